@@ -687,8 +687,15 @@ public:
 
   bool getRTSetsSpecConstants() const { return RTSetsSpecConsts; }
 
+  /// Makes the post-link translate its output modules to SPIR-V itself, in
+  /// place of a SPIRVTranslatorJobAction.
+  void setEmitsSPIRV(bool Val) { EmitsSPIRV = Val; }
+
+  bool getEmitsSPIRV() const { return EmitsSPIRV; }
+
 private:
   bool RTSetsSpecConsts = true;
+  bool EmitsSPIRV = false;
 };
 
 class PartialLinkJobAction : public JobAction {
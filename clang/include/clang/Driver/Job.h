@@ -27,6 +27,7 @@ namespace clang {
 namespace driver {
 
 class Action;
+class CachedCommandGroup;
 class InputInfo;
 class Tool;
 
@@ -179,6 +180,10 @@ public:
   /// Whether the command will be executed in this process or not.
   bool InProcess = false;
 
+  /// The group of commands with a cached result this command belongs to, if
+  /// any.
+  std::shared_ptr<CachedCommandGroup> CacheGroup;
+
   Command(const Action &Source, const Tool &Creator,
           ResponseFileSupport ResponseSupport, const char *Executable,
           const llvm::opt::ArgStringList &Arguments, ArrayRef<InputInfo> Inputs,
@@ -304,6 +309,44 @@ public:
               bool *ExecutionFailed) const override;
 };
 
+/// A sequence of commands turning a single input file into a single output
+/// file, whose output is kept in a cache directory and reused when the
+/// commands are run again on identical input. The cache key covers the input
+/// contents and the executables and arguments of the commands, with the names
+/// of the files that differ between runs (temporary files) left out.
+class CachedCommandGroup {
+public:
+  CachedCommandGroup(StringRef CacheDir, StringRef InputFile,
+                     StringRef OutputFile, ArrayRef<const Command *> Commands,
+                     ArrayRef<StringRef> VolatileFileNames);
+
+  /// Looks the output up in the cache and copies it to its destination if
+  /// found. This is done before the first command of the group is executed.
+  void lookup();
+
+  /// Puts the output into the cache. This is done after the last command of
+  /// the group succeeds.
+  void store() const;
+
+  /// Whether the output was found in the cache, in which case the commands of
+  /// the group are not executed.
+  bool isHit() const { return Hit; }
+
+  bool isFirst(const Command &C) const { return Commands.front() == &C; }
+  bool isLast(const Command &C) const { return Commands.back() == &C; }
+
+private:
+  std::string CacheDir;
+  std::string InputFile;
+  std::string OutputFile;
+  std::vector<const Command *> Commands;
+  /// Sorted by decreasing length, so that a name is never replaced by parts.
+  std::vector<std::string> VolatileFileNames;
+  /// Empty if the key could not be computed.
+  std::string Key;
+  bool Hit = false;
+};
+
 /// JobList - A sequence of jobs to perform.
 class JobList {
 public:
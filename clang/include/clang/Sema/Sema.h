@@ -12809,6 +12809,11 @@ private:
   // useful notes that shows where the kernel was called.
   bool DiagnosingSYCLKernel = false;
 
+  // Records captured by kernels which need no decomposition and have been
+  // checked without diagnostics, so that the kernel argument checks of the
+  // following kernels don't visit them again.
+  llvm::SmallPtrSet<const RecordDecl *, 16> SYCLCheckedKernelArgRecords;
+
 public:
   void addSyclDeviceDecl(Decl *d) { SyclDeviceDecls.insert(d); }
   llvm::SetVector<Decl *> &syclDeviceDecls() { return SyclDeviceDecls; }
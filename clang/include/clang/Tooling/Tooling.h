@@ -80,6 +80,11 @@ public:
                 FileManager *Files,
                 std::shared_ptr<PCHContainerOperations> PCHContainerOps,
                 DiagnosticConsumer *DiagConsumer) = 0;
+
+  /// Whether the action is performed for each of the compiler jobs of an
+  /// offloading compilation, e.g. for both the device and the host compiles
+  /// of -fsycl, rather than only for the first one.
+  virtual bool runsAllCompilerJobs() const { return false; }
 };
 
 /// Interface to generate clang::FrontendActions.
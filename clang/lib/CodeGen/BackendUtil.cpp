@@ -18,6 +18,7 @@
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/Analysis/InlineCost.h"
 #include "llvm/Analysis/StackSafetyAnalysis.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
@@ -41,6 +42,8 @@
 #include "llvm/Passes/PassBuilder.h"
 #include "llvm/Passes/PassPlugin.h"
 #include "llvm/Passes/StandardInstrumentations.h"
+#include "llvm/SYCLLowerIR/InferAddressSpaces.h"
+#include "llvm/SYCLLowerIR/KernelArgFieldElim.h"
 #include "llvm/SYCLLowerIR/LowerESIMD.h"
 #include "llvm/Support/BuryPointer.h"
 #include "llvm/Support/CommandLine.h"
@@ -650,6 +653,15 @@ void EmitAssemblyHelper::CreatePasses(legacy::PassManager &MPM,
                                       !CodeGenOpts.DisableLifetimeMarkers) ||
                                      LangOpts.Coroutines);
     PMBuilder.Inliner = createAlwaysInlinerLegacyPass(InsertLifetimeIntrinsics);
+  } else if (LangOpts.SYCLIsDevice && TargetTriple.isSPIR() &&
+             !CodeGenOpts.OptimizeSize) {
+    // The SPIR device code is only called from the kernels, and the accessors,
+    // ids and ranges their callees take by reference only get out of private
+    // memory once inlined, so inline as eagerly as the NVPTX target does.
+    InlineParams Params = getInlineParams(CodeGenOpts.OptimizationLevel,
+                                          CodeGenOpts.OptimizeSize);
+    Params.DefaultThreshold *= 5;
+    PMBuilder.Inliner = createFunctionInliningPass(Params);
   } else {
     // We do not want to inline hot callsites for SamplePGO module-summary build
     // because profile annotation will happen again in ThinLTO backend, and we
@@ -963,14 +975,28 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
 
   std::unique_ptr<llvm::ToolOutputFile> ThinLinkOS, DwoOS;
 
+  // Clone the SPIR device functions for the address spaces of the pointers
+  // passed to them, then access these through the concrete address spaces
+  // rather than generic pointers.
+  if (LangOpts.SYCLIsDevice && !CodeGenOpts.DisableLLVMPasses &&
+      CodeGenOpts.OptimizationLevel > 0 && !LangOpts.SYCLExplicitSIMD &&
+      llvm::Triple(TheModule->getTargetTriple()).isSPIR()) {
+    PerModulePasses.add(createSYCLInferAddressSpacesPass());
+    PerModulePasses.add(createInferAddressSpacesPass(/*AddressSpace=*/4));
+    PerModulePasses.add(createInstructionCombiningPass());
+  }
+
   // Eliminate dead arguments from SPIR kernels in SYCL environment.
   // 1. Run DAE when LLVM optimizations are applied as well.
   // 2. We cannot run DAE for ESIMD since the pointers to SPIR kernel
   //    functions are saved in !genx.kernels metadata.
   // 3. DAE pass temporary guarded under option.
   if (LangOpts.SYCLIsDevice && !CodeGenOpts.DisableLLVMPasses &&
-      !LangOpts.SYCLExplicitSIMD && LangOpts.EnableDAEInSpirKernels)
+      !LangOpts.SYCLExplicitSIMD && LangOpts.EnableDAEInSpirKernels) {
     PerModulePasses.add(createDeadArgEliminationSYCLPass());
+    // Then pass only the used fields of the remaining aggregate arguments.
+    PerModulePasses.add(createSYCLKernelArgFieldElimPass());
+  }
 
   if (LangOpts.SYCLIsDevice && LangOpts.SYCLExplicitSIMD)
     PerModulePasses.add(createGenXSPIRVWriterAdaptorPass());
@@ -198,6 +198,16 @@ bool Compilation::CleanupFileMap(const ArgStringMap &Files,
 
 int Compilation::ExecuteCommand(const Command &C,
                                 const Command *&FailingCommand) const {
+  // The output of a cached command group is either restored from the cache
+  // before its first command runs or put into the cache after the last one.
+  CachedCommandGroup *CacheGroup = C.CacheGroup.get();
+  if (CacheGroup) {
+    if (CacheGroup->isFirst(C))
+      CacheGroup->lookup();
+    if (CacheGroup->isHit())
+      return 0;
+  }
+
   if ((getDriver().CCPrintOptions ||
        getArgs().hasArg(options::OPT_v)) && !getDriver().CCGenDiagnostics) {
     raw_ostream *OS = &llvm::errs();
@@ -237,6 +247,8 @@ int Compilation::ExecuteCommand(const Command &C,
 
   if (Res)
     FailingCommand = &C;
+  else if (CacheGroup && CacheGroup->isLast(C))
+    CacheGroup->store();
 
   return ExecutionFailed ? 1 : Res;
 }
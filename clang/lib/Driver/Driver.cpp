@@ -3680,17 +3680,33 @@ class OffloadingActionBuilder final {
     SmallVector<CudaArch, 8> GpuArchList;
 
     /// Build the last steps for CUDA after all BC files have been linked.
-    Action *finalizeNVPTXDependences(Action *Input, const llvm::Triple &TT) {
-      auto *BA = C.getDriver().ConstructPhaseAction(
-          C, Args, phases::Backend, Input, AssociatedOffloadKind);
-      if (TT.getOS() != llvm::Triple::NVCL) {
+    ///
+    /// For the CUDA OS, the device code is compiled to PTX and assembled to
+    /// SASS for each architecture of GpuArchList, and fatbinary bundles them
+    /// all in one image: the CUDA driver loads the SASS matching the compute
+    /// capability of the device and only JIT compiles the PTX when there is
+    /// none.
+    Action *finalizeNVPTXDependences(Action *Input, const ToolChain *TC) {
+      if (TC->getTriple().getOS() == llvm::Triple::NVCL)
+        return C.getDriver().ConstructPhaseAction(
+            C, Args, phases::Backend, Input, AssociatedOffloadKind);
+
+      ActionList DeviceActions;
+      for (CudaArch Arch : GpuArchList) {
+        auto *BA = C.getDriver().ConstructPhaseAction(
+            C, Args, phases::Backend, Input, AssociatedOffloadKind);
         auto *AA = C.getDriver().ConstructPhaseAction(
             C, Args, phases::Assemble, BA, AssociatedOffloadKind);
-        ActionList DeviceActions = {BA, AA};
-        return C.MakeAction<LinkJobAction>(DeviceActions,
-                                           types::TY_CUDA_FATBIN);
+        // Bind each action to its architecture so that the backend and ptxas
+        // target it, as the CUDA action builder does.
+        for (Action *A : {AA, BA}) {
+          OffloadAction::DeviceDependences DDep;
+          DDep.add(*A, *TC, CudaArchToString(Arch), AssociatedOffloadKind);
+          DeviceActions.push_back(
+              C.MakeAction<OffloadAction>(DDep, A->getType()));
+        }
       }
-      return BA;
+      return C.MakeAction<LinkJobAction>(DeviceActions, types::TY_CUDA_FATBIN);
     }
 
   public:
@@ -4188,6 +4204,10 @@ class OffloadingActionBuilder final {
         //         |            OffloadWrapper            |
         //         .--------------------------------------.
         //
+        // With -fsycl-post-link-spirv, PostLink outputs SPIR-V and there is
+        // no SPIRVTranslator; the file table of PostLink goes to the
+        // OffloadWrapper directly when there is no BackendCompile.
+        //
         Action *DeviceLinkAction =
             C.MakeAction<LinkJobAction>(LinkObjects, types::TY_LLVM_BC);
         ActionList FullLinkObjects;
@@ -4231,17 +4251,29 @@ class OffloadingActionBuilder final {
         // post link is not optional - even if not splitting, always need to
         // process specialization constants
         bool MultiFileActionDeps = !isSpirvAOT || DeviceCodeSplit || EnableDAE;
+        // sycl-post-link may translate the modules to SPIR-V as it saves
+        // them, which saves writing and parsing them again in llvm-spirv
+        bool PostLinkSPIRV =
+            !isNVPTX && Args.hasFlag(options::OPT_fsycl_post_link_spirv,
+                                     options::OPT_fno_sycl_post_link_spirv,
+                                     false);
         types::ID PostLinkOutType = isNVPTX || !MultiFileActionDeps
                                         ? types::TY_LLVM_BC
                                         : types::TY_Tempfiletable;
+        if (PostLinkOutType == types::TY_LLVM_BC && PostLinkSPIRV)
+          PostLinkOutType = types::TY_SPIRV;
         auto *PostLinkAction = C.MakeAction<SYCLPostLinkJobAction>(
             FullDeviceLinkAction, PostLinkOutType);
         PostLinkAction->setRTSetsSpecConstants(!isAOT);
+        PostLinkAction->setEmitsSPIRV(PostLinkSPIRV);
 
         if (isNVPTX) {
           Action *FinAction =
-              finalizeNVPTXDependences(PostLinkAction, (*TC)->getTriple());
+              finalizeNVPTXDependences(PostLinkAction, *TC);
           WrapperInputs.push_back(FinAction);
+        } else if (PostLinkSPIRV && !isSpirvAOT) {
+          // The file table lists the SPIR-V modules to wrap already
+          WrapperInputs.push_back(PostLinkAction);
         } else {
           // For SPIRV-based targets - translate to SPIRV then optionally
           // compile ahead-of-time to native architecture
@@ -4259,7 +4291,9 @@ class OffloadingActionBuilder final {
           types::ID SPIRVOutType =
               MultiFileActionDeps ? types::TY_Tempfilelist : types::TY_SPIRV;
           Action *BuildCodeAction =
-              C.MakeAction<SPIRVTranslatorJobAction>(SPIRVInput, SPIRVOutType);
+              PostLinkSPIRV ? SPIRVInput
+                            : C.MakeAction<SPIRVTranslatorJobAction>(
+                                  SPIRVInput, SPIRVOutType);
 
           // After the Link, wrap the files before the final host link
           if (isSpirvAOT) {
@@ -4307,6 +4341,10 @@ class OffloadingActionBuilder final {
         if (isSpirvAOT)
           DA.add(*DeviceWrappingAction, **TC, /*BoundArch=*/nullptr,
                  Action::OFK_SYCL);
+        else if (isNVPTX && (*TC)->getTriple().getOS() != llvm::Triple::NVCL)
+          // The fat binary holds the code of all the architectures already
+          DA.add(*DeviceWrappingAction, **TC,
+                 CudaArchToString(GpuArchList.front()), Action::OFK_SYCL);
         else
           withBoundArchForToolChain(*TC, [&](const char *BoundArch) {
             DA.add(*DeviceWrappingAction, **TC, BoundArch, Action::OFK_SYCL);
@@ -9,6 +9,7 @@
 #include "clang/Driver/Job.h"
 #include "InputInfo.h"
 #include "clang/Basic/LLVM.h"
+#include "clang/Basic/Version.h"
 #include "clang/Driver/Driver.h"
 #include "clang/Driver/DriverDiagnostic.h"
 #include "clang/Driver/Tool.h"
@@ -21,6 +22,8 @@
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Program.h"
@@ -493,6 +496,73 @@ int ForceSuccessCommand::Execute(ArrayRef<llvm::Optional<StringRef>> Redirects,
   return 0;
 }
 
+CachedCommandGroup::CachedCommandGroup(StringRef CacheDir, StringRef InputFile,
+                                       StringRef OutputFile,
+                                       ArrayRef<const Command *> Commands,
+                                       ArrayRef<StringRef> VolatileFileNames)
+    : CacheDir(CacheDir), InputFile(InputFile), OutputFile(OutputFile),
+      Commands(Commands.begin(), Commands.end()),
+      VolatileFileNames(VolatileFileNames.begin(), VolatileFileNames.end()) {
+  assert(!this->Commands.empty() && "empty command group");
+  llvm::sort(this->VolatileFileNames,
+             [](const std::string &A, const std::string &B) {
+               return A.size() > B.size();
+             });
+}
+
+void CachedCommandGroup::lookup() {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Input =
+      llvm::MemoryBuffer::getFile(InputFile);
+  if (!Input)
+    return;
+
+  llvm::MD5 Hash;
+  auto AddString = [&](StringRef S) {
+    // Separate the strings, so that their boundaries affect the hash.
+    Hash.update(S);
+    Hash.update(StringRef("", 1));
+  };
+  AddString(getClangFullVersion());
+  AddString((*Input)->getBuffer());
+  for (const Command *C : Commands) {
+    AddString(C->getExecutable());
+    for (const char *Arg : C->getArguments()) {
+      std::string Normalized(Arg);
+      for (const std::string &Name : VolatileFileNames) {
+        for (size_t Pos = Normalized.find(Name); Pos != std::string::npos;
+             Pos = Normalized.find(Name, Pos))
+          Normalized.replace(Pos, Name.size(), "<file>");
+      }
+      AddString(Normalized);
+    }
+  }
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  Key = Result.digest().str().str();
+
+  SmallString<128> CachedFile(CacheDir);
+  llvm::sys::path::append(CachedFile, Key);
+  Hit = llvm::sys::fs::exists(CachedFile) &&
+        !llvm::sys::fs::copy_file(CachedFile, OutputFile);
+}
+
+void CachedCommandGroup::store() const {
+  // The cache is best effort, failures to update it are not errors.
+  if (Key.empty() || llvm::sys::fs::create_directories(CacheDir))
+    return;
+  SmallString<128> CachedFile(CacheDir);
+  llvm::sys::path::append(CachedFile, Key);
+  // Copy to a temporary file first, so that concurrent builds never see a
+  // partially written entry.
+  SmallString<128> TmpFile;
+  if (llvm::sys::fs::createUniqueFile(Twine(CachedFile) + "-%%%%%%.tmp",
+                                      TmpFile))
+    return;
+  if (llvm::sys::fs::copy_file(OutputFile, TmpFile) ||
+      llvm::sys::fs::rename(TmpFile, CachedFile))
+    llvm::sys::fs::remove(TmpFile);
+}
+
 void JobList::Print(raw_ostream &OS, const char *Terminator, bool Quote,
                     CrashReportInfo *CrashInfo) const {
   for (const auto &Job : *this)
@@ -34,6 +34,7 @@
 #include "clang/Driver/Options.h"
 #include "clang/Driver/SanitizerArgs.h"
 #include "clang/Driver/XRayArgs.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Config/llvm-config.h"
 #include "llvm/Option/ArgList.h"
@@ -1288,6 +1289,7 @@ void Clang::AddPreprocessingOptions(Compilation &C, const JobAction &JA,
   }
 
   bool RenderedImplicitInclude = false;
+  bool RenderedImplicitPCH = false;
   for (const Arg *A : Args.filtered(options::OPT_clang_i_Group)) {
     if (A->getOption().matches(options::OPT_include)) {
       // Handling of gcc-style gch precompiled headers.
@@ -1296,6 +1298,14 @@ void Clang::AddPreprocessingOptions(Compilation &C, const JobAction &JA,
 
       bool FoundPCH = false;
       SmallString<128> P(A->getValue());
+      // The device compiles of SYCL offloading can't read the precompiled
+      // header of the host compile, which is built for another target. They
+      // look for one named like foo.h.spir64-unknown-unknown-sycldevice.pch,
+      // so that the host and device compiles both skip parsing the headers.
+      if (JA.isDeviceOffloading(Action::OFK_SYCL)) {
+        P += ".";
+        P += getToolChain().getTriple().str();
+      }
       // We want the files to have a name like foo.h.pch. Add a dummy extension
       // so that replace_extension does the right thing.
       P += ".dummy";
@@ -1315,6 +1325,7 @@ void Clang::AddPreprocessingOptions(Compilation &C, const JobAction &JA,
           A->claim();
           CmdArgs.push_back("-include-pch");
           CmdArgs.push_back(Args.MakeArgString(P));
+          RenderedImplicitPCH = true;
           continue;
         } else {
           // Ignore the PCH if not first on command line and emit warning.
@@ -1339,6 +1350,23 @@ void Clang::AddPreprocessingOptions(Compilation &C, const JobAction &JA,
     A->render(Args, CmdArgs);
   }
 
+  // With -fsycl-pch, the compiles of SYCL offloading use the SYCL headers
+  // precompiled for their target, installed as CL/sycl.hpp.<triple>.pch next
+  // to the headers, unless another precompiled header is used. The #include
+  // of CL/sycl.hpp is then skipped as the header was already included.
+  if (JA.isOffloading(Action::OFK_SYCL) && !RenderedImplicitPCH &&
+      !Args.hasArg(options::OPT_include_pch) &&
+      Args.hasFlag(options::OPT_fsycl_pch, options::OPT_fno_sycl_pch, false)) {
+    SmallString<128> P(D.getInstalledDir());
+    llvm::sys::path::append(P, "..", "include", "sycl", "CL");
+    llvm::sys::path::append(P, "sycl.hpp." + getToolChain().getTriple().str() +
+                                   ".pch");
+    if (llvm::sys::fs::exists(P)) {
+      CmdArgs.push_back("-include-pch");
+      CmdArgs.push_back(Args.MakeArgString(P));
+    }
+  }
+
   Args.AddAllArgs(CmdArgs,
                   {options::OPT_D, options::OPT_U, options::OPT_I_Group,
                    options::OPT_F, options::OPT_index_header_map});
@@ -7780,6 +7808,48 @@ void OffloadBundler::ConstructJobMultipleOutputs(
 
 // Begin OffloadWrapper
 
+// Makes the commands from the SYCL post-link one up to the ones of the given
+// offload wrapper action a cached group, so that the wrapped device code is
+// reused while the linked device module and the options don't change. The
+// device code is not cached if it depends on other inputs, like the FPGA
+// dependency files or the device libraries linked in ahead of time.
+static void addSYCLDeviceCodeCache(Compilation &C, const JobAction &WrapperJA,
+                                   StringRef CacheDir, StringRef Output) {
+  llvm::SmallPtrSet<const Action *, 8> GroupActions;
+  SmallVector<const Action *, 8> Worklist{&WrapperJA};
+  while (!Worklist.empty()) {
+    const Action *A = Worklist.pop_back_val();
+    if (!GroupActions.insert(A).second || isa<SYCLPostLinkJobAction>(A))
+      continue;
+    if (A->getInputs().empty() ||
+        !isa<FileTableTformJobAction, SPIRVTranslatorJobAction,
+             BackendCompileJobAction, OffloadWrapperJobAction>(A))
+      return;
+    Worklist.append(A->getInputs().begin(), A->getInputs().end());
+  }
+
+  SmallVector<Command *, 8> Commands;
+  for (Command &Cmd : C.getJobs())
+    if (GroupActions.count(&Cmd.getSource()))
+      Commands.push_back(&Cmd);
+  if (Commands.empty() ||
+      !isa<SYCLPostLinkJobAction>(Commands.front()->getSource()) ||
+      Commands.front()->getInputFilenames().size() != 1)
+    return;
+
+  // Temporary file names differ between runs, so they are not a part of the
+  // cache key.
+  SmallVector<StringRef, 16> VolatileFileNames{Output};
+  for (const auto &TempFile : C.getTempFiles())
+    VolatileFileNames.push_back(TempFile.first);
+  auto Group = std::make_shared<CachedCommandGroup>(
+      CacheDir, Commands.front()->getInputFilenames().front(), Output,
+      SmallVector<const Command *, 8>(Commands.begin(), Commands.end()),
+      VolatileFileNames);
+  for (Command *Cmd : Commands)
+    Cmd->CacheGroup = Group;
+}
+
 void OffloadWrapper::ConstructJob(Compilation &C, const JobAction &JA,
                                   const InputInfo &Output,
                                   const InputInfoList &Inputs,
@@ -7864,6 +7934,13 @@ void OffloadWrapper::ConstructJob(Compilation &C, const JobAction &JA,
       createArgString("-link-opts=");
     }
 
+    // FPGA binaries are extracted from the bundle sections by other tools, so
+    // only compress images the SYCL runtime consumes directly.
+    if (TCArgs.hasFlag(options::OPT_fsycl_compress_device_images,
+                       options::OPT_fno_sycl_compress_device_images, false) &&
+        TT.getSubArch() != llvm::Triple::SPIRSubArch_fpga)
+      WrapperArgs.push_back("-compress");
+
     WrapperArgs.push_back(
         C.getArgs().MakeArgString(Twine("-target=") + TargetTripleOpt));
 
@@ -7915,6 +7992,10 @@ void OffloadWrapper::ConstructJob(Compilation &C, const JobAction &JA,
     const char *Llc = C.getArgs().MakeArgString(LlcPath);
     C.addCommand(std::make_unique<Command>(
          JA, *this, ResponseFileSupport::None(), Llc, LlcArgs, None));
+
+    if (const Arg *A =
+            TCArgs.getLastArg(options::OPT_fsycl_device_code_cache_dir_EQ))
+      addSYCLDeviceCodeCache(C, JA, A->getValue(), Output.getFilename());
     return;
   } // end of SYCL flavor of offload wrapper command creation
 
@@ -7990,6 +8071,30 @@ void OffloadWrapper::ConstructJob(Compilation &C, const JobAction &JA,
 
 // Begin SPIRVTranslator
 
+// Returns the SPIR-V extensions option of llvm-spirv, which sycl-post-link
+// takes too, for the SYCL device code of the tool chain.
+static const char *getSYCLSPIRVExtensionsArg(const ToolChain &TC,
+                                             const llvm::opt::ArgList &TCArgs) {
+  // Disable SPV_INTEL_usm_storage_classes by default since it adds new
+  // storage classes that represent global_device and global_host address
+  // spaces, which are not supported for all targets. With the extension
+  // disable the storage classes will be lowered to CrossWorkgroup storage
+  // class that is mapped to just global address space. The extension is
+  // supposed to be enabled only for FPGA hardware.
+  const char *ExtArg = "-spirv-ext=+all,-SPV_INTEL_usm_storage_classes";
+  if (TC.getTriple().getSubArch() == llvm::Triple::SPIRSubArch_fpga) {
+    for (auto *A : TCArgs) {
+      if (A->getOption().matches(options::OPT_Xs_separate) ||
+          A->getOption().matches(options::OPT_Xs)) {
+        StringRef ArgString(A->getValue());
+        if (ArgString == "hardware" || ArgString == "simulation")
+          ExtArg = "-spirv-ext=+all";
+      }
+    }
+  }
+  return ExtArg;
+}
+
 void SPIRVTranslator::ConstructJob(Compilation &C, const JobAction &JA,
                                   const InputInfo &Output,
                                   const InputInfoList &Inputs,
@@ -8013,26 +8118,7 @@ void SPIRVTranslator::ConstructJob(Compilation &C, const JobAction &JA,
     TranslatorArgs.push_back("-spirv-allow-extra-diexpressions");
     if (C.getArgs().hasArg(options::OPT_fsycl_esimd))
       TranslatorArgs.push_back("-spirv-allow-unknown-intrinsics");
-
-    // Disable SPV_INTEL_usm_storage_classes by default since it adds new
-    // storage classes that represent global_device and global_host address
-    // spaces, which are not supported for all targets. With the extension
-    // disable the storage classes will be lowered to CrossWorkgroup storage
-    // class that is mapped to just global address space. The extension is
-    // supposed to be enabled only for FPGA hardware.
-    std::string ExtArg("-spirv-ext=+all,-SPV_INTEL_usm_storage_classes");
-    if (getToolChain().getTriple().getSubArch() ==
-        llvm::Triple::SPIRSubArch_fpga) {
-      for (auto *A : TCArgs) {
-        if (A->getOption().matches(options::OPT_Xs_separate) ||
-            A->getOption().matches(options::OPT_Xs)) {
-          StringRef ArgString(A->getValue());
-          if (ArgString == "hardware" || ArgString == "simulation")
-            ExtArg = "-spirv-ext=+all";
-        }
-      }
-    }
-    TranslatorArgs.push_back(TCArgs.MakeArgString(ExtArg));
+    TranslatorArgs.push_back(getSYCLSPIRVExtensionsArg(getToolChain(), TCArgs));
   }
   for (auto I : Inputs) {
     std::string Filename(I.getFilename());
@@ -8143,6 +8229,8 @@ void SYCLPostLink::ConstructJob(Compilation &C, const JobAction &JA,
       addArgs(CmdArgs, TCArgs, {"-split=kernel"});
     else if (StringRef(A->getValue()) == "per_source")
       addArgs(CmdArgs, TCArgs, {"-split=source"});
+    else if (StringRef(A->getValue()) == "by_size")
+      addArgs(CmdArgs, TCArgs, {"-split=size"});
     else
       // split must be off
       assert(StringRef(A->getValue()) == "off");
@@ -8155,24 +8243,51 @@ void SYCLPostLink::ConstructJob(Compilation &C, const JobAction &JA,
       TCArgs.hasFlag(options::OPT_fsycl_dead_args_optimization,
                      options::OPT_fno_sycl_dead_args_optimization, false))
     addArgs(CmdArgs, TCArgs, {"-emit-param-info"});
-  if (JA.getType() == types::TY_LLVM_BC) {
+  if (JA.getType() == types::TY_LLVM_BC || JA.getType() == types::TY_SPIRV) {
     // single file output requested - this means only perform necessary IR
     // transformations (like specialization constant intrinsic lowering) and
-    // output LLVMIR
+    // output LLVMIR, or its SPIR-V translation
     addArgs(CmdArgs, TCArgs, {"-ir-output-only"});
   } else {
     assert(JA.getType() == types::TY_Tempfiletable);
     // Symbol file and specialization constant info generation is mandatory -
     // add options unconditionally
     addArgs(CmdArgs, TCArgs, {"-symbols"});
+    // ESIMD and SYCL kernels are compiled by different back-ends, so they
+    // must not share a device image
+    if (TCArgs.hasFlag(options::OPT_fsycl_esimd, options::OPT_fno_sycl_esimd,
+                       false))
+      addArgs(CmdArgs, TCArgs, {"-split-esimd"});
+    // the variants are listed in the properties, which need a file table
+    if (Arg *A =
+            TCArgs.getLastArg(options::OPT_fsycl_sub_group_size_variants_EQ))
+      addArgs(CmdArgs, TCArgs,
+              {TCArgs.MakeArgString(Twine("-sub-group-size-variants=") +
+                                    llvm::join(A->getValues(), ","))});
   }
   // specialization constants processing is mandatory
   auto *SYCLPostLink = llvm::dyn_cast<SYCLPostLinkJobAction>(&JA);
   if (SYCLPostLink && SYCLPostLink->getRTSetsSpecConstants())
     addArgs(CmdArgs, TCArgs, {"-spec-const=rt"});
+  else if (JA.getType() == types::TY_Tempfiletable &&
+           TCArgs.hasFlag(options::OPT_fsycl_emulate_spec_constants,
+                          options::OPT_fno_sycl_emulate_spec_constants, false))
+    // the values of spec constants are passed to AOT kernels at launch; the
+    // buffer layout is recorded in the properties, which needs a file table
+    addArgs(CmdArgs, TCArgs, {"-spec-const=emulation"});
   else
     addArgs(CmdArgs, TCArgs, {"-spec-const=default"});
 
+  // The output modules are translated with the options of llvm-spirv, see
+  // SPIRVTranslator
+  if (SYCLPostLink && SYCLPostLink->getEmitsSPIRV()) {
+    addArgs(CmdArgs, TCArgs, {"-emit-spirv"});
+    if (TCArgs.hasArg(options::OPT_fsycl_esimd))
+      addArgs(CmdArgs, TCArgs, {"-spirv-allow-unknown-intrinsics"});
+    addArgs(CmdArgs, TCArgs,
+            {getSYCLSPIRVExtensionsArg(getToolChain(), TCArgs)});
+  }
+
   // Add output file table file option
   assert(Output.isFilename() && "output must be a filename");
   addArgs(CmdArgs, TCArgs, {"-o", Output.getFilename()});
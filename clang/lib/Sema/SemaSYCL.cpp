@@ -58,8 +58,11 @@ enum KernelInvocationKind {
 
 const static std::string InitMethodName = "__init";
 const static std::string InitESIMDMethodName = "__init_esimd";
+const static std::string InitNoOffsetMethodName = "__init_no_offset";
 const static std::string FinalizeMethodName = "__finalize";
 constexpr unsigned MaxKernelArgsSize = 2048;
+// Must match kernel_param_accessor_no_offset in the SYCL runtime.
+constexpr int AccessorNoOffsetFlag = 1 << 15;
 
 namespace {
 
@@ -92,6 +95,10 @@ public:
   /// buffer_location class.
   static bool isSyclBufferLocationType(const QualType &Ty);
 
+  /// Checks whether given clang type is a full specialization of the SYCL
+  /// no_offset class.
+  static bool isSyclNoOffsetType(const QualType &Ty);
+
   /// Checks whether given clang type is a standard SYCL API class with given
   /// name.
   /// \param Ty    the clang type being checked
@@ -767,6 +774,40 @@ static target getAccessTarget(const ClassTemplateSpecializationDecl *AccTy) {
       AccTy->getTemplateArgs()[3].getAsIntegral().getExtValue());
 }
 
+/// \return whether given SYCL accessor type has the no_offset property in its
+/// accessor_property_list
+static bool hasNoOffsetProperty(const CXXRecordDecl *RD) {
+  const auto *AccTy = dyn_cast<ClassTemplateSpecializationDecl>(RD);
+  if (!AccTy || AccTy->getTemplateArgs().size() < 6)
+    return false;
+  const TemplateArgument &PropList = AccTy->getTemplateArgs()[5];
+  if (PropList.getKind() != TemplateArgument::ArgKind::Type)
+    return false;
+  const auto *PropListDecl = dyn_cast_or_null<ClassTemplateSpecializationDecl>(
+      PropList.getAsType()->getAsRecordDecl());
+  if (!PropListDecl || PropListDecl->getTemplateArgs().size() != 1)
+    return false;
+  const TemplateArgument &Props = PropListDecl->getTemplateArgs()[0];
+  if (Props.getKind() != TemplateArgument::ArgKind::Pack)
+    return false;
+  return llvm::any_of(Props.pack_elements(), [](const TemplateArgument &Prop) {
+    return Prop.getKind() == TemplateArgument::ArgKind::Type &&
+           Util::isSyclNoOffsetType(Prop.getAsType());
+  });
+}
+
+/// \return the name of the method initializing given SYCL accessor type in
+/// the kernel. The offset of accessors with the no_offset property is known to
+/// be zero, so they are initialized without it when the accessor supports it.
+static const std::string &getAccessorInitMethodName(const CXXRecordDecl *RD,
+                                                    bool IsSIMD) {
+  if (IsSIMD)
+    return InitESIMDMethodName;
+  if (hasNoOffsetProperty(RD) && getMethodByName(RD, InitNoOffsetMethodName))
+    return InitNoOffsetMethodName;
+  return InitMethodName;
+}
+
 // The first template argument to the kernel caller function is used to identify
 // the kernel itself.
 static QualType calculateKernelNameType(ASTContext &Ctx,
@@ -813,13 +854,23 @@ template <typename T> using bind_param_t = typename bind_param<T>::type;
 
 class KernelObjVisitor {
   Sema &SemaRef;
+  // If set, records found in the set are skipped, and records which turn out
+  // to need no decomposition are added to it if they have been visited
+  // without diagnostics. Only valid for handlers which don't collect anything
+  // from such records, i.e. the checkers.
+  llvm::SmallPtrSetImpl<const RecordDecl *> *CheckedRecords = nullptr;
+  // Union bodies are only visited by some of the handlers, so the records in
+  // them are not added to CheckedRecords.
+  unsigned UnionDepth = 0;
 
   template <typename ParentTy, typename... HandlerTys>
   void VisitUnionImpl(const CXXRecordDecl *Owner, ParentTy &Parent,
                       const CXXRecordDecl *Wrapper, HandlerTys &... Handlers) {
     (void)std::initializer_list<int>{
         (Handlers.enterUnion(Owner, Parent), 0)...};
+    ++UnionDepth;
     VisitRecordHelper(Wrapper, Wrapper->fields(), Handlers...);
+    --UnionDepth;
     (void)std::initializer_list<int>{
         (Handlers.leaveUnion(Owner, Parent), 0)...};
   }
@@ -1033,7 +1084,10 @@ class KernelObjVisitor {
   }
 
 public:
-  KernelObjVisitor(Sema &S) : SemaRef(S) {}
+  KernelObjVisitor(Sema &S,
+                   llvm::SmallPtrSetImpl<const RecordDecl *> *CheckedRecords =
+                       nullptr)
+      : SemaRef(S), CheckedRecords(CheckedRecords) {}
 
   template <typename... HandlerTys>
   void VisitRecordBases(const CXXRecordDecl *KernelFunctor,
@@ -1228,6 +1282,11 @@ void KernelObjVisitor::visitRecord(const CXXRecordDecl *Owner, ParentTy &Parent,
                                    HandlerTys &... Handlers) {
   RecordDecl *RD = RecordTy->getAsRecordDecl();
   assert(RD && "should not be null.");
+  if (CheckedRecords && CheckedRecords->count(RD))
+    return;
+  DiagnosticsEngine &Diags = SemaRef.getDiagnostics();
+  unsigned NumWarnings = Diags.getNumWarnings();
+
   if (RD->hasAttr<SYCLRequiresDecompositionAttr>()) {
     // If this container requires decomposition, we have to visit it as
     // 'complex', so all handlers are called in this case with the 'complex'
@@ -1256,6 +1315,13 @@ void KernelObjVisitor::visitRecord(const CXXRecordDecl *Owner, ParentTy &Parent,
               Handlers)
               .Handler...);
   }
+
+  // The handlers stop at the first invalid one, so any error so far might
+  // have hidden a member which needs decomposition.
+  if (CheckedRecords && !UnionDepth &&
+      !RD->hasAttr<SYCLRequiresDecompositionAttr>() &&
+      !Diags.hasErrorOccurred() && Diags.getNumWarnings() == NumWarnings)
+    CheckedRecords->insert(RD);
 }
 
 template <typename... HandlerTys>
@@ -1732,8 +1798,9 @@ class SyclKernelDeclCreator : public SyclKernelFieldHandler {
     const auto *RecordDecl = FieldTy->getAsCXXRecordDecl();
     assert(RecordDecl && "The accessor/sampler must be a RecordDecl");
     const std::string &MethodName =
-        KernelDecl->hasAttr<SYCLSimdAttr>() && isAccessorType
-            ? InitESIMDMethodName
+        isAccessorType
+            ? getAccessorInitMethodName(RecordDecl,
+                                        KernelDecl->hasAttr<SYCLSimdAttr>())
             : InitMethodName;
     CXXMethodDecl *InitMethod = getMethodByName(RecordDecl, MethodName);
     assert(InitMethod && "The accessor/sampler must have the __init method");
@@ -1845,9 +1912,8 @@ public:
                               QualType FieldTy) final {
     const auto *RecordDecl = FieldTy->getAsCXXRecordDecl();
     assert(RecordDecl && "The accessor/sampler must be a RecordDecl");
-    const std::string MethodName = KernelDecl->hasAttr<SYCLSimdAttr>()
-                                       ? InitESIMDMethodName
-                                       : InitMethodName;
+    const std::string &MethodName = getAccessorInitMethodName(
+        RecordDecl, KernelDecl->hasAttr<SYCLSimdAttr>());
     CXXMethodDecl *InitMethod = getMethodByName(RecordDecl, MethodName);
     assert(InitMethod && "The accessor/sampler must have the __init method");
 
@@ -1991,7 +2057,7 @@ class SyclKernelArgsSizeChecker : public SyclKernelFieldHandler {
     const CXXRecordDecl *RecordDecl = FieldTy->getAsCXXRecordDecl();
     assert(RecordDecl && "The accessor/sampler must be a RecordDecl");
     const std::string &MethodName =
-        IsSIMD ? InitESIMDMethodName : InitMethodName;
+        getAccessorInitMethodName(RecordDecl, IsSIMD);
     CXXMethodDecl *InitMethod = getMethodByName(RecordDecl, MethodName);
     assert(InitMethod && "The accessor/sampler must have the __init method");
     for (const ParmVarDecl *Param : InitMethod->parameters())
@@ -2404,9 +2470,9 @@ class SyclKernelBodyCreator : public SyclKernelFieldHandler {
     return VD;
   }
 
-  const std::string &getInitMethodName() const {
+  const std::string &getInitMethodName(const CXXRecordDecl *RD) const {
     bool IsSIMDKernel = isESIMDKernelType(KernelObj);
-    return IsSIMDKernel ? InitESIMDMethodName : InitMethodName;
+    return getAccessorInitMethodName(RD, IsSIMDKernel);
   }
 
   // Default inits the type, then calls the init-method in the body.
@@ -2417,7 +2483,8 @@ class SyclKernelBodyCreator : public SyclKernelFieldHandler {
     addFieldMemberExpr(FD, Ty);
 
     const auto *RecordDecl = Ty->getAsCXXRecordDecl();
-    createSpecialMethodCall(RecordDecl, getInitMethodName(), BodyStmts);
+    createSpecialMethodCall(RecordDecl, getInitMethodName(RecordDecl),
+                            BodyStmts);
 
     removeFieldMemberExpr(FD, Ty);
 
@@ -2427,7 +2494,8 @@ class SyclKernelBodyCreator : public SyclKernelFieldHandler {
   bool handleSpecialType(const CXXBaseSpecifier &BS, QualType Ty) {
     const auto *RecordDecl = Ty->getAsCXXRecordDecl();
     addBaseInit(BS, Ty, InitializationKind::CreateDefault(KernelCallerSrcLoc));
-    createSpecialMethodCall(RecordDecl, getInitMethodName(), BodyStmts);
+    createSpecialMethodCall(RecordDecl, getInitMethodName(RecordDecl),
+                            BodyStmts);
     return true;
   }
 
@@ -2551,7 +2619,8 @@ public:
     // calls, so add them here instead.
     const auto *StreamDecl = Ty->getAsCXXRecordDecl();
 
-    createSpecialMethodCall(StreamDecl, getInitMethodName(), BodyStmts);
+    createSpecialMethodCall(StreamDecl, getInitMethodName(StreamDecl),
+                            BodyStmts);
     createSpecialMethodCall(StreamDecl, FinalizeMethodName, FinalizeStmts);
 
     removeFieldMemberExpr(FD, Ty);
@@ -2669,6 +2738,22 @@ class SyclKernelIntHeaderCreator : public SyclKernelFieldHandler {
   int64_t CurOffset = 0;
   llvm::SmallVector<size_t, 16> ArrayBaseOffsets;
   int StructDepth = 0;
+  bool IsSIMDKernel = false;
+
+  // The info of an accessor parameter holds the access target, the dimensions
+  // shifted by 11 bits and whether the offset is omitted from the kernel
+  // arguments, see kernel_param_desc_t in the runtime.
+  int getAccessorInfo(const ClassTemplateSpecializationDecl *AccTy) const {
+    assert(AccTy->getTemplateArgs().size() >= 2 &&
+           "Incorrect template args for Accessor Type");
+    int Dims = static_cast<int>(
+        AccTy->getTemplateArgs()[1].getAsIntegral().getExtValue());
+    int Info = getAccessTarget(AccTy) | (Dims << 11);
+    if (&getAccessorInitMethodName(AccTy, IsSIMDKernel) ==
+        &InitNoOffsetMethodName)
+      Info |= AccessorNoOffsetFlag;
+    return Info;
+  }
 
   // A series of functions to calculate the change in offset based on the type.
   int64_t offsetOf(const FieldDecl *FD, QualType ArgTy) const {
@@ -2755,8 +2840,8 @@ public:
                              const CXXRecordDecl *KernelObj, QualType NameType,
                              StringRef Name, StringRef StableName,
                              FunctionDecl *KernelFunc)
-      : SyclKernelFieldHandler(S), Header(H) {
-    bool IsSIMDKernel = isESIMDKernelType(KernelObj);
+      : SyclKernelFieldHandler(S), Header(H),
+        IsSIMDKernel(isESIMDKernelType(KernelObj)) {
     Header.startKernel(Name, NameType, StableName, KernelObj->getLocation(),
                        IsSIMDKernel);
     setThisItemIsCalled(KernelObj, KernelFunc);
@@ -2767,11 +2852,7 @@ public:
                               QualType FieldTy) final {
     const auto *AccTy =
         cast<ClassTemplateSpecializationDecl>(FieldTy->getAsRecordDecl());
-    assert(AccTy->getTemplateArgs().size() >= 2 &&
-           "Incorrect template args for Accessor Type");
-    int Dims = static_cast<int>(
-        AccTy->getTemplateArgs()[1].getAsIntegral().getExtValue());
-    int Info = getAccessTarget(AccTy) | (Dims << 11);
+    int Info = getAccessorInfo(AccTy);
     Header.addParamDesc(SYCLIntegrationHeader::kind_accessor, Info,
                         CurOffset +
                             offsetOf(RD, BC.getType()->getAsCXXRecordDecl()));
@@ -2781,11 +2862,7 @@ public:
   bool handleSyclAccessorType(FieldDecl *FD, QualType FieldTy) final {
     const auto *AccTy =
         cast<ClassTemplateSpecializationDecl>(FieldTy->getAsRecordDecl());
-    assert(AccTy->getTemplateArgs().size() >= 2 &&
-           "Incorrect template args for Accessor Type");
-    int Dims = static_cast<int>(
-        AccTy->getTemplateArgs()[1].getAsIntegral().getExtValue());
-    int Info = getAccessTarget(AccTy) | (Dims << 11);
+    int Info = getAccessorInfo(AccTy);
 
     Header.addParamDesc(SYCLIntegrationHeader::kind_accessor, Info,
                         CurOffset + offsetOf(FD, FieldTy));
@@ -3133,6 +3210,7 @@ void Sema::CheckSYCLKernelCall(FunctionDecl *KernelFunc, SourceRange CallLoc,
                                             IsSIMDKernel);
 
   KernelObjVisitor Visitor{*this};
+  KernelObjVisitor CheckVisitor{*this, &SYCLCheckedKernelArgRecords};
   SYCLKernelNameTypeVisitor KernelNameTypeVisitor(*this, Args[0]->getExprLoc(),
                                                   KernelNameType);
 
@@ -3141,9 +3219,12 @@ void Sema::CheckSYCLKernelCall(FunctionDecl *KernelFunc, SourceRange CallLoc,
   // Emit diagnostics for SYCL device kernels only
   if (LangOpts.SYCLIsDevice)
     KernelNameTypeVisitor.Visit(KernelNameType);
-  Visitor.VisitRecordBases(KernelObj, FieldChecker, UnionChecker, DecompMarker);
-  Visitor.VisitRecordFields(KernelObj, FieldChecker, UnionChecker,
-                            DecompMarker);
+  // The checked records are shared by all kernels, as the checks only depend
+  // on the types.
+  CheckVisitor.VisitRecordBases(KernelObj, FieldChecker, UnionChecker,
+                                DecompMarker);
+  CheckVisitor.VisitRecordFields(KernelObj, FieldChecker, UnionChecker,
+                                 DecompMarker);
   // ArgSizeChecker needs to happen after DecompMarker has completed, since it
   // cares about the decomp attributes. DecompMarker cannot run before the
   // others, since it counts on the FieldChecker to make sure it is visiting
@@ -3527,6 +3608,9 @@ class SYCLFwdDeclEmitter
   using InnerTemplArgVisitor = ConstTemplateArgumentVisitor<SYCLFwdDeclEmitter>;
   raw_ostream &OS;
   llvm::SmallPtrSet<const NamedDecl *, 4> Printed;
+  // Types whose forward declarations have all been printed, so that the types
+  // shared by many kernel names are only traversed once.
+  llvm::SmallPtrSet<const Type *, 16> Visited;
   PrintingPolicy Policy;
 
   void printForwardDecl(NamedDecl *D) {
@@ -3591,7 +3675,7 @@ public:
   }
 
   void Visit(QualType T) {
-    if (T.isNull())
+    if (T.isNull() || !Visited.insert(T.getTypePtr()).second)
       return;
     InnerTypeVisitor::Visit(T.getTypePtr());
   }
@@ -4051,6 +4135,20 @@ bool Util::isSyclBufferLocationType(const QualType &Ty) {
   return matchQualifiedTypeName(Ty, Scopes);
 }
 
+bool Util::isSyclNoOffsetType(const QualType &Ty) {
+  const StringRef &PropertyName = "no_offset";
+  const StringRef &InstanceName = "instance";
+  std::array<DeclContextDesc, 6> Scopes = {
+      Util::DeclContextDesc{Decl::Kind::Namespace, "cl"},
+      Util::DeclContextDesc{Decl::Kind::Namespace, "sycl"},
+      Util::DeclContextDesc{Decl::Kind::Namespace, "ONEAPI"},
+      Util::DeclContextDesc{Decl::Kind::Namespace, "property"},
+      Util::DeclContextDesc{Decl::Kind::CXXRecord, PropertyName},
+      Util::DeclContextDesc{Decl::Kind::ClassTemplateSpecialization,
+                            InstanceName}};
+  return matchQualifiedTypeName(Ty, Scopes);
+}
+
 bool Util::isSyclType(const QualType &Ty, StringRef Name, bool Tmpl) {
   Decl::Kind ClassDeclKind =
       Tmpl ? Decl::Kind::ClassTemplateSpecialization : Decl::Kind::CXXRecord;
@@ -96,6 +96,15 @@ public:
             .ExcludedConditionalDirectiveSkipMappings = PPSkipMappings;
     }
 
+    // The host compile of an offloading compilation includes the header which
+    // the device compile generates, e.g. the SYCL integration header. It
+    // doesn't exist while scanning and is filtered out of the dependencies.
+    const std::string &DependencyFilter =
+        Compiler.getDependencyOutputOpts().DependencyFilter;
+    if (!DependencyFilter.empty())
+      llvm::erase_value(Compiler.getPreprocessorOpts().Includes,
+                        DependencyFilter);
+
     FileMgr->getFileSystemOpts().WorkingDir = std::string(WorkingDirectory);
     Compiler.setFileManager(FileMgr);
     Compiler.createSourceManager(*FileMgr);
@@ -139,6 +148,14 @@ public:
     return Result;
   }
 
+  // The dependencies of the host and of the device compiles of an offloading
+  // compilation, e.g. with -fsycl, are scanned by one run, which reuses the
+  // minimized sources of the worker filesystem. The full output describes a
+  // single compiler invocation, so it is computed for the first job only.
+  bool runsAllCompilerJobs() const override {
+    return Format == ScanningOutputFormat::Make;
+  }
+
 private:
   StringRef WorkingDirectory;
   DependencyConsumer &Consumer;
@@ -347,6 +347,22 @@ bool ToolInvocation::run() {
       Driver->BuildCompilation(llvm::makeArrayRef(Argv)));
   if (!Compilation)
     return false;
+  if (Action->runsAllCompilerJobs() && Compilation->getJobs().size() > 1) {
+    bool Success = true;
+    bool RanCompilerJob = false;
+    for (const driver::Command &Job : Compilation->getJobs()) {
+      const llvm::opt::ArgStringList &CC1Args = Job.getArguments();
+      if (CC1Args.empty() || StringRef(CC1Args.front()) != "-cc1")
+        continue;
+      RanCompilerJob = true;
+      std::unique_ptr<CompilerInvocation> Invocation(
+          newInvocation(&Diagnostics, CC1Args, BinaryName));
+      Success &= runInvocation(BinaryName, Compilation.get(),
+                               std::move(Invocation), PCHContainerOps);
+    }
+    if (RanCompilerJob)
+      return Success;
+  }
   const llvm::opt::ArgStringList *const CC1Args = getCC1Arguments(
       &Diagnostics, Compilation.get());
   if (!CC1Args)
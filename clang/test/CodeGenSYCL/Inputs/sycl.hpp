@@ -104,6 +104,13 @@ struct buffer_location {
 } // namespace INTEL
 
 namespace ONEAPI {
+namespace property {
+// Compile time known accessor property
+struct no_offset {
+  template <bool B = true> class instance {};
+};
+} // namespace property
+
 template <typename... properties>
 class accessor_property_list {};
 } // namespace ONEAPI
@@ -168,6 +175,9 @@ public:
 private:
   void __init(__attribute__((opencl_global)) dataT *Ptr, range<dimensions> AccessRange,
               range<dimensions> MemRange, id<dimensions> Offset) {}
+  void __init_no_offset(__attribute__((opencl_global)) dataT *Ptr,
+                        range<dimensions> AccessRange,
+                        range<dimensions> MemRange) {}
   void __init_esimd(__attribute__((opencl_global)) dataT *Ptr) {}
 };
 
@@ -0,0 +1,42 @@
+// RUN: %clang_cc1 -fsycl -fsycl-is-device -triple spir64-unknown-unknown-sycldevice -fsycl-int-header=%t.h %s -emit-llvm -o - | FileCheck %s
+// RUN: FileCheck -input-file=%t.h %s --check-prefix=INT-HEADER
+
+// This test checks that accessors with the no_offset property are initialized
+// without their offset, which is not a kernel argument then.
+
+#include "Inputs/sycl.hpp"
+
+// CHECK: define {{.*}}spir_kernel void @{{.*}}kernel_no_offset
+// CHECK-SAME: i32 addrspace(1)* [[MEM_ARG1:%[a-zA-Z0-9_]+]],
+// CHECK-SAME: %"struct.{{.*}}.cl::sycl::range"* byval{{.*}}align 4 [[ACC_RANGE1:%[a-zA-Z0-9_]+_1]],
+// CHECK-SAME: %"struct.{{.*}}.cl::sycl::range"* byval{{.*}}align 4 [[MEM_RANGE1:%[a-zA-Z0-9_]+_2]],
+// CHECK-SAME: i32 addrspace(1)* [[MEM_ARG2:%[a-zA-Z0-9_]+_3]],
+// CHECK-SAME: %"struct.{{.*}}.cl::sycl::range"* byval{{.*}}align 4 [[ACC_RANGE2:%[a-zA-Z0-9_]+_4]],
+// CHECK-SAME: %"struct.{{.*}}.cl::sycl::range"* byval{{.*}}align 4 [[MEM_RANGE2:%[a-zA-Z0-9_]+_5]],
+// CHECK-SAME: %"struct.{{.*}}.cl::sycl::id"* byval{{.*}}align 4 [[OFFSET2:%[a-zA-Z0-9_]+_6]])
+// CHECK: call spir_func void @{{.*}}__init_no_offset
+// CHECK: call spir_func void @{{.*}}__init
+
+// INT-HEADER: const kernel_param_desc_t kernel_signatures[] = {
+// INT-HEADER-NEXT:   //--- _ZTSZ4mainE16kernel_no_offset
+// INT-HEADER-NEXT:   { kernel_param_kind_t::kind_accessor, 36830, 0 },
+// INT-HEADER-NEXT:   { kernel_param_kind_t::kind_accessor, 4062, 12 },
+// INT-HEADER-EMPTY:
+// INT-HEADER-NEXT: };
+
+int main() {
+  cl::sycl::accessor<int, 1, cl::sycl::access::mode::read_write,
+                     cl::sycl::access::target::global_buffer,
+                     cl::sycl::access::placeholder::false_t,
+                     cl::sycl::ONEAPI::accessor_property_list<
+                         cl::sycl::ONEAPI::property::no_offset::instance<>>>
+      NoOffsetAcc;
+  cl::sycl::accessor<int, 1, cl::sycl::access::mode::read_write>
+      OffsetAcc;
+  cl::sycl::kernel_single_task<class kernel_no_offset>(
+      [=]() {
+        NoOffsetAcc.use();
+        OffsetAcc.use();
+      });
+  return 0;
+}
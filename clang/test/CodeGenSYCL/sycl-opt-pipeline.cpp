@@ -0,0 +1,23 @@
+// RUN: %clang_cc1 -fsycl -fsycl-is-device -triple spir64-unknown-unknown-sycldevice -O2 -mllvm -sycl-opt -emit-llvm %s -o - | FileCheck %s
+
+// Check that the SYCL optimization mode rewrites the accesses through generic
+// pointers whose address space is known.
+
+template <typename name, typename Func>
+__attribute__((sycl_kernel)) void kernel_single_task(const Func &kernelFunc) {
+  kernelFunc();
+}
+
+void store(int *Ptr, int Value) { *Ptr = Value; }
+
+int main() {
+  __attribute__((opencl_global)) int *Global = nullptr;
+  // CHECK-LABEL: define {{.*}}spir_kernel void @{{.*}}kernel_function
+  // CHECK-NOT: addrspacecast
+  // CHECK: store i32 42, i32 addrspace(1)*
+  kernel_single_task<class kernel_function>([=]() {
+    int *Ptr = Global;
+    store(Ptr, 42);
+  });
+  return 0;
+}
@@ -353,6 +353,12 @@
 // CHECK-AR-TGT2-LIST: openmp-x86_64-pc-linux-gnu.{{.+}}.bundle3.o
 // CHECK-AR-TGT2-LIST: openmp-x86_64-pc-linux-gnu.{{.+}}.bundle4.o
 
+// Check that the objects of the archive unbundled in parallel are the same as
+// the ones unbundled serially, in the same order.
+// RUN: clang-offload-bundler -jobs=1 -type=a -targets=host-%itanium_abi_triple,openmp-powerpc64le-ibm-linux-gnu,openmp-x86_64-pc-linux-gnu -outputs=%t.host.serial.a,%t.tgt1.serial.a,%t.tgt2.serial.a -inputs=%t.a -unbundle
+// RUN: cmp %t.tgt1.a %t.tgt1.serial.a
+// RUN: cmp %t.tgt2.a %t.tgt2.serial.a
+
 // Some code so that we can create a binary out of this file.
 int A = 0;
 void test_func(void) {
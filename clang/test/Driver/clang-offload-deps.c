@@ -49,5 +49,26 @@
 // CHECK-EMPTY-SPIR64: target triple = "spir64"
 // CHECK-EMPTY-SPIR64-NOT: @llvm.used
 
+//
+// Check that with -sycl-kernel-gc only the SYCL target symbols the host image
+// references by name are kept, and the other ones are recorded.
+//
+// RUN: %clang -target %itanium_abi_triple -DREFERENCE_FOO -c %s -o %t.host.ref
+// RUN: clang-offload-bundler -type=o -targets=host-%itanium_abi_triple,openmp-x86_64-pc-linux-gnu,sycl-spir64 -inputs=%t.host.ref,%t.x86_64,%t.spir64 -outputs=%t.fat.ref
+// RUN: clang-offload-deps -sycl-kernel-gc -targets=openmp-x86_64-pc-linux-gnu,sycl-spir64 -outputs=%t.gc.x86_64,%t.gc.spir64 %t.fat.ref
+// RUN: llvm-dis -o - %t.gc.x86_64 | FileCheck %s --check-prefixes=CHECK-DEPS-X86_64
+// RUN: llvm-dis -o - %t.gc.spir64 | FileCheck %s --check-prefixes=CHECK-GC-SPIR64
+
+// CHECK-GC-SPIR64: target triple = "spir64"
+// CHECK-GC-SPIR64-NOT: @bar
+// CHECK-GC-SPIR64: @foo = external global i8*
+// CHECK-GC-SPIR64: @llvm.used = appending global [1 x i8*] [i8* bitcast (i8** @foo to i8*)], section "llvm.metadata"
+// CHECK-GC-SPIR64: !sycl.unreferenced.kernels = !{![[BAR:[0-9]+]]}
+// CHECK-GC-SPIR64: ![[BAR]] = !{!"bar"}
+
 void foo(void) {}
 void bar(void) {}
+
+#ifdef REFERENCE_FOO
+const char *FooName = "foo";
+#endif
@@ -0,0 +1,21 @@
+// -------
+// Check that the SYCL device images spanning a page are page-aligned, and
+// that the smaller ones are not.
+//
+// RUN: %python -c "print('x' * 5000)" > %t.tgt
+// RUN: echo 'x' > %t.small.tgt
+// RUN: clang-offload-wrapper -host=x86_64-pc-linux-gnu -kind=sycl -target=spir64-unknown-linux-sycldevice %t.tgt -kind=sycl -target=spir64-unknown-linux-sycldevice %t.small.tgt -o - | llvm-dis | FileCheck %s --check-prefix CHECK-IR
+// CHECK-IR: @.sycl_offloading.0.data = internal unnamed_addr constant [5001 x i8] c"{{x+}}\0A", section "__CLANG_OFFLOAD_BUNDLE__sycl-spir64-unknown-linux-sycldevice", align 4096
+// CHECK-IR: @.sycl_offloading.1.data = internal unnamed_addr constant [2 x i8] c"x\0A", section "__CLANG_OFFLOAD_BUNDLE__sycl-spir64-unknown-linux-sycldevice"{{$}}
+
+// -------
+// Check that the alignment can be changed or disabled.
+//
+// RUN: clang-offload-wrapper -host=x86_64-pc-linux-gnu -kind=sycl -target=spir64-unknown-linux-sycldevice -sycl-image-alignment=2 %t.small.tgt -o - | llvm-dis | FileCheck %s --check-prefix CHECK-ALIGN2
+// CHECK-ALIGN2: @.sycl_offloading.0.data = internal unnamed_addr constant [2 x i8] c"x\0A", section "__CLANG_OFFLOAD_BUNDLE__sycl-spir64-unknown-linux-sycldevice", align 2
+//
+// RUN: clang-offload-wrapper -host=x86_64-pc-linux-gnu -kind=sycl -target=spir64-unknown-linux-sycldevice -sycl-image-alignment=0 %t.tgt -o - | llvm-dis | FileCheck %s --check-prefix CHECK-NOALIGN
+// CHECK-NOALIGN: @.sycl_offloading.0.data = internal unnamed_addr constant [5001 x i8] c"{{x+}}\0A", section "__CLANG_OFFLOAD_BUNDLE__sycl-spir64-unknown-linux-sycldevice"{{$}}
+//
+// RUN: not clang-offload-wrapper -kind=sycl -sycl-image-alignment=3 %t.tgt -o %t.bc 2>&1 | FileCheck %s --check-prefix CHECK-BADALIGN
+// CHECK-BADALIGN: error: -sycl-image-alignment must be a power of two
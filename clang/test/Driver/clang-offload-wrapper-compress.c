@@ -0,0 +1,24 @@
+// REQUIRES: zlib
+
+// -------
+// Check that a compressible SYCL device image is stored compressed, its
+// original size is recorded in the "SYCL/compressed image" property set, and
+// it is not placed into the offload bundle sections.
+//
+// RUN: %python -c "print('Content of device file ' * 64)" > %t.tgt
+// RUN: clang-offload-wrapper -host=x86_64-pc-linux-gnu -kind=sycl -target=spir64-unknown-linux-sycldevice -compress %t.tgt -o - | llvm-dis | FileCheck %s --check-prefix CHECK-IR
+// CHECK-IR-NOT: __CLANG_OFFLOAD_BUNDLE
+// CHECK-IR: @prop = internal unnamed_addr constant [17 x i8] c"UncompressedSize\00"
+// CHECK-IR: @__sycl_offload_prop_sets_arr = internal constant {{.*}} { i8* getelementptr inbounds ([17 x i8], [17 x i8]* @prop, i64 0, i64 0), i8* null, i32 1, i64 1473 }
+// CHECK-IR: @SYCL_PropSetName = internal unnamed_addr constant [22 x i8] c"SYCL/compressed image\00"
+// CHECK-IR: @.sycl_offloading.0.data = internal unnamed_addr constant
+// CHECK-IR-NOT: c"Content of device file
+// CHECK-IR-NOT: __CLANG_OFFLOAD_BUNDLE
+
+// -------
+// Check that an image which does not shrink when compressed is kept as is.
+//
+// RUN: echo 'x' > %t.small.tgt
+// RUN: clang-offload-wrapper -host=x86_64-pc-linux-gnu -kind=sycl -target=spir64-unknown-linux-sycldevice -compress %t.small.tgt -o - | llvm-dis | FileCheck %s --check-prefix CHECK-SMALL
+// CHECK-SMALL-NOT: SYCL/compressed image
+// CHECK-SMALL: @.sycl_offloading.0.data = internal unnamed_addr constant [2 x i8] c"x\0A", section "__CLANG_OFFLOAD_BUNDLE__sycl-spir64-unknown-linux-sycldevice"
@@ -65,6 +65,9 @@
 // CHECK-HELP:                             a_0.bc|a_0.sym|a_0.props|a_0.mnf
 // CHECK-HELP:                             a_1.bin|||
 // CHECK-HELP:   --compile-opts=<string> - compile options passed to the offload runtime
+// CHECK-HELP:   --compress              - Compress SYCL device images with zlib. The runtime decompresses
+// CHECK-HELP:                             an image when it is first used. Compressed images are not
+// CHECK-HELP:                             placed into offload bundle sections.
 // CHECK-HELP:   --desc-name=<name>      - Specifies offload descriptor symbol name: '.<offload kind>.<name>',
 // CHECK-HELP:                             and makes it globally visible
 // CHECK-HELP:   --emit-reg-funcs        - Emit [un-]registration functions
@@ -120,7 +123,7 @@
 // CHECK-IR-DAG: [[SYCL_IMAGETY:%.+]] = type { i16, i8, i8, i8*, i8*, i8*, i8*, i8*, i8*, i8*, [[ENTTY]]*, [[ENTTY]]*, [[PROPSETTY:%.+]]*, [[PROPSETTY]]* }
 // CHECK-IR-DAG: [[PROPSETTY]] = type { i8*, [[PROPTY:%.+]]*, [[PROPTY]]* }
 // CHECK-IR-DAG: [[PROPTY]] = type { i8*, i8*, i32, i64 }
-// CHECK-IR-DAG: [[SYCL_DESCTY:%.+]] = type { i16, i16, [[SYCL_IMAGETY]]*, [[ENTTY]]*, [[ENTTY]]* }
+// CHECK-IR-DAG: [[SYCL_DESCTY:%.+]] = type { i16, i16, [[SYCL_IMAGETY]]*, [[ENTTY]]*, [[ENTTY]]*, %_pi_kernel_name_entry_struct*, %_pi_kernel_name_entry_struct* }
 
 // CHECK-IR: [[ENTBEGIN:@.+]] = external hidden constant [[ENTTY]]
 // CHECK-IR: [[ENTEND:@.+]] = external hidden constant [[ENTTY]]
@@ -145,7 +148,7 @@
 
 // CHECK-IR: [[SYCL_IMAGES:@.+]] = internal unnamed_addr constant [2 x [[SYCL_IMAGETY]]] [{{.*}} { i16 2, i8 4, i8 2, i8* getelementptr inbounds ([4 x i8], [4 x i8]* [[SYCL_TGT0]], i64 0, i64 0), i8* getelementptr inbounds ([3 x i8], [3 x i8]* [[SYCL_COMPILE_OPTS0]], i64 0, i64 0), i8* getelementptr inbounds ([21 x i8], [21 x i8]* [[SYCL_LINK_OPTS0]], i64 0, i64 0), i8* null, i8* null, i8* getelementptr inbounds ([[SYCL_BIN0TY]], [[SYCL_BIN0TY]]* [[SYCL_BIN0]], i64 0, i64 0), i8* getelementptr inbounds ([[SYCL_BIN0TY]], [[SYCL_BIN0TY]]* [[SYCL_BIN0]], i64 1, i64 0), [[ENTTY]]* null, [[ENTTY]]* null, [[PROPSETTY]]* null, [[PROPSETTY]]* null }, [[SYCL_IMAGETY]] { i16 2, i8 4, i8 1, i8* getelementptr inbounds ([4 x i8], [4 x i8]* [[SYCL_TGT1]], i64 0, i64 0), i8* getelementptr inbounds ([1 x i8], [1 x i8]* [[SYCL_COMPILE_OPTS1]], i64 0, i64 0), i8* getelementptr inbounds ([1 x i8], [1 x i8]* [[SYCL_LINK_OPTS1]], i64 0, i64 0), i8* null, i8* null, i8* getelementptr inbounds ([[SYCL_BIN1TY]], [[SYCL_BIN1TY]]* [[SYCL_BIN1]], i64 0, i64 0), i8* getelementptr inbounds ([[SYCL_BIN1TY]], [[SYCL_BIN1TY]]* [[SYCL_BIN1]], i64 1, i64 0), [[ENTTY]]* null, [[ENTTY]]* null, [[PROPSETTY]]* null, [[PROPSETTY]]* null }]
 
-// CHECK-IR: [[SYCL_DESC:@.+]] = internal constant [[SYCL_DESCTY]] { i16 1, i16 2, [[SYCL_IMAGETY]]* getelementptr inbounds ([2 x [[SYCL_IMAGETY]]], [2 x [[SYCL_IMAGETY]]]* [[SYCL_IMAGES]], i64 0, i64 0), [[ENTTY]]* null, [[ENTTY]]* null }
+// CHECK-IR: [[SYCL_DESC:@.+]] = internal constant [[SYCL_DESCTY]] { i16 2, i16 2, [[SYCL_IMAGETY]]* getelementptr inbounds ([2 x [[SYCL_IMAGETY]]], [2 x [[SYCL_IMAGETY]]]* [[SYCL_IMAGES]], i64 0, i64 0), [[ENTTY]]* null, [[ENTTY]]* null, %_pi_kernel_name_entry_struct* null, %_pi_kernel_name_entry_struct* null }
 
 // CHECK-IR: @llvm.global_ctors = appending global [2 x { i32, void ()*, i8* }] [{ i32, void ()*, i8* } { i32 1, void ()* [[OMP_REGFN:@.+]], i8* null }, { i32, void ()*, i8* } { i32 1, void ()* [[SYCL_REGFN:@.+]], i8* null }]
 
@@ -184,10 +187,10 @@
 // CHECK-IR1: source_filename = "offload.wrapper.object"
 // CHECK-IR1: [[IMAGETY:%.+]] = type { i16, i8, i8, i8*, i8*, i8*, i8*, i8*, i8*, i8*, %__tgt_offload_entry*, %__tgt_offload_entry*, %_pi_device_binary_property_set_struct*, %_pi_device_binary_property_set_struct* }
 // CHECK-IR1: [[ENTTY:%.+]] = type { i8*, i8*, i64, i32, i32 }
-// CHECK-IR1: [[DESCTY:%.+]] = type { i16, i16, [[IMAGETY]]*, [[ENTTY]]*, [[ENTTY]]* }
+// CHECK-IR1: [[DESCTY:%.+]] = type { i16, i16, [[IMAGETY]]*, [[ENTTY]]*, [[ENTTY]]*, %_pi_kernel_name_entry_struct*, %_pi_kernel_name_entry_struct* }
 // CHECK-IR1-NOT: @llvm.global_ctors
 // CHECK-IR1-NOT: @llvm.global_dtors
-// CHECK-IR1: @.sycl_offloading.lalala = constant [[DESCTY]] { i16 {{[0-9]+}}, i16 1, [[IMAGETY]]* getelementptr inbounds ([1 x [[IMAGETY]]], [1 x [[IMAGETY]]]* @.sycl_offloading.device_images, i64 0, i64 0), [[ENTTY]]* null, [[ENTTY]]* null }
+// CHECK-IR1: @.sycl_offloading.lalala = constant [[DESCTY]] { i16 {{[0-9]+}}, i16 1, [[IMAGETY]]* getelementptr inbounds ([1 x [[IMAGETY]]], [1 x [[IMAGETY]]]* @.sycl_offloading.device_images, i64 0, i64 0), [[ENTTY]]* null, [[ENTTY]]* null, %_pi_kernel_name_entry_struct* null, %_pi_kernel_name_entry_struct* null }
 
 // -------
 // Check option's effects: -entries
@@ -201,6 +204,23 @@
 // CHECK-IR3: @__sycl_offload_entries_arr = internal constant [2 x %__tgt_offload_entry] [%__tgt_offload_entry { i8* null, i8* getelementptr inbounds ([7 x i8], [7 x i8]* @__sycl_offload_entry_name, i64 0, i64 0), i64 0, i32 0, i32 0 }, %__tgt_offload_entry { i8* null, i8* getelementptr inbounds ([7 x i8], [7 x i8]* @__sycl_offload_entry_name.1, i64 0, i64 0), i64 0, i32 0, i32 0 }]
 // CHECK-IR3: @.sycl_offloading.device_images = internal unnamed_addr constant [1 x %__tgt_device_image] [%__tgt_device_image { {{.*}}, %__tgt_offload_entry* getelementptr inbounds ([2 x %__tgt_offload_entry], [2 x %__tgt_offload_entry]* @__sycl_offload_entries_arr, i64 0, i64 0), %__tgt_offload_entry* getelementptr inbounds ([2 x %__tgt_offload_entry], [2 x %__tgt_offload_entry]* @__sycl_offload_entries_arr, i64 1, i64 0), %_pi_device_binary_property_set_struct* null, %_pi_device_binary_property_set_struct* null }]
 
+// -------
+// Check the kernel name table: every kernel is listed once, sorted by name,
+// along with the index of the first image containing it.
+//
+// RUN: echo -e 'kernelB\nkernelA' > %t1.txt
+// RUN: echo -e 'kernelA\nkernelB' > %t2.txt
+// RUN: echo -e 'kernelC' > %t3.txt
+// RUN: clang-offload-wrapper -host=x86_64-pc-linux-gnu -kind=sycl                 \
+// RUN:   -target=tg1 -entries=%t1.txt %t.tgt -target=tg2 -entries=%t2.txt %t.tgt \
+// RUN:   -target=tg1 -entries=%t3.txt %t.tgt -o - | llvm-dis | FileCheck %s --check-prefix CHECK-IR4
+// CHECK-IR4: [[KNTY:%.+]] = type { i8*, i32 }
+// CHECK-IR4: @__sycl_offload_entry_name = internal unnamed_addr constant [8 x i8] c"kernelB\00"
+// CHECK-IR4: @__sycl_offload_entry_name.1 = internal unnamed_addr constant [8 x i8] c"kernelA\00"
+// CHECK-IR4: @__sycl_offload_entry_name.4 = internal unnamed_addr constant [8 x i8] c"kernelC\00"
+// CHECK-IR4: @__sycl_offload_kernel_names = internal constant [3 x [[KNTY]]] [[[KNTY]] { i8* getelementptr inbounds ([8 x i8], [8 x i8]* @__sycl_offload_entry_name.1, i64 0, i64 0), i32 0 }, [[KNTY]] { i8* getelementptr inbounds ([8 x i8], [8 x i8]* @__sycl_offload_entry_name, i64 0, i64 0), i32 0 }, [[KNTY]] { i8* getelementptr inbounds ([8 x i8], [8 x i8]* @__sycl_offload_entry_name.4, i64 0, i64 0), i32 2 }]
+// CHECK-IR4: @.sycl_offloading.descriptor = internal constant %__tgt_bin_desc { i16 2, i16 3, {{.*}}, [[KNTY]]* getelementptr inbounds ([3 x [[KNTY]]], [3 x [[KNTY]]]* @__sycl_offload_kernel_names, i64 0, i64 0), [[KNTY]]* getelementptr inbounds ([3 x [[KNTY]]], [3 x [[KNTY]]]* @__sycl_offload_kernel_names, i64 1, i64 0) }
+
 // -------
 // Check that device image can be extracted from the wrapper object by the clang-offload-bundler tool.
 //
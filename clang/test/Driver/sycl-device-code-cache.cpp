@@ -0,0 +1,12 @@
+/// Check that the device code cache option is accepted by both drivers and
+/// does not change the commands to run: the cached device code is reused at
+/// execution time.
+// RUN: %clang -### -fsycl -fsycl-device-code-cache-dir=%t.cache %s 2>&1 \
+// RUN:   | FileCheck %s
+// RUN: %clang_cl -### -fsycl -fsycl-device-code-cache-dir=%t.cache %s 2>&1 \
+// RUN:   | FileCheck %s
+// CHECK-NOT: argument unused
+// CHECK-NOT: unknown argument
+// CHECK: sycl-post-link{{.*}}
+// CHECK: clang-offload-wrapper{{.*}}
+// CHECK-NOT: fsycl-device-code-cache-dir
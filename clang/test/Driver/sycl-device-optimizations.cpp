@@ -46,3 +46,41 @@
 // RUN:   %clang -### -fsycl -fvectorize -fslp-vectorize %s 2>&1 \
 // RUN:   | FileCheck -check-prefix=CHECK-VEC-ENABLE %s
 // CHECK-VEC-ENABLE: clang{{.*}} "-fsycl-is-device"{{.*}}"-vectorize-loops"{{.*}}"-vectorize-slp"
+
+/// Check that device images are compressed only when requested and never for
+/// FPGA:
+// RUN:   %clang -### -fsycl -fsycl-compress-device-images %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHECK-COMPRESS %s
+// RUN:   %clang_cl -### -fsycl -fsycl-compress-device-images %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHECK-COMPRESS %s
+// CHECK-COMPRESS: clang-offload-wrapper{{.*}} "-compress"
+// RUN:   %clang -### -fsycl %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHECK-NO-COMPRESS %s
+// RUN:   %clang -### -fsycl -fsycl-compress-device-images \
+// RUN:     -fno-sycl-compress-device-images %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHECK-NO-COMPRESS %s
+// RUN:   %clang -### -fsycl -fintelfpga -fsycl-compress-device-images %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHECK-NO-COMPRESS %s
+// CHECK-NO-COMPRESS-NOT: clang-offload-wrapper{{.*}} "-compress"
+
+/// Check that spec constants are emulated in AOT device code only when
+/// requested:
+// RUN:   %clang -### -fsycl -fsycl-targets=spir64_gen-unknown-unknown-sycldevice \
+// RUN:     -fsycl-emulate-spec-constants %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHECK-SC-EMULATION %s
+// RUN:   %clang_cl -### -fsycl \
+// RUN:     -fsycl-targets=spir64_gen-unknown-unknown-sycldevice \
+// RUN:     -fsycl-emulate-spec-constants %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHECK-SC-EMULATION %s
+// CHECK-SC-EMULATION: sycl-post-link{{.*}} "-spec-const=emulation"
+// RUN:   %clang -### -fsycl -fsycl-targets=spir64_gen-unknown-unknown-sycldevice \
+// RUN:     %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHECK-SC-DEFAULT %s
+// RUN:   %clang -### -fsycl -fsycl-targets=spir64_gen-unknown-unknown-sycldevice \
+// RUN:     -fsycl-emulate-spec-constants -fno-sycl-emulate-spec-constants %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHECK-SC-DEFAULT %s
+// CHECK-SC-DEFAULT: sycl-post-link{{.*}} "-spec-const=default"
+/// JIT device code keeps setting spec constants natively:
+// RUN:   %clang -### -fsycl -fsycl-emulate-spec-constants %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHECK-SC-RT %s
+// CHECK-SC-RT: sycl-post-link{{.*}} "-spec-const=rt"
@@ -55,3 +55,18 @@
 // CHK-PHASES: 13: backend, {12}, assembler, (device-sycl, sm_35)
 // CHK-PHASES: 14: clang-offload-wrapper, {13}, object, (device-sycl, sm_35)
 // CHK-PHASES: 15: offload, "host-sycl (x86_64-unknown-linux-gnu)" {9}, "device-sycl (nvptx64-nvidia-nvcl-sycldevice:sm_35)" {14}, image
+
+/// Check that the code of every compute capability is assembled to SASS and
+/// bundled with its PTX in a single fat binary for the CUDA OS.
+// RUN: %clangxx -### -std=c++11 -target x86_64-unknown-linux-gnu -fsycl \
+// RUN: -fsycl-targets=nvptx64-nvidia-cuda-sycldevice --cuda-path=%S/Inputs/CUDA_111/usr/local/cuda \
+// RUN: -fsycl-libspirv-path=%S/Inputs/SYCL/libspirv.bc \
+// RUN: -Xsycl-target-backend --cuda-gpu-arch=sm_70 \
+// RUN: -Xsycl-target-backend --cuda-gpu-arch=sm_80 %s 2>&1 \
+// RUN: | FileCheck -check-prefix=CHK-SASS %s
+// CHK-SASS-DAG: ptxas{{.*}} "--gpu-name" "sm_70"
+// CHK-SASS-DAG: ptxas{{.*}} "--gpu-name" "sm_80"
+// CHK-SASS: fatbinary{{.*}} "--image=profile=sm_70,{{.*}}" "--image=profile=compute_70,{{.*}}" "--image=profile=sm_80,{{.*}}" "--image=profile=compute_80,{{.*}}"
+// CHK-SASS-NOT: fatbinary
+// CHK-SASS: clang-offload-wrapper"{{.*}} "-target=nvptx64" "-kind=sycl"
+// CHK-SASS-NOT: clang-offload-wrapper"
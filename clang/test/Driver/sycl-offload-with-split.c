@@ -278,6 +278,28 @@
 // RUN:    | FileCheck %s -check-prefixes=CHK-ONE-KERNEL
 // CHK-ONE-KERNEL: sycl-post-link{{.*}} "-split=kernel"{{.*}} "-o"{{.*}}
 
+// Check -fsycl-device-code-split=by_size option passing.
+// RUN:   %clang -### -fsycl -fsycl-device-code-split=by_size %s 2>&1 \
+// RUN:    | FileCheck %s -check-prefixes=CHK-BY-SIZE
+// RUN:   %clang_cl -### -fsycl -fsycl-device-code-split=by_size %s 2>&1 \
+// RUN:    | FileCheck %s -check-prefixes=CHK-BY-SIZE
+// CHK-BY-SIZE: sycl-post-link{{.*}} "-split=size"{{.*}} "-o"{{.*}}
+
+// Check that the ESIMD kernels are split from the SYCL kernels.
+// RUN:   %clang -### -fsycl -fsycl-explicit-simd %s 2>&1 \
+// RUN:    | FileCheck %s -check-prefixes=CHK-SPLIT-ESIMD
+// RUN:   %clang -### -fsycl -fsycl-explicit-simd -fsycl-device-code-split=per_kernel %s 2>&1 \
+// RUN:    | FileCheck %s -check-prefixes=CHK-SPLIT-ESIMD
+// RUN:   %clang -### -fsycl %s 2>&1 \
+// RUN:    | FileCheck %s -check-prefixes=CHK-NO-SPLIT-ESIMD
+// CHK-SPLIT-ESIMD: sycl-post-link{{.*}} "-split-esimd"{{.*}} "-o"{{.*}}
+// CHK-NO-SPLIT-ESIMD-NOT: sycl-post-link{{.*}} "-split-esimd"
+
+// Check -fsycl-sub-group-size-variants option passing.
+// RUN:   %clang -### -fsycl -fsycl-sub-group-size-variants=8,16,32 %s 2>&1 \
+// RUN:    | FileCheck %s -check-prefixes=CHK-SG-VARIANTS
+// CHK-SG-VARIANTS: sycl-post-link{{.*}} "-sub-group-size-variants=8,16,32"{{.*}} "-o"{{.*}}
+
 // Check no device code split mode.
 // RUN:   %clang -### -fsycl -fsycl-device-code-split -fsycl-device-code-split=off %s 2>&1 \
 // RUN:    | FileCheck %s -check-prefixes=CHK-NO-SPLIT
@@ -0,0 +1,22 @@
+/// Check that -fsycl-pch uses the SYCL headers precompiled for the target of
+/// each of the host and device compiles, when they are installed.
+// RUN: rm -rf %t && mkdir -p %t/bin %t/include/sycl/CL
+// RUN: touch %t/include/sycl/CL/sycl.hpp.spir64-unknown-unknown-sycldevice.pch
+// RUN: touch %t/include/sycl/CL/sycl.hpp.x86_64-unknown-linux-gnu.pch
+// RUN: %clang -### -fsycl -fsycl-pch -target x86_64-unknown-linux-gnu \
+// RUN:   -ccc-install-dir %t/bin -c %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHK-PCH %s
+// CHK-PCH: clang{{.*}} "-triple" "spir64-unknown-unknown-sycldevice"{{.*}} "-include-pch" "{{.*}}sycl.hpp.spir64-unknown-unknown-sycldevice.pch"
+// CHK-PCH: clang{{.*}} "-include-pch" "{{.*}}sycl.hpp.x86_64-unknown-linux-gnu.pch"{{.*}} "-fsycl-is-host"
+
+/// The precompiled headers are not used by default, nor when they are not
+/// installed for the target.
+// RUN: %clang -### -fsycl -target x86_64-unknown-linux-gnu \
+// RUN:   -ccc-install-dir %t/bin -c %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHK-NO-PCH %s
+// RUN: rm %t/include/sycl/CL/sycl.hpp.spir64-unknown-unknown-sycldevice.pch
+// RUN: rm %t/include/sycl/CL/sycl.hpp.x86_64-unknown-linux-gnu.pch
+// RUN: %clang -### -fsycl -fsycl-pch -target x86_64-unknown-linux-gnu \
+// RUN:   -ccc-install-dir %t/bin -c %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHK-NO-PCH %s
+// CHK-NO-PCH-NOT: "-include-pch"
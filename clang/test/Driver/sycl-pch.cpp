@@ -0,0 +1,17 @@
+/// Check that the transparent precompiled header lookup of -include uses the
+/// precompiled header of the host for the host compile, and the one built for
+/// the device target for the device compile.
+// RUN: touch %t.h.pch %t.h.spir64-unknown-unknown-sycldevice.pch
+// RUN: %clang -### -fsycl -include %t.h -c %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHK-PCH %s
+// CHK-PCH: clang{{.*}} "-triple" "spir64-unknown-unknown-sycldevice"{{.*}} "-include-pch" "{{.*}}.h.spir64-unknown-unknown-sycldevice.pch"
+// CHK-PCH: clang{{.*}} "-include-pch" "{{.*}}.h.pch"{{.*}} "-fsycl-is-host"
+
+/// Without a precompiled header for the device, the device compile includes
+/// the header rather than the precompiled header of the host.
+// RUN: rm %t.h.spir64-unknown-unknown-sycldevice.pch
+// RUN: %clang -### -fsycl -include %t.h -c %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHK-NO-DEVICE-PCH %s
+// CHK-NO-DEVICE-PCH: clang{{.*}} "-triple" "spir64-unknown-unknown-sycldevice"{{.*}} "-include" "{{.*}}.h"
+// CHK-NO-DEVICE-PCH-NOT: "-include-pch"
+// CHK-NO-DEVICE-PCH: clang{{.*}} "-include-pch" "{{.*}}.h.pch"{{.*}} "-fsycl-is-host"
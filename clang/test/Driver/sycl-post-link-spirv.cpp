@@ -0,0 +1,55 @@
+/// Check that sycl-post-link translates the device code to SPIR-V in place of
+/// llvm-spirv with -fsycl-post-link-spirv
+
+/// JIT: the file table of sycl-post-link is wrapped as is
+// RUN:   %clang -target x86_64-unknown-linux-gnu -ccc-print-phases -fsycl \
+// RUN:     -fno-sycl-device-lib=all -fsycl-post-link-spirv %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHK-PHASES-JIT %s
+// CHK-PHASES-JIT: 11: linker, {10}, ir, (device-sycl)
+// CHK-PHASES-JIT: 12: sycl-post-link, {11}, tempfiletable, (device-sycl)
+// CHK-PHASES-JIT: 13: clang-offload-wrapper, {12}, object, (device-sycl)
+// CHK-PHASES-JIT-NOT: llvm-spirv
+
+/// AOT: sycl-post-link outputs the SPIR-V module for the backend compiler
+// RUN:   %clang -target x86_64-unknown-linux-gnu -ccc-print-phases -fsycl \
+// RUN:     -fno-sycl-device-lib=all -fsycl-post-link-spirv \
+// RUN:     -fsycl-targets=spir64_gen-unknown-unknown-sycldevice %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHK-PHASES-AOT %s
+// CHK-PHASES-AOT: 11: linker, {10}, ir, (device-sycl)
+// CHK-PHASES-AOT: 12: sycl-post-link, {11}, spirv, (device-sycl)
+// CHK-PHASES-AOT: 13: backend-compiler, {12}, image, (device-sycl)
+// CHK-PHASES-AOT: 14: clang-offload-wrapper, {13}, object, (device-sycl)
+
+/// AOT with device code split: the SPIR-V files are extracted from the table
+// RUN:   %clang -target x86_64-unknown-linux-gnu -ccc-print-phases -fsycl \
+// RUN:     -fno-sycl-device-lib=all -fsycl-post-link-spirv \
+// RUN:     -fsycl-device-code-split=per_kernel \
+// RUN:     -fsycl-targets=spir64_gen-unknown-unknown-sycldevice %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHK-PHASES-AOT-SPLIT %s
+// CHK-PHASES-AOT-SPLIT: 12: sycl-post-link, {11}, tempfiletable, (device-sycl)
+// CHK-PHASES-AOT-SPLIT: 13: file-table-tform, {12}, tempfilelist, (device-sycl)
+// CHK-PHASES-AOT-SPLIT: 14: backend-compiler, {13}, tempfilelist, (device-sycl)
+// CHK-PHASES-AOT-SPLIT: 15: file-table-tform, {12, 14}, tempfiletable, (device-sycl)
+// CHK-PHASES-AOT-SPLIT: 16: clang-offload-wrapper, {15}, object, (device-sycl)
+
+/// The translator options are passed to sycl-post-link
+// RUN:   %clang -### -target x86_64-unknown-linux-gnu -fsycl \
+// RUN:     -fsycl-post-link-spirv %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHK-TOOLS %s
+// RUN:   %clang_cl -### -fsycl -fsycl-post-link-spirv %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHK-TOOLS %s
+// CHK-TOOLS: sycl-post-link{{.*}} "-emit-spirv" "-spirv-ext=+all,-SPV_INTEL_usm_storage_classes"
+// CHK-TOOLS-NOT: llvm-spirv{{.*}}
+// RUN:   %clang -### -target x86_64-unknown-linux-gnu -fsycl \
+// RUN:     -fsycl-explicit-simd -fsycl-post-link-spirv %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHK-ESIMD %s
+// CHK-ESIMD: sycl-post-link{{.*}} "-emit-spirv" "-spirv-allow-unknown-intrinsics"
+
+/// llvm-spirv is still used by default
+// RUN:   %clang -### -target x86_64-unknown-linux-gnu -fsycl %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHK-DEFAULT %s
+// RUN:   %clang -### -target x86_64-unknown-linux-gnu -fsycl \
+// RUN:     -fsycl-post-link-spirv -fno-sycl-post-link-spirv %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHK-DEFAULT %s
+// CHK-DEFAULT-NOT: "-emit-spirv"
+// CHK-DEFAULT: llvm-spirv{{.*}}
@@ -39,11 +39,13 @@
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/StringSaver.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
@@ -120,6 +122,12 @@ static cl::opt<unsigned>
                     cl::desc("Alignment of bundle for binary files"),
                     cl::init(1), cl::cat(ClangOffloadBundlerCategory));
 
+static cl::opt<unsigned>
+    NumThreads("jobs",
+               cl::desc("Number of threads unbundling the objects of an "
+                        "archive, 0 to use all the hardware threads\n"),
+               cl::init(0), cl::cat(ClangOffloadBundlerCategory));
+
 /// Magic string that marks the existence of offloading data.
 #define OFFLOAD_BUNDLER_MAGIC_STR "__CLANG_OFFLOAD_BUNDLE__"
 
@@ -174,6 +182,17 @@ public:
   virtual Expected<Optional<StringRef>>
   ReadBundleStart(MemoryBuffer &Input) = 0;
 
+  /// Whether the handler has an index of the bundles of the file, so that they
+  /// can be looked up with FindBundle instead of being read in order with
+  /// ReadBundleStart.
+  virtual bool IsIndexed() const { return false; }
+
+  /// Make the bundle for \a Triple the current one, as ReadBundleStart does
+  /// when it reaches it. Returns false if the file has no such bundle.
+  virtual bool FindBundle(StringRef Triple) {
+    llvm_unreachable("the bundles of the file are not indexed");
+  }
+
   /// Read the marker that closes the current bundle.
   virtual Error ReadBundleEnd(MemoryBuffer &Input) = 0;
 
@@ -354,6 +373,13 @@ public:
     return CurBundleInfo->first();
   }
 
+  bool IsIndexed() const final { return true; }
+
+  bool FindBundle(StringRef Triple) final {
+    CurBundleInfo = BundlesInfo.find(Triple);
+    return CurBundleInfo != BundlesInfo.end();
+  }
+
   Error ReadBundleEnd(MemoryBuffer &Input) final {
     assert(CurBundleInfo != BundlesInfo.end() && "Invalid reader info!");
     return Error::success();
@@ -723,6 +749,13 @@ public:
     return CurBundle->getKey();
   }
 
+  bool IsIndexed() const final { return true; }
+
+  bool FindBundle(StringRef Triple) final {
+    CurBundle = TripleToBundleInfo.find(Triple);
+    return CurBundle != TripleToBundleInfo.end();
+  }
+
   Error ReadBundleEnd(MemoryBuffer &Input) final { return Error::success(); }
 
   Error ReadBundle(raw_ostream &OS, MemoryBuffer &Input) final {
@@ -1062,18 +1095,40 @@ public:
   }
 };
 
+/// Call \a Fn for all the indices in [0, \a N) in parallel, and return the
+/// errors it fails with joined in the order of the indices.
+static Error parallelForEachNError(size_t N, function_ref<Error(size_t)> Fn) {
+  std::vector<Optional<Error>> Errs(N);
+  parallelForEachN(0, N, [&](size_t I) { Errs[I] = Fn(I); });
+  Error Err = Error::success();
+  for (Optional<Error> &E : Errs)
+    Err = joinErrors(std::move(Err), std::move(*E));
+  return Err;
+}
+
 /// Archive file handler. Only unbundling is supported so far.
 class ArchiveFileHandler final : public FileHandler {
   /// Archive we are dealing with.
   std::unique_ptr<Archive> Ar;
 
-  /// Union of bundle names from all object. The value is a count of how many
-  /// times we've seen the bundle in the archive object(s).
-  StringMap<unsigned> Bundles;
+  /// An object file of the archive, with the handler of its bundles.
+  struct ObjectMember {
+    StringRef Name;
+    std::unique_ptr<MemoryBuffer> Buf;
+    std::unique_ptr<ObjectFileHandler> OFH;
+  };
+
+  /// Object files of the archive, in the order of the archive.
+  std::vector<ObjectMember> Members;
+
+  /// Union of bundle names from all objects. The value is the list of indices
+  /// in Members of the objects which have the bundle, so that extracting a
+  /// bundle doesn't scan the other objects.
+  StringMap<SmallVector<unsigned, 8u>> Bundles;
 
   /// Iterators over the bundle names.
-  StringMap<unsigned>::iterator CurrBundle = Bundles.end();
-  StringMap<unsigned>::iterator NextBundle = Bundles.end();
+  StringMap<SmallVector<unsigned, 8u>>::iterator CurrBundle = Bundles.end();
+  StringMap<SmallVector<unsigned, 8u>>::iterator NextBundle = Bundles.end();
 
   /// Output mode for the archive unbundler.
   enum class OutputType {
@@ -1101,7 +1156,8 @@ public:
       return ArOrErr.takeError();
     Ar = std::move(*ArOrErr);
 
-    // Read all children.
+    // Collect all the object children. The members reference the archive
+    // buffer, which is mapped rather than read when it is large.
     Error Err = Error::success();
     for (auto &C : Ar->children(Err)) {
       auto BinOrErr = C.getAsBinary();
@@ -1115,25 +1171,39 @@ public:
       if (!Bin->isObject())
         continue;
 
+      auto ChildNameOrErr = C.getName();
+      if (!ChildNameOrErr)
+        return ChildNameOrErr.takeError();
+
       auto Obj = std::unique_ptr<ObjectFile>(cast<ObjectFile>(Bin.release()));
-      auto Buf = MemoryBuffer::getMemBuffer(Obj->getMemoryBufferRef(), false);
+      ObjectMember M;
+      M.Name = *ChildNameOrErr;
+      M.Buf = MemoryBuffer::getMemBuffer(Obj->getMemoryBufferRef(), false);
+      M.OFH = std::make_unique<ObjectFileHandler>(std::move(Obj));
+      Members.push_back(std::move(M));
+    }
+    if (Err)
+      return Err;
 
-      // Collect the list of bundles from the object.
-      ObjectFileHandler OFH(std::move(Obj));
-      if (Error Err = OFH.ReadHeader(*Buf))
-        return Err;
-      Expected<Optional<StringRef>> NameOrErr = OFH.ReadBundleStart(*Buf);
+    // Read the list of bundles of the objects in parallel.
+    if (Error Err = parallelForEachNError(Members.size(), [&](size_t I) {
+          return Members[I].OFH->ReadHeader(*Members[I].Buf);
+        }))
+      return Err;
+
+    // Index the bundles, in the order of the objects.
+    for (unsigned I = 0; I < Members.size(); ++I) {
+      ObjectMember &M = Members[I];
+      Expected<Optional<StringRef>> NameOrErr = M.OFH->ReadBundleStart(*M.Buf);
       if (!NameOrErr)
         return NameOrErr.takeError();
       while (*NameOrErr) {
-        ++Bundles[**NameOrErr];
-        NameOrErr = OFH.ReadBundleStart(*Buf);
+        Bundles[**NameOrErr].push_back(I);
+        NameOrErr = M.OFH->ReadBundleStart(*M.Buf);
         if (!NameOrErr)
           return NameOrErr.takeError();
       }
     }
-    if (Err)
-      return Err;
 
     CurrBundle = Bundles.end();
     NextBundle = Bundles.begin();
@@ -1147,13 +1217,21 @@ public:
     return CurrBundle->first();
   }
 
+  bool IsIndexed() const override { return true; }
+
+  bool FindBundle(StringRef Triple) override {
+    CurrBundle = Bundles.find(Triple);
+    return CurrBundle != Bundles.end();
+  }
+
   Error ReadBundleEnd(MemoryBuffer &Input) override { return Error::success(); }
 
   Error ReadBundle(raw_ostream &OS, MemoryBuffer &Input) override {
-    assert(CurrBundle->second && "attempt to extract nonexistent bundle");
+    const SmallVectorImpl<unsigned> &MemberIdxs = CurrBundle->second;
+    assert(!MemberIdxs.empty() && "attempt to extract nonexistent bundle");
 
     // In single-file mode we do not expect to see bundle more than once.
-    if (Mode == OutputType::Object && CurrBundle->second > 1)
+    if (Mode == OutputType::Object && MemberIdxs.size() > 1)
       return createStringError(
           errc::invalid_argument,
           "'ao' file type is requested, but the archive contains multiple "
@@ -1165,45 +1243,27 @@ public:
       return Error::success();
     }
 
-    // Extracted objects data for archive mode.
-    SmallVector<std::string, 8u> ArNames;
-    SmallVector<SmallVector<char, 0u>, 8u> ArData;
-    SmallVector<NewArchiveMember, 8u> ArMembers;
-
-    // Read all children.
-    Error Err = Error::success();
-    for (auto &C : Ar->children(Err)) {
-      auto BinOrErr = C.getAsBinary();
-      if (!BinOrErr) {
-        if (auto Err = isNotObjectErrorInvalidFileType(BinOrErr.takeError()))
-          return Err;
-        continue;
-      }
-
-      auto &Bin = BinOrErr.get();
-      if (!Bin->isObject())
-        continue;
-
-      auto Obj = std::unique_ptr<ObjectFile>(cast<ObjectFile>(Bin.release()));
-      auto Buf = MemoryBuffer::getMemBuffer(Obj->getMemoryBufferRef(), false);
-
-      auto ChildNameOrErr = C.getName();
-      if (!ChildNameOrErr)
-        return ChildNameOrErr.takeError();
-
-      ObjectFileHandler OFH(std::move(Obj));
-      if (Error Err = OFH.ReadHeader(*Buf))
+    // Extract the bundle from the single object to the output file.
+    StringRef Triple = CurrBundle->first();
+    if (Mode == OutputType::Object) {
+      ObjectMember &M = Members[MemberIdxs.front()];
+      M.OFH->FindBundle(Triple);
+      if (Error Err = M.OFH->ReadBundle(OS, *M.Buf))
         return Err;
-      Expected<Optional<StringRef>> NameOrErr = OFH.ReadBundleStart(*Buf);
-      if (!NameOrErr)
-        return NameOrErr.takeError();
-      while (*NameOrErr) {
-        auto TT = **NameOrErr;
-        if (TT == CurrBundle->first()) {
-          // This is the bundle we are looking for.
+      return M.OFH->ReadBundleEnd(*M.Buf);
+    }
+
+    // Otherwise extract the bundles of the objects in parallel, to temporary
+    // files in file list mode or to memory in archive mode, and write the
+    // output in the order of the archive.
+    std::vector<SmallString<128u>> ChildFileNames(MemberIdxs.size());
+    std::vector<SmallVector<char, 0u>> ArData(MemberIdxs.size());
+    if (Error Err = parallelForEachNError(MemberIdxs.size(), [&](size_t I) {
+          ObjectMember &M = Members[MemberIdxs[I]];
+          M.OFH->FindBundle(Triple);
           if (Mode == OutputType::FileList) {
             // Create temporary file where the device part will be extracted to.
-            SmallString<128u> ChildFileName;
+            SmallString<128u> &ChildFileName = ChildFileNames[I];
             auto EC = sys::fs::createTemporaryFile(TempFileNameBase, "o",
                                                    ChildFileName);
             if (EC)
@@ -1213,57 +1273,50 @@ public:
             if (EC)
               return createFileError(ChildFileName, EC);
 
-            if (Error Err = OFH.ReadBundle(ChildOS, *Buf))
+            if (Error Err = M.OFH->ReadBundle(ChildOS, *M.Buf))
               return Err;
 
             if (ChildOS.has_error())
               return createFileError(ChildFileName, ChildOS.error());
-
-            // Add temporary file name with the device part to the output file
-            // list.
-            OS << ChildFileName << "\n";
-          } else if (Mode == OutputType::Object) {
-            // Extract the bundle to the output file in single file mode.
-            if (Error Err = OFH.ReadBundle(OS, *Buf))
-              return Err;
-          } else if (Mode == OutputType::Archive) {
-            auto &Name =
-                ArNames.emplace_back((TT + "." + *ChildNameOrErr).str());
-            auto &Data = ArData.emplace_back();
-            raw_svector_ostream ChildOS{Data};
-
-            // Extract the bundle.
-            if (Error Err = OFH.ReadBundle(ChildOS, *Buf))
+          } else {
+            raw_svector_ostream ChildOS{ArData[I]};
+            if (Error Err = M.OFH->ReadBundle(ChildOS, *M.Buf))
               return Err;
-
-            ArMembers.emplace_back(
-                MemoryBufferRef{StringRef(Data.data(), Data.size()), Name});
           }
-          if (Error Err = OFH.ReadBundleEnd(*Buf))
-            return Err;
-        }
-        NameOrErr = OFH.ReadBundleStart(*Buf);
-        if (!NameOrErr)
-          return NameOrErr.takeError();
-      }
-    }
-    if (Err)
+          return M.OFH->ReadBundleEnd(*M.Buf);
+        }))
       return Err;
 
-    if (Mode == OutputType::Archive) {
-      // Determine archive kind for the offload target.
-      auto ArKind = getTargetTriple(CurrBundle->first()).isOSDarwin()
-                        ? Archive::K_DARWIN
-                        : Archive::K_GNU;
-
-      // And write archive to the output.
-      Expected<std::unique_ptr<MemoryBuffer>> NewAr =
-          writeArchiveToBuffer(ArMembers, /*WriteSymtab=*/true, ArKind,
-                               /*Deterministic=*/true, /*Thin=*/false);
-      if (!NewAr)
-        return NewAr.takeError();
-      OS << NewAr.get()->getBuffer();
+    if (Mode == OutputType::FileList) {
+      // Add temporary file names with the device parts to the output file
+      // list.
+      for (const SmallString<128u> &ChildFileName : ChildFileNames)
+        OS << ChildFileName << "\n";
+      return Error::success();
+    }
+
+    assert(Mode == OutputType::Archive && "unexpected output mode");
+    SmallVector<std::string, 8u> ArNames;
+    SmallVector<NewArchiveMember, 8u> ArMembers;
+    ArNames.reserve(MemberIdxs.size());
+    for (size_t I = 0; I < MemberIdxs.size(); ++I) {
+      auto &Name = ArNames.emplace_back(
+          (Triple + "." + Members[MemberIdxs[I]].Name).str());
+      ArMembers.emplace_back(
+          MemoryBufferRef{StringRef(ArData[I].data(), ArData[I].size()), Name});
     }
+
+    // Determine archive kind for the offload target.
+    auto ArKind = getTargetTriple(Triple).isOSDarwin() ? Archive::K_DARWIN
+                                                       : Archive::K_GNU;
+
+    // And write archive to the output.
+    Expected<std::unique_ptr<MemoryBuffer>> NewAr =
+        writeArchiveToBuffer(ArMembers, /*WriteSymtab=*/true, ArKind,
+                             /*Deterministic=*/true, /*Thin=*/false);
+    if (!NewAr)
+      return NewAr.takeError();
+    OS << NewAr.get()->getBuffer();
     return Error::success();
   }
 
@@ -1391,9 +1444,11 @@ static Error BundleFiles() {
 
 // Unbundle the files. Return true if an error was found.
 static Error UnbundleFiles() {
-  // Open Input file.
+  // Open Input file. None of the handlers needs a null terminator, which lets
+  // large inputs be mapped rather than read.
   ErrorOr<std::unique_ptr<MemoryBuffer>> CodeOrErr =
-      MemoryBuffer::getFileOrSTDIN(InputFileNames.front());
+      MemoryBuffer::getFileOrSTDIN(InputFileNames.front(), /*FileSize=*/-1,
+                                   /*RequiresNullTerminator=*/false);
   if (std::error_code EC = CodeOrErr.getError())
     return createFileError(InputFileNames.front(), EC);
 
@@ -1426,24 +1481,7 @@ static Error UnbundleFiles() {
   // Read all the bundles that are in the work list. If we find no bundles we
   // assume the file is meant for the host target.
   bool FoundHostBundle = false;
-  while (!Worklist.empty()) {
-    Expected<Optional<StringRef>> CurTripleOrErr = FH->ReadBundleStart(Input);
-    if (!CurTripleOrErr)
-      return CurTripleOrErr.takeError();
-
-    // We don't have more bundles.
-    if (!*CurTripleOrErr)
-      break;
-
-    StringRef CurTriple = **CurTripleOrErr;
-    assert(!CurTriple.empty());
-
-    auto Output = Worklist.find(CurTriple);
-    // The file may have more bundles for other targets, that we don't care
-    // about. Therefore, move on to the next triple
-    if (Output == Worklist.end())
-      continue;
-
+  auto ReadCurrentBundle = [&](StringMap<StringRef>::iterator Output) -> Error {
     // Check if the output file can be opened and copy the bundle to it.
     std::error_code EC;
     raw_fd_ostream OutputFile(Output->second, EC, sys::fs::OF_None);
@@ -1453,11 +1491,45 @@ static Error UnbundleFiles() {
       return Err;
     if (Error Err = FH->ReadBundleEnd(Input))
       return Err;
-    Worklist.erase(Output);
 
     // Record if we found the host bundle.
-    if (hasHostKind(CurTriple))
+    if (hasHostKind(Output->first()))
       FoundHostBundle = true;
+    Worklist.erase(Output);
+    return Error::success();
+  };
+
+  if (FH->IsIndexed()) {
+    // Look the requested bundles up rather than reading all of them.
+    for (auto &Triple : TargetNames) {
+      auto Output = Worklist.find(Triple);
+      if (Output == Worklist.end() || !FH->FindBundle(Triple))
+        continue;
+      if (Error Err = ReadCurrentBundle(Output))
+        return Err;
+    }
+  } else {
+    while (!Worklist.empty()) {
+      Expected<Optional<StringRef>> CurTripleOrErr = FH->ReadBundleStart(Input);
+      if (!CurTripleOrErr)
+        return CurTripleOrErr.takeError();
+
+      // We don't have more bundles.
+      if (!*CurTripleOrErr)
+        break;
+
+      StringRef CurTriple = **CurTripleOrErr;
+      assert(!CurTriple.empty());
+
+      auto Output = Worklist.find(CurTriple);
+      // The file may have more bundles for other targets, that we don't care
+      // about. Therefore, move on to the next triple
+      if (Output == Worklist.end())
+        continue;
+
+      if (Error Err = ReadCurrentBundle(Output))
+        return Err;
+    }
   }
 
   // If no bundles were found, assume the input file is the host bundle and
@@ -1498,7 +1570,8 @@ static Error UnbundleFiles() {
 static Expected<bool> CheckBundledSection() {
   // Open Input file.
   ErrorOr<std::unique_ptr<MemoryBuffer>> CodeOrErr =
-      MemoryBuffer::getFileOrSTDIN(InputFileNames.front());
+      MemoryBuffer::getFileOrSTDIN(InputFileNames.front(), /*FileSize=*/-1,
+                                   /*RequiresNullTerminator=*/false);
   if (std::error_code EC = CodeOrErr.getError())
     return createFileError(InputFileNames.front(), EC);
   MemoryBuffer &Input = *CodeOrErr.get();
@@ -1523,6 +1596,9 @@ static Expected<bool> CheckBundledSection() {
     return std::move(Err);
 
   StringRef triple = TargetNames.front();
+  if (FH->IsIndexed())
+    return FH->FindBundle(triple);
+
   // Read all the bundles that are in the work list. If we find no bundles we
   // assume the file is meant for the host target.
   bool found = false;
@@ -1564,6 +1640,8 @@ int main(int argc, const char **argv) {
     return 0;
   }
 
+  parallel::strategy = hardware_concurrency(NumThreads);
+
   // These calls are needed so that we can read bitcode correctly.
   InitializeAllTargetInfos();
   InitializeAllTargetMCs();
@@ -18,14 +18,23 @@
 /// that target linker pulls in necessary symbol definitions from the input
 /// static libraries.
 ///
+/// With -sycl-kernel-gc, SYCL target dependence files only reference the
+/// symbols whose names the host image holds as strings. The SYCL runtime gets
+/// the names of the kernels the host can launch as strings from the
+/// integration header, so the other kernels are dead. Their names are recorded
+/// in the sycl.unreferenced.kernels named metadata of the dependence file, so
+/// that sycl-post-link removes them from the linked device code as well.
+///
 //===----------------------------------------------------------------------===//
 
 #include "clang/Basic/Version.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/IR/GlobalVariable.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Metadata.h"
 #include "llvm/IR/Module.h"
 #ifndef NDEBUG
 #include "llvm/IR/Verifier.h"
@@ -40,6 +49,7 @@
 #include "llvm/Support/raw_ostream.h"
 
 #define SYMBOLS_SECTION_NAME ".tgtsym"
+#define UNREFERENCED_KERNELS_MD "sycl.unreferenced.kernels"
 
 using namespace llvm;
 using namespace llvm::object;
@@ -60,6 +70,12 @@ static cl::list<std::string>
             cl::desc("[<offload kind>-<target triple>,...]"),
             cl::cat(ClangOffloadDepsCategory));
 
+static cl::opt<bool> SYCLKernelGC(
+    "sycl-kernel-gc",
+    cl::desc("Drop the kernels of SYCL targets the host image doesn't "
+             "reference by name"),
+    cl::init(false), cl::cat(ClangOffloadDepsCategory));
+
 static cl::opt<std::string> Input(cl::Positional, cl::Required,
                                   cl::desc("<input file>"),
                                   cl::cat(ClangOffloadDepsCategory));
@@ -71,6 +87,31 @@ static void reportError(Error E) {
   logAllUnhandledErrors(std::move(E), WithColor::error(errs(), ToolPath));
 }
 
+/// Collect the null-terminated strings of the data sections of \p Obj.
+static Error collectDataStrings(const ObjectFile &Obj,
+                                DenseSet<StringRef> &Strings) {
+  for (SectionRef Section : Obj.sections()) {
+    if (!Section.isData())
+      continue;
+    Expected<StringRef> NameOrErr = Section.getName();
+    if (!NameOrErr)
+      return NameOrErr.takeError();
+    if (*NameOrErr == SYMBOLS_SECTION_NAME)
+      continue;
+
+    Expected<StringRef> DataOrErr = Section.getContents();
+    if (!DataOrErr)
+      return DataOrErr.takeError();
+    for (StringRef Data = *DataOrErr; !Data.empty();) {
+      StringRef Str;
+      std::tie(Str, Data) = Data.split('\0');
+      if (!Str.empty())
+        Strings.insert(Str);
+    }
+  }
+  return Error::success();
+}
+
 int main(int argc, const char **argv) {
   sys::PrintStackTraceOnErrorSignal(argv[0]);
   ToolPath = sys::fs::getMainExecutable(argv[0], &ToolPath);
@@ -180,6 +221,30 @@ int main(int argc, const char **argv) {
     break;
   }
 
+  // Split the symbols of SYCL targets into the ones the host image references
+  // by name and the other ones.
+  DenseMap<StringRef, SmallVector<StringRef, 8u>> Target2Unreferenced;
+  if (SYCLKernelGC) {
+    DenseSet<StringRef> HostStrings;
+    if (Error Err =
+            collectDataStrings(*ObjectOrErr->getBinary(), HostStrings)) {
+      reportError(std::move(Err));
+      return 1;
+    }
+    for (const std::string &Target : Targets) {
+      if (!StringRef(Target).startswith("sycl-"))
+        continue;
+      SmallDenseSet<StringRef> &Symbols = Target2Symbols[Target];
+      SmallVector<StringRef, 8u> &Unreferenced = Target2Unreferenced[Target];
+      for (StringRef Symbol : Symbols)
+        if (!HostStrings.count(Symbol))
+          Unreferenced.push_back(Symbol);
+      for (StringRef Symbol : Unreferenced)
+        Symbols.erase(Symbol);
+      llvm::sort(Unreferenced);
+    }
+  }
+
   LLVMContext Context;
   Type *Int8PtrTy = Type::getInt8PtrTy(Context);
 
@@ -220,6 +285,14 @@ int main(int argc, const char **argv) {
       }
     }
 
+    auto Unreferenced = Target2Unreferenced.find(Targets[I]);
+    if (Unreferenced != Target2Unreferenced.end() &&
+        !Unreferenced->second.empty()) {
+      NamedMDNode *MD = Mod.getOrInsertNamedMetadata(UNREFERENCED_KERNELS_MD);
+      for (StringRef Symbol : Unreferenced->second)
+        MD->addOperand(MDNode::get(Context, MDString::get(Context, Symbol)));
+    }
+
 #ifndef NDEBUG
     if (verifyModule(Mod, &errs())) {
       reportError(createStringError(inconvertibleErrorCode(),
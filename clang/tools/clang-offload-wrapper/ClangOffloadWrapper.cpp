@@ -16,6 +16,7 @@
 
 #include "clang/Basic/Version.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/ADT/Twine.h"
@@ -30,11 +31,13 @@
 #include "llvm/IR/Verifier.h"
 #endif // NDEBUG
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/Host.h"
 #include "llvm/Support/LineIterator.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PropertySetIO.h"
 #include "llvm/Support/Signals.h"
@@ -43,11 +46,13 @@
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Utils/ModuleUtils.h"
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <fstream>
 #include <iterator>
+#include <limits>
 #include <memory>
 #include <string>
 #include <tuple>
@@ -195,6 +200,23 @@ static cl::opt<std::string> DescriptorName(
         "and makes it globally visible"),
     cl::value_desc("name"), cl::cat(ClangOffloadWrapperCategory));
 
+/// Compress SYCL device images
+static cl::opt<bool> CompressImages(
+    "compress", cl::NotHidden, cl::init(false), cl::Optional,
+    cl::desc("Compress SYCL device images with zlib. The runtime decompresses\n"
+             "an image when it is first used. Compressed images are not\n"
+             "placed into offload bundle sections."),
+    cl::cat(ClangOffloadWrapperCategory));
+
+/// Alignment of SYCL device images
+static cl::opt<unsigned> ImageAlignment(
+    "sycl-image-alignment", cl::NotHidden, cl::init(4096), cl::Optional,
+    cl::desc("Alignment of the SYCL device images which are at least that\n"
+             "large, so that the runtime can drop their whole pages from\n"
+             "memory once it has built them. Must be a power of two, 0\n"
+             "keeps the images unaligned."),
+    cl::cat(ClangOffloadWrapperCategory));
+
 /// batch mode - all input files are grouped in file table files
 static cl::opt<bool> BatchMode(
     "batch", cl::NotHidden, cl::init(false), cl::Optional,
@@ -301,6 +323,7 @@ private:
   StructType *SyclDescTy = nullptr;
   StructType *SyclPropSetTy = nullptr;
   StructType *SyclPropTy = nullptr;
+  StructType *SyclKernelNameTy = nullptr;
 
   /// Records all added device binary images per offload kind.
   llvm::DenseMap<OffloadKind, std::unique_ptr<SameKindPack>> Packs;
@@ -535,7 +558,29 @@ private:
     return PointerType::getUnqual(getSyclDeviceImageTy());
   }
 
-  const uint16_t BinDescStructVersion = 1;
+  // struct _pi_kernel_name_entry_struct {
+  //   const char *Name;
+  //   uint32_t ImageIndex;
+  // };
+  StructType *getSyclKernelNameTy() {
+    if (!SyclKernelNameTy) {
+      SyclKernelNameTy = StructType::create(
+          {
+              Type::getInt8PtrTy(C), // Name
+              Type::getInt32Ty(C)    // ImageIndex
+          },
+          "_pi_kernel_name_entry_struct");
+    }
+    return SyclKernelNameTy;
+  }
+
+  PointerType *getSyclKernelNamePtrTy() {
+    return PointerType::getUnqual(getSyclKernelNameTy());
+  }
+
+  // BinDescStructVersion change log:
+  // -- version 2: added the kernel name table
+  const uint16_t BinDescStructVersion = 2;
 
   // SYCL specific binary descriptor type.
   // struct __tgt_bin_desc {
@@ -548,6 +593,9 @@ private:
   //   /// the offload entry table
   //   __tgt_offload_entry *HostEntriesBegin;
   //   __tgt_offload_entry *HostEntriesEnd;
+  //   /// the kernel name table sorted by name
+  //   _pi_kernel_name_entry_struct *KernelNamesBegin;
+  //   _pi_kernel_name_entry_struct *KernelNamesEnd;
   // };
   StructType *getSyclBinDescTy() {
     if (!SyclDescTy) {
@@ -557,7 +605,9 @@ private:
               Type::getInt16Ty(C),       // NumDeviceImages
               getSyclDeviceImagePtrTy(), // DeviceImages
               getEntryPtrTy(),           // HostEntriesBegin
-              getEntryPtrTy()            // HostEntriesEnd
+              getEntryPtrTy(),           // HostEntriesEnd
+              getSyclKernelNamePtrTy(),  // KernelNamesBegin
+              getSyclKernelNamePtrTy()   // KernelNamesEnd
           },
           "__tgt_bin_desc");
     }
@@ -601,8 +651,9 @@ private:
   // of pointers that point to the beginning and end of the variable.
   std::pair<Constant *, Constant *>
   addArrayToModule(ArrayRef<char> Buf, const Twine &Name,
-                   const Twine &Section = "") {
+                   const Twine &Section = "", MaybeAlign Alignment = None) {
     auto *Var = addGlobalArrayVariable(Name, Buf, Section);
+    Var->setAlignment(Alignment);
     auto *ImageB = ConstantExpr::getGetElementPtr(Var->getValueType(), Var,
                                                   getSizetConstPair(0u, 0u));
     auto *ImageE = ConstantExpr::getGetElementPtr(
@@ -619,6 +670,24 @@ private:
     return DataPtr;
   }
 
+  // Compresses the image data with zlib into Compressed. Leaves Compressed
+  // empty if zlib is not available or the image is too big to be described
+  // by the 32-bit uncompressed size property.
+  Error compressImage(ArrayRef<char> Data, SmallVectorImpl<char> &Compressed) {
+    if (!zlib::isAvailable()) {
+      static bool Warned = false;
+      if (!Warned)
+        WithColor::warning(errs(), "clang-offload-wrapper")
+            << "zlib is not available, device images are not compressed\n";
+      Warned = true;
+      return Error::success();
+    }
+    if (Data.size() > std::numeric_limits<uint32_t>::max())
+      return Error::success();
+    return zlib::compress(StringRef(Data.data(), Data.size()), Compressed,
+                          zlib::BestSizeCompression);
+  }
+
   // Creates all necessary data objects for the given image and returns a pair
   // of pointers that point to the beginning and end of the global variable that
   // contains the image data.
@@ -638,13 +707,21 @@ private:
               TargetTriple);
     }
 
+    // Page-align the SYCL images spanning pages, so that none of their pages
+    // is shared with other data and the runtime can release them.
+    MaybeAlign Alignment;
+    if (Kind == OffloadKind::SYCL && ImageAlignment &&
+        Buf.size() >= ImageAlignment)
+      Alignment = Align(ImageAlignment);
+
     // Create global variable for the image data.
     return addArrayToModule(Buf, Name,
                             TargetTriple.empty()
                                 ? ""
                                 : "__CLANG_OFFLOAD_BUNDLE__" +
                                       offloadKindToString(Kind) + "-" +
-                                      TargetTriple);
+                                      TargetTriple,
+                            Alignment);
   }
 
   // Creates a global variable of const char* type and creates an
@@ -663,12 +740,21 @@ private:
     return ConstantExpr::getGetElementPtr(Var->getValueType(), Var, ZeroZero);
   }
 
+  // A kernel name table element being created, see
+  // addSYCLKernelNameTableToModule.
+  struct KernelNameInfo {
+    StringRef Name;
+    Constant *NameAddr;
+    uint32_t ImageIndex;
+  };
+
   // Creates an array of __tgt_offload_entry that contains function info
   // for the given image. Returns a pair of pointers to the beginning and end
   // of the array, or a pair of nullptrs in case the entries file wasn't
-  // specified.
+  // specified. Appends the names of the entries to KernelNames.
   Expected<std::pair<Constant *, Constant *>>
-  addSYCLOffloadEntriesToModule(StringRef EntriesFile) {
+  addSYCLOffloadEntriesToModule(StringRef EntriesFile, uint32_t ImageIndex,
+                                std::vector<KernelNameInfo> &KernelNames) {
     if (EntriesFile.empty()) {
       auto *NullPtr = Constant::getNullValue(getEntryPtrTy());
       return std::pair<Constant *, Constant *>(NullPtr, NullPtr);
@@ -686,11 +772,12 @@ private:
     std::vector<Constant *> EntriesInits;
     // Only the name field is used for SYCL now, others are for future OpenMP
     // compatibility and new SYCL features
-    for (line_iterator LI(*MB); !LI.is_at_eof(); ++LI)
-      EntriesInits.push_back(ConstantStruct::get(
-          getEntryTy(), NullPtr,
-          addStringToModule(*LI, "__sycl_offload_entry_name"), Zero, i32Zero,
-          i32Zero));
+    for (line_iterator LI(*MB); !LI.is_at_eof(); ++LI) {
+      Constant *Name = addStringToModule(*LI, "__sycl_offload_entry_name");
+      KernelNames.push_back({*LI, Name, ImageIndex});
+      EntriesInits.push_back(ConstantStruct::get(getEntryTy(), NullPtr, Name,
+                                                 Zero, i32Zero, i32Zero));
+    }
 
     auto *Arr = ConstantArray::get(
         ArrayType::get(getEntryTy(), EntriesInits.size()), EntriesInits);
@@ -708,6 +795,54 @@ private:
     return std::pair<Constant *, Constant *>(EntriesB, EntriesE);
   }
 
+  // Creates the kernel name table of the binary descriptor. Each kernel is
+  // listed once with the index of the first image containing it, and the table
+  // is sorted by name, so the runtime can binary search it in place. The name
+  // strings of the offload entries are reused. Returns a pair of pointers to
+  // the beginning and end of the table, or a pair of nullptrs if there are no
+  // kernel names.
+  std::pair<Constant *, Constant *>
+  addSYCLKernelNameTableToModule(std::vector<KernelNameInfo> &KernelNames) {
+    if (KernelNames.empty()) {
+      auto *NullPtr = Constant::getNullValue(getSyclKernelNamePtrTy());
+      return std::pair<Constant *, Constant *>(NullPtr, NullPtr);
+    }
+    // The runtime compares the names with strcmp, which orders them the same
+    // way as StringRef does. Images are visited in order, so the stable sort
+    // keeps the first image listing a kernel at the front.
+    std::stable_sort(KernelNames.begin(), KernelNames.end(),
+                     [](const KernelNameInfo &A, const KernelNameInfo &B) {
+                       return A.Name < B.Name;
+                     });
+    auto NewEnd = std::unique(
+        KernelNames.begin(), KernelNames.end(),
+        [](const KernelNameInfo &A, const KernelNameInfo &B) {
+          return A.Name == B.Name;
+        });
+    KernelNames.erase(NewEnd, KernelNames.end());
+
+    std::vector<Constant *> TableInits;
+    for (const KernelNameInfo &Info : KernelNames)
+      TableInits.push_back(ConstantStruct::get(
+          getSyclKernelNameTy(), Info.NameAddr,
+          ConstantInt::get(Type::getInt32Ty(C), Info.ImageIndex)));
+
+    auto *Arr = ConstantArray::get(
+        ArrayType::get(getSyclKernelNameTy(), TableInits.size()), TableInits);
+    auto *Table = new GlobalVariable(M, Arr->getType(), true,
+                                     GlobalVariable::InternalLinkage, Arr,
+                                     "__sycl_offload_kernel_names");
+    if (Verbose)
+      errs() << "  global added: " << Table->getName() << "\n";
+
+    auto *TableB = ConstantExpr::getGetElementPtr(
+        Table->getValueType(), Table, getSizetConstPair(0u, 0u));
+    auto *TableE = ConstantExpr::getGetElementPtr(
+        Table->getValueType(), Table,
+        getSizetConstPair(0u, TableInits.size()));
+    return std::pair<Constant *, Constant *>(TableB, TableE);
+  }
+
   Expected<std::pair<Constant *, Constant *>>
   addSYCLPropertySetToModule(const llvm::util::PropertySet &PropSet) {
     std::vector<Constant *> PropInits;
@@ -779,23 +914,35 @@ private:
   //                 #                    #
   // Returns a pair of pointers to the beginning and end of the property set
   // array, or a pair of nullptrs in case the properties file wasn't specified.
+  // If UncompressedSize is set, the image is compressed and a property set
+  // holding its original size is added to the ones from the file.
   Expected<std::pair<Constant *, Constant *>>
-  tformSYCLPropertySetRegistryFileToIR(StringRef PropRegistryFile) {
-    if (PropRegistryFile.empty()) {
+  tformSYCLPropertySetRegistryFileToIR(StringRef PropRegistryFile,
+                                       Optional<uint32_t> UncompressedSize) {
+    if (PropRegistryFile.empty() && !UncompressedSize) {
       auto *NullPtr =
           Constant::getNullValue(getSyclPropSetTy()->getPointerTo());
       return std::pair<Constant *, Constant *>(NullPtr, NullPtr);
     }
-    // load the property registry file
-    Expected<MemoryBuffer *> MBOrErr = loadFile(PropRegistryFile);
-    if (!MBOrErr)
-      return MBOrErr.takeError();
-    MemoryBuffer *MB = *MBOrErr;
-    Expected<std::unique_ptr<llvm::util::PropertySetRegistry>> PropRegistryE =
-        llvm::util::PropertySetRegistry::read(MB);
-    if (!PropRegistryE)
-      return PropRegistryE.takeError();
-    auto &PropRegistry = PropRegistryE.get();
+    auto PropRegistry = std::make_unique<llvm::util::PropertySetRegistry>();
+    if (!PropRegistryFile.empty()) {
+      // load the property registry file
+      Expected<MemoryBuffer *> MBOrErr = loadFile(PropRegistryFile);
+      if (!MBOrErr)
+        return MBOrErr.takeError();
+      MemoryBuffer *MB = *MBOrErr;
+      Expected<std::unique_ptr<llvm::util::PropertySetRegistry>>
+          PropRegistryE = llvm::util::PropertySetRegistry::read(MB);
+      if (!PropRegistryE)
+        return PropRegistryE.takeError();
+      PropRegistry = std::move(PropRegistryE.get());
+    }
+    if (UncompressedSize) {
+      std::map<StringRef, uint32_t> SizeEntry = {
+          {"UncompressedSize", *UncompressedSize}};
+      PropRegistry->add(
+          llvm::util::PropertySetRegistry::SYCL_COMPRESSED_IMAGE, SizeEntry);
+    }
     std::vector<Constant *> PropSetsInits;
 
     // transform all property sets to IR and get the middle column image into
@@ -904,6 +1051,7 @@ private:
 
     // Create initializer for the images array.
     SmallVector<Constant *, 4u> ImagesInits;
+    std::vector<KernelNameInfo> KernelNames;
     unsigned ImgId = 0;
 
     for (const auto &ImgPtr : Pack) {
@@ -938,11 +1086,6 @@ private:
             Twine(OffloadKindTag) + Twine(ImgId) + Twine(".manifest"));
       }
 
-      Expected<std::pair<Constant *, Constant *>> PropSets =
-          tformSYCLPropertySetRegistryFileToIR(Img.PropsFile);
-      if (!PropSets)
-        return PropSets.takeError();
-
       if (Img.File.empty())
         return createStringError(errc::invalid_argument,
                                  "image file name missing");
@@ -950,15 +1093,39 @@ private:
       if (!BinOrErr)
         return BinOrErr.takeError();
       MemoryBuffer *Bin = *BinOrErr;
+      ArrayRef<char> BinData =
+          makeArrayRef(Bin->getBufferStart(), Bin->getBufferSize());
+
+      SmallVector<char, 0> CompressedData;
+      Optional<uint32_t> UncompressedSize;
+      if (Kind == OffloadKind::SYCL && CompressImages) {
+        if (Error E = compressImage(BinData, CompressedData))
+          return std::move(E);
+        // Keep the original image if compression doesn't make it smaller.
+        if (!CompressedData.empty() && CompressedData.size() < BinData.size()) {
+          UncompressedSize = static_cast<uint32_t>(BinData.size());
+          BinData = CompressedData;
+        }
+      }
+
+      Expected<std::pair<Constant *, Constant *>> PropSets =
+          tformSYCLPropertySetRegistryFileToIR(Img.PropsFile,
+                                               UncompressedSize);
+      if (!PropSets)
+        return PropSets.takeError();
+
+      // The bundler would extract the compressed data, which no tool expects,
+      // so compressed images are not placed into bundle sections.
       std::pair<Constant *, Constant *> Fbin = addDeviceImageToModule(
-          makeArrayRef(Bin->getBufferStart(), Bin->getBufferSize()),
-          Twine(OffloadKindTag) + Twine(ImgId) + Twine(".data"), Kind, Img.Tgt);
+          BinData, Twine(OffloadKindTag) + Twine(ImgId) + Twine(".data"), Kind,
+          UncompressedSize ? StringRef() : StringRef(Img.Tgt));
 
       if (Kind == OffloadKind::SYCL) {
         // For SYCL image offload entries are defined here, by wrapper, so
         // those are created per image
         Expected<std::pair<Constant *, Constant *>> EntriesOrErr =
-            addSYCLOffloadEntriesToModule(Img.EntriesFile);
+            addSYCLOffloadEntriesToModule(Img.EntriesFile, ImgId,
+                                          KernelNames);
         if (!EntriesOrErr)
           return EntriesOrErr.takeError();
         std::pair<Constant *, Constant *> ImageEntriesPtrs = *EntriesOrErr;
@@ -995,13 +1162,17 @@ private:
                                                    Images, ZeroZero);
 
     // And finally create the binary descriptor object.
+    std::pair<Constant *, Constant *> KernelNamesPtrs;
+    if (Kind == OffloadKind::SYCL)
+      KernelNamesPtrs = addSYCLKernelNameTableToModule(KernelNames);
     auto *DescInit =
         Kind == OffloadKind::SYCL
             ? ConstantStruct::get(
                   getSyclBinDescTy(),
                   ConstantInt::get(Type::getInt16Ty(C), BinDescStructVersion),
                   ConstantInt::get(Type::getInt16Ty(C), ImagesInits.size()),
-                  ImagesB, EntriesB, EntriesE)
+                  ImagesB, EntriesB, EntriesE, KernelNamesPtrs.first,
+                  KernelNamesPtrs.second)
             : ConstantStruct::get(
                   getBinDescTy(),
                   ConstantInt::get(Type::getInt32Ty(C), ImagesInits.size()),
@@ -1324,6 +1495,12 @@ int main(int argc, const char **argv) {
                           "batch job table file must be the only input file"));
     return 1;
   }
+  if (ImageAlignment && !isPowerOf2_32(ImageAlignment)) {
+    reportError(createStringError(errc::invalid_argument,
+                                  "-" + ImageAlignment.ArgStr +
+                                      " must be a power of two"));
+    return 1;
+  }
   if (Target.empty()) {
     Target = sys::getProcessTriple();
     if (Verbose)
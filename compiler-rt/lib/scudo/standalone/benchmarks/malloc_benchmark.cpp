@@ -100,4 +100,52 @@ BENCHMARK_TEMPLATE(BM_malloc_free_loop, scudo::FuchsiaConfig)
     ->Range(MinIters, MaxIters);
 #endif
 
+// Every thread allocates a burst of chunks of the same size and frees them, so
+// that the threads go to the primary in turn. The allocator is shared, as in a
+// multi-threaded service.
+static const size_t BurstSize = 256;
+
+template <typename Config>
+static void BM_malloc_free_threads(benchmark::State &State) {
+  using AllocatorT = scudo::Allocator<Config>;
+  static AllocatorT *Allocator;
+  if (State.thread_index == 0) {
+    Allocator = new AllocatorT;
+    Allocator->reset();
+  }
+
+  const size_t NBytes = State.range(0);
+  void *Ptrs[BurstSize];
+
+  for (auto _ : State) {
+    for (void *&Ptr : Ptrs) {
+      Ptr = Allocator->allocate(NBytes, scudo::Chunk::Origin::Malloc);
+      *reinterpret_cast<uint8_t *>(Ptr) = 1;
+      benchmark::DoNotOptimize(Ptr);
+    }
+    for (void *&Ptr : Ptrs)
+      Allocator->deallocate(Ptr, scudo::Chunk::Origin::Malloc);
+  }
+
+  State.SetItemsProcessed(uint64_t(State.iterations()) * BurstSize);
+  if (State.thread_index == 0) {
+    Allocator->unmapTestOnly();
+    delete Allocator;
+  }
+}
+
+static const size_t MinBurstChunkSize = 16;
+static const size_t MaxBurstChunkSize = 16 * 1024;
+
+BENCHMARK_TEMPLATE(BM_malloc_free_threads, scudo::AndroidConfig)
+    ->Range(MinBurstChunkSize, MaxBurstChunkSize)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+#if SCUDO_CAN_USE_PRIMARY64
+BENCHMARK_TEMPLATE(BM_malloc_free_threads, scudo::FuchsiaConfig)
+    ->Range(MinBurstChunkSize, MaxBurstChunkSize)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+#endif
+
 BENCHMARK_MAIN();
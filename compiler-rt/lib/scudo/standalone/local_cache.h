@@ -93,7 +93,7 @@ template <class SizeClassAllocator> struct SizeClassAllocatorLocalCache {
     // We still have to initialize the cache in the event that the first heap
     // operation in a thread is a deallocation.
     initCacheMaybe(C);
-    if (C->Count == C->MaxCount)
+    if (C->Count >= C->MaxCount)
       drain(C, ClassId);
     // See comment in allocate() about memory accesses.
     const uptr ClassSize = C->ClassSize;
@@ -120,15 +120,29 @@ template <class SizeClassAllocator> struct SizeClassAllocatorLocalCache {
 
 private:
   static const uptr NumClasses = SizeClassMap::NumClasses;
+  // The number of chunks a class caches adapts to the share it has in the
+  // transfers of the cache from and to the primary: a class that refills or
+  // drains again within HotTransfers transfers doubles its MaxCount, up to
+  // MaxCountScale times the size class map hint (and the size of the
+  // TransferBatches), so that it goes less often to the primary. A class that
+  // comes back after more than ColdTransfers transfers halves it, down to a
+  // chunk moved at a time, so that the classes a thread seldom uses hold less
+  // memory. Counting the transfers rather than reading the clock keeps the
+  // refills and the drains as cheap as they were.
+  static const u32 HotTransfers = 4U;
+  static const u32 ColdTransfers = 1024U;
+  static const u32 MaxCountScale = 4U;
   struct PerClass {
     u32 Count;
     u32 MaxCount;
     uptr ClassSize;
+    uptr LastTransfer;
     void *Chunks[2 * TransferBatch::MaxNumCached];
   };
   PerClass PerClassArray[NumClasses];
   LocalStats Stats;
   SizeClassAllocator *Allocator;
+  uptr Transfers;
 
   ALWAYS_INLINE void initCacheMaybe(PerClass *C) {
     if (LIKELY(C->MaxCount))
@@ -146,6 +160,26 @@ private:
     }
   }
 
+  static u32 getMaxCountLimit(uptr ClassSize) {
+    return 2 * Min(TransferBatch::MaxNumCached,
+                   MaxCountScale * TransferBatch::getMaxCached(ClassSize));
+  }
+
+  void adaptMaxCount(PerClass *C, uptr ClassId) {
+    // The batch class follows the other classes.
+    if (ClassId == SizeClassMap::BatchClassId)
+      return;
+    const uptr Interval = ++Transfers - C->LastTransfer;
+    const bool First = C->LastTransfer == 0;
+    C->LastTransfer = Transfers;
+    if (First)
+      return;
+    if (Interval <= HotTransfers)
+      C->MaxCount = Min(2 * C->MaxCount, getMaxCountLimit(C->ClassSize));
+    else if (Interval > ColdTransfers)
+      C->MaxCount = Max(2U, C->MaxCount / 2);
+  }
+
   void destroyBatch(uptr ClassId, void *B) {
     if (ClassId != SizeClassMap::BatchClassId)
       deallocate(SizeClassMap::BatchClassId, B);
@@ -153,18 +187,25 @@ private:
 
   NOINLINE bool refill(PerClass *C, uptr ClassId) {
     initCacheMaybe(C);
-    TransferBatch *B = Allocator->popBatch(this, ClassId);
-    if (UNLIKELY(!B))
-      return false;
-    DCHECK_GT(B->getCount(), 0);
-    C->Count = B->getCount();
-    B->copyToArray(C->Chunks);
-    B->clear();
-    destroyBatch(ClassId, B);
+    adaptMaxCount(C, ClassId);
+    // A class whose MaxCount grew past the size of its batches takes several
+    // of them, up to half of MaxCount.
+    do {
+      TransferBatch *B = Allocator->popBatch(this, ClassId);
+      if (UNLIKELY(!B))
+        return C->Count != 0;
+      DCHECK_GT(B->getCount(), 0);
+      B->copyToArray(&C->Chunks[C->Count]);
+      C->Count += B->getCount();
+      B->clear();
+      destroyBatch(ClassId, B);
+    } while (C->Count < C->MaxCount / 2 &&
+             C->Count <= TransferBatch::MaxNumCached);
     return true;
   }
 
   NOINLINE void drain(PerClass *C, uptr ClassId) {
+    adaptMaxCount(C, ClassId);
     const u32 Count = Min(C->MaxCount / 2, C->Count);
     TransferBatch *B = createBatch(ClassId, C->Chunks[0]);
     if (UNLIKELY(!B))
@@ -11,6 +11,7 @@
 #ifndef FORTRAN_RUNTIME_BUFFER_H_
 #define FORTRAN_RUNTIME_BUFFER_H_
 
+#include "environment.h"
 #include "io-error.h"
 #include "memory.h"
 #include <algorithm>
@@ -45,6 +46,12 @@ public:
   }
   std::size_t BytesBufferedBeforeFrame() const { return frame_ - start_; }
 
+  // The size of the smallest buffer, which FORT_BUFFER_SIZE can enlarge so
+  // that the records are written with fewer and larger system calls.
+  static std::size_t MinBufferSize() {
+    return std::max<std::size_t>(minBuffer, executionEnvironment.ioBufferSize);
+  }
+
   // Returns a short frame at a non-fatal EOF.  Can return a long frame as well.
   std::size_t ReadFrame(
       FileOffset at, std::size_t bytes, IoErrorHandler &handler) {
@@ -81,7 +88,7 @@ public:
       auto got{Store().Read(
           fileOffset_ + length_, buffer_ + next, minBytes, maxBytes, handler)};
       length_ += got;
-      RUNTIME_CHECK(handler, length_ < size_);
+      RUNTIME_CHECK(handler, length_ <= size_);
       if (got < minBytes) {
         break; // error or EOF & program can handle it
       }
@@ -126,7 +133,7 @@ private:
     if (bytes > size_) {
       char *old{buffer_};
       auto oldSize{size_};
-      size_ = std::max<std::int64_t>(bytes, minBuffer);
+      size_ = std::max<std::int64_t>(bytes, MinBufferSize());
       buffer_ =
           reinterpret_cast<char *>(AllocateMemoryOrCrash(terminator, size_));
       auto chunk{std::min<std::int64_t>(length_, oldSize - start_)};
@@ -12,6 +12,12 @@
 
 namespace Fortran::runtime::io {
 
+static const char twoDigits[]{"0001020304050607080910111213141516171819"
+                              "2021222324252627282930313233343536373839"
+                              "4041424344454647484950515253545556575859"
+                              "6061626364656667686970717273747576777879"
+                              "8081828384858687888990919293949596979899"};
+
 template <typename INT, typename UINT>
 bool EditIntegerOutput(IoStatementState &io, const DataEdit &edit, INT n) {
   char buffer[130], *end = &buffer[sizeof buffer], *p = end;
@@ -30,11 +36,18 @@ bool EditIntegerOutput(IoStatementState &io, const DataEdit &edit, INT n) {
     if (isNegative || (edit.modes.editingFlags & signPlus)) {
       signChars = 1; // '-' or '+'
     }
-    while (un > 0) {
-      auto quotient{un / 10u};
-      *--p = '0' + static_cast<int>(un - UINT{10} * quotient);
+    // Two digits at a time
+    while (un >= 10u) {
+      auto quotient{un / 100u};
+      auto pair{static_cast<int>(un - UINT{100} * quotient)};
+      const char *q{twoDigits + pair + pair};
+      *--p = q[1];
+      *--p = q[0];
       un = quotient;
     }
+    if (un > 0) {
+      *--p = '0' + static_cast<int>(un);
+    }
     break;
   case 'B':
     for (; un > 0; un >>= 1) {
@@ -162,6 +175,23 @@ decimal::ConversionToDecimalResult RealOutputEditing<binaryPrecision>::Convert(
   if (edit.modes.editingFlags & signPlus) {
     flags |= decimal::AlwaysSign;
   }
+  if (lastConverted_.str && flags == lastFlags_ &&
+      edit.modes.round == lastRounding_) {
+    if (significantDigits == lastSignificantDigits_) {
+      return lastConverted_;
+    }
+    // A conversion that wasn't cut short by its digit limit holds the
+    // same digits under any larger limit.
+    if (lastConverted_.flags == decimal::Exact && significantDigits > 0 &&
+        lastSignificantDigits_ > 0) {
+      const char *p{lastConverted_.str};
+      int signLength{*p == '-' || *p == '+' ? 1 : 0};
+      if (static_cast<int>(lastConverted_.length) - signLength <=
+          significantDigits) {
+        return lastConverted_;
+      }
+    }
+  }
   auto converted{decimal::ConvertToDecimal<binaryPrecision>(buffer_,
       sizeof buffer_, static_cast<enum decimal::DecimalConversionFlags>(flags),
       significantDigits, edit.modes.round, x_)};
@@ -170,6 +200,10 @@ decimal::ConversionToDecimalResult RealOutputEditing<binaryPrecision>::Convert(
         "RealOutputEditing::Convert : buffer size %zd was insufficient",
         sizeof buffer_);
   }
+  lastConverted_ = converted;
+  lastSignificantDigits_ = significantDigits;
+  lastFlags_ = flags;
+  lastRounding_ = edit.modes.round;
   return converted;
 }
 
@@ -268,8 +302,12 @@ bool RealOutputEditing<binaryPrecision>::EditFOutput(const DataEdit &edit) {
     }
   }
   // Multiple conversions may be needed to get the right number of
-  // effective rounded fractional digits.
+  // effective rounded fractional digits.  The digits before the point are
+  // added only once: when rounding to more digits no longer carries into a
+  // new leading digit, as 9.9996 does with F5.3, the carry being dropped
+  // again would never converge.
   int extraDigits{0};
+  bool canIncrease{true};
   while (true) {
     decimal::ConversionToDecimalResult converted{
         Convert(extraDigits + fracDigits, edit, flags)};
@@ -279,8 +317,9 @@ bool RealOutputEditing<binaryPrecision>::EditFOutput(const DataEdit &edit) {
     }
     int scale{IsZero() ? 1 : edit.modes.scale}; // kP
     int expo{converted.decimalExponent + scale};
-    if (expo > extraDigits && extraDigits >= 0) {
+    if (expo > extraDigits && extraDigits >= 0 && canIncrease) {
       extraDigits = expo;
+      canIncrease = false;
       if (!edit.digits.has_value()) { // F0
         fracDigits = sizeof buffer_ - extraDigits - 2; // sign & NUL
       }
@@ -362,11 +401,23 @@ DataEdit RealOutputEditing<binaryPrecision>::EditForGOutput(DataEdit edit) {
 template <int binaryPrecision>
 bool RealOutputEditing<binaryPrecision>::EditListDirectedOutput(
     const DataEdit &edit) {
-  decimal::ConversionToDecimalResult converted{Convert(1, edit)};
+  // The shortest digits are converted once here and then reused by the E
+  // or F editing below.  The choice between the two depends on the value
+  // rounded to one digit, which can differ in its exponent only when the
+  // shortest digits begin with 9 or are a bare 1.
+  decimal::ConversionToDecimalResult converted{
+      Convert(sizeof buffer_ - 5, edit, decimal::Minimize)};
   if (IsInfOrNaN(converted)) {
     return EditEorDOutput(edit);
   }
   int expo{converted.decimalExponent};
+  const char *digits{converted.str};
+  if (*digits == '-' || *digits == '+') {
+    ++digits;
+  }
+  if (*digits == '9' || (*digits == '1' && digits[1] == '\0')) {
+    expo = Convert(1, edit).decimalExponent;
+  }
   if (expo < 0 || expo > BinaryFloatingPoint::decimalPrecision) {
     DataEdit copy{edit};
     copy.modes.scale = 1; // 1P
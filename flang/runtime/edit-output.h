@@ -86,6 +86,13 @@ private:
       int significantDigits, const DataEdit &, int flags = 0);
 
   BinaryFloatingPoint x_;
+  // The last conversion into buffer_, which is reused when the same digits
+  // are asked for again, as F0 and list-directed editing do.
+  decimal::ConversionToDecimalResult lastConverted_{
+      nullptr, 0, 0, decimal::Exact};
+  int lastSignificantDigits_{0};
+  int lastFlags_{0};
+  decimal::FortranRounding lastRounding_{decimal::RoundNearest};
   char buffer_[BinaryFloatingPoint::maxDecimalConversionDigits +
       EXTRA_DECIMAL_CONVERSION_SPACE];
 };
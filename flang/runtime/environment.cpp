@@ -45,6 +45,7 @@ void ExecutionEnvironment::Configure(
   defaultOutputRoundingMode =
       decimal::FortranRounding::RoundNearest; // RP(==RN)
   conversion = Convert::Unknown;
+  ioBufferSize = 0;
 
   if (auto *x{std::getenv("FORT_FMT_RECL")}) {
     char *end;
@@ -66,6 +67,17 @@ void ExecutionEnvironment::Configure(
     }
   }
 
+  if (auto *x{std::getenv("FORT_BUFFER_SIZE")}) {
+    char *end;
+    auto n{std::strtoll(x, &end, 10)};
+    if (n > 0 && *end == '\0') {
+      ioBufferSize = n;
+    } else {
+      std::fprintf(stderr,
+          "Fortran runtime: FORT_BUFFER_SIZE=%s is invalid; ignored\n", x);
+    }
+  }
+
   // TODO: Set RP/ROUND='PROCESSOR_DEFINED' from environment
 }
 } // namespace Fortran::runtime
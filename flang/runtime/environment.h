@@ -36,6 +36,7 @@ struct ExecutionEnvironment {
   int listDirectedOutputLineLengthLimit;
   enum decimal::FortranRounding defaultOutputRoundingMode;
   Convert conversion;
+  std::size_t ioBufferSize; // FORT_BUFFER_SIZE, 0 for the default
 };
 extern ExecutionEnvironment executionEnvironment;
 } // namespace Fortran::runtime
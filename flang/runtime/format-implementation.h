@@ -373,30 +373,50 @@ DataEdit FormatControl<CONTEXT>::GetNextDataEdit(
   int repeat{CueUpNextDataEdit(context)};
   auto start{offset_};
   DataEdit edit;
-  edit.descriptor = static_cast<char>(Capitalize(GetNextChar(context)));
-  if (edit.descriptor == 'E') {
-    edit.variation = static_cast<char>(Capitalize(PeekNext()));
-    if (edit.variation >= 'A' && edit.variation <= 'Z') {
-      ++offset_;
+  const CachedDataEdit *cached{nullptr};
+  for (const CachedDataEdit &entry : cachedDataEdits_) {
+    if (entry.start == start) {
+      cached = &entry;
+      break;
     }
   }
+  if (cached) {
+    edit = cached->edit;
+    edit.modes = context.mutableModes();
+    offset_ = cached->end;
+  } else {
+    edit.descriptor = static_cast<char>(Capitalize(GetNextChar(context)));
+    if (edit.descriptor == 'E') {
+      edit.variation = static_cast<char>(Capitalize(PeekNext()));
+      if (edit.variation >= 'A' && edit.variation <= 'Z') {
+        ++offset_;
+      }
+    }
 
-  if (edit.descriptor == 'A') { // width is optional for A[w]
-    auto ch{PeekNext()};
-    if (ch >= '0' && ch <= '9') {
+    if (edit.descriptor == 'A') { // width is optional for A[w]
+      auto ch{PeekNext()};
+      if (ch >= '0' && ch <= '9') {
+        edit.width = GetIntField(context);
+      }
+    } else {
       edit.width = GetIntField(context);
     }
-  } else {
-    edit.width = GetIntField(context);
-  }
-  edit.modes = context.mutableModes();
-  if (PeekNext() == '.') {
-    ++offset_;
-    edit.digits = GetIntField(context);
-    CharType ch{PeekNext()};
-    if (ch == 'e' || ch == 'E' || ch == 'd' || ch == 'D') {
+    edit.modes = context.mutableModes();
+    if (PeekNext() == '.') {
       ++offset_;
-      edit.expoDigits = GetIntField(context);
+      edit.digits = GetIntField(context);
+      CharType ch{PeekNext()};
+      if (ch == 'e' || ch == 'E' || ch == 'd' || ch == 'D') {
+        ++offset_;
+        edit.expoDigits = GetIntField(context);
+      }
+    }
+    if (!context.InError()) {
+      CachedDataEdit &entry{cachedDataEdits_[nextCachedDataEdit_]};
+      nextCachedDataEdit_ = (nextCachedDataEdit_ + 1) % maxCachedDataEdits;
+      entry.start = start;
+      entry.end = offset_;
+      entry.edit = edit;
     }
   }
 
@@ -140,6 +140,16 @@ private:
   // pointing to the data edit.
   int CueUpNextDataEdit(Context &, bool stop = false);
 
+  // Data edit descriptors that have already been parsed, by offset, so that
+  // the repeated descriptors and those reached again by format reversion
+  // (13.4(8)) aren't parsed anew for each item.
+  struct CachedDataEdit {
+    int start{-1}; // offset of the descriptor, after its repeat count
+    int end{0}; // offset just past the descriptor
+    DataEdit edit; // its modes are replaced by the current ones
+  };
+  static constexpr int maxCachedDataEdits{4};
+
   static constexpr CharType Capitalize(CharType ch) {
     return ch >= 'a' && ch <= 'z' ? ch + 'A' - 'a' : ch;
   }
@@ -152,6 +162,8 @@ private:
   const CharType *format_{nullptr};
   int formatLength_{0};
   int offset_{0}; // next item is at format_[offset_]
+  int nextCachedDataEdit_{0}; // replaced next, round-robin
+  CachedDataEdit cachedDataEdits_[maxCachedDataEdits];
 
   // must be last, may be incomplete
   Iteration stack_[maxMaxHeight];
@@ -253,6 +253,24 @@ bool ExternalFileUnit::Emit(const char *data, std::size_t bytes,
         static_cast<std::intmax_t>(*recordLength));
     return false;
   }
+  if (directRecord_ || MayEmitDirectly(bytes)) {
+    // Large blocks of unformatted data bypass the frame, which would otherwise
+    // grow to hold the whole record and copy it.  What the frame holds of the
+    // record is written first; the rest of the record, including the
+    // completion of its header, goes straight to the file too.
+    if (!directRecord_) {
+      Flush(handler);
+      directRecord_ = true;
+    }
+    auto at{frameOffsetInFile_ +
+        static_cast<std::int64_t>(recordOffsetInFrame_) + positionInRecord};
+    if (Write(at, data, bytes, handler) < bytes) {
+      return false;
+    }
+    positionInRecord += bytes;
+    furthestPositionInRecord = furthestAfter;
+    return true;
+  }
   WriteFrame(frameOffsetInFile_, recordOffsetInFrame_ + furthestAfter, handler);
   if (positionInRecord > furthestPositionInRecord) {
     std::memset(Frame() + recordOffsetInFrame_ + furthestPositionInRecord, ' ',
@@ -439,12 +457,23 @@ bool ExternalFileUnit::AdvanceRecord(IoErrorHandler &handler) {
         recordOffsetInFrame_ + recordLength.value_or(furthestPositionInRecord);
     recordOffsetInFrame_ = 0;
     impliedEndfile_ = true;
+    directRecord_ = false;
     ++currentRecordNumber;
     BeginRecord();
   }
   return ok;
 }
 
+// Only the variable-length unformatted records can be written directly, as
+// the padding of the fixed-length ones and the conversion of the data need
+// the frame; the completion of the header needs a positionable file.
+bool ExternalFileUnit::MayEmitDirectly(std::size_t bytes) const {
+  return direction_ == Direction::Output && isUnformatted &&
+      !isFixedRecordLength && !swapEndianness_ && mayPosition() &&
+      positionInRecord == furthestPositionInRecord &&
+      bytes >= FileFrame<ExternalFileUnit>::MinBufferSize();
+}
+
 void ExternalFileUnit::BackspaceRecord(IoErrorHandler &handler) {
   if (access != Access::Sequential) {
     handler.SignalError(IostatBackspaceNonSequential,
@@ -102,6 +102,7 @@ private:
   bool SetSequentialVariableFormattedRecordLength();
   void DoImpliedEndfile(IoErrorHandler &);
   void DoEndfile(IoErrorHandler &);
+  bool MayEmitDirectly(std::size_t bytes) const;
 
   int unitNumber_{-1};
   Direction direction_{Direction::Output};
@@ -132,6 +133,10 @@ private:
   std::size_t recordOffsetInFrame_{0}; // of currentRecordNumber
 
   bool swapEndianness_{false};
+
+  // Set when the current output record is written straight to the file
+  // rather than through the frame, after a large block of unformatted data.
+  bool directRecord_{false};
 };
 
 } // namespace Fortran::runtime::io
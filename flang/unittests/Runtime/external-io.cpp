@@ -306,6 +306,92 @@ void TestSequentialVariableUnformatted() {
   llvm::errs() << "end TestSequentialVariableUnformatted()\n";
 }
 
+void TestSequentialLargeUnformatted() {
+  llvm::errs() << "begin TestSequentialLargeUnformatted()\n";
+  // OPEN(NEWUNIT=unit,ACCESS='SEQUENTIAL',ACTION='READWRITE',&
+  //   FORM='UNFORMATTED',STATUS='SCRATCH')
+  auto io{IONAME(BeginOpenNewUnit)(__FILE__, __LINE__)};
+  IONAME(SetAccess)
+  (io, "SEQUENTIAL", 10) || (Fail() << "SetAccess(SEQUENTIAL)", 0);
+  IONAME(SetAction)
+  (io, "READWRITE", 9) || (Fail() << "SetAction(READWRITE)", 0);
+  IONAME(SetForm)
+  (io, "UNFORMATTED", 11) || (Fail() << "SetForm(UNFORMATTED)", 0);
+  IONAME(SetStatus)(io, "SCRATCH", 7) || (Fail() << "SetStatus(SCRATCH)", 0);
+  int unit{-1};
+  IONAME(GetNewUnit)(io, unit) || (Fail() << "GetNewUnit()", 0);
+  llvm::errs() << "unit=" << unit << '\n';
+  IONAME(EndIoStatement)
+  (io) == IostatOk || (Fail() << "EndIoStatement() for OpenNewUnit", 0);
+  // The arrays are larger than the buffer, so that they're written directly
+  // between the items that are buffered.
+  static const int records{3};
+  static const int elements{32 * 1024};
+  static std::int64_t buffer[elements];
+  for (int j{1}; j <= records; ++j) {
+    // WRITE(UNIT=unit) J, [(J+K,K=0,ELEMENTS-1)], -J
+    for (int k{0}; k < elements; ++k) {
+      buffer[k] = j + k;
+    }
+    std::int64_t before{j}, after{-j};
+    io = IONAME(BeginUnformattedOutput)(unit, __FILE__, __LINE__);
+    IONAME(OutputUnformattedBlock)
+    (io, reinterpret_cast<const char *>(&before), sizeof before,
+        sizeof before) ||
+        (Fail() << "OutputUnformattedBlock() before", 0);
+    IONAME(OutputUnformattedBlock)
+    (io, reinterpret_cast<const char *>(&buffer), sizeof buffer,
+        sizeof *buffer) ||
+        (Fail() << "OutputUnformattedBlock()", 0);
+    IONAME(OutputUnformattedBlock)
+    (io, reinterpret_cast<const char *>(&after), sizeof after, sizeof after) ||
+        (Fail() << "OutputUnformattedBlock() after", 0);
+    IONAME(EndIoStatement)
+    (io) == IostatOk ||
+        (Fail() << "EndIoStatement() for OutputUnformattedBlock", 0);
+  }
+  // REWIND(UNIT=unit)
+  io = IONAME(BeginRewind)(unit, __FILE__, __LINE__);
+  IONAME(EndIoStatement)
+  (io) == IostatOk || (Fail() << "EndIoStatement() for Rewind", 0);
+  for (int j{1}; j <= records; ++j) {
+    // READ(UNIT=unit) before, buffer, after; check
+    std::int64_t before{0}, after{0};
+    io = IONAME(BeginUnformattedInput)(unit, __FILE__, __LINE__);
+    IONAME(InputUnformattedBlock)
+    (io, reinterpret_cast<char *>(&before), sizeof before, sizeof before) ||
+        (Fail() << "InputUnformattedBlock() before", 0);
+    IONAME(InputUnformattedBlock)
+    (io, reinterpret_cast<char *>(&buffer), sizeof buffer, sizeof *buffer) ||
+        (Fail() << "InputUnformattedBlock()", 0);
+    IONAME(InputUnformattedBlock)
+    (io, reinterpret_cast<char *>(&after), sizeof after, sizeof after) ||
+        (Fail() << "InputUnformattedBlock() after", 0);
+    IONAME(EndIoStatement)
+    (io) == IostatOk ||
+        (Fail() << "EndIoStatement() for InputUnformattedBlock", 0);
+    if (before != j || after != -j) {
+      Fail() << "Read back " << before << " and " << after
+             << " around the array of record " << j << ", expected " << j
+             << " and " << -j << '\n';
+    }
+    for (int k{0}; k < elements; ++k) {
+      if (buffer[k] != j + k) {
+        Fail() << "Read back [" << k << "]=" << buffer[k]
+               << " from sequential unformatted record " << j << ", expected "
+               << j + k << '\n';
+        break;
+      }
+    }
+  }
+  // CLOSE(UNIT=unit,STATUS='DELETE')
+  io = IONAME(BeginClose)(unit, __FILE__, __LINE__);
+  IONAME(SetStatus)(io, "DELETE", 6) || (Fail() << "SetStatus(DELETE)", 0);
+  IONAME(EndIoStatement)
+  (io) == IostatOk || (Fail() << "EndIoStatement() for Close", 0);
+  llvm::errs() << "end TestSequentialLargeUnformatted()\n";
+}
+
 void TestDirectFormatted() {
   llvm::errs() << "begin TestDirectFormatted()\n";
   // OPEN(NEWUNIT=unit,ACCESS='DIRECT',ACTION='READWRITE',&
@@ -462,6 +548,7 @@ int main() {
   TestDirectUnformattedSwapped();
   TestSequentialFixedUnformatted();
   TestSequentialVariableUnformatted();
+  TestSequentialLargeUnformatted();
   TestDirectFormatted();
   TestSequentialVariableFormatted();
   TestStreamUnformatted();
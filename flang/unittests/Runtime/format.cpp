@@ -135,5 +135,9 @@ int main() {
   Test(2, "(*('PI=',F9.7,:),'tooFar')",
       Results{"'PI='", "F9.7", "'PI='", "F9.7"});
   Test(1, "(3F9.7)", Results{"2*F9.7"}, 2);
+  Test(5, "(2I4,3F9.7)", Results{"I4", "I4", "F9.7", "F9.7", "F9.7"});
+  Test(10, "(I4,F9.7,D10.3E2,ES12.4,A,EN9.2)",
+      Results{"I4", "F9.7", "D10.3E2", "ES12.4", "A", "EN9.2", "/", "I4",
+          "F9.7", "D10.3E2", "ES12.4"});
   return EndTests();
 }
@@ -495,6 +495,9 @@ int main() {
   realTest("(F5.3,';')", -0.0025, "-.003;");
   realTest("(F5.3,';')", -0.00025, "-.000;");
   realTest("(F5.3,';')", -0.000025, "-.000;");
+  realTest("(F6.3,';')", 9.9996, "10.000;");
+  realTest("(F5.1,';')", 99.96, "100.0;");
+  realTest("(F5.1,';')", -9.96, "-10.0;");
 
   realInTest("(F18.0)", "                 0", 0x0);
   realInTest("(F18.0)", "                  ", 0x0);
@@ -0,0 +1,147 @@
+//===-- Benchmark memory functions on size distributions ------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Measures the throughput of llvm-libc and system memcpy and memset on the
+// sizes drawn from the distributions of MemorySizeDistributions.h, which were
+// observed on production workloads. As opposed to the sweeps over sizes of
+// the other benchmarks, this measures the cost of the branches and of the
+// implementation switches for realistic mixes of sizes.
+//
+//===----------------------------------------------------------------------===//
+
+#include "LibcMemoryBenchmark.h"
+#include "MemorySizeDistributions.h"
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/MathExtras.h"
+
+#include <cstring>
+#include <random>
+
+namespace __llvm_libc {
+void *memcpy(void *__restrict, const void *__restrict, size_t);
+void *memset(void *, int, size_t);
+} // namespace __llvm_libc
+
+namespace llvm {
+namespace libc_benchmarks {
+
+// The number of sizes and offsets drawn beforehand, cycled through by the
+// benchmarks. They all fit in the L1 cache.
+static constexpr size_t kBatchSize = 1024;
+// The offsets are drawn in [0, kMaxOffset) so that the buffers are accessed
+// with all the alignments.
+static constexpr size_t kMaxOffset = 64;
+
+struct Call {
+  uint32_t Size;
+  uint32_t SrcOffset;
+  uint32_t DstOffset;
+};
+
+// Draws `kBatchSize` calls from `Distribution`.
+static std::vector<Call> drawCalls(const MemorySizeDistribution &Distribution) {
+  std::mt19937_64 Gen(0);
+  std::discrete_distribution<uint32_t> SizeDistribution(
+      Distribution.Probabilities.begin(), Distribution.Probabilities.end());
+  std::uniform_int_distribution<uint32_t> OffsetDistribution(0,
+                                                             kMaxOffset - 1);
+  std::vector<Call> Calls(kBatchSize);
+  for (Call &C : Calls) {
+    C.Size = SizeDistribution(Gen);
+    C.SrcOffset = OffsetDistribution(Gen);
+    C.DstOffset = OffsetDistribution(Gen);
+  }
+  return Calls;
+}
+
+// AlignedBuffer sizes must be multiples of its alignment.
+static size_t getBufferSize(size_t Size) {
+  return alignTo(Size, AlignedBuffer::Alignment);
+}
+
+using MemcpyFunction = void *(*)(void *__restrict, const void *__restrict,
+                                 size_t);
+using MemsetFunction = void *(*)(void *, int, size_t);
+
+static void benchmarkMemcpy(benchmark::State &State,
+                            const MemorySizeDistribution &Distribution,
+                            MemcpyFunction Function) {
+  const std::vector<Call> Calls = drawCalls(Distribution);
+  const size_t BufferSize =
+      getBufferSize(Distribution.Probabilities.size() + kMaxOffset);
+  AlignedBuffer Src(BufferSize);
+  AlignedBuffer Dst(BufferSize);
+  std::memset(Src.begin(), 'a', BufferSize);
+  size_t Bytes = 0;
+  for (auto _ : State) {
+    for (const Call &C : Calls) {
+      Function(Dst + C.DstOffset, Src + C.SrcOffset, C.Size);
+      Bytes += C.Size;
+    }
+    benchmark::ClobberMemory();
+  }
+  State.SetBytesProcessed(Bytes);
+  State.SetItemsProcessed(State.iterations() * Calls.size());
+}
+
+static void benchmarkMemset(benchmark::State &State,
+                            const MemorySizeDistribution &Distribution,
+                            MemsetFunction Function) {
+  const std::vector<Call> Calls = drawCalls(Distribution);
+  const size_t BufferSize =
+      getBufferSize(Distribution.Probabilities.size() + kMaxOffset);
+  AlignedBuffer Dst(BufferSize);
+  size_t Bytes = 0;
+  for (auto _ : State) {
+    for (const Call &C : Calls) {
+      Function(Dst + C.DstOffset, C.Size & 0xFF, C.Size);
+      Bytes += C.Size;
+    }
+    benchmark::ClobberMemory();
+  }
+  State.SetBytesProcessed(Bytes);
+  State.SetItemsProcessed(State.iterations() * Calls.size());
+}
+
+// Registers one benchmark per distribution and implementation, e.g.
+// `memcpy/memcpy Google A/llvm-libc`.
+static void registerBenchmarks() {
+  for (const MemorySizeDistribution &Distribution :
+       getMemcpySizeDistributions()) {
+    const std::string Prefix =
+        (Twine("memcpy/") + Distribution.Name + "/").str();
+    benchmark::RegisterBenchmark((Prefix + "llvm-libc").c_str(),
+                                 benchmarkMemcpy, Distribution,
+                                 &__llvm_libc::memcpy);
+    benchmark::RegisterBenchmark((Prefix + "system").c_str(),
+                                 benchmarkMemcpy, Distribution, &::memcpy);
+  }
+  for (const MemorySizeDistribution &Distribution :
+       getMemsetSizeDistributions()) {
+    const std::string Prefix =
+        (Twine("memset/") + Distribution.Name + "/").str();
+    benchmark::RegisterBenchmark((Prefix + "llvm-libc").c_str(),
+                                 benchmarkMemset, Distribution,
+                                 &__llvm_libc::memset);
+    benchmark::RegisterBenchmark((Prefix + "system").c_str(),
+                                 benchmarkMemset, Distribution, &::memset);
+  }
+}
+
+} // namespace libc_benchmarks
+} // namespace llvm
+
+int main(int argc, char **argv) {
+  llvm::libc_benchmarks::registerBenchmarks();
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
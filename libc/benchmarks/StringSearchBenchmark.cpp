@@ -0,0 +1,120 @@
+//===-- Benchmark strlen, memchr and strchr -------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Measures the llvm-libc and system byte searches for the lengths and the
+// alignments of the strings, searched to their end. The strings fit in the L1
+// cache, so that the loops are measured rather than the memory.
+//
+//===----------------------------------------------------------------------===//
+
+#include "LibcMemoryBenchmark.h"
+#include "benchmark/benchmark.h"
+
+#include <cstring>
+
+namespace __llvm_libc {
+size_t strlen(const char *);
+void *memchr(const void *, int, size_t);
+char *strchr(const char *, int);
+} // namespace __llvm_libc
+
+namespace llvm {
+namespace libc_benchmarks {
+
+static constexpr size_t kMaxLength = 4096;
+static constexpr size_t kMaxAlignment = 64;
+static_assert(kMaxLength + kMaxAlignment < 2 * kMaxLength, "");
+
+// A string of `Length` 'a' followed by a null terminator, starting
+// `Alignment` bytes after an address aligned to `AlignedBuffer::Alignment`.
+struct SearchedString {
+  // The size of AlignedBuffer must be a multiple of its alignment.
+  AlignedBuffer Buffer{2 * kMaxLength};
+  const char *Str;
+
+  SearchedString(size_t Length, size_t Alignment) {
+    std::memset(Buffer.begin(), 'a', Alignment + Length);
+    Buffer[Alignment + Length] = '\0';
+    Str = Buffer + Alignment;
+  }
+};
+
+template <size_t (*Strlen)(const char *)>
+static void benchmarkStrlen(benchmark::State &State) {
+  const size_t Length = State.range(0);
+  const SearchedString S(Length, State.range(1));
+  for (auto _ : State) {
+    const char *Str = S.Str;
+    benchmark::DoNotOptimize(Str);
+    benchmark::DoNotOptimize(Strlen(Str));
+  }
+  State.SetBytesProcessed(State.iterations() * Length);
+}
+
+template <void *(*Memchr)(const void *, int, size_t)>
+static void benchmarkMemchr(benchmark::State &State) {
+  const size_t Length = State.range(0);
+  const SearchedString S(Length, State.range(1));
+  for (auto _ : State) {
+    const char *Str = S.Str;
+    benchmark::DoNotOptimize(Str);
+    // Searches the null terminator, i.e. the whole string.
+    benchmark::DoNotOptimize(Memchr(Str, '\0', Length + 1));
+  }
+  State.SetBytesProcessed(State.iterations() * Length);
+}
+
+template <const char *(*Strchr)(const char *, int)>
+static void benchmarkStrchr(benchmark::State &State) {
+  const size_t Length = State.range(0);
+  const SearchedString S(Length, State.range(1));
+  for (auto _ : State) {
+    const char *Str = S.Str;
+    benchmark::DoNotOptimize(Str);
+    // The character is not found, the whole string is searched.
+    benchmark::DoNotOptimize(Strchr(Str, 'b'));
+  }
+  State.SetBytesProcessed(State.iterations() * Length);
+}
+
+static size_t llvmLibcStrlen(const char *Str) {
+  return __llvm_libc::strlen(Str);
+}
+static size_t systemStrlen(const char *Str) { return ::strlen(Str); }
+static void *llvmLibcMemchr(const void *Src, int C, size_t N) {
+  return __llvm_libc::memchr(Src, C, N);
+}
+static void *systemMemchr(const void *Src, int C, size_t N) {
+  return const_cast<void *>(::memchr(Src, C, N));
+}
+static const char *llvmLibcStrchr(const char *Str, int C) {
+  return __llvm_libc::strchr(Str, C);
+}
+static const char *systemStrchr(const char *Str, int C) {
+  return ::strchr(Str, C);
+}
+
+// The lengths are the powers of two up to `kMaxLength`. The strings are
+// aligned, or start at the second or last byte of a 32 byte vector.
+static void searchArguments(benchmark::internal::Benchmark *B) {
+  for (size_t Length = 1; Length <= kMaxLength; Length *= 2)
+    for (size_t Alignment : {0, 1, 31})
+      B->Args({static_cast<int64_t>(Length), static_cast<int64_t>(Alignment)});
+}
+
+BENCHMARK_TEMPLATE(benchmarkStrlen, llvmLibcStrlen)->Apply(searchArguments);
+BENCHMARK_TEMPLATE(benchmarkStrlen, systemStrlen)->Apply(searchArguments);
+BENCHMARK_TEMPLATE(benchmarkMemchr, llvmLibcMemchr)->Apply(searchArguments);
+BENCHMARK_TEMPLATE(benchmarkMemchr, systemMemchr)->Apply(searchArguments);
+BENCHMARK_TEMPLATE(benchmarkStrchr, llvmLibcStrchr)->Apply(searchArguments);
+BENCHMARK_TEMPLATE(benchmarkStrchr, systemStrchr)->Apply(searchArguments);
+
+} // namespace libc_benchmarks
+} // namespace llvm
+
+BENCHMARK_MAIN();
@@ -0,0 +1,21 @@
+//===-- Single-precision e^x function for AdvSIMD -------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/math/aarch64/vector_math.h"
+#include "src/math/vector_exp_utils.h"
+
+#include "src/__support/common.h"
+
+namespace __llvm_libc {
+
+VPCS_ATTR vector_math::VFloat<4>
+LLVM_LIBC_ENTRYPOINT(_ZGVnN4v_expf)(vector_math::VFloat<4> x) {
+  return vector_math::expf<4>(x);
+}
+
+} // namespace __llvm_libc
@@ -0,0 +1,21 @@
+//===-- Single-precision sin function for AdvSIMD -------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/math/aarch64/vector_math.h"
+#include "src/math/vector_sincosf_utils.h"
+
+#include "src/__support/common.h"
+
+namespace __llvm_libc {
+
+VPCS_ATTR vector_math::VFloat<4>
+LLVM_LIBC_ENTRYPOINT(_ZGVnN4v_sinf)(vector_math::VFloat<4> x) {
+  return vector_math::sinf<4>(x);
+}
+
+} // namespace __llvm_libc
@@ -0,0 +1,28 @@
+//===-- Implementation header for the AArch64 vector math -------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIBC_SRC_MATH_AARCH64_VECTOR_MATH_H
+#define LLVM_LIBC_SRC_MATH_AARCH64_VECTOR_MATH_H
+
+#include "src/math/vector_math_utils.h"
+
+#define VPCS_ATTR __attribute__((aarch64_vector_pcs))
+
+namespace __llvm_libc {
+
+// The variants for AdvSIMD (ISA letter n of the vector function ABI), which
+// use the vector procedure call standard like the ABI requires.
+
+VPCS_ATTR vector_math::VFloat<4> _ZGVnN4v_expf(vector_math::VFloat<4> x);
+VPCS_ATTR vector_math::VFloat<4> _ZGVnN4v_exp2f(vector_math::VFloat<4> x);
+VPCS_ATTR vector_math::VFloat<4> _ZGVnN4v_sinf(vector_math::VFloat<4> x);
+VPCS_ATTR vector_math::VFloat<4> _ZGVnN4v_cosf(vector_math::VFloat<4> x);
+
+} // namespace __llvm_libc
+
+#endif // LLVM_LIBC_SRC_MATH_AARCH64_VECTOR_MATH_H
@@ -0,0 +1,94 @@
+//===-- Vector implementations of expf and exp2f ----------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIBC_SRC_MATH_VECTOR_EXP_UTILS_H
+#define LLVM_LIBC_SRC_MATH_VECTOR_EXP_UTILS_H
+
+#include "exp2f.h"
+#include "expf.h"
+#include "vector_math_utils.h"
+
+namespace __llvm_libc {
+namespace vector_math {
+
+// 1.5 * 2^23, adding it rounds a float of magnitude below 2^22 to an integer
+// which ends up in the low bits of the sum.
+static constexpr float round_shift = 0x1.8p23f;
+
+// Return 2^n * (1 + poly), where r = x - n is in [-1/2, 1/2] for exp2f or
+// x - n * ln(2) is in [-ln(2)/2, ln(2)/2] for expf, and z is n + round_shift.
+// The lanes for which |n| > 126, i.e. for which 2^n isn't a normal float or
+// x is a NaN, are not handled.
+template <size_t N>
+static inline VFloat<N> exp2_scale(VFloat<N> z, VFloat<N> poly) {
+  VFloat<N> scale = as_float<N>((as_uint32_bits<N>(z) << 23) + 0x3f800000U);
+  return poly * scale + scale;
+}
+
+// Vector version of expf, with a maximum error of 2 ULP. The polynomial is
+// the one of the vector routines of the optimized-routines project, whose
+// error is 1.45 ULP.
+template <size_t N> static inline VFloat<N> expf(VFloat<N> x) {
+  constexpr float inv_ln2 = 0x1.715476p+0f;
+  // ln(2) split so that n * ln2_hi is exact.
+  constexpr float ln2_hi = 0x1.62e4p-1f;
+  constexpr float ln2_lo = 0x1.7f7d1cp-20f;
+  constexpr float c0 = 0x1.0e4020p-7f, c1 = 0x1.573e2ep-5f,
+                  c2 = 0x1.555e66p-3f, c3 = 0x1.fffdb6p-2f,
+                  c4 = 0x1.ffffecp-1f;
+
+  // exp(x) = 2^n * (1 + poly(r)) with x = n * ln(2) + r.
+  VFloat<N> z = x * inv_ln2 + round_shift;
+  VFloat<N> n = z - round_shift;
+  VFloat<N> r = n * -ln2_hi + x;
+  r = n * -ln2_lo + r;
+
+  VFloat<N> r2 = r * r;
+  VFloat<N> p = c0 * r + c1;
+  VFloat<N> q = c2 * r + c3;
+  q = p * r2 + q;
+  VFloat<N> poly = q * r2 + c4 * r;
+  VFloat<N> y = exp2_scale<N>(z, poly);
+
+  // Overflows, underflows, infinities and NaNs are left to the scalar code.
+  VMask<N> special = ~(abs<N>(n) <= 126.0f);
+  if (unlikely(any<N>(special)))
+    return call_scalar<N>(__llvm_libc::expf, x, y, special);
+  return y;
+}
+
+// Vector version of exp2f, with a maximum error of 2 ULP. The polynomial
+// is the one of the vector routines of the optimized-routines project, whose
+// error is 1.962 ULP.
+template <size_t N> static inline VFloat<N> exp2f(VFloat<N> x) {
+  constexpr float c0 = 0x1.59977ap-10f, c1 = 0x1.3ce9e4p-7f,
+                  c2 = 0x1.c6bd32p-5f, c3 = 0x1.ebf9bcp-3f,
+                  c4 = 0x1.62e422p-1f;
+
+  // exp2(x) = 2^n * (1 + poly(r)) with x = n + r.
+  VFloat<N> z = x + round_shift;
+  VFloat<N> n = z - round_shift;
+  VFloat<N> r = x - n;
+
+  VFloat<N> r2 = r * r;
+  VFloat<N> p = c0 * r + c1;
+  VFloat<N> q = c2 * r + c3;
+  q = p * r2 + q;
+  VFloat<N> poly = q * r2 + c4 * r;
+  VFloat<N> y = exp2_scale<N>(z, poly);
+
+  VMask<N> special = ~(abs<N>(n) <= 126.0f);
+  if (unlikely(any<N>(special)))
+    return call_scalar<N>(__llvm_libc::exp2f, x, y, special);
+  return y;
+}
+
+} // namespace vector_math
+} // namespace __llvm_libc
+
+#endif // LLVM_LIBC_SRC_MATH_VECTOR_EXP_UTILS_H
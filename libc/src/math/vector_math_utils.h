@@ -0,0 +1,86 @@
+//===-- Collection of utils for vector math functions -----------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIBC_SRC_MATH_VECTOR_MATH_UTILS_H
+#define LLVM_LIBC_SRC_MATH_VECTOR_MATH_UTILS_H
+
+#include "src/__support/common.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// The vector variants of the math functions are written once for any number
+// of lanes with the vector extension of GCC and Clang, and instantiated for
+// the vector registers of each target. They are named after the vector
+// function ABI, e.g. _ZGVbN4v_expf, so that the loop vectorizer can replace
+// calls to the scalar functions by calls to them.
+//
+// The exact multiply-adds of the algorithms are written a * b + c, and the
+// variants are built with -ffp-contract=fast so that they are fused on the
+// targets which have FMA instructions. LIBC_VECTOR_MATH_HAS_FMA tells which
+// targets do, for the algorithms which need another path without them.
+#if defined(__FMA__) || defined(__ARM_FEATURE_FMA)
+#define LIBC_VECTOR_MATH_HAS_FMA 1
+#else
+#define LIBC_VECTOR_MATH_HAS_FMA 0
+#endif
+
+namespace __llvm_libc {
+namespace vector_math {
+
+template <typename T, size_t N> struct VectorType {
+  typedef T Type __attribute__((vector_size(N * sizeof(T))));
+};
+
+template <size_t N> using VFloat = typename VectorType<float, N>::Type;
+template <size_t N> using VDouble = typename VectorType<double, N>::Type;
+template <size_t N> using VUInt32 = typename VectorType<uint32_t, N>::Type;
+// The type of the lane-wise comparisons of VFloat<N>, whose lanes are all
+// ones when true and zero otherwise.
+template <size_t N> using VMask = typename VectorType<int32_t, N>::Type;
+
+template <size_t N> static inline VUInt32<N> as_uint32_bits(VFloat<N> x) {
+  return reinterpret_cast<VUInt32<N> &>(x);
+}
+
+template <size_t N> static inline VFloat<N> as_float(VUInt32<N> x) {
+  return reinterpret_cast<VFloat<N> &>(x);
+}
+
+template <size_t N> static inline VUInt32<N> as_uint32_bits(VMask<N> x) {
+  return reinterpret_cast<VUInt32<N> &>(x);
+}
+
+template <size_t N> static inline VFloat<N> abs(VFloat<N> x) {
+  return as_float<N>(as_uint32_bits<N>(x) & 0x7fffffffU);
+}
+
+template <size_t N> static inline bool any(VMask<N> mask) {
+  int32_t acc = 0;
+  for (size_t i = 0; i < N; ++i)
+    acc |= mask[i];
+  return acc != 0;
+}
+
+// Replace the lanes of y where mask is true by the result of the scalar
+// function on the same lanes of x. The vector functions use it for the
+// inputs their fast path doesn't handle, so that these get exactly the
+// results and the errno of the scalar functions.
+template <size_t N, typename ScalarFunc>
+static inline VFloat<N> call_scalar(ScalarFunc func, VFloat<N> x,
+                                    VFloat<N> y, VMask<N> mask) {
+  for (size_t i = 0; i < N; ++i)
+    if (mask[i])
+      y[i] = func(x[i]);
+  return y;
+}
+
+} // namespace vector_math
+} // namespace __llvm_libc
+
+#endif // LLVM_LIBC_SRC_MATH_VECTOR_MATH_UTILS_H
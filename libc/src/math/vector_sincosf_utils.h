@@ -0,0 +1,110 @@
+//===-- Vector implementations of sinf and cosf -----------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIBC_SRC_MATH_VECTOR_SINCOSF_UTILS_H
+#define LLVM_LIBC_SRC_MATH_VECTOR_SINCOSF_UTILS_H
+
+#include "cosf.h"
+#include "sinf.h"
+#include "vector_math_utils.h"
+
+namespace __llvm_libc {
+namespace vector_math {
+
+// Inputs of magnitude from this one, infinities and NaNs are left to the
+// scalar code, whose range reduction is exact.
+static constexpr uint32_t sincosf_range_limit = 0x49800000U; // 0x1p20f
+
+// Return |x| - n * PI, where n is an integer or an integer and a half whose
+// magnitude is below 2^20 / PI.
+template <size_t N>
+static inline VFloat<N> sincosf_reduce(VFloat<N> ax, VFloat<N> n) {
+#if LIBC_VECTOR_MATH_HAS_FMA
+  // PI split in three floats, each product by n being exact when fused with
+  // its subtraction.
+  constexpr float pi1 = 0x1.921fb6p+1f;
+  constexpr float pi2 = -0x1.777a5cp-24f;
+  constexpr float pi3 = -0x1.ee59dap-49f;
+  VFloat<N> r = n * -pi1 + ax;
+  r = n * -pi2 + r;
+  return n * -pi3 + r;
+#else
+  // Without FMA, reduce in double precision with PI split in two doubles,
+  // the first one having few enough bits for its product by n to be exact.
+  constexpr double pi_hi = 0x1.921fb544p+1;
+  constexpr double pi_lo = 0x1.0b4611a626331p-33;
+  VDouble<N> nd = __builtin_convertvector(n, VDouble<N>);
+  VDouble<N> r = __builtin_convertvector(ax, VDouble<N>) - nd * pi_hi;
+  r -= nd * pi_lo;
+  return __builtin_convertvector(r, VFloat<N>);
+#endif
+}
+
+// Return sin(r) for r in [-PI/2, PI/2], with a maximum error of 1.886 ULP.
+// The polynomial is the one of the vector routines of the
+// optimized-routines project.
+template <size_t N> static inline VFloat<N> sincosf_poly(VFloat<N> r) {
+  constexpr float a3 = -0x1.555548p-3f, a5 = 0x1.110df4p-7f,
+                  a7 = -0x1.9f42eap-13f, a9 = 0x1.5b2e76p-19f;
+  VFloat<N> r2 = r * r;
+  VFloat<N> y = a9 * r2 + a7;
+  y = y * r2 + a5;
+  y = y * r2 + a3;
+  return (y * r2) * r + r;
+}
+
+// Vector version of sinf, with a maximum error of 1.9 ULP on the targets with
+// FMA and of 2.1 ULP on the others.
+template <size_t N> static inline VFloat<N> sinf(VFloat<N> x) {
+  constexpr float inv_pi = 0x1.45f306p-2f;
+  constexpr float round_shift = 0x1.8p23f;
+
+  VUInt32<N> xi = as_uint32_bits<N>(x);
+  VUInt32<N> sign = xi & 0x80000000U;
+  VFloat<N> ax = abs<N>(x);
+
+  // sin(x) = (-1)^n * sin(|x| - n * PI) * sign(x), with n = rint(|x| / PI).
+  VFloat<N> z = inv_pi * ax + round_shift;
+  VUInt32<N> odd = as_uint32_bits<N>(z) << 31;
+  VFloat<N> n = z - round_shift;
+  VFloat<N> y = sincosf_poly<N>(sincosf_reduce<N>(ax, n));
+  y = as_float<N>(as_uint32_bits<N>(y) ^ sign ^ odd);
+
+  VMask<N> special = as_uint32_bits<N>(ax) >= sincosf_range_limit;
+  if (unlikely(any<N>(special)))
+    return call_scalar<N>(__llvm_libc::sinf, x, y, special);
+  return y;
+}
+
+// Vector version of cosf, with a maximum error of 1.9 ULP on the targets with
+// FMA and of 2.1 ULP on the others.
+template <size_t N> static inline VFloat<N> cosf(VFloat<N> x) {
+  constexpr float inv_pi = 0x1.45f306p-2f;
+  constexpr float half_pi = 0x1.921fb6p0f;
+  constexpr float round_shift = 0x1.8p23f;
+
+  VFloat<N> ax = abs<N>(x);
+
+  // cos(x) = (-1)^n * sin(|x| - (n - 1/2) * PI), with
+  // n = rint((|x| + PI/2) / PI).
+  VFloat<N> z = inv_pi * (ax + half_pi) + round_shift;
+  VUInt32<N> odd = as_uint32_bits<N>(z) << 31;
+  VFloat<N> n = (z - round_shift) - 0.5f;
+  VFloat<N> y = sincosf_poly<N>(sincosf_reduce<N>(ax, n));
+  y = as_float<N>(as_uint32_bits<N>(y) ^ odd);
+
+  VMask<N> special = as_uint32_bits<N>(ax) >= sincosf_range_limit;
+  if (unlikely(any<N>(special)))
+    return call_scalar<N>(__llvm_libc::cosf, x, y, special);
+  return y;
+}
+
+} // namespace vector_math
+} // namespace __llvm_libc
+
+#endif // LLVM_LIBC_SRC_MATH_VECTOR_SINCOSF_UTILS_H
@@ -0,0 +1,21 @@
+//===-- Single-precision cos function for AVX-512 -------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/math/x86_64/vector_math.h"
+#include "src/math/vector_sincosf_utils.h"
+
+#include "src/__support/common.h"
+
+namespace __llvm_libc {
+
+vector_math::VFloat<16>
+LLVM_LIBC_ENTRYPOINT(_ZGVeN16v_cosf)(vector_math::VFloat<16> x) {
+  return vector_math::cosf<16>(x);
+}
+
+} // namespace __llvm_libc
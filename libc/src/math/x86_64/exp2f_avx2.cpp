@@ -0,0 +1,21 @@
+//===-- Single-precision 2^x function for AVX2 ----------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/math/x86_64/vector_math.h"
+#include "src/math/vector_exp_utils.h"
+
+#include "src/__support/common.h"
+
+namespace __llvm_libc {
+
+vector_math::VFloat<8>
+LLVM_LIBC_ENTRYPOINT(_ZGVdN8v_exp2f)(vector_math::VFloat<8> x) {
+  return vector_math::exp2f<8>(x);
+}
+
+} // namespace __llvm_libc
@@ -0,0 +1,21 @@
+//===-- Single-precision sin function for AVX2 ----------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/math/x86_64/vector_math.h"
+#include "src/math/vector_sincosf_utils.h"
+
+#include "src/__support/common.h"
+
+namespace __llvm_libc {
+
+vector_math::VFloat<8>
+LLVM_LIBC_ENTRYPOINT(_ZGVdN8v_sinf)(vector_math::VFloat<8> x) {
+  return vector_math::sinf<8>(x);
+}
+
+} // namespace __llvm_libc
@@ -0,0 +1,38 @@
+//===-- Implementation header for the x86_64 vector math --------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIBC_SRC_MATH_X86_64_VECTOR_MATH_H
+#define LLVM_LIBC_SRC_MATH_X86_64_VECTOR_MATH_H
+
+#include "src/math/vector_math_utils.h"
+
+namespace __llvm_libc {
+
+// The variants for SSE2 (ISA letter b of the vector function ABI), AVX2 (d)
+// and AVX-512 (e), each using the full width of the vector registers. The
+// AVX2 variants also use FMA instructions, which all the AVX2 processors have.
+
+vector_math::VFloat<4> _ZGVbN4v_expf(vector_math::VFloat<4> x);
+vector_math::VFloat<8> _ZGVdN8v_expf(vector_math::VFloat<8> x);
+vector_math::VFloat<16> _ZGVeN16v_expf(vector_math::VFloat<16> x);
+
+vector_math::VFloat<4> _ZGVbN4v_exp2f(vector_math::VFloat<4> x);
+vector_math::VFloat<8> _ZGVdN8v_exp2f(vector_math::VFloat<8> x);
+vector_math::VFloat<16> _ZGVeN16v_exp2f(vector_math::VFloat<16> x);
+
+vector_math::VFloat<4> _ZGVbN4v_sinf(vector_math::VFloat<4> x);
+vector_math::VFloat<8> _ZGVdN8v_sinf(vector_math::VFloat<8> x);
+vector_math::VFloat<16> _ZGVeN16v_sinf(vector_math::VFloat<16> x);
+
+vector_math::VFloat<4> _ZGVbN4v_cosf(vector_math::VFloat<4> x);
+vector_math::VFloat<8> _ZGVdN8v_cosf(vector_math::VFloat<8> x);
+vector_math::VFloat<16> _ZGVeN16v_cosf(vector_math::VFloat<16> x);
+
+} // namespace __llvm_libc
+
+#endif // LLVM_LIBC_SRC_MATH_X86_64_VECTOR_MATH_H
@@ -7,6 +7,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "src/string/strchr.h"
+#include "src/string/string_utils.h"
 
 #include "src/__support/common.h"
 
@@ -14,12 +15,10 @@ namespace __llvm_libc {
 
 // TODO: Look at performance benefits of comparing words.
 char *LLVM_LIBC_ENTRYPOINT(strchr)(const char *src, int c) {
-  unsigned char *str =
-      const_cast<unsigned char *>(reinterpret_cast<const unsigned char *>(src));
   const unsigned char ch = c;
-  for (; *str && *str != ch; ++str)
-    ;
-  return *str == ch ? reinterpret_cast<char *>(str) : nullptr;
+  const char *str = internal::find_character_or_terminator(src, ch);
+  return static_cast<unsigned char>(*str) == ch ? const_cast<char *>(str)
+                                                : nullptr;
 }
 
 } // namespace __llvm_libc
@@ -9,6 +9,7 @@
 #ifndef LIBC_SRC_STRING_STRING_UTILS_H
 #define LIBC_SRC_STRING_STRING_UTILS_H
 
+#include "src/string/vector_string_utils.h"
 #include "utils/CPP/Bitset.h"
 #include <stddef.h> // size_t
 
@@ -18,19 +19,39 @@ namespace internal {
 // Returns the length of a string, denoted by the first occurrence
 // of a null terminator.
 static inline size_t string_length(const char *src) {
+#if defined(LLVM_LIBC_HAS_VECTOR_STRING_UTILS)
+  return vector_string_length(src);
+#else
   size_t length;
   for (length = 0; *src; ++src, ++length)
     ;
   return length;
+#endif
 }
 
 // Returns the first occurrence of 'ch' within the first 'n' characters of
 // 'src'. If 'ch' is not found, returns nullptr.
 static inline void *find_first_character(const unsigned char *src,
                                          unsigned char ch, size_t n) {
+#if defined(LLVM_LIBC_HAS_VECTOR_STRING_UTILS)
+  return vector_find_first_character(src, ch, n);
+#else
   for (; n && *src != ch; --n, ++src)
     ;
   return n ? const_cast<unsigned char *>(src) : nullptr;
+#endif
+}
+
+// Returns the first occurrence of 'ch' or of the null terminator in 'src'.
+static inline const char *find_character_or_terminator(const char *src,
+                                                       unsigned char ch) {
+#if defined(LLVM_LIBC_HAS_VECTOR_STRING_UTILS)
+  return vector_find_character_or_terminator(src, ch);
+#else
+  for (; *src && static_cast<unsigned char>(*src) != ch; ++src)
+    ;
+  return src;
+#endif
 }
 
 // Returns the maximum length span that contains only characters not found in
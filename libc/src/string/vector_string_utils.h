@@ -0,0 +1,214 @@
+//===-- Vector string utils -------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Byte searches which compare whole vectors at a time and turn the result
+// into a bit mask, e.g. with `pmovmskb` on x86.
+//
+// The reads are aligned to the vector size. As the vectors never cross a page
+// boundary, the bytes read past the end of the string or of the buffer are on
+// a page which holds some of the bytes searched, and the reads can't fault.
+// They are out of the bounds of the object though, which memory sanitizers
+// would report, so the scalar implementations are used when sanitizing.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LIBC_SRC_STRING_VECTOR_STRING_UTILS_H
+#define LIBC_SRC_STRING_VECTOR_STRING_UTILS_H
+
+#include <stddef.h> // size_t
+#include <stdint.h> // uintptr_t, uint32_t, uint64_t
+
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(memory_sanitizer)
+#define LLVM_LIBC_STRING_SANITIZED
+#endif
+#endif
+#if defined(__SANITIZE_ADDRESS__)
+#define LLVM_LIBC_STRING_SANITIZED
+#endif
+
+#if !defined(LLVM_LIBC_STRING_SANITIZED)
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#define LLVM_LIBC_HAS_VECTOR_STRING_UTILS
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define LLVM_LIBC_HAS_VECTOR_STRING_UTILS
+#endif
+#endif
+
+#if defined(LLVM_LIBC_HAS_VECTOR_STRING_UTILS)
+
+namespace __llvm_libc {
+namespace internal {
+
+// A vector of bytes and the operations of the searches. For each byte of
+// the vector, the masks returned by the comparisons have `kMaskBitsPerByte`
+// bits, all set if the comparison is true.
+#if defined(__AVX2__)
+struct ByteVector {
+  using Type = __m256i;
+  using Mask = uint32_t;
+  static constexpr size_t kSize = 32;
+  static constexpr size_t kMaskBitsPerByte = 1;
+
+  static Type load(const unsigned char *aligned) {
+    return _mm256_load_si256(reinterpret_cast<const Type *>(aligned));
+  }
+  static Type splat(unsigned char value) {
+    return _mm256_set1_epi8(static_cast<char>(value));
+  }
+  static Mask equal(Type a, Type b) {
+    return _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b));
+  }
+  // The bytes of `a` which are equal to the ones of `b` or zero.
+  static Mask equal_or_zero(Type a, Type b) {
+    const Type zero = _mm256_setzero_si256();
+    return _mm256_movemask_epi8(
+        _mm256_or_si256(_mm256_cmpeq_epi8(a, b), _mm256_cmpeq_epi8(a, zero)));
+  }
+};
+#elif defined(__SSE2__)
+struct ByteVector {
+  using Type = __m128i;
+  using Mask = uint32_t;
+  static constexpr size_t kSize = 16;
+  static constexpr size_t kMaskBitsPerByte = 1;
+
+  static Type load(const unsigned char *aligned) {
+    return _mm_load_si128(reinterpret_cast<const Type *>(aligned));
+  }
+  static Type splat(unsigned char value) {
+    return _mm_set1_epi8(static_cast<char>(value));
+  }
+  static Mask equal(Type a, Type b) {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(a, b));
+  }
+  static Mask equal_or_zero(Type a, Type b) {
+    const Type zero = _mm_setzero_si128();
+    return _mm_movemask_epi8(
+        _mm_or_si128(_mm_cmpeq_epi8(a, b), _mm_cmpeq_epi8(a, zero)));
+  }
+};
+#elif defined(__ARM_NEON)
+struct ByteVector {
+  using Type = uint8x16_t;
+  using Mask = uint64_t;
+  static constexpr size_t kSize = 16;
+  static constexpr size_t kMaskBitsPerByte = 4;
+
+  static Type load(const unsigned char *aligned) { return vld1q_u8(aligned); }
+  static Type splat(unsigned char value) { return vdupq_n_u8(value); }
+  // NEON has no movemask, narrowing the 16 bit lanes of the comparison
+  // result by 4 bits packs it into 64 bits, 4 bits per byte.
+  static Mask to_mask(uint8x16_t comparison) {
+    const uint8x8_t narrowed =
+        vshrn_n_u16(vreinterpretq_u16_u8(comparison), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0);
+  }
+  static Mask equal(Type a, Type b) { return to_mask(vceqq_u8(a, b)); }
+  static Mask equal_or_zero(Type a, Type b) {
+    // A byte is zero or equal to the one of `b` if the minimum of itself and
+    // of their exclusive or is zero.
+    return to_mask(vceqq_u8(vminq_u8(a, veorq_u8(a, b)), vdupq_n_u8(0)));
+  }
+};
+#endif
+
+// Returns the index of the first byte whose comparison is true in `mask`.
+// Precondition: `mask != 0`.
+static inline size_t first_byte_index(ByteVector::Mask mask) {
+  return static_cast<size_t>(__builtin_ctzll(mask)) /
+         ByteVector::kMaskBitsPerByte;
+}
+
+// Returns the vector holding `ptr`, and the number of bytes in it before
+// `ptr` in `misalignment`.
+static inline const unsigned char *
+aligned_vector_of(const unsigned char *ptr, size_t *misalignment) {
+  *misalignment = reinterpret_cast<uintptr_t>(ptr) % ByteVector::kSize;
+  return ptr - *misalignment;
+}
+
+// Drops the bits of the bytes of the first vector that are before the
+// string.
+static inline ByteVector::Mask skip_bytes(ByteVector::Mask mask,
+                                          size_t misalignment) {
+  return mask >> (misalignment * ByteVector::kMaskBitsPerByte);
+}
+
+static inline size_t vector_string_length(const char *src) {
+  const unsigned char *str = reinterpret_cast<const unsigned char *>(src);
+  size_t misalignment;
+  const unsigned char *block = aligned_vector_of(str, &misalignment);
+  const ByteVector::Type zero = ByteVector::splat(0);
+  ByteVector::Mask mask =
+      skip_bytes(ByteVector::equal(ByteVector::load(block), zero),
+                 misalignment);
+  if (mask)
+    return first_byte_index(mask);
+  for (;;) {
+    block += ByteVector::kSize;
+    mask = ByteVector::equal(ByteVector::load(block), zero);
+    if (mask)
+      return block - str + first_byte_index(mask);
+  }
+}
+
+static inline void *vector_find_first_character(const unsigned char *src,
+                                                unsigned char ch, size_t n) {
+  if (n == 0)
+    return nullptr;
+  size_t misalignment;
+  const unsigned char *block = aligned_vector_of(src, &misalignment);
+  const ByteVector::Type needle = ByteVector::splat(ch);
+  ByteVector::Mask mask = skip_bytes(
+      ByteVector::equal(ByteVector::load(block), needle), misalignment);
+  if (mask) {
+    const size_t index = first_byte_index(mask);
+    return index < n ? const_cast<unsigned char *>(src + index) : nullptr;
+  }
+  // `searched` is the number of bytes from `src` to the end of `block`.
+  for (size_t searched = ByteVector::kSize - misalignment; searched < n;
+       searched += ByteVector::kSize) {
+    block += ByteVector::kSize;
+    mask = ByteVector::equal(ByteVector::load(block), needle);
+    if (mask) {
+      const size_t index = searched + first_byte_index(mask);
+      return index < n ? const_cast<unsigned char *>(src + index) : nullptr;
+    }
+  }
+  return nullptr;
+}
+
+// Returns the first occurrence of `ch` or of the null terminator in `src`.
+static inline const char *
+vector_find_character_or_terminator(const char *src, unsigned char ch) {
+  const unsigned char *str = reinterpret_cast<const unsigned char *>(src);
+  size_t misalignment;
+  const unsigned char *block = aligned_vector_of(str, &misalignment);
+  const ByteVector::Type needle = ByteVector::splat(ch);
+  ByteVector::Mask mask = skip_bytes(
+      ByteVector::equal_or_zero(ByteVector::load(block), needle),
+      misalignment);
+  if (mask)
+    return src + first_byte_index(mask);
+  for (;;) {
+    block += ByteVector::kSize;
+    mask = ByteVector::equal_or_zero(ByteVector::load(block), needle);
+    if (mask)
+      return reinterpret_cast<const char *>(block) + first_byte_index(mask);
+  }
+}
+
+} // namespace internal
+} // namespace __llvm_libc
+
+#endif // LLVM_LIBC_HAS_VECTOR_STRING_UTILS
+
+#endif // LIBC_SRC_STRING_VECTOR_STRING_UTILS_H
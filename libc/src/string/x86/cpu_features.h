@@ -0,0 +1,189 @@
+//===-- Runtime CPU features for the x86 memory functions -------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LIBC_SRC_STRING_X86_CPU_FEATURES_H
+#define LIBC_SRC_STRING_X86_CPU_FEATURES_H
+
+#include <cpuid.h>
+#include <stddef.h> // size_t
+#include <stdint.h> // uint32_t, uint64_t
+
+namespace __llvm_libc {
+namespace x86 {
+
+// What the memory functions need to know about the processor they run on to
+// pick their implementation and thresholds.
+struct CpuFeatures {
+  // Whether the instructions and the registers are usable, i.e. whether the
+  // operating system also saves the registers on context switches.
+  bool avx2 = false;
+  bool avx512f = false;
+  // Enhanced `rep movsb`/`rep stosb`.
+  bool erms = false;
+  // `rep movsb` is slower than vector loops on AMD processors for sizes
+  // beyond the L2 cache.
+  bool is_amd = false;
+  // Size in bytes of the L2 cache of a core, and of the largest cache, which
+  // is shared by the cores. Zero when unknown.
+  size_t l2_cache_size = 0;
+  size_t shared_cache_size = 0;
+};
+
+// The sizes from which the memory functions switch strategies.
+struct MemoryFunctionThresholds {
+  // `rep movsb` is used for the copies from `rep_movsb_threshold` bytes and
+  // below `rep_movsb_stop_threshold` bytes.
+  size_t rep_movsb_threshold;
+  size_t rep_movsb_stop_threshold;
+  // `rep stosb` is used for the sets from `rep_stosb_threshold` bytes.
+  size_t rep_stosb_threshold;
+  // Non-temporal stores are used from `non_temporal_threshold` bytes, for
+  // which the destination would evict most of the shared cache.
+  size_t non_temporal_threshold;
+};
+
+static inline uint64_t read_xcr0() {
+  uint32_t eax, edx;
+  asm volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return (static_cast<uint64_t>(edx) << 32) | eax;
+}
+
+// Returns the size of the cache described by `cpuid` leaf 4 (Intel) or
+// 0x8000001d (AMD) for the given subleaf, and its level, or zero if the
+// subleaf describes no data cache.
+static inline size_t get_cache_size(unsigned leaf, unsigned subleaf,
+                                    unsigned *level) {
+  unsigned eax, ebx, ecx, edx;
+  if (!__get_cpuid_count(leaf, subleaf, &eax, &ebx, &ecx, &edx))
+    return 0;
+  const unsigned type = eax & 0x1f;
+  // 1 is a data cache and 3 a unified one, 0 ends the list.
+  if (type != 1 && type != 3)
+    return 0;
+  *level = (eax >> 5) & 0x7;
+  const size_t ways = ((ebx >> 22) & 0x3ff) + 1;
+  const size_t partitions = ((ebx >> 12) & 0x3ff) + 1;
+  const size_t line_size = (ebx & 0xfff) + 1;
+  const size_t sets = static_cast<size_t>(ecx) + 1;
+  return ways * partitions * line_size * sets;
+}
+
+static inline CpuFeatures get_cpu_features() {
+  CpuFeatures features;
+  unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+  const unsigned max_leaf = __get_cpuid_max(0, &ebx);
+  if (max_leaf == 0)
+    return features;
+  __get_cpuid(0, &eax, &ebx, &ecx, &edx);
+  // "AuthenticAMD", and "HygonGenuine" for the processors derived from Zen.
+  features.is_amd = (ebx == 0x68747541 && ecx == 0x444d4163 &&
+                     edx == 0x69746e65) ||
+                    (ebx == 0x6f677948 && ecx == 0x656e6975 &&
+                     edx == 0x6e65476e);
+
+  __get_cpuid(1, &eax, &ebx, &ecx, &edx);
+  const bool osxsave = ecx & bit_OSXSAVE;
+  const uint64_t xcr0 = osxsave ? read_xcr0() : 0;
+  // SSE and AVX state, then opmask and upper ZMM states.
+  const bool os_saves_ymm = (xcr0 & 0x6) == 0x6;
+  const bool os_saves_zmm = (xcr0 & 0xe6) == 0xe6;
+
+  if (max_leaf >= 7) {
+    __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx);
+    features.avx2 = os_saves_ymm && (ebx & bit_AVX2);
+    features.avx512f = os_saves_zmm && (ebx & bit_AVX512F);
+    features.erms = ebx & (1U << 9);
+  }
+
+  unsigned cache_leaf = 0;
+  if (features.is_amd) {
+    if (__get_cpuid_max(0x80000000, nullptr) >= 0x8000001d)
+      cache_leaf = 0x8000001d;
+  } else if (max_leaf >= 4) {
+    cache_leaf = 4;
+  }
+  if (cache_leaf) {
+    unsigned max_level = 0;
+    for (unsigned subleaf = 0; subleaf < 16; ++subleaf) {
+      unsigned level = 0;
+      const size_t size = get_cache_size(cache_leaf, subleaf, &level);
+      if (size == 0)
+        continue;
+      if (level == 2)
+        features.l2_cache_size = size;
+      if (level >= max_level) {
+        max_level = level;
+        features.shared_cache_size = size;
+      }
+    }
+  }
+  return features;
+}
+
+// Returns the thresholds for `features` and the implementation which moves
+// `vector_size` bytes at a time.
+static inline MemoryFunctionThresholds
+get_thresholds(const CpuFeatures &features, size_t vector_size) {
+  MemoryFunctionThresholds thresholds;
+  // Assume a 4MiB shared cache when it is unknown, and leave a quarter of it
+  // to the other data.
+  const size_t shared_cache_size = features.shared_cache_size
+                                       ? features.shared_cache_size
+                                       : 4 * 1024 * 1024;
+  thresholds.non_temporal_threshold = shared_cache_size / 4 * 3;
+  if (features.erms) {
+    // The startup cost of `rep movsb` is paid off by about 2KiB copies with
+    // 16 byte vectors, and the wider the vectors the later it is.
+    thresholds.rep_movsb_threshold = 2048 * (vector_size / 16);
+    thresholds.rep_movsb_stop_threshold =
+        features.is_amd && features.l2_cache_size
+            ? features.l2_cache_size
+            : thresholds.non_temporal_threshold;
+    thresholds.rep_stosb_threshold = 2048;
+  } else {
+    thresholds.rep_movsb_threshold = static_cast<size_t>(-1);
+    thresholds.rep_movsb_stop_threshold = static_cast<size_t>(-1);
+    thresholds.rep_stosb_threshold = static_cast<size_t>(-1);
+  }
+  return thresholds;
+}
+
+// The threads which call a memory function concurrently for the first time
+// all store the thresholds of the implementation they pick, the same ones,
+// while the threads already using it read them. The fields are accessed
+// atomically, which costs plain moves on x86.
+static inline void store_thresholds(MemoryFunctionThresholds *dst,
+                                    const MemoryFunctionThresholds &src) {
+  __atomic_store_n(&dst->rep_movsb_threshold, src.rep_movsb_threshold,
+                   __ATOMIC_RELAXED);
+  __atomic_store_n(&dst->rep_movsb_stop_threshold,
+                   src.rep_movsb_stop_threshold, __ATOMIC_RELAXED);
+  __atomic_store_n(&dst->rep_stosb_threshold, src.rep_stosb_threshold,
+                   __ATOMIC_RELAXED);
+  __atomic_store_n(&dst->non_temporal_threshold, src.non_temporal_threshold,
+                   __ATOMIC_RELAXED);
+}
+
+static inline MemoryFunctionThresholds
+load_thresholds(const MemoryFunctionThresholds *src) {
+  MemoryFunctionThresholds thresholds;
+  thresholds.rep_movsb_threshold =
+      __atomic_load_n(&src->rep_movsb_threshold, __ATOMIC_RELAXED);
+  thresholds.rep_movsb_stop_threshold =
+      __atomic_load_n(&src->rep_movsb_stop_threshold, __ATOMIC_RELAXED);
+  thresholds.rep_stosb_threshold =
+      __atomic_load_n(&src->rep_stosb_threshold, __ATOMIC_RELAXED);
+  thresholds.non_temporal_threshold =
+      __atomic_load_n(&src->non_temporal_threshold, __ATOMIC_RELAXED);
+  return thresholds;
+}
+
+} // namespace x86
+} // namespace __llvm_libc
+
+#endif // LIBC_SRC_STRING_X86_CPU_FEATURES_H
@@ -9,6 +9,9 @@
 #include "src/string/memcpy.h"
 #include "src/__support/common.h"
 #include "src/string/memory_utils/memcpy_utils.h"
+#include "src/string/x86/cpu_features.h"
+
+#include <immintrin.h>
 
 namespace __llvm_libc {
 
@@ -21,11 +24,39 @@ static void CopyRepMovsb(char *__restrict dst, const char *__restrict src,
   asm volatile("rep movsb" : "+D"(dst), "+S"(src), "+c"(count) : : "memory");
 }
 
-#if defined(__AVX__)
-#define BEST_SIZE 64
-#else
-#define BEST_SIZE 32
-#endif
+// The thresholds of the implementation in use, stored before it is picked
+// and accessed with `x86::store_thresholds` and `x86::load_thresholds`.
+static x86::MemoryFunctionThresholds memcpy_thresholds;
+
+// Copies the cache lines of `dst` fully covered by the copy with
+// non-temporal stores of `vector_type` vectors, and the bytes before and after
+// them with regular stores.
+//
+// Precondition: `count >= 2 * LLVM_LIBC_CACHELINE_SIZE`.
+#define DEFINE_COPY_NON_TEMPORAL(name, target_features, vector_type, load,     \
+                                 store)                                        \
+  __attribute__((target(target_features))) static void name(                  \
+      char *__restrict dst, const char *__restrict src, size_t count) {        \
+    constexpr size_t kLineSize = LLVM_LIBC_CACHELINE_SIZE;                     \
+    CopyBlock<kLineSize>(dst, src);                                            \
+    size_t offset = offset_to_next_cache_line(dst);                            \
+    for (; offset + kLineSize <= count; offset += kLineSize)                   \
+      for (size_t i = 0; i < kLineSize; i += sizeof(vector_type))              \
+        store(reinterpret_cast<vector_type *>(dst + offset + i),               \
+              load(reinterpret_cast<const vector_type *>(src + offset + i)));  \
+    /* Orders the non-temporal stores before the stores which follow. */      \
+    _mm_sfence();                                                              \
+    CopyLastBlock<kLineSize>(dst, src, count);                                 \
+  }
+
+DEFINE_COPY_NON_TEMPORAL(CopyNonTemporalSse2, "sse2", __m128i,
+                         _mm_loadu_si128, _mm_stream_si128)
+DEFINE_COPY_NON_TEMPORAL(CopyNonTemporalAvx2, "avx2", __m256i,
+                         _mm256_loadu_si256, _mm256_stream_si256)
+DEFINE_COPY_NON_TEMPORAL(CopyNonTemporalAvx512f, "avx512f", __m512i,
+                         _mm512_loadu_si512, _mm512_stream_si512)
+
+#undef DEFINE_COPY_NON_TEMPORAL
 
 // Design rationale
 // ================
@@ -45,8 +76,16 @@ static void CopyRepMovsb(char *__restrict dst, const char *__restrict src,
 //   implementation parameters.
 // - As compilers and processors get better, the generated code is improved
 //   with little change on the code side.
-static void memcpy_x86(char *__restrict dst, const char *__restrict src,
-                       size_t count) {
+//
+// The function is instantiated for each vector extension, in functions with
+// the matching target attribute into which it is inlined. `kBestSize` is the
+// size of the aligned blocks of the copies beyond 128 or 256 bytes, twice the
+// size of the vector registers.
+template <size_t kBestSize, void (*CopyNonTemporal)(char *__restrict,
+                                                    const char *__restrict,
+                                                    size_t)>
+__attribute__((always_inline)) static inline void
+memcpy_x86(char *__restrict dst, const char *__restrict src, size_t count) {
   if (count == 0)
     return;
   if (count == 1)
@@ -67,23 +106,72 @@ static void memcpy_x86(char *__restrict dst, const char *__restrict src,
     return CopyBlockOverlap<32>(dst, src, count);
   if (count < 128)
     return CopyBlockOverlap<64>(dst, src, count);
-#if defined(__AVX__)
-  if (count < 256)
+  if (kBestSize >= 64 && count < 256)
     return CopyBlockOverlap<128>(dst, src, count);
-#endif
-  // kRepMovsBSize == -1 : Only CopyAligned is used.
-  // kRepMovsBSize ==  0 : Only RepMovsb is used.
-  // else CopyAligned is used to to kRepMovsBSize and then RepMovsb.
-  constexpr size_t kRepMovsBSize = -1;
-  if (count <= kRepMovsBSize)
-    return CopyAlignedBlocks<BEST_SIZE>(dst, src, count);
-  return CopyRepMovsb(dst, src, count);
+  // Large copies use `rep movsb` in the range where the processor makes it
+  // the fastest, i.e. not at all without ERMS, and non-temporal stores when
+  // the destination wouldn't fit in the cache anyway.
+  const x86::MemoryFunctionThresholds thresholds =
+      x86::load_thresholds(&memcpy_thresholds);
+  if (count >= thresholds.non_temporal_threshold)
+    return CopyNonTemporal(dst, src, count);
+  if (count >= thresholds.rep_movsb_threshold &&
+      count < thresholds.rep_movsb_stop_threshold)
+    return CopyRepMovsb(dst, src, count);
+  return CopyAlignedBlocks<kBestSize>(dst, src, count);
+}
+
+__attribute__((target("sse2"))) static void
+memcpy_sse2(char *__restrict dst, const char *__restrict src, size_t count) {
+  memcpy_x86<32, CopyNonTemporalSse2>(dst, src, count);
+}
+
+__attribute__((target("avx2"))) static void
+memcpy_avx2(char *__restrict dst, const char *__restrict src, size_t count) {
+  memcpy_x86<64, CopyNonTemporalAvx2>(dst, src, count);
+}
+
+__attribute__((target("avx512f"))) static void
+memcpy_avx512f(char *__restrict dst, const char *__restrict src,
+               size_t count) {
+  memcpy_x86<128, CopyNonTemporalAvx512f>(dst, src, count);
+}
+
+using MemcpyFunction = void (*)(char *__restrict, const char *__restrict,
+                                size_t);
+
+static void memcpy_resolve(char *__restrict dst, const char *__restrict src,
+                           size_t count);
+
+// The implementation for the processor, picked by the first call. This
+// avoids ifunc relocations, which static executables can't rely on.
+static MemcpyFunction memcpy_function = &memcpy_resolve;
+
+static void memcpy_resolve(char *__restrict dst, const char *__restrict src,
+                           size_t count) {
+  // The threads which call memcpy concurrently for the first time pick the
+  // same implementation.
+  const x86::CpuFeatures features = x86::get_cpu_features();
+  MemcpyFunction function = &memcpy_sse2;
+  size_t vector_size = 16;
+  if (features.avx512f) {
+    function = &memcpy_avx512f;
+    vector_size = 64;
+  } else if (features.avx2) {
+    function = &memcpy_avx2;
+    vector_size = 32;
+  }
+  x86::store_thresholds(&memcpy_thresholds,
+                        x86::get_thresholds(features, vector_size));
+  __atomic_store_n(&memcpy_function, function, __ATOMIC_RELEASE);
+  function(dst, src, count);
 }
 
 void *LLVM_LIBC_ENTRYPOINT(memcpy)(void *__restrict dst,
                                    const void *__restrict src, size_t size) {
-  memcpy_x86(reinterpret_cast<char *>(dst), reinterpret_cast<const char *>(src),
-             size);
+  __atomic_load_n(&memcpy_function, __ATOMIC_ACQUIRE)(
+      reinterpret_cast<char *>(dst), reinterpret_cast<const char *>(src),
+      size);
   return dst;
 }
 
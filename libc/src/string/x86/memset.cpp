@@ -0,0 +1,120 @@
+//===-- Implementation of memset ------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/string/memset.h"
+#include "src/__support/common.h"
+#include "src/string/memory_utils/memset_utils.h"
+#include "src/string/x86/cpu_features.h"
+
+#include <immintrin.h>
+
+namespace __llvm_libc {
+
+static void SetRepStosb(char *dst, unsigned char value, size_t count) {
+  asm volatile("rep stosb" : "+D"(dst), "+c"(count) : "a"(value) : "memory");
+}
+
+// The thresholds of the implementation in use, stored before it is picked
+// and accessed with `x86::store_thresholds` and `x86::load_thresholds`.
+static x86::MemoryFunctionThresholds memset_thresholds;
+
+// Sets the cache lines of `dst` fully covered by the set with non-temporal
+// stores of `vector_type` vectors, and the bytes before and after them with
+// regular stores.
+//
+// Precondition: `count >= 2 * LLVM_LIBC_CACHELINE_SIZE`.
+#define DEFINE_SET_NON_TEMPORAL(name, target_features, vector_type, splat,     \
+                                store)                                         \
+  __attribute__((target(target_features))) static void name(                  \
+      char *dst, unsigned char value, size_t count) {                          \
+    constexpr size_t kLineSize = LLVM_LIBC_CACHELINE_SIZE;                     \
+    SetBlock<kLineSize>(dst, value);                                           \
+    const vector_type splat_value = splat(static_cast<char>(value));          \
+    size_t offset = offset_to_next_cache_line(dst);                            \
+    for (; offset + kLineSize <= count; offset += kLineSize)                   \
+      for (size_t i = 0; i < kLineSize; i += sizeof(vector_type))              \
+        store(reinterpret_cast<vector_type *>(dst + offset + i), splat_value); \
+    /* Orders the non-temporal stores before the stores which follow. */      \
+    _mm_sfence();                                                              \
+    SetLastBlock<kLineSize>(dst, value, count);                                \
+  }
+
+DEFINE_SET_NON_TEMPORAL(SetNonTemporalSse2, "sse2", __m128i, _mm_set1_epi8,
+                        _mm_stream_si128)
+DEFINE_SET_NON_TEMPORAL(SetNonTemporalAvx2, "avx2", __m256i, _mm256_set1_epi8,
+                        _mm256_stream_si256)
+DEFINE_SET_NON_TEMPORAL(SetNonTemporalAvx512f, "avx512f", __m512i,
+                        _mm512_set1_epi8, _mm512_stream_si512)
+
+#undef DEFINE_SET_NON_TEMPORAL
+
+// `GeneralPurposeMemset` for the sizes below the thresholds; `kBestSize` is
+// the size of the aligned blocks beyond 128 bytes. The function is inlined
+// into functions with the target attribute of the vector extension.
+template <size_t kBestSize,
+          void (*SetNonTemporal)(char *, unsigned char, size_t)>
+__attribute__((always_inline)) static inline void
+memset_x86(char *dst, unsigned char value, size_t count) {
+  if (count <= 128)
+    return GeneralPurposeMemset(dst, value, count);
+  const x86::MemoryFunctionThresholds thresholds =
+      x86::load_thresholds(&memset_thresholds);
+  if (count >= thresholds.non_temporal_threshold)
+    return SetNonTemporal(dst, value, count);
+  if (count >= thresholds.rep_stosb_threshold)
+    return SetRepStosb(dst, value, count);
+  return SetAlignedBlocks<kBestSize>(dst, value, count);
+}
+
+__attribute__((target("sse2"))) static void
+memset_sse2(char *dst, unsigned char value, size_t count) {
+  memset_x86<32, SetNonTemporalSse2>(dst, value, count);
+}
+
+__attribute__((target("avx2"))) static void
+memset_avx2(char *dst, unsigned char value, size_t count) {
+  memset_x86<32, SetNonTemporalAvx2>(dst, value, count);
+}
+
+__attribute__((target("avx512f"))) static void
+memset_avx512f(char *dst, unsigned char value, size_t count) {
+  memset_x86<64, SetNonTemporalAvx512f>(dst, value, count);
+}
+
+using MemsetFunction = void (*)(char *, unsigned char, size_t);
+
+static void memset_resolve(char *dst, unsigned char value, size_t count);
+
+// The implementation for the processor, picked by the first call as for
+// memcpy.
+static MemsetFunction memset_function = &memset_resolve;
+
+static void memset_resolve(char *dst, unsigned char value, size_t count) {
+  const x86::CpuFeatures features = x86::get_cpu_features();
+  MemsetFunction function = &memset_sse2;
+  size_t vector_size = 16;
+  if (features.avx512f) {
+    function = &memset_avx512f;
+    vector_size = 64;
+  } else if (features.avx2) {
+    function = &memset_avx2;
+    vector_size = 32;
+  }
+  x86::store_thresholds(&memset_thresholds,
+                        x86::get_thresholds(features, vector_size));
+  __atomic_store_n(&memset_function, function, __ATOMIC_RELEASE);
+  function(dst, value, count);
+}
+
+void *LLVM_LIBC_ENTRYPOINT(memset)(void *dst, int value, size_t count) {
+  __atomic_load_n(&memset_function, __ATOMIC_ACQUIRE)(
+      reinterpret_cast<char *>(dst), static_cast<unsigned char>(value), count);
+  return dst;
+}
+
+} // namespace __llvm_libc
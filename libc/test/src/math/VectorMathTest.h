@@ -0,0 +1,91 @@
+//===-- Utility class to test the vector math functions ---------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "include/errno.h"
+#include "src/errno/llvmlibc_errno.h"
+#include "src/math/vector_math_utils.h"
+#include "utils/FPUtil/FloatOperations.h"
+#include "utils/FPUtil/TestHelpers.h"
+#include "utils/MPFRWrapper/MPFRUtils.h"
+#include "utils/UnitTest/Test.h"
+#include <math.h>
+
+#include <stdint.h>
+
+namespace mpfr = __llvm_libc::testing::mpfr;
+
+template <size_t N>
+class VectorMathTestTemplate : public __llvm_libc::testing::Test {
+public:
+  using VFloat = __llvm_libc::vector_math::VFloat<N>;
+  using ScalarFunc = float (*)(float);
+
+  // The inputs which the fast paths of the vector functions don't handle.
+  static constexpr uint32_t expSpecialInputs[] = {
+      0x7fc00000U, // nan
+      0xffc00000U, // -nan
+      0x7f800000U, // inf
+      0xff800000U, // -inf
+      0x42c80000U, // 100.0f, overflows
+      0xc2dc0000U, // -110.0f, underflows
+      0x7e967699U, // 1.0e38f
+      0xfe967699U, // -1.0e38f
+  };
+  static constexpr uint32_t sincosSpecialInputs[] = {
+      0x7fc00000U, // nan
+      0xffc00000U, // -nan
+      0x7f800000U, // inf
+      0xff800000U, // -inf
+      0x49800000U, // 0x1p20f
+      0xc9800000U, // -0x1p20f
+      0x6ca80000U, // 0x1.5p90f
+      0x7e967699U, // 1.0e38f
+  };
+
+  // Check that the inputs left to the scalar function get exactly its result
+  // and errno, whichever lane they are in.
+  template <typename VectorFunc, size_t M>
+  void testSpecialNumbers(VectorFunc func, ScalarFunc scalarFunc,
+                          const uint32_t (&inputs)[M]) {
+    for (uint32_t bits : inputs) {
+      float input = __llvm_libc::fputil::valueFromBits(bits);
+      llvmlibc_errno = 0;
+      float expected = scalarFunc(input);
+      int expectedErrno = llvmlibc_errno;
+      for (size_t lane = 0; lane < N; ++lane) {
+        VFloat x;
+        for (size_t i = 0; i < N; ++i)
+          x[i] = i == lane ? input : 0.5f;
+        llvmlibc_errno = 0;
+        VFloat y = func(x);
+        EXPECT_FP_EQ(expected, y[lane]);
+        EXPECT_EQ(llvmlibc_errno, expectedErrno);
+      }
+    }
+  }
+
+  template <mpfr::Operation Op, typename VectorFunc>
+  void testInFloatRange(VectorFunc func, double tolerance) {
+    constexpr uint32_t count = 1000000;
+    constexpr uint32_t step = UINT32_MAX / count;
+    VFloat x;
+    size_t lanes = 0;
+    for (uint32_t i = 0, v = 0; i <= count; ++i, v += step) {
+      float f = __llvm_libc::fputil::valueFromBits(v);
+      if (isnan(f) || isinf(f))
+        continue;
+      x[lanes++] = f;
+      if (lanes < N)
+        continue;
+      VFloat y = func(x);
+      for (size_t lane = 0; lane < N; ++lane)
+        ASSERT_MPFR_MATCH(Op, x[lane], y[lane], tolerance);
+      lanes = 0;
+    }
+  }
+};
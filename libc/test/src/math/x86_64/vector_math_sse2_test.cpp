@@ -0,0 +1,54 @@
+//===-- Unittests for the SSE2 vector math functions ----------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "VectorMathTest.h"
+
+#include "src/math/cosf.h"
+#include "src/math/exp2f.h"
+#include "src/math/expf.h"
+#include "src/math/sinf.h"
+#include "src/math/x86_64/vector_math.h"
+#include "utils/UnitTest/Test.h"
+
+using VectorMathTest = VectorMathTestTemplate<4>;
+
+TEST_F(VectorMathTest, SpecialNumbers_expf) {
+  testSpecialNumbers(&__llvm_libc::_ZGVbN4v_expf, &__llvm_libc::expf,
+                     expSpecialInputs);
+}
+
+TEST_F(VectorMathTest, InFloatRange_expf) {
+  testInFloatRange<mpfr::Operation::Exp>(&__llvm_libc::_ZGVbN4v_expf, 2.0);
+}
+
+TEST_F(VectorMathTest, SpecialNumbers_exp2f) {
+  testSpecialNumbers(&__llvm_libc::_ZGVbN4v_exp2f, &__llvm_libc::exp2f,
+                     expSpecialInputs);
+}
+
+TEST_F(VectorMathTest, InFloatRange_exp2f) {
+  testInFloatRange<mpfr::Operation::Exp2>(&__llvm_libc::_ZGVbN4v_exp2f, 2.0);
+}
+
+TEST_F(VectorMathTest, SpecialNumbers_sinf) {
+  testSpecialNumbers(&__llvm_libc::_ZGVbN4v_sinf, &__llvm_libc::sinf,
+                     sincosSpecialInputs);
+}
+
+TEST_F(VectorMathTest, InFloatRange_sinf) {
+  testInFloatRange<mpfr::Operation::Sin>(&__llvm_libc::_ZGVbN4v_sinf, 2.1);
+}
+
+TEST_F(VectorMathTest, SpecialNumbers_cosf) {
+  testSpecialNumbers(&__llvm_libc::_ZGVbN4v_cosf, &__llvm_libc::cosf,
+                     sincosSpecialInputs);
+}
+
+TEST_F(VectorMathTest, InFloatRange_cosf) {
+  testInFloatRange<mpfr::Operation::Cos>(&__llvm_libc::_ZGVbN4v_cosf, 2.1);
+}
@@ -120,3 +120,21 @@ TEST(MemChrTest, SignedCharacterFound) {
   // Should find the first character 'c'.
   ASSERT_EQ(actual[0], c);
 }
+
+TEST(MemChrTest, AllPositionsAndAlignments) {
+  // Exercises the buffers starting and ending anywhere in a vector.
+  char buffer[256];
+  for (size_t align = 0; align < 64; ++align) {
+    for (size_t size = 0; size < 128; ++size) {
+      for (size_t position = 0; position <= size; ++position) {
+        for (size_t i = 0; i < sizeof(buffer); ++i)
+          buffer[i] = 'a';
+        char *const src = buffer + align;
+        // The character at `size` is out of the buffer searched.
+        src[position] = 'b';
+        const char *expected = position < size ? src + position : nullptr;
+        ASSERT_EQ(call_memchr(src, 'b', size), expected);
+      }
+    }
+  }
+}
@@ -49,6 +49,33 @@ TEST(MemcpyTest, Thorough) {
   }
 }
 
+// Large enough for the copies to use the non-temporal stores on most hosts.
+static constexpr size_t kLargeSize = 16 * 1024 * 1024;
+static char large_src[kLargeSize + 128];
+static char large_dst[kLargeSize + 128];
+
+// Exercises the implementations used for large sizes, e.g. `rep movsb` and
+// non-temporal stores on x86.
+TEST(MemcpyTest, LargeSizes) {
+  for (size_t i = 0; i < sizeof(large_src); ++i)
+    large_src[i] = kNumbers[i % kNumbers.size()];
+  for (size_t size = 2048; size <= kLargeSize; size *= 2) {
+    for (size_t count = size - 1; count <= size + 1; ++count) {
+      for (size_t align = 0; align < 64; align += 31) {
+        for (size_t i = 0; i < count + 64; ++i)
+          large_dst[i] = 0;
+        __llvm_libc::memcpy(large_dst + align, large_src, count);
+        for (size_t i = 0; i < align; ++i)
+          ASSERT_EQ(large_dst[i], '\0');
+        for (size_t i = 0; i < count; ++i)
+          ASSERT_EQ(large_dst[align + i], large_src[i]);
+        for (size_t i = align + count; i < count + 64; ++i)
+          ASSERT_EQ(large_dst[i], '\0');
+      }
+    }
+  }
+}
+
 // FIXME: Add tests with reads and writes on the boundary of a read/write
 // protected page to check we're not reading nor writing prior/past the allowed
 // regions.
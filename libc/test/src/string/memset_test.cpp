@@ -48,6 +48,30 @@ TEST(MemsetTest, Thorough) {
   }
 }
 
+// Large enough for the sets to use the non-temporal stores on most hosts.
+static constexpr size_t kLargeSize = 16 * 1024 * 1024;
+static char large_buffer[kLargeSize + 128];
+
+// Exercises the implementations used for large sizes, e.g. `rep stosb` and
+// non-temporal stores on x86.
+TEST(MemsetTest, LargeSizes) {
+  for (size_t size = 2048; size <= kLargeSize; size *= 2) {
+    for (size_t count = size - 1; count <= size + 1; ++count) {
+      for (size_t align = 0; align < 64; align += 31) {
+        for (size_t i = 0; i < count + 64; ++i)
+          large_buffer[i] = 0;
+        __llvm_libc::memset(large_buffer + align, 'a', count);
+        for (size_t i = 0; i < align; ++i)
+          ASSERT_EQ(large_buffer[i], '\0');
+        for (size_t i = 0; i < count; ++i)
+          ASSERT_EQ(large_buffer[align + i], 'a');
+        for (size_t i = align + count; i < count + 64; ++i)
+          ASSERT_EQ(large_buffer[i], '\0');
+      }
+    }
+  }
+}
+
 // FIXME: Add tests with reads and writes on the boundary of a read/write
 // protected page to check we're not reading nor writing prior/past the allowed
 // regions.
@@ -8,6 +8,7 @@
 
 #include "src/string/strchr.h"
 #include "utils/UnitTest/Test.h"
+#include <stddef.h>
 
 TEST(StrChrTest, FindsFirstCharacter) {
   const char *src = "abcde";
@@ -80,3 +81,22 @@ TEST(StrChrTest, EmptyStringShouldOnlyMatchNullTerminator) {
   ASSERT_STREQ(__llvm_libc::strchr("", '3'), nullptr);
   ASSERT_STREQ(__llvm_libc::strchr("", '*'), nullptr);
 }
+
+TEST(StrChrTest, AllPositionsAndAlignments) {
+  // Exercises the strings starting and ending anywhere in a vector.
+  char buffer[256];
+  for (size_t align = 0; align < 64; ++align) {
+    for (size_t length = 0; length < 128; ++length) {
+      for (size_t position = 0; position <= length + 1; ++position) {
+        for (size_t i = 0; i < sizeof(buffer); ++i)
+          buffer[i] = 'a';
+        char *const src = buffer + align;
+        src[length] = '\0';
+        // The character after the null terminator must not be found.
+        src[position] = position == length ? '\0' : 'b';
+        char *expected = position < length ? src + position : nullptr;
+        ASSERT_EQ(__llvm_libc::strchr(src, 'b'), expected);
+      }
+    }
+  }
+}
@@ -22,3 +22,16 @@ TEST(StrLenTest, AnyString) {
   size_t result = __llvm_libc::strlen(any);
   ASSERT_EQ((size_t)12, result);
 }
+
+TEST(StrLenTest, AllLengthsAndAlignments) {
+  // Exercises the strings starting and ending anywhere in a vector.
+  char buffer[256];
+  for (size_t align = 0; align < 64; ++align) {
+    for (size_t length = 0; length < 128; ++length) {
+      for (size_t i = 0; i < sizeof(buffer); ++i)
+        buffer[i] = 'a';
+      buffer[align + length] = '\0';
+      ASSERT_EQ(__llvm_libc::strlen(buffer + align), length);
+    }
+  }
+}
@@ -0,0 +1,179 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <spirv/spirv.h>
+#include <spirv/spirv_types.h>
+
+// A sub-group is a warp. The collectives of a sub-group are scans over the
+// warp shuffles, which only read the lanes below the current one, so that the
+// lanes past the end of a partial warp are never read. The collectives of a
+// work-group combine the totals of its sub-groups in the local memory.
+
+__local char *__clc__get_group_scratch();
+
+_CLC_DEF _CLC_CONVERGENT uint __clc__membermask() {
+  return 0xFFFFFFFF >> (32 - __spirv_SubgroupSize());
+}
+
+#define __CLC_SUBGROUP_SHUFFLE_32(TYPE, SUFFIX, SHUFFLE_TYPE)                  \
+  _CLC_DEF _CLC_OVERLOAD _CLC_CONVERGENT TYPE __clc__SubgroupShuffleUp(        \
+      TYPE x, uint delta) {                                                    \
+    return (TYPE)__nvvm_shfl_sync_up_##SUFFIX(__clc__membermask(),             \
+                                              (SHUFFLE_TYPE)x, delta, 0);      \
+  }                                                                            \
+  _CLC_DEF _CLC_OVERLOAD _CLC_CONVERGENT TYPE __clc__SubgroupShuffle(          \
+      TYPE x, uint lane) {                                                     \
+    return (TYPE)__nvvm_shfl_sync_idx_##SUFFIX(__clc__membermask(),            \
+                                               (SHUFFLE_TYPE)x, lane, 0x1f);   \
+  }
+
+#define __CLC_SUBGROUP_SHUFFLE_64(TYPE)                                        \
+  _CLC_DEF _CLC_OVERLOAD _CLC_CONVERGENT TYPE __clc__SubgroupShuffleUp(        \
+      TYPE x, uint delta) {                                                    \
+    int2 halves = as_int2(x);                                                  \
+    halves.x = __nvvm_shfl_sync_up_i32(__clc__membermask(), halves.x, delta,   \
+                                       0);                                     \
+    halves.y = __nvvm_shfl_sync_up_i32(__clc__membermask(), halves.y, delta,   \
+                                       0);                                     \
+    return as_##TYPE(halves);                                                  \
+  }                                                                            \
+  _CLC_DEF _CLC_OVERLOAD _CLC_CONVERGENT TYPE __clc__SubgroupShuffle(          \
+      TYPE x, uint lane) {                                                     \
+    int2 halves = as_int2(x);                                                  \
+    halves.x = __nvvm_shfl_sync_idx_i32(__clc__membermask(), halves.x, lane,   \
+                                        0x1f);                                 \
+    halves.y = __nvvm_shfl_sync_idx_i32(__clc__membermask(), halves.y, lane,   \
+                                        0x1f);                                 \
+    return as_##TYPE(halves);                                                  \
+  }
+
+__CLC_SUBGROUP_SHUFFLE_32(short, i32, int)
+__CLC_SUBGROUP_SHUFFLE_32(ushort, i32, int)
+__CLC_SUBGROUP_SHUFFLE_32(int, i32, int)
+__CLC_SUBGROUP_SHUFFLE_32(uint, i32, int)
+__CLC_SUBGROUP_SHUFFLE_32(float, f32, float)
+__CLC_SUBGROUP_SHUFFLE_64(long)
+__CLC_SUBGROUP_SHUFFLE_64(ulong)
+#ifdef cl_khr_fp64
+__CLC_SUBGROUP_SHUFFLE_64(double)
+#endif
+
+#undef __CLC_SUBGROUP_SHUFFLE_32
+#undef __CLC_SUBGROUP_SHUFFLE_64
+
+#define __CLC_ADD(x, y) ((x) + (y))
+#define __CLC_MUL(x, y) ((x) * (y))
+#define __CLC_MIN(x, y) ((x) < (y) ? (x) : (y))
+#define __CLC_MAX(x, y) ((x) > (y) ? (x) : (y))
+#define __CLC_OR(x, y) ((x) | (y))
+#define __CLC_XOR(x, y) ((x) ^ (y))
+#define __CLC_AND(x, y) ((x) & (y))
+
+// The inclusive scan of a sub-group takes log2 of its size shuffles. Its
+// reduction is the scan of the last lane, and its exclusive scan the scan of
+// the previous lane.
+#define __CLC_GROUP_COLLECTIVE(NAME, OP, TYPE, IDENTITY)                       \
+  _CLC_DEF _CLC_OVERLOAD _CLC_CONVERGENT TYPE __clc__SubgroupScan##NAME(       \
+      TYPE x) {                                                                \
+    const uint sg_lid = __spirv_SubgroupLocalInvocationId();                   \
+    const uint sg_size = __spirv_SubgroupSize();                               \
+    for (uint delta = 1; delta < sg_size; delta <<= 1) {                       \
+      TYPE y = __clc__SubgroupShuffleUp(x, delta);                             \
+      if (sg_lid >= delta)                                                     \
+        x = OP(y, x);                                                          \
+    }                                                                          \
+    return x;                                                                  \
+  }                                                                            \
+  _CLC_DEF _CLC_OVERLOAD _CLC_CONVERGENT TYPE __clc__SubgroupExclusive##NAME(  \
+      TYPE scan) {                                                             \
+    TYPE y = __clc__SubgroupShuffleUp(scan, 1);                                \
+    return __spirv_SubgroupLocalInvocationId() == 0 ? (TYPE)(IDENTITY) : y;    \
+  }                                                                            \
+  _CLC_DEF _CLC_OVERLOAD _CLC_CONVERGENT TYPE __spirv_Group##NAME(             \
+      uint scope, uint op, TYPE x) {                                           \
+    TYPE scan = __clc__SubgroupScan##NAME(x);                                  \
+    if (scope == Subgroup) {                                                   \
+      if (op == Reduce)                                                        \
+        return __clc__SubgroupShuffle(scan, __spirv_SubgroupSize() - 1);       \
+      if (op == ExclusiveScan)                                                 \
+        return __clc__SubgroupExclusive##NAME(scan);                           \
+      return scan;                                                             \
+    }                                                                          \
+                                                                               \
+    __local TYPE *scratch = (__local TYPE *)__clc__get_group_scratch();        \
+    const uint sg_id = __spirv_SubgroupId();                                   \
+    if (__spirv_SubgroupLocalInvocationId() == __spirv_SubgroupSize() - 1)     \
+      scratch[sg_id] = scan;                                                   \
+    __spirv_ControlBarrier(Workgroup, 0,                                       \
+                           WorkgroupMemory | SequentiallyConsistent);          \
+    TYPE prefix = (TYPE)(IDENTITY);                                            \
+    TYPE total = (TYPE)(IDENTITY);                                             \
+    const uint num_sg = __spirv_NumSubgroups();                                \
+    for (uint i = 0; i < num_sg; ++i) {                                        \
+      if (i == sg_id)                                                          \
+        prefix = total;                                                        \
+      total = OP(total, scratch[i]);                                           \
+    }                                                                          \
+    /* The scratch is reused by the next collective. */                        \
+    __spirv_ControlBarrier(Workgroup, 0,                                       \
+                           WorkgroupMemory | SequentiallyConsistent);          \
+    if (op == Reduce)                                                          \
+      return total;                                                            \
+    if (op == ExclusiveScan)                                                   \
+      return OP(prefix, __clc__SubgroupExclusive##NAME(scan));                 \
+    return OP(prefix, scan);                                                   \
+  }
+
+#define __CLC_INTEGER_COLLECTIVES(TYPE)                                        \
+  __CLC_GROUP_COLLECTIVE(IAdd, __CLC_ADD, TYPE, 0)                             \
+  __CLC_GROUP_COLLECTIVE(NonUniformIMul, __CLC_MUL, TYPE, 1)                   \
+  __CLC_GROUP_COLLECTIVE(NonUniformBitwiseOr, __CLC_OR, TYPE, 0)               \
+  __CLC_GROUP_COLLECTIVE(NonUniformBitwiseXor, __CLC_XOR, TYPE, 0)             \
+  __CLC_GROUP_COLLECTIVE(NonUniformBitwiseAnd, __CLC_AND, TYPE, ~0)
+
+__CLC_INTEGER_COLLECTIVES(short)
+__CLC_INTEGER_COLLECTIVES(ushort)
+__CLC_INTEGER_COLLECTIVES(int)
+__CLC_INTEGER_COLLECTIVES(uint)
+__CLC_INTEGER_COLLECTIVES(long)
+__CLC_INTEGER_COLLECTIVES(ulong)
+
+__CLC_GROUP_COLLECTIVE(SMin, __CLC_MIN, short, SHRT_MAX)
+__CLC_GROUP_COLLECTIVE(SMin, __CLC_MIN, int, INT_MAX)
+__CLC_GROUP_COLLECTIVE(SMin, __CLC_MIN, long, LONG_MAX)
+__CLC_GROUP_COLLECTIVE(UMin, __CLC_MIN, ushort, USHRT_MAX)
+__CLC_GROUP_COLLECTIVE(UMin, __CLC_MIN, uint, UINT_MAX)
+__CLC_GROUP_COLLECTIVE(UMin, __CLC_MIN, ulong, ULONG_MAX)
+__CLC_GROUP_COLLECTIVE(SMax, __CLC_MAX, short, SHRT_MIN)
+__CLC_GROUP_COLLECTIVE(SMax, __CLC_MAX, int, INT_MIN)
+__CLC_GROUP_COLLECTIVE(SMax, __CLC_MAX, long, LONG_MIN)
+__CLC_GROUP_COLLECTIVE(UMax, __CLC_MAX, ushort, 0)
+__CLC_GROUP_COLLECTIVE(UMax, __CLC_MAX, uint, 0)
+__CLC_GROUP_COLLECTIVE(UMax, __CLC_MAX, ulong, 0)
+
+#define __CLC_FLOAT_COLLECTIVES(TYPE)                                          \
+  __CLC_GROUP_COLLECTIVE(FAdd, __CLC_ADD, TYPE, 0)                             \
+  __CLC_GROUP_COLLECTIVE(NonUniformFMul, __CLC_MUL, TYPE, 1)                   \
+  __CLC_GROUP_COLLECTIVE(FMin, __CLC_MIN, TYPE, INFINITY)                      \
+  __CLC_GROUP_COLLECTIVE(FMax, __CLC_MAX, TYPE, -INFINITY)
+
+__CLC_FLOAT_COLLECTIVES(float)
+#ifdef cl_khr_fp64
+__CLC_FLOAT_COLLECTIVES(double)
+#endif
+
+#undef __CLC_FLOAT_COLLECTIVES
+#undef __CLC_INTEGER_COLLECTIVES
+#undef __CLC_GROUP_COLLECTIVE
+#undef __CLC_AND
+#undef __CLC_XOR
+#undef __CLC_OR
+#undef __CLC_MAX
+#undef __CLC_MIN
+#undef __CLC_MUL
+#undef __CLC_ADD
@@ -0,0 +1,12 @@
+; Scratch in the local memory for the partial results of the sub-groups of a
+; work-group: at most 32 sub-groups, of up to 8 bytes each.
+@__clc__group_scratch = internal addrspace(3) global [32 x i64] undef, align 8
+
+define i8 addrspace(3)* @__clc__get_group_scratch() #0 {
+entry:
+  %ptr = getelementptr inbounds [32 x i64], [32 x i64] addrspace(3)* @__clc__group_scratch, i64 0, i64 0
+  %cast = bitcast i64 addrspace(3)* %ptr to i8 addrspace(3)*
+  ret i8 addrspace(3)* %cast
+}
+
+attributes #0 = { alwaysinline }
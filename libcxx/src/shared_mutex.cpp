@@ -16,6 +16,68 @@
 
 _LIBCPP_BEGIN_NAMESPACE_STD
 
+#if defined(_LIBCPP_ABI_ATOMIC_SHARED_MUTEX)
+
+// Shared Mutex Base
+__shared_mutex_base::__shared_mutex_base()
+    : __state_(0)
+{
+}
+
+// Exclusive ownership
+
+void
+__shared_mutex_base::lock()
+{
+    // The writer bit keeps new readers out while those in leave.
+    if (!__try_set_write_entered())
+        __cxx_atomic_wait(&__state_, [this]() { return __try_set_write_entered(); });
+    if (!__readers_left())
+        __cxx_atomic_wait(&__state_, [this]() { return __readers_left(); });
+}
+
+bool
+__shared_mutex_base::try_lock()
+{
+    __cxx_contention_t __old = 0;
+    return __cxx_atomic_compare_exchange_strong(&__state_, &__old, __write_entered_,
+                                                memory_order_acquire, memory_order_relaxed);
+}
+
+void
+__shared_mutex_base::unlock()
+{
+    __cxx_atomic_store(&__state_, __cxx_contention_t(0), memory_order_release);
+    __cxx_atomic_notify_all(&__state_);
+}
+
+// Shared ownership
+
+void
+__shared_mutex_base::lock_shared()
+{
+    if (!__try_add_reader())
+        __cxx_atomic_wait(&__state_, [this]() { return __try_add_reader(); });
+}
+
+bool
+__shared_mutex_base::try_lock_shared()
+{
+    return __try_add_reader();
+}
+
+void
+__shared_mutex_base::unlock_shared()
+{
+    __cxx_contention_t __old = __cxx_atomic_fetch_sub(&__state_, __one_reader_, memory_order_release);
+    // Only a writer waiting for the last reader, or readers waiting for the
+    // count to drop below its maximum, need to be woken up.
+    if (__old == (__write_entered_ | __one_reader_) || __old == __max_readers_)
+        __cxx_atomic_notify_all(&__state_);
+}
+
+#else // _LIBCPP_ABI_ATOMIC_SHARED_MUTEX
+
 // Shared Mutex Base
 __shared_mutex_base::__shared_mutex_base()
     : __state_(0)
@@ -102,6 +164,7 @@ __shared_mutex_base::unlock_shared()
     }
 }
 
+#endif // _LIBCPP_ABI_ATOMIC_SHARED_MUTEX
 
 // Shared Timed Mutex
 // These routines are here for ABI stability
@@ -0,0 +1,58 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++03, c++11, c++14, c++17
+
+// <functional>
+
+// move_only_function holds the nothrow movable callables of up to six pointers
+// without allocating, and function does too with the large buffer ABI.
+
+#include <functional>
+#include <cassert>
+
+#include "test_macros.h"
+#include "count_new.h"
+
+int main(int, char**)
+{
+    long a = 1, b = 2, c = 3, d = 4, e = 5, f = 6;
+    auto six = [a, b, c, d, e, f] { return a + b + c + d + e + f; };
+    auto two = [a, b] { return a + b; };
+    {
+        globalMemCounter.reset();
+        std::move_only_function<long()> mf = six;
+        assert(mf() == 21);
+        assert(globalMemCounter.checkOutstandingNewEq(0));
+    }
+    {
+        globalMemCounter.reset();
+        std::function<long()> fn = two;
+        assert(fn() == 3);
+        assert(globalMemCounter.checkOutstandingNewEq(0));
+    }
+#ifdef _LIBCPP_ABI_FUNCTION_LARGE_BUFFER
+    {
+        globalMemCounter.reset();
+        std::function<long()> fn = six;
+        assert(fn() == 21);
+        assert(globalMemCounter.checkOutstandingNewEq(0));
+    }
+#endif
+    {
+        long g = 7;
+        auto seven = [a, b, c, d, e, f, g] { return a + b + c + d + e + f + g; };
+        globalMemCounter.reset();
+        std::move_only_function<long()> mf = seven;
+        assert(mf() == 28);
+        assert(globalMemCounter.checkOutstandingNewEq(1));
+    }
+    assert(globalMemCounter.checkOutstandingNewEq(0));
+
+  return 0;
+}
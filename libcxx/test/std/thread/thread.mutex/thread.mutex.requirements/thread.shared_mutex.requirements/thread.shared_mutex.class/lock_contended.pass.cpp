@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// UNSUPPORTED: libcpp-has-no-threads
+// UNSUPPORTED: c++03, c++11, c++14
+
+// shared_mutex was introduced in macosx10.12
+// UNSUPPORTED: with_system_cxx_lib=macosx10.11
+// UNSUPPORTED: with_system_cxx_lib=macosx10.10
+// UNSUPPORTED: with_system_cxx_lib=macosx10.9
+
+// <shared_mutex>
+
+// class shared_mutex;
+
+// Mixes readers and writers: the writers never overlap with each other or
+// with a reader, and every lock is eventually granted.
+
+#include <shared_mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cassert>
+
+#include "make_test_thread.h"
+#include "test_macros.h"
+
+std::shared_mutex m;
+std::atomic<int> readers(0);
+std::atomic<int> writers(0);
+long counter = 0;
+
+const int Iterations = 2000;
+
+void reader()
+{
+    for (int i = 0; i < Iterations; ++i)
+    {
+        m.lock_shared();
+        ++readers;
+        assert(writers == 0);
+        long c = counter;
+        std::this_thread::yield();
+        assert(counter == c);
+        --readers;
+        m.unlock_shared();
+    }
+}
+
+void writer()
+{
+    for (int i = 0; i < Iterations; ++i)
+    {
+        m.lock();
+        assert(++writers == 1);
+        assert(readers == 0);
+        ++counter;
+        --writers;
+        m.unlock();
+    }
+}
+
+int main(int, char**)
+{
+    std::vector<std::thread> v;
+    for (int i = 0; i < 4; ++i)
+        v.push_back(support::make_test_thread(reader));
+    for (int i = 0; i < 2; ++i)
+        v.push_back(support::make_test_thread(writer));
+    for (auto& t : v)
+        t.join();
+    assert(counter == 2 * Iterations);
+    assert(m.try_lock());
+    m.unlock();
+
+  return 0;
+}
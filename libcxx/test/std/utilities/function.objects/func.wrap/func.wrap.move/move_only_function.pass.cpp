@@ -0,0 +1,116 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++03, c++11, c++14, c++17
+
+// <functional>
+
+// template<class R, class... ArgTypes> class move_only_function<R(ArgTypes...) cv ref noexcept(noex)>;
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <cassert>
+
+#include "test_macros.h"
+
+struct Big
+{
+    long data_[16] = {};
+    int operator()(int x) && { return static_cast<int>(data_[15]) + x; }
+};
+
+struct Counted
+{
+    static int count;
+    Counted() { ++count; }
+    Counted(Counted&&) { ++count; }
+    ~Counted() { --count; }
+    int operator()() const { return 42; }
+};
+int Counted::count = 0;
+
+int twice(int x) { return 2 * x; }
+
+int main(int, char**)
+{
+    {
+        // Move-only callables, moves and emptiness.
+        std::move_only_function<int(int)> f = [p = std::make_unique<int>(3)](int x) { return *p + x; };
+        assert(f(4) == 7);
+        std::move_only_function<int(int)> g = std::move(f);
+        assert(!f);
+        assert(f == nullptr);
+        assert(g(1) == 4);
+        g = nullptr;
+        assert(!g);
+        static_assert(!std::is_copy_constructible_v<std::move_only_function<int(int)>>);
+        static_assert(std::is_nothrow_move_constructible_v<std::move_only_function<int(int)>>);
+    }
+    {
+        // A null function pointer gives an empty function.
+        int (*fp)(int) = nullptr;
+        std::move_only_function<int(int)> e = fp;
+        assert(!e);
+        e = twice;
+        assert(e(5) == 10);
+    }
+    {
+        // The qualifiers of the signature constrain the callables.
+        std::move_only_function<int(int) const noexcept> h = [](int x) noexcept { return x * 2; };
+        assert(h(3) == 6);
+        static_assert(!std::is_constructible_v<std::move_only_function<int(int) noexcept>, int (*)(int)>);
+        static_assert(std::is_constructible_v<std::move_only_function<int(int) &&>, Big>);
+        static_assert(!std::is_constructible_v<std::move_only_function<int(int) &>, Big>);
+        static_assert(std::is_nothrow_invocable_v<std::move_only_function<int(int) const noexcept> const&, int>);
+        static_assert(!std::is_invocable_v<std::move_only_function<int(int)> const&, int>);
+    }
+    {
+        // In-place construction, including of callables too large to be
+        // held inline.
+        Big big;
+        big.data_[15] = 5;
+        std::move_only_function<int(int) &&> b(std::in_place_type<Big>, big);
+        assert(std::move(b)(1) == 6);
+        std::move_only_function<int(int) &&> c = std::move(b);
+        assert(!b);
+        assert(std::move(c)(2) == 7);
+    }
+    {
+        // The callables are destroyed exactly once.
+        {
+            std::move_only_function<int() const> f{std::in_place_type<Counted>};
+            assert(Counted::count == 1);
+            std::move_only_function<int() const> g = std::move(f);
+            assert(Counted::count == 1);
+            assert(g() == 42);
+            f = std::move(g);
+            assert(Counted::count == 1);
+        }
+        assert(Counted::count == 0);
+    }
+    {
+        // swap, and the return value conversions.
+        std::string s = "abc";
+        std::move_only_function<std::string(std::string)> c = [s](std::string t) { return s + t; };
+        std::move_only_function<std::string(std::string)> d;
+        d.swap(c);
+        assert(!c);
+        assert(d("d") == "abcd");
+        c = [](std::string t) { return t; };
+        swap(c, d);
+        assert(c("x") == "abcx");
+        assert(d("y") == "y");
+        std::move_only_function<void()> v = [] { return 1; };
+        v();
+    }
+
+  return 0;
+}
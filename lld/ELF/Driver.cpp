@@ -325,6 +325,11 @@ static void checkOptions() {
   if (config->pie && config->shared)
     error("-shared and -pie may not be used together");
 
+  if (!config->thinLTORemoteCacheDir.empty() &&
+      config->thinLTOCacheDir.empty())
+    error("--thinlto-remote-cache-dir may not be used without "
+          "--thinlto-cache-dir");
+
   if (!config->shared && !config->filterList.empty())
     error("-F may not be used without -shared");
 
@@ -1064,6 +1069,12 @@ static void readConfigs(opt::InputArgList &args) {
   config->thinLTOCachePolicy = CHECK(
       parseCachePruningPolicy(args.getLastArgValue(OPT_thinlto_cache_policy)),
       "--thinlto-cache-policy: invalid cache policy");
+  config->thinLTORemoteCacheDir =
+      args.getLastArgValue(OPT_thinlto_remote_cache_dir);
+  config->thinLTORemoteCachePolicy = CHECK(
+      parseCachePruningPolicy(
+          args.getLastArgValue(OPT_thinlto_remote_cache_policy)),
+      "--thinlto-remote-cache-policy: invalid cache policy");
   config->thinLTOEmitImportsFiles = args.hasArg(OPT_thinlto_emit_imports_files);
   config->thinLTOIndexOnly = args.hasArg(OPT_thinlto_index_only) ||
                              args.hasArg(OPT_thinlto_index_only_eq);
@@ -2073,6 +2084,8 @@ template <class ELFT> void LinkerDriver::link(opt::InputArgList &args) {
   // appended to the Files vector.
   {
     llvm::TimeTraceScope timeScope("Parse input files");
+    // The files added by autolinking are only parsed serially.
+    preparseFiles(files);
     for (size_t i = 0; i < files.size(); ++i) {
       llvm::TimeTraceScope timeScope("Parse input files", files[i]->getName());
       parseFile(files[i]);
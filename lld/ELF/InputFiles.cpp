@@ -26,9 +26,11 @@
 #include "llvm/Support/ARMAttributeParser.h"
 #include "llvm/Support/ARMBuildAttributes.h"
 #include "llvm/Support/Endian.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/RISCVAttributeParser.h"
 #include "llvm/Support/TarWriter.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace llvm;
@@ -232,6 +234,47 @@ void elf::parseFile(InputFile *file) {
   }
 }
 
+template <class ELFT> static void doPreparseFiles(ArrayRef<InputFile *> files) {
+  std::vector<ObjFile<ELFT> *> objs;
+  size_t numGlobals = 0;
+  for (InputFile *file : files) {
+    // Incompatible files are diagnosed by parseFile.
+    if (file->kind() != InputFile::ObjKind || file->ekind != config->ekind)
+      continue;
+    auto *obj = cast<ObjFile<ELFT>>(file);
+    objs.push_back(obj);
+    numGlobals += obj->template getGlobalELFSyms<ELFT>().size();
+  }
+  parallelForEach(objs, [](ObjFile<ELFT> *obj) {
+    obj->hashGlobalSymbolNames();
+  });
+
+  // Most global symbols are defined or referenced by several files, so this
+  // overestimates the number of symbols, but growing the table is costlier
+  // than the unused space.
+  symtab->reserve(numGlobals);
+}
+
+void elf::preparseFiles(ArrayRef<InputFile *> files) {
+  llvm::TimeTraceScope timeScope("Preparse input files");
+  switch (config->ekind) {
+  case ELF32LEKind:
+    doPreparseFiles<ELF32LE>(files);
+    return;
+  case ELF32BEKind:
+    doPreparseFiles<ELF32BE>(files);
+    return;
+  case ELF64LEKind:
+    doPreparseFiles<ELF64LE>(files);
+    return;
+  case ELF64BEKind:
+    doPreparseFiles<ELF64BE>(files);
+    return;
+  default:
+    llvm_unreachable("unknown ELFT");
+  }
+}
+
 // Concatenates arguments to construct a string representing an error location.
 static std::string createFileLineMsg(StringRef path, unsigned line) {
   std::string filename = std::string(path::filename(path));
@@ -1082,6 +1125,22 @@ StringRef ObjFile<ELFT>::getSectionName(const Elf_Shdr &sec) {
 
 // Initialize this->Symbols. this->Symbols is a parallel array as
 // its corresponding ELF symbol table.
+template <class ELFT> void ObjFile<ELFT>::hashGlobalSymbolNames() {
+  ArrayRef<Elf_Sym> eSyms = this->template getGlobalELFSyms<ELFT>();
+  globalSymbolKeys.reserve(eSyms.size());
+  for (const Elf_Sym &eSym : eSyms) {
+    // Errors can't be reported from here, they are left to
+    // initializeSymbols.
+    if (eSym.getBinding() == STB_LOCAL ||
+        this->stringTable.size() <= eSym.st_name) {
+      globalSymbolKeys.clear();
+      return;
+    }
+    StringRef name = this->stringTable.data() + eSym.st_name;
+    globalSymbolKeys.push_back(SymbolTable::getSymbolKey(name));
+  }
+}
+
 template <class ELFT> void ObjFile<ELFT>::initializeSymbols() {
   ArrayRef<Elf_Sym> eSyms = this->getELFSyms<ELFT>();
   this->symbols.resize(eSyms.size());
@@ -1100,8 +1159,11 @@ template <class ELFT> void ObjFile<ELFT>::initializeSymbols() {
         error(toString(this) + ": non-local symbol (" + Twine(i) +
               ") found at index < .symtab's sh_info (" + Twine(firstGlobal) +
               ")");
-      this->symbols[i] =
-          symtab->insert(CHECK(eSyms[i].getName(this->stringTable), this));
+      if (!globalSymbolKeys.empty() && i >= firstGlobal)
+        this->symbols[i] = symtab->insert(globalSymbolKeys[i - firstGlobal]);
+      else
+        this->symbols[i] =
+            symtab->insert(CHECK(eSyms[i].getName(this->stringTable), this));
       continue;
     }
 
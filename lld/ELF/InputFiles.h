@@ -53,6 +53,11 @@ llvm::Optional<MemoryBufferRef> readFile(StringRef path);
 // Add symbols in File to the symbol table.
 void parseFile(InputFile *file);
 
+// Does the work of parseFile which doesn't depend on the symbol table, for all
+// the regular object files of `files`, in parallel. The files must then be
+// parsed in order with parseFile.
+void preparseFiles(ArrayRef<InputFile *> files);
+
 // The root class of input files.
 class InputFile {
 public:
@@ -256,6 +261,11 @@ public:
   // Get cached DWARF information.
   DWARFCache *getDwarf();
 
+  // Computes the symbol table keys of the global symbols, which
+  // initializeSymbols then inserts into the symbol table. This doesn't access
+  // the symbol table and may be called concurrently for different files.
+  void hashGlobalSymbolNames();
+
 private:
   void initializeSections(bool ignoreComdats);
   void initializeSymbols();
@@ -284,6 +294,11 @@ private:
   // .shstrtab contents.
   StringRef sectionStringTable;
 
+  // The symbol table keys of the global symbols, computed by
+  // hashGlobalSymbolNames. Empty if it wasn't called or if the symbols are
+  // malformed, in which case initializeSymbols reports the errors.
+  std::vector<llvm::CachedHashStringRef> globalSymbolKeys;
+
   // Debugging information to retrieve source file and line for error
   // reporting. Linker may find reasonable number of errors in a
   // single object file, so we cache debugging information in order to
@@ -297,14 +297,19 @@ std::vector<InputFile *> BitcodeCompiler::compile() {
 
   // The --thinlto-cache-dir option specifies the path to a directory in which
   // to cache native object files for ThinLTO incremental builds. If a path was
-  // specified, configure LTO to use it as the cache directory.
+  // specified, configure LTO to use it as the cache directory. The
+  // --thinlto-remote-cache-dir option specifies a directory shared by several
+  // links, e.g. on a network file system, which backs it.
   lto::NativeObjectCache cache;
-  if (!config->thinLTOCacheDir.empty())
-    cache = check(
-        lto::localCache(config->thinLTOCacheDir,
-                        [&](size_t task, std::unique_ptr<MemoryBuffer> mb) {
-                          files[task] = std::move(mb);
-                        }));
+  auto addBuffer = [&](size_t task, std::unique_ptr<MemoryBuffer> mb) {
+    files[task] = std::move(mb);
+  };
+  if (!config->thinLTORemoteCacheDir.empty())
+    cache = check(lto::tieredCache(
+        config->thinLTOCacheDir, addBuffer,
+        check(lto::directoryRemoteCache(config->thinLTORemoteCacheDir))));
+  else if (!config->thinLTOCacheDir.empty())
+    cache = check(lto::localCache(config->thinLTOCacheDir, addBuffer));
 
   if (!bitcodeFiles.empty())
     checkError(ltoObj->run(
@@ -340,6 +345,8 @@ std::vector<InputFile *> BitcodeCompiler::compile() {
 
   if (!config->thinLTOCacheDir.empty())
     pruneCache(config->thinLTOCacheDir, config->thinLTOCachePolicy);
+  if (!config->thinLTORemoteCacheDir.empty())
+    pruneCache(config->thinLTORemoteCacheDir, config->thinLTORemoteCachePolicy);
 
   if (!config->ltoObjPath.empty()) {
     saveBuffer(buf[0], config->ltoObjPath);
@@ -55,6 +55,7 @@
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/Demangle/Demangle.h"
 #include "llvm/Support/Endian.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 
@@ -1527,6 +1528,17 @@ static void scanReloc(InputSectionBase &sec, OffsetGetter &getOffset, RelTy *&i,
   processRelocAux<ELFT>(sec, expr, type, offset, sym, rel, addend);
 }
 
+// Sort relocations by offset for more efficient searching for
+// R_RISCV_PCREL_HI20 and R_PPC64_ADDR64.
+static void sortRelocations(InputSectionBase &sec) {
+  if (config->emachine == EM_RISCV ||
+      (config->emachine == EM_PPC64 && sec.name == ".toc"))
+    llvm::stable_sort(sec.relocations,
+                      [](const Relocation &lhs, const Relocation &rhs) {
+                        return lhs.offset < rhs.offset;
+                      });
+}
+
 template <class ELFT, class RelTy>
 static void scanRelocs(InputSectionBase &sec, ArrayRef<RelTy> rels) {
   OffsetGetter getOffset(sec);
@@ -1537,21 +1549,155 @@ static void scanRelocs(InputSectionBase &sec, ArrayRef<RelTy> rels) {
   for (auto i = rels.begin(), end = rels.end(); i != end;)
     scanReloc<ELFT>(sec, getOffset, i, rels.begin(), end);
 
-  // Sort relocations by offset for more efficient searching for
-  // R_RISCV_PCREL_HI20 and R_PPC64_ADDR64.
-  if (config->emachine == EM_RISCV ||
-      (config->emachine == EM_PPC64 && sec.name == ".toc"))
-    llvm::stable_sort(sec.relocations,
-                      [](const Relocation &lhs, const Relocation &rhs) {
-                        return lhs.offset < rhs.offset;
-                      });
+  sortRelocations(sec);
 }
 
-template <class ELFT> void elf::scanRelocations(InputSectionBase &s) {
-  if (s.areRelocsRela)
-    scanRelocs<ELFT>(s, s.relas<ELFT>());
-  else
-    scanRelocs<ELFT>(s, s.rels<ELFT>());
+// Most relocations are against non-preemptible defined symbols and are
+// link-time constants, so that scanReloc() only appends them to
+// sec.relocations. This does it for such a relocation without reading or
+// writing anything shared with the other sections, so that the sections can
+// be prescanned in parallel. Returns false if the relocation must rather be
+// processed by scanReloc(), in the same order as if all the relocations were
+// scanned serially, because it may create GOT, PLT or dynamic relocation
+// entries or change its symbol.
+template <class ELFT, class RelTy>
+static bool prescanReloc(InputSectionBase &sec, OffsetGetter &getOffset,
+                         const RelTy &rel, const RelTy *end) {
+  uint32_t symIndex = rel.getSymbol(config->isMips64EL);
+  if (symIndex == 0)
+    return false;
+  // A defined symbol which is neither preemptible, an ifunc, nor TLS, keeps
+  // the properties checked below all along the scan.
+  Symbol &sym = sec.getFile<ELFT>()->getSymbol(symIndex);
+  if (!sym.isDefined() || sym.isPreemptible || sym.isGnuIFunc() || sym.isTls())
+    return false;
+
+  RelType type = rel.getType(config->isMips64EL);
+  uint64_t offset = getOffset.get(rel.r_offset);
+  if (offset == uint64_t(-1))
+    return true;
+
+  const uint8_t *relocatedAddr = sec.data().begin() + rel.r_offset;
+  RelExpr expr = target->getRelExpr(type, sym, relocatedAddr);
+  if (expr == R_NONE)
+    return true;
+
+  // The same relaxations as scanReloc().
+  int64_t addend = computeAddend<ELFT>(rel, end, sec, expr, sym.isLocal());
+  if (expr != R_GOT_PC) {
+    if (config->emachine == EM_PPC && expr == R_PPC32_PLTREL)
+      addend &= ~0x8000;
+    if (!(config->emachine == EM_HEXAGON &&
+          (type == R_HEX_GD_PLT_B22_PCREL ||
+           type == R_HEX_GD_PLT_B22_PCREL_X ||
+           type == R_HEX_GD_PLT_B32_PCREL_X)))
+      expr = fromPlt(expr);
+  } else if (!isAbsoluteValue(sym)) {
+    expr = target->adjustGotPcExpr(type, addend, relocatedAddr);
+  }
+
+  if (oneof<R_GOTPLTONLY_PC, R_GOTPLTREL, R_GOTPLT, R_TLSGD_GOTPLT,
+            R_GOTONLY_PC, R_GOTREL, R_PPC64_TOCBASE, R_PPC64_RELAX_TOC>(expr) ||
+      needsPlt(expr) || needsGot(expr) ||
+      !isStaticLinkTimeConstant(expr, type, sym, sec, offset))
+    return false;
+
+  sec.relocations.push_back({expr, type, offset, addend, &sym});
+  return true;
+}
+
+namespace {
+// A relocation left to scanReloc() by prescanRelocs().
+struct DeferredReloc {
+  // The index of the relocation.
+  uint32_t index;
+  // The size of sec.relocations when it is processed.
+  uint32_t position;
+};
+} // namespace
+
+// Prescans the relocations of a section, and returns the ones left.
+template <class ELFT, class RelTy>
+static std::vector<DeferredReloc> prescanRelocs(InputSectionBase &sec,
+                                                ArrayRef<RelTy> rels) {
+  OffsetGetter getOffset(sec);
+  sec.relocations.reserve(rels.size());
+  std::vector<DeferredReloc> deferred;
+  bool deferNext = false;
+  for (size_t i = 0, e = rels.size(); i != e; ++i) {
+    if (!deferNext && prescanReloc<ELFT>(sec, getOffset, rels[i], rels.end()))
+      continue;
+    deferred.push_back({uint32_t(i), uint32_t(sec.relocations.size())});
+    // handleTlsRelocation() may process the relocations following a TLS one,
+    // e.g. the call to __tls_get_addr of a relaxed general dynamic access.
+    uint32_t symIndex = rels[i].getSymbol(config->isMips64EL);
+    deferNext =
+        symIndex != 0 && sec.getFile<ELFT>()->getSymbol(symIndex).isTls();
+  }
+  return deferred;
+}
+
+// Processes the relocations left by prescanRelocs() and inserts their
+// results between the prescanned ones.
+template <class ELFT, class RelTy>
+static void scanDeferredRelocs(InputSectionBase &sec, ArrayRef<RelTy> rels,
+                               ArrayRef<DeferredReloc> deferred) {
+  if (!deferred.empty()) {
+    SmallVector<Relocation, 0> prescanned = std::move(sec.relocations);
+    sec.relocations.clear();
+    sec.relocations.reserve(prescanned.size() + deferred.size());
+    OffsetGetter getOffset(sec);
+    size_t next = 0;
+    const RelTy *scanned = rels.begin();
+    for (const DeferredReloc &d : deferred) {
+      // Skip the relocation if scanReloc() processed it along with the
+      // previous one.
+      const RelTy *i = rels.begin() + d.index;
+      if (i < scanned)
+        continue;
+      sec.relocations.append(prescanned.begin() + next,
+                             prescanned.begin() + d.position);
+      next = d.position;
+      scanReloc<ELFT>(sec, getOffset, i, rels.begin(), rels.end());
+      scanned = i;
+    }
+    sec.relocations.append(prescanned.begin() + next, prescanned.end());
+  }
+  sortRelocations(sec);
+}
+
+template <class ELFT>
+void elf::scanRelocations(ArrayRef<InputSectionBase *> sections) {
+  // MIPS and PPC64 relocations are larger than one entry and depend on the
+  // relocations around them.
+  if (config->emachine == EM_MIPS || config->emachine == EM_PPC64) {
+    for (InputSectionBase *sec : sections) {
+      if (sec->areRelocsRela)
+        scanRelocs<ELFT>(*sec, sec->relas<ELFT>());
+      else
+        scanRelocs<ELFT>(*sec, sec->rels<ELFT>());
+    }
+    return;
+  }
+
+  // Scan the sections in parallel first, then process serially and in order
+  // the relocations with effects outside of their section, so that the output
+  // is the same as if all of them were scanned serially.
+  std::vector<std::vector<DeferredReloc>> deferred(sections.size());
+  parallelForEachN(0, sections.size(), [&](size_t i) {
+    InputSectionBase &sec = *sections[i];
+    if (sec.areRelocsRela)
+      deferred[i] = prescanRelocs<ELFT>(sec, sec.relas<ELFT>());
+    else
+      deferred[i] = prescanRelocs<ELFT>(sec, sec.rels<ELFT>());
+  });
+  for (size_t i = 0, e = sections.size(); i != e; ++i) {
+    InputSectionBase &sec = *sections[i];
+    if (sec.areRelocsRela)
+      scanDeferredRelocs<ELFT>(sec, sec.relas<ELFT>(), deferred[i]);
+    else
+      scanDeferredRelocs<ELFT>(sec, sec.rels<ELFT>(), deferred[i]);
+  }
 }
 
 static bool mergeCmp(const InputSection *a, const InputSection *b) {
@@ -2066,10 +2212,10 @@ void elf::hexagonTLSSymbolUpdate(ArrayRef<OutputSection *> outputSections) {
       });
 }
 
-template void elf::scanRelocations<ELF32LE>(InputSectionBase &);
-template void elf::scanRelocations<ELF32BE>(InputSectionBase &);
-template void elf::scanRelocations<ELF64LE>(InputSectionBase &);
-template void elf::scanRelocations<ELF64BE>(InputSectionBase &);
+template void elf::scanRelocations<ELF32LE>(ArrayRef<InputSectionBase *>);
+template void elf::scanRelocations<ELF32BE>(ArrayRef<InputSectionBase *>);
+template void elf::scanRelocations<ELF64LE>(ArrayRef<InputSectionBase *>);
+template void elf::scanRelocations<ELF64BE>(ArrayRef<InputSectionBase *>);
 template void elf::reportUndefinedSymbols<ELF32LE>();
 template void elf::reportUndefinedSymbols<ELF32BE>();
 template void elf::reportUndefinedSymbols<ELF64LE>();
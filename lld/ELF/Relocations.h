@@ -121,8 +121,9 @@ struct JumpInstrMod {
 
 // This function writes undefined symbol diagnostics to an internal buffer.
 // Call reportUndefinedSymbols() after calling scanRelocations() to emit
-// the diagnostics.
-template <class ELFT> void scanRelocations(InputSectionBase &);
+// the diagnostics. The sections are scanned in parallel, and the result is the
+// same as if they were scanned one after the other.
+template <class ELFT> void scanRelocations(ArrayRef<InputSectionBase *>);
 
 template <class ELFT> void reportUndefinedSymbols();
 
@@ -46,6 +46,15 @@ public:
   void wrap(Symbol *sym, Symbol *real, Symbol *wrap);
 
   Symbol *insert(StringRef name);
+  Symbol *insert(llvm::CachedHashStringRef key);
+
+  // Returns the key of the symbol table entry of a symbol name, i.e. the name
+  // without its default version and its hash. This doesn't access the symbol
+  // table and may be called concurrently.
+  static llvm::CachedHashStringRef getSymbolKey(StringRef name);
+
+  // Reserves space for `n` more symbols.
+  void reserve(size_t n);
 
   Symbol *addSymbol(const Symbol &newSym);
 
@@ -38,6 +38,7 @@
 #include "llvm/Support/MD5.h"
 #include "llvm/Support/Parallel.h"
 #include "llvm/Support/TimeProfiler.h"
+#include <array>
 #include <cstdlib>
 #include <thread>
 
@@ -2769,10 +2770,44 @@ readPubNamesAndTypes(const LLDDwarfObj<ELFT> &obj,
   return ret;
 }
 
+// The symbols of .gdb_index are uniquified by name in this many shards, in
+// parallel.
+static constexpr size_t numGdbSymbolShards = 32;
+
+// The offsets of the groups of the names of a chunk in each shard.
+using GdbShardBegins = std::array<uint32_t, numGdbSymbolShards + 1>;
+
+static size_t getGdbSymbolShardId(CachedHashStringRef name) {
+  return name.hash() >> (32 - countTrailingZeros(numGdbSymbolShards));
+}
+
+// Groups the symbol names and types of an object file by shard, keeping
+// their order within each shard, and returns where each group starts.
+static GdbShardBegins
+groupByShard(std::vector<GdbIndexSection::NameAttrEntry> &entries) {
+  using NameAttrEntry = GdbIndexSection::NameAttrEntry;
+  llvm::stable_sort(entries,
+                    [](const NameAttrEntry &a, const NameAttrEntry &b) {
+                      return getGdbSymbolShardId(a.name) <
+                             getGdbSymbolShardId(b.name);
+                    });
+  GdbShardBegins shardBegins;
+  for (size_t shardId = 0; shardId <= numGdbSymbolShards; ++shardId)
+    shardBegins[shardId] =
+        llvm::partition_point(entries,
+                              [&](const NameAttrEntry &ent) {
+                                return getGdbSymbolShardId(ent.name) < shardId;
+                              }) -
+        entries.begin();
+  return shardBegins;
+}
+
 // Create a list of symbols from a given list of symbol names and types
-// by uniquifying them by name.
+// by uniquifying them by name. The names of each chunk are grouped by shard,
+// starting at the offsets of shardBegins.
 static std::vector<GdbIndexSection::GdbSymbol>
 createSymbols(ArrayRef<std::vector<GdbIndexSection::NameAttrEntry>> nameAttrs,
+              ArrayRef<GdbShardBegins> shardBegins,
               const std::vector<GdbIndexSection::GdbChunk> &chunks) {
   using GdbSymbol = GdbIndexSection::GdbSymbol;
   using NameAttrEntry = GdbIndexSection::NameAttrEntry;
@@ -2788,7 +2823,7 @@ createSymbols(ArrayRef<std::vector<GdbIndexSection::NameAttrEntry>> nameAttrs,
   // The number of symbols we will handle in this function is of the order
   // of millions for very large executables, so we use multi-threading to
   // speed it up.
-  constexpr size_t numShards = 32;
+  constexpr size_t numShards = numGdbSymbolShards;
   size_t concurrency = PowerOf2Floor(
       std::min<size_t>(hardware_concurrency(parallel::strategy.ThreadsRequested)
                            .compute_thread_count(),
@@ -2796,29 +2831,29 @@ createSymbols(ArrayRef<std::vector<GdbIndexSection::NameAttrEntry>> nameAttrs,
 
   // A sharded map to uniquify symbols by name.
   std::vector<DenseMap<CachedHashStringRef, size_t>> map(numShards);
-  size_t shift = 32 - countTrailingZeros(numShards);
 
-  // Instantiate GdbSymbols while uniqufying them by name.
+  // Instantiate GdbSymbols while uniqufying them by name. Each thread only
+  // reads the names of its shards.
   std::vector<std::vector<GdbSymbol>> symbols(numShards);
   parallelForEachN(0, concurrency, [&](size_t threadId) {
-    uint32_t i = 0;
-    for (ArrayRef<NameAttrEntry> entries : nameAttrs) {
-      for (const NameAttrEntry &ent : entries) {
-        size_t shardId = ent.name.hash() >> shift;
-        if ((shardId & (concurrency - 1)) != threadId)
-          continue;
+    for (size_t shardId = threadId; shardId < numShards;
+         shardId += concurrency) {
+      for (size_t i = 0, e = nameAttrs.size(); i != e; ++i) {
+        ArrayRef<NameAttrEntry> entries = makeArrayRef(nameAttrs[i]).slice(
+            shardBegins[i][shardId],
+            shardBegins[i][shardId + 1] - shardBegins[i][shardId]);
+        for (const NameAttrEntry &ent : entries) {
+          uint32_t v = ent.cuIndexAndAttrs + cuIdxs[i];
+          size_t &idx = map[shardId][ent.name];
+          if (idx) {
+            symbols[shardId][idx - 1].cuVector.push_back(v);
+            continue;
+          }
 
-        uint32_t v = ent.cuIndexAndAttrs + cuIdxs[i];
-        size_t &idx = map[shardId][ent.name];
-        if (idx) {
-          symbols[shardId][idx - 1].cuVector.push_back(v);
-          continue;
+          idx = symbols[shardId].size() + 1;
+          symbols[shardId].push_back({ent.name, {v}, 0, 0});
         }
-
-        idx = symbols[shardId].size() + 1;
-        symbols[shardId].push_back({ent.name, {v}, 0, 0});
       }
-      ++i;
     }
   });
 
@@ -2871,6 +2906,7 @@ template <class ELFT> GdbIndexSection *GdbIndexSection::create() {
 
   std::vector<GdbChunk> chunks(files.size());
   std::vector<std::vector<NameAttrEntry>> nameAttrs(files.size());
+  std::vector<GdbShardBegins> shardBegins(files.size());
 
   parallelForEachN(0, files.size(), [&](size_t i) {
     // To keep memory usage low, we don't want to keep cached DWARFContext, so
@@ -2885,11 +2921,12 @@ template <class ELFT> GdbIndexSection *GdbIndexSection::create() {
     chunks[i].compilationUnits = readCuList(dwarf);
     chunks[i].addressAreas = readAddressAreas(dwarf, chunks[i].sec);
     nameAttrs[i] = readPubNamesAndTypes<ELFT>(dobj, chunks[i].compilationUnits);
+    shardBegins[i] = groupByShard(nameAttrs[i]);
   });
 
   auto *ret = make<GdbIndexSection>();
   ret->chunks = std::move(chunks);
-  ret->symbols = createSymbols(nameAttrs, ret->chunks);
+  ret->symbols = createSymbols(nameAttrs, shardBegins, ret->chunks);
   ret->initOutputSize();
   return ret;
 }
@@ -3227,8 +3264,9 @@ void MergeTailSection::finalizeContents() {
 }
 
 void MergeNoTailSection::writeTo(uint8_t *buf) {
-  for (size_t i = 0; i < numShards; ++i)
-    shards[i].write(buf + shardOffsets[i]);
+  // The shards are written to disjoint ranges of the section.
+  parallelForEachN(0, numShards,
+                   [&](size_t i) { shards[i].write(buf + shardOffsets[i]); });
 }
 
 // This function is very hot (i.e. it can take several seconds to finish)
@@ -3288,7 +3326,12 @@ void MergeNoTailSection::finalizeContents() {
 MergeSyntheticSection *elf::createMergeSynthetic(StringRef name, uint32_t type,
                                                  uint64_t flags,
                                                  uint32_t alignment) {
-  bool shouldTailMerge = (flags & SHF_STRINGS) && config->optimize >= 2;
+  // Tail merging is done by a single thread. The debug string sections, e.g.
+  // .debug_str and .debug_line_str, are often the largest merged sections by
+  // far and gain little from it, so they are only deduplicated, in parallel.
+  bool shouldTailMerge = (flags & SHF_STRINGS) && config->optimize >= 2 &&
+                         !((flags & SHF_ALLOC) == 0 &&
+                           name.startswith(".debug_"));
   if (shouldTailMerge)
     return make<MergeTailSection>(name, type, flags, alignment);
   return make<MergeNoTailSection>(name, type, flags, alignment);
@@ -1978,7 +1978,10 @@ template <class ELFT> void Writer<ELFT>::finalizeSections() {
     // a linker-script-defined symbol is absolute.
     ppc64noTocRelax.clear();
     if (!config->relocatable) {
-      forEachRelSec(scanRelocations<ELFT>);
+      std::vector<InputSectionBase *> relSections;
+      forEachRelSec(
+          [&](InputSectionBase &sec) { relSections.push_back(&sec); });
+      scanRelocations<ELFT>(relSections);
       reportUndefinedSymbols<ELFT>();
     }
   }
@@ -2896,9 +2899,15 @@ template <class ELFT> void Writer<ELFT>::openFile() {
 }
 
 template <class ELFT> void Writer<ELFT>::writeSectionsBinary() {
+  // The output sections occupy disjoint ranges of the file, so they are
+  // written in parallel as in writeSections.
+  std::vector<OutputSection *> sections;
   for (OutputSection *sec : outputSections)
     if (sec->flags & SHF_ALLOC)
-      sec->writeTo<ELFT>(Out::bufferStart + sec->offset);
+      sections.push_back(sec);
+  parallelForEach(sections, [](OutputSection *sec) {
+    sec->writeTo<ELFT>(Out::bufferStart + sec->offset);
+  });
 }
 
 static void fillTrap(uint8_t *i, uint8_t *end) {
@@ -2945,9 +2954,18 @@ template <class ELFT> void Writer<ELFT>::writeSections() {
     if (sec->type == SHT_REL || sec->type == SHT_RELA)
       sec->writeTo<ELFT>(Out::bufferStart + sec->offset);
 
+  // The other output sections occupy disjoint ranges of the file, and the
+  // contents which depend on other sections, e.g. .eh_frame_hdr, are written
+  // with them, so they are written in parallel. The output sections with a
+  // single large input section, e.g. the symbol and string tables, would
+  // otherwise be written one after the other.
+  std::vector<OutputSection *> sections;
   for (OutputSection *sec : outputSections)
     if (sec->type != SHT_REL && sec->type != SHT_RELA)
-      sec->writeTo<ELFT>(Out::bufferStart + sec->offset);
+      sections.push_back(sec);
+  parallelForEach(sections, [](OutputSection *sec) {
+    sec->writeTo<ELFT>(Out::bufferStart + sec->offset);
+  });
 }
 
 // Split one uint8 array into small pieces of uint8 arrays.
@@ -13,14 +13,26 @@
 #include "Plugins/SymbolFile/DWARF/LogChannelDWARF.h"
 #include "Plugins/SymbolFile/DWARF/SymbolFileDWARFDwo.h"
 #include "lldb/Core/Module.h"
+#include "lldb/Host/FileSystem.h"
 #include "lldb/Symbol/ObjectFile.h"
+#include "lldb/Utility/DataBufferLLVM.h"
+#include "lldb/Utility/DataExtractor.h"
 #include "lldb/Utility/Stream.h"
+#include "lldb/Utility/StreamString.h"
 #include "lldb/Utility/Timer.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/ThreadPool.h"
 
 using namespace lldb_private;
 using namespace lldb;
 
+/// "LDMI" in the byte order of the cache files, which is always little-endian.
+static constexpr uint32_t g_cache_magic = 0x494d444c;
+/// Bumped whenever the contents or the format of the index change.
+static constexpr uint32_t g_cache_version = 1;
+
 void ManualDWARFIndex::Index() {
   if (!m_dwarf)
     return;
@@ -57,6 +69,11 @@ void ManualDWARFIndex::Index() {
   if (units_to_index.empty())
     return;
 
+  llvm::Optional<FileSpec> cache_file =
+      GetCacheFile(units_to_index, dwp_dwarf);
+  if (cache_file && LoadFromCache(*cache_file))
+    return;
+
   std::vector<IndexSet> sets(units_to_index.size());
 
   // Keep memory down by clearing DIEs for any units if indexing
@@ -109,6 +126,129 @@ void ManualDWARFIndex::Index() {
   pool.async(finalize_fn, &IndexSet::types);
   pool.async(finalize_fn, &IndexSet::namespaces);
   pool.wait();
+
+  if (cache_file)
+    SaveToCache(*cache_file);
+}
+
+llvm::Optional<FileSpec>
+ManualDWARFIndex::GetCacheFile(llvm::ArrayRef<DWARFUnit *> units,
+                               SymbolFileDWARFDwo *dwp) {
+  FileSpec cache_dir = SymbolFileDWARF::GetIndexCachePath();
+  const UUID &uuid = m_module.GetUUID();
+  if (!cache_dir || !uuid.IsValid() || dwp)
+    return llvm::None;
+  for (DWARFUnit *unit : units)
+    if (unit->GetDwoSymbolFile())
+      return llvm::None;
+
+  // The units covered by other indexes are part of the key, as the index of
+  // the same module differs without them.
+  std::vector<dw_offset_t> units_to_avoid(m_units_to_avoid.begin(),
+                                          m_units_to_avoid.end());
+  llvm::sort(units_to_avoid);
+  const size_t units_to_avoid_hash = llvm::hash_combine_range(
+      units_to_avoid.begin(), units_to_avoid.end());
+  cache_dir.AppendPathComponent(
+      llvm::formatv("{0}-{1:x-}.dwarf-index", uuid.GetAsString(""),
+                    units_to_avoid_hash)
+          .str());
+  return cache_dir;
+}
+
+static uint64_t GetCacheTimestamp(Module &module) {
+  return module.GetModificationTime().time_since_epoch().count();
+}
+
+bool ManualDWARFIndex::LoadFromCache(const FileSpec &file) {
+  Log *log = LogChannelDWARF::GetLogIfAll(DWARF_LOG_DEBUG_INFO);
+
+  std::shared_ptr<DataBufferLLVM> buffer_sp =
+      FileSystem::Instance().CreateDataBuffer(file);
+  if (!buffer_sp)
+    return false;
+  DataExtractor data(buffer_sp, eByteOrderLittle, 4);
+  lldb::offset_t offset = 0;
+  if (data.GetU32(&offset) != g_cache_magic ||
+      data.GetU32(&offset) != g_cache_version ||
+      data.GetU64(&offset) != GetCacheTimestamp(m_module))
+    return false;
+  if (!m_set.Decode(data, &offset)) {
+    LLDB_LOG(log, "Ignoring the truncated DWARF index cache {0}", file);
+    m_set = IndexSet();
+    return false;
+  }
+  LLDB_LOG(log, "Loaded the DWARF index of {0} from {1}",
+           m_module.GetFileSpec(), file);
+  return true;
+}
+
+void ManualDWARFIndex::SaveToCache(const FileSpec &file) {
+  Log *log = LogChannelDWARF::GetLogIfAll(DWARF_LOG_DEBUG_INFO);
+
+  StreamString s(Stream::eBinary, 4, eByteOrderLittle);
+  s.PutHex32(g_cache_magic);
+  s.PutHex32(g_cache_version);
+  s.PutHex64(GetCacheTimestamp(m_module));
+  m_set.Encode(s);
+
+  // The index is written to a unique file renamed at the end, so that another
+  // debugger never loads a partial index.
+  const std::string path = file.GetPath();
+  llvm::SmallString<128> temp_path;
+  int fd;
+  if (llvm::sys::fs::create_directories(file.GetDirectory().GetStringRef()))
+    return;
+  if (llvm::sys::fs::createUniqueFile(path + "-%%%%%%", fd, temp_path))
+    return;
+  {
+    llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+    os << s.GetString();
+    os.close();
+    if (os.has_error()) {
+      os.clear_error();
+      llvm::sys::fs::remove(temp_path);
+      return;
+    }
+  }
+  if (llvm::sys::fs::rename(temp_path, path)) {
+    llvm::sys::fs::remove(temp_path);
+    return;
+  }
+  LLDB_LOG(log, "Saved the DWARF index of {0} to {1}", m_module.GetFileSpec(),
+           file);
+}
+
+void ManualDWARFIndex::IndexSet::Encode(Stream &s) const {
+  function_basenames.Encode(s);
+  function_fullnames.Encode(s);
+  function_methods.Encode(s);
+  function_selectors.Encode(s);
+  objc_class_selectors.Encode(s);
+  globals.Encode(s);
+  types.Encode(s);
+  namespaces.Encode(s);
+}
+
+bool ManualDWARFIndex::IndexSet::Decode(const DataExtractor &data,
+                                        lldb::offset_t *offset_ptr) {
+  if (!function_basenames.Decode(data, offset_ptr) ||
+      !function_fullnames.Decode(data, offset_ptr) ||
+      !function_methods.Decode(data, offset_ptr) ||
+      !function_selectors.Decode(data, offset_ptr) ||
+      !objc_class_selectors.Decode(data, offset_ptr) ||
+      !globals.Decode(data, offset_ptr) || !types.Decode(data, offset_ptr) ||
+      !namespaces.Decode(data, offset_ptr))
+    return false;
+  function_basenames.Finalize();
+  function_fullnames.Finalize();
+  function_methods.Finalize();
+  function_selectors.Finalize();
+  objc_class_selectors.Finalize();
+  globals.Finalize();
+  types.Finalize();
+  namespaces.Finalize();
+  return true;
 }
 
 void ManualDWARFIndex::IndexUnit(DWARFUnit &unit, SymbolFileDWARFDwo *dwp,
@@ -344,6 +484,22 @@ void ManualDWARFIndex::GetGlobalVariables(
 
 void ManualDWARFIndex::GetGlobalVariables(
     const DWARFUnit &unit, llvm::function_ref<bool(DWARFDIE die)> callback) {
+  // The globals of a unit of the main file only take the index of the unit,
+  // so that stopping in a unit doesn't index the whole module.
+  if (m_dwarf && &unit.GetSymbolFileDWARF() == m_dwarf) {
+    if (m_units_to_avoid.count(unit.GetOffset()))
+      return;
+    if (DWARFUnit *unit_to_index = m_dwarf->DebugInfo().GetUnitAtOffset(
+            unit.GetDebugSection(), unit.GetOffset())) {
+      DWARFUnit::ScopedExtractDIEs clear_dies =
+          unit_to_index->ExtractDIEsScoped();
+      IndexSet set;
+      IndexUnit(*unit_to_index, m_dwarf->GetDwpSymbolFile().get(), set);
+      set.globals.Finalize();
+      set.globals.FindAllEntriesForUnit(unit, DIERefCallback(callback));
+      return;
+    }
+  }
   Index();
   m_set.globals.FindAllEntriesForUnit(unit, DIERefCallback(callback));
 }
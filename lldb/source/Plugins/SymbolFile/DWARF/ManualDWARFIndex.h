@@ -11,6 +11,7 @@
 
 #include "Plugins/SymbolFile/DWARF/DWARFIndex.h"
 #include "Plugins/SymbolFile/DWARF/NameToDIE.h"
+#include "lldb/Utility/FileSpec.h"
 #include "llvm/ADT/DenseSet.h"
 
 class DWARFDebugInfo;
@@ -65,10 +66,24 @@ private:
     NameToDIE globals;
     NameToDIE types;
     NameToDIE namespaces;
+
+    void Encode(Stream &s) const;
+    /// Decode and finalize the maps written by Encode().
+    bool Decode(const DataExtractor &data, lldb::offset_t *offset_ptr);
   };
   void Index();
   void IndexUnit(DWARFUnit &unit, SymbolFileDWARFDwo *dwp, IndexSet &set);
 
+  /// The file caching the index, if the cache is enabled and the index of the
+  /// module can be cached. The DWARF of split units lives in files which may
+  /// change without the module, so their index is never cached.
+  llvm::Optional<FileSpec> GetCacheFile(llvm::ArrayRef<DWARFUnit *> units,
+                                        SymbolFileDWARFDwo *dwp);
+  /// Load the index from \a file into m_set, if it was saved for this version
+  /// of the module.
+  bool LoadFromCache(const FileSpec &file);
+  void SaveToCache(const FileSpec &file);
+
   static void IndexUnitImpl(DWARFUnit &unit,
                             const lldb::LanguageType cu_language,
                             IndexSet &set);
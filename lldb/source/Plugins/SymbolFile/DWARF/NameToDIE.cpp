@@ -10,6 +10,7 @@
 #include "DWARFUnit.h"
 #include "lldb/Symbol/ObjectFile.h"
 #include "lldb/Utility/ConstString.h"
+#include "lldb/Utility/DataExtractor.h"
 #include "lldb/Utility/RegularExpression.h"
 #include "lldb/Utility/Stream.h"
 #include "lldb/Utility/StreamString.h"
@@ -86,3 +87,40 @@ void NameToDIE::Append(const NameToDIE &other) {
                  other.m_map.GetValueAtIndexUnchecked(i));
   }
 }
+
+void NameToDIE::Encode(Stream &s) const {
+  const uint32_t size = m_map.GetSize();
+  s.PutHex32(size);
+  for (uint32_t i = 0; i < size; ++i) {
+    const DIERef &die_ref = m_map.GetValueAtIndexUnchecked(i);
+    s.PutCString(m_map.GetCStringAtIndexUnchecked(i).GetStringRef());
+    // The dwo number is biased by one, so that zero means the main file.
+    s.PutHex32(die_ref.dwo_num() ? *die_ref.dwo_num() + 1 : 0);
+    s.PutHex8(die_ref.section());
+    s.PutHex32(die_ref.die_offset());
+  }
+}
+
+bool NameToDIE::Decode(const DataExtractor &data, lldb::offset_t *offset_ptr) {
+  if (!data.ValidOffsetForDataOfSize(*offset_ptr, 4))
+    return false;
+  const uint32_t size = data.GetU32(offset_ptr);
+  // An entry takes at least 10 bytes, which bounds the size of a corrupt map.
+  const lldb::offset_t max_size = data.BytesLeft(*offset_ptr) / 10;
+  m_map.Reserve(m_map.GetSize() + std::min<lldb::offset_t>(size, max_size));
+  for (uint32_t i = 0; i < size; ++i) {
+    const char *name = data.GetCStr(offset_ptr);
+    if (!name || !data.ValidOffsetForDataOfSize(*offset_ptr, 9))
+      return false;
+    const uint32_t dwo_num = data.GetU32(offset_ptr);
+    const uint8_t section = data.GetU8(offset_ptr);
+    const dw_offset_t die_offset = data.GetU32(offset_ptr);
+    if (section > DIERef::DebugTypes)
+      return false;
+    m_map.Append(ConstString(name),
+                 DIERef(dwo_num ? llvm::Optional<uint32_t>(dwo_num - 1)
+                                : llvm::None,
+                        static_cast<DIERef::Section>(section), die_offset));
+  }
+  return true;
+}
@@ -47,6 +47,15 @@ public:
                              const DIERef &die_ref)> const
               &callback) const;
 
+  /// Write the entries to a binary stream, in the order of the map.
+  void Encode(lldb_private::Stream &s) const;
+
+  /// Append the entries written by Encode() at \a *offset_ptr and advance it
+  /// past them. Return false if the data is truncated. The map needs to be
+  /// finalized afterwards, since its order depends on the string pool.
+  bool Decode(const lldb_private::DataExtractor &data,
+              lldb::offset_t *offset_ptr);
+
 protected:
   lldb_private::UniqueCStringMap<DIERef> m_map;
 };
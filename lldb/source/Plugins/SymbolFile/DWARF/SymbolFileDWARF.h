@@ -231,6 +231,10 @@ public:
 
   static bool SupportedVersion(uint16_t version);
 
+  /// The directory of the cache of the manual indexes, which is empty if the
+  /// cache is disabled.
+  static lldb_private::FileSpec GetIndexCachePath();
+
   DWARFDIE
   GetDeclContextDIEContainingDIE(const DWARFDIE &die);
 
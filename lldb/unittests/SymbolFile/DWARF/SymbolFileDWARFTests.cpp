@@ -20,6 +20,7 @@
 #include "Plugins/SymbolFile/DWARF/DWARFDebugAbbrev.h"
 #include "Plugins/SymbolFile/DWARF/DWARFDebugArangeSet.h"
 #include "Plugins/SymbolFile/DWARF/DWARFDebugAranges.h"
+#include "Plugins/SymbolFile/DWARF/NameToDIE.h"
 #include "Plugins/SymbolFile/DWARF/SymbolFileDWARF.h"
 #include "Plugins/SymbolFile/PDB/SymbolFilePDB.h"
 #include "Plugins/TypeSystem/Clang/TypeSystemClang.h"
@@ -34,6 +35,7 @@
 #include "lldb/Symbol/LineTable.h"
 #include "lldb/Utility/ArchSpec.h"
 #include "lldb/Utility/DataEncoder.h"
+#include "lldb/Utility/DataExtractor.h"
 #include "lldb/Utility/FileSpec.h"
 #include "lldb/Utility/StreamString.h"
 
@@ -385,3 +387,41 @@ TEST_F(SymbolFileDWARFTests, ParseAranges) {
   EXPECT_EQ(debug_aranges.FindAddress(0x2100 - 1), 255u);
   EXPECT_EQ(debug_aranges.FindAddress(0x2100), DW_INVALID_OFFSET);
 }
+
+TEST_F(SymbolFileDWARFTests, NameToDIEEncodeDecode) {
+  NameToDIE map;
+  map.Insert(ConstString("foo"), DIERef(llvm::None, DIERef::DebugInfo, 0x10));
+  map.Insert(ConstString("bar"), DIERef(3, DIERef::DebugTypes, 0x20));
+  map.Finalize();
+
+  StreamString encoder(Stream::eBinary, 4, eByteOrderLittle);
+  map.Encode(encoder);
+  DataExtractor data(encoder.GetData(), encoder.GetSize(), eByteOrderLittle, 4);
+  lldb::offset_t offset = 0;
+  NameToDIE decoded;
+  ASSERT_TRUE(decoded.Decode(data, &offset));
+  decoded.Finalize();
+  EXPECT_EQ(encoder.GetSize(), offset);
+
+  std::vector<DIERef> refs;
+  auto collect = [&](DIERef ref) {
+    refs.push_back(ref);
+    return true;
+  };
+  decoded.Find(ConstString("foo"), collect);
+  decoded.Find(ConstString("bar"), collect);
+  ASSERT_EQ(2u, refs.size());
+  EXPECT_EQ(llvm::None, refs[0].dwo_num());
+  EXPECT_EQ(DIERef::DebugInfo, refs[0].section());
+  EXPECT_EQ(0x10u, refs[0].die_offset());
+  EXPECT_EQ(3u, refs[1].dwo_num());
+  EXPECT_EQ(DIERef::DebugTypes, refs[1].section());
+  EXPECT_EQ(0x20u, refs[1].die_offset());
+
+  // A truncated map is rejected.
+  DataExtractor truncated(encoder.GetData(), encoder.GetSize() - 1,
+                          eByteOrderLittle, 4);
+  offset = 0;
+  NameToDIE partial;
+  EXPECT_FALSE(partial.Decode(truncated, &offset));
+}
@@ -1640,14 +1640,21 @@ class TopologicalSort {
   typedef std::vector<SPIRVVariable *> SPIRVVariableVec;
   typedef std::vector<SPIRVEntry *> SPIRVConstAndVarVec;
   typedef std::vector<SPIRVTypeForwardPointer *> SPIRVForwardPointerVec;
-  typedef std::function<bool(SPIRVEntry *, SPIRVEntry *)> IdComp;
+  struct IdComp {
+    bool operator()(SPIRVEntry *A, SPIRVEntry *B) const {
+      return A->getId() < B->getId();
+    }
+  };
   typedef std::map<SPIRVEntry *, DFSState, IdComp> EntryStateMapTy;
 
   SPIRVTypeVec TypeIntVec;
   SPIRVConstantVector ConstIntVec;
   SPIRVTypeVec TypeVec;
   SPIRVConstAndVarVec ConstAndVarVec;
-  const SPIRVForwardPointerVec &ForwardPointerVec;
+  // Pointer types referenced by OpTypeForwardPointer. Looked up for every
+  // pointer operand, so kept in a hash set rather than scanning the forward
+  // pointers, which made the sort quadratic for modules with many of them.
+  std::unordered_set<SPIRVEntry *> ForwardPointers;
   EntryStateMapTy EntryStateMap;
 
   friend spv_ostream &operator<<(spv_ostream &O, const TopologicalSort &S);
@@ -1664,13 +1671,8 @@ class TopologicalSort {
       return;
     State = Discovered;
     for (SPIRVEntry *Op : E->getNonLiteralOperands()) {
-      auto Comp = [&Op](SPIRVTypeForwardPointer *FwdPtr) {
-        return FwdPtr->getPointer() == Op;
-      };
       // Skip forward referenced pointers
-      if (Op->getOpCode() == OpTypePointer &&
-          find_if(ForwardPointerVec.begin(), ForwardPointerVec.end(), Comp) !=
-              ForwardPointerVec.end())
+      if (Op->getOpCode() == OpTypePointer && ForwardPointers.count(Op))
         continue;
       visit(Op);
     }
@@ -1694,11 +1696,9 @@ public:
   TopologicalSort(const SPIRVTypeVec &TypeVec,
                   const SPIRVConstantVector &ConstVec,
                   const SPIRVVariableVec &VariableVec,
-                  const SPIRVForwardPointerVec &ForwardPointerVec)
-      : ForwardPointerVec(ForwardPointerVec),
-        EntryStateMap([](SPIRVEntry *A, SPIRVEntry *B) -> bool {
-          return A->getId() < B->getId();
-        }) {
+                  const SPIRVForwardPointerVec &ForwardPointerVec) {
+    for (auto *FwdPtr : ForwardPointerVec)
+      ForwardPointers.insert(FwdPtr->getPointer());
     // Collect entries for sorting
     for (auto *T : TypeVec)
       EntryStateMap[T] = DFSState::Unvisited;
@@ -1707,7 +1707,7 @@ public:
     for (auto *V : VariableVec)
       EntryStateMap[V] = DFSState::Unvisited;
     // Run topoligical sort
-    for (auto ES : EntryStateMap)
+    for (auto &ES : EntryStateMap)
       visit(ES.first);
   }
 };
@@ -33,6 +33,34 @@ using AddBufferFn =
 Expected<NativeObjectCache> localCache(StringRef CacheDirectoryPath,
                                        AddBufferFn AddBuffer);
 
+/// A store of native object files shared by several links, e.g. by the
+/// machines of a build farm, which backs a local cache. The objects are
+/// content-addressed by the keys computed by computeLTOCacheKey.
+///
+/// The callbacks must be thread safe.
+struct RemoteCache {
+  /// Returns the object of \p Key, or null if the store doesn't have it.
+  std::function<std::unique_ptr<MemoryBuffer>(StringRef Key)> Fetch;
+  /// Adds the object of \p Key to the store. The object may not be stored or
+  /// be evicted later, according to the policy of the store.
+  std::function<void(StringRef Key, MemoryBufferRef Object)> Store;
+};
+
+/// Create a cache with a local tier in the given cache directory, as the one
+/// of localCache, backed by \p Remote. The objects missing locally are
+/// fetched from \p Remote and added to the local tier. The objects missing
+/// in both tiers are added to both once compiled.
+///
+/// The local tier may be pruned with pruneCache, with a policy of its own.
+Expected<NativeObjectCache> tieredCache(StringRef CacheDirectoryPath,
+                                        AddBufferFn AddBuffer,
+                                        RemoteCache Remote);
+
+/// Create a remote cache which stores the objects in the given directory,
+/// e.g. one on a network file system. The objects are written atomically, and
+/// the directory may be pruned with pruneCache, as a local cache directory.
+Expected<RemoteCache> directoryRemoteCache(StringRef DirectoryPath);
+
 } // namespace lto
 } // namespace llvm
 
@@ -0,0 +1,33 @@
+//===-- InferAddressSpaces.h - specialize functions for address spaces ----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Clones the SPIR device functions taking generic pointers for the concrete
+// address spaces their callers pass, so that the accesses through them can be
+// rewritten by the InferAddressSpaces function pass running afterwards.
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SYCLLOWERIR_INFERADDRESSSPACES_H
+#define LLVM_SYCLLOWERIR_INFERADDRESSSPACES_H
+
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassManager.h"
+
+namespace llvm {
+
+class SYCLInferAddressSpacesPass
+    : public PassInfoMixin<SYCLInferAddressSpacesPass> {
+public:
+  PreservedAnalyses run(Module &M, ModuleAnalysisManager &);
+};
+
+ModulePass *createSYCLInferAddressSpacesPass();
+void initializeSYCLInferAddressSpacesLegacyPassPass(PassRegistry &);
+
+} // namespace llvm
+
+#endif // LLVM_SYCLLOWERIR_INFERADDRESSSPACES_H
@@ -0,0 +1,34 @@
+//===-- KernelArgFieldElim.h - eliminate unused kernel argument fields ----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Replaces aggregate SPIR kernel arguments passed by value, of which the kernel
+// only reads a few fields, with arguments holding the used byte ranges only.
+// The kept ranges are recorded in the "sycl_kernel_arg_fields" kernel metadata
+// for the SYCL runtime to pass the corresponding parts of the argument.
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SYCLLOWERIR_KERNELARGFIELDELIM_H
+#define LLVM_SYCLLOWERIR_KERNELARGFIELDELIM_H
+
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassManager.h"
+
+namespace llvm {
+
+class SYCLKernelArgFieldElimPass
+    : public PassInfoMixin<SYCLKernelArgFieldElimPass> {
+public:
+  PreservedAnalyses run(Module &M, ModuleAnalysisManager &);
+};
+
+ModulePass *createSYCLKernelArgFieldElimPass();
+void initializeSYCLKernelArgFieldElimLegacyPassPass(PassRegistry &);
+
+} // namespace llvm
+
+#endif // LLVM_SYCLLOWERIR_KERNELARGFIELDELIM_H
@@ -16,6 +16,7 @@
 #include "llvm/Support/Threading.h"
 
 #include <algorithm>
+#include <chrono>
 #include <condition_variable>
 #include <functional>
 #include <mutex>
@@ -57,11 +58,26 @@ public:
     std::unique_lock<std::mutex> lock(Mutex);
     Cond.wait(lock, [&] { return Count == 0; });
   }
+
+  bool isDone() const {
+    std::lock_guard<std::mutex> lock(Mutex);
+    return Count == 0;
+  }
+
+  // Waits until the count is zero or for \p Timeout, whichever comes first.
+  // Returns true if the count is zero.
+  bool syncFor(std::chrono::microseconds Timeout) const {
+    std::unique_lock<std::mutex> lock(Mutex);
+    return Cond.wait_for(lock, Timeout, [&] { return Count == 0; });
+  }
 };
 
+// Task groups may be nested, e.g. a parallel_for_each() may be called by the
+// tasks of another one. The threads waiting for the tasks of a group run the
+// pending tasks of the executor in the meantime, so nested groups run in
+// parallel and can't exhaust the threads of the executor.
 class TaskGroup {
   Latch L;
-  bool Parallel;
 
 public:
   TaskGroup();
@@ -69,7 +85,7 @@ public:
 
   void spawn(std::function<void()> f);
 
-  void sync() const { L.sync(); }
+  void sync() const;
 };
 
 const ptrdiff_t MinParallelSize = 1024;
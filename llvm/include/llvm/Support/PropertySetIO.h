@@ -187,6 +187,16 @@ public:
       "SYCL/composite specialization constants";
   static constexpr char SYCL_DEVICELIB_REQ_MASK[] = "SYCL/devicelib req mask";
   static constexpr char SYCL_KERNEL_PARAM_OPT_INFO[] = "SYCL/kernel param opt";
+  static constexpr char SYCL_KERNEL_PARAM_FIELD_OPT_INFO[] =
+      "SYCL/kernel param field opt";
+  static constexpr char SYCL_COMPRESSED_IMAGE[] = "SYCL/compressed image";
+  static constexpr char SYCL_SPEC_CONST_BUFFER_LAYOUT[] =
+      "SYCL/spec constants buffer layout";
+  static constexpr char SYCL_KERNEL_SPEC_CONST_BUFFER[] =
+      "SYCL/kernel spec constants buffer";
+  static constexpr char SYCL_MISC_PROP[] = "SYCL/misc properties";
+  static constexpr char SYCL_SUB_GROUP_SIZE_VARIANTS[] =
+      "SYCL/sub-group size variants";
 
   // Function for bulk addition of an entire property set under given category
   // (property set name).
@@ -117,6 +117,17 @@ public:
   // De-serializes a table from a file.
   static Expected<UPtrTy> read(const Twine &FileName, char ColSep = '|');
 
+  // De-serializes only the columns with given names from a stream, keeping
+  // their original order. The result is the same as of reading the whole table
+  // and calling peelColumns(ColNames), but other columns' cells are never
+  // materialized.
+  static Expected<UPtrTy> read(MemoryBuffer *Buf, ArrayRef<StringRef> ColNames,
+                               char ColSep = '|');
+
+  // De-serializes only the columns with given names from a file.
+  static Expected<UPtrTy> read(const Twine &FileName,
+                               ArrayRef<StringRef> ColNames, char ColSep = '|');
+
   const SmallVectorImpl<Row> &rows() const { return Rows; }
 
   void addRow(ArrayRef<StringRef> R) {
@@ -13,6 +13,7 @@
 #ifndef LLVM_SUPPORT_THREAD_POOL_H
 #define LLVM_SUPPORT_THREAD_POOL_H
 
+#include "llvm/ADT/FunctionExtras.h"
 #include "llvm/Config/llvm-config.h"
 #include "llvm/Support/Threading.h"
 #include "llvm/Support/thread.h"
@@ -21,22 +22,30 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <utility>
 
 namespace llvm {
 
+class ThreadPoolTaskGroup;
+
 /// A ThreadPool for asynchronous parallel execution on a defined number of
 /// threads.
 ///
-/// The pool keeps a vector of threads alive, waiting on a condition variable
-/// for some work to become available.
+/// Each thread of the pool has a queue of tasks. The tasks submitted by the
+/// tasks running on the pool go to the queue of their thread, which runs the
+/// last one submitted first, and the ones submitted by other threads go to a
+/// shared queue. The threads which run out of tasks steal the oldest ones of
+/// the other queues, and otherwise wait on a condition variable for some work
+/// to become available.
 class ThreadPool {
 public:
-  using TaskTy = std::function<void()>;
+  /// The tasks are move-only, which lets them hold the packaged task of their
+  /// future without another allocation.
+  using TaskTy = unique_function<void()>;
   using PackagedTaskTy = std::packaged_task<void()>;
 
   /// Construct a pool using the hardware strategy \p S for mapping hardware
@@ -54,45 +63,112 @@ public:
   inline std::shared_future<void> async(Function &&F, Args &&... ArgList) {
     auto Task =
         std::bind(std::forward<Function>(F), std::forward<Args>(ArgList)...);
-    return asyncImpl(std::move(Task));
+    return asyncImpl(std::move(Task), nullptr);
   }
 
   /// Asynchronous submission of a task to the pool. The returned future can be
   /// used to wait for the task to finish and is *non-blocking* on destruction.
   template <typename Function>
   inline std::shared_future<void> async(Function &&F) {
-    return asyncImpl(std::forward<Function>(F));
+    return asyncImpl(std::forward<Function>(F), nullptr);
+  }
+
+  /// Asynchronous submission of a task of \p Group to the pool, which
+  /// wait(Group) waits for.
+  template <typename Function, typename... Args>
+  inline std::shared_future<void> async(ThreadPoolTaskGroup &Group,
+                                        Function &&F, Args &&... ArgList) {
+    auto Task =
+        std::bind(std::forward<Function>(F), std::forward<Args>(ArgList)...);
+    return asyncImpl(std::move(Task), &Group);
+  }
+
+  template <typename Function>
+  inline std::shared_future<void> async(ThreadPoolTaskGroup &Group,
+                                        Function &&F) {
+    return asyncImpl(std::forward<Function>(F), &Group);
   }
 
   /// Blocking wait for all the threads to complete and the queue to be empty.
   /// It is an error to try to add new tasks while blocking on this call.
   void wait();
 
+  /// Blocking wait for the tasks of \p Group to complete. The calling thread
+  /// runs the tasks of the group which are still queued in the meantime, so
+  /// the tasks of the pool may wait for the groups they submit.
+  void wait(ThreadPoolTaskGroup &Group);
+
   unsigned getThreadCount() const { return ThreadCount; }
 
 private:
-  bool workCompletedUnlocked() { return !ActiveThreads && Tasks.empty(); }
+  struct QueuedTask {
+    TaskTy Task;
+    ThreadPoolTaskGroup *Group = nullptr;
+  };
 
-  /// Asynchronous submission of a task to the pool. The returned future can be
-  /// used to wait for the task to finish and is *non-blocking* on destruction.
-  std::shared_future<void> asyncImpl(TaskTy F);
+  struct WorkQueue {
+    std::mutex Lock;
+    std::deque<QueuedTask> Tasks;
+  };
+
+  template <typename Function>
+  std::shared_future<void> asyncImpl(Function &&F, ThreadPoolTaskGroup *Group) {
+#if LLVM_ENABLE_THREADS
+    // The packaged task holds the function in the state shared with the
+    // future, and is small enough to be stored in the task without
+    // allocating.
+    PackagedTaskTy PackagedTask(std::forward<Function>(F));
+    std::shared_future<void> Future = PackagedTask.get_future().share();
+    enqueue([PackagedTask = std::move(PackagedTask)]() mutable {
+      PackagedTask();
+    }, Group);
+#else
+    // Get a Future with launch::deferred execution using std::async, so that
+    // both wait() and the returned future can run the task.
+    std::shared_future<void> Future =
+        std::async(std::launch::deferred, std::forward<Function>(F)).share();
+    enqueue([Future]() { Future.get(); }, Group);
+#endif
+    return Future;
+  }
+
+  /// Adds \p Task to the queue of the calling thread.
+  void enqueue(TaskTy Task, ThreadPoolTaskGroup *Group);
+
+  /// Takes a task from the queues, of \p Group only if it is not null.
+  /// Returns false if there is none.
+  bool takeTask(QueuedTask &Task, ThreadPoolTaskGroup *Group);
+
+  /// Runs a task taken from the queues and signals its completion.
+  void runTask(QueuedTask &Task);
+
+  /// The index in Queues of the queue of the calling thread.
+  unsigned getQueueIndex() const;
 
   /// Threads in flight
   std::vector<llvm::thread> Threads;
 
-  /// Tasks waiting for execution in the pool.
-  std::queue<PackagedTaskTy> Tasks;
+  /// The queues of the threads of the pool, followed by the queue shared by
+  /// the other threads.
+  std::vector<std::unique_ptr<WorkQueue>> Queues;
+
+  /// The number of tasks in the queues.
+  std::atomic<unsigned> QueuedTasks{0};
+
+  /// The number of tasks submitted and not completed yet.
+  std::atomic<unsigned> UnfinishedTasks{0};
 
-  /// Locking and signaling for accessing the Tasks queue.
+  /// Incremented when a task of a group is submitted, to wake up the threads
+  /// waiting for its group, which can then run it.
+  unsigned GroupTaskSubmissions = 0;
+
+  /// Locking and signaling for waiting on the queues.
   std::mutex QueueLock;
   std::condition_variable QueueCondition;
 
   /// Signaling for job completion
   std::condition_variable CompletionCondition;
 
-  /// Keep track of the number of thread actually busy
-  unsigned ActiveThreads = 0;
-
 #if LLVM_ENABLE_THREADS // avoids warning for unused variable
   /// Signal for the destruction of the pool, asking thread to exit.
   bool EnableFlag = true;
@@ -100,6 +176,34 @@ private:
 
   unsigned ThreadCount;
 };
+
+/// A group of tasks of a ThreadPool which can be waited for on its own, e.g.
+/// from a task of the same pool.
+class ThreadPoolTaskGroup {
+public:
+  explicit ThreadPoolTaskGroup(ThreadPool &Pool) : Pool(Pool) {}
+
+  /// Blocking destructor: waits for the tasks of the group to complete.
+  ~ThreadPoolTaskGroup() { wait(); }
+
+  template <typename Function, typename... Args>
+  inline std::shared_future<void> async(Function &&F, Args &&... ArgList) {
+    return Pool.async(*this, std::forward<Function>(F),
+                      std::forward<Args>(ArgList)...);
+  }
+
+  void wait() { Pool.wait(*this); }
+
+  ThreadPool &getPool() const { return Pool; }
+
+private:
+  friend class ThreadPool;
+
+  ThreadPool &Pool;
+
+  /// The number of tasks of the group submitted and not completed yet.
+  std::atomic<unsigned> UnfinishedTasks{0};
+};
 }
 
 #endif // LLVM_SUPPORT_THREAD_POOL_H
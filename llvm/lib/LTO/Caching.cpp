@@ -27,124 +27,215 @@
 using namespace llvm;
 using namespace llvm::lto;
 
+/// Called with the contents of a new cache entry when it is committed.
+using CommitFn = std::function<void(MemoryBufferRef Object)>;
+
+// Looks up the entry Key in the cache directory. On a hit, adds its buffer
+// with AddBuffer and returns a null AddStreamFn. Otherwise, returns a stream
+// that commits the entry when it is destroyed, and then calls OnCommit, if
+// not null, and AddBuffer.
+static AddStreamFn lookUpEntry(StringRef CacheDirectoryPath,
+                               AddBufferFn AddBuffer, unsigned Task,
+                               StringRef Key, CommitFn OnCommit) {
+  // This choice of file name allows the cache to be pruned (see pruneCache()
+  // in include/llvm/Support/CachePruning.h).
+  SmallString<64> EntryPath;
+  sys::path::append(EntryPath, CacheDirectoryPath, "llvmcache-" + Key);
+  // First, see if we have a cache hit.
+  SmallString<64> ResultPath;
+  Expected<sys::fs::file_t> FDOrErr = sys::fs::openNativeFileForRead(
+      Twine(EntryPath), sys::fs::OF_UpdateAtime, &ResultPath);
+  std::error_code EC;
+  if (FDOrErr) {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> MBOrErr =
+        MemoryBuffer::getOpenFile(*FDOrErr, EntryPath,
+                                  /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+    sys::fs::closeFile(*FDOrErr);
+    if (MBOrErr) {
+      AddBuffer(Task, std::move(*MBOrErr));
+      return AddStreamFn();
+    }
+    EC = MBOrErr.getError();
+  } else {
+    EC = errorToErrorCode(FDOrErr.takeError());
+  }
+
+  // On Windows we can fail to open a cache file with a permission denied
+  // error. This generally means that another process has requested to delete
+  // the file while it is still open, but it could also mean that another
+  // process has opened the file without the sharing permissions we need.
+  // Since the file is probably being deleted we handle it in the same way as
+  // if the file did not exist at all.
+  if (EC != errc::no_such_file_or_directory && EC != errc::permission_denied)
+    report_fatal_error(Twine("Failed to open cache file ") + EntryPath +
+                       ": " + EC.message() + "\n");
+
+  // This native object stream is responsible for commiting the resulting
+  // file to the cache and calling AddBuffer to add it to the link.
+  struct CacheStream : NativeObjectStream {
+    AddBufferFn AddBuffer;
+    CommitFn OnCommit;
+    sys::fs::TempFile TempFile;
+    std::string EntryPath;
+    unsigned Task;
+
+    CacheStream(std::unique_ptr<raw_pwrite_stream> OS, AddBufferFn AddBuffer,
+                CommitFn OnCommit, sys::fs::TempFile TempFile,
+                std::string EntryPath, unsigned Task)
+        : NativeObjectStream(std::move(OS)), AddBuffer(std::move(AddBuffer)),
+          OnCommit(std::move(OnCommit)), TempFile(std::move(TempFile)),
+          EntryPath(std::move(EntryPath)), Task(Task) {}
+
+    ~CacheStream() {
+      // Make sure the stream is closed before committing it.
+      OS.reset();
+
+      // Open the file first to avoid racing with a cache pruner.
+      ErrorOr<std::unique_ptr<MemoryBuffer>> MBOrErr =
+          MemoryBuffer::getOpenFile(
+              sys::fs::convertFDToNativeFile(TempFile.FD), TempFile.TmpName,
+              /*FileSize=*/-1, /*RequiresNullTerminator=*/false);
+      if (!MBOrErr)
+        report_fatal_error(Twine("Failed to open new cache file ") +
+                           TempFile.TmpName + ": " +
+                           MBOrErr.getError().message() + "\n");
+
+      // On POSIX systems, this will atomically replace the destination if
+      // it already exists. We try to emulate this on Windows, but this may
+      // fail with a permission denied error (for example, if the destination
+      // is currently opened by another process that does not give us the
+      // sharing permissions we need). Since the existing file should be
+      // semantically equivalent to the one we are trying to write, we give
+      // AddBuffer a copy of the bytes we wrote in that case. We do this
+      // instead of just using the existing file, because the pruner might
+      // delete the file before we get a chance to use it.
+      Error E = TempFile.keep(EntryPath);
+      E = handleErrors(std::move(E), [&](const ECError &E) -> Error {
+        std::error_code EC = E.convertToErrorCode();
+        if (EC != errc::permission_denied)
+          return errorCodeToError(EC);
+
+        auto MBCopy = MemoryBuffer::getMemBufferCopy((*MBOrErr)->getBuffer(),
+                                                     EntryPath);
+        MBOrErr = std::move(MBCopy);
+
+        // FIXME: should we consume the discard error?
+        consumeError(TempFile.discard());
+
+        return Error::success();
+      });
+
+      if (E)
+        report_fatal_error(Twine("Failed to rename temporary file ") +
+                           TempFile.TmpName + " to " + EntryPath + ": " +
+                           toString(std::move(E)) + "\n");
+
+      if (OnCommit)
+        OnCommit((*MBOrErr)->getMemBufferRef());
+      AddBuffer(Task, std::move(*MBOrErr));
+    }
+  };
+
+  return [=](size_t Task) -> std::unique_ptr<NativeObjectStream> {
+    // Write to a temporary to avoid race condition
+    SmallString<64> TempFilenameModel;
+    sys::path::append(TempFilenameModel, CacheDirectoryPath, "Thin-%%%%%%.tmp.o");
+    Expected<sys::fs::TempFile> Temp = sys::fs::TempFile::create(
+        TempFilenameModel, sys::fs::owner_read | sys::fs::owner_write);
+    if (!Temp) {
+      errs() << "Error: " << toString(Temp.takeError()) << "\n";
+      report_fatal_error("ThinLTO: Can't get a temporary file");
+    }
+
+    // This CacheStream will move the temporary file into the cache when done.
+    return std::make_unique<CacheStream>(
+        std::make_unique<raw_fd_ostream>(Temp->FD, /* ShouldClose */ false),
+        AddBuffer, OnCommit, std::move(*Temp), std::string(EntryPath.str()),
+        Task);
+  };
+}
+
 Expected<NativeObjectCache> lto::localCache(StringRef CacheDirectoryPath,
                                             AddBufferFn AddBuffer) {
   if (std::error_code EC = sys::fs::create_directories(CacheDirectoryPath))
     return errorCodeToError(EC);
 
   return [=](unsigned Task, StringRef Key) -> AddStreamFn {
-    // This choice of file name allows the cache to be pruned (see pruneCache()
-    // in include/llvm/Support/CachePruning.h).
-    SmallString<64> EntryPath;
-    sys::path::append(EntryPath, CacheDirectoryPath, "llvmcache-" + Key);
-    // First, see if we have a cache hit.
-    SmallString<64> ResultPath;
-    Expected<sys::fs::file_t> FDOrErr = sys::fs::openNativeFileForRead(
-        Twine(EntryPath), sys::fs::OF_UpdateAtime, &ResultPath);
-    std::error_code EC;
-    if (FDOrErr) {
-      ErrorOr<std::unique_ptr<MemoryBuffer>> MBOrErr =
-          MemoryBuffer::getOpenFile(*FDOrErr, EntryPath,
-                                    /*FileSize=*/-1,
-                                    /*RequiresNullTerminator=*/false);
-      sys::fs::closeFile(*FDOrErr);
-      if (MBOrErr) {
-        AddBuffer(Task, std::move(*MBOrErr));
-        return AddStreamFn();
-      }
-      EC = MBOrErr.getError();
-    } else {
-      EC = errorToErrorCode(FDOrErr.takeError());
+    return lookUpEntry(CacheDirectoryPath, AddBuffer, Task, Key,
+                       /*OnCommit=*/nullptr);
+  };
+}
+
+Expected<NativeObjectCache> lto::tieredCache(StringRef CacheDirectoryPath,
+                                             AddBufferFn AddBuffer,
+                                             RemoteCache Remote) {
+  if (std::error_code EC = sys::fs::create_directories(CacheDirectoryPath))
+    return errorCodeToError(EC);
+
+  return [=](unsigned Task, StringRef Key) -> AddStreamFn {
+    AddStreamFn AddStream = lookUpEntry(CacheDirectoryPath, AddBuffer, Task,
+                                        Key, /*OnCommit=*/nullptr);
+    if (!AddStream)
+      return AddStreamFn();
+
+    // On a hit in the remote tier, the object is copied to the local one
+    // through the stream, which also adds it to the link.
+    if (std::unique_ptr<MemoryBuffer> Object = Remote.Fetch(Key)) {
+      *AddStream(Task)->OS << Object->getBuffer();
+      return AddStreamFn();
     }
 
-    // On Windows we can fail to open a cache file with a permission denied
-    // error. This generally means that another process has requested to delete
-    // the file while it is still open, but it could also mean that another
-    // process has opened the file without the sharing permissions we need.
-    // Since the file is probably being deleted we handle it in the same way as
-    // if the file did not exist at all.
-    if (EC != errc::no_such_file_or_directory && EC != errc::permission_denied)
-      report_fatal_error(Twine("Failed to open cache file ") + EntryPath +
-                         ": " + EC.message() + "\n");
-
-    // This native object stream is responsible for commiting the resulting
-    // file to the cache and calling AddBuffer to add it to the link.
-    struct CacheStream : NativeObjectStream {
-      AddBufferFn AddBuffer;
-      sys::fs::TempFile TempFile;
-      std::string EntryPath;
-      unsigned Task;
-
-      CacheStream(std::unique_ptr<raw_pwrite_stream> OS, AddBufferFn AddBuffer,
-                  sys::fs::TempFile TempFile, std::string EntryPath,
-                  unsigned Task)
-          : NativeObjectStream(std::move(OS)), AddBuffer(std::move(AddBuffer)),
-            TempFile(std::move(TempFile)), EntryPath(std::move(EntryPath)),
-            Task(Task) {}
-
-      ~CacheStream() {
-        // Make sure the stream is closed before committing it.
-        OS.reset();
-
-        // Open the file first to avoid racing with a cache pruner.
-        ErrorOr<std::unique_ptr<MemoryBuffer>> MBOrErr =
-            MemoryBuffer::getOpenFile(
-                sys::fs::convertFDToNativeFile(TempFile.FD), TempFile.TmpName,
-                /*FileSize=*/-1, /*RequiresNullTerminator=*/false);
-        if (!MBOrErr)
-          report_fatal_error(Twine("Failed to open new cache file ") +
-                             TempFile.TmpName + ": " +
-                             MBOrErr.getError().message() + "\n");
-
-        // On POSIX systems, this will atomically replace the destination if
-        // it already exists. We try to emulate this on Windows, but this may
-        // fail with a permission denied error (for example, if the destination
-        // is currently opened by another process that does not give us the
-        // sharing permissions we need). Since the existing file should be
-        // semantically equivalent to the one we are trying to write, we give
-        // AddBuffer a copy of the bytes we wrote in that case. We do this
-        // instead of just using the existing file, because the pruner might
-        // delete the file before we get a chance to use it.
-        Error E = TempFile.keep(EntryPath);
-        E = handleErrors(std::move(E), [&](const ECError &E) -> Error {
-          std::error_code EC = E.convertToErrorCode();
-          if (EC != errc::permission_denied)
-            return errorCodeToError(EC);
-
-          auto MBCopy = MemoryBuffer::getMemBufferCopy((*MBOrErr)->getBuffer(),
-                                                       EntryPath);
-          MBOrErr = std::move(MBCopy);
-
-          // FIXME: should we consume the discard error?
-          consumeError(TempFile.discard());
-
-          return Error::success();
-        });
-
-        if (E)
-          report_fatal_error(Twine("Failed to rename temporary file ") +
-                             TempFile.TmpName + " to " + EntryPath + ": " +
-                             toString(std::move(E)) + "\n");
-
-        AddBuffer(Task, std::move(*MBOrErr));
-      }
-    };
-
-    return [=](size_t Task) -> std::unique_ptr<NativeObjectStream> {
-      // Write to a temporary to avoid race condition
-      SmallString<64> TempFilenameModel;
-      sys::path::append(TempFilenameModel, CacheDirectoryPath, "Thin-%%%%%%.tmp.o");
-      Expected<sys::fs::TempFile> Temp = sys::fs::TempFile::create(
-          TempFilenameModel, sys::fs::owner_read | sys::fs::owner_write);
-      if (!Temp) {
-        errs() << "Error: " << toString(Temp.takeError()) << "\n";
-        report_fatal_error("ThinLTO: Can't get a temporary file");
-      }
-
-      // This CacheStream will move the temporary file into the cache when done.
-      return std::make_unique<CacheStream>(
-          std::make_unique<raw_fd_ostream>(Temp->FD, /* ShouldClose */ false),
-          AddBuffer, std::move(*Temp), std::string(EntryPath.str()), Task);
-    };
+    // The object is compiled and added to both tiers. The lookup is repeated
+    // for the stream to store the object remotely: another process may have
+    // added it locally in the meantime.
+    std::string KeyStr = Key.str();
+    return lookUpEntry(CacheDirectoryPath, AddBuffer, Task, Key,
+                       [Remote, KeyStr](MemoryBufferRef Object) {
+                         Remote.Store(KeyStr, Object);
+                       });
+  };
+}
+
+Expected<RemoteCache> lto::directoryRemoteCache(StringRef DirectoryPath) {
+  if (std::error_code EC = sys::fs::create_directories(DirectoryPath))
+    return errorCodeToError(EC);
+
+  std::string Directory = DirectoryPath.str();
+  RemoteCache Remote;
+  Remote.Fetch = [Directory](StringRef Key) -> std::unique_ptr<MemoryBuffer> {
+    SmallString<64> EntryPath;
+    sys::path::append(EntryPath, Directory, "llvmcache-" + Key);
+    ErrorOr<std::unique_ptr<MemoryBuffer>> MBOrErr =
+        MemoryBuffer::getFile(EntryPath, /*FileSize=*/-1,
+                              /*RequiresNullTerminator=*/false);
+    if (!MBOrErr)
+      return nullptr;
+    return std::move(*MBOrErr);
+  };
+  Remote.Store = [Directory](StringRef Key, MemoryBufferRef Object) {
+    // As in the local tier, the object is written to a temporary file which
+    // is then renamed, so that a concurrent Fetch never reads a partial file.
+    // The shared directory is only a cache, the errors are ignored.
+    SmallString<64> TempFilenameModel;
+    sys::path::append(TempFilenameModel, Directory, "Thin-%%%%%%.tmp.o");
+    Expected<sys::fs::TempFile> Temp = sys::fs::TempFile::create(
+        TempFilenameModel, sys::fs::owner_read | sys::fs::owner_write |
+                               sys::fs::group_read | sys::fs::others_read);
+    if (!Temp) {
+      consumeError(Temp.takeError());
+      return;
+    }
+    {
+      raw_fd_ostream OS(Temp->FD, /*shouldClose=*/false);
+      OS << Object.getBuffer();
+    }
+    SmallString<64> EntryPath;
+    sys::path::append(EntryPath, Directory, "llvmcache-" + Key);
+    if (Error E = Temp->keep(EntryPath)) {
+      consumeError(std::move(E));
+      consumeError(Temp->discard());
+    }
   };
+  return Remote;
 }
@@ -0,0 +1,340 @@
+//===-- InferAddressSpaces.cpp - specialize functions for address spaces --===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+// The SYCL front-end gives the generic address space to the pointers which are
+// not explicitly qualified, so a device function called with a pointer to a
+// global buffer or to a local or private variable accesses it through a
+// generic pointer. The InferAddressSpaces function pass can't see through the
+// calls, so this pass clones the callees of which a call passes pointers of a
+// known address space, with parameters in that address space:
+//
+// Old IR:
+// ======
+// define spir_func void @_Z3addPii(i32 addrspace(4)* %p, i32 %v) {
+//   store i32 %v, i32 addrspace(4)* %p
+//   ...
+//   %0 = addrspacecast i32 addrspace(1)* %buf to i32 addrspace(4)*
+//   call spir_func void @_Z3addPii(i32 addrspace(4)* %0, i32 1)
+//
+// New IR:
+// ======
+// define internal spir_func void @_Z3addPii.as1(i32 addrspace(1)* %p, i32 %v) {
+//   %p.generic = addrspacecast i32 addrspace(1)* %p to i32 addrspace(4)*
+//   store i32 %v, i32 addrspace(4)* %p.generic
+//   ...
+//   %1 = addrspacecast i32 addrspace(4)* %0 to i32 addrspace(1)*
+//   call spir_func void @_Z3addPii.as1(i32 addrspace(1)* %1, i32 1)
+//
+// The clones are processed in turn, which specializes the callees deeper in
+// the call graph. InferAddressSpaces then removes the casts to generic within
+// each function. The originals left without uses are erased.
+//===----------------------------------------------------------------------===//
+
+#include "llvm/SYCLLowerIR/InferAddressSpaces.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Operator.h"
+#include "llvm/InitializePasses.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+
+#include <map>
+#include <vector>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "sycl-infer-address-spaces"
+
+STATISTIC(NumClones, "Number of functions cloned for concrete address spaces");
+STATISTIC(NumCallsSpecialized,
+          "Number of calls passing pointers in concrete address spaces");
+
+namespace {
+
+// The generic address space of the SPIR targets.
+constexpr unsigned GenericAS = 4;
+// Stands for the values of which the address space is not constrained yet,
+// such as a phi node reached again through its incoming values.
+constexpr unsigned UnknownAS = ~0u;
+// Bounds the code growth for the functions called on many address spaces.
+constexpr unsigned MaxClonesPerFunction = 8;
+// Bounds the search for the address space of a pointer.
+constexpr unsigned MaxSearchDepth = 8;
+
+unsigned joinAddressSpaces(unsigned AS1, unsigned AS2) {
+  if (AS1 == UnknownAS)
+    return AS2;
+  if (AS2 == UnknownAS)
+    return AS1;
+  return AS1 == AS2 ? AS1 : GenericAS;
+}
+
+/// \returns the address space of the object V points to, GenericAS if it is
+/// not known.
+unsigned getPointeeAddressSpace(const Value *V,
+                                SmallPtrSetImpl<const Value *> &Visited,
+                                unsigned Depth = 0) {
+  unsigned AS = V->getType()->getPointerAddressSpace();
+  if (AS != GenericAS)
+    return AS;
+  if (Depth == MaxSearchDepth)
+    return GenericAS;
+  if (!Visited.insert(V).second)
+    return UnknownAS;
+  if (const auto *Op = dyn_cast<Operator>(V)) {
+    switch (Op->getOpcode()) {
+    case Instruction::AddrSpaceCast:
+    case Instruction::BitCast:
+    case Instruction::GetElementPtr:
+      return getPointeeAddressSpace(Op->getOperand(0), Visited, Depth + 1);
+    case Instruction::Select:
+      return joinAddressSpaces(
+          getPointeeAddressSpace(Op->getOperand(1), Visited, Depth + 1),
+          getPointeeAddressSpace(Op->getOperand(2), Visited, Depth + 1));
+    case Instruction::PHI: {
+      unsigned Joined = UnknownAS;
+      for (const Value *Incoming : cast<PHINode>(Op)->incoming_values()) {
+        Joined = joinAddressSpaces(
+            Joined, getPointeeAddressSpace(Incoming, Visited, Depth + 1));
+        if (Joined == GenericAS)
+          break;
+      }
+      return Joined;
+    }
+    default:
+      break;
+    }
+  }
+  return GenericAS;
+}
+
+/// \returns true if F is only called recursively, if at all.
+bool isOnlyUsedByItself(const Function &F) {
+  return all_of(F.users(), [&F](const User *U) {
+    const auto *I = dyn_cast<Instruction>(U);
+    return I && I->getFunction() == &F;
+  });
+}
+
+bool isGenericPointer(const Type *Ty) {
+  return Ty->isPointerTy() && Ty->getPointerAddressSpace() == GenericAS;
+}
+
+class AddressSpaceSpecializer {
+public:
+  explicit AddressSpaceSpecializer(Module &M) : M(M) {}
+
+  bool run() {
+    SmallVector<Function *, 32> Worklist;
+    for (Function &F : M)
+      if (!F.isDeclaration())
+        Worklist.push_back(&F);
+    bool Changed = false;
+    while (!Worklist.empty()) {
+      Function *F = Worklist.pop_back_val();
+      Changed |= specializeCalls(*F, Worklist);
+    }
+    eraseUnusedOriginals();
+    return Changed;
+  }
+
+private:
+  /// The address space to pass for each parameter, GenericAS for the ones
+  /// kept as they are.
+  using AddressSpaces = std::vector<unsigned>;
+
+  bool specializeCalls(Function &F, SmallVectorImpl<Function *> &Worklist) {
+    SmallVector<CallBase *, 16> Calls;
+    for (Instruction &I : instructions(F))
+      if (auto *CB = dyn_cast<CallBase>(&I)) {
+        Function *Callee = CB->getCalledFunction();
+        if (Callee && !Callee->isDeclaration() && !Callee->isVarArg() &&
+            !Callee->isIntrinsic() &&
+            CB->getFunctionType() == Callee->getFunctionType() &&
+            any_of(Callee->getFunctionType()->params(), isGenericPointer))
+          Calls.push_back(CB);
+      }
+
+    bool Changed = false;
+    for (CallBase *CB : Calls) {
+      Function *Callee = CB->getCalledFunction();
+      AddressSpaces Spaces(CB->arg_size(), GenericAS);
+      bool AnyKnown = false;
+      for (unsigned I = 0; I < CB->arg_size(); ++I) {
+        Value *Arg = CB->getArgOperand(I);
+        if (!isGenericPointer(Arg->getType()))
+          continue;
+        SmallPtrSet<const Value *, 8> Visited;
+        unsigned AS = getPointeeAddressSpace(Arg, Visited);
+        if (AS != UnknownAS && AS != GenericAS) {
+          Spaces[I] = AS;
+          AnyKnown = true;
+        }
+      }
+      if (!AnyKnown)
+        continue;
+
+      Function *Clone = getOrCreateClone(*Callee, Spaces, Worklist);
+      if (!Clone)
+        continue;
+      IRBuilder<> B(CB);
+      for (unsigned I = 0; I < CB->arg_size(); ++I)
+        if (Spaces[I] != GenericAS)
+          CB->setArgOperand(I, B.CreateAddrSpaceCast(
+                                   CB->getArgOperand(I),
+                                   Clone->getArg(I)->getType()));
+      CB->setCalledFunction(Clone);
+      NumCallsSpecialized++;
+      Changed = true;
+    }
+    return Changed;
+  }
+
+  Function *getOrCreateClone(Function &F, const AddressSpaces &Spaces,
+                             SmallVectorImpl<Function *> &Worklist) {
+    Function *&Clone = Clones[{&F, Spaces}];
+    if (Clone)
+      return Clone;
+    // The clones of a clone count against the function first cloned.
+    Function *Original = Originals.lookup(&F);
+    if (!Original)
+      Original = &F;
+    unsigned &Count = NumClonesOf[Original];
+    if (Count == MaxClonesPerFunction)
+      return nullptr;
+    if (Count++ == 0)
+      Candidates.push_back(Original);
+    Clone = cloneForAddressSpaces(F, Spaces);
+    Originals[Clone] = Original;
+    Candidates.push_back(Clone);
+    Worklist.push_back(Clone);
+    NumClones++;
+    return Clone;
+  }
+
+  Function *cloneForAddressSpaces(Function &F, const AddressSpaces &Spaces) {
+    FunctionType *FTy = F.getFunctionType();
+    SmallVector<Type *, 8> Params;
+    std::string Suffix;
+    raw_string_ostream SuffixOS(Suffix);
+    SuffixOS << ".as";
+    bool First = true;
+    for (unsigned I = 0; I < FTy->getNumParams(); ++I) {
+      Type *Ty = FTy->getParamType(I);
+      if (isGenericPointer(Ty)) {
+        SuffixOS << (First ? "" : "_");
+        First = false;
+        if (Spaces[I] == GenericAS) {
+          SuffixOS << "g";
+        } else {
+          SuffixOS << Spaces[I];
+          Ty = cast<PointerType>(Ty)->getElementType()->getPointerTo(
+              Spaces[I]);
+        }
+      }
+      Params.push_back(Ty);
+    }
+    auto *NFTy = FunctionType::get(FTy->getReturnType(), Params, false);
+    Function *NF =
+        Function::Create(NFTy, GlobalValue::InternalLinkage,
+                         F.getAddressSpace(), F.getName() + SuffixOS.str(), &M);
+
+    // The uses of a specialized parameter go through a cast to generic, which
+    // InferAddressSpaces folds into the accesses.
+    ValueToValueMapTy VMap;
+    SmallVector<Instruction *, 4> Casts;
+    for (Argument &Arg : F.args()) {
+      Argument *NewArg = NF->getArg(Arg.getArgNo());
+      NewArg->setName(Arg.getName());
+      if (Spaces[Arg.getArgNo()] == GenericAS) {
+        VMap[&Arg] = NewArg;
+        continue;
+      }
+      auto *Cast = new AddrSpaceCastInst(NewArg, Arg.getType(),
+                                         Arg.getName() + ".generic");
+      VMap[&Arg] = Cast;
+      Casts.push_back(Cast);
+    }
+    SmallVector<ReturnInst *, 8> Returns;
+    CloneFunctionInto(NF, &F, VMap, F.getSubprogram() != nullptr, Returns);
+    NF->setLinkage(GlobalValue::InternalLinkage);
+    NF->setVisibility(GlobalValue::DefaultVisibility);
+    NF->setComdat(nullptr);
+    Instruction *InsertPt = &*NF->getEntryBlock().getFirstInsertionPt();
+    for (Instruction *Cast : Casts)
+      Cast->insertBefore(InsertPt);
+    LLVM_DEBUG(dbgs() << "Cloned " << F.getName() << " as " << NF->getName()
+                      << "\n");
+    return NF;
+  }
+
+  void eraseUnusedOriginals() {
+    bool Erased = true;
+    while (Erased) {
+      Erased = false;
+      for (Function *&F : Candidates)
+        if (F && F->isDiscardableIfUnused() && isOnlyUsedByItself(*F)) {
+          F->dropAllReferences();
+          F->eraseFromParent();
+          F = nullptr;
+          Erased = true;
+        }
+    }
+  }
+
+  Module &M;
+  std::map<std::pair<Function *, AddressSpaces>, Function *> Clones;
+  /// The function first cloned for each clone.
+  DenseMap<Function *, Function *> Originals;
+  /// The number of clones made from each original function.
+  DenseMap<Function *, unsigned> NumClonesOf;
+  /// The cloned functions and the clones, erased if they end up unused.
+  SmallVector<Function *, 16> Candidates;
+};
+
+bool inferModuleAddressSpaces(Module &M) {
+  Triple TT(M.getTargetTriple());
+  if (!TT.isSPIR() || !TT.isSYCLDeviceEnvironment())
+    return false;
+  return AddressSpaceSpecializer(M).run();
+}
+
+class SYCLInferAddressSpacesLegacyPass : public ModulePass {
+public:
+  static char ID;
+  SYCLInferAddressSpacesLegacyPass() : ModulePass(ID) {
+    initializeSYCLInferAddressSpacesLegacyPassPass(
+        *PassRegistry::getPassRegistry());
+  }
+
+  bool runOnModule(Module &M) override { return inferModuleAddressSpaces(M); }
+};
+} // namespace
+
+char SYCLInferAddressSpacesLegacyPass::ID = 0;
+INITIALIZE_PASS(SYCLInferAddressSpacesLegacyPass, "sycl-infer-address-spaces",
+                "Specialize SYCL device functions for the address spaces of "
+                "their pointer arguments",
+                false, false)
+
+ModulePass *llvm::createSYCLInferAddressSpacesPass() {
+  return new SYCLInferAddressSpacesLegacyPass();
+}
+
+PreservedAnalyses SYCLInferAddressSpacesPass::run(Module &M,
+                                                  ModuleAnalysisManager &) {
+  return inferModuleAddressSpaces(M) ? PreservedAnalyses::none()
+                                     : PreservedAnalyses::all();
+}
@@ -0,0 +1,357 @@
+//===-- KernelArgFieldElim.cpp - eliminate unused kernel argument fields --===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+// A kernel argument capturing a struct is passed by value as a whole, even if
+// the kernel reads only a few of its fields. This pass replaces such an
+// argument, if all its uses are loads at constant offsets, with one argument
+// per used byte range:
+//
+// Old IR:
+// ======
+// define spir_kernel void @K(%struct.S* byval(%struct.S) align 8 %_arg_s) {
+//   %a = getelementptr inbounds %struct.S, %struct.S* %_arg_s, i64 0, i32 0
+//   %0 = load i32, i32* %a, align 8
+//   %c = getelementptr inbounds %struct.S, %struct.S* %_arg_s, i64 0, i32 5
+//   %1 = load i64, i64* %c, align 8
+//
+// New IR:
+// ======
+// define spir_kernel void @K({ [4 x i8] }* byval({ [4 x i8] }) align 8
+//                                %_arg_s.range0,
+//                            { [8 x i8] }* byval({ [8 x i8] }) align 8
+//                                %_arg_s.range1) !sycl_kernel_arg_fields !0 {
+//   %2 = getelementptr inbounds { [4 x i8] }, { [4 x i8] }* %_arg_s.range0,
+//            i64 0, i32 0, i64 0
+//   %3 = bitcast i8* %2 to i32*
+//   %0 = load i32, i32* %3, align 8
+//   ...
+// !0 = !{!1}
+// !1 = !{i32 0, i32 0, i32 4, i32 40, i32 8}
+//
+// Each node of the metadata describes one replaced argument: its index as
+// emitted by the front-end followed by the offset and the size of each range.
+// The runtime passes the corresponding bytes of the argument for each range.
+//===----------------------------------------------------------------------===//
+
+#include "llvm/SYCLLowerIR/KernelArgFieldElim.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/InitializePasses.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/Debug.h"
+
+#include <algorithm>
+#include <tuple>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "sycl-kernel-arg-field-elim"
+
+STATISTIC(NumArgsReduced,
+          "Number of kernel arguments reduced to their used byte ranges");
+
+namespace {
+
+// Must match the one produced by DeadArgumentElimination
+constexpr char OmitArgsMD[] = "spir_kernel_omit_args";
+// Must match the one read by sycl-post-link
+constexpr char ArgFieldsMD[] = "sycl_kernel_arg_fields";
+
+// Used bytes at most this far apart are kept in the same range, passing a few
+// unused bytes is cheaper than setting another argument.
+constexpr uint64_t MaxGapInRange = 8;
+// Each range is set with a separate call at kernel launch. If there are more
+// ranges, a single one spanning all the used bytes is kept instead.
+constexpr size_t MaxRangesPerArg = 4;
+
+struct ByteRange {
+  uint64_t Start;
+  uint64_t End;
+};
+
+// A load of the pointee of an argument at a constant offset.
+struct ArgLoad {
+  LoadInst *Load;
+  uint64_t Offset;
+};
+
+// Collects the loads of the pointee of Arg and the pointers derived from Arg
+// they use. Returns false if the pointee is accessed in some other way.
+bool collectArgLoads(Argument &Arg, uint64_t ArgSize, const DataLayout &DL,
+                     SmallVectorImpl<ArgLoad> &Loads,
+                     SmallVectorImpl<Instruction *> &Derived) {
+  SmallVector<std::pair<Value *, uint64_t>, 8> Worklist{{&Arg, 0}};
+  while (!Worklist.empty()) {
+    Value *Ptr;
+    uint64_t Offset;
+    std::tie(Ptr, Offset) = Worklist.pop_back_val();
+    for (User *U : Ptr->users()) {
+      if (auto *LI = dyn_cast<LoadInst>(U)) {
+        if (!LI->isSimple() ||
+            Offset + DL.getTypeStoreSize(LI->getType()) > ArgSize)
+          return false;
+        Loads.push_back({LI, Offset});
+        continue;
+      }
+      if (auto *GEP = dyn_cast<GetElementPtrInst>(U)) {
+        APInt GEPOffset(DL.getIndexTypeSizeInBits(GEP->getType()), 0);
+        if (GEP->getPointerOperand() != Ptr ||
+            !GEP->accumulateConstantOffset(DL, GEPOffset) ||
+            GEPOffset.isNegative())
+          return false;
+        Worklist.push_back({GEP, Offset + GEPOffset.getZExtValue()});
+        Derived.push_back(GEP);
+        continue;
+      }
+      if (isa<BitCastInst>(U) || isa<AddrSpaceCastInst>(U)) {
+        auto *Cast = cast<Instruction>(U);
+        Worklist.push_back({Cast, Offset});
+        Derived.push_back(Cast);
+        continue;
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+// Computes the byte ranges to keep for the given loads, sorted by offset.
+SmallVector<ByteRange, 4> computeRanges(SmallVectorImpl<ArgLoad> &Loads,
+                                        const DataLayout &DL) {
+  std::sort(Loads.begin(), Loads.end(),
+            [](const ArgLoad &A, const ArgLoad &B) {
+              return A.Offset < B.Offset;
+            });
+  SmallVector<ByteRange, 4> Ranges;
+  for (const ArgLoad &L : Loads) {
+    uint64_t End = L.Offset + DL.getTypeStoreSize(L.Load->getType());
+    if (!Ranges.empty() && L.Offset <= Ranges.back().End + MaxGapInRange)
+      Ranges.back().End = std::max(Ranges.back().End, End);
+    else
+      Ranges.push_back({L.Offset, End});
+  }
+  if (Ranges.size() > MaxRangesPerArg) {
+    ByteRange Span{Ranges.front().Start, Ranges.back().End};
+    for (const ByteRange &R : Ranges)
+      Span.End = std::max(Span.End, R.End);
+    Ranges.assign(1, Span);
+  }
+  return Ranges;
+}
+
+// Everything needed to replace one argument.
+struct ArgReduction {
+  unsigned ArgNo;
+  Align ArgAlign;
+  SmallVector<ArgLoad, 8> Loads;
+  SmallVector<Instruction *, 8> Derived;
+  SmallVector<ByteRange, 4> Ranges;
+  // Index of the first replacement argument in the new function
+  unsigned FirstNewArgNo = 0;
+};
+
+Type *getRangeType(LLVMContext &Ctx, const ByteRange &R) {
+  return StructType::get(
+      Ctx, {ArrayType::get(Type::getInt8Ty(Ctx), R.End - R.Start)});
+}
+
+bool reduceKernelArgs(Function &F) {
+  const DataLayout &DL = F.getParent()->getDataLayout();
+  LLVMContext &Ctx = F.getContext();
+
+  SmallVector<ArgReduction, 4> Reductions;
+  for (Argument &Arg : F.args()) {
+    if (!Arg.hasByValAttr())
+      continue;
+    Type *ByValTy = Arg.getParamByValType();
+    if (!ByValTy || !ByValTy->isAggregateType() || !ByValTy->isSized())
+      continue;
+    uint64_t ArgSize = DL.getTypeStoreSize(ByValTy);
+    ArgReduction Red;
+    Red.ArgNo = Arg.getArgNo();
+    Red.ArgAlign = Arg.getParamAlign().getValueOr(DL.getABITypeAlign(ByValTy));
+    // An argument without loads is left to DeadArgumentElimination.
+    if (!collectArgLoads(Arg, ArgSize, DL, Red.Loads, Red.Derived) ||
+        Red.Loads.empty())
+      continue;
+    Red.Ranges = computeRanges(Red.Loads, DL);
+    uint64_t KeptSize = 0;
+    for (const ByteRange &R : Red.Ranges)
+      KeptSize += R.End - R.Start;
+    if (KeptSize >= ArgSize)
+      continue;
+    Reductions.push_back(std::move(Red));
+  }
+  if (Reductions.empty())
+    return false;
+
+  // Build the new argument list.
+  const AttributeList &PAL = F.getAttributes();
+  SmallVector<Type *, 16> Params;
+  SmallVector<AttributeSet, 16> ArgAttrs;
+  auto *RedIt = Reductions.begin();
+  for (Argument &Arg : F.args()) {
+    if (RedIt == Reductions.end() || RedIt->ArgNo != Arg.getArgNo()) {
+      Params.push_back(Arg.getType());
+      ArgAttrs.push_back(PAL.getParamAttributes(Arg.getArgNo()));
+      continue;
+    }
+    RedIt->FirstNewArgNo = Params.size();
+    for (const ByteRange &R : RedIt->Ranges) {
+      Type *RangeTy = getRangeType(Ctx, R);
+      Params.push_back(
+          PointerType::get(RangeTy, Arg.getType()->getPointerAddressSpace()));
+      AttrBuilder B;
+      B.addByValAttr(RangeTy);
+      B.addAlignmentAttr(commonAlignment(RedIt->ArgAlign, R.Start));
+      ArgAttrs.push_back(AttributeSet::get(Ctx, B));
+    }
+    ++RedIt;
+  }
+
+  FunctionType *NFTy =
+      FunctionType::get(F.getReturnType(), Params, F.isVarArg());
+  Function *NF = Function::Create(NFTy, F.getLinkage(), F.getAddressSpace());
+  NF->copyAttributesFrom(&F);
+  NF->setComdat(F.getComdat());
+  NF->setAttributes(AttributeList::get(Ctx, PAL.getFnAttributes(),
+                                       PAL.getRetAttributes(), ArgAttrs));
+  F.getParent()->getFunctionList().insert(F.getIterator(), NF);
+  NF->takeName(&F);
+  SmallVector<std::pair<unsigned, MDNode *>, 8> MDs;
+  F.getAllMetadata(MDs);
+  for (const auto &MD : MDs)
+    NF->addMetadata(MD.first, *MD.second);
+  NF->getBasicBlockList().splice(NF->begin(), F.getBasicBlockList());
+
+  // Front-end indices of the arguments, DeadArgumentElimination may have
+  // already removed some.
+  SmallVector<unsigned, 16> FEArgNos;
+  if (MDNode *MD = F.getMetadata(OmitArgsMD)) {
+    for (unsigned I = 0; I < MD->getNumOperands(); ++I) {
+      const auto *Omit = cast<ConstantAsMetadata>(MD->getOperand(I));
+      if (cast<ConstantInt>(Omit->getValue())->isZero())
+        FEArgNos.push_back(I);
+    }
+  } else {
+    for (unsigned I = 0; I < F.arg_size(); ++I)
+      FEArgNos.push_back(I);
+  }
+  assert(FEArgNos.size() == F.arg_size() && "inconsistent omitted args");
+
+  auto getI32MD = [&Ctx](uint64_t Val) -> Metadata * {
+    return ConstantAsMetadata::get(
+        ConstantInt::get(Type::getInt32Ty(Ctx), Val));
+  };
+  SmallVector<Metadata *, 4> FieldsMDs;
+  RedIt = Reductions.begin();
+  for (Argument &Arg : F.args()) {
+    if (RedIt == Reductions.end() || RedIt->ArgNo != Arg.getArgNo()) {
+      unsigned NewArgNo = Arg.getArgNo();
+      for (auto *It = Reductions.begin(); It != RedIt; ++It)
+        NewArgNo += It->Ranges.size() - 1;
+      Arg.replaceAllUsesWith(NF->getArg(NewArgNo));
+      NF->getArg(NewArgNo)->takeName(&Arg);
+      continue;
+    }
+
+    ArgReduction &Red = *RedIt++;
+    SmallVector<Metadata *, 8> RangeMDs{getI32MD(FEArgNos[Red.ArgNo])};
+    for (unsigned I = 0; I < Red.Ranges.size(); ++I) {
+      const ByteRange &R = Red.Ranges[I];
+      NF->getArg(Red.FirstNewArgNo + I)
+          ->setName(Arg.getName() + ".range" + Twine(I));
+      RangeMDs.push_back(getI32MD(R.Start));
+      RangeMDs.push_back(getI32MD(R.End - R.Start));
+    }
+    FieldsMDs.push_back(MDNode::get(Ctx, RangeMDs));
+
+    // Point every load into the range containing it.
+    for (const ArgLoad &L : Red.Loads) {
+      unsigned RangeNo = 0;
+      while (L.Offset >= Red.Ranges[RangeNo].End)
+        ++RangeNo;
+      const ByteRange &R = Red.Ranges[RangeNo];
+      Argument *NewArg = NF->getArg(Red.FirstNewArgNo + RangeNo);
+      IRBuilder<> B(L.Load);
+      Type *RangeTy = NewArg->getType()->getPointerElementType();
+      Value *Ptr = B.CreateConstInBoundsGEP2_64(RangeTy, NewArg, 0, 0);
+      Ptr = B.CreateConstInBoundsGEP2_64(RangeTy->getStructElementType(0), Ptr,
+                                         0, L.Offset - R.Start);
+      Ptr = B.CreatePointerBitCastOrAddrSpaceCast(
+          Ptr, L.Load->getPointerOperandType());
+      L.Load->setOperand(LoadInst::getPointerOperandIndex(), Ptr);
+      Align RangeAlign = commonAlignment(Red.ArgAlign, R.Start);
+      L.Load->setAlignment(std::min(
+          L.Load->getAlign(), commonAlignment(RangeAlign, L.Offset - R.Start)));
+    }
+    // The derived pointers are collected in def-use order, erase the users
+    // first.
+    for (Instruction *I : reverse(Red.Derived)) {
+      assert(I->use_empty() && "pointer derived from the argument still used");
+      I->eraseFromParent();
+    }
+    NumArgsReduced++;
+  }
+  NF->setMetadata(ArgFieldsMD, MDNode::get(Ctx, FieldsMDs));
+
+  F.eraseFromParent();
+  return true;
+}
+
+bool reduceModuleKernelArgs(Module &M) {
+  if (!StringRef(M.getTargetTriple()).contains("sycldevice"))
+    return false;
+  SmallVector<Function *, 16> Kernels;
+  for (Function &F : M)
+    // A kernel with uses can't change its signature.
+    if (F.getCallingConv() == CallingConv::SPIR_KERNEL && !F.isDeclaration() &&
+        F.use_empty())
+      Kernels.push_back(&F);
+
+  bool Changed = false;
+  for (Function *F : Kernels) {
+    LLVM_DEBUG(dbgs() << "Inspecting kernel arguments of " << F->getName()
+                      << "\n");
+    Changed |= reduceKernelArgs(*F);
+  }
+  return Changed;
+}
+
+class SYCLKernelArgFieldElimLegacyPass : public ModulePass {
+public:
+  static char ID;
+  SYCLKernelArgFieldElimLegacyPass() : ModulePass(ID) {
+    initializeSYCLKernelArgFieldElimLegacyPassPass(
+        *PassRegistry::getPassRegistry());
+  }
+
+  bool runOnModule(Module &M) override { return reduceModuleKernelArgs(M); }
+};
+
+} // namespace
+
+char SYCLKernelArgFieldElimLegacyPass::ID = 0;
+INITIALIZE_PASS(SYCLKernelArgFieldElimLegacyPass, "sycl-kernel-arg-field-elim",
+                "Eliminate unused fields of SYCL kernel arguments", false,
+                false)
+
+ModulePass *llvm::createSYCLKernelArgFieldElimPass() {
+  return new SYCLKernelArgFieldElimLegacyPass();
+}
+
+PreservedAnalyses SYCLKernelArgFieldElimPass::run(Module &M,
+                                                  ModuleAnalysisManager &) {
+  return reduceModuleKernelArgs(M) ? PreservedAnalyses::none()
+                                   : PreservedAnalyses::all();
+}
@@ -373,6 +373,10 @@ public:
         {"pow", {"pow", {a(0), a(1)}}},
         {"div_ieee", {"ieee.div", {a(0), a(1)}}},
         {"dp4a", {"dp4a", {a(0), a(1), a(2)}}},
+        // src0, src1, src2, src1 precision, src2 precision, systolic depth,
+        // repeat count, result sign, accumulator sign
+        {"dpas",
+         {"dpas2", {a(0), a(1), a(2), t(0), t(1), t(2), t(3), t(4), t(5)}}},
         {"any", {"any", {ai1(0)}}},
         {"all", {"all", {ai1(0)}}},
     };
@@ -1046,6 +1050,14 @@ static void translateESIMDIntrinsicCall(CallInst &CI) {
 
   auto PrefLen = StringRef(ESIMD_INTRIN_PREF1).size();
   StringRef BaseName(BaseNameV.begin() + PrefLen, BaseNameV.size() - PrefLen);
+
+  // Prefetches are hints only. The GenX SVM messages available here have
+  // neither a result-less load nor cache controls to express them, so they
+  // are dropped rather than turned into loads the backend would delete anyway.
+  if (BaseName == "flat_prefetch" || BaseName == "flat_block_prefetch") {
+    CI.eraseFromParent();
+    return;
+  }
   const auto &Desc = getIntrinDesc(BaseName);
   if (!Desc.isValid()) // TODO remove this once all intrinsics are supported
     return;
@@ -62,8 +62,36 @@
 //        %"class._ZTSN2cm3gen4simdIiLi16EEE.cm::gen::simd" *) to %
 //        "class._ZTSN2cm3gen4simdIiLi16EEE.cm::gen::simd" addrspace(4) *),
 //        i64 0, i32 0))
+//
+//
+// Passing of read-only simd arguments by value:
+//
+// A simd argument of an internal function that is passed byval and only read
+// by value in the callee is passed as the vector itself instead of a pointer
+// to it. The caller loads the vector before the call and the callee uses the
+// argument in place of its loads, so the vector can stay in registers across
+// the call instead of being spilled to memory for it. The total size of the
+// vectors passed this way is limited per function by
+// -esimd-vec-arg-reg-budget, smaller vectors being passed by value first.
+//
+// Old IR:
+// ======
+//
+// define internal spir_func void @bar(
+//      %"class._ZTSN2cm3gen4simdIiLi16EEE.cm::gen::simd"* byval %0) {
+//   %1 = getelementptr %"class._ZTSN2cm3gen4simdIiLi16EEE.cm::gen::simd",
+//      %"class._ZTSN2cm3gen4simdIiLi16EEE.cm::gen::simd"* %0, i64 0, i32 0
+//   %2 = load <16 x i32>, <16 x i32>* %1
+//
+// New IR:
+// ======
+//
+// define internal spir_func void @bar(<16 x i32> %0) {
+//   <uses of %2 use %0>
 //===----------------------------------------------------------------------===//
 
+#include "llvm/GenXIntrinsics/GenXIntrinsics.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
 #include "llvm/Transforms/Utils/Cloning.h"
 
@@ -71,6 +99,11 @@ using namespace llvm;
 
 #define DEBUG_TYPE "ESIMDLowerVecArg"
 
+static cl::opt<unsigned> VecArgRegBudget(
+    "esimd-vec-arg-reg-budget", cl::init(1024), cl::Hidden,
+    cl::desc("Max total size in bytes of the simd arguments of a function "
+             "passed by value instead of by pointer"));
+
 namespace llvm {
 
 // Forward declarations
@@ -88,6 +121,9 @@ private:
 
   Function *rewriteFunc(Function &F);
   Type *getSimdArgPtrTyOrNull(Value *arg);
+  bool collectVecLoads(Argument *Arg, Type *VecTy,
+                       SmallVectorImpl<Instruction *> &Loads,
+                       SmallVectorImpl<Instruction *> &Addrs);
   void fixGlobals(Module &M);
   void removeOldGlobals();
 };
@@ -137,6 +173,50 @@ Type *ESIMDLowerVecArgPass::getSimdArgPtrTyOrNull(Value *arg) {
                           ArgType->getPointerAddressSpace());
 }
 
+// Return true if the simd pointed to by Arg is only read as a whole vector of
+// type VecTy, collecting the loads (plain or genx.vload) into Loads and the
+// address computations leading to them into Addrs, in def-before-use order.
+bool ESIMDLowerVecArgPass::collectVecLoads(
+    Argument *Arg, Type *VecTy, SmallVectorImpl<Instruction *> &Loads,
+    SmallVectorImpl<Instruction *> &Addrs) {
+  SmallVector<Value *, 8> Worklist{Arg};
+  while (!Worklist.empty()) {
+    Value *V = Worklist.pop_back_val();
+    for (User *U : V->users()) {
+      auto *I = dyn_cast<Instruction>(U);
+      if (!I)
+        return false;
+      if (isa<BitCastInst>(I) || isa<AddrSpaceCastInst>(I)) {
+        Addrs.push_back(I);
+        Worklist.push_back(I);
+        continue;
+      }
+      if (auto *GEP = dyn_cast<GetElementPtrInst>(I)) {
+        if (GEP->getPointerOperand() != V || !GEP->hasAllZeroIndices())
+          return false;
+        Addrs.push_back(I);
+        Worklist.push_back(I);
+        continue;
+      }
+      if (auto *LI = dyn_cast<LoadInst>(I)) {
+        if (LI->isVolatile() || LI->getType() != VecTy)
+          return false;
+        Loads.push_back(I);
+        continue;
+      }
+      auto *CI = dyn_cast<CallInst>(I);
+      Function *Callee = CI ? CI->getCalledFunction() : nullptr;
+      if (!Callee ||
+          GenXIntrinsic::getGenXIntrinsicID(Callee) !=
+              GenXIntrinsic::genx_vload ||
+          CI->getType() != VecTy)
+        return false;
+      Loads.push_back(I);
+    }
+  }
+  return true;
+}
+
 // F may have multiple arguments of type simd*. This
 // function updates all parameters along with call
 // call sites of F.
@@ -145,10 +225,55 @@ Function *ESIMDLowerVecArgPass::rewriteFunc(Function &F) {
   Type *RetTy = FTy->getReturnType();
   SmallVector<Type *, 8> ArgTys;
 
+  // The arguments can only be passed by value if all the callers are known.
+  bool AllUsesAreCalls =
+      F.hasLocalLinkage() && !F.isVarArg() &&
+      F.getCallingConv() != CallingConv::SPIR_KERNEL &&
+      all_of(F.uses(), [](const Use &U) {
+        auto *Call = dyn_cast<CallInst>(U.getUser());
+        return Call && Call->isCallee(&U);
+      });
+
+  // Pick the byval simd arguments only read by value, smaller ones first,
+  // within the register budget.
+  DenseMap<Argument *, SmallVector<Instruction *, 4>> ArgLoads;
+  SmallVector<Instruction *, 8> DeadAddrs;
+  if (AllUsesAreCalls) {
+    const DataLayout &DL = F.getParent()->getDataLayout();
+    SmallVector<std::pair<uint64_t, Argument *>, 8> Candidates;
+    for (Argument &Arg : F.args()) {
+      Type *NewTy = getSimdArgPtrTyOrNull(&Arg);
+      if (NewTy && Arg.hasByValAttr())
+        Candidates.emplace_back(
+            DL.getTypeAllocSize(NewTy->getPointerElementType()), &Arg);
+    }
+    llvm::stable_sort(Candidates, [](const std::pair<uint64_t, Argument *> &A,
+                                     const std::pair<uint64_t, Argument *> &B) {
+      return A.first < B.first;
+    });
+    uint64_t Budget = VecArgRegBudget;
+    for (auto &Candidate : Candidates) {
+      if (Candidate.first > Budget)
+        break;
+      Argument *Arg = Candidate.second;
+      Type *VecTy = getSimdArgPtrTyOrNull(Arg)->getPointerElementType();
+      SmallVector<Instruction *, 4> Loads;
+      SmallVector<Instruction *, 4> Addrs;
+      if (!collectVecLoads(Arg, VecTy, Loads, Addrs))
+        continue;
+      ArgLoads[Arg] = std::move(Loads);
+      DeadAddrs.append(Addrs.begin(), Addrs.end());
+      Budget -= Candidate.first;
+    }
+  }
+
   for (unsigned int i = 0; i != F.arg_size(); i++) {
     auto Arg = F.getArg(i);
     Type *NewTy = getSimdArgPtrTyOrNull(Arg);
-    if (NewTy) {
+    if (NewTy && ArgLoads.count(Arg)) {
+      // Pass the vector itself
+      ArgTys.push_back(NewTy->getPointerElementType());
+    } else if (NewTy) {
       // Copy over byval type for simd* type
       ArgTys.push_back(NewTy);
     } else {
@@ -169,6 +294,12 @@ Function *ESIMDLowerVecArgPass::rewriteFunc(Function &F) {
   for (unsigned int I = 0; I != F.arg_size(); I++) {
     auto Arg = F.getArg(I);
     Type *newTy = getSimdArgPtrTyOrNull(Arg);
+    if (ArgLoads.count(Arg)) {
+      // The loads of the argument are replaced with it after cloning, so
+      // the addresses computed from it are left without uses.
+      VMap.insert(std::make_pair(Arg, UndefValue::get(Arg->getType())));
+      continue;
+    }
     if (newTy) {
       // bitcast vector* -> simd*
       auto BitCast = new BitCastInst(NF->getArg(I), Arg->getType());
@@ -185,6 +316,19 @@ Function *ESIMDLowerVecArgPass::rewriteFunc(Function &F) {
     NF->begin()->getInstList().push_front(B);
   }
 
+  for (auto &ArgAndLoads : ArgLoads) {
+    Argument *NewArg = NF->getArg(ArgAndLoads.first->getArgNo());
+    for (Instruction *Load : ArgAndLoads.second) {
+      auto *NewLoad = cast<Instruction>(VMap[Load]);
+      NewLoad->replaceAllUsesWith(NewArg);
+      NewLoad->eraseFromParent();
+    }
+  }
+  for (Instruction *Addr : reverse(DeadAddrs))
+    if (auto *NewAddr = dyn_cast_or_null<Instruction>(VMap.lookup(Addr)))
+      if (NewAddr->use_empty())
+        NewAddr->eraseFromParent();
+
   NF->takeName(&F);
 
   // Fix call sites
@@ -199,7 +343,12 @@ Function *ESIMDLowerVecArgPass::rewriteFunc(Function &F) {
     for (unsigned int I = 0; I < Call->getNumArgOperands(); I++) {
       auto SrcOpnd = Call->getOperand(I);
       auto NewTy = getSimdArgPtrTyOrNull(SrcOpnd);
-      if (NewTy) {
+      if (NewTy && ArgLoads.count(F.getArg(I))) {
+        // Load the vector to pass it by value
+        auto BitCast = new BitCastInst(SrcOpnd, NewTy, "", Call);
+        Params.push_back(new LoadInst(NewTy->getPointerElementType(), BitCast,
+                                      "", Call));
+      } else if (NewTy) {
         auto BitCast = new BitCastInst(SrcOpnd, NewTy, "", Call);
         Params.push_back(BitCast);
       } else {
@@ -65,6 +65,18 @@
 // (1) - materialization of a PFWI object
 // (2) - "fixup" of the private variable address.
 //
+// Unless disabled by -sycl-lower-wg-uniformize=false, the amount of barriers
+// and copying is reduced by the following:
+// - WG-scope instructions which don't access memory are executed by all WIs:
+//   their operands are uniform, so recomputing their results is cheaper than
+//   sharing them through local memory. This also gives each WI its own
+//   pointers into its private copies of the locals.
+// - locals of kind 3 which are never written by the WG-scope code are not
+//   materialized, as the private copy of each WI is as up to date as the
+//   leader's one.
+// - a barrier which follows another one with no memory accesses in between is
+//   removed.
+//
 // TODO The approach employed by this pass generates lots of barriers and data
 // copying between private and local memory, which might not be efficient. There
 // are optimization opportunities listed below. Also other approaches can be
@@ -86,6 +98,8 @@
 #include "llvm/Pass.h"
 #include "llvm/Support/CommandLine.h"
 
+#include <algorithm>
+
 #ifndef NDEBUG
 #include "llvm/IR/CFG.h"
 #include "llvm/IR/Verifier.h"
@@ -98,6 +112,8 @@ using namespace llvm;
 #define DEBUG_TYPE "lowerwgcode"
 
 STATISTIC(LocalMemUsed, "amount of additional local memory used for sharing");
+STATISTIC(NumUniformInsts, "number of WG scope instructions run by all WIs");
+STATISTIC(NumBarriersRemoved, "number of redundant barriers removed");
 
 static constexpr char WG_SCOPE_MD[] = "work_group_scope";
 static constexpr char WI_SCOPE_MD[] = "work_item_scope";
@@ -108,6 +124,12 @@ static cl::opt<int> Debug("sycl-lower-wg-debug", llvm::cl::Optional,
                           llvm::cl::desc("Debug SYCL work group code lowering"),
                           llvm::cl::init(1));
 
+static cl::opt<bool> UniformizeWGScope(
+    "sycl-lower-wg-uniformize", llvm::cl::Optional, llvm::cl::Hidden,
+    llvm::cl::desc("Execute side effect free work group scope code by all work "
+                   "items instead of sharing its results"),
+    llvm::cl::init(true));
+
 namespace {
 class SYCLLowerWGScopeLegacyPass : public FunctionPass {
 public:
@@ -238,7 +260,10 @@ static bool mayHaveSideEffects(const Instruction *I) {
     assert(!isPFWICall(I) && "pfwi must have been handled separately");
     return true;
   default:
-    return true;
+    // Operands of WG scope instructions are uniform, so instructions which
+    // don't access memory give the same results in all WIs.
+    return !UniformizeWGScope || I->mayReadOrWriteMemory() ||
+           I->mayHaveSideEffects();
   }
 }
 
@@ -487,11 +512,45 @@ static void materializeLocalsInWIScopeBlocksImpl(
   }
 }
 
+// Checks if the local may be written by the WG scope code, through any pointer
+// derived from it. Pointers which escape are assumed to be written through.
+static bool mayBeWrittenInWGScope(const AllocaInst *L) {
+  SmallVector<const Value *, 8> Ptrs{L};
+  SmallPtrSet<const Value *, 8> Seen;
+
+  while (!Ptrs.empty()) {
+    const Value *Ptr = Ptrs.pop_back_val();
+    if (!Seen.insert(Ptr).second)
+      continue;
+
+    for (const User *U : Ptr->users()) {
+      const auto *I = dyn_cast<Instruction>(U);
+      if (!I)
+        return true;
+      if (isa<BitCastInst>(I) || isa<AddrSpaceCastInst>(I) ||
+          isa<GetElementPtrInst>(I)) {
+        Ptrs.push_back(I);
+        continue;
+      }
+      if (isa<LoadInst>(I))
+        continue;
+      if (const auto *II = dyn_cast<IntrinsicInst>(I))
+        if (II->isLifetimeStartOrEnd())
+          continue;
+      // Writes done by all WIs, each to its own copy
+      if (isa<CallInst>(I) && isWIScopeInst(I))
+        continue;
+      return true;
+    }
+  }
+  return false;
+}
+
 // Checks if there is a need to materialize value of given local in given work
 // item-scope basic block.
 static bool localMustBeMaterialized(const AllocaInst *L, const BasicBlock &BB) {
   // TODO this is overly conservative - see speculations below.
-  return true;
+  return !UniformizeWGScope || mayBeWrittenInWGScope(L);
 }
 
 // This function handles locals of kind 3 (see comments at the top of file).
@@ -755,6 +814,42 @@ static void sharePFWGPrivateObjects(Function &F, const Triple &TT) {
   spirv::genWGBarrier(MergeBB->front(), TT);
 }
 
+static bool isWGBarrier(const Instruction &I) {
+  const auto *Call = dyn_cast<CallInst>(&I);
+  const Function *F = Call ? Call->getCalledFunction() : nullptr;
+  return F && F->getName() == "_Z22__spirv_ControlBarrierjjj";
+}
+
+// Removes the barriers which follow an identical barrier in the same basic
+// block with no instructions accessing memory in between: no WI can observe
+// the second one. Such pairs appear e.g. when a range of WG scope code is
+// followed by the materialization of the locals.
+static void removeRedundantBarriers(Function &F) {
+  for (BasicBlock &BB : F) {
+    CallInst *LastBarrier = nullptr;
+    for (auto It = BB.begin(); It != BB.end();) {
+      Instruction &I = *It++;
+      if (isWGBarrier(I)) {
+        auto *Barrier = cast<CallInst>(&I);
+        auto SameArg = [](const Use &A, const Use &B) {
+          return A.get() == B.get();
+        };
+        if (LastBarrier &&
+            std::equal(LastBarrier->arg_begin(), LastBarrier->arg_end(),
+                       Barrier->arg_begin(), SameArg)) {
+          Barrier->eraseFromParent();
+          ++NumBarriersRemoved;
+          continue;
+        }
+        LastBarrier = Barrier;
+        continue;
+      }
+      if (I.mayReadOrWriteMemory() || I.mayHaveSideEffects())
+        LastBarrier = nullptr;
+    }
+  }
+}
+
 PreservedAnalyses SYCLLowerWGScopePass::run(Function &F, const llvm::Triple &TT,
                                             FunctionAnalysisManager &FAM) {
   if (!F.getMetadata(WG_SCOPE_MD))
@@ -804,8 +899,10 @@ PreservedAnalyses SYCLLowerWGScopePass::run(Function &F, const llvm::Triple &TT,
         }
         continue;
       }
-      if (!mayHaveSideEffects(I))
+      if (!mayHaveSideEffects(I)) {
+        ++NumUniformInsts;
         continue;
+      }
       LLVM_DEBUG(llvm::dbgs() << "+++ Side effects: " << *I << "\n");
       if (!First)
         First = I;
@@ -860,6 +957,9 @@ PreservedAnalyses SYCLLowerWGScopePass::run(Function &F, const llvm::Triple &TT,
   // PFWG lambda object ('this' pointer).
   sharePFWGPrivateObjects(F, TT);
 
+  if (UniformizeWGScope)
+    removeRedundantBarriers(F);
+
 #ifndef NDEBUG
   if (HaveChanges && Debug > 0)
     verifyModule(*F.getParent(), &llvm::errs());
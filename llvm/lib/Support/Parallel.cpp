@@ -12,8 +12,9 @@
 #include "llvm/Support/Threading.h"
 
 #include <atomic>
+#include <deque>
 #include <future>
-#include <stack>
+#include <memory>
 #include <thread>
 #include <vector>
 
@@ -33,15 +34,28 @@ public:
   virtual ~Executor() = default;
   virtual void add(std::function<void()> func) = 0;
 
+  /// Runs one of the closures not yet started, if any, on the calling thread.
+  /// Returns true if a closure was run.
+  virtual bool runPendingTask() = 0;
+
   static Executor *getDefaultExecutor();
 };
 
-/// An implementation of an Executor that runs closures on a thread pool
-///   in filo order.
+/// An implementation of an Executor that runs closures on a thread pool.
+///
+/// Each worker thread has a queue of closures, to which it adds the closures
+/// it spawns and from which it takes the last one added, so that the closures
+/// which share the data in its cache run after each other. The threads which
+/// run out of closures steal the oldest ones from the queues of the other
+/// threads, which are usually the largest parts of the work left. The threads
+/// outside of the pool share one more queue.
 class ThreadPoolExecutor : public Executor {
 public:
   explicit ThreadPoolExecutor(ThreadPoolStrategy S = hardware_concurrency()) {
     unsigned ThreadCount = S.compute_thread_count();
+    Queues.reserve(ThreadCount + 1);
+    for (unsigned I = 0; I <= ThreadCount; ++I)
+      Queues.push_back(std::make_unique<WorkQueue>());
     // Spawn all but one of the threads in another thread as spawning threads
     // can take a while.
     Threads.reserve(ThreadCount);
@@ -88,35 +102,90 @@ public:
 
   void add(std::function<void()> F) override {
     {
-      std::lock_guard<std::mutex> Lock(Mutex);
-      WorkStack.push(F);
+      WorkQueue &Queue = *Queues[getQueueIndex()];
+      std::lock_guard<std::mutex> Lock(Queue.Mutex);
+      Queue.Tasks.push_back(std::move(F));
     }
+    ++PendingTasks;
+    // Taking the lock orders the increment before the check of the sleeping
+    // workers, which would otherwise miss the notification.
+    { std::lock_guard<std::mutex> Lock(Mutex); }
     Cond.notify_one();
   }
 
+  bool runPendingTask() override {
+    std::function<void()> Task;
+    if (!takeTask(Task))
+      return false;
+    Task();
+    return true;
+  }
+
 private:
+  struct WorkQueue {
+    std::mutex Mutex;
+    std::deque<std::function<void()>> Tasks;
+  };
+
+  // The queue of the calling thread.
+  unsigned getQueueIndex() const {
+    if (CurrentExecutor == this)
+      return CurrentWorkerIndex;
+    return Queues.size() - 1;
+  }
+
+  // Takes the last closure of the queue of the calling thread, or steals the
+  // first one of another queue.
+  bool takeTask(std::function<void()> &Task) {
+    if (PendingTasks == 0)
+      return false;
+    unsigned Self = getQueueIndex();
+    for (unsigned I = 0, E = Queues.size(); I != E; ++I) {
+      WorkQueue &Queue = *Queues[(Self + I) % E];
+      std::lock_guard<std::mutex> Lock(Queue.Mutex);
+      if (Queue.Tasks.empty())
+        continue;
+      if (I == 0) {
+        Task = std::move(Queue.Tasks.back());
+        Queue.Tasks.pop_back();
+      } else {
+        Task = std::move(Queue.Tasks.front());
+        Queue.Tasks.pop_front();
+      }
+      --PendingTasks;
+      return true;
+    }
+    return false;
+  }
+
   void work(ThreadPoolStrategy S, unsigned ThreadID) {
     S.apply_thread_strategy(ThreadID);
-    while (true) {
+    CurrentExecutor = this;
+    CurrentWorkerIndex = ThreadID;
+    while (!Stop) {
+      if (runPendingTask())
+        continue;
       std::unique_lock<std::mutex> Lock(Mutex);
-      Cond.wait(Lock, [&] { return Stop || !WorkStack.empty(); });
-      if (Stop)
-        break;
-      auto Task = WorkStack.top();
-      WorkStack.pop();
-      Lock.unlock();
-      Task();
+      Cond.wait(Lock, [&] { return Stop || PendingTasks != 0; });
     }
   }
 
+  static thread_local const ThreadPoolExecutor *CurrentExecutor;
+  static thread_local unsigned CurrentWorkerIndex;
+
   std::atomic<bool> Stop{false};
-  std::stack<std::function<void()>> WorkStack;
+  // The number of closures in the queues.
+  std::atomic<unsigned> PendingTasks{0};
+  std::vector<std::unique_ptr<WorkQueue>> Queues;
   std::mutex Mutex;
   std::condition_variable Cond;
   std::promise<void> ThreadsCreated;
   std::vector<std::thread> Threads;
 };
 
+thread_local const ThreadPoolExecutor *ThreadPoolExecutor::CurrentExecutor;
+thread_local unsigned ThreadPoolExecutor::CurrentWorkerIndex;
+
 Executor *Executor::getDefaultExecutor() {
   // The ManagedStatic enables the ThreadPoolExecutor to be stopped via
   // llvm_shutdown() which allows a "clean" fast exit, e.g. via _exit(). This
@@ -144,25 +213,31 @@ Executor *Executor::getDefaultExecutor() {
 }
 } // namespace
 
-static std::atomic<int> TaskGroupInstances;
+TaskGroup::TaskGroup() = default;
 
-// Latch::sync() called by the dtor may cause one thread to block. If is a dead
-// lock if all threads in the default executor are blocked. To prevent the dead
-// lock, only allow the first TaskGroup to run tasks parallelly. In the scenario
-// of nested parallel_for_each(), only the outermost one runs parallelly.
-TaskGroup::TaskGroup() : Parallel(TaskGroupInstances++ == 0) {}
-TaskGroup::~TaskGroup() { --TaskGroupInstances; }
+// The tasks refer to the group, which must outlive them.
+TaskGroup::~TaskGroup() { sync(); }
 
 void TaskGroup::spawn(std::function<void()> F) {
-  if (Parallel) {
-    L.inc();
-    Executor::getDefaultExecutor()->add([&, F] {
-      F();
-      L.dec();
-    });
-  } else {
+  L.inc();
+  Executor::getDefaultExecutor()->add([&, F] {
     F();
-  }
+    L.dec();
+  });
+}
+
+void TaskGroup::sync() const {
+  if (L.isDone())
+    return;
+  // Blocking would take the thread out of the pool, and all of them in the
+  // case of nested groups. Run the pending tasks instead, which include the
+  // ones of this group that no other thread started, and only wait briefly
+  // for the ones which are running.
+  Executor *Exec = Executor::getDefaultExecutor();
+  do {
+    if (!Exec->runPendingTask())
+      L.syncFor(std::chrono::microseconds(100));
+  } while (!L.isDone());
 }
 
 } // namespace detail
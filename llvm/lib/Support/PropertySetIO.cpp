@@ -197,6 +197,12 @@ constexpr char PropertySetRegistry::SYCL_SPECIALIZATION_CONSTANTS[];
 constexpr char PropertySetRegistry::SYCL_DEVICELIB_REQ_MASK[];
 constexpr char PropertySetRegistry::SYCL_KERNEL_PARAM_OPT_INFO[];
 constexpr char PropertySetRegistry::SYCL_COMPOSITE_SPECIALIZATION_CONSTANTS[];
+constexpr char PropertySetRegistry::SYCL_KERNEL_PARAM_FIELD_OPT_INFO[];
+constexpr char PropertySetRegistry::SYCL_COMPRESSED_IMAGE[];
+constexpr char PropertySetRegistry::SYCL_SPEC_CONST_BUFFER_LAYOUT[];
+constexpr char PropertySetRegistry::SYCL_KERNEL_SPEC_CONST_BUFFER[];
+constexpr char PropertySetRegistry::SYCL_MISC_PROP[];
+constexpr char PropertySetRegistry::SYCL_SUB_GROUP_SIZE_VARIANTS[];
 
 } // namespace util
 } // namespace llvm
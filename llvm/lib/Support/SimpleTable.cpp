@@ -190,56 +190,118 @@ void SimpleTable::write(raw_ostream &Out, bool WriteTitles, char ColSep) const {
   }
 }
 
-Expected<SimpleTable::UPtrTy> SimpleTable::read(MemoryBuffer *Buf,
-                                                char ColSep) {
+// Parses a table from given buffer. If ColNames is not null, only the columns
+// with given names are materialized, the rest are skipped right at parse time.
+static Expected<SimpleTable::UPtrTy>
+readTable(MemoryBuffer *Buf, const ArrayRef<StringRef> *ColNames,
+          char ColSep) {
   line_iterator LI(*Buf);
 
-  if (LI.is_at_end() || LI->empty()) // empty table
+  if (LI.is_at_end() || LI->empty()) { // empty table
+    if (ColNames && !ColNames->empty())
+      return makeError("column not found " + ColNames->front());
     return std::make_unique<SimpleTable>();
-  UPtrTy Res;
+  }
+  SmallVector<StringRef, 4> Titles;
+  SmallVector<std::string, 4> Ordinals;
 
   if (LI->startswith(COL_TITLE_LINE_OPEN)) {
     if (!LI->endswith(COL_TITLE_LINE_CLOSE))
       return createStringError(errc::invalid_argument, "malformed title line");
     // column titles present
     StringRef L = LI->substr(1, LI->size() - 2); // trim '[' and ']'
-    SmallVector<StringRef, 4> Titles;
     L.split(Titles, ColSep);
-    auto Table = SimpleTable::create(Titles);
-    if (!Table)
-      return Table.takeError();
-    Res = std::move(Table.get());
     LI++;
+  } else {
+    // no titles - columns are named by their ordinals, see create(int)
+    const auto NColumns = LI->count(ColSep) + 1;
+
+    for (size_t I = 0; I < NColumns; ++I)
+      Ordinals.emplace_back(Twine(I).str());
+    Titles.append(Ordinals.begin(), Ordinals.end());
+  }
+  // figure out which columns stay, preserving their original order
+  SmallVector<int, 4> Kept;
+
+  if (ColNames) {
+    std::set<StringRef> Names(ColNames->begin(), ColNames->end());
+
+    if (Names.size() != ColNames->size())
+      return makeError("duplicated column names found");
+    for (int I = 0; I < static_cast<int>(Titles.size()); ++I)
+      if (Names.erase(Titles[I]) > 0)
+        Kept.push_back(I);
+    if (Names.size() > 0)
+      return makeError("column not found " + *Names.begin());
+  } else {
+    for (int I = 0; I < static_cast<int>(Titles.size()); ++I)
+      Kept.push_back(I);
   }
+  SmallVector<StringRef, 4> KeptTitles;
+
+  for (int I : Kept)
+    KeptTitles.push_back(Titles[I]);
+  auto Table = SimpleTable::create(KeptTitles);
+  if (!Table)
+    return Table.takeError();
+  SimpleTable::UPtrTy Res = std::move(Table.get());
   // parse rows
+  SmallVector<StringRef, 4> Vals;
+  SmallVector<StringRef, 4> KeptVals;
+
   while (!LI.is_at_end()) {
-    SmallVector<StringRef, 4> Vals;
+    Vals.clear();
     LI->split(Vals, ColSep);
 
-    if (!Res) {
-      auto Table = SimpleTable::create(Vals.size());
-      if (!Table)
-        return Table.takeError();
-      Res = std::move(Table.get());
-    }
-    if (static_cast<int>(Vals.size()) != Res->getNumColumns())
+    if (Vals.size() != Titles.size())
       return createStringError(errc::invalid_argument,
                                "row size mismatch at line " +
                                    Twine(LI.line_number()));
-    Res->addRow(Vals);
+    KeptVals.clear();
+
+    for (int I : Kept)
+      KeptVals.push_back(Vals[I]);
+    Res->addRow(KeptVals);
     LI++;
   }
   return std::move(Res);
 }
 
-Expected<SimpleTable::UPtrTy> SimpleTable::read(const Twine &FileName,
+Expected<SimpleTable::UPtrTy> SimpleTable::read(MemoryBuffer *Buf,
                                                 char ColSep) {
+  return readTable(Buf, nullptr, ColSep);
+}
+
+Expected<SimpleTable::UPtrTy>
+SimpleTable::read(MemoryBuffer *Buf, ArrayRef<StringRef> ColNames,
+                  char ColSep) {
+  return readTable(Buf, &ColNames, ColSep);
+}
+
+static Expected<std::unique_ptr<MemoryBuffer>> readFile(const Twine &FileName) {
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> MemBuf =
       MemoryBuffer::getFileAsStream(FileName);
   if (!MemBuf || !MemBuf->get())
     return createFileError(Twine("can't read ") + FileName, MemBuf.getError());
+  return std::move(MemBuf.get());
+}
+
+Expected<SimpleTable::UPtrTy> SimpleTable::read(const Twine &FileName,
+                                                char ColSep) {
+  Expected<std::unique_ptr<MemoryBuffer>> MemBuf = readFile(FileName);
+  if (!MemBuf)
+    return MemBuf.takeError();
   return read(MemBuf->get(), ColSep);
 }
 
+Expected<SimpleTable::UPtrTy>
+SimpleTable::read(const Twine &FileName, ArrayRef<StringRef> ColNames,
+                  char ColSep) {
+  Expected<std::unique_ptr<MemoryBuffer>> MemBuf = readFile(FileName);
+  if (!MemBuf)
+    return MemBuf.takeError();
+  return read(MemBuf->get(), ColNames, ColSep);
+}
+
 } // namespace util
 } // namespace llvm
@@ -12,81 +12,158 @@
 
 #include "llvm/Support/ThreadPool.h"
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Config/llvm-config.h"
 #include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace llvm;
 
+// The pool whose thread is the current thread, if any, and the index of the
+// queue of the thread.
+static thread_local const ThreadPool *CurrentPool = nullptr;
+static thread_local unsigned CurrentQueueIndex = 0;
+
+unsigned ThreadPool::getQueueIndex() const {
+  if (CurrentPool == this)
+    return CurrentQueueIndex;
+  return Queues.size() - 1;
+}
+
+void ThreadPool::enqueue(TaskTy Task, ThreadPoolTaskGroup *Group) {
+  // Count the task before it can be taken, so that it is never seen as
+  // completed before being counted.
+  ++UnfinishedTasks;
+  if (Group)
+    ++Group->UnfinishedTasks;
+  ++QueuedTasks;
+  {
+    WorkQueue &Queue = *Queues[getQueueIndex()];
+    std::lock_guard<std::mutex> LockGuard(Queue.Lock);
+    Queue.Tasks.push_back({std::move(Task), Group});
+  }
+  {
+    // Taking the lock orders the update of the counters before the checks of
+    // the waiting threads, which would otherwise miss the notifications.
+    std::lock_guard<std::mutex> LockGuard(QueueLock);
+#if LLVM_ENABLE_THREADS
+    // Don't allow enqueueing after disabling the pool
+    assert(EnableFlag && "Queuing a thread during ThreadPool destruction");
+#endif
+    if (Group)
+      ++GroupTaskSubmissions;
+  }
+  QueueCondition.notify_one();
+  if (Group)
+    CompletionCondition.notify_all();
+}
+
+bool ThreadPool::takeTask(QueuedTask &Task, ThreadPoolTaskGroup *Group) {
+  if (QueuedTasks == 0)
+    return false;
+  unsigned Self = getQueueIndex();
+  unsigned SharedIndex = Queues.size() - 1;
+  for (unsigned I = 0, E = Queues.size(); I != E; ++I) {
+    WorkQueue &Queue = *Queues[(Self + I) % E];
+    std::lock_guard<std::mutex> LockGuard(Queue.Lock);
+    if (Queue.Tasks.empty())
+      continue;
+    if (Group) {
+      auto It = llvm::find_if(Queue.Tasks, [&](const QueuedTask &Queued) {
+        return Queued.Group == Group;
+      });
+      if (It == Queue.Tasks.end())
+        continue;
+      Task = std::move(*It);
+      Queue.Tasks.erase(It);
+    } else if (I == 0 && Self != SharedIndex) {
+      // The last task submitted by the thread likely uses the data it has in
+      // its cache.
+      Task = std::move(Queue.Tasks.back());
+      Queue.Tasks.pop_back();
+    } else {
+      Task = std::move(Queue.Tasks.front());
+      Queue.Tasks.pop_front();
+    }
+    --QueuedTasks;
+    return true;
+  }
+  return false;
+}
+
+void ThreadPool::runTask(QueuedTask &Task) {
+  Task.Task();
+  // The group may be destroyed as soon as its count reaches zero.
+  bool Notify = --UnfinishedTasks == 0;
+  if (Task.Group && --Task.Group->UnfinishedTasks == 0)
+    Notify = true;
+  // Notify task completion if this is the last task of the pool or of its
+  // group, in case someone waits on ThreadPool::wait().
+  if (Notify) {
+    std::lock_guard<std::mutex> LockGuard(QueueLock);
+    CompletionCondition.notify_all();
+  }
+}
+
 #if LLVM_ENABLE_THREADS
 
 ThreadPool::ThreadPool(ThreadPoolStrategy S)
     : ThreadCount(S.compute_thread_count()) {
+  Queues.reserve(ThreadCount + 1);
+  for (unsigned I = 0; I <= ThreadCount; ++I)
+    Queues.push_back(std::make_unique<WorkQueue>());
   // Create ThreadCount threads that will loop forever, wait on QueueCondition
   // for tasks to be queued or the Pool to be destroyed.
   Threads.reserve(ThreadCount);
   for (unsigned ThreadID = 0; ThreadID < ThreadCount; ++ThreadID) {
     Threads.emplace_back([S, ThreadID, this] {
       S.apply_thread_strategy(ThreadID);
+      CurrentPool = this;
+      CurrentQueueIndex = ThreadID;
       while (true) {
-        PackagedTaskTy Task;
-        {
-          std::unique_lock<std::mutex> LockGuard(QueueLock);
-          // Wait for tasks to be pushed in the queue
-          QueueCondition.wait(LockGuard,
-                              [&] { return !EnableFlag || !Tasks.empty(); });
-          // Exit condition
-          if (!EnableFlag && Tasks.empty())
-            return;
-          // Yeah, we have a task, grab it and release the lock on the queue
-
-          // We first need to signal that we are active before popping the queue
-          // in order for wait() to properly detect that even if the queue is
-          // empty, there is still a task in flight.
-          ++ActiveThreads;
-          Task = std::move(Tasks.front());
-          Tasks.pop();
-        }
-        // Run the task we just grabbed
-        Task();
-
-        bool Notify;
-        {
-          // Adjust `ActiveThreads`, in case someone waits on ThreadPool::wait()
-          std::lock_guard<std::mutex> LockGuard(QueueLock);
-          --ActiveThreads;
-          Notify = workCompletedUnlocked();
+        QueuedTask Task;
+        if (takeTask(Task, nullptr)) {
+          runTask(Task);
+          continue;
         }
-        // Notify task completion if this is the last active thread, in case
-        // someone waits on ThreadPool::wait().
-        if (Notify)
-          CompletionCondition.notify_all();
+        std::unique_lock<std::mutex> LockGuard(QueueLock);
+        // Wait for tasks to be pushed in the queues
+        QueueCondition.wait(LockGuard,
+                            [&] { return !EnableFlag || QueuedTasks != 0; });
+        // Exit condition
+        if (!EnableFlag && QueuedTasks == 0)
+          return;
       }
     });
   }
 }
 
 void ThreadPool::wait() {
-  // Wait for all threads to complete and the queue to be empty
+  // Wait for all the tasks to complete
   std::unique_lock<std::mutex> LockGuard(QueueLock);
-  CompletionCondition.wait(LockGuard, [&] { return workCompletedUnlocked(); });
+  CompletionCondition.wait(LockGuard, [&] { return UnfinishedTasks == 0; });
 }
 
-std::shared_future<void> ThreadPool::asyncImpl(TaskTy Task) {
-  /// Wrap the Task in a packaged_task to return a future object.
-  PackagedTaskTy PackagedTask(std::move(Task));
-  auto Future = PackagedTask.get_future();
-  {
-    // Lock the queue and push the new task
+void ThreadPool::wait(ThreadPoolTaskGroup &Group) {
+  while (Group.UnfinishedTasks != 0) {
+    unsigned Submissions;
+    {
+      std::lock_guard<std::mutex> LockGuard(QueueLock);
+      Submissions = GroupTaskSubmissions;
+    }
+    QueuedTask Task;
+    if (takeTask(Task, &Group)) {
+      runTask(Task);
+      continue;
+    }
+    // The tasks of the group are running on other threads. Wait for them,
+    // or for a new task which this thread can run.
     std::unique_lock<std::mutex> LockGuard(QueueLock);
-
-    // Don't allow enqueueing after disabling the pool
-    assert(EnableFlag && "Queuing a thread during ThreadPool destruction");
-
-    Tasks.push(std::move(PackagedTask));
+    CompletionCondition.wait(LockGuard, [&] {
+      return Group.UnfinishedTasks == 0 ||
+             GroupTaskSubmissions != Submissions;
+    });
   }
-  QueueCondition.notify_one();
-  return Future.share();
 }
 
 // The destructor joins all threads, waiting for completion.
@@ -109,25 +186,21 @@ ThreadPool::ThreadPool(ThreadPoolStrategy S)
     errs() << "Warning: request a ThreadPool with " << ThreadCount
            << " threads, but LLVM_ENABLE_THREADS has been turned off\n";
   }
+  Queues.push_back(std::make_unique<WorkQueue>());
 }
 
 void ThreadPool::wait() {
   // Sequential implementation running the tasks
-  while (!Tasks.empty()) {
-    auto Task = std::move(Tasks.front());
-    Tasks.pop();
-    Task();
-  }
+  QueuedTask Task;
+  while (takeTask(Task, nullptr))
+    runTask(Task);
 }
 
-std::shared_future<void> ThreadPool::asyncImpl(TaskTy Task) {
-  // Get a Future with launch::deferred execution using std::async
-  auto Future = std::async(std::launch::deferred, std::move(Task)).share();
-  // Wrap the future so that both ThreadPool::wait() can operate and the
-  // returned future can be sync'ed on.
-  PackagedTaskTy PackagedTask([Future]() { Future.get(); });
-  Tasks.push(std::move(PackagedTask));
-  return Future;
+void ThreadPool::wait(ThreadPoolTaskGroup &Group) {
+  // Sequential implementation running the tasks of the group
+  QueuedTask Task;
+  while (takeTask(Task, &Group))
+    runTask(Task);
 }
 
 ThreadPool::~ThreadPool() { wait(); }
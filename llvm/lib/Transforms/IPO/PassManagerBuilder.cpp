@@ -72,6 +72,10 @@ static cl::opt<bool>
     SYCLOptimizationMode("sycl-opt", cl::init(false), cl::Hidden,
                          cl::desc("Enable SYCL optimization mode."));
 
+static cl::opt<int> SYCLUnrollThreshold(
+    "sycl-unroll-threshold", cl::init(300), cl::Hidden,
+    cl::desc("Loop unrolling threshold of the SYCL optimization mode."));
+
 cl::opt<bool> RunNewGVN("enable-newgvn", cl::init(false), cl::Hidden,
                         cl::desc("Run the NewGVN pass"));
 
@@ -384,6 +388,12 @@ void PassManagerBuilder::addFunctionSimplificationPasses(
   assert(OptLevel >= 1 && "Calling function optimizer with no optimization level!");
   MPM.add(createSROAPass());
   MPM.add(createEarlyCSEPass(true /* Enable mem-ssa. */)); // Catch trivial redundancies
+  // Accesses through generic pointers are slower than through the named
+  // address spaces on most SYCL devices, so rewrite the generic pointers whose
+  // address space is known once the callees are inlined. SPIR targets have no
+  // TTI to tell the generic address space, which is 4.
+  if (SYCLOptimizationMode)
+    MPM.add(createInferAddressSpacesPass(/*AddressSpace=*/4));
   if (EnableKnowledgeRetention)
     MPM.add(createAssumeSimplifyPass());
 
@@ -670,7 +680,9 @@ void PassManagerBuilder::populateModulePassManager(
     MPM.add(createOpenMPOptLegacyPass());
 
   MPM.add(createPostOrderFunctionAttrsLegacyPass());
-  if (OptLevel > 2)
+  // The callees of SYCL kernels often take accessors, ids and ranges by
+  // reference, which stay in private memory unless promoted.
+  if (OptLevel > 2 || SYCLOptimizationMode)
     MPM.add(createArgumentPromotionPass()); // Scalarize uninlined fn args
 
   addExtensionsToPM(EP_CGSCCOptimizerLate, MPM);
@@ -852,8 +864,16 @@ void PassManagerBuilder::populateModulePassManager(
   }
 
   // Unroll small loops
-  MPM.add(createLoopUnrollPass(OptLevel, DisableUnrollLoops,
-                               ForgetAllSCEVInLoopUnroll));
+  if (SYCLOptimizationMode)
+    // Fully unrolled loops let SROA keep the private arrays in registers,
+    // while the remainder loops of runtime unrolling diverge on GPUs.
+    MPM.add(createLoopUnrollPass(OptLevel, DisableUnrollLoops,
+                                 ForgetAllSCEVInLoopUnroll,
+                                 SYCLUnrollThreshold, /*Count=*/-1,
+                                 /*AllowPartial=*/-1, /*Runtime=*/0));
+  else
+    MPM.add(createLoopUnrollPass(OptLevel, DisableUnrollLoops,
+                                 ForgetAllSCEVInLoopUnroll));
 
   if (!DisableUnrollLoops) {
     // LoopUnroll may generate some redundency to cleanup.
@@ -144,7 +144,7 @@ struct TformCmd {
 
   using Func = std::function<Error(TformCmd *)>;
 
-  Error consumeInput(InpIt Cur, const InpIt End) {
+  Error consumeInput(InpIt &Cur, const InpIt End) {
     Func F =
         StringSwitch<Func>(Kind)
             .Case(OPT_REPLACE,
@@ -297,8 +297,15 @@ int main(int argc, char **argv) {
   // commands are constructed, command line is correct - read input and execute
   // transformations on it
 
+  // If the first command is an extraction, only the extracted columns are
+  // materialized while reading, which saves a lot of work on large tables.
+  // The extraction itself then becomes a no-op, but is still executed to keep
+  // the command sequence intact.
+  const TformCmd *First = Cmds.empty() ? nullptr : Cmds.begin()->second.get();
   Expected<util::SimpleTable::UPtrTy> Table =
-      util::SimpleTable::read(InputFile);
+      (First && First->Kind == OPT_EXTRACT)
+          ? util::SimpleTable::read(InputFile, First->Args)
+          : util::SimpleTable::read(InputFile);
   if (!Table)
     CHECK_AND_EXIT(Table.takeError());
 
@@ -18,7 +18,11 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/SystemUtils.h"
+#include "llvm/Support/Threading.h"
 
+#include <chrono>
+#include <deque>
+#include <thread>
 #include <vector>
 
 using namespace llvm;
@@ -62,6 +66,16 @@ static cl::opt<std::string> OutputFileList{
     "out-file-list", cl::desc("Specify filename for list of outputs."),
     cl::value_desc("filename"), cl::init("")};
 
+static cl::opt<unsigned> Jobs{
+    "jobs",
+    cl::desc("Specify the number of commands to execute in parallel; 0 means "
+             "the number of hardware threads. Outputs of the commands are "
+             "printed in the order of the input list."),
+    cl::init(1), cl::value_desc("N")};
+
+static cl::alias JobsShort{"j", cl::desc("Alias for --jobs"),
+                           cl::aliasopt(Jobs)};
+
 static void error(const Twine &Msg) {
   errs() << "llvm-foreach: " << Msg << '\n';
   exit(1);
@@ -72,6 +86,27 @@ static void error(std::error_code EC, const Twine &Prefix) {
     error(Prefix + ": " + EC.message());
 }
 
+namespace {
+// A command executed in parallel mode. Its stdout and stderr are redirected to
+// temporary files, which are printed once all previous commands have finished
+// to keep the output independent of the execution order.
+struct ParallelJob {
+  sys::ProcessInfo PI;
+  SmallString<128> OutFile;
+  SmallString<128> ErrFile;
+  bool Finished = false;
+  int Result = 0;
+  std::string ErrMsg;
+};
+} // anonymous namespace
+
+static void printAndRemove(StringRef Path, raw_ostream &OS) {
+  if (ErrorOr<std::unique_ptr<MemoryBuffer>> MB = MemoryBuffer::getFile(Path))
+    OS << (*MB)->getBuffer();
+  OS.flush();
+  sys::fs::remove(Path);
+}
+
 int main(int argc, char **argv) {
   cl::ParseCommandLineOptions(
       argc, argv,
@@ -151,6 +186,49 @@ int main(int argc, char **argv) {
   if (!OutputFileList.empty())
     error(EC, "error opening the file '" + OutputFileList + "'");
 
+  unsigned NumJobs =
+      Jobs == 0 ? heavyweight_hardware_concurrency().compute_thread_count()
+                : Jobs;
+  // Commands launched in parallel mode whose output is not printed yet, in
+  // the order of the input list.
+  std::deque<ParallelJob> PendingJobs;
+  unsigned NumRunning = 0;
+  bool Failed = false;
+  std::string FailMsg;
+  // Collects finished commands and prints the output of those without
+  // unfinished predecessors. Sleeps a bit if no command has finished.
+  auto PollJobs = [&]() {
+    bool AnyFinished = false;
+    for (ParallelJob &Job : PendingJobs) {
+      if (Job.Finished)
+        continue;
+      sys::ProcessInfo WaitResult =
+          sys::Wait(Job.PI, /*SecondsToWait=*/0,
+                    /*WaitUntilTerminates=*/false, &Job.ErrMsg);
+      if (WaitResult.Pid == 0)
+        continue;
+      Job.Finished = true;
+      Job.Result = WaitResult.ReturnCode;
+      Failed |= Job.Result != 0;
+      AnyFinished = true;
+      --NumRunning;
+    }
+    for (; !PendingJobs.empty() && PendingJobs.front().Finished;
+         PendingJobs.pop_front()) {
+      ParallelJob &Job = PendingJobs.front();
+      printAndRemove(Job.OutFile, outs());
+      printAndRemove(Job.ErrFile, errs());
+      // Report the first failed command of the input list.
+      if (Job.Result != 0 && FailMsg.empty())
+        FailMsg = Job.ErrMsg.empty()
+                      ? "command failed with exit code " +
+                            std::to_string(Job.Result)
+                      : Job.ErrMsg;
+    }
+    if (!AnyFinished && NumRunning != 0)
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  };
+
   std::string ResOutArg;
   std::vector<std::string> ResInArgs(InReplaceArgs.size());
   std::string ResFileList = "";
@@ -197,15 +275,49 @@ int main(int argc, char **argv) {
         OS << Path << "\n";
     }
 
-    std::string ErrMsg;
-    // TODO: Add possibility to execute commands in parallel.
-    int Result =
-        sys::ExecuteAndWait(Prog, Args, /*Env=*/None, /*Redirects=*/None,
-                            /*SecondsToWait=*/0, /*MemoryLimit=*/0, &ErrMsg);
-    if (Result != 0)
-      error(ErrMsg);
+    if (NumJobs == 1) {
+      std::string ErrMsg;
+      int Result =
+          sys::ExecuteAndWait(Prog, Args, /*Env=*/None, /*Redirects=*/None,
+                              /*SecondsToWait=*/0, /*MemoryLimit=*/0, &ErrMsg);
+      if (Result != 0)
+        error(ErrMsg);
+      continue;
+    }
+
+    while (NumRunning == NumJobs)
+      PollJobs();
+    if (Failed)
+      break;
+
+    PendingJobs.emplace_back();
+    ParallelJob &Job = PendingJobs.back();
+    error(sys::fs::createTemporaryFile("llvm-foreach", "out", Job.OutFile),
+          "Could not create a file for command stdout.");
+    error(sys::fs::createTemporaryFile("llvm-foreach", "err", Job.ErrFile),
+          "Could not create a file for command stderr.");
+    Optional<StringRef> Redirects[] = {None, StringRef(Job.OutFile),
+                                       StringRef(Job.ErrFile)};
+    bool ExecutionFailed = false;
+    Job.PI = sys::ExecuteNoWait(Prog, Args, /*Env=*/None, Redirects,
+                                /*MemoryLimit=*/0, &Job.ErrMsg,
+                                &ExecutionFailed);
+    if (ExecutionFailed) {
+      Job.Finished = true;
+      Job.Result = -1;
+      Failed = true;
+      break;
+    }
+    ++NumRunning;
   }
 
+  // Stop launching new commands after the first failure, but let the running
+  // ones finish so that no process outlives llvm-foreach.
+  while (!PendingJobs.empty())
+    PollJobs();
+  if (Failed)
+    error(FailMsg);
+
   if (!OutputFileList.empty()) {
     OS.close();
   }
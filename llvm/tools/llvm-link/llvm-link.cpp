@@ -186,7 +186,14 @@ loadArFile(const char *Argv0, std::unique_ptr<MemoryBuffer> Buffer,
       return nullptr;
     }
 
-    std::unique_ptr<Module> M = parseIR(MemBuf.get(), ParseErr, Context);
+    // Only the function bodies which are linked into the result are
+    // materialized, e.g. with -only-needed.
+    std::unique_ptr<Module> M =
+        DisableLazyLoad
+            ? parseIR(MemBuf.get(), ParseErr, Context)
+            : getLazyIRModule(MemoryBuffer::getMemBuffer(MemBuf.get(),
+                                                         false),
+                              ParseErr, Context);
 
     if (!M.get()) {
       errs() << Argv0 << ": ";
@@ -341,7 +348,26 @@ static bool importFunctions(const char *argv0, Module &DestModule) {
   return true;
 }
 
+// Returns whether linking \p Src into \p Dest with Linker::LinkOnlyNeeded
+// would link anything, i.e. whether \p Src has appending variables or defines
+// a global declared in \p Dest. Only the global table of a lazily loaded
+// \p Src is read, so that the modules which are not needed, e.g. most of the
+// device libraries, are not materialized at all.
+static bool isNeededByDestination(const Module &Src, const Module &Dest) {
+  for (const GlobalValue &GV : Src.global_values()) {
+    if (GV.hasAppendingLinkage())
+      return true;
+    if (GV.isDeclaration() || GV.hasLocalLinkage())
+      continue;
+    const GlobalValue *DGV = Dest.getNamedValue(GV.getName());
+    if (DGV && DGV->isDeclaration())
+      return true;
+  }
+  return false;
+}
+
 static bool linkFiles(const char *argv0, LLVMContext &Context, Linker &L,
+                      const Module &Composite,
                       const cl::list<std::string> &Files,
                       unsigned Flags) {
   // Filter out flags that don't apply to the first file we load.
@@ -352,17 +378,33 @@ static bool linkFiles(const char *argv0, LLVMContext &Context, Linker &L,
     std::unique_ptr<MemoryBuffer> Buffer =
         ExitOnErr(errorOrToExpected(MemoryBuffer::getFileOrSTDIN(File)));
 
+    // With -only-needed, the metadata is materialized only once the module
+    // is known to be needed.
+    bool OnlyNeededFile = ApplicableFlags & Linker::Flags::LinkOnlyNeeded;
+    bool IsArchive = identify_magic(Buffer->getBuffer()) == file_magic::archive;
     std::unique_ptr<Module> M =
-        identify_magic(Buffer->getBuffer()) == file_magic::archive
-            ? loadArFile(argv0, std::move(Buffer), Context, Flags,
-                         ApplicableFlags)
-            : loadFile(argv0, std::move(Buffer), Context);
+        IsArchive ? loadArFile(argv0, std::move(Buffer), Context, Flags,
+                               ApplicableFlags)
+                  : loadFile(argv0, std::move(Buffer), Context,
+                             /*MaterializeMetadata=*/!OnlyNeededFile);
     if (!M.get()) {
       errs() << argv0 << ": ";
       WithColor::error() << " loading file '" << File << "'\n";
       return false;
     }
 
+    if (OnlyNeededFile) {
+      if (!isNeededByDestination(*M, Composite)) {
+        if (Verbose)
+          errs() << "Skipping '" << File << "', no symbol is needed\n";
+        continue;
+      }
+      if (!IsArchive) {
+        ExitOnErr(M->materializeMetadata());
+        UpgradeDebugInfo(*M);
+      }
+    }
+
     // Note that when ODR merging types cannot verify input files in here When
     // doing that debug metadata in the src module might already be pointing to
     // the destination.
@@ -442,11 +484,11 @@ int main(int argc, char **argv) {
     Flags |= Linker::Flags::LinkOnlyNeeded;
 
   // First add all the regular input files
-  if (!linkFiles(argv[0], Context, L, InputFilenames, Flags))
+  if (!linkFiles(argv[0], Context, L, *Composite, InputFilenames, Flags))
     return 1;
 
   // Next the -override ones.
-  if (!linkFiles(argv[0], Context, L, OverridingInputs,
+  if (!linkFiles(argv[0], Context, L, *Composite, OverridingInputs,
                  Flags | Linker::Flags::OverrideFromSrc))
     return 1;
 
@@ -55,6 +55,12 @@ static cl::opt<std::string> OutputFilename("o", cl::Required,
 static cl::opt<std::string> CacheDir("cache-dir", cl::desc("Cache Directory"),
                                      cl::value_desc("directory"));
 
+static cl::opt<std::string>
+    RemoteCacheDir("remote-cache-dir",
+                   cl::desc("Cache Directory shared by several links, "
+                            "backing the one of -cache-dir"),
+                   cl::value_desc("directory"));
+
 static cl::opt<std::string> OptPipeline("opt-pipeline",
                                         cl::desc("Optimizer Pipeline"),
                                         cl::value_desc("pipeline"));
@@ -371,8 +377,18 @@ static int run(int argc, char **argv) {
   };
 
   NativeObjectCache Cache;
-  if (!CacheDir.empty())
+  if (!RemoteCacheDir.empty()) {
+    if (CacheDir.empty()) {
+      errs() << argv[0] << ": -remote-cache-dir requires -cache-dir\n";
+      return 1;
+    }
+    Cache = check(tieredCache(CacheDir, AddBuffer,
+                              check(directoryRemoteCache(RemoteCacheDir),
+                                    "failed to create remote cache")),
+                  "failed to create cache");
+  } else if (!CacheDir.empty()) {
     Cache = check(localCache(CacheDir, AddBuffer), "failed to create cache");
+  }
 
   check(Lto.run(AddStream, Cache), "LTO::run failed");
   return 0;
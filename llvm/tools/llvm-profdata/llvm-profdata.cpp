@@ -221,6 +221,26 @@ static void overlapInput(const std::string &BaseFilename,
   }
 }
 
+/// Add a record of \p Input to the writer of \p WC, whose lock is held.
+static void addRecord(WriterContext *WC, NamedInstrProfRecord &&I,
+                      const WeightedFile &Input) {
+  const StringRef FuncName = I.Name;
+  bool Reported = false;
+  WC->Writer.addRecord(std::move(I), Input.Weight, [&](Error E) {
+    if (Reported) {
+      consumeError(std::move(E));
+      return;
+    }
+    Reported = true;
+    // Only show hint the first time an error occurs.
+    instrprof_error IPE = InstrProfError::take(std::move(E));
+    std::unique_lock<std::mutex> ErrGuard{WC->ErrLock};
+    bool firstTime = WC->WriterErrorCodes.insert(IPE).second;
+    handleMergeWriterError(make_error<InstrProfError>(IPE), Input.Filename,
+                           FuncName, firstTime);
+  });
+}
+
 /// Load an input into a writer context.
 static void loadInput(const WeightedFile &Input, SymbolRemapper *Remapper,
                       WriterContext *WC) {
@@ -256,27 +276,82 @@ static void loadInput(const WeightedFile &Input, SymbolRemapper *Remapper,
   for (auto &I : *Reader) {
     if (Remapper)
       I.Name = (*Remapper)(I.Name);
-    const StringRef FuncName = I.Name;
-    bool Reported = false;
-    WC->Writer.addRecord(std::move(I), Input.Weight, [&](Error E) {
-      if (Reported) {
-        consumeError(std::move(E));
-        return;
-      }
-      Reported = true;
-      // Only show hint the first time an error occurs.
-      instrprof_error IPE = InstrProfError::take(std::move(E));
-      std::unique_lock<std::mutex> ErrGuard{WC->ErrLock};
-      bool firstTime = WC->WriterErrorCodes.insert(IPE).second;
-      handleMergeWriterError(make_error<InstrProfError>(IPE), Input.Filename,
-                             FuncName, firstTime);
-    });
+    addRecord(WC, std::move(I), Input);
   }
   if (Reader->hasError())
     if (Error E = Reader->getError())
       WC->Errors.emplace_back(std::move(E), Filename);
 }
 
+/// The number of records a sharded merge hands over to a shard at once.
+static constexpr size_t ShardBatchSize = 256;
+
+/// Load an input into the writer contexts of a sharded merge, each of which
+/// owns the functions whose names hash to it. The records are handed over in
+/// batches, so that a context is locked once per batch. The first context
+/// also keeps the kind of the profile and the errors of the inputs.
+static void loadInputSharded(const WeightedFile &Input,
+                             SymbolRemapper *Remapper,
+                             ArrayRef<std::unique_ptr<WriterContext>> Shards) {
+  // Copy the filename, as in loadInput.
+  std::string Filename = Input.Filename;
+  WriterContext *First = Shards[0].get();
+
+  auto ReaderOrErr = InstrProfReader::create(Filename);
+  if (Error E = ReaderOrErr.takeError()) {
+    // Skip the empty profiles by returning sliently.
+    instrprof_error IPE = InstrProfError::take(std::move(E));
+    if (IPE != instrprof_error::empty_raw_profile) {
+      std::unique_lock<std::mutex> CtxGuard{First->Lock};
+      First->Errors.emplace_back(make_error<InstrProfError>(IPE), Filename);
+    }
+    return;
+  }
+
+  auto Reader = std::move(ReaderOrErr.get());
+  {
+    std::unique_lock<std::mutex> CtxGuard{First->Lock};
+    if (First->Writer.setIsIRLevelProfile(Reader->isIRLevelProfile(),
+                                          Reader->hasCSIRLevelProfile())) {
+      First->Errors.emplace_back(
+          make_error<StringError>(
+              "Merge IR generated profile with Clang generated profile.",
+              std::error_code()),
+          Filename);
+      return;
+    }
+    First->Writer.setInstrEntryBBEnabled(Reader->instrEntryBBEnabled());
+  }
+
+  // The names of the records refer to the reader, so the batches are all
+  // handed over before it is destroyed.
+  std::vector<std::vector<NamedInstrProfRecord>> Batches(Shards.size());
+  auto HandOver = [&](size_t Shard) {
+    WriterContext *WC = Shards[Shard].get();
+    std::unique_lock<std::mutex> CtxGuard{WC->Lock};
+    for (NamedInstrProfRecord &I : Batches[Shard])
+      addRecord(WC, std::move(I), Input);
+    Batches[Shard].clear();
+  };
+  for (auto &I : *Reader) {
+    if (Remapper)
+      I.Name = (*Remapper)(I.Name);
+    size_t Shard = hash_value(I.Name) % Shards.size();
+    Batches[Shard].push_back(std::move(I));
+    if (Batches[Shard].size() == ShardBatchSize)
+      HandOver(Shard);
+  }
+  for (size_t Shard = 0; Shard < Shards.size(); ++Shard)
+    if (!Batches[Shard].empty())
+      HandOver(Shard);
+
+  if (Reader->hasError())
+    if (Error E = Reader->getError()) {
+      std::unique_lock<std::mutex> CtxGuard{First->Lock};
+      First->Errors.emplace_back(std::move(E), Filename);
+    }
+}
+
 /// Merge the \p Src writer context into \p Dst.
 static void mergeWriterContexts(WriterContext *Dst, WriterContext *Src) {
   for (auto &ErrorPair : Src->Errors)
@@ -312,7 +387,8 @@ static void mergeInstrProfile(const WeightedFileVector &Inputs,
                               SymbolRemapper *Remapper,
                               StringRef OutputFilename,
                               ProfileFormat OutputFormat, bool OutputSparse,
-                              unsigned NumThreads, FailureMode FailMode) {
+                              unsigned NumThreads, unsigned NumShards,
+                              FailureMode FailMode) {
   if (OutputFilename.compare("-") == 0)
     exitWithError("Cannot write indexed profdata format to stdout.");
 
@@ -324,6 +400,9 @@ static void mergeInstrProfile(const WeightedFileVector &Inputs,
   SmallSet<instrprof_error, 4> WriterErrorCodes;
 
   // If NumThreads is not specified, auto-detect a good default.
+  if (NumThreads == 0 && NumShards)
+    NumThreads = std::min(hardware_concurrency().compute_thread_count(),
+                          unsigned(Inputs.size()));
   if (NumThreads == 0)
     NumThreads = std::min(hardware_concurrency().compute_thread_count(),
                           unsigned((Inputs.size() + 1) / 2));
@@ -331,13 +410,31 @@ static void mergeInstrProfile(const WeightedFileVector &Inputs,
   // the merge_empty_profile.test because the InstrProfWriter.ProfileKind isn't
   // merged, thus the emitted file ends up with a PF_Unknown kind.
 
-  // Initialize the writer contexts.
+  // Initialize the writer contexts, one per thread or one per shard.
   SmallVector<std::unique_ptr<WriterContext>, 4> Contexts;
-  for (unsigned I = 0; I < NumThreads; ++I)
+  for (unsigned I = 0; I < (NumShards ? NumShards : NumThreads); ++I)
     Contexts.emplace_back(std::make_unique<WriterContext>(
         OutputSparse, ErrorLock, WriterErrorCodes));
 
-  if (NumThreads == 1) {
+  if (NumShards) {
+    // Every thread loads its inputs into all the shards, which own disjoint
+    // sets of functions. Unlike the merge per thread, the memory thus holds
+    // each function once however many threads there are.
+    ThreadPool Pool(hardware_concurrency(NumThreads));
+    for (const auto &Input : Inputs)
+      Pool.async(loadInputSharded, Input, Remapper,
+                 ArrayRef<std::unique_ptr<WriterContext>>(Contexts));
+    Pool.wait();
+
+    // The functions of the shards are moved into the first one, which takes
+    // no merging of records as they are disjoint. The shards are freed as
+    // they are emptied.
+    for (unsigned I = 1; I < NumShards; ++I) {
+      mergeWriterContexts(Contexts[0].get(), Contexts[I].get());
+      Contexts[I].reset();
+    }
+    Contexts.resize(1);
+  } else if (NumThreads == 1) {
     for (const auto &Input : Inputs)
       loadInput(Input, Remapper, Contexts[0].get());
   } else {
@@ -831,6 +928,12 @@ static int merge_main(int argc, const char *argv[]) {
       cl::desc("Number of merge threads to use (default: autodetect)"));
   cl::alias NumThreadsA("j", cl::desc("Alias for --num-threads"),
                         cl::aliasopt(NumThreads));
+  cl::opt<unsigned> NumShards(
+      "num-shards", cl::init(0),
+      cl::desc("Partition the functions into this many shards shared by the "
+               "merge threads, so that the memory holds the merged profile "
+               "only once (only meaningful for -instr; default: one merge "
+               "per thread, reduced at the end)"));
   cl::opt<std::string> ProfileSymbolListFile(
       "prof-sym-list", cl::init(""),
       cl::desc("Path to file containing the list of function symbols "
@@ -909,7 +1012,8 @@ static int merge_main(int argc, const char *argv[]) {
 
   if (ProfileKind == instr)
     mergeInstrProfile(WeightedInputs, Remapper.get(), OutputFilename,
-                      OutputFormat, OutputSparse, NumThreads, FailureMode);
+                      OutputFormat, OutputSparse, NumThreads, NumShards,
+                      FailureMode);
   else
     mergeSampleProfile(WeightedInputs, Remapper.get(), OutputFilename,
                        OutputFormat, ProfileSymbolListFile, CompressAllSections,
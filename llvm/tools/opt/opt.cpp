@@ -567,6 +567,8 @@ int main(int argc, char **argv) {
   initializeSYCLLowerESIMDLegacyPassPass(Registry);
   initializeESIMDLowerLoadStorePass(Registry);
   initializeESIMDLowerVecArgLegacyPassPass(Registry);
+  initializeSYCLKernelArgFieldElimLegacyPassPass(Registry);
+  initializeSYCLInferAddressSpacesLegacyPassPass(Registry);
 
 #ifdef BUILD_EXAMPLES
   initializeExampleIRTransforms(Registry);
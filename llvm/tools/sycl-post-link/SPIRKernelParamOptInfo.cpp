@@ -15,18 +15,42 @@ namespace {
 
 // Must match the one produced by DeadArgumentElimination
 static constexpr char MetaDataID[] = "spir_kernel_omit_args";
+// Must match the one produced by SYCLKernelArgFieldElim
+static constexpr char FieldsMetaDataID[] = "sycl_kernel_arg_fields";
+
+unsigned getUIntOperand(const llvm::MDNode *MD, unsigned I) {
+  const auto *MDInt = llvm::cast<llvm::ConstantAsMetadata>(MD->getOperand(I));
+  return static_cast<unsigned>(llvm::cast<llvm::ConstantInt>(MDInt->getValue())
+                                   ->getValue()
+                                   .getZExtValue());
+}
 
 } // anonymous namespace
 
 namespace llvm {
 
-void SPIRKernelParamOptInfo::releaseMemory() { clear(); }
+void SPIRKernelParamOptInfo::releaseMemory() {
+  clear();
+  ParamFields.clear();
+}
 
 SPIRKernelParamOptInfo
 SPIRKernelParamOptInfoAnalysis::run(Module &M, ModuleAnalysisManager &AM) {
   SPIRKernelParamOptInfo Res;
 
   for (const Function &F : M) {
+    if (MDNode *FieldsMD = F.getMetadata(FieldsMetaDataID)) {
+      SmallVector<uint32_t, 8> &Fields = Res.ParamFields[F.getName()];
+      for (const MDOperand &Op : FieldsMD->operands()) {
+        const auto *ParamMD = cast<MDNode>(Op);
+        assert(ParamMD->getNumOperands() % 2 == 1 && "malformed field info");
+        Fields.push_back(getUIntOperand(ParamMD, 0));
+        Fields.push_back(ParamMD->getNumOperands() / 2);
+        for (unsigned I = 1; I < ParamMD->getNumOperands(); ++I)
+          Fields.push_back(getUIntOperand(ParamMD, I));
+      }
+    }
+
     MDNode *MD = F.getMetadata(MetaDataID);
     if (!MD)
       continue;
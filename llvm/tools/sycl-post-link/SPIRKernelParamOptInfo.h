@@ -10,10 +10,13 @@
 // been optimized away by the LLVM optimizer. The information is produced by
 // DeadArgumentElimination transformation and stored into a specific metadata
 // attached to kernel functions in a module.
+// For aggregate parameters of which only parts are used, the info also holds
+// the byte ranges kept by SYCLKernelArgFieldElim.
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/PassManager.h"
@@ -26,6 +29,11 @@ using SPIRKernelParamOptInfoBaseTy = DenseMap<StringRef, BitVector>;
 class SPIRKernelParamOptInfo : public SPIRKernelParamOptInfoBaseTy {
 public:
   void releaseMemory();
+
+  // Maps a kernel name to the byte ranges kept for its reduced aggregate
+  // parameters. For each such parameter the list holds its index as emitted
+  // by the FE, the number of ranges, then the offset and size of each range.
+  DenseMap<StringRef, SmallVector<uint32_t, 8>> ParamFields;
 };
 
 class SPIRKernelParamOptInfoAnalysis
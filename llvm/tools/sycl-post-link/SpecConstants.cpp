@@ -11,12 +11,15 @@
 #include "SpecConstants.h"
 
 #include "llvm/ADT/APInt.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/IR/InstIterator.h"
 #include "llvm/IR/Instruction.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MathExtras.h"
 
 using namespace llvm;
 
@@ -42,6 +45,18 @@ constexpr char SPIRV_GET_SPEC_CONST_COMPOSITE[] =
 // IDs of all scalar spec constants included into a composite
 constexpr char SPEC_CONST_SYM_ID_MD_STRING[] = "SYCL_SPEC_CONST_SYM_ID";
 
+// Name of the module-level metadata recording the offsets of the emulated spec
+// constants in the buffer they are loaded from:
+// !sycl.spec_const_buffer_layout = !{!0, !1, ...}
+// !0 = !{!"string-id", i32 <offset>}
+constexpr char SPEC_CONST_BUFFER_LAYOUT_MD_STRING[] =
+    "sycl.spec_const_buffer_layout";
+// Name of the kernel metadata describing the implicit argument which takes the
+// emulated spec constants buffer: !{i32 <argument index>, i32 <buffer size>}
+constexpr char SPEC_CONST_BUFFER_ARG_MD_STRING[] = "sycl_spec_const_buffer";
+// Name of the type of the emulated spec constants buffer.
+constexpr char SPEC_CONST_BUFFER_TYPE_NAME[] = "struct.__sycl_spec_const_buffer";
+
 void AssertRelease(bool Cond, const char *Msg) {
   if (!Cond)
     report_fatal_error((Twine("SpecConstants.cpp: ") + Msg).str().c_str());
@@ -385,6 +400,217 @@ Instruction *emitSpecConstantRecursive(Type *Ty, Instruction *InsertBefore,
   return emitSpecConstantRecursiveImpl(Ty, InsertBefore, IDs, Index);
 }
 
+bool isSpecConstIntrinsic(const Function &F) {
+  return F.isDeclaration() &&
+         (F.getName().startswith(SYCL_GET_SPEC_CONST_VAL) ||
+          F.getName().startswith(SYCL_GET_COMPOSITE_SPEC_CONST_VAL));
+}
+
+// Returns the type of the spec constant the intrinsic call queries, and the
+// index of the argument with its symbolic ID.
+std::pair<Type *, unsigned> getSpecConstTypeAndNameArgNo(const CallInst *CI) {
+  if (!CI->getCalledFunction()->getName().startswith(
+          SYCL_GET_COMPOSITE_SPEC_CONST_VAL))
+    return std::make_pair(CI->getType(), 0u);
+  // structs are returned via sret arguments.
+  auto *PtrTy = cast<PointerType>(CI->getArgOperand(0)->getType());
+  return std::make_pair(PtrTy->getElementType(), 1u);
+}
+
+// Assigns the spec constants queried in the module their offsets in the
+// emulated spec constants buffer and returns the buffer size.
+unsigned layOutSpecConstBuffer(Module &M, StringMap<unsigned> &Offsets) {
+  const DataLayout &DL = M.getDataLayout();
+  unsigned Size = 0;
+
+  for (Function &F : M) {
+    if (!isSpecConstIntrinsic(F))
+      continue;
+    for (auto *U : F.users()) {
+      auto *CI = dyn_cast<CallInst>(U);
+      if (!CI)
+        continue;
+      Type *SCTy;
+      unsigned NameArgNo;
+      std::tie(SCTy, NameArgNo) = getSpecConstTypeAndNameArgNo(CI);
+      SmallVector<Instruction *, 3> Unused;
+      StringRef SymID = getStringLiteralArg(CI, NameArgNo, Unused);
+      if (Offsets.count(SymID))
+        continue;
+      unsigned Offset = alignTo(Size, DL.getABITypeAlignment(SCTy));
+      Offsets[SymID] = Offset;
+      Size = Offset + DL.getTypeAllocSize(SCTy);
+    }
+  }
+  return Size;
+}
+
+// Appends a metadata operand for a new kernel argument to each of the
+// kernel_arg_* metadata of the kernel, so that they keep matching the kernel
+// signature.
+void extendKernelArgMetadata(Function &F) {
+  SmallVector<std::pair<unsigned, MDNode *>, 8> MDs;
+  F.getAllMetadata(MDs);
+  LLVMContext &Ctx = F.getContext();
+  SmallVector<StringRef, 16> MDNames;
+  Ctx.getMDKindNames(MDNames);
+
+  for (const auto &MD : MDs) {
+    StringRef Name = MDNames[MD.first];
+    if (!Name.startswith("kernel_arg_") || MD.second->getNumOperands() == 0)
+      continue;
+    SmallVector<Metadata *, 8> Ops(MD.second->op_begin(),
+                                   MD.second->op_end());
+    Metadata *Last = Ops.back();
+    if (isa<MDString>(Last)) {
+      Ops.push_back(MDString::get(Ctx, Name == "kernel_arg_type" ||
+                                               Name == "kernel_arg_base_type"
+                                           ? "char*"
+                                           : ""));
+    } else if (auto *C = dyn_cast<ConstantAsMetadata>(Last)) {
+      // Buffer location -1 designates the absence of one.
+      int64_t Val = Name == "kernel_arg_buffer_location" ? -1 : 0;
+      Ops.push_back(ConstantAsMetadata::get(
+          ConstantInt::get(C->getValue()->getType(), Val, /*isSigned=*/true)));
+    } else {
+      continue;
+    }
+    F.setMetadata(MD.first, MDNode::get(Ctx, Ops));
+  }
+}
+
+// Appends a parameter to each function which queries spec constants directly
+// or through its callees. Kernels take the emulated spec constants buffer by
+// value, other functions take a pointer to it, which is passed down through
+// all call chains from the kernels. Returns the pointer to the buffer within
+// each of the new functions.
+DenseMap<Function *, Value *>
+addSpecConstBufferParams(Module &M, unsigned BufferSize) {
+  LLVMContext &Ctx = M.getContext();
+  SetVector<Function *> Funcs;
+
+  for (Function &F : M) {
+    if (!isSpecConstIntrinsic(F))
+      continue;
+    for (auto *U : F.users())
+      if (auto *CI = dyn_cast<CallInst>(U))
+        Funcs.insert(CI->getFunction());
+  }
+  for (unsigned I = 0; I < Funcs.size(); ++I) {
+    Function *F = Funcs[I];
+    if (F->getCallingConv() == CallingConv::SPIR_KERNEL)
+      continue;
+    for (User *U : F->users()) {
+      auto *CI = dyn_cast<CallInst>(U);
+      AssertRelease(CI && CI->getCalledFunction() == F,
+                    "spec constants emulation does not support functions "
+                    "using spec constants to be called indirectly");
+      Funcs.insert(CI->getFunction());
+    }
+  }
+
+  auto *BufferTy = StructType::create(
+      {ArrayType::get(Type::getInt8Ty(Ctx), std::max(BufferSize, 1u))},
+      SPEC_CONST_BUFFER_TYPE_NAME);
+  auto *BufferPtrTy = Type::getInt8PtrTy(Ctx);
+  DenseMap<Function *, Function *> NewFuncs;
+  DenseMap<Function *, Value *> BufferPtrs;
+
+  for (Function *F : Funcs) {
+    const bool IsKernel = F->getCallingConv() == CallingConv::SPIR_KERNEL;
+    const unsigned ArgNo = F->arg_size();
+    SmallVector<Type *, 8> Params(F->getFunctionType()->param_begin(),
+                                  F->getFunctionType()->param_end());
+    Params.push_back(IsKernel ? PointerType::getUnqual(BufferTy)
+                              : BufferPtrTy);
+    auto *NFTy = FunctionType::get(F->getReturnType(), Params,
+                                   F->getFunctionType()->isVarArg());
+    Function *NF = Function::Create(NFTy, F->getLinkage(),
+                                    F->getAddressSpace(), "", &M);
+    M.getFunctionList().remove(NF);
+    M.getFunctionList().insert(F->getIterator(), NF);
+    NF->copyAttributesFrom(F);
+    NF->setComdat(F->getComdat());
+    NF->copyMetadata(F, 0);
+    NF->takeName(F);
+    NF->getBasicBlockList().splice(NF->begin(), F->getBasicBlockList());
+
+    for (auto I = F->arg_begin(), J = NF->arg_begin(); I != F->arg_end();
+         ++I, ++J) {
+      I->replaceAllUsesWith(&*J);
+      J->takeName(&*I);
+    }
+    Argument *BufferArg = NF->getArg(ArgNo);
+    if (IsKernel) {
+      BufferArg->setName("_arg__sycl_spec_const_buffer");
+      NF->addParamAttr(ArgNo, Attribute::getWithByValType(Ctx, BufferTy));
+      NF->addParamAttr(ArgNo, Attribute::getWithAlignment(Ctx, Align(8)));
+      extendKernelArgMetadata(*NF);
+      Type *I32Ty = Type::getInt32Ty(Ctx);
+      Metadata *MDOps[] = {
+          ConstantAsMetadata::get(ConstantInt::get(I32Ty, ArgNo)),
+          ConstantAsMetadata::get(ConstantInt::get(I32Ty, BufferSize))};
+      NF->setMetadata(SPEC_CONST_BUFFER_ARG_MD_STRING,
+                      MDNode::get(Ctx, MDOps));
+      BufferPtrs[NF] =
+          new BitCastInst(BufferArg, BufferPtrTy, "",
+                          &*NF->getEntryBlock().getFirstInsertionPt());
+    } else {
+      BufferArg->setName("__sycl_spec_const_buffer");
+      BufferPtrs[NF] = BufferArg;
+    }
+    NewFuncs[F] = NF;
+  }
+
+  // Now that all the functions have the new parameter, pass the buffer
+  // pointer along at every call site.
+  for (const auto &FuncPair : NewFuncs) {
+    Function *F = FuncPair.first;
+    Function *NF = FuncPair.second;
+    SmallVector<CallInst *, 8> Calls;
+    for (User *U : F->users())
+      if (auto *CI = dyn_cast<CallInst>(U))
+        Calls.push_back(CI);
+
+    for (CallInst *CI : Calls) {
+      SmallVector<Value *, 8> Args(CI->arg_begin(), CI->arg_end());
+      Args.push_back(BufferPtrs[CI->getFunction()]);
+      SmallVector<OperandBundleDef, 1> Bundles;
+      CI->getOperandBundlesAsDefs(Bundles);
+      CallInst *NewCI = CallInst::Create(NF, Args, Bundles, "", CI);
+      NewCI->setCallingConv(CI->getCallingConv());
+      NewCI->setAttributes(CI->getAttributes());
+      NewCI->setTailCallKind(CI->getTailCallKind());
+      NewCI->setDebugLoc(CI->getDebugLoc());
+      CI->replaceAllUsesWith(NewCI);
+      NewCI->takeName(CI);
+      CI->eraseFromParent();
+    }
+    // Kernels may still be referenced, e.g. by llvm.used.
+    if (!F->use_empty())
+      F->replaceAllUsesWith(ConstantExpr::getBitCast(NF, F->getType()));
+    F->eraseFromParent();
+  }
+  return BufferPtrs;
+}
+
+// Emits a load of the spec constant of given type from given offset in the
+// emulated spec constants buffer.
+Instruction *emitSpecConstBufferLoad(Type *Ty, Value *BufferPtr,
+                                     unsigned Offset,
+                                     Instruction *InsertBefore) {
+  LLVMContext &Ctx = InsertBefore->getContext();
+  Value *Idx = ConstantInt::get(Type::getInt32Ty(Ctx), Offset);
+  Value *GEP = GetElementPtrInst::CreateInBounds(
+      Type::getInt8Ty(Ctx), BufferPtr, Idx, "", InsertBefore);
+  Value *Ptr = new BitCastInst(
+      GEP, PointerType::get(Ty, BufferPtr->getType()->getPointerAddressSpace()),
+      "", InsertBefore);
+  // The buffer is byte-aligned as far as the kernel knows.
+  return new LoadInst(Ty, Ptr, "", /*isVolatile=*/false, Align(1),
+                      InsertBefore);
+}
+
 } // namespace
 
 PreservedAnalyses SpecConstantsPass::run(Module &M,
@@ -392,18 +618,35 @@ PreservedAnalyses SpecConstantsPass::run(Module &M,
   unsigned NextID = 0;
   StringMap<SmallVector<unsigned, 1>> IDMap;
 
+  // In the emulation mode, lay the buffer out and give all the functions on
+  // the way from kernels to the spec constants a pointer to it first.
+  StringMap<unsigned> BufferOffsets;
+  DenseMap<Function *, Value *> BufferPtrs;
+  if (Mode == HandlingMode::emulation) {
+    unsigned BufferSize = layOutSpecConstBuffer(M, BufferOffsets);
+    if (!BufferOffsets.empty()) {
+      BufferPtrs = addSpecConstBufferParams(M, BufferSize);
+      LLVMContext &Ctx = M.getContext();
+      NamedMDNode *LayoutMD =
+          M.getOrInsertNamedMetadata(SPEC_CONST_BUFFER_LAYOUT_MD_STRING);
+      for (const auto &Entry : BufferOffsets) {
+        Metadata *MDOps[] = {
+            MDString::get(Ctx, Entry.getKey()),
+            ConstantAsMetadata::get(
+                ConstantInt::get(Type::getInt32Ty(Ctx), Entry.getValue()))};
+        LayoutMD->addOperand(MDNode::get(Ctx, MDOps));
+      }
+    }
+  }
+
   // Iterate through all declarations of instances of function template
   // template <typename T> T __sycl_getSpecConstantValue(const char *ID)
-  // intrinsic to find its calls and lower them depending on the SetValAtRT
-  // setting (see below).
+  // intrinsic to find its calls and lower them depending on the Mode setting
+  // (see below).
   bool IRModified = false;
 
   for (Function &F : M) {
-    if (!F.isDeclaration())
-      continue;
-
-    if (!F.getName().startswith(SYCL_GET_SPEC_CONST_VAL) &&
-        !F.getName().startswith(SYCL_GET_COMPOSITE_SPEC_CONST_VAL))
+    if (!isSpecConstIntrinsic(F))
       continue;
 
     SmallVector<CallInst *, 32> SCIntrCalls;
@@ -424,16 +667,12 @@ PreservedAnalyses SpecConstantsPass::run(Module &M,
 
       SmallVector<Instruction *, 3> DelInsts;
       DelInsts.push_back(CI);
-      Type *SCTy = CI->getType();
-      unsigned NameArgNo = 0;
-      if (IsComposite) { // structs are returned via sret arguments.
-        NameArgNo = 1;
-        auto *PtrTy = cast<PointerType>(CI->getArgOperand(0)->getType());
-        SCTy = PtrTy->getElementType();
-      }
+      Type *SCTy;
+      unsigned NameArgNo;
+      std::tie(SCTy, NameArgNo) = getSpecConstTypeAndNameArgNo(CI);
       StringRef SymID = getStringLiteralArg(CI, NameArgNo, DelInsts);
 
-      if (SetValAtRT) {
+      if (Mode == HandlingMode::native) {
         // 2. Spec constant value will be set at run time - then add the literal
         // to a "spec const string literal ID" -> "integer ID" map or
         // "composite spec const string literal ID" -> "vector of integer IDs"
@@ -481,8 +720,17 @@ PreservedAnalyses SpecConstantsPass::run(Module &M,
         // %3 = call <2 x i32> @_Z29__spirv_SpecConstantCompositeii(i32 \
         //          %1, i32 %2), !SYCL_SPEC_CONST_SYM_ID !23
         // !23 = {!"string-id-2", i32 3, i32 4}
+      } else if (Mode == HandlingMode::emulation) {
+        // 2a. Spec constant value is set at kernel launch - load it from the
+        // buffer the kernel takes.
+        Value *Val = emitSpecConstBufferLoad(
+            SCTy, BufferPtrs[CI->getFunction()], BufferOffsets[SymID], CI);
+        if (IsComposite)
+          new StoreInst(Val, CI->getArgOperand(0), CI);
+        else
+          CI->replaceAllUsesWith(Val);
       } else {
-        // 2a. Spec constant must be resolved at compile time - just replace
+        // 2b. Spec constant must be resolved at compile time - just replace
         // the intrinsic with default C++ value for the spec constant type.
         Value *Default = getDefaultCPPValue(SCTy);
         if (IsComposite) {
@@ -539,3 +787,27 @@ bool SpecConstantsPass::collectSpecConstantMetadata(
 
   return Met;
 }
+
+bool SpecConstantsPass::collectSpecConstBufferMetadata(
+    Module &M, SpecConstBufferLayoutTy &Layout,
+    KernelSpecConstBufferMapTy &KernelArgs) {
+  auto getUInt = [](const MDOperand &Op) {
+    return static_cast<unsigned>(
+        mdconst::extract<ConstantInt>(Op)->getZExtValue());
+  };
+
+  if (NamedMDNode *LayoutMD =
+          M.getNamedMetadata(SPEC_CONST_BUFFER_LAYOUT_MD_STRING))
+    for (const MDNode *Entry : LayoutMD->operands())
+      Layout[cast<MDString>(Entry->getOperand(0))->getString()] =
+          getUInt(Entry->getOperand(1));
+
+  for (Function &F : M) {
+    if (F.isDeclaration() || F.getCallingConv() != CallingConv::SPIR_KERNEL)
+      continue;
+    if (const MDNode *ArgMD = F.getMetadata(SPEC_CONST_BUFFER_ARG_MD_STRING))
+      KernelArgs[F.getName()] = {getUInt(ArgMD->getOperand(0)),
+                                 getUInt(ArgMD->getOperand(1))};
+  }
+  return !KernelArgs.empty();
+}
@@ -42,13 +42,35 @@ struct CompositeSpecConstElementDescriptor {
 };
 using CompositeSpecIDMapTy =
     std::map<StringRef, std::vector<CompositeSpecConstElementDescriptor>>;
+// Maps spec constant names to their offsets in the buffer emulated spec
+// constants are loaded from.
+using SpecConstBufferLayoutTy = std::map<StringRef, unsigned>;
+// Describes the implicit kernel argument taking the emulated spec constants
+// buffer.
+struct SpecConstBufferArgDescriptor {
+  // Index of the argument.
+  unsigned Index;
+  // Size of the buffer.
+  unsigned Size;
+};
+using KernelSpecConstBufferMapTy =
+    std::map<StringRef, SpecConstBufferArgDescriptor>;
 
 class SpecConstantsPass : public PassInfoMixin<SpecConstantsPass> {
 public:
-  // SetValAtRT parameter controls spec constant lowering mode:
-  // - if true, it is lowered to SPIRV intrinsic which retrieves constant value
-  // - if false, it is replaced with C++ default (used for AOT compilers)
-  SpecConstantsPass(bool SetValAtRT = true) : SetValAtRT(SetValAtRT) {}
+  enum class HandlingMode {
+    // Spec constants are lowered to SPIRV intrinsics which retrieve constant
+    // values.
+    native,
+    // Spec constants are replaced with C++ defaults (used for AOT compilers).
+    default_values,
+    // Spec constants are lowered to loads from a buffer the kernels take by
+    // value as an implicit trailing argument, so that the runtime can set
+    // their values at kernel launch (used for AOT compilers).
+    emulation
+  };
+
+  SpecConstantsPass(HandlingMode Mode = HandlingMode::native) : Mode(Mode) {}
   PreservedAnalyses run(Module &M, ModuleAnalysisManager &MAM);
 
   // Searches given module for occurences of specialization constant-specific
@@ -61,6 +83,13 @@ public:
                                           ScalarSpecIDMapTy &ScalarIDMap,
                                           CompositeSpecIDMapTy &CompositeIDMap);
 
+  // Searches given module for the metadata left by the emulation mode and
+  // builds a "spec constant name" -> "offset in the buffer" map and a
+  // "kernel name" -> "buffer argument" map for the kernels of the module.
+  static bool
+  collectSpecConstBufferMetadata(Module &M, SpecConstBufferLayoutTy &Layout,
+                                 KernelSpecConstBufferMapTy &KernelArgs);
+
 private:
-  bool SetValAtRT;
+  HandlingMode Mode;
 };
@@ -11,13 +11,16 @@
 // utilities are:
 // - module splitter to split a big input module into smaller ones
 // - specialization constant intrinsic transformation
+// - optional in-process translation of the output modules to SPIR-V
 //===----------------------------------------------------------------------===//
 
 #include "SPIRKernelParamOptInfo.h"
 #include "SpecConstants.h"
 
 #include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/Bitcode/BitcodeWriterPass.h"
 #include "llvm/IR/IRPrintingPasses.h"
 #include "llvm/IR/InstIterator.h"
@@ -28,15 +31,23 @@
 #include "llvm/IRReader/IRReader.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/PropertySetIO.h"
 #include "llvm/Support/SimpleTable.h"
 #include "llvm/Support/SystemUtils.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/IPO/GlobalDCE.h"
 #include "llvm/Transforms/Utils/Cloning.h"
 
+#ifdef SYCL_POST_LINK_ENABLE_SPIRV
+#include "LLVMSPIRVLib.h"
+#endif // SYCL_POST_LINK_ENABLE_SPIRV
+
+#include <climits>
+#include <fstream>
 #include <memory>
 
 using namespace llvm;
@@ -51,6 +62,12 @@ static constexpr char COL_CODE[] = "Code";
 static constexpr char COL_SYM[] = "Symbols";
 static constexpr char COL_PROPS[] = "Properties";
 static constexpr char DEVICELIB_FUNC_PREFIX[] = "__devicelib_";
+// Must match the metadata written by clang-offload-deps -sycl-kernel-gc.
+static constexpr char UNREFERENCED_KERNELS_MD[] = "sycl.unreferenced.kernels";
+static constexpr char ESIMD_MARKER_MD[] = "sycl_explicit_simd";
+static constexpr char REQD_SUB_GROUP_SIZE_MD[] = "intel_reqd_sub_group_size";
+static constexpr char ATTR_SUB_GROUP_SIZE_VARIANT_OF[] =
+    "sycl-sub-group-size-variant-of";
 
 // DeviceLibExt is shared between sycl-post-link tool and sycl runtime.
 // If any change is made here, need to sync with DeviceLibExt definition
@@ -89,8 +106,9 @@ static cl::opt<bool> OutputAssembly{"S",
                                     cl::Hidden, cl::cat(PostLinkCat)};
 
 enum IRSplitMode {
-  SPLIT_PER_TU,    // one module per translation unit
-  SPLIT_PER_KERNEL // one module per kernel
+  SPLIT_PER_TU,     // one module per translation unit
+  SPLIT_PER_KERNEL, // one module per kernel
+  SPLIT_BY_SIZE     // kernels sharing code grouped into size-bounded modules
 };
 
 static cl::opt<IRSplitMode> SplitMode(
@@ -99,14 +117,41 @@ static cl::opt<IRSplitMode> SplitMode(
     cl::values(clEnumValN(SPLIT_PER_TU, "source",
                           "1 output module per source (translation unit)"),
                clEnumValN(SPLIT_PER_KERNEL, "kernel",
-                          "1 output module per kernel")),
+                          "1 output module per kernel"),
+               clEnumValN(SPLIT_BY_SIZE, "size",
+                          "output modules of kernels sharing code, each "
+                          "limited by -split-size-limit")),
     cl::cat(PostLinkCat));
 
+static cl::opt<bool> SplitEsimd{
+    "split-esimd",
+    cl::desc("put the ESIMD kernels and the SYCL kernels in separate output "
+             "modules"),
+    cl::cat(PostLinkCat)};
+
+static cl::list<unsigned> SubGroupSizeVariants{
+    "sub-group-size-variants", cl::CommaSeparated,
+    cl::desc("sub-group sizes to compile a variant of each kernel with no "
+             "required sub-group size for; the runtime picks one per device"),
+    cl::cat(PostLinkCat)};
+
+static cl::opt<unsigned> SplitSizeLimit{
+    "split-size-limit",
+    cl::desc("target size of an output module in LLVM IR instructions for "
+             "-split=size; kernels bigger than that get their own module"),
+    cl::init(20000), cl::cat(PostLinkCat)};
+
+static cl::opt<unsigned> NumThreads{
+    "threads",
+    cl::desc("number of threads to split and save output modules with; 0 "
+             "means the number of hardware threads"),
+    cl::init(0), cl::cat(PostLinkCat)};
+
 static cl::opt<bool> DoSymGen{"symbols",
                               cl::desc("generate exported symbol files"),
                               cl::cat(PostLinkCat)};
 
-enum SpecConstMode { SC_USE_RT_VAL, SC_USE_DEFAULT_VAL };
+enum SpecConstMode { SC_USE_RT_VAL, SC_USE_DEFAULT_VAL, SC_USE_EMULATION };
 
 static cl::opt<SpecConstMode> SpecConstLower{
     "spec-const",
@@ -116,19 +161,41 @@ static cl::opt<SpecConstMode> SpecConstLower{
     cl::values(
         clEnumValN(SC_USE_RT_VAL, "rt", "spec constants are set at runtime"),
         clEnumValN(SC_USE_DEFAULT_VAL, "default",
-                   "set spec constants to C++ defaults")),
+                   "set spec constants to C++ defaults"),
+        clEnumValN(SC_USE_EMULATION, "emulation",
+                   "spec constants are passed to kernels at runtime in an "
+                   "implicit argument")),
     cl::cat(PostLinkCat)};
 
 static cl::opt<bool> EmitKernelParamInfo{
     "emit-param-info", cl::desc("emit kernel parameter optimization info"),
     cl::cat(PostLinkCat)};
 
+static cl::opt<bool> EmitSPIRV{
+    "emit-spirv",
+    cl::desc("translate the output modules to SPIR-V in process instead of "
+             "saving them as LLVM IR"),
+    cl::cat(PostLinkCat)};
+
+static cl::list<std::string> SPIRVExt{
+    "spirv-ext", cl::CommaSeparated,
+    cl::desc("SPIR-V extensions allowed with -emit-spirv, in the format of "
+             "llvm-spirv: +all,-EXT_NAME (default: +all)"),
+    cl::cat(PostLinkCat)};
+
+static cl::opt<bool> SPIRVAllowUnknownIntrinsics{
+    "spirv-allow-unknown-intrinsics",
+    cl::desc("translate unknown LLVM intrinsics to function calls with "
+             "-emit-spirv"),
+    cl::cat(PostLinkCat)};
+
 struct ImagePropSaveInfo {
   bool NeedDeviceLibReqMask;
   bool DoSpecConst;
   bool SetSpecConstAtRT;
   bool SpecConstsMet;
   bool EmitKernelParamInfo;
+  bool EmulateSpecConsts;
 };
 // Please update DeviceLibFuncMap if any item is added to or removed from
 // fallback device libraries in libdevice.
@@ -281,14 +348,131 @@ static void writeToFile(std::string Filename, std::string Content) {
   OS.close();
 }
 
+// Each fallback device library corresponds to one bit in "require mask" which
+// is an unsigned int32. getDeviceLibBit checks which fallback device library
+// is required for FuncName and returns the corresponding bit. The corresponding
+// mask for each fallback device library is:
+// fallback-cassert:      0x1
+// fallback-cmath:        0x2
+// fallback-cmath-fp64:   0x4
+// fallback-complex:      0x8
+// fallback-complex-fp64: 0x10
+static uint32_t getDeviceLibBits(const std::string &FuncName) {
+  auto DeviceLibFuncIter = DeviceLibFuncMap.find(FuncName);
+  return ((DeviceLibFuncIter == DeviceLibFuncMap.end())
+              ? 0
+              : 0x1 << (static_cast<uint32_t>(DeviceLibFuncIter->second) -
+                        static_cast<uint32_t>(
+                            DeviceLibExt::cl_intel_devicelib_assert)));
+}
+
 // Describes scope covered by each entry in the module-kernel map populated by
 // the collectKernelModuleMap function.
 enum KernelMapEntryScope {
   Scope_PerKernel, // one entry per kernel
   Scope_PerModule, // one entry per module
+  Scope_PerGroup,  // one entry per size-bounded group of kernels
   Scope_Global     // single entry in the map for all kernels
 };
 
+// Collects the kernels along with all functions they call directly or
+// indirectly into GVs.
+static void collectCallGraph(ArrayRef<Function *> Kernels,
+                             SetVector<const GlobalValue *> &GVs) {
+  std::vector<llvm::Function *> Workqueue;
+
+  for (auto &F : Kernels) {
+    GVs.insert(F);
+    Workqueue.push_back(F);
+  }
+
+  while (!Workqueue.empty()) {
+    Function *F = &*Workqueue.back();
+    Workqueue.pop_back();
+    for (auto &I : instructions(F)) {
+      if (CallBase *CB = dyn_cast<CallBase>(&I))
+        if (Function *CF = CB->getCalledFunction())
+          if (!CF->isDeclaration() && !GVs.count(CF)) {
+            GVs.insert(CF);
+            Workqueue.push_back(CF);
+          }
+    }
+  }
+}
+
+// Groups kernels of M into modules of at most SplitSizeLimit instructions,
+// counting a function called from several kernels of a group once. Each
+// kernel goes to the group it shares most code with among those it still fits
+// in. Only kernels requiring the same fallback device libraries are grouped
+// together, so that no module pulls in libraries most of its kernels don't
+// need.
+static void collectKernelGroups(
+    Module &M,
+    std::map<StringRef, std::vector<Function *>> &ResKernelModuleMap) {
+  struct KernelGroup {
+    uint32_t ReqMask;
+    size_t Size = 0;
+    SmallPtrSet<const GlobalValue *, 32> Functions;
+    std::vector<Function *> Kernels;
+  };
+  std::vector<KernelGroup> Groups;
+
+  for (auto &F : M.functions()) {
+    if (F.getCallingConv() != CallingConv::SPIR_KERNEL)
+      continue;
+
+    SetVector<const GlobalValue *> CallGraph;
+    collectCallGraph({&F}, CallGraph);
+    uint32_t ReqMask = 0;
+    for (const GlobalValue *GV : CallGraph)
+      for (const auto &I : instructions(cast<Function>(GV)))
+        if (const auto *CB = dyn_cast<CallBase>(&I))
+          if (const Function *CF = CB->getCalledFunction())
+            if (CF->isDeclaration() &&
+                CF->getName().startswith(DEVICELIB_FUNC_PREFIX))
+              ReqMask |= getDeviceLibBits(CF->getName().str());
+
+    KernelGroup *Best = nullptr;
+    size_t BestShared = 0;
+    size_t BestSize = 0;
+    for (KernelGroup &G : Groups) {
+      if (G.ReqMask != ReqMask)
+        continue;
+      size_t Shared = 0;
+      size_t Added = 0;
+      for (const GlobalValue *GV : CallGraph) {
+        size_t Size = cast<Function>(GV)->getInstructionCount();
+        if (G.Functions.count(GV))
+          Shared += Size;
+        else
+          Added += Size;
+      }
+      if (G.Size + Added > SplitSizeLimit)
+        continue;
+      if (!Best || Shared > BestShared) {
+        Best = &G;
+        BestShared = Shared;
+        BestSize = G.Size + Added;
+      }
+    }
+    if (!Best) {
+      Groups.emplace_back();
+      Best = &Groups.back();
+      Best->ReqMask = ReqMask;
+      BestSize = 0;
+      for (const GlobalValue *GV : CallGraph)
+        BestSize += cast<Function>(GV)->getInstructionCount();
+    }
+    Best->Size = BestSize;
+    Best->Functions.insert(CallGraph.begin(), CallGraph.end());
+    Best->Kernels.push_back(&F);
+  }
+
+  // The name of the first kernel is a unique and stable key for a group.
+  for (KernelGroup &G : Groups)
+    ResKernelModuleMap[G.Kernels.front()->getName()] = std::move(G.Kernels);
+}
+
 // This function decides how kernels of the input module M will be distributed
 // ("split") into multiple modules based on the command options and IR
 // attributes. The decision is recorded in the output map parameter
@@ -298,6 +482,10 @@ enum KernelMapEntryScope {
 static void collectKernelModuleMap(
     Module &M, std::map<StringRef, std::vector<Function *>> &ResKernelModuleMap,
     KernelMapEntryScope EntryScope) {
+  if (EntryScope == Scope_PerGroup) {
+    collectKernelGroups(M, ResKernelModuleMap);
+    return;
+  }
 
   for (auto &F : M.functions()) {
     if (F.getCallingConv() == CallingConv::SPIR_KERNEL) {
@@ -331,6 +519,77 @@ static void collectKernelModuleMap(
   }
 }
 
+static bool isESIMDKernel(const Function &F) {
+  return F.getCallingConv() == CallingConv::SPIR_KERNEL &&
+         F.getMetadata(ESIMD_MARKER_MD);
+}
+
+// Moves the ESIMD kernels of every group of ResKernelModuleMap which also has
+// SYCL kernels to a group of their own. The two kinds of kernels are compiled
+// by different back-ends, so they can't share a device image.
+static void splitESIMDKernels(
+    std::map<StringRef, std::vector<Function *>> &ResKernelModuleMap) {
+  std::map<StringRef, std::vector<Function *>> Res;
+  for (auto &It : ResKernelModuleMap) {
+    std::vector<Function *> SYCLKernels;
+    std::vector<Function *> ESIMDKernels;
+    for (Function *F : It.second)
+      (isESIMDKernel(*F) ? ESIMDKernels : SYCLKernels).push_back(F);
+    if (SYCLKernels.empty() || ESIMDKernels.empty()) {
+      Res[It.first] = std::move(It.second);
+      continue;
+    }
+    // Kernel names are unique, so the name of a kernel of a group is a key no
+    // other group has.
+    StringRef ESIMDKey = ESIMDKernels.front()->getName();
+    StringRef SYCLKey =
+        It.first == ESIMDKey ? SYCLKernels.front()->getName() : It.first;
+    Res[SYCLKey] = std::move(SYCLKernels);
+    Res[ESIMDKey] = std::move(ESIMDKernels);
+  }
+  ResKernelModuleMap = std::move(Res);
+}
+
+// Returns the name of the variant of the kernel requiring the sub-group size.
+// Must be kept in sync with the SYCL runtime.
+static std::string getSubGroupSizeVariantName(StringRef KernelName,
+                                              unsigned Size) {
+  return (KernelName + "__sg" + Twine(Size)).str();
+}
+
+// Adds to every group of ResKernelModuleMap a clone of each of its kernels
+// with no required sub-group size for every size of -sub-group-size-variants,
+// the clone requiring that size. The variants stay in the group of their
+// kernel, so the runtime can pick one from the program it builds for the
+// kernel without building another one. Returns true if any variant is added.
+static bool addSubGroupSizeVariants(
+    Module &M,
+    std::map<StringRef, std::vector<Function *>> &ResKernelModuleMap) {
+  bool VariantsAdded = false;
+  Type *Int32Ty = Type::getInt32Ty(M.getContext());
+  for (auto &It : ResKernelModuleMap) {
+    std::vector<Function *> Variants;
+    for (Function *F : It.second) {
+      if (F->isDeclaration() || F->getMetadata(REQD_SUB_GROUP_SIZE_MD))
+        continue;
+      for (unsigned Size : SubGroupSizeVariants) {
+        ValueToValueMapTy VMap;
+        Function *Variant = CloneFunction(F, VMap);
+        Variant->setName(getSubGroupSizeVariantName(F->getName(), Size));
+        Variant->setMetadata(
+            REQD_SUB_GROUP_SIZE_MD,
+            MDNode::get(M.getContext(), ConstantAsMetadata::get(
+                                            ConstantInt::get(Int32Ty, Size))));
+        Variant->addFnAttr(ATTR_SUB_GROUP_SIZE_VARIANT_OF, F->getName());
+        Variants.push_back(Variant);
+      }
+    }
+    VariantsAdded |= !Variants.empty();
+    It.second.insert(It.second.end(), Variants.begin(), Variants.end());
+  }
+  return VariantsAdded;
+}
+
 // Input parameter KernelModuleMap is a map containing groups of kernels with
 // same values of the sycl-module-id attribute. ResSymbolsLists is a vector of
 // kernel name lists. Each vector element is a string with kernel names from the
@@ -350,6 +609,39 @@ static void collectSymbolsLists(
   }
 }
 
+// Produces a module containing the Kernels of M along with all IR they depend
+// on (globals, functions from their call graph,...).
+static std::unique_ptr<Module> extractKernels(Module &M,
+                                              ArrayRef<Function *> Kernels) {
+  // Collect all dependencies of the kernels.
+  SetVector<const GlobalValue *> GVs;
+  collectCallGraph(Kernels, GVs);
+
+  // It's not easy to trace global variable's uses inside needed functions
+  // because global variable can be used inside a combination of operators, so
+  // mark all global variables as needed and remove dead ones after
+  // cloning.
+  for (auto &G : M.globals()) {
+    GVs.insert(&G);
+  }
+
+  ValueToValueMapTy VMap;
+  // Clone definitions only for needed globals. Others will be added as
+  // declarations and removed later.
+  std::unique_ptr<Module> MClone = CloneModule(
+      M, VMap, [&](const GlobalValue *GV) { return GVs.count(GV); });
+
+  // TODO: Use the new PassManager instead?
+  legacy::PassManager Passes;
+  // Do cleanup.
+  Passes.add(createGlobalDCEPass());           // Delete unreachable globals.
+  Passes.add(createStripDeadDebugInfoPass());  // Remove dead debug info.
+  Passes.add(createStripDeadPrototypesPass()); // Remove dead func decls.
+  Passes.run(*MClone.get());
+
+  return MClone;
+}
+
 // Input parameter KernelModuleMap is a map containing groups of kernels with
 // same values of the sycl-module-id attribute. For each group of kernels a
 // separate IR module will be produced.
@@ -360,54 +652,42 @@ static void
 splitModule(Module &M,
             std::map<StringRef, std::vector<Function *>> &KernelModuleMap,
             std::vector<std::unique_ptr<Module>> &ResModules) {
-  for (auto &It : KernelModuleMap) {
-    // For each group of kernels collect all dependencies.
-    SetVector<const GlobalValue *> GVs;
-    std::vector<llvm::Function *> Workqueue;
-
-    for (auto &F : It.second) {
-      GVs.insert(F);
-      Workqueue.push_back(F);
-    }
-
-    while (!Workqueue.empty()) {
-      Function *F = &*Workqueue.back();
-      Workqueue.pop_back();
-      for (auto &I : instructions(F)) {
-        if (CallBase *CB = dyn_cast<CallBase>(&I))
-          if (Function *CF = CB->getCalledFunction())
-            if (!CF->isDeclaration() && !GVs.count(CF)) {
-              GVs.insert(CF);
-              Workqueue.push_back(CF);
-            }
-      }
-    }
-
-    // It's not easy to trace global variable's uses inside needed functions
-    // because global variable can be used inside a combination of operators, so
-    // mark all global variables as needed and remove dead ones after
-    // cloning.
-    for (auto &G : M.globals()) {
-      GVs.insert(&G);
-    }
+  for (auto &It : KernelModuleMap)
+    ResModules.push_back(extractKernels(M, It.second));
+}
 
-    ValueToValueMapTy VMap;
-    // Clone definitions only for needed globals. Others will be added as
-    // declarations and removed later.
-    std::unique_ptr<Module> MClone = CloneModule(
-        M, VMap, [&](const GlobalValue *GV) { return GVs.count(GV); });
+// Removes the kernels which clang-offload-deps has found the host image doesn't
+// reference by name, and the code only they use. Returns true if the module
+// has been changed.
+static bool removeUnreferencedKernels(Module &M) {
+  NamedMDNode *MD = M.getNamedMetadata(UNREFERENCED_KERNELS_MD);
+  if (!MD)
+    return false;
 
-    // TODO: Use the new PassManager instead?
-    legacy::PassManager Passes;
-    // Do cleanup.
-    Passes.add(createGlobalDCEPass());           // Delete unreachable globals.
-    Passes.add(createStripDeadDebugInfoPass());  // Remove dead debug info.
-    Passes.add(createStripDeadPrototypesPass()); // Remove dead func decls.
-    Passes.run(*MClone.get());
+  bool KernelsRemoved = false;
+  for (const MDNode *Node : MD->operands()) {
+    if (Node->getNumOperands() != 1 || !isa<MDString>(Node->getOperand(0)))
+      error("invalid " + Twine(UNREFERENCED_KERNELS_MD) + " metadata");
+    StringRef Name = cast<MDString>(Node->getOperand(0))->getString();
+    Function *F = M.getFunction(Name);
+    // The other unreferenced symbols are only kept if the code still uses
+    // them.
+    if (!F || F->isDeclaration() ||
+        F->getCallingConv() != CallingConv::SPIR_KERNEL)
+      continue;
+    F->setLinkage(GlobalValue::InternalLinkage);
+    KernelsRemoved = true;
+  }
+  M.eraseNamedMetadata(MD);
 
-    // Save results.
-    ResModules.push_back(std::move(MClone));
+  if (KernelsRemoved) {
+    ModulePassManager MPM;
+    ModuleAnalysisManager MAM;
+    MAM.registerPass([&] { return PassInstrumentationAnalysis(); });
+    MPM.addPass(GlobalDCEPass());
+    MPM.run(M, MAM);
   }
+  return true;
 }
 
 static std::string makeResultFileName(Twine Ext, int I) {
@@ -423,7 +703,72 @@ static std::string makeResultFileName(Twine Ext, int I) {
       .str();
 }
 
+#ifdef SYCL_POST_LINK_ENABLE_SPIRV
+// Returns the options the SYCL driver passes to llvm-spirv for device code,
+// with the extensions given by -spirv-ext.
+static SPIRV::TranslatorOpts getSPIRVTranslatorOpts() {
+  std::map<std::string, SPIRV::ExtensionID> ExtensionNamesMap;
+#define _STRINGIFY(X) #X
+#define STRINGIFY(X) _STRINGIFY(X)
+#define EXT(X) ExtensionNamesMap[STRINGIFY(X)] = SPIRV::ExtensionID::X;
+#include "LLVMSPIRVExtensions.inc"
+#undef EXT
+#undef STRINGIFY
+#undef _STRINGIFY
+
+  SPIRV::TranslatorOpts::ExtensionsStatusMap ExtensionsStatus;
+  for (const auto &It : ExtensionNamesMap)
+    ExtensionsStatus[It.second] = SPIRVExt.empty();
+  for (const std::string &ExtString : SPIRVExt) {
+    if (ExtString.size() < 2 ||
+        (ExtString.front() != '+' && ExtString.front() != '-'))
+      error("invalid value of -" + SPIRVExt.ArgStr + " '" + ExtString +
+            "', expected format is +EXT_NAME,-EXT_NAME");
+    bool ExtStatus = ExtString.front() == '+';
+    std::string ExtName = ExtString.substr(1);
+    if (ExtName == "all") {
+      for (const auto &It : ExtensionNamesMap)
+        ExtensionsStatus[It.second] = ExtStatus;
+      continue;
+    }
+    auto It = ExtensionNamesMap.find(ExtName);
+    if (It == ExtensionNamesMap.end())
+      error("unknown SPIR-V extension '" + ExtName + "'");
+    ExtensionsStatus[It->second] = ExtStatus;
+  }
+
+  SPIRV::TranslatorOpts Opts(SPIRV::VersionNumber::SPIRV_1_1,
+                             ExtensionsStatus);
+  Opts.setDebugInfoEIS(SPIRV::DebugInfoEIS::SPIRV_Debug);
+  Opts.setAllowExtraDIExpressionsEnabled(true);
+  Opts.setSPIRVAllowUnknownIntrinsicsEnabled(SPIRVAllowUnknownIntrinsics);
+  return Opts;
+}
+#endif // SYCL_POST_LINK_ENABLE_SPIRV
+
+// Translates M to SPIR-V in the output file. The translation modifies M, so
+// everything else must be extracted from it before. Output modules live in
+// separate contexts, so they can be translated concurrently.
+static void saveModuleAsSPIRV(Module &M, StringRef OutFilename) {
+#ifdef SYCL_POST_LINK_ENABLE_SPIRV
+  static const SPIRV::TranslatorOpts Opts = getSPIRVTranslatorOpts();
+  std::ofstream Out{OutFilename.str(), std::ios::binary};
+  if (!Out)
+    error("error opening the file '" + OutFilename + "'");
+  std::string ErrMsg;
+  if (!writeSpirv(&M, Opts, Out, ErrMsg))
+    error("failed to translate '" + OutFilename + "' to SPIR-V: " + ErrMsg);
+#else
+  error("-" + EmitSPIRV.ArgStr + " is not supported by this build");
+#endif // SYCL_POST_LINK_ENABLE_SPIRV
+}
+
 static void saveModule(Module &M, StringRef OutFilename) {
+  if (EmitSPIRV) {
+    saveModuleAsSPIRV(M, OutFilename);
+    return;
+  }
+
   std::error_code EC;
   raw_fd_ostream Out{OutFilename, EC, sys::fs::OF_None};
   checkError(EC, "error opening the file '" + OutFilename + "'");
@@ -438,40 +783,25 @@ static void saveModule(Module &M, StringRef OutFilename) {
   PrintModule.run(M);
 }
 
+// Saves the I-th result module to a file and returns the file name.
+static std::string saveResultModule(Module &M, int I) {
+  StringRef FileExt = EmitSPIRV ? ".spv" : OutputAssembly ? ".ll" : ".bc";
+  std::string CurOutFileName = makeResultFileName(FileExt, I);
+  saveModule(M, CurOutFileName);
+  return CurOutFileName;
+}
+
 // Saves specified collection of llvm IR modules to files.
 // Saves file list if user specified corresponding filename.
 static string_vector
 saveResultModules(std::vector<std::unique_ptr<Module>> &ResModules) {
   string_vector Res;
 
-  for (size_t I = 0; I < ResModules.size(); ++I) {
-    std::error_code EC;
-    StringRef FileExt = (OutputAssembly) ? ".ll" : ".bc";
-    std::string CurOutFileName = makeResultFileName(FileExt, I);
-    saveModule(*ResModules[I].get(), CurOutFileName);
-    Res.emplace_back(std::move(CurOutFileName));
-  }
+  for (size_t I = 0; I < ResModules.size(); ++I)
+    Res.emplace_back(saveResultModule(*ResModules[I].get(), I));
   return Res;
 }
 
-// Each fallback device library corresponds to one bit in "require mask" which
-// is an unsigned int32. getDeviceLibBit checks which fallback device library
-// is required for FuncName and returns the corresponding bit. The corresponding
-// mask for each fallback device library is:
-// fallback-cassert:      0x1
-// fallback-cmath:        0x2
-// fallback-cmath-fp64:   0x4
-// fallback-complex:      0x8
-// fallback-complex-fp64: 0x10
-static uint32_t getDeviceLibBits(const std::string &FuncName) {
-  auto DeviceLibFuncIter = DeviceLibFuncMap.find(FuncName);
-  return ((DeviceLibFuncIter == DeviceLibFuncMap.end())
-              ? 0
-              : 0x1 << (static_cast<uint32_t>(DeviceLibFuncIter->second) -
-                        static_cast<uint32_t>(
-                            DeviceLibExt::cl_intel_devicelib_assert)));
-}
-
 // For each device image module, we go through all functions which meets
 // 1. The function name has prefix "__devicelib_"
 // 2. The function is declaration which means it doesn't have function body
@@ -495,64 +825,140 @@ static uint32_t getModuleReqMask(const Module &M) {
   return ReqMask;
 }
 
-static string_vector saveDeviceImageProperty(
-    const std::vector<std::unique_ptr<Module>> &ResultModules,
-    const ImagePropSaveInfo &ImgPSInfo) {
-  string_vector Res;
-  for (size_t I = 0; I < ResultModules.size(); ++I) {
-    llvm::util::PropertySetRegistry PropSet;
-    if (ImgPSInfo.NeedDeviceLibReqMask) {
-      uint32_t MRMask = getModuleReqMask(*ResultModules[I]);
-      std::map<StringRef, uint32_t> RMEntry = {{"DeviceLibReqMask", MRMask}};
-      PropSet.add(llvm::util::PropertySetRegistry::SYCL_DEVICELIB_REQ_MASK,
-                  RMEntry);
+// Saves the properties of the I-th result module M to a file and returns the
+// file name.
+static std::string saveModuleProperties(Module &M,
+                                        const ImagePropSaveInfo &ImgPSInfo,
+                                        int I) {
+  llvm::util::PropertySetRegistry PropSet;
+  if (ImgPSInfo.NeedDeviceLibReqMask) {
+    uint32_t MRMask = getModuleReqMask(M);
+    std::map<StringRef, uint32_t> RMEntry = {{"DeviceLibReqMask", MRMask}};
+    PropSet.add(llvm::util::PropertySetRegistry::SYCL_DEVICELIB_REQ_MASK,
+                RMEntry);
+  }
+  if (ImgPSInfo.DoSpecConst && ImgPSInfo.SetSpecConstAtRT) {
+    if (ImgPSInfo.SpecConstsMet) {
+      // extract spec constant maps per each module
+      ScalarSpecIDMapTy TmpScalarSpecIDMap;
+      CompositeSpecIDMapTy TmpCompositeSpecIDMap;
+      SpecConstantsPass::collectSpecConstantMetadata(M, TmpScalarSpecIDMap,
+                                                     TmpCompositeSpecIDMap);
+      PropSet.add(
+          llvm::util::PropertySetRegistry::SYCL_SPECIALIZATION_CONSTANTS,
+          TmpScalarSpecIDMap);
+      PropSet.add(llvm::util::PropertySetRegistry::
+                      SYCL_COMPOSITE_SPECIALIZATION_CONSTANTS,
+                  TmpCompositeSpecIDMap);
     }
-    if (ImgPSInfo.DoSpecConst && ImgPSInfo.SetSpecConstAtRT) {
-      if (ImgPSInfo.SpecConstsMet) {
-        // extract spec constant maps per each module
-        ScalarSpecIDMapTy TmpScalarSpecIDMap;
-        CompositeSpecIDMapTy TmpCompositeSpecIDMap;
-        SpecConstantsPass::collectSpecConstantMetadata(
-            *ResultModules[I].get(), TmpScalarSpecIDMap, TmpCompositeSpecIDMap);
-        PropSet.add(
-            llvm::util::PropertySetRegistry::SYCL_SPECIALIZATION_CONSTANTS,
-            TmpScalarSpecIDMap);
-        PropSet.add(llvm::util::PropertySetRegistry::
-                        SYCL_COMPOSITE_SPECIALIZATION_CONSTANTS,
-                    TmpCompositeSpecIDMap);
+  }
+  if (ImgPSInfo.DoSpecConst && ImgPSInfo.EmulateSpecConsts &&
+      ImgPSInfo.SpecConstsMet) {
+    // extract the emulated spec constants buffer layout and the kernel
+    // arguments taking the buffer per each module
+    SpecConstBufferLayoutTy Layout;
+    KernelSpecConstBufferMapTy KernelArgs;
+    if (SpecConstantsPass::collectSpecConstBufferMetadata(M, Layout,
+                                                          KernelArgs)) {
+      PropSet.add(
+          llvm::util::PropertySetRegistry::SYCL_SPEC_CONST_BUFFER_LAYOUT,
+          Layout);
+      llvm::util::PropertySet &ArgProps = PropSet
+          [llvm::util::PropertySetRegistry::SYCL_KERNEL_SPEC_CONST_BUFFER];
+      for (const auto &KernelArg : KernelArgs) {
+        // encoded as {argument index, buffer size}
+        const uint32_t Words[] = {KernelArg.second.Index,
+                                  KernelArg.second.Size};
+        ArgProps.insert(std::make_pair(
+            KernelArg.first,
+            llvm::util::PropertyValue(
+                reinterpret_cast<const unsigned char *>(Words),
+                sizeof(Words) * CHAR_BIT)));
       }
     }
-    if (ImgPSInfo.EmitKernelParamInfo) {
-      // extract kernel parameter optimization info per module
-      ModuleAnalysisManager MAM;
-      // Register required analysis
-      MAM.registerPass([&] { return PassInstrumentationAnalysis(); });
-      // Register the payload analysis
-      MAM.registerPass([&] { return SPIRKernelParamOptInfoAnalysis(); });
-      SPIRKernelParamOptInfo PInfo =
-          MAM.getResult<SPIRKernelParamOptInfoAnalysis>(*ResultModules[I]);
-
-      // convert analysis results into properties and record them
-      llvm::util::PropertySet &Props =
-          PropSet[llvm::util::PropertySetRegistry::SYCL_KERNEL_PARAM_OPT_INFO];
-
-      for (const auto &NameInfoPair : PInfo) {
-        const llvm::BitVector &Bits = NameInfoPair.second;
-        const llvm::ArrayRef<uintptr_t> Arr = NameInfoPair.second.getData();
+  }
+  if (ImgPSInfo.EmitKernelParamInfo) {
+    // extract kernel parameter optimization info per module
+    ModuleAnalysisManager MAM;
+    // Register required analysis
+    MAM.registerPass([&] { return PassInstrumentationAnalysis(); });
+    // Register the payload analysis
+    MAM.registerPass([&] { return SPIRKernelParamOptInfoAnalysis(); });
+    SPIRKernelParamOptInfo PInfo =
+        MAM.getResult<SPIRKernelParamOptInfoAnalysis>(M);
+
+    // convert analysis results into properties and record them
+    llvm::util::PropertySet &Props =
+        PropSet[llvm::util::PropertySetRegistry::SYCL_KERNEL_PARAM_OPT_INFO];
+
+    for (const auto &NameInfoPair : PInfo) {
+      const llvm::BitVector &Bits = NameInfoPair.second;
+      const llvm::ArrayRef<uintptr_t> Arr = NameInfoPair.second.getData();
+      const unsigned char *Data =
+          reinterpret_cast<const unsigned char *>(Arr.begin());
+      llvm::util::PropertyValue::SizeTy DataBitSize = Bits.size();
+      Props.insert(std::make_pair(
+          NameInfoPair.first, llvm::util::PropertyValue(Data, DataBitSize)));
+    }
+
+    if (!PInfo.ParamFields.empty()) {
+      llvm::util::PropertySet &FieldProps =
+          PropSet[llvm::util::PropertySetRegistry::
+                      SYCL_KERNEL_PARAM_FIELD_OPT_INFO];
+      for (const auto &NameFieldsPair : PInfo.ParamFields) {
+        const SmallVector<uint32_t, 8> &Words = NameFieldsPair.second;
         const unsigned char *Data =
-            reinterpret_cast<const unsigned char *>(Arr.begin());
-        llvm::util::PropertyValue::SizeTy DataBitSize = Bits.size();
-        Props.insert(std::make_pair(
-            NameInfoPair.first, llvm::util::PropertyValue(Data, DataBitSize)));
+            reinterpret_cast<const unsigned char *>(Words.data());
+        llvm::util::PropertyValue::SizeTy DataBitSize =
+            Words.size() * sizeof(uint32_t) * CHAR_BIT;
+        FieldProps.insert(
+            std::make_pair(NameFieldsPair.first,
+                           llvm::util::PropertyValue(Data, DataBitSize)));
       }
     }
-    std::error_code EC;
-    std::string SCFile = makeResultFileName(".prop", I);
-    raw_fd_ostream SCOut(SCFile, EC);
-    PropSet.write(SCOut);
-    Res.emplace_back(std::move(SCFile));
   }
+  // the sub-group sizes of the variants of every kernel which has some
+  std::map<StringRef, SmallVector<uint32_t, 4>> SubGroupSizes;
+  for (const Function &F : M.functions()) {
+    if (!F.hasFnAttribute(ATTR_SUB_GROUP_SIZE_VARIANT_OF))
+      continue;
+    StringRef KernelName =
+        F.getFnAttribute(ATTR_SUB_GROUP_SIZE_VARIANT_OF).getValueAsString();
+    const MDNode *MD = F.getMetadata(REQD_SUB_GROUP_SIZE_MD);
+    SubGroupSizes[KernelName].push_back(static_cast<uint32_t>(
+        mdconst::extract<ConstantInt>(MD->getOperand(0))->getZExtValue()));
+  }
+  if (!SubGroupSizes.empty()) {
+    llvm::util::PropertySet &Props = PropSet
+        [llvm::util::PropertySetRegistry::SYCL_SUB_GROUP_SIZE_VARIANTS];
+    for (const auto &KernelSizes : SubGroupSizes) {
+      const SmallVector<uint32_t, 4> &Words = KernelSizes.second;
+      Props.insert(std::make_pair(
+          KernelSizes.first,
+          llvm::util::PropertyValue(
+              reinterpret_cast<const unsigned char *>(Words.data()),
+              Words.size() * sizeof(uint32_t) * CHAR_BIT)));
+    }
+  }
+  // the runtime compiles the ESIMD images with the vector back-end
+  if (llvm::any_of(M.functions(),
+                   [](const Function &F) { return isESIMDKernel(F); })) {
+    std::map<StringRef, uint32_t> MiscEntry = {{"isEsimdImage", 1}};
+    PropSet.add(llvm::util::PropertySetRegistry::SYCL_MISC_PROP, MiscEntry);
+  }
+  std::error_code EC;
+  std::string SCFile = makeResultFileName(".prop", I);
+  raw_fd_ostream SCOut(SCFile, EC);
+  PropSet.write(SCOut);
+  return SCFile;
+}
 
+static string_vector saveDeviceImageProperty(
+    const std::vector<std::unique_ptr<Module>> &ResultModules,
+    const ImagePropSaveInfo &ImgPSInfo) {
+  string_vector Res;
+  for (size_t I = 0; I < ResultModules.size(); ++I)
+    Res.emplace_back(saveModuleProperties(*ResultModules[I], ImgPSInfo, I));
   return Res;
 }
 
@@ -570,6 +976,48 @@ static string_vector saveResultSymbolsLists(string_vector &ResSymbolsLists) {
   return std::move(Res);
 }
 
+// Does the same as splitModule followed by saveResultModules and
+// saveDeviceImageProperty, but processes the output modules in parallel.
+// LLVMContext is not thread-safe, so each task parses its own copy of M into a
+// separate context first. Result files keep the order of KernelModuleMap.
+static void splitAndSaveModulesInParallel(
+    Module &M, std::map<StringRef, std::vector<Function *>> &KernelModuleMap,
+    const ImagePropSaveInfo &ImgPSInfo, string_vector &CodeFiles,
+    string_vector &PropFiles) {
+  SmallVector<char, 0> Bitcode;
+  raw_svector_ostream BitcodeOS(Bitcode);
+  WriteBitcodeToFile(M, BitcodeOS, /*ShouldPreserveUseListOrder=*/true);
+  MemoryBufferRef BitcodeRef(StringRef(Bitcode.data(), Bitcode.size()),
+                             M.getModuleIdentifier());
+
+  CodeFiles.resize(KernelModuleMap.size());
+  PropFiles.resize(KernelModuleMap.size());
+  ThreadPool Pool(hardware_concurrency(NumThreads));
+  int I = 0;
+  for (auto &It : KernelModuleMap) {
+    std::vector<std::string> KernelNames;
+    for (Function *F : It.second)
+      KernelNames.push_back(F->getName().str());
+
+    Pool.async([&, I, KernelNames = std::move(KernelNames)]() {
+      LLVMContext Context;
+      SMDiagnostic Err;
+      std::unique_ptr<Module> MCopy = parseIR(BitcodeRef, Err, Context);
+      if (!MCopy)
+        error("failed to copy the input module: " + Err.getMessage());
+
+      std::vector<Function *> Kernels;
+      for (const std::string &Name : KernelNames)
+        Kernels.push_back(MCopy->getFunction(Name));
+      std::unique_ptr<Module> MSplit = extractKernels(*MCopy, Kernels);
+      PropFiles[I] = saveModuleProperties(*MSplit, ImgPSInfo, I);
+      CodeFiles[I] = saveResultModule(*MSplit, I);
+    });
+    ++I;
+  }
+  Pool.wait();
+}
+
 #define CHECK_AND_EXIT(E)                                                      \
   {                                                                            \
     Error LocE = std::move(E);                                                 \
@@ -594,7 +1042,9 @@ int main(int argc, char **argv) {
       "  Groups kernels using function attribute 'sycl-module-id', i.e.\n"
       "  kernels with the same values of the 'sycl-module-id' attribute will\n"
       "  be put into the same module. If -split=kernel option is specified,\n"
-      "  one module per kernel will be emitted.\n"
+      "  one module per kernel will be emitted. If -split=size is specified,\n"
+      "  kernels sharing code are grouped into modules bounded by\n"
+      "  -split-size-limit.\n"
       "- If -symbols options is also specified, then for each produced module\n"
       "  a text file containing names of all spir kernels in it is generated.\n"
       "- Specialization constant intrinsic transformer. Replaces symbolic\n"
@@ -614,19 +1064,38 @@ int main(int argc, char **argv) {
       "  $ sycl-post-link --ir-output-only --spec-const=default \\\n"
       "    -o example_p.bc example.bc\n"
       "will produce single output file example_p.bc suitable for SPIRV\n"
-      "translation.\n");
+      "translation.\n"
+      "If -emit-spirv is specified, the output modules are translated to\n"
+      "SPIR-V in process, saving the round trip through bitcode files and\n"
+      "llvm-spirv. The translation uses the options the SYCL driver passes\n"
+      "to llvm-spirv, and the modules are translated in parallel with\n"
+      "-threads.\n"
+      "If the input module has the sycl.unreferenced.kernels metadata added\n"
+      "by clang-offload-deps -sycl-kernel-gc, the kernels listed there are\n"
+      "removed first, as the host can't launch them.\n"
+      "If -split-esimd is specified, the ESIMD kernels are put in other\n"
+      "modules than the SYCL kernels, even without -split, and the\n"
+      "properties of these modules mark them as ESIMD images, which the\n"
+      "runtime builds with the vector back-end.\n"
+      "If -sub-group-size-variants is specified, a variant of every kernel\n"
+      "with no required sub-group size is compiled for each of the sizes,\n"
+      "into the module of the kernel. The runtime picks the variant to run\n"
+      "for each device.\n");
 
-  bool DoSplit = SplitMode.getNumOccurrences() > 0;
+  bool DoSplit = SplitMode.getNumOccurrences() > 0 || SplitEsimd;
   bool DoSpecConst = SpecConstLower.getNumOccurrences() > 0;
   bool DoParamInfo = EmitKernelParamInfo.getNumOccurrences() > 0;
+  bool DoSubGroupSizeVariants = !SubGroupSizeVariants.empty();
 
-  if (!DoSplit && !DoSpecConst && !DoSymGen && !DoParamInfo) {
+  if (!DoSplit && !DoSpecConst && !DoSymGen && !DoParamInfo &&
+      !DoSubGroupSizeVariants) {
     errs() << "no actions specified; try --help for usage info\n";
     return 1;
   }
   if (IROutputOnly && DoSplit) {
-    errs() << "error: -" << SplitMode.ArgStr << " can't be used with -"
-           << IROutputOnly.ArgStr << "\n";
+    errs() << "error: -"
+           << (SplitEsimd ? SplitEsimd.ArgStr : SplitMode.ArgStr)
+           << " can't be used with -" << IROutputOnly.ArgStr << "\n";
     return 1;
   }
   if (IROutputOnly && DoSymGen) {
@@ -639,6 +1108,21 @@ int main(int argc, char **argv) {
            << " -" << IROutputOnly.ArgStr << "\n";
     return 1;
   }
+  if (IROutputOnly && DoSubGroupSizeVariants) {
+    errs() << "error: -" << SubGroupSizeVariants.ArgStr << " can't be used"
+           << " with -" << IROutputOnly.ArgStr << "\n";
+    return 1;
+  }
+  if (IROutputOnly && SpecConstLower == SC_USE_EMULATION) {
+    errs() << "error: -" << SpecConstLower.ArgStr << "=emulation can't be used"
+           << " with -" << IROutputOnly.ArgStr << "\n";
+    return 1;
+  }
+  if (EmitSPIRV && OutputAssembly) {
+    errs() << "error: -" << OutputAssembly.ArgStr << " can't be used with -"
+           << EmitSPIRV.ArgStr << "\n";
+    return 1;
+  }
   SMDiagnostic Err;
   std::unique_ptr<Module> M = parseIRFile(InputFilename, Err, Context);
   // It is OK to use raw pointer here as we control that it does not outlive M
@@ -652,28 +1136,25 @@ int main(int argc, char **argv) {
   if (OutputFilename.getNumOccurrences() == 0)
     OutputFilename = (Twine(sys::path::stem(InputFilename)) + ".files").str();
 
-  std::map<StringRef, std::vector<Function *>> GlobalsSet;
+  // drop the dead kernels before anything is computed for them
+  bool UnreferencedKernelsMet = removeUnreferencedKernels(*MPtr);
 
-  if (DoSplit || DoSymGen) {
-    KernelMapEntryScope Scope = Scope_Global;
-    if (DoSplit)
-      Scope = SplitMode == SPLIT_PER_KERNEL ? Scope_PerKernel : Scope_PerModule;
-    collectKernelModuleMap(*MPtr, GlobalsSet, Scope);
-  }
-
-  std::vector<std::unique_ptr<Module>> ResultModules;
-  string_vector ResultSymbolsLists;
-
-  util::SimpleTable Table;
   bool SpecConstsMet = false;
   bool SetSpecConstAtRT = DoSpecConst && (SpecConstLower == SC_USE_RT_VAL);
+  bool EmulateSpecConsts = DoSpecConst && (SpecConstLower == SC_USE_EMULATION);
 
   if (DoSpecConst) {
     // perform the spec constant intrinsics transformation and enumeration on
-    // the whole module
+    // the whole module; this must precede kernel collection, as emulation
+    // replaces the kernels with ones taking an extra argument
     ModulePassManager RunSpecConst;
     ModuleAnalysisManager MAM;
-    SpecConstantsPass SCP(SetSpecConstAtRT);
+    SpecConstantsPass SCP(
+        SetSpecConstAtRT
+            ? SpecConstantsPass::HandlingMode::native
+            : EmulateSpecConsts
+                  ? SpecConstantsPass::HandlingMode::emulation
+                  : SpecConstantsPass::HandlingMode::default_values);
     // Register required analysis
     MAM.registerPass([&] { return PassInstrumentationAnalysis(); });
     RunSpecConst.addPass(SCP);
@@ -683,34 +1164,69 @@ int main(int argc, char **argv) {
     PreservedAnalyses Res = RunSpecConst.run(*MPtr, MAM);
     SpecConstsMet = !Res.areAllPreserved();
   }
+
+  std::map<StringRef, std::vector<Function *>> GlobalsSet;
+
+  bool SubGroupSizeVariantsMet = false;
+  if (DoSplit || DoSymGen || DoSubGroupSizeVariants) {
+    KernelMapEntryScope Scope = Scope_Global;
+    if (SplitMode.getNumOccurrences() > 0)
+      Scope = SplitMode == SPLIT_PER_KERNEL
+                  ? Scope_PerKernel
+                  : SplitMode == SPLIT_BY_SIZE ? Scope_PerGroup
+                                               : Scope_PerModule;
+    collectKernelModuleMap(*MPtr, GlobalsSet, Scope);
+    if (SplitEsimd)
+      splitESIMDKernels(GlobalsSet);
+    if (DoSubGroupSizeVariants)
+      SubGroupSizeVariantsMet = addSubGroupSizeVariants(*MPtr, GlobalsSet);
+  }
+
+  std::vector<std::unique_ptr<Module>> ResultModules;
+  string_vector ResultSymbolsLists;
+
+  util::SimpleTable Table;
   if (IROutputOnly) {
     // the result is the transformed input LLVMIR file rather than a file table
     saveModule(*MPtr, OutputFilename);
     return 0;
   }
-  if (DoSplit) {
-    splitModule(*MPtr, GlobalsSet, ResultModules);
-    // post-link always produces a code result, even if it is unmodified input
-    if (ResultModules.size() == 0)
+  ImagePropSaveInfo ImgPSInfo = {true, DoSpecConst, SetSpecConstAtRT,
+                                 SpecConstsMet, EmitKernelParamInfo,
+                                 EmulateSpecConsts};
+  string_vector CodeFiles;
+  string_vector PropFiles;
+  if (DoSplit && GlobalsSet.size() > 1 && NumThreads != 1) {
+    splitAndSaveModulesInParallel(*MPtr, GlobalsSet, ImgPSInfo, CodeFiles,
+                                  PropFiles);
+  } else {
+    if (DoSplit) {
+      splitModule(*MPtr, GlobalsSet, ResultModules);
+      // post-link always produces a code result, even if it is unmodified
+      // input
+      if (ResultModules.size() == 0)
+        ResultModules.push_back(std::move(M));
+    } else
       ResultModules.push_back(std::move(M));
-  } else
-    ResultModules.push_back(std::move(M));
+
+    // properties go first, as the SPIR-V translation modifies the modules
+    PropFiles = saveDeviceImageProperty(ResultModules, ImgPSInfo);
+    // reuse input module if there were no spec constants, no removed kernels,
+    // no splitting and no translation
+    CodeFiles = SpecConstsMet || UnreferencedKernelsMet ||
+                        SubGroupSizeVariantsMet || (ResultModules.size() > 1) ||
+                        EmitSPIRV
+                    ? saveResultModules(ResultModules)
+                    : string_vector{InputFilename};
+  }
 
   {
-    // reuse input module if there were no spec constants and no splitting
-    string_vector Files = SpecConstsMet || (ResultModules.size() > 1)
-                              ? saveResultModules(ResultModules)
-                              : string_vector{InputFilename};
     // "Code" column is always output
-    Error Err = Table.addColumn(COL_CODE, Files);
+    Error Err = Table.addColumn(COL_CODE, CodeFiles);
     CHECK_AND_EXIT(Err);
   }
-
   {
-    ImagePropSaveInfo ImgPSInfo = {true, DoSpecConst, SetSpecConstAtRT,
-                                   SpecConstsMet, EmitKernelParamInfo};
-    string_vector Files = saveDeviceImageProperty(ResultModules, ImgPSInfo);
-    Error Err = Table.addColumn(COL_PROPS, Files);
+    Error Err = Table.addColumn(COL_PROPS, PropFiles);
     CHECK_AND_EXIT(Err);
   }
   if (DoSymGen) {
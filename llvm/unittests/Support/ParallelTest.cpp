@@ -14,6 +14,7 @@
 #include "llvm/Support/Parallel.h"
 #include "gtest/gtest.h"
 #include <array>
+#include <atomic>
 #include <random>
 
 uint32_t array[1024 * 1024];
@@ -49,6 +50,19 @@ TEST(Parallel, parallel_for) {
   ASSERT_EQ(range[2049], 1u);
 }
 
+TEST(Parallel, NestedForEach) {
+  // The inner loops run in parallel with the outer one. The threads waiting
+  // for their tasks run the other pending tasks, so they can't deadlock even
+  // when the nested groups outnumber the threads.
+  std::atomic<uint32_t> count{0};
+  parallelForEachN(0, 64, [&](size_t) {
+    parallelForEachN(0, 64, [&](size_t) {
+      parallelForEachN(0, 16, [&](size_t) { ++count; });
+    });
+  });
+  EXPECT_EQ(count, 64u * 64u * 16u);
+}
+
 TEST(Parallel, TransformReduce) {
   // Sum an empty list, check that it works.
   auto identity = [](uint32_t v) { return v; };
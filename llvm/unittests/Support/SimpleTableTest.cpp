@@ -82,4 +82,31 @@ TEST(SimpleTable, Operations) {
   ASSERT_EQ(Result, Expected);
 }
 
+TEST(SimpleTable, ReadColumns) {
+  auto Content = "[Code|Symbols|Properties]\n"
+                 "a_0.bc|a_0.sym|a_0.props\n"
+                 "a_1.bc|a_1.sym|a_1.props\n";
+  auto MemBuf = MemoryBuffer::getMemBuffer(Content);
+  // Materialize only two columns; the order must follow the original table
+  auto Table = SimpleTable::read(MemBuf.get(), {"Properties", "Code"});
+
+  if (!Table)
+    FAIL() << "SimpleTable::read failed\n";
+
+  std::string Result;
+  {
+    llvm::raw_string_ostream OS(Result);
+    Table->get()->write(OS);
+  }
+  auto Expected = "[Code|Properties]\n"
+                  "a_0.bc|a_0.props\n"
+                  "a_1.bc|a_1.props\n";
+  ASSERT_EQ(Result, Expected);
+
+  // Unknown columns must be diagnosed
+  auto Bad = SimpleTable::read(MemBuf.get(), {"Code", "Manifest"});
+  ASSERT_FALSE(static_cast<bool>(Bad));
+  consumeError(Bad.takeError());
+}
+
 } // namespace
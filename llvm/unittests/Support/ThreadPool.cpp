@@ -167,6 +167,43 @@ TEST_F(ThreadPoolTest, PoolDestruction) {
   ASSERT_EQ(5, checked_in);
 }
 
+TEST_F(ThreadPoolTest, GroupWait) {
+  CHECK_UNSUPPORTED();
+  // Test that the tasks of the pool can wait for the groups they submit,
+  // which needs the waiting threads to run the tasks of their group.
+  std::atomic_int checked_in{0};
+  ThreadPool Pool(hardware_concurrency(2));
+  ThreadPoolTaskGroup Outer(Pool);
+  for (size_t i = 0; i < 8; ++i) {
+    Outer.async([&Pool, &checked_in] {
+      ThreadPoolTaskGroup Inner(Pool);
+      for (size_t j = 0; j < 8; ++j)
+        Inner.async([&checked_in] { ++checked_in; });
+      Inner.wait();
+    });
+  }
+  Outer.wait();
+  ASSERT_EQ(64, checked_in);
+}
+
+TEST_F(ThreadPoolTest, GroupWaitIgnoresOtherTasks) {
+  CHECK_UNSUPPORTED();
+  // Test that waiting for a group doesn't wait for the other tasks.
+  std::atomic_int checked_in{0};
+  ThreadPool Pool(hardware_concurrency(2));
+  Pool.async([this, &checked_in] {
+    waitForMainThread();
+    ++checked_in;
+  });
+  ThreadPoolTaskGroup Group(Pool);
+  Group.async([&checked_in] { ++checked_in; });
+  Group.wait();
+  ASSERT_EQ(1, checked_in);
+  setMainThreadReady();
+  Pool.wait();
+  ASSERT_EQ(2, checked_in);
+}
+
 #if LLVM_ENABLE_THREADS == 1
 
 void ThreadPoolTest::RunOnAllSockets(ThreadPoolStrategy S) {
@@ -73,11 +73,13 @@ mlirAsyncRuntimeAddTokenToGroup(AsyncToken *, AsyncGroup *);
 extern "C" MLIR_ASYNCRUNTIME_EXPORT void
 mlirAsyncRuntimeEmplaceToken(AsyncToken *);
 
-// Blocks the caller thread until the token becomes ready.
+// Blocks the caller thread until the token becomes ready. A thread managed by
+// the runtime runs the other pending tasks meanwhile.
 extern "C" MLIR_ASYNCRUNTIME_EXPORT void
 mlirAsyncRuntimeAwaitToken(AsyncToken *);
 
-// Blocks the caller thread until the elements in the group become ready.
+// Blocks the caller thread until the elements in the group become ready. A
+// thread managed by the runtime runs the other pending tasks meanwhile.
 extern "C" MLIR_ASYNCRUNTIME_EXPORT void
 mlirAsyncRuntimeAwaitAllInGroup(AsyncGroup *);
 
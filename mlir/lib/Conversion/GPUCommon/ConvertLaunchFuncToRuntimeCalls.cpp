@@ -86,7 +86,8 @@ protected:
   FunctionCallBuilder moduleLoadCallBuilder = {
       "mgpuModuleLoad",
       llvmPointerType /* void *module */,
-      {llvmPointerType /* void *cubin */}};
+      {llvmPointerType /* void *cubin */,
+       llvmIntPtrType /* intptr_t sizeBytes */}};
   FunctionCallBuilder moduleUnloadCallBuilder = {
       "mgpuModuleUnload", llvmVoidType, {llvmPointerType /* void *module */}};
   FunctionCallBuilder moduleGetFunctionCallBuilder = {
@@ -550,7 +551,7 @@ Value ConvertLaunchFuncOpToGpuRuntimeCallPattern::generateKernelNameConstant(
 // hsaco in the 'rocdl.hsaco' attribute of the kernel function in the IR.
 //
 // %0 = call %binarygetter
-// %1 = call %moduleLoad(%0)
+// %1 = call %moduleLoad(%0, <size of the binary>)
 // %2 = <see generateKernelNameConstant>
 // %3 = call %moduleGetFunction(%1, %2)
 // %4 = call %streamCreate()
@@ -601,7 +602,15 @@ LogicalResult ConvertLaunchFuncOpToGpuRuntimeCallPattern::matchAndRewrite(
       LLVM::createGlobalString(loc, rewriter, nameBuffer.str(),
                                binaryAttr.getValue(), LLVM::Linkage::Internal);
 
-  auto module = moduleLoadCallBuilder.create(loc, rewriter, data);
+  // The size is needed by the runtimes which can't find the end of the binary
+  // on their own, e.g. for SPIR-V.
+  auto dataSize = rewriter.create<LLVM::ConstantOp>(
+      loc, llvmIntPtrType,
+      rewriter.getIntegerAttr(
+          rewriter.getIntegerType(getTypeConverter()->getPointerBitwidth(0)),
+          binaryAttr.getValue().size()));
+  auto module =
+      moduleLoadCallBuilder.create(loc, rewriter, {data, dataSize});
   // Get the function from the module. The name corresponds to the name of
   // the kernel function.
   auto kernelName = generateKernelNameConstant(
@@ -17,13 +17,22 @@
 
 #include <atomic>
 #include <cassert>
+#include <chrono>
 #include <condition_variable>
+#include <cstdlib>
+#include <deque>
 #include <functional>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <vector>
 
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 //===----------------------------------------------------------------------===//
 // Async runtime API.
 //===----------------------------------------------------------------------===//
@@ -33,6 +42,159 @@ namespace {
 // Forward declare class defined below.
 class RefCounted;
 
+// -------------------------------------------------------------------------- //
+// A work stealing executor for the async tasks.
+//
+// Each worker thread owns a queue of tasks. A task launched from a worker goes
+// to the back of its queue, and one launched from another thread goes to the
+// queues in turn. A worker runs the tasks from the back of its own queue, and
+// when it is empty, steals the tasks from the front of the other queues.
+//
+// The number of workers defaults to the number of hardware threads and can be
+// set with the MLIR_ASYNC_RUNTIME_NUM_WORKERS environment variable. On Linux,
+// MLIR_ASYNC_RUNTIME_PIN_WORKERS=1 pins each worker to a CPU.
+// -------------------------------------------------------------------------- //
+
+class WorkStealingExecutor {
+public:
+  using Task = std::function<void()>;
+
+  WorkStealingExecutor(unsigned numWorkers, bool pinWorkers)
+      : numPending(0), nextQueue(0), stop(false) {
+    for (unsigned i = 0; i < numWorkers; ++i)
+      queues.push_back(std::make_unique<Queue>());
+    for (unsigned i = 0; i < numWorkers; ++i)
+      workers.emplace_back([this, i]() { runWorker(i); });
+    if (pinWorkers)
+      pin();
+  }
+
+  // Runs the pending tasks, then stops the workers.
+  ~WorkStealingExecutor() {
+    {
+      std::unique_lock<std::mutex> lock(mu);
+      stop = true;
+    }
+    cv.notify_all();
+    for (std::thread &worker : workers)
+      worker.join();
+  }
+
+  void execute(Task task) {
+    unsigned queue = currentExecutor == this
+                         ? currentWorker
+                         : nextQueue.fetch_add(1, std::memory_order_relaxed) %
+                               queues.size();
+    {
+      std::unique_lock<std::mutex> lock(queues[queue]->mu);
+      queues[queue]->tasks.push_back(std::move(task));
+    }
+    {
+      std::unique_lock<std::mutex> lock(mu);
+      numPending.fetch_add(1);
+    }
+    cv.notify_one();
+  }
+
+  // Returns true if the caller is one of the workers.
+  bool isWorkerThread() const { return currentExecutor == this; }
+
+  // Runs one pending task on the calling worker, so that a worker waiting for
+  // a token or a group keeps the tasks moving. Returns false if there is none.
+  bool tryRunPendingTask() {
+    assert(isWorkerThread() && "not called from a worker");
+    Task task;
+    if (!popOrSteal(currentWorker, task))
+      return false;
+    task();
+    return true;
+  }
+
+private:
+  struct Queue {
+    std::mutex mu;
+    std::deque<Task> tasks;
+  };
+
+  bool popOrSteal(unsigned worker, Task &task) {
+    // Own tasks first, the most recent one as its data is likely still in the
+    // cache.
+    {
+      Queue &own = *queues[worker];
+      std::unique_lock<std::mutex> lock(own.mu);
+      if (!own.tasks.empty()) {
+        task = std::move(own.tasks.back());
+        own.tasks.pop_back();
+        numPending.fetch_sub(1);
+        return true;
+      }
+    }
+    // Then the oldest tasks of the other workers.
+    for (size_t i = 1, e = queues.size(); i < e; ++i) {
+      Queue &victim = *queues[(worker + i) % e];
+      std::unique_lock<std::mutex> lock(victim.mu);
+      if (!victim.tasks.empty()) {
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        numPending.fetch_sub(1);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void runWorker(unsigned worker) {
+    currentExecutor = this;
+    currentWorker = worker;
+    while (true) {
+      Task task;
+      if (popOrSteal(worker, task)) {
+        task();
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(mu);
+      cv.wait(lock, [this] { return numPending.load() > 0 || stop; });
+      if (stop && numPending.load() == 0)
+        return;
+    }
+  }
+
+  void pin() {
+#if defined(__linux__)
+    unsigned numCpus = std::thread::hardware_concurrency();
+    if (numCpus == 0)
+      return;
+    for (unsigned i = 0, e = workers.size(); i < e; ++i) {
+      cpu_set_t cpus;
+      CPU_ZERO(&cpus);
+      CPU_SET(i % numCpus, &cpus);
+      pthread_setaffinity_np(workers[i].native_handle(), sizeof(cpus), &cpus);
+    }
+#endif
+  }
+
+  std::vector<std::unique_ptr<Queue>> queues;
+  std::vector<std::thread> workers;
+
+  // Number of tasks in the queues. Incremented with `mu` locked so that an
+  // idle worker can't miss it.
+  std::atomic<size_t> numPending;
+  // The queue the next task launched from outside the workers goes to.
+  std::atomic<unsigned> nextQueue;
+
+  // Idle workers wait on `cv` for a task or for the executor to stop.
+  std::mutex mu;
+  std::condition_variable cv;
+  bool stop;
+
+  static thread_local WorkStealingExecutor *currentExecutor;
+  static thread_local unsigned currentWorker;
+};
+
+thread_local WorkStealingExecutor *WorkStealingExecutor::currentExecutor =
+    nullptr;
+thread_local unsigned WorkStealingExecutor::currentWorker = 0;
+
 // -------------------------------------------------------------------------- //
 // AsyncRuntime orchestrates all async operations and Async runtime API is built
 // on top of the default runtime instance.
@@ -43,6 +205,8 @@ public:
   AsyncRuntime() : numRefCountedObjects(0) {}
 
   ~AsyncRuntime() {
+    // Run the pending tasks before checking the objects are all destroyed.
+    executor.reset();
     assert(getNumRefCountedObjects() == 0 &&
            "all ref counted objects must be destroyed");
   }
@@ -51,6 +215,21 @@ public:
     return numRefCountedObjects.load(std::memory_order_relaxed);
   }
 
+  // Returns the executor, starting its workers on the first call.
+  WorkStealingExecutor &getExecutor() {
+    std::call_once(executorInit, [this]() {
+      unsigned numWorkers = std::thread::hardware_concurrency();
+      if (const char *env = std::getenv("MLIR_ASYNC_RUNTIME_NUM_WORKERS"))
+        numWorkers = std::atoi(env);
+      if (numWorkers == 0)
+        numWorkers = 1;
+      const char *pin = std::getenv("MLIR_ASYNC_RUNTIME_PIN_WORKERS");
+      executor = std::make_unique<WorkStealingExecutor>(
+          numWorkers, pin && std::atoi(pin) != 0);
+    });
+    return *executor;
+  }
+
 private:
   friend class RefCounted;
 
@@ -64,6 +243,9 @@ private:
   }
 
   std::atomic<int32_t> numRefCountedObjects;
+
+  std::once_flag executorInit;
+  std::unique_ptr<WorkStealingExecutor> executor;
 };
 
 // Returns the default per-process instance of an async runtime.
@@ -221,42 +403,68 @@ extern "C" void mlirAsyncRuntimeEmplaceToken(AsyncToken *token) {
   token->dropRef();
 }
 
+// Blocks the caller until `isReady` returns true. A worker of the executor
+// runs the pending tasks meanwhile instead, as the tasks it waits for may be
+// among them.
+template <typename Object, typename IsReady>
+static void awaitOrRunPendingTasks(Object *object, IsReady isReady) {
+  WorkStealingExecutor &executor =
+      getDefaultAsyncRuntimeInstance()->getExecutor();
+  std::unique_lock<std::mutex> lock(object->mu);
+  if (!executor.isWorkerThread()) {
+    object->cv.wait(lock, isReady);
+    return;
+  }
+  while (!isReady()) {
+    lock.unlock();
+    bool ranTask = executor.tryRunPendingTask();
+    lock.lock();
+    // Nothing to run: the awaited tasks are running on other workers.
+    if (!ranTask && !isReady())
+      object->cv.wait_for(lock, std::chrono::microseconds(100), isReady);
+  }
+}
+
 extern "C" void mlirAsyncRuntimeAwaitToken(AsyncToken *token) {
-  std::unique_lock<std::mutex> lock(token->mu);
-  if (!token->ready)
-    token->cv.wait(lock, [token] { return token->ready; });
+  awaitOrRunPendingTasks(token, [token] { return token->ready; });
 }
 
 extern "C" void mlirAsyncRuntimeAwaitAllInGroup(AsyncGroup *group) {
-  std::unique_lock<std::mutex> lock(group->mu);
-  if (group->pendingTokens != 0)
-    group->cv.wait(lock, [group] { return group->pendingTokens == 0; });
+  awaitOrRunPendingTasks(group, [group] { return group->pendingTokens == 0; });
 }
 
 extern "C" void mlirAsyncRuntimeExecute(CoroHandle handle, CoroResume resume) {
-  (*resume)(handle);
+  getDefaultAsyncRuntimeInstance()->getExecutor().execute(
+      [handle, resume]() { (*resume)(handle); });
 }
 
+// The continuations of the awaits are launched on the executor when the
+// token or the group becomes ready, instead of running in the thread which
+// made it ready with its lock held.
 extern "C" void mlirAsyncRuntimeAwaitTokenAndExecute(AsyncToken *token,
                                                      CoroHandle handle,
                                                      CoroResume resume) {
   std::unique_lock<std::mutex> lock(token->mu);
-  auto execute = [handle, resume]() { (*resume)(handle); };
-  if (token->ready)
-    execute();
-  else
-    token->awaiters.push_back([execute]() { execute(); });
+  if (token->ready) {
+    lock.unlock();
+    (*resume)(handle);
+  } else {
+    token->awaiters.push_back(
+        [handle, resume]() { mlirAsyncRuntimeExecute(handle, resume); });
+  }
 }
 
 extern "C" void mlirAsyncRuntimeAwaitAllInGroupAndExecute(AsyncGroup *group,
                                                           CoroHandle handle,
                                                           CoroResume resume) {
   std::unique_lock<std::mutex> lock(group->mu);
-  auto execute = [handle, resume]() { (*resume)(handle); };
-  if (group->pendingTokens == 0)
-    execute();
-  else
-    group->awaiters.push_back([execute]() { execute(); });
+  if (group->pendingTokens == 0) {
+    lock.unlock();
+    (*resume)(handle);
+  } else {
+    group->awaiters.push_back(
+        [handle, resume]() { mlirAsyncRuntimeExecute(handle, resume); });
+  }
 }
 
 //===----------------------------------------------------------------------===//
@@ -18,19 +18,98 @@
 
 #ifdef MLIR_CRUNNERUTILS_DEFINE_FUNCTIONS
 
+#include <algorithm>
 #include <cctype>
 #include <cinttypes>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 //===----------------------------------------------------------------------===//
 //
 // Internal support for reading matrices in the Matrix Market Exchange Format.
 // See https://math.nist.gov/MatrixMarket for details on this format.
 //
+// The whole file is mapped into memory and its data items are parsed in
+// parallel when the matrix is opened, each thread parsing a range of whole
+// lines. The items are then handed out in file order.
+//
 //===----------------------------------------------------------------------===//
 
+namespace {
+
+// A nonzero element of a matrix.
+struct MatrixItem {
+  uint64_t i;
+  uint64_t j;
+  double d;
+};
+
+// The contents of a matrix file.
+struct MatrixFile {
+  // Maps the file into memory, or reads it when it can't be mapped.
+  bool open(const char *filename);
+  void close();
+
+  const char *begin = nullptr;
+  const char *end = nullptr;
+  bool mapped = false;
+  std::vector<char> buffer;
+};
+
+} // namespace
+
+bool MatrixFile::open(const char *filename) {
+#ifndef _WIN32
+  int fd = ::open(filename, O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+    void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data != MAP_FAILED) {
+      ::close(fd);
+      madvise(data, st.st_size, MADV_WILLNEED);
+      begin = static_cast<const char *>(data);
+      end = begin + st.st_size;
+      mapped = true;
+      return true;
+    }
+  }
+  ::close(fd);
+#endif
+  FILE *file = fopen(filename, "rb");
+  if (!file)
+    return false;
+  char data[1 << 16];
+  size_t size;
+  while ((size = fread(data, 1, sizeof(data), file)) > 0)
+    buffer.insert(buffer.end(), data, data + size);
+  fclose(file);
+  begin = buffer.data();
+  end = begin + buffer.size();
+  return true;
+}
+
+void MatrixFile::close() {
+#ifndef _WIN32
+  if (mapped)
+    munmap(const_cast<char *>(begin), end - begin);
+#endif
+  std::vector<char>().swap(buffer);
+  begin = end = nullptr;
+  mapped = false;
+}
+
 // Helper to convert string to lower case.
 static char *toLower(char *token) {
   for (char *c = token; *c; c++)
@@ -38,12 +117,27 @@ static char *toLower(char *token) {
   return token;
 }
 
-// Read the header of a general sparse matrix of type real.
+// Helper to copy the line at pos into line, as fgets would, and return the
+// position after it.
+static const char *getLine(const char *pos, const char *end, char *line,
+                           size_t size) {
+  size_t n = 0;
+  while (pos != end && n + 1 < size) {
+    line[n++] = *pos;
+    if (*pos++ == '\n')
+      break;
+  }
+  line[n] = 0;
+  return pos;
+}
+
+// Read the header of a general sparse matrix of type real, and return the
+// position of the data items.
 //
 // TODO: support other formats as well?
 //
-static void readHeader(FILE *file, char *name, uint64_t *m, uint64_t *n,
-                       uint64_t *nnz) {
+static const char *readHeader(const char *pos, const char *end, char *name,
+                              uint64_t *m, uint64_t *n, uint64_t *nnz) {
   char line[1025];
   char header[64];
   char object[64];
@@ -51,7 +145,8 @@ static void readHeader(FILE *file, char *name, uint64_t *m, uint64_t *n,
   char field[64];
   char symmetry[64];
   // Read header line.
-  if (fscanf(file, "%63s %63s %63s %63s %63s\n", header, object, format, field,
+  pos = getLine(pos, end, line, sizeof(line));
+  if (sscanf(line, "%63s %63s %63s %63s %63s", header, object, format, field,
              symmetry) != 5) {
     fprintf(stderr, "Corrupt header in %s\n", name);
     exit(1);
@@ -65,12 +160,15 @@ static void readHeader(FILE *file, char *name, uint64_t *m, uint64_t *n,
             "Cannot find a general sparse matrix with type real in %s\n", name);
     exit(1);
   }
-  // Skip comments.
+  // Skip white space and comments.
+  while (pos != end && isspace(*pos))
+    pos++;
   while (1) {
-    if (!fgets(line, 1025, file)) {
+    if (pos == end) {
       fprintf(stderr, "Cannot find data in %s\n", name);
       exit(1);
     }
+    pos = getLine(pos, end, line, sizeof(line));
     if (line[0] != '%')
       break;
   }
@@ -79,18 +177,168 @@ static void readHeader(FILE *file, char *name, uint64_t *m, uint64_t *n,
     fprintf(stderr, "Cannot find size in %s\n", name);
     exit(1);
   }
+  return pos;
 }
 
-// Read next data item.
-static void readItem(FILE *file, char *name, uint64_t *i, uint64_t *j,
-                     double *d) {
-  if (fscanf(file, "%" PRIu64 " %" PRIu64 " %lg\n", i, j, d) != 3) {
+static bool isBlank(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' ||
+         c == '\f';
+}
+
+// Parse an unsigned integer the way fscanf does, and advance pos past it.
+static bool parseIndex(const char *&pos, const char *end, uint64_t *value) {
+  while (pos != end && isBlank(*pos))
+    pos++;
+  if (pos != end && *pos == '+')
+    pos++;
+  if (pos == end || *pos < '0' || *pos > '9')
+    return false;
+  uint64_t v = 0;
+  for (; pos != end && *pos >= '0' && *pos <= '9'; pos++)
+    v = v * 10 + (*pos - '0');
+  *value = v;
+  return true;
+}
+
+// Parse a floating-point number the way fscanf does, and advance pos past it.
+// Decimal numbers whose digits and power of ten are exactly representable
+// in a double are converted directly, with correct rounding; all the others
+// are left to strtod.
+static bool parseValue(const char *&pos, const char *end, double *value) {
+  static const double powersOf10[] = {
+      1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  while (pos != end && isBlank(*pos))
+    pos++;
+  const char *token = pos;
+  while (pos != end && !isBlank(*pos))
+    pos++;
+  if (token == pos)
+    return false;
+
+  const char *c = token;
+  bool negative = false;
+  if (*c == '+' || *c == '-')
+    negative = *c++ == '-';
+  uint64_t mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+  bool hasDigits = false;
+  for (; c != pos && *c >= '0' && *c <= '9'; c++, hasDigits = true)
+    if (mantissa || *c != '0') {
+      mantissa = mantissa * 10 + (*c - '0');
+      digits++;
+    }
+  if (c != pos && *c == '.')
+    for (c++; c != pos && *c >= '0' && *c <= '9'; c++, hasDigits = true) {
+      if (mantissa || *c != '0') {
+        mantissa = mantissa * 10 + (*c - '0');
+        digits++;
+      }
+      exponent--;
+    }
+  if (hasDigits && c != pos && (*c == 'e' || *c == 'E')) {
+    const char *e = c + 1;
+    bool negativeExponent = false;
+    if (e != pos && (*e == '+' || *e == '-'))
+      negativeExponent = *e++ == '-';
+    int explicitExponent = 0;
+    if (e != pos && *e >= '0' && *e <= '9') {
+      for (; e != pos && *e >= '0' && *e <= '9' && explicitExponent < 1000; e++)
+        explicitExponent = explicitExponent * 10 + (*e - '0');
+      exponent += negativeExponent ? -explicitExponent : explicitExponent;
+      c = e;
+    }
+  }
+  if (hasDigits && c == pos && digits <= 15 && exponent >= -22 &&
+      exponent <= 22) {
+    double v = static_cast<double>(mantissa);
+    v = exponent < 0 ? v / powersOf10[-exponent] : v * powersOf10[exponent];
+    *value = negative ? -v : v;
+    return true;
+  }
+
+  char buffer[128];
+  size_t size = pos - token;
+  if (size >= sizeof(buffer))
+    return false;
+  memcpy(buffer, token, size);
+  buffer[size] = 0;
+  char *parsed;
+  *value = strtod(buffer, &parsed);
+  // As fscanf, accept the longest prefix of the token that is a number.
+  if (parsed == buffer)
+    return false;
+  pos = token + (parsed - buffer);
+  return true;
+}
+
+// Read the data items in [pos, end) into items, and return false if one is
+// incomplete.
+static bool readItemRange(const char *pos, const char *end,
+                          std::vector<MatrixItem> &items) {
+  while (1) {
+    while (pos != end && isBlank(*pos))
+      pos++;
+    if (pos == end)
+      return true;
+    MatrixItem item;
+    if (!parseIndex(pos, end, &item.i) || !parseIndex(pos, end, &item.j) ||
+        !parseValue(pos, end, &item.d))
+      return false;
+    // Translate 1-based to 0-based.
+    item.i = item.i - 1;
+    item.j = item.j - 1;
+    items.push_back(item);
+  }
+}
+
+// Read the nnz data items at pos, in chunks of whole lines parsed by as many
+// threads as the size of the data calls for.
+static void readItems(const char *pos, const char *end, char *name,
+                      uint64_t nnz,
+                      std::vector<std::vector<MatrixItem>> &chunks) {
+  const size_t minChunkSize = 1 << 20;
+  size_t numChunks = std::thread::hardware_concurrency();
+  if (numChunks == 0)
+    numChunks = 1;
+  if (numChunks > static_cast<size_t>(end - pos) / minChunkSize)
+    numChunks = static_cast<size_t>(end - pos) / minChunkSize + 1;
+
+  std::vector<const char *> bounds(numChunks + 1, end);
+  bounds[0] = pos;
+  for (size_t c = 1; c < numChunks; c++) {
+    const char *bound = pos + (end - pos) / numChunks * c;
+    if (bound < bounds[c - 1])
+      bound = bounds[c - 1];
+    bound = static_cast<const char *>(memchr(bound, '\n', end - bound));
+    bounds[c] = bound ? bound + 1 : end;
+  }
+
+  chunks.assign(numChunks, std::vector<MatrixItem>());
+  std::vector<char> complete(numChunks);
+  auto readChunk = [&](size_t c) {
+    chunks[c].reserve(std::count(bounds[c], bounds[c + 1], '\n') + 1);
+    complete[c] = readItemRange(bounds[c], bounds[c + 1], chunks[c]);
+  };
+  std::vector<std::thread> threads;
+  for (size_t c = 1; c < numChunks; c++)
+    threads.emplace_back(readChunk, c);
+  readChunk(0);
+  for (std::thread &thread : threads)
+    thread.join();
+
+  // The items after the first nnz ones are ignored, as they are never read.
+  uint64_t count = 0;
+  for (size_t c = 0; c < numChunks && count < nnz; c++) {
+    count += chunks[c].size();
+    if (!complete[c] && count < nnz)
+      break;
+  }
+  if (count < nnz) {
     fprintf(stderr, "Cannot find next data item in %s\n", name);
     exit(1);
   }
-  // Translate 1-based to 0-based.
-  *i = *i - 1;
-  *j = *j - 1;
 }
 
 //===----------------------------------------------------------------------===//
@@ -128,23 +376,31 @@ static void readItem(FILE *file, char *name, uint64_t *i, uint64_t *j,
 //===----------------------------------------------------------------------===//
 
 // Currently open matrix. This is *not* thread-safe or re-entrant.
-static FILE *sparseFile = nullptr;
+static MatrixFile sparseFile;
 static char *sparseFilename = nullptr;
+static std::vector<std::vector<MatrixItem>> sparseItems;
+static size_t sparseChunk = 0;
+static size_t sparseItem = 0;
 
 extern "C" void openMatrixC(char *filename, uint64_t *mdata, uint64_t *ndata,
                             uint64_t *nnzdata) {
-  if (sparseFile != nullptr) {
+  if (sparseFilename != nullptr) {
     fprintf(stderr, "Other file still open %s vs. %s\n", sparseFilename,
             filename);
     exit(1);
   }
-  sparseFile = fopen(filename, "r");
-  if (!sparseFile) {
+  if (!sparseFile.open(filename)) {
     fprintf(stderr, "Cannot find %s\n", filename);
     exit(1);
   }
   sparseFilename = filename;
-  readHeader(sparseFile, filename, mdata, ndata, nnzdata);
+  const char *data = readHeader(sparseFile.begin, sparseFile.end, filename,
+                                mdata, ndata, nnzdata);
+  readItems(data, sparseFile.end, filename, *nnzdata, sparseItems);
+  // The items are all parsed, the file is not needed anymore.
+  sparseFile.close();
+  sparseChunk = 0;
+  sparseItem = 0;
 }
 
 // "MLIRized" version.
@@ -157,11 +413,23 @@ extern "C" void openMatrix(char *filename, uint64_t *mbase, uint64_t *mdata,
 
 extern "C" void readMatrixItemC(uint64_t *idata, uint64_t *jdata,
                                 double *ddata) {
-  if (sparseFile == nullptr) {
+  if (sparseFilename == nullptr) {
     fprintf(stderr, "Cannot read item from unopened matrix\n");
     exit(1);
   }
-  readItem(sparseFile, sparseFilename, idata, jdata, ddata);
+  while (sparseChunk < sparseItems.size() &&
+         sparseItem == sparseItems[sparseChunk].size()) {
+    sparseChunk++;
+    sparseItem = 0;
+  }
+  if (sparseChunk == sparseItems.size()) {
+    fprintf(stderr, "Cannot find next data item in %s\n", sparseFilename);
+    exit(1);
+  }
+  const MatrixItem &item = sparseItems[sparseChunk][sparseItem++];
+  *idata = item.i;
+  *jdata = item.j;
+  *ddata = item.d;
 }
 
 // "MLIRized" version.
@@ -172,12 +440,11 @@ extern "C" void readMatrixItem(uint64_t *ibase, uint64_t *idata, int64_t ioff,
 }
 
 extern "C" void closeMatrix() {
-  if (sparseFile == nullptr) {
+  if (sparseFilename == nullptr) {
     fprintf(stderr, "Cannot close unopened matrix\n");
     exit(1);
   }
-  fclose(sparseFile);
-  sparseFile = nullptr;
+  std::vector<std::vector<MatrixItem>>().swap(sparseItems);
   sparseFilename = nullptr;
 }
 
@@ -42,7 +42,7 @@ static auto InitializeCtx = [] {
   return 0;
 }();
 
-extern "C" CUmodule mgpuModuleLoad(void *data) {
+extern "C" CUmodule mgpuModuleLoad(void *data, intptr_t /*sizeBytes*/) {
   CUmodule module = nullptr;
   CUDA_REPORT_IF_ERROR(cuModuleLoadData(&module, data));
   return module;
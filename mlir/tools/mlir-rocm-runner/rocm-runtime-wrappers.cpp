@@ -41,7 +41,7 @@ static auto InitializeCtx = [] {
   return 0;
 }();
 
-extern "C" hipModule_t mgpuModuleLoad(void *data) {
+extern "C" hipModule_t mgpuModuleLoad(void *data, intptr_t /*sizeBytes*/) {
   hipModule_t module = nullptr;
   HIP_REPORT_IF_ERROR(hipModuleLoadData(&module, data));
   return module;
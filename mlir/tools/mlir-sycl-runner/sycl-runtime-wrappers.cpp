@@ -0,0 +1,354 @@
+//===- sycl-runtime-wrappers.cpp - MLIR SYCL runner wrapper library -------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Implements the C wrappers the GPU to LLVM lowering calls, on top of the
+// SYCL Plugin Interface (PI), so that kernels compiled to SPIR-V run through
+// the same plugins as the SYCL runtime, e.g. on Level Zero. The plugin is
+// loaded from the library named by the MLIR_SYCL_PI_PLUGIN environment
+// variable, libpi_level_zero.so by default, and the first GPU it reports is
+// used.
+//
+// The modules must be SPIR-V with the Kernel capability, whose entry points
+// take their arguments as function parameters. The sizes of the kernel
+// arguments are taken from the types of these parameters. Streams map to PI
+// in-order queues, and the memory allocated by mgpuMemAlloc is shared USM so
+// that the host can access it too.
+//
+//===----------------------------------------------------------------------===//
+
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <dlfcn.h>
+
+#include "llvm/Support/raw_ostream.h"
+
+#include "CL/sycl/detail/pi.h"
+
+#define PI_REPORT_IF_ERROR(expr)                                               \
+  [](pi_result result) {                                                       \
+    if (result == PI_SUCCESS)                                                  \
+      return;                                                                  \
+    llvm::errs() << "'" << #expr << "' failed with '" << result << "'\n";      \
+  }(expr)
+
+namespace {
+
+struct Runtime {
+  pi_plugin plugin;
+  pi_device device = nullptr;
+  pi_context context = nullptr;
+
+  const pi_plugin::FunctionPointers &pi() const {
+    return plugin.PiFunctionTable;
+  }
+};
+
+Runtime loadRuntime() {
+  Runtime runtime;
+  std::memset(&runtime.plugin, 0, sizeof(runtime.plugin));
+  const char *name = std::getenv("MLIR_SYCL_PI_PLUGIN");
+  if (!name)
+    name = "libpi_level_zero.so";
+  void *library = dlopen(name, RTLD_NOW | RTLD_LOCAL);
+  if (!library) {
+    llvm::errs() << "cannot load the PI plugin '" << name << "'\n";
+    return runtime;
+  }
+  auto init = reinterpret_cast<decltype(&piPluginInit)>(
+      dlsym(library, "piPluginInit"));
+  if (!init) {
+    llvm::errs() << "'" << name << "' is not a PI plugin\n";
+    return runtime;
+  }
+  std::strncpy(runtime.plugin.PiVersion, _PI_H_VERSION_STRING,
+               sizeof(runtime.plugin.PiVersion));
+  PI_REPORT_IF_ERROR(init(&runtime.plugin));
+  const auto &pi = runtime.pi();
+
+  pi_uint32 numPlatforms = 0;
+  PI_REPORT_IF_ERROR(pi.piPlatformsGet(0, nullptr, &numPlatforms));
+  std::vector<pi_platform> platforms(numPlatforms);
+  PI_REPORT_IF_ERROR(
+      pi.piPlatformsGet(numPlatforms, platforms.data(), nullptr));
+  for (pi_platform platform : platforms) {
+    pi_uint32 numDevices = 0;
+    if (pi.piDevicesGet(platform, PI_DEVICE_TYPE_GPU, 1, &runtime.device,
+                        &numDevices) == PI_SUCCESS &&
+        numDevices)
+      break;
+    runtime.device = nullptr;
+  }
+  if (!runtime.device) {
+    llvm::errs() << "no GPU found by the PI plugin '" << name << "'\n";
+    return runtime;
+  }
+  PI_REPORT_IF_ERROR(pi.piContextCreate(nullptr, 1, &runtime.device, nullptr,
+                                        nullptr, &runtime.context));
+  return runtime;
+}
+
+const Runtime &getRuntime() {
+  static Runtime runtime = loadRuntime();
+  return runtime;
+}
+
+/// How a kernel argument is passed.
+struct ArgInfo {
+  size_t size;
+  /// Whether it is a pointer to global memory, i.e. to USM.
+  bool isGlobalPointer;
+};
+
+using KernelSignatures = std::unordered_map<std::string, std::vector<ArgInfo>>;
+
+/// Returns the arguments of the kernels of the SPIR-V binary, by kernel name.
+KernelSignatures getKernelSignatures(const uint32_t *words, size_t numWords) {
+  enum : uint32_t {
+    OpMemoryModel = 14,
+    OpEntryPoint = 15,
+    OpTypeInt = 21,
+    OpTypeFloat = 22,
+    OpTypeVector = 23,
+    OpTypePointer = 32,
+    OpTypeFunction = 33,
+    OpFunction = 54,
+    ExecutionModelKernel = 6,
+    AddressingModelPhysical32 = 1,
+    StorageClassCrossWorkgroup = 5,
+  };
+  constexpr size_t headerSize = 5;
+
+  size_t pointerSize = 8;
+  std::unordered_map<uint32_t, std::string> entryPoints;
+  std::unordered_map<uint32_t, ArgInfo> types;
+  std::unordered_map<uint32_t, std::vector<uint32_t>> functionTypes;
+  KernelSignatures signatures;
+
+  for (size_t i = headerSize; i < numWords;) {
+    uint32_t numOperands = (words[i] >> 16) - 1;
+    uint32_t opcode = words[i] & 0xffff;
+    const uint32_t *ops = words + i + 1;
+    if (numOperands + 1 == 0 || i + 1 + numOperands > numWords)
+      break;
+    i += numOperands + 1;
+
+    switch (opcode) {
+    case OpMemoryModel:
+      if (ops[0] == AddressingModelPhysical32)
+        pointerSize = 4;
+      break;
+    case OpEntryPoint:
+      if (ops[0] == ExecutionModelKernel)
+        entryPoints[ops[1]] = reinterpret_cast<const char *>(ops + 2);
+      break;
+    case OpTypeInt:
+    case OpTypeFloat:
+      types[ops[0]] = {ops[1] / 8, false};
+      break;
+    case OpTypeVector: {
+      // Vectors of 3 elements take the space of 4.
+      uint32_t count = ops[2] == 3 ? 4 : ops[2];
+      types[ops[0]] = {types[ops[1]].size * count, false};
+      break;
+    }
+    case OpTypePointer:
+      types[ops[0]] = {pointerSize, ops[1] == StorageClassCrossWorkgroup};
+      break;
+    case OpTypeFunction:
+      // Skip the return type.
+      functionTypes[ops[0]].assign(ops + 2, ops + numOperands);
+      break;
+    case OpFunction: {
+      auto entryPoint = entryPoints.find(ops[1]);
+      if (entryPoint == entryPoints.end())
+        break;
+      std::vector<ArgInfo> &args = signatures[entryPoint->second];
+      for (uint32_t paramType : functionTypes[ops[3]])
+        args.push_back(types[paramType]);
+      break;
+    }
+    default:
+      break;
+    }
+  }
+  return signatures;
+}
+
+struct Kernel {
+  pi_kernel kernel;
+  const std::vector<ArgInfo> *args;
+};
+
+struct Module {
+  pi_program program;
+  KernelSignatures signatures;
+  std::vector<std::unique_ptr<Kernel>> kernels;
+};
+
+/// A PI event is created by the command it tracks, so the event returned to
+/// the caller holds the one of the last command it was recorded for.
+struct Event {
+  pi_event event = nullptr;
+};
+
+} // namespace
+
+extern "C" Module *mgpuModuleLoad(void *data, intptr_t sizeBytes) {
+  const Runtime &runtime = getRuntime();
+  auto module = std::make_unique<Module>();
+  module->program = nullptr;
+  PI_REPORT_IF_ERROR(runtime.pi().piProgramCreate(runtime.context, data,
+                                                  sizeBytes, &module->program));
+  PI_REPORT_IF_ERROR(runtime.pi().piProgramBuild(
+      module->program, 1, &runtime.device, "", nullptr, nullptr));
+  module->signatures =
+      getKernelSignatures(static_cast<const uint32_t *>(data),
+                          sizeBytes / sizeof(uint32_t));
+  return module.release();
+}
+
+extern "C" void mgpuModuleUnload(Module *module) {
+  const Runtime &runtime = getRuntime();
+  for (auto &kernel : module->kernels)
+    PI_REPORT_IF_ERROR(runtime.pi().piKernelRelease(kernel->kernel));
+  PI_REPORT_IF_ERROR(runtime.pi().piProgramRelease(module->program));
+  delete module;
+}
+
+extern "C" Kernel *mgpuModuleGetFunction(Module *module, const char *name) {
+  auto signature = module->signatures.find(name);
+  if (signature == module->signatures.end()) {
+    llvm::errs() << "no kernel named '" << name << "' in the SPIR-V module\n";
+    return nullptr;
+  }
+  auto kernel = std::make_unique<Kernel>();
+  kernel->kernel = nullptr;
+  kernel->args = &signature->second;
+  PI_REPORT_IF_ERROR(getRuntime().pi().piKernelCreate(module->program, name,
+                                                      &kernel->kernel));
+  module->kernels.push_back(std::move(kernel));
+  return module->kernels.back().get();
+}
+
+// The wrapper uses intptr_t instead of size_t to match the type of MLIR's
+// index type. This avoids the need for casts in the generated MLIR code.
+extern "C" void mgpuLaunchKernel(Kernel *kernel, intptr_t gridX,
+                                 intptr_t gridY, intptr_t gridZ,
+                                 intptr_t blockX, intptr_t blockY,
+                                 intptr_t blockZ, int32_t smem, pi_queue queue,
+                                 void **params, void ** /*extra*/) {
+  const auto &pi = getRuntime().pi();
+  if (smem != 0)
+    llvm::errs() << "dynamic shared memory is not supported, ignoring "
+                 << smem << " bytes\n";
+  for (size_t i = 0, e = kernel->args->size(); i < e; ++i) {
+    const ArgInfo &arg = (*kernel->args)[i];
+    if (arg.isGlobalPointer)
+      PI_REPORT_IF_ERROR(pi.piextKernelSetArgPointer(kernel->kernel, i,
+                                                     arg.size, params[i]));
+    else
+      PI_REPORT_IF_ERROR(
+          pi.piKernelSetArg(kernel->kernel, i, arg.size, params[i]));
+  }
+  size_t globalSize[] = {size_t(gridX * blockX), size_t(gridY * blockY),
+                         size_t(gridZ * blockZ)};
+  size_t localSize[] = {size_t(blockX), size_t(blockY), size_t(blockZ)};
+  pi_event event = nullptr;
+  PI_REPORT_IF_ERROR(pi.piEnqueueKernelLaunch(queue, kernel->kernel, 3,
+                                              nullptr, globalSize, localSize,
+                                              0, nullptr, &event));
+  if (event)
+    PI_REPORT_IF_ERROR(pi.piEventRelease(event));
+}
+
+extern "C" pi_queue mgpuStreamCreate() {
+  const Runtime &runtime = getRuntime();
+  pi_queue queue = nullptr;
+  PI_REPORT_IF_ERROR(runtime.pi().piQueueCreate(
+      runtime.context, runtime.device, /*properties=*/0, &queue));
+  return queue;
+}
+
+extern "C" void mgpuStreamDestroy(pi_queue queue) {
+  PI_REPORT_IF_ERROR(getRuntime().pi().piQueueRelease(queue));
+}
+
+extern "C" void mgpuStreamSynchronize(pi_queue queue) {
+  PI_REPORT_IF_ERROR(getRuntime().pi().piQueueFinish(queue));
+}
+
+extern "C" void mgpuStreamWaitEvent(pi_queue queue, Event *event) {
+  if (!event->event)
+    return;
+  pi_event marker = nullptr;
+  PI_REPORT_IF_ERROR(getRuntime().pi().piEnqueueEventsWaitWithBarrier(
+      queue, 1, &event->event, &marker));
+  if (marker)
+    PI_REPORT_IF_ERROR(getRuntime().pi().piEventRelease(marker));
+}
+
+extern "C" Event *mgpuEventCreate() { return new Event(); }
+
+extern "C" void mgpuEventDestroy(Event *event) {
+  if (event->event)
+    PI_REPORT_IF_ERROR(getRuntime().pi().piEventRelease(event->event));
+  delete event;
+}
+
+extern "C" void mgpuEventSynchronize(Event *event) {
+  if (event->event)
+    PI_REPORT_IF_ERROR(getRuntime().pi().piEventsWait(1, &event->event));
+}
+
+extern "C" void mgpuEventRecord(Event *event, pi_queue queue) {
+  const auto &pi = getRuntime().pi();
+  if (event->event)
+    PI_REPORT_IF_ERROR(pi.piEventRelease(event->event));
+  event->event = nullptr;
+  // A barrier with no events waits for all the commands enqueued before it.
+  PI_REPORT_IF_ERROR(
+      pi.piEnqueueEventsWaitWithBarrier(queue, 0, nullptr, &event->event));
+}
+
+extern "C" void *mgpuMemAlloc(uint64_t sizeBytes, pi_queue /*queue*/) {
+  const Runtime &runtime = getRuntime();
+  void *ptr = nullptr;
+  PI_REPORT_IF_ERROR(runtime.pi().piextUSMSharedAlloc(
+      &ptr, runtime.context, runtime.device, nullptr, sizeBytes,
+      /*alignment=*/0));
+  return ptr;
+}
+
+extern "C" void mgpuMemFree(void *ptr, pi_queue queue) {
+  // The memory may still be used by the commands of the queue.
+  if (queue)
+    mgpuStreamSynchronize(queue);
+  PI_REPORT_IF_ERROR(getRuntime().pi().piextUSMFree(getRuntime().context, ptr));
+}
+
+// PI can't make existing host memory accessible to the device, so the data
+// has to be in memory allocated with gpu.alloc instead.
+extern "C" void mgpuMemHostRegister(void * /*ptr*/, uint64_t /*sizeBytes*/) {
+  llvm::errs() << "host memory registration is not supported by the SYCL "
+                  "runtime wrappers, allocate the memory with gpu.alloc "
+                  "instead\n";
+}
+
+extern "C" void mgpuMemHostRegisterMemRef(int64_t /*rank*/,
+                                          void * /*descriptor*/,
+                                          int64_t /*elementSizeBytes*/) {
+  llvm::errs() << "gpu.host_register is not supported by the SYCL runtime "
+                  "wrappers, allocate the memory with gpu.alloc instead\n";
+}
@@ -17,6 +17,7 @@
 #include "utils.h"
 #include <CL/cl.h>
 
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Path.h"
 
@@ -26,7 +27,9 @@
 #include <iostream>
 #include <map>
 #include <memory>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -66,12 +69,14 @@ using CLContextUPtr = std::unique_ptr<
  * \param FileNames (const std::vector<std::string>).
  * \param PlatformId (cl_platform_id).
  * \param DeviceId (cl_device_id).
+ * \param Log (std::ostream &) receives the progress messages.
  * \return a tuple of vector of unique pointers to programs, error message and
  * return code.
  */
 std::tuple<std::vector<CLProgramUPtr>, std::string, cl_int>
 generateProgramsFromBinaries(const std::vector<std::string> &FileNames,
-                             cl_platform_id PlatformId, cl_device_id DeviceId) {
+                             cl_platform_id PlatformId, cl_device_id DeviceId,
+                             std::ostream &Log) {
   // step 0: define internal types
 
   enum SupportedTypes : int8_t { BEGIN, ELF = BEGIN, SPIRV, UNKNOWN, END };
@@ -201,7 +206,7 @@ generateProgramsFromBinaries(const std::vector<std::string> &FileNames,
 
     Programs.push_back(Program);
 
-    std::cout << "OpenCL program was successfully created from " +
+    Log << "OpenCL program was successfully created from " +
                      SupportedTypesToNames[FileType] + " file " + FileName
               << '\n';
   }
@@ -251,14 +256,155 @@ getCompilerBuildLog(const CLProgramUPtr &ProgramUPtr, cl_device_id Device) {
                          CLErr);
 }
 
+/*! \brief Build the input binary for a device type and write the OpenCL
+ * program binary to a file. The builds for several device types run on
+ * concurrent threads, so the progress messages are returned instead of
+ * printed, to keep the output of each device in one piece.
+ * \param Device (DeviceType).
+ * \param InputBinary (const std::string &).
+ * \param BuildOptions (const std::string &).
+ * \param OutputFile (const std::string &).
+ * \return a tuple of progress messages, error message and return code.
+ */
+std::tuple<std::string, std::string, cl_int>
+buildProgramForDevice(DeviceType Device, const std::string &InputBinary,
+                      const std::string &BuildOptions,
+                      const std::string &OutputFile) {
+  std::ostringstream Log;
+  cl_int CLErr(CL_SUCCESS);
+  std::string ErrorMessage;
+
+  // step 1: get OpenCL platform
+  cl_platform_id PlatformId = nullptr;
+  std::string PlatformName;
+  std::tie(PlatformId, PlatformName, ErrorMessage, CLErr) =
+      getOpenCLPlatform(Device);
+
+  if (clFailed(CLErr)) {
+    return std::make_tuple(Log.str(), ErrorMessage, CLErr);
+  }
+
+  Log << "Platform name: " << PlatformName << '\n';
+
+  // step 2: get OpenCL device
+  cl_device_id DeviceId = nullptr;
+  std::tie(DeviceId, ErrorMessage, CLErr) =
+      getOpenCLDevice(PlatformId, Device);
+
+  if (clFailed(CLErr)) {
+    return std::make_tuple(Log.str(), ErrorMessage, CLErr);
+  }
+
+  std::string DeviceName;
+  std::tie(DeviceName, ErrorMessage, CLErr) =
+      getOpenCLDeviceInfo(DeviceId, CL_DEVICE_NAME);
+
+  if (clFailed(CLErr)) {
+    return std::make_tuple(Log.str(), ErrorMessage, CLErr);
+  }
+
+  Log << "Device name: " << DeviceName << '\n';
+
+  // step 3: get driver version
+  std::string DriverVersion;
+  std::tie(DriverVersion, ErrorMessage, CLErr) =
+      getOpenCLDeviceInfo(DeviceId, CL_DRIVER_VERSION);
+
+  if (clFailed(CLErr)) {
+    return std::make_tuple(Log.str(), ErrorMessage, CLErr);
+  }
+
+  Log << "Driver version: " << DriverVersion << '\n';
+
+  // step 4: generate OpenCL programs from input binaries
+  std::vector<CLProgramUPtr> Progs;
+  std::tie(Progs, ErrorMessage, CLErr) =
+      generateProgramsFromBinaries({InputBinary}, PlatformId, DeviceId, Log);
+
+  if (clFailed(CLErr)) {
+    return std::make_tuple(Log.str(), ErrorMessage, CLErr);
+  }
+
+  CLProgramUPtr ProgramUPtr(std::move(Progs[0]));
+
+  // step 5: build OpenCL program
+  CLErr = clBuildProgram(ProgramUPtr.get(), 1, &DeviceId, BuildOptions.c_str(),
+                         nullptr, nullptr);
+
+  std::string CompilerBuildLog;
+  std::string BuildLogErrorMessage;
+  std::tie(CompilerBuildLog, BuildLogErrorMessage, std::ignore) =
+      getCompilerBuildLog(ProgramUPtr, DeviceId);
+
+  // don't exit because we should show compiler build log and/or error message
+  // from clBuildProgram if it will be
+  if (!CompilerBuildLog.empty()) {
+    Log << CompilerBuildLog << '\n';
+  }
+
+  if (clFailed(CLErr)) {
+    return std::make_tuple(
+        Log.str(),
+        BuildLogErrorMessage +
+            formatCLError("Failed to build a program:", CLErr) + '\n',
+        CLErr);
+  }
+
+  // step 6: get program binary
+  size_t ProgramBinarySize = 0;
+  CLErr = clGetProgramInfo(ProgramUPtr.get(), CL_PROGRAM_BINARY_SIZES,
+                           sizeof(size_t), &ProgramBinarySize, nullptr);
+  if (clFailed(CLErr) || ProgramBinarySize == 0) {
+    return std::make_tuple(
+        Log.str(),
+        BuildLogErrorMessage +
+            formatCLError("Failed to get OpenCL program binary size", CLErr) +
+            '\n',
+        CLErr);
+  }
+
+  std::vector<unsigned char> ProgramBinaries(ProgramBinarySize, '\0');
+  auto ProgramBinariesRaw = ProgramBinaries.data();
+  CLErr =
+      clGetProgramInfo(ProgramUPtr.get(), CL_PROGRAM_BINARIES,
+                       sizeof(unsigned char *), &ProgramBinariesRaw, nullptr);
+  if (clFailed(CLErr)) {
+    return std::make_tuple(
+        Log.str(),
+        BuildLogErrorMessage +
+            formatCLError("Failed to get OpenCL program binary data", CLErr) +
+            '\n',
+        CLErr);
+  }
+
+  // step 7: write program binary (in ELF format) to the file
+  std::ofstream OutputELF(OutputFile, std::ofstream::binary);
+
+  for (const auto &Chunk : ProgramBinaries) {
+    OutputELF << Chunk;
+  }
+
+  if (!OutputELF.good()) {
+    return std::make_tuple(Log.str(),
+                           BuildLogErrorMessage +
+                               "Failed to create OpenCL program binary file\n",
+                           OPENCL_AOT_FAILED_TO_CREATE_ELF);
+  }
+  Log << "OpenCL program binary file was successfully created: " << OutputFile
+      << '\n';
+
+  return std::make_tuple(Log.str(), BuildLogErrorMessage, CL_SUCCESS);
+}
+
 int main(int Argc, char *Argv[]) {
   // step 0: set command line options
   cl::opt<std::string> OptInputBinary(
       cl::Positional, cl::Required,
       cl::desc("<input SPIR-V or OpenCL program binary>"),
       cl::value_desc("filename"));
-  cl::opt<DeviceType> OptDevice(
-      "device", cl::Required, cl::desc("Set target device type:"),
+  cl::list<DeviceType> OptDevice(
+      "device", cl::OneOrMore, cl::CommaSeparated,
+      cl::desc("Set target device types, built in parallel:"),
       cl::values(
           clEnumVal(cpu, "Intel(R) processor device"),
           clEnumVal(gpu, "Intel(R) Processor Graphics device"),
@@ -297,7 +443,13 @@ int main(int Argc, char *Argv[]) {
               "Intel(R) SSE, and SSSE3 instructions")));
   cl::opt<std::string> OptOutputElf(
       "o", cl::init("output.bin"),
-      cl::desc("Specify the output OpenCL program binary filename"),
+      cl::desc("Specify the output OpenCL program binary filename; with "
+               "several device types, the type is appended to its stem"),
+      cl::value_desc("filename"));
+  cl::opt<std::string> OptOutputFileList(
+      "out-file-list",
+      cl::desc("Write the list of output binaries, one per line in the order "
+               "of --device, as llvm-foreach --out-file-list does"),
       cl::value_desc("filename"));
   cl::list<std::string> OptBuildOptions("bo", cl::ZeroOrMore,
                                         cl::desc("Set OpenCL build options"),
@@ -314,63 +466,25 @@ int main(int Argc, char *Argv[]) {
     return OPENCL_AOT_FILE_NOT_EXIST;
   }
 
+  const auto UsesCPUTargetArch = [](DeviceType Device) {
+    return Device == cpu || Device == fpga_fast_emu;
+  };
   if (OptMArch.getNumOccurrences() &&
-      (OptDevice.getValue() != cpu && OptDevice.getValue() != fpga_fast_emu)) {
+      std::none_of(OptDevice.begin(), OptDevice.end(), UsesCPUTargetArch)) {
     std::cerr << "Use --march option with --device=cpu or "
                  "--device=fpga_fast_emu only";
     return OPENCL_AOT_OPTIONS_COEXISTENCE_FAILURE;
   }
 
-  cl_int CLErr(CL_SUCCESS);
-
-  // step 2: get OpenCL platform
-  cl_platform_id PlatformId = nullptr;
-  std::string PlatformName;
-  std::string ErrorMessage;
-  std::tie(PlatformId, PlatformName, ErrorMessage, CLErr) =
-      getOpenCLPlatform(OptDevice);
-
-  if (clFailed(CLErr)) {
-    std::cerr << ErrorMessage;
-    return CLErr;
-  }
-
-  std::cout << "Platform name: " << PlatformName << '\n';
-
-  // step 3: get OpenCL device
-  cl_device_id DeviceId = nullptr;
-  std::tie(DeviceId, ErrorMessage, CLErr) =
-      getOpenCLDevice(PlatformId, OptDevice);
-
-  if (clFailed(CLErr)) {
-    std::cerr << ErrorMessage;
-    return CLErr;
-  }
-
-  std::string DeviceName;
-  std::tie(DeviceName, ErrorMessage, CLErr) =
-      getOpenCLDeviceInfo(DeviceId, CL_DEVICE_NAME);
-
-  if (clFailed(CLErr)) {
-    std::cerr << ErrorMessage;
-    return CLErr;
-  }
-
-  std::cout << "Device name: " << DeviceName << '\n';
-
-  // step 4: get driver version
-  std::string DriverVersion;
-  std::tie(DriverVersion, ErrorMessage, CLErr) =
-      getOpenCLDeviceInfo(DeviceId, CL_DRIVER_VERSION);
-
-  if (clFailed(CLErr)) {
-    std::cerr << ErrorMessage;
-    return CLErr;
+  std::vector<DeviceType> Devices(OptDevice.begin(), OptDevice.end());
+  for (auto It = Devices.begin(); It != Devices.end(); ++It) {
+    if (std::find(Devices.begin(), It, *It) != It) {
+      std::cerr << "Each device type can be set with --device only once\n";
+      return OPENCL_AOT_OPTIONS_COEXISTENCE_FAILURE;
+    }
   }
 
-  std::cout << "Driver version: " << DriverVersion << '\n';
-
-  // step 5: enable optimizations for target CPU architecture
+  // step 2: enable optimizations for target CPU architecture
   if (OptMArch.getNumOccurrences()) {
     std::string CPUTargetArchEnvVarName = "CL_CONFIG_CPU_TARGET_ARCH";
     std::map<ArchType, std::string> ArchTypeToCPUTargetArchEnvVarValues{
@@ -401,19 +515,7 @@ int main(int Argc, char *Argv[]) {
               << ArchTypeToArchTypeName[OptMArch] << '\n';
   }
 
-  // step 6: generate OpenCL programs from input binaries
-  std::vector<CLProgramUPtr> Progs;
-  std::tie(Progs, ErrorMessage, CLErr) = generateProgramsFromBinaries(
-      {OptInputBinary.c_str()}, PlatformId, DeviceId);
-
-  if (clFailed(CLErr)) {
-    std::cerr << ErrorMessage;
-    return CLErr;
-  }
-
-  CLProgramUPtr ProgramUPtr(std::move(Progs[0]));
-
-  // step 7: set OpenCL build options
+  // step 3: set OpenCL build options
   std::string BuildOptions;
   if (!OptBuildOptions.empty()) {
     for (const auto &BO : OptBuildOptions)
@@ -426,65 +528,71 @@ int main(int Argc, char *Argv[]) {
   }
   std::cout << "Using build options: " << BuildOptions << '\n';
 
-  // step 8: build OpenCL program
-  CLErr = clBuildProgram(ProgramUPtr.get(), 1, &DeviceId, BuildOptions.c_str(),
-                         nullptr, nullptr);
-
-  std::string CompilerBuildLog;
-  std::tie(CompilerBuildLog, ErrorMessage, std::ignore) =
-      getCompilerBuildLog(ProgramUPtr, DeviceId);
-
-  if (!ErrorMessage.empty()) {
-    std::cerr << ErrorMessage;
-    // don't exit because we should show compiler build log and/or error message
-    // from clBuildProgram if it will be
-  }
-
-  if (!CompilerBuildLog.empty()) {
-    std::cout << CompilerBuildLog << '\n';
+  // step 4: name output binaries, e.g. output_cpu.bin and output_gpu.bin for
+  // -o output.bin
+  std::map<DeviceType, std::string> DeviceTypeToSuffix{
+      {cpu, "cpu"}, {gpu, "gpu"}, {fpga_fast_emu, "fpga_fast_emu"}};
+  std::vector<std::string> OutputFiles;
+  for (DeviceType Device : Devices) {
+    if (Devices.size() == 1) {
+      OutputFiles.push_back(OptOutputElf);
+      continue;
+    }
+    SmallString<128> OutputFile(sys::path::parent_path(OptOutputElf));
+    sys::path::append(OutputFile, sys::path::stem(OptOutputElf) + "_" +
+                                      DeviceTypeToSuffix[Device] +
+                                      sys::path::extension(OptOutputElf));
+    OutputFiles.push_back(std::string(OutputFile));
   }
 
-  if (clFailed(CLErr)) {
-    std::cerr << formatCLError("Failed to build a program:", CLErr) << '\n';
-    return CLErr;
+  // step 5: build for all device types in parallel. Each device type has its
+  // own platform, and the threads share nothing but the input file.
+  using BuildResult = std::tuple<std::string, std::string, cl_int>;
+  std::vector<BuildResult> Results(Devices.size());
+  std::vector<std::thread> Builders;
+  for (size_t I = 1; I < Devices.size(); ++I) {
+    Builders.emplace_back([&, I]() {
+      Results[I] = buildProgramForDevice(Devices[I], OptInputBinary,
+                                         BuildOptions, OutputFiles[I]);
+    });
   }
-
-  // step 9: get program binary
-  size_t ProgramBinarySize = 0;
-  CLErr = clGetProgramInfo(ProgramUPtr.get(), CL_PROGRAM_BINARY_SIZES,
-                           sizeof(size_t), &ProgramBinarySize, nullptr);
-  if (clFailed(CLErr) || ProgramBinarySize == 0) {
-    std::cerr << formatCLError("Failed to get OpenCL program binary size",
-                               CLErr)
-              << '\n';
-    return CLErr;
+  Results[0] = buildProgramForDevice(Devices[0], OptInputBinary, BuildOptions,
+                                     OutputFiles[0]);
+  for (auto &Builder : Builders) {
+    Builder.join();
   }
 
-  std::vector<unsigned char> ProgramBinaries(ProgramBinarySize, '\0');
-  auto ProgramBinariesRaw = ProgramBinaries.data();
-  CLErr =
-      clGetProgramInfo(ProgramUPtr.get(), CL_PROGRAM_BINARIES,
-                       sizeof(unsigned char *), &ProgramBinariesRaw, nullptr);
-  if (clFailed(CLErr)) {
-    std::cerr << formatCLError("Failed to get OpenCL program binary data",
-                               CLErr)
-              << '\n';
-    return CLErr;
+  // step 6: print the results in the order of --device, fail with the first
+  // error
+  cl_int Result(CL_SUCCESS);
+  for (const auto &DeviceResult : Results) {
+    std::string Log;
+    std::string ErrorMessage;
+    cl_int CLErr(CL_SUCCESS);
+    std::tie(Log, ErrorMessage, CLErr) = DeviceResult;
+    std::cout << Log;
+    std::cerr << ErrorMessage;
+    if (clFailed(CLErr) && !clFailed(Result)) {
+      Result = CLErr;
+    }
   }
 
-  // step 10: write program binary (in ELF format) to the file
-  std::ofstream OutputELF(OptOutputElf, std::ofstream::binary);
-
-  for (const auto &Chunk : ProgramBinaries) {
-    OutputELF << Chunk;
+  if (clFailed(Result)) {
+    return Result;
   }
 
-  if (!OutputELF.good()) {
-    std::cerr << "Failed to create OpenCL program binary file" << '\n';
-    return OPENCL_AOT_FAILED_TO_CREATE_ELF;
+  // step 7: write the list of output binaries
+  if (!OptOutputFileList.empty()) {
+    std::ofstream OutputFileList(OptOutputFileList);
+    for (const auto &OutputFile : OutputFiles) {
+      OutputFileList << OutputFile << '\n';
+    }
+    if (!OutputFileList.good()) {
+      std::cerr << "Failed to create list of output files " << OptOutputFileList
+                << '\n';
+      return OPENCL_AOT_FAILED_TO_OPEN_FILE;
+    }
   }
-  std::cout << "OpenCL program binary file was successfully created: "
-            << OptOutputElf << '\n';
 
   return CL_SUCCESS;
 }
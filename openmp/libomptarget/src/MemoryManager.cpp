@@ -13,13 +13,29 @@
 // not used, it will not be freed on the device directly. The buffer is
 // organized in a number of buckets for efficient look up. A memory will go to
 // corresponding bucket based on its size. When a new memory request comes in,
-// it will first check whether there is free memory of same size. If yes,
-// returns it directly. Otherwise, allocate one on device.
+// it will first check whether there is free memory of the same size class, i.e.
+// at least as large but less than twice as large. If yes, returns it directly.
+// Otherwise, allocate one on device.
 //
-// It also provides a way to opt out the memory manager. Memory
-// allocation/deallocation will only be managed if the requested size is less
-// than SizeThreshold, which can be configured via an environment variable
-// LIBOMPTARGET_MEMORY_MANAGER_THRESHOLD.
+// Each thread keeps the last few memories it freed in a front cache which it
+// looks up before the buckets, without taking their locks. The front caches
+// are bounded, and moved to the buckets when the thread exits.
+//
+// Memory requests larger than SizeThreshold, which can be configured via an
+// environment variable LIBOMPTARGET_MEMORY_MANAGER_THRESHOLD, are served from
+// chunks allocated on device. A freed chunk is split to serve smaller large
+// requests, taking the smallest free block large enough, and the free blocks
+// of a chunk are merged back together.
+//
+// When the memory buffered goes beyond a high watermark, which can be
+// configured via an environment variable
+// LIBOMPTARGET_MEMORY_MANAGER_HIGH_WATERMARK (0 for no limit), the unused
+// chunks, least recently used first, and then the largest memories of the
+// buckets are freed on device until half of it is buffered. Statistics are
+// reported when the manager is destroyed if LIBOMPTARGET_INFO is set.
+//
+// The memory manager will only be disabled when users set
+// LIBOMPTARGET_MEMORY_MANAGER_THRESHOLD to 0.
 //
 //===----------------------------------------------------------------------===//
 
@@ -28,6 +44,9 @@
 #include "private.h"
 #include "rtl.h"
 
+#include <algorithm>
+#include <cstdlib>
+
 namespace {
 constexpr const size_t BucketSize[] = {
     0,       1U << 2, 1U << 3,  1U << 4,  1U << 5,  1U << 6, 1U << 7,
@@ -83,15 +102,98 @@ int findBucket(size_t Size) {
 
   return L;
 }
+
+/// The number of free nodes per bucket a thread keeps in its front cache
+constexpr const size_t FrontCacheCapacity = 8;
+
+/// The sizes of the chunks and of their blocks are multiples of it
+constexpr const size_t LargeBlockAlignment = 256;
+
+/// The default of the memory buffered at which the memory manager starts
+/// releasing it, which can be configured via an env \p
+/// LIBOMPTARGET_MEMORY_MANAGER_HIGH_WATERMARK. By default, the value is 1GB.
+constexpr const size_t DefaultHighWatermark = 1UL << 30;
+
+/// Whether a free memory of size \p NodeSize can serve a request of \p Size
+bool isSameSizeClass(size_t NodeSize, size_t Size) {
+  return NodeSize >= Size && NodeSize / 2 < Size;
+}
+
+/// The memory managers alive, so that a thread which exits only returns its
+/// front caches to them.
+struct ManagerRegistryTy {
+  std::mutex Mtx;
+  std::unordered_map<uint64_t, MemoryManagerTy *> Managers;
+};
+
+/// The registry is never destroyed since threads can exit after the static
+/// objects are destroyed.
+ManagerRegistryTy &getManagerRegistry() {
+  static ManagerRegistryTy *Registry = new ManagerRegistryTy();
+  return *Registry;
+}
+
+std::atomic<uint64_t> NextManagerID(0);
+
+/// Set when the front caches of the thread are destroyed, after which the
+/// memory managers use the buckets only. It is trivially destructible so that
+/// it can still be read by the destructors of the static objects.
+thread_local bool ThreadCachesDestroyed = false;
+
+/// The front caches of a thread, by memory manager ID
+struct ThreadCachesTy {
+  std::unordered_map<uint64_t, MemoryManagerTy::FrontCacheTy> Caches;
+
+  ~ThreadCachesTy() {
+    ThreadCachesDestroyed = true;
+    ManagerRegistryTy &Registry = getManagerRegistry();
+    std::lock_guard<std::mutex> LG(Registry.Mtx);
+    for (auto &C : Caches) {
+      auto Itr = Registry.Managers.find(C.first);
+      if (Itr != Registry.Managers.end())
+        Itr->second->flushFrontCache(C.second);
+    }
+  }
+};
+
+thread_local ThreadCachesTy ThreadCaches;
 } // namespace
 
 MemoryManagerTy::MemoryManagerTy(DeviceTy &Dev, size_t Threshold)
-    : FreeLists(NumBuckets), FreeListLocks(NumBuckets), Device(Dev) {
+    : FreeLists(NumBuckets), FreeListLocks(NumBuckets),
+      HighWatermark(DefaultHighWatermark), ID(NextManagerID++), Device(Dev) {
   if (Threshold)
     SizeThreshold = Threshold;
+  if (const char *Env =
+          std::getenv("LIBOMPTARGET_MEMORY_MANAGER_HIGH_WATERMARK"))
+    HighWatermark = std::stoul(Env);
+
+  ManagerRegistryTy &Registry = getManagerRegistry();
+  std::lock_guard<std::mutex> LG(Registry.Mtx);
+  Registry.Managers.emplace(ID, this);
 }
 
 MemoryManagerTy::~MemoryManagerTy() {
+  // The front caches of the threads still running are left alone from now on.
+  // Their nodes are in the map table, so they're deallocated below.
+  {
+    ManagerRegistryTy &Registry = getManagerRegistry();
+    std::lock_guard<std::mutex> LG(Registry.Mtx);
+    Registry.Managers.erase(ID);
+  }
+
+  INFO(Device.DeviceID,
+       "Memory manager: %zu allocations, %zu from the thread caches, %zu from "
+       "the buckets, %zu from the chunks, %zu allocations on device\n",
+       Stats.NumAllocations.load(), Stats.FrontCacheHits.load(),
+       Stats.BucketHits.load(), Stats.LargeBlockHits.load(),
+       Stats.DeviceAllocations.load());
+  INFO(Device.DeviceID,
+       "Memory manager: %zu blocks split, %zu trims, %zu bytes released, "
+       "peak of %zu bytes buffered\n",
+       Stats.NumSplits.load(), Stats.NumTrims.load(),
+       Stats.ReleasedSize.load(), Stats.PeakCachedSize.load());
+
   // TODO: There is a little issue that target plugin is destroyed before this
   // object, therefore the memory free will not succeed.
   // Deallocate all memory in map
@@ -99,9 +201,12 @@ MemoryManagerTy::~MemoryManagerTy() {
     assert(Itr->second.Ptr && "nullptr in map table");
     deleteOnDevice(Itr->second.Ptr);
   }
+  for (auto &C : Chunks)
+    deleteOnDevice(C.second.Base);
 }
 
 void *MemoryManagerTy::allocateOnDevice(size_t Size, void *HstPtr) const {
+  ++Stats.DeviceAllocations;
   return Device.RTL->data_alloc(Device.RTLDeviceID, Size, HstPtr);
 }
 
@@ -109,28 +214,131 @@ int MemoryManagerTy::deleteOnDevice(void *Ptr) const {
   return Device.RTL->data_delete(Device.RTLDeviceID, Ptr);
 }
 
-void *MemoryManagerTy::freeAndAllocate(size_t Size, void *HstPtr) {
-  std::vector<void *> RemoveList;
+void MemoryManagerTy::addCachedSize(size_t Size) {
+  const size_t New = CachedSize += Size;
+  size_t Peak = Stats.PeakCachedSize.load();
+  while (New > Peak && !Stats.PeakCachedSize.compare_exchange_weak(Peak, New))
+    ;
+}
+
+MemoryManagerTy::FrontCacheTy *MemoryManagerTy::getFrontCache() {
+  if (ThreadCachesDestroyed)
+    return nullptr;
+  FrontCacheTy &Cache = ThreadCaches.Caches[ID];
+  if (Cache.Lists.empty())
+    Cache.Lists.resize(NumBuckets);
+  return &Cache;
+}
 
-  // Deallocate all memory in FreeList
-  for (int I = 0; I < NumBuckets; ++I) {
-    FreeListTy &List = FreeLists[I];
-    std::lock_guard<std::mutex> Lock(FreeListLocks[I]);
-    if (List.empty())
+void MemoryManagerTy::flushFrontCache(FrontCacheTy &Cache) {
+  for (size_t I = 0; I < Cache.Lists.size(); ++I) {
+    std::vector<NodeTy *> &Cached = Cache.Lists[I];
+    if (Cached.empty())
       continue;
-    for (const NodeTy &N : List) {
-      deleteOnDevice(N.Ptr);
-      RemoveList.push_back(N.Ptr);
+    std::lock_guard<std::mutex> LG(FreeListLocks[I]);
+    for (NodeTy *N : Cached)
+      FreeLists[I].insert(*N);
+    Cached.clear();
+  }
+}
+
+void MemoryManagerTy::eraseFreeBlock(uintptr_t Begin, size_t Size) {
+  auto Range = LargeFreeBlocks.equal_range(Size);
+  for (auto Itr = Range.first; Itr != Range.second; ++Itr) {
+    if (Itr->second == Begin) {
+      LargeFreeBlocks.erase(Itr);
+      return;
     }
-    FreeLists[I].clear();
   }
+  assert(false && "free block not found");
+}
+
+void MemoryManagerTy::releaseFreeChunks(size_t Target) {
+  std::lock_guard<std::mutex> LG(LargeLock);
+
+  std::vector<ChunkTy *> FreeChunks;
+  for (auto &C : Chunks)
+    if (C.second.UsedSize == 0)
+      FreeChunks.push_back(&C.second);
+  std::sort(FreeChunks.begin(), FreeChunks.end(),
+            [](const ChunkTy *LHS, const ChunkTy *RHS) {
+              return LHS->LastUse < RHS->LastUse;
+            });
+
+  for (ChunkTy *C : FreeChunks) {
+    if (CachedSize <= Target)
+      break;
+    // The blocks of a chunk with no used block are merged into one.
+    void *Base = C->Base;
+    const size_t Size = C->Size;
+    eraseFreeBlock(reinterpret_cast<uintptr_t>(Base), Size);
+    LargeBlocks.erase(reinterpret_cast<uintptr_t>(Base));
+    Chunks.erase(Base);
+    DP("Release chunk " DPxMOD " of size %zu.\n", DPxPTR(Base), Size);
+    deleteOnDevice(Base);
+    CachedSize -= Size;
+    Stats.ReleasedSize += Size;
+  }
+}
+
+void MemoryManagerTy::releaseFreeNodes(size_t Target) {
+  for (int I = NumBuckets - 1; I >= 0 && CachedSize > Target; --I) {
+    std::vector<void *> RemoveList;
+    {
+      FreeListTy &List = FreeLists[I];
+      std::lock_guard<std::mutex> LG(FreeListLocks[I]);
+      size_t RemovedSize = 0;
+      while (!List.empty() && CachedSize - RemovedSize > Target) {
+        auto Itr = std::prev(List.end());
+        RemovedSize += Itr->get().Size;
+        RemoveList.push_back(Itr->get().Ptr);
+        List.erase(Itr);
+      }
+    }
+    if (RemoveList.empty())
+      continue;
 
-  // Remove all nodes in the map table which have been released
-  if (!RemoveList.empty()) {
-    std::lock_guard<std::mutex> LG(MapTableLock);
-    for (void *P : RemoveList)
-      PtrToNodeTable.erase(P);
+    // The memory is deallocated with the map table locked, so that the device
+    // can't give the same pointer to another allocation before its node is
+    // removed.
+    std::lock_guard<std::shared_timed_mutex> LG(MapTableLock);
+    for (void *P : RemoveList) {
+      auto Itr = PtrToNodeTable.find(P);
+      assert(Itr != PtrToNodeTable.end() && "node not in map table");
+      const size_t Size = Itr->second.Size;
+      deleteOnDevice(P);
+      PtrToNodeTable.erase(Itr);
+      CachedSize -= Size;
+      Stats.ReleasedSize += Size;
+    }
   }
+}
+
+void MemoryManagerTy::trimIfNeeded() {
+  if (!HighWatermark || CachedSize <= HighWatermark)
+    return;
+
+  // Another thread is already on it.
+  std::unique_lock<std::mutex> LG(TrimLock, std::try_to_lock);
+  if (!LG.owns_lock())
+    return;
+
+  DP("%zu bytes are buffered, beyond the high watermark %zu. Release them "
+     "down to %zu.\n",
+     CachedSize.load(), HighWatermark, HighWatermark / 2);
+  ++Stats.NumTrims;
+  releaseFreeChunks(HighWatermark / 2);
+  releaseFreeNodes(HighWatermark / 2);
+}
+
+void *MemoryManagerTy::freeAndAllocate(size_t Size, void *HstPtr) {
+  // Deallocate all free memory, including the one in the front cache of this
+  // thread. The front caches of the other threads are small and can't be
+  // touched from here.
+  if (FrontCacheTy *Cache = getFrontCache())
+    flushFrontCache(*Cache);
+  releaseFreeChunks(0);
+  releaseFreeNodes(0);
 
   // Try allocate memory again
   return allocateOnDevice(Size, HstPtr);
@@ -156,6 +364,95 @@ void *MemoryManagerTy::allocateOrFreeAndAllocateOnDevice(size_t Size,
   return TgtPtr;
 }
 
+void *MemoryManagerTy::allocateLarge(size_t Size, void *HstPtr) {
+  const size_t BlockSize = (Size + LargeBlockAlignment - 1) /
+                           LargeBlockAlignment * LargeBlockAlignment;
+
+  // Try to get the smallest free block large enough
+  {
+    std::lock_guard<std::mutex> LG(LargeLock);
+    auto FreeItr = LargeFreeBlocks.lower_bound(BlockSize);
+    if (FreeItr != LargeFreeBlocks.end()) {
+      const uintptr_t Begin = FreeItr->second;
+      LargeFreeBlocks.erase(FreeItr);
+      BlockTy &Block = LargeBlocks.find(Begin)->second;
+      assert(Block.IsFree && "used block in the free blocks");
+
+      // Split the rest off if it can serve another request above the
+      // threshold.
+      if (Block.Size - BlockSize > SizeThreshold) {
+        const size_t RestSize = Block.Size - BlockSize;
+        Block.Size = BlockSize;
+        LargeBlocks.emplace(Begin + BlockSize,
+                            BlockTy{RestSize, true, Block.Chunk});
+        LargeFreeBlocks.emplace(RestSize, Begin + BlockSize);
+        ++Stats.NumSplits;
+      }
+
+      Block.IsFree = false;
+      Block.Chunk->UsedSize += Block.Size;
+      Block.Chunk->LastUse = ++UseClock;
+      CachedSize -= Block.Size;
+      ++Stats.LargeBlockHits;
+
+      DP("Found block " DPxMOD " of size %zu in chunk " DPxMOD ".\n",
+         DPxPTR(Begin), Block.Size, DPxPTR(Block.Chunk->Base));
+      return reinterpret_cast<void *>(Begin);
+    }
+  }
+
+  DP("Cannot find a free block. Allocate a chunk of size %zu on device.\n",
+     BlockSize);
+  void *TgtPtr = allocateOrFreeAndAllocateOnDevice(BlockSize, HstPtr);
+  if (TgtPtr == nullptr)
+    return nullptr;
+
+  std::lock_guard<std::mutex> LG(LargeLock);
+  ChunkTy &Chunk = Chunks[TgtPtr];
+  Chunk = ChunkTy{TgtPtr, BlockSize, BlockSize, ++UseClock};
+  LargeBlocks[reinterpret_cast<uintptr_t>(TgtPtr)] =
+      BlockTy{BlockSize, false, &Chunk};
+  return TgtPtr;
+}
+
+bool MemoryManagerTy::freeLarge(void *TgtPtr) {
+  std::lock_guard<std::mutex> LG(LargeLock);
+  auto Itr = LargeBlocks.find(reinterpret_cast<uintptr_t>(TgtPtr));
+  if (Itr == LargeBlocks.end() || Itr->second.IsFree)
+    return false;
+
+  ChunkTy *Chunk = Itr->second.Chunk;
+  Chunk->UsedSize -= Itr->second.Size;
+  Chunk->LastUse = ++UseClock;
+  addCachedSize(Itr->second.Size);
+  Itr->second.IsFree = true;
+
+  DP("Found block " DPxMOD " of size %zu in chunk " DPxMOD ".\n",
+     DPxPTR(TgtPtr), Itr->second.Size, DPxPTR(Chunk->Base));
+
+  // The blocks of a chunk are adjacent, so merge the block with the next and
+  // the previous ones if they're free and in the same chunk.
+  auto Next = std::next(Itr);
+  if (Next != LargeBlocks.end() && Next->second.IsFree &&
+      Next->second.Chunk == Chunk) {
+    eraseFreeBlock(Next->first, Next->second.Size);
+    Itr->second.Size += Next->second.Size;
+    LargeBlocks.erase(Next);
+  }
+  if (Itr != LargeBlocks.begin()) {
+    auto Prev = std::prev(Itr);
+    if (Prev->second.IsFree && Prev->second.Chunk == Chunk) {
+      eraseFreeBlock(Prev->first, Prev->second.Size);
+      Prev->second.Size += Itr->second.Size;
+      LargeBlocks.erase(Itr);
+      Itr = Prev;
+    }
+  }
+  LargeFreeBlocks.emplace(Itr->second.Size, Itr->first);
+
+  return true;
+}
+
 void *MemoryManagerTy::allocate(size_t Size, void *HstPtr) {
   // If the size is zero, we will not bother the target device. Just return
   // nullptr directly.
@@ -165,13 +462,13 @@ void *MemoryManagerTy::allocate(size_t Size, void *HstPtr) {
   DP("MemoryManagerTy::allocate: size %zu with host pointer " DPxMOD ".\n",
      Size, DPxPTR(HstPtr));
 
-  // If the size is greater than the threshold, allocate it directly from
-  // device.
+  ++Stats.NumAllocations;
+
+  // If the size is greater than the threshold, allocate it from the chunks.
   if (Size > SizeThreshold) {
-    DP("%zu is greater than the threshold %zu. Allocate it directly from "
-       "device\n",
+    DP("%zu is greater than the threshold %zu. Allocate it from the chunks.\n",
        Size, SizeThreshold);
-    void *TgtPtr = allocateOrFreeAndAllocateOnDevice(Size, HstPtr);
+    void *TgtPtr = allocateLarge(Size, HstPtr);
 
     DP("Got target pointer " DPxMOD ". Return directly.\n", DPxPTR(TgtPtr));
 
@@ -179,49 +476,62 @@ void *MemoryManagerTy::allocate(size_t Size, void *HstPtr) {
   }
 
   NodeTy *NodePtr = nullptr;
+  const int B = findBucket(Size);
+
+  // Try to get a node from the front cache of this thread
+  if (FrontCacheTy *Cache = getFrontCache()) {
+    std::vector<NodeTy *> &Cached = Cache->Lists[B];
+    auto Itr = std::find_if(Cached.begin(), Cached.end(), [Size](NodeTy *N) {
+      return isSameSizeClass(N->Size, Size);
+    });
+    if (Itr != Cached.end()) {
+      NodePtr = *Itr;
+      *Itr = Cached.back();
+      Cached.pop_back();
+      ++Stats.FrontCacheHits;
+    }
+  }
 
   // Try to get a node from FreeList
-  {
-    const int B = findBucket(Size);
+  if (NodePtr == nullptr) {
     FreeListTy &List = FreeLists[B];
 
     NodeTy TempNode(Size, nullptr);
     std::lock_guard<std::mutex> LG(FreeListLocks[B]);
-    FreeListTy::const_iterator Itr = List.find(TempNode);
+    FreeListTy::const_iterator Itr = List.lower_bound(TempNode);
 
-    if (Itr != List.end()) {
+    if (Itr != List.end() && isSameSizeClass(Itr->get().Size, Size)) {
       NodePtr = &Itr->get();
       List.erase(Itr);
+      ++Stats.BucketHits;
     }
   }
 
-#ifdef OMPTARGET_DEBUG
-  if (NodePtr != nullptr)
-    DP("Find one node " DPxMOD " in the bucket.\n", DPxPTR(NodePtr));
-#endif
+  if (NodePtr != nullptr) {
+    DP("Find one node " DPxMOD " of size %zu.\n", DPxPTR(NodePtr),
+       NodePtr->Size);
+    CachedSize -= NodePtr->Size;
+    return NodePtr->Ptr;
+  }
 
   // We cannot find a valid node in FreeLists. Let's allocate on device and
   // create a node for it.
-  if (NodePtr == nullptr) {
-    DP("Cannot find a node in the FreeLists. Allocate on device.\n");
-    // Allocate one on device
-    void *TgtPtr = allocateOrFreeAndAllocateOnDevice(Size, HstPtr);
+  DP("Cannot find a node in the FreeLists. Allocate on device.\n");
+  // Allocate one on device
+  void *TgtPtr = allocateOrFreeAndAllocateOnDevice(Size, HstPtr);
 
-    if (TgtPtr == nullptr)
-      return nullptr;
-
-    // Create a new node and add it into the map table
-    {
-      std::lock_guard<std::mutex> Guard(MapTableLock);
-      auto Itr = PtrToNodeTable.emplace(TgtPtr, NodeTy(Size, TgtPtr));
-      NodePtr = &Itr.first->second;
-    }
+  if (TgtPtr == nullptr)
+    return nullptr;
 
-    DP("Node address " DPxMOD ", target pointer " DPxMOD ", size %zu\n",
-       DPxPTR(NodePtr), DPxPTR(TgtPtr), Size);
+  // Create a new node and add it into the map table
+  {
+    std::lock_guard<std::shared_timed_mutex> Guard(MapTableLock);
+    auto Itr = PtrToNodeTable.emplace(TgtPtr, NodeTy(Size, TgtPtr));
+    NodePtr = &Itr.first->second;
   }
 
-  assert(NodePtr && "NodePtr should not be nullptr at this point");
+  DP("Node address " DPxMOD ", target pointer " DPxMOD ", size %zu\n",
+     DPxPTR(NodePtr), DPxPTR(TgtPtr), Size);
 
   return NodePtr->Ptr;
 }
@@ -233,7 +543,7 @@ int MemoryManagerTy::free(void *TgtPtr) {
 
   // Look it up into the table
   {
-    std::lock_guard<std::mutex> G(MapTableLock);
+    std::shared_lock<std::shared_timed_mutex> G(MapTableLock);
     auto Itr = PtrToNodeTable.find(TgtPtr);
 
     // We don't remove the node from the map table because the map does not
@@ -242,21 +552,32 @@ int MemoryManagerTy::free(void *TgtPtr) {
       P = &Itr->second;
   }
 
-  // The memory is not managed by the manager
   if (P == nullptr) {
+    if (freeLarge(TgtPtr)) {
+      trimIfNeeded();
+      return OFFLOAD_SUCCESS;
+    }
+    // The memory is not managed by the manager
     DP("Cannot find its node. Delete it on device directly.\n");
     return deleteOnDevice(TgtPtr);
   }
 
-  // Insert the node to the free list
-  const int B = findBucket(P->Size);
-
-  DP("Found its node " DPxMOD ". Insert it to bucket %d.\n", DPxPTR(P), B);
+  addCachedSize(P->Size);
 
-  {
+  // Keep the node for this thread if its front cache has room, or insert it
+  // to the free list otherwise.
+  const int B = findBucket(P->Size);
+  FrontCacheTy *Cache = getFrontCache();
+  if (Cache && Cache->Lists[B].size() < FrontCacheCapacity) {
+    DP("Found its node " DPxMOD ". Keep it in the front cache.\n", DPxPTR(P));
+    Cache->Lists[B].push_back(P);
+  } else {
+    DP("Found its node " DPxMOD ". Insert it to bucket %d.\n", DPxPTR(P), B);
     std::lock_guard<std::mutex> G(FreeListLocks[B]);
     FreeLists[B].insert(*P);
   }
 
+  trimIfNeeded();
+
   return OFFLOAD_SUCCESS;
 }
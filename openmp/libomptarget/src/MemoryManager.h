@@ -13,11 +13,15 @@
 #ifndef LLVM_OPENMP_LIBOMPTARGET_SRC_MEMORYMANAGER_H
 #define LLVM_OPENMP_LIBOMPTARGET_SRC_MEMORYMANAGER_H
 
+#include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <functional>
 #include <list>
+#include <map>
 #include <mutex>
 #include <set>
+#include <shared_mutex>
 #include <unordered_map>
 #include <vector>
 
@@ -47,6 +51,45 @@ class MemoryManagerTy {
   /// the look up procedure more efficient.
   using FreeListTy = std::multiset<std::reference_wrapper<NodeTy>, NodeCmpTy>;
 
+  /// A device allocation made for a request above the threshold. It is carved
+  /// into blocks which are reused for later requests above the threshold.
+  struct ChunkTy {
+    /// Target pointer of the allocation
+    void *Base;
+    /// Size of the allocation
+    size_t Size;
+    /// Number of bytes of the chunk in used blocks
+    size_t UsedSize;
+    /// Value of \p UseClock when a block of the chunk was last allocated or
+    /// freed
+    uint64_t LastUse;
+  };
+
+  /// A free or used part of a chunk. The blocks of a chunk cover it with no
+  /// gap, and two adjacent free blocks are always merged.
+  struct BlockTy {
+    /// Block size
+    size_t Size;
+    /// Whether the block is free
+    bool IsFree;
+    /// The chunk the block is part of
+    ChunkTy *Chunk;
+  };
+
+  /// Counters reported when the manager is destroyed if LIBOMPTARGET_INFO is
+  /// set.
+  struct StatsTy {
+    std::atomic<size_t> NumAllocations{0};
+    std::atomic<size_t> FrontCacheHits{0};
+    std::atomic<size_t> BucketHits{0};
+    std::atomic<size_t> LargeBlockHits{0};
+    std::atomic<size_t> NumSplits{0};
+    std::atomic<size_t> DeviceAllocations{0};
+    std::atomic<size_t> NumTrims{0};
+    std::atomic<size_t> ReleasedSize{0};
+    std::atomic<size_t> PeakCachedSize{0};
+  };
+
   /// A list of \p FreeListTy entries, each of which is a \p std::multiset of
   /// Nodes whose size is less or equal to a specific bucket size.
   std::vector<FreeListTy> FreeLists;
@@ -54,8 +97,29 @@ class MemoryManagerTy {
   std::vector<std::mutex> FreeListLocks;
   /// A table to map from a target pointer to its node
   std::unordered_map<void *, NodeTy> PtrToNodeTable;
-  /// The mutex for the table \p PtrToNodeTable
-  std::mutex MapTableLock;
+  /// The lock for the table \p PtrToNodeTable, shared for the look ups
+  std::shared_timed_mutex MapTableLock;
+  /// The chunks, by target pointer
+  std::unordered_map<void *, ChunkTy> Chunks;
+  /// All the blocks of the chunks, by target pointer
+  std::map<uintptr_t, BlockTy> LargeBlocks;
+  /// The target pointers of the free blocks, by block size
+  std::multimap<size_t, uintptr_t> LargeFreeBlocks;
+  /// The mutex for \p Chunks, \p LargeBlocks and \p LargeFreeBlocks
+  std::mutex LargeLock;
+  /// Incremented every time a block is allocated or freed
+  uint64_t UseClock = 0;
+  /// Number of bytes allocated on the device and not in use, wherever they
+  /// are cached
+  std::atomic<size_t> CachedSize{0};
+  /// When \p CachedSize goes beyond it, the cached memory is released down to
+  /// half of it. Zero means no limit.
+  size_t HighWatermark;
+  /// Held while the cached memory is released down to the low watermark
+  std::mutex TrimLock;
+  /// Unique ID of the manager, identifying its front caches
+  const uint64_t ID;
+  mutable StatsTy Stats;
   /// A reference to its corresponding \p DeviceTy object
   DeviceTy &Device;
 
@@ -76,7 +140,39 @@ class MemoryManagerTy {
   /// try again.
   void *allocateOrFreeAndAllocateOnDevice(size_t Size, void *HstPtr);
 
+  /// Allocate a block of at least \p Size bytes, splitting the smallest free
+  /// block big enough if any, or allocating a chunk on device otherwise.
+  void *allocateLarge(size_t Size, void *HstPtr);
+
+  /// Free the block pointed by \p TgtPtr, merging it with its free
+  /// neighbours. Return false if \p TgtPtr is not a used block.
+  bool freeLarge(void *TgtPtr);
+
+  /// Remove the free block at \p Begin from \p LargeFreeBlocks
+  void eraseFreeBlock(uintptr_t Begin, size_t Size);
+
+  /// Deallocate the chunks with no used block on device, least recently used
+  /// first, until \p CachedSize is at most \p Target.
+  void releaseFreeChunks(size_t Target);
+
+  /// Deallocate the nodes of the FreeLists on device, largest first, until
+  /// \p CachedSize is at most \p Target.
+  void releaseFreeNodes(size_t Target);
+
+  /// Release cached memory down to half the high watermark if \p CachedSize
+  /// is beyond it.
+  void trimIfNeeded();
+
+  /// Add \p Size to \p CachedSize, recording the peak.
+  void addCachedSize(size_t Size);
+
 public:
+  /// A few free nodes per bucket which a thread reuses without taking the
+  /// bucket locks.
+  struct FrontCacheTy {
+    std::vector<std::vector<NodeTy *>> Lists;
+  };
+
   /// Constructor. If \p Threshold is non-zero, then the default threshold will
   /// be overwritten by \p Threshold.
   MemoryManagerTy(DeviceTy &Dev, size_t Threshold = 0);
@@ -90,6 +186,15 @@ public:
 
   /// Deallocate memory pointed by \p TgtPtr
   int free(void *TgtPtr);
+
+  /// Move the nodes of the front cache of a thread to the FreeLists, e.g.
+  /// when the thread exits.
+  void flushFrontCache(FrontCacheTy &Cache);
+
+private:
+  /// Return the front cache of the calling thread, or nullptr if the thread
+  /// is exiting.
+  FrontCacheTy *getFrontCache();
 };
 
 #endif // LLVM_OPENMP_LIBOMPTARGET_SRC_MEMORYMANAGER_H
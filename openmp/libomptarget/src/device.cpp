@@ -15,18 +15,41 @@
 #include "private.h"
 #include "rtl.h"
 
+#include <atomic>
 #include <cassert>
 #include <climits>
 #include <cstdio>
 #include <string>
 
+namespace {
+/// The last value given to a \p DeviceTy::MapGeneration
+std::atomic<uint64_t> LastMapGeneration(0);
+
+/// The number of entries a thread keeps from its last look ups
+constexpr const unsigned LookupCacheSize = 4;
+
+/// The entries of the map tables a thread has found pointers in lately, so
+/// that a pointer of the same mapping is found without searching the table.
+struct LookupCacheTy {
+  struct {
+    const DeviceTy *Device;
+    uint64_t Generation;
+    HostDataToTargetListTy::iterator Entry;
+  } Entries[LookupCacheSize];
+  /// The next entry to replace
+  unsigned Next;
+};
+thread_local LookupCacheTy LookupCache = {};
+} // namespace
+
 DeviceTy::DeviceTy(const DeviceTy &D)
     : DeviceID(D.DeviceID), RTL(D.RTL), RTLDeviceID(D.RTLDeviceID),
       IsInit(D.IsInit), InitFlag(), HasPendingGlobals(D.HasPendingGlobals),
       HostDataToTargetMap(D.HostDataToTargetMap),
       PendingCtorsDtors(D.PendingCtorsDtors), ShadowPtrMap(D.ShadowPtrMap),
       DataMapMtx(), PendingGlobalsMtx(), ShadowMtx(),
-      LoopTripCnt(D.LoopTripCnt), MemoryManager(nullptr) {}
+      MapGeneration(++LastMapGeneration), LoopTripCnt(D.LoopTripCnt),
+      MemoryManager(nullptr) {}
 
 DeviceTy &DeviceTy::operator=(const DeviceTy &D) {
   DeviceID = D.DeviceID;
@@ -35,6 +58,7 @@ DeviceTy &DeviceTy::operator=(const DeviceTy &D) {
   IsInit = D.IsInit;
   HasPendingGlobals = D.HasPendingGlobals;
   HostDataToTargetMap = D.HostDataToTargetMap;
+  MapGeneration = ++LastMapGeneration;
   PendingCtorsDtors = D.PendingCtorsDtors;
   ShadowPtrMap = D.ShadowPtrMap;
   LoopTripCnt = D.LoopTripCnt;
@@ -46,7 +70,7 @@ DeviceTy::DeviceTy(RTLInfoTy *RTL)
     : DeviceID(-1), RTL(RTL), RTLDeviceID(-1), IsInit(false), InitFlag(),
       HasPendingGlobals(false), HostDataToTargetMap(), PendingCtorsDtors(),
       ShadowPtrMap(), DataMapMtx(), PendingGlobalsMtx(), ShadowMtx(),
-      MemoryManager(nullptr) {}
+      MapGeneration(++LastMapGeneration), MemoryManager(nullptr) {}
 
 DeviceTy::~DeviceTy() {
   if (DeviceID == -1 || getInfoLevel() < 1)
@@ -88,6 +112,7 @@ int DeviceTy::associatePtr(void *HstPtrBegin, void *TgtPtrBegin, int64_t Size) {
       DPxPTR(newEntry.HstPtrBegin), DPxPTR(newEntry.HstPtrEnd),
       DPxPTR(newEntry.TgtPtrBegin));
   HostDataToTargetMap.insert(newEntry);
+  invalidateLookupCaches();
 
   DataMapMtx.unlock();
 
@@ -103,6 +128,7 @@ int DeviceTy::disassociatePtr(void *HstPtrBegin) {
     if (search->isRefCountInf()) {
       DP("Association found, removing it\n");
       HostDataToTargetMap.erase(search);
+      invalidateLookupCaches();
       DataMapMtx.unlock();
       return OFFLOAD_SUCCESS;
     } else {
@@ -122,7 +148,7 @@ uint64_t DeviceTy::getMapEntryRefCnt(void *HstPtrBegin) {
   uintptr_t hp = (uintptr_t)HstPtrBegin;
   uint64_t RefCnt = 0;
 
-  DataMapMtx.lock();
+  DataMapMtx.lock_shared();
   if (!HostDataToTargetMap.empty()) {
     auto upper = HostDataToTargetMap.upper_bound(hp);
     if (upper != HostDataToTargetMap.begin()) {
@@ -133,7 +159,7 @@ uint64_t DeviceTy::getMapEntryRefCnt(void *HstPtrBegin) {
       }
     }
   }
-  DataMapMtx.unlock();
+  DataMapMtx.unlock_shared();
 
   if (RefCnt == 0) {
     DP("DeviceTy::getMapEntry: requested entry not found\n");
@@ -152,6 +178,19 @@ LookupResult DeviceTy::lookupMapping(void *HstPtrBegin, int64_t Size) {
   if (HostDataToTargetMap.empty())
     return lr;
 
+  // Check the entries this thread has found lately first. Since the entries
+  // don't overlap, a pointer contained in one of them is in no other.
+  for (const auto &C : LookupCache.Entries) {
+    if (C.Device != this || C.Generation != MapGeneration)
+      continue;
+    if (hp >= C.Entry->HstPtrBegin && hp < C.Entry->HstPtrEnd &&
+        (hp + Size) <= C.Entry->HstPtrEnd) {
+      lr.Entry = C.Entry;
+      lr.Flags.IsContained = 1;
+      return lr;
+    }
+  }
+
   auto upper = HostDataToTargetMap.upper_bound(hp);
   // check the left bin
   if (upper != HostDataToTargetMap.begin()) {
@@ -164,6 +203,14 @@ LookupResult DeviceTy::lookupMapping(void *HstPtrBegin, int64_t Size) {
     lr.Flags.ExtendsAfter = hp < HT.HstPtrEnd && (hp + Size) > HT.HstPtrEnd;
   }
 
+  if (lr.Flags.IsContained) {
+    auto &C = LookupCache.Entries[LookupCache.Next];
+    C.Device = this;
+    C.Generation = MapGeneration;
+    C.Entry = lr.Entry;
+    LookupCache.Next = (LookupCache.Next + 1) % LookupCacheSize;
+  }
+
   // check the right bin
   if (!(lr.Flags.IsContained || lr.Flags.ExtendsAfter) &&
       upper != HostDataToTargetMap.end()) {
@@ -270,6 +317,7 @@ void *DeviceTy::getOrAllocTgtPtr(void *HstPtrBegin, void *HstPtrBase,
     HostDataToTargetMap.emplace(
         HostDataToTargetTy((uintptr_t)HstPtrBase, (uintptr_t)HstPtrBegin,
                            (uintptr_t)HstPtrBegin + Size, tp, HstPtrName));
+    invalidateLookupCaches();
     rc = (void *)tp;
   }
 
@@ -286,7 +334,12 @@ void *DeviceTy::getTgtPtrBegin(void *HstPtrBegin, int64_t Size, bool &IsLast,
   void *rc = NULL;
   IsHostPtr = false;
   IsLast = false;
-  DataMapMtx.lock();
+  // Only the reference count of the entry may change, so the look ups which
+  // don't change it can run concurrently.
+  if (UpdateRefCount)
+    DataMapMtx.lock();
+  else
+    DataMapMtx.lock_shared();
   LookupResult lr = lookupMapping(HstPtrBegin, Size);
 
   if (lr.Flags.IsContained ||
@@ -313,7 +366,10 @@ void *DeviceTy::getTgtPtrBegin(void *HstPtrBegin, int64_t Size, bool &IsLast,
     rc = HstPtrBegin;
   }
 
-  DataMapMtx.unlock();
+  if (UpdateRefCount)
+    DataMapMtx.unlock();
+  else
+    DataMapMtx.unlock_shared();
   return rc;
 }
 
@@ -331,6 +387,10 @@ void *DeviceTy::getTgtPtrBegin(void *HstPtrBegin, int64_t Size) {
   return NULL;
 }
 
+void DeviceTy::invalidateLookupCaches() {
+  MapGeneration = ++LastMapGeneration;
+}
+
 int DeviceTy::deallocTgtPtr(void *HstPtrBegin, int64_t Size, bool ForceDelete,
                             bool HasCloseModifier) {
   if (PM->RTLs.RequiresFlags & OMP_REQ_UNIFIED_SHARED_MEMORY &&
@@ -352,6 +412,7 @@ int DeviceTy::deallocTgtPtr(void *HstPtrBegin, int64_t Size, bool ForceDelete,
           ", Size=%" PRId64 "\n", (ForceDelete ? " (forced)" : ""),
           DPxPTR(HT.HstPtrBegin), DPxPTR(HT.TgtPtrBegin), Size);
       HostDataToTargetMap.erase(lr.Entry);
+      invalidateLookupCaches();
     }
     rc = OFFLOAD_SUCCESS;
   } else {
@@ -20,6 +20,7 @@
 #include <memory>
 #include <mutex>
 #include <set>
+#include <shared_mutex>
 #include <vector>
 
 #include "rtl.h"
@@ -151,7 +152,15 @@ struct DeviceTy {
 
   ShadowPtrListTy ShadowPtrMap;
 
-  std::mutex DataMapMtx, PendingGlobalsMtx, ShadowMtx;
+  /// Locked shared by the look ups which don't update a reference count, and
+  /// exclusively otherwise.
+  std::shared_timed_mutex DataMapMtx;
+  std::mutex PendingGlobalsMtx, ShadowMtx;
+
+  /// Changed every time an entry is added to or removed from
+  /// \p HostDataToTargetMap, so that the entries the threads have cached in
+  /// their last look ups are known to be stale. Unique across the devices.
+  uint64_t MapGeneration;
 
   // NOTE: Once libomp gains full target-task support, this state should be
   // moved into the target task in libomp.
@@ -174,7 +183,12 @@ struct DeviceTy {
   bool isDataExchangable(const DeviceTy& DstDevice);
 
   uint64_t getMapEntryRefCnt(void *HstPtrBegin);
+  /// Look up the entry of \p HostDataToTargetMap \p HstPtrBegin is in. Must
+  /// be called with \p DataMapMtx locked, shared or exclusively.
   LookupResult lookupMapping(void *HstPtrBegin, int64_t Size);
+  /// Must be called with \p DataMapMtx locked exclusively after entries are
+  /// added to or removed from \p HostDataToTargetMap.
+  void invalidateLookupCaches();
   void *getOrAllocTgtPtr(void *HstPtrBegin, void *HstPtrBase, int64_t Size,
                          map_var_info_t HstPtrName, bool &IsNew,
                          bool &IsHostPtr, bool IsImplicit, bool UpdateRefCount,
@@ -16,6 +16,7 @@
 #include "rtl.h"
 
 #include <cassert>
+#include <deque>
 #include <vector>
 
 /* All begin addresses for partially mapped structs must be 8-aligned in order
@@ -137,6 +138,7 @@ static int InitLibrary(DeviceTy& Device) {
             (uintptr_t)CurrHostEntry->addr + CurrHostEntry->size /*HstPtrEnd*/,
             (uintptr_t)CurrDeviceEntry->addr /*TgtPtrBegin*/, nullptr,
             true /*IsRefCountINF*/);
+        Device.invalidateLookupCaches();
       }
     }
     Device.DataMapMtx.unlock();
@@ -246,11 +248,82 @@ int targetDataMapper(DeviceTy &Device, void *arg_base, void *arg,
   return rc;
 }
 
+namespace {
+/// The copies between the host and the device made while handling the map
+/// clauses of a region. They are issued in order when the batch is flushed,
+/// and a copy whose host and target ranges both directly follow the ones of
+/// the previous copy is merged into it, e.g. for the members of a struct or
+/// consecutive elements of an array mapped separately.
+class TransferBatchTy {
+  struct TransferTy {
+    void *HstPtr;
+    void *TgtPtr;
+    int64_t Size;
+  };
+  std::vector<TransferTy> Transfers;
+  /// Pointer values to be written to the device, which must stay alive until
+  /// the batch is flushed. A deque never moves its elements.
+  std::deque<void *> PointerValues;
+  /// Number of copies added since the last flush
+  size_t NumAdded = 0;
+
+public:
+  void add(void *HstPtr, void *TgtPtr, int64_t Size) {
+    ++NumAdded;
+    if (!Transfers.empty()) {
+      TransferTy &Last = Transfers.back();
+      if ((char *)Last.HstPtr + Last.Size == HstPtr &&
+          (char *)Last.TgtPtr + Last.Size == TgtPtr) {
+        Last.Size += Size;
+        return;
+      }
+    }
+    Transfers.push_back({HstPtr, TgtPtr, Size});
+  }
+
+  /// Add the copy of the pointer value \p Val to \p TgtPtr.
+  void addPointer(void *Val, void *TgtPtr) {
+    PointerValues.push_back(Val);
+    add(&PointerValues.back(), TgtPtr, sizeof(void *));
+  }
+
+  /// Copy the data added from the host to the device.
+  int submit(DeviceTy &Device, __tgt_async_info *AsyncInfo) {
+    return flush(Device, AsyncInfo, /*ToDevice=*/true);
+  }
+
+  /// Copy the data added from the device to the host.
+  int retrieve(DeviceTy &Device, __tgt_async_info *AsyncInfo) {
+    return flush(Device, AsyncInfo, /*ToDevice=*/false);
+  }
+
+private:
+  int flush(DeviceTy &Device, __tgt_async_info *AsyncInfo, bool ToDevice) {
+    if (Transfers.empty())
+      return OFFLOAD_SUCCESS;
+    DP("Issuing %zu copies %s the device for %zu map entries\n",
+       Transfers.size(), ToDevice ? "to" : "from", NumAdded);
+    int Ret = OFFLOAD_SUCCESS;
+    for (const TransferTy &T : Transfers) {
+      Ret = ToDevice
+                ? Device.submitData(T.TgtPtr, T.HstPtr, T.Size, AsyncInfo)
+                : Device.retrieveData(T.HstPtr, T.TgtPtr, T.Size, AsyncInfo);
+      if (Ret != OFFLOAD_SUCCESS)
+        break;
+    }
+    Transfers.clear();
+    NumAdded = 0;
+    return Ret;
+  }
+};
+} // namespace
+
 /// Internal function to do the mapping and transfer the data to the device
 int targetDataBegin(DeviceTy &Device, int32_t arg_num, void **args_base,
                     void **args, int64_t *arg_sizes, int64_t *arg_types,
                     map_var_info_t *arg_names, void **arg_mappers,
                     __tgt_async_info *async_info_ptr) {
+  TransferBatchTy Batch;
   // process each input.
   for (int32_t i = 0; i < arg_num; ++i) {
     // Ignore private variables and arrays - there is no mapping for them.
@@ -264,6 +337,12 @@ int targetDataBegin(DeviceTy &Device, int32_t arg_num, void **args_base,
       // with new arguments.
       DP("Calling targetDataMapper for the %dth argument\n", i);
 
+      // The copies of the mapper may overwrite some of the ones added so far.
+      if (Batch.submit(Device, async_info_ptr) != OFFLOAD_SUCCESS) {
+        REPORT("Copying data to device failed.\n");
+        return OFFLOAD_FAIL;
+      }
+
       int rc = targetDataMapper(Device, args_base[i], args[i], arg_sizes[i],
                                 arg_types[i], arg_mappers[i], targetDataBegin);
 
@@ -392,12 +471,7 @@ int targetDataBegin(DeviceTy &Device, int32_t arg_num, void **args_base,
       if (copy && !IsHostPtr) {
         DP("Moving %" PRId64 " bytes (hst:" DPxMOD ") -> (tgt:" DPxMOD ")\n",
            data_size, DPxPTR(HstPtrBegin), DPxPTR(TgtPtrBegin));
-        int rt = Device.submitData(TgtPtrBegin, HstPtrBegin, data_size,
-                                   async_info_ptr);
-        if (rt != OFFLOAD_SUCCESS) {
-          REPORT("Copying data to device failed.\n");
-          return OFFLOAD_FAIL;
-        }
+        Batch.add(HstPtrBegin, TgtPtrBegin, data_size);
       }
     }
 
@@ -406,12 +480,9 @@ int targetDataBegin(DeviceTy &Device, int32_t arg_num, void **args_base,
          DPxPTR(PointerTgtPtrBegin), DPxPTR(TgtPtrBegin));
       uint64_t Delta = (uint64_t)HstPtrBegin - (uint64_t)HstPtrBase;
       void *TgtPtrBase = (void *)((uint64_t)TgtPtrBegin - Delta);
-      int rt = Device.submitData(PointerTgtPtrBegin, &TgtPtrBase,
-                                 sizeof(void *), async_info_ptr);
-      if (rt != OFFLOAD_SUCCESS) {
-        REPORT("Copying data to device failed.\n");
-        return OFFLOAD_FAIL;
-      }
+      // The copy is made after the one of the struct the pointer is part of,
+      // if any.
+      Batch.addPointer(TgtPtrBase, PointerTgtPtrBegin);
       // create shadow pointers for this entry
       Device.ShadowMtx.lock();
       Device.ShadowPtrMap[Pointer_HstPtrBegin] = {
@@ -420,6 +491,11 @@ int targetDataBegin(DeviceTy &Device, int32_t arg_num, void **args_base,
     }
   }
 
+  if (Batch.submit(Device, async_info_ptr) != OFFLOAD_SUCCESS) {
+    REPORT("Copying data to device failed.\n");
+    return OFFLOAD_FAIL;
+  }
+
   return OFFLOAD_SUCCESS;
 }
 
@@ -450,6 +526,20 @@ int targetDataEnd(DeviceTy &Device, int32_t ArgNum, void **ArgBases,
                   __tgt_async_info *AsyncInfo) {
   int Ret;
   std::vector<DeallocTgtPtrInfo> DeallocTgtPtrs;
+  TransferBatchTy Batch;
+  // The host pointers to restore from their shadow copies once the data
+  // containing them is copied back.
+  std::vector<std::pair<void **, void *>> ShadowRestores;
+  auto RetrieveAndRestore = [&]() {
+    if (Batch.retrieve(Device, AsyncInfo) != OFFLOAD_SUCCESS) {
+      REPORT("Copying data from device failed.\n");
+      return OFFLOAD_FAIL;
+    }
+    for (auto &R : ShadowRestores)
+      *R.first = R.second;
+    ShadowRestores.clear();
+    return OFFLOAD_SUCCESS;
+  };
   // process each input.
   for (int32_t I = ArgNum - 1; I >= 0; --I) {
     // Ignore private variables and arrays - there is no mapping for them.
@@ -464,6 +554,10 @@ int targetDataEnd(DeviceTy &Device, int32_t ArgNum, void **ArgBases,
       // with new arguments.
       DP("Calling targetDataMapper for the %dth argument\n", I);
 
+      // The copies of the mapper may overwrite some of the ones added so far.
+      if (RetrieveAndRestore() != OFFLOAD_SUCCESS)
+        return OFFLOAD_FAIL;
+
       Ret = targetDataMapper(Device, ArgBases[I], Args[I], ArgSizes[I],
                              ArgTypes[I], ArgMappers[I], targetDataEnd);
 
@@ -559,12 +653,7 @@ int targetDataEnd(DeviceTy &Device, int32_t ArgNum, void **ArgBases,
               TgtPtrBegin == HstPtrBegin)) {
           DP("Moving %" PRId64 " bytes (tgt:" DPxMOD ") -> (hst:" DPxMOD ")\n",
              DataSize, DPxPTR(TgtPtrBegin), DPxPTR(HstPtrBegin));
-          Ret = Device.retrieveData(HstPtrBegin, TgtPtrBegin, DataSize,
-                                    AsyncInfo);
-          if (Ret != OFFLOAD_SUCCESS) {
-            REPORT("Copying data from device failed.\n");
-            return OFFLOAD_FAIL;
-          }
+          Batch.add(HstPtrBegin, TgtPtrBegin, DataSize);
         }
       }
 
@@ -588,12 +677,13 @@ int targetDataEnd(DeviceTy &Device, int32_t ArgNum, void **ArgBases,
         if ((uintptr_t)ShadowHstPtrAddr >= UB)
           break;
 
-        // If we copied the struct to the host, we need to restore the pointer.
+        // If we copied the struct to the host, we need to restore the pointer
+        // once the copy is made.
         if (ArgTypes[I] & OMP_TGT_MAPTYPE_FROM) {
           DP("Restoring original host pointer value " DPxMOD " for host "
              "pointer " DPxMOD "\n",
              DPxPTR(Itr->second.HstPtrVal), DPxPTR(ShadowHstPtrAddr));
-          *ShadowHstPtrAddr = Itr->second.HstPtrVal;
+          ShadowRestores.emplace_back(ShadowHstPtrAddr, Itr->second.HstPtrVal);
         }
         // If the struct is to be deallocated, remove the shadow entry.
         if (DelEntry) {
@@ -612,6 +702,9 @@ int targetDataEnd(DeviceTy &Device, int32_t ArgNum, void **ArgBases,
     }
   }
 
+  if (RetrieveAndRestore() != OFFLOAD_SUCCESS)
+    return OFFLOAD_FAIL;
+
   // We need to synchronize before deallocating data.
   // If AsyncInfo is nullptr, the previous data transfer (if has) will be
   // synchronous, so we don't need to synchronize again. If AsyncInfo->Queue is
@@ -18,7 +18,7 @@
 enum GPUArch { NVPTX64, SPIR32, SPIR64 };
 
 /// The GPU Runtime implementation to use.
-enum GPURuntime { CUDA, OpenCL };
+enum GPURuntime { CUDA, OpenCL, PI };
 
 namespace polly {
 extern bool PollyManagedMemory;
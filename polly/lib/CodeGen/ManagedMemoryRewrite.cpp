@@ -13,6 +13,9 @@
 //                                       with a constructor call to
 //                                       `polly_mallocManaged`.
 //
+// With the SYCL Plugin Interface as runtime, the managed memory is shared USM
+// allocated by `polly_mallocManagedPI` and freed by `polly_freeManagedPI`.
+//
 //===----------------------------------------------------------------------===//
 
 #include "polly/CodeGen/IRBuilder.h"
@@ -44,8 +47,10 @@ static cl::opt<bool> IgnoreLinkageForGlobals(
 #define DEBUG_TYPE "polly-acc-rewrite-managed-memory"
 namespace {
 
-static llvm::Function *getOrCreatePollyMallocManaged(Module &M) {
-  const char *Name = "polly_mallocManaged";
+static llvm::Function *getOrCreatePollyMallocManaged(Module &M,
+                                                     GPURuntime Runtime) {
+  const char *Name = Runtime == GPURuntime::PI ? "polly_mallocManagedPI"
+                                               : "polly_mallocManaged";
   Function *F = M.getFunction(Name);
 
   // If F is not available, declare it.
@@ -61,8 +66,10 @@ static llvm::Function *getOrCreatePollyMallocManaged(Module &M) {
   return F;
 }
 
-static llvm::Function *getOrCreatePollyFreeManaged(Module &M) {
-  const char *Name = "polly_freeManaged";
+static llvm::Function *getOrCreatePollyFreeManaged(Module &M,
+                                                   GPURuntime Runtime) {
+  const char *Name =
+      Runtime == GPURuntime::PI ? "polly_freeManagedPI" : "polly_freeManaged";
   Function *F = M.getFunction(Name);
 
   // If F is not available, declare it.
@@ -177,7 +184,8 @@ static void getInstructionUsersOfValue(Value *V,
 
 static void
 replaceGlobalArray(Module &M, const DataLayout &DL, GlobalVariable &Array,
-                   SmallPtrSet<GlobalVariable *, 4> &ReplacedGlobals) {
+                   SmallPtrSet<GlobalVariable *, 4> &ReplacedGlobals,
+                   GPURuntime Runtime) {
   // We only want arrays.
   ArrayType *ArrayTy = dyn_cast<ArrayType>(Array.getType()->getElementType());
   if (!ArrayTy)
@@ -218,7 +226,7 @@ replaceGlobalArray(Module &M, const DataLayout &DL, GlobalVariable &Array,
       cast<GlobalVariable>(M.getOrInsertGlobal(NewName, ElemPtrTy));
   ReplacementToArr->setInitializer(ConstantPointerNull::get(ElemPtrTy));
 
-  Function *PollyMallocManaged = getOrCreatePollyMallocManaged(M);
+  Function *PollyMallocManaged = getOrCreatePollyMallocManaged(M, Runtime);
   std::string FnName = Array.getName().str();
   FnName += ".constructor";
   PollyIRBuilder Builder(M.getContext());
@@ -286,7 +294,8 @@ static void getAllocasToBeManaged(Function &F,
 }
 
 static void rewriteAllocaAsManagedMemory(AllocaInst *Alloca,
-                                         const DataLayout &DL) {
+                                         const DataLayout &DL,
+                                         GPURuntime Runtime) {
   LLVM_DEBUG(dbgs() << "rewriting: (" << *Alloca << ") to managed mem.\n");
   Module *M = Alloca->getModule();
   assert(M && "Alloca does not have a module");
@@ -295,7 +304,7 @@ static void rewriteAllocaAsManagedMemory(AllocaInst *Alloca,
   Builder.SetInsertPoint(Alloca);
 
   Function *MallocManagedFn =
-      getOrCreatePollyMallocManaged(*Alloca->getModule());
+      getOrCreatePollyMallocManaged(*Alloca->getModule(), Runtime);
   const uint64_t Size =
       DL.getTypeAllocSize(Alloca->getType()->getElementType());
   Value *SizeVal = Builder.getInt64(Size);
@@ -315,7 +324,7 @@ static void rewriteAllocaAsManagedMemory(AllocaInst *Alloca,
       continue;
     Builder.SetInsertPoint(Return);
 
-    Function *FreeManagedFn = getOrCreatePollyFreeManaged(*M);
+    Function *FreeManagedFn = getOrCreatePollyFreeManaged(*M, Runtime);
     Builder.CreateCall(FreeManagedFn, {RawManagedMem});
   }
 }
@@ -361,7 +370,7 @@ public:
 
     if (Malloc) {
       PollyIRBuilder Builder(M.getContext());
-      Function *PollyMallocManaged = getOrCreatePollyMallocManaged(M);
+      Function *PollyMallocManaged = getOrCreatePollyMallocManaged(M, Runtime);
       assert(PollyMallocManaged && "unable to create polly_mallocManaged");
 
       replaceAllUsesAndConstantUses(Malloc, PollyMallocManaged, Builder);
@@ -372,7 +381,7 @@ public:
 
     if (Free) {
       PollyIRBuilder Builder(M.getContext());
-      Function *PollyFreeManaged = getOrCreatePollyFreeManaged(M);
+      Function *PollyFreeManaged = getOrCreatePollyFreeManaged(M, Runtime);
       assert(PollyFreeManaged && "unable to create polly_freeManaged");
 
       replaceAllUsesAndConstantUses(Free, PollyFreeManaged, Builder);
@@ -381,7 +390,7 @@ public:
 
     SmallPtrSet<GlobalVariable *, 4> GlobalsToErase;
     for (GlobalVariable &Global : M.globals())
-      replaceGlobalArray(M, DL, Global, GlobalsToErase);
+      replaceGlobalArray(M, DL, Global, GlobalsToErase, Runtime);
     for (GlobalVariable *G : GlobalsToErase)
       G->eraseFromParent();
 
@@ -392,7 +401,7 @@ public:
         getAllocasToBeManaged(F, AllocasToBeManaged);
 
       for (AllocaInst *Alloca : AllocasToBeManaged)
-        rewriteAllocaAsManagedMemory(Alloca, DL);
+        rewriteAllocaAsManagedMemory(Alloca, DL, Runtime);
     }
 
     return true;
@@ -39,6 +39,11 @@
 #include "isl/union_map.h"
 #include <algorithm>
 
+#ifdef HAS_SPIRV_TRANSLATOR
+#include "LLVMSPIRVLib.h"
+#include <sstream>
+#endif
+
 extern "C" {
 #include "ppcg/cuda.h"
 #include "ppcg/gpu.h"
@@ -378,7 +383,7 @@ private:
   /// The GPU program we generate code for.
   gpu_prog *Prog;
 
-  /// The GPU Runtime implementation to use (OpenCL or CUDA).
+  /// The GPU Runtime implementation to use (OpenCL, CUDA or SYCL PI).
   GPURuntime Runtime;
 
   /// The GPU Architecture to target.
@@ -615,6 +620,15 @@ private:
   /// @returns A string containing the corresponding PTX assembly code.
   std::string createKernelASM();
 
+  /// Create a SPIR-V binary for the current GPU kernel.
+  ///
+  /// The binary may contain null characters, so it is preceded by its size
+  /// as a 64-bit integer in the byte order of the host.
+  ///
+  /// @returns The size-prefixed binary, or an empty string if it cannot be
+  ///          created.
+  std::string createKernelSPIRV();
+
   /// Remove references from the dominator tree to the kernel function @p F.
   ///
   /// @param F The function to remove references to.
@@ -1053,6 +1067,9 @@ Value *GPUNodeBuilder::createCallInitContext() {
   case GPURuntime::OpenCL:
     Name = "polly_initContextCL";
     break;
+  case GPURuntime::PI:
+    Name = "polly_initContextPI";
+    break;
   }
 
   Module *M = Builder.GetInsertBlock()->getParent()->getParent();
@@ -1617,9 +1634,12 @@ GPUNodeBuilder::createLaunchParameters(ppcg_kernel *Kernel, Function *F,
   // If we are using the OpenCL Runtime, we need to add the kernel argument
   // sizes to the end of the launch-parameter list, so OpenCL can determine
   // how big the respective kernel arguments are.
-  // Here we need to reserve adequate space for that.
+  // Here we need to reserve adequate space for that. The SYCL PI runtime
+  // takes the sizes the same way.
+  const bool NeedsArgSizes =
+      Runtime == GPURuntime::OpenCL || Runtime == GPURuntime::PI;
   Type *ArrayTy;
-  if (Runtime == GPURuntime::OpenCL)
+  if (NeedsArgSizes)
     ArrayTy = ArrayType::get(Builder.getInt8PtrTy(), 2 * NumArgs);
   else
     ArrayTy = ArrayType::get(Builder.getInt8PtrTy(), NumArgs);
@@ -1641,6 +1661,14 @@ GPUNodeBuilder::createLaunchParameters(ppcg_kernel *Kernel, Function *F,
 
     if (Runtime == GPURuntime::OpenCL)
       ArgSizes[Index] = SAI->getElemSizeInBytes();
+    // The arrays are USM pointers with PI, which are set by
+    // piextKernelSetArgPointer. A negative size tells them apart from the
+    // arguments passed by value.
+    if (Runtime == GPURuntime::PI)
+      ArgSizes[Index] =
+          gpu_array_is_read_only_scalar(&Prog->array[i])
+              ? SAI->getElemSizeInBytes()
+              : -static_cast<int>(DL.getPointerSize());
 
     Value *DevArray = nullptr;
     if (PollyManagedMemory) {
@@ -1695,7 +1723,7 @@ GPUNodeBuilder::createLaunchParameters(ppcg_kernel *Kernel, Function *F,
     Value *Val = IDToValue[Id];
     isl_id_free(Id);
 
-    if (Runtime == GPURuntime::OpenCL)
+    if (NeedsArgSizes)
       ArgSizes[Index] = computeSizeInBytes(Val->getType());
 
     Instruction *Param =
@@ -1716,7 +1744,7 @@ GPUNodeBuilder::createLaunchParameters(ppcg_kernel *Kernel, Function *F,
       Val = ValueMap[Val];
     isl_id_free(Id);
 
-    if (Runtime == GPURuntime::OpenCL)
+    if (NeedsArgSizes)
       ArgSizes[Index] = computeSizeInBytes(Val->getType());
 
     Instruction *Param =
@@ -1729,7 +1757,7 @@ GPUNodeBuilder::createLaunchParameters(ppcg_kernel *Kernel, Function *F,
   }
 
   for (auto Val : SubtreeValues) {
-    if (Runtime == GPURuntime::OpenCL)
+    if (NeedsArgSizes)
       ArgSizes[Index] = computeSizeInBytes(Val->getType());
 
     Instruction *Param =
@@ -1741,7 +1769,7 @@ GPUNodeBuilder::createLaunchParameters(ppcg_kernel *Kernel, Function *F,
     Index++;
   }
 
-  if (Runtime == GPURuntime::OpenCL) {
+  if (NeedsArgSizes) {
     for (int i = 0; i < NumArgs; i++) {
       Value *Val = ConstantInt::get(Builder.getInt32Ty(), ArgSizes[i]);
       Instruction *Param =
@@ -2276,6 +2304,8 @@ void GPUNodeBuilder::createKernelFunction(
       GPUModule->setTargetTriple(Triple::normalize("nvptx64-nvidia-cuda"));
     else if (Runtime == GPURuntime::OpenCL)
       GPUModule->setTargetTriple(Triple::normalize("nvptx64-nvidia-nvcl"));
+    else
+      llvm_unreachable("The SYCL PI runtime requires the SPIR64 architecture");
     GPUModule->setDataLayout(computeNVPTXDataLayout(true /* is64Bit */));
     break;
   case GPUArch::SPIR32:
@@ -2329,10 +2359,14 @@ std::string GPUNodeBuilder::createKernelASM() {
     case GPURuntime::OpenCL:
       GPUTriple = llvm::Triple(Triple::normalize("nvptx64-nvidia-nvcl"));
       break;
+    case GPURuntime::PI:
+      llvm_unreachable("The SYCL PI runtime requires the SPIR64 architecture");
     }
     break;
   case GPUArch::SPIR64:
   case GPUArch::SPIR32:
+    if (Runtime == GPURuntime::PI)
+      return createKernelSPIRV();
     std::string SPIRAssembly;
     raw_string_ostream IROstream(SPIRAssembly);
     IROstream << *GPUModule;
@@ -2382,6 +2416,25 @@ std::string GPUNodeBuilder::createKernelASM() {
   return ASMStream.str().str();
 }
 
+std::string GPUNodeBuilder::createKernelSPIRV() {
+#ifdef HAS_SPIRV_TRANSLATOR
+  std::ostringstream SPIRVStream;
+  std::string ErrMsg;
+  if (!writeSpirv(GPUModule.get(), SPIRVStream, ErrMsg)) {
+    errs() << "Translating the kernel to SPIR-V failed: " << ErrMsg << "\n";
+    return "";
+  }
+
+  const std::string Binary = SPIRVStream.str();
+  const uint64_t Size = Binary.size();
+  std::string Prefixed(reinterpret_cast<const char *>(&Size), sizeof(Size));
+  return Prefixed + Binary;
+#else
+  errs() << "Polly was built without the SPIR-V translator.\n";
+  return "";
+#endif
+}
+
 bool GPUNodeBuilder::requiresCUDALibDevice() {
   bool RequiresLibDevice = false;
   for (Function &F : GPUModule->functions()) {
@@ -2470,6 +2523,8 @@ std::string GPUNodeBuilder::finalizeKernelFunction() {
   }
 
   std::string Assembly = createKernelASM();
+  if (Assembly.empty())
+    BuildSuccessful = false;
 
   if (DumpKernelASM)
     outs() << Assembly << "\n";
@@ -3554,6 +3609,11 @@ public:
     DL = &S->getRegion().getEntry()->getModule()->getDataLayout();
     RI = &getAnalysis<RegionInfoPass>().getRegionInfo();
 
+    // The plugins of the SYCL runtime only take 64-bit SPIR-V kernels.
+    if (Runtime == GPURuntime::PI && Architecture != GPUArch::SPIR64)
+      report_fatal_error("The SYCL PI runtime requires the SPIR64 GPU "
+                         "architecture (-polly-gpu-arch=spir64)");
+
     LLVM_DEBUG(dbgs() << "PPCGCodeGen running on : " << getUniqueScopName(S)
                       << " | loop depth: " << S->getMaxLoopDepth() << "\n");
 
@@ -112,7 +112,9 @@ static cl::opt<GPURuntime> GPURuntimeChoice(
     cl::values(clEnumValN(GPURuntime::CUDA, "libcudart",
                           "use the CUDA Runtime API"),
                clEnumValN(GPURuntime::OpenCL, "libopencl",
-                          "use the OpenCL Runtime API")),
+                          "use the OpenCL Runtime API"),
+               clEnumValN(GPURuntime::PI, "libpi",
+                          "use the Plugin Interface of the SYCL runtime")),
     cl::init(GPURuntime::CUDA), cl::ZeroOrMore, cl::cat(PollyCategory));
 
 static cl::opt<GPUArch>
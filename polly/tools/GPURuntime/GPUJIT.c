@@ -26,6 +26,10 @@
 #endif /* __APPLE__ */
 #endif /* HAS_LIBOPENCL */
 
+#ifdef HAS_LIBSYCLPI
+#include "GPUJITPI.h"
+#endif /* HAS_LIBSYCLPI */
+
 #include <assert.h>
 #include <dlfcn.h>
 #include <stdarg.h>
@@ -1569,6 +1573,161 @@ static void freeContextCUDA(PollyGPUContext *Context) {
 
 #endif /* HAS_LIBCUDART */
 /******************************************************************************/
+/*                           SYCL Plugin Interface                            */
+/******************************************************************************/
+
+#ifdef HAS_LIBSYCLPI
+
+struct PIKernelT {
+  void *Kernel;
+  const char *BinaryString;
+};
+typedef struct PIKernelT PIKernel;
+
+static PollyGPUContext *initContextPI() {
+  dump_function();
+
+  static __thread PollyGPUContext *CurrentContext = NULL;
+
+  if (CurrentContext)
+    return CurrentContext;
+
+  /* The PI context lives until the process exits, see GPUJITPI.h. */
+  pollyPIInitContext(DebugMode);
+
+  PollyGPUContext *Context = malloc(sizeof(PollyGPUContext));
+  if (Context == 0) {
+    fprintf(stderr, "Allocate memory for Polly GPU context failed.\n");
+    exit(-1);
+  }
+  Context->Context = NULL;
+
+  if (CacheMode)
+    CurrentContext = Context;
+
+  return Context;
+}
+
+static void freeKernelPI(PollyGPUFunction *Kernel) {
+  dump_function();
+
+  if (CacheMode)
+    return;
+
+  pollyPIFreeKernel(((PIKernel *)Kernel->Kernel)->Kernel);
+  free(Kernel->Kernel);
+  free(Kernel);
+}
+
+static PollyGPUFunction *getKernelPI(const char *BinaryBuffer,
+                                     const char *KernelName) {
+  dump_function();
+
+  static __thread PollyGPUFunction *KernelCache[KERNEL_CACHE_SIZE];
+  static __thread int NextCacheItem = 0;
+
+  for (long i = 0; i < KERNEL_CACHE_SIZE; i++) {
+    // As with OpenCL, the kernels are global constants, hence a pointer
+    // comparision is sufficient to determine equality.
+    if (KernelCache[i] &&
+        ((PIKernel *)KernelCache[i]->Kernel)->BinaryString == BinaryBuffer) {
+      debug_print("  -> using cached kernel\n");
+      return KernelCache[i];
+    }
+  }
+
+  PollyGPUFunction *Function = malloc(sizeof(PollyGPUFunction));
+  if (Function == 0) {
+    fprintf(stderr, "Allocate memory for Polly GPU function failed.\n");
+    exit(-1);
+  }
+  Function->Kernel = (PIKernel *)malloc(sizeof(PIKernel));
+  if (Function->Kernel == 0) {
+    fprintf(stderr, "Allocate memory for Polly PI kernel failed.\n");
+    exit(-1);
+  }
+
+  ((PIKernel *)Function->Kernel)->Kernel =
+      pollyPIGetKernel(BinaryBuffer, KernelName);
+  ((PIKernel *)Function->Kernel)->BinaryString = BinaryBuffer;
+
+  if (CacheMode) {
+    if (KernelCache[NextCacheItem])
+      freeKernelPI(KernelCache[NextCacheItem]);
+
+    KernelCache[NextCacheItem] = Function;
+
+    NextCacheItem = (NextCacheItem + 1) % KERNEL_CACHE_SIZE;
+  }
+
+  return Function;
+}
+
+static void copyFromHostToDevicePI(void *HostData, PollyGPUDevicePtr *DevData,
+                                   long MemSize) {
+  dump_function();
+
+  pollyPICopy(DevData->DevicePtr, HostData, MemSize);
+}
+
+static void copyFromDeviceToHostPI(PollyGPUDevicePtr *DevData, void *HostData,
+                                   long MemSize) {
+  dump_function();
+
+  pollyPICopy(HostData, DevData->DevicePtr, MemSize);
+}
+
+static void launchKernelPI(PollyGPUFunction *Kernel, unsigned int GridDimX,
+                           unsigned int GridDimY, unsigned int BlockDimX,
+                           unsigned int BlockDimY, unsigned int BlockDimZ,
+                           void **Parameters) {
+  dump_function();
+
+  pollyPILaunchKernel(((PIKernel *)Kernel->Kernel)->Kernel, GridDimX, GridDimY,
+                      BlockDimX, BlockDimY, BlockDimZ, Parameters);
+}
+
+static void freeDeviceMemoryPI(PollyGPUDevicePtr *Allocation) {
+  dump_function();
+
+  pollyPIFreeDeviceMemory(Allocation->DevicePtr);
+  free(Allocation);
+}
+
+static PollyGPUDevicePtr *allocateMemoryForDevicePI(long MemSize) {
+  dump_function();
+
+  PollyGPUDevicePtr *DevData = malloc(sizeof(PollyGPUDevicePtr));
+  if (DevData == 0) {
+    fprintf(stderr, "Allocate memory for GPU device memory pointer failed.\n");
+    exit(-1);
+  }
+  DevData->DevicePtr = pollyPIAllocateDeviceMemory(MemSize);
+
+  return DevData;
+}
+
+static void *getDevicePtrPI(PollyGPUDevicePtr *Allocation) {
+  dump_function();
+
+  return Allocation->DevicePtr;
+}
+
+static void synchronizeDevicePI() {
+  dump_function();
+
+  pollyPISynchronize();
+}
+
+static void freeContextPI(PollyGPUContext *Context) {
+  dump_function();
+
+  pollyPISynchronize();
+  free(Context);
+}
+
+#endif /* HAS_LIBSYCLPI */
+/******************************************************************************/
 /*                                    API                                     */
 /******************************************************************************/
 
@@ -1591,6 +1750,11 @@ PollyGPUContext *polly_initContext() {
     Context = initContextCL();
     break;
 #endif /* HAS_LIBOPENCL */
+#ifdef HAS_LIBSYCLPI
+  case RUNTIME_PI:
+    Context = initContextPI();
+    break;
+#endif /* HAS_LIBSYCLPI */
   default:
     err_runtime();
   }
@@ -1612,6 +1776,11 @@ void polly_freeKernel(PollyGPUFunction *Kernel) {
     freeKernelCL(Kernel);
     break;
 #endif /* HAS_LIBOPENCL */
+#ifdef HAS_LIBSYCLPI
+  case RUNTIME_PI:
+    freeKernelPI(Kernel);
+    break;
+#endif /* HAS_LIBSYCLPI */
   default:
     err_runtime();
   }
@@ -1634,6 +1803,11 @@ PollyGPUFunction *polly_getKernel(const char *BinaryBuffer,
     Function = getKernelCL(BinaryBuffer, KernelName);
     break;
 #endif /* HAS_LIBOPENCL */
+#ifdef HAS_LIBSYCLPI
+  case RUNTIME_PI:
+    Function = getKernelPI(BinaryBuffer, KernelName);
+    break;
+#endif /* HAS_LIBSYCLPI */
   default:
     err_runtime();
   }
@@ -1656,6 +1830,11 @@ void polly_copyFromHostToDevice(void *HostData, PollyGPUDevicePtr *DevData,
     copyFromHostToDeviceCL(HostData, DevData, MemSize);
     break;
 #endif /* HAS_LIBOPENCL */
+#ifdef HAS_LIBSYCLPI
+  case RUNTIME_PI:
+    copyFromHostToDevicePI(HostData, DevData, MemSize);
+    break;
+#endif /* HAS_LIBSYCLPI */
   default:
     err_runtime();
   }
@@ -1676,6 +1855,11 @@ void polly_copyFromDeviceToHost(PollyGPUDevicePtr *DevData, void *HostData,
     copyFromDeviceToHostCL(DevData, HostData, MemSize);
     break;
 #endif /* HAS_LIBOPENCL */
+#ifdef HAS_LIBSYCLPI
+  case RUNTIME_PI:
+    copyFromDeviceToHostPI(DevData, HostData, MemSize);
+    break;
+#endif /* HAS_LIBSYCLPI */
   default:
     err_runtime();
   }
@@ -1700,6 +1884,12 @@ void polly_launchKernel(PollyGPUFunction *Kernel, unsigned int GridDimX,
                    Parameters);
     break;
 #endif /* HAS_LIBOPENCL */
+#ifdef HAS_LIBSYCLPI
+  case RUNTIME_PI:
+    launchKernelPI(Kernel, GridDimX, GridDimY, BlockDimX, BlockDimY, BlockDimZ,
+                   Parameters);
+    break;
+#endif /* HAS_LIBSYCLPI */
   default:
     err_runtime();
   }
@@ -1719,6 +1909,11 @@ void polly_freeDeviceMemory(PollyGPUDevicePtr *Allocation) {
     freeDeviceMemoryCL(Allocation);
     break;
 #endif /* HAS_LIBOPENCL */
+#ifdef HAS_LIBSYCLPI
+  case RUNTIME_PI:
+    freeDeviceMemoryPI(Allocation);
+    break;
+#endif /* HAS_LIBSYCLPI */
   default:
     err_runtime();
   }
@@ -1740,6 +1935,11 @@ PollyGPUDevicePtr *polly_allocateMemoryForDevice(long MemSize) {
     DevData = allocateMemoryForDeviceCL(MemSize);
     break;
 #endif /* HAS_LIBOPENCL */
+#ifdef HAS_LIBSYCLPI
+  case RUNTIME_PI:
+    DevData = allocateMemoryForDevicePI(MemSize);
+    break;
+#endif /* HAS_LIBSYCLPI */
   default:
     err_runtime();
   }
@@ -1763,6 +1963,11 @@ void *polly_getDevicePtr(PollyGPUDevicePtr *Allocation) {
     DevPtr = getDevicePtrCL(Allocation);
     break;
 #endif /* HAS_LIBOPENCL */
+#ifdef HAS_LIBSYCLPI
+  case RUNTIME_PI:
+    DevPtr = getDevicePtrPI(Allocation);
+    break;
+#endif /* HAS_LIBSYCLPI */
   default:
     err_runtime();
   }
@@ -1784,6 +1989,11 @@ void polly_synchronizeDevice() {
     synchronizeDeviceCL();
     break;
 #endif /* HAS_LIBOPENCL */
+#ifdef HAS_LIBSYCLPI
+  case RUNTIME_PI:
+    synchronizeDevicePI();
+    break;
+#endif /* HAS_LIBSYCLPI */
   default:
     err_runtime();
   }
@@ -1806,6 +2016,11 @@ void polly_freeContext(PollyGPUContext *Context) {
     freeContextCL(Context);
     break;
 #endif /* HAS_LIBOPENCL */
+#ifdef HAS_LIBSYCLPI
+  case RUNTIME_PI:
+    freeContextPI(Context);
+    break;
+#endif /* HAS_LIBSYCLPI */
   default:
     err_runtime();
   }
@@ -1854,3 +2069,42 @@ PollyGPUContext *polly_initContextCL() {
   exit(-1);
 #endif /* HAS_LIBOPENCL */
 }
+
+/* Initialize GPUJIT with the SYCL Plugin Interface as runtime library. */
+PollyGPUContext *polly_initContextPI() {
+#ifdef HAS_LIBSYCLPI
+  Runtime = RUNTIME_PI;
+  return polly_initContext();
+#else
+  fprintf(stderr, "GPU Runtime was built without SYCL PI support.\n");
+  exit(-1);
+#endif /* HAS_LIBSYCLPI */
+}
+
+void polly_freeManagedPI(void *mem) {
+  dump_function();
+
+#ifdef HAS_LIBSYCLPI
+  // The memory may be freed before any kernel ran, e.g. if it isn't managed.
+  pollyPIInitContext(DebugMode);
+  pollyPIFreeManaged(mem);
+#else
+  fprintf(stderr, "GPU Runtime was built without SYCL PI support.\n");
+  exit(-1);
+#endif /* HAS_LIBSYCLPI */
+}
+
+void *polly_mallocManagedPI(size_t size) {
+  dump_function();
+
+#ifdef HAS_LIBSYCLPI
+  // See [Size 0 allocations].
+  size = max(size, 1);
+  // Global constructors allocate before any kernel ran.
+  pollyPIInitContext(DebugMode);
+  return pollyPIMallocManaged(size);
+#else
+  fprintf(stderr, "GPU Runtime was built without SYCL PI support.\n");
+  exit(-1);
+#endif /* HAS_LIBSYCLPI */
+}
@@ -75,12 +75,19 @@
  *   polly_freeContext(Context);
  * }
  *
+ * With the SYCL Plugin Interface (PI) as runtime, initialized by
+ * polly_initContextPI, the kernel is a SPIR-V binary instead, which is
+ * preceded by its size as a 64-bit integer since it may contain null
+ * characters. The device pointers are USM pointers. As with OpenCL, the sizes
+ * of the kernel arguments follow the arguments in the parameter array, as
+ * ints; the USM pointers have the negation of their size.
  */
 
 typedef enum PollyGPURuntimeT {
   RUNTIME_NONE,
   RUNTIME_CUDA,
-  RUNTIME_CL
+  RUNTIME_CL,
+  RUNTIME_PI
 } PollyGPURuntime;
 
 typedef struct PollyGPUContextT PollyGPUContext;
@@ -97,6 +104,7 @@ typedef struct CUDADevicePtrT CUDADevicePtr;
 
 PollyGPUContext *polly_initContextCUDA();
 PollyGPUContext *polly_initContextCL();
+PollyGPUContext *polly_initContextPI();
 PollyGPUFunction *polly_getKernel(const char *BinaryBuffer,
                                   const char *KernelName);
 void polly_freeKernel(PollyGPUFunction *Kernel);
@@ -120,4 +128,8 @@ void polly_freeContext(PollyGPUContext *Context);
 // If this is still present, ping Siddharth Bhat <siddu.druid@gmail.com>
 void *polly_mallocManaged(size_t size);
 void polly_freeManaged(void *mem);
+
+/* The managed memory of the SYCL PI runtime is shared USM. */
+void *polly_mallocManagedPI(size_t size);
+void polly_freeManagedPI(void *mem);
 #endif /* GPUJIT_H_ */
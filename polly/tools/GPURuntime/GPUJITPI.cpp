@@ -0,0 +1,275 @@
+/***************** GPUJITPI.cpp - SYCL PI backend of GPUJIT *******************/
+/*                                                                            */
+/* Part of the LLVM Project, under the Apache License v2.0 with LLVM          */
+/* Exceptions.                                                                */
+/* See https://llvm.org/LICENSE.txt for license information.                  */
+/* SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception                    */
+/*                                                                            */
+/******************************************************************************/
+/*                                                                            */
+/*  This file implements the kernel launches and the USM allocations of       */
+/*  GPUJIT on top of the Plugin Interface of the SYCL runtime.                */
+/*                                                                            */
+/******************************************************************************/
+
+#include "GPUJITPI.h"
+
+#include <CL/sycl/detail/pi.h>
+
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+
+namespace {
+
+struct PIRuntime {
+  pi_plugin Plugin;
+  pi_device Device = nullptr;
+  pi_context Context = nullptr;
+  pi_queue Queue = nullptr;
+
+  const pi_plugin::FunctionPointers &pi() const {
+    return Plugin.PiFunctionTable;
+  }
+};
+
+struct PIKernel {
+  pi_program Program;
+  pi_kernel Kernel;
+};
+
+PIRuntime *GlobalRuntime = nullptr;
+
+void checkPIError(pi_result Ret, const char *Format, ...) {
+  if (Ret == PI_SUCCESS)
+    return;
+
+  fprintf(stderr, "PI error %d: ", static_cast<int>(Ret));
+  va_list Args;
+  va_start(Args, Format);
+  vfprintf(stderr, Format, Args);
+  va_end(Args);
+  exit(-1);
+}
+
+const PIRuntime &getRuntime() {
+  if (!GlobalRuntime) {
+    fprintf(stderr, "GPGPU-code generation not correctly initialized.\n");
+    exit(-1);
+  }
+  return *GlobalRuntime;
+}
+
+PIRuntime *loadRuntime(int DebugMode) {
+  PIRuntime *Runtime = new PIRuntime();
+  memset(&Runtime->Plugin, 0, sizeof(Runtime->Plugin));
+
+  const char *Name = getenv("POLLY_PI_PLUGIN");
+  if (!Name)
+    Name = "libpi_level_zero.so";
+  void *Handle = dlopen(Name, RTLD_NOW | RTLD_LOCAL);
+  if (!Handle) {
+    fprintf(stderr, "Cannot load the PI plugin %s: %s\n", Name, dlerror());
+    exit(-1);
+  }
+  auto Init = reinterpret_cast<decltype(&piPluginInit)>(
+      dlsym(Handle, "piPluginInit"));
+  if (!Init) {
+    fprintf(stderr, "%s is not a PI plugin.\n", Name);
+    exit(-1);
+  }
+  strncpy(Runtime->Plugin.PiVersion, _PI_H_VERSION_STRING,
+          sizeof(Runtime->Plugin.PiVersion));
+  checkPIError(Init(&Runtime->Plugin), "Failed to initialize %s.\n", Name);
+  const auto &PI = Runtime->pi();
+
+  pi_uint32 NumPlatforms = 0;
+  checkPIError(PI.piPlatformsGet(0, nullptr, &NumPlatforms),
+               "Failed to get the number of platforms.\n");
+  pi_platform *Platforms = new pi_platform[NumPlatforms];
+  checkPIError(PI.piPlatformsGet(NumPlatforms, Platforms, nullptr),
+               "Failed to get the platforms.\n");
+  for (pi_uint32 i = 0; i < NumPlatforms && !Runtime->Device; i++) {
+    pi_uint32 NumDevices = 0;
+    if (PI.piDevicesGet(Platforms[i], PI_DEVICE_TYPE_GPU, 1, &Runtime->Device,
+                        &NumDevices) != PI_SUCCESS ||
+        NumDevices == 0)
+      Runtime->Device = nullptr;
+  }
+  delete[] Platforms;
+  if (!Runtime->Device) {
+    fprintf(stderr, "There is no GPU supported by the PI plugin %s.\n", Name);
+    exit(-1);
+  }
+
+  if (DebugMode) {
+    char DeviceName[256] = {};
+    checkPIError(PI.piDeviceGetInfo(Runtime->Device, PI_DEVICE_INFO_NAME,
+                                    sizeof(DeviceName) - 1, DeviceName,
+                                    nullptr),
+                 "Failed to fetch device name.\n");
+    fprintf(stderr, "> Running on GPU device %s through %s.\n", DeviceName,
+            Name);
+  }
+
+  checkPIError(PI.piContextCreate(nullptr, 1, &Runtime->Device, nullptr,
+                                  nullptr, &Runtime->Context),
+               "Failed to create context.\n");
+  // The commands are run in order, so that a copy after a kernel launch sees
+  // its results.
+  checkPIError(PI.piQueueCreate(Runtime->Context, Runtime->Device, 0,
+                                &Runtime->Queue),
+               "Failed to create queue.\n");
+  return Runtime;
+}
+
+} // namespace
+
+void pollyPIInitContext(int DebugMode) {
+  if (!GlobalRuntime)
+    GlobalRuntime = loadRuntime(DebugMode);
+}
+
+void pollyPISynchronize(void) {
+  const PIRuntime &Runtime = getRuntime();
+  checkPIError(Runtime.pi().piQueueFinish(Runtime.Queue),
+               "Synchronizing device and host memory failed.\n");
+}
+
+void *pollyPIGetKernel(const char *BinaryBuffer, const char *KernelName) {
+  const PIRuntime &Runtime = getRuntime();
+  const auto &PI = Runtime.pi();
+
+  // The SPIR-V binary may contain null characters, so it is preceded by its
+  // size.
+  uint64_t BinarySize;
+  memcpy(&BinarySize, BinaryBuffer, sizeof(BinarySize));
+  const char *Binary = BinaryBuffer + sizeof(BinarySize);
+
+  PIKernel *Kernel = new PIKernel();
+  checkPIError(PI.piProgramCreate(Runtime.Context, Binary, BinarySize,
+                                  &Kernel->Program),
+               "Failed to create program from SPIR-V.\n");
+  checkPIError(PI.piProgramBuild(Kernel->Program, 1, &Runtime.Device, "",
+                                 nullptr, nullptr),
+               "Failed to build program.\n");
+  checkPIError(PI.piKernelCreate(Kernel->Program, KernelName, &Kernel->Kernel),
+               "Failed to create kernel %s.\n", KernelName);
+  return Kernel;
+}
+
+void pollyPIFreeKernel(void *Kernel) {
+  const PIRuntime &Runtime = getRuntime();
+  const auto &PI = Runtime.pi();
+  PIKernel *K = static_cast<PIKernel *>(Kernel);
+
+  // The kernel may still be running.
+  pollyPISynchronize();
+  checkPIError(PI.piKernelRelease(K->Kernel), "Failed to release kernel.\n");
+  checkPIError(PI.piProgramRelease(K->Program),
+               "Failed to release program.\n");
+  delete K;
+}
+
+void pollyPILaunchKernel(void *Kernel, unsigned int GridDimX,
+                         unsigned int GridDimY, unsigned int BlockDimX,
+                         unsigned int BlockDimY, unsigned int BlockDimZ,
+                         void **Parameters) {
+  const PIRuntime &Runtime = getRuntime();
+  const auto &PI = Runtime.pi();
+  pi_kernel K = static_cast<PIKernel *>(Kernel)->Kernel;
+
+  pi_uint32 NumArgs;
+  checkPIError(PI.piKernelGetInfo(K, PI_KERNEL_INFO_NUM_ARGS, sizeof(NumArgs),
+                                  &NumArgs, nullptr),
+               "Failed to get number of kernel arguments.\n");
+
+  // Argument sizes are stored at the end of the Parameters array. The USM
+  // pointers have negative sizes.
+  for (pi_uint32 i = 0; i < NumArgs; i++) {
+    const int Size = *static_cast<int *>(Parameters[NumArgs + i]);
+    if (Size < 0)
+      checkPIError(PI.piextKernelSetArgPointer(K, i, -Size, Parameters[i]),
+                   "Failed to set Kernel argument %u.\n", i);
+    else
+      checkPIError(PI.piKernelSetArg(K, i, Size, Parameters[i]),
+                   "Failed to set Kernel argument %u.\n", i);
+  }
+
+  const unsigned int GridDimZ = 1;
+  size_t GlobalWorkSize[3] = {BlockDimX * GridDimX, BlockDimY * GridDimY,
+                              BlockDimZ * GridDimZ};
+  size_t LocalWorkSize[3] = {BlockDimX, BlockDimY, BlockDimZ};
+
+  pi_event Event = nullptr;
+  checkPIError(PI.piEnqueueKernelLaunch(Runtime.Queue, K, 3, nullptr,
+                                        GlobalWorkSize, LocalWorkSize, 0,
+                                        nullptr, &Event),
+               "Launching PI kernel failed.\n");
+  if (Event)
+    checkPIError(PI.piEventRelease(Event), "Failed to release event.\n");
+}
+
+void *pollyPIAllocateDeviceMemory(long MemSize) {
+  const PIRuntime &Runtime = getRuntime();
+  void *DevPtr = nullptr;
+  checkPIError(Runtime.pi().piextUSMDeviceAlloc(&DevPtr, Runtime.Context,
+                                                Runtime.Device, nullptr,
+                                                MemSize, 0),
+               "Allocate memory for GPU device memory pointer failed.\n");
+  return DevPtr;
+}
+
+void pollyPIFreeDeviceMemory(void *DevPtr) {
+  const PIRuntime &Runtime = getRuntime();
+  // The memory may still be used by the commands of the queue.
+  pollyPISynchronize();
+  checkPIError(Runtime.pi().piextUSMFree(Runtime.Context, DevPtr),
+               "Failed to free device memory.\n");
+}
+
+void pollyPICopy(void *Dst, const void *Src, long MemSize) {
+  const PIRuntime &Runtime = getRuntime();
+  const auto &PI = Runtime.pi();
+  pi_event Event = nullptr;
+  checkPIError(PI.piextUSMEnqueueMemcpy(Runtime.Queue, PI_TRUE, Dst, Src,
+                                        MemSize, 0, nullptr, &Event),
+               "Copying data between the host and the device failed.\n");
+  if (Event)
+    checkPIError(PI.piEventRelease(Event), "Failed to release event.\n");
+}
+
+void *pollyPIMallocManaged(size_t Size) {
+  const PIRuntime &Runtime = getRuntime();
+  void *Mem = nullptr;
+  checkPIError(Runtime.pi().piextUSMSharedAlloc(&Mem, Runtime.Context,
+                                                Runtime.Device, nullptr, Size,
+                                                0),
+               "Allocating shared USM failed for size: %zu\n", Size);
+  return Mem;
+}
+
+void pollyPIFreeManaged(void *Mem) {
+  const PIRuntime &Runtime = getRuntime();
+  const auto &PI = Runtime.pi();
+
+  // As with CUDA, there may be more `free` calls in the original program than
+  // `malloc` calls, so memory which isn't USM is given back to the underlying
+  // allocator. Unlike CUDA, PI tells which memory is USM.
+  pi_usm_type Type = PI_MEM_TYPE_UNKNOWN;
+  checkPIError(PI.piextUSMGetMemAllocInfo(Runtime.Context, Mem,
+                                          PI_MEM_ALLOC_TYPE, sizeof(Type),
+                                          &Type, nullptr),
+               "Failed to get the type of the allocation.\n");
+  if (Type == PI_MEM_TYPE_UNKNOWN) {
+    free(Mem);
+    return;
+  }
+
+  pollyPISynchronize();
+  checkPIError(PI.piextUSMFree(Runtime.Context, Mem),
+               "Failed to free shared USM.\n");
+}
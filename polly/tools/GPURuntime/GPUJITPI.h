@@ -0,0 +1,60 @@
+/****************** GPUJITPI.h - SYCL PI backend of GPUJIT ********************/
+/*                                                                            */
+/* Part of the LLVM Project, under the Apache License v2.0 with LLVM          */
+/* Exceptions.                                                                */
+/* See https://llvm.org/LICENSE.txt for license information.                  */
+/* SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception                    */
+/*                                                                            */
+/******************************************************************************/
+/*                                                                            */
+/*  This file declares the SYCL Plugin Interface (PI) backend of GPUJIT.      */
+/*                                                                            */
+/******************************************************************************/
+
+#ifndef GPUJITPI_H_
+#define GPUJITPI_H_
+#include "stddef.h"
+
+/*
+ * The PI backend is written in C++, as the PI headers of the SYCL runtime
+ * are, and is only used by GPUJIT.c through the functions below. All the
+ * device pointers are USM pointers, which the kernels take as they are.
+ *
+ * The plugin is loaded from the library named by the POLLY_PI_PLUGIN
+ * environment variable, libpi_level_zero.so by default, and the first GPU it
+ * reports is used. The plugin, its context and its queue live until the
+ * process exits, since the managed memory allocated by global constructors
+ * belongs to the context.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Loads the plugin on the first call. */
+void pollyPIInitContext(int DebugMode);
+/* Waits for the commands enqueued so far. */
+void pollyPISynchronize(void);
+
+/* The binary is a SPIR-V module preceded by its size, see GPUJIT.h. */
+void *pollyPIGetKernel(const char *BinaryBuffer, const char *KernelName);
+void pollyPIFreeKernel(void *Kernel);
+void pollyPILaunchKernel(void *Kernel, unsigned int GridDimX,
+                         unsigned int GridDimY, unsigned int BlockDimX,
+                         unsigned int BlockDimY, unsigned int BlockDimZ,
+                         void **Parameters);
+
+void *pollyPIAllocateDeviceMemory(long MemSize);
+void pollyPIFreeDeviceMemory(void *DevPtr);
+/* Copies between the host and USM, blocking. */
+void pollyPICopy(void *Dst, const void *Src, long MemSize);
+
+/* Shared USM, which pollyPIFreeManaged tells apart from malloc'd memory. */
+void *pollyPIMallocManaged(size_t Size);
+void pollyPIFreeManaged(void *Mem);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GPUJITPI_H_ */
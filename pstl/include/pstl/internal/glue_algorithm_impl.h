@@ -0,0 +1,114 @@
+// -*- C++ -*-
+//===-- glue_algorithm_impl.h ---------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef _PSTL_GLUE_ALGORITHM_IMPL_H
+#define _PSTL_GLUE_ALGORITHM_IMPL_H
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+
+#include "execution_defs.h"
+#include "parallel_backend.h"
+#include "utils.h"
+
+// The parallel overloads of the algorithms run on the parallel backend when
+// the policy and the iterators allow it (__is_parallel), and otherwise as
+// their serial overloads do.
+
+_PSTL_HIDE_FROM_ABI_PUSH
+
+namespace std
+{
+
+// [alg.foreach]
+
+template <class _ExecutionPolicy, class _ForwardIterator, class _Function>
+__pstl::__internal::__enable_if_execution_policy<_ExecutionPolicy, void>
+for_each(_ExecutionPolicy&& __exec, _ForwardIterator __first, _ForwardIterator __last, _Function __f)
+{
+    __pstl::__internal::__except_handler([&]() {
+        if constexpr (__pstl::__internal::__is_parallel<_ExecutionPolicy, _ForwardIterator>::value)
+            __pstl::__par_backend::__parallel_for(
+                std::forward<_ExecutionPolicy>(__exec), __first, __last,
+                [&__f](_ForwardIterator __b, _ForwardIterator __e) { std::for_each(__b, __e, __f); });
+        else
+            std::for_each(__first, __last, __f);
+    });
+}
+
+template <class _ExecutionPolicy, class _ForwardIterator, class _Size, class _Function>
+__pstl::__internal::__enable_if_execution_policy<_ExecutionPolicy, _ForwardIterator>
+for_each_n(_ExecutionPolicy&& __exec, _ForwardIterator __first, _Size __n, _Function __f)
+{
+    if constexpr (__pstl::__internal::__is_parallel<_ExecutionPolicy, _ForwardIterator>::value)
+    {
+        if (__n <= 0)
+            return __first;
+        _ForwardIterator __last = __first + __n;
+        std::for_each(std::forward<_ExecutionPolicy>(__exec), __first, __last, __f);
+        return __last;
+    }
+    else
+        return __pstl::__internal::__except_handler([&]() { return std::for_each_n(__first, __n, __f); });
+}
+
+// [alg.sort]
+
+template <class _ExecutionPolicy, class _RandomAccessIterator, class _Compare>
+__pstl::__internal::__enable_if_execution_policy<_ExecutionPolicy, void>
+sort(_ExecutionPolicy&& __exec, _RandomAccessIterator __first, _RandomAccessIterator __last, _Compare __comp)
+{
+    __pstl::__internal::__except_handler([&]() {
+        if constexpr (__pstl::__internal::__is_parallel<_ExecutionPolicy, _RandomAccessIterator>::value)
+            __pstl::__par_backend::__parallel_stable_sort(
+                std::forward<_ExecutionPolicy>(__exec), __first, __last, __comp,
+                [](_RandomAccessIterator __b, _RandomAccessIterator __e, _Compare __c) { std::sort(__b, __e, __c); });
+        else
+            std::sort(__first, __last, __comp);
+    });
+}
+
+template <class _ExecutionPolicy, class _RandomAccessIterator>
+__pstl::__internal::__enable_if_execution_policy<_ExecutionPolicy, void>
+sort(_ExecutionPolicy&& __exec, _RandomAccessIterator __first, _RandomAccessIterator __last)
+{
+    std::sort(std::forward<_ExecutionPolicy>(__exec), __first, __last, std::less<>());
+}
+
+// [stable.sort]
+
+template <class _ExecutionPolicy, class _RandomAccessIterator, class _Compare>
+__pstl::__internal::__enable_if_execution_policy<_ExecutionPolicy, void>
+stable_sort(_ExecutionPolicy&& __exec, _RandomAccessIterator __first, _RandomAccessIterator __last, _Compare __comp)
+{
+    __pstl::__internal::__except_handler([&]() {
+        if constexpr (__pstl::__internal::__is_parallel<_ExecutionPolicy, _RandomAccessIterator>::value)
+            __pstl::__par_backend::__parallel_stable_sort(
+                std::forward<_ExecutionPolicy>(__exec), __first, __last, __comp,
+                [](_RandomAccessIterator __b, _RandomAccessIterator __e, _Compare __c) {
+                    std::stable_sort(__b, __e, __c);
+                });
+        else
+            std::stable_sort(__first, __last, __comp);
+    });
+}
+
+template <class _ExecutionPolicy, class _RandomAccessIterator>
+__pstl::__internal::__enable_if_execution_policy<_ExecutionPolicy, void>
+stable_sort(_ExecutionPolicy&& __exec, _RandomAccessIterator __first, _RandomAccessIterator __last)
+{
+    std::stable_sort(std::forward<_ExecutionPolicy>(__exec), __first, __last, std::less<>());
+}
+
+} // namespace std
+
+_PSTL_HIDE_FROM_ABI_POP
+
+#endif /* _PSTL_GLUE_ALGORITHM_IMPL_H */
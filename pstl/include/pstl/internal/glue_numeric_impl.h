@@ -0,0 +1,205 @@
+// -*- C++ -*-
+//===-- glue_numeric_impl.h -----------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef _PSTL_GLUE_NUMERIC_IMPL_H
+#define _PSTL_GLUE_NUMERIC_IMPL_H
+
+// <algorithm> comes first, the parallel backends use it and it includes the
+// parallel algorithms, which include the backends in turn
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <numeric>
+
+#include "execution_defs.h"
+#include "parallel_backend.h"
+#include "utils.h"
+
+// The reductions and scans combine the elements in the order of the ranges,
+// so that the operations need to be associative, but not commutative.
+
+_PSTL_HIDE_FROM_ABI_PUSH
+
+namespace std
+{
+
+// [transform.reduce]
+
+template <class _ExecutionPolicy, class _ForwardIterator1, class _ForwardIterator2, class _Tp, class _BinaryOperation1,
+          class _BinaryOperation2>
+__pstl::__internal::__enable_if_execution_policy<_ExecutionPolicy, _Tp>
+transform_reduce(_ExecutionPolicy&& __exec, _ForwardIterator1 __first1, _ForwardIterator1 __last1,
+                 _ForwardIterator2 __first2, _Tp __init, _BinaryOperation1 __binary_op1,
+                 _BinaryOperation2 __binary_op2)
+{
+    return __pstl::__internal::__except_handler([&]() {
+        if constexpr (__pstl::__internal::__is_parallel<_ExecutionPolicy, _ForwardIterator1, _ForwardIterator2>::value)
+            return __pstl::__par_backend::__parallel_transform_reduce(
+                std::forward<_ExecutionPolicy>(__exec), __first1, __last1,
+                [__first1, __first2, __binary_op2](_ForwardIterator1 __i) {
+                    return __binary_op2(*__i, *(__first2 + (__i - __first1)));
+                },
+                std::move(__init), __binary_op1,
+                [__first1, __first2, __binary_op1, __binary_op2](_ForwardIterator1 __i, _ForwardIterator1 __last,
+                                                                 _Tp __acc) {
+                    for (_ForwardIterator2 __j = __first2 + (__i - __first1); __i != __last; ++__i, ++__j)
+                        __acc = __binary_op1(std::move(__acc), __binary_op2(*__i, *__j));
+                    return __acc;
+                });
+        else
+            return std::transform_reduce(__first1, __last1, __first2, std::move(__init), __binary_op1, __binary_op2);
+    });
+}
+
+template <class _ExecutionPolicy, class _ForwardIterator1, class _ForwardIterator2, class _Tp>
+__pstl::__internal::__enable_if_execution_policy<_ExecutionPolicy, _Tp>
+transform_reduce(_ExecutionPolicy&& __exec, _ForwardIterator1 __first1, _ForwardIterator1 __last1,
+                 _ForwardIterator2 __first2, _Tp __init)
+{
+    return std::transform_reduce(std::forward<_ExecutionPolicy>(__exec), __first1, __last1, __first2,
+                                 std::move(__init), std::plus<>(), std::multiplies<>());
+}
+
+template <class _ExecutionPolicy, class _ForwardIterator, class _Tp, class _BinaryOperation, class _UnaryOperation>
+__pstl::__internal::__enable_if_execution_policy<_ExecutionPolicy, _Tp>
+transform_reduce(_ExecutionPolicy&& __exec, _ForwardIterator __first, _ForwardIterator __last, _Tp __init,
+                 _BinaryOperation __binary_op, _UnaryOperation __unary_op)
+{
+    return __pstl::__internal::__except_handler([&]() {
+        if constexpr (__pstl::__internal::__is_parallel<_ExecutionPolicy, _ForwardIterator>::value)
+            return __pstl::__par_backend::__parallel_transform_reduce(
+                std::forward<_ExecutionPolicy>(__exec), __first, __last,
+                [__unary_op](_ForwardIterator __i) { return __unary_op(*__i); }, std::move(__init), __binary_op,
+                [__binary_op, __unary_op](_ForwardIterator __i, _ForwardIterator __last, _Tp __acc) {
+                    for (; __i != __last; ++__i)
+                        __acc = __binary_op(std::move(__acc), __unary_op(*__i));
+                    return __acc;
+                });
+        else
+            return std::transform_reduce(__first, __last, std::move(__init), __binary_op, __unary_op);
+    });
+}
+
+// [reduce]
+
+template <class _ExecutionPolicy, class _ForwardIterator, class _Tp, class _BinaryOperation>
+__pstl::__internal::__enable_if_execution_policy<_ExecutionPolicy, _Tp>
+reduce(_ExecutionPolicy&& __exec, _ForwardIterator __first, _ForwardIterator __last, _Tp __init,
+       _BinaryOperation __binary_op)
+{
+    return std::transform_reduce(std::forward<_ExecutionPolicy>(__exec), __first, __last, std::move(__init),
+                                 __binary_op, __pstl::__internal::__no_op());
+}
+
+template <class _ExecutionPolicy, class _ForwardIterator, class _Tp>
+__pstl::__internal::__enable_if_execution_policy<_ExecutionPolicy, _Tp>
+reduce(_ExecutionPolicy&& __exec, _ForwardIterator __first, _ForwardIterator __last, _Tp __init)
+{
+    return std::reduce(std::forward<_ExecutionPolicy>(__exec), __first, __last, std::move(__init), std::plus<>());
+}
+
+template <class _ExecutionPolicy, class _ForwardIterator>
+__pstl::__internal::__enable_if_execution_policy<_ExecutionPolicy,
+                                                 typename iterator_traits<_ForwardIterator>::value_type>
+reduce(_ExecutionPolicy&& __exec, _ForwardIterator __first, _ForwardIterator __last)
+{
+    typedef typename iterator_traits<_ForwardIterator>::value_type _ValueType;
+    return std::reduce(std::forward<_ExecutionPolicy>(__exec), __first, __last, _ValueType{}, std::plus<>());
+}
+
+// [transform.inclusive.scan]
+
+template <class _ExecutionPolicy, class _ForwardIterator1, class _ForwardIterator2, class _BinaryOperation,
+          class _UnaryOperation, class _Tp>
+__pstl::__internal::__enable_if_execution_policy<_ExecutionPolicy, _ForwardIterator2>
+transform_inclusive_scan(_ExecutionPolicy&& __exec, _ForwardIterator1 __first, _ForwardIterator1 __last,
+                         _ForwardIterator2 __result, _BinaryOperation __binary_op, _UnaryOperation __unary_op,
+                         _Tp __init)
+{
+    return __pstl::__internal::__except_handler([&]() {
+        if constexpr (__pstl::__internal::__is_parallel<_ExecutionPolicy, _ForwardIterator1, _ForwardIterator2>::value)
+        {
+            typedef typename iterator_traits<_ForwardIterator1>::difference_type _DifferenceType;
+            _DifferenceType __n = __last - __first;
+            __pstl::__par_backend::__parallel_strict_scan(
+                std::forward<_ExecutionPolicy>(__exec), __n, std::move(__init),
+                [__first, __binary_op, __unary_op](_DifferenceType __i, _DifferenceType __len) {
+                    _ForwardIterator1 __it = __first + __i;
+                    _Tp __sum = __unary_op(*__it);
+                    for (_ForwardIterator1 __end = __it + __len; ++__it != __end;)
+                        __sum = __binary_op(std::move(__sum), __unary_op(*__it));
+                    return __sum;
+                },
+                __binary_op,
+                [__first, __result, __binary_op, __unary_op](_DifferenceType __i, _DifferenceType __len,
+                                                             _Tp __sum) {
+                    _ForwardIterator1 __it = __first + __i;
+                    _ForwardIterator2 __out = __result + __i;
+                    for (_ForwardIterator1 __end = __it + __len; __it != __end; ++__it, ++__out)
+                    {
+                        __sum = __binary_op(std::move(__sum), __unary_op(*__it));
+                        *__out = __sum;
+                    }
+                });
+            return __result + __n;
+        }
+        else
+            return std::transform_inclusive_scan(__first, __last, __result, __binary_op, __unary_op,
+                                                 std::move(__init));
+    });
+}
+
+template <class _ExecutionPolicy, class _ForwardIterator1, class _ForwardIterator2, class _BinaryOperation,
+          class _UnaryOperation>
+__pstl::__internal::__enable_if_execution_policy<_ExecutionPolicy, _ForwardIterator2>
+transform_inclusive_scan(_ExecutionPolicy&& __exec, _ForwardIterator1 __first, _ForwardIterator1 __last,
+                         _ForwardIterator2 __result, _BinaryOperation __binary_op, _UnaryOperation __unary_op)
+{
+    if (__first == __last)
+        return __result;
+    // The first element starts the sum, as there is no identity element
+    auto __tmp = __unary_op(*__first);
+    *__result = __tmp;
+    return std::transform_inclusive_scan(std::forward<_ExecutionPolicy>(__exec), ++__first, __last, ++__result,
+                                         __binary_op, __unary_op, std::move(__tmp));
+}
+
+// [inclusive.scan]
+
+template <class _ExecutionPolicy, class _ForwardIterator1, class _ForwardIterator2, class _BinaryOperation, class _Tp>
+__pstl::__internal::__enable_if_execution_policy<_ExecutionPolicy, _ForwardIterator2>
+inclusive_scan(_ExecutionPolicy&& __exec, _ForwardIterator1 __first, _ForwardIterator1 __last,
+               _ForwardIterator2 __result, _BinaryOperation __binary_op, _Tp __init)
+{
+    return std::transform_inclusive_scan(std::forward<_ExecutionPolicy>(__exec), __first, __last, __result,
+                                         __binary_op, __pstl::__internal::__no_op(), std::move(__init));
+}
+
+template <class _ExecutionPolicy, class _ForwardIterator1, class _ForwardIterator2, class _BinaryOperation>
+__pstl::__internal::__enable_if_execution_policy<_ExecutionPolicy, _ForwardIterator2>
+inclusive_scan(_ExecutionPolicy&& __exec, _ForwardIterator1 __first, _ForwardIterator1 __last,
+               _ForwardIterator2 __result, _BinaryOperation __binary_op)
+{
+    return std::transform_inclusive_scan(std::forward<_ExecutionPolicy>(__exec), __first, __last, __result,
+                                         __binary_op, __pstl::__internal::__no_op());
+}
+
+template <class _ExecutionPolicy, class _ForwardIterator1, class _ForwardIterator2>
+__pstl::__internal::__enable_if_execution_policy<_ExecutionPolicy, _ForwardIterator2>
+inclusive_scan(_ExecutionPolicy&& __exec, _ForwardIterator1 __first, _ForwardIterator1 __last,
+               _ForwardIterator2 __result)
+{
+    return std::inclusive_scan(std::forward<_ExecutionPolicy>(__exec), __first, __last, __result, std::plus<>());
+}
+
+} // namespace std
+
+_PSTL_HIDE_FROM_ABI_POP
+
+#endif /* _PSTL_GLUE_NUMERIC_IMPL_H */
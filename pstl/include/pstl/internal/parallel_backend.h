@@ -0,0 +1,49 @@
+// -*- C++ -*-
+//===-- parallel_backend.h ------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef _PSTL_PARALLEL_BACKEND_H
+#define _PSTL_PARALLEL_BACKEND_H
+
+#include "pstl_config.h"
+
+// A backend provides, in its namespace, the primitives the algorithms are
+// written with:
+//   __parallel_for(__exec, __first, __last, __f)
+//     calls __f(__b, __e) on subranges partitioning [__first, __last);
+//   __parallel_transform_reduce(__exec, __first, __last, __u, __init, __combine, __brick_reduce)
+//     reduces subranges with __brick_reduce(__b, __e, __init) and combines the
+//     results in order;
+//   __parallel_strict_scan(__exec, __n, __initial, __reduce, __combine, __scan)
+//     scans [0, __n) in subranges, see __utils::__chunked_strict_scan;
+//   __parallel_stable_sort(__exec, __first, __last, __comp, __leaf_sort)
+//     sorts subranges with __leaf_sort and merges them.
+
+#if defined(_PSTL_PAR_BACKEND_SERIAL)
+#    include "parallel_backend_serial.h"
+namespace __pstl
+{
+namespace __par_backend = __serial_backend;
+}
+#elif defined(_PSTL_PAR_BACKEND_TBB)
+#    include "parallel_backend_tbb.h"
+namespace __pstl
+{
+namespace __par_backend = __tbb_backend;
+}
+#elif defined(_PSTL_PAR_BACKEND_OMP)
+#    include "parallel_backend_omp.h"
+namespace __pstl
+{
+namespace __par_backend = __omp_backend;
+}
+#else
+_PSTL_PRAGMA_MESSAGE("Parallel backend was not specified");
+#endif
+
+#endif /* _PSTL_PARALLEL_BACKEND_H */
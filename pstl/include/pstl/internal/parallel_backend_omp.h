@@ -0,0 +1,137 @@
+// -*- C++ -*-
+//===-- parallel_backend_omp.h --------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef _PSTL_PARALLEL_BACKEND_OMP_H
+#define _PSTL_PARALLEL_BACKEND_OMP_H
+
+#include <algorithm>
+#include <omp.h>
+
+#include "parallel_backend_utils.h"
+#include "pstl_config.h"
+
+// The OpenMP backend runs the chunks of the ranges as OpenMP tasks, on the
+// team of the caller when it runs in a parallel region, or else on a team
+// started for the algorithm.
+
+_PSTL_HIDE_FROM_ABI_PUSH
+
+namespace __pstl
+{
+namespace __omp_backend
+{
+
+template <class _Fp>
+void
+__run_on_team(_Fp __f)
+{
+    if (omp_in_parallel())
+    {
+        __f();
+        return;
+    }
+    _PSTL_PRAGMA(omp parallel)
+    _PSTL_PRAGMA(omp single nowait)
+    __f();
+}
+
+template <class _Size, class _Fp>
+void
+__for_chunks(_Size __chunks, _Fp __f)
+{
+    __run_on_team([&]() {
+        _PSTL_PRAGMA(omp taskloop untied grainsize(1))
+        for (_Size __chunk = 0; __chunk < __chunks; ++__chunk)
+            __f(__chunk);
+    });
+}
+
+struct __chunks_runner
+{
+    template <class _Size, class _Fp>
+    void
+    operator()(_Size __chunks, _Fp __f) const
+    {
+        __omp_backend::__for_chunks(__chunks, __f);
+    }
+};
+
+template <class _ExecutionPolicy, class _Index, class _Fp>
+void
+__parallel_for(_ExecutionPolicy&&, _Index __first, _Index __last, _Fp __f)
+{
+    auto __n = __last - __first;
+    auto __chunks = __utils::__chunk_count(__n);
+    if (__chunks <= 1)
+    {
+        __f(__first, __last);
+        return;
+    }
+    __omp_backend::__for_chunks(__chunks, [&](decltype(__n) __chunk) {
+        auto __bounds = __utils::__chunk_bounds(__n, __chunk);
+        __f(__first + __bounds.first, __first + __bounds.second);
+    });
+}
+
+template <class _ExecutionPolicy, class _Index, class _Up, class _Tp, class _Cp, class _Rp>
+_Tp
+__parallel_transform_reduce(_ExecutionPolicy&&, _Index __first, _Index __last, _Up __u, _Tp __init, _Cp __combine,
+                            _Rp __brick_reduce)
+{
+    return __utils::__chunked_transform_reduce(__chunks_runner(), __first, __last, __u, std::move(__init), __combine,
+                                               __brick_reduce);
+}
+
+template <class _ExecutionPolicy, typename _Index, typename _Tp, typename _Rp, typename _Cp, typename _Sp>
+void
+__parallel_strict_scan(_ExecutionPolicy&&, _Index __n, _Tp __initial, _Rp __reduce, _Cp __combine, _Sp __scan)
+{
+    __utils::__chunked_strict_scan(__chunks_runner(), __n, std::move(__initial), __reduce, __combine, __scan);
+}
+
+// A merge sort whose halves are sorted by separate tasks, down to chunks that
+// __leaf_sort sorts
+template <typename _RandomAccessIterator, typename _Compare, typename _LeafSort>
+void
+__parallel_stable_sort_body(_RandomAccessIterator __xs, _RandomAccessIterator __xe, _Compare __comp,
+                            _LeafSort __leaf_sort)
+{
+    if (__xe - __xs <= static_cast<decltype(__xe - __xs)>(__utils::__default_chunk_size))
+    {
+        __leaf_sort(__xs, __xe, __comp);
+        return;
+    }
+    _RandomAccessIterator __xm = __xs + (__xe - __xs) / 2;
+    _PSTL_PRAGMA(omp task untied)
+    __omp_backend::__parallel_stable_sort_body(__xs, __xm, __comp, __leaf_sort);
+    __omp_backend::__parallel_stable_sort_body(__xm, __xe, __comp, __leaf_sort);
+    _PSTL_PRAGMA(omp taskwait)
+    std::inplace_merge(__xs, __xm, __xe, __comp);
+}
+
+template <class _ExecutionPolicy, typename _RandomAccessIterator, typename _Compare, typename _LeafSort>
+void
+__parallel_stable_sort(_ExecutionPolicy&&, _RandomAccessIterator __xs, _RandomAccessIterator __xe, _Compare __comp,
+                       _LeafSort __leaf_sort)
+{
+    if (__xe - __xs <= static_cast<decltype(__xe - __xs)>(__utils::__default_chunk_size))
+    {
+        __leaf_sort(__xs, __xe, __comp);
+        return;
+    }
+    __omp_backend::__run_on_team(
+        [&]() { __omp_backend::__parallel_stable_sort_body(__xs, __xe, __comp, __leaf_sort); });
+}
+
+} // namespace __omp_backend
+} // namespace __pstl
+
+_PSTL_HIDE_FROM_ABI_POP
+
+#endif /* _PSTL_PARALLEL_BACKEND_OMP_H */
@@ -0,0 +1,84 @@
+// -*- C++ -*-
+//===-- parallel_backend_tbb.h --------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef _PSTL_PARALLEL_BACKEND_TBB_H
+#define _PSTL_PARALLEL_BACKEND_TBB_H
+
+#include <algorithm>
+
+#include "parallel_backend_utils.h"
+#include "pstl_config.h"
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_invoke.h>
+
+_PSTL_HIDE_FROM_ABI_PUSH
+
+namespace __pstl
+{
+namespace __tbb_backend
+{
+
+struct __chunks_runner
+{
+    template <class _Size, class _Fp>
+    void
+    operator()(_Size __chunks, _Fp __f) const
+    {
+        tbb::parallel_for(_Size(0), __chunks, [&__f](_Size __chunk) { __f(__chunk); });
+    }
+};
+
+template <class _ExecutionPolicy, class _Index, class _Fp>
+void
+__parallel_for(_ExecutionPolicy&&, _Index __first, _Index __last, _Fp __f)
+{
+    tbb::parallel_for(tbb::blocked_range<_Index>(__first, __last, __utils::__default_chunk_size),
+                      [&__f](const tbb::blocked_range<_Index>& __range) { __f(__range.begin(), __range.end()); });
+}
+
+template <class _ExecutionPolicy, class _Index, class _Up, class _Tp, class _Cp, class _Rp>
+_Tp
+__parallel_transform_reduce(_ExecutionPolicy&&, _Index __first, _Index __last, _Up __u, _Tp __init, _Cp __combine,
+                            _Rp __brick_reduce)
+{
+    return __utils::__chunked_transform_reduce(__chunks_runner(), __first, __last, __u, std::move(__init), __combine,
+                                               __brick_reduce);
+}
+
+template <class _ExecutionPolicy, typename _Index, typename _Tp, typename _Rp, typename _Cp, typename _Sp>
+void
+__parallel_strict_scan(_ExecutionPolicy&&, _Index __n, _Tp __initial, _Rp __reduce, _Cp __combine, _Sp __scan)
+{
+    __utils::__chunked_strict_scan(__chunks_runner(), __n, std::move(__initial), __reduce, __combine, __scan);
+}
+
+template <class _ExecutionPolicy, typename _RandomAccessIterator, typename _Compare, typename _LeafSort>
+void
+__parallel_stable_sort(_ExecutionPolicy&& __exec, _RandomAccessIterator __xs, _RandomAccessIterator __xe,
+                       _Compare __comp, _LeafSort __leaf_sort)
+{
+    if (__xe - __xs <= static_cast<decltype(__xe - __xs)>(__utils::__default_chunk_size))
+    {
+        __leaf_sort(__xs, __xe, __comp);
+        return;
+    }
+    _RandomAccessIterator __xm = __xs + (__xe - __xs) / 2;
+    tbb::parallel_invoke([&]() { __tbb_backend::__parallel_stable_sort(__exec, __xs, __xm, __comp, __leaf_sort); },
+                         [&]() { __tbb_backend::__parallel_stable_sort(__exec, __xm, __xe, __comp, __leaf_sort); });
+    std::inplace_merge(__xs, __xm, __xe, __comp);
+}
+
+} // namespace __tbb_backend
+} // namespace __pstl
+
+_PSTL_HIDE_FROM_ABI_POP
+
+#endif /* _PSTL_PARALLEL_BACKEND_TBB_H */
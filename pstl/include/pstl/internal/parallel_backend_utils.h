@@ -0,0 +1,145 @@
+// -*- C++ -*-
+//===-- parallel_backend_utils.h ------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef _PSTL_PARALLEL_BACKEND_UTILS_H
+#define _PSTL_PARALLEL_BACKEND_UTILS_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "pstl_config.h"
+
+_PSTL_HIDE_FROM_ABI_PUSH
+
+namespace __pstl
+{
+namespace __utils
+{
+
+// The ranges are divided into chunks of this many elements, each of which is
+// handled by one task: small enough to balance the load, large enough for the
+// task to cost little next to its elements.
+constexpr std::size_t __default_chunk_size = 2048;
+
+template <typename _Size>
+_Size
+__chunk_count(_Size __n)
+{
+    return (__n + _Size(__default_chunk_size) - 1) / _Size(__default_chunk_size);
+}
+
+// The bounds [__begin, __end) of chunk __chunk of [0, __n)
+template <typename _Size>
+std::pair<_Size, _Size>
+__chunk_bounds(_Size __n, _Size __chunk)
+{
+    _Size __begin = __chunk * _Size(__default_chunk_size);
+    _Size __end = __n - __begin > _Size(__default_chunk_size) ? __begin + _Size(__default_chunk_size) : __n;
+    return {__begin, __end};
+}
+
+// Raw memory for one value per chunk, which the algorithms construct and
+// destroy themselves
+template <typename _Tp>
+class __buffer
+{
+    std::allocator<_Tp> __allocator_;
+    _Tp* __ptr_;
+    const std::size_t __buf_size_;
+    __buffer(const __buffer&) = delete;
+    void
+    operator=(const __buffer&) = delete;
+
+  public:
+    explicit __buffer(std::size_t __n) : __allocator_(), __ptr_(__allocator_.allocate(__n)), __buf_size_(__n) {}
+
+    _Tp*
+    get() const
+    {
+        return __ptr_;
+    }
+
+    ~__buffer() { __allocator_.deallocate(__ptr_, __buf_size_); }
+};
+
+// Reduces the chunks of [__first, __last) in parallel, then combines their
+// sums in order, so that __combine need not be commutative.  Each chunk starts
+// from its first element, transformed by __u, as there is no identity element.
+// __for_chunks(__n, __f) calls __f(0) ... __f(__n - 1) in parallel and waits.
+template <class _ForChunks, class _Index, class _Up, class _Tp, class _Cp, class _Rp>
+_Tp
+__chunked_transform_reduce(_ForChunks __for_chunks, _Index __first, _Index __last, _Up __u, _Tp __init,
+                           _Cp __combine, _Rp __brick_reduce)
+{
+    auto __n = __last - __first;
+    auto __chunks = __chunk_count(__n);
+    if (__chunks <= 1)
+        return __brick_reduce(__first, __last, std::move(__init));
+
+    __buffer<_Tp> __sums(__chunks);
+    _Tp* __sum = __sums.get();
+    __for_chunks(__chunks, [&](decltype(__n) __chunk) {
+        auto __bounds = __chunk_bounds(__n, __chunk);
+        _Index __begin = __first + __bounds.first;
+        new (__sum + __chunk) _Tp(__brick_reduce(__begin + 1, __first + __bounds.second, __u(__begin)));
+    });
+    for (decltype(__n) __chunk = 0; __chunk < __chunks; ++__chunk)
+    {
+        __init = __combine(std::move(__init), std::move(__sum[__chunk]));
+        __sum[__chunk].~_Tp();
+    }
+    return __init;
+}
+
+// A scan in two passes over the chunks of [0, __n): __reduce(__i, __len)
+// returns the sum of a chunk, and __scan(__i, __len, __initial) writes its
+// scan starting from the sum of the elements before it.
+template <class _ForChunks, class _Index, class _Tp, class _Rp, class _Cp, class _Sp>
+void
+__chunked_strict_scan(_ForChunks __for_chunks, _Index __n, _Tp __initial, _Rp __reduce, _Cp __combine, _Sp __scan)
+{
+    _Index __chunks = __chunk_count(__n);
+    if (__chunks <= 1)
+    {
+        if (__n > 0)
+            __scan(_Index(0), __n, std::move(__initial));
+        return;
+    }
+
+    // The last chunk isn't reduced, nothing follows it
+    __buffer<_Tp> __sums(__chunks);
+    _Tp* __sum = __sums.get();
+    __for_chunks(__chunks - 1, [&](_Index __chunk) {
+        auto __bounds = __chunk_bounds(__n, __chunk);
+        new (__sum + __chunk) _Tp(__reduce(__bounds.first, __bounds.second - __bounds.first));
+    });
+    // Each sum is replaced by the sum of the chunks before it
+    for (_Index __chunk = 0; __chunk + 1 < __chunks; ++__chunk)
+    {
+        _Tp __next = __combine(__initial, __sum[__chunk]);
+        __sum[__chunk] = std::move(__initial);
+        __initial = std::move(__next);
+    }
+    new (__sum + __chunks - 1) _Tp(std::move(__initial));
+    __for_chunks(__chunks, [&](_Index __chunk) {
+        auto __bounds = __chunk_bounds(__n, __chunk);
+        __scan(__bounds.first, __bounds.second - __bounds.first, __sum[__chunk]);
+    });
+    for (_Index __chunk = 0; __chunk < __chunks; ++__chunk)
+        __sum[__chunk].~_Tp();
+}
+
+} // namespace __utils
+} // namespace __pstl
+
+_PSTL_HIDE_FROM_ABI_POP
+
+#endif /* _PSTL_PARALLEL_BACKEND_UTILS_H */
@@ -0,0 +1,55 @@
+// -*- C++ -*-
+//===-- for_each.pass.cpp -------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++03, c++11, c++14
+
+#include <algorithm>
+#include <cassert>
+#include <execution>
+#include <iostream>
+#include <list>
+#include <numeric>
+#include <vector>
+
+static const std::size_t sizes[] = {0, 1, 2, 100, 2047, 2048, 2049, 4097, 100003};
+
+template <class Policy>
+void
+test(Policy&& exec)
+{
+    for (std::size_t n : sizes)
+    {
+        std::vector<long> v(n);
+        std::iota(v.begin(), v.end(), 0);
+        std::for_each(exec, v.begin(), v.end(), [](long& x) { x *= 3; });
+        for (std::size_t i = 0; i < n; ++i)
+            assert(v[i] == 3 * static_cast<long>(i));
+
+        auto end = std::for_each_n(exec, v.begin(), n / 2, [](long& x) { x = -x; });
+        assert(end == v.begin() + n / 2);
+        for (std::size_t i = 0; i < n; ++i)
+            assert(v[i] == (i < n / 2 ? -3 : 3) * static_cast<long>(i));
+
+        // Iterators that aren't random access run serially
+        std::list<long> l(v.begin(), v.end());
+        std::for_each(exec, l.begin(), l.end(), [](long& x) { ++x; });
+        assert(std::equal(l.begin(), l.end(), v.begin(), v.end(), [](long a, long b) { return a == b + 1; }));
+    }
+}
+
+int
+main()
+{
+    test(std::execution::seq);
+    test(std::execution::unseq);
+    test(std::execution::par);
+    test(std::execution::par_unseq);
+    std::cout << "done" << std::endl;
+    return 0;
+}
@@ -0,0 +1,75 @@
+// -*- C++ -*-
+//===-- sort.pass.cpp -----------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++03, c++11, c++14
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <execution>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+// The sizes are around the multiples of the chunks of the parallel backends
+static const std::size_t sizes[] = {0, 1, 2, 100, 2047, 2048, 2049, 4097, 100003};
+
+static std::vector<std::pair<unsigned, unsigned>>
+make_input(std::size_t n)
+{
+    std::vector<std::pair<unsigned, unsigned>> in(n);
+    std::uint32_t x = 2463534242u;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        in[i] = {x % 1000, static_cast<unsigned>(i)};
+    }
+    return in;
+}
+
+template <class Policy>
+void
+test(Policy&& exec)
+{
+    auto by_key = [](const std::pair<unsigned, unsigned>& a, const std::pair<unsigned, unsigned>& b) {
+        return a.first < b.first;
+    };
+    for (std::size_t n : sizes)
+    {
+        auto in = make_input(n);
+
+        auto expected = in;
+        std::sort(expected.begin(), expected.end());
+        auto out = in;
+        std::sort(exec, out.begin(), out.end());
+        assert(out == expected);
+
+        out = in;
+        std::sort(exec, out.begin(), out.end(), by_key);
+        assert(std::is_sorted(out.begin(), out.end(), by_key));
+
+        // The elements with the same key keep the order of their second member
+        out = in;
+        std::stable_sort(exec, out.begin(), out.end(), by_key);
+        assert(out == expected);
+    }
+}
+
+int
+main()
+{
+    test(std::execution::seq);
+    test(std::execution::unseq);
+    test(std::execution::par);
+    test(std::execution::par_unseq);
+    std::cout << "done" << std::endl;
+    return 0;
+}
@@ -0,0 +1,90 @@
+// -*- C++ -*-
+//===-- inclusive_scan.pass.cpp -------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++03, c++11, c++14
+
+#include <cassert>
+#include <execution>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+static const std::size_t sizes[] = {0, 1, 2, 100, 2047, 2048, 2049, 4097, 100003};
+
+// x -> a * x + b modulo 2^32, whose composition is associative but not
+// commutative
+struct affine
+{
+    unsigned a, b;
+    bool
+    operator==(const affine& other) const
+    {
+        return a == other.a && b == other.b;
+    }
+};
+
+struct compose
+{
+    affine
+    operator()(const affine& f, const affine& g) const
+    {
+        return {g.a * f.a, g.a * f.b + g.b};
+    }
+};
+
+template <class Policy>
+void
+test(Policy&& exec)
+{
+    for (std::size_t n : sizes)
+    {
+        std::vector<affine> in(n);
+        for (std::size_t i = 0; i < n; ++i)
+            in[i] = {static_cast<unsigned>(2 * i + 1), static_cast<unsigned>(i * i)};
+
+        std::vector<affine> expected(n), out(n);
+        std::inclusive_scan(in.begin(), in.end(), expected.begin(), compose());
+        auto end = std::inclusive_scan(exec, in.begin(), in.end(), out.begin(), compose());
+        assert(end == out.end());
+        assert(out == expected);
+
+        affine init{3, 7};
+        std::inclusive_scan(in.begin(), in.end(), expected.begin(), compose(), init);
+        std::inclusive_scan(exec, in.begin(), in.end(), out.begin(), compose(), init);
+        assert(out == expected);
+
+        // In place
+        out = in;
+        std::inclusive_scan(exec, out.begin(), out.end(), out.begin(), compose(), init);
+        assert(out == expected);
+
+        std::vector<long> v(n), sums(n);
+        std::iota(v.begin(), v.end(), 1);
+        std::inclusive_scan(exec, v.begin(), v.end(), sums.begin());
+        for (std::size_t i = 0; i < n; ++i)
+            assert(sums[i] == static_cast<long>((i + 1) * (i + 2) / 2));
+
+        std::transform_inclusive_scan(exec, v.begin(), v.end(), sums.begin(), std::plus<>(),
+                                      [](long x) { return 2 * x; }, 1L);
+        for (std::size_t i = 0; i < n; ++i)
+            assert(sums[i] == static_cast<long>((i + 1) * (i + 2) + 1));
+    }
+}
+
+int
+main()
+{
+    test(std::execution::seq);
+    test(std::execution::unseq);
+    test(std::execution::par);
+    test(std::execution::par_unseq);
+    std::cout << "done" << std::endl;
+    return 0;
+}
@@ -0,0 +1,63 @@
+// -*- C++ -*-
+//===-- reduce.pass.cpp ---------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++03, c++11, c++14
+
+#include <cassert>
+#include <execution>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+static const std::size_t sizes[] = {0, 1, 2, 100, 2047, 2048, 2049, 4097, 100003};
+
+template <class Policy>
+void
+test(Policy&& exec)
+{
+    for (std::size_t n : sizes)
+    {
+        std::vector<long long> a(n), b(n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            a[i] = static_cast<long long>(i % 97) - 40;
+            b[i] = static_cast<long long>(i % 13) + 1;
+        }
+        long long sum = 0, dot = 0, squares = 0;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            sum += a[i];
+            dot += a[i] * b[i];
+            squares += a[i] * a[i];
+        }
+
+        assert(std::reduce(exec, a.begin(), a.end()) == sum);
+        assert(std::reduce(exec, a.begin(), a.end(), 5LL) == sum + 5);
+        assert(std::reduce(exec, a.begin(), a.end(), 0LL, std::plus<>()) == sum);
+        assert(std::transform_reduce(exec, a.begin(), a.end(), b.begin(), 0LL) == dot);
+        assert(std::transform_reduce(exec, a.begin(), a.end(), b.begin(), 1LL, std::plus<>(), std::multiplies<>()) ==
+               dot + 1);
+        assert(std::transform_reduce(exec, a.begin(), a.end(), 0LL, std::plus<>(),
+                                     [](long long x) { return x * x; }) == squares);
+        // The initial value and the elements may have different types
+        assert(std::reduce(exec, b.begin(), b.end(), 0.5) == static_cast<double>(std::reduce(b.begin(), b.end())) + 0.5);
+    }
+}
+
+int
+main()
+{
+    test(std::execution::seq);
+    test(std::execution::unseq);
+    test(std::execution::par);
+    test(std::execution::par_unseq);
+    std::cout << "done" << std::endl;
+    return 0;
+}
@@ -0,0 +1,545 @@
+//==--- application_workloads.cpp --- SYCL application workload benchmarks -==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Measures the end-to-end throughput of the workloads SYCL applications are
+// made of: streaming through buffers and USM, USM copies, matrix
+// multiplication, reductions, prefix scans, graphs of many small kernels,
+// pipelines of kernels and host tasks over several queues, and the builds of
+// the programs on a cold start. The ESIMD matrix multiplication is in
+// esimd_workloads.cpp.
+//
+// Each benchmark is registered once per device, see benchmark_devices.hpp, and
+// reports its throughput in bytes, items or FLOP per second along with its
+// time. The results of a run are written as JSON with
+//
+//   sycl-application-benchmarks --benchmark_out=results.json
+//     --benchmark_out_format=json --benchmark_repetitions=5
+//
+// and compare_results.py compares them with the results of a baseline run.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark_devices.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+using namespace cl::sycl;
+using namespace sycl_benchmarks;
+
+template <bool IsTriad> class StreamBufferKernel;
+template <bool IsTriad> class StreamUSMKernel;
+class GemmKernel;
+class ReductionBufferKernel;
+class ReductionUSMKernel;
+class DAGBufferKernel;
+class DAGUSMKernel;
+class PipelineProduceKernel;
+class PipelineConsumeKernel;
+class ColdStartKernel;
+
+namespace {
+std::vector<std::unique_ptr<BenchmarkDevice>> Devices;
+
+constexpr float StreamScalar = 3.0f;
+
+/// Marks the benchmark as failed unless \p Ok; the time of a wrong result is
+/// not worth comparing.
+void checkResult(benchmark::State &State, bool Ok, const char *Workload) {
+  if (!Ok)
+    State.SkipWithError(Workload);
+}
+
+/// STREAM copy (A = B) or triad (A = B + s * C) through buffers. The buffers
+/// stay on the device between the iterations, so the results are the device
+/// bandwidth with the costs of the accessors and of the scheduler.
+template <bool IsTriad>
+void BM_StreamBuffer(benchmark::State &State, BenchmarkDevice *Device) {
+  queue &Queue = Device->Queue;
+  const size_t N = State.range(0);
+  buffer<float, 1> A{range<1>{N}}, B{range<1>{N}}, C{range<1>{N}};
+  Queue.submit([&](handler &CGH) {
+    CGH.fill(B.get_access<access::mode::discard_write>(CGH), 1.0f);
+  });
+  Queue.submit([&](handler &CGH) {
+    CGH.fill(C.get_access<access::mode::discard_write>(CGH), 2.0f);
+  });
+  for (auto _ : State) {
+    Queue.submit([&](handler &CGH) {
+      auto AAcc = A.get_access<access::mode::discard_write>(CGH);
+      auto BAcc = B.get_access<access::mode::read>(CGH);
+      auto CAcc = C.get_access<access::mode::read>(CGH);
+      CGH.parallel_for<StreamBufferKernel<IsTriad>>(
+          range<1>{N}, [=](id<1> I) {
+            AAcc[I] = IsTriad ? BAcc[I] + StreamScalar * CAcc[I] : BAcc[I];
+          });
+    });
+    Queue.wait();
+  }
+  const float Expected = IsTriad ? 1.0f + StreamScalar * 2.0f : 1.0f;
+  checkResult(State, A.get_access<access::mode::read>()[N - 1] == Expected,
+              "wrong STREAM result");
+  State.SetBytesProcessed(State.iterations() * (IsTriad ? 3 : 2) * N *
+                          sizeof(float));
+}
+
+/// The same STREAM kernels on device USM, without the scheduler.
+template <bool IsTriad>
+void BM_StreamUSM(benchmark::State &State, BenchmarkDevice *Device) {
+  queue &Queue = Device->Queue;
+  const size_t N = State.range(0);
+  float *A = malloc_device<float>(N, Queue);
+  float *B = malloc_device<float>(N, Queue);
+  float *C = malloc_device<float>(N, Queue);
+  Queue.fill(B, 1.0f, N);
+  Queue.fill(C, 2.0f, N);
+  Queue.wait();
+  for (auto _ : State) {
+    Queue.submit([&](handler &CGH) {
+      CGH.parallel_for<StreamUSMKernel<IsTriad>>(range<1>{N}, [=](id<1> I) {
+        A[I] = IsTriad ? B[I] + StreamScalar * C[I] : B[I];
+      });
+    });
+    Queue.wait();
+  }
+  float Last = 0.0f;
+  Queue.memcpy(&Last, A + N - 1, sizeof(float)).wait();
+  const float Expected = IsTriad ? 1.0f + StreamScalar * 2.0f : 1.0f;
+  checkResult(State, Last == Expected, "wrong STREAM result");
+  State.SetBytesProcessed(State.iterations() * (IsTriad ? 3 : 2) * N *
+                          sizeof(float));
+  free(A, Queue);
+  free(B, Queue);
+  free(C, Queue);
+}
+
+/// The memory a USM copy reads or writes.
+enum class MemoryKind { Pageable, Host, Device };
+
+void *allocateMemory(queue &Queue, size_t Bytes, MemoryKind Kind) {
+  switch (Kind) {
+  case MemoryKind::Pageable: {
+    void *Ptr = std::malloc(Bytes);
+    // The pages are mapped before the copies
+    std::memset(Ptr, 0, Bytes);
+    return Ptr;
+  }
+  case MemoryKind::Host:
+    return malloc_host(Bytes, Queue);
+  case MemoryKind::Device:
+    return malloc_device(Bytes, Queue);
+  }
+  return nullptr;
+}
+
+void freeMemory(queue &Queue, void *Ptr, MemoryKind Kind) {
+  if (Kind == MemoryKind::Pageable)
+    std::free(Ptr);
+  else
+    free(Ptr, Queue);
+}
+
+/// The bandwidth of queue::memcpy between the kinds of memory.
+void BM_Memcpy(benchmark::State &State, BenchmarkDevice *Device,
+               MemoryKind SrcKind, MemoryKind DstKind) {
+  queue &Queue = Device->Queue;
+  const size_t Bytes = State.range(0);
+  void *Src = allocateMemory(Queue, Bytes, SrcKind);
+  void *Dst = allocateMemory(Queue, Bytes, DstKind);
+  for (auto _ : State)
+    Queue.memcpy(Dst, Src, Bytes).wait();
+  State.SetBytesProcessed(State.iterations() * Bytes);
+  freeMemory(Queue, Src, SrcKind);
+  freeMemory(Queue, Dst, DstKind);
+}
+
+constexpr size_t GemmTile = 16;
+
+/// C = A * B for square matrices of floats, with the tiles of A and B staged
+/// in local memory by the work-groups.
+void BM_Gemm(benchmark::State &State, BenchmarkDevice *Device) {
+  queue &Queue = Device->Queue;
+  const size_t N = State.range(0);
+  if (Queue.get_device().get_info<info::device::max_work_group_size>() <
+      GemmTile * GemmTile) {
+    State.SkipWithError("work-groups too small for the GEMM tiles");
+    return;
+  }
+  float *A = malloc_device<float>(N * N, Queue);
+  float *B = malloc_device<float>(N * N, Queue);
+  float *C = malloc_device<float>(N * N, Queue);
+  Queue.fill(A, 1.0f, N * N);
+  Queue.fill(B, 2.0f, N * N);
+  Queue.wait();
+  for (auto _ : State) {
+    Queue.submit([&](handler &CGH) {
+      using TileAccessor =
+          accessor<float, 2, access::mode::read_write, access::target::local>;
+      TileAccessor ATile{range<2>{GemmTile, GemmTile}, CGH};
+      TileAccessor BTile{range<2>{GemmTile, GemmTile}, CGH};
+      CGH.parallel_for<GemmKernel>(
+          nd_range<2>{range<2>{N, N}, range<2>{GemmTile, GemmTile}},
+          [=](nd_item<2> It) {
+            const size_t Row = It.get_global_id(0);
+            const size_t Col = It.get_global_id(1);
+            const size_t LocalRow = It.get_local_id(0);
+            const size_t LocalCol = It.get_local_id(1);
+            float Sum = 0.0f;
+            for (size_t K0 = 0; K0 < N; K0 += GemmTile) {
+              ATile[LocalRow][LocalCol] = A[Row * N + K0 + LocalCol];
+              BTile[LocalRow][LocalCol] = B[(K0 + LocalRow) * N + Col];
+              It.barrier(access::fence_space::local_space);
+              for (size_t K = 0; K < GemmTile; ++K)
+                Sum += ATile[LocalRow][K] * BTile[K][LocalCol];
+              It.barrier(access::fence_space::local_space);
+            }
+            C[Row * N + Col] = Sum;
+          });
+    });
+    Queue.wait();
+  }
+  float Last = 0.0f;
+  Queue.memcpy(&Last, C + N * N - 1, sizeof(float)).wait();
+  checkResult(State, Last == 2.0f * N, "wrong GEMM result");
+  State.counters["FLOP/s"] = benchmark::Counter(
+      2.0 * N * N * N * State.iterations(), benchmark::Counter::kIsRate);
+  free(A, Queue);
+  free(B, Queue);
+  free(C, Queue);
+}
+
+size_t getWorkGroupSize(const queue &Queue) {
+  return std::min<size_t>(
+      256, Queue.get_device().get_info<info::device::max_work_group_size>());
+}
+
+/// The sum of N integers with a reduction to a buffer.
+void BM_ReductionBuffer(benchmark::State &State, BenchmarkDevice *Device) {
+  queue &Queue = Device->Queue;
+  const size_t N = State.range(0);
+  const size_t WGSize = getWorkGroupSize(Queue);
+  buffer<unsigned, 1> In{range<1>{N}};
+  buffer<unsigned, 1> Sum{range<1>{1}};
+  Queue.submit([&](handler &CGH) {
+    CGH.fill(In.get_access<access::mode::discard_write>(CGH), 1u);
+  });
+  for (auto _ : State) {
+    Queue.submit([&](handler &CGH) {
+      auto InAcc = In.get_access<access::mode::read>(CGH);
+      auto SumAcc = Sum.get_access<access::mode::discard_write>(CGH);
+      CGH.parallel_for<ReductionBufferKernel>(
+          nd_range<1>{range<1>{N}, range<1>{WGSize}},
+          ONEAPI::reduction(SumAcc, ONEAPI::plus<unsigned>()),
+          [=](nd_item<1> It, auto &Sum) {
+            Sum.combine(InAcc[It.get_global_id(0)]);
+          });
+    });
+    Queue.wait();
+  }
+  checkResult(State, Sum.get_access<access::mode::read>()[0] == N,
+              "wrong reduction result");
+  State.SetItemsProcessed(State.iterations() * N);
+}
+
+/// The sum of N integers with a reduction to device USM. The sum of every
+/// iteration is added to the one of the previous iterations.
+void BM_ReductionUSM(benchmark::State &State, BenchmarkDevice *Device) {
+  queue &Queue = Device->Queue;
+  const size_t N = State.range(0);
+  const size_t WGSize = getWorkGroupSize(Queue);
+  unsigned *In = malloc_device<unsigned>(N, Queue);
+  unsigned *Sum = malloc_device<unsigned>(1, Queue);
+  Queue.fill(In, 1u, N);
+  Queue.fill(Sum, 0u, 1);
+  Queue.wait();
+  for (auto _ : State) {
+    Queue.submit([&](handler &CGH) {
+      CGH.parallel_for<ReductionUSMKernel>(
+          nd_range<1>{range<1>{N}, range<1>{WGSize}},
+          ONEAPI::reduction(Sum, ONEAPI::plus<unsigned>()),
+          [=](nd_item<1> It, auto &Sum) {
+            Sum.combine(In[It.get_global_id(0)]);
+          });
+    });
+    Queue.wait();
+  }
+  unsigned Result = 0;
+  Queue.memcpy(&Result, Sum, sizeof(unsigned)).wait();
+  // The sums wrap around like the unsigned additions of the device
+  checkResult(State,
+              Result == static_cast<unsigned>(N * State.iterations()),
+              "wrong reduction result");
+  State.SetItemsProcessed(State.iterations() * N);
+  free(In, Queue);
+  free(Sum, Queue);
+}
+
+/// The inclusive or exclusive device-wide scan of N integers.
+template <bool IsInclusive>
+void BM_Scan(benchmark::State &State, BenchmarkDevice *Device) {
+  queue &Queue = Device->Queue;
+  const size_t N = State.range(0);
+  int *In = malloc_device<int>(N, Queue);
+  int *Out = malloc_device<int>(N, Queue);
+  Queue.fill(In, 1, N).wait();
+  for (auto _ : State) {
+    if (IsInclusive)
+      ONEAPI::inclusive_scan(Queue, In, In + N, Out, ONEAPI::plus<int>())
+          .wait();
+    else
+      ONEAPI::exclusive_scan(Queue, In, In + N, Out, ONEAPI::plus<int>())
+          .wait();
+  }
+  int Last = 0;
+  Queue.memcpy(&Last, Out + N - 1, sizeof(int)).wait();
+  checkResult(State, Last == static_cast<int>(IsInclusive ? N : N - 1),
+              "wrong scan result");
+  State.SetItemsProcessed(State.iterations() * N);
+  free(In, Queue);
+  free(Out, Queue);
+}
+
+// The graph of small kernels: DAGDepth layers of DAGWidth kernels, the kernel
+// I of a layer combines the arrays I and I + 1 written by the previous layer.
+constexpr size_t DAGWidth = 8;
+constexpr size_t DAGDepth = 16;
+constexpr size_t DAGKernelSize = 1024;
+
+/// The graph of small kernels over buffers, whose dependencies are found by
+/// the scheduler.
+void BM_KernelDAGBuffer(benchmark::State &State, BenchmarkDevice *Device) {
+  queue &Queue = Device->Queue;
+  std::vector<buffer<float, 1>> Arrays;
+  for (size_t I = 0; I < 2 * DAGWidth; ++I) {
+    Arrays.emplace_back(range<1>{DAGKernelSize});
+    Queue.submit([&](handler &CGH) {
+      CGH.fill(Arrays.back().get_access<access::mode::discard_write>(CGH),
+               1.0f);
+    });
+  }
+  Queue.wait();
+  for (auto _ : State) {
+    for (size_t Layer = 0; Layer < DAGDepth; ++Layer) {
+      // The layers read and write the two halves of the arrays in turn
+      const size_t Src = Layer % 2 * DAGWidth;
+      const size_t Dst = (Layer + 1) % 2 * DAGWidth;
+      for (size_t I = 0; I < DAGWidth; ++I)
+        Queue.submit([&](handler &CGH) {
+          auto In0 = Arrays[Src + I].get_access<access::mode::read>(CGH);
+          auto In1 = Arrays[Src + (I + 1) % DAGWidth]
+                         .get_access<access::mode::read>(CGH);
+          auto Out =
+              Arrays[Dst + I].get_access<access::mode::discard_write>(CGH);
+          CGH.parallel_for<DAGBufferKernel>(
+              range<1>{DAGKernelSize},
+              [=](id<1> J) { Out[J] = 0.5f * (In0[J] + In1[J]); });
+        });
+    }
+    Queue.wait();
+  }
+  State.SetItemsProcessed(State.iterations() * DAGDepth * DAGWidth);
+}
+
+/// The same graph over device USM, with the dependencies given as events.
+void BM_KernelDAGUSM(benchmark::State &State, BenchmarkDevice *Device) {
+  queue &Queue = Device->Queue;
+  float *Arrays = malloc_device<float>(2 * DAGWidth * DAGKernelSize, Queue);
+  Queue.fill(Arrays, 1.0f, 2 * DAGWidth * DAGKernelSize).wait();
+  std::vector<event> Previous(DAGWidth), Current(DAGWidth);
+  for (auto _ : State) {
+    std::fill(Previous.begin(), Previous.end(), event());
+    for (size_t Layer = 0; Layer < DAGDepth; ++Layer) {
+      const float *Src = Arrays + Layer % 2 * DAGWidth * DAGKernelSize;
+      float *Dst = Arrays + (Layer + 1) % 2 * DAGWidth * DAGKernelSize;
+      for (size_t I = 0; I < DAGWidth; ++I) {
+        const size_t Next = (I + 1) % DAGWidth;
+        const size_t Prev = (I + DAGWidth - 1) % DAGWidth;
+        Current[I] = Queue.submit([&](handler &CGH) {
+          // The kernels I and I + 1 of the previous layer wrote the inputs,
+          // the kernels I - 1 and I read the output
+          CGH.depends_on({Previous[Prev], Previous[I], Previous[Next]});
+          const float *In0 = Src + I * DAGKernelSize;
+          const float *In1 = Src + Next * DAGKernelSize;
+          float *Out = Dst + I * DAGKernelSize;
+          CGH.parallel_for<DAGUSMKernel>(
+              range<1>{DAGKernelSize},
+              [=](id<1> J) { Out[J] = 0.5f * (In0[J] + In1[J]); });
+        });
+      }
+      std::swap(Previous, Current);
+    }
+    Queue.wait();
+  }
+  State.SetItemsProcessed(State.iterations() * DAGDepth * DAGWidth);
+  free(Arrays, Queue);
+}
+
+constexpr size_t PipelineChunks = 32;
+constexpr size_t PipelineSlots = 4;
+
+/// A pipeline of three stages on three queues of the device: a kernel
+/// produces a chunk, a host task updates it and a kernel consumes it. Up to
+/// PipelineSlots chunks are in flight, the stages only wait for each other
+/// through the buffers.
+void BM_HostTaskPipeline(benchmark::State &State, BenchmarkDevice *Device) {
+  const device Dev = Device->Queue.get_device();
+  const context Context = Device->Queue.get_context();
+  queue Producer(Context, Dev), Host(Context, Dev), Consumer(Context, Dev);
+  const size_t ChunkSize = State.range(0);
+  std::vector<buffer<float, 1>> Chunks, Results;
+  for (size_t I = 0; I < PipelineSlots; ++I) {
+    Chunks.emplace_back(range<1>{ChunkSize});
+    Results.emplace_back(range<1>{ChunkSize});
+  }
+  for (auto _ : State) {
+    for (size_t I = 0; I < PipelineChunks; ++I) {
+      buffer<float, 1> &Chunk = Chunks[I % PipelineSlots];
+      buffer<float, 1> &Result = Results[I % PipelineSlots];
+      const float First = static_cast<float>(I);
+      Producer.submit([&](handler &CGH) {
+        auto Out = Chunk.get_access<access::mode::discard_write>(CGH);
+        CGH.parallel_for<PipelineProduceKernel>(
+            range<1>{ChunkSize}, [=](id<1> J) { Out[J] = First + J[0]; });
+      });
+      Host.submit([&](handler &CGH) {
+        auto Acc = Chunk.get_access<access::mode::read_write,
+                                    access::target::host_buffer>(CGH);
+        CGH.codeplay_host_task([=]() {
+          for (size_t J = 0; J < ChunkSize; ++J)
+            Acc[J] = 2.0f * Acc[J] + 1.0f;
+        });
+      });
+      Consumer.submit([&](handler &CGH) {
+        auto In = Chunk.get_access<access::mode::read>(CGH);
+        auto Out = Result.get_access<access::mode::discard_write>(CGH);
+        CGH.parallel_for<PipelineConsumeKernel>(
+            range<1>{ChunkSize}, [=](id<1> J) { Out[J] = 0.5f * In[J]; });
+      });
+    }
+    Producer.wait();
+    Host.wait();
+    Consumer.wait();
+  }
+  const size_t LastChunk = PipelineChunks - 1;
+  const float Expected = LastChunk + 0.5f;
+  checkResult(State,
+              Results[LastChunk % PipelineSlots]
+                      .get_access<access::mode::read>()[0] == Expected,
+              "wrong pipeline result");
+  State.SetItemsProcessed(State.iterations() * PipelineChunks);
+  State.SetBytesProcessed(State.iterations() * PipelineChunks * ChunkSize *
+                          sizeof(float));
+}
+
+void submitColdStartKernel(queue &Queue, float *Out) {
+  Queue.submit([&](handler &CGH) {
+    CGH.parallel_for<ColdStartKernel>(range<1>{1024}, [=](id<1> I) {
+      float X = static_cast<float>(I[0]);
+      for (int K = 0; K < 16; ++K)
+        X = cl::sycl::sin(X) * X + 1.0f;
+      Out[I] = X;
+    });
+  });
+}
+
+/// The build of the program of a kernel for a new context, which misses the
+/// in-memory program cache. With SYCL_CACHE_PERSISTENT=1 the device code is
+/// loaded from the persistent cache instead.
+void BM_ColdProgramBuild(benchmark::State &State, BenchmarkDevice *Device) {
+  const device Dev = Device->Queue.get_device();
+  for (auto _ : State) {
+    State.PauseTiming();
+    {
+      context Context(Dev);
+      State.ResumeTiming();
+      program Program(Context);
+      Program.build_with_kernel_type<ColdStartKernel>();
+      State.PauseTiming();
+    }
+    State.ResumeTiming();
+  }
+}
+
+/// The time to the completion of the first kernel of a new context and
+/// queue, which includes the build of the program and the allocations.
+void BM_ColdFirstSubmit(benchmark::State &State, BenchmarkDevice *Device) {
+  const device Dev = Device->Queue.get_device();
+  for (auto _ : State) {
+    queue Queue(context(Dev), Dev);
+    float *Out = malloc_device<float>(1024, Queue);
+    submitColdStartKernel(Queue, Out);
+    Queue.wait();
+    free(Out, Queue);
+  }
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+
+  Devices = getBenchmarkDevices();
+  if (Devices.empty()) {
+    std::cerr << "No SYCL devices to benchmark\n";
+    return 1;
+  }
+
+  constexpr int64_t StreamSize = int64_t(1) << 24;
+  constexpr int64_t CopyBytes = int64_t(1) << 26;
+  for (const std::unique_ptr<BenchmarkDevice> &Device : Devices) {
+    BenchmarkDevice *Dev = Device.get();
+    registerBenchmark("BM_StreamCopyBuffer", BM_StreamBuffer<false>, Dev)
+        ->Arg(StreamSize);
+    registerBenchmark("BM_StreamTriadBuffer", BM_StreamBuffer<true>, Dev)
+        ->Arg(StreamSize);
+    registerBenchmark("BM_StreamCopyUSM", BM_StreamUSM<false>, Dev)
+        ->Arg(StreamSize);
+    registerBenchmark("BM_StreamTriadUSM", BM_StreamUSM<true>, Dev)
+        ->Arg(StreamSize);
+    registerBenchmark("BM_MemcpyPageableToDevice", BM_Memcpy, Dev,
+                      MemoryKind::Pageable, MemoryKind::Device)
+        ->Arg(CopyBytes);
+    registerBenchmark("BM_MemcpyHostToDevice", BM_Memcpy, Dev,
+                      MemoryKind::Host, MemoryKind::Device)
+        ->Arg(CopyBytes);
+    registerBenchmark("BM_MemcpyDeviceToHost", BM_Memcpy, Dev,
+                      MemoryKind::Device, MemoryKind::Host)
+        ->Arg(CopyBytes);
+    registerBenchmark("BM_MemcpyDeviceToDevice", BM_Memcpy, Dev,
+                      MemoryKind::Device, MemoryKind::Device)
+        ->Arg(CopyBytes);
+    registerBenchmark("BM_Gemm", BM_Gemm, Dev)->Arg(512)->Arg(1024);
+    registerBenchmark("BM_ReductionBuffer", BM_ReductionBuffer, Dev)
+        ->Arg(StreamSize);
+    registerBenchmark("BM_ReductionUSM", BM_ReductionUSM, Dev)
+        ->Arg(StreamSize);
+    registerBenchmark("BM_InclusiveScan", BM_Scan<true>, Dev)
+        ->Arg(StreamSize);
+    registerBenchmark("BM_ExclusiveScan", BM_Scan<false>, Dev)
+        ->Arg(StreamSize);
+    registerBenchmark("BM_KernelDAGBuffer", BM_KernelDAGBuffer, Dev);
+    registerBenchmark("BM_KernelDAGUSM", BM_KernelDAGUSM, Dev);
+    registerBenchmark("BM_HostTaskPipeline", BM_HostTaskPipeline, Dev)
+        ->Arg(1 << 16);
+    registerBenchmark("BM_ColdProgramBuild", BM_ColdProgramBuild, Dev)
+        ->Unit(benchmark::kMillisecond);
+    registerBenchmark("BM_ColdFirstSubmit", BM_ColdFirstSubmit, Dev)
+        ->Unit(benchmark::kMillisecond);
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+  // The queues are released while the runtime is still up
+  Devices.clear();
+  return 0;
+}
@@ -0,0 +1,73 @@
+//==------- benchmark_devices.hpp --- Devices of the SYCL benchmarks -------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// The benchmarks are registered once per device of the non-host platforms, so
+// that one binary covers the OpenCL, Level Zero and CUDA plugins. The name of
+// a benchmark is followed by the backend and the index of the device in its
+// platform, e.g. BM_EmptyKernelSubmit/level_zero:0, which keeps the names of
+// the results stable from one run to the next.
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl.hpp>
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sycl_benchmarks {
+
+/// A device to benchmark, with a queue kept for the whole run so that the
+/// programs built by the first iterations stay in the cache of its context.
+struct BenchmarkDevice {
+  BenchmarkDevice(const cl::sycl::device &Dev, std::string Name)
+      : Queue(Dev), Name(std::move(Name)) {}
+
+  cl::sycl::queue Queue;
+  /// The backend and the index of the device, e.g. opencl:1.
+  std::string Name;
+};
+
+/// \return the devices of the non-host platforms, the ones accepted by
+/// SYCL_DEVICE_FILTER if it is set.
+inline std::vector<std::unique_ptr<BenchmarkDevice>> getBenchmarkDevices() {
+  std::vector<std::unique_ptr<BenchmarkDevice>> Devices;
+  for (const cl::sycl::platform &Platform :
+       cl::sycl::platform::get_platforms()) {
+    if (Platform.is_host())
+      continue;
+    int Index = 0;
+    for (const cl::sycl::device &Dev : Platform.get_devices()) {
+      std::stringstream Name;
+      Name << Platform.get_backend() << ":" << Index++;
+      Devices.push_back(std::make_unique<BenchmarkDevice>(Dev, Name.str()));
+    }
+  }
+  return Devices;
+}
+
+/// Registers \p Fn, called with \p Device and \p Args, as Name/<device name>.
+/// The benchmarks are timed in real time since the work is done by the
+/// devices and the threads of the runtime.
+template <typename FnT, typename... ArgsT>
+benchmark::internal::Benchmark *registerBenchmark(const char *Name, FnT Fn,
+                                                  BenchmarkDevice *Device,
+                                                  ArgsT... Args) {
+  std::string FullName = std::string(Name) + "/" + Device->Name;
+  auto *Benchmark =
+      benchmark::RegisterBenchmark(FullName.c_str(), Fn, Device, Args...);
+  Benchmark->UseRealTime();
+  return Benchmark;
+}
+
+} // namespace sycl_benchmarks
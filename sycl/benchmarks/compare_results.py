@@ -0,0 +1,100 @@
+#!/usr/bin/env python
+#
+# Compare the results of the SYCL benchmarks against the results of a
+# baseline run, both written by --benchmark_out=<file>
+# --benchmark_out_format=json. Return an error if a benchmark failed or is
+# slower than the baseline by more than the threshold.
+#
+import argparse
+import json
+import re
+import sys
+
+TIME_UNITS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+AGGREGATES = ("_mean", "_median", "_stddev")
+
+
+def load_results(path):
+  """Return the real times in ns of the benchmarks of the results in path,
+  and the names of the benchmarks which failed. The medians are used for the
+  runs with repetitions."""
+  with open(path) as results_file:
+    results = json.load(results_file)
+  runs = {}
+  medians = {}
+  failed = set()
+  for run in results.get("benchmarks", []):
+    name = run["name"]
+    if run.get("error_occurred"):
+      failed.add(name)
+      continue
+    time = run["real_time"] * TIME_UNITS[run.get("time_unit", "ns")]
+    if name.endswith("_median"):
+      medians[name[:-len("_median")]] = time
+    elif not name.endswith(AGGREGATES):
+      runs.setdefault(name, []).append(time)
+  times = {name: sorted(t)[len(t) // 2] for name, t in runs.items()}
+  times.update(medians)
+  return times, failed
+
+
+def format_time(time):
+  for unit in ("s", "ms", "us"):
+    if time >= TIME_UNITS[unit]:
+      return "%.3f %s" % (time / TIME_UNITS[unit], unit)
+  return "%.1f ns" % time
+
+
+def main():
+  parser = argparse.ArgumentParser(
+      description="Compare SYCL benchmark results against a baseline.")
+  parser.add_argument("baseline", help="JSON results of the baseline run")
+  parser.add_argument("results", help="JSON results to check")
+  parser.add_argument("--threshold", type=float, default=0.05,
+                      help="relative slowdown reported as a regression "
+                      "(default: 0.05)")
+  parser.add_argument("--filter", default="",
+                      help="only compare the benchmarks matching the regex")
+  args = parser.parse_args()
+
+  baseline, baseline_failed = load_results(args.baseline)
+  results, failed = load_results(args.results)
+  name_filter = re.compile(args.filter)
+
+  regressions = []
+  errors = sorted(name for name in failed if name_filter.search(name))
+  names = sorted(name for name in set(baseline) | set(results)
+                 if name_filter.search(name))
+  width = max([len(name) for name in names] + [len("benchmark")])
+  print("%-*s %14s %14s %9s" % (width, "benchmark", "baseline", "new",
+                                "change"))
+  for name in names:
+    if name not in results:
+      if name not in failed:
+        print("%-*s %14s %14s" % (width, name,
+                                  format_time(baseline[name]), "missing"))
+      continue
+    if name not in baseline:
+      state = "failed" if name in baseline_failed else "new"
+      print("%-*s %14s %14s" % (width, name, state,
+                                format_time(results[name])))
+      continue
+    change = results[name] / baseline[name] - 1.0
+    marker = ""
+    if change > args.threshold:
+      regressions.append(name)
+      marker = "  <- regression"
+    print("%-*s %14s %14s %+8.1f%%%s" %
+          (width, name, format_time(baseline[name]),
+           format_time(results[name]), change * 100.0, marker))
+
+  for name in errors:
+    print("error: %s failed" % name)
+  if regressions:
+    print("%d benchmark(s) slower than the baseline by more than %.1f%%" %
+          (len(regressions), args.threshold * 100.0))
+  return 1 if regressions or errors else 0
+
+
+if __name__ == "__main__":
+  sys.exit(main())
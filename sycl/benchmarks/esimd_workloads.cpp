@@ -0,0 +1,123 @@
+//==------- esimd_workloads.cpp --- SYCL ESIMD workload benchmarks ---------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// The ESIMD counterparts of the workloads of application_workloads.cpp. ESIMD
+// kernels only run on Intel GPUs, so this binary is built for SPIR-V only and
+// registers its benchmarks for the Intel GPUs of the OpenCL and Level Zero
+// platforms.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark_devices.hpp"
+
+#include <CL/sycl/INTEL/esimd.hpp>
+
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+using namespace cl::sycl;
+using namespace sycl_benchmarks;
+
+class GemmESIMDKernel;
+
+namespace {
+std::vector<std::unique_ptr<BenchmarkDevice>> Devices;
+
+// Every thread computes GemmRows x GemmCols elements of C, reading the rows
+// of A by blocks of GemmDepth elements.
+constexpr int GemmRows = 8;
+constexpr int GemmCols = 16;
+constexpr int GemmDepth = 8;
+
+/// C = A * B for square matrices of floats, with the tiles of C kept in the
+/// registers of the threads.
+void BM_GemmESIMD(benchmark::State &State, BenchmarkDevice *Device) {
+  queue &Queue = Device->Queue;
+  const size_t N = State.range(0);
+  float *A = malloc_device<float>(N * N, Queue);
+  float *B = malloc_device<float>(N * N, Queue);
+  float *C = malloc_device<float>(N * N, Queue);
+  Queue.fill(A, 1.0f, N * N);
+  Queue.fill(B, 2.0f, N * N);
+  Queue.wait();
+  const range<2> Threads{N / GemmRows, N / GemmCols};
+  for (auto _ : State) {
+    Queue.submit([&](handler &CGH) {
+      CGH.parallel_for<GemmESIMDKernel>(
+          nd_range<2>{Threads, range<2>{1, 1}},
+          [=](nd_item<2> It) SYCL_ESIMD_KERNEL {
+            using namespace sycl::INTEL::gpu;
+            const size_t Row = It.get_global_id(0) * GemmRows;
+            const size_t Col = It.get_global_id(1) * GemmCols;
+            simd<float, GemmRows * GemmCols> Acc(0.0f);
+            for (size_t K0 = 0; K0 < N; K0 += GemmDepth) {
+              simd<float, GemmRows * GemmDepth> ABlock;
+              for (int R = 0; R < GemmRows; ++R)
+                ABlock.select<GemmDepth, 1>(R * GemmDepth) =
+                    block_load<float, GemmDepth>(A + (Row + R) * N + K0);
+              for (int K = 0; K < GemmDepth; ++K) {
+                simd<float, GemmCols> BRow =
+                    block_load<float, GemmCols>(B + (K0 + K) * N + Col);
+                for (int R = 0; R < GemmRows; ++R) {
+                  simd<float, GemmCols> Product = BRow;
+                  Product *= ABlock[R * GemmDepth + K];
+                  Acc.select<GemmCols, 1>(R * GemmCols) += Product;
+                }
+              }
+            }
+            for (int R = 0; R < GemmRows; ++R)
+              block_store<float, GemmCols>(
+                  C + (Row + R) * N + Col,
+                  Acc.select<GemmCols, 1>(R * GemmCols).read());
+          });
+    });
+    Queue.wait();
+  }
+  float Last = 0.0f;
+  Queue.memcpy(&Last, C + N * N - 1, sizeof(float)).wait();
+  if (Last != 2.0f * N)
+    State.SkipWithError("wrong GEMM result");
+  State.counters["FLOP/s"] = benchmark::Counter(
+      2.0 * N * N * N * State.iterations(), benchmark::Counter::kIsRate);
+  free(A, Queue);
+  free(B, Queue);
+  free(C, Queue);
+}
+
+bool isIntelGPU(const device &Dev) {
+  constexpr unsigned IntelVendorId = 0x8086;
+  return Dev.is_gpu() &&
+         Dev.get_info<info::device::vendor_id>() == IntelVendorId;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+
+  for (std::unique_ptr<BenchmarkDevice> &Device : getBenchmarkDevices())
+    if (isIntelGPU(Device->Queue.get_device()))
+      Devices.push_back(std::move(Device));
+  if (Devices.empty()) {
+    std::cerr << "No Intel GPUs to benchmark\n";
+    return 1;
+  }
+
+  for (const std::unique_ptr<BenchmarkDevice> &Device : Devices)
+    registerBenchmark("BM_GemmESIMD", BM_GemmESIMD, Device.get())
+        ->Arg(512)
+        ->Arg(1024);
+
+  benchmark::RunSpecifiedBenchmarks();
+  // The queues are released while the runtime is still up
+  Devices.clear();
+  return 0;
+}
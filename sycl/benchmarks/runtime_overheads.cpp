@@ -0,0 +1,197 @@
+//==------ runtime_overheads.cpp --- SYCL runtime overhead benchmarks ------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Measures the host side costs of the SYCL runtime: the kernels do no work, so
+// the results are the time spent in the runtime and in the plugins. Each
+// benchmark is registered once per device, see benchmark_devices.hpp.
+// SYCL_DEVICE_FILTER restricts the devices.
+//
+//   sycl-runtime-benchmarks --benchmark_filter=opencl
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark_devices.hpp"
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace cl::sycl;
+using namespace sycl_benchmarks;
+
+namespace {
+class EmptyKernel;
+class BufferKernel;
+class USMKernel;
+
+// Submissions without waits would fill the device queues without bound.
+constexpr int64_t SubmitsPerWait = 4096;
+
+std::vector<std::unique_ptr<BenchmarkDevice>> Devices;
+
+void submitEmptyKernel(queue &Queue) {
+  Queue.submit([&](handler &CGH) { CGH.single_task<EmptyKernel>([]() {}); });
+}
+
+/// The latency of the submission of an empty kernel; the runtime and the
+/// plugin are warmed up, so the program and kernel caches are hit.
+void BM_EmptyKernelSubmit(benchmark::State &State, BenchmarkDevice *Device) {
+  queue &Queue = Device->Queue;
+  submitEmptyKernel(Queue);
+  Queue.wait();
+  int64_t Submits = 0;
+  for (auto _ : State) {
+    submitEmptyKernel(Queue);
+    if (++Submits % SubmitsPerWait == 0) {
+      State.PauseTiming();
+      Queue.wait();
+      State.ResumeTiming();
+    }
+  }
+  Queue.wait();
+  State.SetItemsProcessed(State.iterations());
+}
+
+/// The submission throughput when several threads submit to the same queue.
+void BM_SubmitThroughput(benchmark::State &State, BenchmarkDevice *Device) {
+  queue &Queue = Device->Queue;
+  if (State.thread_index == 0) {
+    submitEmptyKernel(Queue);
+    Queue.wait();
+  }
+  int64_t Submits = 0;
+  for (auto _ : State) {
+    submitEmptyKernel(Queue);
+    if (++Submits % SubmitsPerWait == 0)
+      Queue.wait();
+  }
+  Queue.wait();
+  State.SetItemsProcessed(State.iterations());
+}
+
+/// The round trip of an empty kernel: submission, execution and event::wait.
+void BM_SubmitAndWait(benchmark::State &State, BenchmarkDevice *Device) {
+  queue &Queue = Device->Queue;
+  for (auto _ : State) {
+    event Event = Queue.submit(
+        [&](handler &CGH) { CGH.single_task<EmptyKernel>([]() {}); });
+    Event.wait();
+  }
+}
+
+/// The cost of event::wait on an event which is already complete.
+void BM_WaitCompleteEvent(benchmark::State &State, BenchmarkDevice *Device) {
+  queue &Queue = Device->Queue;
+  event Event = Queue.submit(
+      [&](handler &CGH) { CGH.single_task<EmptyKernel>([]() {}); });
+  Event.wait();
+  for (auto _ : State)
+    Event.wait();
+}
+
+/// The submission of a kernel accessing a buffer, which goes through the
+/// dependency graph of the scheduler.
+void BM_BufferAccessorSubmit(benchmark::State &State, BenchmarkDevice *Device) {
+  queue &Queue = Device->Queue;
+  buffer<int, 1> Buffer{range<1>{1}};
+  int64_t Submits = 0;
+  for (auto _ : State) {
+    Queue.submit([&](handler &CGH) {
+      auto Acc = Buffer.get_access<access::mode::write>(CGH);
+      CGH.single_task<BufferKernel>([=]() { Acc[0] = 1; });
+    });
+    if (++Submits % SubmitsPerWait == 0) {
+      State.PauseTiming();
+      Queue.wait();
+      State.ResumeTiming();
+    }
+  }
+  Queue.wait();
+  State.SetItemsProcessed(State.iterations());
+}
+
+/// The submission of the same kernel accessing USM instead, for comparison
+/// with BM_BufferAccessorSubmit.
+void BM_USMPointerSubmit(benchmark::State &State, BenchmarkDevice *Device) {
+  queue &Queue = Device->Queue;
+  int *Ptr = malloc_device<int>(1, Queue);
+  int64_t Submits = 0;
+  for (auto _ : State) {
+    Queue.submit([&](handler &CGH) {
+      CGH.single_task<USMKernel>([=]() { *Ptr = 1; });
+    });
+    if (++Submits % SubmitsPerWait == 0) {
+      State.PauseTiming();
+      Queue.wait();
+      State.ResumeTiming();
+    }
+  }
+  Queue.wait();
+  free(Ptr, Queue);
+  State.SetItemsProcessed(State.iterations());
+}
+
+/// The round trip of an empty host task: submission, dispatch to the host
+/// thread pool and event::wait.
+void BM_HostTaskDispatch(benchmark::State &State, BenchmarkDevice *Device) {
+  queue &Queue = Device->Queue;
+  for (auto _ : State) {
+    event Event = Queue.submit(
+        [&](handler &CGH) { CGH.codeplay_host_task([]() {}); });
+    Event.wait();
+  }
+}
+
+/// The lookup of a program already in the program cache of the context.
+void BM_ProgramCacheHit(benchmark::State &State, BenchmarkDevice *Device) {
+  context Context = Device->Queue.get_context();
+  {
+    program Program(Context);
+    Program.build_with_kernel_type<EmptyKernel>();
+  }
+  for (auto _ : State) {
+    program Program(Context);
+    Program.build_with_kernel_type<EmptyKernel>();
+    benchmark::DoNotOptimize(Program);
+  }
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+
+  Devices = getBenchmarkDevices();
+  if (Devices.empty()) {
+    std::cerr << "No SYCL devices to benchmark\n";
+    return 1;
+  }
+
+  for (const std::unique_ptr<BenchmarkDevice> &Device : Devices) {
+    registerBenchmark("BM_EmptyKernelSubmit", BM_EmptyKernelSubmit,
+                      Device.get());
+    registerBenchmark("BM_SubmitThroughput", BM_SubmitThroughput, Device.get())
+        ->ThreadRange(1, 16);
+    registerBenchmark("BM_SubmitAndWait", BM_SubmitAndWait, Device.get());
+    registerBenchmark("BM_WaitCompleteEvent", BM_WaitCompleteEvent,
+                      Device.get());
+    registerBenchmark("BM_BufferAccessorSubmit", BM_BufferAccessorSubmit,
+                      Device.get());
+    registerBenchmark("BM_USMPointerSubmit", BM_USMPointerSubmit,
+                      Device.get());
+    registerBenchmark("BM_HostTaskDispatch", BM_HostTaskDispatch,
+                      Device.get());
+    registerBenchmark("BM_ProgramCacheHit", BM_ProgramCacheHit, Device.get());
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+  // The queues are released while the runtime is still up
+  Devices.clear();
+  return 0;
+}
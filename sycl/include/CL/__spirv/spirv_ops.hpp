@@ -518,6 +518,32 @@ extern SYCL_EXTERNAL void
 __spirv_ocl_prefetch(const __attribute__((opencl_global)) char *Ptr,
                      size_t NumBytes) noexcept;
 
+// Joint matrix operations, see the SPV_INTEL_joint_matrix extension.
+template <typename T, std::size_t R, std::size_t C, __spv::MatrixLayout L,
+          __spv::Scope::Flag S = __spv::Scope::Flag::Subgroup>
+extern SYCL_EXTERNAL __spv::__spirv_JointMatrixINTEL<T, R, C, L, S> *
+__spirv_JointMatrixLoadINTEL(T *Ptr, std::size_t Stride,
+                             __spv::MatrixLayout Layout = L,
+                             __spv::Scope::Flag Sc = S, int MemOperand = 0);
+
+template <typename T, std::size_t R, std::size_t C, __spv::MatrixLayout L,
+          __spv::Scope::Flag S = __spv::Scope::Flag::Subgroup>
+extern SYCL_EXTERNAL void __spirv_JointMatrixStoreINTEL(
+    T *Ptr, __spv::__spirv_JointMatrixINTEL<T, R, C, L, S> *Object,
+    std::size_t Stride, __spv::MatrixLayout Layout = L,
+    __spv::Scope::Flag Sc = S, int MemOperand = 0);
+
+template <typename TA, typename TB, typename TC, std::size_t M, std::size_t K,
+          std::size_t N, __spv::MatrixLayout LA, __spv::MatrixLayout LB,
+          __spv::MatrixLayout LC,
+          __spv::Scope::Flag S = __spv::Scope::Flag::Subgroup>
+extern SYCL_EXTERNAL __spv::__spirv_JointMatrixINTEL<TC, M, N, LC, S> *
+__spirv_JointMatrixMadINTEL(
+    __spv::__spirv_JointMatrixINTEL<TA, M, K, LA, S> *A,
+    __spv::__spirv_JointMatrixINTEL<TB, K, N, LB, S> *B,
+    __spv::__spirv_JointMatrixINTEL<TC, M, N, LC, S> *C,
+    __spv::Scope::Flag Sc = S);
+
 #else // if !__SYCL_DEVICE_ONLY__
 
 template <typename dataT>
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 // TODO: include the header file with SPIR-V declarations from SPIRV-Headers
@@ -65,6 +66,19 @@ enum class GroupOperation : uint32_t {
   ExclusiveScan = 2
 };
 
+enum class MatrixLayout : uint32_t {
+  RowMajor = 0,
+  ColumnMajor = 1,
+  PackedA = 2,
+  PackedB = 3
+};
+
+// Opaque matrix jointly held by the work-items of a group, see the
+// SPV_INTEL_joint_matrix extension.
+template <typename T, std::size_t R, std::size_t C, MatrixLayout U,
+          Scope::Flag S = Scope::Flag::Subgroup>
+struct __spirv_JointMatrixINTEL;
+
 } // namespace __spv
 
 #ifdef __SYCL_DEVICE_ONLY__
@@ -9,12 +9,23 @@
 #pragma once
 
 #include <CL/sycl/ONEAPI/atomic.hpp>
+#include <CL/sycl/ONEAPI/built_programs.hpp>
+#include <CL/sycl/ONEAPI/command_graph.hpp>
+#include <CL/sycl/ONEAPI/device_algorithm.hpp>
+#include <CL/sycl/ONEAPI/distributed_usm.hpp>
 #include <CL/sycl/ONEAPI/experimental/builtins.hpp>
+#include <CL/sycl/ONEAPI/experimental/specialized_kernel.hpp>
 #include <CL/sycl/ONEAPI/filter_selector.hpp>
 #include <CL/sycl/ONEAPI/function_pointer.hpp>
+#include <CL/sycl/ONEAPI/half_conversions.hpp>
 #include <CL/sycl/ONEAPI/group_algorithm.hpp>
+#include <CL/sycl/ONEAPI/kernel_fusion.hpp>
+#include <CL/sycl/ONEAPI/kernel_stats.hpp>
+#include <CL/sycl/ONEAPI/prebuild.hpp>
 #include <CL/sycl/ONEAPI/reduction.hpp>
 #include <CL/sycl/ONEAPI/sub_group.hpp>
+#include <CL/sycl/ONEAPI/submission_batch.hpp>
+#include <CL/sycl/ONEAPI/submit_latency.hpp>
 #include <CL/sycl/accessor.hpp>
 #include <CL/sycl/aspects.hpp>
 #include <CL/sycl/atomic.hpp>
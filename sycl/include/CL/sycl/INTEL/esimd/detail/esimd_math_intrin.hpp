@@ -14,7 +14,9 @@
 #include <CL/sycl/INTEL/esimd/detail/esimd_host_util.hpp>
 #include <CL/sycl/INTEL/esimd/detail/esimd_types.hpp>
 #include <CL/sycl/INTEL/esimd/esimd_enum.hpp>
+#include <CL/sycl/half_type.hpp>
 #include <cstdint>
+#include <cstring>
 
 using sycl::INTEL::gpu::vector_type_t;
 
@@ -244,6 +246,37 @@ SYCL_EXTERNAL sycl::INTEL::gpu::vector_type_t<Ty, N>
 __esimd_dp4(sycl::INTEL::gpu::vector_type_t<Ty, N> v1,
             sycl::INTEL::gpu::vector_type_t<Ty, N> v2);
 
+namespace __esimd {
+
+// Number of bits in a DPAS operand element of the given precision.
+template <sycl::INTEL::gpu::EsimdPrecisionType P>
+constexpr int getDpasElemBits() {
+  using PT = sycl::INTEL::gpu::EsimdPrecisionType;
+  return P == PT::U1 || P == PT::S1
+             ? 1
+             : P == PT::U2 || P == PT::S2
+                   ? 2
+                   : P == PT::U4 || P == PT::S4
+                         ? 4
+                         : P == PT::U8 || P == PT::S8 ? 8 : 16;
+}
+
+} // namespace __esimd
+
+// Dot product accumulate systolic: multiplies the RepeatCount x K matrix in
+// src2 by the K x ExecSize matrix in src1, adds the RepeatCount x ExecSize
+// accumulator in src0 and returns the result. K is SystolicDepth times the
+// number of operations per channel. ResSign and AccSign tell whether the
+// result and the accumulator are signed.
+template <sycl::INTEL::gpu::EsimdPrecisionType Src1Precision,
+          sycl::INTEL::gpu::EsimdPrecisionType Src2Precision,
+          int SystolicDepth, int RepeatCount, int ResSign, int AccSign,
+          typename T, typename T0, typename T1, typename T2, int N, int N1,
+          int N2>
+SYCL_EXTERNAL vector_type_t<T, N> __esimd_dpas(vector_type_t<T0, N> src0,
+                                               vector_type_t<T1, N1> src1,
+                                               vector_type_t<T2, N2> src2);
+
 #ifndef __SYCL_DEVICE_ONLY__
 
 template <typename T>
@@ -1095,6 +1128,89 @@ SYCL_EXTERNAL vector_type_t<T1, N> __esimd_dp4a(vector_type_t<T2, N> src0,
   return retv;
 };
 
+namespace __esimd {
+
+// Returns the Idx'th element of precision P in the operand packed in Bytes.
+template <sycl::INTEL::gpu::EsimdPrecisionType P>
+double readDpasElem(const unsigned char *Bytes, int Idx) {
+  using PT = sycl::INTEL::gpu::EsimdPrecisionType;
+  constexpr int Bits = getDpasElemBits<P>();
+  const int Off = Idx * Bits;
+  uint32_t Raw = Bytes[Off / 8];
+  if (Bits > 8)
+    Raw |= static_cast<uint32_t>(Bytes[Off / 8 + 1]) << 8;
+  Raw = (Raw >> (Off % 8)) & ((1u << Bits) - 1);
+
+  if constexpr (P == PT::BF16) {
+    uint32_t FloatBits = Raw << 16;
+    float Res;
+    std::memcpy(&Res, &FloatBits, sizeof(Res));
+    return Res;
+  } else if constexpr (P == PT::FP16) {
+    uint16_t HalfBits = static_cast<uint16_t>(Raw);
+    cl::sycl::half Res;
+    std::memcpy(&Res, &HalfBits, sizeof(Res));
+    return static_cast<float>(Res);
+  } else if constexpr (P == PT::S1 || P == PT::S2 || P == PT::S4 ||
+                       P == PT::S8) {
+    return (Raw >> (Bits - 1)) ? static_cast<double>(Raw) - (1 << Bits)
+                               : static_cast<double>(Raw);
+  } else {
+    return Raw;
+  }
+}
+
+} // namespace __esimd
+
+template <sycl::INTEL::gpu::EsimdPrecisionType Src1Precision,
+          sycl::INTEL::gpu::EsimdPrecisionType Src2Precision,
+          int SystolicDepth, int RepeatCount, int ResSign, int AccSign,
+          typename T, typename T0, typename T1, typename T2, int N, int N1,
+          int N2>
+SYCL_EXTERNAL vector_type_t<T, N> __esimd_dpas(vector_type_t<T0, N> src0,
+                                               vector_type_t<T1, N1> src1,
+                                               vector_type_t<T2, N2> src2) {
+  constexpr int Src1Bits = __esimd::getDpasElemBits<Src1Precision>();
+  constexpr int Src2Bits = __esimd::getDpasElemBits<Src2Precision>();
+  constexpr int MaxBits = Src1Bits > Src2Bits ? Src1Bits : Src2Bits;
+  constexpr int OpsPerChannel = 32 / MaxBits < 8 ? 32 / MaxBits : 8;
+  constexpr int ExecSize = N / RepeatCount;
+
+  unsigned char Src1Bytes[N1 * sizeof(T1)];
+  unsigned char Src2Bytes[N2 * sizeof(T2)];
+  for (int I = 0; I < N1; I++) {
+    T1 Elem = src1[I];
+    std::memcpy(Src1Bytes + I * sizeof(T1), &Elem, sizeof(T1));
+  }
+  for (int I = 0; I < N2; I++) {
+    T2 Elem = src2[I];
+    std::memcpy(Src2Bytes + I * sizeof(T2), &Elem, sizeof(T2));
+  }
+
+  vector_type_t<T, N> retv;
+  for (int R = 0; R < RepeatCount; R++) {
+    for (int C = 0; C < ExecSize; C++) {
+      double Sum = 0;
+      for (int D = 0; D < SystolicDepth; D++) {
+        for (int K = 0; K < OpsPerChannel; K++) {
+          double A = __esimd::readDpasElem<Src2Precision>(
+              Src2Bytes, (R * SystolicDepth + D) * OpsPerChannel + K);
+          double B = __esimd::readDpasElem<Src1Precision>(
+              Src1Bytes, (D * ExecSize + C) * OpsPerChannel + K);
+          Sum += A * B;
+        }
+      }
+      const int I = R * ExecSize + C;
+      if constexpr (std::is_floating_point<T>::value)
+        retv[I] = static_cast<T>(static_cast<float>(src0[I]) + Sum);
+      else
+        retv[I] = static_cast<T>(static_cast<int64_t>(src0[I]) +
+                                 static_cast<int64_t>(Sum));
+    }
+  }
+  return retv;
+}
+
 template <typename Ty, int N>
 SYCL_EXTERNAL sycl::INTEL::gpu::vector_type_t<Ty, N>
 __esimd_reduced_max(sycl::INTEL::gpu::vector_type_t<Ty, N> src1,
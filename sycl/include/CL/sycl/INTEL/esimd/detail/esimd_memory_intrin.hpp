@@ -53,13 +53,33 @@ SYCL_EXTERNAL void
 __esimd_flat_block_write(uint64_t addr,
                          sycl::INTEL::gpu::vector_type_t<Ty, N> vals);
 
+// flat_prefetch hints that data at flat addresses is about to be gathered
+template <typename Ty, int N, int NumBlk = 0,
+          sycl::INTEL::gpu::CacheHint L1H = sycl::INTEL::gpu::CacheHint::None,
+          sycl::INTEL::gpu::CacheHint L3H = sycl::INTEL::gpu::CacheHint::None>
+SYCL_EXTERNAL void
+__esimd_flat_prefetch(sycl::INTEL::gpu::vector_type_t<uint64_t, N> addrs,
+                      int ElemsPerAddr = NumBlk,
+                      sycl::INTEL::gpu::vector_type_t<uint16_t, N> pred = 1);
+
+// flat_block_prefetch hints that a block of data at one flat address is about
+// to be read
+template <typename Ty, int N,
+          sycl::INTEL::gpu::CacheHint L1H = sycl::INTEL::gpu::CacheHint::None,
+          sycl::INTEL::gpu::CacheHint L3H = sycl::INTEL::gpu::CacheHint::None>
+SYCL_EXTERNAL void __esimd_flat_block_prefetch(uint64_t addr);
+
 // Reads a block of data from given surface at given offset.
-template <typename Ty, int N, typename SurfIndAliasTy>
+template <typename Ty, int N, typename SurfIndAliasTy,
+          sycl::INTEL::gpu::CacheHint L1H = sycl::INTEL::gpu::CacheHint::None,
+          sycl::INTEL::gpu::CacheHint L3H = sycl::INTEL::gpu::CacheHint::None>
 SYCL_EXTERNAL sycl::INTEL::gpu::vector_type_t<Ty, N>
 __esimd_block_read(SurfIndAliasTy surf_ind, uint32_t offset);
 
 // Writes given block of data to a surface with given index at given offset.
-template <typename Ty, int N, typename SurfIndAliasTy>
+template <typename Ty, int N, typename SurfIndAliasTy,
+          sycl::INTEL::gpu::CacheHint L1H = sycl::INTEL::gpu::CacheHint::None,
+          sycl::INTEL::gpu::CacheHint L3H = sycl::INTEL::gpu::CacheHint::None>
 SYCL_EXTERNAL void
 __esimd_block_write(SurfIndAliasTy surf_ind, uint32_t offset,
                     sycl::INTEL::gpu::vector_type_t<Ty, N> vals);
@@ -637,6 +657,19 @@ __esimd_flat_block_write(uint64_t addr,
   }
 }
 
+// Prefetches are only hints to the memory subsystem, there is nothing to do
+// on host.
+template <typename Ty, int N, int NumBlk, sycl::INTEL::gpu::CacheHint L1H,
+          sycl::INTEL::gpu::CacheHint L3H>
+SYCL_EXTERNAL void
+__esimd_flat_prefetch(sycl::INTEL::gpu::vector_type_t<uint64_t, N> addrs,
+                      int ElemsPerAddr,
+                      sycl::INTEL::gpu::vector_type_t<uint16_t, N> pred) {}
+
+template <typename Ty, int N, sycl::INTEL::gpu::CacheHint L1H,
+          sycl::INTEL::gpu::CacheHint L3H>
+SYCL_EXTERNAL void __esimd_flat_block_prefetch(uint64_t addr) {}
+
 template <typename Ty, int M, int N, typename TACC>
 SYCL_EXTERNAL sycl::INTEL::gpu::vector_type_t<Ty, M * N>
 __esimd_media_block_load(unsigned modififer, TACC handle, unsigned plane,
@@ -876,14 +909,16 @@ __esimd_flat_atomic2(sycl::INTEL::gpu::vector_type_t<uint64_t, N> addrs,
   return retv;
 }
 
-template <typename Ty, int N, typename SurfIndAliasTy>
+template <typename Ty, int N, typename SurfIndAliasTy,
+          sycl::INTEL::gpu::CacheHint L1H, sycl::INTEL::gpu::CacheHint L3H>
 SYCL_EXTERNAL sycl::INTEL::gpu::vector_type_t<Ty, N>
 __esimd_block_read(SurfIndAliasTy surf_ind, uint32_t offset) {
   throw cl::sycl::feature_not_supported();
   return sycl::INTEL::gpu::vector_type_t<Ty, N>();
 }
 
-template <typename Ty, int N, typename SurfIndAliasTy>
+template <typename Ty, int N, typename SurfIndAliasTy,
+          sycl::INTEL::gpu::CacheHint L1H, sycl::INTEL::gpu::CacheHint L3H>
 SYCL_EXTERNAL void
 __esimd_block_write(SurfIndAliasTy surf_ind, uint32_t offset,
                     sycl::INTEL::gpu::vector_type_t<Ty, N> vals) {
@@ -104,6 +104,21 @@ enum class CacheHint : uint8_t {
   ReadInvalidate = 5
 };
 
+// Element types of the src1 and src2 operands of the DPAS (dot product
+// accumulate systolic) operation.
+enum class EsimdPrecisionType {
+  U1 = 0,
+  S1 = 1,
+  U2 = 2,
+  S2 = 3,
+  U4 = 4,
+  S4 = 5,
+  U8 = 6,
+  S8 = 7,
+  BF16 = 8,
+  FP16 = 9
+};
+
 } // namespace gpu
 
 } // namespace INTEL
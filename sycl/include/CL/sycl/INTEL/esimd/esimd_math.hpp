@@ -1330,6 +1330,62 @@ esimd_dp4a(simd<T2, N> src0, simd<T3, N> src1, simd<T4, N> src2,
   return esimd_sat<T1>(Result);
 }
 
+/// DPAS - dot product accumulate systolic, executed by the matrix engine.
+///
+/// Computes \c src0 + \c src2 x \c src1, where \c src2 is a
+/// repeat_count x K matrix, \c src1 is a K x ExecSize matrix and \c src0 and
+/// the result are repeat_count x ExecSize matrices, all stored row by row.
+/// ExecSize is N / repeat_count and K is systolic_depth times the number of
+/// operations per channel, i.e. the number of source elements in 32 bits (at
+/// most 8). Rows of \c src2 hold their K elements packed back to back. \c src1
+/// is packed in "VNNI" order: each 32-bit group of a row holds the elements
+/// of OpsPerChannel consecutive rows in one column.
+///
+/// \tparam src1_precision is the element type of \c src1.
+/// \tparam src2_precision is the element type of \c src2.
+/// \tparam systolic_depth is the systolic depth, must be 8.
+/// \tparam repeat_count is the number of result rows, in range [1, 8].
+/// \tparam T is the result element type.
+///
+/// \ingroup sycl_esimd
+template <EsimdPrecisionType src1_precision,
+          EsimdPrecisionType src2_precision, int systolic_depth,
+          int repeat_count, typename T, typename T0, typename T1, typename T2,
+          int N, int N1, int N2>
+ESIMD_NODEBUG ESIMD_INLINE simd<T, N>
+esimd_dpas(simd<T0, N> src0, simd<T1, N1> src1, simd<T2, N2> src2,
+           int flag = GENX_NOSAT) {
+  constexpr int Src1Bits = __esimd::getDpasElemBits<src1_precision>();
+  constexpr int Src2Bits = __esimd::getDpasElemBits<src2_precision>();
+  constexpr int MaxBits = Src1Bits > Src2Bits ? Src1Bits : Src2Bits;
+  constexpr int OpsPerChannel = 32 / MaxBits < 8 ? 32 / MaxBits : 8;
+  constexpr int ExecSize = N / repeat_count;
+  static_assert(systolic_depth == 8, "systolic depth must be 8");
+  static_assert(repeat_count >= 1 && repeat_count <= 8,
+                "repeat count must be in range [1, 8]");
+  static_assert(N % repeat_count == 0 && (ExecSize == 8 || ExecSize == 16),
+                "execution size must be 8 or 16");
+  static_assert(N1 * sizeof(T1) * 8 ==
+                    systolic_depth * ExecSize * OpsPerChannel * Src1Bits,
+                "src1 must hold a K x ExecSize matrix");
+  static_assert(N2 * sizeof(T2) * 8 ==
+                    repeat_count * systolic_depth * OpsPerChannel * Src2Bits,
+                "src2 must hold a repeat_count x K matrix");
+  static_assert(std::is_floating_point<T>::value == (Src1Bits == 16) &&
+                    std::is_floating_point<T>::value == (Src2Bits == 16),
+                "floating point result requires BF16 or FP16 sources and "
+                "vice versa");
+
+  simd<T, N> Result =
+      __esimd_dpas<src1_precision, src2_precision, systolic_depth,
+                   repeat_count, std::is_signed<T>::value,
+                   std::is_signed<T0>::value, T, T0, T1, T2, N, N1, N2>(
+          src0.data(), src1.data(), src2.data());
+  if (flag != GENX_SAT)
+    return Result;
+  return esimd_sat<T>(Result);
+}
+
 static auto constexpr ESIMD_CONST_E = 2.71828f;
 static auto constexpr ESIMD_CONST_PI = 3.14159f;
 static auto constexpr ESIMD_CONST_2PI = 6.28318f;
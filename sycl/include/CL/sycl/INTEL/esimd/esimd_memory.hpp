@@ -188,7 +188,8 @@ ESIMD_INLINE ESIMD_NODEBUG simd<T, n> block_load(const T *const addr) {
 
 /// Accessor-based block-load.
 /// \ingroup sycl_esimd
-template <typename T, int n, typename AccessorTy>
+template <typename T, int n, typename AccessorTy,
+          CacheHint L1H = CacheHint::None, CacheHint L3H = CacheHint::None>
 ESIMD_INLINE ESIMD_NODEBUG simd<T, n> block_load(AccessorTy acc,
                                                  uint32_t offset) {
   constexpr unsigned Sz = sizeof(T) * n;
@@ -202,9 +203,10 @@ ESIMD_INLINE ESIMD_NODEBUG simd<T, n> block_load(AccessorTy acc,
 
 #if defined(__SYCL_DEVICE_ONLY__)
   auto surf_ind = AccessorPrivateProxy::getNativeImageObj(acc);
-  return __esimd_block_read<T, n>(surf_ind, offset);
+  return __esimd_block_read<T, n, decltype(surf_ind), L1H, L3H>(surf_ind,
+                                                                offset);
 #else
-  return __esimd_block_read<T, n>(acc, offset);
+  return __esimd_block_read<T, n, AccessorTy, L1H, L3H>(acc, offset);
 #endif // __SYCL_DEVICE_ONLY__
 }
 
@@ -228,7 +230,8 @@ ESIMD_INLINE ESIMD_NODEBUG void block_store(T *p, simd<T, n> vals) {
 
 /// Accessor-based block-store.
 /// \ingroup sycl_esimd
-template <typename T, int n, typename AccessorTy>
+template <typename T, int n, typename AccessorTy,
+          CacheHint L1H = CacheHint::None, CacheHint L3H = CacheHint::None>
 ESIMD_INLINE ESIMD_NODEBUG void block_store(AccessorTy acc, uint32_t offset,
                                             simd<T, n> vals) {
   constexpr unsigned Sz = sizeof(T) * n;
@@ -242,12 +245,55 @@ ESIMD_INLINE ESIMD_NODEBUG void block_store(AccessorTy acc, uint32_t offset,
 
 #if defined(__SYCL_DEVICE_ONLY__)
   auto surf_ind = AccessorPrivateProxy::getNativeImageObj(acc);
-  __esimd_block_write<T, n>(surf_ind, offset >> 4, vals.data());
+  __esimd_block_write<T, n, decltype(surf_ind), L1H, L3H>(
+      surf_ind, offset >> 4, vals.data());
 #else
-  __esimd_block_write<T, n>(acc, offset >> 4, vals.data());
+  __esimd_block_write<T, n, AccessorTy, L1H, L3H>(acc, offset >> 4,
+                                                  vals.data());
 #endif // __SYCL_DEVICE_ONLY__
 }
 
+/// Flat-address block prefetch. Hints the memory subsystem that the block
+/// \c block_load<T, n, L1H, L3H>(addr) would read is going to be accessed
+/// soon, without waiting for the data. The prefetch may be dropped when the
+/// target has no means to express it.
+/// \ingroup sycl_esimd
+template <typename T, int n, CacheHint L1H = CacheHint::None,
+          CacheHint L3H = CacheHint::None>
+ESIMD_INLINE ESIMD_NODEBUG void block_prefetch(const T *const addr) {
+  constexpr unsigned Sz = sizeof(T) * n;
+  static_assert(Sz >= __esimd::OWORD, "block size must be at least 1 oword");
+  static_assert(Sz % __esimd::OWORD == 0,
+                "block size must be whole number of owords");
+  static_assert(__esimd::isPowerOf2(Sz / __esimd::OWORD),
+                "block must be 1, 2, 4 or 8 owords long");
+  static_assert(Sz <= 8 * __esimd::OWORD,
+                "block size must be at most 8 owords");
+
+  uintptr_t Addr = reinterpret_cast<uintptr_t>(addr);
+  __esimd_flat_block_prefetch<T, n, L1H, L3H>(Addr);
+}
+
+/// Flat-address gather prefetch. Hints the memory subsystem that the elements
+/// \c gather<T, n, ElemsPerAddr, L1H, L3H>(p, offsets, pred) would read are
+/// going to be accessed soon, without waiting for the data. The prefetch may
+/// be dropped when the target has no means to express it.
+/// \ingroup sycl_esimd
+template <typename T, int n, int ElemsPerAddr = 1,
+          CacheHint L1H = CacheHint::None, CacheHint L3H = CacheHint::None>
+ESIMD_INLINE ESIMD_NODEBUG typename sycl::detail::enable_if_t<
+    ((n == 8 || n == 16 || n == 32) &&
+     (ElemsPerAddr == 1 || ElemsPerAddr == 2 || ElemsPerAddr == 4)),
+    void>
+gather_prefetch(const T *p, simd<uint32_t, n> offsets,
+                simd<uint16_t, n> pred = 1) {
+  simd<uint64_t, n> offsets_i = convert<uint64_t>(offsets);
+  simd<uint64_t, n> addrs(reinterpret_cast<uint64_t>(p));
+  addrs = addrs + offsets_i;
+  __esimd_flat_prefetch<T, n, ElemsPerAddrEncoding<ElemsPerAddr>(), L1H, L3H>(
+      addrs.data(), ElemsPerAddrEncoding<ElemsPerAddr>(), pred.data());
+}
+
 /// Accessor-based gather.
 ///
 /// Collects elements located at given offsets in an accessor and returns them
@@ -729,29 +775,41 @@ template <typename T, int m, int n, typename AccessorTy, unsigned plane = 0>
 ESIMD_INLINE ESIMD_NODEBUG simd<T, m * n>
 media_block_load(AccessorTy acc, unsigned x, unsigned y) {
   constexpr unsigned Width = n * sizeof(T);
-  static_assert(Width * m <= 256u,
-                "data does not fit into a single dataport transaction");
   static_assert(Width <= 64u, "valid block width is in range [1, 64]");
-  static_assert(m <= 64u, "valid block height is in range [1, 64]");
+  static_assert(m >= 1, "block height must be positive");
   static_assert(plane <= 3u, "valid plane index is in range [0, 3]");
-#if defined(__SYCL_DEVICE_ONLY__)
-  constexpr unsigned int RoundedWidth =
-      Width < 4 ? 4 : __esimd::getNextPowerOf2<Width>();
-
-  if constexpr (Width < RoundedWidth) {
-    constexpr unsigned int n1 = RoundedWidth / sizeof(T);
-    simd<T, m *n1> temp = __esimd_media_block_load<T, m, n1>(
-        0, AccessorPrivateProxy::getNativeImageObj(acc), plane, sizeof(T) * n,
-        x, y);
-    return temp.template select<m, 1, n, 1>(0, 0);
+  // Rows of a single dataport transaction.
+  constexpr unsigned MaxHeight = 256u / Width < 64u ? 256u / Width : 64u;
+  if constexpr (m > MaxHeight) {
+    // Taller blocks are transferred as several bands of rows.
+    simd<T, m * n> Res;
+    Res.template select<MaxHeight * n, 1>(0) =
+        media_block_load<T, MaxHeight, n, AccessorTy, plane>(acc, x, y);
+    Res.template select<(m - MaxHeight) * n, 1>(MaxHeight * n) =
+        media_block_load<T, m - MaxHeight, n, AccessorTy, plane>(
+            acc, x, y + MaxHeight);
+    return Res;
   } else {
-    return __esimd_media_block_load<T, m, n>(
-        0, AccessorPrivateProxy::getNativeImageObj(acc), plane, sizeof(T) * n,
-        x, y);
-  }
+#if defined(__SYCL_DEVICE_ONLY__)
+    constexpr unsigned int RoundedWidth =
+        Width < 4 ? 4 : __esimd::getNextPowerOf2<Width>();
+
+    if constexpr (Width < RoundedWidth) {
+      constexpr unsigned int n1 = RoundedWidth / sizeof(T);
+      simd<T, m *n1> temp = __esimd_media_block_load<T, m, n1>(
+          0, AccessorPrivateProxy::getNativeImageObj(acc), plane,
+          sizeof(T) * n, x, y);
+      return temp.template select<m, 1, n, 1>(0, 0);
+    } else {
+      return __esimd_media_block_load<T, m, n>(
+          0, AccessorPrivateProxy::getNativeImageObj(acc), plane,
+          sizeof(T) * n, x, y);
+    }
 #else
-  return __esimd_media_block_load<T, m, n>(0, acc, plane, sizeof(T) * n, x, y);
+    return __esimd_media_block_load<T, m, n>(0, acc, plane, sizeof(T) * n, x,
+                                             y);
 #endif // __SYCL_DEVICE_ONLY__
+  }
 }
 
 /// Media block store.
@@ -771,32 +829,42 @@ template <typename T, int m, int n, typename AccessorTy, unsigned plane = 0>
 ESIMD_INLINE ESIMD_NODEBUG void
 media_block_store(AccessorTy acc, unsigned x, unsigned y, simd<T, m * n> vals) {
   constexpr unsigned Width = n * sizeof(T);
-  static_assert(Width * m <= 256u,
-                "data does not fit into a single dataport transaction");
   static_assert(Width <= 64u, "valid block width is in range [1, 64]");
-  static_assert(m <= 64u, "valid block height is in range [1, 64]");
+  static_assert(m >= 1, "block height must be positive");
   static_assert(plane <= 3u, "valid plane index is in range [0, 3]");
-#if defined(__SYCL_DEVICE_ONLY__)
-  constexpr unsigned int RoundedWidth =
-      Width < 4 ? 4 : __esimd::getNextPowerOf2<Width>();
-  constexpr unsigned int n1 = RoundedWidth / sizeof(T);
-
-  if constexpr (Width < RoundedWidth) {
-    simd<T, m * n1> temp;
-    auto temp_ref = temp.template format<T, m, n1>();
-    auto vals_ref = vals.template format<T, m, n>();
-    temp_ref.template select<m, 1, n, 1>() = vals_ref;
-    __esimd_media_block_store<T, m, n1>(
-        0, AccessorPrivateProxy::getNativeImageObj(acc), plane, sizeof(T) * n,
-        x, y, temp);
+  // Rows of a single dataport transaction.
+  constexpr unsigned MaxHeight = 256u / Width < 64u ? 256u / Width : 64u;
+  if constexpr (m > MaxHeight) {
+    // Taller blocks are transferred as several bands of rows.
+    media_block_store<T, MaxHeight, n, AccessorTy, plane>(
+        acc, x, y, vals.template select<MaxHeight * n, 1>(0));
+    media_block_store<T, m - MaxHeight, n, AccessorTy, plane>(
+        acc, x, y + MaxHeight,
+        vals.template select<(m - MaxHeight) * n, 1>(MaxHeight * n));
   } else {
-    __esimd_media_block_store<T, m, n>(
-        0, AccessorPrivateProxy::getNativeImageObj(acc), plane, sizeof(T) * n,
-        x, y, vals);
-  }
+#if defined(__SYCL_DEVICE_ONLY__)
+    constexpr unsigned int RoundedWidth =
+        Width < 4 ? 4 : __esimd::getNextPowerOf2<Width>();
+    constexpr unsigned int n1 = RoundedWidth / sizeof(T);
+
+    if constexpr (Width < RoundedWidth) {
+      simd<T, m * n1> temp;
+      auto temp_ref = temp.template format<T, m, n1>();
+      auto vals_ref = vals.template format<T, m, n>();
+      temp_ref.template select<m, 1, n, 1>() = vals_ref;
+      __esimd_media_block_store<T, m, n1>(
+          0, AccessorPrivateProxy::getNativeImageObj(acc), plane,
+          sizeof(T) * n, x, y, temp);
+    } else {
+      __esimd_media_block_store<T, m, n>(
+          0, AccessorPrivateProxy::getNativeImageObj(acc), plane,
+          sizeof(T) * n, x, y, vals);
+    }
 #else
-  __esimd_media_block_store<T, m, n>(0, acc, plane, sizeof(T) * n, x, y, vals);
+    __esimd_media_block_store<T, m, n>(0, acc, plane, sizeof(T) * n, x, y,
+                                       vals);
 #endif // __SYCL_DEVICE_ONLY__
+  }
 }
 
 #ifndef __SYCL_DEVICE_ONLY__
@@ -10,4 +10,5 @@
 #include <CL/sycl/INTEL/fpga_device_selector.hpp>
 #include <CL/sycl/INTEL/fpga_lsu.hpp>
 #include <CL/sycl/INTEL/fpga_reg.hpp>
+#include <CL/sycl/INTEL/host_pipe.hpp>
 #include <CL/sycl/INTEL/pipes.hpp>
@@ -0,0 +1,173 @@
+//==------------- host_pipe.hpp - SYCL host to kernel pipes ---*- C++ -*----==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// ===--------------------------------------------------------------------=== //
+
+#pragma once
+
+#include <CL/sycl/ONEAPI/atomic_ref.hpp>
+#include <CL/sycl/exception.hpp>
+#include <CL/sycl/queue.hpp>
+#include <CL/sycl/usm.hpp>
+
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace INTEL {
+
+namespace detail {
+/// The positions of the reader and of the writer of a host pipe. Each one is
+/// only written by its side, and they only grow, so the ring buffer is full
+/// when they are Capacity apart.
+struct host_pipe_positions {
+  alignas(64) uint64_t Read;
+  alignas(64) uint64_t Write;
+};
+} // namespace detail
+
+/// The end of a host_pipe used by a kernel. It is captured by the kernel by
+/// copy; the kernel is usually a long running one, which processes the data
+/// the host streams to it, or streams its results back to the host.
+///
+/// Each direction has a single reader and a single writer: a pipe is either
+/// written by the host and read by one work-item, or the other way round.
+template <typename T> class host_pipe_end {
+  using PositionRef =
+      ONEAPI::atomic_ref<uint64_t, ONEAPI::memory_order::acq_rel,
+                         ONEAPI::memory_scope::system,
+                         access::address_space::global_space>;
+
+public:
+  /// Reads the next element if there is one.
+  /// \return true if an element was read.
+  bool try_read(T &Value) const {
+    PositionRef Read(MPositions->Read);
+    PositionRef Write(MPositions->Write);
+    const uint64_t Position = Read.load(ONEAPI::memory_order::relaxed);
+    if (Position == Write.load(ONEAPI::memory_order::acquire))
+      return false;
+    Value = MData[Position % MCapacity];
+    Read.store(Position + 1, ONEAPI::memory_order::release);
+    return true;
+  }
+
+  /// Writes the element if the pipe is not full.
+  /// \return true if the element was written.
+  bool try_write(const T &Value) const {
+    PositionRef Read(MPositions->Read);
+    PositionRef Write(MPositions->Write);
+    const uint64_t Position = Write.load(ONEAPI::memory_order::relaxed);
+    if (Position - Read.load(ONEAPI::memory_order::acquire) == MCapacity)
+      return false;
+    MData[Position % MCapacity] = Value;
+    Write.store(Position + 1, ONEAPI::memory_order::release);
+    return true;
+  }
+
+  /// Reads the next element, waiting for it if the pipe is empty.
+  T read() const {
+    T Value;
+    while (!try_read(Value))
+      wait();
+    return Value;
+  }
+
+  /// Writes the element, waiting for room if the pipe is full.
+  void write(const T &Value) const {
+    while (!try_write(Value))
+      wait();
+  }
+
+private:
+  host_pipe_end(T *Data, detail::host_pipe_positions *Positions,
+                uint64_t Capacity)
+      : MData(Data), MPositions(Positions), MCapacity(Capacity) {}
+
+  static void wait() {
+#ifndef __SYCL_DEVICE_ONLY__
+    std::this_thread::yield();
+#endif
+  }
+
+  T *MData;
+  detail::host_pipe_positions *MPositions;
+  uint64_t MCapacity;
+
+  template <typename> friend class host_pipe;
+};
+
+/// A pipe streaming data between the host and a kernel without a kernel
+/// launch per chunk of data. The data goes through a ring buffer of pinned
+/// host memory, which the kernel accesses through get_kernel_end() while the
+/// host uses read() and write().
+///
+/// The pipe is backed by USM host allocations, so the device of the queue
+/// must support them; its kernels access the host memory atomically.
+template <typename T> class host_pipe {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "The elements of a host_pipe must be trivially copyable");
+
+public:
+  /// Creates the pipe for the kernels of the context of the queue, with room
+  /// for Capacity elements.
+  host_pipe(const queue &Q, size_t Capacity) : MContext(Q.get_context()) {
+    if (Capacity == 0)
+      throw invalid_parameter_error("The capacity of a host_pipe is zero",
+                                    PI_INVALID_VALUE);
+    MData = malloc_host<T>(Capacity, MContext);
+    MPositions = malloc_host<detail::host_pipe_positions>(1, MContext);
+    if (!MData || !MPositions) {
+      free(MData, MContext);
+      free(MPositions, MContext);
+      throw runtime_error("The host_pipe allocation failed",
+                          PI_OUT_OF_HOST_MEMORY);
+    }
+    MPositions->Read = 0;
+    MPositions->Write = 0;
+    MCapacity = Capacity;
+  }
+
+  host_pipe(const host_pipe &) = delete;
+  host_pipe &operator=(const host_pipe &) = delete;
+
+  /// The kernels using the pipe must be complete.
+  ~host_pipe() {
+    free(MData, MContext);
+    free(MPositions, MContext);
+  }
+
+  /// \return the end of the pipe to be captured by a kernel.
+  host_pipe_end<T> get_kernel_end() const {
+    return host_pipe_end<T>(MData, MPositions, MCapacity);
+  }
+
+  /// Reads the next element written by the kernel if there is one.
+  bool try_read(T &Value) { return get_kernel_end().try_read(Value); }
+
+  /// Writes the element for the kernel if the pipe is not full.
+  bool try_write(const T &Value) { return get_kernel_end().try_write(Value); }
+
+  /// Reads the next element written by the kernel, waiting for it.
+  T read() { return get_kernel_end().read(); }
+
+  /// Writes the element for the kernel, waiting for room in the pipe.
+  void write(const T &Value) { get_kernel_end().write(Value); }
+
+  size_t get_capacity() const { return MCapacity; }
+
+private:
+  context MContext;
+  T *MData = nullptr;
+  detail::host_pipe_positions *MPositions = nullptr;
+  uint64_t MCapacity = 0;
+};
+
+} // namespace INTEL
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
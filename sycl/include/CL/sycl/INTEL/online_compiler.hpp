@@ -12,7 +12,18 @@
 #include <CL/sycl/detail/defines_elementary.hpp> // for __SYCL_INLINE_NAMESPACE
 #include <CL/sycl/device.hpp>
 
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iterator>
 #include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 __SYCL_INLINE_NAMESPACE(cl) {
@@ -65,6 +76,97 @@ class online_compile_error : public sycl::exception {
 /// Designates a source language for the online compiler.
 enum class source_language { opencl_c, cm };
 
+namespace detail {
+/// The binaries compiled by the online compilers of the program, keyed by the
+/// source, the options and the compilation target.
+///
+/// If SYCL_ONLINE_COMPILER_CACHE_DIR is set, the binaries are also kept in
+/// that directory, so that other runs of the program find them.
+class online_compile_cache {
+public:
+  static online_compile_cache &get() {
+    static online_compile_cache Cache;
+    return Cache;
+  }
+
+  /// \return the binary compiled for Key, by Compile if it is not cached.
+  template <typename CompileT>
+  std::vector<byte> getOrCompile(const std::string &Key, CompileT Compile) {
+    {
+      std::lock_guard<std::mutex> Lock(MMutex);
+      auto It = MBinaries.find(Key);
+      if (It != MBinaries.end())
+        return It->second;
+    }
+
+    std::vector<byte> Binary;
+    if (!readFromDisk(Key, Binary)) {
+      Binary = Compile();
+      writeToDisk(Key, Binary);
+    }
+    std::lock_guard<std::mutex> Lock(MMutex);
+    return MBinaries.emplace(Key, std::move(Binary)).first->second;
+  }
+
+private:
+  online_compile_cache() {
+    if (const char *Dir = std::getenv("SYCL_ONLINE_COMPILER_CACHE_DIR"))
+      MDir = Dir;
+  }
+
+  std::string getPath(const std::string &Key) const {
+    std::stringstream Path;
+    Path << MDir << "/" << std::hex << std::hash<std::string>{}(Key) << ".bin";
+    return Path.str();
+  }
+
+  // The file starts with the key, the hashes of different keys may collide.
+  bool readFromDisk(const std::string &Key, std::vector<byte> &Binary) const {
+    if (MDir.empty())
+      return false;
+    std::ifstream File(getPath(Key), std::ios::binary);
+    size_t KeySize = 0;
+    if (!File.read(reinterpret_cast<char *>(&KeySize), sizeof(KeySize)) ||
+        KeySize != Key.size())
+      return false;
+    std::string FileKey(KeySize, '\0');
+    if (!File.read(&FileKey[0], KeySize) || FileKey != Key)
+      return false;
+    Binary.assign(std::istreambuf_iterator<char>(File),
+                  std::istreambuf_iterator<char>());
+    return true;
+  }
+
+  // Failures to write only lose the binary for the other runs.
+  void writeToDisk(const std::string &Key,
+                   const std::vector<byte> &Binary) const {
+    if (MDir.empty())
+      return;
+    // Written to a temporary file first, the concurrent readers must not see
+    // the file partially written.
+    const std::string Path = getPath(Key);
+    std::stringstream TmpPath;
+    TmpPath << Path << "." << std::hex << std::hash<std::thread::id>{}(
+                                              std::this_thread::get_id());
+    {
+      std::ofstream File(TmpPath.str(), std::ios::binary);
+      const size_t KeySize = Key.size();
+      File.write(reinterpret_cast<const char *>(&KeySize), sizeof(KeySize));
+      File.write(Key.data(), KeySize);
+      File.write(reinterpret_cast<const char *>(Binary.data()), Binary.size());
+      if (!File)
+        return;
+    }
+    if (std::rename(TmpPath.str().c_str(), Path.c_str()) != 0)
+      std::remove(TmpPath.str().c_str());
+  }
+
+  std::mutex MMutex;
+  std::unordered_map<std::string, std::vector<byte>> MBinaries;
+  std::string MDir;
+};
+} // namespace detail
+
 /// Represents an online compiler for the language given as template
 /// parameter.
 template <source_language Lang> class online_compiler {
@@ -75,7 +177,8 @@ public:
   /// device capabilities are supported by the target device(s).
   online_compiler(compiled_code_format fmt = compiled_code_format::spir_v)
       : OutputFormat(fmt), OutputFormatVersion({0, 0}),
-        DeviceArch(device_arch::any), Is64Bit(true), DeviceStepping("") {}
+        DeviceType(sycl::info::device_type::all), DeviceArch(device_arch::any),
+        Is64Bit(true), DeviceStepping("") {}
 
   /// Constructs online compiler which targets given architecture and produces
   /// given compiled code format. Produces device code is 64-bit.
@@ -84,8 +187,8 @@ public:
   /// supported for given device type.
   online_compiler(sycl::info::device_type dev_type, device_arch arch,
                   compiled_code_format fmt = compiled_code_format::spir_v)
-      : OutputFormat(fmt), OutputFormatVersion({0, 0}), DeviceArch(arch),
-        Is64Bit(true), DeviceStepping("") {}
+      : OutputFormat(fmt), OutputFormatVersion({0, 0}), DeviceType(dev_type),
+        DeviceArch(arch), Is64Bit(true), DeviceStepping("") {}
 
   /// Constructs online compiler for the target specified by given SYCL device.
   online_compiler(const sycl::device &dev);
@@ -99,6 +202,20 @@ public:
   template <typename... Tys>
   std::vector<byte> compile(const std::string &src, const Tys &... args);
 
+  /// Compiles given in-memory \c Lang source asynchronously, the arguments
+  /// are the ones of \c compile. The compilation target is the one of the
+  /// compiler when this is called, the compiler may be changed or destroyed
+  /// before the compilation is done.
+  /// The future throws online_compile_error if compilation is not successful.
+  template <typename... Tys>
+  std::future<std::vector<byte>> compile_async(const std::string &src,
+                                               const Tys &... args) {
+    return std::async(std::launch::async,
+                      [Compiler = *this, src, args...]() mutable {
+                        return Compiler.compile(src, args...);
+                      });
+  }
+
   /// Sets the compiled code format of the compilation target and returns *this.
   online_compiler<Lang> &setOutputFormat(compiled_code_format fmt);
 
@@ -123,6 +240,35 @@ public:
   online_compiler<Lang> &setTargetDeviceStepping(const std::string &id);
 
 private:
+  /// \return the binary of the source, which is only compiled if the same
+  /// source was not compiled before with the same options for the same
+  /// target.
+  std::vector<byte> compileCached(const std::string &src,
+                                  const std::vector<std::string> &options) {
+    return detail::online_compile_cache::get().getOrCompile(
+        getCacheKey(src, options), [&]() {
+          // real implementation will call some non-templated impl function
+          // here
+          return std::vector<byte>{};
+        });
+  }
+
+  /// \return the identifier of the compilation of the source with the
+  /// options for the compilation target.
+  std::string getCacheKey(const std::string &src,
+                          const std::vector<std::string> &options) {
+    std::stringstream Key;
+    Key << static_cast<int>(Lang) << ";" << static_cast<int>(OutputFormat)
+        << ";" << OutputFormatVersion.first << "." << OutputFormatVersion.second
+        << ";" << static_cast<int>(DeviceType) << ";"
+        << static_cast<int>(DeviceArch) << ";" << Is64Bit << ";"
+        << DeviceStepping.size() << ":" << DeviceStepping << ";";
+    for (const std::string &Option : options)
+      Key << Option.size() << ":" << Option << ";";
+    Key << src.size() << ":" << src;
+    return Key.str();
+  }
+
   // Compilation target specification fields: {
 
   /// Compiled code format.
@@ -154,8 +300,7 @@ template <>
 template <>
 std::vector<byte>
 online_compiler<source_language::opencl_c>::compile(const std::string &src) {
-  // real implementation will call some non-templated impl function here
-  return std::vector<byte>{};
+  return compileCached(src, {});
 }
 
 /// Compiles given OpenCL source. May throw \c online_compile_error.
@@ -166,8 +311,7 @@ template <>
 template <>
 std::vector<byte> online_compiler<source_language::opencl_c>::compile(
     const std::string &src, const std::vector<std::string> &options) {
-  // real implementation will call some non-templated impl function here
-  return std::vector<byte>{};
+  return compileCached(src, options);
 }
 
 /// Compiles given CM source.
@@ -175,8 +319,7 @@ template <>
 template <>
 std::vector<byte>
 online_compiler<source_language::cm>::compile(const std::string &src) {
-  // real implementation will call some non-templated impl function here
-  return std::vector<byte>{};
+  return compileCached(src, {});
 }
 
 /// Compiles given CM source.
@@ -185,8 +328,7 @@ template <>
 template <>
 std::vector<byte> online_compiler<source_language::cm>::compile(
     const std::string &src, const std::vector<std::string> &options) {
-  // real implementation will call some non-templated impl function here
-  return std::vector<byte>{};
+  return compileCached(src, options);
 }
 
 } // namespace INTEL
@@ -0,0 +1,60 @@
+//==------ built_programs.hpp --- SYCL export and import of JIT builds -----==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl/context.hpp>
+#include <CL/sycl/detail/export.hpp>
+#include <CL/sycl/stl.hpp>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace ONEAPI {
+
+// This is a preview extension implementation, intended to provide early
+// access to a feature for review and community feedback.
+//
+// Because the interfaces defined by this header file are not final and are
+// subject to change they are not intended to be used by shipping software
+// products. If you are interested in using this feature in your software
+// product, please let us know!
+
+/// \brief writes the native binaries of the programs the JIT compiler has
+/// built for the kernels of the application in the context to a file.
+///
+/// Each binary is tagged with the device and the driver it is built for, the
+/// device code it is built from, the build options and the spec constant
+/// values, so that it is only used by a process which would build the same
+/// program. Together with ONEAPI::prebuild_all, it lets deployment tools make
+/// the builds once per device model instead of once per process.
+///
+/// \param Context is the context the programs are built in.
+/// \param FileName is the file to write, replaced if it exists.
+/// \return the number of programs written.
+/// \throw runtime_error if the file can't be written.
+__SYCL_EXPORT size_t export_built_programs(const context &Context,
+                                           const string_class &FileName);
+
+/// \brief reads the native binaries written by export_built_programs, so that
+/// the programs of the context are created from them instead of being built.
+///
+/// The binaries built for other devices or drivers than the ones of the
+/// context are skipped, and so are the ones built from device code which the
+/// application doesn't have, e.g. after it has been rebuilt.
+///
+/// \param Context is the context to create the programs in.
+/// \param FileName is the file to read.
+/// \return the number of programs imported for the devices of the context.
+/// \throw runtime_error if the file can't be read or has been written by
+/// another version of the runtime.
+__SYCL_EXPORT size_t import_built_programs(const context &Context,
+                                           const string_class &FileName);
+
+} // namespace ONEAPI
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -0,0 +1,86 @@
+//==------- command_graph.hpp --- SYCL recorded command sequences ----------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl/detail/export.hpp>
+#include <CL/sycl/event.hpp>
+#include <CL/sycl/queue.hpp>
+#include <CL/sycl/stl.hpp>
+
+#include <memory>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+class command_graph_impl;
+} // namespace detail
+
+namespace ONEAPI {
+
+// This is a preview extension implementation, intended to provide early
+// access to a feature for review and community feedback.
+//
+// Because the interfaces defined by this header file are not final and are
+// subject to change they are not intended to be used by shipping software
+// products. If you are interested in using this feature in your software
+// product, please let us know!
+
+/// \brief sequence of commands recorded from a queue, which is executed again
+/// as a single operation.
+///
+/// Launching a recorded sequence costs about as much as launching a single
+/// kernel, which helps iterative applications submitting the same few dozen
+/// small kernels every iteration. Recording the sequence again with other
+/// arguments updates the graph in place, which is much cheaper than creating
+/// a new one as long as the sequence of the commands doesn't change.
+///
+/// While a queue is being recorded the commands submitted to it are not
+/// executed, so the host must not wait for them, and they may only depend on
+/// other commands recorded from the same queue. Commands using USM pointers
+/// meet these requirements, commands using buffers may need host
+/// synchronization and should not be recorded.
+///
+/// The CUDA backend records the queue into a CUDA graph. With the other
+/// backends the SYCL runtime records the kernels and the USM operations
+/// submitted to the queue, with their dependencies and their kernel
+/// arguments, so that a replay enqueues them without going through the
+/// scheduler again; the other command groups can't be recorded, and the
+/// dependencies on commands which are not recorded are waited for during the
+/// recording.
+class __SYCL_EXPORT command_graph {
+public:
+  command_graph();
+
+  /// Starts recording the commands submitted to the queue. The queue is waited
+  /// for before the recording starts.
+  ///
+  /// \throw feature_not_supported if the queue is a host queue.
+  void begin_recording(queue &Queue);
+
+  /// Finishes the recording started by begin_recording. The recorded commands
+  /// replace the ones recorded before.
+  void end_recording();
+
+  /// \return true if commands have been recorded into the graph.
+  bool is_recorded() const;
+
+  /// Executes the recorded commands on the queue, which must be in the same
+  /// context and on the same device as the recorded one.
+  ///
+  /// \param DepEvents are the events the execution waits for.
+  /// \return an event representing the execution of all recorded commands.
+  event replay(queue &Queue, const vector_class<event> &DepEvents = {});
+
+private:
+  std::shared_ptr<sycl::detail::command_graph_impl> impl;
+};
+
+} // namespace ONEAPI
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -0,0 +1,554 @@
+//==------- device_algorithm.hpp --- SYCL device-wide algorithms ----------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl/ONEAPI/atomic.hpp>
+#include <CL/sycl/ONEAPI/group_algorithm.hpp>
+#include <CL/sycl/accessor.hpp>
+#include <CL/sycl/handler.hpp>
+#include <CL/sycl/queue.hpp>
+#include <CL/sycl/usm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#ifndef __DISABLE_SYCL_ONEAPI_GROUP_ALGORITHMS__
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace ONEAPI {
+
+// This is a preview extension implementation, intended to provide early
+// access to a feature for review and community feedback.
+//
+// Because the interfaces defined by this header file are not final and are
+// subject to change they are not intended to be used by shipping software
+// products. If you are interested in using this feature in your software
+// product, please let us know!
+//
+// The algorithms below run over USM memory on the device of the queue. They
+// are built on the group algorithms and thus share their restrictions: they
+// are not supported on host device and accept only the operations listed in
+// ONEAPI/functional.hpp.
+
+namespace detail {
+
+using cl::sycl::detail::enable_if_t;
+
+/// These are the forward declarations for the classes that help to create
+/// names for the kernels implementing the device-wide algorithms.
+template <typename T, class BinaryOperation, bool IsInclusive>
+class __sycl_scan_kernel;
+template <typename T, bool UseLocalBins> class __sycl_histogram_kernel;
+template <typename KeyT> class __sycl_radix_sort_count_kernel;
+template <typename KeyT, typename ValueT>
+class __sycl_radix_sort_scatter_kernel;
+
+// The work-group size used by the algorithms, unless the device limits it.
+constexpr size_t algorithm_wg_size = 256;
+
+// The number of contiguous elements a work-item scans in registers.
+constexpr size_t scan_items_per_work_item = 4;
+
+// The status of a tile in the decoupled look-back scan. A tile publishes
+// the reduction of its own elements (aggregate) as soon as it is known, and
+// then the reduction of all elements up to and including the tile (prefix).
+enum scan_status : uint32_t {
+  scan_status_invalid = 0,
+  scan_status_aggregate = 1,
+  scan_status_prefix = 2
+};
+
+inline size_t getAlgorithmWGSize(const queue &Q) {
+  return (std::min)(
+      algorithm_wg_size,
+      Q.get_device().get_info<info::device::max_work_group_size>());
+}
+
+/// The temporary device memory of the decoupled look-back scan.
+template <typename T> struct scan_state {
+  scan_state(queue &Q, size_t N) {
+    size_t WGSize = getAlgorithmWGSize(Q);
+    TileSize = WGSize * scan_items_per_work_item;
+    NumTiles = (N + TileSize - 1) / TileSize;
+    // The last element is the counter assigning the tiles to work-groups.
+    Flags = malloc_device<uint32_t>(NumTiles + 1, Q);
+    Aggregates = malloc_device<T>(NumTiles, Q);
+    Prefixes = malloc_device<T>(NumTiles, Q);
+    if (!Flags || !Aggregates || !Prefixes) {
+      release(Q.get_context());
+      throw runtime_error("Not enough memory for the scan",
+                          PI_OUT_OF_RESOURCES);
+    }
+  }
+
+  void release(const context &Ctx) {
+    free(Flags, Ctx);
+    free(Aggregates, Ctx);
+    free(Prefixes, Ctx);
+  }
+
+  size_t TileSize;
+  size_t NumTiles;
+  uint32_t *Flags;
+  T *Aggregates;
+  T *Prefixes;
+};
+
+/// Frees the USM memory \p Ptrs after the commands represented by \p Dep
+/// complete. The returned event completes when the memory is freed.
+template <typename... Ts> event freeAfter(queue &Q, event Dep, Ts *... Ptrs) {
+  context Ctx = Q.get_context();
+  return Q.submit([&](handler &CGH) {
+    CGH.depends_on(Dep);
+    CGH.codeplay_host_task([=]() {
+      (void)std::initializer_list<int>{(free(Ptrs, Ctx), 0)...};
+    });
+  });
+}
+
+/// Enqueues a single-pass scan of the \p N elements starting at \p First
+/// to \p Result, using the temporary memory \p State.
+///
+/// Each work-group scans one tile of elements. The tiles are assigned to
+/// work-groups in the order the work-groups start, so a work-group only waits
+/// for the tiles of the work-groups which are already running. The prefix of
+/// a tile is found by looking back at the statuses of the preceding tiles
+/// until a tile with a known prefix is reached, so every element is read and
+/// written only once.
+template <bool IsInclusive, typename T, class BinaryOperation>
+event scanImpl(queue &Q, const T *First, size_t N, T *Result, T Init,
+               BinaryOperation BOp, scan_state<T> &State,
+               const vector_class<event> &DepEvents) {
+  size_t TileSize = State.TileSize;
+  size_t NumTiles = State.NumTiles;
+  size_t WGSize = TileSize / scan_items_per_work_item;
+  uint32_t *Flags = State.Flags;
+  T *Aggregates = State.Aggregates;
+  T *Prefixes = State.Prefixes;
+  event InitEvent = Q.submit([&](handler &CGH) {
+    CGH.depends_on(DepEvents);
+    CGH.memset(Flags, 0, (NumTiles + 1) * sizeof(uint32_t));
+  });
+
+  return Q.submit([&](handler &CGH) {
+    CGH.depends_on(InitEvent);
+    accessor<size_t, 1, access::mode::read_write, access::target::local>
+        TileIdLocal(1, CGH);
+    accessor<T, 1, access::mode::read_write, access::target::local>
+        PrefixLocal(1, CGH);
+    CGH.parallel_for<__sycl_scan_kernel<T, BinaryOperation, IsInclusive>>(
+        nd_range<1>(NumTiles * WGSize, WGSize), [=](nd_item<1> NDIt) {
+          constexpr size_t K = scan_items_per_work_item;
+          group<1> G = NDIt.get_group();
+          size_t LID = NDIt.get_local_linear_id();
+          if (LID == 0) {
+            atomic_ref<uint32_t, memory_order::relaxed, memory_scope::device,
+                       access::address_space::global_space>
+                Counter(Flags[NumTiles]);
+            TileIdLocal[0] = Counter.fetch_add(1);
+          }
+          NDIt.barrier(access::fence_space::local_space);
+          size_t TileId = TileIdLocal[0];
+
+          // Every work-item reduces its contiguous elements in registers, so
+          // only the sums of the work-items are scanned over the group.
+          size_t Begin = TileId * TileSize + LID * K;
+          T X[K];
+          T Sum = sycl::detail::identity<T, BinaryOperation>::value;
+          for (size_t J = 0; J < K; ++J) {
+            if (Begin + J < N) {
+              X[J] = First[Begin + J];
+              Sum = BOp(Sum, X[J]);
+            }
+          }
+          T Exclusive = exclusive_scan(G, Sum, BOp);
+          T Aggregate = broadcast(G, BOp(Exclusive, Sum), WGSize - 1);
+
+          if (LID == 0) {
+            T Prefix = Init;
+            if (TileId == 0) {
+              Prefixes[0] = BOp(Init, Aggregate);
+              atomic_fence(memory_order::acq_rel, memory_scope::device);
+              atomic_ref<uint32_t, memory_order::relaxed, memory_scope::device,
+                         access::address_space::global_space>(Flags[0])
+                  .store(scan_status_prefix);
+            } else {
+              Aggregates[TileId] = Aggregate;
+              atomic_fence(memory_order::acq_rel, memory_scope::device);
+              atomic_ref<uint32_t, memory_order::relaxed, memory_scope::device,
+                         access::address_space::global_space>(Flags[TileId])
+                  .store(scan_status_aggregate);
+
+              // Look back: combine the aggregates of the preceding tiles
+              // until a tile with a known prefix is found.
+              T LookBack = sycl::detail::identity<T, BinaryOperation>::value;
+              for (size_t P = TileId; P-- > 0;) {
+                atomic_ref<uint32_t, memory_order::relaxed,
+                           memory_scope::device,
+                           access::address_space::global_space>
+                    Flag(Flags[P]);
+                uint32_t Status;
+                while ((Status = Flag.load()) == scan_status_invalid)
+                  ;
+                atomic_fence(memory_order::acq_rel, memory_scope::device);
+                if (Status == scan_status_prefix) {
+                  LookBack = BOp(Prefixes[P], LookBack);
+                  break;
+                }
+                LookBack = BOp(Aggregates[P], LookBack);
+              }
+              Prefix = LookBack;
+
+              Prefixes[TileId] = BOp(Prefix, Aggregate);
+              atomic_fence(memory_order::acq_rel, memory_scope::device);
+              atomic_ref<uint32_t, memory_order::relaxed, memory_scope::device,
+                         access::address_space::global_space>(Flags[TileId])
+                  .store(scan_status_prefix);
+            }
+            PrefixLocal[0] = Prefix;
+          }
+          NDIt.barrier(access::fence_space::local_space);
+
+          T Run = BOp(PrefixLocal[0], Exclusive);
+          for (size_t J = 0; J < K; ++J) {
+            if (Begin + J < N) {
+              if (IsInclusive) {
+                Run = BOp(Run, X[J]);
+                Result[Begin + J] = Run;
+              } else {
+                Result[Begin + J] = Run;
+                Run = BOp(Run, X[J]);
+              }
+            }
+          }
+        });
+  });
+}
+
+template <bool IsInclusive, typename T, class BinaryOperation>
+event scan(queue &Q, const T *First, const T *Last, T *Result, T Init,
+           BinaryOperation BOp) {
+  size_t N = Last - First;
+  if (N == 0)
+    return event();
+  scan_state<T> State(Q, N);
+  event Scan = scanImpl<IsInclusive>(Q, First, N, Result, Init, BOp, State, {});
+  return freeAfter(Q, Scan, State.Flags, State.Aggregates, State.Prefixes);
+}
+
+/// Returns the bin of the integral value \p X from [Lower, Upper).
+template <typename T>
+enable_if_t<std::is_integral<T>::value, size_t>
+getHistogramBin(T X, T Lower, T Upper, size_t NumBins) {
+  using UT = typename std::make_unsigned<T>::type;
+  uint64_t Offset = static_cast<UT>(X - Lower);
+  uint64_t Width = static_cast<UT>(Upper - Lower);
+  return static_cast<size_t>(Offset * NumBins / Width);
+}
+
+/// Returns the bin of the floating point value \p X from [Lower, Upper).
+template <typename T>
+enable_if_t<!std::is_integral<T>::value, size_t>
+getHistogramBin(T X, T Lower, T Upper, size_t NumBins) {
+  size_t Bin = static_cast<size_t>((X - Lower) / (Upper - Lower) * NumBins);
+  // Rounding may move the values close to Upper out of the last bin.
+  return (std::min)(Bin, NumBins - 1);
+}
+
+template <bool UseLocalBins, typename T>
+event histogramImpl(queue &Q, const T *First, size_t N, uint32_t *Bins,
+                    size_t NumBins, T Lower, T Upper) {
+  size_t WGSize = getAlgorithmWGSize(Q);
+  size_t NumWorkGroups = (N + WGSize * scan_items_per_work_item - 1) /
+                         (WGSize * scan_items_per_work_item);
+  return Q.submit([&](handler &CGH) {
+    accessor<uint32_t, 1, access::mode::read_write, access::target::local>
+        LocalBins(UseLocalBins ? NumBins : 1, CGH);
+    CGH.parallel_for<__sycl_histogram_kernel<T, UseLocalBins>>(
+        nd_range<1>(NumWorkGroups * WGSize, WGSize), [=](nd_item<1> NDIt) {
+          size_t LID = NDIt.get_local_linear_id();
+          if (UseLocalBins) {
+            for (size_t B = LID; B < NumBins; B += WGSize)
+              LocalBins[B] = 0;
+            NDIt.barrier(access::fence_space::local_space);
+          }
+
+          size_t Stride = NDIt.get_global_range(0);
+          for (size_t I = NDIt.get_global_linear_id(); I < N; I += Stride) {
+            T X = First[I];
+            if (!(X >= Lower && X < Upper))
+              continue;
+            size_t B = getHistogramBin(X, Lower, Upper, NumBins);
+            if (UseLocalBins)
+              atomic_ref<uint32_t, memory_order::relaxed,
+                         memory_scope::work_group,
+                         access::address_space::local_space>(LocalBins[B])
+                  .fetch_add(1);
+            else
+              atomic_ref<uint32_t, memory_order::relaxed, memory_scope::device,
+                         access::address_space::global_space>(Bins[B])
+                  .fetch_add(1);
+          }
+
+          // Merge the bins of the work-group to the global ones.
+          if (UseLocalBins) {
+            NDIt.barrier(access::fence_space::local_space);
+            for (size_t B = LID; B < NumBins; B += WGSize)
+              if (uint32_t Count = LocalBins[B])
+                atomic_ref<uint32_t, memory_order::relaxed,
+                           memory_scope::device,
+                           access::address_space::global_space>(Bins[B])
+                    .fetch_add(Count);
+          }
+        });
+  });
+}
+
+// The number of bits of the key sorted by one pass of the radix sort.
+constexpr int radix_sort_bits = 4;
+constexpr int radix_sort_buckets = 1 << radix_sort_bits;
+
+/// Returns the digit of the key \p Key sorted by the pass \p Pass. The keys
+/// are mapped to unsigned integers preserving their order.
+template <typename KeyT> uint32_t getRadixDigit(KeyT Key, int Pass) {
+  using UKeyT = typename std::make_unsigned<KeyT>::type;
+  constexpr UKeyT SignBit =
+      std::is_signed<KeyT>::value
+          ? static_cast<UKeyT>(UKeyT(1) << (sizeof(KeyT) * 8 - 1))
+          : UKeyT(0);
+  UKeyT Bits = static_cast<UKeyT>(Key) ^ SignBit;
+  return static_cast<uint32_t>(Bits >> (Pass * radix_sort_bits)) &
+         (radix_sort_buckets - 1);
+}
+
+} // namespace detail
+
+/// Computes the inclusive scan of [first, last) with \p binary_op and writes
+/// it to \p result on the device of the queue \p q.
+///
+/// \return an event representing the scan.
+template <typename T, class BinaryOperation>
+event inclusive_scan(queue &q, const T *first, const T *last, T *result,
+                     BinaryOperation binary_op) {
+  return detail::scan</*IsInclusive=*/true>(
+      q, first, last, result,
+      sycl::detail::identity<T, BinaryOperation>::value, binary_op);
+}
+
+/// Computes the inclusive scan of [first, last) with \p binary_op starting
+/// with \p init and writes it to \p result on the device of the queue \p q.
+///
+/// \return an event representing the scan.
+template <typename T, class BinaryOperation>
+event inclusive_scan(queue &q, const T *first, const T *last, T *result,
+                     BinaryOperation binary_op,
+                     typename std::remove_cv<T>::type init) {
+  return detail::scan</*IsInclusive=*/true>(q, first, last, result, init,
+                                            binary_op);
+}
+
+/// Computes the exclusive scan of [first, last) with \p binary_op starting
+/// with \p init and writes it to \p result on the device of the queue \p q.
+///
+/// \return an event representing the scan.
+template <typename T, class BinaryOperation>
+event exclusive_scan(queue &q, const T *first, const T *last, T *result,
+                     typename std::remove_cv<T>::type init,
+                     BinaryOperation binary_op) {
+  return detail::scan</*IsInclusive=*/false>(q, first, last, result, init,
+                                             binary_op);
+}
+
+/// Computes the exclusive scan of [first, last) with \p binary_op and writes
+/// it to \p result on the device of the queue \p q.
+///
+/// \return an event representing the scan.
+template <typename T, class BinaryOperation>
+event exclusive_scan(queue &q, const T *first, const T *last, T *result,
+                     BinaryOperation binary_op) {
+  return detail::scan</*IsInclusive=*/false>(
+      q, first, last, result,
+      sycl::detail::identity<T, BinaryOperation>::value, binary_op);
+}
+
+/// Counts the elements of [first, last) falling into each of \p num_bins
+/// bins of equal width covering [lower, upper), and adds the counts to
+/// \p bins. The elements outside of [lower, upper) are not counted.
+///
+/// The work-groups count the elements in local memory and merge their counts
+/// to \p bins at the end, unless the bins don't fit the local memory.
+///
+/// \return an event representing the computation.
+template <typename T>
+event histogram(queue &q, const T *first, const T *last, uint32_t *bins,
+                size_t num_bins, T lower, T upper) {
+  size_t N = last - first;
+  if (N == 0 || num_bins == 0 || !(lower < upper))
+    return event();
+  size_t LocalMemSize =
+      q.get_device().get_info<info::device::local_mem_size>();
+  // Leave a half of local memory to the implementation of the kernel.
+  if (num_bins * sizeof(uint32_t) <= LocalMemSize / 2)
+    return detail::histogramImpl</*UseLocalBins=*/true>(q, first, N, bins,
+                                                        num_bins, lower, upper);
+  return detail::histogramImpl</*UseLocalBins=*/false>(q, first, N, bins,
+                                                       num_bins, lower, upper);
+}
+
+/// Sorts the \p n integral keys \p keys in ascending order together with
+/// the values \p values on the device of the queue \p q. The sort is stable.
+///
+/// This is a least significant digit radix sort. Every pass counts the digits
+/// in each work-group, scans the counts to get the position of every digit of
+/// every work-group, and moves the keys and the values to their positions.
+/// The keys and values are moved between the given arrays and the temporary
+/// ones, and the result ends in the given arrays.
+///
+/// \return an event representing the sort.
+template <typename KeyT, typename ValueT>
+event radix_sort_by_key(queue &q, KeyT *keys, ValueT *values, size_t n) {
+  static_assert(std::is_integral<KeyT>::value &&
+                    !std::is_same<KeyT, bool>::value,
+                "Only integral keys are supported by radix_sort_by_key");
+  constexpr int NumBuckets = detail::radix_sort_buckets;
+  constexpr int NumPasses = sizeof(KeyT) * 8 / detail::radix_sort_bits;
+  static_assert(NumPasses % 2 == 0, "The result must end in the input arrays");
+  if (n == 0)
+    return event();
+  if (n > (std::numeric_limits<uint32_t>::max)())
+    throw runtime_error("Too many elements for radix_sort_by_key",
+                        PI_INVALID_VALUE);
+
+  // The work-groups handle contiguous chunks of elements, the chunks are
+  // multiples of the work-group size.
+  size_t WGSize = detail::getAlgorithmWGSize(q);
+  size_t NumWGs = (std::min)((n + WGSize - 1) / WGSize,
+                             detail::algorithm_wg_size * 4);
+  size_t Chunk = ((n + NumWGs - 1) / NumWGs + WGSize - 1) / WGSize * WGSize;
+  NumWGs = (n + Chunk - 1) / Chunk;
+  size_t NumCounts = NumBuckets * NumWGs;
+
+  KeyT *TmpKeys = malloc_device<KeyT>(n, q);
+  ValueT *TmpValues = malloc_device<ValueT>(n, q);
+  uint32_t *Counts = malloc_device<uint32_t>(NumCounts, q);
+  uint32_t *Offsets = malloc_device<uint32_t>(NumCounts, q);
+  if (!TmpKeys || !TmpValues || !Counts || !Offsets) {
+    context Ctx = q.get_context();
+    free(TmpKeys, Ctx);
+    free(TmpValues, Ctx);
+    free(Counts, Ctx);
+    free(Offsets, Ctx);
+    throw runtime_error("Not enough memory for radix_sort_by_key",
+                        PI_OUT_OF_RESOURCES);
+  }
+  detail::scan_state<uint32_t> ScanState(q, NumCounts);
+
+  event Event;
+  for (int Pass = 0; Pass < NumPasses; ++Pass) {
+    KeyT *SrcKeys = Pass % 2 ? TmpKeys : keys;
+    KeyT *DstKeys = Pass % 2 ? keys : TmpKeys;
+    ValueT *SrcValues = Pass % 2 ? TmpValues : values;
+    ValueT *DstValues = Pass % 2 ? values : TmpValues;
+
+    // Count the digits of every work-group. Counts[D * NumWGs + WG] holds
+    // the number of the digits D in the chunk of the work-group WG, so that
+    // the exclusive scan of Counts gives the positions of the chunks' digits.
+    event CountEvent = q.submit([&](handler &CGH) {
+      CGH.depends_on(Event);
+      accessor<uint32_t, 1, access::mode::read_write, access::target::local>
+          LocalCounts(NumBuckets, CGH);
+      CGH.parallel_for<detail::__sycl_radix_sort_count_kernel<KeyT>>(
+          nd_range<1>(NumWGs * WGSize, WGSize), [=](nd_item<1> NDIt) {
+            size_t LID = NDIt.get_local_linear_id();
+            size_t WG = NDIt.get_group_linear_id();
+            if (LID < NumBuckets)
+              LocalCounts[LID] = 0;
+            NDIt.barrier(access::fence_space::local_space);
+            size_t End = (std::min)(n, (WG + 1) * Chunk);
+            for (size_t I = WG * Chunk + LID; I < End; I += WGSize)
+              atomic_ref<uint32_t, memory_order::relaxed,
+                         memory_scope::work_group,
+                         access::address_space::local_space>(
+                  LocalCounts[detail::getRadixDigit(SrcKeys[I], Pass)])
+                  .fetch_add(1);
+            NDIt.barrier(access::fence_space::local_space);
+            if (LID < NumBuckets)
+              Counts[LID * NumWGs + WG] = LocalCounts[LID];
+          });
+    });
+
+    event ScanEvent = detail::scanImpl</*IsInclusive=*/false>(
+        q, Counts, NumCounts, Offsets, 0u, ONEAPI::plus<uint32_t>(),
+        ScanState, {CountEvent});
+
+    // Move the elements to their positions. The elements of a chunk are
+    // processed in blocks of the work-group size in order. The rank of an
+    // element among the elements of the block with the same digit is found
+    // by the scans of the per-digit flags packed to 16-bit fields, four
+    // digits per scan.
+    Event = q.submit([&](handler &CGH) {
+      CGH.depends_on(ScanEvent);
+      CGH.parallel_for<detail::__sycl_radix_sort_scatter_kernel<KeyT, ValueT>>(
+          nd_range<1>(NumWGs * WGSize, WGSize), [=](nd_item<1> NDIt) {
+            constexpr int DigitsPerWord = 4;
+            constexpr int FieldBits = 16;
+            group<1> G = NDIt.get_group();
+            size_t LID = NDIt.get_local_linear_id();
+            size_t WG = NDIt.get_group_linear_id();
+            uint32_t Positions[NumBuckets];
+            for (int D = 0; D < NumBuckets; ++D)
+              Positions[D] = Offsets[D * NumWGs + WG];
+
+            size_t Begin = WG * Chunk;
+            size_t End = (std::min)(n, Begin + Chunk);
+            for (size_t Block = Begin; Block < Begin + Chunk;
+                 Block += WGSize) {
+              size_t I = Block + LID;
+              bool IsValid = I < End;
+              KeyT Key{};
+              uint32_t Digit = 0;
+              if (IsValid) {
+                Key = SrcKeys[I];
+                Digit = detail::getRadixDigit(Key, Pass);
+              }
+              uint32_t Position = 0;
+              for (int W = 0; W < NumBuckets / DigitsPerWord; ++W) {
+                bool IsMine = IsValid && Digit / DigitsPerWord == W;
+                int Shift = static_cast<int>(Digit % DigitsPerWord) * FieldBits;
+                uint64_t Flag = IsMine ? uint64_t(1) << Shift : 0;
+                uint64_t Ranks =
+                    exclusive_scan(G, Flag, ONEAPI::plus<uint64_t>());
+                uint64_t Totals = broadcast(G, Ranks + Flag, WGSize - 1);
+                if (IsMine)
+                  Position = Positions[Digit] +
+                             static_cast<uint32_t>((Ranks >> Shift) & 0xFFFF);
+                for (int D = 0; D < DigitsPerWord; ++D)
+                  Positions[W * DigitsPerWord + D] += static_cast<uint32_t>(
+                      (Totals >> (D * FieldBits)) & 0xFFFF);
+              }
+              if (IsValid) {
+                DstKeys[Position] = Key;
+                DstValues[Position] = SrcValues[I];
+              }
+            }
+          });
+    });
+  }
+
+  return detail::freeAfter(q, Event, TmpKeys, TmpValues, Counts, Offsets,
+                           ScanState.Flags, ScanState.Aggregates,
+                           ScanState.Prefixes);
+}
+
+} // namespace ONEAPI
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
+#endif // __DISABLE_SYCL_ONEAPI_GROUP_ALGORITHMS__
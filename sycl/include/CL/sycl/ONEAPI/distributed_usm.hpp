@@ -0,0 +1,59 @@
+//==------ distributed_usm.hpp --- SYCL USM striped across the devices -----==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl/context.hpp>
+#include <CL/sycl/detail/export.hpp>
+
+#include <cstddef>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace ONEAPI {
+
+// This is a preview extension implementation, intended to provide early
+// access to a feature for review and community feedback.
+//
+// Because the interfaces defined by this header file are not final and are
+// subject to change they are not intended to be used by shipping software
+// products. If you are interested in using this feature in your software
+// product, please let us know!
+
+/// The default size of the stripes of the distributed allocations.
+constexpr size_t default_stripe_size = 2 * 1024 * 1024;
+
+/// \brief allocates shared memory striped across the devices of the context.
+///
+/// The stripes of StripeSize bytes are placed on the devices of the context
+/// in turn: the first stripe on the first device, the second stripe on the
+/// second one, and so on. Kernels submitted to each device which touch the
+/// stripes of that device use its local memory, so one allocation uses the
+/// bandwidth of all the devices, e.g. of all the tiles of a GPU.
+///
+/// The stripe size should be a multiple of the page size of the devices.
+/// The allocation is a regular shared allocation on the first device of the
+/// context if the backend can't place the stripes, or if the context has a
+/// single device. It is freed by sycl::free; get_pointer_device can't tell
+/// the device of a distributed allocation.
+///
+/// \return the allocation, or nullptr if it fails.
+__SYCL_EXPORT void *malloc_shared_distributed(
+    size_t Size, const context &Ctxt,
+    size_t StripeSize = default_stripe_size);
+
+template <typename T>
+T *malloc_shared_distributed(size_t Count, const context &Ctxt,
+                             size_t StripeSize = default_stripe_size) {
+  return static_cast<T *>(
+      malloc_shared_distributed(Count * sizeof(T), Ctxt, StripeSize));
+}
+
+} // namespace ONEAPI
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -0,0 +1,202 @@
+//==------------- matrix.hpp - SYCL joint matrix extension ----------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/__spirv/spirv_ops.hpp>
+#include <CL/sycl/ONEAPI/sub_group.hpp>
+#include <CL/sycl/detail/defines.hpp>
+#include <CL/sycl/exception.hpp>
+#include <CL/sycl/half_type.hpp>
+#include <CL/sycl/multi_ptr.hpp>
+
+#include <cstddef>
+#include <type_traits>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace ONEAPI {
+namespace experimental {
+namespace matrix {
+
+// The values match __spv::MatrixLayout.
+enum class matrix_layout {
+  row_major = 0,
+  col_major = 1,
+  packed_a = 2,
+  packed_b = 3
+};
+
+// A NumRows x NumCols matrix of T jointly held by the work-items of a group.
+// Each work-item holds an unspecified part of the matrix, so it can only be
+// accessed through joint_matrix_load, joint_matrix_store and joint_matrix_mad,
+// which all work-items of the group must call with the same arguments.
+//
+// On the Intel GPU path the operations map onto the SPV_INTEL_joint_matrix
+// instructions. On the CUDA path they map onto the wmma PTX instructions,
+// which support 16x16x16 products of half matrices accumulated into float
+// ones; there the left operand of joint_matrix_mad is a half matrix with a
+// row_major or col_major layout and the right operand a packed_b one.
+template <typename T, size_t NumRows, size_t NumCols,
+          matrix_layout Layout = matrix_layout::row_major,
+          typename Group = ONEAPI::sub_group>
+struct joint_matrix {
+  static_assert(std::is_same<Group, ONEAPI::sub_group>::value,
+                "joint_matrix is only supported at sub-group scope");
+
+#if defined(__SYCL_DEVICE_ONLY__) && defined(__NVPTX__)
+  static_assert(NumRows == 16 && NumCols == 16,
+                "only 16x16 matrices are supported on CUDA");
+  static_assert(std::is_same<T, half>::value || std::is_same<T, float>::value,
+                "only half and float matrices are supported on CUDA");
+
+  // A wmma fragment: pairs of half elements or single float elements.
+  typename std::conditional<std::is_same<T, half>::value, int32_t, float>::type
+      Fragment[8];
+  // Whether the fragment was loaded from a column-major matrix.
+  bool ColMajor = false;
+#elif defined(__SYCL_DEVICE_ONLY__)
+  __spv::__spirv_JointMatrixINTEL<T, NumRows, NumCols,
+                                  static_cast<__spv::MatrixLayout>(Layout)>
+      *spvm;
+#endif
+
+  joint_matrix(Group) {}
+};
+
+namespace detail {
+
+#ifndef __SYCL_DEVICE_ONLY__
+[[noreturn]] inline void throwJointMatrixOnHost() {
+  throw runtime_error("joint_matrix is not supported on host device.",
+                      PI_INVALID_DEVICE);
+}
+#endif
+
+} // namespace detail
+
+// Loads the matrix at Src, whose rows (columns if MemLayout is col_major) are
+// Stride elements apart, into Res.
+template <typename Group, typename T, size_t NumRows, size_t NumCols,
+          matrix_layout Layout, access::address_space Space>
+void joint_matrix_load(Group,
+                       joint_matrix<T, NumRows, NumCols, Layout, Group> &Res,
+                       multi_ptr<T, Space> Src, size_t Stride,
+                       matrix_layout MemLayout) {
+#if defined(__SYCL_DEVICE_ONLY__) && defined(__NVPTX__)
+  const T *Ptr = Src.get();
+  Res.ColMajor = MemLayout == matrix_layout::col_major;
+  if constexpr (std::is_same<T, float>::value) {
+    if (Res.ColMajor)
+      __hmma_m16n16k16_ld_c_f32(Res.Fragment, Ptr, Stride, 1);
+    else
+      __hmma_m16n16k16_ld_c_f32(Res.Fragment, Ptr, Stride, 0);
+  } else if constexpr (Layout == matrix_layout::packed_b) {
+    const int32_t *IPtr = reinterpret_cast<const int32_t *>(Ptr);
+    if (Res.ColMajor)
+      __hmma_m16n16k16_ld_b(Res.Fragment, IPtr, Stride, 1);
+    else
+      __hmma_m16n16k16_ld_b(Res.Fragment, IPtr, Stride, 0);
+  } else {
+    const int32_t *IPtr = reinterpret_cast<const int32_t *>(Ptr);
+    if (Res.ColMajor)
+      __hmma_m16n16k16_ld_a(Res.Fragment, IPtr, Stride, 1);
+    else
+      __hmma_m16n16k16_ld_a(Res.Fragment, IPtr, Stride, 0);
+  }
+#elif defined(__SYCL_DEVICE_ONLY__)
+  T *Ptr = Src.get();
+  Res.spvm = __spirv_JointMatrixLoadINTEL<
+      T, NumRows, NumCols, static_cast<__spv::MatrixLayout>(Layout)>(
+      Ptr, Stride, static_cast<__spv::MatrixLayout>(MemLayout));
+#else
+  (void)Res;
+  (void)Src;
+  (void)Stride;
+  (void)MemLayout;
+  detail::throwJointMatrixOnHost();
+#endif
+}
+
+// Stores Src to the matrix at Dst, whose rows (columns if MemLayout is
+// col_major) are Stride elements apart.
+template <typename Group, typename T, size_t NumRows, size_t NumCols,
+          matrix_layout Layout, access::address_space Space>
+void joint_matrix_store(Group,
+                        joint_matrix<T, NumRows, NumCols, Layout, Group> &Src,
+                        multi_ptr<T, Space> Dst, size_t Stride,
+                        matrix_layout MemLayout) {
+#if defined(__SYCL_DEVICE_ONLY__) && defined(__NVPTX__)
+  static_assert(std::is_same<T, float>::value,
+                "only float matrices can be stored on CUDA");
+  T *Ptr = Dst.get();
+  if (MemLayout == matrix_layout::col_major)
+    __hmma_m16n16k16_st_c_f32(Ptr, Src.Fragment, Stride, 1);
+  else
+    __hmma_m16n16k16_st_c_f32(Ptr, Src.Fragment, Stride, 0);
+#elif defined(__SYCL_DEVICE_ONLY__)
+  T *Ptr = Dst.get();
+  __spirv_JointMatrixStoreINTEL<T, NumRows, NumCols,
+                                static_cast<__spv::MatrixLayout>(Layout)>(
+      Ptr, Src.spvm, Stride, static_cast<__spv::MatrixLayout>(MemLayout));
+#else
+  (void)Src;
+  (void)Dst;
+  (void)Stride;
+  (void)MemLayout;
+  detail::throwJointMatrixOnHost();
+#endif
+}
+
+// Returns A * B + C.
+template <typename Group, typename TA, typename TB, typename TC, size_t M,
+          size_t K, size_t N, matrix_layout LayoutA, matrix_layout LayoutB,
+          matrix_layout LayoutC>
+joint_matrix<TC, M, N, LayoutC, Group>
+joint_matrix_mad(Group Sg, joint_matrix<TA, M, K, LayoutA, Group> &A,
+                 joint_matrix<TB, K, N, LayoutB, Group> &B,
+                 joint_matrix<TC, M, N, LayoutC, Group> &C) {
+  joint_matrix<TC, M, N, LayoutC, Group> Res(Sg);
+#if defined(__SYCL_DEVICE_ONLY__) && defined(__NVPTX__)
+  static_assert(std::is_same<TA, half>::value &&
+                    std::is_same<TB, half>::value &&
+                    std::is_same<TC, float>::value,
+                "only half x half + float products are supported on CUDA");
+  static_assert(LayoutA != matrix_layout::packed_b &&
+                    LayoutB == matrix_layout::packed_b,
+                "the right operand must be a packed_b matrix on CUDA");
+  // The fragments must be combined in the memory layouts they were loaded
+  // from: row.row, row.col, col.row or col.col.
+  if (!A.ColMajor && !B.ColMajor)
+    __hmma_m16n16k16_mma_f32f32(Res.Fragment, A.Fragment, B.Fragment,
+                                C.Fragment, 0, 0);
+  else if (!A.ColMajor)
+    __hmma_m16n16k16_mma_f32f32(Res.Fragment, A.Fragment, B.Fragment,
+                                C.Fragment, 1, 0);
+  else if (!B.ColMajor)
+    __hmma_m16n16k16_mma_f32f32(Res.Fragment, A.Fragment, B.Fragment,
+                                C.Fragment, 2, 0);
+  else
+    __hmma_m16n16k16_mma_f32f32(Res.Fragment, A.Fragment, B.Fragment,
+                                C.Fragment, 3, 0);
+#elif defined(__SYCL_DEVICE_ONLY__)
+  Res.spvm = __spirv_JointMatrixMadINTEL(A.spvm, B.spvm, C.spvm);
+#else
+  (void)A;
+  (void)B;
+  (void)C;
+  detail::throwJointMatrixOnHost();
+#endif
+  return Res;
+}
+
+} // namespace matrix
+} // namespace experimental
+} // namespace ONEAPI
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -0,0 +1,75 @@
+//==--- specialized_kernel.hpp --- SYCL kernels specialized at launch time -==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl/ONEAPI/experimental/spec_constant.hpp>
+#include <CL/sycl/context.hpp>
+#include <CL/sycl/kernel.hpp>
+#include <CL/sycl/program.hpp>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace ONEAPI {
+namespace experimental {
+
+// This is a preview extension implementation, intended to provide early
+// access to a feature for review and community feedback.
+//
+// Because the interfaces defined by this header file are not final and are
+// subject to change they are not intended to be used by shipping software
+// products. If you are interested in using this feature in your software
+// product, please let us know!
+
+/// \brief the kernel KernelName built with the values of its launch
+/// constants, e.g. the sizes and the strides of the data it processes.
+///
+/// The launch constants are specialization constants: the device compiler
+/// folds their values into the code when the kernel is built, so the loops
+/// bounded by them can be unrolled. The builds are kept in the program cache
+/// of the context and keyed by the values, so the kernels specialized with
+/// the same values are only built once, see SYCL_CACHE_MAX_SPECIALIZED_BUILDS.
+///
+/// \code
+///   specialized_kernel<class Scale> Specialized(Q.get_context());
+///   auto N = Specialized.specialize<class Size>(Size);
+///   Q.submit([&](handler &CGH) {
+///     CGH.single_task<class Scale>(Specialized.get_kernel(), [=]() {
+///       for (int I = 0; I < N.get(); ++I)
+///         Ptr[I] *= 2;
+///     });
+///   });
+/// \endcode
+template <typename KernelName> class specialized_kernel {
+public:
+  explicit specialized_kernel(const context &Context) : MProgram(Context) {}
+
+  /// Sets the value of the launch constant ID. Must be called before
+  /// get_kernel().
+  /// \return the launch constant to be captured by the kernel.
+  template <typename ID, typename T> spec_constant<T, ID> specialize(T Value) {
+    return MProgram.set_spec_constant<ID>(Value);
+  }
+
+  /// \return the kernel specialized with the values set, which can be passed
+  /// to the kernel invocations of handler. The kernel is built on the first
+  /// call, unless the program cache has a build with the same values.
+  kernel get_kernel() {
+    if (MProgram.get_state() == program_state::none)
+      MProgram.build_with_kernel_type<KernelName>();
+    return MProgram.get_kernel<KernelName>();
+  }
+
+private:
+  program MProgram;
+};
+
+} // namespace experimental
+} // namespace ONEAPI
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -145,6 +145,66 @@ Function for_each(Group g, Ptr first, Ptr last, Function f) {
 #endif
 }
 
+// The number of elements a work-item keeps in registers at once in the
+// algorithms over ranges: the length of the tiles scanned by a work-item, and
+// the number of elements loaded by one sub-group block read.
+constexpr int joint_tile_size = 4;
+
+// Combines the elements of [first, last) assigned to the work-item into
+// partial.
+template <typename Group, typename Ptr, typename T, class BinaryOperation>
+T joint_partial_reduce(Group g, Ptr first, Ptr last, T partial,
+                       BinaryOperation binary_op) {
+  for_each(g, first, last, [&](const typename remove_pointer<Ptr>::type &x) {
+    partial = binary_op(partial, x);
+  });
+  return partial;
+}
+
+// Sub-groups read the contiguous elements of global memory with block reads,
+// joint_tile_size elements per work-item at once.
+template <typename ElemT, typename T, class BinaryOperation>
+enable_if_t<sub_group::AcceptableForGlobalLoadStore<
+                ElemT, access::address_space::global_space>::value,
+            T>
+joint_partial_reduce(
+    ONEAPI::sub_group g,
+    multi_ptr<ElemT, access::address_space::global_space> first,
+    multi_ptr<ElemT, access::address_space::global_space> last, T partial,
+    BinaryOperation binary_op) {
+#ifdef __SYCL_DEVICE_ONLY__
+  auto combine = [&](const ElemT &x) { partial = binary_op(partial, x); };
+  // Block reads need all work-items of the sub-group and aligned addresses.
+  // The conditions are uniform over the sub-group.
+  ptrdiff_t sg_size = g.get_max_local_range()[0];
+  if (static_cast<ptrdiff_t>(g.get_local_range()[0]) == sg_size) {
+    constexpr uintptr_t alignment = 16;
+    auto aligned = first;
+    while (aligned < last &&
+           reinterpret_cast<uintptr_t>(aligned.get()) % alignment != 0)
+      ++aligned;
+    for_each(g, first, aligned, combine);
+    first = aligned;
+    for (; last - first >= joint_tile_size * sg_size;
+         first += joint_tile_size * sg_size) {
+      vec<ElemT, joint_tile_size> x = g.load<joint_tile_size>(first);
+      for (int j = 0; j < joint_tile_size; ++j)
+        partial = binary_op(partial, x[j]);
+    }
+  }
+  for_each(g, first, last, combine);
+  return partial;
+#else
+  (void)g;
+  (void)first;
+  (void)last;
+  (void)partial;
+  (void)binary_op;
+  throw runtime_error("Group algorithms are not supported on host device.",
+                      PI_INVALID_DEVICE);
+#endif
+}
+
 } // namespace detail
 
 namespace ONEAPI {
@@ -558,8 +618,8 @@ reduce(Group g, Ptr first, Ptr last, BinaryOperation binary_op) {
 #ifdef __SYCL_DEVICE_ONLY__
   typename Ptr::element_type partial =
       sycl::detail::identity<T, BinaryOperation>::value;
-  sycl::detail::for_each(g, first, last,
-                         [&](const T &x) { partial = binary_op(partial, x); });
+  partial = sycl::detail::joint_partial_reduce(g, first, last, partial,
+                                               binary_op);
   return reduce(g, partial, binary_op);
 #else
   (void)g;
@@ -588,10 +648,8 @@ reduce(Group g, Ptr first, Ptr last, T init, BinaryOperation binary_op) {
       "Result type of binary_op must match reduction accumulation type.");
 #ifdef __SYCL_DEVICE_ONLY__
   T partial = sycl::detail::identity<T, BinaryOperation>::value;
-  sycl::detail::for_each(
-      g, first, last, [&](const typename detail::remove_pointer<Ptr>::type &x) {
-        partial = binary_op(partial, x);
-      });
+  partial = sycl::detail::joint_partial_reduce(g, first, last, partial,
+                                               binary_op);
   return reduce(g, partial, init, binary_op);
 #else
   (void)g;
@@ -716,25 +774,32 @@ exclusive_scan(Group g, InPtr first, InPtr last, OutPtr result, T init,
            std::is_same<decltype(binary_op(*first, *first)), float>::value),
       "Result type of binary_op must match scan accumulation type.");
 #ifdef __SYCL_DEVICE_ONLY__
+  // Every work-item scans a tile of contiguous elements in registers, so
+  // only the sums of the tiles are scanned over the group.
+  constexpr ptrdiff_t tile_size = sycl::detail::joint_tile_size;
   ptrdiff_t offset = sycl::detail::get_local_linear_id(g);
   ptrdiff_t stride = sycl::detail::get_local_linear_range(g);
   ptrdiff_t N = last - first;
-  auto roundup = [=](const ptrdiff_t &v,
-                     const ptrdiff_t &divisor) -> ptrdiff_t {
-    return ((v + divisor - 1) / divisor) * divisor;
-  };
-  typename InPtr::element_type x;
-  typename OutPtr::element_type carry = init;
-  for (ptrdiff_t chunk = 0; chunk < roundup(N, stride); chunk += stride) {
-    ptrdiff_t i = chunk + offset;
-    if (i < N) {
-      x = first[i];
+  using OutT = typename OutPtr::element_type;
+  OutT carry = init;
+  for (ptrdiff_t chunk = 0; chunk < N; chunk += stride * tile_size) {
+    ptrdiff_t tile = chunk + offset * tile_size;
+    typename InPtr::element_type x[tile_size];
+    OutT tile_sum = sycl::detail::identity<OutT, BinaryOperation>::value;
+    for (ptrdiff_t j = 0; j < tile_size; ++j) {
+      if (tile + j < N) {
+        x[j] = first[tile + j];
+        tile_sum = binary_op(tile_sum, x[j]);
+      }
     }
-    typename OutPtr::element_type out = exclusive_scan(g, x, carry, binary_op);
-    if (i < N) {
-      result[i] = out;
+    OutT out = exclusive_scan(g, tile_sum, carry, binary_op);
+    for (ptrdiff_t j = 0; j < tile_size; ++j) {
+      if (tile + j < N) {
+        result[tile + j] = out;
+        out = binary_op(out, x[j]);
+      }
     }
-    carry = broadcast(g, binary_op(out, x), stride - 1);
+    carry = broadcast(g, out, stride - 1);
   }
   return result + N;
 #else
@@ -880,23 +945,30 @@ inclusive_scan(Group g, InPtr first, InPtr last, OutPtr result,
            std::is_same<decltype(binary_op(init, *first)), float>::value),
       "Result type of binary_op must match scan accumulation type.");
 #ifdef __SYCL_DEVICE_ONLY__
+  // Every work-item scans a tile of contiguous elements in registers, so
+  // only the sums of the tiles are scanned over the group.
+  constexpr ptrdiff_t tile_size = sycl::detail::joint_tile_size;
   ptrdiff_t offset = sycl::detail::get_local_linear_id(g);
   ptrdiff_t stride = sycl::detail::get_local_linear_range(g);
   ptrdiff_t N = last - first;
-  auto roundup = [=](const ptrdiff_t &v,
-                     const ptrdiff_t &divisor) -> ptrdiff_t {
-    return ((v + divisor - 1) / divisor) * divisor;
-  };
-  typename InPtr::element_type x;
-  typename OutPtr::element_type carry = init;
-  for (ptrdiff_t chunk = 0; chunk < roundup(N, stride); chunk += stride) {
-    ptrdiff_t i = chunk + offset;
-    if (i < N) {
-      x = first[i];
+  using OutT = typename OutPtr::element_type;
+  OutT carry = init;
+  for (ptrdiff_t chunk = 0; chunk < N; chunk += stride * tile_size) {
+    ptrdiff_t tile = chunk + offset * tile_size;
+    typename InPtr::element_type x[tile_size];
+    OutT tile_sum = sycl::detail::identity<OutT, BinaryOperation>::value;
+    for (ptrdiff_t j = 0; j < tile_size; ++j) {
+      if (tile + j < N) {
+        x[j] = first[tile + j];
+        tile_sum = binary_op(tile_sum, x[j]);
+      }
     }
-    typename OutPtr::element_type out = inclusive_scan(g, x, binary_op, carry);
-    if (i < N) {
-      result[i] = out;
+    OutT out = exclusive_scan(g, tile_sum, carry, binary_op);
+    for (ptrdiff_t j = 0; j < tile_size; ++j) {
+      if (tile + j < N) {
+        out = binary_op(out, x[j]);
+        result[tile + j] = out;
+      }
     }
     carry = broadcast(g, out, stride - 1);
   }
@@ -0,0 +1,42 @@
+//==------- half_conversions.hpp --- SYCL host conversions of halfs --------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl/aliases.hpp>
+#include <CL/sycl/detail/defines.hpp>
+#include <CL/sycl/detail/export.hpp>
+
+#include <cstddef>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace ONEAPI {
+
+// This is a preview extension implementation, intended to provide early
+// access to a feature for review and community feedback.
+//
+// Because the interfaces defined by this header file are not final and are
+// subject to change they are not intended to be used by shipping software
+// products. If you are interested in using this feature in your software
+// product, please let us know!
+
+/// Converts the \p Count floats of \p Src to the halfs of \p Dst on the host,
+/// rounding to the nearest even half.
+///
+/// The values are converted several at a time by the vector conversion
+/// instructions of the processor, if it has them, e.g. F16C on x86.
+__SYCL_EXPORT void convert_to_half(const float *Src, half *Dst, size_t Count);
+
+/// Converts the \p Count halfs of \p Src to the floats of \p Dst on the host.
+__SYCL_EXPORT void convert_from_half(const half *Src, float *Dst,
+                                     size_t Count);
+
+} // namespace ONEAPI
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -0,0 +1,69 @@
+//==------- kernel_fusion.hpp --- SYCL kernel fusion of command groups -----==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl/detail/export.hpp>
+#include <CL/sycl/event.hpp>
+#include <CL/sycl/queue.hpp>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace ONEAPI {
+
+// This is a preview extension implementation, intended to provide early
+// access to a feature for review and community feedback.
+//
+// Because the interfaces defined by this header file are not final and are
+// subject to change they are not intended to be used by shipping software
+// products. If you are interested in using this feature in your software
+// product, please let us know!
+
+/// \brief collects the command groups submitted to a queue, so that they are
+/// submitted together as a single fused command group.
+///
+/// Between start_fusion and complete_fusion the command groups submitted to
+/// the queue are kept by the runtime instead of being executed. The events
+/// returned for them may only be used as dependencies of the other command
+/// groups of the fusion; complete_fusion returns the event which stands for
+/// all of them.
+///
+/// The runtime does not generate fused device code yet: complete_fusion
+/// submits the collected command groups in order, with their dependencies on
+/// each other, so the result is the same as without the fusion.
+class __SYCL_EXPORT fusion_wrapper {
+public:
+  explicit fusion_wrapper(queue &Queue);
+
+  queue get_queue() const;
+
+  /// \return true if the command groups submitted to the queue are collected.
+  bool is_in_fusion_mode() const;
+
+  /// Starts collecting the command groups submitted to the queue.
+  ///
+  /// \throw runtime_error if the queue is already in fusion mode.
+  /// \throw feature_not_supported if the queue is a host queue.
+  void start_fusion();
+
+  /// Submits the collected command groups without fusing them and leaves the
+  /// fusion mode.
+  void cancel_fusion();
+
+  /// Submits the collected command groups as one and leaves the fusion mode.
+  ///
+  /// \return an event representing the execution of all the command groups.
+  event complete_fusion();
+
+private:
+  queue MQueue;
+};
+
+} // namespace ONEAPI
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -0,0 +1,66 @@
+//==---------- kernel_stats.hpp --- SYCL per-kernel execution statistics ---==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl/ONEAPI/submit_latency.hpp>
+#include <CL/sycl/detail/defines_elementary.hpp>
+#include <CL/sycl/detail/export.hpp>
+#include <CL/sycl/stl.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace ONEAPI {
+
+// This is a preview extension implementation, intended to provide early
+// access to a feature for review and community feedback.
+//
+// Because the interfaces defined by this header file are not final and are
+// subject to change they are not intended to be used by shipping software
+// products. If you are interested in using this feature in your software
+// product, please let us know!
+
+/// The execution statistics of a kernel on a device, aggregated over its
+/// launches by the SYCL runtime.
+struct kernel_stats {
+  string_class kernel_name;
+  string_class device_name;
+  std::size_t launch_count;
+  /// The device execution times of the sampled launches, in nanoseconds. The
+  /// count is the number of sampled launches which have completed.
+  submit_latency device_time;
+  /// The total time spent setting the arguments of the launches.
+  std::uint64_t arg_setup_ns;
+  /// The total time spent getting the kernel for the launches, which includes
+  /// building its program when it is not in the cache.
+  std::uint64_t build_ns;
+};
+
+/// \returns true if the SYCL runtime collects the kernel statistics.
+///
+/// The statistics are collected when the SYCL_KERNEL_STATS environment
+/// variable is set. The queues are then created with profiling enabled, and
+/// the device time of one launch in SYCL_KERNEL_STATS_SAMPLING, 1 by default,
+/// of each kernel is measured.
+__SYCL_EXPORT bool is_kernel_stats_enabled();
+
+/// \returns the statistics of every kernel launched on a device so far, by
+/// decreasing total device time, or nothing if the statistics are not
+/// collected.
+__SYCL_EXPORT vector_class<kernel_stats> get_kernel_stats();
+
+/// Drops the statistics collected so far. The launches running during the
+/// reset may be partially dropped.
+__SYCL_EXPORT void reset_kernel_stats();
+
+} // namespace ONEAPI
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -0,0 +1,57 @@
+//==-------- memory_usage.hpp --- SYCL memory usage of a context -----------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl/detail/defines.hpp>
+
+#include <cstddef>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace ONEAPI {
+
+// This is a preview extension implementation, intended to provide early
+// access to a feature for review and community feedback.
+//
+// Because the interfaces defined by this header file are not final and are
+// subject to change they are not intended to be used by shipping software
+// products. If you are interested in using this feature in your software
+// product, please let us know!
+
+/// The memory a context holds through the runtime, in bytes, as returned by
+/// context::get_info<info::context::ext_oneapi_memory_usage>().
+///
+/// The buffers include the buffers of the streams and the scratch buffers of
+/// the reductions. The memory provided by the user, e.g. through the host
+/// pointer of a buffer, isn't counted.
+struct memory_usage {
+  /// Device allocations of the buffers.
+  size_t buffers = 0;
+  /// Device allocations of the images.
+  size_t images = 0;
+  /// Allocations of sycl::malloc_device and the like.
+  size_t usm_device = 0;
+  /// Allocations of sycl::malloc_host and the like.
+  size_t usm_host = 0;
+  /// Allocations of sycl::malloc_shared and the like.
+  size_t usm_shared = 0;
+  /// USM host blocks freed by the user and kept by the runtime for reuse.
+  size_t cached = 0;
+  /// The sum of all the above.
+  size_t total = 0;
+  /// The largest size of the allocations in use, i.e. of the total without
+  /// the cached blocks, since the context has been created.
+  size_t peak = 0;
+  /// The limit set by SYCL_CONTEXT_MEMORY_LIMIT, zero if there is none.
+  size_t limit = 0;
+};
+
+} // namespace ONEAPI
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -0,0 +1,58 @@
+//==----------- prebuild.hpp --- SYCL ahead-of-first-use builds ------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl/context.hpp>
+#include <CL/sycl/detail/export.hpp>
+#include <CL/sycl/device.hpp>
+#include <CL/sycl/stl.hpp>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace ONEAPI {
+
+// This is a preview extension implementation, intended to provide early
+// access to a feature for review and community feedback.
+//
+// Because the interfaces defined by this header file are not final and are
+// subject to change they are not intended to be used by shipping software
+// products. If you are interested in using this feature in your software
+// product, please let us know!
+
+/// \brief starts building the device code of all kernels known to the SYCL
+/// runtime for the given devices of the context.
+///
+/// The builds run in background and the function returns immediately. The
+/// built programs are kept in the program cache of the context, so the first
+/// submission of a kernel to a queue of the context does not wait for its
+/// build. Build failures are not reported by this function: they are reported
+/// when the failed kernel is submitted.
+///
+/// \param Context is the context to build the device code for.
+/// \param Devices is a list of devices of the context.
+__SYCL_EXPORT void prebuild_all(const context &Context,
+                                const vector_class<device> &Devices);
+
+/// \brief starts building the device code of all kernels known to the SYCL
+/// runtime for all devices of the context.
+inline void prebuild_all(const context &Context) {
+  prebuild_all(Context, Context.get_devices());
+}
+
+/// \brief blocks until all builds started by prebuild_all for the context
+/// are finished.
+__SYCL_EXPORT void wait_for_prebuild(const context &Context);
+
+/// \returns true if no builds started by prebuild_all for the context are
+/// in progress.
+__SYCL_EXPORT bool is_prebuild_complete(const context &Context);
+
+} // namespace ONEAPI
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
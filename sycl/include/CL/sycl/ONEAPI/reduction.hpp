@@ -13,6 +13,9 @@
 #include <CL/sycl/accessor.hpp>
 #include <CL/sycl/handler.hpp>
 
+#include <tuple>
+#include <utility>
+
 __SYCL_INLINE_NAMESPACE(cl) {
 namespace sycl {
 namespace ONEAPI {
@@ -339,6 +342,24 @@ public:
   T MValue;
 };
 
+/// Returns a buffer of \p Size bytes from the scratch arena of the queue
+/// \p Queue. The buffer returns to the arena when the returned pointer and all
+/// its copies are destroyed, so the buffers are reused by the reductions
+/// submitted to the same queue later. If \p ZeroInit is true, then the buffer
+/// is filled with zeros and the zeros must be restored before it is released.
+__SYCL_EXPORT shared_ptr_class<buffer<unsigned char, 1>>
+reduGetScratchBuffer(shared_ptr_class<queue_impl> Queue, size_t Size,
+                     bool ZeroInit);
+
+/// Returns \p Size bytes of USM device memory from the scratch arena of the
+/// in-order queue \p Queue, or nullptr if the queue cannot lend it. The memory
+/// returns to the arena when the returned pointer and all its copies are
+/// destroyed. If \p ZeroInit is true, then the memory is filled with zeros
+/// and the zeros must be restored before it is released.
+__SYCL_EXPORT shared_ptr_class<void>
+reduGetUSMScratch(shared_ptr_class<queue_impl> Queue, size_t Size,
+                  bool ZeroInit);
+
 /// This class encapsulates the reduction variable/accessor,
 /// the reduction operator and an optional operator identity.
 template <typename T, class BinaryOperation, int Dims, bool IsUSM,
@@ -501,36 +522,55 @@ public:
                     access::target::local>(Size, CGH);
   }
 
-  accessor<T, buffer_dim, access::mode::read>
-  getReadAccToPreviousPartialReds(handler &CGH) const {
-    CGH.addReduction(MOutBufPtr);
-    return accessor<T, buffer_dim, access::mode::read>(*MOutBufPtr, CGH);
+  /// Borrows a global buffer for \p Size partial sums from the scratch arena
+  /// of the queue and returns an accessor to it.
+  accessor<T, 1, access::mode::discard_read_write,
+           access::target::global_buffer>
+  getPartialSumsAcc(size_t Size, handler &CGH) const {
+    auto ScratchBuf =
+        reduGetScratchBuffer(CGH.MQueue, Size * sizeof(T), /*ZeroInit=*/false);
+    CGH.addReduction(ScratchBuf);
+    auto PartialSumsBuf = std::make_shared<buffer<T, 1>>(
+        ScratchBuf->template reinterpret<T, 1>(range<1>(Size)));
+    CGH.addReduction(PartialSumsBuf);
+    return accessor<T, 1, access::mode::discard_read_write,
+                    access::target::global_buffer>(*PartialSumsBuf, CGH);
   }
 
-  template <access::placeholder _IsPlaceholder = IsPlaceholder>
-  enable_if_t<_IsPlaceholder == access::placeholder::false_t, accessor_type>
-  getWriteAccForPartialReds(size_t Size, handler &CGH) {
-    if (Size == 1)
-      return *MAcc;
+  /// Borrows 1-element global buffer filled with zero from the scratch arena
+  /// of the queue, which counts the work-groups that finished their part of
+  /// the reduction, and returns an accessor to that buffer. The kernel must
+  /// reset the counter to zero when it's done.
+  accessor<int, 1, access::mode::read_write, access::target::global_buffer>
+  getTicketCounterAcc(handler &CGH) const {
+    auto ScratchBuf =
+        reduGetScratchBuffer(CGH.MQueue, sizeof(int), /*ZeroInit=*/true);
+    CGH.addReduction(ScratchBuf);
+    auto CounterBuf = std::make_shared<buffer<int, 1>>(
+        ScratchBuf->template reinterpret<int, 1>(range<1>(1)));
+    CGH.addReduction(CounterBuf);
+    return accessor<int, 1, access::mode::read_write,
+                    access::target::global_buffer>(*CounterBuf, CGH);
+  }
 
-    // Create a new output buffer and return an accessor to it.
-    MOutBufPtr = std::make_shared<buffer<T, buffer_dim>>(range<1>(Size));
-    CGH.addReduction(MOutBufPtr);
-    return accessor_type(*MOutBufPtr, CGH);
+  /// Borrows USM device memory for \p Size partial sums from the scratch arena
+  /// of the queue. \return nullptr if the queue cannot lend USM memory.
+  T *getPartialSumsUSM(size_t Size, handler &CGH) const {
+    auto Scratch =
+        reduGetUSMScratch(CGH.MQueue, Size * sizeof(T), /*ZeroInit=*/false);
+    CGH.addReduction(Scratch);
+    return static_cast<T *>(Scratch.get());
   }
 
-  template <access::placeholder _IsPlaceholder = IsPlaceholder>
-  enable_if_t<_IsPlaceholder == access::placeholder::true_t, accessor_type>
-  getWriteAccForPartialReds(size_t Size, handler &CGH) {
-    if (Size == 1)
-      return *MAcc;
-
-    // Create a new output buffer and return an accessor to it.
-    MOutBufPtr = std::make_shared<buffer<T, buffer_dim>>(range<1>(Size));
-    accessor_type NewAcc(*MOutBufPtr);
-    CGH.addReduction(MOutBufPtr);
-    CGH.require(NewAcc);
-    return NewAcc;
+  /// Borrows USM device memory for the counter of the work-groups, filled
+  /// with zero, from the scratch arena of the queue. The kernel must reset the
+  /// counter to zero when it's done.
+  /// \return nullptr if the queue cannot lend USM memory.
+  int *getTicketCounterUSM(handler &CGH) const {
+    auto Scratch =
+        reduGetUSMScratch(CGH.MQueue, sizeof(int), /*ZeroInit=*/true);
+    CGH.addReduction(Scratch);
+    return static_cast<int *>(Scratch.get());
   }
 
   /// Creates 1-element global buffer initialized with identity value and
@@ -577,8 +617,6 @@ private:
   /// User's accessor to where the reduction must be written.
   shared_ptr_class<accessor_type> MAcc;
 
-  shared_ptr_class<buffer<T, buffer_dim>> MOutBufPtr;
-
   /// USM pointer referencing the memory to where the result of the reduction
   /// must be written. Applicable/used only for USM reductions.
   T *MUSMPointer = nullptr;
@@ -586,29 +624,20 @@ private:
   BinaryOperation MBinaryOp;
 };
 
-/// These are the forward declaration for the classes that help to create
-/// names for additional kernels. It is used only when there are
-/// more then 1 kernels in one parallel_for() implementing SYCL reduction.
+/// This is the forward declaration for the class that helps to create
+/// names for the kernels implementing SYCL reduction.
 template <typename T1, bool B1, bool B2, typename T2>
 class __sycl_reduction_main_kernel;
-template <typename T1, bool B1, bool B2, typename T2>
-class __sycl_reduction_aux_kernel;
 
-/// Helper structs to get additional kernel name types based on given
-/// \c Name and \c Type types: if \c Name is undefined (is a \c auto_name) then
-/// \c Type becomes the \c Name.
+/// Helper struct to get the kernel name type based on given \c Name and
+/// \c Type types: if \c Name is undefined (is a \c auto_name) then \c Type
+/// becomes the \c Name.
 template <typename Name, typename Type, bool B1, bool B2, typename OutputT>
 struct get_reduction_main_kernel_name_t {
   using name = __sycl_reduction_main_kernel<
       typename sycl::detail::get_kernel_name_t<Name, Type>::name, B1, B2,
       OutputT>;
 };
-template <typename Name, typename Type, bool B1, bool B2, typename OutputT>
-struct get_reduction_aux_kernel_name_t {
-  using name = __sycl_reduction_aux_kernel<
-      typename sycl::detail::get_kernel_name_t<Name, Type>::name, B1, B2,
-      OutputT>;
-};
 
 /// Implements a command group function that enqueues a kernel that calls
 /// user's lambda function KernelFunc and also does one iteration of reduction
@@ -718,75 +747,86 @@ reduCGFunc(handler &CGH, KernelType KernelFunc, const nd_range<Dims> &Range,
         CGH, KernelFunc, Range, Redu, Out);
 }
 
-/// Implements a command group function that enqueues a kernel that
-/// calls user's lambda function and does one iteration of reduction
-/// of elements in each of work-groups.
-/// This version uses ONEAPI::reduce() algorithm to reduce elements in each
-/// of work-groups. At the end of each work-groups the partial sum is written
-/// to a global buffer.
-///
-/// Briefly: user's lambda, ONEAPI:reduce(), FP + ADD/MIN/MAX.
-template <typename KernelName, typename KernelType, int Dims, class Reduction,
-          bool IsPow2WG, typename OutputT>
-enable_if_t<Reduction::has_fast_reduce && !Reduction::has_fast_atomics>
-reduCGFuncImpl(handler &CGH, KernelType KernelFunc, const nd_range<Dims> &Range,
-               Reduction &, OutputT Out) {
-
-  size_t NWorkGroups = Range.get_group_range().size();
-  // This additional check is needed for 'read_write' accessor case only.
-  // It does not slow-down the kernel writing to 'discard_write' accessor as
-  // the condition seems to be resolved at compile time for 'discard_write'.
-  bool IsUpdateOfUserVar =
-      Reduction::accessor_mode == access::mode::read_write && NWorkGroups == 1;
-
-  using Name = typename get_reduction_main_kernel_name_t<
-      KernelName, KernelType, Reduction::is_usm, IsPow2WG, OutputT>::name;
-  CGH.parallel_for<Name>(Range, [=](nd_item<Dims> NDIt) {
-    // Call user's functions. Reducer.MValue gets initialized there.
-    typename Reduction::reducer_type Reducer;
-    KernelFunc(NDIt, Reducer);
+/// Reduces the values of the work-items of a work-group with ONEAPI::reduce(),
+/// which the device implements with its sub-group operations. The result is
+/// returned to every work-item.
+template <bool IsPow2WG, class Reduction, int Dims, typename LocalAccT>
+enable_if_t<Reduction::has_fast_reduce, typename Reduction::result_type>
+reduOverGroup(nd_item<Dims> NDIt, typename Reduction::result_type Value,
+              LocalAccT, typename Reduction::result_type,
+              typename Reduction::binary_operation BOp) {
+  return ONEAPI::reduce(NDIt.get_group(), Value, BOp);
+}
 
-    // Compute the partial sum/reduction for the work-group.
-    size_t WGID = NDIt.get_group_linear_id();
-    typename Reduction::result_type PSum = Reducer.MValue;
-    typename Reduction::binary_operation BOp;
-    PSum = ONEAPI::reduce(NDIt.get_group(), PSum, BOp);
-    if (NDIt.get_local_linear_id() == 0) {
-      if (IsUpdateOfUserVar)
-        PSum = BOp(*(Reduction::getOutPointer(Out)), PSum);
-      Reduction::getOutPointer(Out)[WGID] = PSum;
-    }
-  });
+/// Reduces the values of the work-items of a work-group with tree-reduction
+/// in the local memory \p LocalReds. The result is only valid in the work-item
+/// with the local id 0.
+template <bool IsPow2WG, class Reduction, int Dims, typename LocalAccT>
+enable_if_t<!Reduction::has_fast_reduce, typename Reduction::result_type>
+reduOverGroup(nd_item<Dims> NDIt, typename Reduction::result_type Value,
+              LocalAccT LocalReds, typename Reduction::result_type Identity,
+              typename Reduction::binary_operation BOp) {
+  size_t WGSize = NDIt.get_local_range().size();
+  size_t LID = NDIt.get_local_linear_id();
+
+  // Copy the element to local memory to prepare it for tree-reduction.
+  LocalReds[LID] = Value;
+  if (!IsPow2WG)
+    LocalReds[WGSize] = Identity;
+  NDIt.barrier();
+
+  // Tree-reduction: reduce the local array LocalReds[:] to LocalReds[0]
+  // LocalReds[WGSize] accumulates last/odd elements when the step
+  // of tree-reduction loop is not even.
+  size_t PrevStep = WGSize;
+  for (size_t CurStep = PrevStep >> 1; CurStep > 0; CurStep >>= 1) {
+    if (LID < CurStep)
+      LocalReds[LID] = BOp(LocalReds[LID], LocalReds[LID + CurStep]);
+    else if (!IsPow2WG && LID == CurStep && (PrevStep & 0x1))
+      LocalReds[WGSize] = BOp(LocalReds[WGSize], LocalReds[PrevStep - 1]);
+    NDIt.barrier();
+    PrevStep = CurStep;
+  }
+  return IsPow2WG ? LocalReds[0] : BOp(LocalReds[0], LocalReds[WGSize]);
 }
 
-/// Implements a command group function that enqueues a kernel that calls
-/// user's lambda function \param KernelFunc and does one iteration of
-/// reduction of elements in each of work-groups.
-/// This version uses tree-reduction algorithm to reduce elements in each
-/// of work-groups. At the end of each work-group the partial sum is written
-/// to a global buffer.
+/// Enqueues the kernel with the name \c Name that calls user's lambda
+/// function \param KernelFunc and does the whole reduction in a single pass.
+/// Every work-group reduces its elements and writes the partial sum to
+/// \p PartialSums, then takes a ticket from the counter \p Counter. The
+/// work-group which takes the last ticket is the last one to finish, it
+/// reduces the partial sums of all work-groups and writes the result to user's
+/// reduction variable. The order of the operations doesn't depend on which of
+/// the work-groups finishes last, so the results are reproducible.
 ///
-/// Briefly: user's lambda, tree-reduction, CUSTOM types/ops.
-template <typename KernelName, typename KernelType, int Dims, class Reduction,
-          bool IsPow2WG, typename OutputT>
-enable_if_t<!Reduction::has_fast_reduce && !Reduction::has_fast_atomics>
-reduCGFuncImpl(handler &CGH, KernelType KernelFunc, const nd_range<Dims> &Range,
-               Reduction &Redu, OutputT Out) {
+/// \p PartialSums and \p Counter are either accessors or USM pointers.
+template <typename Name, bool IsPow2WG, typename KernelType, int Dims,
+          class Reduction, typename OutputT, typename PartialSumsT,
+          typename CounterT>
+void reduCGFuncSinglePass(handler &CGH, KernelType KernelFunc,
+                          const nd_range<Dims> &Range, Reduction &Redu,
+                          OutputT Out, PartialSumsT PartialSums,
+                          CounterT Counter) {
   size_t WGSize = Range.get_local_range().size();
   size_t NWorkGroups = Range.get_group_range().size();
 
-  bool IsUpdateOfUserVar =
-      Reduction::accessor_mode == access::mode::read_write && NWorkGroups == 1;
+  // The result is combined with the value of user's reduction variable unless
+  // the value is discarded.
+  constexpr bool IsUpdateOfUserVar =
+      Reduction::accessor_mode == access::mode::read_write;
 
   // Use local memory to reduce elements in work-groups into 0-th element.
   // If WGSize is not power of two, then WGSize+1 elements are allocated.
   // The additional last element is used to catch elements that could
   // otherwise be lost in the tree-reduction algorithm.
-  size_t NumLocalElements = WGSize + (IsPow2WG ? 0 : 1);
+  // ONEAPI::reduce() doesn't need local memory.
+  size_t NumLocalElements =
+      Reduction::has_fast_reduce ? 1 : WGSize + (IsPow2WG ? 0 : 1);
   auto LocalReds = Redu.getReadWriteLocalAcc(NumLocalElements, CGH);
+  accessor<int, 1, access::mode::read_write, access::target::local>
+      IsLastGroup(1, CGH);
+
   typename Reduction::result_type ReduIdentity = Redu.getIdentity();
-  using Name = typename get_reduction_main_kernel_name_t<
-      KernelName, KernelType, Reduction::is_usm, IsPow2WG, OutputT>::name;
   auto BOp = Redu.getBinaryOperation();
   CGH.parallel_for<Name>(Range, [=](nd_item<Dims> NDIt) {
     // Call user's functions. Reducer.MValue gets initialized there.
@@ -795,43 +835,115 @@ reduCGFuncImpl(handler &CGH, KernelType KernelFunc, const nd_range<Dims> &Range,
 
     size_t WGSize = NDIt.get_local_range().size();
     size_t LID = NDIt.get_local_linear_id();
-    // Copy the element to local memory to prepare it for tree-reduction.
-    LocalReds[LID] = Reducer.MValue;
-    if (!IsPow2WG)
-      LocalReds[WGSize] = ReduIdentity;
-    NDIt.barrier();
+    typename Reduction::result_type PSum = reduOverGroup<IsPow2WG, Reduction>(
+        NDIt, Reducer.MValue, LocalReds, ReduIdentity, BOp);
 
-    // Tree-reduction: reduce the local array LocalReds[:] to LocalReds[0]
-    // LocalReds[WGSize] accumulates last/odd elements when the step
-    // of tree-reduction loop is not even.
-    size_t PrevStep = WGSize;
-    for (size_t CurStep = PrevStep >> 1; CurStep > 0; CurStep >>= 1) {
-      if (LID < CurStep)
-        LocalReds[LID] = BOp(LocalReds[LID], LocalReds[LID + CurStep]);
-      else if (!IsPow2WG && LID == CurStep && (PrevStep & 0x1))
-        LocalReds[WGSize] = BOp(LocalReds[WGSize], LocalReds[PrevStep - 1]);
-      NDIt.barrier();
-      PrevStep = CurStep;
+    // Publish the partial sum of the work-group before taking the ticket, so
+    // that the last work-group sees all of them.
+    if (LID == 0) {
+      PartialSums[NDIt.get_group_linear_id()] = PSum;
+      ONEAPI::atomic_fence(ONEAPI::memory_order::acq_rel,
+                           ONEAPI::memory_scope::device);
+      ONEAPI::atomic_ref<int, ONEAPI::memory_order::relaxed,
+                         ONEAPI::memory_scope::device,
+                         access::address_space::global_space>
+          Ticket(Counter[0]);
+      IsLastGroup[0] = Ticket.fetch_add(1) == static_cast<int>(NWorkGroups - 1);
+      ONEAPI::atomic_fence(ONEAPI::memory_order::acq_rel,
+                           ONEAPI::memory_scope::device);
     }
-
-    // Compute the partial sum/reduction for the work-group.
+    NDIt.barrier();
+    if (!IsLastGroup[0])
+      return;
+    // All the work-groups have taken their tickets, restore the zero for
+    // the next user of the counter.
+    if (LID == 0)
+      Counter[0] = 0;
+
+    // Reduce the partial sums of all work-groups.
+    typename Reduction::result_type Sum = ReduIdentity;
+    for (size_t I = LID; I < NWorkGroups; I += WGSize)
+      Sum = BOp(Sum, PartialSums[I]);
+    Sum = reduOverGroup<IsPow2WG, Reduction>(NDIt, Sum, LocalReds,
+                                             ReduIdentity, BOp);
     if (LID == 0) {
-      size_t GrID = NDIt.get_group_linear_id();
-      typename Reduction::result_type PSum =
-          IsPow2WG ? LocalReds[0] : BOp(LocalReds[0], LocalReds[WGSize]);
       if (IsUpdateOfUserVar)
-        PSum = BOp(*(Reduction::getOutPointer(Out)), PSum);
-      Reduction::getOutPointer(Out)[GrID] = PSum;
+        Sum = BOp(*(Reduction::getOutPointer(Out)), Sum);
+      *(Reduction::getOutPointer(Out)) = Sum;
     }
   });
 }
 
+/// Implements a command group function that enqueues a kernel that calls
+/// user's lambda function \param KernelFunc and does the whole reduction in
+/// a single pass, see reduCGFuncSinglePass(). The partial sums and the ticket
+/// counter are kept in buffers borrowed from the scratch arena of the queue.
+///
+/// Briefly: user's lambda, ONEAPI::reduce() or tree-reduction + atomic ticket,
+/// FP + ADD/MIN/MAX, CUSTOM types/ops.
+template <typename KernelName, typename KernelType, int Dims, class Reduction,
+          bool IsPow2WG, typename OutputT>
+enable_if_t<!Reduction::has_fast_atomics>
+reduCGFuncImpl(handler &CGH, KernelType KernelFunc, const nd_range<Dims> &Range,
+               Reduction &Redu, OutputT Out) {
+  size_t NWorkGroups = Range.get_group_range().size();
+  auto PartialSums = Redu.getPartialSumsAcc(NWorkGroups, CGH);
+  auto Counter = Redu.getTicketCounterAcc(CGH);
+
+  using Name = typename get_reduction_main_kernel_name_t<
+      KernelName, KernelType, Reduction::is_usm, IsPow2WG, OutputT>::name;
+  reduCGFuncSinglePass<Name, IsPow2WG>(CGH, KernelFunc, Range, Redu, Out,
+                                       PartialSums, Counter);
+}
+
+/// This is the forward declaration for the class that helps to create
+/// names for the single-pass kernels keeping their temporary data in USM
+/// memory.
+template <typename T1, bool B1> class __sycl_reduction_usm_kernel;
+
+/// Enqueues the single-pass kernel of the USM reduction \p Redu with the
+/// partial sums and the ticket counter in USM memory borrowed from the scratch
+/// arena of the in-order queue. The command group then has no accessors to
+/// global memory, so the scheduler enqueues it without the dependency graph.
+/// \return false if the queue cannot lend USM memory and nothing was done.
+template <typename KernelName, typename KernelType, int Dims, class Reduction>
+enable_if_t<Reduction::is_usm, bool>
+reduCGFuncUSMScratch(handler &CGH, KernelType KernelFunc,
+                     const nd_range<Dims> &Range, Reduction &Redu,
+                     bool IsPow2WG) {
+  size_t NWorkGroups = Range.get_group_range().size();
+  auto *PartialSums = Redu.getPartialSumsUSM(NWorkGroups, CGH);
+  if (!PartialSums)
+    return false;
+  int *Counter = Redu.getTicketCounterUSM(CGH);
+  if (!Counter)
+    return false;
+
+  using KName = typename sycl::detail::get_kernel_name_t<KernelName,
+                                                          KernelType>::name;
+  if (IsPow2WG)
+    reduCGFuncSinglePass<__sycl_reduction_usm_kernel<KName, true>, true>(
+        CGH, KernelFunc, Range, Redu, Redu.getUSMPointer(), PartialSums,
+        Counter);
+  else
+    reduCGFuncSinglePass<__sycl_reduction_usm_kernel<KName, false>, false>(
+        CGH, KernelFunc, Range, Redu, Redu.getUSMPointer(), PartialSums,
+        Counter);
+  return true;
+}
+
+template <typename KernelName, typename KernelType, int Dims, class Reduction>
+enable_if_t<!Reduction::is_usm, bool>
+reduCGFuncUSMScratch(handler &, KernelType, const nd_range<Dims> &,
+                     Reduction &, bool) {
+  return false;
+}
+
 template <typename KernelName, typename KernelType, int Dims, class Reduction>
 enable_if_t<!Reduction::has_fast_atomics>
 reduCGFunc(handler &CGH, KernelType KernelFunc, const nd_range<Dims> &Range,
            Reduction &Redu) {
   size_t WGSize = Range.get_local_range().size();
-  size_t NWorkGroups = Range.get_group_range().size();
 
   // If the work group size is not pow of 2, then the kernel runs some
   // additional code and checks in it.
@@ -839,7 +951,10 @@ reduCGFunc(handler &CGH, KernelType KernelFunc, const nd_range<Dims> &Range,
   // group size is pow of 2 or not, assume true for such cases.
   bool IsPow2WG = Reduction::has_fast_reduce || ((WGSize & (WGSize - 1)) == 0);
 
-  if (Reduction::is_usm && NWorkGroups == 1) {
+  if (reduCGFuncUSMScratch<KernelName>(CGH, KernelFunc, Range, Redu, IsPow2WG))
+    return;
+
+  if (Reduction::is_usm) {
     if (IsPow2WG)
       reduCGFuncImpl<KernelName, KernelType, Dims, Reduction, true>(
           CGH, KernelFunc, Range, Redu, Redu.getUSMPointer());
@@ -847,160 +962,224 @@ reduCGFunc(handler &CGH, KernelType KernelFunc, const nd_range<Dims> &Range,
       reduCGFuncImpl<KernelName, KernelType, Dims, Reduction, false>(
           CGH, KernelFunc, Range, Redu, Redu.getUSMPointer());
   } else {
-    auto Out = Redu.getWriteAccForPartialReds(NWorkGroups, CGH);
     if (IsPow2WG)
       reduCGFuncImpl<KernelName, KernelType, Dims, Reduction, true>(
-          CGH, KernelFunc, Range, Redu, Out);
+          CGH, KernelFunc, Range, Redu, Redu.getUserAccessor());
     else
       reduCGFuncImpl<KernelName, KernelType, Dims, Reduction, false>(
-          CGH, KernelFunc, Range, Redu, Out);
+          CGH, KernelFunc, Range, Redu, Redu.getUserAccessor());
   }
 }
 
-/// Implements a command group function that enqueues a kernel that does one
-/// iteration of reduction of elements in each of work-groups.
-/// This version uses ONEAPI::reduce() algorithm to reduce elements in each
-/// of work-groups. At the end of each work-groups the partial sum is written
-/// to a global buffer.
-///
-/// Briefly: aux kernel, ONEAPI:reduce(), reproducible results, FP + ADD/MIN/MAX
-template <typename KernelName, typename KernelType, bool UniformWG,
-          class Reduction, typename InputT, typename OutputT>
-enable_if_t<Reduction::has_fast_reduce && !Reduction::has_fast_atomics>
-reduAuxCGFuncImpl(handler &CGH, size_t NWorkItems, size_t NWorkGroups,
-                  size_t WGSize, Reduction &, InputT In, OutputT Out) {
-  using Name = typename get_reduction_aux_kernel_name_t<
-      KernelName, KernelType, Reduction::is_usm, UniformWG, OutputT>::name;
-  bool IsUpdateOfUserVar =
-      Reduction::accessor_mode == access::mode::read_write && NWorkGroups == 1;
-  range<1> GlobalRange = {UniformWG ? NWorkItems : NWorkGroups * WGSize};
-  nd_range<1> Range{GlobalRange, range<1>(WGSize)};
-  CGH.parallel_for<Name>(Range, [=](nd_item<1> NDIt) {
-    typename Reduction::binary_operation BOp;
-    size_t WGID = NDIt.get_group_linear_id();
-    size_t GID = NDIt.get_global_linear_id();
-    typename Reduction::result_type PSum =
-        (UniformWG || (GID < NWorkItems))
-            ? In[GID]
-            : Reduction::reducer_type::getIdentity();
-    PSum = ONEAPI::reduce(NDIt.get_group(), PSum, BOp);
-    if (NDIt.get_local_linear_id() == 0) {
-      if (IsUpdateOfUserVar)
-        PSum = BOp(*(Reduction::getOutPointer(Out)), PSum);
-      Reduction::getOutPointer(Out)[WGID] = PSum;
-    }
-  });
+/// This is the forward declaration for the class that helps to create
+/// names for the kernels implementing several SYCL reductions at once.
+template <typename T1, bool B1> class __sycl_reduction_multi_kernel;
+
+/// Returns the pointer or the accessor to which the result of the USM
+/// reduction \p Redu is written.
+template <class Reduction>
+enable_if_t<Reduction::is_usm, typename Reduction::result_type *>
+reduGetOutput(Reduction &Redu) {
+  return Redu.getUSMPointer();
 }
 
-/// Implements a command group function that enqueues a kernel that does one
-/// iteration of reduction of elements in each of work-groups.
-/// This version uses tree-reduction algorithm to reduce elements in each
-/// of work-groups. At the end of each work-group the partial sum is written
-/// to a global buffer.
-///
-/// Briefly: aux kernel, tree-reduction, CUSTOM types/ops.
-template <typename KernelName, typename KernelType, bool UniformPow2WG,
-          class Reduction, typename InputT, typename OutputT>
-enable_if_t<!Reduction::has_fast_reduce && !Reduction::has_fast_atomics>
-reduAuxCGFuncImpl(handler &CGH, size_t NWorkItems, size_t NWorkGroups,
-                  size_t WGSize, Reduction &Redu, InputT In, OutputT Out) {
-  bool IsUpdateOfUserVar =
-      Reduction::accessor_mode == access::mode::read_write && NWorkGroups == 1;
+/// Returns the accessor to which the result of the reduction \p Redu is
+/// written.
+template <class Reduction>
+enable_if_t<!Reduction::is_usm, typename Reduction::accessor_type>
+reduGetOutput(Reduction &Redu) {
+  return Redu.getUserAccessor();
+}
+
+/// Writes the final result \p Value of a reduction to \p Out, combining it
+/// with the value of user's reduction variable unless that value is discarded.
+template <class Reduction, typename OutputT>
+void reduWriteOutput(const OutputT &Out, typename Reduction::result_type Value,
+                     typename Reduction::binary_operation BOp) {
+  constexpr bool IsUpdateOfUserVar =
+      Reduction::accessor_mode == access::mode::read_write;
+  if (IsUpdateOfUserVar)
+    Value = BOp(*(Reduction::getOutPointer(Out)), Value);
+  *(Reduction::getOutPointer(Out)) = Value;
+}
+
+/// Reduces the values \p Values of several reductions over a work-group
+/// with a tree-reduction in the local memory \p LocalAccs. Each step of
+/// the tree-reduction is done for all of the reductions before the barrier,
+/// so the number of barriers doesn't depend on the number of reductions.
+/// The results are only valid in the work-item with the local id 0.
+template <bool IsPow2WG, int Dims, typename... ValueT, typename... LocalAccT,
+          typename... BOpT, size_t... Is>
+void reduMultiOverGroup(nd_item<Dims> NDIt, std::tuple<ValueT...> &Values,
+                        const std::tuple<LocalAccT...> &LocalAccs,
+                        const std::tuple<ValueT...> &Identities,
+                        const std::tuple<BOpT...> &BOps,
+                        std::index_sequence<Is...>) {
+  size_t WGSize = NDIt.get_local_range().size();
+  size_t LID = NDIt.get_local_linear_id();
+
+  // Copy the elements to local memory to prepare them for tree-reduction.
+  (void)std::initializer_list<int>{
+      (std::get<Is>(LocalAccs)[LID] = std::get<Is>(Values), 0)...};
+  if (!IsPow2WG)
+    (void)std::initializer_list<int>{
+        (std::get<Is>(LocalAccs)[WGSize] = std::get<Is>(Identities), 0)...};
+  NDIt.barrier();
+
+  // Tree-reduction: reduce the local arrays to their 0-th elements.
+  // The elements with the index WGSize accumulate last/odd elements when
+  // the step of tree-reduction loop is not even.
+  size_t PrevStep = WGSize;
+  for (size_t CurStep = PrevStep >> 1; CurStep > 0; CurStep >>= 1) {
+    if (LID < CurStep)
+      (void)std::initializer_list<int>{
+          (std::get<Is>(LocalAccs)[LID] =
+               std::get<Is>(BOps)(std::get<Is>(LocalAccs)[LID],
+                                  std::get<Is>(LocalAccs)[LID + CurStep]),
+           0)...};
+    else if (!IsPow2WG && LID == CurStep && (PrevStep & 0x1))
+      (void)std::initializer_list<int>{
+          (std::get<Is>(LocalAccs)[WGSize] =
+               std::get<Is>(BOps)(std::get<Is>(LocalAccs)[WGSize],
+                                  std::get<Is>(LocalAccs)[PrevStep - 1]),
+           0)...};
+    NDIt.barrier();
+    PrevStep = CurStep;
+  }
+
+  (void)std::initializer_list<int>{
+      (std::get<Is>(Values) =
+           IsPow2WG ? std::get<Is>(LocalAccs)[0]
+                    : std::get<Is>(BOps)(std::get<Is>(LocalAccs)[0],
+                                         std::get<Is>(LocalAccs)[WGSize]),
+       0)...};
+}
+
+/// Implements a command group function that enqueues a kernel that calls
+/// user's lambda function \param KernelFunc and does all the reductions
+/// \param Redus in a single pass.
+/// The scheme is the same as for a single reduction without fast atomics:
+/// every work-group writes the partial sums to global buffers and the
+/// work-group that takes the last ticket from the shared counter reduces them.
+/// The values of all the reductions go through one tree-reduction, so
+/// the barriers are shared by the reductions.
+template <typename KernelName, typename KernelType, int Dims, bool IsPow2WG,
+          size_t... Is, typename... Reductions>
+void reduCGFuncMultiImpl(handler &CGH, KernelType KernelFunc,
+                         const nd_range<Dims> &Range,
+                         std::index_sequence<Is...> ReduIndices,
+                         Reductions &... Redus) {
+  size_t WGSize = Range.get_local_range().size();
+  size_t NWorkGroups = Range.get_group_range().size();
 
-  // Use local memory to reduce elements in work-groups into 0-th element.
   // If WGSize is not power of two, then WGSize+1 elements are allocated.
   // The additional last element is used to catch elements that could
   // otherwise be lost in the tree-reduction algorithm.
-  size_t NumLocalElements = WGSize + (UniformPow2WG ? 0 : 1);
-  auto LocalReds = Redu.getReadWriteLocalAcc(NumLocalElements, CGH);
+  size_t NumLocalElements = WGSize + (IsPow2WG ? 0 : 1);
+  auto LocalAccs =
+      std::make_tuple(Redus.getReadWriteLocalAcc(NumLocalElements, CGH)...);
+  auto PartialSums =
+      std::make_tuple(Redus.getPartialSumsAcc(NWorkGroups, CGH)...);
+  auto Outs = std::make_tuple(reduGetOutput(Redus)...);
+  auto Identities = std::make_tuple(Redus.getIdentity()...);
+  auto BOps = std::make_tuple(Redus.getBinaryOperation()...);
+  accessor<int, 1, access::mode::read_write, access::target::local>
+      IsLastGroup(1, CGH);
+  // A single ticket counter serves all the reductions.
+  auto Counter =
+      std::get<0>(std::forward_as_tuple(Redus...)).getTicketCounterAcc(CGH);
+
+  using Name = __sycl_reduction_multi_kernel<
+      typename sycl::detail::get_kernel_name_t<KernelName, KernelType>::name,
+      IsPow2WG>;
+  CGH.parallel_for<Name>(Range, [=](nd_item<Dims> NDIt) {
+    // Call user's function. The reducers get initialized there.
+    std::tuple<typename Reductions::reducer_type...> Reducers(
+        typename Reductions::reducer_type(std::get<Is>(Identities),
+                                          std::get<Is>(BOps))...);
+    KernelFunc(NDIt, std::get<Is>(Reducers)...);
 
-  auto ReduIdentity = Redu.getIdentity();
-  auto BOp = Redu.getBinaryOperation();
-  using Name = typename get_reduction_aux_kernel_name_t<
-      KernelName, KernelType, Reduction::is_usm, UniformPow2WG, OutputT>::name;
-  range<1> GlobalRange = {UniformPow2WG ? NWorkItems : NWorkGroups * WGSize};
-  nd_range<1> Range{GlobalRange, range<1>(WGSize)};
-  CGH.parallel_for<Name>(Range, [=](nd_item<1> NDIt) {
     size_t WGSize = NDIt.get_local_range().size();
     size_t LID = NDIt.get_local_linear_id();
-    size_t GID = NDIt.get_global_linear_id();
-
-    // Copy the element to local memory to prepare it for tree-reduction.
-    LocalReds[LID] =
-        (UniformPow2WG || GID < NWorkItems) ? In[GID] : ReduIdentity;
-    if (!UniformPow2WG)
-      LocalReds[WGSize] = ReduIdentity;
-    NDIt.barrier();
-
-    // Tree-reduction: reduce the local array LocalReds[:] to LocalReds[0]
-    // LocalReds[WGSize] accumulates last/odd elements when the step
-    // of tree-reduction loop is not even.
-    size_t PrevStep = WGSize;
-    for (size_t CurStep = PrevStep >> 1; CurStep > 0; CurStep >>= 1) {
-      if (LID < CurStep)
-        LocalReds[LID] = BOp(LocalReds[LID], LocalReds[LID + CurStep]);
-      else if (!UniformPow2WG && LID == CurStep && (PrevStep & 0x1))
-        LocalReds[WGSize] = BOp(LocalReds[WGSize], LocalReds[PrevStep - 1]);
-      NDIt.barrier();
-      PrevStep = CurStep;
-    }
+    std::tuple<typename Reductions::result_type...> Values(
+        std::get<Is>(Reducers).MValue...);
+    reduMultiOverGroup<IsPow2WG>(NDIt, Values, LocalAccs, Identities, BOps,
+                                 ReduIndices);
 
-    // Compute the partial sum/reduction for the work-group.
+    // Publish the partial sums of the work-group before taking the ticket,
+    // so that the last work-group sees all of them.
     if (LID == 0) {
-      size_t GrID = NDIt.get_group_linear_id();
-      typename Reduction::result_type PSum =
-          UniformPow2WG ? LocalReds[0] : BOp(LocalReds[0], LocalReds[WGSize]);
-      if (IsUpdateOfUserVar)
-        PSum = BOp(*(Reduction::getOutPointer(Out)), PSum);
-      Reduction::getOutPointer(Out)[GrID] = PSum;
+      size_t GroupID = NDIt.get_group_linear_id();
+      (void)std::initializer_list<int>{
+          (std::get<Is>(PartialSums)[GroupID] = std::get<Is>(Values), 0)...};
+      ONEAPI::atomic_fence(ONEAPI::memory_order::acq_rel,
+                           ONEAPI::memory_scope::device);
+      ONEAPI::atomic_ref<int, ONEAPI::memory_order::relaxed,
+                         ONEAPI::memory_scope::device,
+                         access::address_space::global_space>
+          Ticket(Counter[0]);
+      IsLastGroup[0] = Ticket.fetch_add(1) == static_cast<int>(NWorkGroups - 1);
+      ONEAPI::atomic_fence(ONEAPI::memory_order::acq_rel,
+                           ONEAPI::memory_scope::device);
     }
+    NDIt.barrier();
+    if (!IsLastGroup[0])
+      return;
+    // All the work-groups have taken their tickets, restore the zero for
+    // the next user of the counter.
+    if (LID == 0)
+      Counter[0] = 0;
+
+    // Reduce the partial sums of all work-groups.
+    Values = Identities;
+    for (size_t I = LID; I < NWorkGroups; I += WGSize)
+      (void)std::initializer_list<int>{
+          (std::get<Is>(Values) = std::get<Is>(BOps)(
+               std::get<Is>(Values), std::get<Is>(PartialSums)[I]),
+           0)...};
+    reduMultiOverGroup<IsPow2WG>(NDIt, Values, LocalAccs, Identities, BOps,
+                                 ReduIndices);
+    if (LID == 0)
+      (void)std::initializer_list<int>{
+          (reduWriteOutput<Reductions>(std::get<Is>(Outs),
+                                       std::get<Is>(Values),
+                                       std::get<Is>(BOps)),
+           0)...};
   });
 }
 
-/// Implements a command group function that enqueues a kernel that does one
-/// iteration of reduction of elements in each of work-groups.
-/// At the end of each work-group the partial sum is written to a global buffer.
-/// The function returns the number of the newly generated partial sums.
-template <typename KernelName, typename KernelType, class Reduction>
-enable_if_t<!Reduction::has_fast_atomics, size_t>
-reduAuxCGFunc(handler &CGH, size_t NWorkItems, size_t MaxWGSize,
-              Reduction &Redu) {
-
-  size_t NWorkGroups;
-  size_t WGSize = reduComputeWGSize(NWorkItems, MaxWGSize, NWorkGroups);
-
-  // The last kernel DOES write to user's accessor passed to reduction.
-  // Associate it with handler manually.
-  if (NWorkGroups == 1 && !Reduction::is_usm)
-    Redu.associateWithHandler(CGH);
-
-  // The last work-group may be not fully loaded with work, or the work group
-  // size may be not power of two. Those two cases considered inefficient
-  // as they require additional code and checks in the kernel.
-  bool HasUniformWG = NWorkGroups * WGSize == NWorkItems;
-  if (!Reduction::has_fast_reduce)
-    HasUniformWG = HasUniformWG && (WGSize & (WGSize - 1)) == 0;
-
-  // Get read accessor to the buffer that was used as output
-  // in the previous kernel.
-  auto In = Redu.getReadAccToPreviousPartialReds(CGH);
-  if (Reduction::is_usm && NWorkGroups == 1) {
-    if (HasUniformWG)
-      reduAuxCGFuncImpl<KernelName, KernelType, true>(
-          CGH, NWorkItems, NWorkGroups, WGSize, Redu, In, Redu.getUSMPointer());
-    else
-      reduAuxCGFuncImpl<KernelName, KernelType, false>(
-          CGH, NWorkItems, NWorkGroups, WGSize, Redu, In, Redu.getUSMPointer());
-  } else {
-    auto Out = Redu.getWriteAccForPartialReds(NWorkGroups, CGH);
-    if (HasUniformWG)
-      reduAuxCGFuncImpl<KernelName, KernelType, true>(
-          CGH, NWorkItems, NWorkGroups, WGSize, Redu, In, Out);
-    else
-      reduAuxCGFuncImpl<KernelName, KernelType, false>(
-          CGH, NWorkItems, NWorkGroups, WGSize, Redu, In, Out);
-  }
-  return NWorkGroups;
+/// Returns the size of local memory a work-item needs for the reductions
+/// given by the first elements of \p ArgsTuple, selected by \p Is.
+template <typename... RestT, size_t... Is>
+size_t reduGetMemPerWorkItem(std::tuple<RestT...> &,
+                             std::index_sequence<Is...>) {
+  size_t Sizes[] = {sizeof(typename std::tuple_element<
+                           Is, std::tuple<RestT...>>::type::result_type)...};
+  size_t Size = 0;
+  for (size_t ElemSize : Sizes)
+    Size += ElemSize;
+  return Size;
+}
+
+/// Implements parallel_for() with several reductions. \p ArgsTuple holds
+/// the reductions selected by \p Is followed by the kernel function.
+template <typename KernelName, int Dims, typename... RestT, size_t... Is>
+void reduCGFunc(handler &CGH, const nd_range<Dims> &Range,
+                std::tuple<RestT...> &ArgsTuple, std::index_sequence<Is...>) {
+  auto KernelFunc = std::get<sizeof...(RestT) - 1>(ArgsTuple);
+  using KernelType = decltype(KernelFunc);
+  size_t WGSize = Range.get_local_range().size();
+
+  // If the work group size is not pow of 2, then the kernel runs some
+  // additional code and checks in it.
+  if ((WGSize & (WGSize - 1)) == 0)
+    reduCGFuncMultiImpl<KernelName, KernelType, Dims, true>(
+        CGH, KernelFunc, Range, std::index_sequence<Is...>(),
+        std::get<Is>(ArgsTuple)...);
+  else
+    reduCGFuncMultiImpl<KernelName, KernelType, Dims, false>(
+        CGH, KernelFunc, Range, std::index_sequence<Is...>(),
+        std::get<Is>(ArgsTuple)...);
 }
 
 } // namespace detail
@@ -0,0 +1,91 @@
+//==------ submission_batch.hpp --- SYCL batched command group submission --==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl/detail/common.hpp>
+#include <CL/sycl/detail/export.hpp>
+#include <CL/sycl/event.hpp>
+#include <CL/sycl/queue.hpp>
+#include <CL/sycl/stl.hpp>
+
+#include <memory>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+class submission_batch_impl;
+} // namespace detail
+
+namespace ONEAPI {
+
+// This is a preview extension implementation, intended to provide early
+// access to a feature for review and community feedback.
+//
+// Because the interfaces defined by this header file are not final and are
+// subject to change they are not intended to be used by shipping software
+// products. If you are interested in using this feature in your software
+// product, please let us know!
+
+/// \brief collects command groups for a queue and submits them together.
+///
+/// The command group functions are run by submit, but the command groups are
+/// only submitted by commit, in order. The consecutive ones which need the
+/// dependency graph of the runtime are added to it under a single lock
+/// acquisition, and the commands are enqueued back to back, so that the
+/// plugins batching their commands, like Level Zero, put them into the same
+/// native command lists.
+///
+/// The event returned by submit may only be used as a dependency of the
+/// command groups submitted to the batch after it; commit returns the events
+/// of the command groups. The command groups which are not committed when the
+/// last copy of the batch is destroyed are committed then.
+class __SYCL_EXPORT submission_batch {
+public:
+  explicit submission_batch(queue &Queue);
+
+  queue get_queue() const;
+
+  /// \return the number of command groups waiting for commit.
+  size_t size() const;
+
+  /// Runs a command group function object and adds the command group to the
+  /// batch.
+  ///
+  /// \param CGF is a function object containing command group.
+  /// \param CodeLoc is the code location of the submit call (default argument)
+  /// \return an event standing for the command group in the batch.
+  template <typename T>
+  event
+  submit(T CGF
+#ifndef DISABLE_SYCL_INSTRUMENTATION_METADATA
+         ,
+         const detail::code_location &CodeLoc = detail::code_location::current()
+#endif
+  ) {
+#ifdef DISABLE_SYCL_INSTRUMENTATION_METADATA
+    const detail::code_location &CodeLoc = {};
+#endif
+    return submit_impl(CGF, CodeLoc);
+  }
+
+  /// Submits the command groups of the batch to the queue and empties it.
+  ///
+  /// \return the events of the command groups, in submission order.
+  vector_class<event> commit();
+
+private:
+  event submit_impl(function_class<void(handler &)> CGH,
+                    const detail::code_location &CodeLoc);
+
+  shared_ptr_class<detail::submission_batch_impl> impl;
+};
+
+} // namespace ONEAPI
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -0,0 +1,75 @@
+//==-------- submit_latency.hpp --- SYCL submission latency statistics -----==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl/detail/defines_elementary.hpp>
+#include <CL/sycl/detail/export.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace ONEAPI {
+
+// This is a preview extension implementation, intended to provide early
+// access to a feature for review and community feedback.
+//
+// Because the interfaces defined by this header file are not final and are
+// subject to change they are not intended to be used by shipping software
+// products. If you are interested in using this feature in your software
+// product, please let us know!
+
+/// The stages of the submission of a command group which the SYCL runtime
+/// measures. The stages are nested: the time of a stage includes the time of
+/// the stages below it.
+enum class submit_stage : unsigned int {
+  /// handler::finalize, the whole submission after the command group function.
+  finalize = 0,
+  /// Scheduler::addCG, the submission of the command group to the scheduler.
+  add_command_group = 1,
+  /// The creation of the commands of the command group in the graph.
+  graph_builder = 2,
+  /// The enqueue of the new command and of its dependencies.
+  enqueue_command = 3,
+  /// The piEnqueueKernelLaunch call of a kernel.
+  kernel_launch = 4
+};
+
+/// The latency statistics of a submission stage, in nanoseconds.
+///
+/// The percentiles are taken from histograms with a relative precision of
+/// 12.5%.
+struct submit_latency {
+  std::size_t count;
+  std::uint64_t total_ns;
+  std::uint64_t min_ns;
+  std::uint64_t max_ns;
+  std::uint64_t p50_ns;
+  std::uint64_t p90_ns;
+  std::uint64_t p99_ns;
+};
+
+/// \returns true if the SYCL runtime measures the latency of the submissions.
+///
+/// The measurements are enabled with the SYCL_SUBMIT_LATENCY environment
+/// variable.
+__SYCL_EXPORT bool is_submit_latency_enabled();
+
+/// \returns the latency statistics of the stage over all the threads of the
+/// application, or all zeroes if the measurements are not enabled.
+__SYCL_EXPORT submit_latency get_submit_latency(submit_stage Stage);
+
+/// Drops the latencies measured so far. The latencies measured by other
+/// threads during the reset may be partially dropped.
+__SYCL_EXPORT void reset_submit_latency();
+
+} // namespace ONEAPI
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -891,6 +891,19 @@ protected:
       MData += Offset[0];
   }
 
+  // __init variant used by the device compiler for accessors with the
+  // no_offset property, which saves the kernel argument of the offset.
+  void __init_no_offset(ConcreteASPtrType Ptr, range<AdjustedDim> AccessRange,
+                        range<AdjustedDim> MemRange) {
+    MData = Ptr;
+#pragma unroll
+    for (int I = 0; I < AdjustedDim; ++I) {
+      getOffset()[I] = 0;
+      getAccessRange()[I] = AccessRange[I];
+      getMemoryRange()[I] = MemRange[I];
+    }
+  }
+
   // __init variant used by the device compiler for ESIMD kernels.
   // TODO In ESIMD accessors usage is limited for now - access range, mem
   // range and offset are not supported.
@@ -1366,6 +1379,7 @@ public:
                          sizeof(DataT), BufferRef.OffsetInBytes,
                          BufferRef.IsSubBuffer) {
     checkDeviceAccessorBufferSize(BufferRef.get_count());
+    checkNoOffset(AccessOffset);
     if (!IsPlaceH)
       addHostAccessorAndWait(AccessorBaseHost::impl.get());
   }
@@ -1447,6 +1461,7 @@ public:
                          sizeof(DataT), BufferRef.OffsetInBytes,
                          BufferRef.IsSubBuffer) {
     checkDeviceAccessorBufferSize(BufferRef.get_count());
+    checkNoOffset(AccessOffset);
     detail::associateWithHandler(CommandGroupHandler, this, AccessTarget);
   }
 #endif
@@ -1601,6 +1616,21 @@ public:
   bool operator!=(const accessor &Rhs) const { return !(*this == Rhs); }
 
 private:
+  void checkNoOffset(const id<Dimensions> &AccessOffset) {
+#if __cplusplus >= 201703L
+    // Kernels assume a zero offset for accessors with the no_offset property.
+    if (PropertyListT::template has_property<ONEAPI::property::no_offset>())
+      for (int I = 0; I < Dimensions; ++I)
+        if (AccessOffset[I] != 0)
+          throw cl::sycl::invalid_object_error(
+              "The offset of an accessor with the no_offset property must be "
+              "zero.",
+              PI_INVALID_VALUE);
+#else
+    (void)AccessOffset;
+#endif
+  }
+
   void checkDeviceAccessorBufferSize(const size_t elemInBuffer) {
     if (!IsHostBuf && elemInBuffer == 0)
       throw cl::sycl::invalid_object_error(
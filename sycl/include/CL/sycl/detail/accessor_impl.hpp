@@ -134,9 +134,11 @@ public:
                    access::mode AccessMode, detail::SYCLMemObjI *SYCLMemObject,
                    int Dims, int ElemSize, int OffsetInBytes = 0,
                    bool IsSubBuffer = false) {
-    impl = shared_ptr_class<AccessorImplHost>(new AccessorImplHost(
+    // A single allocation for the implementation and its reference count,
+    // since every submission creates accessors
+    impl = std::make_shared<AccessorImplHost>(
         Offset, AccessRange, MemoryRange, AccessMode, SYCLMemObject, Dims,
-        ElemSize, OffsetInBytes, IsSubBuffer));
+        ElemSize, OffsetInBytes, IsSubBuffer);
   }
 
 protected:
@@ -181,8 +183,7 @@ using LocalAccessorImplPtr = shared_ptr_class<LocalAccessorImplHost>;
 class LocalAccessorBaseHost {
 public:
   LocalAccessorBaseHost(sycl::range<3> Size, int Dims, int ElemSize) {
-    impl = shared_ptr_class<LocalAccessorImplHost>(
-        new LocalAccessorImplHost(Size, Dims, ElemSize));
+    impl = std::make_shared<LocalAccessorImplHost>(Size, Dims, ElemSize);
   }
   sycl::range<3> &getSize() { return impl->MSize; }
   const sycl::range<3> &getSize() const { return impl->MSize; }
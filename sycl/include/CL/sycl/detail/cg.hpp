@@ -62,7 +62,9 @@ public:
     FILL_USM,
     PREFETCH_USM,
     CODEPLAY_INTEROP_TASK,
-    CODEPLAY_HOST_TASK
+    CODEPLAY_HOST_TASK,
+    COPY_USM_RECT,
+    FILL_USM_RECT
   };
 
   CG(CGTYPE Type, vector_class<vector_class<char>> ArgsStorage,
@@ -87,7 +89,7 @@ public:
 
   CG(CG &&CommandGroup) = default;
 
-  CGTYPE getType() { return MType; }
+  CGTYPE getType() const { return MType; }
 
   virtual ~CG() = default;
 
@@ -127,6 +129,8 @@ public:
   string_class MKernelName;
   detail::OSModuleHandle MOSModuleHandle;
   vector_class<shared_ptr_class<detail::stream_impl>> MStreams;
+  /// Integer ID of the kernel, zero if the kernel is not identified by one.
+  unsigned int MKernelID;
 
   CGExecKernel(NDRDescT NDRDesc, unique_ptr_class<HostKernelBase> HKernel,
                shared_ptr_class<detail::kernel_impl> SyclKernel,
@@ -138,14 +142,15 @@ public:
                vector_class<ArgDesc> Args, string_class KernelName,
                detail::OSModuleHandle OSModuleHandle,
                vector_class<shared_ptr_class<detail::stream_impl>> Streams,
-               CGTYPE Type, detail::code_location loc = {})
+               CGTYPE Type, detail::code_location loc = {},
+               unsigned int KernelID = 0)
       : CG(Type, std::move(ArgsStorage), std::move(AccStorage),
            std::move(SharedPtrStorage), std::move(Requirements),
            std::move(Events), std::move(loc)),
         MNDRDesc(std::move(NDRDesc)), MHostKernel(std::move(HKernel)),
         MSyclKernel(std::move(SyclKernel)), MArgs(std::move(Args)),
         MKernelName(std::move(KernelName)), MOSModuleHandle(OSModuleHandle),
-        MStreams(std::move(Streams)) {
+        MStreams(std::move(Streams)), MKernelID(KernelID) {
     assert((getType() == RUN_ON_HOST_INTEL || getType() == KERNEL) &&
            "Wrong type of exec kernel CG.");
   }
@@ -265,6 +270,53 @@ public:
   int getFill() { return MPattern[0]; }
 };
 
+/// "Copy USM rectangle" command group class.
+class CGCopyUSMRect : public CG {
+  void *MSrc;
+  void *MDst;
+  USMRect MRect;
+
+public:
+  CGCopyUSMRect(void *Src, void *Dst, const USMRect &Rect,
+                vector_class<vector_class<char>> ArgsStorage,
+                vector_class<detail::AccessorImplPtr> AccStorage,
+                vector_class<shared_ptr_class<const void>> SharedPtrStorage,
+                vector_class<Requirement *> Requirements,
+                vector_class<detail::EventImplPtr> Events,
+                detail::code_location loc = {})
+      : CG(COPY_USM_RECT, std::move(ArgsStorage), std::move(AccStorage),
+           std::move(SharedPtrStorage), std::move(Requirements),
+           std::move(Events), std::move(loc)),
+        MSrc(Src), MDst(Dst), MRect(Rect) {}
+
+  void *getSrc() { return MSrc; }
+  void *getDst() { return MDst; }
+  const USMRect &getRect() { return MRect; }
+};
+
+/// "Fill USM rectangle" command group class.
+class CGFillUSMRect : public CG {
+  vector_class<char> MPattern;
+  void *MDst;
+  USMRect MRect;
+
+public:
+  CGFillUSMRect(vector_class<char> Pattern, void *DstPtr, const USMRect &Rect,
+                vector_class<vector_class<char>> ArgsStorage,
+                vector_class<detail::AccessorImplPtr> AccStorage,
+                vector_class<shared_ptr_class<const void>> SharedPtrStorage,
+                vector_class<Requirement *> Requirements,
+                vector_class<detail::EventImplPtr> Events,
+                detail::code_location loc = {})
+      : CG(FILL_USM_RECT, std::move(ArgsStorage), std::move(AccStorage),
+           std::move(SharedPtrStorage), std::move(Requirements),
+           std::move(Events), std::move(loc)),
+        MPattern(std::move(Pattern)), MDst(DstPtr), MRect(Rect) {}
+  void *getDst() { return MDst; }
+  const USMRect &getRect() { return MRect; }
+  const vector_class<char> &getPattern() { return MPattern; }
+};
+
 /// "Prefetch USM" command group class.
 class CGPrefetchUSM : public CG {
   void *MDst;
@@ -122,6 +122,19 @@ public:
   size_t Dims;
 };
 
+// The structure represents the rectangle of a 2D or 3D USM copy or fill: the
+// size in bytes of its rows, its numbers of rows and slices and the distances
+// in bytes between the rows and the slices of the source and destination.
+struct USMRect {
+  size_t Width = 0;
+  size_t Height = 1;
+  size_t Depth = 1;
+  size_t SrcRowPitch = 0;
+  size_t SrcSlicePitch = 0;
+  size_t DstRowPitch = 0;
+  size_t DstSlicePitch = 0;
+};
+
 // The pure virtual class aimed to store lambda/functors of any type.
 class HostKernelBase {
 public:
@@ -157,6 +170,14 @@ public:
   void call(interop_handle handle) { MInteropTask(handle); }
 };
 
+/// Runs Task(Begin, End) for the chunks of [0, Count) on the threads of the
+/// host device and returns once all of them are done. The first exception
+/// thrown by Task is rethrown. SYCL_HOST_KERNEL_THREADS sets the number of
+/// threads.
+__SYCL_EXPORT void
+runOnHostThreads(size_t Count,
+                 const function_class<void(size_t, size_t)> &Task);
+
 // Class which stores specific lambda object.
 template <class KernelType, class KernelArgType, int Dims>
 class HostKernel : public HostKernelBase {
@@ -164,7 +185,7 @@ class HostKernel : public HostKernelBase {
   KernelType MKernel;
 
 public:
-  HostKernel(KernelType Kernel) : MKernel(Kernel) {}
+  HostKernel(KernelType Kernel) : MKernel(std::move(Kernel)) {}
   void call(const NDRDescT &NDRDesc, HostProfilingInfo *HPI) override {
     // adjust ND range for serial host:
     NDRDescT AdjustedRange = NDRDesc;
@@ -194,6 +215,27 @@ public:
 
   char *getPtr() override { return reinterpret_cast<char *>(&MKernel); }
 
+  // Applies F to the indices of [0, Range), the largest dimension being split
+  // among the host device threads. Barriers are not supported on the host
+  // device, so the work-items of a work-group never wait for each other.
+  template <typename FuncT>
+  void parallelIterate(const sycl::range<Dims> &Range, FuncT F) {
+    int SplitDim = 0;
+    for (int I = 1; I < Dims; ++I)
+      if (Range[I] > Range[SplitDim])
+        SplitDim = I;
+
+    runOnHostThreads(Range[SplitDim], [&](size_t Begin, size_t End) {
+      sycl::id<Dims> LowerBound;
+      sycl::range<Dims> UpperBound = Range;
+      LowerBound[SplitDim] = Begin;
+      UpperBound[SplitDim] = End;
+      detail::NDLoop<Dims>::iterate(
+          LowerBound, InitializedVal<Dims, range>::template get<1>(),
+          UpperBound, F);
+    });
+  }
+
   template <class ArgT = KernelArgType>
   typename detail::enable_if_t<std::is_same<ArgT, void>::value>
   runOnHost(const NDRDescT &) {
@@ -210,7 +252,7 @@ public:
       Offset[I] = NDRDesc.GlobalOffset[I];
     }
 
-    detail::NDLoop<Dims>::iterate(Range, [&](const sycl::id<Dims> &ID) {
+    parallelIterate(Range, [&](const sycl::id<Dims> &ID) {
       sycl::item<Dims, /*Offset=*/true> Item =
           IDBuilder::createItem<Dims, true>(Range, ID, Offset);
       store_id(&ID);
@@ -228,7 +270,7 @@ public:
     for (int I = 0; I < Dims; ++I)
       Range[I] = NDRDesc.GlobalSize[I];
 
-    detail::NDLoop<Dims>::iterate(Range, [&](const sycl::id<Dims> ID) {
+    parallelIterate(Range, [&](const sycl::id<Dims> ID) {
       sycl::item<Dims, /*Offset=*/false> Item =
           IDBuilder::createItem<Dims, false>(Range, ID);
       sycl::item<Dims, /*Offset=*/true> ItemWithOffset = Item;
@@ -249,7 +291,7 @@ public:
       Offset[I] = NDRDesc.GlobalOffset[I];
     }
 
-    detail::NDLoop<Dims>::iterate(Range, [&](const sycl::id<Dims> &ID) {
+    parallelIterate(Range, [&](const sycl::id<Dims> &ID) {
       sycl::id<Dims> OffsetID = ID + Offset;
       sycl::item<Dims, /*Offset=*/true> Item =
           IDBuilder::createItem<Dims, true>(Range, OffsetID, Offset);
@@ -281,7 +323,7 @@ public:
       GlobalSize[I] = NDRDesc.GlobalSize[I];
     }
 
-    detail::NDLoop<Dims>::iterate(GroupSize, [&](const id<Dims> &GroupID) {
+    parallelIterate(GroupSize, [&](const id<Dims> &GroupID) {
       sycl::group<Dims> Group = IDBuilder::createGroup<Dims>(
           GlobalSize, LocalSize, GroupSize, GroupID);
 
@@ -324,7 +366,7 @@ public:
       LocalSize[I] = NDRDesc.LocalSize[I];
       GlobalSize[I] = NDRDesc.GlobalSize[I];
     }
-    detail::NDLoop<Dims>::iterate(NGroups, [&](const id<Dims> &GroupID) {
+    parallelIterate(NGroups, [&](const id<Dims> &GroupID) {
       sycl::group<Dims> Group =
           IDBuilder::createGroup<Dims>(GlobalSize, LocalSize, NGroups, GroupID);
       MKernel(Group);
@@ -21,8 +21,11 @@ class RTDeviceBinaryImage : public pi::DeviceBinaryImage {
 public:
   RTDeviceBinaryImage(OSModuleHandle ModuleHandle)
       : pi::DeviceBinaryImage(), ModuleHandle(ModuleHandle) {}
+  // Property sets of the image are not parsed until \ref prepare is called.
   RTDeviceBinaryImage(pi_device_binary Bin, OSModuleHandle ModuleHandle)
-      : pi::DeviceBinaryImage(Bin), ModuleHandle(ModuleHandle) {}
+      : pi::DeviceBinaryImage(), ModuleHandle(ModuleHandle) {
+    this->Bin = Bin;
+  }
   OSModuleHandle getOSModuleHandle() const { return ModuleHandle; }
 
   ~RTDeviceBinaryImage() override {}
@@ -33,13 +36,37 @@ public:
 
   const pi_device_binary_struct &getRawData() const { return *get(); }
 
+  /// Returns true if the image data is compressed and hasn't been
+  /// decompressed yet.
+  bool isCompressed() const {
+    return getCompressedImageInfo().isAvailable() && !DecompressedData;
+  }
+
+  /// Parses the property sets of the image and decompresses its data if
+  /// needed. Images are registered without being looked into, so this must be
+  /// called before the image is used. Subsequent calls do nothing.
+  void prepare();
+
+  /// Drops the pages of the image data from the resident memory of the
+  /// process if they are backed by a read-only segment of the loaded module.
+  /// They are read again from the module file when next accessed, so the
+  /// image stays usable.
+  void releaseData() const;
+
   void print() const override {
     pi::DeviceBinaryImage::print();
     std::cerr << "    OSModuleHandle=" << ModuleHandle << "\n";
   }
 
 protected:
+  /// Replaces compressed image data with its decompressed copy owned by this
+  /// object. Does nothing for images which are not compressed.
+  void decompress();
+
   OSModuleHandle ModuleHandle;
+  bool Prepared = false;
+  std::unique_ptr<unsigned char[]> DecompressedData;
+  pi_device_binary_struct DecompressedBin;
 };
 
 // Dynamically allocated device binary image, which de-allocates its binary
@@ -792,6 +792,38 @@ void imageWriteHostImpl(const CoordT &Coords, const WriteDataT &Color,
 // 5. Convert the Read Data into Return DataT based on conversion rules in
 // the Spec.(convertReadData)
 // Possible DataT are cl_int4, cl_uint4, cl_float4, cl_half4;
+// Reads the pixel directly if it has one of the formats most used on the host
+// and returns true, the results are the same as the ones of the generic
+// conversions.
+template <typename DataT>
+bool readCommonPixelData(const unsigned char *, const image_channel_type,
+                         const image_channel_order, DataT &) {
+  return false;
+}
+
+inline bool readCommonPixelData(const unsigned char *Ptr,
+                                const image_channel_type ImageChannelType,
+                                const image_channel_order ImageChannelOrder,
+                                cl_float4 &Color) {
+  if (ImageChannelOrder == image_channel_order::rgba &&
+      ImageChannelType == image_channel_type::unorm_int8) {
+    Color = cl_float4(Ptr[0], Ptr[1], Ptr[2], Ptr[3]) / 255.0f;
+    return true;
+  }
+  if (ImageChannelType != image_channel_type::fp32)
+    return false;
+  const cl_float *FloatPtr = reinterpret_cast<const cl_float *>(Ptr);
+  if (ImageChannelOrder == image_channel_order::rgba) {
+    Color = cl_float4(FloatPtr[0], FloatPtr[1], FloatPtr[2], FloatPtr[3]);
+    return true;
+  }
+  if (ImageChannelOrder == image_channel_order::r) {
+    Color = cl_float4(FloatPtr[0], 0, 0, 1);
+    return true;
+  }
+  return false;
+}
+
 template <typename DataT>
 DataT ReadPixelData(const cl_int4 PixelCoord, const id<3> ImgPitch,
                     const image_channel_type ImageChannelType,
@@ -802,6 +834,8 @@ DataT ReadPixelData(const cl_int4 PixelCoord, const id<3> ImgPitch,
              getImageOffset(PixelCoord, ImgPitch,
                             ElementSize); // Utility to compute offset in
                                           // image_accessor_util.hpp
+  if (readCommonPixelData(Ptr, ImageChannelType, ImageChannelOrder, Color))
+    return Color;
 
   switch (ImageChannelType) {
     // TODO: Pass either ImageChannelType or the exact channel type to the
@@ -929,22 +963,22 @@ DataT ReadPixelDataLinearFiltMode(const cl_int8 CoordValues,
         return Res.template convert<cl_float>();
       };
 
-  // Get Color Values at each Coordinate.
+  // Get Color Values at each Coordinate. The coordinates of 1D and 2D images
+  // coincide in the missing dimensions, their pixels are only read once.
   cl_float4 Ci0j0k0 = getColorInFloat(cl_int4{i0, j0, k0, 0});
-  
   cl_float4 Ci1j0k0 = getColorInFloat(cl_int4{i1, j0, k0, 0});
-  
-  cl_float4 Ci0j1k0 = getColorInFloat(cl_int4{i0, j1, k0, 0});
-  
-  cl_float4 Ci1j1k0 = getColorInFloat(cl_int4{i1, j1, k0, 0});
-  
-  cl_float4 Ci0j0k1 = getColorInFloat(cl_int4{i0, j0, k1, 0});
-  
-  cl_float4 Ci1j0k1 = getColorInFloat(cl_int4{i1, j0, k1, 0});
-  
-  cl_float4 Ci0j1k1 = getColorInFloat(cl_int4{i0, j1, k1, 0});
-  
-  cl_float4 Ci1j1k1 = getColorInFloat(cl_int4{i1, j1, k1, 0});
+  cl_float4 Ci0j1k0 =
+      j1 == j0 ? Ci0j0k0 : getColorInFloat(cl_int4{i0, j1, k0, 0});
+  cl_float4 Ci1j1k0 =
+      j1 == j0 ? Ci1j0k0 : getColorInFloat(cl_int4{i1, j1, k0, 0});
+  cl_float4 Ci0j0k1 =
+      k1 == k0 ? Ci0j0k0 : getColorInFloat(cl_int4{i0, j0, k1, 0});
+  cl_float4 Ci1j0k1 =
+      k1 == k0 ? Ci1j0k0 : getColorInFloat(cl_int4{i1, j0, k1, 0});
+  cl_float4 Ci0j1k1 =
+      k1 == k0 ? Ci0j1k0 : getColorInFloat(cl_int4{i0, j1, k1, 0});
+  cl_float4 Ci1j1k1 =
+      k1 == k0 ? Ci1j1k0 : getColorInFloat(cl_int4{i1, j1, k1, 0});
 
   cl_float a = abc.x();
   cl_float b = abc.y();
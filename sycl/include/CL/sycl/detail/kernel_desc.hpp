@@ -29,6 +29,11 @@ enum class kernel_param_kind_t {
   kind_pointer
 };
 
+// Set in the info of an accessor parameter when the device compiler has
+// initialized the accessor with __init_no_offset, so that its offset is not
+// passed to the kernel.
+constexpr int kernel_param_accessor_no_offset = 1 << 15;
+
 // describes a kernel parameter
 struct kernel_param_desc_t {
   // parameter kind
@@ -36,7 +41,9 @@ struct kernel_param_desc_t {
   // kind == kind_std_layout
   //   parameter size in bytes (includes padding for structs)
   // kind == kind_accessor
-  //   access target; possible access targets are defined in access/access.hpp
+  //   access target; possible access targets are defined in access/access.hpp,
+  //   the dimensions of the accessor shifted by 11 bits and the
+  //   kernel_param_accessor_no_offset flag
   int info;
   // offset of the captured value of the parameter in the lambda or function
   // object
@@ -25,6 +25,7 @@ namespace detail {
 class queue_impl;
 class event_impl;
 class context_impl;
+struct USMRect;
 
 using QueueImplPtr = std::shared_ptr<detail::queue_impl>;
 using EventImplPtr = std::shared_ptr<detail::event_impl>;
@@ -148,6 +149,17 @@ public:
                        int Pattern, std::vector<RT::PiEvent> DepEvents,
                        RT::PiEvent &OutEvent);
 
+  static void copy_usm_rect(const void *SrcMem, QueueImplPtr Queue,
+                            const USMRect &Rect, void *DstMem,
+                            std::vector<RT::PiEvent> DepEvents,
+                            RT::PiEvent &OutEvent);
+
+  static void fill_usm_rect(void *DstMem, QueueImplPtr Queue,
+                            const USMRect &Rect,
+                            const std::vector<char> &Pattern,
+                            std::vector<RT::PiEvent> DepEvents,
+                            RT::PiEvent &OutEvent);
+
   static void prefetch_usm(void *Ptr, QueueImplPtr Queue, size_t Len,
                            std::vector<RT::PiEvent> DepEvents,
                            RT::PiEvent &OutEvent);
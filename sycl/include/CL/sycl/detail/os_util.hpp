@@ -80,6 +80,14 @@ public:
 
   /// Deallocates the memory referenced by \p Ptr.
   static void alignedFree(void *Ptr);
+
+  /// Creates directory \p Dir together with all missing parent directories.
+  /// Returns 0 on success (including the case when the directory already
+  /// exists), nonzero otherwise.
+  static int makeDir(const char *Dir);
+
+  /// Checks whether a file or a directory exists at \p Path.
+  static bool isPathPresent(const std::string &Path);
 };
 
 } // namespace detail
@@ -28,6 +28,26 @@
 // addition to the increase of the minor.
 //
 // PI version changes log:
+// -- Version 2.12:
+// 1. PI_EXT_ONEAPI_QUEUE_SPIN_WAIT queue property added.
+// -- Version 2.11:
+// 1. piextUSMEnqueueMemcpyRect and piextUSMEnqueueFillRect added.
+// -- Version 2.10:
+// 1. piextUSMImport and piextUSMRelease added.
+// -- Version 2.9:
+// 1. PI_EXT_ONEAPI_QUEUE_SUB_DEVICE_SCALING queue property added.
+// -- Version 2.8:
+// 1. PI_EXT_ONEAPI_MEM_ALLOC_STRIPE_SIZE USM allocation property added.
+// -- Version 2.7:
+// 1. PI_EXT_ONEAPI_QUEUE_PRIORITY_LOW and PI_EXT_ONEAPI_QUEUE_PRIORITY_HIGH
+// queue properties added.
+// -- Version 2.6:
+// 1. piextEnqueueMemBufferCopyPeer added.
+// -- Version 2.5:
+// 1. piextKernelSetArgs and the pi_kernel_arg structure added.
+// -- Version 2.4:
+// 1. piextQueueBeginGraphCapture, piextQueueEndGraphCapture,
+// piextEnqueueCommandGraph and piextCommandGraphRelease added.
 // -- Version 1.2:
 // 1. (Binary backward compatibility breaks) Two fields added to the
 // pi_device_binary_struct structure:
@@ -36,7 +56,7 @@
 // 2. A number of types needed to define pi_device_binary_property_set added.
 //
 #define _PI_H_VERSION_MAJOR 2
-#define _PI_H_VERSION_MINOR 3
+#define _PI_H_VERSION_MINOR 12
 
 #define _PI_STRING_HELPER(a) #a
 #define _PI_CONCAT(a, b) _PI_STRING_HELPER(a.b)
@@ -531,6 +551,18 @@ constexpr pi_queue_properties PI_QUEUE_PROFILING_ENABLE =
 constexpr pi_queue_properties PI_QUEUE_ON_DEVICE = CL_QUEUE_ON_DEVICE;
 constexpr pi_queue_properties PI_QUEUE_ON_DEVICE_DEFAULT =
     CL_QUEUE_ON_DEVICE_DEFAULT;
+// The priority of the work of the queue relative to the other queues of the
+// device. The plugins which can't prioritize queues ignore them.
+constexpr pi_queue_properties PI_EXT_ONEAPI_QUEUE_PRIORITY_LOW = (1 << 18);
+constexpr pi_queue_properties PI_EXT_ONEAPI_QUEUE_PRIORITY_HIGH = (1 << 19);
+// The kernels of an out-of-order queue on a root device are spread across the
+// sub-devices of the device. The plugins which can't do it ignore it.
+constexpr pi_queue_properties PI_EXT_ONEAPI_QUEUE_SUB_DEVICE_SCALING =
+    (1 << 20);
+// The waits on the events of the queue poll them for a while before blocking,
+// which detects the completion of short commands sooner at the cost of a busy
+// host thread. The plugins which can't poll the events ignore it.
+constexpr pi_queue_properties PI_EXT_ONEAPI_QUEUE_SPIN_WAIT = (1 << 21);
 
 using pi_result = _pi_result;
 using pi_platform_info = _pi_platform_info;
@@ -671,6 +703,26 @@ static const uint8_t PI_DEVICE_BINARY_OFFLOAD_KIND_SYCL = 4;
 #define __SYCL_PI_PROPERTY_SET_DEVICELIB_REQ_MASK "SYCL/devicelib req mask"
 /// PropertySetRegistry::SYCL_KERNEL_PARAM_OPT_INFO defined in PropertySetIO.h
 #define __SYCL_PI_PROPERTY_SET_KERNEL_PARAM_OPT_INFO "SYCL/kernel param opt"
+/// PropertySetRegistry::SYCL_KERNEL_PARAM_FIELD_OPT_INFO defined in
+/// PropertySetIO.h
+#define __SYCL_PI_PROPERTY_SET_KERNEL_PARAM_FIELD_OPT_INFO                     \
+  "SYCL/kernel param field opt"
+/// PropertySetRegistry::SYCL_COMPRESSED_IMAGE defined in PropertySetIO.h
+#define __SYCL_PI_PROPERTY_SET_COMPRESSED_IMAGE "SYCL/compressed image"
+/// PropertySetRegistry::SYCL_SPEC_CONST_BUFFER_LAYOUT defined in
+/// PropertySetIO.h
+#define __SYCL_PI_PROPERTY_SET_SPEC_CONST_BUFFER_LAYOUT                        \
+  "SYCL/spec constants buffer layout"
+/// PropertySetRegistry::SYCL_KERNEL_SPEC_CONST_BUFFER defined in
+/// PropertySetIO.h
+#define __SYCL_PI_PROPERTY_SET_KERNEL_SPEC_CONST_BUFFER                        \
+  "SYCL/kernel spec constants buffer"
+/// PropertySetRegistry::SYCL_MISC_PROP defined in PropertySetIO.h
+#define __SYCL_PI_PROPERTY_SET_SYCL_MISC_PROP "SYCL/misc properties"
+/// PropertySetRegistry::SYCL_SUB_GROUP_SIZE_VARIANTS defined in
+/// PropertySetIO.h
+#define __SYCL_PI_PROPERTY_SET_SUB_GROUP_SIZE_VARIANTS                         \
+  "SYCL/sub-group size variants"
 
 /// This struct is a record of the device binary information. If the Kind field
 /// denotes a portable binary type (SPIR-V or LLVM IR), the DeviceTargetSpec
@@ -769,7 +821,19 @@ struct pi_image_region_struct {
 using pi_image_region = pi_image_region_struct *;
 
 // Offload binaries descriptor version supported by this library.
-static const uint16_t PI_DEVICE_BINARIES_VERSION = 1;
+// -- version 2: added the kernel name table
+static const uint16_t PI_DEVICE_BINARIES_VERSION = 2;
+
+/// An element of the kernel name table of a binary descriptor. The table lists
+/// every kernel of the descriptor once and is sorted by kernel name in
+/// strcmp order, so it can be binary searched in place.
+struct _pi_kernel_name_entry_struct {
+  /// Null-terminated name of the kernel
+  const char *Name;
+  /// Index of the first device binary in the descriptor containing the kernel
+  uint32_t ImageIndex;
+};
+using _pi_kernel_name_entry = _pi_kernel_name_entry_struct *;
 
 /// This struct is a record of all the device code that may be offloaded.
 /// It must match the __tgt_bin_desc structure generated by
@@ -786,6 +850,9 @@ struct pi_device_binaries_struct {
   /// the offload entry table (not used, for compatibility with OpenMP)
   _pi_offload_entry *HostEntriesBegin;
   _pi_offload_entry *HostEntriesEnd;
+  /// The kernel name table, present since version 2
+  _pi_kernel_name_entry KernelNamesBegin;
+  _pi_kernel_name_entry KernelNamesEnd;
 };
 using pi_device_binaries = pi_device_binaries_struct *;
 
@@ -799,6 +866,7 @@ struct _pi_program;
 struct _pi_kernel;
 struct _pi_event;
 struct _pi_sampler;
+struct _pi_ext_command_graph;
 
 using pi_platform = _pi_platform *;
 using pi_device = _pi_device *;
@@ -809,6 +877,7 @@ using pi_program = _pi_program *;
 using pi_kernel = _pi_kernel *;
 using pi_event = _pi_event *;
 using pi_sampler = _pi_sampler *;
+using pi_ext_command_graph = _pi_ext_command_graph *;
 
 typedef struct {
   pi_image_channel_order image_channel_order;
@@ -1366,6 +1435,24 @@ __SYCL_EXPORT pi_result piEnqueueMemBufferCopyRect(
     pi_uint32 num_events_in_wait_list, const pi_event *event_wait_list,
     pi_event *event);
 
+/// Copies memory between buffers of different contexts of the same plugin
+/// without staging the data in host memory, e.g. over a peer-to-peer link of
+/// the devices.
+///
+/// \param src_queue is the queue the copy is enqueued to. It must belong to the
+/// context of src_buffer.
+/// \param dst_queue is a queue of the context and the device of dst_buffer.
+/// \param event_wait_list are events of the context of src_queue.
+/// \param event is an event of the context of src_queue.
+///
+/// \return PI_INVALID_OPERATION if the devices can't access each other's
+/// memory; nothing is enqueued then.
+__SYCL_EXPORT pi_result piextEnqueueMemBufferCopyPeer(
+    pi_queue src_queue, pi_mem src_buffer, size_t src_offset,
+    pi_queue dst_queue, pi_mem dst_buffer, size_t dst_offset, size_t size,
+    pi_uint32 num_events_in_wait_list, const pi_event *event_wait_list,
+    pi_event *event);
+
 __SYCL_EXPORT pi_result
 piEnqueueMemBufferFill(pi_queue command_queue, pi_mem buffer,
                        const void *pattern, size_t pattern_size, size_t offset,
@@ -1425,6 +1512,38 @@ __SYCL_EXPORT pi_result piextKernelSetArgSampler(pi_kernel kernel,
                                                  pi_uint32 arg_index,
                                                  const pi_sampler *arg_value);
 
+typedef enum {
+  PI_KERNEL_ARG_VALUE = 0,   ///< as passed to piKernelSetArg
+  PI_KERNEL_ARG_MEM_OBJ = 1, ///< as passed to piextKernelSetArgMemObj
+  PI_KERNEL_ARG_SAMPLER = 2, ///< as passed to piextKernelSetArgSampler
+  PI_KERNEL_ARG_POINTER = 3  ///< as passed to piextKernelSetArgPointer
+} _pi_kernel_arg_kind;
+
+using pi_kernel_arg_kind = _pi_kernel_arg_kind;
+
+/// Describes a single argument passed to piextKernelSetArgs.
+struct pi_kernel_arg {
+  pi_kernel_arg_kind kind;
+  pi_uint32 index;
+  /// The size of the argument, ignored for memory objects and samplers.
+  size_t size;
+  /// Points to the value of the argument, to a pi_mem or to a pi_sampler
+  /// depending on the kind.
+  const void *value;
+};
+
+/// Sets several kernel arguments at once, as if piKernelSetArg or the
+/// corresponding extension was called for each of them in order. Setting all
+/// arguments of a launch with a single call saves the per-argument cost of
+/// crossing the plugin boundary.
+///
+/// \param kernel is the kernel to set the arguments of.
+/// \param num_args is the number of elements of args.
+/// \param args are the arguments to set.
+__SYCL_EXPORT pi_result piextKernelSetArgs(pi_kernel kernel,
+                                           pi_uint32 num_args,
+                                           const pi_kernel_arg *args);
+
 ///
 // USM
 ///
@@ -1461,7 +1580,10 @@ typedef enum {
 } _pi_usm_type;
 
 typedef enum : pi_bitfield {
-  PI_MEM_ALLOC_FLAGS = CL_MEM_ALLOC_FLAGS_INTEL
+  PI_MEM_ALLOC_FLAGS = CL_MEM_ALLOC_FLAGS_INTEL,
+  // The shared allocation is split in stripes of the given size, which are
+  // placed on the devices of the context in turn.
+  PI_EXT_ONEAPI_MEM_ALLOC_STRIPE_SIZE = 0x10000
 } _pi_usm_mem_properties;
 
 typedef enum : pi_bitfield {
@@ -1520,6 +1642,25 @@ __SYCL_EXPORT pi_result piextUSMSharedAlloc(void **result_ptr,
 /// \param ptr is the memory to be freed
 __SYCL_EXPORT pi_result piextUSMFree(pi_context context, void *ptr);
 
+/// Registers host memory which is not a USM allocation with the driver, e.g.
+/// the memory of a buffer created with use_host_ptr, so that the copies
+/// between it and the devices of the context run as from pinned memory.
+///
+/// \param ptr is the start of the host memory
+/// \param size is the size of the host memory in bytes
+/// \param context is the pi_context the memory is registered with
+/// \return PI_INVALID_OPERATION if the memory can't be registered, e.g. because
+/// it overlaps memory registered already.
+__SYCL_EXPORT pi_result piextUSMImport(const void *ptr, size_t size,
+                                       pi_context context);
+
+/// Releases the registration of host memory made by piextUSMImport. No copy
+/// from or to the memory may be in progress.
+///
+/// \param ptr is the start of the host memory passed to piextUSMImport
+/// \param context is the pi_context the memory is registered with
+__SYCL_EXPORT pi_result piextUSMRelease(const void *ptr, pi_context context);
+
 /// USM Memset API
 ///
 /// \param queue is the queue to submit to
@@ -1554,6 +1695,50 @@ __SYCL_EXPORT pi_result piextUSMEnqueueMemcpy(pi_queue queue, pi_bool blocking,
                                               const pi_event *events_waitlist,
                                               pi_event *event);
 
+/// USM rectangular Memcpy API
+///
+/// Copies a rectangle of \p region->depth_scalar slices of
+/// \p region->height_scalar rows of \p region->width_bytes bytes each.
+///
+/// \param queue is the queue to submit to
+/// \param blocking is whether this operation should block the host
+/// \param dst_ptr is the location the data will be copied
+/// \param dst_row_pitch is the distance in bytes between the rows of dst_ptr
+/// \param dst_slice_pitch is the distance in bytes between the slices of
+///        dst_ptr
+/// \param src_ptr is the data to be copied
+/// \param src_row_pitch is the distance in bytes between the rows of src_ptr
+/// \param src_slice_pitch is the distance in bytes between the slices of
+///        src_ptr
+/// \param region is the size of the rectangle to copy
+/// \param num_events_in_waitlist is the number of events to wait on
+/// \param events_waitlist is an array of events to wait on
+/// \param event is the event that represents this operation
+__SYCL_EXPORT pi_result piextUSMEnqueueMemcpyRect(
+    pi_queue queue, pi_bool blocking, void *dst_ptr, size_t dst_row_pitch,
+    size_t dst_slice_pitch, const void *src_ptr, size_t src_row_pitch,
+    size_t src_slice_pitch, pi_buff_rect_region region,
+    pi_uint32 num_events_in_waitlist, const pi_event *events_waitlist,
+    pi_event *event);
+
+/// USM rectangular Fill API
+///
+/// \param queue is the queue to submit to
+/// \param ptr is the first row to fill
+/// \param row_pitch is the distance in bytes between the rows of ptr
+/// \param pattern is the pattern the rows are filled with
+/// \param pattern_size is the size in bytes of the pattern, a power of two
+/// \param width is the size in bytes of the rows, a multiple of pattern_size
+/// \param height is the number of rows to fill
+/// \param num_events_in_waitlist is the number of events to wait on
+/// \param events_waitlist is an array of events to wait on
+/// \param event is the event that represents this operation
+__SYCL_EXPORT pi_result piextUSMEnqueueFillRect(
+    pi_queue queue, void *ptr, size_t row_pitch, const void *pattern,
+    size_t pattern_size, size_t width, size_t height,
+    pi_uint32 num_events_in_waitlist, const pi_event *events_waitlist,
+    pi_event *event);
+
 /// Hint to migrate memory to the device
 ///
 /// \param queue is the queue to submit to
@@ -1601,6 +1786,45 @@ __SYCL_EXPORT pi_result piextUSMGetMemAllocInfo(
     pi_context context, const void *ptr, pi_mem_info param_name,
     size_t param_value_size, void *param_value, size_t *param_value_size_ret);
 
+///
+// Command graphs
+///
+
+/// Starts recording the commands enqueued to the queue into a command graph
+/// instead of executing them. The queue must not have pending work and must
+/// not be waited on by the host until the recording is finished.
+///
+/// Plugins which don't support command graphs return PI_INVALID_OPERATION.
+///
+/// \param queue is the queue to record.
+__SYCL_EXPORT pi_result piextQueueBeginGraphCapture(pi_queue queue);
+
+/// Finishes the recording started by piextQueueBeginGraphCapture.
+///
+/// \param queue is the recorded queue.
+/// \param graph is the resulting executable graph. If it points to a graph
+/// recorded before, that graph is updated in place with the arguments of the
+/// new recording, which is cheaper than creating a new graph when the
+/// sequence of commands is the same.
+__SYCL_EXPORT pi_result piextQueueEndGraphCapture(pi_queue queue,
+                                                  pi_ext_command_graph *graph);
+
+/// Enqueues all commands of the graph as a single operation.
+///
+/// \param queue is the queue to submit to. It must belong to the context
+/// and the device of the recorded queue.
+/// \param graph is the graph to execute.
+/// \param num_events_in_wait_list is the number of events to wait on
+/// \param event_wait_list is an array of events to wait on
+/// \param event is the event that represents the execution of the graph
+__SYCL_EXPORT pi_result piextEnqueueCommandGraph(
+    pi_queue queue, pi_ext_command_graph graph,
+    pi_uint32 num_events_in_wait_list, const pi_event *event_wait_list,
+    pi_event *event);
+
+/// Releases the graph created by piextQueueEndGraphCapture.
+__SYCL_EXPORT pi_result piextCommandGraphRelease(pi_ext_command_graph graph);
+
 struct _pi_plugin {
   // PI version supported by host passed to the plugin. The Plugin
   // checks and writes the appropriate Function Pointers in
@@ -98,11 +98,13 @@ using PiDeviceBinaryType = ::pi_device_binary_type;
 using PiContext = ::pi_context;
 using PiProgram = ::pi_program;
 using PiKernel = ::pi_kernel;
+using PiKernelArg = ::pi_kernel_arg;
 using PiQueue = ::pi_queue;
 using PiQueueProperties = ::pi_queue_properties;
 using PiMem = ::pi_mem;
 using PiMemFlags = ::pi_mem_flags;
 using PiEvent = ::pi_event;
+using PiExtCommandGraph = ::pi_ext_command_graph;
 using PiSampler = ::pi_sampler;
 using PiSamplerInfo = ::pi_sampler_info;
 using PiSamplerProperties = ::pi_sampler_properties;
@@ -150,8 +152,8 @@ template <PiApiKind PiApiOffset> struct PiFuncInfo {};
 #define _PI_API(api)                                                           \
   template <> struct PiFuncInfo<PiApiKind::api> {                              \
     using FuncPtrT = decltype(&::api);                                         \
-    inline std::string getFuncName() { return #api; }                          \
-    inline FuncPtrT getFuncPtr(PiPlugin MPlugin) {                             \
+    inline const char *getFuncName() { return #api; }                          \
+    inline FuncPtrT getFuncPtr(const PiPlugin &MPlugin) {                      \
       return MPlugin.PiFunctionTable.api;                                      \
     }                                                                          \
   };
@@ -313,6 +315,50 @@ public:
   const PropertyRange &getKernelParamOptInfo() const {
     return KernelParamOptInfo;
   }
+  /// Gets the iterator range over the kernels with aggregate parameters of
+  /// which only parts are passed. For each property pointed to by an iterator
+  /// within the range, the name of the property is the kernel name and the
+  /// value is a list of 32-bit unsigned integers: for each such parameter, its
+  /// index, the number of byte ranges to pass and the offset and size of each
+  /// range.
+  const PropertyRange &getKernelParamFieldOptInfo() const {
+    return KernelParamFieldOptInfo;
+  }
+  /// Gets the iterator range over the properties of a compressed binary
+  /// image. The range is available only if the image data is compressed with
+  /// zlib, in which case the "UncompressedSize" property is the 32-bit size of
+  /// the original image.
+  const PropertyRange &getCompressedImageInfo() const {
+    return CompressedImageInfo;
+  }
+  /// Gets the iterator range over the spec constants emulated in the image.
+  /// Such spec constants are passed to the kernels in a buffer; for each
+  /// property pointed to by an iterator within the range, the name of the
+  /// property is the spec constant symbolic ID and the value is the 32-bit
+  /// offset of the spec constant in the buffer.
+  const PropertyRange &getSpecConstBufferLayout() const {
+    return SpecConstBufferLayout;
+  }
+  /// Gets the iterator range over the kernels taking the emulated spec
+  /// constants buffer. For each property pointed to by an iterator within the
+  /// range, the name of the property is the kernel name and the value is a
+  /// pair of 32-bit unsigned integers: the index of the implicit argument
+  /// taking the buffer and the size of the buffer.
+  const PropertyRange &getKernelSpecConstBuffer() const {
+    return KernelSpecConstBuffer;
+  }
+  /// Gets the iterator range over the miscellaneous properties of the image,
+  /// e.g. the 32-bit "isEsimdImage" property set to 1 if its kernels are
+  /// ESIMD ones.
+  const PropertyRange &getMiscProperties() const { return MiscProperties; }
+  /// Gets the iterator range over the kernels of the image compiled for
+  /// several required sub-group sizes. For each property pointed to by an
+  /// iterator within the range, the name of the property is the kernel name
+  /// and the value is the list of the 32-bit sizes, the variant for size N
+  /// being named after the kernel followed by "__sgN".
+  const PropertyRange &getSubGroupSizeVariants() const {
+    return SubGroupSizeVariants;
+  }
   virtual ~DeviceBinaryImage() {}
 
 protected:
@@ -325,6 +371,12 @@ protected:
   DeviceBinaryImage::PropertyRange CompositeSpecConstIDMap;
   DeviceBinaryImage::PropertyRange DeviceLibReqMask;
   DeviceBinaryImage::PropertyRange KernelParamOptInfo;
+  DeviceBinaryImage::PropertyRange KernelParamFieldOptInfo;
+  DeviceBinaryImage::PropertyRange CompressedImageInfo;
+  DeviceBinaryImage::PropertyRange SpecConstBufferLayout;
+  DeviceBinaryImage::PropertyRange KernelSpecConstBuffer;
+  DeviceBinaryImage::PropertyRange MiscProperties;
+  DeviceBinaryImage::PropertyRange SubGroupSizeVariants;
 };
 
 /// Tries to determine the device binary image foramat. Returns
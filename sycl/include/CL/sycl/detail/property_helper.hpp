@@ -31,6 +31,13 @@ enum DataLessPropKind {
   NoInit,
   BufferUsePinnedHostMemory,
   UsePrimaryContext,
+  QueuePrefetchSharedUSM,
+  QueueDiscardEvents,
+  QueuePriorityNormal,
+  QueuePriorityLow,
+  QueuePriorityHigh,
+  QueueSubDeviceScaling,
+  QueueSpinWait,
   DataLessPropKindSize
 };
 
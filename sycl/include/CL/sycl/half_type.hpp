@@ -15,10 +15,15 @@
 #include <array>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <iostream>
 #include <limits>
 
+#if !defined(__SYCL_DEVICE_ONLY__) && defined(__F16C__)
+#include <immintrin.h>
+#endif
+
 #ifdef __SYCL_DEVICE_ONLY__
 // `constexpr` could work because the implicit conversion from `float` to
 // `_Float16` can be `constexpr`.
@@ -32,6 +37,109 @@ namespace sycl {
 namespace detail {
 namespace host_half_impl {
 
+// The conversions of the host half type. They round to the nearest even half
+// as the conversion instructions of the processors, which are used when the
+// code is compiled for them, e.g. with -mf16c on x86.
+inline uint16_t float2Half(const float &Val) {
+#if !defined(__SYCL_DEVICE_ONLY__) && defined(__F16C__)
+  return _cvtss_sh(Val, _MM_FROUND_TO_NEAREST_INT);
+#elif !defined(__SYCL_DEVICE_ONLY__) && defined(__aarch64__)
+  const __fp16 Half = Val;
+  uint16_t Ret;
+  std::memcpy(&Ret, &Half, sizeof(Ret));
+  return Ret;
+#else
+  uint32_t Bits;
+  std::memcpy(&Bits, &Val, sizeof(Bits));
+
+  // Extract the sign from the float value
+  const uint16_t Sign = (Bits & 0x80000000) >> 16;
+  uint32_t Abs = Bits & 0x7fffffff;
+
+  // NaN, infinity, and the numbers from 65520, which round to infinity
+  if (Abs >= 0x477ff000) {
+    if (Abs > 0x7f800000)
+      // The NaN is quiet and keeps the high bits of the fraction.
+      return Sign | 0x7e00 | ((Abs >> 13) & 0x3ff);
+    return Sign | 0x7c00;
+  }
+
+  // Subnormals and zero: the addition of 0.5 aligns the fraction on the unit
+  // of the subnormal halves, 2^-24, and rounds it to the nearest even.
+  if (Abs < 0x38800000) {
+    float Aligned;
+    std::memcpy(&Aligned, &Abs, sizeof(Aligned));
+    Aligned += 0.5f;
+    uint32_t AlignedBits;
+    std::memcpy(&AlignedBits, &Aligned, sizeof(AlignedBits));
+    return Sign | (AlignedBits - 0x3f000000);
+  }
+
+  // Normal range for half type: rebias the exponent, and round the 23-bit
+  // mantissa to 10 bits, to the nearest even. The carry of the rounding may
+  // increment the exponent, up to infinity.
+  const uint32_t Odd = (Abs >> 13) & 1;
+  Abs += 0xfff + Odd - (uint32_t(127 - 15) << 23);
+  return Sign | (Abs >> 13);
+#endif
+}
+
+inline float half2Float(const uint16_t &Val) {
+#if !defined(__SYCL_DEVICE_ONLY__) && defined(__F16C__)
+  return _cvtsh_ss(Val);
+#elif !defined(__SYCL_DEVICE_ONLY__) && defined(__aarch64__)
+  __fp16 Half;
+  std::memcpy(&Half, &Val, sizeof(Half));
+  return Half;
+#else
+  // Extract the sign from the bits
+  const uint32_t Sign = static_cast<uint32_t>(Val & 0x8000) << 16;
+  // Extract the exponent from the bits
+  const uint8_t Exp16 = (Val & 0x7c00) >> 10;
+  // Extract the fraction from the bits
+  uint16_t Frac16 = Val & 0x3ff;
+
+  uint32_t Exp32 = 0;
+  if (Exp16 == 0x1f) {
+    Exp32 = 0xff;
+  } else if (Exp16 == 0) {
+    Exp32 = 0;
+  } else {
+    Exp32 = static_cast<uint32_t>(Exp16) + 112;
+  }
+
+  // corner case: subnormal -> normal
+  // The denormal number of FP16 can be represented by FP32, therefore we need
+  // to recover the exponent and recalculate the fration.
+  if (Exp16 == 0 && Frac16 != 0) {
+    uint8_t OffSet = 0;
+    do {
+      ++OffSet;
+      Frac16 <<= 1;
+    } while ((Frac16 & 0x400) != 0x400);
+    // mask the 9th bit
+    Frac16 &= 0x3ff;
+    Exp32 = 113 - OffSet;
+  }
+
+  uint32_t Frac32 = Frac16 << 13;
+
+  // Compose the final FP32 binary
+  uint32_t Bits = 0;
+
+  Bits |= Sign;
+  Bits |= (Exp32 << 23);
+  Bits |= Frac32;
+  // The NaN is quiet, as with the conversion instructions.
+  if (Exp16 == 0x1f && Frac16 != 0)
+    Bits |= 0x400000;
+
+  float Result;
+  std::memcpy(&Result, &Bits, sizeof(Result));
+  return Result;
+#endif
+}
+
 class __SYCL_EXPORT half {
 public:
   half() = default;
@@ -83,6 +191,34 @@ private:
   uint16_t Buf;
 };
 
+#if !__SYCL_BUILD_SYCL_DLL
+// The members are inlined into the applications. The library defines them out
+// of line too, in half_type.cpp, for the applications built before.
+inline half::half(const float &RHS) : Buf(float2Half(RHS)) {}
+
+inline half &half::operator+=(const half &RHS) {
+  *this = operator float() + static_cast<float>(RHS);
+  return *this;
+}
+
+inline half &half::operator-=(const half &RHS) {
+  *this = operator float() - static_cast<float>(RHS);
+  return *this;
+}
+
+inline half &half::operator*=(const half &RHS) {
+  *this = operator float() * static_cast<float>(RHS);
+  return *this;
+}
+
+inline half &half::operator/=(const half &RHS) {
+  *this = operator float() / static_cast<float>(RHS);
+  return *this;
+}
+
+inline half::operator float() const { return half2Float(Buf); }
+#endif // !__SYCL_BUILD_SYCL_DLL
+
 } // namespace host_half_impl
 
 namespace half_impl {
@@ -31,7 +31,9 @@
 #include <functional>
 #include <limits>
 #include <memory>
+#include <tuple>
 #include <type_traits>
+#include <utility>
 
 // SYCL_LANGUAGE_VERSION is 4 digit year followed by 2 digit revision
 #if !SYCL_LANGUAGE_VERSION || SYCL_LANGUAGE_VERSION < 202001
@@ -44,6 +46,7 @@ template <typename DataT, int Dimensions, cl::sycl::access::mode AccessMode,
 class __fill;
 
 template <typename T> class __usmfill;
+template <typename T> class __usmfill2d;
 
 template <typename T_Src, typename T_Dst, int Dims,
           cl::sycl::access::mode AccessMode,
@@ -154,6 +157,19 @@ public:
 
 __SYCL_EXPORT device getDeviceFromHandler(handler &);
 
+/// Returns the process-wide integer ID of the kernel with the given name
+/// coming from the OS module the name belongs to. The runtime uses the ID to
+/// find the built kernel without any string processing. Never returns zero.
+__SYCL_EXPORT unsigned int getKernelID(const char *KernelName);
+
+/// Returns the integer ID of the kernel. The ID is requested from the runtime
+/// once per kernel and then kept for subsequent submissions.
+template <typename KernelName> unsigned int getKernelID() {
+  static const unsigned int ID =
+      getKernelID(KernelInfo<KernelName>::getName());
+  return ID;
+}
+
 #if __SYCL_ID_QUERIES_FIT_IN_INT__
 template <typename T> struct NotIntMsg;
 
@@ -256,10 +272,35 @@ enable_if_t<!Reduction::has_fast_atomics>
 reduCGFunc(handler &CGH, KernelType KernelFunc, const nd_range<Dims> &Range,
            Reduction &Redu);
 
-template <typename KernelName, typename KernelType, class Reduction>
-enable_if_t<!Reduction::has_fast_atomics, size_t>
-reduAuxCGFunc(handler &CGH, size_t NWorkItems, size_t MaxWGSize,
-              Reduction &Redu);
+template <typename KernelName, int Dims, typename... RestT, size_t... Is>
+void reduCGFunc(handler &CGH, const nd_range<Dims> &Range,
+                std::tuple<RestT...> &ArgsTuple, std::index_sequence<Is...>);
+
+template <typename... RestT, size_t... Is>
+size_t reduGetMemPerWorkItem(std::tuple<RestT...> &ArgsTuple,
+                             std::index_sequence<Is...>);
+
+/// Checks if the type \p T is a reduction, i.e. an object returned by
+/// ONEAPI::reduction().
+template <typename T> struct IsReduction : std::false_type {};
+
+template <typename T, class BinaryOperation, int Dims, bool IsUSM,
+          access::mode AccMode, access::placeholder IsPlaceholder>
+struct IsReduction<
+    reduction_impl<T, BinaryOperation, Dims, IsUSM, AccMode, IsPlaceholder>>
+    : std::true_type {};
+
+/// Checks that all the types except the last one are reductions and the last
+/// one is not, i.e. that the types are the arguments of parallel_for() with
+/// several reductions followed by the kernel function.
+template <typename FirstT, typename... RestT> struct AreAllButLastReductions {
+  static constexpr bool value = IsReduction<FirstT>::value &&
+                                AreAllButLastReductions<RestT...>::value;
+};
+
+template <typename T> struct AreAllButLastReductions<T> {
+  static constexpr bool value = !IsReduction<T>::value;
+};
 
 __SYCL_EXPORT size_t reduGetMaxWGSize(shared_ptr_class<queue_impl> Queue,
                                       size_t LocalMemBytesPerWorkItem);
@@ -507,8 +548,10 @@ private:
   template <typename KernelName, typename KernelType, int Dims,
             typename LambdaArgType>
   void StoreLambda(KernelType KernelFunc) {
-    MHostKernel.reset(
-        new detail::HostKernel<KernelType, LambdaArgType, Dims>(KernelFunc));
+    // The lambda is moved, not copied, so that the accessors it captures are
+    // not retained and released once more
+    MHostKernel.reset(new detail::HostKernel<KernelType, LambdaArgType, Dims>(
+        std::move(KernelFunc)));
 
     using KI = sycl::detail::KernelInfo<KernelName>;
     // Empty name indicates that the compilation happens without integration
@@ -520,6 +563,7 @@ private:
                                    &KI::getParamDesc(0), KI::isESIMD());
       MKernelName = KI::getName();
       MOSModuleHandle = detail::OSUtil::getOSModuleHandle(KI::getName());
+      MKernelID = detail::getKernelID<KernelName>();
     } else {
       // In case w/o the integration header it is necessary to process
       // accessors from the list(which are associated with this handler) as
@@ -1231,7 +1275,6 @@ public:
   /// globally visible, there is no need for the developer to provide
   /// a kernel name for it.
   ///
-  /// TODO: Need to handle more than 1 reduction in parallel_for().
   /// TODO: Support HOST. The kernels called by this parallel_for() may use
   /// some functionality that is not yet supported on HOST such as:
   /// barrier(), and ONEAPI::reduce() that also may be used in more
@@ -1241,27 +1284,16 @@ public:
   detail::enable_if_t<!Reduction::has_fast_atomics>
   parallel_for(nd_range<Dims> Range, Reduction Redu,
                _KERNELFUNCPARAM(KernelFunc)) {
-    // This parallel_for() is lowered to the following sequence:
-    // 1) Call a kernel that a) call user's lambda function and b) performs
-    //    one iteration of reduction, storing the partial reductions/sums
-    //    to either a newly created global buffer or to user's reduction
-    //    accessor. So, if the original 'Range' has totally
-    //    N1 elements and work-group size is W, then after the first iteration
-    //    there will be N2 partial sums where N2 = N1 / W.
-    //    If (N2 == 1) then the partial sum is written to user's accessor.
-    //    Otherwise, a new global buffer is created and partial sums are written
-    //    to it.
-    // 2) Call an aux kernel (if necessary, i.e. if N2 > 1) as many times as
-    //    necessary to reduce all partial sums into one final sum.
-
-    // Before running the kernels, check that device has enough local memory
+    // This parallel_for() is lowered to a single kernel that a) calls user's
+    // lambda function, b) reduces the elements of each work-group and stores
+    // the partial sum to a global buffer, and c) in the work-group that
+    // finishes last, reduces the partial sums into the final result.
+
+    // Before running the kernel, check that device has enough local memory
     // to hold local arrays that may be required for the reduction algorithm.
     // TODO: If the work-group-size is limited by the local memory, then
-    // a special version of the main kernel may be created. The one that would
-    // not use local accessors, which means it would not do the reduction in
-    // the main kernel, but simply generate Range.get_global_range.size() number
-    // of partial sums, leaving the reduction work to the additional/aux
-    // kernels.
+    // a special version of the kernel may be created. The one that would
+    // not use local accessors.
     constexpr bool HFR = Reduction::has_fast_reduce;
     size_t OneElemSize = HFR ? 0 : sizeof(typename Reduction::result_type);
     // TODO: currently the maximal work group size is determined for the given
@@ -1275,33 +1307,41 @@ public:
                                     std::to_string(MaxWGSize),
                                 PI_INVALID_WORK_GROUP_SIZE);
 
-    // 1. Call the kernel that includes user's lambda function.
     ONEAPI::detail::reduCGFunc<KernelName>(*this, KernelFunc, Range, Redu);
-    shared_ptr_class<detail::queue_impl> QueueCopy = MQueue;
-    this->finalize();
+  }
 
-    // 2. Run the additional kernel as many times as needed to reduce
-    // all partial sums into one scalar.
-
-    // TODO: Create a special slow/sequential version of the kernel that would
-    // handle the reduction instead of reporting an assert below.
-    if (MaxWGSize <= 1)
-      throw sycl::runtime_error("The implementation handling parallel_for with "
-                                "reduction requires the maximal work group "
-                                "size to be greater than 1 to converge. "
-                                "The maximal work group size depends on the "
-                                "device and the size of the objects passed to "
-                                "the reduction.",
+  /// Defines and invokes a SYCL kernel function for the specified nd_range.
+  /// Performs several reductions at once: the arguments \param Rest are
+  /// the reductions followed by the kernel function, which accepts nd_item
+  /// and one reducer per reduction, in the same order.
+  ///
+  /// All the reductions are done by a single kernel, which reduces the values
+  /// of all the reductions together in one tree-reduction, so the work-group
+  /// barriers are shared by the reductions rather than repeated for each of
+  /// them.
+  template <typename KernelName = detail::auto_name, int Dims,
+            typename... RestT>
+  detail::enable_if_t<
+      (sizeof...(RestT) >= 3 &&
+       ONEAPI::detail::AreAllButLastReductions<RestT...>::value)>
+  parallel_for(nd_range<Dims> Range, RestT... Rest) {
+    std::tuple<RestT...> ArgsTuple(Rest...);
+    auto ReduIndices = std::make_index_sequence<sizeof...(RestT) - 1>();
+
+    // Every reduction needs one element of local memory per work-item.
+    size_t LocalMemPerWorkItem =
+        ONEAPI::detail::reduGetMemPerWorkItem(ArgsTuple, ReduIndices);
+    size_t MaxWGSize =
+        ONEAPI::detail::reduGetMaxWGSize(MQueue, LocalMemPerWorkItem);
+    if (Range.get_local_range().size() > MaxWGSize)
+      throw sycl::runtime_error("The implementation handling parallel_for with"
+                                " reduction requires work group size not bigger"
+                                " than " +
+                                    std::to_string(MaxWGSize),
                                 PI_INVALID_WORK_GROUP_SIZE);
-    size_t NWorkItems = Range.get_group_range().size();
-    while (NWorkItems > 1) {
-      handler AuxHandler(QueueCopy, MIsHost);
-      AuxHandler.saveCodeLoc(MCodeLoc);
 
-      NWorkItems = ONEAPI::detail::reduAuxCGFunc<KernelName, KernelType>(
-          AuxHandler, NWorkItems, MaxWGSize, Redu);
-      MLastEvent = AuxHandler.finalize();
-    } // end while (NWorkItems > 1)
+    ONEAPI::detail::reduCGFunc<KernelName>(*this, Range, ArgsTuple,
+                                           ReduIndices);
   }
 
   /// Hierarchical kernel invocation method of a kernel defined as a lambda
@@ -1938,6 +1978,64 @@ public:
   /// \param Count is a number of bytes to copy.
   void memcpy(void *Dest, const void *Src, size_t Count);
 
+  /// Copies a rectangle of rows from one memory region to another, both
+  /// pointed by USM pointers.
+  /// No operations is done if \param Width or \param Height is zero. An
+  /// exception is thrown if either \param Dest or \param Src is nullptr, or
+  /// if a pitch is smaller than \param Width.
+  ///
+  /// \param Dest is a USM pointer to the first row of the destination.
+  /// \param DestPitch is the distance in bytes between the destination rows.
+  /// \param Src is a USM pointer to the first row of the source.
+  /// \param SrcPitch is the distance in bytes between the source rows.
+  /// \param Width is the number of bytes of each row to copy.
+  /// \param Height is the number of rows to copy.
+  void memcpy2d(void *Dest, size_t DestPitch, const void *Src, size_t SrcPitch,
+                size_t Width, size_t Height);
+
+  /// Copies a box of slices of rows from one memory region to another, both
+  /// pointed by USM pointers.
+  /// No operations is done if any of \param Width, \param Height or
+  /// \param Depth is zero. An exception is thrown if either \param Dest or
+  /// \param Src is nullptr, if a pitch is smaller than \param Width or a
+  /// slice pitch is smaller than \param Height of its rows.
+  ///
+  /// \param Dest is a USM pointer to the first row of the destination.
+  /// \param DestPitch is the distance in bytes between the destination rows.
+  /// \param DestSlicePitch is the distance in bytes between the destination
+  /// slices.
+  /// \param Src is a USM pointer to the first row of the source.
+  /// \param SrcPitch is the distance in bytes between the source rows.
+  /// \param SrcSlicePitch is the distance in bytes between the source slices.
+  /// \param Width is the number of bytes of each row to copy.
+  /// \param Height is the number of rows of each slice to copy.
+  /// \param Depth is the number of slices to copy.
+  void memcpy3d(void *Dest, size_t DestPitch, size_t DestSlicePitch,
+                const void *Src, size_t SrcPitch, size_t SrcSlicePitch,
+                size_t Width, size_t Height, size_t Depth);
+
+  /// Fills a rectangle of rows of the memory pointed by a USM pointer with
+  /// the specified pattern.
+  ///
+  /// \param Dest is a USM pointer to the first row to fill.
+  /// \param DestPitch is the distance in bytes between the rows.
+  /// \param Pattern is the pattern to fill into the memory. T should be
+  /// trivially copyable.
+  /// \param Width is the number of times to fill Pattern into each row.
+  /// \param Height is the number of rows to fill.
+  template <typename T>
+  void fill2d(void *Dest, size_t DestPitch, const T &Pattern, size_t Width,
+              size_t Height) {
+    throwIfActionIsCreated();
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Pattern must be trivially copyable");
+    // The plugins fill the patterns of 1, 2 and 4 bytes natively, the other
+    // ones are filled by a kernel.
+    fill2dImpl(Dest, DestPitch, Pattern, Width, Height,
+               std::integral_constant<bool, sizeof(T) == 1 || sizeof(T) == 2 ||
+                                                sizeof(T) == 4>{});
+  }
+
   /// Fills the memory pointed by a USM pointer with the value specified.
   /// No operations is done if \param Count is zero. An exception is thrown
   /// if \param Dest is nullptr. The behavior is undefined if \param Dest
@@ -1957,6 +2055,28 @@ public:
   void prefetch(const void *Ptr, size_t Count);
 
 private:
+  /// Records a FILL_USM_RECT command group for fill2d(), the widths in bytes.
+  void fill2dImpl(void *Dest, size_t DestPitch, const void *Pattern,
+                  size_t PatternSize, size_t Width, size_t Height);
+
+  template <typename T>
+  void fill2dImpl(void *Dest, size_t DestPitch, const T &Pattern, size_t Width,
+                  size_t Height, std::true_type) {
+    fill2dImpl(Dest, DestPitch, &Pattern, sizeof(T), Width * sizeof(T),
+               Height);
+  }
+
+  template <typename T>
+  void fill2dImpl(void *Dest, size_t DestPitch, const T &Pattern, size_t Width,
+                  size_t Height, std::false_type) {
+    parallel_for<class __usmfill2d<T>>(
+        range<2>(Height, Width), [=](id<2> Index) {
+          T *Row = reinterpret_cast<T *>(static_cast<char *>(Dest) +
+                                         Index[0] * DestPitch);
+          Row[Index[1]] = Pattern;
+        });
+  }
+
   shared_ptr_class<detail::queue_impl> MQueue;
   /// The storage for the arguments passed.
   /// We need to store a copy of values that are passed explicitly through
@@ -2007,6 +2127,8 @@ private:
 
   detail::code_location MCodeLoc = {};
   bool MIsFinalized = false;
+  /// Integer ID of the kernel, zero if the kernel is not identified by one.
+  unsigned int MKernelID = 0;
   event MLastEvent;
 
   // Make queue_impl class friend to be able to call finalize method.
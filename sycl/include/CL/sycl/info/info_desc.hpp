@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <CL/sycl/ONEAPI/memory_usage.hpp>
 #include <CL/sycl/detail/common.hpp>
 #include <CL/sycl/detail/pi.hpp>
 #include <CL/sycl/id.hpp>
@@ -37,6 +38,8 @@ enum class context : cl_context_info {
   reference_count = CL_CONTEXT_REFERENCE_COUNT,
   platform = CL_CONTEXT_PLATFORM,
   devices = CL_CONTEXT_DEVICES,
+  // Answered by the runtime, never passed to the plugins.
+  ext_oneapi_memory_usage = 0x10080,
 };
 
 // A.3 Device information descriptors
@@ -19,5 +19,51 @@ class enable_profiling
     : public detail::DataLessProperty<detail::QueueEnableProfiling> {};
 } // namespace queue
 } // namespace property
+
+namespace ext {
+namespace oneapi {
+namespace property {
+namespace queue {
+/// Makes the queue prefetch the shared USM allocations which the pointers
+/// passed to a kernel point to, so that the memory is migrated to the device
+/// before the kernel is executed instead of on page faults.
+class prefetch_shared_usm
+    : public detail::DataLessProperty<detail::QueuePrefetchSharedUSM> {};
+/// Lets an in-order queue skip the creation of the events of the kernels
+/// which do not use buffers or images.
+///
+/// The event returned for such a submission is not associated with it:
+/// waiting on it returns immediately, and it must not be used as a dependency
+/// of other command groups. queue::wait still waits for all the submissions
+/// and queue::submit_barrier returns a real event, which completes once the
+/// previous submissions do. The property must be used together with
+/// property::queue::in_order.
+class discard_events
+    : public detail::DataLessProperty<detail::QueueDiscardEvents> {};
+/// The priority of the work of the queue relative to the other queues of the
+/// device, for the backends which support it: Level Zero and CUDA. It is also
+/// the priority of the host threads running the host tasks of the queue. At
+/// most one of the priorities can be used.
+class priority_normal
+    : public detail::DataLessProperty<detail::QueuePriorityNormal> {};
+class priority_low
+    : public detail::DataLessProperty<detail::QueuePriorityLow> {};
+class priority_high
+    : public detail::DataLessProperty<detail::QueuePriorityHigh> {};
+/// The kernels of an out-of-order queue on a device with several sub-devices,
+/// e.g. the tiles of a GPU, are spread across the sub-devices. Each kernel
+/// runs on a single sub-device. Only Level Zero supports it, the other
+/// backends run the kernels on the device.
+class sub_device_scaling
+    : public detail::DataLessProperty<detail::QueueSubDeviceScaling> {};
+/// The waits on the events of the queue poll the device for a short time,
+/// then poll it while yielding the thread, and only then block, so that the
+/// completion of short commands is seen within a few microseconds. Only Level
+/// Zero and CUDA support it, the other backends always block.
+class spin_wait : public detail::DataLessProperty<detail::QueueSpinWait> {};
+} // namespace queue
+} // namespace property
+} // namespace oneapi
+} // namespace ext
 } // namespace sycl
 } // __SYCL_INLINE_NAMESPACE(cl)
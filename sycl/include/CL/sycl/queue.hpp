@@ -352,6 +352,64 @@ public:
   /// \return an event representing copy operation.
   event memcpy(void *Dest, const void *Src, size_t Count);
 
+  /// Copies a rectangle of rows from one memory region to another, both
+  /// pointed by USM pointers, see handler::memcpy2d.
+  ///
+  /// \param Dest is a USM pointer to the first row of the destination.
+  /// \param DestPitch is the distance in bytes between the destination rows.
+  /// \param Src is a USM pointer to the first row of the source.
+  /// \param SrcPitch is the distance in bytes between the source rows.
+  /// \param Width is the number of bytes of each row to copy.
+  /// \param Height is the number of rows to copy.
+  /// \return an event representing copy operation.
+  event memcpy2d(void *Dest, size_t DestPitch, const void *Src,
+                 size_t SrcPitch, size_t Width, size_t Height) {
+    return submit([=](handler &CGH) {
+      CGH.memcpy2d(Dest, DestPitch, Src, SrcPitch, Width, Height);
+    });
+  }
+
+  /// Copies a box of slices of rows from one memory region to another, both
+  /// pointed by USM pointers, see handler::memcpy3d.
+  ///
+  /// \param Dest is a USM pointer to the first row of the destination.
+  /// \param DestPitch is the distance in bytes between the destination rows.
+  /// \param DestSlicePitch is the distance in bytes between the destination
+  /// slices.
+  /// \param Src is a USM pointer to the first row of the source.
+  /// \param SrcPitch is the distance in bytes between the source rows.
+  /// \param SrcSlicePitch is the distance in bytes between the source slices.
+  /// \param Width is the number of bytes of each row to copy.
+  /// \param Height is the number of rows of each slice to copy.
+  /// \param Depth is the number of slices to copy.
+  /// \return an event representing copy operation.
+  event memcpy3d(void *Dest, size_t DestPitch, size_t DestSlicePitch,
+                 const void *Src, size_t SrcPitch, size_t SrcSlicePitch,
+                 size_t Width, size_t Height, size_t Depth) {
+    return submit([=](handler &CGH) {
+      CGH.memcpy3d(Dest, DestPitch, DestSlicePitch, Src, SrcPitch,
+                   SrcSlicePitch, Width, Height, Depth);
+    });
+  }
+
+  /// Fills a rectangle of rows of the memory pointed by a USM pointer with
+  /// the specified pattern, see handler::fill2d.
+  ///
+  /// \param Dest is a USM pointer to the first row to fill.
+  /// \param DestPitch is the distance in bytes between the rows.
+  /// \param Pattern is the pattern to fill into the memory. T should be
+  /// trivially copyable.
+  /// \param Width is the number of times to fill Pattern into each row.
+  /// \param Height is the number of rows to fill.
+  /// \return an event representing fill operation.
+  template <typename T>
+  event fill2d(void *Dest, size_t DestPitch, const T &Pattern, size_t Width,
+               size_t Height) {
+    return submit([&](handler &CGH) {
+      CGH.fill2d<T>(Dest, DestPitch, Pattern, Width, Height);
+    });
+  }
+
   /// Provides additional information to the underlying runtime about how
   /// different allocations are used.
   ///
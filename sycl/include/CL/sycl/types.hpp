@@ -504,6 +504,21 @@ convertImpl(T Value) {
 
 #endif // __SYCL_DEVICE_ONLY__
 
+// The element indices of a swizzle, as a pack.
+template <int... Indices> struct SwizzleIndices {};
+
+// The Count indices from Begin, Stride apart, e.g. of the lo(), hi(), odd()
+// and even() swizzles of the swizzles.def.
+template <int Begin, int Stride, int Count, int... Indices>
+struct MakeSwizzleIndices
+    : MakeSwizzleIndices<Begin, Stride, Count - 1,
+                         Begin + Stride * (Count - 1), Indices...> {};
+
+template <int Begin, int Stride, int... Indices>
+struct MakeSwizzleIndices<Begin, Stride, 0, Indices...> {
+  using type = SwizzleIndices<Indices...>;
+};
+
 } // namespace detail
 
 #if defined(_WIN32) && (_MSC_VER)
@@ -866,15 +881,11 @@ public:
 
   // Begin hi/lo, even/odd, xyzw, and rgba swizzles.
 private:
-  // Indexer used in the swizzles.def
-  // Currently it is defined as a template struct. Replacing it with a constexpr
-  // function would activate a bug in MSVC that is fixed only in v19.20.
-  // Until then MSVC does not recognize such constexpr functions as const and
-  // thus does not let using them in template parameters inside swizzle.def.
-  template <int Index>
-  struct Indexer {
-    static constexpr int value = Index;
-  };
+  // The swizzles of the swizzles.def, the indices of which are the indices of
+  // the elements of the vector.
+  template <int... Indices> using IndexedSwizzle = Swizzle<Indices...>;
+  template <int... Indices>
+  using IndexedConstSwizzle = ConstSwizzle<Indices...>;
 
 public:
 #ifdef __SYCL_ACCESS_RETURN
@@ -1793,6 +1804,13 @@ private:
     static constexpr int value = IDXs[Index >= getNumElements() ? 0 : Index];
   };
 
+  // The swizzles of the swizzles.def, the indices of which are mapped to the
+  // ones of the vector by the Indexer.
+  template <int... Indices>
+  using IndexedSwizzle = Swizzle<Indexer<Indices>::value...>;
+  template <int... Indices>
+  using IndexedConstSwizzle = ConstSwizzle<Indexer<Indices>::value...>;
+
 public:
 #ifdef __SYCL_ACCESS_RETURN
 #error "Undefine __SYCL_ACCESS_RETURN macro"
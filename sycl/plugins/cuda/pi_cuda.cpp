@@ -17,6 +17,7 @@
 #include <pi_cuda.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cuda.h>
 #include <cuda_device_runtime_api.h>
@@ -24,6 +25,7 @@
 #include <memory>
 #include <mutex>
 #include <regex>
+#include <thread>
 
 namespace {
 std::string getCudaVersionString() {
@@ -64,7 +66,7 @@ inline void assign_result(pi_result *ptr, pi_result value) noexcept {
 }
 
 // Iterates over the event wait list, returns correct pi_result error codes.
-// Invokes the callback for the latest event of each queue in the wait list.
+// Invokes the callback for the latest event of each stream in the wait list.
 // The callback must take a single pi_event argument and return a pi_result.
 template <typename Func>
 pi_result forLatestEvents(const pi_event *event_wait_list,
@@ -84,20 +86,20 @@ pi_result forLatestEvents(const pi_event *event_wait_list,
   std::sort(events.begin(), events.end(), [](pi_event e0, pi_event e1) {
     // Tiered sort creating sublists of streams (smallest value first) in which
     // the corresponding events are sorted into a sequence of newest first.
-    return e0->get_queue()->stream_ < e1->get_queue()->stream_ ||
-           (e0->get_queue()->stream_ == e1->get_queue()->stream_ &&
+    return e0->get_stream() < e1->get_stream() ||
+           (e0->get_stream() == e1->get_stream() &&
             e0->get_event_id() > e1->get_event_id());
   });
 
   bool first = true;
   CUstream lastSeenStream = 0;
   for (pi_event event : events) {
-    if (!event || (!first && event->get_queue()->stream_ == lastSeenStream)) {
+    if (!event || (!first && event->get_stream() == lastSeenStream)) {
       continue;
     }
 
     first = false;
-    lastSeenStream = event->get_queue()->stream_;
+    lastSeenStream = event->get_stream();
 
     auto result = f(event);
     if (result != PI_SUCCESS) {
@@ -143,12 +145,49 @@ pi_result check_error(CUresult result, const char *function, int line,
 /// \cond NODOXY
 #define PI_CHECK_ERROR(result) check_error(result, __func__, __LINE__, __FILE__)
 
+/// Bumped whenever the plugin changes the CUDA context stack of a thread other
+/// than by a ScopedContext, i.e. in context creation and release. A context
+/// cached by a thread in an earlier epoch may not be current or alive anymore.
+std::atomic_uint32_t contextStackEpoch{0};
+
+/// The CUDA context the plugin knows to be current on this thread, valid in
+/// the epoch it was cached in.
+struct CachedCurrentContext {
+  CUcontext context = nullptr;
+  uint32_t epoch = 0;
+};
+thread_local CachedCurrentContext cachedCurrentContext;
+
+/// The cache assumes that the application doesn't change the current CUDA
+/// context of the threads calling into the plugin itself. Those that do can
+/// disable it with SYCL_PI_CUDA_DISABLE_CONTEXT_CACHE.
+bool isContextCacheEnabled() {
+  static const bool enabled =
+      std::getenv("SYCL_PI_CUDA_DISABLE_CONTEXT_CACHE") == nullptr;
+  return enabled;
+}
+
+void cacheCurrentContext(CUcontext ctxt) {
+  cachedCurrentContext.context = ctxt;
+  cachedCurrentContext.epoch =
+      contextStackEpoch.load(std::memory_order_relaxed);
+}
+
+bool isCachedCurrentContext(CUcontext ctxt) {
+  return cachedCurrentContext.context == ctxt &&
+         cachedCurrentContext.epoch ==
+             contextStackEpoch.load(std::memory_order_relaxed) &&
+         isContextCacheEnabled();
+}
+
 /// RAII type to guarantee recovering original CUDA context
 /// Scoped context is used across all PI CUDA plugin implementation
 /// to activate the PI Context on the current thread, matching the
 /// CUDA driver semantics where the context used for the CUDA Driver
 /// API is the one active on the thread.
-/// The implementation tries to avoid replacing the CUcontext if it cans
+/// The implementation tries to avoid replacing the CUcontext if it cans.
+/// The context it leaves active on a thread is cached, so that the next
+/// ScopedContext for it on the thread makes no driver call.
 class ScopedContext {
   pi_context placedContext_;
   CUcontext original_;
@@ -162,26 +201,35 @@ public:
     }
 
     CUcontext desired = placedContext_->get();
+    if (isCachedCurrentContext(desired)) {
+      return;
+    }
+
     PI_CHECK_ERROR(cuCtxGetCurrent(&original_));
     if (original_ != desired) {
       // Sets the desired context as the active one for the thread
       PI_CHECK_ERROR(cuCtxSetCurrent(desired));
-      if (original_ == nullptr) {
+      if (original_ == nullptr || placedContext_->is_primary()) {
         // No context is installed on the current thread
         // This is the most common case. We can activate the context in the
         // thread and leave it there until all the PI context referring to the
         // same underlying CUDA context are destroyed. This emulates
         // the behaviour of the CUDA runtime api, and avoids costly context
         // switches. No action is required on this side of the if.
+        // Primary contexts are left active as well, as the CUDA runtime api
+        // does, rather than switched back to the original context.
       } else {
         needToRecover_ = true;
+        return;
       }
     }
+    cacheCurrentContext(desired);
   }
 
   ~ScopedContext() {
     if (needToRecover_) {
       PI_CHECK_ERROR(cuCtxSetCurrent(original_));
+      cacheCurrentContext(original_);
     }
   }
 };
@@ -316,10 +364,11 @@ pi_result cuda_piEventRetain(pi_event event);
 
 /// \endcond
 
-_pi_event::_pi_event(pi_command_type type, pi_context context, pi_queue queue)
+_pi_event::_pi_event(pi_command_type type, pi_context context, pi_queue queue,
+                     CUstream stream)
     : commandType_{type}, refCount_{1}, isCompleted_{false}, isRecorded_{false},
       isStarted_{false}, evEnd_{nullptr}, evStart_{nullptr}, evQueued_{nullptr},
-      queue_{queue}, context_{context} {
+      queue_{queue}, stream_{stream}, context_{context} {
 
   assert(type != PI_COMMAND_TYPE_USER);
 
@@ -354,7 +403,7 @@ pi_result _pi_event::start() {
     if (queue_->properties_ & PI_QUEUE_PROFILING_ENABLE) {
       // NOTE: This relies on the default stream to be unused.
       result = PI_CHECK_ERROR(cuEventRecord(evQueued_, 0));
-      result = PI_CHECK_ERROR(cuEventRecord(evStart_, queue_->get()));
+      result = PI_CHECK_ERROR(cuEventRecord(evStart_, stream_));
     }
   } catch (pi_result error) {
     result = error;
@@ -401,7 +450,7 @@ pi_result _pi_event::record() {
     return PI_INVALID_QUEUE;
   }
 
-  CUstream cuStream = queue_->get();
+  CUstream cuStream = stream_;
 
   try {
     eventId_ = queue_->get_next_event_id();
@@ -424,8 +473,39 @@ pi_result _pi_event::record() {
 pi_result _pi_event::wait() {
   pi_result retErr;
   try {
+    const std::chrono::microseconds spinTime =
+        queue_ ? queue_->waitSpinTime_ : std::chrono::microseconds{0};
+    if (spinTime.count() > 0) {
+      using clock = std::chrono::steady_clock;
+      const clock::time_point start = clock::now();
+      bool yielding = false;
+      while (true) {
+        CUresult result = cuEventQuery(evEnd_);
+        if (result == CUDA_SUCCESS) {
+          ++(yielding ? queue_->numWaitsYielded_ : queue_->numWaitsSpun_);
+          isCompleted_ = true;
+          return PI_SUCCESS;
+        }
+        if (result != CUDA_ERROR_NOT_READY) {
+          return PI_CHECK_ERROR(result);
+        }
+        const clock::duration elapsed = clock::now() - start;
+        if (elapsed >= 2 * spinTime) {
+          break;
+        }
+        // Past the first half, the other threads of the core get to run
+        // between the polls.
+        if (elapsed >= spinTime) {
+          yielding = true;
+          std::this_thread::yield();
+        }
+      }
+    }
     retErr = PI_CHECK_ERROR(cuEventSynchronize(evEnd_));
     isCompleted_ = true;
+    if (queue_) {
+      ++queue_->numWaitsBlocked_;
+    }
   } catch (pi_result error) {
     retErr = error;
   }
@@ -445,12 +525,48 @@ pi_result _pi_event::release() {
   return PI_SUCCESS;
 }
 
-// makes all future work submitted to queue wait for all work captured in event.
-pi_result enqueueEventWait(pi_queue queue, pi_event event) {
+// makes all future work submitted to stream wait for all work captured in
+// event.
+pi_result enqueueEventWait(CUstream stream, pi_event event) {
+  // Work submitted to the same stream is already ordered after the event.
+  if (event->get_stream() == stream) {
+    return PI_SUCCESS;
+  }
   // for native events, the cuStreamWaitEvent call is used.
   // This makes all future work submitted to stream wait for all
   // work captured in event.
-  return PI_CHECK_ERROR(cuStreamWaitEvent(queue->get(), event->get(), 0));
+  return PI_CHECK_ERROR(cuStreamWaitEvent(stream, event->get(), 0));
+}
+
+// makes all future work submitted to stream wait for the events of the wait
+// list. Must be called with the context of the queue active.
+pi_result enqueueEventsWait(CUstream stream, pi_uint32 num_events_in_wait_list,
+                            const pi_event *event_wait_list) {
+  if (!event_wait_list) {
+    return PI_SUCCESS;
+  }
+  return forLatestEvents(event_wait_list, num_events_in_wait_list,
+                         [stream](pi_event event) -> pi_result {
+                           return enqueueEventWait(stream, event);
+                         });
+}
+
+// makes all future work submitted to stream wait for all work submitted to the
+// other streams of queue so far. Must be called with the context of the queue
+// active.
+pi_result enqueueStreamsWait(pi_queue queue, CUstream stream) {
+  queue->for_each_stream([stream](CUstream other) {
+    if (other == stream) {
+      return;
+    }
+    CUevent event;
+    PI_CHECK_ERROR(cuEventCreate(&event, CU_EVENT_DISABLE_TIMING));
+    PI_CHECK_ERROR(cuEventRecord(event, other));
+    PI_CHECK_ERROR(cuStreamWaitEvent(stream, event, 0));
+    // The pending wait is not affected by destroying the event.
+    PI_CHECK_ERROR(cuEventDestroy(event));
+  });
+  return PI_SUCCESS;
 }
 
 _pi_program::_pi_program(pi_context ctxt)
@@ -601,6 +717,62 @@ public:
   void dismiss() { Captive = nullptr; }
 };
 
+/// Reads the parameters of the USM device pools from
+/// SYCL_PI_CUDA_USM_DEVICE_POOL=<MaxPoolableSize>,<Capacity>,<MaxPoolSize>.
+/// Sizes are in bytes and trailing fields can be omitted. By default
+/// allocations up to 2M are pooled and each bucket keeps up to 4 empty slabs,
+/// within 16M per pool. A MaxPoolableSize of 0 disables the pools.
+const USMAllocatorParameters &cuda_getUSMDevicePoolParameters() {
+  static const USMAllocatorParameters params = [] {
+    USMAllocatorParameters params;
+    params.Name = "device";
+    params.MaxPoolableSize = 2 * 1024 * 1024;
+    params.Capacity = 4;
+    params.MaxPoolSize = 16 * 1024 * 1024;
+    params.ThreadCacheSize = 16;
+
+    const char *config = std::getenv("SYCL_PI_CUDA_USM_DEVICE_POOL");
+    if (config) {
+      size_t *fields[] = {&params.MaxPoolableSize, &params.Capacity,
+                          &params.MaxPoolSize};
+      for (size_t *field : fields) {
+        char *end = nullptr;
+        unsigned long long value = std::strtoull(config, &end, 10);
+        if (end == config) {
+          break;
+        }
+        *field = static_cast<size_t>(value);
+        if (*end != ',') {
+          break;
+        }
+        config = end + 1;
+      }
+    }
+    return params;
+  }();
+  return params;
+}
+
+void *_pi_usm_device_memory::allocate(size_t size) {
+  ScopedContext active(context_);
+  CUdeviceptr ptr = 0;
+  PI_CHECK_ERROR(cuMemAlloc(&ptr, size));
+  return reinterpret_cast<void *>(ptr);
+}
+
+void *_pi_usm_device_memory::allocate(size_t size, size_t alignment) {
+  // Device allocations are aligned to at least 256 bytes, which covers all
+  // alignments the pool forwards here.
+  void *ptr = allocate(size);
+  assert(reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0);
+  return ptr;
+}
+
+void _pi_usm_device_memory::deallocate(void *ptr) {
+  ScopedContext active(context_);
+  PI_CHECK_ERROR(cuMemFree(reinterpret_cast<CUdeviceptr>(ptr)));
+}
+
 //-- PI API implementation
 extern "C" {
 
@@ -1453,7 +1625,17 @@ pi_result cuda_piDeviceGetInfo(pi_device device, pi_device_info param_name,
   }
 
     // TODO: Investigate if this information is available on CUDA.
-  case PI_DEVICE_INFO_PCI_ADDRESS:
+  case PI_DEVICE_INFO_PCI_ADDRESS: {
+    // The bus id is formatted as "DDDD:BB:DD.F", in hexadecimal.
+    static constexpr size_t MAX_PCI_BUS_ID_LENGTH = 16u;
+    char busId[MAX_PCI_BUS_ID_LENGTH];
+    if (cuDeviceGetPCIBusId(busId, MAX_PCI_BUS_ID_LENGTH, device->get()) !=
+        CUDA_SUCCESS) {
+      return PI_INVALID_VALUE;
+    }
+    return getInfoArray(strlen(busId) + 1, param_value_size, param_value,
+                        param_value_size_ret, busId);
+  }
   case PI_DEVICE_INFO_GPU_EU_COUNT:
   case PI_DEVICE_INFO_GPU_EU_SIMD_WIDTH:
   case PI_DEVICE_INFO_GPU_SLICES:
@@ -1578,6 +1760,9 @@ pi_result cuda_piContextCreate(const pi_context_properties *properties,
           _pi_context::kind::user_defined, newContext, *devices});
     }
 
+    // The context stacks cached by the threads may not be current anymore.
+    contextStackEpoch.fetch_add(1, std::memory_order_relaxed);
+
     // Use default stream to record base event counter
     PI_CHECK_ERROR(cuEventCreate(&piContextPtr->evBase_, CU_EVENT_DEFAULT));
     PI_CHECK_ERROR(cuEventRecord(piContextPtr->evBase_, 0));
@@ -1612,6 +1797,12 @@ pi_result cuda_piContextRelease(pi_context ctxt) {
 
   PI_CHECK_ERROR(cuEventDestroy(context->evBase_));
 
+  // The pooled slabs belong to the CUDA context, free them while it is alive.
+  context->deviceMemPool_.reset();
+
+  // The threads which cached the context as current may not use it anymore.
+  contextStackEpoch.fetch_add(1, std::memory_order_relaxed);
+
   if (!ctxt->is_primary()) {
     CUcontext cuCtxt = ctxt->get();
     CUcontext current = nullptr;
@@ -1904,10 +2095,46 @@ pi_result cuda_piextMemCreateWithNativeHandle(pi_native_handle nativeHandle,
   return {};
 }
 
+/// Reads the time in microseconds for which the waits on the events of a
+/// queue poll them, see _pi_queue::waitSpinTime_. Queues given
+/// PI_EXT_ONEAPI_QUEUE_SPIN_WAIT poll for 50us by default, the other queues
+/// only if SYCL_PI_CUDA_WAIT_SPIN_US is set.
+static std::chrono::microseconds
+getQueueWaitSpinTime(pi_queue_properties properties) {
+  static const int envSpinTime = [] {
+    const char *value = std::getenv("SYCL_PI_CUDA_WAIT_SPIN_US");
+    return value ? std::max(std::atoi(value), 0) : -1;
+  }();
+  if (envSpinTime >= 0) {
+    return std::chrono::microseconds(envSpinTime);
+  }
+  return std::chrono::microseconds(
+      (properties & PI_EXT_ONEAPI_QUEUE_SPIN_WAIT) ? 50 : 0);
+}
+
+/// Reads the number of streams of an out-of-order queue from the environment.
+static unsigned int getQueueStreamCount(const char *envVar,
+                                        unsigned int defaultCount) {
+  const char *value = std::getenv(envVar);
+  if (!value) {
+    return defaultCount;
+  }
+  return static_cast<unsigned int>(std::max(std::atoi(value), 0));
+}
+
 /// Creates a `pi_queue` object on the CUDA backend.
 /// Valid properties
 /// * __SYCL_PI_CUDA_USE_DEFAULT_STREAM -> CU_STREAM_DEFAULT
 /// * __SYCL_PI_CUDA_SYNC_WITH_DEFAULT -> CU_STREAM_NON_BLOCKING
+///
+/// Out-of-order queues get SYCL_PI_CUDA_NUM_COMPUTE_STREAMS compute streams
+/// (1 by default) and SYCL_PI_CUDA_NUM_TRANSFER_STREAMS transfer streams (none
+/// by default), see _pi_queue.
+///
+/// The waits on the events of the queue poll them before blocking if the
+/// queue has PI_EXT_ONEAPI_QUEUE_SPIN_WAIT or SYCL_PI_CUDA_WAIT_SPIN_US is
+/// set. The number of waits completed by each phase is printed when the queue
+/// is released if SYCL_PI_CUDA_PRINT_WAIT_STATS is set.
 /// \return Pi queue object mapping to a CUStream
 ///
 pi_result cuda_piQueueCreate(pi_context context, pi_device device,
@@ -1924,8 +2151,9 @@ pi_result cuda_piQueueCreate(pi_context context, pi_device device,
 
     ScopedContext active(context);
 
-    CUstream cuStream;
     unsigned int flags = 0;
+    unsigned int numComputeStreams = 1;
+    unsigned int numTransferStreams = 0;
 
     if (properties == __SYCL_PI_CUDA_USE_DEFAULT_STREAM) {
       flags = CU_STREAM_DEFAULT;
@@ -1933,15 +2161,68 @@ pi_result cuda_piQueueCreate(pi_context context, pi_device device,
       flags = 0;
     } else {
       flags = CU_STREAM_NON_BLOCKING;
+      if (properties & PI_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE) {
+        static const unsigned int envComputeStreams =
+            getQueueStreamCount("SYCL_PI_CUDA_NUM_COMPUTE_STREAMS", 1);
+        static const unsigned int envTransferStreams =
+            getQueueStreamCount("SYCL_PI_CUDA_NUM_TRANSFER_STREAMS", 0);
+        numComputeStreams = std::max(envComputeStreams, 1u);
+        numTransferStreams = envTransferStreams;
+      }
     }
 
-    err = PI_CHECK_ERROR(cuStreamCreate(&cuStream, flags));
+    // The numerically lower priorities are the higher ones.
+    int priority = 0;
+    if (properties & (PI_EXT_ONEAPI_QUEUE_PRIORITY_LOW |
+                      PI_EXT_ONEAPI_QUEUE_PRIORITY_HIGH)) {
+      int leastPriority = 0;
+      int greatestPriority = 0;
+      PI_CHECK_ERROR(
+          cuCtxGetStreamPriorityRange(&leastPriority, &greatestPriority));
+      priority = (properties & PI_EXT_ONEAPI_QUEUE_PRIORITY_LOW)
+                     ? leastPriority
+                     : greatestPriority;
+    }
+
+    std::vector<CUstream> computeStreams;
+    std::vector<CUstream> transferStreams;
+    auto destroyStreams = [&]() {
+      for (CUstream stream : computeStreams)
+        cuStreamDestroy(stream);
+      for (CUstream stream : transferStreams)
+        cuStreamDestroy(stream);
+    };
+    auto createStreams = [&](std::vector<CUstream> &streams,
+                             unsigned int count) {
+      for (unsigned int i = 0; i < count; ++i) {
+        CUstream cuStream;
+        pi_result result = PI_CHECK_ERROR(
+            cuStreamCreateWithPriority(&cuStream, flags, priority));
+        if (result != PI_SUCCESS) {
+          return result;
+        }
+        streams.push_back(cuStream);
+      }
+      return PI_SUCCESS;
+    };
+
+    try {
+      err = createStreams(computeStreams, numComputeStreams);
+      if (err == PI_SUCCESS) {
+        err = createStreams(transferStreams, numTransferStreams);
+      }
+    } catch (pi_result error) {
+      err = error;
+    }
     if (err != PI_SUCCESS) {
+      destroyStreams();
       return err;
     }
 
     queueImpl = std::unique_ptr<_pi_queue>(
-        new _pi_queue{cuStream, context, device, properties});
+        new _pi_queue{std::move(computeStreams), std::move(transferStreams),
+                      context, device, properties,
+                      getQueueWaitSpinTime(properties)});
 
     *queue = queueImpl.release();
 
@@ -2001,9 +2282,18 @@ pi_result cuda_piQueueRelease(pi_queue command_queue) {
 
     ScopedContext active(command_queue->get_context());
 
-    auto stream = queueImpl->stream_;
-    PI_CHECK_ERROR(cuStreamSynchronize(stream));
-    PI_CHECK_ERROR(cuStreamDestroy(stream));
+    queueImpl->for_each_stream([](CUstream stream) {
+      PI_CHECK_ERROR(cuStreamSynchronize(stream));
+      PI_CHECK_ERROR(cuStreamDestroy(stream));
+    });
+
+    static const bool printWaitStats =
+        std::getenv("SYCL_PI_CUDA_PRINT_WAIT_STATS") != nullptr;
+    if (printWaitStats) {
+      std::cerr << "PI CUDA queue waits: spun " << queueImpl->numWaitsSpun_
+                << ", yielded " << queueImpl->numWaitsYielded_ << ", blocked "
+                << queueImpl->numWaitsBlocked_ << std::endl;
+    }
 
     return PI_SUCCESS;
   } catch (pi_result err) {
@@ -2023,7 +2313,10 @@ pi_result cuda_piQueueFinish(pi_queue command_queue) {
     assert(command_queue !=
            nullptr); // need PI_ERROR_INVALID_EXTERNAL_HANDLE error code
     ScopedContext active(command_queue->get_context());
-    result = PI_CHECK_ERROR(cuStreamSynchronize(command_queue->stream_));
+    result = PI_SUCCESS;
+    command_queue->for_each_stream([&result](CUstream stream) {
+      result = PI_CHECK_ERROR(cuStreamSynchronize(stream));
+    });
 
   } catch (pi_result err) {
 
@@ -2076,19 +2369,19 @@ pi_result cuda_piEnqueueMemBufferWrite(pi_queue command_queue, pi_mem buffer,
   assert(buffer != nullptr);
   assert(command_queue != nullptr);
   pi_result retErr = PI_SUCCESS;
-  CUstream cuStream = command_queue->get();
+  CUstream cuStream = command_queue->get_next_transfer_stream();
   CUdeviceptr devPtr = buffer->mem_.buffer_mem_.get();
   std::unique_ptr<_pi_event> retImplEv{nullptr};
 
   try {
     ScopedContext active(command_queue->get_context());
 
-    retErr = cuda_piEnqueueEventsWait(command_queue, num_events_in_wait_list,
-                                      event_wait_list, nullptr);
+    retErr = enqueueEventsWait(cuStream, num_events_in_wait_list,
+                               event_wait_list);
 
     if (event) {
       retImplEv = std::unique_ptr<_pi_event>(_pi_event::make_native(
-          PI_COMMAND_TYPE_MEM_BUFFER_WRITE, command_queue));
+          PI_COMMAND_TYPE_MEM_BUFFER_WRITE, command_queue, cuStream));
       retImplEv->start();
     }
 
@@ -2122,19 +2415,19 @@ pi_result cuda_piEnqueueMemBufferRead(pi_queue command_queue, pi_mem buffer,
   assert(buffer != nullptr);
   assert(command_queue != nullptr);
   pi_result retErr = PI_SUCCESS;
-  CUstream cuStream = command_queue->get();
+  CUstream cuStream = command_queue->get_next_transfer_stream();
   CUdeviceptr devPtr = buffer->mem_.buffer_mem_.get();
   std::unique_ptr<_pi_event> retImplEv{nullptr};
 
   try {
     ScopedContext active(command_queue->get_context());
 
-    retErr = cuda_piEnqueueEventsWait(command_queue, num_events_in_wait_list,
-                                      event_wait_list, nullptr);
+    retErr = enqueueEventsWait(cuStream, num_events_in_wait_list,
+                               event_wait_list);
 
     if (event) {
       retImplEv = std::unique_ptr<_pi_event>(_pi_event::make_native(
-          PI_COMMAND_TYPE_MEM_BUFFER_READ, command_queue));
+          PI_COMMAND_TYPE_MEM_BUFFER_READ, command_queue, cuStream));
       retImplEv->start();
     }
 
@@ -2377,11 +2670,11 @@ pi_result cuda_piEnqueueKernelLaunch(
 
   try {
     ScopedContext active(command_queue->get_context());
-    CUstream cuStream = command_queue->get();
+    CUstream cuStream = command_queue->get_next_compute_stream();
     CUfunction cuFunc = kernel->get();
 
-    retError = cuda_piEnqueueEventsWait(command_queue, num_events_in_wait_list,
-                                        event_wait_list, nullptr);
+    retError = enqueueEventsWait(cuStream, num_events_in_wait_list,
+                                 event_wait_list);
 
     // Set the implicit global offset parameter if kernel has offset variant
     if (kernel->get_with_offset_parameter()) {
@@ -2403,7 +2696,7 @@ pi_result cuda_piEnqueueKernelLaunch(
 
     if (event) {
       retImplEv = std::unique_ptr<_pi_event>(_pi_event::make_native(
-          PI_COMMAND_TYPE_NDRANGE_KERNEL, command_queue));
+          PI_COMMAND_TYPE_NDRANGE_KERNEL, command_queue, cuStream));
       retImplEv->start();
     }
 
@@ -3063,6 +3356,40 @@ pi_result cuda_piextKernelSetArgPointer(pi_kernel kernel, pi_uint32 arg_index,
   return PI_SUCCESS;
 }
 
+pi_result cuda_piextKernelSetArgs(pi_kernel kernel, pi_uint32 num_args,
+                                 const pi_kernel_arg *args) {
+  assert(kernel != nullptr);
+  assert(num_args == 0 || args != nullptr);
+
+  for (pi_uint32 i = 0; i < num_args; ++i) {
+    const pi_kernel_arg &arg = args[i];
+    pi_result retErr = PI_SUCCESS;
+    switch (arg.kind) {
+    case PI_KERNEL_ARG_VALUE:
+      retErr = cuda_piKernelSetArg(kernel, arg.index, arg.size, arg.value);
+      break;
+    case PI_KERNEL_ARG_MEM_OBJ:
+      retErr = cuda_piextKernelSetArgMemObj(
+          kernel, arg.index, static_cast<const pi_mem *>(arg.value));
+      break;
+    case PI_KERNEL_ARG_SAMPLER:
+      retErr = cuda_piextKernelSetArgSampler(
+          kernel, arg.index, static_cast<const pi_sampler *>(arg.value));
+      break;
+    case PI_KERNEL_ARG_POINTER:
+      retErr = cuda_piextKernelSetArgPointer(kernel, arg.index, arg.size,
+                                             arg.value);
+      break;
+    default:
+      retErr = PI_INVALID_VALUE;
+    }
+    if (retErr != PI_SUCCESS) {
+      return retErr;
+    }
+  }
+  return PI_SUCCESS;
+}
+
 //
 // Events
 //
@@ -3183,7 +3510,8 @@ pi_result cuda_piEventRelease(pi_event event) {
   return PI_SUCCESS;
 }
 
-/// Enqueues a wait on the given CUstream for all events.
+/// Enqueues a wait on one of the streams of the queue for all events. With an
+/// empty wait list the stream waits for all work enqueued to the queue so far.
 /// See \ref enqueueEventWait
 ///
 pi_result cuda_piEnqueueEventsWait(pi_queue command_queue,
@@ -3196,21 +3524,20 @@ pi_result cuda_piEnqueueEventsWait(pi_queue command_queue,
 
   try {
     ScopedContext active(command_queue->get_context());
+    CUstream cuStream = command_queue->get_next_compute_stream();
 
-    if (event_wait_list) {
-      auto result =
-          forLatestEvents(event_wait_list, num_events_in_wait_list,
-                          [command_queue](pi_event event) -> pi_result {
-                            return enqueueEventWait(command_queue, event);
-                          });
-
-      if (result != PI_SUCCESS) {
-        return result;
-      }
+    auto result =
+        event_wait_list
+            ? enqueueEventsWait(cuStream, num_events_in_wait_list,
+                                event_wait_list)
+            : enqueueStreamsWait(command_queue, cuStream);
+    if (result != PI_SUCCESS) {
+      return result;
     }
 
     if (event) {
-      *event = _pi_event::make_native(PI_COMMAND_TYPE_MARKER, command_queue);
+      *event = _pi_event::make_native(PI_COMMAND_TYPE_MARKER, command_queue,
+                                      cuStream);
       (*event)->start();
       (*event)->record();
     }
@@ -3454,19 +3781,19 @@ pi_result cuda_piEnqueueMemBufferReadRect(
   assert(command_queue != nullptr);
 
   pi_result retErr = PI_SUCCESS;
-  CUstream cuStream = command_queue->get();
+  CUstream cuStream = command_queue->get_next_transfer_stream();
   CUdeviceptr devPtr = buffer->mem_.buffer_mem_.get();
   std::unique_ptr<_pi_event> retImplEv{nullptr};
 
   try {
     ScopedContext active(command_queue->get_context());
 
-    retErr = cuda_piEnqueueEventsWait(command_queue, num_events_in_wait_list,
-                                      event_wait_list, nullptr);
+    retErr = enqueueEventsWait(cuStream, num_events_in_wait_list,
+                               event_wait_list);
 
     if (event) {
       retImplEv = std::unique_ptr<_pi_event>(_pi_event::make_native(
-          PI_COMMAND_TYPE_MEM_BUFFER_READ_RECT, command_queue));
+          PI_COMMAND_TYPE_MEM_BUFFER_READ_RECT, command_queue, cuStream));
       retImplEv->start();
     }
 
@@ -3505,19 +3832,19 @@ pi_result cuda_piEnqueueMemBufferWriteRect(
   assert(command_queue != nullptr);
 
   pi_result retErr = PI_SUCCESS;
-  CUstream cuStream = command_queue->get();
+  CUstream cuStream = command_queue->get_next_transfer_stream();
   CUdeviceptr devPtr = buffer->mem_.buffer_mem_.get();
   std::unique_ptr<_pi_event> retImplEv{nullptr};
 
   try {
     ScopedContext active(command_queue->get_context());
 
-    retErr = cuda_piEnqueueEventsWait(command_queue, num_events_in_wait_list,
-                                      event_wait_list, nullptr);
+    retErr = enqueueEventsWait(cuStream, num_events_in_wait_list,
+                               event_wait_list);
 
     if (event) {
       retImplEv = std::unique_ptr<_pi_event>(_pi_event::make_native(
-          PI_COMMAND_TYPE_MEM_BUFFER_WRITE_RECT, command_queue));
+          PI_COMMAND_TYPE_MEM_BUFFER_WRITE_RECT, command_queue, cuStream));
       retImplEv->start();
     }
 
@@ -3558,21 +3885,20 @@ pi_result cuda_piEnqueueMemBufferCopy(pi_queue command_queue, pi_mem src_buffer,
 
   try {
     ScopedContext active(command_queue->get_context());
+    CUstream stream = command_queue->get_next_transfer_stream();
 
     if (event_wait_list) {
-      cuda_piEnqueueEventsWait(command_queue, num_events_in_wait_list,
-                               event_wait_list, nullptr);
+      enqueueEventsWait(stream, num_events_in_wait_list, event_wait_list);
     }
 
     pi_result result;
 
     if (event) {
       retImplEv = std::unique_ptr<_pi_event>(_pi_event::make_native(
-          PI_COMMAND_TYPE_MEM_BUFFER_COPY, command_queue));
+          PI_COMMAND_TYPE_MEM_BUFFER_COPY, command_queue, stream));
       result = retImplEv->start();
     }
 
-    auto stream = command_queue->get();
     auto src = src_buffer->mem_.buffer_mem_.get() + src_offset;
     auto dst = dst_buffer->mem_.buffer_mem_.get() + dst_offset;
 
@@ -3591,6 +3917,60 @@ pi_result cuda_piEnqueueMemBufferCopy(pi_queue command_queue, pi_mem src_buffer,
   }
 }
 
+/// Copies between buffers of different contexts with cuMemcpyPeerAsync, which
+/// goes over the peer-to-peer link when the devices have one and is staged by
+/// the driver otherwise.
+pi_result cuda_piextEnqueueMemBufferCopyPeer(
+    pi_queue src_queue, pi_mem src_buffer, size_t src_offset,
+    pi_queue dst_queue, pi_mem dst_buffer, size_t dst_offset, size_t size,
+    pi_uint32 num_events_in_wait_list, const pi_event *event_wait_list,
+    pi_event *event) {
+  if (!src_queue || !dst_queue) {
+    return PI_INVALID_QUEUE;
+  }
+  assert(src_buffer != nullptr);
+  assert(dst_buffer != nullptr);
+  assert(src_buffer->mem_type_ == _pi_mem::mem_type::buffer);
+  assert(dst_buffer->mem_type_ == _pi_mem::mem_type::buffer);
+
+  std::unique_ptr<_pi_event> retImplEv{nullptr};
+
+  try {
+    ScopedContext active(src_queue->get_context());
+    CUstream stream = src_queue->get_next_transfer_stream();
+
+    if (event_wait_list) {
+      enqueueEventsWait(stream, num_events_in_wait_list, event_wait_list);
+    }
+
+    pi_result result;
+
+    if (event) {
+      retImplEv = std::unique_ptr<_pi_event>(_pi_event::make_native(
+          PI_COMMAND_TYPE_MEM_BUFFER_COPY, src_queue, stream));
+      result = retImplEv->start();
+    }
+
+    auto src = src_buffer->mem_.buffer_mem_.get() + src_offset;
+    auto dst = dst_buffer->mem_.buffer_mem_.get() + dst_offset;
+
+    result = PI_CHECK_ERROR(
+        cuMemcpyPeerAsync(dst, dst_queue->get_context()->get(), src,
+                          src_queue->get_context()->get(), size, stream));
+
+    if (event) {
+      result = retImplEv->record();
+      *event = retImplEv.release();
+    }
+
+    return result;
+  } catch (pi_result err) {
+    return err;
+  } catch (...) {
+    return PI_ERROR_UNKNOWN;
+  }
+}
+
 pi_result cuda_piEnqueueMemBufferCopyRect(
     pi_queue command_queue, pi_mem src_buffer, pi_mem dst_buffer,
     pi_buff_rect_offset src_origin, pi_buff_rect_offset dst_origin,
@@ -3604,7 +3984,7 @@ pi_result cuda_piEnqueueMemBufferCopyRect(
   assert(command_queue != nullptr);
 
   pi_result retErr = PI_SUCCESS;
-  CUstream cuStream = command_queue->get();
+  CUstream cuStream = command_queue->get_next_transfer_stream();
   CUdeviceptr srcPtr = src_buffer->mem_.buffer_mem_.get();
   CUdeviceptr dstPtr = dst_buffer->mem_.buffer_mem_.get();
   std::unique_ptr<_pi_event> retImplEv{nullptr};
@@ -3612,12 +3992,12 @@ pi_result cuda_piEnqueueMemBufferCopyRect(
   try {
     ScopedContext active(command_queue->get_context());
 
-    retErr = cuda_piEnqueueEventsWait(command_queue, num_events_in_wait_list,
-                                      event_wait_list, nullptr);
+    retErr = enqueueEventsWait(cuStream, num_events_in_wait_list,
+                               event_wait_list);
 
     if (event) {
       retImplEv = std::unique_ptr<_pi_event>(_pi_event::make_native(
-          PI_COMMAND_TYPE_MEM_BUFFER_COPY_RECT, command_queue));
+          PI_COMMAND_TYPE_MEM_BUFFER_COPY_RECT, command_queue, cuStream));
       retImplEv->start();
     }
 
@@ -3664,22 +4044,21 @@ pi_result cuda_piEnqueueMemBufferFill(pi_queue command_queue, pi_mem buffer,
 
   try {
     ScopedContext active(command_queue->get_context());
+    CUstream stream = command_queue->get_next_transfer_stream();
 
     if (event_wait_list) {
-      cuda_piEnqueueEventsWait(command_queue, num_events_in_wait_list,
-                               event_wait_list, nullptr);
+      enqueueEventsWait(stream, num_events_in_wait_list, event_wait_list);
     }
 
     pi_result result;
 
     if (event) {
       retImplEv = std::unique_ptr<_pi_event>(_pi_event::make_native(
-          PI_COMMAND_TYPE_MEM_BUFFER_FILL, command_queue));
+          PI_COMMAND_TYPE_MEM_BUFFER_FILL, command_queue, stream));
       result = retImplEv->start();
     }
 
     auto dstDevice = buffer->mem_.buffer_mem_.get() + offset;
-    auto stream = command_queue->get();
     auto N = size / pattern_size;
 
     // pattern size in bytes
@@ -3835,14 +4214,13 @@ pi_result cuda_piEnqueueMemImageRead(
   assert(image->mem_type_ == _pi_mem::mem_type::surface);
 
   pi_result retErr = PI_SUCCESS;
-  CUstream cuStream = command_queue->get();
+  CUstream cuStream = command_queue->get_next_transfer_stream();
 
   try {
     ScopedContext active(command_queue->get_context());
 
     if (event_wait_list) {
-      cuda_piEnqueueEventsWait(command_queue, num_events_in_wait_list,
-                               event_wait_list, nullptr);
+      enqueueEventsWait(cuStream, num_events_in_wait_list, event_wait_list);
     }
 
     CUarray array = image->mem_.surface_mem_.get_array();
@@ -3873,8 +4251,8 @@ pi_result cuda_piEnqueueMemImageRead(
     }
 
     if (event) {
-      auto new_event =
-          _pi_event::make_native(PI_COMMAND_TYPE_IMAGE_READ, command_queue);
+      auto new_event = _pi_event::make_native(PI_COMMAND_TYPE_IMAGE_READ,
+                                              command_queue, cuStream);
       new_event->record();
       *event = new_event;
     }
@@ -3903,14 +4281,13 @@ cuda_piEnqueueMemImageWrite(pi_queue command_queue, pi_mem image,
   assert(image->mem_type_ == _pi_mem::mem_type::surface);
 
   pi_result retErr = PI_SUCCESS;
-  CUstream cuStream = command_queue->get();
+  CUstream cuStream = command_queue->get_next_transfer_stream();
 
   try {
     ScopedContext active(command_queue->get_context());
 
     if (event_wait_list) {
-      cuda_piEnqueueEventsWait(command_queue, num_events_in_wait_list,
-                               event_wait_list, nullptr);
+      enqueueEventsWait(cuStream, num_events_in_wait_list, event_wait_list);
     }
 
     CUarray array = image->mem_.surface_mem_.get_array();
@@ -3941,8 +4318,8 @@ cuda_piEnqueueMemImageWrite(pi_queue command_queue, pi_mem image,
     }
 
     if (event) {
-      auto new_event =
-          _pi_event::make_native(PI_COMMAND_TYPE_IMAGE_WRITE, command_queue);
+      auto new_event = _pi_event::make_native(PI_COMMAND_TYPE_IMAGE_WRITE,
+                                              command_queue, cuStream);
       new_event->record();
       *event = new_event;
     }
@@ -3968,14 +4345,13 @@ pi_result cuda_piEnqueueMemImageCopy(pi_queue command_queue, pi_mem src_image,
          dst_image->mem_.surface_mem_.get_image_type());
 
   pi_result retErr = PI_SUCCESS;
-  CUstream cuStream = command_queue->get();
+  CUstream cuStream = command_queue->get_next_transfer_stream();
 
   try {
     ScopedContext active(command_queue->get_context());
 
     if (event_wait_list) {
-      cuda_piEnqueueEventsWait(command_queue, num_events_in_wait_list,
-                               event_wait_list, nullptr);
+      enqueueEventsWait(cuStream, num_events_in_wait_list, event_wait_list);
     }
 
     CUarray srcArray = src_image->mem_.surface_mem_.get_array();
@@ -4016,8 +4392,8 @@ pi_result cuda_piEnqueueMemImageCopy(pi_queue command_queue, pi_mem src_image,
     }
 
     if (event) {
-      auto new_event =
-          _pi_event::make_native(PI_COMMAND_TYPE_IMAGE_COPY, command_queue);
+      auto new_event = _pi_event::make_native(PI_COMMAND_TYPE_IMAGE_COPY,
+                                              command_queue, cuStream);
       new_event->record();
       *event = new_event;
     }
@@ -4082,16 +4458,17 @@ pi_result cuda_piEnqueueMemBufferMap(pi_queue command_queue, pi_mem buffer,
         num_events_in_wait_list, event_wait_list, event);
   } else {
     ScopedContext active(command_queue->get_context());
+    CUstream cuStream = command_queue->get_next_transfer_stream();
 
     if (is_pinned) {
-      ret_err = cuda_piEnqueueEventsWait(command_queue, num_events_in_wait_list,
-                                         event_wait_list, nullptr);
+      ret_err = enqueueEventsWait(cuStream, num_events_in_wait_list,
+                                  event_wait_list);
     }
 
     if (event) {
       try {
         *event = _pi_event::make_native(PI_COMMAND_TYPE_MEM_BUFFER_MAP,
-                                        command_queue);
+                                        command_queue, cuStream);
         (*event)->start();
         (*event)->record();
       } catch (pi_result error) {
@@ -4136,16 +4513,17 @@ pi_result cuda_piEnqueueMemUnmap(pi_queue command_queue, pi_mem memobj,
         num_events_in_wait_list, event_wait_list, event);
   } else {
     ScopedContext active(command_queue->get_context());
+    CUstream cuStream = command_queue->get_next_transfer_stream();
 
     if (is_pinned) {
-      ret_err = cuda_piEnqueueEventsWait(command_queue, num_events_in_wait_list,
-                                         event_wait_list, nullptr);
+      ret_err = enqueueEventsWait(cuStream, num_events_in_wait_list,
+                                  event_wait_list);
     }
 
     if (event) {
       try {
         *event = _pi_event::make_native(PI_COMMAND_TYPE_MEM_BUFFER_UNMAP,
-                                        command_queue);
+                                        command_queue, cuStream);
         (*event)->start();
         (*event)->record();
       } catch (pi_result error) {
@@ -4181,6 +4559,7 @@ pi_result cuda_piextUSMHostAlloc(void **result_ptr, pi_context context,
 }
 
 /// USM: Implements USM device allocations using a normal CUDA device pointer
+/// Allocations served by the pool of the context don't call the driver.
 ///
 pi_result cuda_piextUSMDeviceAlloc(void **result_ptr, pi_context context,
                                    pi_device device,
@@ -4192,8 +4571,14 @@ pi_result cuda_piextUSMDeviceAlloc(void **result_ptr, pi_context context,
   assert(properties == nullptr);
   pi_result result = PI_SUCCESS;
   try {
-    ScopedContext active(context);
-    result = PI_CHECK_ERROR(cuMemAlloc((CUdeviceptr *)result_ptr, size));
+    if (context->deviceMemPool_) {
+      USMAllocContext &pool = *context->deviceMemPool_;
+      *result_ptr =
+          alignment ? pool.allocate(size, alignment) : pool.allocate(size);
+    } else {
+      ScopedContext active(context);
+      result = PI_CHECK_ERROR(cuMemAlloc((CUdeviceptr *)result_ptr, size));
+    }
   } catch (pi_result error) {
     result = error;
   }
@@ -4241,7 +4626,11 @@ pi_result cuda_piextUSMFree(pi_context context, void *ptr) {
         &type, CU_POINTER_ATTRIBUTE_MEMORY_TYPE, (CUdeviceptr)ptr));
     assert(type == CU_MEMORYTYPE_DEVICE or type == CU_MEMORYTYPE_HOST);
     if (type == CU_MEMORYTYPE_DEVICE) {
-      result = PI_CHECK_ERROR(cuMemFree((CUdeviceptr)ptr));
+      if (context->deviceMemPool_) {
+        context->deviceMemPool_->deallocate(ptr);
+      } else {
+        result = PI_CHECK_ERROR(cuMemFree((CUdeviceptr)ptr));
+      }
     }
     if (type == CU_MEMORYTYPE_HOST) {
       result = PI_CHECK_ERROR(cuMemFreeHost(ptr));
@@ -4252,6 +4641,36 @@ pi_result cuda_piextUSMFree(pi_context context, void *ptr) {
   return result;
 }
 
+/// Page-locks the host memory with cuMemHostRegister, which makes the copies
+/// between it and the devices run as from memory of cuMemAllocHost.
+pi_result cuda_piextUSMImport(const void *ptr, size_t size,
+                              pi_context context) {
+  assert(context != nullptr);
+  try {
+    ScopedContext active(context);
+    const CUresult ret = cuMemHostRegister(const_cast<void *>(ptr), size,
+                                           CU_MEMHOSTREGISTER_PORTABLE);
+    // The registrations are global to the process, e.g. the memory may be
+    // registered for another context already.
+    if (ret == CUDA_ERROR_HOST_MEMORY_ALREADY_REGISTERED) {
+      return PI_INVALID_OPERATION;
+    }
+    return PI_CHECK_ERROR(ret);
+  } catch (pi_result error) {
+    return error;
+  }
+}
+
+pi_result cuda_piextUSMRelease(const void *ptr, pi_context context) {
+  assert(context != nullptr);
+  try {
+    ScopedContext active(context);
+    return PI_CHECK_ERROR(cuMemHostUnregister(const_cast<void *>(ptr)));
+  } catch (pi_result error) {
+    return error;
+  }
+}
+
 pi_result cuda_piextUSMEnqueueMemset(pi_queue queue, void *ptr, pi_int32 value,
                                      size_t count,
                                      pi_uint32 num_events_in_waitlist,
@@ -4259,17 +4678,17 @@ pi_result cuda_piextUSMEnqueueMemset(pi_queue queue, void *ptr, pi_int32 value,
                                      pi_event *event) {
   assert(queue != nullptr);
   assert(ptr != nullptr);
-  CUstream cuStream = queue->get();
+  CUstream cuStream = queue->get_next_transfer_stream();
   pi_result result = PI_SUCCESS;
   std::unique_ptr<_pi_event> event_ptr{nullptr};
 
   try {
     ScopedContext active(queue->get_context());
-    result = cuda_piEnqueueEventsWait(queue, num_events_in_waitlist,
-                                      events_waitlist, nullptr);
+    result = enqueueEventsWait(cuStream, num_events_in_waitlist,
+                               events_waitlist);
     if (event) {
-      event_ptr = std::unique_ptr<_pi_event>(
-          _pi_event::make_native(PI_COMMAND_TYPE_MEM_BUFFER_FILL, queue));
+      event_ptr = std::unique_ptr<_pi_event>(_pi_event::make_native(
+          PI_COMMAND_TYPE_MEM_BUFFER_FILL, queue, cuStream));
       event_ptr->start();
     }
     result = PI_CHECK_ERROR(cuMemsetD8Async(
@@ -4293,17 +4712,17 @@ pi_result cuda_piextUSMEnqueueMemcpy(pi_queue queue, pi_bool blocking,
   assert(queue != nullptr);
   assert(dst_ptr != nullptr);
   assert(src_ptr != nullptr);
-  CUstream cuStream = queue->get();
+  CUstream cuStream = queue->get_next_transfer_stream();
   pi_result result = PI_SUCCESS;
   std::unique_ptr<_pi_event> event_ptr{nullptr};
 
   try {
     ScopedContext active(queue->get_context());
-    result = cuda_piEnqueueEventsWait(queue, num_events_in_waitlist,
-                                      events_waitlist, nullptr);
+    result = enqueueEventsWait(cuStream, num_events_in_waitlist,
+                               events_waitlist);
     if (event) {
-      event_ptr = std::unique_ptr<_pi_event>(
-          _pi_event::make_native(PI_COMMAND_TYPE_MEM_BUFFER_COPY, queue));
+      event_ptr = std::unique_ptr<_pi_event>(_pi_event::make_native(
+          PI_COMMAND_TYPE_MEM_BUFFER_COPY, queue, cuStream));
       event_ptr->start();
     }
     result = PI_CHECK_ERROR(cuMemcpyAsync(
@@ -4323,6 +4742,124 @@ pi_result cuda_piextUSMEnqueueMemcpy(pi_queue queue, pi_bool blocking,
   return result;
 }
 
+pi_result cuda_piextUSMEnqueueMemcpyRect(
+    pi_queue queue, pi_bool blocking, void *dst_ptr, size_t dst_row_pitch,
+    size_t dst_slice_pitch, const void *src_ptr, size_t src_row_pitch,
+    size_t src_slice_pitch, pi_buff_rect_region region,
+    pi_uint32 num_events_in_waitlist, const pi_event *events_waitlist,
+    pi_event *event) {
+  assert(queue != nullptr);
+  assert(dst_ptr != nullptr);
+  assert(src_ptr != nullptr);
+  assert(region != nullptr);
+  CUstream cuStream = queue->get_next_transfer_stream();
+  pi_result result = PI_SUCCESS;
+  std::unique_ptr<_pi_event> event_ptr{nullptr};
+
+  src_row_pitch = (!src_row_pitch) ? region->width_bytes : src_row_pitch;
+  src_slice_pitch = (!src_slice_pitch) ? (region->height_scalar * src_row_pitch)
+                                       : src_slice_pitch;
+  dst_row_pitch = (!dst_row_pitch) ? region->width_bytes : dst_row_pitch;
+  dst_slice_pitch = (!dst_slice_pitch) ? (region->height_scalar * dst_row_pitch)
+                                       : dst_slice_pitch;
+
+  // With unified addressing, the driver finds out where the USM pointers
+  // point to.
+  CUDA_MEMCPY3D params = {0};
+  params.WidthInBytes = region->width_bytes;
+  params.Height = region->height_scalar;
+  params.Depth = region->depth_scalar;
+  params.srcMemoryType = CU_MEMORYTYPE_UNIFIED;
+  params.srcDevice = (CUdeviceptr)src_ptr;
+  params.srcPitch = src_row_pitch;
+  params.srcHeight = src_slice_pitch / src_row_pitch;
+  params.dstMemoryType = CU_MEMORYTYPE_UNIFIED;
+  params.dstDevice = (CUdeviceptr)dst_ptr;
+  params.dstPitch = dst_row_pitch;
+  params.dstHeight = dst_slice_pitch / dst_row_pitch;
+
+  try {
+    ScopedContext active(queue->get_context());
+    result = enqueueEventsWait(cuStream, num_events_in_waitlist,
+                               events_waitlist);
+    if (event) {
+      event_ptr = std::unique_ptr<_pi_event>(_pi_event::make_native(
+          PI_COMMAND_TYPE_MEM_BUFFER_COPY_RECT, queue, cuStream));
+      event_ptr->start();
+    }
+    result = PI_CHECK_ERROR(cuMemcpy3DAsync(&params, cuStream));
+    if (event) {
+      result = event_ptr->record();
+    }
+    if (blocking) {
+      result = PI_CHECK_ERROR(cuStreamSynchronize(cuStream));
+    }
+    if (event) {
+      *event = event_ptr.release();
+    }
+  } catch (pi_result err) {
+    result = err;
+  }
+  return result;
+}
+
+pi_result cuda_piextUSMEnqueueFillRect(pi_queue queue, void *ptr,
+                                       size_t row_pitch, const void *pattern,
+                                       size_t pattern_size, size_t width,
+                                       size_t height,
+                                       pi_uint32 num_events_in_waitlist,
+                                       const pi_event *events_waitlist,
+                                       pi_event *event) {
+  assert(queue != nullptr);
+  assert(ptr != nullptr);
+  assert(pattern != nullptr);
+  if (pattern_size != 1 && pattern_size != 2 && pattern_size != 4)
+    return PI_INVALID_VALUE;
+  CUstream cuStream = queue->get_next_transfer_stream();
+  pi_result result = PI_SUCCESS;
+  std::unique_ptr<_pi_event> event_ptr{nullptr};
+
+  try {
+    ScopedContext active(queue->get_context());
+    result = enqueueEventsWait(cuStream, num_events_in_waitlist,
+                               events_waitlist);
+    if (event) {
+      event_ptr = std::unique_ptr<_pi_event>(_pi_event::make_native(
+          PI_COMMAND_TYPE_MEM_BUFFER_FILL, queue, cuStream));
+      event_ptr->start();
+    }
+    // The widths of the memsets are in elements of the pattern.
+    const size_t elems = width / pattern_size;
+    switch (pattern_size) {
+    case 1:
+      result = PI_CHECK_ERROR(cuMemsetD2D8Async(
+          (CUdeviceptr)ptr, row_pitch,
+          *static_cast<const unsigned char *>(pattern), elems, height,
+          cuStream));
+      break;
+    case 2:
+      result = PI_CHECK_ERROR(cuMemsetD2D16Async(
+          (CUdeviceptr)ptr, row_pitch,
+          *static_cast<const unsigned short *>(pattern), elems, height,
+          cuStream));
+      break;
+    default:
+      result = PI_CHECK_ERROR(cuMemsetD2D32Async(
+          (CUdeviceptr)ptr, row_pitch,
+          *static_cast<const unsigned int *>(pattern), elems, height,
+          cuStream));
+      break;
+    }
+    if (event) {
+      result = event_ptr->record();
+      *event = event_ptr.release();
+    }
+  } catch (pi_result err) {
+    result = err;
+  }
+  return result;
+}
+
 pi_result cuda_piextUSMEnqueuePrefetch(pi_queue queue, const void *ptr,
                                        size_t size,
                                        pi_usm_migration_flags flags,
@@ -4331,7 +4868,7 @@ pi_result cuda_piextUSMEnqueuePrefetch(pi_queue queue, const void *ptr,
                                        pi_event *event) {
   assert(queue != nullptr);
   assert(ptr != nullptr);
-  CUstream cuStream = queue->get();
+  CUstream cuStream = queue->get_next_transfer_stream();
   pi_result result = PI_SUCCESS;
   std::unique_ptr<_pi_event> event_ptr{nullptr};
 
@@ -4341,11 +4878,11 @@ pi_result cuda_piextUSMEnqueuePrefetch(pi_queue queue, const void *ptr,
 
   try {
     ScopedContext active(queue->get_context());
-    result = cuda_piEnqueueEventsWait(queue, num_events_in_waitlist,
-                                      events_waitlist, nullptr);
+    result = enqueueEventsWait(cuStream, num_events_in_waitlist,
+                               events_waitlist);
     if (event) {
-      event_ptr = std::unique_ptr<_pi_event>(
-          _pi_event::make_native(PI_COMMAND_TYPE_MEM_BUFFER_COPY, queue));
+      event_ptr = std::unique_ptr<_pi_event>(_pi_event::make_native(
+          PI_COMMAND_TYPE_MEM_BUFFER_COPY, queue, cuStream));
       event_ptr->start();
     }
     result = PI_CHECK_ERROR(cuMemPrefetchAsync(
@@ -4475,6 +5012,134 @@ pi_result cuda_piextUSMGetMemAllocInfo(pi_context context, const void *ptr,
   return result;
 }
 
+/// Starts capturing the work enqueued to the queue into a CUDA graph. The
+/// capture is thread local, so other threads may keep using other queues of
+/// the context. Work before the capture is finished, so that the captured
+/// graph has no dependencies on it.
+///
+pi_result cuda_piextQueueBeginGraphCapture(pi_queue queue) {
+  assert(queue != nullptr);
+  if (queue->capturing_) {
+    return PI_INVALID_OPERATION;
+  }
+
+  try {
+    ScopedContext active(queue->get_context());
+    queue->for_each_stream([](CUstream stream) {
+      PI_CHECK_ERROR(cuStreamSynchronize(stream));
+    });
+    PI_CHECK_ERROR(cuStreamBeginCapture(queue->get(),
+                                        CU_STREAM_CAPTURE_MODE_THREAD_LOCAL));
+    queue->capturing_ = true;
+  } catch (pi_result err) {
+    return err;
+  }
+  return PI_SUCCESS;
+}
+
+/// Finishes the capture and turns the captured work into an executable graph.
+/// If \p graph already holds an executable graph, it is updated with the
+/// parameters of the captured one with cuGraphExecUpdate, which only fails if
+/// the sequence of the commands has changed. In that case the executable graph
+/// is rebuilt.
+///
+pi_result cuda_piextQueueEndGraphCapture(pi_queue queue,
+                                         pi_ext_command_graph *graph) {
+  assert(queue != nullptr);
+  assert(graph != nullptr);
+  if (!queue->capturing_) {
+    return PI_INVALID_OPERATION;
+  }
+
+  pi_result result = PI_SUCCESS;
+  try {
+    ScopedContext active(queue->get_context());
+    CUgraph cuGraph = nullptr;
+    queue->capturing_ = false;
+    PI_CHECK_ERROR(cuStreamEndCapture(queue->get(), &cuGraph));
+
+    pi_ext_command_graph graphImpl = *graph;
+    if (graphImpl) {
+      CUgraphNode errorNode;
+      CUgraphExecUpdateResult updateResult;
+      if (cuGraphExecUpdate(graphImpl->exec_, cuGraph, &errorNode,
+                            &updateResult) != CUDA_SUCCESS) {
+        PI_CHECK_ERROR(cuGraphExecDestroy(graphImpl->exec_));
+        result = PI_CHECK_ERROR(cuGraphInstantiate(&graphImpl->exec_, cuGraph,
+                                                   nullptr, nullptr, 0));
+      }
+    } else {
+      CUgraphExec cuGraphExec;
+      result = PI_CHECK_ERROR(
+          cuGraphInstantiate(&cuGraphExec, cuGraph, nullptr, nullptr, 0));
+      *graph = new _pi_ext_command_graph{cuGraphExec, queue->get_context(),
+                                         queue->device_};
+    }
+    // The executable graph doesn't need the graph it was built from.
+    PI_CHECK_ERROR(cuGraphDestroy(cuGraph));
+  } catch (pi_result err) {
+    result = err;
+  } catch (...) {
+    result = PI_OUT_OF_RESOURCES;
+  }
+  return result;
+}
+
+pi_result cuda_piextEnqueueCommandGraph(pi_queue queue,
+                                        pi_ext_command_graph graph,
+                                        pi_uint32 num_events_in_wait_list,
+                                        const pi_event *event_wait_list,
+                                        pi_event *event) {
+  assert(queue != nullptr);
+  assert(graph != nullptr);
+  if (queue->get_context() != graph->context_ ||
+      queue->device_ != graph->device_) {
+    return PI_INVALID_QUEUE;
+  }
+
+  pi_result result = PI_SUCCESS;
+  std::unique_ptr<_pi_event> retImplEv{nullptr};
+
+  try {
+    ScopedContext active(queue->get_context());
+    CUstream cuStream = queue->get_next_compute_stream();
+
+    result = enqueueEventsWait(cuStream, num_events_in_wait_list,
+                               event_wait_list);
+
+    if (event) {
+      retImplEv = std::unique_ptr<_pi_event>(_pi_event::make_native(
+          PI_COMMAND_TYPE_NDRANGE_KERNEL, queue, cuStream));
+      retImplEv->start();
+    }
+
+    result = PI_CHECK_ERROR(cuGraphLaunch(graph->get(), cuStream));
+
+    if (event) {
+      result = retImplEv->record();
+      *event = retImplEv.release();
+    }
+  } catch (pi_result err) {
+    result = err;
+  }
+  return result;
+}
+
+pi_result cuda_piextCommandGraphRelease(pi_ext_command_graph graph) {
+  assert(graph != nullptr);
+
+  try {
+    std::unique_ptr<_pi_ext_command_graph> graphImpl(graph);
+    ScopedContext active(graph->context_);
+    PI_CHECK_ERROR(cuGraphExecDestroy(graph->get()));
+  } catch (pi_result err) {
+    return err;
+  } catch (...) {
+    return PI_OUT_OF_RESOURCES;
+  }
+  return PI_SUCCESS;
+}
+
 const char SupportedVersion[] = _PI_H_VERSION_STRING;
 
 pi_result piPluginInit(pi_plugin *PluginInit) {
@@ -4590,6 +5255,7 @@ pi_result piPluginInit(pi_plugin *PluginInit) {
   _PI_CL(piEnqueueMemBufferWriteRect, cuda_piEnqueueMemBufferWriteRect)
   _PI_CL(piEnqueueMemBufferCopy, cuda_piEnqueueMemBufferCopy)
   _PI_CL(piEnqueueMemBufferCopyRect, cuda_piEnqueueMemBufferCopyRect)
+  _PI_CL(piextEnqueueMemBufferCopyPeer, cuda_piextEnqueueMemBufferCopyPeer)
   _PI_CL(piEnqueueMemBufferFill, cuda_piEnqueueMemBufferFill)
   _PI_CL(piEnqueueMemImageRead, cuda_piEnqueueMemImageRead)
   _PI_CL(piEnqueueMemImageWrite, cuda_piEnqueueMemImageWrite)
@@ -4602,14 +5268,25 @@ pi_result piPluginInit(pi_plugin *PluginInit) {
   _PI_CL(piextUSMDeviceAlloc, cuda_piextUSMDeviceAlloc)
   _PI_CL(piextUSMSharedAlloc, cuda_piextUSMSharedAlloc)
   _PI_CL(piextUSMFree, cuda_piextUSMFree)
+  _PI_CL(piextUSMImport, cuda_piextUSMImport)
+  _PI_CL(piextUSMRelease, cuda_piextUSMRelease)
   _PI_CL(piextUSMEnqueueMemset, cuda_piextUSMEnqueueMemset)
   _PI_CL(piextUSMEnqueueMemcpy, cuda_piextUSMEnqueueMemcpy)
+  _PI_CL(piextUSMEnqueueMemcpyRect, cuda_piextUSMEnqueueMemcpyRect)
+  _PI_CL(piextUSMEnqueueFillRect, cuda_piextUSMEnqueueFillRect)
   _PI_CL(piextUSMEnqueuePrefetch, cuda_piextUSMEnqueuePrefetch)
   _PI_CL(piextUSMEnqueueMemAdvise, cuda_piextUSMEnqueueMemAdvise)
   _PI_CL(piextUSMGetMemAllocInfo, cuda_piextUSMGetMemAllocInfo)
 
+  // Command graphs
+  _PI_CL(piextQueueBeginGraphCapture, cuda_piextQueueBeginGraphCapture)
+  _PI_CL(piextQueueEndGraphCapture, cuda_piextQueueEndGraphCapture)
+  _PI_CL(piextEnqueueCommandGraph, cuda_piextEnqueueCommandGraph)
+  _PI_CL(piextCommandGraphRelease, cuda_piextCommandGraphRelease)
+
   _PI_CL(piextKernelSetArgMemObj, cuda_piextKernelSetArgMemObj)
   _PI_CL(piextKernelSetArgSampler, cuda_piextKernelSetArgSampler)
+  _PI_CL(piextKernelSetArgs, cuda_piextKernelSetArgs)
 
 #undef _PI_CL
 
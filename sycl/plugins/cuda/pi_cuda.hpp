@@ -22,6 +22,7 @@
 #include <array>
 #include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstring>
 #include <cuda.h>
 #include <limits>
@@ -32,6 +33,8 @@
 #include <functional>
 #include <mutex>
 
+#include "../level_zero/usm_allocator.hpp"
+
 extern "C" {
 
 /// \cond INGORE_BLOCK_IN_DOXYGEN
@@ -82,6 +85,23 @@ public:
   pi_platform get_platform() const noexcept { return platform_; };
 };
 
+/// Allocates the slabs of the USM device memory pool of a context.
+/// The memory is allocated with the driver, within the given context.
+///
+class _pi_usm_device_memory : public SystemMemory {
+  _pi_context *context_;
+
+public:
+  explicit _pi_usm_device_memory(_pi_context *context) : context_{context} {}
+
+  void *allocate(size_t size) override;
+  void *allocate(size_t size, size_t alignment) override;
+  void deallocate(void *ptr) override;
+};
+
+/// Returns the parameters of the USM device memory pools.
+const USMAllocatorParameters &cuda_getUSMDevicePoolParameters();
+
 /// PI context mapping to a CUDA context object.
 ///
 /// There is no direct mapping between a CUDA context and a PI context,
@@ -120,6 +140,14 @@ public:
 ///  called upon destruction of the PI Context.
 ///  See proposal for details.
 ///
+/// <b> USM device memory pool </b>
+///
+///  `cuMemAlloc` and `cuMemFree` synchronize the device, so the small USM
+///  device allocations are served from a pool of slabs owned by the context.
+///  Memory released with `piextUSMFree` is reused without calling the driver,
+///  which is safe since SYCL requires that the memory is no longer used by
+///  any command when it is freed.
+///
 struct _pi_context {
 
   struct deleter_data {
@@ -138,10 +166,20 @@ struct _pi_context {
 
   CUevent evBase_; // CUDA event used as base counter
 
+  /// Pool of the USM device allocations, nullptr if pooling is disabled.
+  /// Released before the CUDA context, see cuda_piContextRelease.
+  std::unique_ptr<USMAllocContext> deviceMemPool_;
+
   _pi_context(kind k, CUcontext ctxt, _pi_device *devId)
       : kind_{k}, cuContext_{ctxt}, deviceId_{devId}, refCount_{1},
         evBase_(nullptr) {
     cuda_piDeviceRetain(deviceId_);
+    const USMAllocatorParameters &params = cuda_getUSMDevicePoolParameters();
+    if (params.MaxPoolableSize > 0) {
+      deviceMemPool_.reset(new USMAllocContext(
+          std::unique_ptr<SystemMemory>(new _pi_usm_device_memory(this)),
+          params));
+    }
   };
 
   ~_pi_context() { cuda_piDeviceRelease(deviceId_); }
@@ -348,20 +386,53 @@ struct _pi_mem {
 
 /// PI queue mapping on to CUstream objects.
 ///
+/// An out-of-order queue may own several streams so that commands which don't
+/// depend on each other run concurrently. Kernels are spread round-robin over
+/// the compute streams and memory operations over the transfer streams, which
+/// fall back to the compute streams if the queue has none. Dependencies
+/// between commands on different streams are expressed with cuStreamWaitEvent
+/// on the events of the wait list. The first compute stream is the native
+/// handle of the queue.
+///
+/// While the queue is recording a command graph all commands go to the first
+/// compute stream, which is the only one in capture mode.
+///
 struct _pi_queue {
   using native_type = CUstream;
 
   native_type stream_;
+  std::vector<native_type> computeStreams_;
+  std::vector<native_type> transferStreams_;
   _pi_context *context_;
   _pi_device *device_;
   pi_queue_properties properties_;
   std::atomic_uint32_t refCount_;
   std::atomic_uint32_t eventCount_;
-
-  _pi_queue(CUstream stream, _pi_context *context, _pi_device *device,
-            pi_queue_properties properties)
-      : stream_{stream}, context_{context}, device_{device},
-        properties_{properties}, refCount_{1}, eventCount_{0} {
+  std::atomic_uint32_t computeStreamIdx_;
+  std::atomic_uint32_t transferStreamIdx_;
+  bool capturing_;
+  /// Time for which the waits on the events of the queue poll them with
+  /// cuEventQuery before blocking in cuEventSynchronize, see
+  /// PI_EXT_ONEAPI_QUEUE_SPIN_WAIT. A wait polls in a busy loop for that time,
+  /// then yields the thread between the polls for as long again, and finally
+  /// blocks. Zero if the waits block at once.
+  std::chrono::microseconds waitSpinTime_;
+  /// The number of waits which saw the completion while polling in a busy
+  /// loop, while yielding, or blocked.
+  std::atomic_uint32_t numWaitsSpun_;
+  std::atomic_uint32_t numWaitsYielded_;
+  std::atomic_uint32_t numWaitsBlocked_;
+
+  _pi_queue(std::vector<CUstream> &&computeStreams,
+            std::vector<CUstream> &&transferStreams, _pi_context *context,
+            _pi_device *device, pi_queue_properties properties,
+            std::chrono::microseconds waitSpinTime)
+      : stream_{computeStreams[0]}, computeStreams_{std::move(computeStreams)},
+        transferStreams_{std::move(transferStreams)}, context_{context},
+        device_{device}, properties_{properties}, refCount_{1}, eventCount_{0},
+        computeStreamIdx_{0}, transferStreamIdx_{0}, capturing_{false},
+        waitSpinTime_{waitSpinTime}, numWaitsSpun_{0}, numWaitsYielded_{0},
+        numWaitsBlocked_{0} {
     cuda_piContextRetain(context_);
     cuda_piDeviceRetain(device_);
   }
@@ -373,6 +444,31 @@ struct _pi_queue {
 
   native_type get() const noexcept { return stream_; };
 
+  /// Returns the stream to launch the next kernel on.
+  native_type get_next_compute_stream() noexcept {
+    if (computeStreams_.size() == 1 || capturing_)
+      return stream_;
+    return computeStreams_[computeStreamIdx_++ % computeStreams_.size()];
+  }
+
+  /// Returns the stream to enqueue the next memory operation on.
+  native_type get_next_transfer_stream() noexcept {
+    if (transferStreams_.empty() || capturing_)
+      return get_next_compute_stream();
+    return transferStreams_[transferStreamIdx_++ % transferStreams_.size()];
+  }
+
+  bool has_multiple_streams() const noexcept {
+    return computeStreams_.size() + transferStreams_.size() > 1;
+  }
+
+  template <typename Func> void for_each_stream(Func &&f) {
+    for (native_type stream : computeStreams_)
+      f(stream);
+    for (native_type stream : transferStreams_)
+      f(stream);
+  }
+
   _pi_context *get_context() const { return context_; };
 
   pi_uint32 increment_reference_count() noexcept { return ++refCount_; }
@@ -402,6 +498,8 @@ public:
 
   pi_queue get_queue() const noexcept { return queue_; }
 
+  CUstream get_stream() const noexcept { return stream_; }
+
   pi_command_type get_command_type() const noexcept { return commandType_; }
 
   pi_uint32 get_reference_count() const noexcept { return refCount_; }
@@ -445,8 +543,14 @@ public:
   pi_uint64 get_end_time() const;
 
   // construct a native CUDA. This maps closely to the underlying CUDA event.
+  // The event is recorded on \p stream, which must belong to \p queue.
+  static pi_event make_native(pi_command_type type, pi_queue queue,
+                              CUstream stream) {
+    return new _pi_event(type, queue->get_context(), queue, stream);
+  }
+
   static pi_event make_native(pi_command_type type, pi_queue queue) {
-    return new _pi_event(type, queue->get_context(), queue);
+    return make_native(type, queue, queue->get());
   }
 
   pi_result release();
@@ -456,7 +560,8 @@ public:
 private:
   // This constructor is private to force programmers to use the make_native /
   // make_user static members in order to create a pi_event for CUDA.
-  _pi_event(pi_command_type type, pi_context context, pi_queue queue);
+  _pi_event(pi_command_type type, pi_context context, pi_queue queue,
+            CUstream stream);
 
   pi_command_type commandType_; // The type of command associated with event.
 
@@ -484,6 +589,8 @@ private:
   pi_queue queue_; // pi_queue associated with the event. If this is a user
                    // event, this will be nullptr.
 
+  CUstream stream_; // Stream of queue_ the associated command was enqueued to.
+
   pi_context context_; // pi_context associated with the event. If this is a
                        // native event, this will be the same context associated
                        // with the queue_ member.
@@ -706,6 +813,27 @@ struct _pi_sampler {
   pi_uint32 get_reference_count() const noexcept { return refCount_; }
 };
 
+/// PI command graph mapping on to an executable CUDA graph, which is built
+/// from the work captured on the stream of a queue.
+///
+struct _pi_ext_command_graph {
+  using native_type = CUgraphExec;
+
+  native_type exec_;
+  _pi_context *context_;
+  _pi_device *device_;
+
+  _pi_ext_command_graph(CUgraphExec exec, _pi_context *context,
+                        _pi_device *device)
+      : exec_{exec}, context_{context}, device_{device} {
+    cuda_piContextRetain(context_);
+  }
+
+  ~_pi_ext_command_graph() { cuda_piContextRelease(context_); }
+
+  native_type get() const noexcept { return exec_; }
+};
+
 // -------------------------------------------------------------
 // Helper types and functions
 //
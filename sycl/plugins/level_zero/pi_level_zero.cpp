@@ -273,6 +273,71 @@ _pi_context::decrementAliveEventsInPool(ze_event_pool_handle_t ZePool) {
   return ZE_RESULT_SUCCESS;
 }
 
+_pi_context::EventCacheShard &_pi_context::getEventCacheShard() {
+  size_t Shard = std::hash<std::thread::id>()(std::this_thread::get_id());
+  return EventCache[Shard % NumEventCacheShards];
+}
+
+bool _pi_context::getCachedEvent(ze_event_handle_t &ZeEvent,
+                                 ze_event_pool_handle_t &ZePool) {
+  EventCacheShard &Shard = getEventCacheShard();
+  std::lock_guard<std::mutex> Lock(Shard.Mutex);
+  if (Shard.Events.empty())
+    return false;
+  ZeEvent = Shard.Events.back().first;
+  ZePool = Shard.Events.back().second;
+  Shard.Events.pop_back();
+  return true;
+}
+
+ze_result_t _pi_context::cacheEvent(ze_event_handle_t ZeEvent,
+                                    ze_event_pool_handle_t ZePool) {
+  {
+    std::lock_guard<std::mutex> Lock(WaitedEventsMutex);
+    if (NumWaitsOnEvent.count(ZeEvent)) {
+      ReleasedWaitedEvents[ZeEvent] = ZePool;
+      return ZE_RESULT_SUCCESS;
+    }
+  }
+  if (ze_result_t ZeRes = zeEventHostReset(ZeEvent))
+    return ZeRes;
+  EventCacheShard &Shard = getEventCacheShard();
+  std::lock_guard<std::mutex> Lock(Shard.Mutex);
+  Shard.Events.emplace_back(ZeEvent, ZePool);
+  return ZE_RESULT_SUCCESS;
+}
+
+void _pi_context::retainWaitedEvents(const ze_event_handle_t *ZeEvents,
+                                     pi_uint32 NumEvents) {
+  std::lock_guard<std::mutex> Lock(WaitedEventsMutex);
+  for (pi_uint32 I = 0; I < NumEvents; I++)
+    ++NumWaitsOnEvent[ZeEvents[I]];
+}
+
+ze_result_t _pi_context::releaseWaitedEvents(
+    const std::vector<ze_event_handle_t> &ZeEvents) {
+  std::vector<std::pair<ze_event_handle_t, ze_event_pool_handle_t>> Released;
+  {
+    std::lock_guard<std::mutex> Lock(WaitedEventsMutex);
+    for (ze_event_handle_t ZeEvent : ZeEvents) {
+      auto It = NumWaitsOnEvent.find(ZeEvent);
+      if (It == NumWaitsOnEvent.end() || --It->second > 0)
+        continue;
+      NumWaitsOnEvent.erase(It);
+      auto ReleasedIt = ReleasedWaitedEvents.find(ZeEvent);
+      if (ReleasedIt != ReleasedWaitedEvents.end()) {
+        Released.push_back(*ReleasedIt);
+        ReleasedWaitedEvents.erase(ReleasedIt);
+      }
+    }
+  }
+  for (const auto &ReleasedEvent : Released)
+    if (ze_result_t ZeRes =
+            cacheEvent(ReleasedEvent.first, ReleasedEvent.second))
+      return ZeRes;
+  return ZE_RESULT_SUCCESS;
+}
+
 // Some opencl extensions we know are supported by all Level Zero devices.
 constexpr char ZE_SUPPORTED_EXTENSIONS[] =
     "cl_khr_il_program cl_khr_subgroups cl_intel_subgroups "
@@ -419,6 +484,22 @@ pi_result _pi_device::initialize() {
     return PI_ERROR_UNKNOWN;
   }
   this->ZeComputeQueueGroupIndex = ComputeGroupIndex;
+  this->ZeComputeQueueGroupNumQueues =
+      std::max(queueProperties[ComputeGroupIndex].numQueues, 1u);
+
+  // The first group with "copy" but no "compute" capabilities is the main
+  // copy engine. Groups following it, if any, are the link copy engines.
+  for (uint32_t i = 0; i < numQueueGroups; i++) {
+    if (!(queueProperties[i].flags &
+          ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COMPUTE) &&
+        (queueProperties[i].flags &
+         ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COPY)) {
+      ZeCopyQueueGroupIndex = i;
+      ZeCopyMaxMemoryFillPatternSize =
+          queueProperties[i].maxMemoryFillPatternSize;
+      break;
+    }
+  }
 
   // Cache device properties
   ZeDeviceProperties = {};
@@ -446,6 +527,20 @@ pi_result _pi_context::finalize() {
   // This function is called when pi_context is deallocated, piContextRelase.
   // There could be some memory that may have not been deallocated.
   // For example, zeEventPool could be still alive.
+  for (EventCacheShard &Shard : EventCache) {
+    for (const auto &CachedEvent : Shard.Events) {
+      ZE_CALL(zeEventDestroy(CachedEvent.first));
+      ZE_CALL(decrementAliveEventsInPool(CachedEvent.second));
+    }
+    Shard.Events.clear();
+  }
+  for (const auto &ReleasedEvent : ReleasedWaitedEvents) {
+    ZE_CALL(zeEventDestroy(ReleasedEvent.first));
+    ZE_CALL(decrementAliveEventsInPool(ReleasedEvent.second));
+  }
+  ReleasedWaitedEvents.clear();
+  NumWaitsOnEvent.clear();
+
   std::lock_guard<std::mutex> NumEventsLiveInEventPoolGuard(
       NumEventsLiveInEventPoolMutex, std::adopt_lock);
   if (ZeEventPool && NumEventsLiveInEventPool[ZeEventPool])
@@ -462,16 +557,47 @@ _pi_queue::resetCommandListFenceEntry(ze_command_list_handle_t ZeCommandList,
   // Event has been signalled: If the fence for the associated command list
   // is signalled, then reset the fence and command list and add them to the
   // available list for ruse in PI calls.
-  ZE_CALL(zeFenceReset(this->ZeCommandListFenceMap[ZeCommandList]));
+  bool IsCopy = isCopyCommandList(ZeCommandList);
+  ze_fence_handle_t ZeFence =
+      getCommandListFenceMap(ZeCommandList)[ZeCommandList];
+  // The last executed command list has completed.
+  if (ZeFence == ZeLastExecutedFence)
+    ZeLastExecutedFence = nullptr;
+  ZE_CALL(zeFenceReset(ZeFence));
   ZE_CALL(zeCommandListReset(ZeCommandList));
+  if (auto Res = releaseWaitLists(ZeCommandList))
+    return Res;
   if (MakeAvailable) {
     std::lock_guard<std::mutex> lock(this->Device->ZeCommandListCacheMutex);
-    this->Device->ZeCommandListCache.push_back(ZeCommandList);
+    (IsCopy ? this->Device->ZeCopyCommandListCache
+            : this->Device->ZeCommandListCache)
+        .push_back(ZeCommandList);
   }
 
   return PI_SUCCESS;
 }
 
+void _pi_queue::retainWaitList(ze_command_list_handle_t ZeCommandList,
+                               pi_uint32 NumEvents,
+                               const ze_event_handle_t *ZeEvents) {
+  if (NumEvents == 0)
+    return;
+  std::vector<ze_event_handle_t> &WaitedEvents =
+      ZeCommandListWaitedEvents[ZeCommandList];
+  WaitedEvents.insert(WaitedEvents.end(), ZeEvents, ZeEvents + NumEvents);
+  Context->retainWaitedEvents(ZeEvents, NumEvents);
+}
+
+pi_result _pi_queue::releaseWaitLists(ze_command_list_handle_t ZeCommandList) {
+  auto It = ZeCommandListWaitedEvents.find(ZeCommandList);
+  if (It == ZeCommandListWaitedEvents.end())
+    return PI_SUCCESS;
+  std::vector<ze_event_handle_t> WaitedEvents = std::move(It->second);
+  ZeCommandListWaitedEvents.erase(It);
+  ZE_CALL(Context->releaseWaitedEvents(WaitedEvents));
+  return PI_SUCCESS;
+}
+
 static const pi_uint32 ZeCommandListBatchSize = [] {
   // Default value of 0. This specifies to use dynamic batch size adjustment.
   pi_uint32 BatchSizeVal = 0;
@@ -488,15 +614,84 @@ static const pi_uint32 ZeCommandListBatchSize = [] {
   return BatchSizeVal;
 }();
 
+// Latency target of batching in microseconds. If it is non-zero, an open
+// command list is also executed when its first command has waited for longer
+// than that, or when the device has completed all the other work of the
+// queue, so that batching doesn't delay the commands of an idle device.
+// Disabled by default, set by SYCL_PI_LEVEL_ZERO_BATCH_LATENCY_US.
+static const std::chrono::microseconds ZeBatchLatencyTarget = [] {
+  const char *LatencyStr = std::getenv("SYCL_PI_LEVEL_ZERO_BATCH_LATENCY_US");
+  pi_int32 LatencyVal = LatencyStr ? std::atoi(LatencyStr) : 0;
+  // Negative numbers will be silently ignored.
+  return std::chrono::microseconds(LatencyVal > 0 ? LatencyVal : 0);
+}();
+
+// Time in microseconds for which the waits on the events of a queue poll them
+// before blocking in the driver, see _pi_queue::WaitSpinTime. Queues given
+// PI_EXT_ONEAPI_QUEUE_SPIN_WAIT poll for 50us by default, the other queues
+// only if SYCL_PI_LEVEL_ZERO_WAIT_SPIN_US is set. Negative values are ignored.
+static const pi_int32 ZeWaitSpinTimeEnv = [] {
+  const char *SpinStr = std::getenv("SYCL_PI_LEVEL_ZERO_WAIT_SPIN_US");
+  return SpinStr ? std::max(std::atoi(SpinStr), 0) : -1;
+}();
+static constexpr pi_int32 ZeDefaultWaitSpinTime = 50;
+
+// Controls if memory copies and fills are offloaded to the copy engine of
+// the device. Disabled by default, enabled by
+// SYCL_PI_LEVEL_ZERO_USE_COPY_ENGINE=1.
+static const bool ZeUseCopyEngine = [] {
+  const char *CopyEngineStr = std::getenv("SYCL_PI_LEVEL_ZERO_USE_COPY_ENGINE");
+  return CopyEngineStr && std::atoi(CopyEngineStr) != 0;
+}();
+
+// Controls if the queues use immediate command lists instead of batching the
+// commands into regular command lists. Disabled by default, enabled by
+// SYCL_PI_LEVEL_ZERO_USE_IMMEDIATE_COMMANDLISTS=1.
+static const bool ZeUseImmediateCommandLists = [] {
+  const char *ImmediateStr =
+      std::getenv("SYCL_PI_LEVEL_ZERO_USE_IMMEDIATE_COMMANDLISTS");
+  return ImmediateStr && std::atoi(ImmediateStr) != 0;
+}();
+
+// Controls if out-of-order queues spread their command lists across all the
+// command queues of the compute group instead of using only the first one.
+// Disabled by default, enabled by
+// SYCL_PI_LEVEL_ZERO_USE_MULTIPLE_COMPUTE_QUEUES=1.
+static const bool ZeUseMultipleComputeQueues = [] {
+  const char *MultipleStr =
+      std::getenv("SYCL_PI_LEVEL_ZERO_USE_MULTIPLE_COMPUTE_QUEUES");
+  return MultipleStr && std::atoi(MultipleStr) != 0;
+}();
+
+ze_command_queue_handle_t
+_pi_queue::getExecCommandQueue(ze_command_list_handle_t ZeCommandList) {
+  if (isCopyCommandList(ZeCommandList))
+    return ZeCopyCommandQueue;
+  auto It = ZeCommandListQueueMap.find(ZeCommandList);
+  return It != ZeCommandListQueueMap.end() ? It->second : ZeCommandQueue;
+}
+
+bool _pi_queue::useCopyEngine(size_t PatternSize) const {
+  return ZeCopyCommandQueue != nullptr &&
+         PatternSize <= Device->ZeCopyMaxMemoryFillPatternSize;
+}
+
 // Retrieve an available command list to be used in a PI call
 // Caller must hold a lock on the Queue passed in.
 pi_result _pi_device::getAvailableCommandList(
     pi_queue Queue, ze_command_list_handle_t *ZeCommandList,
-    ze_fence_handle_t *ZeFence, bool AllowBatching) {
+    ze_fence_handle_t *ZeFence, bool AllowBatching, bool UseCopyEngine) {
+  // All the commands of a queue with an immediate command list go to it.
+  if (Queue->ZeImmediateCommandList) {
+    *ZeCommandList = Queue->ZeImmediateCommandList;
+    *ZeFence = nullptr;
+    return PI_SUCCESS;
+  }
+
   // First see if there is an command-list open for batching commands
   // for this queue.
   if (Queue->ZeOpenCommandList) {
-    if (AllowBatching) {
+    if (AllowBatching && !UseCopyEngine) {
       *ZeCommandList = Queue->ZeOpenCommandList;
       *ZeFence = Queue->ZeOpenCommandListFence;
       return PI_SUCCESS;
@@ -520,6 +715,24 @@ pi_result _pi_device::getAvailableCommandList(
   ze_fence_desc_t ZeFenceDesc = {};
   ZeFenceDesc.stype = ZE_STRUCTURE_TYPE_FENCE_DESC;
 
+  // Command lists can only be executed on command queues of the group they
+  // were created for, so each engine has its own command lists and fences.
+  std::list<ze_command_list_handle_t> &ZeCommandListCache =
+      UseCopyEngine ? ZeCopyCommandListCache : this->ZeCommandListCache;
+  std::map<ze_command_list_handle_t, ze_fence_handle_t> &ZeCommandListFenceMap =
+      UseCopyEngine ? Queue->ZeCopyCommandListFenceMap
+                    : Queue->ZeCommandListFenceMap;
+  // A new fence binds the command list to the command queue it is created
+  // for: the copy queue, or the next compute queue in round-robin order.
+  auto bindCommandQueue = [&](ze_command_list_handle_t List) {
+    if (UseCopyEngine)
+      return Queue->ZeCopyCommandQueue;
+    return Queue->ZeCommandListQueueMap[List] =
+               Queue->getNextComputeCommandQueue();
+  };
+  if (UseCopyEngine)
+    ZeCommandListDesc.commandQueueGroupOrdinal = ZeCopyQueueGroupIndex;
+
   // Initally, we need to check if a command list has already been created
   // on this device that is available for use. If so, then reuse that
   // Level-Zero Command List and Fence for this PI call.
@@ -528,18 +741,19 @@ pi_result _pi_device::getAvailableCommandList(
     // will be a race condition.
     std::lock_guard<std::mutex> lock(Queue->Device->ZeCommandListCacheMutex);
 
-    if (Queue->Device->ZeCommandListCache.size() > 0) {
-      *ZeCommandList = Queue->Device->ZeCommandListCache.front();
-      *ZeFence = Queue->ZeCommandListFenceMap[*ZeCommandList];
+    if (ZeCommandListCache.size() > 0) {
+      *ZeCommandList = ZeCommandListCache.front();
+      *ZeFence = ZeCommandListFenceMap[*ZeCommandList];
       if (*ZeFence == nullptr) {
         // If there is a command list available on this device, but no
         // fence yet associated, then we must create a fence/list
         // reference for this Queue. This can happen if two Queues reuse
         // a device which did not have the resources freed.
-        ZE_CALL(zeFenceCreate(Queue->ZeCommandQueue, &ZeFenceDesc, ZeFence));
-        Queue->ZeCommandListFenceMap[*ZeCommandList] = *ZeFence;
+        ZE_CALL(zeFenceCreate(bindCommandQueue(*ZeCommandList), &ZeFenceDesc,
+                              ZeFence));
+        ZeCommandListFenceMap[*ZeCommandList] = *ZeFence;
       }
-      Queue->Device->ZeCommandListCache.pop_front();
+      ZeCommandListCache.pop_front();
       return PI_SUCCESS;
     }
   }
@@ -550,7 +764,7 @@ pi_result _pi_device::getAvailableCommandList(
   // if a command list has completed dispatch of its commands and is ready for
   // reuse. If a command list is found to have been signalled, then the
   // command list & fence are reset and we return.
-  for (const auto &MapEntry : Queue->ZeCommandListFenceMap) {
+  for (const auto &MapEntry : ZeCommandListFenceMap) {
     ze_result_t ZeResult = ZE_CALL_NOCHECK(zeFenceQueryStatus(MapEntry.second));
     if (ZeResult == ZE_RESULT_SUCCESS) {
       Queue->resetCommandListFenceEntry(MapEntry.first, false);
@@ -571,8 +785,9 @@ pi_result _pi_device::getAvailableCommandList(
                                 &ZeCommandListDesc, ZeCommandList));
     // Increments the total number of command lists created on this platform.
     this->Platform->ZeGlobalCommandListCount++;
-    ZE_CALL(zeFenceCreate(Queue->ZeCommandQueue, &ZeFenceDesc, ZeFence));
-    Queue->ZeCommandListFenceMap.insert(
+    ZE_CALL(zeFenceCreate(bindCommandQueue(*ZeCommandList), &ZeFenceDesc,
+                          ZeFence));
+    ZeCommandListFenceMap.insert(
         std::pair<ze_command_list_handle_t, ze_fence_handle_t>(*ZeCommandList,
                                                                *ZeFence));
     pi_result = PI_SUCCESS;
@@ -624,16 +839,50 @@ void _pi_queue::adjustBatchSizeForPartialBatch(pi_uint32 PartialBatchSize) {
   }
 }
 
+bool _pi_queue::isBatchLatencyTargetReached() {
+  if (ZeBatchLatencyTarget.count() == 0 || ZeOpenCommandListSize == 0)
+    return false;
+
+  if (std::chrono::steady_clock::now() - ZeOpenCommandListStartTime >=
+      ZeBatchLatencyTarget)
+    return true;
+
+  // Nothing else of this queue runs on the device, so waiting for the batch
+  // to fill up only adds latency.
+  return !ZeLastExecutedFence ||
+         ZE_CALL_NOCHECK(zeFenceQueryStatus(ZeLastExecutedFence)) ==
+             ZE_RESULT_SUCCESS;
+}
+
+void _pi_queue::recordBatchExecution() {
+  auto Latency = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - ZeOpenCommandListStartTime);
+  NumBatchesExecuted += 1;
+  NumBatchedCommands += ZeOpenCommandListSize;
+  BatchLatencyTotal += Latency;
+  BatchLatencyMax = std::max(BatchLatencyMax, Latency);
+}
+
 pi_result _pi_queue::executeCommandList(ze_command_list_handle_t ZeCommandList,
                                         ze_fence_handle_t ZeFence,
                                         bool IsBlocking,
                                         bool OKToBatchCommand) {
+  // Commands appended to an immediate command list are already submitted.
+  if (ZeCommandList == ZeImmediateCommandList) {
+    if (IsBlocking || (ZeSerialize & ZeSerializeBlock) != 0)
+      return synchronizeImmediateCommandList();
+    return PI_SUCCESS;
+  }
+
   if (OKToBatchCommand && this->isBatchingAllowed()) {
     if (this->ZeOpenCommandList != nullptr &&
         this->ZeOpenCommandList != ZeCommandList)
       die("executeCommandList: ZeOpenCommandList should be equal to"
           "null or ZeCommandList");
 
+    if (this->ZeOpenCommandListSize == 0)
+      this->ZeOpenCommandListStartTime = std::chrono::steady_clock::now();
+
     if (this->ZeOpenCommandListSize + 1 < QueueBatchSize) {
       this->ZeOpenCommandList = ZeCommandList;
       this->ZeOpenCommandListFence = ZeFence;
@@ -645,26 +894,38 @@ pi_result _pi_queue::executeCommandList(ze_command_list_handle_t ZeCommandList,
       //
       this->ZeOpenCommandListSize += 1;
 
-      return PI_SUCCESS;
-    }
+      if (!isBatchLatencyTargetReached())
+        return PI_SUCCESS;
 
-    adjustBatchSizeForFullBatch();
+      // The batch is closed by time rather than by count, so it is not
+      // used to adjust the batch size.
+      NumTimesClosedByLatency += 1;
+    } else {
+      this->ZeOpenCommandListSize += 1;
+      adjustBatchSizeForFullBatch();
+    }
 
+    recordBatchExecution();
     this->ZeOpenCommandList = nullptr;
     this->ZeOpenCommandListFence = nullptr;
     this->ZeOpenCommandListSize = 0;
   }
 
+  ze_command_queue_handle_t ZeExecQueue = getExecCommandQueue(ZeCommandList);
+
   // Close the command list and have it ready for dispatch.
   ZE_CALL(zeCommandListClose(ZeCommandList));
   // Offload command list to the GPU for asynchronous execution
-  ZE_CALL(zeCommandQueueExecuteCommandLists(ZeCommandQueue, 1, &ZeCommandList,
+  ZE_CALL(zeCommandQueueExecuteCommandLists(ZeExecQueue, 1, &ZeCommandList,
                                             ZeFence));
 
+  if (ZeFence && !isCopyCommandList(ZeCommandList))
+    ZeLastExecutedFence = ZeFence;
+
   // Check global control to make every command blocking for debugging.
   if (IsBlocking || (ZeSerialize & ZeSerializeBlock) != 0) {
     // Wait until command lists attached to the command queue are executed.
-    ZE_CALL(zeCommandQueueSynchronize(ZeCommandQueue, UINT32_MAX));
+    ZE_CALL(zeCommandQueueSynchronize(ZeExecQueue, UINT32_MAX));
   }
   return PI_SUCCESS;
 }
@@ -681,6 +942,7 @@ pi_result _pi_queue::executeOpenCommandList() {
     auto OpenListFence = this->ZeOpenCommandListFence;
 
     adjustBatchSizeForPartialBatch(this->ZeOpenCommandListSize);
+    recordBatchExecution();
 
     this->ZeOpenCommandList = nullptr;
     this->ZeOpenCommandListFence = nullptr;
@@ -692,6 +954,28 @@ pi_result _pi_queue::executeOpenCommandList() {
   return PI_SUCCESS;
 }
 
+pi_result _pi_queue::synchronizeImmediateCommandList() {
+  if (!ZeImmediateSyncEvent) {
+    size_t Index = 0;
+    ZE_CALL(Context->getFreeSlotInExistingOrNewPool(ZeImmediateSyncEventPool,
+                                                    Index));
+    ze_event_desc_t ZeEventDesc = {};
+    ZeEventDesc.signal = ZE_EVENT_SCOPE_FLAG_HOST;
+    ZeEventDesc.wait = ZE_EVENT_SCOPE_FLAG_HOST;
+    ZeEventDesc.index = Index;
+    ZE_CALL(zeEventCreate(ZeImmediateSyncEventPool, &ZeEventDesc,
+                          &ZeImmediateSyncEvent));
+  }
+
+  // The barrier is signalled once all the commands appended before it have
+  // completed.
+  ZE_CALL(zeCommandListAppendBarrier(ZeImmediateCommandList,
+                                     ZeImmediateSyncEvent, 0, nullptr));
+  ZE_CALL(zeEventHostSynchronize(ZeImmediateSyncEvent, UINT32_MAX));
+  ZE_CALL(zeEventHostReset(ZeImmediateSyncEvent));
+  return releaseWaitLists(ZeImmediateCommandList);
+}
+
 ze_event_handle_t *_pi_event::createZeEventList(pi_uint32 EventListLength,
                                                 const pi_event *EventList) {
   try {
@@ -710,6 +994,32 @@ void _pi_event::deleteZeEventList(ze_event_handle_t *ZeEventList) {
   delete[] ZeEventList;
 }
 
+// Creates the event of a command, if the caller asks for one, and the list of
+// the Level Zero events the command waits for. Neither uses the state of the
+// queue, so the enqueue interfaces do this before locking the queue, which
+// keeps shorter the time the other threads enqueueing to it wait for the lock.
+// The command list of the event is set once the command is appended to one.
+static pi_result createEventAndZeWaitList(pi_queue Queue,
+                                          pi_command_type CommandType,
+                                          pi_event *Event,
+                                          pi_uint32 NumEventsInWaitList,
+                                          const pi_event *EventWaitList,
+                                          ze_event_handle_t *&ZeEventWaitList) {
+  if (Event) {
+    if (auto Res = piEventCreate(Queue->Context, Event))
+      return Res;
+
+    (*Event)->Queue = Queue;
+    (*Event)->CommandType = CommandType;
+  }
+
+  ZeEventWaitList =
+      _pi_event::createZeEventList(NumEventsInWaitList, EventWaitList);
+  if (!ZeEventWaitList)
+    return PI_OUT_OF_HOST_MEMORY;
+  return PI_SUCCESS;
+}
+
 extern "C" {
 
 // Forward declarations
@@ -1132,6 +1442,10 @@ pi_result piDeviceRelease(pi_device Device) {
            Device->ZeCommandListCache) {
         zeCommandListDestroy(ZeCommandList);
       }
+      for (ze_command_list_handle_t &ZeCommandList :
+           Device->ZeCopyCommandListCache) {
+        zeCommandListDestroy(ZeCommandList);
+      }
       Device->ZeCommandListCacheMutex.unlock();
       delete Device;
     }
@@ -1900,43 +2214,77 @@ pi_result piContextRelease(pi_context Context) {
   return PI_SUCCESS;
 }
 
-pi_result piQueueCreate(pi_context Context, pi_device Device,
-                        pi_queue_properties Properties, pi_queue *Queue) {
-
-  // Check that unexpected bits are not set.
-  PI_ASSERT(!(Properties & ~(PI_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE |
-                             PI_QUEUE_PROFILING_ENABLE | PI_QUEUE_ON_DEVICE |
-                             PI_QUEUE_ON_DEVICE_DEFAULT)),
-            PI_INVALID_VALUE);
-
+// Creates the queue on the device, which is either a device of the context or
+// a sub-device of one.
+static pi_result createQueue(pi_context Context, pi_device Device,
+                             pi_queue_properties Properties, pi_queue *Queue) {
   ze_device_handle_t ZeDevice;
   ze_command_queue_handle_t ZeCommandQueue;
 
-  PI_ASSERT(Context, PI_INVALID_CONTEXT);
-
-  if (std::find(Context->Devices.begin(), Context->Devices.end(), Device) ==
-      Context->Devices.end()) {
-    return PI_INVALID_DEVICE;
-  }
-
-  PI_ASSERT(Device, PI_INVALID_DEVICE);
-
   ZeDevice = Device->ZeDevice;
   ze_command_queue_desc_t ZeCommandQueueDesc = {};
   ZeCommandQueueDesc.ordinal = Device->ZeComputeQueueGroupIndex;
   ZeCommandQueueDesc.index = 0;
   ZeCommandQueueDesc.mode = ZE_COMMAND_QUEUE_MODE_ASYNCHRONOUS;
+  if (Properties & PI_EXT_ONEAPI_QUEUE_PRIORITY_LOW)
+    ZeCommandQueueDesc.priority = ZE_COMMAND_QUEUE_PRIORITY_PRIORITY_LOW;
+  else if (Properties & PI_EXT_ONEAPI_QUEUE_PRIORITY_HIGH)
+    ZeCommandQueueDesc.priority = ZE_COMMAND_QUEUE_PRIORITY_PRIORITY_HIGH;
 
   ZE_CALL(
       zeCommandQueueCreate(Context->ZeContext, ZeDevice,
                            &ZeCommandQueueDesc, // TODO: translate properties
                            &ZeCommandQueue));
 
+  // The immediate command list is created on the same engine and is used for
+  // all the commands instead of the command queue.
+  ze_command_list_handle_t ZeImmediateCommandList = nullptr;
+  if (ZeUseImmediateCommandLists)
+    ZE_CALL(zeCommandListCreateImmediate(Context->ZeContext, ZeDevice,
+                                         &ZeCommandQueueDesc,
+                                         &ZeImmediateCommandList));
+
+  // Commands on different command queues are only ordered by the events in
+  // their wait lists, which an in-order queue doesn't have to provide. So only
+  // out-of-order queues use the other compute queues and the copy engine.
+  std::vector<ze_command_queue_handle_t> ZeExtraComputeCommandQueues;
+  if (ZeUseMultipleComputeQueues && !ZeUseImmediateCommandLists &&
+      (Properties & PI_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE)) {
+    for (uint32_t I = 1; I < Device->ZeComputeQueueGroupNumQueues; ++I) {
+      ze_command_queue_handle_t ZeExtraQueue;
+      ZeCommandQueueDesc.index = I;
+      ZE_CALL(zeCommandQueueCreate(Context->ZeContext, ZeDevice,
+                                   &ZeCommandQueueDesc, &ZeExtraQueue));
+      ZeExtraComputeCommandQueues.push_back(ZeExtraQueue);
+    }
+    ZeCommandQueueDesc.index = 0;
+  }
+
+  ze_command_queue_handle_t ZeCopyCommandQueue = nullptr;
+  if (ZeUseCopyEngine && !ZeImmediateCommandList && Device->hasCopyEngine() &&
+      (Properties & PI_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE)) {
+    ZeCommandQueueDesc.ordinal = Device->ZeCopyQueueGroupIndex;
+    ZE_CALL(zeCommandQueueCreate(Context->ZeContext, ZeDevice,
+                                 &ZeCommandQueueDesc, &ZeCopyCommandQueue));
+  }
+
   PI_ASSERT(Queue, PI_INVALID_QUEUE);
 
   try {
-    *Queue =
-        new _pi_queue(ZeCommandQueue, Context, Device, ZeCommandListBatchSize);
+    *Queue = new _pi_queue(ZeCommandQueue, Context, Device,
+                           ZeCommandListBatchSize, ZeCopyCommandQueue);
+    // The commands of a high priority queue are not batched: they are
+    // submitted as soon as they are enqueued.
+    if (Properties & PI_EXT_ONEAPI_QUEUE_PRIORITY_HIGH)
+      (*Queue)->QueueBatchSize = 0;
+    if (ZeWaitSpinTimeEnv >= 0)
+      (*Queue)->WaitSpinTime = std::chrono::microseconds(ZeWaitSpinTimeEnv);
+    else if (Properties & PI_EXT_ONEAPI_QUEUE_SPIN_WAIT)
+      (*Queue)->WaitSpinTime = std::chrono::microseconds(ZeDefaultWaitSpinTime);
+    (*Queue)->ZeImmediateCommandList = ZeImmediateCommandList;
+    (*Queue)->ZeComputeCommandQueues.insert(
+        (*Queue)->ZeComputeCommandQueues.end(),
+        ZeExtraComputeCommandQueues.begin(), ZeExtraComputeCommandQueues.end());
   } catch (const std::bad_alloc &) {
     return PI_OUT_OF_HOST_MEMORY;
   } catch (...) {
@@ -1945,6 +2293,85 @@ pi_result piQueueCreate(pi_context Context, pi_device Device,
   return PI_SUCCESS;
 }
 
+pi_result _pi_queue::createSubDeviceQueues(pi_queue_properties Properties) {
+  uint32_t Count = 0;
+  ZE_CALL(zeDeviceGetSubDevices(Device->ZeDevice, &Count, nullptr));
+  if (Count < 2)
+    return PI_SUCCESS;
+
+  const pi_device_partition_property Partition[] = {
+      PI_DEVICE_PARTITION_BY_AFFINITY_DOMAIN,
+      PI_DEVICE_AFFINITY_DOMAIN_NEXT_PARTITIONABLE, 0};
+  std::vector<pi_device> SubDevices(Count);
+  if (auto Res = piDevicePartition(Device, Partition, Count, SubDevices.data(),
+                                   nullptr))
+    return Res;
+  // The queues are owned by this queue, and the sub-devices by the queues.
+  for (uint32_t I = 0; I < Count; ++I) {
+    pi_queue SubDeviceQueue = nullptr;
+    if (auto Res =
+            createQueue(Context, SubDevices[I], Properties, &SubDeviceQueue)) {
+      for (uint32_t J = I; J < Count; ++J)
+        piDeviceRelease(SubDevices[J]);
+      return Res;
+    }
+    SubDeviceQueues.push_back(SubDeviceQueue);
+  }
+  return PI_SUCCESS;
+}
+
+pi_queue _pi_queue::getKernelQueue() {
+  if (SubDeviceQueues.empty())
+    return this;
+  std::lock_guard<std::mutex> Lock(PiQueueMutex);
+  pi_queue KernelQueue = SubDeviceQueues[NextSubDeviceQueue];
+  NextSubDeviceQueue = (NextSubDeviceQueue + 1) % SubDeviceQueues.size();
+  return KernelQueue;
+}
+
+pi_result piQueueCreate(pi_context Context, pi_device Device,
+                        pi_queue_properties Properties, pi_queue *Queue) {
+
+  // Check that unexpected bits are not set.
+  PI_ASSERT(!(Properties & ~(PI_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE |
+                             PI_QUEUE_PROFILING_ENABLE | PI_QUEUE_ON_DEVICE |
+                             PI_QUEUE_ON_DEVICE_DEFAULT |
+                             PI_EXT_ONEAPI_QUEUE_PRIORITY_LOW |
+                             PI_EXT_ONEAPI_QUEUE_PRIORITY_HIGH |
+                             PI_EXT_ONEAPI_QUEUE_SUB_DEVICE_SCALING |
+                             PI_EXT_ONEAPI_QUEUE_SPIN_WAIT)),
+            PI_INVALID_VALUE);
+
+  PI_ASSERT(Context, PI_INVALID_CONTEXT);
+
+  if (std::find(Context->Devices.begin(), Context->Devices.end(), Device) ==
+      Context->Devices.end()) {
+    return PI_INVALID_DEVICE;
+  }
+
+  PI_ASSERT(Device, PI_INVALID_DEVICE);
+  PI_ASSERT(Queue, PI_INVALID_QUEUE);
+
+  const pi_queue_properties QueueProperties =
+      Properties & ~PI_EXT_ONEAPI_QUEUE_SUB_DEVICE_SCALING;
+  if (auto Res = createQueue(Context, Device, QueueProperties, Queue))
+    return Res;
+
+  // The kernels of an out-of-order queue are not ordered with each other, so
+  // they can run on different sub-devices. The other commands stay on the
+  // root device: the memory is shared by the sub-devices.
+  if ((Properties & PI_EXT_ONEAPI_QUEUE_SUB_DEVICE_SCALING) &&
+      (Properties & PI_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE) &&
+      !Device->IsSubDevice && !ZeUseImmediateCommandLists) {
+    if (auto Res = (*Queue)->createSubDeviceQueues(QueueProperties)) {
+      piQueueRelease(*Queue);
+      *Queue = nullptr;
+      return Res;
+    }
+  }
+  return PI_SUCCESS;
+}
+
 pi_result piQueueGetInfo(pi_queue Queue, pi_queue_info ParamName,
                          size_t ParamValueSize, void *ParamValue,
                          size_t *ParamValueSizeRet) {
@@ -1999,16 +2426,78 @@ pi_result piQueueRelease(pi_queue Queue) {
     if (auto Res = Queue->executeOpenCommandList())
       return Res;
 
+    for (pi_queue SubDeviceQueue : Queue->SubDeviceQueues) {
+      pi_device SubDevice = SubDeviceQueue->Device;
+      if (auto Res = piQueueRelease(SubDeviceQueue))
+        return Res;
+      piDeviceRelease(SubDevice);
+    }
+    Queue->SubDeviceQueues.clear();
+
+    // The events waited for by the commands still running are only reused
+    // once the commands have completed.
+    for (const auto &WaitedEvents : Queue->ZeCommandListWaitedEvents) {
+      ze_command_list_handle_t ZeCommandList = WaitedEvents.first;
+      if (ZeCommandList == Queue->ZeImmediateCommandList)
+        continue;
+      ZE_CALL(zeFenceHostSynchronize(
+          Queue->getCommandListFenceMap(ZeCommandList)[ZeCommandList],
+          UINT32_MAX));
+    }
+    if (Queue->ZeCommandListWaitedEvents.count(Queue->ZeImmediateCommandList))
+      if (auto Res = Queue->synchronizeImmediateCommandList())
+        return Res;
+    for (const auto &WaitedEvents : Queue->ZeCommandListWaitedEvents)
+      ZE_CALL(Queue->Context->releaseWaitedEvents(WaitedEvents.second));
+    Queue->ZeCommandListWaitedEvents.clear();
+
     // Destroy all the fences created associated with this queue.
     for (const auto &MapEntry : Queue->ZeCommandListFenceMap) {
       ZE_CALL(zeFenceDestroy(MapEntry.second));
     }
     Queue->ZeCommandListFenceMap.clear();
-    ZE_CALL(zeCommandQueueDestroy(Queue->ZeCommandQueue));
+    for (const auto &MapEntry : Queue->ZeCopyCommandListFenceMap) {
+      ZE_CALL(zeFenceDestroy(MapEntry.second));
+    }
+    Queue->ZeCopyCommandListFenceMap.clear();
+    Queue->ZeCommandListQueueMap.clear();
+    for (ze_command_queue_handle_t ZeQueue : Queue->ZeComputeCommandQueues) {
+      ZE_CALL(zeCommandQueueDestroy(ZeQueue));
+    }
+    Queue->ZeComputeCommandQueues.clear();
     Queue->ZeCommandQueue = nullptr;
+    if (Queue->ZeCopyCommandQueue) {
+      ZE_CALL(zeCommandQueueDestroy(Queue->ZeCopyCommandQueue));
+      Queue->ZeCopyCommandQueue = nullptr;
+    }
+    if (Queue->ZeImmediateCommandList) {
+      ZE_CALL(zeCommandListDestroy(Queue->ZeImmediateCommandList));
+      Queue->ZeImmediateCommandList = nullptr;
+    }
+    if (Queue->ZeImmediateSyncEvent) {
+      ZE_CALL(zeEventDestroy(Queue->ZeImmediateSyncEvent));
+      ZE_CALL(Queue->Context->decrementAliveEventsInPool(
+          Queue->ZeImmediateSyncEventPool));
+      Queue->ZeImmediateSyncEvent = nullptr;
+    }
 
     zePrint("piQueueRelease NumTimesClosedFull %d, NumTimesClosedEarly %d\n",
             Queue->NumTimesClosedFull, Queue->NumTimesClosedEarly);
+    zePrint("piQueueRelease NumBatchesExecuted %d, NumBatchedCommands %d, "
+            "NumTimesClosedByLatency %d, average batch latency %lld us, "
+            "max batch latency %lld us\n",
+            Queue->NumBatchesExecuted, Queue->NumBatchedCommands,
+            Queue->NumTimesClosedByLatency,
+            static_cast<long long>(
+                Queue->NumBatchesExecuted
+                    ? Queue->BatchLatencyTotal.count() /
+                          Queue->NumBatchesExecuted
+                    : 0),
+            static_cast<long long>(Queue->BatchLatencyMax.count()));
+    zePrint("piQueueRelease NumWaitsSpun %d, NumWaitsYielded %d, "
+            "NumWaitsBlocked %d\n",
+            Queue->NumWaitsSpun.load(), Queue->NumWaitsYielded.load(),
+            Queue->NumWaitsBlocked.load());
   }
   return PI_SUCCESS;
 }
@@ -2024,7 +2513,17 @@ pi_result piQueueFinish(pi_queue Queue) {
   if (auto Res = Queue->executeOpenCommandList())
     return Res;
 
-  ZE_CALL(zeCommandQueueSynchronize(Queue->ZeCommandQueue, UINT32_MAX));
+  for (pi_queue SubDeviceQueue : Queue->SubDeviceQueues)
+    if (auto Res = piQueueFinish(SubDeviceQueue))
+      return Res;
+
+  if (Queue->ZeImmediateCommandList)
+    return Queue->synchronizeImmediateCommandList();
+
+  for (ze_command_queue_handle_t ZeQueue : Queue->ZeComputeCommandQueues)
+    ZE_CALL(zeCommandQueueSynchronize(ZeQueue, UINT32_MAX));
+  if (Queue->ZeCopyCommandQueue)
+    ZE_CALL(zeCommandQueueSynchronize(Queue->ZeCopyCommandQueue, UINT32_MAX));
   return PI_SUCCESS;
 }
 
@@ -2086,7 +2585,24 @@ pi_result piMemBufferCreate(pi_context Context, pi_mem_flags Flags, size_t Size,
                             Context->Devices[0]->ZeDeviceProperties.flags &
                                 ZE_DEVICE_PROPERTY_FLAG_INTEGRATED;
 
-  if (DeviceIsIntegrated) {
+  // If the user memory of an integrated device is itself a USM host or shared
+  // allocation of this context, it is used as the buffer storage.  Then
+  // neither the creation nor the map/unmap operations copy the data.
+  bool UseHostPtrAsIs = false;
+  if (DeviceIsIntegrated && HostPtr && (Flags & PI_MEM_FLAGS_HOST_PTR_USE)) {
+    ze_memory_allocation_properties_t ZeMemoryAllocationProperties = {};
+    ze_device_handle_t ZeDeviceHandle;
+    ZE_CALL(zeMemGetAllocProperties(Context->ZeContext, HostPtr,
+                                    &ZeMemoryAllocationProperties,
+                                    &ZeDeviceHandle));
+    UseHostPtrAsIs =
+        ZeMemoryAllocationProperties.type == ZE_MEMORY_TYPE_HOST ||
+        ZeMemoryAllocationProperties.type == ZE_MEMORY_TYPE_SHARED;
+  }
+
+  if (UseHostPtrAsIs) {
+    Ptr = HostPtr;
+  } else if (DeviceIsIntegrated) {
     ze_host_mem_alloc_desc_t ZeDesc = {};
     ZeDesc.flags = 0;
 
@@ -2100,7 +2616,7 @@ pi_result piMemBufferCreate(pi_context Context, pi_mem_flags Flags, size_t Size,
     ZE_CALL(
         zeMemAllocDevice(Context->ZeContext, &ZeDesc, Size, 1, ZeDevice, &Ptr));
   }
-  if (HostPtr) {
+  if (HostPtr && !UseHostPtrAsIs) {
     if ((Flags & PI_MEM_FLAGS_HOST_PTR_USE) != 0 ||
         (Flags & PI_MEM_FLAGS_HOST_PTR_COPY) != 0) {
       // Initialize the buffer with user data
@@ -2121,13 +2637,16 @@ pi_result piMemBufferCreate(pi_context Context, pi_mem_flags Flags, size_t Size,
     }
   }
 
-  auto HostPtrOrNull =
-      (Flags & PI_MEM_FLAGS_HOST_PTR_USE) ? pi_cast<char *>(HostPtr) : nullptr;
+  auto HostPtrOrNull = (Flags & PI_MEM_FLAGS_HOST_PTR_USE) && !UseHostPtrAsIs
+                           ? pi_cast<char *>(HostPtr)
+                           : nullptr;
   try {
-    *RetMem = new _pi_buffer(
+    auto Buffer = new _pi_buffer(
         Context, pi_cast<char *>(Ptr) /* Level Zero Memory Handle */,
         HostPtrOrNull, nullptr, 0, 0,
         DeviceIsIntegrated /* Flag indicating allocation in host memory */);
+    Buffer->OwnZeMem = !UseHostPtrAsIs;
+    *RetMem = Buffer;
   } catch (const std::bad_alloc &) {
     return PI_OUT_OF_HOST_MEMORY;
   } catch (...) {
@@ -2160,7 +2679,7 @@ pi_result piMemRelease(pi_mem Mem) {
       ZE_CALL(zeImageDestroy(pi_cast<ze_image_handle_t>(Mem->getZeHandle())));
     } else {
       auto Buf = static_cast<_pi_buffer *>(Mem);
-      if (!Buf->isSubBuffer()) {
+      if (!Buf->isSubBuffer() && Buf->OwnZeMem) {
         ZE_CALL(zeMemFree(Mem->Context->ZeContext, Mem->getZeHandle()));
       }
     }
@@ -2450,7 +2969,7 @@ pi_result piProgramGetInfo(pi_program Program, pi_program_info ParamName,
     // TODO: return all devices this program exists for.
     return ReturnValue(Program->Context->Devices[0]);
   case PI_PROGRAM_INFO_BINARY_SIZES: {
-    size_t SzBinary;
+    size_t SzBinary = 0;
     if (Program->State == _pi_program::IL ||
         Program->State == _pi_program::Native) {
       SzBinary = Program->CodeLength;
@@ -2466,16 +2985,15 @@ pi_result piProgramGetInfo(pi_program Program, pi_program_info ParamName,
       // PI_PROGRAM_INFO_BINARY_SIZES API assume the entire linked program is
       // one contiguous region, which is not the case for LinkedExe program
       // in Level Zero.  Therefore, this API is unimplemented when the Program
-      // has more than one module.
+      // has more than one module: a zero size is reported, which tells the
+      // caller (e.g. the persistent device code cache) there is no binary to
+      // save.
       _pi_program::ModuleIterator ModIt(Program);
 
       PI_ASSERT(!ModIt.Done(), PI_INVALID_VALUE);
 
-      if (ModIt.Count() > 1) {
-        die("piProgramGetInfo: PI_PROGRAM_INFO_BINARY_SIZES not implemented "
-            "for linked programs");
-      }
-      ZE_CALL(zeModuleGetNativeBinary(*ModIt, &SzBinary, nullptr));
+      if (ModIt.Count() == 1)
+        ZE_CALL(zeModuleGetNativeBinary(*ModIt, &SzBinary, nullptr));
     }
     // This is an array of 1 element, initialized as if it were scalar.
     return ReturnValue(size_t{SzBinary});
@@ -3025,11 +3543,14 @@ zeModuleGetPropertiesMock(ze_module_handle_t hModule,
 }
 
 // Returns true if we should use the Level Zero driver online linking APIs.
-// At the time this code was written, these APIs exist but do not work.  We
-// think that support in the DPC++ runtime is ready once the driver bugs are
-// fixed, so runtime support can be enabled by setting an environment variable.
+// The DPC++ runtime links the fallback device libraries to the user programs
+// with them, so this is the default.  Setting SYCL_ENABLE_LEVEL_ZERO_LINK=0
+// falls back to the mocks, to work around drivers with broken linking.
 static bool isOnlineLinkEnabled() {
-  static bool IsEnabled = std::getenv("SYCL_ENABLE_LEVEL_ZERO_LINK");
+  static bool IsEnabled = [] {
+    const char *Env = std::getenv("SYCL_ENABLE_LEVEL_ZERO_LINK");
+    return !Env || std::string(Env) != "0";
+  }();
   return IsEnabled;
 }
 pi_result piKernelCreate(pi_program Program, const char *KernelName,
@@ -3131,6 +3652,36 @@ pi_result piextKernelSetArgSampler(pi_kernel Kernel, pi_uint32 ArgIndex,
   return PI_SUCCESS;
 }
 
+pi_result piextKernelSetArgs(pi_kernel Kernel, pi_uint32 NumArgs,
+                             const pi_kernel_arg *Args) {
+  PI_ASSERT(Kernel, PI_INVALID_KERNEL);
+  PI_ASSERT(NumArgs == 0 || Args, PI_INVALID_VALUE);
+
+  for (pi_uint32 I = 0; I < NumArgs; ++I) {
+    const pi_kernel_arg &Arg = Args[I];
+    pi_result Res = PI_SUCCESS;
+    switch (Arg.kind) {
+    case PI_KERNEL_ARG_VALUE:
+    case PI_KERNEL_ARG_POINTER:
+      Res = piKernelSetArg(Kernel, Arg.index, Arg.size, Arg.value);
+      break;
+    case PI_KERNEL_ARG_MEM_OBJ:
+      Res = piextKernelSetArgMemObj(Kernel, Arg.index,
+                                    static_cast<const pi_mem *>(Arg.value));
+      break;
+    case PI_KERNEL_ARG_SAMPLER:
+      Res = piextKernelSetArgSampler(
+          Kernel, Arg.index, static_cast<const pi_sampler *>(Arg.value));
+      break;
+    default:
+      Res = PI_INVALID_VALUE;
+    }
+    if (Res != PI_SUCCESS)
+      return Res;
+  }
+  return PI_SUCCESS;
+}
+
 pi_result piKernelGetInfo(pi_kernel Kernel, pi_kernel_info ParamName,
                           size_t ParamValueSize, void *ParamValue,
                           size_t *ParamValueSizeRet) {
@@ -3328,9 +3879,24 @@ piEnqueueKernelLaunch(pi_queue Queue, pi_kernel Kernel, pi_uint32 WorkDim,
     WG[1] = pi_cast<uint32_t>(LocalWorkSize[1]);
     WG[2] = pi_cast<uint32_t>(LocalWorkSize[2]);
   } else {
-    ZE_CALL(zeKernelSuggestGroupSize(Kernel->ZeKernel, GlobalWorkSize[0],
-                                     GlobalWorkSize[1], GlobalWorkSize[2],
-                                     &WG[0], &WG[1], &WG[2]));
+    // Ask Level Zero only once for each global size the kernel is launched
+    // with.
+    std::lock_guard<std::mutex> Lock(Kernel->GroupSizeMutex);
+    std::array<size_t, 3> GlobalSize{
+        {GlobalWorkSize[0], GlobalWorkSize[1], GlobalWorkSize[2]}};
+    auto It = Kernel->SuggestedGroupSizes.find(GlobalSize);
+    if (It == Kernel->SuggestedGroupSizes.end()) {
+      ZE_CALL(zeKernelSuggestGroupSize(Kernel->ZeKernel, GlobalWorkSize[0],
+                                       GlobalWorkSize[1], GlobalWorkSize[2],
+                                       &WG[0], &WG[1], &WG[2]));
+      if (Kernel->SuggestedGroupSizes.size() >=
+          _pi_kernel::MaxSuggestedGroupSizes)
+        Kernel->SuggestedGroupSizes.clear();
+      Kernel->SuggestedGroupSizes.emplace(
+          GlobalSize, std::array<uint32_t, 3>{{WG[0], WG[1], WG[2]}});
+    } else {
+      std::copy(It->second.begin(), It->second.end(), WG);
+    }
   }
 
   // TODO: assert if sizes do not fit into 32-bit?
@@ -3378,27 +3944,24 @@ piEnqueueKernelLaunch(pi_queue Queue, pi_kernel Kernel, pi_uint32 WorkDim,
     return PI_INVALID_WORK_GROUP_SIZE;
   }
 
-  ZE_CALL(zeKernelSetGroupSize(Kernel->ZeKernel, WG[0], WG[1], WG[2]));
-
-  // Lock automatically releases when this goes out of scope.
-  std::lock_guard<std::mutex> lock(Queue->PiQueueMutex);
+  // The group size is kept by the kernel, so only set it when it changes.
+  {
+    std::lock_guard<std::mutex> Lock(Kernel->GroupSizeMutex);
+    std::array<uint32_t, 3> GroupSize{{WG[0], WG[1], WG[2]}};
+    if (Kernel->GroupSize != GroupSize) {
+      ZE_CALL(zeKernelSetGroupSize(Kernel->ZeKernel, WG[0], WG[1], WG[2]));
+      Kernel->GroupSize = GroupSize;
+    }
+  }
 
-  // Get a new command list to be used on this call
-  ze_command_list_handle_t ZeCommandList = nullptr;
-  ze_fence_handle_t ZeFence = nullptr;
-  if (auto Res = Queue->Device->getAvailableCommandList(Queue, &ZeCommandList,
-                                                        &ZeFence, true))
-    return Res;
+  Queue = Queue->getKernelQueue();
 
-  ze_event_handle_t ZeEvent = nullptr;
-  auto Res = piEventCreate(Kernel->Program->Context, Event);
-  if (Res != PI_SUCCESS)
+  ze_event_handle_t *ZeEventWaitList = nullptr;
+  if (auto Res = createEventAndZeWaitList(Queue, PI_COMMAND_TYPE_NDRANGE_KERNEL,
+                                          Event, NumEventsInWaitList,
+                                          EventWaitList, ZeEventWaitList))
     return Res;
 
-  (*Event)->Queue = Queue;
-  (*Event)->CommandType = PI_COMMAND_TYPE_NDRANGE_KERNEL;
-  (*Event)->ZeCommandList = ZeCommandList;
-
   // Save the kernel in the event, so that when the event is signalled
   // the code can do a piKernelRelease on this kernel.
   (*Event)->CommandData = (void *)Kernel;
@@ -3410,17 +3973,25 @@ piEnqueueKernelLaunch(pi_queue Queue, pi_kernel Kernel, pi_uint32 WorkDim,
   // in CommandData.
   piKernelRetain(Kernel);
 
-  ZeEvent = (*Event)->ZeEvent;
+  ze_event_handle_t ZeEvent = (*Event)->ZeEvent;
 
-  ze_event_handle_t *ZeEventWaitList =
-      _pi_event::createZeEventList(NumEventsInWaitList, EventWaitList);
-  if (!ZeEventWaitList)
-    return PI_OUT_OF_HOST_MEMORY;
+  // Lock automatically releases when this goes out of scope.
+  std::lock_guard<std::mutex> lock(Queue->PiQueueMutex);
+
+  // Get a new command list to be used on this call
+  ze_command_list_handle_t ZeCommandList = nullptr;
+  ze_fence_handle_t ZeFence = nullptr;
+  if (auto Res = Queue->Device->getAvailableCommandList(Queue, &ZeCommandList,
+                                                        &ZeFence, true))
+    return Res;
+
+  (*Event)->ZeCommandList = ZeCommandList;
 
   // Add the command to the command list
   ZE_CALL(zeCommandListAppendLaunchKernel(
       ZeCommandList, Kernel->ZeKernel, &ZeThreadGroupDimensions, ZeEvent,
       NumEventsInWaitList, ZeEventWaitList));
+  Queue->retainWaitList(ZeCommandList, NumEventsInWaitList, ZeEventWaitList);
 
   zePrint("calling zeCommandListAppendLaunchKernel() with"
           "  ZeEvent %lx\n"
@@ -3445,19 +4016,23 @@ piEnqueueKernelLaunch(pi_queue Queue, pi_kernel Kernel, pi_uint32 WorkDim,
 // Events
 //
 pi_result piEventCreate(pi_context Context, pi_event *RetEvent) {
-  size_t Index = 0;
   ze_event_pool_handle_t ZeEventPool = {};
-  ZE_CALL(Context->getFreeSlotInExistingOrNewPool(ZeEventPool, Index));
   ze_event_handle_t ZeEvent;
-  ze_event_desc_t ZeEventDesc = {};
-  // We have to set the SIGNAL & WAIT flags as HOST scope because the
-  // Level-Zero plugin implementation waits for the events to complete
-  // on the host.
-  ZeEventDesc.signal = ZE_EVENT_SCOPE_FLAG_HOST;
-  ZeEventDesc.wait = ZE_EVENT_SCOPE_FLAG_HOST;
-  ZeEventDesc.index = Index;
-
-  ZE_CALL(zeEventCreate(ZeEventPool, &ZeEventDesc, &ZeEvent));
+  // All the events are created with the same description, so an event
+  // released earlier by this thread can be reused as is.
+  if (!Context->getCachedEvent(ZeEvent, ZeEventPool)) {
+    size_t Index = 0;
+    ZE_CALL(Context->getFreeSlotInExistingOrNewPool(ZeEventPool, Index));
+    ze_event_desc_t ZeEventDesc = {};
+    // We have to set the SIGNAL & WAIT flags as HOST scope because the
+    // Level-Zero plugin implementation waits for the events to complete
+    // on the host.
+    ZeEventDesc.signal = ZE_EVENT_SCOPE_FLAG_HOST;
+    ZeEventDesc.wait = ZE_EVENT_SCOPE_FLAG_HOST;
+    ZeEventDesc.index = Index;
+
+    ZE_CALL(zeEventCreate(ZeEventPool, &ZeEventDesc, &ZeEvent));
+  }
 
   try {
     PI_ASSERT(RetEvent, PI_INVALID_VALUE);
@@ -3587,13 +4162,14 @@ static void cleanupAfterEvent(pi_event Event) {
   // been cleaned up already.
   auto EventCommandList = Event->ZeCommandList;
 
-  if (EventCommandList) {
+  // Immediate command lists are not tracked by fences and are never reused.
+  if (EventCommandList && EventCommandList != Queue->ZeImmediateCommandList) {
     // Event has been signalled: If the fence for the associated command list
     // is signalled, then reset the fence and command list and add them to the
     // available list for reuse in PI calls.
     if (Queue->RefCount > 0) {
-      ze_result_t ZeResult = ZE_CALL_NOCHECK(
-          zeFenceQueryStatus(Queue->ZeCommandListFenceMap[EventCommandList]));
+      ze_result_t ZeResult = ZE_CALL_NOCHECK(zeFenceQueryStatus(
+          Queue->getCommandListFenceMap(EventCommandList)[EventCommandList]));
       if (ZeResult == ZE_RESULT_SUCCESS) {
         Queue->resetCommandListFenceEntry(EventCommandList, true);
         Event->ZeCommandList = nullptr;
@@ -3609,6 +4185,35 @@ static void cleanupAfterEvent(pi_event Event) {
   }
 }
 
+pi_result _pi_queue::waitForEvent(ze_event_handle_t ZeEvent) {
+  if (WaitSpinTime.count() > 0) {
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point Start = Clock::now();
+    bool Yielding = false;
+    while (true) {
+      ze_result_t ZeResult = ZE_CALL_NOCHECK(zeEventQueryStatus(ZeEvent));
+      if (ZeResult == ZE_RESULT_SUCCESS) {
+        ++(Yielding ? NumWaitsYielded : NumWaitsSpun);
+        return PI_SUCCESS;
+      }
+      if (ZeResult != ZE_RESULT_NOT_READY)
+        return mapError(ZeResult);
+      const Clock::duration Elapsed = Clock::now() - Start;
+      if (Elapsed >= 2 * WaitSpinTime)
+        break;
+      // Past the first half, the other threads of the core get to run
+      // between the polls.
+      if (Elapsed >= WaitSpinTime) {
+        Yielding = true;
+        std::this_thread::yield();
+      }
+    }
+  }
+  ZE_CALL(zeEventHostSynchronize(ZeEvent, UINT32_MAX));
+  ++NumWaitsBlocked;
+  return PI_SUCCESS;
+}
+
 pi_result piEventsWait(pi_uint32 NumEvents, const pi_event *EventList) {
 
   if (NumEvents && !EventList) {
@@ -3631,7 +4236,8 @@ pi_result piEventsWait(pi_uint32 NumEvents, const pi_event *EventList) {
   for (uint32_t I = 0; I < NumEvents; I++) {
     ze_event_handle_t ZeEvent = EventList[I]->ZeEvent;
     zePrint("ZeEvent = %lx\n", pi_cast<std::uintptr_t>(ZeEvent));
-    ZE_CALL(zeEventHostSynchronize(ZeEvent, UINT32_MAX));
+    if (auto Res = EventList[I]->Queue->waitForEvent(ZeEvent))
+      return Res;
 
     // NOTE: we are cleaning up after the event here to free resources
     // sooner in case run-time is not calling piEventRelease soon enough.
@@ -3671,10 +4277,16 @@ pi_result piEventRelease(pi_event Event) {
       ZE_CALL(zeMemFree(Event->Queue->Context->ZeContext, Event->CommandData));
       Event->CommandData = nullptr;
     }
-    ZE_CALL(zeEventDestroy(Event->ZeEvent));
-
     auto Context = Event->Context;
-    ZE_CALL(Context->decrementAliveEventsInPool(Event->ZeEventPool));
+    // A completed event can't be signalled by the device anymore and is kept
+    // for reuse. Others are destroyed, as the device may still signal them.
+    if (ZE_CALL_NOCHECK(zeEventQueryStatus(Event->ZeEvent)) ==
+        ZE_RESULT_SUCCESS) {
+      ZE_CALL(Context->cacheEvent(Event->ZeEvent, Event->ZeEventPool));
+    } else {
+      ZE_CALL(zeEventDestroy(Event->ZeEvent));
+      ZE_CALL(Context->decrementAliveEventsInPool(Event->ZeEventPool));
+    }
 
     delete Event;
   }
@@ -3853,6 +4465,17 @@ pi_result piEnqueueEventsWaitWithBarrier(pi_queue Queue,
                                          pi_event *Event) {
   PI_ASSERT(Queue, PI_INVALID_QUEUE);
 
+  // TODO: use unique_ptr with custom deleter in the whole Level Zero plugin for
+  // wrapping ze_event_handle_t *ZeEventWaitList to avoid memory leaks in case
+  // return will be called in ZE_CALL(ze***(...)), and thus
+  // _pi_event::deleteZeEventList(ZeEventWaitList) won't be called.
+  ze_event_handle_t *ZeEventWaitList = nullptr;
+  if (auto Res = createEventAndZeWaitList(Queue, PI_COMMAND_TYPE_USER, Event,
+                                          NumEventsInWaitList, EventWaitList,
+                                          ZeEventWaitList))
+    return Res;
+  ze_event_handle_t ZeEvent = Event ? (*Event)->ZeEvent : nullptr;
+
   // Lock automatically releases when this goes out of scope.
   std::lock_guard<std::mutex> lock(Queue->PiQueueMutex);
 
@@ -3863,28 +4486,12 @@ pi_result piEnqueueEventsWaitWithBarrier(pi_queue Queue,
                                                         &ZeFence))
     return Res;
 
-  ze_event_handle_t ZeEvent = nullptr;
-  if (Event) {
-    auto Res = piEventCreate(Queue->Context, Event);
-    if (Res != PI_SUCCESS)
-      return Res;
-
-    (*Event)->Queue = Queue;
-    (*Event)->CommandType = PI_COMMAND_TYPE_USER;
+  if (Event)
     (*Event)->ZeCommandList = ZeCommandList;
 
-    ZeEvent = (*Event)->ZeEvent;
-  }
-
-  // TODO: use unique_ptr with custom deleter in the whole Level Zero plugin for
-  // wrapping ze_event_handle_t *ZeEventWaitList to avoid memory leaks in case
-  // return will be called in ZE_CALL(ze***(...)), and thus
-  // _pi_event::deleteZeEventList(ZeEventWaitList) won't be called.
-  ze_event_handle_t *ZeEventWaitList =
-      _pi_event::createZeEventList(NumEventsInWaitList, EventWaitList);
-
   ZE_CALL(zeCommandListAppendBarrier(ZeCommandList, ZeEvent,
                                      NumEventsInWaitList, ZeEventWaitList));
+  Queue->retainWaitList(ZeCommandList, NumEventsInWaitList, ZeEventWaitList);
 
   _pi_event::deleteZeEventList(ZeEventWaitList);
 
@@ -3900,9 +4507,6 @@ pi_result piEnqueueMemBufferRead(pi_queue Queue, pi_mem Src,
   PI_ASSERT(Src, PI_INVALID_MEM_OBJECT);
   PI_ASSERT(Queue, PI_INVALID_QUEUE);
 
-  // Lock automatically releases when this goes out of scope.
-  std::lock_guard<std::mutex> lock(Queue->PiQueueMutex);
-
   return enqueueMemCopyHelper(PI_COMMAND_TYPE_MEM_BUFFER_READ, Queue, Dst,
                               BlockingRead, Size,
                               pi_cast<char *>(Src->getZeHandle()) + Offset,
@@ -3920,9 +4524,6 @@ pi_result piEnqueueMemBufferReadRect(
   PI_ASSERT(Buffer, PI_INVALID_MEM_OBJECT);
   PI_ASSERT(Queue, PI_INVALID_QUEUE);
 
-  // Lock automatically releases when this goes out of scope.
-  std::lock_guard<std::mutex> lock(Queue->PiQueueMutex);
-
   return enqueueMemCopyRectHelper(
       PI_COMMAND_TYPE_MEM_BUFFER_READ_RECT, Queue, Buffer->getZeHandle(),
       static_cast<char *>(Ptr), BufferOffset, HostOffset, Region,
@@ -3933,47 +4534,55 @@ pi_result piEnqueueMemBufferReadRect(
 } // extern "C"
 
 // Shared by all memory read/write/copy PI interfaces.
-// PI interfaces must already have queue's mutex locked on entry.
+// Locks the queue for the time the command is appended to a command list.
 static pi_result
 enqueueMemCopyHelper(pi_command_type CommandType, pi_queue Queue, void *Dst,
                      pi_bool BlockingWrite, size_t Size, const void *Src,
                      pi_uint32 NumEventsInWaitList,
                      const pi_event *EventWaitList, pi_event *Event) {
 
-  // Get a new command list to be used on this call
-  ze_command_list_handle_t ZeCommandList = nullptr;
-  ze_fence_handle_t ZeFence = nullptr;
-  if (auto Res = Queue->Device->getAvailableCommandList(Queue, &ZeCommandList,
-                                                        &ZeFence))
+  ze_event_handle_t *ZeEventWaitList = nullptr;
+  if (auto Res = createEventAndZeWaitList(Queue, CommandType, Event,
+                                          NumEventsInWaitList, EventWaitList,
+                                          ZeEventWaitList))
     return Res;
+  ze_event_handle_t ZeEvent = Event ? (*Event)->ZeEvent : nullptr;
 
-  ze_event_handle_t ZeEvent = nullptr;
-  if (Event) {
-    auto Res = piEventCreate(Queue->Context, Event);
-    if (Res != PI_SUCCESS)
-      return Res;
+  // A blocking command with an event is waited for once the queue is
+  // unlocked, so that the other threads can enqueue to it meanwhile.
+  const bool WaitUnlocked = BlockingWrite && ZeEvent;
 
-    (*Event)->Queue = Queue;
-    (*Event)->CommandType = CommandType;
-    (*Event)->ZeCommandList = ZeCommandList;
+  {
+    // Lock automatically releases when this goes out of scope.
+    std::lock_guard<std::mutex> lock(Queue->PiQueueMutex);
 
-    ZeEvent = (*Event)->ZeEvent;
-  }
+    // Memory transfers go to the copy engine if it is used by the queue.
+    bool UseCopyEngine = Queue->useCopyEngine();
 
-  ze_event_handle_t *ZeEventWaitList =
-      _pi_event::createZeEventList(NumEventsInWaitList, EventWaitList);
-  if (!ZeEventWaitList)
-    return PI_OUT_OF_HOST_MEMORY;
+    // Get a new command list to be used on this call
+    ze_command_list_handle_t ZeCommandList = nullptr;
+    ze_fence_handle_t ZeFence = nullptr;
+    if (auto Res = Queue->Device->getAvailableCommandList(
+            Queue, &ZeCommandList, &ZeFence, false, UseCopyEngine))
+      return Res;
 
-  ZE_CALL(zeCommandListAppendWaitOnEvents(ZeCommandList, NumEventsInWaitList,
-                                          ZeEventWaitList));
+    if (Event)
+      (*Event)->ZeCommandList = ZeCommandList;
 
-  ZE_CALL(zeCommandListAppendMemoryCopy(ZeCommandList, Dst, Src, Size, ZeEvent,
-                                        0, nullptr));
+    ZE_CALL(zeCommandListAppendWaitOnEvents(
+        ZeCommandList, NumEventsInWaitList, ZeEventWaitList));
+    Queue->retainWaitList(ZeCommandList, NumEventsInWaitList, ZeEventWaitList);
 
-  if (auto Res =
-          Queue->executeCommandList(ZeCommandList, ZeFence, BlockingWrite))
-    return Res;
+    ZE_CALL(zeCommandListAppendMemoryCopy(ZeCommandList, Dst, Src, Size,
+                                          ZeEvent, 0, nullptr));
+
+    if (auto Res = Queue->executeCommandList(ZeCommandList, ZeFence,
+                                             BlockingWrite && !WaitUnlocked))
+      return Res;
+  }
+
+  if (WaitUnlocked)
+    ZE_CALL(zeEventHostSynchronize(ZeEvent, UINT32_MAX));
 
   zePrint("calling zeCommandListAppendMemoryCopy() with\n"
           "  xe_event %lx\n"
@@ -3990,7 +4599,7 @@ enqueueMemCopyHelper(pi_command_type CommandType, pi_queue Queue, void *Dst,
 }
 
 // Shared by all memory read/write/copy rect PI interfaces.
-// PI interfaces must already have queue's mutex locked on entry.
+// Locks the queue for the time the command is appended to a command list.
 static pi_result enqueueMemCopyRectHelper(
     pi_command_type CommandType, pi_queue Queue, void *SrcBuffer,
     void *DstBuffer, pi_buff_rect_offset SrcOrigin,
@@ -4001,41 +4610,12 @@ static pi_result enqueueMemCopyRectHelper(
 
   PI_ASSERT(Region && SrcOrigin && DstOrigin, PI_INVALID_VALUE);
 
-  // Get a new command list to be used on this call
-  ze_command_list_handle_t ZeCommandList = nullptr;
-  ze_fence_handle_t ZeFence = nullptr;
-  if (auto Res = Queue->Device->getAvailableCommandList(Queue, &ZeCommandList,
-                                                        &ZeFence))
+  ze_event_handle_t *ZeEventWaitList = nullptr;
+  if (auto Res = createEventAndZeWaitList(Queue, CommandType, Event,
+                                          NumEventsInWaitList, EventWaitList,
+                                          ZeEventWaitList))
     return Res;
-
-  ze_event_handle_t ZeEvent = nullptr;
-  if (Event) {
-    auto Res = piEventCreate(Queue->Context, Event);
-    if (Res != PI_SUCCESS)
-      return Res;
-
-    (*Event)->Queue = Queue;
-    (*Event)->CommandType = CommandType;
-    (*Event)->ZeCommandList = ZeCommandList;
-
-    ZeEvent = (*Event)->ZeEvent;
-  }
-
-  ze_event_handle_t *ZeEventWaitList =
-      _pi_event::createZeEventList(NumEventsInWaitList, EventWaitList);
-  if (!ZeEventWaitList)
-    return PI_OUT_OF_HOST_MEMORY;
-
-  ZE_CALL(zeCommandListAppendWaitOnEvents(ZeCommandList, NumEventsInWaitList,
-                                          ZeEventWaitList));
-
-  zePrint("calling zeCommandListAppendWaitOnEvents() with\n"
-          "  NumEventsInWaitList %d:",
-          pi_cast<std::uintptr_t>(ZeEvent), NumEventsInWaitList);
-  for (pi_uint32 I = 0; I < NumEventsInWaitList; I++) {
-    zePrint(" %lx", pi_cast<std::uintptr_t>(ZeEventWaitList[I]));
-  }
-  zePrint("\n");
+  ze_event_handle_t ZeEvent = Event ? (*Event)->ZeEvent : nullptr;
 
   uint32_t SrcOriginX = pi_cast<uint32_t>(SrcOrigin->x_bytes);
   uint32_t SrcOriginY = pi_cast<uint32_t>(SrcOrigin->y_scalar);
@@ -4068,20 +4648,56 @@ static pi_result enqueueMemCopyRectHelper(
   const ze_copy_region_t ZeDstRegion = {DstOriginX, DstOriginY, DstOriginZ,
                                         Width,      Height,     Depth};
 
-  ZE_CALL(zeCommandListAppendMemoryCopyRegion(
-      ZeCommandList, DstBuffer, &ZeDstRegion, DstPitch, DstSlicePitch,
-      SrcBuffer, &ZeSrcRegion, SrcPitch, SrcSlicePitch, nullptr, 0, nullptr));
+  // A blocking command with an event is waited for once the queue is
+  // unlocked, so that the other threads can enqueue to it meanwhile.
+  const bool WaitUnlocked = Blocking && ZeEvent;
+  {
+    // Lock automatically releases when this goes out of scope.
+    std::lock_guard<std::mutex> lock(Queue->PiQueueMutex);
+
+    // Memory transfers go to the copy engine if it is used by the queue.
+    bool UseCopyEngine = Queue->useCopyEngine();
 
-  zePrint("calling zeCommandListAppendMemoryCopyRegion()\n");
+    // Get a new command list to be used on this call
+    ze_command_list_handle_t ZeCommandList = nullptr;
+    ze_fence_handle_t ZeFence = nullptr;
+    if (auto Res = Queue->Device->getAvailableCommandList(
+            Queue, &ZeCommandList, &ZeFence, false, UseCopyEngine))
+      return Res;
+
+    if (Event)
+      (*Event)->ZeCommandList = ZeCommandList;
+
+    ZE_CALL(zeCommandListAppendWaitOnEvents(
+        ZeCommandList, NumEventsInWaitList, ZeEventWaitList));
+    Queue->retainWaitList(ZeCommandList, NumEventsInWaitList, ZeEventWaitList);
+
+    ZE_CALL(zeCommandListAppendMemoryCopyRegion(
+        ZeCommandList, DstBuffer, &ZeDstRegion, DstPitch, DstSlicePitch,
+        SrcBuffer, &ZeSrcRegion, SrcPitch, SrcSlicePitch, nullptr, 0,
+        nullptr));
+
+    ZE_CALL(zeCommandListAppendBarrier(ZeCommandList, ZeEvent, 0, nullptr));
+
+    if (auto Res = Queue->executeCommandList(ZeCommandList, ZeFence,
+                                             Blocking && !WaitUnlocked))
+      return Res;
+  }
 
-  ZE_CALL(zeCommandListAppendBarrier(ZeCommandList, ZeEvent, 0, nullptr));
+  if (WaitUnlocked)
+    ZE_CALL(zeEventHostSynchronize(ZeEvent, UINT32_MAX));
 
+  zePrint("calling zeCommandListAppendWaitOnEvents() with\n"
+          "  NumEventsInWaitList %d:",
+          NumEventsInWaitList);
+  for (pi_uint32 I = 0; I < NumEventsInWaitList; I++) {
+    zePrint(" %lx", pi_cast<std::uintptr_t>(ZeEventWaitList[I]));
+  }
+  zePrint("\n");
+  zePrint("calling zeCommandListAppendMemoryCopyRegion()\n");
   zePrint("calling zeCommandListAppendBarrier() with Event %lx\n",
           pi_cast<std::uintptr_t>(ZeEvent));
 
-  if (auto Res = Queue->executeCommandList(ZeCommandList, ZeFence, Blocking))
-    return Res;
-
   _pi_event::deleteZeEventList(ZeEventWaitList);
 
   return PI_SUCCESS;
@@ -4099,9 +4715,6 @@ pi_result piEnqueueMemBufferWrite(pi_queue Queue, pi_mem Buffer,
   PI_ASSERT(Buffer, PI_INVALID_MEM_OBJECT);
   PI_ASSERT(Queue, PI_INVALID_QUEUE);
 
-  // Lock automatically releases when this goes out of scope.
-  std::lock_guard<std::mutex> lock(Queue->PiQueueMutex);
-
   return enqueueMemCopyHelper(PI_COMMAND_TYPE_MEM_BUFFER_WRITE, Queue,
                               pi_cast<char *>(Buffer->getZeHandle()) +
                                   Offset, // dst
@@ -4121,9 +4734,6 @@ pi_result piEnqueueMemBufferWriteRect(
   PI_ASSERT(Buffer, PI_INVALID_MEM_OBJECT);
   PI_ASSERT(Queue, PI_INVALID_QUEUE);
 
-  // Lock automatically releases when this goes out of scope.
-  std::lock_guard<std::mutex> lock(Queue->PiQueueMutex);
-
   return enqueueMemCopyRectHelper(
       PI_COMMAND_TYPE_MEM_BUFFER_WRITE_RECT, Queue,
       const_cast<char *>(static_cast<const char *>(Ptr)), Buffer->getZeHandle(),
@@ -4141,9 +4751,6 @@ pi_result piEnqueueMemBufferCopy(pi_queue Queue, pi_mem SrcBuffer,
   PI_ASSERT(SrcBuffer && DstBuffer, PI_INVALID_MEM_OBJECT);
   PI_ASSERT(Queue, PI_INVALID_QUEUE);
 
-  // Lock automatically releases when this goes out of scope.
-  std::lock_guard<std::mutex> lock(Queue->PiQueueMutex);
-
   return enqueueMemCopyHelper(
       PI_COMMAND_TYPE_MEM_BUFFER_COPY, Queue,
       pi_cast<char *>(DstBuffer->getZeHandle()) + DstOffset,
@@ -4161,9 +4768,6 @@ pi_result piEnqueueMemBufferCopyRect(
   PI_ASSERT(SrcBuffer && DstBuffer, PI_INVALID_MEM_OBJECT);
   PI_ASSERT(Queue, PI_INVALID_QUEUE);
 
-  // Lock automatically releases when this goes out of scope.
-  std::lock_guard<std::mutex> lock(Queue->PiQueueMutex);
-
   return enqueueMemCopyRectHelper(
       PI_COMMAND_TYPE_MEM_BUFFER_COPY_RECT, Queue, SrcBuffer->getZeHandle(),
       DstBuffer->getZeHandle(), SrcOrigin, DstOrigin, Region, SrcRowPitch,
@@ -4172,51 +4776,81 @@ pi_result piEnqueueMemBufferCopyRect(
       NumEventsInWaitList, EventWaitList, Event);
 }
 
+pi_result piextEnqueueMemBufferCopyPeer(
+    pi_queue SrcQueue, pi_mem SrcBuffer, size_t SrcOffset, pi_queue DstQueue,
+    pi_mem DstBuffer, size_t DstOffset, size_t Size,
+    pi_uint32 NumEventsInWaitList, const pi_event *EventWaitList,
+    pi_event *Event) {
+  PI_ASSERT(SrcBuffer && DstBuffer, PI_INVALID_MEM_OBJECT);
+  PI_ASSERT(SrcQueue && DstQueue, PI_INVALID_QUEUE);
+  // Level Zero memory is only accessible in the context it is allocated in.
+  return PI_INVALID_OPERATION;
+}
+
 } // extern "C"
 
 //
-// Caller of this must assure that the Queue is non-null and already had
-// the lock acquired.
+// Caller of this must assure that the Queue is non-null. The queue is
+// locked for the time the command is appended to a command list.
+// The fills of NumRows > 1 rows fill Size bytes every RowPitch bytes.
 static pi_result
 enqueueMemFillHelper(pi_command_type CommandType, pi_queue Queue, void *Ptr,
                      const void *Pattern, size_t PatternSize, size_t Size,
                      pi_uint32 NumEventsInWaitList,
-                     const pi_event *EventWaitList, pi_event *Event) {
+                     const pi_event *EventWaitList, pi_event *Event,
+                     size_t NumRows = 1, size_t RowPitch = 0) {
 
-  // Get a new command list to be used on this call
-  ze_command_list_handle_t ZeCommandList = nullptr;
-  ze_fence_handle_t ZeFence = nullptr;
-  if (auto Res = Queue->Device->getAvailableCommandList(Queue, &ZeCommandList,
-                                                        &ZeFence))
+  // Pattern size must be a power of two
+  PI_ASSERT((PatternSize > 0) && ((PatternSize & (PatternSize - 1)) == 0),
+            PI_INVALID_VALUE);
+
+  ze_event_handle_t *ZeEventWaitList = nullptr;
+  if (auto Res = createEventAndZeWaitList(Queue, CommandType, Event,
+                                          NumEventsInWaitList, EventWaitList,
+                                          ZeEventWaitList))
     return Res;
+  ze_event_handle_t ZeEvent = Event ? (*Event)->ZeEvent : nullptr;
 
-  ze_event_handle_t ZeEvent = nullptr;
-  if (Event) {
-    auto Res = piEventCreate(Queue->Context, Event);
-    if (Res != PI_SUCCESS)
-      return Res;
+  {
+    // Lock automatically releases when this goes out of scope.
+    std::lock_guard<std::mutex> lock(Queue->PiQueueMutex);
 
-    (*Event)->Queue = Queue;
-    (*Event)->CommandType = CommandType;
-    (*Event)->ZeCommandList = ZeCommandList;
+    // Memory transfers go to the copy engine if it is used by the queue.
+    bool UseCopyEngine = Queue->useCopyEngine(PatternSize);
 
-    ZeEvent = (*Event)->ZeEvent;
-  }
+    // Get a new command list to be used on this call
+    ze_command_list_handle_t ZeCommandList = nullptr;
+    ze_fence_handle_t ZeFence = nullptr;
+    if (auto Res = Queue->Device->getAvailableCommandList(
+            Queue, &ZeCommandList, &ZeFence, false, UseCopyEngine))
+      return Res;
 
-  ze_event_handle_t *ZeEventWaitList =
-      _pi_event::createZeEventList(NumEventsInWaitList, EventWaitList);
-  if (!ZeEventWaitList)
-    return PI_OUT_OF_HOST_MEMORY;
+    if (Event)
+      (*Event)->ZeCommandList = ZeCommandList;
 
-  ZE_CALL(zeCommandListAppendWaitOnEvents(ZeCommandList, NumEventsInWaitList,
-                                          ZeEventWaitList));
+    ZE_CALL(zeCommandListAppendWaitOnEvents(
+        ZeCommandList, NumEventsInWaitList, ZeEventWaitList));
+    Queue->retainWaitList(ZeCommandList, NumEventsInWaitList, ZeEventWaitList);
 
-  // Pattern size must be a power of two
-  PI_ASSERT((PatternSize > 0) && ((PatternSize & (PatternSize - 1)) == 0),
-            PI_INVALID_VALUE);
+    if (NumRows == 1) {
+      ZE_CALL(zeCommandListAppendMemoryFill(ZeCommandList, Ptr, Pattern,
+                                            PatternSize, Size, ZeEvent, 0,
+                                            nullptr));
+    } else {
+      // The rows are filled by the commands of the same command list, the
+      // event is signalled once all of them are done.
+      for (size_t Row = 0; Row < NumRows; ++Row)
+        ZE_CALL(zeCommandListAppendMemoryFill(
+            ZeCommandList, pi_cast<char *>(Ptr) + Row * RowPitch, Pattern,
+            PatternSize, Size, nullptr, 0, nullptr));
+      ZE_CALL(zeCommandListAppendBarrier(ZeCommandList, ZeEvent, 0, nullptr));
+    }
 
-  ZE_CALL(zeCommandListAppendMemoryFill(
-      ZeCommandList, Ptr, Pattern, PatternSize, Size, ZeEvent, 0, nullptr));
+    // Execute command list asynchronously, as the event will be used
+    // to track down its completion.
+    if (auto Res = Queue->executeCommandList(ZeCommandList, ZeFence))
+      return Res;
+  }
 
   zePrint("calling zeCommandListAppendMemoryFill() with\n"
           "  xe_event %lx\n"
@@ -4227,11 +4861,6 @@ enqueueMemFillHelper(pi_command_type CommandType, pi_queue Queue, void *Ptr,
   }
   zePrint("\n");
 
-  // Execute command list asynchronously, as the event will be used
-  // to track down its completion.
-  if (auto Res = Queue->executeCommandList(ZeCommandList, ZeFence))
-    return Res;
-
   _pi_event::deleteZeEventList(ZeEventWaitList);
 
   return PI_SUCCESS;
@@ -4249,9 +4878,6 @@ pi_result piEnqueueMemBufferFill(pi_queue Queue, pi_mem Buffer,
   PI_ASSERT(Buffer, PI_INVALID_MEM_OBJECT);
   PI_ASSERT(Queue, PI_INVALID_QUEUE);
 
-  // Lock automatically releases when this goes out of scope.
-  std::lock_guard<std::mutex> lock(Queue->PiQueueMutex);
-
   return enqueueMemFillHelper(PI_COMMAND_TYPE_MEM_BUFFER_FILL, Queue,
                               pi_cast<char *>(Buffer->getZeHandle()) + Offset,
                               Pattern, PatternSize, Size, NumEventsInWaitList,
@@ -4346,6 +4972,7 @@ pi_result piEnqueueMemBufferMap(pi_queue Queue, pi_mem Buffer,
 
   ZE_CALL(zeCommandListAppendWaitOnEvents(ZeCommandList, NumEventsInWaitList,
                                           ZeEventWaitList));
+  Queue->retainWaitList(ZeCommandList, NumEventsInWaitList, ZeEventWaitList);
 
   ZE_CALL(zeCommandListAppendMemoryCopy(
       ZeCommandList, *RetMap, pi_cast<char *>(Buffer->getZeHandle()) + Offset,
@@ -4431,6 +5058,7 @@ pi_result piEnqueueMemUnmap(pi_queue Queue, pi_mem MemObj, void *MappedPtr,
 
   ZE_CALL(zeCommandListAppendWaitOnEvents(ZeCommandList, NumEventsInWaitList,
                                           ZeEventWaitList));
+  Queue->retainWaitList(ZeCommandList, NumEventsInWaitList, ZeEventWaitList);
 
   // TODO: Level Zero is missing the memory "mapping" capabilities, so we are
   // left to doing copy (write back to the device).
@@ -4539,6 +5167,7 @@ enqueueMemImageCommandHelper(pi_command_type CommandType, pi_queue Queue,
 
   ZE_CALL(zeCommandListAppendWaitOnEvents(ZeCommandList, NumEventsInWaitList,
                                           ZeEventWaitList));
+  Queue->retainWaitList(ZeCommandList, NumEventsInWaitList, ZeEventWaitList);
 
   if (CommandType == PI_COMMAND_TYPE_IMAGE_READ) {
     pi_mem SrcMem = pi_cast<pi_mem>(const_cast<void *>(Src));
@@ -4741,14 +5370,19 @@ pi_result piMemBufferPartition(pi_mem Buffer, pi_mem_flags Flags,
   PI_ASSERT(Region->origin <= (Region->origin + Region->size),
             PI_INVALID_VALUE);
 
+  // A sub-buffer of a buffer allocated in host memory is in host memory too,
+  // so it is mapped without copies like its parent.  It is mapped to the same
+  // region of the host pointer of the parent buffer if there is one.
+  char *HostPtr =
+      Buffer->MapHostPtr ? Buffer->MapHostPtr + Region->origin : nullptr;
   try {
     *RetMem =
         new _pi_buffer(Buffer->Context,
                        pi_cast<char *>(Buffer->getZeHandle()) +
                            Region->origin /* Level Zero memory handle */,
-                       nullptr /* Host pointer */, Buffer /* Parent buffer */,
+                       HostPtr /* Host pointer */, Buffer /* Parent buffer */,
                        Region->origin /* Sub-buffer origin */,
-                       Region->size /*Sub-buffer size*/);
+                       Region->size /*Sub-buffer size*/, Buffer->OnHost);
   } catch (const std::bad_alloc &) {
     return PI_OUT_OF_HOST_MEMORY;
   } catch (...) {
@@ -4800,9 +5434,9 @@ pi_result piextGetDeviceFunctionPointer(pi_device Device, pi_program Program,
   return mapError(ZeResult);
 }
 
-pi_result piextUSMHostAlloc(void **ResultPtr, pi_context Context,
-                            pi_usm_mem_properties *Properties, size_t Size,
-                            pi_uint32 Alignment) {
+pi_result USMHostAllocImpl(void **ResultPtr, pi_context Context,
+                           pi_usm_mem_properties *Properties, size_t Size,
+                           pi_uint32 Alignment) {
   PI_ASSERT(Context, PI_INVALID_CONTEXT);
 
   // Check that incorrect bits are not set in the properties.
@@ -4829,6 +5463,133 @@ static bool ShouldUseUSMAllocator() {
 
 static const bool UseUSMAllocator = ShouldUseUSMAllocator();
 
+// Parses a size in bytes with an optional K, M or G suffix.
+static bool parseUSMAllocatorSize(const std::string &Str, size_t &Size) {
+  const char *Begin = Str.c_str();
+  char *End = nullptr;
+  unsigned long long Val = std::strtoull(Begin, &End, 10);
+  if (End == Begin)
+    return false;
+  switch (*End) {
+  case 'g':
+  case 'G':
+    Val <<= 10;
+    // fallthrough
+  case 'm':
+  case 'M':
+    Val <<= 10;
+    // fallthrough
+  case 'k':
+  case 'K':
+    Val <<= 10;
+    ++End;
+    break;
+  default:
+    break;
+  }
+  if (*End != '\0')
+    return false;
+  Size = Val;
+  return true;
+}
+
+// The USM pools are configured by
+// SYCL_PI_LEVEL_ZERO_USM_ALLOCATOR=<Item>[;<Item>]... where each item is
+// either
+//   <MaxPoolSize>
+// which sets the limit of the empty slabs kept by each pool, or
+//   <MemType>:<MaxPoolableSize>[,<Capacity>[,<SlabMinSize>]]
+// which configures the pools of one memory type: host, device or shared.
+// Sizes are in bytes and accept K, M and G suffixes. By default allocations
+// up to 2M are pooled and each bucket keeps up to 4 empty slabs, within 16M
+// per pool. SYCL_PI_LEVEL_ZERO_USM_ALLOCATOR_TRACE=1 prints the statistics of
+// the pools when they are destroyed.
+// SYCL_PI_LEVEL_ZERO_USM_ALLOCATOR_THREAD_CACHE=<N> sets the number of free
+// chunks of each small bucket kept by every thread, 16 by default; 0 disables
+// the thread caches.
+const USMAllocatorParameters &
+getUSMAllocatorParameters(ze_memory_type_t MemType) {
+  enum { Host, Device, Shared, NumMemTypes };
+  static const std::array<USMAllocatorParameters, NumMemTypes> Params = [] {
+    std::array<USMAllocatorParameters, NumMemTypes> Params;
+    const char *Names[NumMemTypes] = {"host", "device", "shared"};
+    const char *TraceStr =
+        std::getenv("SYCL_PI_LEVEL_ZERO_USM_ALLOCATOR_TRACE");
+    const char *ThreadCacheStr =
+        std::getenv("SYCL_PI_LEVEL_ZERO_USM_ALLOCATOR_THREAD_CACHE");
+    pi_int32 ThreadCacheSize = ThreadCacheStr ? std::atoi(ThreadCacheStr) : 16;
+    for (int I = 0; I < NumMemTypes; ++I) {
+      Params[I].Name = Names[I];
+      Params[I].MaxPoolableSize = 2 * 1024 * 1024;
+      Params[I].Capacity = 4;
+      Params[I].MaxPoolSize = 16 * 1024 * 1024;
+      // Negative numbers will be silently ignored.
+      Params[I].ThreadCacheSize = ThreadCacheSize > 0 ? ThreadCacheSize : 0;
+      Params[I].PrintStats = TraceStr && std::atoi(TraceStr) != 0;
+    }
+
+    const char *ConfigStr = std::getenv("SYCL_PI_LEVEL_ZERO_USM_ALLOCATOR");
+    if (!ConfigStr)
+      return Params;
+
+    std::stringstream Config(ConfigStr);
+    std::string Item;
+    while (std::getline(Config, Item, ';')) {
+      size_t Colon = Item.find(':');
+      if (Colon == std::string::npos) {
+        size_t MaxPoolSize;
+        if (!parseUSMAllocatorSize(Item, MaxPoolSize)) {
+          zePrint("Invalid SYCL_PI_LEVEL_ZERO_USM_ALLOCATOR item: %s\n",
+                  Item.c_str());
+          continue;
+        }
+        for (auto &P : Params)
+          P.MaxPoolSize = MaxPoolSize;
+        continue;
+      }
+
+      std::string Name = Item.substr(0, Colon);
+      auto It = std::find_if(Names, Names + NumMemTypes,
+                             [&](const char *N) { return Name == N; });
+      if (It == Names + NumMemTypes) {
+        zePrint("Invalid SYCL_PI_LEVEL_ZERO_USM_ALLOCATOR item: %s\n",
+                Item.c_str());
+        continue;
+      }
+
+      // Parse the values into a copy so that an invalid item is ignored as
+      // a whole.
+      USMAllocatorParameters P = Params[It - Names];
+      std::stringstream Values(Item.substr(Colon + 1));
+      std::string Value;
+      size_t *Fields[] = {&P.MaxPoolableSize, &P.Capacity, &P.SlabMinSize};
+      bool Valid = true;
+      for (size_t *Field : Fields) {
+        if (!std::getline(Values, Value, ','))
+          break;
+        Valid = Valid && parseUSMAllocatorSize(Value, *Field);
+      }
+      if (!Valid || (P.SlabMinSize & (P.SlabMinSize - 1)) != 0 ||
+          P.SlabMinSize == 0) {
+        zePrint("Invalid SYCL_PI_LEVEL_ZERO_USM_ALLOCATOR item: %s\n",
+                Item.c_str());
+        continue;
+      }
+      Params[It - Names] = P;
+    }
+    return Params;
+  }();
+
+  switch (MemType) {
+  case ZE_MEMORY_TYPE_DEVICE:
+    return Params[Device];
+  case ZE_MEMORY_TYPE_SHARED:
+    return Params[Shared];
+  default:
+    return Params[Host];
+  }
+}
+
 pi_result USMDeviceAllocImpl(void **ResultPtr, pi_context Context,
                              pi_device Device,
                              pi_usm_mem_properties *Properties, size_t Size,
@@ -4881,6 +5642,55 @@ pi_result USMSharedAllocImpl(void **ResultPtr, pi_context Context,
   return PI_SUCCESS;
 }
 
+// Allocates shared memory which is not associated with a single device: the
+// stripes of StripeSize bytes are placed on the devices of the context in
+// turn, so kernels running on different devices use the bandwidth of their
+// local memory.
+static pi_result USMSharedAllocDistributedImpl(void **ResultPtr,
+                                               pi_context Context, size_t Size,
+                                               pi_uint32 Alignment,
+                                               size_t StripeSize) {
+  PI_ASSERT(Context, PI_INVALID_CONTEXT);
+  PI_ASSERT(StripeSize > 0, PI_INVALID_VALUE);
+
+  ze_host_mem_alloc_desc_t ZeHostDesc = {};
+  ze_device_mem_alloc_desc_t ZeDevDesc = {};
+  ZE_CALL(zeMemAllocShared(Context->ZeContext, &ZeDevDesc, &ZeHostDesc, Size,
+                           Alignment, nullptr, ResultPtr));
+
+  const size_t NumDevices = Context->Devices.size();
+  char *Ptr = static_cast<char *>(*ResultPtr);
+  auto PlaceStripes = [&](pi_device Device, size_t First) {
+    // Synchronous, so that the placement is set when the allocation returns
+    ze_command_queue_desc_t ZeCommandQueueDesc = {};
+    ZeCommandQueueDesc.ordinal = Device->ZeComputeQueueGroupIndex;
+    ZeCommandQueueDesc.index = 0;
+    ZeCommandQueueDesc.mode = ZE_COMMAND_QUEUE_MODE_SYNCHRONOUS;
+    ze_command_list_handle_t ZeCommandList = nullptr;
+    ZE_CALL(zeCommandListCreateImmediate(Context->ZeContext, Device->ZeDevice,
+                                         &ZeCommandQueueDesc, &ZeCommandList));
+    ze_result_t ZeResult = ZE_RESULT_SUCCESS;
+    for (size_t Offset = First * StripeSize;
+         Offset < Size && ZeResult == ZE_RESULT_SUCCESS;
+         Offset += NumDevices * StripeSize)
+      ZeResult = ZE_CALL_NOCHECK(zeCommandListAppendMemAdvise(
+          ZeCommandList, Device->ZeDevice, Ptr + Offset,
+          std::min(StripeSize, Size - Offset),
+          ZE_MEMORY_ADVICE_SET_PREFERRED_LOCATION));
+    ZE_CALL(zeCommandListDestroy(ZeCommandList));
+    return mapError(ZeResult);
+  };
+
+  for (size_t I = 0; I < NumDevices && I * StripeSize < Size; ++I) {
+    if (pi_result Result = PlaceStripes(Context->Devices[I], I)) {
+      zeMemFree(Context->ZeContext, *ResultPtr);
+      *ResultPtr = nullptr;
+      return Result;
+    }
+  }
+  return PI_SUCCESS;
+}
+
 pi_result USMFreeImpl(pi_context Context, void *Ptr) {
   ZE_CALL(zeMemFree(Context->ZeContext, Ptr));
   return PI_SUCCESS;
@@ -4907,6 +5717,11 @@ pi_result USMDeviceMemoryAlloc::allocateImpl(void **ResultPtr, size_t Size,
                             Alignment);
 }
 
+pi_result USMHostMemoryAlloc::allocateImpl(void **ResultPtr, size_t Size,
+                                           pi_uint32 Alignment) {
+  return USMHostAllocImpl(ResultPtr, Context, nullptr, Size, Alignment);
+}
+
 void *USMMemoryAllocBase::allocate(size_t Size) {
   void *Ptr = nullptr;
 
@@ -4966,6 +5781,11 @@ pi_result piextUSMSharedAlloc(void **ResultPtr, pi_context Context,
                               pi_device Device,
                               pi_usm_mem_properties *Properties, size_t Size,
                               pi_uint32 Alignment) {
+  // The distributed allocations are not pooled, they are usually large.
+  if (Properties && *Properties == PI_EXT_ONEAPI_MEM_ALLOC_STRIPE_SIZE)
+    return USMSharedAllocDistributedImpl(ResultPtr, Context, Size, Alignment,
+                                         static_cast<size_t>(Properties[1]));
+
   if (!UseUSMAllocator ||
       // L0 spec says that allocation fails if Alignment != 2^n, in order to
       // keep the same behavior for the allocator, just call L0 API directly and
@@ -4989,6 +5809,29 @@ pi_result piextUSMSharedAlloc(void **ResultPtr, pi_context Context,
   return PI_SUCCESS;
 }
 
+pi_result piextUSMHostAlloc(void **ResultPtr, pi_context Context,
+                            pi_usm_mem_properties *Properties, size_t Size,
+                            pi_uint32 Alignment) {
+  if (!UseUSMAllocator ||
+      // L0 spec says that allocation fails if Alignment != 2^n, in order to
+      // keep the same behavior for the allocator, just call L0 API directly and
+      // return the error code.
+      ((Alignment & (Alignment - 1)) != 0)) {
+    return USMHostAllocImpl(ResultPtr, Context, Properties, Size, Alignment);
+  }
+
+  PI_ASSERT(Context, PI_INVALID_CONTEXT);
+
+  try {
+    *ResultPtr = Context->HostMemAllocContext.allocate(Size, Alignment);
+  } catch (const UsmAllocationException &Ex) {
+    *ResultPtr = nullptr;
+    return Ex.getError();
+  }
+
+  return PI_SUCCESS;
+}
+
 pi_result piextUSMFree(pi_context Context, void *Ptr) {
   if (!UseUSMAllocator) {
     return USMFreeImpl(Context, Ptr);
@@ -5036,11 +5879,66 @@ pi_result piextUSMFree(pi_context Context, void *Ptr) {
       // Handled below
       break;
     }
+  } else if (ZeMemoryAllocationProperties.type == ZE_MEMORY_TYPE_HOST) {
+    try {
+      Context->HostMemAllocContext.deallocate(Ptr);
+    } catch (const UsmAllocationException &Ex) {
+      return Ex.getError();
+    }
+    return PI_SUCCESS;
   }
 
   return USMFreeImpl(Context, Ptr);
 }
 
+// Host memory is imported through extension functions of the driver, which
+// make it accessible to the devices of the driver as USM host memory.
+using zexDriverImportExternalPointerFn = ze_result_t (*)(ze_driver_handle_t,
+                                                         void *, size_t);
+using zexDriverReleaseImportedPointerFn = ze_result_t (*)(ze_driver_handle_t,
+                                                          void *);
+
+template <typename FnT>
+static FnT getDriverExtensionFunction(ze_driver_handle_t ZeDriver,
+                                      const char *Name) {
+  void *Fn = nullptr;
+  if (ZE_CALL_NOCHECK(
+          zeDriverGetExtensionFunctionAddress(ZeDriver, Name, &Fn)) !=
+      ZE_RESULT_SUCCESS)
+    return nullptr;
+  return reinterpret_cast<FnT>(Fn);
+}
+
+pi_result piextUSMImport(const void *HostPtr, size_t Size,
+                         pi_context Context) {
+  PI_ASSERT(Context, PI_INVALID_CONTEXT);
+  PI_ASSERT(HostPtr, PI_INVALID_VALUE);
+
+  // All devices in the context are of the same platform.
+  ze_driver_handle_t ZeDriver = Context->Devices[0]->Platform->ZeDriver;
+  auto Import =
+      getDriverExtensionFunction<zexDriverImportExternalPointerFn>(
+          ZeDriver, "zexDriverImportExternalPointer");
+  if (!Import)
+    return PI_INVALID_OPERATION;
+  ZE_CALL(Import(ZeDriver, const_cast<void *>(HostPtr), Size));
+  return PI_SUCCESS;
+}
+
+pi_result piextUSMRelease(const void *HostPtr, pi_context Context) {
+  PI_ASSERT(Context, PI_INVALID_CONTEXT);
+  PI_ASSERT(HostPtr, PI_INVALID_VALUE);
+
+  ze_driver_handle_t ZeDriver = Context->Devices[0]->Platform->ZeDriver;
+  auto Release =
+      getDriverExtensionFunction<zexDriverReleaseImportedPointerFn>(
+          ZeDriver, "zexDriverReleaseImportedPointer");
+  if (!Release)
+    return PI_INVALID_OPERATION;
+  ZE_CALL(Release(ZeDriver, const_cast<void *>(HostPtr)));
+  return PI_SUCCESS;
+}
+
 pi_result piextKernelSetArgPointer(pi_kernel Kernel, pi_uint32 ArgIndex,
                                    size_t ArgSize, const void *ArgValue) {
 
@@ -5068,9 +5966,6 @@ pi_result piextUSMEnqueueMemset(pi_queue Queue, void *Ptr, pi_int32 Value,
 
   PI_ASSERT(Queue, PI_INVALID_QUEUE);
 
-  // Lock automatically releases when this goes out of scope.
-  std::lock_guard<std::mutex> lock(Queue->PiQueueMutex);
-
   return enqueueMemFillHelper(
       // TODO: do we need a new command type for USM memset?
       PI_COMMAND_TYPE_MEM_BUFFER_FILL, Queue, Ptr,
@@ -5091,15 +5986,47 @@ pi_result piextUSMEnqueueMemcpy(pi_queue Queue, pi_bool Blocking, void *DstPtr,
 
   PI_ASSERT(Queue, PI_INVALID_QUEUE);
 
-  // Lock automatically releases when this goes out of scope.
-  std::lock_guard<std::mutex> lock(Queue->PiQueueMutex);
-
   return enqueueMemCopyHelper(
       // TODO: do we need a new command type for this?
       PI_COMMAND_TYPE_MEM_BUFFER_COPY, Queue, DstPtr, Blocking, Size, SrcPtr,
       NumEventsInWaitlist, EventsWaitlist, Event);
 }
 
+pi_result piextUSMEnqueueMemcpyRect(
+    pi_queue Queue, pi_bool Blocking, void *DstPtr, size_t DstRowPitch,
+    size_t DstSlicePitch, const void *SrcPtr, size_t SrcRowPitch,
+    size_t SrcSlicePitch, pi_buff_rect_region Region,
+    pi_uint32 NumEventsInWaitlist, const pi_event *EventsWaitlist,
+    pi_event *Event) {
+  PI_ASSERT(DstPtr && SrcPtr, PI_INVALID_VALUE);
+  PI_ASSERT(Queue, PI_INVALID_QUEUE);
+
+  pi_buff_rect_offset_struct ZeroOrigin = {0, 0, 0};
+  return enqueueMemCopyRectHelper(
+      // TODO: do we need a new command type for this?
+      PI_COMMAND_TYPE_MEM_BUFFER_COPY_RECT, Queue, const_cast<void *>(SrcPtr),
+      DstPtr, &ZeroOrigin, &ZeroOrigin, Region, SrcRowPitch, DstRowPitch,
+      SrcSlicePitch, DstSlicePitch, Blocking, NumEventsInWaitlist,
+      EventsWaitlist, Event);
+}
+
+pi_result piextUSMEnqueueFillRect(pi_queue Queue, void *Ptr, size_t RowPitch,
+                                  const void *Pattern, size_t PatternSize,
+                                  size_t Width, size_t Height,
+                                  pi_uint32 NumEventsInWaitlist,
+                                  const pi_event *EventsWaitlist,
+                                  pi_event *Event) {
+  PI_ASSERT(Ptr && Pattern, PI_INVALID_VALUE);
+  PI_ASSERT(Queue, PI_INVALID_QUEUE);
+
+  // Rows laid out back to back are filled at once.
+  const bool Contiguous = RowPitch == Width || Height == 1;
+  return enqueueMemFillHelper(
+      PI_COMMAND_TYPE_MEM_BUFFER_FILL, Queue, Ptr, Pattern, PatternSize,
+      Contiguous ? Width * Height : Width, NumEventsInWaitlist, EventsWaitlist,
+      Event, Contiguous ? 1 : Height, RowPitch);
+}
+
 /// Hint to migrate memory to the device
 ///
 /// @param Queue is the queue to submit to
@@ -5146,6 +6073,7 @@ pi_result piextUSMEnqueuePrefetch(pi_queue Queue, const void *Ptr, size_t Size,
 
   ZE_CALL(zeCommandListAppendWaitOnEvents(ZeCommandList, NumEventsInWaitlist,
                                           ZeEventWaitList));
+  Queue->retainWaitList(ZeCommandList, NumEventsInWaitlist, ZeEventWaitList);
 
   // TODO: figure out how to translate "flags"
   ZE_CALL(zeCommandListAppendMemoryPrefetch(ZeCommandList, Ptr, Size));
@@ -5288,6 +6216,30 @@ pi_result piextUSMGetMemAllocInfo(pi_context Context, const void *Ptr,
   return PI_SUCCESS;
 }
 
+// Command graphs are not supported by the Level Zero plugin yet.
+pi_result piextQueueBeginGraphCapture(pi_queue Queue) {
+  PI_ASSERT(Queue, PI_INVALID_QUEUE);
+  return PI_INVALID_OPERATION;
+}
+
+pi_result piextQueueEndGraphCapture(pi_queue Queue,
+                                    pi_ext_command_graph *Graph) {
+  PI_ASSERT(Queue, PI_INVALID_QUEUE);
+  return PI_INVALID_OPERATION;
+}
+
+pi_result piextEnqueueCommandGraph(pi_queue Queue, pi_ext_command_graph Graph,
+                                   pi_uint32 NumEventsInWaitList,
+                                   const pi_event *EventWaitList,
+                                   pi_event *Event) {
+  PI_ASSERT(Queue, PI_INVALID_QUEUE);
+  return PI_INVALID_OPERATION;
+}
+
+pi_result piextCommandGraphRelease(pi_ext_command_graph Graph) {
+  return PI_INVALID_OPERATION;
+}
+
 pi_result piKernelSetExecInfo(pi_kernel Kernel, pi_kernel_exec_info ParamName,
                               size_t ParamValueSize, const void *ParamValue) {
   PI_ASSERT(Kernel, PI_INVALID_KERNEL);
@@ -5341,6 +6293,9 @@ pi_result piPluginInit(pi_plugin *PluginInit) {
 #define _PI_API(api)                                                           \
   (PluginInit->PiFunctionTable).api = (decltype(&::api))(&api);
 #include <CL/sycl/detail/pi.def>
+  // Let the runtime know upfront that buffers of different contexts can't be
+  // copied between directly.
+  PluginInit->PiFunctionTable.piextEnqueueMemBufferCopyPeer = nullptr;
 
   return PI_SUCCESS;
 }
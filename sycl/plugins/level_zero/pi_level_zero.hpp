@@ -19,8 +19,10 @@
 #define PI_LEVEL_ZERO_HPP
 
 #include <CL/sycl/detail/pi.h>
+#include <array>
 #include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstring>
 #include <iostream>
 #include <list>
@@ -112,6 +114,11 @@ public:
   void deallocate(void *Ptr) override final;
 };
 
+// Returns the parameters of the USM pools of the given memory type: the
+// defaults of the plugin updated with SYCL_PI_LEVEL_ZERO_USM_ALLOCATOR.
+const USMAllocatorParameters &
+getUSMAllocatorParameters(ze_memory_type_t MemType);
+
 // Allocation routines for shared memory type
 class USMSharedMemoryAlloc : public USMMemoryAllocBase {
 protected:
@@ -134,6 +141,16 @@ public:
       : USMMemoryAllocBase(Ctx, Dev) {}
 };
 
+// Allocation routines for host memory type
+class USMHostMemoryAlloc : public USMMemoryAllocBase {
+protected:
+  pi_result allocateImpl(void **ResultPtr, size_t Size,
+                         pi_uint32 Alignment) override;
+
+public:
+  USMHostMemoryAlloc(pi_context Ctx) : USMMemoryAllocBase(Ctx, nullptr) {}
+};
+
 struct _pi_device : _pi_object {
   _pi_device(ze_device_handle_t Device, pi_platform Plt,
              bool isSubDevice = false)
@@ -144,12 +161,22 @@ struct _pi_device : _pi_object {
   }
 
   // Keep the ordinal of a "compute" commands group, where we send all
-  // commands currently.
-  // TODO[1.0]: discover "copy" command group as well to use for memory
-  // copying operations exclusively.
-  //
+  // commands except for the ones offloaded to the copy engine.
   uint32_t ZeComputeQueueGroupIndex;
 
+  // Number of command queues, i.e. queue indices, in the "compute" group.
+  uint32_t ZeComputeQueueGroupNumQueues = 1;
+
+  // Keep the ordinal of a "copy" commands group, which is used for memory
+  // copying operations exclusively, or -1 if the device has none.
+  int32_t ZeCopyQueueGroupIndex = -1;
+
+  // Largest pattern size which the copy engine can fill memory with.
+  size_t ZeCopyMaxMemoryFillPatternSize = 0;
+
+  // Returns true if the device has an engine dedicated to memory copies.
+  bool hasCopyEngine() const { return ZeCopyQueueGroupIndex >= 0; }
+
   // Initialize the entire PI device.
   pi_result initialize();
 
@@ -163,6 +190,9 @@ struct _pi_device : _pi_object {
   std::mutex ZeCommandListCacheMutex;
   // Cache of all currently Available Command Lists for use by PI APIs
   std::list<ze_command_list_handle_t> ZeCommandListCache;
+  // Cache of the available command lists created for the copy engine. It is
+  // protected by ZeCommandListCacheMutex too.
+  std::list<ze_command_list_handle_t> ZeCopyCommandListCache;
 
   // Indicates if this is a root-device or a sub-device.
   // Technically this information can be queried from a device handle, but it
@@ -181,10 +211,14 @@ struct _pi_device : _pi_object {
   // If AllowBatching is true, then the command list returned may already have
   // command in it, if AllowBatching is false, any open command lists that
   // already exist in Queue will be closed and executed.
+  // If UseCopyEngine is true, then the command list returned is to be
+  // executed on the copy command queue of the Queue. Such command lists are
+  // never batched.
   pi_result getAvailableCommandList(pi_queue Queue,
                                     ze_command_list_handle_t *ZeCommandList,
                                     ze_fence_handle_t *ZeFence,
-                                    bool AllowBatching = false);
+                                    bool AllowBatching = false,
+                                    bool UseCopyEngine = false);
 
   // Cache of the immutable device properties.
   ze_device_properties_t ZeDeviceProperties;
@@ -195,19 +229,25 @@ struct _pi_context : _pi_object {
   _pi_context(ze_context_handle_t ZeContext, pi_uint32 NumDevices,
               const pi_device *Devs)
       : ZeContext{ZeContext}, Devices{Devs, Devs + NumDevices},
-        ZeCommandListInit{nullptr}, ZeEventPool{nullptr},
-        NumEventsAvailableInEventPool{}, NumEventsLiveInEventPool{} {
+        ZeCommandListInit{nullptr},
+        HostMemAllocContext{std::unique_ptr<SystemMemory>(
+                                new USMHostMemoryAlloc(this)),
+                            getUSMAllocatorParameters(ZE_MEMORY_TYPE_HOST)},
+        ZeEventPool{nullptr}, NumEventsAvailableInEventPool{},
+        NumEventsLiveInEventPool{} {
     // Create USM allocator context for each pair (device, context).
     for (uint32_t I = 0; I < NumDevices; I++) {
       pi_device Device = Devs[I];
       SharedMemAllocContexts.emplace(
           std::piecewise_construct, std::make_tuple(Device),
           std::make_tuple(std::unique_ptr<SystemMemory>(
-              new USMSharedMemoryAlloc(this, Device))));
+                              new USMSharedMemoryAlloc(this, Device)),
+                          getUSMAllocatorParameters(ZE_MEMORY_TYPE_SHARED)));
       DeviceMemAllocContexts.emplace(
           std::piecewise_construct, std::make_tuple(Device),
           std::make_tuple(std::unique_ptr<SystemMemory>(
-              new USMDeviceMemoryAlloc(this, Device))));
+                              new USMDeviceMemoryAlloc(this, Device)),
+                          getUSMAllocatorParameters(ZE_MEMORY_TYPE_DEVICE)));
       // NOTE: one must additionally call initialize() to complete
       // PI context creation.
     }
@@ -245,11 +285,39 @@ struct _pi_context : _pi_object {
   // and destroy the pool if there are no alive events.
   ze_result_t decrementAliveEventsInPool(ze_event_pool_handle_t pool);
 
+  // Takes an event released earlier by the calling thread out of the event
+  // cache. Returns false if there is no such event.
+  bool getCachedEvent(ze_event_handle_t &ZeEvent,
+                      ze_event_pool_handle_t &ZePool);
+
+  // Resets the completed event and puts it into the event cache of the calling
+  // thread instead of destroying it, so that its pool slot is reused by the
+  // next event created by the thread.
+  // An event still waited for by a command which may not have completed is
+  // only put into the event cache once releaseWaitedEvents drops the last wait.
+  ze_result_t cacheEvent(ze_event_handle_t ZeEvent,
+                         ze_event_pool_handle_t ZePool);
+
+  // Records that a command appended to a command list waits for the events.
+  // Resetting such an event would make the command wait for the next command
+  // signalling it, so the event is not reused until the wait is released.
+  void retainWaitedEvents(const ze_event_handle_t *ZeEvents,
+                          pi_uint32 NumEvents);
+
+  // Releases the waits recorded by retainWaitedEvents, once the commands
+  // waiting for the events have completed, and caches the released events
+  // no command waits for anymore.
+  ze_result_t
+  releaseWaitedEvents(const std::vector<ze_event_handle_t> &ZeEvents);
+
   // Store USM allocator context(internal allocator structures)
   // for USM shared/host and device allocations. There is 1 allocator context
   // per each pair of (context, device) per each memory type.
   std::unordered_map<pi_device, USMAllocContext> SharedMemAllocContexts;
   std::unordered_map<pi_device, USMAllocContext> DeviceMemAllocContexts;
+  // Host allocations are not associated with a device, so there is a single
+  // allocator context for them.
+  USMAllocContext HostMemAllocContext;
 
 private:
   // Following member variables are used to manage assignment of events
@@ -278,6 +346,28 @@ private:
 
   // Mutex to control operations on NumEventsLiveInEventPool.
   std::mutex NumEventsLiveInEventPoolMutex;
+
+  // Released events which are kept for reuse. Threads are spread across the
+  // shards by their id, so that threads creating and releasing events at the
+  // same time rarely take the same mutex. The cached events stay alive in
+  // NumEventsLiveInEventPool until the context is finalized.
+  struct EventCacheShard {
+    std::mutex Mutex;
+    std::vector<std::pair<ze_event_handle_t, ze_event_pool_handle_t>> Events;
+  };
+  static constexpr size_t NumEventCacheShards = 16;
+  std::array<EventCacheShard, NumEventCacheShards> EventCache;
+
+  // Returns the event cache shard of the calling thread.
+  EventCacheShard &getEventCacheShard();
+
+  // Number of the waits recorded by retainWaitedEvents for each event, and the
+  // pools of the events released while still waited for, which are cached
+  // once their last wait is released.
+  std::mutex WaitedEventsMutex;
+  std::unordered_map<ze_event_handle_t, pi_uint32> NumWaitsOnEvent;
+  std::unordered_map<ze_event_handle_t, ze_event_pool_handle_t>
+      ReleasedWaitedEvents;
 };
 
 // If doing dynamic batching, start batch size at 4.
@@ -285,14 +375,49 @@ const pi_uint32 DynamicBatchStartSize = 4;
 
 struct _pi_queue : _pi_object {
   _pi_queue(ze_command_queue_handle_t Queue, pi_context Context,
-            pi_device Device, pi_uint32 BatchSize)
-      : ZeCommandQueue{Queue}, Context{Context}, Device{Device},
+            pi_device Device, pi_uint32 BatchSize,
+            ze_command_queue_handle_t CopyQueue = nullptr)
+      : ZeCommandQueue{Queue}, ZeComputeCommandQueues(1, Queue),
+        ZeCopyCommandQueue{CopyQueue}, Context{Context}, Device{Device},
         QueueBatchSize{BatchSize > 0 ? BatchSize : DynamicBatchStartSize},
         UseDynamicBatching{BatchSize == 0} {}
 
   // Level Zero command queue handle.
   ze_command_queue_handle_t ZeCommandQueue;
 
+  // All the Level Zero command queues of the compute group used by this
+  // queue, one per queue index, ZeCommandQueue being the first one. There is
+  // more than one only for out-of-order PI queues with multiple compute
+  // queues enabled, and the command lists are spread across them in
+  // round-robin order.
+  std::vector<ze_command_queue_handle_t> ZeComputeCommandQueues;
+
+  // Position in ZeComputeCommandQueues of the queue which the next command
+  // list is bound to.
+  size_t NextComputeCommandQueue = {0};
+
+  // The queues on the sub-devices of the device which the kernels of the
+  // queue are spread across in round-robin order, see
+  // PI_EXT_ONEAPI_QUEUE_SUB_DEVICE_SCALING. Empty if the kernels run on the
+  // device itself.
+  std::vector<pi_queue> SubDeviceQueues;
+
+  // Position in SubDeviceQueues of the queue of the next kernel.
+  size_t NextSubDeviceQueue = {0};
+
+  // Creates the queues of SubDeviceQueues with the given properties. Does
+  // nothing if the device has less than two sub-devices.
+  pi_result createSubDeviceQueues(pi_queue_properties Properties);
+
+  // Returns the queue the next kernel is enqueued to.
+  pi_queue getKernelQueue();
+
+  // Level Zero command queue on the copy engine of the device, which memory
+  // copies and fills are offloaded to, or nullptr if there is no offload.
+  // Commands submitted to the two queues are only ordered by the events in
+  // their wait lists, so it is only created for out-of-order PI queues.
+  ze_command_queue_handle_t ZeCopyCommandQueue;
+
   // Keeps the PI context to which this queue belongs.
   // This field is only set at _pi_queue creation time, and cannot change.
   // Therefore it can be accessed without holding a lock on this _pi_queue.
@@ -308,13 +433,39 @@ struct _pi_queue : _pi_object {
   // this lock has been acquired, and this must be released upon exit
   // from a pi_queue API call.  No other mutexes/locking should be
   // needed/used for the queue data structures.
+  // The enqueue API calls hold it only while they append their command to a
+  // command list: the events and wait lists of the commands are created, and
+  // the blocking commands are waited for, without it.
   std::mutex PiQueueMutex;
 
+  // Level Zero immediate command list which all the commands of this queue
+  // are appended to if immediate command lists are enabled, or nullptr.
+  // Commands appended to it are submitted to the device right away, so it is
+  // never batched, closed or reset and no fence tracks it in
+  // ZeCommandListFenceMap.
+  ze_command_list_handle_t ZeImmediateCommandList = {nullptr};
+
+  // Event used by synchronizeImmediateCommandList and the pool it is
+  // allocated from. Created on first use.
+  ze_event_handle_t ZeImmediateSyncEvent = {nullptr};
+  ze_event_pool_handle_t ZeImmediateSyncEventPool = {nullptr};
+
+  // Waits until all the commands appended to ZeImmediateCommandList are
+  // completed.
+  pi_result synchronizeImmediateCommandList();
+
   // Open command list field for batching commands into this queue.
   ze_command_list_handle_t ZeOpenCommandList = {nullptr};
   ze_fence_handle_t ZeOpenCommandListFence = {nullptr};
   pi_uint32 ZeOpenCommandListSize = {0};
 
+  // Time when the first command was batched into ZeOpenCommandList.
+  std::chrono::steady_clock::time_point ZeOpenCommandListStartTime;
+
+  // Fence of the command list this queue executed last, used to find out if
+  // the device has gone idle while commands are being batched.
+  ze_fence_handle_t ZeLastExecutedFence = {nullptr};
+
   // Approximate number of commands that are allowed to be batched for
   // this queue.
   // Added this member to the queue rather than using a global variable
@@ -335,10 +486,103 @@ struct _pi_queue : _pi_object {
   pi_uint32 NumTimesClosedEarly = {0};
   pi_uint32 NumTimesClosedFull = {0};
 
+  // Statistics of the batches executed by this queue: the number of batches
+  // and of the commands in them, how many were closed by the latency policy,
+  // and the total and largest time the commands waited in an open batch.
+  pi_uint32 NumBatchesExecuted = {0};
+  pi_uint32 NumBatchedCommands = {0};
+  pi_uint32 NumTimesClosedByLatency = {0};
+  std::chrono::microseconds BatchLatencyTotal{0};
+  std::chrono::microseconds BatchLatencyMax{0};
+
+  // Returns true if the latency policy requires the open command list to be
+  // executed now: its first command has waited for longer than the
+  // configured deadline, or the device has no other work from this queue.
+  bool isBatchLatencyTargetReached();
+
+  // Updates the batch statistics when ZeOpenCommandList is executed.
+  void recordBatchExecution();
+
+  // Time for which the waits on the events of this queue poll them with
+  // zeEventQueryStatus before blocking in zeEventHostSynchronize, see
+  // PI_EXT_ONEAPI_QUEUE_SPIN_WAIT. A wait polls in a busy loop for that
+  // time, then yields the thread between the polls for as long again, and
+  // finally blocks. Zero if the waits block at once. Set at queue creation.
+  std::chrono::microseconds WaitSpinTime{0};
+
+  // Statistics of the waits on the events of this queue: how many saw the
+  // completion while polling in a busy loop, while yielding, or blocked.
+  // The waits don't hold PiQueueMutex, so they are atomic.
+  std::atomic<pi_uint32> NumWaitsSpun{0};
+  std::atomic<pi_uint32> NumWaitsYielded{0};
+  std::atomic<pi_uint32> NumWaitsBlocked{0};
+
+  // Waits for the completion of the given event of this queue, following the
+  // policy of WaitSpinTime.
+  pi_result waitForEvent(ze_event_handle_t ZeEvent);
+
   // Map of all Command lists created with their associated Fence used for
   // tracking when the command list is available for use again.
   std::map<ze_command_list_handle_t, ze_fence_handle_t> ZeCommandListFenceMap;
 
+  // Same as ZeCommandListFenceMap, but for the command lists executed on
+  // ZeCopyCommandQueue.
+  std::map<ze_command_list_handle_t, ze_fence_handle_t>
+      ZeCopyCommandListFenceMap;
+
+  // Compute command queue each command list in ZeCommandListFenceMap is
+  // executed on. Fences are only signalled by the command queue they are
+  // created for, so a command list stays bound to the same queue for as long
+  // as its fence lives.
+  std::map<ze_command_list_handle_t, ze_command_queue_handle_t>
+      ZeCommandListQueueMap;
+
+  // Returns the compute command queue to bind the next command list to and
+  // advances the round-robin position.
+  ze_command_queue_handle_t getNextComputeCommandQueue() {
+    ze_command_queue_handle_t ZeQueue =
+        ZeComputeCommandQueues[NextComputeCommandQueue];
+    NextComputeCommandQueue =
+        (NextComputeCommandQueue + 1) % ZeComputeCommandQueues.size();
+    return ZeQueue;
+  }
+
+  // Returns the command queue the command list is executed on.
+  ze_command_queue_handle_t
+  getExecCommandQueue(ze_command_list_handle_t ZeCommandList);
+
+  // Returns true if the command list is executed on ZeCopyCommandQueue.
+  bool isCopyCommandList(ze_command_list_handle_t ZeCommandList) const {
+    return ZeCopyCommandListFenceMap.count(ZeCommandList) != 0;
+  }
+
+  // Returns the map of command lists and fences the command list belongs to.
+  std::map<ze_command_list_handle_t, ze_fence_handle_t> &
+  getCommandListFenceMap(ze_command_list_handle_t ZeCommandList) {
+    return isCopyCommandList(ZeCommandList) ? ZeCopyCommandListFenceMap
+                                            : ZeCommandListFenceMap;
+  }
+
+  // Level Zero events waited for by the commands appended to each command
+  // list, including ZeImmediateCommandList. They are kept from reuse until
+  // the fence of the command list is signalled, or the immediate command list
+  // is synchronized.
+  std::map<ze_command_list_handle_t, std::vector<ze_event_handle_t>>
+      ZeCommandListWaitedEvents;
+
+  // Records that the command just appended to the command list waits for the
+  // events.
+  void retainWaitList(ze_command_list_handle_t ZeCommandList,
+                      pi_uint32 NumEvents, const ze_event_handle_t *ZeEvents);
+
+  // Releases the waits of the commands of the command list, which must have
+  // completed.
+  pi_result releaseWaitLists(ze_command_list_handle_t ZeCommandList);
+
+  // Returns true if a memory copy or fill with the given pattern size should
+  // be offloaded to the copy engine. PatternSize is 0 for copies.
+  bool useCopyEngine(size_t PatternSize = 0) const;
+
   // Returns true if any commands for this queue are allowed to
   // be batched together.
   bool isBatchingAllowed();
@@ -453,6 +697,10 @@ struct _pi_buffer final : _pi_mem {
   // It is just convenient to have it char * to simplify offset arithmetics.
   char *ZeMem;
 
+  // Indicates that ZeMem is allocated by the plugin, rather than being the
+  // USM memory the buffer is created with, and must be freed with the buffer.
+  bool OwnZeMem = true;
+
   struct {
     _pi_mem *Parent;
     size_t Origin; // only valid if Parent != nullptr
@@ -703,6 +951,17 @@ struct _pi_kernel : _pi_object {
 
   // Keep the program of the kernel.
   pi_program Program;
+
+  // The group sizes returned by zeKernelSuggestGroupSize for the global sizes
+  // of the launches without a local size. The cache is dropped when it
+  // reaches MaxSuggestedGroupSizes entries.
+  static constexpr size_t MaxSuggestedGroupSizes = 64;
+  std::map<std::array<size_t, 3>, std::array<uint32_t, 3>> SuggestedGroupSizes;
+
+  // The group size last set with zeKernelSetGroupSize, which is kept by the
+  // Level Zero kernel across the launches.
+  std::array<uint32_t, 3> GroupSize{{0, 0, 0}};
+  std::mutex GroupSizeMutex; // Protects access to the fields above.
 };
 
 struct _pi_sampler : _pi_object {
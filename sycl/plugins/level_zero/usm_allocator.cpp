@@ -8,6 +8,7 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <bitset>
 #include <cassert>
 #include <iostream>
@@ -15,6 +16,7 @@
 #include <memory>
 #include <mutex>
 #include <shared_mutex>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -22,48 +24,10 @@
 #include "usm_allocator.hpp"
 
 namespace settings {
-// Size of the slab which is going to be requested from the system.
-static constexpr size_t SlabSize = 64 * 1024; // 64K
-// The largest size which is allocated via the allocator.
-// Allocations with size > CutOff bypass the USM allocator and
-// go directly to the runtime.
-static constexpr size_t CutOff = SlabSize / 2;
-
-// Unfortunately we cannot deduce the size of the array, so every change
-// to the number of buckets should be reflected here.
-using BucketsArrayType = std::array<size_t, 21>;
-
-// Generates a list of bucket sizes used by the allocator.
-static constexpr BucketsArrayType generateBucketSizes() {
-
-// In order to make bucket sizes constexpr simply write
-// them all. There are some restrictions that doesn't
-// allow to write this in a nicer way.
-
-// Simple helper to compute power of 2
-#define P(n) (1 << n)
-
-  BucketsArrayType Sizes = {32,    48,
-                            64,    96,
-                            128,   192,
-                            P(8),  P(8) + P(7),
-                            P(9),  P(9) + P(8),
-                            P(10), P(10) + P(9),
-                            P(11), P(11) + P(10),
-                            P(12), P(12) + P(11),
-                            P(13), P(13) + P(12),
-                            P(14), P(14) + P(13),
-                            CutOff};
-#undef P
-
-  return Sizes;
-}
-
-static constexpr BucketsArrayType BucketSizes = generateBucketSizes();
-
-// The implementation expects that SlabSize is 2^n
-static_assert((SlabSize & (SlabSize - 1)) == 0,
-              "SlabSize must be a power of 2");
+// Size of the smallest bucket.
+static constexpr size_t MinBucketSize = 32;
+// Size of the largest bucket whose chunks are kept in the thread caches.
+static constexpr size_t MaxThreadCachedSize = 16 * 1024;
 } // namespace settings
 
 // Aligns the pointer down to the specified alignment
@@ -92,8 +56,12 @@ static size_t AlignUp(size_t Val, size_t Alignment) {
 }
 
 class Bucket;
+class Slab;
 
-// Represents the allocated memory block of size 'settings::SlabSize'
+// A chunk and the slab it belongs to.
+using ChunkRef = std::pair<void *, Slab *>;
+
+// Represents the allocated memory block of size 'Bucket::getSlabSize()'.
 // Internally, it splits the memory block into chunks. The number of
 // chunks depends of the size of a Bucket which created the Slab.
 // The chunks
@@ -145,11 +113,12 @@ public:
   void *getFreeChunk();
 
   void *getPtr() const { return MemPtr; }
-  void *getEnd() const {
-    return static_cast<char *>(getPtr()) + settings::SlabSize;
-  }
+  void *getEnd() const;
 
   size_t getChunkSize() const;
+
+  // Returns the start of the chunk which contains the pointer.
+  void *getChunkStart(void *Ptr) const;
   size_t getNumChunks() const { return Chunks.size(); }
 
   bool hasAvail();
@@ -163,6 +132,12 @@ public:
 class Bucket {
   const size_t Size;
 
+  // Position of the bucket in the allocator context.
+  const size_t Index;
+
+  // Size of the slabs of this bucket.
+  const size_t SlabSize;
+
   // List of slabs which have at least 1 available chunk.
   std::list<std::unique_ptr<Slab>> AvailableSlabs;
 
@@ -172,25 +147,67 @@ class Bucket {
   // Protects the bucket and all the corresponding slabs
   std::mutex BucketLock;
 
+  // Number of the empty slabs in AvailableSlabs which are kept for reuse.
+  size_t NumEmptySlabs = 0;
+
+  // Statistics of the bucket.
+  size_t NumAllocs = 0;
+  size_t NumAllocsFromPool = 0;
+  size_t NumFrees = 0;
+  size_t NumSlabsInUse = 0;
+  size_t MaxSlabsInUse = 0;
+  size_t MaxSlabsInPool = 0;
+
   // Reference to the allocator context, used access memory allocation
   // routines, slab map and etc.
   USMAllocContext::USMAllocImpl &OwnAllocCtx;
 
 public:
-  Bucket(size_t Sz, USMAllocContext::USMAllocImpl &AllocCtx)
-      : Size{Sz}, OwnAllocCtx{AllocCtx} {}
+  Bucket(size_t Sz, size_t Idx, size_t SlabSz,
+         USMAllocContext::USMAllocImpl &AllocCtx)
+      : Size{Sz}, Index{Idx}, SlabSize{SlabSz}, OwnAllocCtx{AllocCtx} {}
 
   void *getChunk();
 
+  // Appends N chunks with their slabs to Chunks under a single lock.
+  void getChunks(size_t N, std::vector<ChunkRef> &Chunks);
+
   size_t getSize() const { return Size; }
+  size_t getIndex() const { return Index; }
+  size_t getSlabSize() const { return SlabSize; }
+
+  // Prints the statistics of the bucket if it has been used.
+  void printStats(std::ostream &Os);
 
   void freeChunk(void *Ptr, Slab &Slab);
+
+  // Frees the chunks in [Begin, End) under a single lock.
+  void freeChunks(const ChunkRef *Begin, const ChunkRef *End);
+
   SystemMemory &getMemHandle();
   USMAllocContext::USMAllocImpl &getUsmAllocCtx() { return OwnAllocCtx; }
 
 private:
   void onFreeChunk(Slab &);
-  decltype(AvailableSlabs.begin()) getAvailSlab();
+  decltype(AvailableSlabs.begin()) getAvailSlab(bool &FromPool);
+
+  // The lock must be acquired before calling this method
+  void *getChunkLocked(Slab *&ChunkSlab);
+};
+
+// Free chunks of the small buckets of a pool which are kept by a single
+// thread. The chunks remain allocated in their slabs while they are here.
+struct ThreadCache {
+  // Protects the cache from the pool being destroyed or the thread exiting at
+  // the same time, so it is normally taken by the owning thread only.
+  std::mutex Lock;
+
+  // The pool which the chunks belong to, or nullptr once the chunks are
+  // returned to the pool or the pool is destroyed.
+  USMAllocContext::USMAllocImpl *Owner = nullptr;
+
+  // Free chunks of each cached bucket.
+  std::vector<std::vector<ChunkRef>> Magazines;
 };
 
 class USMAllocContext::USMAllocImpl {
@@ -202,17 +219,67 @@ class USMAllocContext::USMAllocImpl {
   // Handle to the memory allocation routine
   std::unique_ptr<SystemMemory> MemHandle;
 
+  // The parameters are used by the slabs, so they must outlive the buckets.
+  const USMAllocatorParameters Params;
+
+  // Total size of the empty slabs kept for reuse by all the buckets.
+  std::atomic<size_t> PoolSize{0};
+
   // Store as unique_ptrs since Bucket is not Movable(because of std::mutex)
   std::vector<std::unique_ptr<Bucket>> Buckets;
 
+  // Number of the first buckets which are cached by the threads.
+  size_t NumThreadCachedBuckets = 0;
+
+  // Identifies the pool in the thread caches of the threads. Unlike the
+  // address of the pool, it is never reused.
+  const uint64_t Id;
+  static std::atomic<uint64_t> NextId;
+
+  // Caches of all the threads which use the pool.
+  std::vector<std::shared_ptr<ThreadCache>> ThreadCaches;
+  std::mutex ThreadCachesLock;
+
 public:
-  USMAllocImpl(std::unique_ptr<SystemMemory> SystemMemHandle)
-      : MemHandle{std::move(SystemMemHandle)} {
+  USMAllocImpl(std::unique_ptr<SystemMemory> SystemMemHandle,
+               const USMAllocatorParameters &Parameters)
+      : MemHandle{std::move(SystemMemHandle)}, Params{Parameters},
+        Id{NextId++} {
+    // The implementation expects that SlabMinSize is 2^n
+    assert((Params.SlabMinSize & (Params.SlabMinSize - 1)) == 0 &&
+           "SlabMinSize must be a power of 2");
+
+    // Buckets of sizes 2^n and 2^n + 2^(n-1) up to MaxPoolableSize, which is
+    // the size of the last bucket.
+    for (size_t Size = settings::MinBucketSize; Size < Params.MaxPoolableSize;
+         Size *= 2) {
+      addBucket(Size);
+      if (Size + Size / 2 < Params.MaxPoolableSize)
+        addBucket(Size + Size / 2);
+    }
+    if (Params.MaxPoolableSize > 0)
+      addBucket(Params.MaxPoolableSize);
+
+    if (Params.ThreadCacheSize > 0)
+      NumThreadCachedBuckets = std::count_if(
+          Buckets.begin(), Buckets.end(), [](const auto &BucketPtr) {
+            return BucketPtr->getSize() <= settings::MaxThreadCachedSize;
+          });
+  }
 
-    Buckets.reserve(settings::BucketSizes.size());
+  ~USMAllocImpl() {
+    // The chunks in the thread caches are freed with their slabs.
+    std::lock_guard<std::mutex> Lg(ThreadCachesLock);
+    for (auto &Cache : ThreadCaches) {
+      std::lock_guard<std::mutex> CacheLg(Cache->Lock);
+      Cache->Owner = nullptr;
+      Cache->Magazines.clear();
+    }
 
-    for (auto &&Size : settings::BucketSizes) {
-      Buckets.emplace_back(std::make_unique<Bucket>(Size, *this));
+    if (Params.PrintStats) {
+      std::cerr << Params.Name << " pool statistics:\n";
+      for (auto &Bucket : Buckets)
+        Bucket->printStats(std::cerr);
     }
   }
 
@@ -222,6 +289,27 @@ public:
 
   SystemMemory &getMemHandle() { return *MemHandle; }
 
+  const USMAllocatorParameters &getParams() const { return Params; }
+
+  // Reserves the room for an empty slab of the given size in the pool.
+  // Returns false if the pool has no room left, in which case the slab must be
+  // returned to the system.
+  bool tryPoolSlab(size_t SlabSize) {
+    if (PoolSize.fetch_add(SlabSize) + SlabSize > Params.MaxPoolSize) {
+      PoolSize -= SlabSize;
+      return false;
+    }
+    return true;
+  }
+
+  // Releases the room of an empty slab which is taken out of the pool.
+  void unpoolSlab(size_t SlabSize) { PoolSize -= SlabSize; }
+
+  // Returns all the chunks of the thread cache to the buckets and detaches
+  // the cache from the pool. The lock of the cache must be acquired before
+  // calling this method.
+  void returnThreadCache(ThreadCache &Cache);
+
   std::shared_timed_mutex &getKnownSlabsMapLock() { return KnownSlabsMapLock; }
   std::unordered_multimap<void *, Slab &> &getKnownSlabs() {
     return KnownSlabs;
@@ -229,6 +317,21 @@ public:
 
 private:
   Bucket &findBucket(size_t Size);
+
+  // Returns a chunk of the bucket, from the thread cache if the bucket is
+  // cached.
+  void *getChunk(Bucket &Bucket);
+
+  // Frees the chunk of the slab, to the thread cache if the bucket is cached.
+  void freeChunk(void *Ptr, Slab &Slab);
+
+  // Returns the cache of the calling thread, which is created on first use.
+  ThreadCache &getThreadCache();
+
+  void addBucket(size_t Size) {
+    Buckets.emplace_back(std::make_unique<Bucket>(
+        Size, Buckets.size(), std::max(Size, Params.SlabMinSize), *this));
+  }
 };
 
 bool operator==(const Slab &Lhs, const Slab &Rhs) {
@@ -242,10 +345,10 @@ std::ostream &operator<<(std::ostream &Os, const Slab &Slab) {
 }
 
 Slab::Slab(Bucket &Bkt)
-    : MemPtr(Bkt.getMemHandle().allocate(settings::SlabSize)),
+    : MemPtr(Bkt.getMemHandle().allocate(Bkt.getSlabSize())),
       // In case if bucket size is not that SlabSize % b.getSize() == 0, we
       // would have some padding at the end of the slab.
-      Chunks(settings::SlabSize / Bkt.getSize()), NumAllocated{0},
+      Chunks(Bkt.getSlabSize() / Bkt.getSize()), NumAllocated{0},
       bucket(Bkt), SlabListIter{}, FirstFreeChunkIdx{0} {
 
   regSlab(*this);
@@ -291,6 +394,16 @@ const Bucket &Slab::getBucket() const { return bucket; }
 
 size_t Slab::getChunkSize() const { return bucket.getSize(); }
 
+void *Slab::getChunkStart(void *Ptr) const {
+  auto ChunkIdx =
+      (static_cast<char *>(Ptr) - static_cast<char *>(MemPtr)) / getChunkSize();
+  return static_cast<char *>(MemPtr) + ChunkIdx * getChunkSize();
+}
+
+void *Slab::getEnd() const {
+  return static_cast<char *>(getPtr()) + bucket.getSlabSize();
+}
+
 void Slab::regSlabByAddr(void *Addr, Slab &Slab) {
   auto &Lock = Slab.getBucket().getUsmAllocCtx().getKnownSlabsMapLock();
   auto &Map = Slab.getBucket().getUsmAllocCtx().getKnownSlabs();
@@ -319,17 +432,25 @@ void Slab::unregSlabByAddr(void *Addr, Slab &Slab) {
   assert(false && "Slab is not found");
 }
 
+// The slabs are registered by the SlabMinSize aligned addresses of the first
+// two SlabMinSize blocks they overlap with. All the pointers handed out of a
+// slab lie within them: slabs larger than SlabMinSize hold a single chunk and
+// the alignment of the pooled allocations doesn't exceed SlabMinSize.
 void Slab::regSlab(Slab &Slab) {
-  void *StartAddr = AlignPtrDown(Slab.getPtr(), settings::SlabSize);
-  void *EndAddr = static_cast<char *>(StartAddr) + settings::SlabSize;
+  const size_t SlabMinSize =
+      Slab.getBucket().getUsmAllocCtx().getParams().SlabMinSize;
+  void *StartAddr = AlignPtrDown(Slab.getPtr(), SlabMinSize);
+  void *EndAddr = static_cast<char *>(StartAddr) + SlabMinSize;
 
   regSlabByAddr(StartAddr, Slab);
   regSlabByAddr(EndAddr, Slab);
 }
 
 void Slab::unregSlab(Slab &Slab) {
-  void *StartAddr = AlignPtrDown(Slab.getPtr(), settings::SlabSize);
-  void *EndAddr = static_cast<char *>(StartAddr) + settings::SlabSize;
+  const size_t SlabMinSize =
+      Slab.getBucket().getUsmAllocCtx().getParams().SlabMinSize;
+  void *StartAddr = AlignPtrDown(Slab.getPtr(), SlabMinSize);
+  void *EndAddr = static_cast<char *>(StartAddr) + SlabMinSize;
 
   unregSlabByAddr(StartAddr, Slab);
   unregSlabByAddr(EndAddr, Slab);
@@ -359,11 +480,21 @@ void Slab::freeChunk(void *Ptr) {
 
 bool Slab::hasAvail() { return NumAllocated != getNumChunks(); }
 
-auto Bucket::getAvailSlab() -> decltype(AvailableSlabs.begin()) {
+auto Bucket::getAvailSlab(bool &FromPool) -> decltype(AvailableSlabs.begin()) {
+  FromPool = false;
   if (AvailableSlabs.size() == 0) {
     auto It = AvailableSlabs.insert(AvailableSlabs.begin(),
                                     std::make_unique<Slab>(*this));
     (*It)->setIterator(It);
+    NumSlabsInUse += 1;
+    MaxSlabsInUse = std::max(MaxSlabsInUse, NumSlabsInUse);
+  } else if ((*AvailableSlabs.begin())->getNumAllocated() == 0) {
+    // The empty slab leaves the pool.
+    FromPool = true;
+    NumEmptySlabs -= 1;
+    OwnAllocCtx.unpoolSlab(SlabSize);
+    NumSlabsInUse += 1;
+    MaxSlabsInUse = std::max(MaxSlabsInUse, NumSlabsInUse);
   }
 
   return AvailableSlabs.begin();
@@ -372,8 +503,28 @@ auto Bucket::getAvailSlab() -> decltype(AvailableSlabs.begin()) {
 void *Bucket::getChunk() {
   std::lock_guard<std::mutex> Lg(BucketLock);
 
-  auto SlabIt = getAvailSlab();
+  Slab *ChunkSlab;
+  return getChunkLocked(ChunkSlab);
+}
+
+void Bucket::getChunks(size_t N, std::vector<ChunkRef> &Chunks) {
+  std::lock_guard<std::mutex> Lg(BucketLock);
+
+  for (size_t I = 0; I < N; ++I) {
+    Slab *ChunkSlab;
+    void *Chunk = getChunkLocked(ChunkSlab);
+    Chunks.emplace_back(Chunk, ChunkSlab);
+  }
+}
+
+void *Bucket::getChunkLocked(Slab *&ChunkSlab) {
+  bool FromPool;
+  auto SlabIt = getAvailSlab(FromPool);
+  ChunkSlab = SlabIt->get();
   auto *FreeChunk = (*SlabIt)->getFreeChunk();
+  NumAllocs += 1;
+  if (FromPool)
+    NumAllocsFromPool += 1;
 
   // If the slab is full, move it to unavailable slabs and update its itreator
   if (!((*SlabIt)->hasAvail())) {
@@ -390,10 +541,22 @@ void Bucket::freeChunk(void *Ptr, Slab &Slab) {
   std::lock_guard<std::mutex> Lg(BucketLock);
 
   Slab.freeChunk(Ptr);
+  NumFrees += 1;
 
   onFreeChunk(Slab);
 }
 
+void Bucket::freeChunks(const ChunkRef *Begin, const ChunkRef *End) {
+  std::lock_guard<std::mutex> Lg(BucketLock);
+
+  for (const ChunkRef *It = Begin; It != End; ++It) {
+    It->second->freeChunk(It->first);
+    NumFrees += 1;
+
+    onFreeChunk(*It->second);
+  }
+}
+
 // The lock must be acquired before calling this method
 void Bucket::onFreeChunk(Slab &Slab) {
   // In case if the slab was previously full and now has 1 available
@@ -409,10 +572,23 @@ void Bucket::onFreeChunk(Slab &Slab) {
     (*It)->setIterator(It);
   }
 
-  // Remove the slab when all the chunks from it are deallocated
+  // Remove the slab when all the chunks from it are deallocated, unless the
+  // bucket and the pool have room to keep it for reuse.
   // Note: since the slab is stored as unique_ptr, just remove it from
   // the list to remove the list to destroy the object
   if (Slab.getNumAllocated() == 0) {
+    NumSlabsInUse -= 1;
+    if (NumEmptySlabs < OwnAllocCtx.getParams().Capacity &&
+        OwnAllocCtx.tryPoolSlab(SlabSize)) {
+      NumEmptySlabs += 1;
+      MaxSlabsInPool = std::max(MaxSlabsInPool, NumEmptySlabs);
+      // Keep the empty slabs at the end of the list, so that the partially
+      // used ones are filled first.
+      AvailableSlabs.splice(AvailableSlabs.end(), AvailableSlabs,
+                            Slab.getIterator());
+      return;
+    }
+
     auto It = Slab.getIterator();
     assert(It != AvailableSlabs.end());
 
@@ -420,16 +596,26 @@ void Bucket::onFreeChunk(Slab &Slab) {
   }
 }
 
+void Bucket::printStats(std::ostream &Os) {
+  std::lock_guard<std::mutex> Lg(BucketLock);
+  if (NumAllocs == 0)
+    return;
+
+  Os << "  bucket " << Size << ": allocs " << NumAllocs << ", allocs from pool "
+     << NumAllocsFromPool << ", frees " << NumFrees << ", max slabs in use "
+     << MaxSlabsInUse << ", max slabs in pool " << MaxSlabsInPool << "\n";
+}
+
 SystemMemory &Bucket::getMemHandle() { return OwnAllocCtx.getMemHandle(); }
 
 void *USMAllocContext::USMAllocImpl::allocate(size_t Size) {
   if (Size == 0)
     return nullptr;
 
-  if (Size > settings::CutOff)
+  if (Size > Params.MaxPoolableSize)
     return getMemHandle().allocate(Size);
 
-  return findBucket(Size).getChunk();
+  return getChunk(findBucket(Size));
 }
 
 void *USMAllocContext::USMAllocImpl::allocate(size_t Size, size_t Alignment) {
@@ -441,18 +627,122 @@ void *USMAllocContext::USMAllocImpl::allocate(size_t Size, size_t Alignment) {
 
   size_t AlignedSize = (Size > 1) ? AlignUp(Size, Alignment) : Alignment;
 
-  // Check if our largest chunk is able to fit aligned size.
+  // Check if our largest chunk is able to fit aligned size and the pointer
+  // stays within the blocks the slab is registered by.
   // If not, just request aligned pointer from the system.
-  if (AlignedSize > settings::CutOff) {
+  if (AlignedSize > Params.MaxPoolableSize ||
+      Alignment > Params.SlabMinSize) {
     return getMemHandle().allocate(Size, Alignment);
   }
 
-  auto *Ptr = findBucket(AlignedSize).getChunk();
+  auto *Ptr = getChunk(findBucket(AlignedSize));
   return AlignPtrUp(Ptr, Alignment);
 }
 
+namespace {
+// Caches of the calling thread for all the pools it uses. The chunks are
+// returned to the pools which are still alive when the thread exits.
+struct ThreadCacheMap {
+  std::unordered_map<uint64_t, std::shared_ptr<ThreadCache>> Caches;
+
+  ~ThreadCacheMap() {
+    for (auto &Entry : Caches) {
+      std::lock_guard<std::mutex> Lg(Entry.second->Lock);
+      if (Entry.second->Owner)
+        Entry.second->Owner->returnThreadCache(*Entry.second);
+    }
+  }
+};
+
+thread_local ThreadCacheMap LocalThreadCaches;
+} // namespace
+
+std::atomic<uint64_t> USMAllocContext::USMAllocImpl::NextId{0};
+
+ThreadCache &USMAllocContext::USMAllocImpl::getThreadCache() {
+  auto &Caches = LocalThreadCaches.Caches;
+  auto It = Caches.find(Id);
+  if (It != Caches.end())
+    return *It->second;
+
+  auto Cache = std::make_shared<ThreadCache>();
+  Cache->Owner = this;
+  Cache->Magazines.resize(NumThreadCachedBuckets);
+
+  {
+    std::lock_guard<std::mutex> Lg(ThreadCachesLock);
+    // Forget the caches of the threads which have exited.
+    ThreadCaches.erase(std::remove_if(ThreadCaches.begin(), ThreadCaches.end(),
+                                      [](const auto &C) {
+                                        std::lock_guard<std::mutex> CacheLg(
+                                            C->Lock);
+                                        return C->Owner == nullptr;
+                                      }),
+                       ThreadCaches.end());
+    ThreadCaches.push_back(Cache);
+  }
+
+  // Forget the caches of the pools which are destroyed.
+  for (auto I = Caches.begin(); I != Caches.end();) {
+    bool IsDetached;
+    {
+      std::lock_guard<std::mutex> CacheLg(I->second->Lock);
+      IsDetached = I->second->Owner == nullptr;
+    }
+    I = IsDetached ? Caches.erase(I) : std::next(I);
+  }
+
+  return *Caches.emplace(Id, std::move(Cache)).first->second;
+}
+
+void USMAllocContext::USMAllocImpl::returnThreadCache(ThreadCache &Cache) {
+  for (size_t I = 0; I < Cache.Magazines.size(); ++I) {
+    auto &Magazine = Cache.Magazines[I];
+    Buckets[I]->freeChunks(Magazine.data(), Magazine.data() + Magazine.size());
+    Magazine.clear();
+  }
+  Cache.Owner = nullptr;
+}
+
+void *USMAllocContext::USMAllocImpl::getChunk(Bucket &Bucket) {
+  if (Bucket.getIndex() >= NumThreadCachedBuckets)
+    return Bucket.getChunk();
+
+  ThreadCache &Cache = getThreadCache();
+  std::lock_guard<std::mutex> Lg(Cache.Lock);
+  auto &Magazine = Cache.Magazines[Bucket.getIndex()];
+  // Refill half of the magazine at once.
+  if (Magazine.empty())
+    Bucket.getChunks(Params.ThreadCacheSize / 2 + 1, Magazine);
+
+  void *Chunk = Magazine.back().first;
+  Magazine.pop_back();
+  return Chunk;
+}
+
+void USMAllocContext::USMAllocImpl::freeChunk(void *Ptr, Slab &Slab) {
+  auto &Bucket = Slab.getBucket();
+  if (Bucket.getIndex() >= NumThreadCachedBuckets) {
+    Bucket.freeChunk(Ptr, Slab);
+    return;
+  }
+
+  ThreadCache &Cache = getThreadCache();
+  std::lock_guard<std::mutex> Lg(Cache.Lock);
+  auto &Magazine = Cache.Magazines[Bucket.getIndex()];
+  // The pointer may be aligned up within the chunk.
+  Magazine.emplace_back(Slab.getChunkStart(Ptr), &Slab);
+  // Return half of the full magazine at once.
+  if (Magazine.size() > Params.ThreadCacheSize) {
+    const size_t Keep = Params.ThreadCacheSize / 2;
+    Bucket.freeChunks(Magazine.data() + Keep,
+                      Magazine.data() + Magazine.size());
+    Magazine.resize(Keep);
+  }
+}
+
 Bucket &USMAllocContext::USMAllocImpl::findBucket(size_t Size) {
-  assert(Size <= settings::CutOff && "Unexpected size");
+  assert(Size <= Params.MaxPoolableSize && "Unexpected size");
 
   auto It = std::find_if(
       Buckets.begin(), Buckets.end(),
@@ -464,7 +754,7 @@ Bucket &USMAllocContext::USMAllocImpl::findBucket(size_t Size) {
 }
 
 void USMAllocContext::USMAllocImpl::deallocate(void *Ptr) {
-  auto *SlabPtr = AlignPtrDown(Ptr, settings::SlabSize);
+  auto *SlabPtr = AlignPtrDown(Ptr, Params.SlabMinSize);
 
   // Lock the map on read
   std::shared_lock<std::shared_timed_mutex> Lk(getKnownSlabsMapLock());
@@ -485,8 +775,7 @@ void USMAllocContext::USMAllocImpl::deallocate(void *Ptr) {
       // Unlock the map before freeing the chunk, it may be locked on write
       // there
       Lk.unlock();
-      auto &Bucket = Slab.getBucket();
-      Bucket.freeChunk(Ptr, Slab);
+      freeChunk(Ptr, Slab);
       return;
     }
   }
@@ -498,8 +787,9 @@ void USMAllocContext::USMAllocImpl::deallocate(void *Ptr) {
   getMemHandle().deallocate(Ptr);
 }
 
-USMAllocContext::USMAllocContext(std::unique_ptr<SystemMemory> MemHandle)
-    : pImpl(std::make_unique<USMAllocImpl>(std::move(MemHandle))) {}
+USMAllocContext::USMAllocContext(std::unique_ptr<SystemMemory> MemHandle,
+                                 const USMAllocatorParameters &Params)
+    : pImpl(std::make_unique<USMAllocImpl>(std::move(MemHandle), Params)) {}
 
 void *USMAllocContext::allocate(size_t size) { return pImpl->allocate(size); }
 
@@ -9,6 +9,7 @@
 #ifndef USM_ALLOCATOR
 #define USM_ALLOCATOR
 
+#include <cstddef>
 #include <memory>
 
 // USM system memory allocation/deallocation interface.
@@ -20,12 +21,44 @@ public:
   virtual ~SystemMemory() = default;
 };
 
+// Tunable parameters of a USM pool. The defaults describe the original
+// allocator: small allocations only and no empty slabs kept for reuse.
+struct USMAllocatorParameters {
+  // Name of the pool in the statistics.
+  const char *Name = "USM";
+
+  // Minimum size of the slabs requested from the system. Slabs of the buckets
+  // which are larger than that hold a single chunk. Must be a power of 2.
+  size_t SlabMinSize = 64 * 1024;
+
+  // The largest size which is allocated from the pool. Allocations with a
+  // larger size bypass the pool and go directly to the runtime.
+  size_t MaxPoolableSize = 32 * 1024;
+
+  // Number of empty slabs each bucket keeps for reuse instead of returning
+  // them to the system.
+  size_t Capacity = 0;
+
+  // Limit of the total size of the empty slabs kept by the pool.
+  size_t MaxPoolSize = 0;
+
+  // Number of free chunks of each small bucket which every thread keeps to
+  // itself, so that its allocations and frees mostly don't take the bucket
+  // locks. 0 disables the thread caches.
+  size_t ThreadCacheSize = 0;
+
+  // Print the statistics of the pool when it is destroyed.
+  bool PrintStats = false;
+};
+
 class USMAllocContext {
 public:
   // Keep it public since it needs to be accessed by the lower layer(Buckets)
   class USMAllocImpl;
 
-  USMAllocContext(std::unique_ptr<SystemMemory> memHandle);
+  USMAllocContext(std::unique_ptr<SystemMemory> memHandle,
+                  const USMAllocatorParameters &params =
+                      USMAllocatorParameters());
   ~USMAllocContext();
 
   void *allocate(size_t size);
@@ -22,6 +22,8 @@
 #include <iostream>
 #include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -66,54 +68,122 @@ CONSTFIX char clSetProgramSpecializationConstantName[] =
 
 #undef CONSTFIX
 
-// USM helper function to get an extension function pointer
-template <const char *FuncName, typename T>
-static pi_result getExtFuncFromContext(pi_context context, T *fptr) {
-  // TODO
-  // Potentially redo caching as PI interface changes.
-  thread_local static std::map<pi_context, T> FuncPtrs;
+// The extension functions resolved for each platform
+static constexpr const char *ExtFuncNames[] = {
+    clHostMemAllocName,
+    clDeviceMemAllocName,
+    clSharedMemAllocName,
+    clMemFreeName,
+    clCreateBufferWithPropertiesName,
+    clSetKernelArgMemPointerName,
+    clEnqueueMemsetName,
+    clEnqueueMemcpyName,
+    clEnqueueMigrateMemName,
+    clEnqueueMemAdviseName,
+    clGetMemAllocInfoName,
+    clSetProgramSpecializationConstantName};
+
+static constexpr size_t NumExtFuncs =
+    sizeof(ExtFuncNames) / sizeof(ExtFuncNames[0]);
+
+// Index of FuncName in ExtFuncNames, or NumExtFuncs if it is not there
+static constexpr size_t getExtFuncIndex(const char *FuncName, size_t I = 0) {
+  return I == NumExtFuncs || ExtFuncNames[I] == FuncName
+             ? I
+             : getExtFuncIndex(FuncName, I + 1);
+}
 
-  // if cached, return cached FuncPtr
-  if (auto F = FuncPtrs[context]) {
-    *fptr = F;
+/// The extension functions of a platform, in the order of ExtFuncNames. The
+/// functions missing from the platform are null.
+///
+/// The tables are filled once per platform and never modified nor freed
+/// afterwards, so they are read without locking.
+struct ExtFuncTable {
+  void *Funcs[NumExtFuncs];
+};
+
+static const ExtFuncTable *getPlatformExtFuncTable(cl_platform_id Platform) {
+  static std::mutex Mutex;
+  static std::map<cl_platform_id, std::unique_ptr<ExtFuncTable>> Tables;
+
+  std::lock_guard<std::mutex> Lock(Mutex);
+  std::unique_ptr<ExtFuncTable> &Table = Tables[Platform];
+  if (!Table) {
+    Table.reset(new ExtFuncTable);
+    for (size_t I = 0; I < NumExtFuncs; ++I)
+      Table->Funcs[I] =
+          clGetExtensionFunctionAddressForPlatform(Platform, ExtFuncNames[I]);
+  }
+  return Table.get();
+}
+
+// Get the extension function table of the platform of a context
+static pi_result getExtFuncTable(pi_context context,
+                                 const ExtFuncTable **Table) {
+  // The USM calls usually use the same context over and over, so remember the
+  // last one of the thread in front of the map of all the contexts it used.
+  // The map is thread local so that neither is locked.
+  thread_local static pi_context LastContext = nullptr;
+  thread_local static const ExtFuncTable *LastTable = nullptr;
+  thread_local static std::map<pi_context, const ExtFuncTable *> Tables;
+
+  if (context == LastContext) {
+    *Table = LastTable;
     return PI_SUCCESS;
   }
 
-  size_t deviceCount;
-  cl_int ret_err = clGetContextInfo(
-      cast<cl_context>(context), CL_CONTEXT_DEVICES, 0, nullptr, &deviceCount);
+  const ExtFuncTable *&ContextTable = Tables[context];
+  if (!ContextTable) {
+    size_t deviceCount;
+    cl_int ret_err =
+        clGetContextInfo(cast<cl_context>(context), CL_CONTEXT_DEVICES, 0,
+                         nullptr, &deviceCount);
 
-  if (ret_err != CL_SUCCESS || deviceCount < 1) {
-    return PI_INVALID_CONTEXT;
-  }
+    if (ret_err != CL_SUCCESS || deviceCount < 1) {
+      Tables.erase(context);
+      return PI_INVALID_CONTEXT;
+    }
 
-  std::vector<cl_device_id> devicesInCtx(deviceCount);
-  ret_err = clGetContextInfo(cast<cl_context>(context), CL_CONTEXT_DEVICES,
-                             deviceCount * sizeof(cl_device_id),
-                             devicesInCtx.data(), nullptr);
+    std::vector<cl_device_id> devicesInCtx(deviceCount);
+    ret_err = clGetContextInfo(cast<cl_context>(context), CL_CONTEXT_DEVICES,
+                               deviceCount * sizeof(cl_device_id),
+                               devicesInCtx.data(), nullptr);
 
-  if (ret_err != CL_SUCCESS) {
-    return PI_INVALID_CONTEXT;
-  }
+    cl_platform_id curPlatform;
+    if (ret_err == CL_SUCCESS)
+      ret_err = clGetDeviceInfo(devicesInCtx[0], CL_DEVICE_PLATFORM,
+                                sizeof(cl_platform_id), &curPlatform, nullptr);
 
-  cl_platform_id curPlatform;
-  ret_err = clGetDeviceInfo(devicesInCtx[0], CL_DEVICE_PLATFORM,
-                            sizeof(cl_platform_id), &curPlatform, nullptr);
+    if (ret_err != CL_SUCCESS) {
+      Tables.erase(context);
+      return PI_INVALID_CONTEXT;
+    }
 
-  if (ret_err != CL_SUCCESS) {
-    return PI_INVALID_CONTEXT;
+    ContextTable = getPlatformExtFuncTable(curPlatform);
   }
 
-  T FuncPtr =
-      (T)clGetExtensionFunctionAddressForPlatform(curPlatform, FuncName);
+  LastContext = context;
+  LastTable = ContextTable;
+  *Table = ContextTable;
+  return PI_SUCCESS;
+}
+
+// USM helper function to get an extension function pointer
+template <const char *FuncName, typename T>
+static pi_result getExtFuncFromContext(pi_context context, T *fptr) {
+  constexpr size_t Index = getExtFuncIndex(FuncName);
+  static_assert(Index < NumExtFuncs, "Extension function is not in the table");
+
+  const ExtFuncTable *Table;
+  if (pi_result Err = getExtFuncTable(context, &Table))
+    return Err;
 
+  T FuncPtr = (T)Table->Funcs[Index];
   if (!FuncPtr)
     return PI_INVALID_VALUE;
 
   *fptr = FuncPtr;
-  FuncPtrs[context] = FuncPtr;
-
-  return cast<pi_result>(ret_err);
+  return PI_SUCCESS;
 }
 
 /// Enables indirect access of pointers in kernels.
@@ -307,6 +377,12 @@ pi_result piQueueCreate(pi_context context, pi_device device,
                         pi_queue_properties properties, pi_queue *queue) {
   assert(queue && "piQueueCreate failed, queue argument is null");
 
+  // The extension bits are not passed on, OpenCL doesn't know them.
+  properties &= ~(PI_EXT_ONEAPI_QUEUE_PRIORITY_LOW |
+                  PI_EXT_ONEAPI_QUEUE_PRIORITY_HIGH |
+                  PI_EXT_ONEAPI_QUEUE_SUB_DEVICE_SCALING |
+                  PI_EXT_ONEAPI_QUEUE_SPIN_WAIT);
+
   cl_platform_id curPlatform;
   cl_int ret_err =
       clGetDeviceInfo(cast<cl_device_id>(device), CL_DEVICE_PLATFORM,
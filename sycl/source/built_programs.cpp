@@ -0,0 +1,61 @@
+//==------ built_programs.cpp --- SYCL export and import of JIT builds -----==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <CL/sycl/ONEAPI/built_programs.hpp>
+#include <detail/built_program_bundle.hpp>
+#include <detail/context_impl.hpp>
+#include <detail/persistent_device_code_cache.hpp>
+#include <detail/program_manager/program_manager.hpp>
+
+#include <unordered_set>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace ONEAPI {
+
+using sycl::detail::BuiltProgramBundle;
+
+size_t export_built_programs(const context &Context,
+                             const string_class &FileName) {
+  using sycl::detail::ProgramManager;
+  std::vector<BuiltProgramBundle::Entry> Entries;
+  if (!Context.is_host())
+    Entries = ProgramManager::getInstance().getBuiltProgramEntries(Context);
+  BuiltProgramBundle::writeToFile(FileName, Entries);
+  return Entries.size();
+}
+
+size_t import_built_programs(const context &Context,
+                             const string_class &FileName) {
+  std::vector<BuiltProgramBundle::Entry> Entries =
+      BuiltProgramBundle::readFromFile(FileName);
+  if (Context.is_host())
+    return 0;
+
+  std::unordered_set<std::string> DeviceIDs;
+  for (const device &Device : Context.get_devices())
+    DeviceIDs.insert(
+        sycl::detail::PersistentDeviceCodeCache::getDeviceIDString(Device));
+
+  // The binaries of the other images are never looked up, so only the device
+  // and the driver need to be checked here.
+  BuiltProgramBundle &Imported =
+      sycl::detail::getSyclObjImpl(Context)->getImportedPrograms();
+  size_t NumImported = 0;
+  for (BuiltProgramBundle::Entry &Entry : Entries) {
+    if (Entry.Binary.empty() || !DeviceIDs.count(Entry.DeviceID))
+      continue;
+    Imported.add(std::move(Entry));
+    ++NumImported;
+  }
+  return NumImported;
+}
+
+} // namespace ONEAPI
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
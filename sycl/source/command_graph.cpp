@@ -0,0 +1,33 @@
+//==------- command_graph.cpp --- SYCL recorded command sequences ----------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <CL/sycl/ONEAPI/command_graph.hpp>
+#include <detail/command_graph_impl.hpp>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace ONEAPI {
+
+command_graph::command_graph()
+    : impl(std::make_shared<sycl::detail::command_graph_impl>()) {}
+
+void command_graph::begin_recording(queue &Queue) {
+  impl->beginRecording(sycl::detail::getSyclObjImpl(Queue));
+}
+
+void command_graph::end_recording() { impl->endRecording(); }
+
+bool command_graph::is_recorded() const { return impl->isRecorded(); }
+
+event command_graph::replay(queue &Queue, const vector_class<event> &DepEvents) {
+  return impl->replay(sycl::detail::getSyclObjImpl(Queue), DepEvents);
+}
+
+} // namespace ONEAPI
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -23,9 +23,23 @@ void *buffer_impl::allocateMem(ContextImplPtr Context, bool InitFromUserData,
          "Internal error. Allocating memory on the host "
          "while having use_host_ptr property");
 
-  return MemoryManager::allocateMemBuffer(
-      std::move(Context), this, HostPtr, HostPtrReadOnly, BaseT::getSize(),
-      BaseT::MInteropEvent, BaseT::MInteropContext, MProps, OutEventToWait);
+  // The copies between the memory of the user and the device buffer run at
+  // the speed of pinned memory if the plugin can register it. The memory is
+  // registered for as long as the buffer uses it.
+  void *UserPtr = BaseT::getUserPtr();
+  const bool ImportHostPtr =
+      !Context->is_host() && BaseT::useHostPtr() && !BaseT::MOpenCLInterop &&
+      !BaseT::MHostPtrReadOnly && UserPtr &&
+      Context->importHostMemory(this, UserPtr, BaseT::getSize());
+  try {
+    return MemoryManager::allocateMemBuffer(
+        Context, this, HostPtr, HostPtrReadOnly, BaseT::getSize(),
+        BaseT::MInteropEvent, BaseT::MInteropContext, MProps, OutEventToWait);
+  } catch (...) {
+    if (ImportHostPtr)
+      Context->releaseHostMemoryImport(this);
+    throw;
+  }
 }
 } // namespace detail
 } // namespace sycl
@@ -0,0 +1,162 @@
+//==---------- built_program_bundle.cpp - Exported built programs ----------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <CL/sycl/exception.hpp>
+#include <detail/built_program_bundle.hpp>
+#include <detail/persistent_device_code_cache.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+
+constexpr const char *BuiltProgramBundle::FormatVersion;
+
+BuiltProgramBundle::Entry
+BuiltProgramBundle::getEntry(const device &Device,
+                             const RTDeviceBinaryImage &Img,
+                             const SerializedObj &SpecConsts,
+                             const std::string &BuildOptions) {
+  const pi_device_binary_struct &RawImg = Img.getRawData();
+  std::string ImgString{reinterpret_cast<const char *>(RawImg.BinaryStart),
+                        Img.getSize()};
+
+  Entry E;
+  E.DeviceID = PersistentDeviceCodeCache::getDeviceIDString(Device);
+  E.ImageID = std::to_string(std::hash<std::string>{}(ImgString)) + "/" +
+              std::to_string(Img.getSize());
+  E.BuildOptions = BuildOptions;
+  E.SpecConsts = PersistentDeviceCodeCache::getSpecConstsString(SpecConsts);
+  return E;
+}
+
+std::string BuiltProgramBundle::getKey(const Entry &E) {
+  // The components are size-prefixed, so no separator can be confused with
+  // their contents.
+  std::string Key;
+  for (const std::string *Str :
+       {&E.DeviceID, &E.ImageID, &E.BuildOptions, &E.SpecConsts})
+    Key += std::to_string(Str->size()) + ":" + *Str;
+  return Key;
+}
+
+void BuiltProgramBundle::writeToFile(const std::string &FileName,
+                                     const std::vector<Entry> &Entries) {
+  std::ofstream FileStream{FileName, std::ios::binary};
+  if (!FileStream.is_open())
+    throw runtime_error("Cannot open " + FileName + " for writing",
+                        PI_INVALID_VALUE);
+
+  auto WriteData = [&FileStream](const char *Data, size_t Size) {
+    FileStream.write(reinterpret_cast<const char *>(&Size), sizeof(Size));
+    FileStream.write(Data, Size);
+  };
+  auto WriteString = [&WriteData](const std::string &Str) {
+    WriteData(Str.data(), Str.size());
+  };
+
+  WriteData(FormatVersion, std::strlen(FormatVersion));
+  size_t NumEntries = Entries.size();
+  FileStream.write(reinterpret_cast<const char *>(&NumEntries),
+                   sizeof(NumEntries));
+  for (const Entry &E : Entries) {
+    WriteString(E.DeviceID);
+    WriteString(E.ImageID);
+    WriteString(E.BuildOptions);
+    WriteString(E.SpecConsts);
+    WriteData(E.Binary.data(), E.Binary.size());
+  }
+  FileStream.close();
+  if (FileStream.fail()) {
+    std::remove(FileName.c_str());
+    throw runtime_error("Cannot write " + FileName, PI_INVALID_VALUE);
+  }
+}
+
+std::vector<BuiltProgramBundle::Entry>
+BuiltProgramBundle::readFromFile(const std::string &FileName) {
+  std::ifstream FileStream{FileName, std::ios::binary};
+  if (!FileStream.is_open())
+    throw runtime_error("Cannot open " + FileName + " for reading",
+                        PI_INVALID_VALUE);
+
+  FileStream.seekg(0, std::ios::end);
+  const size_t FileSize = FileStream.tellg();
+  FileStream.seekg(0, std::ios::beg);
+
+  auto ReadSize = [&FileStream, FileSize]() {
+    size_t Size = 0;
+    FileStream.read(reinterpret_cast<char *>(&Size), sizeof(Size));
+    // A size beyond the end of the file is a truncated or corrupted bundle.
+    if (FileStream.fail() || Size > FileSize)
+      throw runtime_error("Corrupted bundle of built programs",
+                          PI_INVALID_BINARY);
+    return Size;
+  };
+  auto ReadData = [&FileStream](char *Data, size_t Size) {
+    FileStream.read(Data, Size);
+    if (FileStream.fail())
+      throw runtime_error("Corrupted bundle of built programs",
+                          PI_INVALID_BINARY);
+  };
+  auto ReadString = [&ReadSize, &ReadData]() {
+    std::string Str(ReadSize(), '\0');
+    ReadData(&Str[0], Str.size());
+    return Str;
+  };
+
+  std::string Version;
+  try {
+    Version = ReadString();
+  } catch (const runtime_error &) {
+    // Not a bundle at all, reported below.
+  }
+  if (Version != FormatVersion)
+    throw runtime_error(FileName + " is not a bundle of built programs of "
+                                   "this version of the SYCL runtime",
+                        PI_INVALID_BINARY);
+
+  // Every entry takes at least the sizes of its five components.
+  const size_t NumEntries = ReadSize();
+  if (NumEntries > FileSize / (5 * sizeof(size_t)))
+    throw runtime_error("Corrupted bundle of built programs",
+                        PI_INVALID_BINARY);
+  std::vector<Entry> Entries(NumEntries);
+  for (Entry &E : Entries) {
+    E.DeviceID = ReadString();
+    E.ImageID = ReadString();
+    E.BuildOptions = ReadString();
+    E.SpecConsts = ReadString();
+    E.Binary.resize(ReadSize());
+    ReadData(E.Binary.data(), E.Binary.size());
+  }
+  return Entries;
+}
+
+void BuiltProgramBundle::add(Entry &&E) {
+  std::string Key = getKey(E);
+  std::lock_guard<std::mutex> Lock(MMutex);
+  MBinaries[std::move(Key)] = std::move(E.Binary);
+}
+
+std::vector<char> BuiltProgramBundle::find(const Entry &E) const {
+  std::string Key = getKey(E);
+  std::lock_guard<std::mutex> Lock(MMutex);
+  auto It = MBinaries.find(Key);
+  if (It == MBinaries.end())
+    return {};
+  return It->second;
+}
+
+} // namespace detail
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
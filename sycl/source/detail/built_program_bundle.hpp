@@ -0,0 +1,92 @@
+//==---------- built_program_bundle.hpp - Exported built programs ----------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl/detail/device_binary_image.hpp>
+#include <CL/sycl/detail/util.hpp>
+#include <CL/sycl/device.hpp>
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+
+/* The native binaries of built programs, exported by one process and imported
+ * by the next ones, e.g. to deploy the JIT builds of an application made once
+ * per device model.
+ *
+ * Each program is identified by the same components as the items of the
+ * persistent device code cache: the device and its driver, the device image
+ * the program is built from, the build options and the spec constant values.
+ * The image is identified by its hash and size, so that the bundle doesn't
+ * duplicate the application's device code.
+ *
+ * The bundle file holds a header with the format version followed by the
+ * size-prefixed components and binary of every program. Programs built for
+ * other devices or drivers than the ones of the importing context are skipped
+ * on import, so a single bundle can serve several device models.
+ */
+class BuiltProgramBundle {
+public:
+  struct Entry {
+    std::string DeviceID;
+    std::string ImageID;
+    std::string BuildOptions;
+    std::string SpecConsts;
+    std::vector<char> Binary;
+  };
+
+  /// Returns the entry of the program built for \p Device from \p Img,
+  /// without its binary.
+  static Entry getEntry(const device &Device, const RTDeviceBinaryImage &Img,
+                        const SerializedObj &SpecConsts,
+                        const std::string &BuildOptions);
+
+  /// Writes the entries to the file.
+  ///
+  /// \throw runtime_error if the file can't be written.
+  static void writeToFile(const std::string &FileName,
+                          const std::vector<Entry> &Entries);
+
+  /// Reads the entries written by writeToFile.
+  ///
+  /// \throw runtime_error if the file can't be read or is not a bundle of
+  /// the current format version.
+  static std::vector<Entry> readFromFile(const std::string &FileName);
+
+  /// Adds the binary of the entry, replacing the one with the same key.
+  void add(Entry &&E);
+
+  /// Returns the binary of the program identified by the entry, or an empty
+  /// vector if it has not been added.
+  std::vector<char> find(const Entry &E) const;
+
+  bool empty() const {
+    std::lock_guard<std::mutex> Lock(MMutex);
+    return MBinaries.empty();
+  }
+
+  /// Version of the layout of the bundle files. Must be bumped every time the
+  /// layout changes, so that stale bundles are rejected.
+  static constexpr const char *FormatVersion = "SYCL built programs v1";
+
+private:
+  static std::string getKey(const Entry &E);
+
+  mutable std::mutex MMutex;
+  std::unordered_map<std::string, std::vector<char>> MBinaries;
+};
+
+} // namespace detail
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -221,148 +221,79 @@ __SYCL_INLINE_NAMESPACE(cl) {
 namespace __host_std {
 namespace detail {
 
+// Applies the scalar operations to the elements of the vectors. The elements
+// are accessed in place rather than through swizzles, so the loops are plain
+// array loops which the compiler inlines the operations into and vectorizes
+// for the arithmetic operations.
 template <int N> struct helper {
-  template <typename Res, typename Op, typename T1>
-  inline void run_1v(Res &r, Op op, T1 x) {
-    helper<N - 1>().run_1v(r, op, x);
-    r.template swizzle<N>() = op(x.template swizzle<N>());
-  }
-
-  template <typename Res, typename Op, typename T1, typename T2>
-  inline void run_1v_2v(Res &r, Op op, T1 x, T2 y) {
-    helper<N - 1>().run_1v_2v(r, op, x, y);
-    r.template swizzle<N>() =
-        op(x.template swizzle<N>(), y.template swizzle<N>());
-  }
-
-  template <typename Res, typename Op, typename T1, typename T2>
-  inline void run_1v_2s(Res &r, Op op, T1 x, T2 y) {
-    helper<N - 1>().run_1v_2s(r, op, x, y);
-    r.template swizzle<N>() = op(x.template swizzle<N>(), y);
-  }
-
-  template <typename Res, typename Op, typename T1, typename T2, typename T3>
-  inline void run_1v_2s_3s(Res &r, Op op, T1 x, T2 y, T3 z) {
-    helper<N - 1>().run_1v_2s_3s(r, op, x, y, z);
-    r.template swizzle<N>() = op(x.template swizzle<N>(), y, z);
-  }
-
-  template <typename Res, typename Op, typename T1, typename T2>
-  inline void run_1v_2v_rs(Res &r, Op op, T1 x, T2 y) {
-    helper<N - 1>().run_1v_2v_rs(r, op, x, y);
-    op(r, x.template swizzle<N>(), y.template swizzle<N>());
-  }
-
-  template <typename Res, typename Op, typename T1>
-  inline void run_1v_rs(Res &r, Op op, T1 x) {
-    helper<N - 1>().run_1v_rs(r, op, x);
-    op(r, x.template swizzle<N>());
-  }
-
-  template <typename Res, typename Op, typename T1, typename T2>
-  inline void run_1v_2p(Res &r, Op op, T1 x, T2 y) {
-    helper<N - 1>().run_1v_2p(r, op, x, y);
-    // TODO avoid creating a temporary variable
-    typename std::remove_pointer<T2>::type::element_type temp;
-    r.template swizzle<N>() = op(x.template swizzle<N>(), &temp);
-    y->template swizzle<N>() = temp;
-  }
-
-  template <typename Res, typename Op, typename T1, typename T2, typename T3>
-  inline void run_1v_2v_3p(Res &r, Op op, T1 x, T2 y, T3 z) {
-    helper<N - 1>().run_1v_2v_3p(r, op, x, y, z);
-    // TODO avoid creating a temporary variable
-    typename std::remove_pointer<T3>::type::element_type temp;
-    r.template swizzle<N>() =
-        op(x.template swizzle<N>(), y.template swizzle<N>(), &temp);
-    z->template swizzle<N>() = temp;
-  }
-
-  template <typename Res, typename Op, typename T1, typename T2, typename T3>
-  inline void run_1v_2v_3v(Res &r, Op op, T1 x, T2 y, T3 z) {
-    helper<N - 1>().run_1v_2v_3v(r, op, x, y, z);
-    r.template swizzle<N>() =
-        op(x.template swizzle<N>(), y.template swizzle<N>(),
-           z.template swizzle<N>());
-  }
-
-  template <typename Res, typename Op, typename T1>
-  inline void run_1v_sr_or(Res &r, Op op, T1 x) {
-    helper<N - 1>().run_1v_sr_or(r, op, x);
-    r = (op(x.template swizzle<N>()) || r);
-  }
-
-  template <typename Res, typename Op, typename T1>
-  inline void run_1v_sr_and(Res &r, Op op, T1 x) {
-    helper<N - 1>().run_1v_sr_and(r, op, x);
-    r = (op(x.template swizzle<N>()) && r);
-  }
-};
+  static constexpr int Size = N + 1;
 
-template <> struct helper<0> {
   template <typename Res, typename Op, typename T1>
   inline void run_1v(Res &r, Op op, T1 x) {
-    r.template swizzle<0>() = op(x.template swizzle<0>());
+    for (int I = 0; I < Size; ++I)
+      r[I] = op(x[I]);
   }
 
   template <typename Res, typename Op, typename T1, typename T2>
   inline void run_1v_2v(Res &r, Op op, T1 x, T2 y) {
-    r.template swizzle<0>() =
-        op(x.template swizzle<0>(), y.template swizzle<0>());
+    for (int I = 0; I < Size; ++I)
+      r[I] = op(x[I], y[I]);
   }
 
   template <typename Res, typename Op, typename T1, typename T2>
   inline void run_1v_2s(Res &r, Op op, T1 x, T2 y) {
-    r.template swizzle<0>() = op(x.template swizzle<0>(), y);
+    for (int I = 0; I < Size; ++I)
+      r[I] = op(x[I], y);
   }
 
   template <typename Res, typename Op, typename T1, typename T2, typename T3>
   inline void run_1v_2s_3s(Res &r, Op op, T1 x, T2 y, T3 z) {
-    r.template swizzle<0>() = op(x.template swizzle<0>(), y, z);
+    for (int I = 0; I < Size; ++I)
+      r[I] = op(x[I], y, z);
   }
 
   template <typename Res, typename Op, typename T1, typename T2>
   inline void run_1v_2v_rs(Res &r, Op op, T1 x, T2 y) {
-    op(r, x.template swizzle<0>(), y.template swizzle<0>());
+    for (int I = 0; I < Size; ++I)
+      op(r, x[I], y[I]);
   }
 
   template <typename Res, typename Op, typename T1>
   inline void run_1v_rs(Res &r, Op op, T1 x) {
-    op(r, x.template swizzle<0>());
+    for (int I = 0; I < Size; ++I)
+      op(r, x[I]);
   }
 
   template <typename Res, typename Op, typename T1, typename T2>
   inline void run_1v_2p(Res &r, Op op, T1 x, T2 y) {
-    // TODO avoid creating a temporary variable
-    typename std::remove_pointer<T2>::type::element_type temp;
-    r.template swizzle<0>() = op(x.template swizzle<0>(), &temp);
-    y->template swizzle<0>() = temp;
+    for (int I = 0; I < Size; ++I)
+      r[I] = op(x[I], &(*y)[I]);
   }
 
   template <typename Res, typename Op, typename T1, typename T2, typename T3>
   inline void run_1v_2v_3p(Res &r, Op op, T1 x, T2 y, T3 z) {
-    // TODO avoid creating a temporary variable
-    typename std::remove_pointer<T3>::type::element_type temp;
-    r.template swizzle<0>() =
-        op(x.template swizzle<0>(), y.template swizzle<0>(), &temp);
-    z->template swizzle<0>() = temp;
+    for (int I = 0; I < Size; ++I)
+      r[I] = op(x[I], y[I], &(*z)[I]);
   }
 
   template <typename Res, typename Op, typename T1, typename T2, typename T3>
   inline void run_1v_2v_3v(Res &r, Op op, T1 x, T2 y, T3 z) {
-    r.template swizzle<0>() =
-        op(x.template swizzle<0>(), y.template swizzle<0>(),
-           z.template swizzle<0>());
+    for (int I = 0; I < Size; ++I)
+      r[I] = op(x[I], y[I], z[I]);
   }
 
   template <typename Res, typename Op, typename T1>
   inline void run_1v_sr_or(Res &r, Op op, T1 x) {
-    r = op(x.template swizzle<0>());
+    r = op(x[0]);
+    for (int I = 1; I < Size; ++I)
+      r = (op(x[I]) || r);
   }
 
   template <typename Res, typename Op, typename T1>
   inline void run_1v_sr_and(Res &r, Op op, T1 x) {
-    r = op(x.template swizzle<0>());
+    r = op(x[0]);
+    for (int I = 1; I < Size; ++I)
+      r = (op(x[I]) && r);
   }
 };
 
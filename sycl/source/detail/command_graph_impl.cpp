@@ -0,0 +1,295 @@
+//==------- command_graph_impl.cpp --- SYCL recorded command sequences -----==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <CL/sycl/detail/memory_manager.hpp>
+#include <CL/sycl/exception.hpp>
+#include <detail/command_graph_impl.hpp>
+#include <detail/event_impl.hpp>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+
+command_graph_impl::~command_graph_impl() {
+  if (MRecordingQueue && MRecordingNodes) {
+    MRecordingQueue->setRecordingGraph(nullptr);
+    releaseNodes(MNewNodes);
+  } else if (MRecordingQueue) {
+    // Throw the unfinished recording away, so that the queue is usable again.
+    RT::PiExtCommandGraph Graph = MGraph;
+    if (MRecordingQueue->getPlugin()
+            .call_nocheck<PiApiKind::piextQueueEndGraphCapture>(
+                MRecordingQueue->getHandleRef(), &Graph) == PI_SUCCESS)
+      MGraph = Graph;
+  }
+  if (MGraph)
+    MContext->getPlugin().call_nocheck<PiApiKind::piextCommandGraphRelease>(
+        MGraph);
+  releaseNodes(MNodes);
+}
+
+void command_graph_impl::beginRecording(const QueueImplPtr &Queue) {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  if (MRecordingQueue)
+    throw runtime_error("The command graph is already being recorded",
+                        PI_INVALID_OPERATION);
+  if (Queue->is_host())
+    throw feature_not_supported(
+        "Command graphs are not supported by the host queues",
+        PI_INVALID_OPERATION);
+  if (MContext && MContext != Queue->getContextImplPtr())
+    throw invalid_parameter_error(
+        "The queue must be in the context of the recorded command graph",
+        PI_INVALID_CONTEXT);
+
+  // The recorded commands must not depend on the ones submitted before.
+  Queue->wait();
+  // The backends which can't record their queues are recorded by the runtime
+  RT::PiResult Err = PI_INVALID_OPERATION;
+  if (Queue->getPlugin()
+          .getPiPlugin()
+          .PiFunctionTable.piextQueueBeginGraphCapture)
+    Err = Queue->getPlugin()
+              .call_nocheck<PiApiKind::piextQueueBeginGraphCapture>(
+                  Queue->getHandleRef());
+  MRecordingNodes = Err == PI_INVALID_OPERATION;
+  if (MRecordingNodes)
+    Queue->setRecordingGraph(this);
+  else
+    Queue->getPlugin().checkPiResult(Err);
+  MRecordingQueue = Queue;
+  MContext = Queue->getContextImplPtr();
+}
+
+void command_graph_impl::endRecording() {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  if (!MRecordingQueue)
+    throw runtime_error("The command graph is not being recorded",
+                        PI_INVALID_OPERATION);
+
+  QueueImplPtr Queue = std::move(MRecordingQueue);
+  if (MRecordingNodes) {
+    endNodesRecording(Queue);
+    return;
+  }
+  Queue->getPlugin().call<PiApiKind::piextQueueEndGraphCapture>(
+      Queue->getHandleRef(), &MGraph);
+}
+
+event command_graph_impl::replay(const QueueImplPtr &Queue,
+                                 const vector_class<event> &DepEvents) {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  if (!MGraph && !MNodesRecorded)
+    throw runtime_error("The command graph has not been recorded",
+                        PI_INVALID_OPERATION);
+  if (MContext != Queue->getContextImplPtr())
+    throw invalid_parameter_error(
+        "The queue must be in the context of the recorded command graph",
+        PI_INVALID_CONTEXT);
+
+  if (MNodesRecorded)
+    return replayNodes(Queue, DepEvents);
+  return Queue->enqueueCommandGraph(Queue, MGraph, DepEvents);
+}
+
+EventImplPtr command_graph_impl::record(std::unique_ptr<CG> CommandGroup) {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  if (!MRecordingQueue || !MRecordingNodes)
+    throw runtime_error("The command graph is not being recorded",
+                        PI_INVALID_OPERATION);
+
+  bool Recordable = CommandGroup->MRequirements.empty();
+  switch (CommandGroup->getType()) {
+  case CG::KERNEL:
+    Recordable = Recordable &&
+                 static_cast<CGExecKernel &>(*CommandGroup).MStreams.empty();
+    break;
+  case CG::COPY_USM:
+  case CG::FILL_USM:
+  case CG::COPY_USM_RECT:
+  case CG::FILL_USM_RECT:
+  case CG::PREFETCH_USM:
+    break;
+  default:
+    Recordable = false;
+  }
+  if (!Recordable)
+    throw feature_not_supported(
+        "Only kernels and USM operations without accessors or streams can be "
+        "recorded into a command graph",
+        PI_INVALID_OPERATION);
+
+  Node NewNode;
+  for (const EventImplPtr &Event : CommandGroup->MEvents) {
+    auto It = MNewNodeIndices.find(Event.get());
+    if (It != MNewNodeIndices.end()) {
+      NewNode.MDeps.push_back(It->second);
+      continue;
+    }
+    // The other dependencies are complete for all the replays once they are
+    // complete for the recording.
+    Event->wait(Event);
+  }
+  NewNode.MCommandGroup = std::move(CommandGroup);
+
+  EventImplPtr Event = makeEventImpl();
+  MNewNodeIndices[Event.get()] = MNewNodes.size();
+  MNewNodes.push_back(std::move(NewNode));
+  MNewEvents.push_back(Event);
+  return Event;
+}
+
+void command_graph_impl::endNodesRecording(const QueueImplPtr &Queue) {
+  Queue->setRecordingGraph(nullptr);
+  MNewEvents.clear();
+  MNewNodeIndices.clear();
+  std::vector<Node> NewNodes;
+  NewNodes.swap(MNewNodes);
+
+  // Recording the same sequence again only updates the arguments of the
+  // kernels.
+  std::vector<bool> HasUsers(NewNodes.size(), false);
+  try {
+    for (size_t I = 0; I < NewNodes.size(); ++I) {
+      Node &NewNode = NewNodes[I];
+      for (size_t Dep : NewNode.MDeps)
+        HasUsers[Dep] = true;
+      if (NewNode.MCommandGroup->getType() != CG::KERNEL)
+        continue;
+      if (I < MNodes.size())
+        std::swap(NewNode.MKernel, MNodes[I].MKernel);
+      prepareRecordedKernel(
+          Queue, static_cast<CGExecKernel &>(*NewNode.MCommandGroup),
+          NewNode.MKernel);
+    }
+  } catch (...) {
+    releaseNodes(NewNodes);
+    releaseNodes(MNodes);
+    MNodes.clear();
+    MSinks.clear();
+    MNodesRecorded = false;
+    throw;
+  }
+
+  releaseNodes(MNodes);
+  MNodes.swap(NewNodes);
+  MSinks.clear();
+  for (size_t I = 0; I < MNodes.size(); ++I)
+    if (!HasUsers[I])
+      MSinks.push_back(I);
+  MNodesRecorded = true;
+}
+
+event command_graph_impl::replayNodes(const QueueImplPtr &Queue,
+                                      const vector_class<event> &DepEvents) {
+  std::vector<RT::PiEvent> WaitList;
+  for (const event &DepEvent : DepEvents) {
+    const EventImplPtr &DepEventImpl = getSyclObjImpl(DepEvent);
+    if (DepEventImpl->is_host())
+      DepEventImpl->wait(DepEventImpl);
+    else
+      WaitList.push_back(DepEventImpl->getHandleRef());
+  }
+
+  const plugin &Plugin = Queue->getPlugin();
+  std::vector<RT::PiEvent> NodeEvents(MNodes.size(), nullptr);
+  auto ReleaseNodeEvents = [&]() {
+    for (RT::PiEvent Event : NodeEvents)
+      if (Event)
+        Plugin.call<PiApiKind::piEventRelease>(Event);
+  };
+
+  try {
+    for (size_t I = 0; I < MNodes.size(); ++I) {
+      Node &N = MNodes[I];
+      std::vector<RT::PiEvent> RawEvents;
+      if (N.MDeps.empty())
+        RawEvents = WaitList;
+      for (size_t Dep : N.MDeps)
+        RawEvents.push_back(NodeEvents[Dep]);
+
+      switch (N.MCommandGroup->getType()) {
+      case CG::KERNEL: {
+        if (CL_SUCCESS !=
+            launchRecordedKernel(Queue, N.MKernel, RawEvents, &NodeEvents[I]))
+          throw runtime_error("Enqueue process failed.",
+                              PI_INVALID_OPERATION);
+        break;
+      }
+      case CG::COPY_USM: {
+        CGCopyUSM *Copy = static_cast<CGCopyUSM *>(N.MCommandGroup.get());
+        MemoryManager::copy_usm(Copy->getSrc(), Queue, Copy->getLength(),
+                                Copy->getDst(), std::move(RawEvents),
+                                NodeEvents[I]);
+        break;
+      }
+      case CG::FILL_USM: {
+        CGFillUSM *Fill = static_cast<CGFillUSM *>(N.MCommandGroup.get());
+        MemoryManager::fill_usm(Fill->getDst(), Queue, Fill->getLength(),
+                                Fill->getFill(), std::move(RawEvents),
+                                NodeEvents[I]);
+        break;
+      }
+      case CG::COPY_USM_RECT: {
+        CGCopyUSMRect *Copy =
+            static_cast<CGCopyUSMRect *>(N.MCommandGroup.get());
+        MemoryManager::copy_usm_rect(Copy->getSrc(), Queue, Copy->getRect(),
+                                     Copy->getDst(), std::move(RawEvents),
+                                     NodeEvents[I]);
+        break;
+      }
+      case CG::FILL_USM_RECT: {
+        CGFillUSMRect *Fill =
+            static_cast<CGFillUSMRect *>(N.MCommandGroup.get());
+        MemoryManager::fill_usm_rect(Fill->getDst(), Queue, Fill->getRect(),
+                                     Fill->getPattern(), std::move(RawEvents),
+                                     NodeEvents[I]);
+        break;
+      }
+      case CG::PREFETCH_USM: {
+        CGPrefetchUSM *Prefetch =
+            static_cast<CGPrefetchUSM *>(N.MCommandGroup.get());
+        MemoryManager::prefetch_usm(Prefetch->getDst(), Queue,
+                                    Prefetch->getLength(),
+                                    std::move(RawEvents), NodeEvents[I]);
+        break;
+      }
+      default:
+        throw runtime_error("Unhandled type of recorded command group",
+                            PI_INVALID_OPERATION);
+      }
+    }
+  } catch (...) {
+    ReleaseNodeEvents();
+    throw;
+  }
+
+  // A single event stands for the whole replay
+  std::vector<RT::PiEvent> SinkEvents;
+  SinkEvents.reserve(MSinks.size());
+  for (size_t Sink : MSinks)
+    SinkEvents.push_back(NodeEvents[Sink]);
+  const std::vector<RT::PiEvent> &LastEvents =
+      MNodes.empty() ? WaitList : SinkEvents;
+  RT::PiEvent NativeEvent = nullptr;
+  RT::PiResult Err = Plugin.call_nocheck<PiApiKind::piEnqueueEventsWait>(
+      Queue->getHandleRef(), LastEvents.size(),
+      LastEvents.empty() ? nullptr : LastEvents.data(), &NativeEvent);
+  ReleaseNodeEvents();
+  Plugin.checkPiResult(Err);
+  return Queue->addNativeEvent(Queue, NativeEvent);
+}
+
+void command_graph_impl::releaseNodes(std::vector<Node> &Nodes) {
+  for (Node &N : Nodes)
+    releaseRecordedKernel(MContext, N.MKernel);
+}
+
+} // namespace detail
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -0,0 +1,100 @@
+//==------- command_graph_impl.hpp --- SYCL recorded command sequences -----==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl/detail/pi.hpp>
+#include <CL/sycl/event.hpp>
+#include <CL/sycl/stl.hpp>
+#include <detail/queue_impl.hpp>
+#include <detail/scheduler/commands.hpp>
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+
+/// Owner of the executable graph built by the plugin from the commands recorded
+/// from a queue, see ONEAPI::command_graph.
+///
+/// The backends which can't record their queues get a graph built by the
+/// runtime instead: the command groups submitted to the queue are kept
+/// together with their dependencies and their kernels are given arguments
+/// once, so that the replay only enqueues the commands.
+class command_graph_impl {
+public:
+  command_graph_impl() = default;
+  command_graph_impl(const command_graph_impl &) = delete;
+  command_graph_impl &operator=(const command_graph_impl &) = delete;
+  ~command_graph_impl();
+
+  void beginRecording(const QueueImplPtr &Queue);
+
+  void endRecording();
+
+  bool isRecorded() const {
+    std::lock_guard<std::mutex> Lock(MMutex);
+    return MGraph != nullptr || MNodesRecorded;
+  }
+
+  event replay(const QueueImplPtr &Queue, const vector_class<event> &DepEvents);
+
+  /// Records a command group submitted to the queue being recorded by the
+  /// runtime.
+  ///
+  /// \return an event standing for the command group, which may only be used
+  /// as a dependency of the other command groups of the recording.
+  EventImplPtr record(std::unique_ptr<CG> CommandGroup);
+
+private:
+  /// A command group recorded by the runtime.
+  struct Node {
+    std::unique_ptr<CG> MCommandGroup;
+    /// The indices of the nodes the command group depends on.
+    std::vector<size_t> MDeps;
+    /// The kernel of a kernel command group.
+    RecordedKernel MKernel;
+  };
+
+  /// Builds the nodes of the recording done by the runtime.
+  void endNodesRecording(const QueueImplPtr &Queue);
+
+  event replayNodes(const QueueImplPtr &Queue,
+                    const vector_class<event> &DepEvents);
+
+  /// Returns the kernels of the nodes to the kernel program cache.
+  void releaseNodes(std::vector<Node> &Nodes);
+
+  mutable std::mutex MMutex;
+  /// The queue being recorded, nullptr if there is no recording in progress.
+  QueueImplPtr MRecordingQueue;
+  /// The context all queues using the graph must belong to.
+  ContextImplPtr MContext;
+  RT::PiExtCommandGraph MGraph = nullptr;
+
+  /// True if the recording is done by the runtime.
+  bool MRecordingNodes = false;
+  /// The nodes of the last recording done by the runtime.
+  std::vector<Node> MNodes;
+  /// The indices of the nodes no other node depends on.
+  std::vector<size_t> MSinks;
+  bool MNodesRecorded = false;
+  /// The nodes of the recording in progress, and the events standing for
+  /// them, which are kept alive until the end of the recording.
+  std::vector<Node> MNewNodes;
+  std::vector<EventImplPtr> MNewEvents;
+  std::unordered_map<const event_impl *, size_t> MNewNodeIndices;
+};
+
+} // namespace detail
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -14,6 +14,7 @@
 #include <CL/sycl/detail/pi.hpp>
 #include <CL/sycl/info/info_desc.hpp>
 #include <detail/global_handler.hpp>
+#include <detail/work_group_size.hpp>
 
 #include <algorithm>
 #include <array>
@@ -166,6 +167,27 @@ public:
   }
 };
 
+template <> class SYCLConfig<SYCL_CACHE_PERSISTENT> {
+  using BaseT = SYCLConfigBase<SYCL_CACHE_PERSISTENT>;
+
+public:
+  static bool get() {
+    static bool Initialized = false;
+    // The persistent device code cache is disabled by default.
+    static bool Enabled = false;
+
+    // Configuration parameters are processed only once, like reading a string
+    // from environment and converting it into a typed object.
+    if (Initialized)
+      return Enabled;
+
+    const char *ValStr = BaseT::getRawValue();
+    Enabled = (ValStr && std::atoi(ValStr) != 0);
+    Initialized = true;
+    return Enabled;
+  }
+};
+
 template <> class SYCLConfig<SYCL_DEVICE_FILTER> {
   using BaseT = SYCLConfigBase<SYCL_DEVICE_FILTER>;
 
@@ -207,6 +229,42 @@ public:
   }
 };
 
+template <> class SYCLConfig<SYCL_WORK_GROUP_SIZE_POLICY> {
+  using BaseT = SYCLConfigBase<SYCL_WORK_GROUP_SIZE_POLICY>;
+
+public:
+  static WorkGroupSizePolicy get() {
+    static bool Initialized = false;
+    // The runtime chooses the local sizes by default.
+    static WorkGroupSizePolicy Policy = WorkGroupSizePolicy::occupancy;
+
+    // Configuration parameters are processed only once, like reading a string
+    // from environment and converting it into a typed object.
+    if (Initialized)
+      return Policy;
+
+    const char *ValStr = BaseT::getRawValue();
+    const std::array<std::pair<std::string, WorkGroupSizePolicy>, 3>
+        PolicyMap = {{{"driver", WorkGroupSizePolicy::driver},
+                      {"occupancy", WorkGroupSizePolicy::occupancy},
+                      {"autotune", WorkGroupSizePolicy::autotune}}};
+    if (ValStr) {
+      auto It = std::find_if(
+          std::begin(PolicyMap), std::end(PolicyMap),
+          [&ValStr](
+              const std::pair<std::string, WorkGroupSizePolicy> &Element) {
+            return Element.first == ValStr;
+          });
+      if (It == PolicyMap.end())
+        pi::die("Invalid work-group size policy. "
+                "Valid values are driver/occupancy/autotune");
+      Policy = It->second;
+    }
+    Initialized = true;
+    return Policy;
+  }
+};
+
 } // namespace detail
 } // namespace sycl
 } // __SYCL_INLINE_NAMESPACE(cl)
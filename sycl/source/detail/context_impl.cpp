@@ -17,6 +17,7 @@
 #include <CL/sycl/properties/context_properties.hpp>
 #include <CL/sycl/property_list.hpp>
 #include <CL/sycl/stl.hpp>
+#include <detail/config.hpp>
 #include <detail/context_impl.hpp>
 #include <detail/context_info.hpp>
 #include <detail/platform_impl.hpp>
@@ -30,6 +31,8 @@ context_impl::context_impl(const device &Device, async_handler AsyncHandler,
     : MAsyncHandler(AsyncHandler), MDevices(1, Device), MContext(nullptr),
       MPlatform(), MPropList(PropList), MHostContext(Device.is_host()) {
   MKernelProgramCache.setContextPtr(this);
+  if (MHostStagingRing.isEnabled())
+    MHostStagingRing.setNumaNode(getNumaNode());
 }
 
 context_impl::context_impl(const vector_class<cl::sycl::device> Devices,
@@ -65,6 +68,8 @@ context_impl::context_impl(const vector_class<cl::sycl::device> Devices,
   }
 
   MKernelProgramCache.setContextPtr(this);
+  if (MHostStagingRing.isEnabled())
+    MHostStagingRing.setNumaNode(getNumaNode());
 }
 
 context_impl::context_impl(RT::PiContext PiContext, async_handler AsyncHandler,
@@ -98,6 +103,8 @@ context_impl::context_impl(RT::PiContext PiContext, async_handler AsyncHandler,
   // care of when creating device object.
   getPlugin().call<PiApiKind::piContextRetain>(MContext);
   MKernelProgramCache.setContextPtr(this);
+  if (MHostStagingRing.isEnabled())
+    MHostStagingRing.setNumaNode(getNumaNode());
 }
 
 cl_context context_impl::get() const {
@@ -113,12 +120,28 @@ cl_context context_impl::get() const {
 
 bool context_impl::is_host() const { return MHostContext; }
 
+int context_impl::getNumaNode() const {
+  int Node = -1;
+  for (const device &Device : MDevices) {
+    const int DeviceNode = getSyclObjImpl(Device)->getNumaNode();
+    if (DeviceNode < 0 || (Node >= 0 && DeviceNode != Node))
+      return -1;
+    Node = DeviceNode;
+  }
+  return Node;
+}
+
 context_impl::~context_impl() {
   for (auto LibProg : MCachedLibPrograms) {
     assert(LibProg.second && "Null program must not be kept in the cache");
     getPlugin().call<PiApiKind::piProgramRelease>(LibProg.second);
   }
   if (!MHostContext) {
+    MUSMHostPool.release(getPlugin(), MContext);
+    MHostStagingRing.release(getPlugin(), MContext);
+    MHostMemoryImports.releaseAll([this](const void *Ptr) {
+      getPlugin().call_nocheck<PiApiKind::piextUSMRelease>(Ptr, MContext);
+    });
     // TODO catch an exception and put it to list of asynchronous exceptions
     getPlugin().call<PiApiKind::piContextRelease>(MContext);
   }
@@ -146,9 +169,48 @@ context_impl::get_info<info::context::devices>() const {
   return MDevices;
 }
 
+template <>
+ONEAPI::memory_usage
+context_impl::get_info<info::context::ext_oneapi_memory_usage>() const {
+  return MMemoryUsage.getUsage(MUSMHostPool.getCachedSize());
+}
+
 RT::PiContext &context_impl::getHandleRef() { return MContext; }
 const RT::PiContext &context_impl::getHandleRef() const { return MContext; }
 
+bool context_impl::reserveMemory(size_t Size) {
+  if (MMemoryUsage.fits(Size, MUSMHostPool.getCachedSize()))
+    return true;
+  if (MHostContext)
+    return false;
+  MUSMHostPool.trim(getPlugin(), MContext);
+  return MMemoryUsage.fits(Size, MUSMHostPool.getCachedSize());
+}
+
+bool context_impl::importHostMemory(const void *Owner, const void *Ptr,
+                                    size_t Size) {
+  if (MHostContext || hasHostUnifiedMemory() ||
+      !getPlugin().getPiPlugin().PiFunctionTable.piextUSMImport)
+    return false;
+  static const bool Disabled =
+      SYCLConfig<SYCL_DISABLE_HOST_PTR_IMPORT>::get() != nullptr;
+  if (Disabled)
+    return false;
+  return MHostMemoryImports.acquire(
+      Owner, Ptr, Size, [this](const void *Begin, size_t Length) {
+        return getPlugin().call_nocheck<PiApiKind::piextUSMImport>(
+                   Begin, Length, MContext) == PI_SUCCESS;
+      });
+}
+
+void context_impl::releaseHostMemoryImport(const void *Owner) {
+  if (MHostContext)
+    return;
+  MHostMemoryImports.release(Owner, [this](const void *Ptr) {
+    getPlugin().call_nocheck<PiApiKind::piextUSMRelease>(Ptr, MContext);
+  });
+}
+
 KernelProgramCache &context_impl::getKernelProgramCache() const {
   return MKernelProgramCache;
 }
@@ -161,6 +223,37 @@ context_impl::hasDevice(shared_ptr_class<detail::device_impl> Device) const {
   return false;
 }
 
+bool context_impl::hasHostUnifiedMemory() const {
+  std::call_once(MHostUnifiedMemoryFlag, [this]() {
+    MHostUnifiedMemory = true;
+    for (const device &Device : MDevices)
+      MHostUnifiedMemory &=
+          Device.get_info<info::device::host_unified_memory>();
+  });
+  return MHostUnifiedMemory;
+}
+
+void context_impl::beginPrebuild() {
+  std::lock_guard<std::mutex> Lock(MPrebuildMutex);
+  ++MPendingPrebuilds;
+}
+
+void context_impl::endPrebuild() {
+  std::lock_guard<std::mutex> Lock(MPrebuildMutex);
+  if (--MPendingPrebuilds == 0)
+    MPrebuildFinished.notify_all();
+}
+
+void context_impl::waitForPrebuild() {
+  std::unique_lock<std::mutex> Lock(MPrebuildMutex);
+  MPrebuildFinished.wait(Lock, [this]() { return MPendingPrebuilds == 0; });
+}
+
+bool context_impl::isPrebuildComplete() {
+  std::lock_guard<std::mutex> Lock(MPrebuildMutex);
+  return MPendingPrebuilds == 0;
+}
+
 pi_native_handle context_impl::getNative() const {
   auto Plugin = getPlugin();
   pi_native_handle Handle;
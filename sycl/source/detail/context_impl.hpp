@@ -14,13 +14,21 @@
 #include <CL/sycl/info/info_desc.hpp>
 #include <CL/sycl/property_list.hpp>
 #include <CL/sycl/stl.hpp>
+#include <detail/built_program_bundle.hpp>
 #include <detail/device_impl.hpp>
+#include <detail/host_memory_imports.hpp>
+#include <detail/host_staging_ring.hpp>
 #include <detail/kernel_program_cache.hpp>
+#include <detail/memory_usage_tracker.hpp>
 #include <detail/platform_impl.hpp>
 #include <detail/program_manager/program_manager.hpp>
+#include <detail/usm/usm_host_pool.hpp>
 
+#include <condition_variable>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <tuple>
 
 __SYCL_INLINE_NAMESPACE(cl) {
 namespace sycl {
@@ -149,19 +157,83 @@ public:
   ///  etc.
   ///
   /// See `doc/extensions/C-CXX-StandardLibrary/DeviceLibExtensions.rst' for
-  /// more details.
+  /// more details. The programs are keyed by extension, by whether they are
+  /// the fast math variant of the library, and by device.
   ///
-  /// \returns a map with device library programs.
-  std::map<std::pair<DeviceLibExt, RT::PiDevice>, RT::PiProgram> &
+  /// \returns a map with device library programs. Accesses to the map must
+  /// be guarded by getCachedLibProgramsMutex().
+  std::map<std::tuple<DeviceLibExt, bool, RT::PiDevice>, RT::PiProgram> &
   getCachedLibPrograms() {
     return MCachedLibPrograms;
   }
 
+  std::mutex &getCachedLibProgramsMutex() { return MCachedLibProgramsMutex; }
+
   KernelProgramCache &getKernelProgramCache() const;
 
   /// Returns true if and only if context contains the given device.
   bool hasDevice(shared_ptr_class<detail::device_impl> Device) const;
 
+  /// Returns true if all devices of the context share the memory with the
+  /// host, see info::device::host_unified_memory. Memory objects of such
+  /// contexts are allocated in host accessible memory, so host accessors don't
+  /// need to copy the data.
+  ///
+  /// The value is queried once and then cached.
+  bool hasHostUnifiedMemory() const;
+
+  /// Registers a build started by ONEAPI::prebuild_all.
+  void beginPrebuild();
+
+  /// Marks a build started by ONEAPI::prebuild_all as finished.
+  void endPrebuild();
+
+  /// Blocks until all builds started by ONEAPI::prebuild_all are finished.
+  void waitForPrebuild();
+
+  /// \return true if no builds started by ONEAPI::prebuild_all are running.
+  bool isPrebuildComplete();
+
+  /// Returns the pool which caches USM host allocations freed by sycl::free.
+  USMHostPool &getUSMHostPool() { return MUSMHostPool; }
+
+  /// Returns the ring of pinned memory large copies between pageable host
+  /// memory and buffers go through.
+  HostStagingRing &getHostStagingRing() { return MHostStagingRing; }
+
+  /// \return the NUMA node all the devices of the context are attached to, or
+  /// -1 if they are attached to different ones or it is unknown.
+  int getNumaNode() const;
+
+  /// Registers [Ptr, Ptr + Size) with the plugin for \p Owner, so that the
+  /// copies between the range and the devices run at the speed of pinned
+  /// memory. Nothing is registered for the contexts whose devices access the
+  /// host memory anyway, nor if SYCL_DISABLE_HOST_PTR_IMPORT is set.
+  ///
+  /// \return true if the range is registered.
+  bool importHostMemory(const void *Owner, const void *Ptr, size_t Size);
+
+  /// Releases the registration made for \p Owner, if any.
+  void releaseHostMemoryImport(const void *Owner);
+
+  /// \return true if [Ptr, Ptr + Size) is registered with the plugin.
+  bool isHostMemoryImported(const void *Ptr, size_t Size) const {
+    return MHostMemoryImports.contains(Ptr, Size);
+  }
+
+  /// Returns the native binaries imported by ONEAPI::import_built_programs,
+  /// which are used instead of building the programs they are built from.
+  BuiltProgramBundle &getImportedPrograms() { return MImportedPrograms; }
+
+  /// Returns the accounting of the memory allocated in the context.
+  MemoryUsageTracker &getMemoryUsage() { return MMemoryUsage; }
+
+  /// Checks that \p Size more bytes fit under the memory limit of the
+  /// context. The blocks cached by the USM host pool are freed if they don't.
+  ///
+  /// \return false if the allocation would exceed the limit.
+  bool reserveMemory(size_t Size);
+
   /// Gets the native handle of the SYCL context.
   ///
   /// \return a native handle.
@@ -174,9 +246,20 @@ private:
   PlatformImplPtr MPlatform;
   property_list MPropList;
   bool MHostContext;
-  std::map<std::pair<DeviceLibExt, RT::PiDevice>, RT::PiProgram>
+  std::map<std::tuple<DeviceLibExt, bool, RT::PiDevice>, RT::PiProgram>
       MCachedLibPrograms;
+  std::mutex MCachedLibProgramsMutex;
+  std::mutex MPrebuildMutex;
+  std::condition_variable MPrebuildFinished;
+  size_t MPendingPrebuilds = 0;
   mutable KernelProgramCache MKernelProgramCache;
+  USMHostPool MUSMHostPool;
+  HostStagingRing MHostStagingRing;
+  HostMemoryImports MHostMemoryImports;
+  MemoryUsageTracker MMemoryUsage;
+  BuiltProgramBundle MImportedPrograms;
+  mutable std::once_flag MHostUnifiedMemoryFlag;
+  mutable bool MHostUnifiedMemory = false;
 };
 
 } // namespace detail
@@ -7,15 +7,130 @@
 //===----------------------------------------------------------------------===//
 
 #include <CL/sycl/detail/pi.hpp>
+#include <CL/sycl/exception.hpp>
 
+#include <cstdint>
+#include <cstring>
 #include <memory>
 
 #include <CL/sycl/detail/device_binary_image.hpp>
 
+#ifdef SYCL_RT_ZLIB_AVAILABLE
+#include <zlib.h>
+#endif
+
+#ifdef __SYCL_RT_OS_LINUX
+#include <link.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 __SYCL_INLINE_NAMESPACE(cl) {
 namespace sycl {
 namespace detail {
 
+#ifdef __SYCL_RT_OS_LINUX
+namespace {
+struct ReadOnlySegmentQuery {
+  uintptr_t Begin; // in
+  uintptr_t End;   // in
+  bool Found;      // out
+};
+} // namespace
+
+static int findReadOnlySegment(struct dl_phdr_info *Info, size_t,
+                               void *Data) {
+  auto Query = reinterpret_cast<ReadOnlySegmentQuery *>(Data);
+  for (int I = 0; I < Info->dlpi_phnum; ++I) {
+    const ElfW(Phdr) &Segment = Info->dlpi_phdr[I];
+    // Only the file contents of the segments never written to, relocations
+    // included, are guaranteed to be read back unchanged.
+    if (Segment.p_type != PT_LOAD || (Segment.p_flags & PF_W))
+      continue;
+    uintptr_t SegBegin = Info->dlpi_addr + Segment.p_vaddr;
+    uintptr_t SegEnd = SegBegin + Segment.p_filesz;
+    if (Query->Begin >= SegBegin && Query->End <= SegEnd) {
+      Query->Found = true;
+      return 1;
+    }
+  }
+  return 0;
+}
+#endif // __SYCL_RT_OS_LINUX
+
+/// Drops the whole pages within [Begin, End) from the resident memory if they
+/// belong to a read-only segment of a loaded module.
+static void releaseModulePages(const unsigned char *Begin,
+                               const unsigned char *End) {
+#ifdef __SYCL_RT_OS_LINUX
+  static const uintptr_t PageSize = sysconf(_SC_PAGESIZE);
+  uintptr_t PagesBegin =
+      (reinterpret_cast<uintptr_t>(Begin) + PageSize - 1) & ~(PageSize - 1);
+  uintptr_t PagesEnd = reinterpret_cast<uintptr_t>(End) & ~(PageSize - 1);
+  if (PagesBegin >= PagesEnd)
+    return;
+  ReadOnlySegmentQuery Query{PagesBegin, PagesEnd, false};
+  dl_iterate_phdr(findReadOnlySegment, &Query);
+  // The pages of the heap or of the writable segments would be lost.
+  if (Query.Found)
+    madvise(reinterpret_cast<void *>(PagesBegin), PagesEnd - PagesBegin,
+            MADV_DONTNEED);
+#else
+  (void)Begin;
+  (void)End;
+#endif // __SYCL_RT_OS_LINUX
+}
+
+void RTDeviceBinaryImage::prepare() {
+  if (!Prepared) {
+    init(Bin);
+    Prepared = true;
+  }
+  decompress();
+}
+
+void RTDeviceBinaryImage::decompress() {
+  if (!isCompressed())
+    return;
+#ifdef SYCL_RT_ZLIB_AVAILABLE
+  pi_uint32 Size = 0;
+  for (const auto &Prop : getCompressedImageInfo())
+    if (std::strcmp(Prop->Name, "UncompressedSize") == 0)
+      Size = pi::DeviceBinaryProperty(Prop).asUint32();
+
+  std::unique_ptr<unsigned char[]> Data(new unsigned char[Size]);
+  uLongf DataSize = Size;
+  if (Size == 0 ||
+      ::uncompress(Data.get(), &DataSize, Bin->BinaryStart, getSize()) !=
+          Z_OK ||
+      DataSize != Size)
+    throw runtime_error("Failed to decompress device image",
+                        PI_INVALID_BINARY);
+
+  // The original descriptor is a part of the loaded executable image and can't
+  // be modified, so a copy pointing to the decompressed data is used instead.
+  DecompressedData = std::move(Data);
+  DecompressedBin = *Bin;
+  DecompressedBin.BinaryStart = DecompressedData.get();
+  DecompressedBin.BinaryEnd = DecompressedBin.BinaryStart + Size;
+  // The compressed data is not needed anymore.
+  releaseModulePages(Bin->BinaryStart, Bin->BinaryEnd);
+  Bin = &DecompressedBin;
+  if (Format == PI_DEVICE_BINARY_TYPE_NONE)
+    Format = pi::getBinaryImageFormat(Bin->BinaryStart, Size);
+#else
+  throw runtime_error("Compressed device images are not supported, the SYCL "
+                      "runtime is built without zlib",
+                      PI_INVALID_BINARY);
+#endif
+}
+
+void RTDeviceBinaryImage::releaseData() const {
+  // The decompressed data lives in the heap.
+  if (!DecompressedData)
+    releaseModulePages(Bin->BinaryStart, Bin->BinaryEnd);
+}
+
 DynRTDeviceBinaryImage::DynRTDeviceBinaryImage(
     std::unique_ptr<char[]> &&DataPtr, size_t DataSize, OSModuleHandle M)
     : RTDeviceBinaryImage(M) {
@@ -40,6 +155,7 @@ DynRTDeviceBinaryImage::DynRTDeviceBinaryImage(
     Bin->DeviceTargetSpec = __SYCL_PI_DEVICE_BINARY_TARGET_UNKNOWN;
   }
   init(Bin);
+  Prepared = true;
 }
 
 DynRTDeviceBinaryImage::~DynRTDeviceBinaryImage() {
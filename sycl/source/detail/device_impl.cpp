@@ -7,7 +7,9 @@
 //===----------------------------------------------------------------------===//
 
 #include <CL/sycl/device.hpp>
+#include <detail/config.hpp>
 #include <detail/device_impl.hpp>
+#include <detail/numa.hpp>
 #include <detail/platform_impl.hpp>
 
 #include <algorithm>
@@ -109,9 +111,11 @@ bool device_impl::has_extension(const string_class &ExtensionName) const {
     // TODO: implement extension management for host device;
     return false;
 
-  string_class AllExtensionNames =
-      get_device_info<string_class, info::device::extensions>::get(
-          this->getHandleRef(), this->getPlugin());
+  const string_class &AllExtensionNames = MInfoCache.get<string_class>(
+      DeviceInfoSlot::extensions_string, [this]() {
+        return get_device_info<string_class, info::device::extensions>::get(
+            this->getHandleRef(), this->getPlugin());
+      });
   return (AllExtensionNames.find(ExtensionName) != std::string::npos);
 }
 
@@ -215,6 +219,31 @@ pi_native_handle device_impl::getNative() const {
   return Handle;
 }
 
+int device_impl::getNumaNode() const {
+  int Node = MNumaNode.load(std::memory_order_relaxed);
+  if (Node != NumaNodeUnqueried)
+    return Node;
+
+  Node = -1;
+  if (!MIsHostDevice && !SYCLConfig<SYCL_DISABLE_NUMA_PLACEMENT>::get()) {
+    const plugin &Plugin = getPlugin();
+    size_t Size = 0;
+    if (Plugin.call_nocheck<PiApiKind::piDeviceGetInfo>(
+            MDevice, PI_DEVICE_INFO_PCI_ADDRESS, 0, nullptr, &Size) ==
+            PI_SUCCESS &&
+        Size > 0) {
+      std::string Address(Size, '\0');
+      if (Plugin.call_nocheck<PiApiKind::piDeviceGetInfo>(
+              MDevice, PI_DEVICE_INFO_PCI_ADDRESS, Size, &Address[0],
+              nullptr) == PI_SUCCESS)
+        Node = getPciDeviceNumaNode(Address.c_str());
+    }
+  }
+  // Racing threads find the same node.
+  MNumaNode.store(Node, std::memory_order_relaxed);
+  return Node;
+}
+
 bool device_impl::has(aspect Aspect) const {
   size_t return_size = 0;
   pi_device_type device_type;
@@ -12,8 +12,10 @@
 #include <CL/sycl/detail/pi.hpp>
 #include <CL/sycl/stl.hpp>
 #include <detail/device_info.hpp>
+#include <detail/device_info_cache.hpp>
 #include <detail/platform_impl.hpp>
 
+#include <atomic>
 #include <memory>
 
 __SYCL_INLINE_NAMESPACE(cl) {
@@ -190,9 +192,16 @@ public:
     if (is_host()) {
       return get_device_info_host<param>();
     }
-    return get_device_info<
-        typename info::param_traits<info::device, param>::return_type,
-        param>::get(this->getHandleRef(), this->getPlugin());
+    using ReturnT =
+        typename info::param_traits<info::device, param>::return_type;
+    auto Compute = [this]() {
+      return get_device_info<ReturnT, param>::get(this->getHandleRef(),
+                                                  this->getPlugin());
+    };
+    constexpr DeviceInfoSlot Slot = getDeviceInfoSlot(param);
+    if (Slot != DeviceInfoSlot::num_slots)
+      return MInfoCache.get<ReturnT>(Slot, Compute);
+    return Compute();
   }
 
   /// Check if affinity partitioning by specified domain is supported by
@@ -217,6 +226,11 @@ public:
   /// \return true if the SYCL device has the given feature.
   bool has(aspect Aspect) const;
 
+  /// \return the NUMA node of the host the device is attached to, or -1 if it
+  /// is unknown, e.g. for the host device, without the PCI address of the
+  /// device or with SYCL_DISABLE_NUMA_PLACEMENT set.
+  int getNumaNode() const;
+
   /// Gets the single instance of the Host Device
   ///
   /// \return the host device_impl singleton
@@ -230,6 +244,10 @@ private:
   bool MIsRootDevice = false;
   bool MIsHostDevice;
   PlatformImplPtr MPlatform;
+  mutable DeviceInfoCache MInfoCache;
+  /// The NUMA node of the device, NumaNodeUnqueried until it is queried.
+  static constexpr int NumaNodeUnqueried = -2;
+  mutable std::atomic<int> MNumaNode{NumaNodeUnqueried};
 }; // class device_impl
 
 } // namespace detail
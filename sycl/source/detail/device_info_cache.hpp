@@ -0,0 +1,127 @@
+//===-- device_info_cache.hpp - Cache of immutable device info --*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl/detail/defines.hpp>
+#include <CL/sycl/info/info_desc.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+
+/// The device info which is cached by device_impl. These queries are made by
+/// the runtime and by library code on the submission path, and their values
+/// never change for a device.
+enum class DeviceInfoSlot : size_t {
+  max_compute_units,
+  max_work_item_sizes,
+  max_work_group_size,
+  max_num_sub_groups,
+  sub_group_sizes,
+  local_mem_size,
+  max_mem_alloc_size,
+  global_mem_size,
+  extensions,
+  extensions_string,
+  name,
+  vendor,
+  usm_device_allocations,
+  usm_host_allocations,
+  usm_shared_allocations,
+  num_slots
+};
+
+/// \return the slot of the device info, or DeviceInfoSlot::num_slots if it is
+/// not cached.
+constexpr DeviceInfoSlot getDeviceInfoSlot(info::device Param) {
+  switch (Param) {
+  case info::device::max_compute_units:
+    return DeviceInfoSlot::max_compute_units;
+  case info::device::max_work_item_sizes:
+    return DeviceInfoSlot::max_work_item_sizes;
+  case info::device::max_work_group_size:
+    return DeviceInfoSlot::max_work_group_size;
+  case info::device::max_num_sub_groups:
+    return DeviceInfoSlot::max_num_sub_groups;
+  case info::device::sub_group_sizes:
+    return DeviceInfoSlot::sub_group_sizes;
+  case info::device::local_mem_size:
+    return DeviceInfoSlot::local_mem_size;
+  case info::device::max_mem_alloc_size:
+    return DeviceInfoSlot::max_mem_alloc_size;
+  case info::device::global_mem_size:
+    return DeviceInfoSlot::global_mem_size;
+  case info::device::extensions:
+    return DeviceInfoSlot::extensions;
+  case info::device::name:
+    return DeviceInfoSlot::name;
+  case info::device::vendor:
+    return DeviceInfoSlot::vendor;
+  case info::device::usm_device_allocations:
+    return DeviceInfoSlot::usm_device_allocations;
+  case info::device::usm_host_allocations:
+    return DeviceInfoSlot::usm_host_allocations;
+  case info::device::usm_shared_allocations:
+    return DeviceInfoSlot::usm_shared_allocations;
+  default:
+    return DeviceInfoSlot::num_slots;
+  }
+}
+
+/// Values computed on their first query and then read without locks.
+///
+/// Concurrent first queries may all compute the value, only one of the
+/// results is kept.
+class DeviceInfoCache {
+public:
+  DeviceInfoCache() = default;
+  DeviceInfoCache(const DeviceInfoCache &) = delete;
+  DeviceInfoCache &operator=(const DeviceInfoCache &) = delete;
+
+  ~DeviceInfoCache() {
+    for (size_t I = 0; I < NumSlots; ++I)
+      if (void *Value = MValues[I].load(std::memory_order_relaxed))
+        MDeleters[I](Value);
+  }
+
+  /// \return the value of the slot, computed by Compute if the slot is empty.
+  /// The type of the value must be the same for all the queries of a slot.
+  template <typename T, typename ComputeT>
+  const T &get(DeviceInfoSlot Slot, ComputeT Compute) {
+    const size_t Index = static_cast<size_t>(Slot);
+    void *Value = MValues[Index].load(std::memory_order_acquire);
+    if (Value)
+      return *static_cast<const T *>(Value);
+
+    std::unique_ptr<T> NewValue(new T(Compute()));
+    void *Expected = nullptr;
+    if (!MValues[Index].compare_exchange_strong(
+            Expected, NewValue.get(), std::memory_order_acq_rel,
+            std::memory_order_acquire))
+      return *static_cast<const T *>(Expected);
+    // Only read by the destructor, after all the queries
+    MDeleters[Index] = [](void *Ptr) { delete static_cast<T *>(Ptr); };
+    return *NewValue.release();
+  }
+
+private:
+  static constexpr size_t NumSlots =
+      static_cast<size_t>(DeviceInfoSlot::num_slots);
+
+  std::atomic<void *> MValues[NumSlots] = {};
+  void (*MDeleters[NumSlots])(void *) = {};
+};
+
+} // namespace detail
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
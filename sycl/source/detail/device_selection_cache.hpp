@@ -0,0 +1,103 @@
+//==--- device_selection_cache.hpp - Cache of platforms, devices, contexts -==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl/device.hpp>
+#include <CL/sycl/info/info_desc.hpp>
+#include <CL/sycl/platform.hpp>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+
+class context_impl;
+class device_impl;
+
+/// Keeps what queue construction needs and never changes while the plugins
+/// are loaded: the platforms and devices found, the devices chosen by the
+/// built-in selectors, and the default contexts of the devices.
+///
+/// The values are computed on first use by the functions passed to the
+/// getters, with a lock held for every kind of value. Failures are not
+/// cached.
+class DeviceSelectionCache {
+public:
+  /// \return the platforms enumerated by Enumerate on the first call.
+  template <typename EnumerateT>
+  std::vector<platform> getPlatforms(EnumerateT Enumerate) {
+    std::lock_guard<std::mutex> Lock(MPlatformsMutex);
+    if (!MPlatformsEnumerated) {
+      MPlatforms = Enumerate();
+      MPlatformsEnumerated = true;
+    }
+    return MPlatforms;
+  }
+
+  /// \return the devices of DeviceType enumerated by Enumerate on the first
+  /// call for the type.
+  template <typename EnumerateT>
+  std::vector<device> getDevices(info::device_type DeviceType,
+                                 EnumerateT Enumerate) {
+    std::lock_guard<std::mutex> Lock(MDevicesMutex);
+    auto It = MDevices.find(DeviceType);
+    if (It == MDevices.end())
+      It = MDevices.emplace(DeviceType, Enumerate()).first;
+    return It->second;
+  }
+
+  /// \return the device chosen by Select on the first call for Selector,
+  /// which identifies a selector whose choice only depends on the devices.
+  template <typename SelectT>
+  device getSelectedDevice(const std::string &Selector, SelectT Select) {
+    std::lock_guard<std::mutex> Lock(MSelectionsMutex);
+    auto It = MSelections.find(Selector);
+    if (It == MSelections.end())
+      It = MSelections.emplace(Selector, Select()).first;
+    return It->second;
+  }
+
+  /// \return the default context of Device, made by Create on the first call
+  /// for the device.
+  template <typename CreateT>
+  std::shared_ptr<context_impl>
+  getDefaultContext(const std::shared_ptr<device_impl> &Device,
+                    CreateT Create) {
+    std::lock_guard<std::mutex> Lock(MContextsMutex);
+    std::shared_ptr<context_impl> &Context = MDefaultContexts[Device];
+    if (!Context)
+      Context = Create();
+    return Context;
+  }
+
+private:
+  std::mutex MPlatformsMutex;
+  bool MPlatformsEnumerated = false;
+  std::vector<platform> MPlatforms;
+
+  std::mutex MDevicesMutex;
+  std::map<info::device_type, std::vector<device>> MDevices;
+
+  std::mutex MSelectionsMutex;
+  std::unordered_map<std::string, device> MSelections;
+
+  std::mutex MContextsMutex;
+  std::map<std::shared_ptr<device_impl>, std::shared_ptr<context_impl>>
+      MDefaultContexts;
+};
+
+} // namespace detail
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
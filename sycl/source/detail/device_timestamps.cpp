@@ -0,0 +1,147 @@
+//==------- device_timestamps.cpp --- Device execution time reporting ------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/device_timestamps.hpp>
+#include <detail/kernel_stats.hpp>
+#include <detail/plugin.hpp>
+
+#include <algorithm>
+#include <chrono>
+
+#ifdef XPTI_ENABLE_INSTRUMENTATION
+#include "xpti_trace_framework.hpp"
+#endif
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+#ifdef XPTI_ENABLE_INSTRUMENTATION
+extern xpti::trace_event_data_t *GSYCLGraphEvent;
+#endif
+
+DeviceTimestampPoller::~DeviceTimestampPoller() {
+  {
+    std::lock_guard<std::mutex> Lock(MMutex);
+    MStop = true;
+  }
+  MCondition.notify_one();
+  if (MThread.joinable())
+    MThread.join();
+  // The commands still running at exit are not reported. The sampled kernel
+  // launches which completed since the last poll are still recorded.
+  for (const PendingCommand &Command : MPending)
+    if (!Command.KernelStats || !poll(Command))
+      Command.Plugin->call_nocheck<PiApiKind::piEventRelease>(Command.Event);
+}
+
+bool DeviceTimestampPoller::isEnabled() {
+#ifdef XPTI_ENABLE_INSTRUMENTATION
+  return xptiCheckTraceEnabled(xptiRegisterStream(SYCL_STREAM_NAME),
+                               xpti::trace_metadata);
+#else
+  return false;
+#endif
+}
+
+uint64_t DeviceTimestampPoller::hostTime() {
+  // The clock of xptiQueryNotificationTime()
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void DeviceTimestampPoller::add(const plugin &Plugin, RT::PiEvent Event,
+                                void *TraceEvent, uint64_t Instance,
+                                uint8_t StreamID, uint64_t HostQueuedTime) {
+  add({&Plugin, Event, TraceEvent, Instance, StreamID, HostQueuedTime,
+       nullptr});
+}
+
+void DeviceTimestampPoller::add(const plugin &Plugin, RT::PiEvent Event,
+                                KernelStatsEntry &Stats) {
+  add({&Plugin, Event, nullptr, 0, 0, 0, &Stats});
+}
+
+void DeviceTimestampPoller::add(const PendingCommand &Command) {
+  Command.Plugin->call<PiApiKind::piEventRetain>(Command.Event);
+  {
+    std::lock_guard<std::mutex> Lock(MMutex);
+    MPending.push_back(Command);
+    if (!MThread.joinable())
+      MThread = std::thread([this] { run(); });
+  }
+  MCondition.notify_one();
+}
+
+bool DeviceTimestampPoller::poll(const PendingCommand &Command) {
+  const plugin &Plugin = *Command.Plugin;
+  pi_int32 Status = PI_EVENT_COMPLETE;
+  RT::PiResult Error = Plugin.call_nocheck<PiApiKind::piEventGetInfo>(
+      Command.Event, PI_EVENT_INFO_COMMAND_EXECUTION_STATUS, sizeof(Status),
+      &Status, nullptr);
+  // Commands that failed are dropped too
+  if (Error == PI_SUCCESS && Status > PI_EVENT_COMPLETE)
+    return false;
+
+  uint64_t Queued = 0, Start = 0, End = 0;
+  if (Error == PI_SUCCESS && Status == PI_EVENT_COMPLETE &&
+      Plugin.call_nocheck<PiApiKind::piEventGetProfilingInfo>(
+          Command.Event, PI_PROFILING_INFO_COMMAND_QUEUED, sizeof(Queued),
+          &Queued, nullptr) == PI_SUCCESS &&
+      Plugin.call_nocheck<PiApiKind::piEventGetProfilingInfo>(
+          Command.Event, PI_PROFILING_INFO_COMMAND_START, sizeof(Start), &Start,
+          nullptr) == PI_SUCCESS &&
+      Plugin.call_nocheck<PiApiKind::piEventGetProfilingInfo>(
+          Command.Event, PI_PROFILING_INFO_COMMAND_END, sizeof(End), &End,
+          nullptr) == PI_SUCCESS) {
+    if (Command.KernelStats) {
+      // This thread is the single writer of the histogram
+      if (End >= Start)
+        Command.KernelStats->DeviceTime.record(End - Start);
+    } else {
+#ifdef XPTI_ENABLE_INSTRUMENTATION
+      // Both clocks count nanoseconds, so the device times are moved by the
+      // offset between the two records of the time the command was queued at
+      uint64_t Offset = Command.HostQueuedTime - Queued;
+      xpti::device_timestamps_t Timestamps{Command.HostQueuedTime,
+                                           Start + Offset, End + Offset};
+      xptiNotifySubscribers(
+          Command.StreamID, xpti::trace_metadata, GSYCLGraphEvent,
+          static_cast<xpti::trace_event_data_t *>(Command.TraceEvent),
+          Command.Instance, static_cast<const void *>(&Timestamps));
+#endif
+    }
+  }
+  Plugin.call_nocheck<PiApiKind::piEventRelease>(Command.Event);
+  return true;
+}
+
+void DeviceTimestampPoller::run() {
+  std::vector<PendingCommand> Polled;
+  std::unique_lock<std::mutex> Lock(MMutex);
+  while (true) {
+    MCondition.wait(Lock, [this] { return MStop || !MPending.empty(); });
+    if (MStop)
+      return;
+    // Poll without the lock, so that submissions are not held up
+    Polled.swap(MPending);
+    Lock.unlock();
+    Polled.erase(std::remove_if(Polled.begin(), Polled.end(), poll),
+                 Polled.end());
+    Lock.lock();
+    // Keep the submission order, the oldest commands complete first
+    MPending.insert(MPending.begin(), Polled.begin(), Polled.end());
+    Polled.clear();
+    if (!MPending.empty())
+      MCondition.wait_for(Lock, std::chrono::milliseconds(1),
+                          [this] { return MStop; });
+  }
+}
+} // namespace detail
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
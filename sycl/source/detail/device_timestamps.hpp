@@ -0,0 +1,96 @@
+//==------- device_timestamps.hpp --- Device execution time reporting ------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl/detail/pi.hpp>
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+class plugin;
+struct KernelStatsEntry;
+
+/// Reports the device execution times of the commands to the XPTI
+/// subscribers.
+///
+/// A subscriber asks for the times by registering a callback for the metadata
+/// trace point type of the SYCL stream; the runtime then creates its queues
+/// with profiling enabled, whatever the queue properties the user gave. Once a
+/// command completes, a metadata notification is sent for the trace event of
+/// the command with an xpti::device_timestamps_t as user data.
+///
+/// The events are polled from a thread of their own, so neither the
+/// submission nor the completion of the commands waits for the profiling
+/// queries. The device clock is correlated to the host clock through the time
+/// each command is queued at, which both the host and the device record.
+///
+/// The device times of the kernel launches sampled for the kernel statistics
+/// are recorded the same way, see SYCL_KERNEL_STATS.
+class DeviceTimestampPoller {
+public:
+  DeviceTimestampPoller() = default;
+  ~DeviceTimestampPoller();
+
+  DeviceTimestampPoller(const DeviceTimestampPoller &) = delete;
+  DeviceTimestampPoller &operator=(const DeviceTimestampPoller &) = delete;
+
+  /// \return true if a subscriber listens to the device execution times.
+  static bool isEnabled();
+
+  /// \return the host time used for the device execution times.
+  static uint64_t hostTime();
+
+  /// Reports the execution times of the command of Event once it completes.
+  ///
+  /// \param TraceEvent is the XPTI trace event of the command.
+  /// \param Instance is the instance of the trace event.
+  /// \param HostQueuedTime is the host time the command was queued at.
+  void add(const plugin &Plugin, RT::PiEvent Event, void *TraceEvent,
+           uint64_t Instance, uint8_t StreamID, uint64_t HostQueuedTime);
+
+  /// Records the device time of the kernel launch of Event in Stats once it
+  /// completes.
+  void add(const plugin &Plugin, RT::PiEvent Event, KernelStatsEntry &Stats);
+
+private:
+  struct PendingCommand {
+    const plugin *Plugin;
+    RT::PiEvent Event;
+    void *TraceEvent;
+    uint64_t Instance;
+    uint8_t StreamID;
+    uint64_t HostQueuedTime;
+    /// The statistics of the kernel launch, or nullptr if the command is
+    /// reported to the XPTI subscribers.
+    KernelStatsEntry *KernelStats;
+  };
+
+  void add(const PendingCommand &Command);
+
+  /// Reports the command if it is complete. \return true if the command is no
+  /// longer pending.
+  static bool poll(const PendingCommand &Command);
+
+  void run();
+
+  std::mutex MMutex;
+  std::condition_variable MCondition;
+  std::vector<PendingCommand> MPending;
+  std::thread MThread;
+  bool MStop = false;
+};
+} // namespace detail
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
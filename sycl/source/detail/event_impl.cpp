@@ -15,7 +15,10 @@
 
 #include "detail/config.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <map>
+#include <vector>
 
 #ifdef XPTI_ENABLE_INSTRUMENTATION
 #include "xpti_trace_framework.hpp"
@@ -30,6 +33,13 @@ namespace detail {
 extern xpti::trace_event_data_t *GSYCLGraphEvent;
 #endif
 
+SlabPool &getEventPool() {
+  // Events are owned by user objects which may be destroyed after the runtime
+  // is shut down, so the pool is never destroyed.
+  static SlabPool *EventPool = new SlabPool();
+  return *EventPool;
+}
+
 // Threat all devices that don't support interoperability as host devices to
 // avoid attempts to call method get on such events.
 bool event_impl::is_host() const { return MHostEvent || !MOpenCLInterop; }
@@ -59,6 +69,46 @@ void event_impl::waitInternal() const {
     ;
 }
 
+void event_impl::waitAllInternal(
+    const std::vector<std::shared_ptr<event_impl>> &Events) {
+  // piEventsWait requires all the events to belong to the same context.
+  std::map<context_impl *, std::vector<RT::PiEvent>> NativeEventsPerContext;
+  std::vector<const event_impl *> OtherEvents;
+  for (const std::shared_ptr<event_impl> &Event : Events) {
+    if (!Event->MHostEvent && Event->MEvent)
+      NativeEventsPerContext[Event->MContext.get()].push_back(Event->MEvent);
+    else
+      OtherEvents.push_back(Event.get());
+  }
+
+  for (auto &CtxWithEvents : NativeEventsPerContext)
+    CtxWithEvents.first->getPlugin().call<PiApiKind::piEventsWait>(
+        CtxWithEvents.second.size(), CtxWithEvents.second.data());
+
+  for (const event_impl *Event : OtherEvents)
+    Event->waitInternal();
+}
+
+void event_impl::waitAll(
+    const std::vector<std::shared_ptr<event_impl>> &Events) {
+  // Events without a native handle may still have their commands not enqueued.
+  bool HasPendingCommands =
+      std::any_of(Events.begin(), Events.end(),
+                  [](const std::shared_ptr<event_impl> &Event) {
+                    return !Event->MEvent && Event->MCommand;
+                  });
+  if (HasPendingCommands)
+    detail::Scheduler::getInstance().waitForEvents(Events);
+  else
+    waitAllInternal(Events);
+
+  if (SYCLConfig<SYCL_DISABLE_EXECUTION_GRAPH_CLEANUP>::get())
+    return;
+  for (const std::shared_ptr<event_impl> &Event : Events)
+    if (Event->MCommand)
+      detail::Scheduler::getInstance().deferCleanupFinishedCommands(Event);
+}
+
 void event_impl::setComplete() {
   if (MHostEvent || !MEvent) {
 #ifndef NDEBUG
@@ -139,7 +189,8 @@ void *event_impl::instrumentationProlog(string_class &Name, int32_t StreamID,
                                         uint64_t &IId) const {
   void *TraceEvent = nullptr;
 #ifdef XPTI_ENABLE_INSTRUMENTATION
-  if (!xptiTraceEnabled())
+  if (!xptiCheckTraceEnabled(StreamID, xpti::trace_wait_begin) ||
+      !xptiSampleTrace(StreamID))
     return TraceEvent;
   // Use a thread-safe counter to get a unique instance ID for the wait() on the
   // event
@@ -201,7 +252,8 @@ void event_impl::wait(
   else if (MCommand)
     detail::Scheduler::getInstance().waitForEvent(Self);
   if (MCommand && !SYCLConfig<SYCL_DISABLE_EXECUTION_GRAPH_CLEANUP>::get())
-    detail::Scheduler::getInstance().cleanupFinishedCommands(std::move(Self));
+    detail::Scheduler::getInstance().deferCleanupFinishedCommands(
+        std::move(Self));
 
 #ifdef XPTI_ENABLE_INSTRUMENTATION
   instrumentationEpilog(TelemetryEvent, Name, StreamID, IId);
@@ -13,9 +13,12 @@
 #include <CL/sycl/detail/pi.hpp>
 #include <CL/sycl/info/info_desc.hpp>
 #include <CL/sycl/stl.hpp>
+#include <detail/slab_pool.hpp>
 
 #include <atomic>
 #include <cassert>
+#include <memory>
+#include <utility>
 
 __SYCL_INLINE_NAMESPACE(cl) {
 namespace sycl {
@@ -73,6 +76,15 @@ public:
   /// \param Self is a pointer to this event.
   void wait_and_throw(std::shared_ptr<cl::sycl::detail::event_impl> Self);
 
+  /// Waits for all the events.
+  ///
+  /// Commands of all the events are enqueued before waiting, and the native
+  /// events are waited for by a single call per context.
+  ///
+  /// \param Events is a list of the events to wait for.
+  static void
+  waitAll(const std::vector<std::shared_ptr<event_impl>> &Events);
+
   /// Queries this event for profiling information.
   ///
   /// If the requested info is not available when this member function is
@@ -99,6 +111,13 @@ public:
   /// Waits for the event with respect to device type.
   void waitInternal() const;
 
+  /// Waits for the events with respect to device type. Native events of the
+  /// same context are waited for together.
+  ///
+  /// \param Events is a list of the events which have been enqueued.
+  static void
+  waitAllInternal(const std::vector<std::shared_ptr<event_impl>> &Events);
+
   /// Marks this event as completed.
   void setComplete();
 
@@ -178,6 +197,22 @@ private:
   std::atomic<int> MState;
 };
 
+/// \return the pool which holds the event_impl objects and their shared
+/// pointer control blocks.
+///
+/// An event is created for every submission, so the memory is recycled instead
+/// of being returned to the system allocator.
+SlabPool &getEventPool();
+
+/// Creates an event_impl with its control block in a single block of the
+/// event pool.
+template <typename... ArgsT>
+std::shared_ptr<event_impl> makeEventImpl(ArgsT &&... Args) {
+  return std::allocate_shared<event_impl>(
+      SlabPoolAllocator<event_impl, getEventPool>(),
+      std::forward<ArgsT>(Args)...);
+}
+
 } // namespace detail
 } // namespace sycl
 } // __SYCL_INLINE_NAMESPACE(cl)
@@ -105,7 +105,8 @@ filter create_filter(const std::string &Input) {
 }
 
 filter_selector_impl::filter_selector_impl(const std::string &Input)
-    : mFilters(), mRanker(), mNumDevicesSeen(0), mMatchFound(false) {
+    : mFilter(Input), mFilters(), mRanker(), mNumDevicesSeen(0),
+      mMatchFound(false) {
   std::vector<std::string> Filters = detail::tokenize(Input, ",");
   mNumTotalDevices = device::get_devices().size();
 
@@ -11,6 +11,7 @@
 #include <CL/sycl/detail/device_filter.hpp>
 #include <CL/sycl/device_selector.hpp>
 
+#include <string>
 #include <vector>
 
 __SYCL_INLINE_NAMESPACE(cl) {
@@ -29,9 +30,12 @@ public:
   filter_selector_impl(const std::string &filter);
   int operator()(const device &dev) const;
   void reset() const;
+  /// \return the filter string the selector is constructed with.
+  const std::string &getFilter() const { return mFilter; }
 
 private:
   static constexpr int REJECT_DEVICE_SCORE = -1;
+  std::string mFilter;
   mutable std::vector<filter> mFilters;
   default_selector mRanker;
   mutable int mNumDevicesSeen;
@@ -8,16 +8,27 @@
 
 #include <CL/sycl/detail/device_filter.hpp>
 #include <CL/sycl/detail/spinlock.hpp>
+#include <detail/config.hpp>
+#include <detail/context_impl.hpp>
+#include <detail/device_selection_cache.hpp>
+#include <detail/device_timestamps.hpp>
 #include <detail/global_handler.hpp>
+#include <detail/kernel_stats.hpp>
 #include <detail/platform_impl.hpp>
 #include <detail/plugin.hpp>
 #include <detail/program_manager/program_manager.hpp>
 #include <detail/scheduler/scheduler.hpp>
+#include <detail/slab_pool.hpp>
+#include <detail/submit_latency.hpp>
+#include <detail/thread_pool.hpp>
 
 #ifdef _WIN32
 #include <windows.h>
 #endif
 
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
 #include <vector>
 
 __SYCL_INLINE_NAMESPACE(cl) {
@@ -112,8 +123,123 @@ GlobalHandler::getDeviceFilterList(const std::string &InitValue) {
 
   return *MDeviceFilterList;
 }
+ThreadPool &GlobalHandler::getProgramBuildThreadPool() {
+  if (MProgramBuildThreadPool)
+    return *MProgramBuildThreadPool;
 
-void shutdown() { delete &GlobalHandler::instance(); }
+  const std::lock_guard<SpinLock> Lock{MFieldsLock};
+  if (!MProgramBuildThreadPool) {
+    // The calling thread takes part in the builds too, see
+    // ThreadPool::parallelFor.
+    unsigned int Size = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    MProgramBuildThreadPool = std::make_unique<ThreadPool>(Size);
+    MProgramBuildThreadPool->start();
+  }
+
+  return *MProgramBuildThreadPool;
+}
+
+ThreadPool *GlobalHandler::getHostKernelThreadPool() {
+  const std::lock_guard<SpinLock> Lock{MFieldsLock};
+  if (!MHostKernelThreadPoolInitialized) {
+    unsigned int Threads = std::thread::hardware_concurrency();
+    if (const char *ValStr = SYCLConfig<SYCL_HOST_KERNEL_THREADS>::get())
+      Threads = static_cast<unsigned int>(std::strtoul(ValStr, nullptr, 10));
+    // The submitting thread runs a share of the kernel too
+    if (Threads > 1) {
+      MHostKernelThreadPool = std::make_unique<ThreadPool>(Threads - 1);
+      MHostKernelThreadPool->start();
+    }
+    MHostKernelThreadPoolInitialized = true;
+  }
+
+  return MHostKernelThreadPool.get();
+}
+
+SlabPool &GlobalHandler::getCommandPool() {
+  if (MCommandPool)
+    return *MCommandPool;
+
+  const std::lock_guard<SpinLock> Lock{MFieldsLock};
+  if (!MCommandPool)
+    MCommandPool = std::make_unique<SlabPool>();
+
+  return *MCommandPool;
+}
+
+DeviceTimestampPoller &GlobalHandler::getDeviceTimestampPoller() {
+  if (MDeviceTimestampPoller)
+    return *MDeviceTimestampPoller;
+
+  const std::lock_guard<SpinLock> Lock{MFieldsLock};
+  if (!MDeviceTimestampPoller)
+    MDeviceTimestampPoller = std::make_unique<DeviceTimestampPoller>();
+
+  return *MDeviceTimestampPoller;
+}
+
+SubmitLatencyRecorder &GlobalHandler::getSubmitLatencyRecorder() {
+  if (MSubmitLatencyRecorder)
+    return *MSubmitLatencyRecorder;
+
+  const std::lock_guard<SpinLock> Lock{MFieldsLock};
+  if (!MSubmitLatencyRecorder)
+    MSubmitLatencyRecorder = std::make_unique<SubmitLatencyRecorder>();
+
+  return *MSubmitLatencyRecorder;
+}
+
+KernelStatsRecorder &GlobalHandler::getKernelStatsRecorder() {
+  if (MKernelStatsRecorder)
+    return *MKernelStatsRecorder;
+
+  const std::lock_guard<SpinLock> Lock{MFieldsLock};
+  if (!MKernelStatsRecorder)
+    MKernelStatsRecorder = std::make_unique<KernelStatsRecorder>();
+
+  return *MKernelStatsRecorder;
+}
+
+DeviceSelectionCache &GlobalHandler::getDeviceSelectionCache() {
+  if (MDeviceSelectionCache)
+    return *MDeviceSelectionCache;
+
+  const std::lock_guard<SpinLock> Lock{MFieldsLock};
+  if (!MDeviceSelectionCache)
+    MDeviceSelectionCache = std::make_unique<DeviceSelectionCache>();
+
+  return *MDeviceSelectionCache;
+}
+
+void GlobalHandler::drainForFastShutdown() {
+  // The host kernels and the builds may submit work, so they are finished
+  // first.
+  MHostKernelThreadPool.reset();
+  MProgramBuildThreadPool.reset();
+  if (MScheduler)
+    MScheduler->waitForAllRecords();
+  // Stops the thread calling the plugins, and reports the latencies and the
+  // kernel statistics.
+  MDeviceTimestampPoller.reset();
+  MSubmitLatencyRecorder.reset();
+  MKernelStatsRecorder.reset();
+}
+
+void shutdown() {
+  // With SYCL_FAST_SHUTDOWN set, the programs, kernels, events and contexts
+  // are not released one by one, which takes long with large program caches:
+  // the driver reclaims their resources at process exit. The work still
+  // running is waited for only.
+  if (SYCLConfig<SYCL_FAST_SHUTDOWN>::get()) {
+    try {
+      GlobalHandler::instance().drainForFastShutdown();
+    } catch (...) {
+      // Nothing can be reported once the application has exited.
+    }
+    return;
+  }
+  delete &GlobalHandler::instance();
+}
 
 #ifdef _WIN32
 BOOL WINAPI DllMain(HINSTANCE hinstDLL, DWORD fdwReason, LPVOID lpReserved) {
@@ -22,6 +22,12 @@ class ProgramManager;
 class Sync;
 class plugin;
 class device_filter_list;
+class ThreadPool;
+class SlabPool;
+class DeviceTimestampPoller;
+class KernelStatsRecorder;
+class SubmitLatencyRecorder;
+class DeviceSelectionCache;
 
 using PlatformImplPtr = std::shared_ptr<platform_impl>;
 
@@ -56,6 +62,15 @@ public:
   std::mutex &getFilterMutex();
   std::vector<plugin> &getPlugins();
   device_filter_list &getDeviceFilterList(const std::string &InitValue);
+  ThreadPool &getProgramBuildThreadPool();
+  /// \return the pool running the host device kernels, or nullptr if
+  /// SYCL_HOST_KERNEL_THREADS makes them run on the submitting thread only.
+  ThreadPool *getHostKernelThreadPool();
+  SlabPool &getCommandPool();
+  DeviceTimestampPoller &getDeviceTimestampPoller();
+  SubmitLatencyRecorder &getSubmitLatencyRecorder();
+  KernelStatsRecorder &getKernelStatsRecorder();
+  DeviceSelectionCache &getDeviceSelectionCache();
 
 private:
   friend void shutdown();
@@ -64,8 +79,14 @@ private:
   GlobalHandler();
   ~GlobalHandler();
 
+  /// Waits for the work still running, for the fast shutdown which leaves the
+  /// global objects alive. \sa shutdown
+  void drainForFastShutdown();
+
   SpinLock MFieldsLock;
 
+  // Declared before the scheduler to outlive the commands it owns.
+  std::unique_ptr<SlabPool> MCommandPool;
   std::unique_ptr<Scheduler> MScheduler;
   std::unique_ptr<ProgramManager> MProgramManager;
   std::unique_ptr<Sync> MSync;
@@ -74,6 +95,21 @@ private:
   std::unique_ptr<std::mutex> MFilterMutex;
   std::unique_ptr<std::vector<plugin>> MPlugins;
   std::unique_ptr<device_filter_list> MDeviceFilterList;
+  // Declared before the poller, which records the device times of the
+  // sampled launches in it until it is destroyed.
+  std::unique_ptr<KernelStatsRecorder> MKernelStatsRecorder;
+  // Declared after the plugins, as its thread calls them until it is
+  // destroyed.
+  std::unique_ptr<DeviceTimestampPoller> MDeviceTimestampPoller;
+  std::unique_ptr<SubmitLatencyRecorder> MSubmitLatencyRecorder;
+  // Declared after the plugins, as it releases the default contexts when it
+  // is destroyed.
+  std::unique_ptr<DeviceSelectionCache> MDeviceSelectionCache;
+  // Declared last to be destroyed first: its jobs may use any of the objects
+  // above.
+  std::unique_ptr<ThreadPool> MProgramBuildThreadPool;
+  std::unique_ptr<ThreadPool> MHostKernelThreadPool;
+  bool MHostKernelThreadPoolInitialized = false;
 };
 } // namespace detail
 } // namespace sycl
@@ -11,7 +11,10 @@
 #include <CL/sycl/event.hpp>
 #include <detail/context_impl.hpp>
 #include <detail/event_impl.hpp>
+#include <detail/global_handler.hpp>
+#include <detail/thread_pool.hpp>
 
+#include <algorithm>
 #include <memory>
 
 __SYCL_INLINE_NAMESPACE(cl) {
@@ -39,6 +42,23 @@ void waitEvents(std::vector<cl::sycl::event> DepEvents) {
   }
 }
 
+void runOnHostThreads(size_t Count,
+                      const function_class<void(size_t, size_t)> &Task) {
+  ThreadPool *Pool = GlobalHandler::instance().getHostKernelThreadPool();
+  if (!Pool || Count <= 1) {
+    Task(0, Count);
+    return;
+  }
+
+  // A few chunks per thread balance the chunks which take longer
+  constexpr size_t ChunksPerThread = 4;
+  const size_t NumChunks =
+      std::min(Count, (Pool->getThreadCount() + 1) * ChunksPerThread);
+  Pool->parallelFor(NumChunks, [&](size_t Chunk) {
+    Task(Count * Chunk / NumChunks, Count * (Chunk + 1) / NumChunks);
+  });
+}
+
 } // namespace detail
 } // namespace sycl
 } // __SYCL_INLINE_NAMESPACE(cl)
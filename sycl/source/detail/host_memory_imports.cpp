@@ -0,0 +1,92 @@
+//==---- host_memory_imports.cpp - Host memory registered with a driver ----==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/host_memory_imports.hpp>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+
+HostMemoryImports::RegistrationMapT::const_iterator
+HostMemoryImports::find(uintptr_t Begin, uintptr_t End) const {
+  // The registration starting last at or before Begin is the only one which
+  // can hold the range, as the registrations don't overlap.
+  auto It = MRegistrations.upper_bound(Begin);
+  if (It == MRegistrations.begin())
+    return MRegistrations.end();
+  --It;
+  return End <= It->second.End ? It : MRegistrations.end();
+}
+
+bool HostMemoryImports::acquire(const void *Owner, const void *Ptr,
+                                size_t Size, const ImportFn &Import) {
+  if (Size < MinSize)
+    return false;
+  const uintptr_t Begin = reinterpret_cast<uintptr_t>(Ptr);
+  const uintptr_t End = Begin + Size;
+  std::lock_guard<std::mutex> Lock(MMutex);
+  if (MOwners.count(Owner))
+    return true;
+
+  auto It = find(Begin, End);
+  if (It != MRegistrations.end()) {
+    ++MRegistrations.find(It->first)->second.NumOwners;
+    MOwners.emplace(Owner, It->first);
+    return true;
+  }
+
+  // A range overlapping a registration starts before its end and ends after
+  // its start.
+  auto Next = MRegistrations.lower_bound(Begin);
+  if (Next != MRegistrations.end() && Next->first < End)
+    return false;
+  if (Next != MRegistrations.begin() && std::prev(Next)->second.End > Begin)
+    return false;
+
+  if (!Import(Ptr, Size))
+    return false;
+  MRegistrations.emplace(Begin, Registration{End, 1});
+  MOwners.emplace(Owner, Begin);
+  MNumRegistrations.store(MRegistrations.size(), std::memory_order_release);
+  return true;
+}
+
+void HostMemoryImports::release(const void *Owner, const ReleaseFn &Release) {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  auto OwnerIt = MOwners.find(Owner);
+  if (OwnerIt == MOwners.end())
+    return;
+  auto It = MRegistrations.find(OwnerIt->second);
+  MOwners.erase(OwnerIt);
+  if (--It->second.NumOwners != 0)
+    return;
+  Release(reinterpret_cast<const void *>(It->first));
+  MRegistrations.erase(It);
+  MNumRegistrations.store(MRegistrations.size(), std::memory_order_release);
+}
+
+void HostMemoryImports::releaseAll(const ReleaseFn &Release) {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  for (const auto &R : MRegistrations)
+    Release(reinterpret_cast<const void *>(R.first));
+  MRegistrations.clear();
+  MOwners.clear();
+  MNumRegistrations.store(0, std::memory_order_release);
+}
+
+bool HostMemoryImports::contains(const void *Ptr, size_t Size) const {
+  if (MNumRegistrations.load(std::memory_order_acquire) == 0)
+    return false;
+  const uintptr_t Begin = reinterpret_cast<uintptr_t>(Ptr);
+  std::lock_guard<std::mutex> Lock(MMutex);
+  return find(Begin, Begin + Size) != MRegistrations.end();
+}
+
+} // namespace detail
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
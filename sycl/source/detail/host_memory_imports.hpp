@@ -0,0 +1,88 @@
+//==---- host_memory_imports.hpp - Host memory registered with a driver ----==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl/detail/defines.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+
+/// The ranges of user host memory of a context registered with the plugin by
+/// piextUSMImport, e.g. the memory of the buffers created with use_host_ptr.
+/// The copies between these ranges and the devices run as from pinned memory,
+/// so they are not staged.
+///
+/// Each registration has owners, e.g. the memory objects using the range, and
+/// is released with the last one. An owner whose range is held by a range
+/// registered already shares that registration. The ranges which overlap a
+/// registered one only partly are not registered, as the drivers refuse
+/// overlapping registrations.
+class HostMemoryImports {
+public:
+  /// The smallest range registered. Registering memory pins its pages, which
+  /// costs more than the copies of small ranges gain.
+  static constexpr size_t MinSize = 64 * 1024;
+
+  /// Registers a range with the plugin. \return false if it refuses to.
+  using ImportFn = std::function<bool(const void *Ptr, size_t Size)>;
+  /// Releases the registration of a range starting at \p Ptr.
+  using ReleaseFn = std::function<void(const void *Ptr)>;
+
+  HostMemoryImports() = default;
+  HostMemoryImports(const HostMemoryImports &) = delete;
+  HostMemoryImports &operator=(const HostMemoryImports &) = delete;
+
+  /// Makes \p Owner an owner of a registration holding [Ptr, Ptr + Size),
+  /// registering the range with \p Import if there is none. Does nothing if
+  /// \p Owner owns a registration already.
+  ///
+  /// \return true if \p Owner owns a registration.
+  bool acquire(const void *Owner, const void *Ptr, size_t Size,
+               const ImportFn &Import);
+
+  /// Gives up the registration \p Owner owns, if any. The last owner of a
+  /// registration releases it with \p Release.
+  void release(const void *Owner, const ReleaseFn &Release);
+
+  /// Releases all registrations with \p Release.
+  void releaseAll(const ReleaseFn &Release);
+
+  /// \return true if [Ptr, Ptr + Size) is held by a registered range.
+  bool contains(const void *Ptr, size_t Size) const;
+
+private:
+  struct Registration {
+    uintptr_t End;
+    size_t NumOwners;
+  };
+  using RegistrationMapT = std::map<uintptr_t, Registration>;
+
+  /// \return the registration holding [Begin, End), or the end iterator.
+  RegistrationMapT::const_iterator find(uintptr_t Begin, uintptr_t End) const;
+
+  mutable std::mutex MMutex;
+  /// The registrations by the start of their ranges.
+  RegistrationMapT MRegistrations;
+  std::unordered_map<const void *, uintptr_t> MOwners;
+  /// Lets contains() return without locking while there is no registration.
+  std::atomic<size_t> MNumRegistrations{0};
+};
+
+} // namespace detail
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
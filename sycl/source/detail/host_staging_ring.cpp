@@ -0,0 +1,176 @@
+//==-------------- host_staging_ring.cpp - Pinned staging of host copies ---==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/config.hpp>
+#include <detail/host_staging_ring.hpp>
+#include <detail/numa.hpp>
+#include <detail/plugin.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+
+static size_t getCapacityConfig() {
+  const char *ValStr = SYCLConfig<SYCL_HOST_STAGING_RING_SIZE>::get();
+  if (!ValStr)
+    return 0;
+  return static_cast<size_t>(std::strtoull(ValStr, nullptr, 10));
+}
+
+HostStagingRing::HostStagingRing() : MCapacity(getCapacityConfig()) {}
+
+bool HostStagingRing::isStageable(const plugin &Plugin, RT::PiContext Context,
+                                  const void *HostPtr, size_t Size) const {
+  // A copy of a single chunk can't overlap with anything.
+  if (!isEnabled() || Size <= getSlotSize())
+    return false;
+
+  // USM host memory is pinned already and is copied directly.
+  if (!Plugin.getPiPlugin().PiFunctionTable.piextUSMGetMemAllocInfo)
+    return true;
+  pi_usm_type Type = PI_MEM_TYPE_UNKNOWN;
+  RT::PiResult Error =
+      Plugin.call_nocheck<PiApiKind::piextUSMGetMemAllocInfo>(
+          Context, HostPtr, PI_MEM_ALLOC_TYPE, sizeof(Type), &Type, nullptr);
+  return Error != PI_SUCCESS || Type == PI_MEM_TYPE_UNKNOWN;
+}
+
+bool HostStagingRing::allocateSlots(const plugin &Plugin,
+                                    RT::PiContext Context) {
+  if (MSlots[0])
+    return true;
+  // The plugins pin the host memory as they allocate it, so it is placed by
+  // the memory policy of the allocating thread.
+  ScopedNumaNodePreference Preference(MNumaNode);
+  for (size_t Slot = 0; Slot < NumSlots; ++Slot) {
+    RT::PiResult Error = Plugin.call_nocheck<PiApiKind::piextUSMHostAlloc>(
+        &MSlots[Slot], Context, nullptr, getSlotSize(), 0);
+    if (Error != PI_SUCCESS) {
+      for (size_t I = 0; I < Slot; ++I) {
+        Plugin.call<PiApiKind::piextUSMFree>(Context, MSlots[I]);
+        MSlots[I] = nullptr;
+      }
+      MSlots[Slot] = nullptr;
+      return false;
+    }
+  }
+  return true;
+}
+
+void HostStagingRing::waitForSlot(const plugin &Plugin, size_t Slot) {
+  if (RT::PiEvent &Event = MSlotEvents[Slot]) {
+    Plugin.call<PiApiKind::piEventsWait>(1, &Event);
+    Plugin.call<PiApiKind::piEventRelease>(Event);
+    Event = nullptr;
+  }
+}
+
+bool HostStagingRing::write(const plugin &Plugin, RT::PiContext Context,
+                            RT::PiQueue Queue, RT::PiMem Dst, size_t DstOffset,
+                            const char *Src, size_t Size,
+                            const std::vector<RT::PiEvent> &DepEvents,
+                            RT::PiEvent &OutEvent) {
+  if (!isStageable(Plugin, Context, Src, Size))
+    return false;
+
+  std::lock_guard<std::mutex> Lock(MMutex);
+  if (!allocateSlots(Plugin, Context))
+    return false;
+
+  // The host memory may be written by the commands the copy depends on.
+  if (!DepEvents.empty())
+    Plugin.call<PiApiKind::piEventsWait>(DepEvents.size(), DepEvents.data());
+
+  const size_t SlotSize = getSlotSize();
+  size_t Slot = 0;
+  for (size_t Offset = 0; Offset < Size; Offset += SlotSize) {
+    const size_t ChunkSize = std::min(SlotSize, Size - Offset);
+    waitForSlot(Plugin, Slot);
+    std::memcpy(MSlots[Slot], Src + Offset, ChunkSize);
+    Plugin.call<PiApiKind::piEnqueueMemBufferWrite>(
+        Queue, Dst, /*blocking_write=*/false, DstOffset + Offset, ChunkSize,
+        MSlots[Slot], 0, nullptr, &MSlotEvents[Slot]);
+    Slot = (Slot + 1) % NumSlots;
+  }
+
+  // The transfers of the first chunks are complete once their slots are
+  // reused, so only the ones left in the slots are waited for.
+  std::vector<RT::PiEvent> PendingEvents;
+  for (RT::PiEvent Event : MSlotEvents)
+    if (Event)
+      PendingEvents.push_back(Event);
+  Plugin.call<PiApiKind::piEnqueueEventsWait>(
+      Queue, PendingEvents.size(), PendingEvents.data(), &OutEvent);
+  return true;
+}
+
+bool HostStagingRing::read(const plugin &Plugin, RT::PiContext Context,
+                           RT::PiQueue Queue, RT::PiMem Src, size_t SrcOffset,
+                           char *Dst, size_t Size,
+                           const std::vector<RT::PiEvent> &DepEvents,
+                           RT::PiEvent &OutEvent) {
+  if (!isStageable(Plugin, Context, Dst, Size))
+    return false;
+
+  std::lock_guard<std::mutex> Lock(MMutex);
+  if (!allocateSlots(Plugin, Context))
+    return false;
+  for (size_t Slot = 0; Slot < NumSlots; ++Slot)
+    waitForSlot(Plugin, Slot);
+
+  const size_t SlotSize = getSlotSize();
+  const size_t NumChunks = (Size + SlotSize - 1) / SlotSize;
+  auto EnqueueChunk = [&](size_t Chunk) {
+    const size_t Offset = Chunk * SlotSize;
+    const size_t Slot = Chunk % NumSlots;
+    Plugin.call<PiApiKind::piEnqueueMemBufferRead>(
+        Queue, Src, /*blocking_read=*/false, SrcOffset + Offset,
+        std::min(SlotSize, Size - Offset), MSlots[Slot], DepEvents.size(),
+        DepEvents.data(), &MSlotEvents[Slot]);
+  };
+
+  for (size_t Chunk = 0; Chunk < std::min(NumChunks, NumSlots); ++Chunk)
+    EnqueueChunk(Chunk);
+  for (size_t Chunk = 0; Chunk < NumChunks; ++Chunk) {
+    const size_t Offset = Chunk * SlotSize;
+    const size_t Slot = Chunk % NumSlots;
+    RT::PiEvent Event = MSlotEvents[Slot];
+    MSlotEvents[Slot] = nullptr;
+    Plugin.call<PiApiKind::piEventsWait>(1, &Event);
+    std::memcpy(Dst + Offset, MSlots[Slot], std::min(SlotSize, Size - Offset));
+
+    if (Chunk + 1 == NumChunks) {
+      // The event of the last chunk is complete when all chunks are.
+      OutEvent = Event;
+    } else {
+      Plugin.call<PiApiKind::piEventRelease>(Event);
+      if (Chunk + NumSlots < NumChunks)
+        EnqueueChunk(Chunk + NumSlots);
+    }
+  }
+  return true;
+}
+
+void HostStagingRing::release(const plugin &Plugin, RT::PiContext Context) {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  for (size_t Slot = 0; Slot < NumSlots; ++Slot) {
+    waitForSlot(Plugin, Slot);
+    if (MSlots[Slot]) {
+      Plugin.call<PiApiKind::piextUSMFree>(Context, MSlots[Slot]);
+      MSlots[Slot] = nullptr;
+    }
+  }
+}
+
+} // namespace detail
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -0,0 +1,95 @@
+//==------ host_staging_ring.hpp - Pinned staging of host copies -*- C++ -*-==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl/detail/defines.hpp>
+#include <CL/sycl/detail/pi.hpp>
+
+#include <array>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+
+class plugin;
+
+/// Ring of pinned host memory slots of a context, which large copies between
+/// pageable host memory and buffers go through.
+///
+/// Drivers copy pageable memory through their own staging memory, mostly one
+/// step after the other. The ring splits a copy into chunks of a slot size and
+/// copies every chunk between the user memory and its slot on the host while
+/// the transfers of the other chunks are in progress, which gets close to the
+/// peak bandwidth of the bus.
+///
+/// The slots are allocated on the first staged copy. A ring with zero capacity
+/// is disabled.
+class HostStagingRing {
+public:
+  static constexpr size_t NumSlots = 4;
+
+  /// Constructs the ring with the capacity set by SYCL_HOST_STAGING_RING_SIZE.
+  HostStagingRing();
+  explicit HostStagingRing(size_t Capacity) : MCapacity(Capacity) {}
+  HostStagingRing(const HostStagingRing &) = delete;
+  HostStagingRing &operator=(const HostStagingRing &) = delete;
+
+  bool isEnabled() const { return MCapacity >= NumSlots; }
+
+  size_t getSlotSize() const { return MCapacity / NumSlots; }
+
+  /// Copies \p Size bytes from \p Src to \p Dst at \p DstOffset through the
+  /// ring. The host memory is read after \p DepEvents are complete.
+  ///
+  /// \return false if the copy is too small to be staged, \p Src is pinned
+  /// already or the slots can't be allocated; nothing is enqueued then.
+  bool write(const plugin &Plugin, RT::PiContext Context, RT::PiQueue Queue,
+             RT::PiMem Dst, size_t DstOffset, const char *Src, size_t Size,
+             const std::vector<RT::PiEvent> &DepEvents, RT::PiEvent &OutEvent);
+
+  /// Copies \p Size bytes from \p Src at \p SrcOffset to \p Dst through the
+  /// ring. The copy is complete when the function returns.
+  ///
+  /// \return false under the same conditions as write.
+  bool read(const plugin &Plugin, RT::PiContext Context, RT::PiQueue Queue,
+            RT::PiMem Src, size_t SrcOffset, char *Dst, size_t Size,
+            const std::vector<RT::PiEvent> &DepEvents, RT::PiEvent &OutEvent);
+
+  /// Makes the slots allocated hereafter prefer the NUMA node \p Node.
+  void setNumaNode(int Node) { MNumaNode = Node; }
+
+  /// Waits for the pending transfers and frees the slots.
+  void release(const plugin &Plugin, RT::PiContext Context);
+
+private:
+  bool isStageable(const plugin &Plugin, RT::PiContext Context,
+                   const void *HostPtr, size_t Size) const;
+
+  /// Allocates the slots if they aren't yet. Must be called under MMutex.
+  bool allocateSlots(const plugin &Plugin, RT::PiContext Context);
+
+  /// Waits until the transfer of the slot is complete. Must be called under
+  /// MMutex.
+  void waitForSlot(const plugin &Plugin, size_t Slot);
+
+  const size_t MCapacity;
+  std::mutex MMutex;
+  std::array<void *, NumSlots> MSlots{};
+  /// Transfers in progress of every slot.
+  std::array<RT::PiEvent, NumSlots> MSlotEvents{};
+  /// The NUMA node the slots are allocated on, -1 if any.
+  int MNumaNode = -1;
+};
+
+} // namespace detail
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
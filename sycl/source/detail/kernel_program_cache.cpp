@@ -7,6 +7,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <detail/context_impl.hpp>
+#include <detail/device_impl.hpp>
 #include <detail/kernel_program_cache.hpp>
 #include <detail/plugin.hpp>
 
@@ -14,6 +15,10 @@ __SYCL_INLINE_NAMESPACE(cl) {
 namespace sycl {
 namespace detail {
 KernelProgramCache::~KernelProgramCache() {
+  for (auto &Clones : MKernelClones)
+    for (RT::PiKernel Clone : Clones.second)
+      MParentContext->getPlugin().call<PiApiKind::piKernelRelease>(Clone);
+
   for (auto &ProgIt : MCachedPrograms) {
     ProgramWithBuildStateT &ProgWithState = ProgIt.second;
     PiProgramT *ToBeDeleted = ProgWithState.Ptr.load();
@@ -39,6 +44,133 @@ KernelProgramCache::~KernelProgramCache() {
     const detail::plugin &Plugin = MParentContext->getPlugin();
     Plugin.call<PiApiKind::piProgramRelease>(ToBeDeleted);
   }
+
+  for (std::atomic<KernelByIDChunk *> &Chunk : MKernelsByID)
+    delete Chunk.load();
+}
+
+RT::PiProgram KernelProgramCache::useSpecializedBuild(
+    const ProgramCacheKeyT &Key, bool Pin, const SpecializedBuildLimits &Limits,
+    size_t Size) {
+  std::lock_guard<std::mutex> Lock(MProgramCacheMutex);
+  auto It = MCachedPrograms.find(Key);
+  if (It == MCachedPrograms.end() || It->second.State.load() != BS_Done)
+    return nullptr;
+  RT::PiProgram Program = It->second.Ptr.load();
+
+  const KernelSetOnDeviceT KernelSet(Key.first.second, Key.second);
+  auto Pos = MSpecializedBuildByProgram.find(Program);
+  if (Pos == MSpecializedBuildByProgram.end()) {
+    ++MSpecializedBuildStats.Misses;
+    MSpecializedBuilds.push_front(SpecializedBuild{It, KernelSet, Size, 0});
+    MSpecializedBuildByProgram.emplace(Program, MSpecializedBuilds.begin());
+    ++MSpecializedBuildCounts[KernelSet];
+    ++MSpecializedBuildStats.Builds;
+    MSpecializedBuildStats.Size += Size;
+  } else {
+    ++MSpecializedBuildStats.Hits;
+    MSpecializedBuilds.splice(MSpecializedBuilds.begin(), MSpecializedBuilds,
+                              Pos->second);
+  }
+  if (Pin)
+    ++MSpecializedBuilds.front().Pins;
+
+  // Only the kernel set of the build being used may be beyond its own limit,
+  // as the limit is enforced on every use. The build being used is at the
+  // front and is never evicted.
+  size_t &KernelSetBuilds = MSpecializedBuildCounts[KernelSet];
+  auto Victim = MSpecializedBuilds.end();
+  while (--Victim != MSpecializedBuilds.begin()) {
+    const bool OverTotal = MSpecializedBuildStats.Builds > Limits.MaxBuilds ||
+                           MSpecializedBuildStats.Size > Limits.MaxSize;
+    const bool OverKernelSet = KernelSetBuilds > Limits.MaxBuildsPerKernelSet;
+    if (!OverTotal && !OverKernelSet)
+      break;
+    if (Victim->Pins != 0 || (!OverTotal && Victim->KernelSet != KernelSet))
+      continue;
+    auto VictimCount = MSpecializedBuildCounts.find(Victim->KernelSet);
+    if (--VictimCount->second == 0 && Victim->KernelSet != KernelSet)
+      MSpecializedBuildCounts.erase(VictimCount);
+    --MSpecializedBuildStats.Builds;
+    MSpecializedBuildStats.Size -= Victim->Size;
+    MSpecializedBuildByProgram.erase(Victim->It->second.Ptr.load());
+    evictSpecializedBuild(Victim->It->second);
+    ++MSpecializedBuildStats.Evictions;
+    Victim = MSpecializedBuilds.erase(Victim);
+  }
+  return Program;
+}
+
+void KernelProgramCache::unpinSpecializedBuild(RT::PiProgram Program) {
+  std::lock_guard<std::mutex> Lock(MProgramCacheMutex);
+  auto Pos = MSpecializedBuildByProgram.find(Program);
+  if (Pos != MSpecializedBuildByProgram.end() && Pos->second->Pins > 0)
+    --Pos->second->Pins;
+}
+
+KernelWorkGroupSizesPtr
+KernelProgramCache::getKernelWorkGroupSizes(RT::PiKernel Kernel,
+                                            const device_impl &Device) {
+  const auto Key = std::make_pair(Kernel, Device.getHandleRef());
+  {
+    std::lock_guard<std::mutex> Lock(MWorkGroupSizesMutex);
+    auto It = MWorkGroupSizes.find(Key);
+    if (It != MWorkGroupSizes.end())
+      return It->second;
+  }
+  // The limits are queried without the lock. Of the threads querying them at
+  // the same time, the first one to be done publishes them.
+  auto Sizes = std::make_shared<KernelWorkGroupSizes>(
+      getKernelWorkGroupLimits(Kernel, Device));
+  std::lock_guard<std::mutex> Lock(MWorkGroupSizesMutex);
+  return MWorkGroupSizes.emplace(Key, std::move(Sizes)).first->second;
+}
+
+void KernelProgramCache::evictSpecializedBuild(
+    ProgramWithBuildStateT &BuildResult) {
+  PiProgramT *Program = BuildResult.Ptr.load();
+  const detail::plugin &Plugin = MParentContext->getPlugin();
+
+  {
+    std::lock_guard<std::mutex> Lock(MKernelsPerProgramCacheMutex);
+    auto KernIt = MKernelsPerProgramCache.find(Program);
+
+    if (KernIt != MKernelsPerProgramCache.end()) {
+      std::lock_guard<std::mutex> ClonesLock(MKernelClonesMutex);
+
+      for (auto &p : KernIt->second) {
+        PiKernelT *Kern = p.second.Ptr.load();
+        if (!Kern)
+          continue;
+
+        auto ClonesIt = MKernelClones.find(Kern);
+        if (ClonesIt != MKernelClones.end()) {
+          for (RT::PiKernel Clone : ClonesIt->second)
+            Plugin.call<PiApiKind::piKernelRelease>(Clone);
+          MKernelClones.erase(ClonesIt);
+        }
+        {
+          // A later kernel may get the handle of the released one.
+          std::lock_guard<std::mutex> SizesLock(MWorkGroupSizesMutex);
+          auto SizesIt = MWorkGroupSizes.lower_bound(
+              std::pair<RT::PiKernel, RT::PiDevice>(Kern, nullptr));
+          while (SizesIt != MWorkGroupSizes.end() &&
+                 SizesIt->first.first == Kern)
+            SizesIt = MWorkGroupSizes.erase(SizesIt);
+        }
+        Plugin.call<PiApiKind::piKernelRelease>(Kern);
+      }
+      MKernelsPerProgramCache.erase(KernIt);
+    }
+  }
+  Plugin.call<PiApiKind::piProgramRelease>(Program);
+
+  // A failed build without an error is built again by the next request.
+  BuildResult.Ptr.store(nullptr);
+  {
+    std::lock_guard<std::mutex> Lock(BuildResult.MBuildResultMutex);
+    BuildResult.State.store(BS_Failed);
+  }
 }
 }
 }
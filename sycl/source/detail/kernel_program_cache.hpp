@@ -14,17 +14,30 @@
 #include <CL/sycl/detail/pi.hpp>
 #include <CL/sycl/detail/util.hpp>
 #include <detail/platform_impl.hpp>
+#include <detail/work_group_size.hpp>
 
+#include <array>
 #include <atomic>
 #include <condition_variable>
+#include <functional>
+#include <list>
 #include <map>
 #include <mutex>
+#include <shared_mutex>
+#include <tuple>
 #include <type_traits>
+#include <unordered_map>
+#include <vector>
 
 __SYCL_INLINE_NAMESPACE(cl) {
 namespace sycl {
 namespace detail {
 class context_impl;
+class device_impl;
+
+/// States of the cached build results.
+enum BuildState { BS_InProgress, BS_Done, BS_Failed };
+
 class KernelProgramCache {
 public:
   /// Denotes build error data. The data is filled in from cl::sycl::exception
@@ -80,6 +93,37 @@ public:
       std::map<std::pair<string_class, RT::PiDevice>, KernelWithBuildStateT>;
   using KernelCacheT = std::map<RT::PiProgram, KernelByNameT>;
 
+  /// Key of the kernel fast cache. For the kernels which are not bound to a
+  /// user program the OS module, the kernel name and the device identify the
+  /// program and the kernel unambiguously.
+  using KernelFastCacheKeyT =
+      std::tuple<OSModuleHandle, string_class, RT::PiDevice>;
+  /// The built kernel and the mutex guarding its arguments setting.
+  using KernelFastCacheValT = std::pair<RT::PiKernel, std::mutex *>;
+
+  /// Statistics of the specialized builds, i.e. the programs built with
+  /// specialization constant values set by a user program.
+  struct SpecializedBuildStats {
+    size_t Hits = 0;
+    size_t Misses = 0;
+    size_t Evictions = 0;
+    /// The number of specialized builds in the cache and the sum of their
+    /// estimated sizes in bytes.
+    size_t Builds = 0;
+    size_t Size = 0;
+  };
+
+  /// Capacity of the cache for the specialized builds. The size of a build is
+  /// estimated by the caller, see useSpecializedBuild().
+  struct SpecializedBuildLimits {
+    /// The maximum number of builds of a kernel set for a device.
+    size_t MaxBuildsPerKernelSet;
+    /// The maximum number of builds and the maximum sum of their sizes over
+    /// all the kernel sets and devices of the context.
+    size_t MaxBuilds;
+    size_t MaxSize;
+  };
+
   ~KernelProgramCache();
 
   void setContextPtr(const ContextPtr &AContext) { MParentContext = AContext; }
@@ -92,6 +136,29 @@ public:
     return {MKernelsPerProgramCache, MKernelsPerProgramCacheMutex};
   }
 
+  /// Marks the specialized build with the given key as the most recently used
+  /// one. The least recently used builds beyond the limits are evicted: their
+  /// programs and kernels are released and the next request for them builds
+  /// them again. The builds pinned by user programs, which covers the kernels
+  /// of the commands in flight, are never evicted.
+  /// \param Pin if true, the build is pinned until unpinSpecializedBuild().
+  /// \param Size is the estimated size of the build, accounted for when the
+  ///        build is seen for the first time.
+  /// \return the program of the build or nullptr if the build has been evicted
+  ///         after it was looked up, so that the caller has to build it again.
+  RT::PiProgram useSpecializedBuild(const ProgramCacheKeyT &Key, bool Pin,
+                                    const SpecializedBuildLimits &Limits,
+                                    size_t Size = 0);
+
+  /// Unpins the specialized build pinned by useSpecializedBuild(). Does
+  /// nothing if the program is not a specialized build.
+  void unpinSpecializedBuild(RT::PiProgram Program);
+
+  SpecializedBuildStats getSpecializedBuildStats() {
+    std::lock_guard<std::mutex> Lock(MProgramCacheMutex);
+    return MSpecializedBuildStats;
+  }
+
   template <typename T, class Predicate>
   void waitUntilBuilt(BuildResult<T> &BR, Predicate Pred) const {
     std::unique_lock<std::mutex> Lock(BR.MBuildResultMutex);
@@ -103,13 +170,195 @@ public:
     BR.MBuildCV.notify_all();
   }
 
+  /// Looks the kernel up in the fast cache. Lookups of different threads do
+  /// not block each other, so this is the only synchronization taking place
+  /// on submission of an already built kernel.
+  /// \return the kernel and its mutex, or a pair of nullptrs on a miss.
+  KernelFastCacheValT tryToGetKernelFast(OSModuleHandle M,
+                                         const string_class &KernelName,
+                                         RT::PiDevice Device) {
+    KernelFastCacheKeyT Key{M, KernelName, Device};
+    KernelFastCacheShard &Shard = getKernelFastCacheShard(Key);
+    std::shared_lock<std::shared_timed_mutex> Lock(Shard.MMutex);
+    auto It = Shard.MKernels.find(Key);
+    if (It != Shard.MKernels.end())
+      return It->second;
+    return std::make_pair(nullptr, nullptr);
+  }
+
+  /// Publishes a kernel built through the regular build-state machinery in
+  /// the fast cache. The kernel is still owned by the kernels-per-program
+  /// cache.
+  void saveKernelFast(OSModuleHandle M, const string_class &KernelName,
+                      RT::PiDevice Device, KernelFastCacheValT Kernel) {
+    KernelFastCacheKeyT Key{M, KernelName, Device};
+    KernelFastCacheShard &Shard = getKernelFastCacheShard(Key);
+    std::lock_guard<std::shared_timed_mutex> Lock(Shard.MMutex);
+    Shard.MKernels.emplace(std::move(Key), Kernel);
+  }
+
+  /// Looks the kernel up by the integer ID assigned by the program manager.
+  /// The lookup is an array access and does not take any locks.
+  /// \return the kernel and its mutex, or a pair of nullptrs on a miss.
+  KernelFastCacheValT tryToGetKernelByID(unsigned int KernelID,
+                                         RT::PiDevice Device) {
+    KernelByIDSlot *Slot = getKernelByIDSlot(KernelID, /*Create=*/false);
+    if (Slot && Slot->MState.load(std::memory_order_acquire) == SlotReady &&
+        Slot->MDevice == Device)
+      return std::make_pair(Slot->MKernel, Slot->MKernelMutex);
+    return std::make_pair(nullptr, nullptr);
+  }
+
+  /// Publishes a built kernel in the slot of the given ID. Each slot keeps
+  /// the kernel for a single device, the first one to be saved; kernels for
+  /// other devices of the context are found through the sharded fast cache.
+  void saveKernelByID(unsigned int KernelID, RT::PiDevice Device,
+                      KernelFastCacheValT Kernel) {
+    KernelByIDSlot *Slot = getKernelByIDSlot(KernelID, /*Create=*/true);
+    if (!Slot)
+      return;
+    int Expected = SlotEmpty;
+    if (!Slot->MState.compare_exchange_strong(Expected, SlotBusy))
+      return;
+    Slot->MDevice = Device;
+    Slot->MKernel = Kernel.first;
+    Slot->MKernelMutex = Kernel.second;
+    Slot->MState.store(SlotReady, std::memory_order_release);
+  }
+
+  /// Takes a free clone of the cached kernel. Kernel objects are stateful, so
+  /// a thread finding the mutex of the cached kernel locked sets the arguments
+  /// of a clone and launches it instead of waiting for the other thread.
+  /// \return a clone of the kernel, or nullptr if there is no free one and the
+  /// caller has to create it.
+  RT::PiKernel tryToGetKernelClone(RT::PiKernel Kernel) {
+    std::lock_guard<std::mutex> Lock(MKernelClonesMutex);
+    auto It = MKernelClones.find(Kernel);
+    if (It == MKernelClones.end() || It->second.empty())
+      return nullptr;
+    RT::PiKernel Clone = It->second.back();
+    It->second.pop_back();
+    return Clone;
+  }
+
+  /// Puts a clone of the cached kernel to the free list once its launch is
+  /// enqueued. The clones are owned by the cache and released with it.
+  void returnKernelClone(RT::PiKernel Kernel, RT::PiKernel Clone) {
+    std::lock_guard<std::mutex> Lock(MKernelClonesMutex);
+    MKernelClones[Kernel].push_back(Clone);
+  }
+
+  /// Gets the local sizes selected for the launches of the cached kernel
+  /// \p Kernel on \p Device. Its limits are queried on the first call.
+  KernelWorkGroupSizesPtr getKernelWorkGroupSizes(RT::PiKernel Kernel,
+                                                  const device_impl &Device);
+
 private:
+  struct KernelFastCacheKeyHash {
+    size_t operator()(const KernelFastCacheKeyT &Key) const {
+      size_t Hash = std::hash<string_class>{}(std::get<1>(Key));
+      Hash ^= std::hash<OSModuleHandle>{}(std::get<0>(Key)) + 0x9e3779b9 +
+              (Hash << 6) + (Hash >> 2);
+      Hash ^= std::hash<RT::PiDevice>{}(std::get<2>(Key)) + 0x9e3779b9 +
+              (Hash << 6) + (Hash >> 2);
+      return Hash;
+    }
+  };
+
+  /// The fast cache is split into shards with separate locks, so that writers
+  /// only block the readers of a single shard.
+  struct KernelFastCacheShard {
+    std::shared_timed_mutex MMutex;
+    std::unordered_map<KernelFastCacheKeyT, KernelFastCacheValT,
+                       KernelFastCacheKeyHash>
+        MKernels;
+  };
+
+  static constexpr size_t NumKernelFastCacheShards = 16;
+
+  KernelFastCacheShard &getKernelFastCacheShard(const KernelFastCacheKeyT &Key) {
+    return MKernelFastCache[KernelFastCacheKeyHash{}(Key) %
+                            NumKernelFastCacheShards];
+  }
+
+  enum KernelByIDSlotState { SlotEmpty, SlotBusy, SlotReady };
+
+  struct KernelByIDSlot {
+    std::atomic<int> MState{SlotEmpty};
+    RT::PiDevice MDevice = nullptr;
+    RT::PiKernel MKernel = nullptr;
+    std::mutex *MKernelMutex = nullptr;
+  };
+
+  /// The slots are allocated in chunks on demand, so that the table never
+  /// moves and can be read without locks.
+  static constexpr size_t KernelByIDChunkSize = 256;
+  static constexpr size_t MaxKernelByIDChunks = 64;
+  using KernelByIDChunk = std::array<KernelByIDSlot, KernelByIDChunkSize>;
+
+  KernelByIDSlot *getKernelByIDSlot(unsigned int KernelID, bool Create) {
+    size_t ChunkIdx = KernelID / KernelByIDChunkSize;
+    if (ChunkIdx >= MaxKernelByIDChunks)
+      return nullptr;
+    std::atomic<KernelByIDChunk *> &ChunkPtr = MKernelsByID[ChunkIdx];
+    KernelByIDChunk *Chunk = ChunkPtr.load(std::memory_order_acquire);
+    if (!Chunk) {
+      if (!Create)
+        return nullptr;
+      KernelByIDChunk *NewChunk = new KernelByIDChunk();
+      if (ChunkPtr.compare_exchange_strong(Chunk, NewChunk))
+        Chunk = NewChunk;
+      else
+        delete NewChunk;
+    }
+    return &(*Chunk)[KernelID % KernelByIDChunkSize];
+  }
+
+  using KernelSetOnDeviceT = std::pair<KernelSetId, RT::PiDevice>;
+
+  struct SpecializedBuild {
+    ProgramCacheT::iterator It;
+    KernelSetOnDeviceT KernelSet;
+    size_t Size;
+    unsigned int Pins;
+  };
+  using SpecializedBuildListT = std::list<SpecializedBuild>;
+
+  /// Releases the program of the specialized build along with its kernels and
+  /// makes the cache entry rebuildable. The entry itself is not erased as
+  /// other threads may still be looking at it.
+  void evictSpecializedBuild(ProgramWithBuildStateT &BuildResult);
+
   std::mutex MProgramCacheMutex;
   std::mutex MKernelsPerProgramCacheMutex;
 
   ProgramCacheT MCachedPrograms;
   KernelCacheT MKernelsPerProgramCache;
   ContextPtr MParentContext;
+
+  // The members below are guarded by MProgramCacheMutex.
+  /// Specialized builds of all the kernel sets for all the devices, the most
+  /// recently used first.
+  SpecializedBuildListT MSpecializedBuilds;
+  /// The number of specialized builds of each kernel set for each device.
+  std::map<KernelSetOnDeviceT, size_t> MSpecializedBuildCounts;
+  /// Positions of the specialized builds in the list above.
+  std::unordered_map<RT::PiProgram, SpecializedBuildListT::iterator>
+      MSpecializedBuildByProgram;
+  SpecializedBuildStats MSpecializedBuildStats;
+
+  std::array<KernelFastCacheShard, NumKernelFastCacheShards> MKernelFastCache;
+
+  std::mutex MKernelClonesMutex;
+  /// Free clones of the cached kernels.
+  std::unordered_map<RT::PiKernel, std::vector<RT::PiKernel>> MKernelClones;
+  std::array<std::atomic<KernelByIDChunk *>, MaxKernelByIDChunks>
+      MKernelsByID{};
+
+  std::mutex MWorkGroupSizesMutex;
+  /// The local sizes selected for the launches of the cached kernels.
+  std::map<std::pair<RT::PiKernel, RT::PiDevice>, KernelWorkGroupSizesPtr>
+      MWorkGroupSizes;
 };
 } // namespace detail
 } // namespace sycl
@@ -0,0 +1,119 @@
+//==---------- kernel_stats.cpp --- SYCL per-kernel execution statistics ---==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/config.hpp>
+#include <detail/kernel_stats.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+
+KernelStatsRecorder::KernelStatsRecorder(uint64_t Sampling)
+    : MSampling(Sampling ? Sampling : 1) {}
+
+KernelStatsRecorder::~KernelStatsRecorder() {
+  if (!isEnabled())
+    return;
+  const char *Output = SYCLConfig<SYCL_KERNEL_STATS>::get();
+  if (std::strcmp(Output, "1") == 0) {
+    print(std::cerr);
+    return;
+  }
+  std::ofstream File(Output);
+  if (File)
+    print(File);
+  else
+    std::cerr << "SYCL_KERNEL_STATS: cannot write to " << Output << "\n";
+}
+
+bool KernelStatsRecorder::isEnabled() {
+  static const bool Enabled = [] {
+    const char *Value = SYCLConfig<SYCL_KERNEL_STATS>::get();
+    return Value && *Value && std::strcmp(Value, "0") != 0;
+  }();
+  return Enabled;
+}
+
+uint64_t KernelStatsRecorder::getSamplingConfig() {
+  const char *ValStr = SYCLConfig<SYCL_KERNEL_STATS_SAMPLING>::get();
+  if (!ValStr)
+    return 1;
+  return static_cast<uint64_t>(std::strtoull(ValStr, nullptr, 10));
+}
+
+std::vector<ONEAPI::kernel_stats> KernelStatsRecorder::get() {
+  std::vector<ONEAPI::kernel_stats> Result;
+  std::vector<uint64_t> Counts(LatencyHistogram::NumBuckets);
+  {
+    std::lock_guard<std::mutex> Lock(MMutex);
+    for (const auto &Device : MEntries)
+      for (const auto &Kernel : Device.second) {
+        const KernelStatsEntry &Entry = *Kernel.second;
+        ONEAPI::kernel_stats Stats{};
+        Stats.kernel_name = Entry.KernelName;
+        Stats.device_name = Entry.DeviceName;
+        Stats.launch_count = Entry.Launches.load(std::memory_order_relaxed);
+        Stats.arg_setup_ns = Entry.ArgSetupNs.load(std::memory_order_relaxed);
+        Stats.build_ns = Entry.BuildNs.load(std::memory_order_relaxed);
+        std::fill(Counts.begin(), Counts.end(), 0);
+        Entry.DeviceTime.merge(Counts, Stats.device_time);
+        LatencyHistogram::setPercentiles(Counts, Stats.device_time);
+        // The kernels not launched since the last reset are left out
+        if (Stats.launch_count || Stats.device_time.count)
+          Result.push_back(std::move(Stats));
+      }
+  }
+  std::sort(Result.begin(), Result.end(),
+            [](const ONEAPI::kernel_stats &A, const ONEAPI::kernel_stats &B) {
+              return A.device_time.total_ns > B.device_time.total_ns;
+            });
+  return Result;
+}
+
+void KernelStatsRecorder::reset() {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  for (const auto &Device : MEntries)
+    for (const auto &Kernel : Device.second) {
+      KernelStatsEntry &Entry = *Kernel.second;
+      Entry.Launches.store(0, std::memory_order_relaxed);
+      Entry.ArgSetupNs.store(0, std::memory_order_relaxed);
+      Entry.BuildNs.store(0, std::memory_order_relaxed);
+      Entry.DeviceTime.reset();
+    }
+}
+
+void KernelStatsRecorder::print(std::ostream &Out) {
+  std::vector<ONEAPI::kernel_stats> Stats = get();
+  Out << "SYCL kernel statistics (ns), one launch in " << MSampling
+      << " timed\n";
+  Out << std::right;
+  for (const char *Column : {"launches", "timed", "total", "mean", "p50",
+                             "p90", "p99", "max", "arg setup", "build"})
+    Out << std::setw(14) << Column;
+  Out << "  kernel [device]\n";
+  for (const ONEAPI::kernel_stats &Kernel : Stats) {
+    const ONEAPI::submit_latency &Time = Kernel.device_time;
+    Out << std::setw(14) << Kernel.launch_count << std::setw(14)
+        << Time.count << std::setw(14) << Time.total_ns << std::setw(14)
+        << (Time.count ? Time.total_ns / Time.count : 0) << std::setw(14)
+        << Time.p50_ns << std::setw(14) << Time.p90_ns << std::setw(14)
+        << Time.p99_ns << std::setw(14) << Time.max_ns << std::setw(14)
+        << Kernel.arg_setup_ns << std::setw(14) << Kernel.build_ns << "  "
+        << Kernel.kernel_name << " [" << Kernel.device_name << "]\n";
+  }
+}
+} // namespace detail
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
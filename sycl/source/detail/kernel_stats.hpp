@@ -0,0 +1,100 @@
+//==---------- kernel_stats.hpp --- SYCL per-kernel execution statistics ---==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl/ONEAPI/kernel_stats.hpp>
+#include <detail/submit_latency.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+
+/// The statistics of a kernel on a device.
+///
+/// The counters are updated by the submitting threads; the device times are
+/// recorded by the thread of the DeviceTimestampPoller only, which is the
+/// single writer the histogram needs.
+struct KernelStatsEntry {
+  KernelStatsEntry(std::string Kernel, std::string Device)
+      : KernelName(std::move(Kernel)), DeviceName(std::move(Device)) {}
+
+  const std::string KernelName;
+  const std::string DeviceName;
+  std::atomic<uint64_t> Launches{0};
+  std::atomic<uint64_t> ArgSetupNs{0};
+  std::atomic<uint64_t> BuildNs{0};
+  LatencyHistogram DeviceTime;
+};
+
+/// Collects the statistics of the kernels launched on the devices, see
+/// SYCL_KERNEL_STATS.
+///
+/// The entries are never removed, so that the sampled launches still pending
+/// in the DeviceTimestampPoller may refer to them.
+class KernelStatsRecorder {
+public:
+  /// \param Sampling is the number of launches of a kernel for each launch
+  /// whose device time is measured.
+  explicit KernelStatsRecorder(uint64_t Sampling = getSamplingConfig());
+  /// Prints the statistics if SYCL_KERNEL_STATS asks for it.
+  ~KernelStatsRecorder();
+
+  /// \return true if SYCL_KERNEL_STATS enables the statistics.
+  static bool isEnabled();
+
+  /// \return the number of launches per sampled launch set by
+  /// SYCL_KERNEL_STATS_SAMPLING.
+  static uint64_t getSamplingConfig();
+
+  /// \return the entry of the kernel on the device, which is created with the
+  /// device name returned by GetDeviceName on the first launch.
+  template <typename GetDeviceNameT>
+  KernelStatsEntry &getEntry(const std::string &KernelName, const void *Device,
+                             GetDeviceNameT GetDeviceName) {
+    std::lock_guard<std::mutex> Lock(MMutex);
+    std::unique_ptr<KernelStatsEntry> &Entry = MEntries[Device][KernelName];
+    if (!Entry)
+      Entry = std::make_unique<KernelStatsEntry>(KernelName, GetDeviceName());
+    return *Entry;
+  }
+
+  /// Counts a launch of the kernel of Entry.
+  ///
+  /// \return true if the device time of the launch is to be measured.
+  bool countLaunch(KernelStatsEntry &Entry) const {
+    uint64_t Launch = Entry.Launches.fetch_add(1, std::memory_order_relaxed);
+    return Launch % MSampling == 0;
+  }
+
+  /// \return the statistics of all the entries by decreasing total device
+  /// time.
+  std::vector<ONEAPI::kernel_stats> get();
+  void reset();
+  void print(std::ostream &Out);
+
+private:
+  const uint64_t MSampling;
+  std::mutex MMutex;
+  std::unordered_map<
+      const void *,
+      std::unordered_map<std::string, std::unique_ptr<KernelStatsEntry>>>
+      MEntries;
+};
+} // namespace detail
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -6,20 +6,84 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <CL/sycl/detail/cg_types.hpp>
 #include <CL/sycl/detail/memory_manager.hpp>
 #include <detail/context_impl.hpp>
 #include <detail/event_impl.hpp>
+#include <detail/numa.hpp>
 #include <detail/queue_impl.hpp>
+#include <detail/scheduler/scheduler.hpp>
 
 #include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <cstring>
 #include <vector>
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
 __SYCL_INLINE_NAMESPACE(cl) {
 namespace sycl {
 namespace detail {
 
+// Host copies of at least this size are split over the host threads.
+static constexpr size_t ParallelHostCopyMinSize = 8 * 1024 * 1024;
+// Host copies of at least this size don't fit the caches, so their
+// destination won't be reread from the caches soon. The copies bypass the
+// caches with non-temporal stores instead of evicting everything else.
+static constexpr size_t NonTemporalHostCopyMinSize = 64 * 1024 * 1024;
+
+static void copyNonTemporal(char *Dst, const char *Src, size_t Size) {
+#if defined(__SSE2__) || defined(_M_X64)
+  constexpr size_t VecSize = sizeof(__m128i);
+  const size_t Head = std::min(
+      Size, (VecSize - reinterpret_cast<uintptr_t>(Dst) % VecSize) % VecSize);
+  std::memcpy(Dst, Src, Head);
+  size_t Pos = Head;
+  for (; Pos + VecSize <= Size; Pos += VecSize)
+    _mm_stream_si128(
+        reinterpret_cast<__m128i *>(Dst + Pos),
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(Src + Pos)));
+  std::memcpy(Dst + Pos, Src + Pos, Size - Pos);
+  // The streaming stores are weakly ordered.
+  _mm_sfence();
+#else
+  std::memcpy(Dst, Src, Size);
+#endif
+}
+
+// Copies Size bytes between host memory ranges which don't overlap. Large
+// copies are split over the host threads in chunks of whole pages of the
+// destination, so that each page of a destination not touched yet is first
+// touched, and so placed on its NUMA node, by a single thread.
+static void copyHostMemory(char *Dst, const char *Src, size_t Size) {
+  const bool NonTemporal = Size >= NonTemporalHostCopyMinSize;
+  auto CopyRange = [=](size_t Begin, size_t End) {
+    if (NonTemporal)
+      copyNonTemporal(Dst + Begin, Src + Begin, End - Begin);
+    else
+      std::memcpy(Dst + Begin, Src + Begin, End - Begin);
+  };
+  if (Size < ParallelHostCopyMinSize) {
+    CopyRange(0, Size);
+    return;
+  }
+
+  // The first chunk ends at the first chunk boundary of the destination.
+  constexpr size_t ChunkSize = NumaMinPlacementSize;
+  const size_t Head =
+      (ChunkSize - reinterpret_cast<uintptr_t>(Dst) % ChunkSize) % ChunkSize;
+  const size_t NumChunks = 1 + (Size - Head + ChunkSize - 1) / ChunkSize;
+  auto ChunkBegin = [=](size_t Chunk) {
+    return Chunk == 0 ? 0 : std::min(Size, Head + (Chunk - 1) * ChunkSize);
+  };
+  runOnHostThreads(NumChunks, [&](size_t Begin, size_t End) {
+    CopyRange(ChunkBegin(Begin), ChunkBegin(End));
+  });
+}
+
 static void waitForEvents(const std::vector<EventImplPtr> &Events) {
   // Assuming all events will be on the same device or
   // devices associated with the same Backend.
@@ -64,6 +128,7 @@ void MemoryManager::releaseMemObj(ContextImplPtr TargetContext,
     return;
   }
 
+  TargetContext->getMemoryUsage().recordRelease(MemAllocation);
   const detail::plugin &Plugin = TargetContext->getPlugin();
   Plugin.call<PiApiKind::piMemRelease>(pi::cast<RT::PiMem>(MemAllocation));
 }
@@ -95,11 +160,13 @@ void *MemoryManager::allocateHostMemory(SYCLMemObjI *MemObj, void *UserPtr,
     return UserPtr;
 
   void *NewMem = MemObj->allocateHostMem();
+  if (Size >= NumaMinPlacementSize)
+    preferNumaNode(NewMem, Size, Scheduler::getMemObjNumaNode(MemObj));
 
   // Need to initialize new memory if user provides pointer to read only
   // memory.
   if (UserPtr && HostPtrReadOnly == true)
-    std::memcpy((char *)NewMem, (char *)UserPtr, Size);
+    copyHostMemory((char *)NewMem, (char *)UserPtr, Size);
   return NewMem;
 }
 
@@ -123,22 +190,18 @@ RT::PiMemFlags getMemObjCreationFlags(const ContextImplPtr &TargetContext,
                                       void *UserPtr, bool HostPtrReadOnly) {
   // Create read_write mem object to handle arbitrary uses.
   RT::PiMemFlags Result = PI_MEM_FLAGS_ACCESS_RW;
+  // Create the memory object using the host pointer only if the devices
+  // support host_unified_memory to avoid potential copy overhead.
+  // TODO This check duplicates the one performed in the GraphBuilder during
+  // AllocaCommand creation. This information should be propagated here
+  // instead, which would be a breaking ABI change.
+  const bool HostUnifiedMemory = TargetContext->hasHostUnifiedMemory();
   if (UserPtr) {
     if (HostPtrReadOnly)
       Result |= PI_MEM_FLAGS_HOST_PTR_COPY;
-    else {
-      // Create the memory object using the host pointer only if the devices
-      // support host_unified_memory to avoid potential copy overhead.
-      // TODO This check duplicates the one performed in the GraphBuilder during
-      // AllocaCommand creation. This information should be propagated here
-      // instead, which would be a breaking ABI change.
-      bool HostUnifiedMemory = true;
-      for (const device &Device : TargetContext->getDevices())
-        HostUnifiedMemory &=
-            Device.get_info<info::device::host_unified_memory>();
+    else
       Result |= HostUnifiedMemory ? PI_MEM_FLAGS_HOST_PTR_USE
                                   : PI_MEM_FLAGS_HOST_PTR_COPY;
-    }
   }
 
   return Result;
@@ -166,15 +229,29 @@ MemoryManager::allocateBufferObject(ContextImplPtr TargetContext, void *UserPtr,
                                     const sycl::property_list &PropsList) {
   RT::PiMemFlags CreationFlags =
       getMemObjCreationFlags(TargetContext, UserPtr, HostPtrReadOnly);
-  if (PropsList.has_property<
+  // Without a user pointer, allocate the buffer in host accessible memory if
+  // the devices share it with the host, so that the buffer is mapped to the
+  // host accessors rather than copied.
+  if ((!UserPtr && TargetContext->hasHostUnifiedMemory()) ||
+      PropsList.has_property<
           sycl::ext::oneapi::property::buffer::use_pinned_host_memory>())
     CreationFlags |= PI_MEM_FLAGS_HOST_PTR_ALLOC;
 
+  // The memory of the user isn't accounted to the context.
+  const bool Owned = !(CreationFlags & PI_MEM_FLAGS_HOST_PTR_USE);
+  if (Owned && !TargetContext->reserveMemory(Size))
+    throw memory_allocation_error(
+        "The buffer allocation exceeds the memory limit of the context",
+        PI_OUT_OF_RESOURCES);
+
   RT::PiMem NewMem = nullptr;
   const detail::plugin &Plugin = TargetContext->getPlugin();
   Plugin.call<PiApiKind::piMemBufferCreate>(TargetContext->getHandleRef(),
                                             CreationFlags, Size, UserPtr,
                                             &NewMem, nullptr);
+  if (Owned)
+    TargetContext->getMemoryUsage().recordAllocation(
+        NewMem, MemoryUsageTracker::Category::Buffer, Size);
   return NewMem;
 }
 
@@ -207,8 +284,20 @@ void *MemoryManager::allocateMemImage(
   if (UserPtr && InteropContext)
     return allocateInteropMemObject(TargetContext, UserPtr, InteropEvent,
                                     InteropContext, PropsList, OutEventToWait);
-  return allocateImageObject(TargetContext, UserPtr, HostPtrReadOnly, Desc,
-                             Format, PropsList);
+  // The memory of the user isn't accounted to the context.
+  const bool Owned =
+      !(getMemObjCreationFlags(TargetContext, UserPtr, HostPtrReadOnly) &
+        PI_MEM_FLAGS_HOST_PTR_USE);
+  if (Owned && !TargetContext->reserveMemory(Size))
+    throw memory_allocation_error(
+        "The image allocation exceeds the memory limit of the context",
+        PI_OUT_OF_RESOURCES);
+  void *NewMem = allocateImageObject(TargetContext, UserPtr, HostPtrReadOnly,
+                                     Desc, Format, PropsList);
+  if (Owned)
+    TargetContext->getMemoryUsage().recordAllocation(
+        NewMem, MemoryUsageTracker::Category::Image, Size);
+  return NewMem;
 }
 
 void *MemoryManager::allocateMemSubBuffer(ContextImplPtr TargetContext,
@@ -297,10 +386,22 @@ void copyH2D(SYCLMemObjI *SYCLMemObj, char *SrcMem, QueueImplPtr,
 
   if (MemType == detail::SYCLMemObjI::MemObjType::BUFFER) {
     if (1 == DimDst && 1 == DimSrc) {
-      Plugin.call<PiApiKind::piEnqueueMemBufferWrite>(
-          Queue, DstMem,
-          /*blocking_write=*/CL_FALSE, DstXOffBytes, DstAccessRangeWidthBytes,
-          SrcMem + SrcXOffBytes, DepEvents.size(), DepEvents.data(), &OutEvent);
+      // Large copies from pageable memory are pipelined through pinned memory
+      // unless the device accesses the host memory anyway or the memory is
+      // registered with the plugin.
+      const ContextImplPtr &Context = TgtQueue->getContextImplPtr();
+      if (Context->hasHostUnifiedMemory() ||
+          Context->isHostMemoryImported(SrcMem + SrcXOffBytes,
+                                        DstAccessRangeWidthBytes) ||
+          !Context->getHostStagingRing().write(
+              Plugin, Context->getHandleRef(), Queue, DstMem, DstXOffBytes,
+              SrcMem + SrcXOffBytes, DstAccessRangeWidthBytes, DepEvents,
+              OutEvent))
+        Plugin.call<PiApiKind::piEnqueueMemBufferWrite>(
+            Queue, DstMem,
+            /*blocking_write=*/CL_FALSE, DstXOffBytes, DstAccessRangeWidthBytes,
+            SrcMem + SrcXOffBytes, DepEvents.size(), DepEvents.data(),
+            &OutEvent);
     } else {
       size_t BufferRowPitch = (1 == DimDst) ? 0 : DstSzWidthBytes;
       size_t BufferSlicePitch =
@@ -374,10 +475,19 @@ void copyD2H(SYCLMemObjI *SYCLMemObj, RT::PiMem SrcMem, QueueImplPtr SrcQueue,
 
   if (MemType == detail::SYCLMemObjI::MemObjType::BUFFER) {
     if (1 == DimDst && 1 == DimSrc) {
-      Plugin.call<PiApiKind::piEnqueueMemBufferRead>(
-          Queue, SrcMem,
-          /*blocking_read=*/CL_FALSE, SrcXOffBytes, SrcAccessRangeWidthBytes,
-          DstMem + DstXOffBytes, DepEvents.size(), DepEvents.data(), &OutEvent);
+      const ContextImplPtr &Context = SrcQueue->getContextImplPtr();
+      if (Context->hasHostUnifiedMemory() ||
+          Context->isHostMemoryImported(DstMem + DstXOffBytes,
+                                        SrcAccessRangeWidthBytes) ||
+          !Context->getHostStagingRing().read(
+              Plugin, Context->getHandleRef(), Queue, SrcMem, SrcXOffBytes,
+              DstMem + DstXOffBytes, SrcAccessRangeWidthBytes, DepEvents,
+              OutEvent))
+        Plugin.call<PiApiKind::piEnqueueMemBufferRead>(
+            Queue, SrcMem,
+            /*blocking_read=*/CL_FALSE, SrcXOffBytes, SrcAccessRangeWidthBytes,
+            DstMem + DstXOffBytes, DepEvents.size(), DepEvents.data(),
+            &OutEvent);
     } else {
       size_t BufferRowPitch = (1 == DimSrc) ? 0 : SrcSzWidthBytes;
       size_t BufferSlicePitch =
@@ -418,15 +528,85 @@ void copyD2H(SYCLMemObjI *SYCLMemObj, RT::PiMem SrcMem, QueueImplPtr SrcQueue,
   }
 }
 
+// Copies memory between devices of different contexts. Buffers which the
+// plugin can copy between directly don't go through the host, anything else is
+// read into host memory and written from there, which is pipelined through the
+// pinned staging rings of the contexts if they are enabled.
+static void copyD2DAcrossContexts(
+    SYCLMemObjI *SYCLMemObj, RT::PiMem SrcMem, QueueImplPtr SrcQueue,
+    unsigned int DimSrc, sycl::range<3> SrcSize, sycl::range<3> SrcAccessRange,
+    sycl::id<3> SrcOffset, unsigned int SrcElemSize, RT::PiMem DstMem,
+    QueueImplPtr TgtQueue, unsigned int DimDst, sycl::range<3> DstSize,
+    sycl::range<3> DstAccessRange, sycl::id<3> DstOffset,
+    unsigned int DstElemSize, std::vector<RT::PiEvent> DepEvents,
+    RT::PiEvent &OutEvent) {
+  const detail::plugin &Plugin = SrcQueue->getPlugin();
+
+  if (SYCLMemObj->getType() == detail::SYCLMemObjI::MemObjType::BUFFER &&
+      Plugin.getPiPlugin().PiFunctionTable.piextEnqueueMemBufferCopyPeer) {
+    // Only contiguous regions can be copied directly: 1D ones and whole
+    // buffers, which is what memory moves between contexts copy.
+    bool IsContiguous = 1 == DimSrc && 1 == DimDst;
+    IsContiguous |= SrcOffset == id<3>{0, 0, 0} &&
+                    DstOffset == id<3>{0, 0, 0} && SrcSize == SrcAccessRange &&
+                    DstSize == DstAccessRange;
+    if (IsContiguous) {
+      size_t Size = SrcAccessRange[0] * SrcAccessRange[1] * SrcAccessRange[2] *
+                    SrcElemSize;
+      RT::PiResult Error =
+          Plugin.call_nocheck<PiApiKind::piextEnqueueMemBufferCopyPeer>(
+              SrcQueue->getHandleRef(), SrcMem, SrcOffset[0] * SrcElemSize,
+              TgtQueue->getHandleRef(), DstMem, DstOffset[0] * DstElemSize,
+              Size, DepEvents.size(), DepEvents.data(), &OutEvent);
+      if (Error == PI_SUCCESS)
+        return;
+      if (Error != PI_INVALID_OPERATION)
+        Plugin.checkPiResult(Error);
+    }
+  }
+
+  std::vector<char> HostMem(SrcSize[0] * SrcSize[1] * SrcSize[2] *
+                            SrcElemSize);
+  RT::PiEvent ReadEvent = nullptr;
+  copyD2H(SYCLMemObj, SrcMem, SrcQueue, DimSrc, SrcSize, SrcAccessRange,
+          SrcOffset, SrcElemSize, HostMem.data(), nullptr, DimSrc, SrcSize,
+          SrcAccessRange, SrcOffset, SrcElemSize, std::move(DepEvents),
+          ReadEvent);
+  if (ReadEvent) {
+    Plugin.call<PiApiKind::piEventsWait>(1, &ReadEvent);
+    Plugin.call<PiApiKind::piEventRelease>(ReadEvent);
+  }
+
+  const detail::plugin &TgtPlugin = TgtQueue->getPlugin();
+  RT::PiEvent WriteEvent = nullptr;
+  copyH2D(SYCLMemObj, HostMem.data(), nullptr, DimSrc, SrcSize, SrcAccessRange,
+          SrcOffset, SrcElemSize, DstMem, TgtQueue, DimDst, DstSize,
+          DstAccessRange, DstOffset, DstElemSize, {}, WriteEvent);
+  if (WriteEvent) {
+    TgtPlugin.call<PiApiKind::piEventsWait>(1, &WriteEvent);
+    TgtPlugin.call<PiApiKind::piEventRelease>(WriteEvent);
+  }
+  // The host memory goes away here, so the copy is complete already.
+  OutEvent = nullptr;
+}
+
 void copyD2D(SYCLMemObjI *SYCLMemObj, RT::PiMem SrcMem, QueueImplPtr SrcQueue,
              unsigned int DimSrc, sycl::range<3> SrcSize,
              sycl::range<3> SrcAccessRange, sycl::id<3> SrcOffset,
-             unsigned int SrcElemSize, RT::PiMem DstMem, QueueImplPtr,
-             unsigned int DimDst, sycl::range<3> DstSize, sycl::range<3>,
-             sycl::id<3> DstOffset, unsigned int DstElemSize,
-             std::vector<RT::PiEvent> DepEvents, RT::PiEvent &OutEvent) {
+             unsigned int SrcElemSize, RT::PiMem DstMem, QueueImplPtr TgtQueue,
+             unsigned int DimDst, sycl::range<3> DstSize,
+             sycl::range<3> DstAccessRange, sycl::id<3> DstOffset,
+             unsigned int DstElemSize, std::vector<RT::PiEvent> DepEvents,
+             RT::PiEvent &OutEvent) {
   assert(SYCLMemObj && "The SYCLMemObj is nullptr");
 
+  if (SrcQueue->getContextImplPtr() != TgtQueue->getContextImplPtr())
+    return copyD2DAcrossContexts(
+        SYCLMemObj, SrcMem, std::move(SrcQueue), DimSrc, SrcSize,
+        SrcAccessRange, SrcOffset, SrcElemSize, DstMem, std::move(TgtQueue),
+        DimDst, DstSize, DstAccessRange, DstOffset, DstElemSize,
+        std::move(DepEvents), OutEvent);
+
   const RT::PiQueue Queue = SrcQueue->getHandleRef();
   const detail::plugin &Plugin = SrcQueue->getPlugin();
 
@@ -513,7 +693,7 @@ static void copyH2H(SYCLMemObjI *, char *SrcMem, QueueImplPtr,
 
   size_t BytesToCopy =
       SrcAccessRange[0] * SrcElemSize * SrcAccessRange[1] * SrcAccessRange[2];
-  std::memcpy(DstMem, SrcMem, BytesToCopy);
+  copyHostMemory(DstMem, SrcMem, BytesToCopy);
 }
 
 // Copies memory between: host and device, host and host,
@@ -657,7 +837,8 @@ void MemoryManager::copy_usm(const void *SrcMem, QueueImplPtr SrcQueue,
   sycl::context Context = SrcQueue->get_context();
 
   if (Context.is_host()) {
-    std::memcpy(DstMem, SrcMem, Len);
+    copyHostMemory(static_cast<char *>(DstMem),
+                   static_cast<const char *>(SrcMem), Len);
   } else {
     const detail::plugin &Plugin = SrcQueue->getPlugin();
     Plugin.call<PiApiKind::piextUSMEnqueueMemcpy>(SrcQueue->getHandleRef(),
@@ -688,6 +869,117 @@ void MemoryManager::fill_usm(void *Mem, QueueImplPtr Queue, size_t Length,
   }
 }
 
+// Joins the events of the commands enqueued for the rows of a rectangle into
+// OutEvent and releases them.
+static void joinRowEvents(const plugin &Plugin, RT::PiQueue Queue,
+                          std::vector<RT::PiEvent> &RowEvents,
+                          RT::PiEvent &OutEvent) {
+  Plugin.call<PiApiKind::piEnqueueEventsWait>(Queue, RowEvents.size(),
+                                              RowEvents.data(), &OutEvent);
+  for (RT::PiEvent Event : RowEvents)
+    Plugin.call<PiApiKind::piEventRelease>(Event);
+}
+
+void MemoryManager::copy_usm_rect(const void *SrcMem, QueueImplPtr SrcQueue,
+                                  const USMRect &Rect, void *DstMem,
+                                  std::vector<RT::PiEvent> DepEvents,
+                                  RT::PiEvent &OutEvent) {
+  if (!Rect.Width || !Rect.Height || !Rect.Depth)
+    return;
+  if (!SrcMem || !DstMem)
+    throw runtime_error("NULL pointer argument in memory copy operation.",
+                        PI_INVALID_VALUE);
+
+  const char *Src = static_cast<const char *>(SrcMem);
+  char *Dst = static_cast<char *>(DstMem);
+  if (SrcQueue->is_host()) {
+    for (size_t Z = 0; Z < Rect.Depth; ++Z)
+      for (size_t Y = 0; Y < Rect.Height; ++Y)
+        std::memcpy(Dst + Z * Rect.DstSlicePitch + Y * Rect.DstRowPitch,
+                    Src + Z * Rect.SrcSlicePitch + Y * Rect.SrcRowPitch,
+                    Rect.Width);
+    return;
+  }
+
+  const detail::plugin &Plugin = SrcQueue->getPlugin();
+  RT::PiQueue Queue = SrcQueue->getHandleRef();
+  if (Plugin.getPiPlugin().PiFunctionTable.piextUSMEnqueueMemcpyRect) {
+    pi_buff_rect_region_struct Region{Rect.Width, Rect.Height, Rect.Depth};
+    Plugin.call<PiApiKind::piextUSMEnqueueMemcpyRect>(
+        Queue, /* blocking */ false, DstMem, Rect.DstRowPitch,
+        Rect.DstSlicePitch, SrcMem, Rect.SrcRowPitch, Rect.SrcSlicePitch,
+        &Region, DepEvents.size(), DepEvents.data(), &OutEvent);
+    return;
+  }
+
+  // The plugins without rectangular copies copy the rows one by one.
+  std::vector<RT::PiEvent> RowEvents(Rect.Depth * Rect.Height);
+  for (size_t Z = 0; Z < Rect.Depth; ++Z)
+    for (size_t Y = 0; Y < Rect.Height; ++Y)
+      Plugin.call<PiApiKind::piextUSMEnqueueMemcpy>(
+          Queue, /* blocking */ false,
+          Dst + Z * Rect.DstSlicePitch + Y * Rect.DstRowPitch,
+          Src + Z * Rect.SrcSlicePitch + Y * Rect.SrcRowPitch, Rect.Width,
+          DepEvents.size(), DepEvents.data(), &RowEvents[Z * Rect.Height + Y]);
+  joinRowEvents(Plugin, Queue, RowEvents, OutEvent);
+}
+
+void MemoryManager::fill_usm_rect(void *DstMem, QueueImplPtr Queue,
+                                  const USMRect &Rect,
+                                  const std::vector<char> &Pattern,
+                                  std::vector<RT::PiEvent> DepEvents,
+                                  RT::PiEvent &OutEvent) {
+  if (!Rect.Width || !Rect.Height)
+    return;
+  if (!DstMem)
+    throw runtime_error("NULL pointer argument in memory fill operation.",
+                        PI_INVALID_VALUE);
+
+  char *Dst = static_cast<char *>(DstMem);
+  const size_t PatternSize = Pattern.size();
+  if (Queue->is_host()) {
+    for (size_t Y = 0; Y < Rect.Height; ++Y)
+      for (size_t X = 0; X < Rect.Width; X += PatternSize)
+        std::memcpy(Dst + Y * Rect.DstRowPitch + X, Pattern.data(),
+                    PatternSize);
+    return;
+  }
+
+  const detail::plugin &Plugin = Queue->getPlugin();
+  RT::PiQueue PiQueue = Queue->getHandleRef();
+  if (Plugin.getPiPlugin().PiFunctionTable.piextUSMEnqueueFillRect) {
+    Plugin.call<PiApiKind::piextUSMEnqueueFillRect>(
+        PiQueue, DstMem, Rect.DstRowPitch, Pattern.data(), PatternSize,
+        Rect.Width, Rect.Height, DepEvents.size(), DepEvents.data(),
+        &OutEvent);
+    return;
+  }
+
+  // The plugins without rectangular fills fill the rows one by one. Memset
+  // only fills bytes, so the other patterns are written to the first row,
+  // which is then copied to the others.
+  std::vector<RT::PiEvent> RowEvents(Rect.Height);
+  if (PatternSize == 1) {
+    for (size_t Y = 0; Y < Rect.Height; ++Y)
+      Plugin.call<PiApiKind::piextUSMEnqueueMemset>(
+          PiQueue, Dst + Y * Rect.DstRowPitch, Pattern[0], Rect.Width,
+          DepEvents.size(), DepEvents.data(), &RowEvents[Y]);
+  } else {
+    std::vector<char> Row(Rect.Width);
+    for (size_t X = 0; X < Rect.Width; X += PatternSize)
+      std::memcpy(Row.data() + X, Pattern.data(), PatternSize);
+    // The copy of the first row blocks, as Row is freed on return.
+    Plugin.call<PiApiKind::piextUSMEnqueueMemcpy>(
+        PiQueue, /* blocking */ true, Dst, Row.data(), Rect.Width,
+        DepEvents.size(), DepEvents.data(), &RowEvents[0]);
+    for (size_t Y = 1; Y < Rect.Height; ++Y)
+      Plugin.call<PiApiKind::piextUSMEnqueueMemcpy>(
+          PiQueue, /* blocking */ false, Dst + Y * Rect.DstRowPitch, Dst,
+          Rect.Width, 0, nullptr, &RowEvents[Y]);
+  }
+  joinRowEvents(Plugin, PiQueue, RowEvents, OutEvent);
+}
+
 void MemoryManager::prefetch_usm(void *Mem, QueueImplPtr Queue, size_t Length,
                                  std::vector<RT::PiEvent> DepEvents,
                                  RT::PiEvent &OutEvent) {
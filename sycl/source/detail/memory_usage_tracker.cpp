@@ -0,0 +1,72 @@
+//==-- memory_usage_tracker.cpp - Memory usage accounting of a context -----==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/config.hpp>
+#include <detail/memory_usage_tracker.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+
+static size_t getLimitConfig() {
+  const char *ValStr = SYCLConfig<SYCL_CONTEXT_MEMORY_LIMIT>::get();
+  if (!ValStr)
+    return 0;
+  return static_cast<size_t>(std::strtoull(ValStr, nullptr, 10));
+}
+
+MemoryUsageTracker::MemoryUsageTracker() : MLimit(getLimitConfig()) {}
+
+bool MemoryUsageTracker::fits(size_t Size, size_t Cached) const {
+  if (MLimit == 0)
+    return true;
+  std::lock_guard<std::mutex> Lock(MMutex);
+  return MTotal + Cached <= MLimit && Size <= MLimit - MTotal - Cached;
+}
+
+void MemoryUsageTracker::recordAllocation(void *Ptr, Category C, size_t Size) {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  if (!MAllocations.emplace(Ptr, std::make_pair(C, Size)).second)
+    return;
+  MUsage[static_cast<size_t>(C)] += Size;
+  MTotal += Size;
+  MPeak = std::max(MPeak, MTotal);
+}
+
+bool MemoryUsageTracker::recordRelease(void *Ptr) {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  auto It = MAllocations.find(Ptr);
+  if (It == MAllocations.end())
+    return false;
+  MUsage[static_cast<size_t>(It->second.first)] -= It->second.second;
+  MTotal -= It->second.second;
+  MAllocations.erase(It);
+  return true;
+}
+
+ONEAPI::memory_usage MemoryUsageTracker::getUsage(size_t Cached) const {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  ONEAPI::memory_usage Usage;
+  Usage.buffers = MUsage[static_cast<size_t>(Category::Buffer)];
+  Usage.images = MUsage[static_cast<size_t>(Category::Image)];
+  Usage.usm_device = MUsage[static_cast<size_t>(Category::USMDevice)];
+  Usage.usm_host = MUsage[static_cast<size_t>(Category::USMHost)];
+  Usage.usm_shared = MUsage[static_cast<size_t>(Category::USMShared)];
+  Usage.cached = Cached;
+  Usage.total = MTotal + Cached;
+  Usage.peak = MPeak;
+  Usage.limit = MLimit;
+  return Usage;
+}
+
+} // namespace detail
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
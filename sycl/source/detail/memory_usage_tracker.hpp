@@ -0,0 +1,73 @@
+//==-- memory_usage_tracker.hpp - Memory usage accounting of a context -----==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl/ONEAPI/memory_usage.hpp>
+#include <CL/sycl/detail/defines.hpp>
+
+#include <array>
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+
+/// Accounting of the memory a context allocates through the plugin.
+///
+/// Every allocation is recorded with its category and size when it is made
+/// and forgotten when it is released, so that releasing a pointer which has
+/// never been recorded, e.g. user provided memory, is harmless.
+///
+/// The limit is soft: it is checked by fits() before an allocation, which is
+/// not atomic with recording it, so concurrent allocations may overshoot it.
+class MemoryUsageTracker {
+public:
+  enum class Category { Buffer, Image, USMDevice, USMHost, USMShared };
+
+  /// Constructs the tracker with the limit set by SYCL_CONTEXT_MEMORY_LIMIT.
+  MemoryUsageTracker();
+  explicit MemoryUsageTracker(size_t Limit) : MLimit(Limit) {}
+  MemoryUsageTracker(const MemoryUsageTracker &) = delete;
+  MemoryUsageTracker &operator=(const MemoryUsageTracker &) = delete;
+
+  /// \return the limit of the total usage, zero if there is none.
+  size_t getLimit() const { return MLimit; }
+
+  /// \return true if \p Size more bytes fit under the limit while \p Cached
+  /// bytes are kept by the caches of the context.
+  bool fits(size_t Size, size_t Cached) const;
+
+  /// Records the allocation \p Ptr of \p Size bytes.
+  void recordAllocation(void *Ptr, Category C, size_t Size);
+
+  /// Forgets the allocation \p Ptr.
+  ///
+  /// \return false if \p Ptr has not been recorded.
+  bool recordRelease(void *Ptr);
+
+  /// \return the usage by category, with \p Cached bytes kept by the caches.
+  ONEAPI::memory_usage getUsage(size_t Cached) const;
+
+private:
+  static constexpr size_t NumCategories = 5;
+
+  const size_t MLimit;
+  mutable std::mutex MMutex;
+  std::unordered_map<void *, std::pair<Category, size_t>> MAllocations;
+  std::array<size_t, NumCategories> MUsage{};
+  size_t MTotal = 0;
+  size_t MPeak = 0;
+};
+
+} // namespace detail
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
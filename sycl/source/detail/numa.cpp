@@ -0,0 +1,180 @@
+//==--------- numa.cpp - Placement on the NUMA nodes of the host -----------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/numa.hpp>
+
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+
+#ifdef __linux__
+// The memory policies of <numaif.h>, which isn't available without libnuma.
+static constexpr int MPolPreferred = 1;
+#endif
+
+/// Parses the numbers of \p Str separated by \p Separators, in base \p Base.
+/// \return false if a field is empty or isn't a number.
+static bool parseFields(const std::string &Str, const char *Separators,
+                        int Base, std::vector<unsigned long> &Fields) {
+  size_t Begin = 0;
+  for (const char *Sep = Separators;; ++Sep) {
+    const size_t End = *Sep ? Str.find(*Sep, Begin) : Str.size();
+    if (End == std::string::npos || End == Begin)
+      return false;
+    for (size_t I = Begin; I < End; ++I)
+      if (!std::isxdigit(static_cast<unsigned char>(Str[I])) ||
+          (Base == 10 && !std::isdigit(static_cast<unsigned char>(Str[I]))))
+        return false;
+    Fields.push_back(std::strtoul(Str.substr(Begin, End - Begin).c_str(),
+                                  nullptr, Base));
+    if (!*Sep)
+      return true;
+    Begin = End + 1;
+  }
+}
+
+std::string normalizePciAddress(const std::string &Address) {
+  // Already in the sysfs format.
+  std::vector<unsigned long> Fields;
+  const bool IsSysfs = Address.size() == 12 && Address[4] == ':' &&
+                       Address[7] == ':' && Address[10] == '.';
+  if (IsSysfs) {
+    if (!parseFields(Address, "::.", 16, Fields))
+      return {};
+  } else if (!parseFields(Address, "::.", 10, Fields)) {
+    return {};
+  }
+  if (Fields[0] > 0xffff || Fields[1] > 0xff || Fields[2] > 0x1f ||
+      Fields[3] > 0x7)
+    return {};
+
+  char Buf[16];
+  std::snprintf(Buf, sizeof(Buf), "%04lx:%02lx:%02lx.%lx", Fields[0],
+                Fields[1], Fields[2], Fields[3]);
+  return Buf;
+}
+
+std::vector<size_t> parseCpuList(const std::string &List) {
+  std::vector<size_t> Cores;
+  size_t Begin = 0;
+  while (Begin < List.size()) {
+    size_t End = List.find(',', Begin);
+    if (End == std::string::npos)
+      End = List.size();
+    const std::string Range = List.substr(Begin, End - Begin);
+    std::vector<unsigned long> Bounds;
+    if (!parseFields(Range, "", 10, Bounds))
+      Bounds.clear();
+    if (Bounds.empty() && !parseFields(Range, "-", 10, Bounds))
+      return {};
+    const unsigned long Last = Bounds.back();
+    if (Last < Bounds.front())
+      return {};
+    for (unsigned long Core = Bounds.front(); Core <= Last; ++Core)
+      Cores.push_back(Core);
+    Begin = End + 1;
+  }
+  return Cores;
+}
+
+int getPciDeviceNumaNode(const std::string &PciAddress) {
+#ifdef __linux__
+  const std::string Address = normalizePciAddress(PciAddress);
+  if (Address.empty())
+    return -1;
+  std::ifstream File("/sys/bus/pci/devices/" + Address + "/numa_node");
+  int Node = -1;
+  // The node is -1 on the hosts without NUMA.
+  if (!(File >> Node))
+    return -1;
+  return Node;
+#else
+  (void)PciAddress;
+  return -1;
+#endif
+}
+
+std::vector<size_t> getNumaNodeCores(int Node) {
+#ifdef __linux__
+  if (Node < 0)
+    return {};
+  std::ifstream File("/sys/devices/system/node/node" + std::to_string(Node) +
+                     "/cpulist");
+  std::string List;
+  if (!std::getline(File, List))
+    return {};
+  return parseCpuList(List);
+#else
+  (void)Node;
+  return {};
+#endif
+}
+
+void preferNumaNode(void *Ptr, size_t Size, int Node) {
+#ifdef __linux__
+  constexpr size_t MaskBits = 8 * sizeof(unsigned long);
+  if (Node < 0 || static_cast<size_t>(Node) >= MaskBits)
+    return;
+  const uintptr_t PageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+  const uintptr_t Begin =
+      (reinterpret_cast<uintptr_t>(Ptr) + PageSize - 1) & ~(PageSize - 1);
+  const uintptr_t End = (reinterpret_cast<uintptr_t>(Ptr) + Size) &
+                        ~(PageSize - 1);
+  if (End <= Begin)
+    return;
+  const unsigned long Mask = 1ul << Node;
+  // Placement is a performance hint only, a failure is not an error. The
+  // kernel takes one more than the number of bits of the mask.
+  syscall(SYS_mbind, Begin, End - Begin, MPolPreferred, &Mask, MaskBits + 1,
+          0);
+#else
+  (void)Ptr;
+  (void)Size;
+  (void)Node;
+#endif
+}
+
+ScopedNumaNodePreference::ScopedNumaNodePreference(int Node) {
+#ifdef __linux__
+  constexpr size_t MaskBits = 8 * sizeof(unsigned long) * MaskLongs;
+  if (Node < 0 || static_cast<size_t>(Node) >= MaskBits)
+    return;
+  if (syscall(SYS_get_mempolicy, &MMode, MMask, MaskBits + 1, nullptr, 0) != 0)
+    return;
+  unsigned long Mask[MaskLongs] = {};
+  Mask[Node / (8 * sizeof(unsigned long))] =
+      1ul << (Node % (8 * sizeof(unsigned long)));
+  MRestore =
+      syscall(SYS_set_mempolicy, MPolPreferred, Mask, MaskBits + 1) == 0;
+#else
+  (void)Node;
+#endif
+}
+
+ScopedNumaNodePreference::~ScopedNumaNodePreference() {
+#ifdef __linux__
+  if (MRestore)
+    syscall(SYS_set_mempolicy, MMode, MMask,
+            8 * sizeof(unsigned long) * MaskLongs + 1);
+#endif
+}
+
+} // namespace detail
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -0,0 +1,72 @@
+//==--------- numa.hpp - Placement on the NUMA nodes of the host -*- C++ -*-==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl/detail/defines.hpp>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+
+// The transfers between the host memory and a device are the fastest from the
+// NUMA node the device is attached to, and so are the host threads feeding
+// it. The node of a device is read from sysfs by its PCI address. Placement is
+// only supported on Linux; elsewhere the nodes are unknown, and the functions
+// below do nothing.
+
+/// The smallest host allocation placed on a node. Placement works on whole
+/// pages, which smaller allocations share with others.
+constexpr size_t NumaMinPlacementSize = 1024 * 1024;
+
+/// \return the PCI address \p Address in the sysfs format "DDDD:BB:DD.F", or
+/// an empty string if it is malformed. Plugins report the address either so,
+/// in hexadecimal, or as decimal numbers without padding.
+std::string normalizePciAddress(const std::string &Address);
+
+/// \return the cores of a sysfs CPU list such as "0-3,8,10-11", or an empty
+/// vector if it is malformed.
+std::vector<size_t> parseCpuList(const std::string &List);
+
+/// \return the NUMA node of the PCI device at \p PciAddress, or -1 if it is
+/// unknown.
+int getPciDeviceNumaNode(const std::string &PciAddress);
+
+/// \return the host cores of the NUMA node \p Node, or an empty vector if they
+/// are unknown.
+std::vector<size_t> getNumaNodeCores(int Node);
+
+/// Makes the pages of [Ptr, Ptr + Size) which aren't touched yet prefer the
+/// NUMA node \p Node. Only the pages the range holds entirely are placed.
+void preferNumaNode(void *Ptr, size_t Size, int Node);
+
+/// Makes the memory the calling thread allocates in its scope prefer a NUMA
+/// node, e.g. the memory a plugin allocates and pins right away.
+class ScopedNumaNodePreference {
+public:
+  /// Does nothing if \p Node is negative.
+  explicit ScopedNumaNodePreference(int Node);
+  ~ScopedNumaNodePreference();
+  ScopedNumaNodePreference(const ScopedNumaNodePreference &) = delete;
+  ScopedNumaNodePreference &
+  operator=(const ScopedNumaNodePreference &) = delete;
+
+private:
+  static constexpr size_t MaskLongs = 16;
+  bool MRestore = false;
+  int MMode = 0;
+  unsigned long MMask[MaskLongs] = {};
+};
+
+} // namespace detail
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -24,17 +24,21 @@
 #include <libgen.h> // for dirname
 #include <link.h>
 #include <linux/limits.h> // for PATH_MAX
+#include <sys/stat.h>
 #include <sys/sysinfo.h>
 
 #elif defined(__SYCL_RT_OS_WINDOWS)
 
 #include <Windows.h>
+#include <direct.h>
 #include <malloc.h>
 #include <shlwapi.h>
+#include <sys/stat.h>
 
 #elif defined(__SYCL_RT_OS_DARWIN)
 
 #include <dlfcn.h>
+#include <sys/stat.h>
 #include <sys/sysctl.h>
 #include <sys/types.h>
 
@@ -258,6 +262,42 @@ void OSUtil::alignedFree(void *Ptr) {
 #endif
 }
 
+int OSUtil::makeDir(const char *Dir) {
+  assert((Dir != nullptr) && "Passed null-pointer as directory name.");
+  if (isPathPresent(Dir))
+    return 0;
+
+  // Create the parent directories first, so that the whole path is created
+  // similarly to "mkdir -p".
+  std::string Path{Dir};
+  size_t Pos = Path.find_last_of("/\\");
+  if (Pos != std::string::npos && Pos != 0) {
+    int Res = makeDir(Path.substr(0, Pos).c_str());
+    if (Res != 0)
+      return Res;
+  }
+
+#if defined(__SYCL_RT_OS_WINDOWS)
+  int Res = _mkdir(Path.c_str());
+#else
+  int Res = mkdir(Path.c_str(), 0777);
+#endif
+  // Another process could have created the directory in the meantime.
+  if (Res != 0 && isPathPresent(Path))
+    return 0;
+  return Res;
+}
+
+bool OSUtil::isPathPresent(const std::string &Path) {
+#if defined(__SYCL_RT_OS_WINDOWS)
+  struct _stat Stat;
+  return !_stat(Path.c_str(), &Stat);
+#else
+  struct stat Stat;
+  return !stat(Path.c_str(), &Stat);
+#endif
+}
+
 } // namespace detail
 } // namespace sycl
 } // __SYCL_INLINE_NAMESPACE(cl)
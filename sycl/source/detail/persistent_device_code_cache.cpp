@@ -0,0 +1,336 @@
+//==---------- persistent_device_code_cache.cpp -----------------*- C++-*---==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/config.hpp>
+#include <detail/device_impl.hpp>
+#include <detail/persistent_device_code_cache.hpp>
+#include <detail/plugin.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+
+constexpr const char *PersistentDeviceCodeCache::FormatVersion;
+constexpr size_t PersistentDeviceCodeCache::DefaultMinDeviceImageSize;
+constexpr size_t PersistentDeviceCodeCache::DefaultMaxDeviceImageSize;
+constexpr const char *LockCacheItem::LockSuffix;
+
+LockCacheItem::LockCacheItem(const std::string &Path)
+    : FileName(Path + LockSuffix) {
+  // The "x" mode makes fopen fail if the file already exists, which provides
+  // the exclusive ownership of the lock across threads and processes.
+  if (std::FILE *File = std::fopen(FileName.c_str(), "wx")) {
+    std::fclose(File);
+    Owned = true;
+  }
+}
+
+LockCacheItem::~LockCacheItem() {
+  if (Owned)
+    std::remove(FileName.c_str());
+}
+
+static size_t getSizeConfig(const char *ValStr, size_t Default) {
+  if (!ValStr)
+    return Default;
+  return static_cast<size_t>(std::strtoull(ValStr, nullptr, 10));
+}
+
+bool PersistentDeviceCodeCache::isEnabled() {
+  return SYCLConfig<SYCL_CACHE_PERSISTENT>::get();
+}
+
+bool PersistentDeviceCodeCache::isImageCached(const RTDeviceBinaryImage &Img) {
+  if (!isEnabled())
+    return false;
+
+  // Only the images which require JIT compilation are worth caching: native
+  // images are loaded as is anyway.
+  if (Img.getFormat() != PI_DEVICE_BINARY_TYPE_SPIRV)
+    return false;
+
+  static const size_t MinImageSize =
+      getSizeConfig(SYCLConfig<SYCL_CACHE_MIN_DEVICE_IMAGE_SIZE>::get(),
+                    DefaultMinDeviceImageSize);
+  static const size_t MaxImageSize =
+      getSizeConfig(SYCLConfig<SYCL_CACHE_MAX_DEVICE_IMAGE_SIZE>::get(),
+                    DefaultMaxDeviceImageSize);
+  size_t ImgSize = Img.getSize();
+  return ImgSize >= MinImageSize && ImgSize <= MaxImageSize;
+}
+
+std::string PersistentDeviceCodeCache::getRootDir() {
+  if (const char *RootDir = SYCLConfig<SYCL_CACHE_DIR>::get())
+    return RootDir;
+
+  constexpr char DeviceCodeCacheDir[] = "libsycl_cache";
+#if defined(__SYCL_RT_OS_WINDOWS)
+  if (const char *AppDataDir = std::getenv("AppData"))
+    return std::string(AppDataDir) + OSUtil::DirSep + DeviceCodeCacheDir;
+#else
+  if (const char *CacheDir = std::getenv("XDG_CACHE_HOME"))
+    return std::string(CacheDir) + OSUtil::DirSep + DeviceCodeCacheDir;
+  if (const char *HomeDir = std::getenv("HOME"))
+    return std::string(HomeDir) + OSUtil::DirSep + ".cache" + OSUtil::DirSep +
+           DeviceCodeCacheDir;
+#endif
+  return "";
+}
+
+std::string PersistentDeviceCodeCache::getDeviceIDString(const device &Device) {
+  platform Platform = Device.get_platform();
+  return Platform.get_info<info::platform::name>() + "/" +
+         Platform.get_info<info::platform::version>() + "/" +
+         Device.get_info<info::device::name>() + "/" +
+         Device.get_info<info::device::vendor>() + "/" +
+         Device.get_info<info::device::driver_version>();
+}
+
+std::string
+PersistentDeviceCodeCache::getSpecConstsString(const SerializedObj &SpecConsts) {
+  return {SpecConsts.begin(), SpecConsts.end()};
+}
+
+std::string PersistentDeviceCodeCache::getCacheItemPath(
+    const device &Device, const RTDeviceBinaryImage &Img,
+    const SerializedObj &SpecConsts, const std::string &BuildOptionsString) {
+  std::string RootDir = getRootDir();
+  if (RootDir.empty())
+    return {};
+
+  const pi_device_binary_struct &RawImg = Img.getRawData();
+  std::string ImgString{reinterpret_cast<const char *>(RawImg.BinaryStart),
+                        Img.getSize()};
+
+  std::hash<std::string> StringHasher{};
+  return RootDir + OSUtil::DirSep + FormatVersion + OSUtil::DirSep +
+         std::to_string(StringHasher(getDeviceIDString(Device))) +
+         OSUtil::DirSep + std::to_string(StringHasher(ImgString)) +
+         OSUtil::DirSep +
+         std::to_string(StringHasher(getSpecConstsString(SpecConsts) +
+                                     BuildOptionsString));
+}
+
+std::vector<std::vector<char>> PersistentDeviceCodeCache::getItemFromDisc(
+    const device &Device, const RTDeviceBinaryImage &Img,
+    const SerializedObj &SpecConsts, const std::string &BuildOptionsString) {
+  if (!isImageCached(Img))
+    return {};
+
+  std::string Path =
+      getCacheItemPath(Device, Img, SpecConsts, BuildOptionsString);
+  if (Path.empty() || !OSUtil::isPathPresent(Path))
+    return {};
+
+  for (size_t I = 0;; ++I) {
+    std::string FileName = Path + OSUtil::DirSep + std::to_string(I);
+    if (!OSUtil::isPathPresent(FileName + ".bin") &&
+        !LockCacheItem::isLocked(FileName))
+      break;
+
+    // Skip the items which are being written right now.
+    if (LockCacheItem::isLocked(FileName))
+      continue;
+
+    try {
+      if (isCacheItemSrcEqual(FileName + ".src", Device, Img, SpecConsts,
+                              BuildOptionsString))
+        return readBinaryDataFromFile(FileName + ".bin");
+    } catch (...) {
+      // The item is corrupted or was removed in the meantime, try the next
+      // one.
+    }
+  }
+  return {};
+}
+
+void PersistentDeviceCodeCache::putItemToDisc(
+    const device &Device, const RTDeviceBinaryImage &Img,
+    const SerializedObj &SpecConsts, const std::string &BuildOptionsString,
+    const RT::PiProgram &NativePrg) {
+  if (!isImageCached(Img))
+    return;
+
+  std::string DirName =
+      getCacheItemPath(Device, Img, SpecConsts, BuildOptionsString);
+  if (DirName.empty() || OSUtil::makeDir(DirName.c_str()) != 0)
+    return;
+
+  try {
+    std::vector<char> Binary = getProgramBinary(Device, NativePrg);
+    if (Binary.empty())
+      return;
+
+    std::string FileName;
+    for (size_t I = 0;; ++I) {
+      FileName = DirName + OSUtil::DirSep + std::to_string(I);
+      if (!OSUtil::isPathPresent(FileName + ".bin") &&
+          !LockCacheItem::isLocked(FileName))
+        break;
+    }
+
+    LockCacheItem Lock{FileName};
+    if (Lock.isOwned()) {
+      writeSourceItem(FileName + ".src", Device, Img, SpecConsts,
+                      BuildOptionsString);
+      writeBinaryDataToFile(FileName + ".bin", {std::move(Binary)});
+    }
+  } catch (...) {
+    // The cache is an optimization only, a failure to fill it in is not
+    // reported to the user.
+  }
+}
+
+std::vector<char>
+PersistentDeviceCodeCache::getProgramBinary(const device &Device,
+                                            const RT::PiProgram &NativePrg) {
+  const detail::plugin &Plugin = getSyclObjImpl(Device)->getPlugin();
+  const RT::PiDevice PiDevice = getSyclObjImpl(Device)->getHandleRef();
+
+  // The program may be associated with every device of the context, but it
+  // is built for the single one only.
+  size_t PIDevicesSize = 0;
+  Plugin.call<PiApiKind::piProgramGetInfo>(NativePrg, PI_PROGRAM_INFO_DEVICES,
+                                           0, nullptr, &PIDevicesSize);
+  std::vector<RT::PiDevice> PIDevices(PIDevicesSize / sizeof(RT::PiDevice));
+  Plugin.call<PiApiKind::piProgramGetInfo>(NativePrg, PI_PROGRAM_INFO_DEVICES,
+                                           PIDevicesSize, PIDevices.data(),
+                                           nullptr);
+  auto DeviceIt = std::find(PIDevices.begin(), PIDevices.end(), PiDevice);
+  if (DeviceIt == PIDevices.end())
+    return {};
+  size_t DeviceIdx = std::distance(PIDevices.begin(), DeviceIt);
+
+  std::vector<size_t> BinarySizes(PIDevices.size());
+  Plugin.call<PiApiKind::piProgramGetInfo>(
+      NativePrg, PI_PROGRAM_INFO_BINARY_SIZES,
+      sizeof(size_t) * BinarySizes.size(), BinarySizes.data(), nullptr);
+  if (BinarySizes[DeviceIdx] == 0)
+    return {};
+
+  std::vector<std::vector<char>> Result(BinarySizes.size());
+  std::vector<char *> Pointers(BinarySizes.size());
+  for (size_t I = 0; I < BinarySizes.size(); ++I) {
+    Result[I].resize(BinarySizes[I]);
+    Pointers[I] = Result[I].data();
+  }
+  Plugin.call<PiApiKind::piProgramGetInfo>(NativePrg, PI_PROGRAM_INFO_BINARIES,
+                                           sizeof(char *) * Pointers.size(),
+                                           Pointers.data(), nullptr);
+  return std::move(Result[DeviceIdx]);
+}
+
+void PersistentDeviceCodeCache::writeBinaryDataToFile(
+    const std::string &FileName, const std::vector<std::vector<char>> &Data) {
+  std::ofstream FileStream{FileName, std::ios::binary};
+  if (!FileStream.is_open())
+    return;
+
+  size_t Size = Data.size();
+  FileStream.write(reinterpret_cast<const char *>(&Size), sizeof(Size));
+  for (const std::vector<char> &Binary : Data) {
+    Size = Binary.size();
+    FileStream.write(reinterpret_cast<const char *>(&Size), sizeof(Size));
+    FileStream.write(Binary.data(), Size);
+  }
+  FileStream.close();
+  if (FileStream.fail())
+    std::remove(FileName.c_str());
+}
+
+std::vector<std::vector<char>>
+PersistentDeviceCodeCache::readBinaryDataFromFile(const std::string &FileName) {
+  std::ifstream FileStream{FileName, std::ios::binary};
+  if (!FileStream.is_open())
+    return {};
+
+  FileStream.seekg(0, std::ios::end);
+  const size_t FileSize = FileStream.tellg();
+  FileStream.seekg(0, std::ios::beg);
+
+  size_t NumBinaries = 0;
+  FileStream.read(reinterpret_cast<char *>(&NumBinaries), sizeof(NumBinaries));
+  if (FileStream.fail() || NumBinaries > FileSize / sizeof(size_t))
+    return {};
+
+  std::vector<std::vector<char>> Res(NumBinaries);
+  for (size_t I = 0; I < NumBinaries; ++I) {
+    size_t BinarySize = 0;
+    FileStream.read(reinterpret_cast<char *>(&BinarySize), sizeof(BinarySize));
+    if (FileStream.fail() || BinarySize > FileSize)
+      return {};
+    Res[I].resize(BinarySize);
+    FileStream.read(Res[I].data(), BinarySize);
+    if (FileStream.fail())
+      return {};
+  }
+  return Res;
+}
+
+void PersistentDeviceCodeCache::writeSourceItem(
+    const std::string &FileName, const device &Device,
+    const RTDeviceBinaryImage &Img, const SerializedObj &SpecConsts,
+    const std::string &BuildOptionsString) {
+  std::ofstream FileStream{FileName, std::ios::binary};
+  if (!FileStream.is_open())
+    return;
+
+  auto WriteString = [&FileStream](const std::string &Str) {
+    size_t Size = Str.size();
+    FileStream.write(reinterpret_cast<const char *>(&Size), sizeof(Size));
+    FileStream.write(Str.data(), Size);
+  };
+
+  const pi_device_binary_struct &RawImg = Img.getRawData();
+  WriteString(getDeviceIDString(Device));
+  WriteString(BuildOptionsString);
+  WriteString(getSpecConstsString(SpecConsts));
+  WriteString({reinterpret_cast<const char *>(RawImg.BinaryStart),
+               Img.getSize()});
+  FileStream.close();
+  if (FileStream.fail())
+    std::remove(FileName.c_str());
+}
+
+bool PersistentDeviceCodeCache::isCacheItemSrcEqual(
+    const std::string &FileName, const device &Device,
+    const RTDeviceBinaryImage &Img, const SerializedObj &SpecConsts,
+    const std::string &BuildOptionsString) {
+  std::ifstream FileStream{FileName, std::ios::binary};
+  if (!FileStream.is_open())
+    return false;
+
+  auto MatchString = [&FileStream](const char *Data, size_t Size) {
+    size_t StoredSize = 0;
+    FileStream.read(reinterpret_cast<char *>(&StoredSize), sizeof(StoredSize));
+    if (FileStream.fail() || StoredSize != Size)
+      return false;
+    std::vector<char> Stored(Size);
+    FileStream.read(Stored.data(), Size);
+    return !FileStream.fail() && std::equal(Stored.begin(), Stored.end(), Data);
+  };
+  auto MatchStdString = [&MatchString](const std::string &Str) {
+    return MatchString(Str.data(), Str.size());
+  };
+
+  const pi_device_binary_struct &RawImg = Img.getRawData();
+  return MatchStdString(getDeviceIDString(Device)) &&
+         MatchStdString(BuildOptionsString) &&
+         MatchStdString(getSpecConstsString(SpecConsts)) &&
+         MatchString(reinterpret_cast<const char *>(RawImg.BinaryStart),
+                     Img.getSize());
+}
+
+} // namespace detail
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
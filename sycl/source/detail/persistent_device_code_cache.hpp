@@ -0,0 +1,149 @@
+//==---------- persistent_device_code_cache.hpp -----------------*- C++-*---==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl/detail/device_binary_image.hpp>
+#include <CL/sycl/detail/os_util.hpp>
+#include <CL/sycl/detail/pi.hpp>
+#include <CL/sycl/detail/util.hpp>
+#include <CL/sycl/device.hpp>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+
+/* This is an on-disk cache of device programs built by the SYCL runtime. It
+ * outlives both the context and the process, so that warm application runs
+ * can create programs from native binaries instead of JIT compiling SPIR-V.
+ *
+ * The cache is disabled by default and is enabled by SYCL_CACHE_PERSISTENT=1.
+ * The cache root is taken from SYCL_CACHE_DIR and falls back to
+ * $XDG_CACHE_HOME/libsycl_cache, $HOME/.cache/libsycl_cache or
+ * %AppData%\libsycl_cache.
+ *
+ * Each item is kept in a directory built from hashes of its key components:
+ *   <root>/<format version>/<device>/<device image>/<build options and spec
+ *   constants>/<N>.bin
+ * The '.src' file next to each '.bin' file stores the unhashed key so that
+ * hash collisions are resolved by comparing it with the requested one. While
+ * an item is being written it is protected by a '.lock' file; locked items are
+ * skipped by readers.
+ *
+ * Any failure to read or write the cache is not an error: the program is
+ * built as if the cache is disabled.
+ */
+class PersistentDeviceCodeCache {
+public:
+  /// Returns true if the persistent cache is enabled by the configuration.
+  static bool isEnabled();
+
+  /// Returns true if programs built from the image can be put to the cache:
+  /// the cache is enabled, the image requires JIT compilation and its size is
+  /// within the configured limits.
+  static bool isImageCached(const RTDeviceBinaryImage &Img);
+
+  /// Returns the directory holding all cache items for the given key.
+  static std::string getCacheItemPath(const device &Device,
+                                      const RTDeviceBinaryImage &Img,
+                                      const SerializedObj &SpecConsts,
+                                      const std::string &BuildOptionsString);
+
+  /// Returns the native binaries of the program built for the given key or an
+  /// empty vector if there is no such item in the cache.
+  static std::vector<std::vector<char>>
+  getItemFromDisc(const device &Device, const RTDeviceBinaryImage &Img,
+                  const SerializedObj &SpecConsts,
+                  const std::string &BuildOptionsString);
+
+  /// Stores the native binaries of the built program \p NativePrg under the
+  /// given key.
+  static void putItemToDisc(const device &Device,
+                            const RTDeviceBinaryImage &Img,
+                            const SerializedObj &SpecConsts,
+                            const std::string &BuildOptionsString,
+                            const RT::PiProgram &NativePrg);
+
+  /// Returns a string which identifies the device and its driver, so that a
+  /// driver update invalidates the cached binaries.
+  static std::string getDeviceIDString(const device &Device);
+
+  /// Returns a string which represents the spec constant values.
+  static std::string getSpecConstsString(const SerializedObj &SpecConsts);
+
+  /// Returns the native binary of the program \p NativePrg built for the
+  /// device, or an empty vector if the plugin provides none.
+  static std::vector<char> getProgramBinary(const device &Device,
+                                            const RT::PiProgram &NativePrg);
+
+  /// Version of the layout of the cache items on disk. Must be bumped every
+  /// time the layout changes, so that stale items are never read.
+  static constexpr const char *FormatVersion = "v1";
+
+  /// Images smaller than this are rebuilt faster than read from disk.
+  static constexpr size_t DefaultMinDeviceImageSize = 0;
+
+  /// Images larger than this are not cached to limit the disk usage.
+  static constexpr size_t DefaultMaxDeviceImageSize = 1024 * 1024 * 1024;
+
+private:
+  /// Returns the root directory of the cache.
+  static std::string getRootDir();
+
+  /// Writes the binaries to the file in form of a count of binaries followed
+  /// by size-prefixed binary data.
+  static void writeBinaryDataToFile(const std::string &FileName,
+                                    const std::vector<std::vector<char>> &Data);
+
+  /// Reads the binaries written by writeBinaryDataToFile.
+  static std::vector<std::vector<char>>
+  readBinaryDataFromFile(const std::string &FileName);
+
+  /// Writes the unhashed key of the cache item.
+  static void writeSourceItem(const std::string &FileName,
+                              const device &Device,
+                              const RTDeviceBinaryImage &Img,
+                              const SerializedObj &SpecConsts,
+                              const std::string &BuildOptionsString);
+
+  /// Checks that the unhashed key stored in the file matches the given one.
+  static bool isCacheItemSrcEqual(const std::string &FileName,
+                                  const device &Device,
+                                  const RTDeviceBinaryImage &Img,
+                                  const SerializedObj &SpecConsts,
+                                  const std::string &BuildOptionsString);
+};
+
+/// Guards a cache item against concurrent writes by other threads and
+/// processes. The lock is held for the lifetime of the object if it has been
+/// acquired successfully.
+class LockCacheItem {
+public:
+  LockCacheItem(const std::string &Path);
+  ~LockCacheItem();
+
+  bool isOwned() const { return Owned; }
+
+  static bool isLocked(const std::string &Path) {
+    return OSUtil::isPathPresent(Path + LockSuffix);
+  }
+
+private:
+  const std::string FileName;
+  bool Owned = false;
+
+  static constexpr const char *LockSuffix = ".lock";
+};
+
+} // namespace detail
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -96,10 +96,15 @@ uint64_t emitFunctionBeginTrace(const char *FName) {
   /// \endcode
   if (xptiTraceEnabled()) {
     uint8_t StreamID = xptiRegisterStream(SYCL_PICALL_STREAM_NAME);
+    // A call that is not sampled keeps a zero CorrelationID, so that its
+    // function_end is not sent either
+    uint16_t TraceType = (uint16_t)xpti::trace_point_type_t::function_begin;
+    if (!xptiCheckTraceEnabled(StreamID, TraceType) ||
+        !xptiSampleTrace(StreamID))
+      return CorrelationID;
     CorrelationID = xptiGetUniqueId();
-    xptiNotifySubscribers(
-        StreamID, (uint16_t)xpti::trace_point_type_t::function_begin,
-        GPICallEvent, nullptr, CorrelationID, static_cast<const void *>(FName));
+    xptiNotifySubscribers(StreamID, TraceType, GPICallEvent, nullptr,
+                          CorrelationID, static_cast<const void *>(FName));
   }
 #endif // XPTI_ENABLE_INSTRUMENTATION
   return CorrelationID;
@@ -107,7 +112,7 @@ uint64_t emitFunctionBeginTrace(const char *FName) {
 
 void emitFunctionEndTrace(uint64_t CorrelationID, const char *FName) {
 #ifdef XPTI_ENABLE_INSTRUMENTATION
-  if (xptiTraceEnabled()) {
+  if (CorrelationID && xptiTraceEnabled()) {
     // CorrelationID is the unique ID that ties together a function_begin and
     // function_end pair of trace calls. The splitting of a scoped_notify into
     // two function calls incurs an additional overhead as the StreamID must
@@ -589,7 +594,10 @@ void DeviceBinaryImage::init(pi_device_binary Bin) {
   // it when invoking the offload wrapper job
   Format = static_cast<pi::PiDeviceBinaryType>(Bin->Format);
 
-  if (Format == PI_DEVICE_BINARY_TYPE_NONE)
+  CompressedImageInfo.init(Bin, __SYCL_PI_PROPERTY_SET_COMPRESSED_IMAGE);
+  // The format of a compressed image is determined once it is decompressed.
+  if (Format == PI_DEVICE_BINARY_TYPE_NONE &&
+      !CompressedImageInfo.isAvailable())
     // try to determine the format; may remain "NONE"
     Format = getBinaryImageFormat(Bin->BinaryStart, getSize());
 
@@ -598,6 +606,15 @@ void DeviceBinaryImage::init(pi_device_binary Bin) {
                                __SYCL_PI_PROPERTY_SET_COMPOSITE_SPEC_CONST_MAP);
   DeviceLibReqMask.init(Bin, __SYCL_PI_PROPERTY_SET_DEVICELIB_REQ_MASK);
   KernelParamOptInfo.init(Bin, __SYCL_PI_PROPERTY_SET_KERNEL_PARAM_OPT_INFO);
+  KernelParamFieldOptInfo.init(
+      Bin, __SYCL_PI_PROPERTY_SET_KERNEL_PARAM_FIELD_OPT_INFO);
+  SpecConstBufferLayout.init(Bin,
+                             __SYCL_PI_PROPERTY_SET_SPEC_CONST_BUFFER_LAYOUT);
+  KernelSpecConstBuffer.init(Bin,
+                             __SYCL_PI_PROPERTY_SET_KERNEL_SPEC_CONST_BUFFER);
+  MiscProperties.init(Bin, __SYCL_PI_PROPERTY_SET_SYCL_MISC_PROP);
+  SubGroupSizeVariants.init(Bin,
+                            __SYCL_PI_PROPERTY_SET_SUB_GROUP_SIZE_VARIANTS);
 }
 
 } // namespace pi
@@ -9,6 +9,7 @@
 #include <CL/sycl/device.hpp>
 #include <detail/config.hpp>
 #include <detail/device_impl.hpp>
+#include <detail/device_selection_cache.hpp>
 #include <detail/force_device.hpp>
 #include <detail/global_handler.hpp>
 #include <detail/platform_impl.hpp>
@@ -16,8 +17,10 @@
 
 #include <algorithm>
 #include <cstring>
+#include <exception>
 #include <regex>
 #include <string>
+#include <thread>
 #include <vector>
 
 __SYCL_INLINE_NAMESPACE(cl) {
@@ -92,38 +95,75 @@ static bool IsBannedPlatform(platform Platform) {
   return IsNVIDIAOpenCL(Platform);
 }
 
-vector_class<platform> platform_impl::get_platforms() {
+// Enumerates the platforms of the plugin which have devices of the type.
+static vector_class<platform> getPluginPlatforms(const plugin &Plugin,
+                                                 info::device_type DeviceType) {
   vector_class<platform> Platforms;
+  pi_uint32 NumPlatforms = 0;
+  Plugin.call<PiApiKind::piPlatformsGet>(0, nullptr, &NumPlatforms);
+
+  if (NumPlatforms) {
+    vector_class<RT::PiPlatform> PiPlatforms(NumPlatforms);
+    Plugin.call<PiApiKind::piPlatformsGet>(NumPlatforms, PiPlatforms.data(),
+                                           nullptr);
+
+    for (const auto &PiPlatform : PiPlatforms) {
+      platform Platform = detail::createSyclObjFromImpl<platform>(
+          platform_impl::getOrMakePlatformImpl(PiPlatform, Plugin));
+      // Skip platforms which do not contain requested device types
+      if (!Platform.get_devices(DeviceType).empty() &&
+          !IsBannedPlatform(Platform))
+        Platforms.push_back(Platform);
+    }
+  }
+  return Platforms;
+}
+
+static vector_class<platform> enumeratePlatforms() {
   const vector_class<plugin> &Plugins = RT::initialize();
 
   info::device_type ForcedType = detail::get_forced_type();
-  for (unsigned int i = 0; i < Plugins.size(); i++) {
-
-    pi_uint32 NumPlatforms = 0;
-    Plugins[i].call<PiApiKind::piPlatformsGet>(0, nullptr, &NumPlatforms);
-
-    if (NumPlatforms) {
-      vector_class<RT::PiPlatform> PiPlatforms(NumPlatforms);
-      Plugins[i].call<PiApiKind::piPlatformsGet>(NumPlatforms,
-                                                 PiPlatforms.data(), nullptr);
-
-      for (const auto &PiPlatform : PiPlatforms) {
-        platform Platform = detail::createSyclObjFromImpl<platform>(
-            getOrMakePlatformImpl(PiPlatform, Plugins[i]));
-        // Skip platforms which do not contain requested device types
-        if (!Platform.get_devices(ForcedType).empty() &&
-            !IsBannedPlatform(Platform))
-          Platforms.push_back(Platform);
-      }
-    }
+  vector_class<vector_class<platform>> PluginPlatforms(Plugins.size());
+  if (Plugins.size() == 1) {
+    PluginPlatforms[0] = getPluginPlatforms(Plugins[0], ForcedType);
+  } else {
+    // The first calls to a backend initialize its driver, which takes long
+    // for some of them, so the plugins are enumerated in parallel.
+    vector_class<std::exception_ptr> Errors(Plugins.size());
+    vector_class<std::thread> Threads;
+    Threads.reserve(Plugins.size());
+    for (size_t I = 0; I < Plugins.size(); ++I)
+      Threads.emplace_back([&, I]() {
+        try {
+          PluginPlatforms[I] = getPluginPlatforms(Plugins[I], ForcedType);
+        } catch (...) {
+          Errors[I] = std::current_exception();
+        }
+      });
+    for (std::thread &Thread : Threads)
+      Thread.join();
+    for (const std::exception_ptr &Error : Errors)
+      if (Error)
+        std::rethrow_exception(Error);
   }
 
+  vector_class<platform> Platforms;
+  for (const vector_class<platform> &Found : PluginPlatforms)
+    Platforms.insert(Platforms.end(), Found.begin(), Found.end());
+
   // The host platform should always be available.
   Platforms.emplace_back(platform());
 
   return Platforms;
 }
 
+vector_class<platform> platform_impl::get_platforms() {
+  // The plugins are loaded once and their platforms don't change, so they are
+  // only enumerated once.
+  return GlobalHandler::instance().getDeviceSelectionCache().getPlatforms(
+      enumeratePlatforms);
+}
+
 std::string getValue(const std::string &AllowList, size_t &Pos,
                      unsigned long int Size) {
   size_t Prev = Pos;
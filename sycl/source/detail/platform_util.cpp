@@ -158,6 +158,25 @@ uint32_t PlatformUtil::getNativeVectorWidth(PlatformUtil::TypeIndex TIndex) {
   return 0;
 }
 
+bool PlatformUtil::hasHalfConversions() {
+#if defined(__x86_64__) || defined(__i386__)
+  // The F16C instructions operate on YMM registers, which the OS must save.
+  // f16c = CPUID.1.ECX[29]
+  uint32_t Info[4];
+  cpuid(Info, 1);
+#if defined(__SYCL_RT_OS_LINUX)
+  return __builtin_cpu_supports("avx") && (Info[2] & (1 << 29));
+#elif defined(__SYCL_RT_OS_WINDOWS)
+  // avx = CPUID.1.ECX[28]
+  return (Info[2] & (1 << 28)) && (Info[2] & (1 << 29));
+#endif
+#elif defined(__aarch64__)
+  // The conversions are part of the base ARMv8 instruction set.
+  return true;
+#endif
+  return false;
+}
+
 void PlatformUtil::prefetch(const char *Ptr, size_t NumBytes) {
   if (!Ptr)
     return;
@@ -41,6 +41,10 @@ struct PlatformUtil {
   static uint64_t getMemCacheSize();
 
   static void prefetch(const char *Ptr, size_t NumBytes);
+
+  /// Returns true if the host converts between half and float vectors with
+  /// instructions, i.e. with the F16C extension on x86.
+  static bool hasHalfConversions();
 };
 
 } // namespace detail
@@ -33,7 +33,8 @@ public:
   plugin() = delete;
 
   plugin(RT::PiPlugin Plugin, backend UseBackend)
-      : MPlugin(Plugin), MBackend(UseBackend) {}
+      : MPlugin(Plugin), MBackend(UseBackend),
+        MTraceCalls(pi::trace(pi::TraceLevel::PI_TRACE_CALLS)) {}
 
   plugin &operator=(const plugin &) = default;
   plugin(const plugin &) = default;
@@ -66,20 +67,53 @@ public:
   template <PiApiKind PiApiOffset, typename... ArgsT>
   RT::PiResult call_nocheck(ArgsT... Args) const {
     RT::PiFuncInfo<PiApiOffset> PiCallInfo;
+    // Keep the untraced call free of the tracing code, it is on the hot path
+    // of every submission.
+    if (!isTracingEnabled())
+      return PiCallInfo.getFuncPtr(MPlugin)(Args...);
+    return callTraced<PiApiOffset>(Args...);
+  }
+
+  /// Calls the API, traces the call, checks the result
+  ///
+  /// \throw cl::sycl::runtime_exception if the call was not successful.
+  template <PiApiKind PiApiOffset, typename... ArgsT>
+  void call(ArgsT... Args) const {
+    RT::PiResult Err = call_nocheck<PiApiOffset>(Args...);
+    checkPiResult(Err);
+  }
+
+  backend getBackend(void) const { return MBackend; }
+
+private:
+  /// Returns true if the PI calls are traced either by SYCL_PI_TRACE or by
+  /// an XPTI subscriber.
+  bool isTracingEnabled() const {
+#ifdef XPTI_ENABLE_INSTRUMENTATION
+    if (xptiTraceEnabled())
+      return true;
+#endif
+    return MTraceCalls;
+  }
+
+  template <PiApiKind PiApiOffset, typename... ArgsT>
+  RT::PiResult callTraced(ArgsT... Args) const {
+    RT::PiFuncInfo<PiApiOffset> PiCallInfo;
 #ifdef XPTI_ENABLE_INSTRUMENTATION
     // Emit a function_begin trace for the PI API before the call is executed.
     // If arguments need to be captured, then a data structure can be sent in
     // the per_instance_user_data field.
-    std::string PIFnName = PiCallInfo.getFuncName();
-    uint64_t CorrelationID = pi::emitFunctionBeginTrace(PIFnName.c_str());
+    const char *PIFnName = PiCallInfo.getFuncName();
+    uint64_t CorrelationID = pi::emitFunctionBeginTrace(PIFnName);
 #endif
-    if (pi::trace(pi::TraceLevel::PI_TRACE_CALLS)) {
-      std::string FnName = PiCallInfo.getFuncName();
-      std::cout << "---> " << FnName << "(" << std::endl;
+    if (MTraceCalls) {
+      std::cout << "---> " << PiCallInfo.getFuncName() << "(" << std::endl;
       RT::printArgs(Args...);
     }
+
     RT::PiResult R = PiCallInfo.getFuncPtr(MPlugin)(Args...);
-    if (pi::trace(pi::TraceLevel::PI_TRACE_CALLS)) {
+
+    if (MTraceCalls) {
       std::cout << ") ---> ";
       RT::printArgs(R);
       RT::printOuts(Args...);
@@ -87,25 +121,16 @@ public:
     }
 #ifdef XPTI_ENABLE_INSTRUMENTATION
     // Close the function begin with a call to function end
-    pi::emitFunctionEndTrace(CorrelationID, PIFnName.c_str());
+    pi::emitFunctionEndTrace(CorrelationID, PIFnName);
 #endif
     return R;
   }
 
-  /// Calls the API, traces the call, checks the result
-  ///
-  /// \throw cl::sycl::runtime_exception if the call was not successful.
-  template <PiApiKind PiApiOffset, typename... ArgsT>
-  void call(ArgsT... Args) const {
-    RT::PiResult Err = call_nocheck<PiApiOffset>(Args...);
-    checkPiResult(Err);
-  }
-
-  backend getBackend(void) const { return MBackend; }
-
-private:
   RT::PiPlugin MPlugin;
   backend MBackend;
+  /// SYCL_PI_TRACE is read once, so whether the calls are printed is known
+  /// when the plugin is created.
+  bool MTraceCalls;
 }; // class plugin
 } // namespace detail
 } // namespace sycl
@@ -204,6 +204,8 @@ program_impl::program_impl(ContextImplPtr Context, RT::PiKernel Kernel)
 program_impl::~program_impl() {
   // TODO catch an exception and put it to list of asynchronous exceptions
   if (!is_host() && MProgram != nullptr) {
+    if (MProgramAndKernelCachingAllowed)
+      MContext->getKernelProgramCache().unpinSpecializedBuild(MProgram);
     const detail::plugin &Plugin = getPlugin();
     Plugin.call<PiApiKind::piProgramRelease>(MProgram);
   }
@@ -259,7 +261,8 @@ void program_impl::build_with_kernel_name(string_class KernelName,
       MProgramAndKernelCachingAllowed = true;
       MProgram = ProgramManager::getInstance().getBuiltPIProgram(
           Module, get_context(), get_devices()[0], KernelName, this,
-          /*JITCompilationIsRequired=*/(!BuildOptions.empty()));
+          /*JITCompilationIsRequired=*/(!BuildOptions.empty()),
+          /*PinSpecializedBuild=*/true);
       const detail::plugin &Plugin = getPlugin();
       Plugin.call<PiApiKind::piProgramRetain>(MProgram);
     } else {
@@ -337,6 +337,11 @@ public:
   /// Tells whether a specialization constant has been set for this program.
   bool hasSetSpecConstants() const { return !SpecConstRegistry.empty(); }
 
+  /// Returns the values of the spec constants set in the program.
+  const SpecConstRegistryT &getSpecConstRegistry() const {
+    return SpecConstRegistry;
+  }
+
   /// \return true if caching is allowed for this program.
   bool is_cacheable() const { return MProgramAndKernelCachingAllowed; }
 
@@ -20,9 +20,11 @@
 #include <detail/context_impl.hpp>
 #include <detail/device_impl.hpp>
 #include <detail/global_handler.hpp>
+#include <detail/persistent_device_code_cache.hpp>
 #include <detail/program_impl.hpp>
 #include <detail/program_manager/program_manager.hpp>
 #include <detail/spec_constant_impl.hpp>
+#include <detail/thread_pool.hpp>
 
 #include <algorithm>
 #include <cassert>
@@ -30,10 +32,13 @@
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
+#include <iterator>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <sstream>
 #include <string>
+#include <unordered_set>
 
 __SYCL_INLINE_NAMESPACE(cl) {
 namespace sycl {
@@ -43,8 +48,6 @@ using ContextImplPtr = std::shared_ptr<cl::sycl::detail::context_impl>;
 
 static constexpr int DbgProgMgr = 0;
 
-enum BuildState { BS_InProgress, BS_Done, BS_Failed };
-
 static constexpr char UseSpvEnv[]("SYCL_USE_KERNEL_SPV");
 
 ProgramManager &ProgramManager::getInstance() {
@@ -346,12 +349,164 @@ RT::PiProgram ProgramManager::createPIProgram(const RTDeviceBinaryImage &Img,
   return Res;
 }
 
-RT::PiProgram ProgramManager::getBuiltPIProgram(OSModuleHandle M,
-                                                const context &Context,
-                                                const device &Device,
-                                                const string_class &KernelName,
-                                                const program_impl *Prg,
-                                                bool JITCompilationIsRequired) {
+/// \return true if the kernels of the image are ESIMD ones.
+static bool isEsimdImage(const RTDeviceBinaryImage &Img) {
+  for (const pi_device_binary_property &Prop : Img.getMiscProperties())
+    if (std::strcmp(Prop->Name, "isEsimdImage") == 0)
+      return pi::DeviceBinaryProperty(Prop).asUint32() != 0;
+  return false;
+}
+
+/// \return the compile options of the programs built from the image.
+static std::string getCompileOptions(const RTDeviceBinaryImage &Img) {
+  if (const char *CompileOpts = std::getenv("SYCL_PROGRAM_COMPILE_OPTIONS"))
+    return CompileOpts;
+  std::string CompileOpts = Img.getCompileOptions();
+  // The ESIMD images split from the SYCL ones by sycl-post-link are compiled
+  // by the vector back-end, whatever the options of the other images.
+  if (isEsimdImage(Img) && CompileOpts.find("-vc-codegen") == std::string::npos)
+    CompileOpts += CompileOpts.empty() ? "-vc-codegen" : " -vc-codegen";
+  return CompileOpts;
+}
+
+/// \return the link options of the programs built from the image.
+static const char *getLinkOptions(const RTDeviceBinaryImage &Img) {
+  if (const char *LinkOpts = std::getenv("SYCL_PROGRAM_LINK_OPTIONS"))
+    return LinkOpts;
+  return Img.getLinkOptions();
+}
+
+/// The sub-group sizes of kernels set by the SYCL_SUB_GROUP_SIZE_TABLE file,
+/// by kernel name and then by device name, the empty name matching any device.
+using SubGroupSizeTable =
+    std::unordered_map<std::string, std::unordered_map<std::string, uint32_t>>;
+
+/// \return the table of the SYCL_SUB_GROUP_SIZE_TABLE file. Every line of the
+/// file holds a kernel name and a sub-group size, optionally followed by the
+/// name of the devices the size is for. Malformed lines are ignored.
+static const SubGroupSizeTable &getSubGroupSizeTable() {
+  static const SubGroupSizeTable Table = [] {
+    SubGroupSizeTable Table;
+    const char *FileName = SYCLConfig<SYCL_SUB_GROUP_SIZE_TABLE>::get();
+    if (!FileName)
+      return Table;
+    std::ifstream File(FileName);
+    std::string Line;
+    while (std::getline(File, Line)) {
+      std::istringstream LineStream(Line);
+      std::string KernelName;
+      uint32_t Size = 0;
+      if (!(LineStream >> KernelName >> Size) || KernelName[0] == '#')
+        continue;
+      std::string DeviceName;
+      std::getline(LineStream >> std::ws, DeviceName);
+      Table[KernelName][DeviceName] = Size;
+    }
+    return Table;
+  }();
+  return Table;
+}
+
+/// \return the names of the sub-group size variants of the kernels of the
+/// image to run on the device instead of the kernels, by kernel name.
+///
+/// The size set for the device by the SYCL_SUB_GROUP_SIZE_TABLE file is used
+/// if the kernel has a variant for it. Otherwise the largest size the device
+/// supports is used, as it needs the fewest hardware threads. The kernel
+/// itself is run if the device supports none of the sizes.
+static std::unordered_map<string_class, string_class>
+pickSubGroupSizeVariants(const RTDeviceBinaryImage &Img,
+                         const device &Device) {
+  std::unordered_map<string_class, string_class> VariantNames;
+  const pi::DeviceBinaryImage::PropertyRange &Variants =
+      Img.getSubGroupSizeVariants();
+  if (!Variants.isAvailable())
+    return VariantNames;
+
+  vector_class<size_t> DeviceSizes;
+  try {
+    DeviceSizes = Device.get_info<info::device::sub_group_sizes>();
+  } catch (const exception &) {
+    // No size is known to be supported, only the table can pick one.
+  }
+  const SubGroupSizeTable &Table = getSubGroupSizeTable();
+  const std::string DeviceName =
+      Table.empty() ? std::string() : Device.get_info<info::device::name>();
+
+  for (const auto &Info : Variants) {
+    // The byte array starts with its size in bits, followed by the sizes as
+    // 32-bit words.
+    const pi::ByteArray Bytes = pi::DeviceBinaryProperty(Info).asByteArray();
+    const int NBytesForSize = 8;
+    std::vector<uint32_t> Sizes((Bytes.size() - NBytesForSize) / 4);
+    for (size_t I = 0; I < Sizes.size(); ++I)
+      for (int B = 0; B < 4; ++B)
+        Sizes[I] |= static_cast<uint32_t>(Bytes[NBytesForSize + I * 4 + B])
+                    << B * 8;
+
+    uint32_t Picked = 0;
+    auto KernelIt = Table.find(Info->Name);
+    if (KernelIt != Table.end()) {
+      auto SizeIt = KernelIt->second.find(DeviceName);
+      if (SizeIt == KernelIt->second.end())
+        SizeIt = KernelIt->second.find(std::string());
+      if (SizeIt != KernelIt->second.end() &&
+          std::find(Sizes.begin(), Sizes.end(), SizeIt->second) != Sizes.end())
+        Picked = SizeIt->second;
+    }
+    if (!Picked)
+      for (uint32_t Size : Sizes)
+        if (Size > Picked && std::find(DeviceSizes.begin(), DeviceSizes.end(),
+                                       Size) != DeviceSizes.end())
+          Picked = Size;
+    if (Picked)
+      VariantNames[Info->Name] =
+          string_class(Info->Name) + "__sg" + std::to_string(Picked);
+  }
+  return VariantNames;
+}
+
+size_t ProgramManager::getProgramSizeEstimate(RT::PiProgram Program) {
+  std::lock_guard<std::mutex> Lock(MNativeProgramsMutex);
+  auto It = NativePrograms.find(Program);
+  return It == NativePrograms.end() ? 0 : It->second->getSize();
+}
+
+/// \return the value of a limit of the program cache, the default one if not
+/// set. Zero lifts the limit.
+template <ConfigID Config> static size_t getCacheLimitConfig(size_t Default) {
+  const char *ValStr = SYCLConfig<Config>::get();
+  size_t Val = ValStr ? static_cast<size_t>(std::strtoull(ValStr, nullptr, 10))
+                      : Default;
+  return Val ? Val : std::numeric_limits<size_t>::max();
+}
+
+/// \return the capacity of the program cache for the specialized builds.
+static const KernelProgramCache::SpecializedBuildLimits &
+getSpecializedBuildLimits() {
+  static const KernelProgramCache::SpecializedBuildLimits Limits{
+      getCacheLimitConfig<SYCL_CACHE_MAX_SPECIALIZED_BUILDS>(32),
+      getCacheLimitConfig<SYCL_CACHE_MAX_PROGRAMS>(0),
+      getCacheLimitConfig<SYCL_CACHE_MAX_PROGRAMS_SIZE>(0)};
+  return Limits;
+}
+
+bool ProgramManager::isImageBuiltForContext(const RTDeviceBinaryImage &Img,
+                                            const ContextImplPtr &Ctx,
+                                            RT::PiDevice Device) {
+  std::unordered_set<RT::PiDevice> &BuiltDevices = MImageBuiltDevices[&Img];
+  BuiltDevices.insert(Device);
+  return std::all_of(Ctx->getDevices().begin(), Ctx->getDevices().end(),
+                     [&BuiltDevices](const device &D) {
+                       return BuiltDevices.count(
+                           getRawSyclObjImpl(D)->getHandleRef());
+                     });
+}
+
+RT::PiProgram ProgramManager::getBuiltPIProgram(
+    OSModuleHandle M, const context &Context, const device &Device,
+    const string_class &KernelName, const program_impl *Prg,
+    bool JITCompilationIsRequired, bool PinSpecializedBuild) {
   KernelSetId KSId = getKernelSetId(M, KernelName);
 
   const ContextImplPtr Ctx = getSyclObjImpl(Context);
@@ -367,17 +522,51 @@ RT::PiProgram ProgramManager::getBuiltPIProgram(OSModuleHandle M,
   auto GetF = [](const Locked<ProgramCacheT> &LockedCache) -> ProgramCacheT & {
     return LockedCache.get();
   };
-  auto BuildF = [this, &M, &KSId, &Context, &Device, Prg,
+  SerializedObj SpecConsts;
+  if (Prg)
+    Prg->stableSerializeSpecConstRegistry(SpecConsts);
+
+  auto BuildF = [this, &M, &KSId, &Context, &Device, Prg, &SpecConsts,
                  &JITCompilationIsRequired] {
     const RTDeviceBinaryImage &Img =
         getDeviceImage(M, KSId, Context, Device, JITCompilationIsRequired);
 
     ContextImplPtr ContextImpl = getSyclObjImpl(Context);
     const detail::plugin &Plugin = ContextImpl->getPlugin();
-    RT::PiProgram NativePrg = createPIProgram(Img, Context, Device);
-    if (Prg)
-      flushSpecConstants(*Prg, getSyclObjImpl(Device)->getHandleRef(),
-                         NativePrg, &Img);
+
+    const std::string CompileOpts = getCompileOptions(Img);
+    const char *LinkOpts = getLinkOptions(Img);
+    const std::string BuildOptions = CompileOpts + LinkOpts;
+
+    // Try to reuse the native binary built by one of the previous runs. Such
+    // a binary already has the spec constant values and the device libraries
+    // baked in.
+    std::vector<std::vector<char>> CachedBinaries;
+    BuiltProgramBundle &Imported = ContextImpl->getImportedPrograms();
+    if (!Imported.empty() && Img.getFormat() == PI_DEVICE_BINARY_TYPE_SPIRV) {
+      std::vector<char> Binary = Imported.find(BuiltProgramBundle::getEntry(
+          Device, Img, SpecConsts, BuildOptions));
+      if (!Binary.empty())
+        CachedBinaries.push_back(std::move(Binary));
+    }
+    if (CachedBinaries.empty())
+      CachedBinaries = PersistentDeviceCodeCache::getItemFromDisc(
+          Device, Img, SpecConsts, BuildOptions);
+    const bool LoadedFromCache = !CachedBinaries.empty();
+
+    RT::PiProgram NativePrg;
+    if (LoadedFromCache) {
+      const std::vector<char> &Binary = CachedBinaries.front();
+      NativePrg = createBinaryProgram(
+          ContextImpl, Device,
+          reinterpret_cast<const unsigned char *>(Binary.data()),
+          Binary.size());
+    } else {
+      NativePrg = createPIProgram(Img, Context, Device);
+      if (Prg)
+        flushSpecConstants(*Prg, getSyclObjImpl(Device)->getHandleRef(),
+                           NativePrg, &Img);
+    }
     ProgramPtr ProgramManaged(
         NativePrg, Plugin.getPiPlugin().PiFunctionTable.piProgramRelease);
 
@@ -387,53 +576,237 @@ RT::PiProgram ProgramManager::getBuiltPIProgram(OSModuleHandle M,
     // If device image is not SPIR-V, DeviceLibReqMask will be 0 which means
     // no fallback device library will be linked.
     uint32_t DeviceLibReqMask = 0;
-    if (Img.getFormat() == PI_DEVICE_BINARY_TYPE_SPIRV &&
+    if (!LoadedFromCache && Img.getFormat() == PI_DEVICE_BINARY_TYPE_SPIRV &&
         !SYCLConfig<SYCL_DEVICELIB_NO_FALLBACK>::get())
       DeviceLibReqMask = getDeviceLibReqMask(Img);
 
     ProgramPtr BuiltProgram =
-        build(std::move(ProgramManaged), ContextImpl, Img.getCompileOptions(),
-              Img.getLinkOptions(), getRawSyclObjImpl(Device)->getHandleRef(),
+        build(std::move(ProgramManaged), ContextImpl, CompileOpts, LinkOpts,
+              getRawSyclObjImpl(Device)->getHandleRef(),
               ContextImpl->getCachedLibPrograms(), DeviceLibReqMask);
 
+    std::unordered_map<string_class, string_class> VariantNames =
+        pickSubGroupSizeVariants(Img, Device);
+    bool ImageBuilt = false;
     {
       std::lock_guard<std::mutex> Lock(MNativeProgramsMutex);
       NativePrograms[BuiltProgram.get()] = &Img;
+      // The handle of a released program may be reused for this one.
+      if (VariantNames.empty())
+        MKernelVariantNames.erase(BuiltProgram.get());
+      else
+        MKernelVariantNames[BuiltProgram.get()] = std::move(VariantNames);
+      ImageBuilt = isImageBuiltForContext(
+          Img, ContextImpl, getRawSyclObjImpl(Device)->getHandleRef());
     }
+
+    if (!LoadedFromCache)
+      PersistentDeviceCodeCache::putItemToDisc(Device, Img, SpecConsts,
+                                               BuildOptions,
+                                               BuiltProgram.get());
+    // The image data is rarely needed once the programs of all the devices
+    // in use are cached, so it doesn't have to stay in the resident memory.
+    if (ImageBuilt)
+      Img.releaseData();
     return BuiltProgram.release();
   };
 
-  SerializedObj SpecConsts;
-  if (Prg)
-    Prg->stableSerializeSpecConstRegistry(SpecConsts);
-
   const RT::PiDevice PiDevice = getRawSyclObjImpl(Device)->getHandleRef();
-  auto BuildResult = getOrBuild<PiProgramT, compile_program_error>(
-      Cache,
-      std::make_pair(std::make_pair(std::move(SpecConsts), KSId), PiDevice),
-      AcquireF, GetF, BuildF);
-  return BuildResult->Ptr.load();
+  const auto CacheKey =
+      std::make_pair(std::make_pair(SpecConsts, KSId), PiDevice);
+  for (;;) {
+    auto BuildResult = getOrBuild<PiProgramT, compile_program_error>(
+        Cache, CacheKey, AcquireF, GetF, BuildF);
+    if (SpecConsts.empty())
+      return BuildResult->Ptr.load();
+
+    // Builds with the spec constant values set by user programs are kept in
+    // a bounded LRU list, so that switching among many specializations does
+    // not grow the cache without limits. A build evicted right after it was
+    // looked up is built again.
+    RT::PiProgram Program = Cache.useSpecializedBuild(
+        CacheKey, PinSpecializedBuild, getSpecializedBuildLimits(),
+        getProgramSizeEstimate(BuildResult->Ptr.load()));
+    if (DbgProgMgr > 0) {
+      KernelProgramCache::SpecializedBuildStats Stats =
+          Cache.getSpecializedBuildStats();
+      std::cerr << ">>> specialized builds: hits " << Stats.Hits
+                << ", misses " << Stats.Misses << ", evictions "
+                << Stats.Evictions << ", cached " << Stats.Builds << " ("
+                << Stats.Size << " bytes)\n";
+    }
+    if (Program)
+      return Program;
+  }
+}
+
+std::vector<RT::PiProgram> ProgramManager::getBuiltPIPrograms(
+    OSModuleHandle M, const context &Context,
+    const vector_class<device> &Devices, const string_class &KernelName,
+    const program_impl *Prg, bool JITCompilationIsRequired) {
+  // Programs for different devices are built independently, so the builds
+  // are spread over the build thread pool. The program cache keeps the
+  // builds for the same device from being duplicated.
+  std::vector<RT::PiProgram> Programs(Devices.size());
+  GlobalHandler::instance().getProgramBuildThreadPool().parallelFor(
+      Devices.size(), [&](size_t Idx) {
+        Programs[Idx] = getBuiltPIProgram(M, Context, Devices[Idx], KernelName,
+                                          Prg, JITCompilationIsRequired);
+      });
+  return Programs;
+}
+
+void ProgramManager::prebuildAll(const context &Context,
+                                 const vector_class<device> &Devices) {
+  vector_class<device> TargetDevices;
+  std::copy_if(Devices.begin(), Devices.end(),
+               std::back_inserter(TargetDevices),
+               [](const device &Dev) { return !Dev.is_host(); });
+  if (TargetDevices.empty())
+    return;
+
+  // Programs are built per kernel set, so any kernel of the set identifies
+  // it. Images with no entry info have no kernel names: such a set is found
+  // by any name from its module.
+  std::vector<std::pair<OSModuleHandle, string_class>> KernelSets;
+  {
+    std::lock_guard<std::mutex> Guard(Sync::getGlobalLock());
+    std::unordered_set<KernelSetId> Seen;
+    for (const auto &ModuleKernelSets : m_KernelSets)
+      for (const auto &KernelSet : ModuleKernelSets.second)
+        if (Seen.insert(KernelSet.second).second)
+          KernelSets.emplace_back(ModuleKernelSets.first, KernelSet.first);
+    for (const auto &ModuleNameTables : m_KernelNameTables)
+      for (const KernelNameTable &Table : ModuleNameTables.second)
+        for (auto It = Table.Begin; It != Table.End; ++It)
+          if (Seen.insert(Table.ImageKSIds[It->ImageIndex]).second)
+            KernelSets.emplace_back(ModuleNameTables.first, It->Name);
+    for (const auto &ModuleKernelSet : m_OSModuleKernelSets)
+      if (Seen.insert(ModuleKernelSet.second).second)
+        KernelSets.emplace_back(ModuleKernelSet.first, "");
+  }
+
+  GlobalHandler::instance().getProgramBuildThreadPool().parallelFor(
+      KernelSets.size(), [&](size_t Idx) {
+        try {
+          getBuiltPIPrograms(KernelSets[Idx].first, Context, TargetDevices,
+                             KernelSets[Idx].second);
+        } catch (const exception &) {
+          // The build is retried and the error is reported when one of the
+          // kernels is submitted.
+        }
+      });
+}
+
+std::vector<BuiltProgramBundle::Entry>
+ProgramManager::getBuiltProgramEntries(const context &Context) {
+  const ContextImplPtr Ctx = getSyclObjImpl(Context);
+  const plugin &Plugin = Ctx->getPlugin();
+
+  struct BuiltProgram {
+    RT::PiProgram Program;
+    RT::PiDevice Device;
+    SerializedObj SpecConsts;
+  };
+  // The programs are retained, so that they outlive their eviction from the
+  // cache while their binaries are read outside of the cache lock.
+  std::vector<BuiltProgram> Programs;
+  {
+    auto LockedCache = Ctx->getKernelProgramCache().acquireCachedPrograms();
+    for (auto &CacheEntry : LockedCache.get()) {
+      RT::PiProgram Program = CacheEntry.second.Ptr.load();
+      if (!Program)
+        continue;
+      Plugin.call<PiApiKind::piProgramRetain>(Program);
+      Programs.push_back(BuiltProgram{Program, CacheEntry.first.second,
+                                      CacheEntry.first.first.first});
+    }
+  }
+
+  std::vector<BuiltProgramBundle::Entry> Entries;
+  for (BuiltProgram &Built : Programs) {
+    ProgramPtr ProgramManaged(
+        Built.Program, Plugin.getPiPlugin().PiFunctionTable.piProgramRelease);
+    const RTDeviceBinaryImage *Img = nullptr;
+    {
+      std::lock_guard<std::mutex> Lock(MNativeProgramsMutex);
+      auto It = NativePrograms.find(Built.Program);
+      if (It != NativePrograms.end())
+        Img = It->second;
+    }
+    // Native images are loaded as is, there is no build to save.
+    if (!Img || Img->getFormat() != PI_DEVICE_BINARY_TYPE_SPIRV)
+      continue;
+
+    for (const device &Device : Ctx->getDevices()) {
+      if (getSyclObjImpl(Device)->getHandleRef() != Built.Device)
+        continue;
+      BuiltProgramBundle::Entry Entry = BuiltProgramBundle::getEntry(
+          Device, *Img, Built.SpecConsts,
+          getCompileOptions(*Img) + getLinkOptions(*Img));
+      Entry.Binary =
+          PersistentDeviceCodeCache::getProgramBinary(Device, Built.Program);
+      if (!Entry.Binary.empty())
+        Entries.push_back(std::move(Entry));
+    }
+  }
+  return Entries;
+}
+
+static RT::PiKernel createPIKernel(const plugin &Plugin, RT::PiProgram Program,
+                                   const string_class &KernelName) {
+  RT::PiKernel Result = nullptr;
+
+  // TODO need some user-friendly error/exception
+  // instead of currently obscure one
+  Plugin.call<PiApiKind::piKernelCreate>(Program, KernelName.c_str(), &Result);
+
+  // Some PI Plugins (like OpenCL) require this call to enable USM
+  // For others, PI will turn this into a NOP.
+  Plugin.call<PiApiKind::piKernelSetExecInfo>(Result, PI_USM_INDIRECT_ACCESS,
+                                              sizeof(pi_bool), &PI_TRUE);
+
+  return Result;
 }
 
 std::pair<RT::PiKernel, std::mutex *> ProgramManager::getOrCreateKernel(
     OSModuleHandle M, const context &Context, const device &Device,
-    const string_class &KernelName, const program_impl *Prg) {
+    const string_class &KernelName, const program_impl *Prg,
+    unsigned int KernelID) {
   if (DbgProgMgr > 0) {
     std::cerr << ">>> ProgramManager::getOrCreateKernel(" << M << ", "
               << getRawSyclObjImpl(Context) << ", " << getRawSyclObjImpl(Device)
               << ", " << KernelName << ")\n";
   }
 
+  const ContextImplPtr Ctx = getSyclObjImpl(Context);
+  const RT::PiDevice PiDevice = getRawSyclObjImpl(Device)->getHandleRef();
+  KernelProgramCache &Cache = Ctx->getKernelProgramCache();
+
+  // Kernels of user programs depend on the program's build options and spec
+  // constants, so only the kernels built by the program manager itself go
+  // through the fast cache.
+  if (!Prg) {
+    if (KernelID) {
+      auto Ret = Cache.tryToGetKernelByID(KernelID, PiDevice);
+      if (Ret.first)
+        return Ret;
+    }
+    auto Ret = Cache.tryToGetKernelFast(M, KernelName, PiDevice);
+    if (Ret.first) {
+      if (KernelID)
+        Cache.saveKernelByID(KernelID, PiDevice, Ret);
+      return Ret;
+    }
+  }
+
   RT::PiProgram Program =
       getBuiltPIProgram(M, Context, Device, KernelName, Prg);
-  const ContextImplPtr Ctx = getSyclObjImpl(Context);
 
   using PiKernelT = KernelProgramCache::PiKernelT;
   using KernelCacheT = KernelProgramCache::KernelCacheT;
   using KernelByNameT = KernelProgramCache::KernelByNameT;
 
-  KernelProgramCache &Cache = Ctx->getKernelProgramCache();
-
   auto AcquireF = [](KernelProgramCache &Cache) {
     return Cache.acquireKernelsPerProgramCache();
   };
@@ -441,28 +814,52 @@ std::pair<RT::PiKernel, std::mutex *> ProgramManager::getOrCreateKernel(
       [&Program](const Locked<KernelCacheT> &LockedCache) -> KernelByNameT & {
     return LockedCache.get()[Program];
   };
-  auto BuildF = [&Program, &KernelName, &Ctx] {
-    PiKernelT *Result = nullptr;
-
-    // TODO need some user-friendly error/exception
-    // instead of currently obscure one
-    const detail::plugin &Plugin = Ctx->getPlugin();
-    Plugin.call<PiApiKind::piKernelCreate>(Program, KernelName.c_str(),
-                                           &Result);
-
-    // Some PI Plugins (like OpenCL) require this call to enable USM
-    // For others, PI will turn this into a NOP.
-    Plugin.call<PiApiKind::piKernelSetExecInfo>(Result, PI_USM_INDIRECT_ACCESS,
-                                                sizeof(pi_bool), &PI_TRUE);
-
-    return Result;
+  auto BuildF = [this, &Program, &KernelName, &Ctx] {
+    return createPIKernel(Ctx->getPlugin(), Program,
+                          getKernelVariantName(Program, KernelName));
   };
 
-  const RT::PiDevice PiDevice = getRawSyclObjImpl(Device)->getHandleRef();
   auto BuildResult = getOrBuild<PiKernelT, invalid_object_error>(
       Cache, std::make_pair(KernelName, PiDevice), AcquireF, GetF, BuildF);
-  return std::make_pair(BuildResult->Ptr.load(),
-                        &(BuildResult->MBuildResultMutex));
+  auto Ret = std::make_pair(BuildResult->Ptr.load(),
+                            &(BuildResult->MBuildResultMutex));
+  if (!Prg) {
+    Cache.saveKernelFast(M, KernelName, PiDevice, Ret);
+    if (KernelID)
+      Cache.saveKernelByID(KernelID, PiDevice, Ret);
+  }
+  return Ret;
+}
+
+RT::PiKernel ProgramManager::getKernelClone(const ContextImplPtr &Context,
+                                            RT::PiProgram Program,
+                                            RT::PiKernel Kernel,
+                                            const string_class &KernelName) {
+  RT::PiKernel Clone =
+      Context->getKernelProgramCache().tryToGetKernelClone(Kernel);
+  if (Clone)
+    return Clone;
+  return createPIKernel(Context->getPlugin(), Program,
+                        getKernelVariantName(Program, KernelName));
+}
+
+string_class
+ProgramManager::getKernelVariantName(RT::PiProgram Program,
+                                     const string_class &KernelName) {
+  std::lock_guard<std::mutex> Lock(MNativeProgramsMutex);
+  auto ProgramIt = MKernelVariantNames.find(Program);
+  if (ProgramIt == MKernelVariantNames.end())
+    return KernelName;
+  auto NameIt = ProgramIt->second.find(KernelName);
+  return NameIt == ProgramIt->second.end() ? KernelName : NameIt->second;
+}
+
+unsigned int ProgramManager::getKernelID(OSModuleHandle M,
+                                         const string_class &KernelName) {
+  std::lock_guard<std::mutex> Lock(m_KernelIDsMutex);
+  auto Inserted = m_KernelIDs.emplace(std::make_pair(M, KernelName),
+                                      m_KernelIDs.size() + 1);
+  return Inserted.first->second;
 }
 
 RT::PiProgram
@@ -542,18 +939,23 @@ static bool loadDeviceLib(const ContextImplPtr Context, const char *Name,
   return Prog != nullptr;
 }
 
-static const char *getDeviceLibFilename(DeviceLibExt Extension) {
+static const char *getDeviceLibFilename(DeviceLibExt Extension,
+                                        bool FastMath) {
   switch (Extension) {
   case DeviceLibExt::cl_intel_devicelib_assert:
     return "libsycl-fallback-cassert.spv";
   case DeviceLibExt::cl_intel_devicelib_math:
-    return "libsycl-fallback-cmath.spv";
+    return FastMath ? "libsycl-fallback-cmath-fast.spv"
+                    : "libsycl-fallback-cmath.spv";
   case DeviceLibExt::cl_intel_devicelib_math_fp64:
-    return "libsycl-fallback-cmath-fp64.spv";
+    return FastMath ? "libsycl-fallback-cmath-fp64-fast.spv"
+                    : "libsycl-fallback-cmath-fp64.spv";
   case DeviceLibExt::cl_intel_devicelib_complex:
-    return "libsycl-fallback-complex.spv";
+    return FastMath ? "libsycl-fallback-complex-fast.spv"
+                    : "libsycl-fallback-complex.spv";
   case DeviceLibExt::cl_intel_devicelib_complex_fp64:
-    return "libsycl-fallback-complex-fp64.spv";
+    return FastMath ? "libsycl-fallback-complex-fp64-fast.spv"
+                    : "libsycl-fallback-complex-fp64.spv";
   }
   throw compile_program_error("Unhandled (new?) device library extension",
                               PI_INVALID_OPERATION);
@@ -576,27 +978,42 @@ static const char *getDeviceLibExtensionStr(DeviceLibExt Extension) {
                               PI_INVALID_OPERATION);
 }
 
+/// \returns true if the fallback libraries built with -cl-fast-relaxed-math
+/// may be linked to a program built with CompileOptions.
+static bool isDeviceLibFastMathAllowed(const std::string &CompileOptions) {
+  return CompileOptions.find("-cl-fast-relaxed-math") != std::string::npos;
+}
+
+/// \param FastMath tells to load the low precision variant of the library if
+/// it is installed, there is none for the assert extension.
 static RT::PiProgram loadDeviceLibFallback(
-    const ContextImplPtr Context, DeviceLibExt Extension,
+    const ContextImplPtr Context, DeviceLibExt Extension, bool FastMath,
     const RT::PiDevice &Device,
-    std::map<std::pair<DeviceLibExt, RT::PiDevice>, RT::PiProgram>
+    std::map<std::tuple<DeviceLibExt, bool, RT::PiDevice>, RT::PiProgram>
         &CachedLibPrograms) {
 
-  const char *LibFileName = getDeviceLibFilename(Extension);
-  auto CacheResult = CachedLibPrograms.emplace(
-      std::make_pair(std::make_pair(Extension, Device), nullptr));
-  bool Cached = !CacheResult.second;
-  auto LibProgIt = CacheResult.first;
-  RT::PiProgram &LibProg = LibProgIt->second;
-
-  if (Cached)
-    return LibProg;
+  if (Extension == DeviceLibExt::cl_intel_devicelib_assert)
+    FastMath = false;
+  const auto CacheKey = std::make_tuple(Extension, FastMath, Device);
+  {
+    std::lock_guard<std::mutex> Lock(Context->getCachedLibProgramsMutex());
+    auto LibProgIt = CachedLibPrograms.find(CacheKey);
+    if (LibProgIt != CachedLibPrograms.end())
+      return LibProgIt->second;
+  }
 
-  if (!loadDeviceLib(Context, LibFileName, LibProg)) {
-    CachedLibPrograms.erase(LibProgIt);
+  // The library is loaded and compiled without holding the lock, so that
+  // the fallback libraries are built concurrently.
+  RT::PiProgram LibProg = nullptr;
+  // The full precision library is correct for the fast math programs too, and
+  // is then cached for them when the variant is not installed.
+  if (FastMath &&
+      !loadDeviceLib(Context, getDeviceLibFilename(Extension, true), LibProg))
+    FastMath = false;
+  const char *LibFileName = getDeviceLibFilename(Extension, FastMath);
+  if (!LibProg && !loadDeviceLib(Context, LibFileName, LibProg))
     throw compile_program_error(std::string("Failed to load ") + LibFileName,
                                 PI_INVALID_VALUE);
-  }
 
   const detail::plugin &Plugin = Context->getPlugin();
   // TODO no spec constants are used in the std libraries, support in the future
@@ -606,15 +1023,22 @@ static RT::PiProgram loadDeviceLibFallback(
       // Do not use compile options for library programs: it is not clear
       // if user options (image options) are supposed to be applied to
       // library program as well, and what actually happens to a SPIR-V
-      // program if we apply them.
-      "", 0, nullptr, nullptr, nullptr, nullptr);
+      // program if we apply them. The fast math variants allow the device
+      // compiler to relax them further.
+      FastMath ? "-cl-fast-relaxed-math" : "", 0, nullptr, nullptr, nullptr,
+      nullptr);
   if (Error != PI_SUCCESS) {
-    CachedLibPrograms.erase(LibProgIt);
-    throw compile_program_error(
-        ProgramManager::getProgramBuildLog(LibProg, Context), Error);
+    std::string BuildLog = ProgramManager::getProgramBuildLog(LibProg, Context);
+    Plugin.call<PiApiKind::piProgramRelease>(LibProg);
+    throw compile_program_error(BuildLog, Error);
   }
 
-  return LibProg;
+  std::lock_guard<std::mutex> Lock(Context->getCachedLibProgramsMutex());
+  auto CacheResult = CachedLibPrograms.emplace(CacheKey, LibProg);
+  // Another thread has compiled the same library in the meantime.
+  if (!CacheResult.second)
+    Plugin.call<PiApiKind::piProgramRelease>(LibProg);
+  return CacheResult.first->second;
 }
 
 ProgramManager::ProgramManager() {
@@ -705,6 +1129,9 @@ ProgramManager::getDeviceImage(OSModuleHandle M, KernelSetId KSId,
   }
 
   Img = Imgs[ImgInd].get();
+  // Images are registered as is, only the images actually selected for a
+  // device get parsed and decompressed.
+  Img->prepare();
 
   if (DbgProgMgr > 0) {
     std::cerr << "selected device image: " << &Img->getRawData() << "\n";
@@ -725,9 +1152,9 @@ static bool isDeviceLibRequired(DeviceLibExt Ext, uint32_t DeviceLibReqMask) {
 
 static std::vector<RT::PiProgram> getDeviceLibPrograms(
     const ContextImplPtr Context, const RT::PiDevice &Device,
-    std::map<std::pair<DeviceLibExt, RT::PiDevice>, RT::PiProgram>
+    std::map<std::tuple<DeviceLibExt, bool, RT::PiDevice>, RT::PiProgram>
         &CachedLibPrograms,
-    uint32_t DeviceLibReqMask) {
+    uint32_t DeviceLibReqMask, bool FastMath) {
   std::vector<RT::PiProgram> Programs;
 
   std::pair<DeviceLibExt, bool> RequiredDeviceLibExt[] = {
@@ -747,6 +1174,7 @@ static std::vector<RT::PiProgram> getDeviceLibPrograms(
 
   // Load a fallback library for an extension if the device does not
   // support it.
+  std::vector<DeviceLibExt> FallbackExts;
   for (auto &Pair : RequiredDeviceLibExt) {
     DeviceLibExt Ext = Pair.first;
     bool &FallbackIsLoaded = Pair.second;
@@ -774,11 +1202,19 @@ static std::vector<RT::PiProgram> getDeviceLibPrograms(
     bool DeviceSupports = DevExtList.npos != DevExtList.find(ExtStr);
 
     if (!DeviceSupports || InhibitNativeImpl) {
-      Programs.push_back(
-          loadDeviceLibFallback(Context, Ext, Device, CachedLibPrograms));
+      FallbackExts.push_back(Ext);
       FallbackIsLoaded = true;
     }
   }
+
+  // The fallback libraries are independent of each other and are compiled
+  // in parallel.
+  Programs.resize(FallbackExts.size());
+  GlobalHandler::instance().getProgramBuildThreadPool().parallelFor(
+      FallbackExts.size(), [&](size_t Idx) {
+        Programs[Idx] = loadDeviceLibFallback(
+            Context, FallbackExts[Idx], FastMath, Device, CachedLibPrograms);
+      });
   return Programs;
 }
 
@@ -786,7 +1222,7 @@ ProgramManager::ProgramPtr ProgramManager::build(
     ProgramPtr Program, const ContextImplPtr Context,
     const string_class &CompileOptions, const string_class &LinkOptions,
     const RT::PiDevice &Device,
-    std::map<std::pair<DeviceLibExt, RT::PiDevice>, RT::PiProgram>
+    std::map<std::tuple<DeviceLibExt, bool, RT::PiDevice>, RT::PiProgram>
         &CachedLibPrograms,
     uint32_t DeviceLibReqMask) {
 
@@ -797,21 +1233,20 @@ ProgramManager::ProgramPtr ProgramManager::build(
   }
 
   bool LinkDeviceLibs = (DeviceLibReqMask != 0);
-  const char *CompileOpts = std::getenv("SYCL_PROGRAM_COMPILE_OPTIONS");
-  if (!CompileOpts) {
-    CompileOpts = CompileOptions.c_str();
-  }
-  const char *LinkOpts = std::getenv("SYCL_PROGRAM_LINK_OPTIONS");
-  if (!LinkOpts) {
-    LinkOpts = LinkOptions.c_str();
-  }
+  const char *CompileOpts = CompileOptions.c_str();
+  const char *LinkOpts = LinkOptions.c_str();
 
-  // TODO: Currently, online linking isn't implemented yet on Level Zero.
-  // To enable device libraries and unify the behaviors on all backends,
-  // online linking is disabled temporarily, all fallback device libraries
-  // will be linked offline. When Level Zero supports online linking, we need
-  // to remove the line of code below and switch back to online linking.
-  LinkDeviceLibs = false;
+  const detail::plugin &Plugin = Context->getPlugin();
+
+  // The fallback device libraries are compiled once per device and context,
+  // and then linked to every user program, which on Level Zero only resolves
+  // the imports of the user module.  The plugin can be told to not use the
+  // driver linker, in which case the user program must not be linked.
+  if (Plugin.getBackend() == backend::level_zero) {
+    const char *Env = std::getenv("SYCL_ENABLE_LEVEL_ZERO_LINK");
+    if (Env && std::string(Env) == "0")
+      LinkDeviceLibs = false;
+  }
 
   // TODO: this is a temporary workaround for GPU tests for ESIMD compiler.
   // We do not link with other device libraries, because it may fail
@@ -823,11 +1258,11 @@ ProgramManager::ProgramPtr ProgramManager::build(
 
   std::vector<RT::PiProgram> LinkPrograms;
   if (LinkDeviceLibs) {
-    LinkPrograms = getDeviceLibPrograms(Context, Device, CachedLibPrograms,
-                                        DeviceLibReqMask);
+    LinkPrograms = getDeviceLibPrograms(
+        Context, Device, CachedLibPrograms, DeviceLibReqMask,
+        isDeviceLibFastMathAllowed(CompileOptions));
   }
 
-  const detail::plugin &Plugin = Context->getPlugin();
   if (LinkPrograms.empty()) {
     std::string Opts(CompileOpts);
 
@@ -883,52 +1318,180 @@ createKernelArgMask(const pi::ByteArray &Bytes) {
   return Result;
 }
 
+static ProgramManager::KernelArgFields
+createKernelArgFields(const pi::ByteArray &Bytes) {
+  // The byte array starts with its size in bits, followed by 32-bit words.
+  const int NBytesForSize = 8;
+  auto getWord = [&Bytes](std::size_t I) {
+    std::uint32_t Word = 0;
+    for (int B = 0; B < 4; ++B)
+      Word |= static_cast<std::uint32_t>(Bytes[NBytesForSize + I * 4 + B])
+              << B * 8;
+    return Word;
+  };
+  const std::size_t NWords = (Bytes.size() - NBytesForSize) / 4;
+
+  ProgramManager::KernelArgFields Result;
+  for (std::size_t I = 0; I + 1 < NWords;) {
+    const int ArgIndex = static_cast<int>(getWord(I++));
+    const std::uint32_t NRanges = getWord(I++);
+    ProgramManager::KernelArgFieldRanges &Ranges = Result[ArgIndex];
+    for (std::uint32_t R = 0; R < NRanges && I + 1 < NWords; ++R, I += 2)
+      Ranges.emplace_back(getWord(I), getWord(I + 1));
+  }
+  return Result;
+}
+
+static bool isSameCString(const char *A, const char *B) {
+  return A == B || (A && B && std::strcmp(A, B) == 0);
+}
+
+template <typename T>
+static bool isSameData(T ABegin, T AEnd, T BBegin, T BEnd) {
+  return AEnd - ABegin == BEnd - BBegin &&
+         (ABegin == AEnd || ABegin == BBegin ||
+          std::memcmp(ABegin, BBegin, (AEnd - ABegin) * sizeof(*ABegin)) == 0);
+}
+
+/// \return true if the images have the same contents, which is the case for
+/// the copies of an image registered by every shared library linked with the
+/// static library it comes from.
+static bool isSameImage(const pi_device_binary_struct &A,
+                        const pi_device_binary_struct &B) {
+  if (A.Version != B.Version || A.Kind != B.Kind || A.Format != B.Format ||
+      !isSameCString(A.DeviceTargetSpec, B.DeviceTargetSpec) ||
+      !isSameCString(A.CompileOptions, B.CompileOptions) ||
+      !isSameCString(A.LinkOptions, B.LinkOptions) ||
+      !isSameData(A.ManifestStart, A.ManifestEnd, B.ManifestStart,
+                  B.ManifestEnd) ||
+      !isSameData(A.BinaryStart, A.BinaryEnd, B.BinaryStart, B.BinaryEnd))
+    return false;
+
+  if (A.EntriesEnd - A.EntriesBegin != B.EntriesEnd - B.EntriesBegin ||
+      !std::equal(A.EntriesBegin, A.EntriesEnd, B.EntriesBegin,
+                  [](const _pi_offload_entry_struct &EA,
+                     const _pi_offload_entry_struct &EB) {
+                    return isSameCString(EA.name, EB.name) &&
+                           EA.size == EB.size && EA.flags == EB.flags;
+                  }))
+    return false;
+
+  auto IsSameProp = [](const _pi_device_binary_property_struct &PA,
+                       const _pi_device_binary_property_struct &PB) {
+    if (!isSameCString(PA.Name, PB.Name) || PA.Type != PB.Type ||
+        PA.ValSize != PB.ValSize)
+      return false;
+    // The value of 32-bit integer properties is held by ValSize.
+    if (!PA.ValAddr || !PB.ValAddr)
+      return PA.ValAddr == PB.ValAddr;
+    const auto *VA = static_cast<const unsigned char *>(PA.ValAddr);
+    const auto *VB = static_cast<const unsigned char *>(PB.ValAddr);
+    return isSameData(VA, VA + PA.ValSize, VB, VB + PB.ValSize);
+  };
+  auto IsSamePropSet = [&IsSameProp](
+                           const _pi_device_binary_property_set_struct &SA,
+                           const _pi_device_binary_property_set_struct &SB) {
+    return isSameCString(SA.Name, SB.Name) &&
+           SA.PropertiesEnd - SA.PropertiesBegin ==
+               SB.PropertiesEnd - SB.PropertiesBegin &&
+           std::equal(SA.PropertiesBegin, SA.PropertiesEnd, SB.PropertiesBegin,
+                      IsSameProp);
+  };
+  return A.PropertySetsEnd - A.PropertySetsBegin ==
+             B.PropertySetsEnd - B.PropertySetsBegin &&
+         std::equal(A.PropertySetsBegin, A.PropertySetsEnd,
+                    B.PropertySetsBegin, IsSamePropSet);
+}
+
 void ProgramManager::addImages(pi_device_binaries DeviceBinary) {
   std::lock_guard<std::mutex> Guard(Sync::getGlobalLock());
 
+  // Kernel names of the descriptors having a name table are looked up in the
+  // table in place rather than copied into m_KernelSets.
+  KernelNameTable *NameTable = nullptr;
+  if (DeviceBinary->Version >= 2 &&
+      DeviceBinary->KernelNamesBegin != DeviceBinary->KernelNamesEnd) {
+    std::vector<KernelNameTable> &Tables =
+        m_KernelNameTables[OSUtil::getOSModuleHandle(DeviceBinary)];
+    Tables.push_back(
+        {DeviceBinary->KernelNamesBegin, DeviceBinary->KernelNamesEnd,
+         std::vector<KernelSetId>(DeviceBinary->NumDeviceBinaries)});
+    NameTable = &Tables.back();
+  }
+
   for (int I = 0; I < DeviceBinary->NumDeviceBinaries; I++) {
     pi_device_binary RawImg = &(DeviceBinary->DeviceBinaries[I]);
     OSModuleHandle M = OSUtil::getOSModuleHandle(RawImg);
     const _pi_offload_entry EntriesB = RawImg->EntriesBegin;
     const _pi_offload_entry EntriesE = RawImg->EntriesEnd;
+    // Registration happens at library load time for every image, including
+    // the ones for devices which are not present, so only the offload entry
+    // table is used here. Property sets are parsed when the image is first
+    // selected for a device, see getDeviceImage.
     auto Img = make_unique_ptr<RTDeviceBinaryImage>(RawImg, M);
 
-    // Fill the kernel argument mask map
-    const pi::DeviceBinaryImage::PropertyRange &KPOIRange =
-        Img->getKernelParamOptInfo();
-    if (KPOIRange.isAvailable()) {
-      KernelNameToArgMaskMap &ArgMaskMap =
-          m_EliminatedKernelArgMasks[Img.get()];
-      for (const auto &Info : KPOIRange)
-        ArgMaskMap[Info->Name] =
-            createKernelArgMask(pi::DeviceBinaryProperty(Info).asByteArray());
-    }
     // Use the entry information if it's available
     if (EntriesB != EntriesE) {
+      // A static library linked into several shared libraries has its images
+      // registered by each of them. Only the first copy of an image is kept,
+      // so that all the modules share its kernel set and the programs built
+      // from it, while their kernel names are still resolved per module.
+      // Copies are looked for among the images of the same size, target and
+      // first kernel, so that the contents of the other images are not
+      // paged in.
+      const auto CopyKey = std::make_tuple(
+          std::string(EntriesB->name),
+          std::string(RawImg->DeviceTargetSpec ? RawImg->DeviceTargetSpec : ""),
+          static_cast<size_t>(RawImg->BinaryEnd - RawImg->BinaryStart));
+      KernelSetId CopyKSId = 0;
+      auto CopyRange = m_ImageCopyCandidates.equal_range(CopyKey);
+      for (auto It = CopyRange.first; It != CopyRange.second; ++It)
+        if (isSameImage(*It->second.first, *RawImg)) {
+          CopyKSId = It->second.second;
+          break;
+        }
+
       // The kernel sets for any pair of images are either disjoint or
       // identical, look up the kernel set using the first kernel name...
-      StrToKSIdMap &KSIdMap = m_KernelSets[M];
-      auto KSIdIt = KSIdMap.find(EntriesB->name);
-      if (KSIdIt != KSIdMap.end()) {
+      KernelSetId KSId = findKernelSetId(M, EntriesB->name);
+      if (KSId != 0) {
         for (_pi_offload_entry EntriesIt = EntriesB + 1; EntriesIt != EntriesE;
              ++EntriesIt)
-          assert(KSIdMap[EntriesIt->name] == KSIdIt->second &&
+          assert(findKernelSetId(M, EntriesIt->name) == KSId &&
                  "Kernel sets are not disjoint");
-        auto &Imgs = m_DeviceImages[KSIdIt->second];
-        assert(Imgs && "Device image vector should have been already created");
-        Imgs->push_back(std::move(Img));
-        continue;
+      } else {
+        // ... or create the set first if it hasn't been, which is the set of
+        // the copy of the image registered by another module if there is one
+        KSId = CopyKSId ? CopyKSId : getNextKernelSetId();
+        if (!NameTable) {
+          StrToKSIdMap &KSIdMap = m_KernelSets[M];
+          for (_pi_offload_entry EntriesIt = EntriesB; EntriesIt != EntriesE;
+               ++EntriesIt) {
+            auto Result =
+                KSIdMap.insert(std::make_pair(EntriesIt->name, KSId));
+            (void)Result;
+            assert(Result.second && "Kernel sets are not disjoint");
+          }
+        }
+        if (!CopyKSId)
+          m_DeviceImages[KSId].reset(
+              new std::vector<RTDeviceBinaryImageUPtr>());
       }
-      // ... or create the set first if it hasn't been
-      KernelSetId KSId = getNextKernelSetId();
-      for (_pi_offload_entry EntriesIt = EntriesB; EntriesIt != EntriesE;
-           ++EntriesIt) {
-        auto Result = KSIdMap.insert(std::make_pair(EntriesIt->name, KSId));
-        (void)Result;
-        assert(Result.second && "Kernel sets are not disjoint");
+      if (NameTable)
+        NameTable->ImageKSIds[I] = KSId;
+      if (CopyKSId == KSId) {
+        if (DbgProgMgr > 0)
+          std::cerr << ">>> device image " << RawImg
+                    << " is shared with another module, kernel set " << KSId
+                    << "\n";
+        // The pages of the copy's data are not needed anymore.
+        Img->releaseData();
+        continue;
       }
-      m_DeviceImages[KSId].reset(new std::vector<RTDeviceBinaryImageUPtr>());
-      m_DeviceImages[KSId]->push_back(std::move(Img));
+      auto &Imgs = m_DeviceImages[KSId];
+      assert(Imgs && "Device image vector should have been already created");
+      Imgs->push_back(std::move(Img));
+      m_ImageCopyCandidates.emplace(CopyKey, std::make_pair(RawImg, KSId));
       continue;
     }
     // Otherwise assume that the image contains all kernels associated with the
@@ -966,14 +1529,10 @@ ProgramManager::getKernelSetId(OSModuleHandle M,
   if (m_UseSpvFile && M == OSUtil::ExeModuleHandle)
     return SpvFileKSId;
   std::lock_guard<std::mutex> Guard(Sync::getGlobalLock());
-  auto KSIdMapIt = m_KernelSets.find(M);
-  if (KSIdMapIt != m_KernelSets.end()) {
-    const StrToKSIdMap &KSIdMap = KSIdMapIt->second;
-    auto KSIdIt = KSIdMap.find(KernelName);
-    // If the kernel has been assigned to a kernel set, return it
-    if (KSIdIt != KSIdMap.end())
-      return KSIdIt->second;
-  }
+  // If the kernel has been assigned to a kernel set, return it
+  KernelSetId KSId = findKernelSetId(M, KernelName.c_str());
+  if (KSId != 0)
+    return KSId;
   // If no kernel set was found check if there is a kernel set containing
   // all kernels in the given module
   auto ModuleKSIdIt = m_OSModuleKernelSets.find(M);
@@ -984,6 +1543,35 @@ ProgramManager::getKernelSetId(OSModuleHandle M,
                       PI_INVALID_KERNEL_NAME);
 }
 
+KernelSetId ProgramManager::findKernelSetId(OSModuleHandle M,
+                                            const char *KernelName) const {
+  auto TablesIt = m_KernelNameTables.find(M);
+  if (TablesIt != m_KernelNameTables.end()) {
+    for (const KernelNameTable &Table : TablesIt->second) {
+      auto It = std::lower_bound(
+          Table.Begin, Table.End, KernelName,
+          [](const _pi_kernel_name_entry_struct &Entry, const char *Name) {
+            return std::strcmp(Entry.Name, Name) < 0;
+          });
+      if (It == Table.End || std::strcmp(It->Name, KernelName) != 0)
+        continue;
+      assert(It->ImageIndex < Table.ImageKSIds.size() &&
+             "Bad image index in the kernel name table");
+      // The id is 0 while the image is being registered.
+      if (KernelSetId KSId = Table.ImageKSIds[It->ImageIndex])
+        return KSId;
+    }
+  }
+  auto KSIdMapIt = m_KernelSets.find(M);
+  if (KSIdMapIt != m_KernelSets.end()) {
+    const StrToKSIdMap &KSIdMap = KSIdMapIt->second;
+    auto KSIdIt = KSIdMap.find(KernelName);
+    if (KSIdIt != KSIdMap.end())
+      return KSIdIt->second;
+  }
+  return 0;
+}
+
 void ProgramManager::dumpImage(const RTDeviceBinaryImage &Img,
                                KernelSetId KSId) const {
   std::string Fname("sycl_");
@@ -1066,52 +1654,134 @@ uint32_t ProgramManager::getDeviceLibReqMask(const RTDeviceBinaryImage &Img) {
 // header instead.
 ProgramManager::KernelArgMask ProgramManager::getEliminatedKernelArgMask(
     OSModuleHandle M, const context &Context, const device &Device,
-    pi::PiProgram NativePrg, const string_class &KernelName,
-    bool KnownProgram) {
+    pi::PiProgram NativePrg, const string_class &KernelName, bool KnownProgram,
+    KernelArgFields *ArgFields, SpecConstBufferInfo *SpecConstBuf) {
   // If instructed to use a spv file, assume no eliminated arguments.
   if (m_UseSpvFile && M == OSUtil::ExeModuleHandle)
     return {};
 
+  const RTDeviceBinaryImage *Img = nullptr;
   {
     std::lock_guard<std::mutex> Lock(MNativeProgramsMutex);
     auto ImgIt = NativePrograms.find(NativePrg);
-    if (ImgIt != NativePrograms.end()) {
-      auto MapIt = m_EliminatedKernelArgMasks.find(ImgIt->second);
-      if (MapIt != m_EliminatedKernelArgMasks.end())
-        return MapIt->second[KernelName];
-      return {};
-    }
+    if (ImgIt != NativePrograms.end())
+      Img = ImgIt->second;
   }
 
-  if (KnownProgram)
-    throw runtime_error("Program is not associated with a binary image",
-                        PI_INVALID_VALUE);
+  if (!Img) {
+    if (KnownProgram)
+      throw runtime_error("Program is not associated with a binary image",
+                          PI_INVALID_VALUE);
 
-  // If not sure whether the program was built with one of the images, try
-  // finding the binary.
-  // TODO this can backfire in some extreme edge cases where there's a kernel
-  // name collision between our binaries and user-created native programs.
-  KernelSetId KSId;
-  try {
-    KSId = getKernelSetId(M, KernelName);
-  } catch (sycl::runtime_error &e) {
-    // If the kernel name wasn't found, assume that the program wasn't created
-    // from one of our device binary images.
-    if (e.get_cl_code() == PI_INVALID_KERNEL_NAME)
-      return {};
-    std::rethrow_exception(std::current_exception());
+    // If not sure whether the program was built with one of the images, try
+    // finding the binary.
+    // TODO this can backfire in some extreme edge cases where there's a kernel
+    // name collision between our binaries and user-created native programs.
+    KernelSetId KSId;
+    try {
+      KSId = getKernelSetId(M, KernelName);
+    } catch (sycl::runtime_error &e) {
+      // If the kernel name wasn't found, assume that the program wasn't
+      // created from one of our device binary images.
+      if (e.get_cl_code() == PI_INVALID_KERNEL_NAME)
+        return {};
+      std::rethrow_exception(std::current_exception());
+    }
+    Img = &getDeviceImage(M, KSId, Context, Device);
+    {
+      std::lock_guard<std::mutex> Lock(MNativeProgramsMutex);
+      NativePrograms[NativePrg] = Img;
+    }
   }
-  RTDeviceBinaryImage &Img = getDeviceImage(M, KSId, Context, Device);
-  {
-    std::lock_guard<std::mutex> Lock(MNativeProgramsMutex);
-    NativePrograms[NativePrg] = &Img;
+
+  std::lock_guard<std::mutex> Guard(Sync::getGlobalLock());
+  cacheKernelArgInfo(*Img);
+  if (ArgFields) {
+    const KernelNameToArgFieldsMap &ArgFieldsMap = m_KernelArgFields[Img];
+    auto FieldsIt = ArgFieldsMap.find(KernelName);
+    if (FieldsIt != ArgFieldsMap.end())
+      *ArgFields = FieldsIt->second;
   }
-  auto MapIt = m_EliminatedKernelArgMasks.find(&Img);
-  if (MapIt != m_EliminatedKernelArgMasks.end())
-    return MapIt->second[KernelName];
+  if (SpecConstBuf) {
+    const KernelNameToSpecConstBufferMap &BufMap =
+        m_KernelSpecConstBuffers[Img];
+    auto BufIt = BufMap.find(KernelName);
+    if (BufIt != BufMap.end())
+      *SpecConstBuf = BufIt->second;
+  }
+  const KernelNameToArgMaskMap &ArgMaskMap = m_EliminatedKernelArgMasks[Img];
+  auto MaskIt = ArgMaskMap.find(KernelName);
+  if (MaskIt != ArgMaskMap.end())
+    return MaskIt->second;
   return {};
 }
 
+void ProgramManager::cacheKernelArgInfo(const RTDeviceBinaryImage &Img) {
+  // An entry, possibly empty, is created for every image looked at, which
+  // means that its properties have already been parsed.
+  if (m_EliminatedKernelArgMasks.count(&Img))
+    return;
+  KernelNameToArgMaskMap &ArgMaskMap = m_EliminatedKernelArgMasks[&Img];
+  for (const auto &Info : Img.getKernelParamOptInfo())
+    ArgMaskMap[Info->Name] =
+        createKernelArgMask(pi::DeviceBinaryProperty(Info).asByteArray());
+  KernelNameToArgFieldsMap &ArgFieldsMap = m_KernelArgFields[&Img];
+  for (const auto &Info : Img.getKernelParamFieldOptInfo())
+    ArgFieldsMap[Info->Name] =
+        createKernelArgFields(pi::DeviceBinaryProperty(Info).asByteArray());
+
+  const pi::DeviceBinaryImage::PropertyRange &BufArgs =
+      Img.getKernelSpecConstBuffer();
+  if (!BufArgs.isAvailable())
+    return;
+  SpecConstBufferLayout &Layout = m_SpecConstBufferLayouts[&Img];
+  for (const auto &Info : Img.getSpecConstBufferLayout())
+    Layout[Info->Name] = pi::DeviceBinaryProperty(Info).asUint32();
+  KernelNameToSpecConstBufferMap &BufMap = m_KernelSpecConstBuffers[&Img];
+  for (const auto &Info : BufArgs) {
+    // The byte array starts with its size in bits, followed by the argument
+    // index and the buffer size as 32-bit words.
+    const pi::ByteArray Bytes = pi::DeviceBinaryProperty(Info).asByteArray();
+    const int NBytesForSize = 8;
+    assert(Bytes.size() >= NBytesForSize + 2 * sizeof(pi_uint32) &&
+           "Malformed spec constants buffer argument property");
+    auto getWord = [&Bytes](std::size_t I) {
+      pi_uint32 Word = 0;
+      for (int B = 0; B < 4; ++B)
+        Word |= static_cast<pi_uint32>(Bytes[NBytesForSize + I * 4 + B])
+                << B * 8;
+      return Word;
+    };
+    SpecConstBufferInfo &Buf = BufMap[Info->Name];
+    Buf.ArgIndex = getWord(0);
+    Buf.Size = getWord(1);
+    Buf.Layout = &Layout;
+  }
+}
+
+void ProgramManager::fillSpecConstBuffer(
+    const SpecConstBufferInfo &SpecConstBuf, const program_impl *Prg,
+    std::vector<unsigned char> &Buffer) {
+  Buffer.assign(SpecConstBuf.Size, 0);
+  if (!Prg || !SpecConstBuf.Layout)
+    return;
+  for (const auto &SC : Prg->getSpecConstRegistry()) {
+    auto OffsetIt = SpecConstBuf.Layout->find(SC.first);
+    if (OffsetIt == SpecConstBuf.Layout->end() || !SC.second.isSet())
+      continue;
+    if (OffsetIt->second + SC.second.getSize() > Buffer.size())
+      throw runtime_error("Spec constant value does not fit the buffer",
+                          PI_INVALID_VALUE);
+    std::memcpy(Buffer.data() + OffsetIt->second, SC.second.getValuePtr(),
+                SC.second.getSize());
+  }
+}
+
+unsigned int getKernelID(const char *KernelName) {
+  return ProgramManager::getInstance().getKernelID(
+      OSUtil::getOSModuleHandle(KernelName), KernelName);
+}
+
 } // namespace detail
 } // namespace sycl
 } // __SYCL_INLINE_NAMESPACE(cl)
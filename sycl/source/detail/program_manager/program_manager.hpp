@@ -15,12 +15,15 @@
 #include <CL/sycl/detail/util.hpp>
 #include <CL/sycl/device.hpp>
 #include <CL/sycl/stl.hpp>
+#include <detail/built_program_bundle.hpp>
 #include <detail/spec_constant_impl.hpp>
 
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 // +++ Entry points referenced by the offload wrapper object {
@@ -61,6 +64,25 @@ class ProgramManager {
 public:
   // TODO use a custom dynamic bitset instead to make initialization simpler.
   using KernelArgMask = std::vector<bool>;
+  /// Byte ranges, as offset and size pairs, of an aggregate kernel argument
+  /// which are passed to the kernel, each as a separate argument.
+  using KernelArgFieldRanges = std::vector<std::pair<uint32_t, uint32_t>>;
+  /// Maps the indices of aggregate kernel arguments of which only parts are
+  /// passed to their kept byte ranges.
+  using KernelArgFields = std::unordered_map<int, KernelArgFieldRanges>;
+  /// Maps the symbolic IDs of emulated spec constants to their offsets in the
+  /// spec constants buffer.
+  using SpecConstBufferLayout = std::map<string_class, pi_uint32>;
+  /// Describes the implicit argument through which a kernel built ahead of
+  /// time with emulated spec constants takes their values.
+  struct SpecConstBufferInfo {
+    /// Index of the argument.
+    pi_uint32 ArgIndex = 0;
+    /// Size of the buffer passed in the argument, 0 if there is no argument.
+    pi_uint32 Size = 0;
+    /// Offsets of the spec constants in the buffer.
+    const SpecConstBufferLayout *Layout = nullptr;
+  };
 
   // Returns the single instance of the program manager for the entire
   // process. Can only be called after staticInit is done.
@@ -85,15 +107,60 @@ public:
   ///        once the function returns.
   /// \param JITCompilationIsRequired If JITCompilationIsRequired is true
   ///        add a check that kernel is compiled, otherwise don't add the check.
+  /// \param PinSpecializedBuild if true and the program is built with the spec
+  ///        constant values set in Prg, the build is not evicted from the cache
+  ///        until KernelProgramCache::unpinSpecializedBuild() is called.
   RT::PiProgram getBuiltPIProgram(OSModuleHandle M, const context &Context,
                                   const device &Device,
                                   const string_class &KernelName,
                                   const program_impl *Prg = nullptr,
-                                  bool JITCompilationIsRequired = false);
+                                  bool JITCompilationIsRequired = false,
+                                  bool PinSpecializedBuild = false);
+  /// Builds or retrieves from cache the programs for each of the devices,
+  /// like getBuiltPIProgram does for a single device. The builds for
+  /// different devices run concurrently.
+  /// \return the programs in the order of Devices.
+  std::vector<RT::PiProgram>
+  getBuiltPIPrograms(OSModuleHandle M, const context &Context,
+                     const vector_class<device> &Devices,
+                     const string_class &KernelName,
+                     const program_impl *Prg = nullptr,
+                     bool JITCompilationIsRequired = false);
+  /// Builds the programs of all registered kernel sets for each of the
+  /// devices and puts them to the program cache of the context. Build
+  /// failures are ignored, the failed builds are retried on the kernel
+  /// submission.
+  void prebuildAll(const context &Context, const vector_class<device> &Devices);
+  /// Returns the native binaries of the programs built from SPIR-V images
+  /// which are in the program cache of the context.
+  std::vector<BuiltProgramBundle::Entry>
+  getBuiltProgramEntries(const context &Context);
+  /// Builds or retrieves from cache the kernel with given name.
+  /// \param KernelID the integer ID of the kernel as returned by getKernelID,
+  ///        zero if the kernel is identified by its name only.
   std::pair<RT::PiKernel, std::mutex *>
   getOrCreateKernel(OSModuleHandle M, const context &Context,
                     const device &Device, const string_class &KernelName,
-                    const program_impl *Prg);
+                    const program_impl *Prg, unsigned int KernelID = 0);
+
+  /// Returns a free clone of a kernel returned by getOrCreateKernel for
+  /// the kernels which are not bound to a user program, creating it if
+  /// needed. The clone must be given back to the kernel program cache of the
+  /// context with KernelProgramCache::returnKernelClone.
+  RT::PiKernel getKernelClone(const ContextImplPtr &Context,
+                              RT::PiProgram Program, RT::PiKernel Kernel,
+                              const string_class &KernelName);
+
+  /// Returns the name of the kernel of the program to create for KernelName:
+  /// the sub-group size variant picked for the device of the program if the
+  /// kernel has some, KernelName otherwise.
+  string_class getKernelVariantName(RT::PiProgram Program,
+                                    const string_class &KernelName);
+
+  /// Returns the process-wide integer ID of the kernel coming from the OS
+  /// module. IDs are dense and start from 1, so they can be used as indices
+  /// in flat per-context tables of kernels.
+  unsigned int getKernelID(OSModuleHandle M, const string_class &KernelName);
   RT::PiProgram getPiProgramFromPiKernel(RT::PiKernel Kernel,
                                          const ContextImplPtr Context);
 
@@ -130,10 +197,23 @@ public:
   /// \param KnownProgram indicates whether the PI program is guaranteed to
   ///        be known to program manager (built with its API) or not (not
   ///        cacheable or constructed with interoperability).
+  /// \param ArgFields if not null, receives the aggregate arguments of which
+  ///        only parts are passed to the kernel.
+  /// \param SpecConstBuf if not null, receives the description of the
+  ///        argument taking the emulated spec constants.
   KernelArgMask
   getEliminatedKernelArgMask(OSModuleHandle M, const context &Context,
                              const device &Device, pi::PiProgram NativePrg,
-                             const string_class &KernelName, bool KnownProgram);
+                             const string_class &KernelName, bool KnownProgram,
+                             KernelArgFields *ArgFields = nullptr,
+                             SpecConstBufferInfo *SpecConstBuf = nullptr);
+
+  /// Fills the buffer passed in the argument taking emulated spec constants
+  /// with the values set in the program, or zeroes for the ones not set.
+  /// \param Prg the program the kernel comes from, may be null.
+  static void fillSpecConstBuffer(const SpecConstBufferInfo &SpecConstBuf,
+                                  const program_impl *Prg,
+                                  std::vector<unsigned char> &Buffer);
 
   ProgramManager();
   ~ProgramManager() = default;
@@ -151,7 +231,7 @@ private:
   ProgramPtr build(ProgramPtr Program, const ContextImplPtr Context,
                    const string_class &CompileOptions,
                    const string_class &LinkOptions, const RT::PiDevice &Device,
-                   std::map<std::pair<DeviceLibExt, RT::PiDevice>,
+                   std::map<std::tuple<DeviceLibExt, bool, RT::PiDevice>,
                             RT::PiProgram> &CachedLibPrograms,
                    uint32_t DeviceLibReqMask);
   /// Provides a new kernel set id for grouping kernel names together
@@ -160,22 +240,41 @@ private:
   /// cases (when reading images from file or using images with no entry info)
   KernelSetId getKernelSetId(OSModuleHandle M,
                              const string_class &KernelName) const;
+  /// Looks up the kernel set of a kernel with entry info in the kernel name
+  /// tables and m_KernelSets, returns 0 if there is none. Doesn't allocate
+  /// memory unless the module has images registered without a name table.
+  /// Must be called with the \ref Sync::getGlobalLock() held.
+  KernelSetId findKernelSetId(OSModuleHandle M, const char *KernelName) const;
+  /// Estimates the memory held by a built program, which is the size of the
+  /// device image it is built from, or 0 if the image is not known.
+  size_t getProgramSizeEstimate(RT::PiProgram Program);
+  /// Records that a program has been built from Img for Device.
+  /// \return true if programs have been built from Img for all the devices of
+  /// Ctx.
+  /// Must be called with the \ref MNativeProgramsMutex held.
+  bool isImageBuiltForContext(const RTDeviceBinaryImage &Img,
+                              const ContextImplPtr &Ctx, RT::PiDevice Device);
   /// Dumps image to current directory
   void dumpImage(const RTDeviceBinaryImage &Img, KernelSetId KSId) const;
+  /// Fills \ref m_EliminatedKernelArgMasks, \ref m_KernelArgFields,
+  /// \ref m_SpecConstBufferLayouts and \ref m_KernelSpecConstBuffers for the
+  /// given prepared image if it hasn't been done yet.
+  /// Must be called with the \ref Sync::getGlobalLock() held.
+  void cacheKernelArgInfo(const RTDeviceBinaryImage &Img);
 
-  /// The three maps below are used during kernel resolution. Any kernel is
+  /// The maps below are used during kernel resolution. Any kernel is
   /// identified by its name and the OS module it's coming from, allowing
   /// kernels with identical names in different OS modules. The following
   /// assumption is made: for any two device images in a SYCL application
   /// their kernel sets are either identical or disjoint. Based on this
-  /// assumption, m_KernelSets is used to group kernels together into sets by
-  /// assigning a set ID to them during device image registration. This ID is
-  /// then mapped to a vector of device images containing kernels from the set
-  /// (m_DeviceImages). An exception is made for device images with no entry
-  /// information: a special kernel set ID is used for them which is assigned
-  /// to just the OS module. These kernel set ids are stored in
-  /// m_OSModuleKernelSets and device images associated with them are assumed
-  /// to contain all kernels coming from that OS module.
+  /// assumption, m_KernelSets (or m_KernelNameTables) is used to group kernels
+  /// together into sets by assigning a set ID to them during device image
+  /// registration. This ID is then mapped to a vector of device images
+  /// containing kernels from the set (m_DeviceImages). An exception is made
+  /// for device images with no entry information: a special kernel set ID is
+  /// used for them which is assigned to just the OS module. These kernel set
+  /// ids are stored in m_OSModuleKernelSets and device images associated with
+  /// them are assumed to contain all kernels coming from that OS module.
 
   using RTDeviceBinaryImageUPtr = std::unique_ptr<RTDeviceBinaryImage>;
 
@@ -193,6 +292,30 @@ private:
   /// Access must be guarded by the \ref Sync::getGlobalLock()
   std::unordered_map<OSModuleHandle, StrToKSIdMap> m_KernelSets;
 
+  /// The sorted kernel name table of a binary descriptor, see
+  /// pi_device_binaries_struct. Kernels from descriptors having one are not
+  /// added to m_KernelSets, they are found by binary search in the table
+  /// emitted by clang-offload-wrapper instead.
+  struct KernelNameTable {
+    _pi_kernel_name_entry Begin;
+    _pi_kernel_name_entry End;
+    /// Kernel set ids of the descriptor images, indexed the same way.
+    std::vector<KernelSetId> ImageKSIds;
+  };
+  /// Keeps the kernel name tables of the descriptors registered for each OS
+  /// module.
+  /// Access must be guarded by the \ref Sync::getGlobalLock()
+  std::unordered_map<OSModuleHandle, std::vector<KernelNameTable>>
+      m_KernelNameTables;
+
+  /// Keeps the images with entry info added to m_DeviceImages, with their
+  /// kernel sets, by their first kernel name, target and size. These are the
+  /// candidates for being identical to an image registered by another module.
+  /// Access must be guarded by the \ref Sync::getGlobalLock()
+  std::multimap<std::tuple<std::string, std::string, size_t>,
+                std::pair<pi_device_binary, KernelSetId>>
+      m_ImageCopyCandidates;
+
   /// Keeps kernel sets for OS modules containing images without entry info.
   /// Such images are assumed to contain all kernel associated with the module.
   /// Access must be guarded by the \ref Sync::getGlobalLock()
@@ -213,16 +336,62 @@ private:
   // NOTE: access is synchronized via the MNativeProgramsMutex
   std::unordered_map<pi::PiProgram, const RTDeviceBinaryImage *> NativePrograms;
 
-  /// Protects NativePrograms that can be changed by class' methods.
+  /// Maps the programs built from images with sub-group size variants to the
+  /// names of the variants picked for the device of the program, by kernel
+  /// name. The same caveats as for NativePrograms apply to the keys.
+  /// NOTE: access is synchronized via the MNativeProgramsMutex
+  std::unordered_map<pi::PiProgram,
+                     std::unordered_map<string_class, string_class>>
+      MKernelVariantNames;
+
+  /// The devices for which programs have been built from each image, see
+  /// isImageBuiltForContext.
+  /// NOTE: access is synchronized via the MNativeProgramsMutex
+  std::unordered_map<const RTDeviceBinaryImage *,
+                     std::unordered_set<RT::PiDevice>>
+      MImageBuiltDevices;
+
+  /// Protects NativePrograms, MKernelVariantNames and MImageBuiltDevices that
+  /// can be changed by class' methods.
   std::mutex MNativeProgramsMutex;
 
   using KernelNameToArgMaskMap =
       std::unordered_map<string_class, KernelArgMask>;
   /// Maps binary image and kernel name pairs to kernel argument masks which
   /// specify which arguments were eliminated during device code optimization.
+  /// The entry for an image is created when the image is first used.
+  /// Access must be guarded by the \ref Sync::getGlobalLock()
   std::unordered_map<const RTDeviceBinaryImage *, KernelNameToArgMaskMap>
       m_EliminatedKernelArgMasks;
 
+  using KernelNameToArgFieldsMap =
+      std::unordered_map<string_class, KernelArgFields>;
+  /// Maps binary image and kernel name pairs to the aggregate kernel arguments
+  /// which were reduced to their used parts during device code optimization.
+  /// Access must be guarded by the \ref Sync::getGlobalLock()
+  std::unordered_map<const RTDeviceBinaryImage *, KernelNameToArgFieldsMap>
+      m_KernelArgFields;
+
+  /// Maps binary images with emulated spec constants to the layouts of their
+  /// spec constants buffers.
+  /// Access must be guarded by the \ref Sync::getGlobalLock()
+  std::unordered_map<const RTDeviceBinaryImage *, SpecConstBufferLayout>
+      m_SpecConstBufferLayouts;
+
+  using KernelNameToSpecConstBufferMap =
+      std::unordered_map<string_class, SpecConstBufferInfo>;
+  /// Maps binary image and kernel name pairs to the kernel arguments taking
+  /// emulated spec constants buffers.
+  /// Access must be guarded by the \ref Sync::getGlobalLock()
+  std::unordered_map<const RTDeviceBinaryImage *,
+                     KernelNameToSpecConstBufferMap>
+      m_KernelSpecConstBuffers;
+
+  /// Maps the OS module and the name of a kernel to its integer ID.
+  std::map<std::pair<OSModuleHandle, string_class>, unsigned int> m_KernelIDs;
+  /// Protects m_KernelIDs.
+  std::mutex m_KernelIDsMutex;
+
   /// True iff a SPIR-V file has been specified with an environment variable
   bool m_UseSpvFile = false;
 };
@@ -9,10 +9,17 @@
 #include <CL/sycl/context.hpp>
 #include <CL/sycl/detail/memory_manager.hpp>
 #include <CL/sycl/detail/pi.hpp>
+#include <CL/sycl/detail/usm_impl.hpp>
 #include <CL/sycl/device.hpp>
+#include <detail/config.hpp>
+#include <detail/device_selection_cache.hpp>
 #include <detail/event_impl.hpp>
+#include <detail/global_handler.hpp>
+#include <detail/numa.hpp>
 #include <detail/queue_impl.hpp>
 
+#include <algorithm>
+#include <cstdlib>
 #include <cstring>
 #include <utility>
 
@@ -24,6 +31,21 @@
 __SYCL_INLINE_NAMESPACE(cl) {
 namespace sycl {
 namespace detail {
+ContextImplPtr queue_impl::getDefaultContext(const DeviceImplPtr &Device) {
+  auto Create = [&Device] {
+    return detail::getSyclObjImpl(
+        context(createSyclObjFromImpl<device>(Device), {},
+                (DefaultContextType == CUDAContextT::primary)
+                    ? property_list{property::context::cuda::
+                                        use_primary_context()}
+                    : property_list{}));
+  };
+  if (SYCLConfig<SYCL_DISABLE_DEFAULT_CONTEXT>::get())
+    return Create();
+  return GlobalHandler::instance().getDeviceSelectionCache().getDefaultContext(
+      Device, Create);
+}
+
 template <> cl_uint queue_impl::get_info<info::queue::reference_count>() const {
   RT::PiResult result = PI_SUCCESS;
   if (!is_host())
@@ -44,7 +66,7 @@ template <> device queue_impl::get_info<info::queue::device>() const {
 static event
 prepareUSMEvent(const shared_ptr_class<detail::queue_impl> &QueueImpl,
                 RT::PiEvent NativeEvent) {
-  auto EventImpl = std::make_shared<detail::event_impl>(QueueImpl);
+  auto EventImpl = detail::makeEventImpl(QueueImpl);
   EventImpl->getHandleRef() = NativeEvent;
   EventImpl->setContextImpl(detail::getSyclObjImpl(QueueImpl->get_context()));
   return detail::createSyclObjFromImpl<event>(EventImpl);
@@ -96,8 +118,108 @@ event queue_impl::mem_advise(const shared_ptr_class<detail::queue_impl> &Self,
   return ResEvent;
 }
 
+event queue_impl::enqueueCommandGraph(
+    const shared_ptr_class<detail::queue_impl> &Self,
+    RT::PiExtCommandGraph Graph, const vector_class<event> &DepEvents) {
+  vector_class<RT::PiEvent> WaitList;
+  for (const event &DepEvent : DepEvents) {
+    const EventImplPtr &DepEventImpl = getSyclObjImpl(DepEvent);
+    if (DepEventImpl->is_host())
+      DepEventImpl->wait(DepEventImpl);
+    else
+      WaitList.push_back(DepEventImpl->getHandleRef());
+  }
+
+  RT::PiEvent NativeEvent{};
+  getPlugin().call<PiApiKind::piextEnqueueCommandGraph>(
+      getHandleRef(), Graph, WaitList.size(),
+      WaitList.empty() ? nullptr : WaitList.data(), &NativeEvent);
+
+  event ResEvent = prepareUSMEvent(Self, NativeEvent);
+  addSharedEvent(ResEvent);
+  return ResEvent;
+}
+
+event queue_impl::addNativeEvent(const shared_ptr_class<queue_impl> &Self,
+                                 RT::PiEvent NativeEvent) {
+  event ResEvent = prepareUSMEvent(Self, NativeEvent);
+  addSharedEvent(ResEvent);
+  return ResEvent;
+}
+
+constexpr size_t queue_impl::MinEventsToPrune;
+
+void queue_impl::startFusion() {
+  if (MHostQueue)
+    throw feature_not_supported(
+        "Kernel fusion is not supported by the host queues",
+        PI_INVALID_OPERATION);
+  std::lock_guard<mutex_class> Lock(MFusionMutex);
+  if (MInFusionMode)
+    throw runtime_error("The queue is already in fusion mode",
+                        PI_INVALID_OPERATION);
+  MInFusionMode = true;
+}
+
+EventImplPtr queue_impl::addToFusion(std::unique_ptr<CG> CommandGroup) {
+  std::lock_guard<mutex_class> Lock(MFusionMutex);
+  if (!MInFusionMode)
+    throw runtime_error("The queue is not in fusion mode",
+                        PI_INVALID_OPERATION);
+  EventImplPtr Event = makeEventImpl();
+  MFusionList.emplace_back(Event, std::move(CommandGroup));
+  return Event;
+}
+
+event queue_impl::completeFusion(const shared_ptr_class<queue_impl> &Self) {
+  vector_class<std::pair<EventImplPtr, std::unique_ptr<CG>>> FusionList;
+  {
+    std::lock_guard<mutex_class> Lock(MFusionMutex);
+    if (!MInFusionMode)
+      throw runtime_error("The queue is not in fusion mode",
+                          PI_INVALID_OPERATION);
+    MInFusionMode = false;
+    FusionList.swap(MFusionList);
+  }
+
+  vector_class<event> Events = submitCollected(Self, std::move(FusionList));
+
+  // A barrier stands for all of the command groups, and orders them with the
+  // next submissions to an in-order queue.
+  return submit([&](handler &CGH) { CGH.barrier(Events); }, Self, {});
+}
+
+vector_class<event> queue_impl::submitCollected(
+    const shared_ptr_class<queue_impl> &Self,
+    vector_class<std::pair<EventImplPtr, std::unique_ptr<CG>>> CommandGroups) {
+  if (CommandGroups.empty())
+    return {};
+  const EventImplPtr LastPlaceholder = CommandGroups.back().first;
+  std::vector<EventImplPtr> EventImpls =
+      Scheduler::getInstance().addCGs(std::move(CommandGroups), Self);
+
+  vector_class<event> Events;
+  Events.reserve(EventImpls.size());
+  for (EventImplPtr &EventImpl : EventImpls) {
+    Events.push_back(createSyclObjFromImpl<event>(std::move(EventImpl)));
+    addEvent(Events.back());
+  }
+
+  // The next command groups submitted to an in-order queue depend on the
+  // last collected one, not on its placeholder
+  if (MIsInorder) {
+    std::lock_guard<mutex_class> Lock(MLastEventMutex);
+    if (MLastEvent == LastPlaceholder)
+      MLastEvent = getSyclObjImpl(Events.back());
+  }
+  return Events;
+}
+
 void queue_impl::addEvent(const event &Event) {
   EventImplPtr Eimpl = getSyclObjImpl(Event);
+  // The discarded events are waited for with piQueueFinish
+  if (Eimpl == MDiscardedEvent)
+    return;
   Command *Cmd = (Command *)(Eimpl->getCommand());
   if (!Cmd) {
     // if there is no command on the event, we cannot track it with MEventsWeak
@@ -107,15 +229,79 @@ void queue_impl::addEvent(const event &Event) {
     std::weak_ptr<event_impl> EventWeakPtr{Eimpl};
     std::lock_guard<mutex_class> Lock{MMutex};
     MEventsWeak.push_back(std::move(EventWeakPtr));
+    if (MEventsWeak.size() >= MEventsWeakPruneSize)
+      pruneWeakEvents();
   }
 }
 
+event queue_impl::finalizeInOrder(handler &Handler) {
+  std::lock_guard<mutex_class> Lock(MLastEventMutex);
+  const bool IsHostTask = Handler.MCGType == CG::CODEPLAY_HOST_TASK ||
+                          Handler.MCGType == CG::RUN_ON_HOST_INTEL;
+  if (MLastEvent && MLastEvent == MDiscardedEvent) {
+    // The discarded events can't be waited for, a marker on the native queue
+    // stands for the commands before the host task.
+    if (IsHostTask) {
+      EventImplPtr Marker = makeEventImpl(Handler.MQueue);
+      Marker->setContextImpl(MContext);
+      getPlugin().call<PiApiKind::piEnqueueEventsWait>(
+          MQueues[0], 0, nullptr, &Marker->getHandleRef());
+      Handler.MEvents.push_back(std::move(Marker));
+    }
+  } else if (MLastEvent && (IsHostTask || MLastEvent->is_host() ||
+                            MLastEvent->getHandleRef() == nullptr)) {
+    // Host tasks are not on the native queue, neither are the commands which
+    // are blocked in the graph
+    Handler.MEvents.push_back(MLastEvent);
+  }
+
+  event Event = Handler.finalize();
+  MLastEvent = getSyclObjImpl(Event);
+  return Event;
+}
+
 /// addSharedEvent - queue_impl tracks events with weak pointers
 /// but some events have no other owner. In this case,
 /// addSharedEvent will have the queue track the events via a shared pointer.
 void queue_impl::addSharedEvent(const event &Event) {
   std::lock_guard<mutex_class> Lock(MMutex);
   MEventsShared.push_back(Event);
+  if (MEventsShared.size() >= MEventsSharedPruneSize)
+    pruneSharedEvents();
+}
+
+void queue_impl::pruneWeakEvents() {
+  MEventsWeak.erase(
+      std::remove_if(MEventsWeak.begin(), MEventsWeak.end(),
+                     [](const std::weak_ptr<event_impl> &EventImplWeakPtr) {
+                       return EventImplWeakPtr.expired();
+                     }),
+      MEventsWeak.end());
+  MEventsWeakPruneSize = std::max(MinEventsToPrune, 2 * MEventsWeak.size());
+}
+
+/// \return true if the event has a native event which is complete.
+static bool isNativeEventComplete(const plugin &Plugin, const event &Event) {
+  RT::PiEvent Handle = getSyclObjImpl(Event)->getHandleRef();
+  if (!Handle)
+    return false;
+  pi_int32 Status = PI_EVENT_QUEUED;
+  return Plugin.call_nocheck<PiApiKind::piEventGetInfo>(
+             Handle, PI_EVENT_INFO_COMMAND_EXECUTION_STATUS, sizeof(Status),
+             &Status, nullptr) == PI_SUCCESS &&
+         Status == PI_EVENT_COMPLETE;
+}
+
+void queue_impl::pruneSharedEvents() {
+  const plugin &Plugin = getPlugin();
+  MEventsShared.erase(std::remove_if(MEventsShared.begin(), MEventsShared.end(),
+                                     [&Plugin](const event &Event) {
+                                       return isNativeEventComplete(Plugin,
+                                                                    Event);
+                                     }),
+                      MEventsShared.end());
+  MEventsSharedPruneSize =
+      std::max(MinEventsToPrune, 2 * MEventsShared.size());
 }
 
 void *queue_impl::instrumentationProlog(const detail::code_location &CodeLoc,
@@ -128,7 +314,10 @@ void *queue_impl::instrumentationProlog(const detail::code_location &CodeLoc,
   (void)IId;
 #ifdef XPTI_ENABLE_INSTRUMENTATION
   xpti::trace_event_data_t *WaitEvent = nullptr;
-  if (!xptiTraceEnabled())
+  // Bail out before building the payload if nobody listens to wait() calls or
+  // this one is not sampled
+  if (!xptiCheckTraceEnabled(StreamID, xpti::trace_wait_begin) ||
+      !xptiSampleTrace(StreamID))
     return TraceEvent;
 
   xpti::payload_t Payload;
@@ -219,12 +408,19 @@ void queue_impl::wait(const detail::code_location &CodeLoc) {
     USMEvents.swap(MEventsShared);
   }
 
+  vector_class<EventImplPtr> EventImpls;
+  EventImpls.reserve(Events.size() + USMEvents.size());
   for (std::weak_ptr<event_impl> &EventImplWeakPtr : Events)
     if (std::shared_ptr<event_impl> EventImplPtr = EventImplWeakPtr.lock())
-      EventImplPtr->wait(EventImplPtr);
-
+      EventImpls.push_back(std::move(EventImplPtr));
   for (event &Event : USMEvents)
-    Event.wait();
+    EventImpls.push_back(getSyclObjImpl(Event));
+
+  event_impl::waitAll(EventImpls);
+  // The submissions whose events are discarded are only known to the native
+  // queue
+  if (MDiscardEvents)
+    getPlugin().call<PiApiKind::piQueueFinish>(MQueues[0]);
 
 #ifdef XPTI_ENABLE_INSTRUMENTATION
   instrumentationEpilog(TelemetryEvent, Name, StreamID, IId);
@@ -251,7 +447,24 @@ void queue_impl::initHostTaskAndEventCallbackThreadPool() {
         "Invalid value for SYCL_QUEUE_THREAD_POOL_SIZE environment variable",
         PI_INVALID_VALUE);
 
-  MHostTaskThreadPool.reset(new ThreadPool(Size));
+  // Pinning the workers to the host cores is opt-in.
+  const char *PinVal = std::getenv("SYCL_QUEUE_THREAD_POOL_PINNING");
+  const bool PinThreads = PinVal && std::atoi(PinVal) != 0;
+
+  // The host tasks of the prioritized queues run at the matching host thread
+  // priority.
+  int NiceIncrement = 0;
+  if (has_property<ext::oneapi::property::queue::priority_low>())
+    NiceIncrement = 5;
+  else if (has_property<ext::oneapi::property::queue::priority_high>())
+    NiceIncrement = -5;
+
+  // The host tasks mostly feed the device, so they run on the host cores of
+  // its NUMA node.
+  std::vector<size_t> Cores = getNumaNodeCores(MDevice->getNumaNode());
+
+  MHostTaskThreadPool.reset(
+      new ThreadPool(Size, PinThreads, NiceIncrement, std::move(Cores)));
   MHostTaskThreadPool->start();
 }
 
@@ -262,6 +475,95 @@ pi_native_handle queue_impl::getNative() const {
   return Handle;
 }
 
+// The arena keeps at most this number of free scratch buffers, so that
+// reductions with many different sizes don't hold too much memory.
+static constexpr size_t MaxNumFreeReductionScratch = 16;
+
+std::unique_ptr<queue_impl::ReductionScratchT>
+queue_impl::takeReductionScratch(size_t Size, bool ZeroInit) {
+  {
+    std::lock_guard<mutex_class> Lock(MReductionScratchMutex);
+    auto It = MReductionScratch.find({ZeroInit, Size});
+    if (It != MReductionScratch.end()) {
+      std::unique_ptr<ReductionScratchT> Buf = std::move(It->second);
+      MReductionScratch.erase(It);
+      return Buf;
+    }
+  }
+
+  if (!ZeroInit)
+    return std::unique_ptr<ReductionScratchT>(
+        new ReductionScratchT(range<1>(Size)));
+  // The buffer copies the zeros to its own storage.
+  vector_class<unsigned char> Zeros(Size, 0);
+  std::unique_ptr<ReductionScratchT> Buf(
+      new ReductionScratchT(Zeros.begin(), Zeros.end()));
+  Buf->set_write_back(false);
+  return Buf;
+}
+
+void queue_impl::returnReductionScratch(
+    size_t Size, bool ZeroInit, std::unique_ptr<ReductionScratchT> Buf) {
+  std::unique_lock<mutex_class> Lock(MReductionScratchMutex);
+  if (MReductionScratch.size() >= MaxNumFreeReductionScratch) {
+    // Destroy the buffer without holding the lock, as that may wait for
+    // the commands using it.
+    Lock.unlock();
+    Buf.reset();
+    return;
+  }
+  MReductionScratch.emplace(std::make_pair(ZeroInit, Size), std::move(Buf));
+}
+
+void *queue_impl::takeReductionUSMScratch(size_t Size, bool ZeroInit) {
+  if (MHostQueue || !MIsInorder || getRecordingGraph())
+    return nullptr;
+  {
+    std::lock_guard<mutex_class> Lock(MReductionScratchMutex);
+    auto It = MReductionUSMScratch.find({ZeroInit, Size});
+    if (It != MReductionUSMScratch.end()) {
+      void *Ptr = It->second;
+      MReductionUSMScratch.erase(It);
+      return Ptr;
+    }
+  }
+
+  void *Ptr = usm::alignedAlloc(0, Size, get_context(), get_device(),
+                                sycl::usm::alloc::device);
+  if (!Ptr || !ZeroInit)
+    return Ptr;
+  // The in-order queue fills the zeros before the command group using them.
+  RT::PiEvent Event = nullptr;
+  const detail::plugin &Plugin = getPlugin();
+  Plugin.call<PiApiKind::piextUSMEnqueueMemset>(MQueues[0], Ptr, 0, Size, 0,
+                                                nullptr, &Event);
+  Plugin.call<PiApiKind::piEventRelease>(Event);
+  return Ptr;
+}
+
+void queue_impl::returnReductionUSMScratch(size_t Size, bool ZeroInit,
+                                           void *Ptr) {
+  {
+    std::lock_guard<mutex_class> Lock(MReductionScratchMutex);
+    if (MReductionUSMScratch.size() < MaxNumFreeReductionScratch) {
+      MReductionUSMScratch.emplace(std::make_pair(ZeroInit, Size), Ptr);
+      return;
+    }
+  }
+  // The commands using the allocation may still run.
+  getPlugin().call<PiApiKind::piQueueFinish>(MQueues[0]);
+  usm::free(Ptr, get_context());
+}
+
+void queue_impl::freeReductionUSMScratch() {
+  if (MReductionUSMScratch.empty())
+    return;
+  getPlugin().call<PiApiKind::piQueueFinish>(MQueues[0]);
+  for (auto &Scratch : MReductionUSMScratch)
+    usm::free(Scratch.second, get_context());
+  MReductionUSMScratch.clear();
+}
+
 } // namespace detail
 } // namespace sycl
 } // __SYCL_INLINE_NAMESPACE(cl)
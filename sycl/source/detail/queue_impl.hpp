@@ -20,11 +20,15 @@
 #include <CL/sycl/stl.hpp>
 #include <detail/context_impl.hpp>
 #include <detail/device_impl.hpp>
+#include <detail/device_timestamps.hpp>
 #include <detail/event_impl.hpp>
+#include <detail/kernel_stats.hpp>
 #include <detail/plugin.hpp>
 #include <detail/scheduler/scheduler.hpp>
 #include <detail/thread_pool.hpp>
 
+#include <atomic>
+#include <map>
 #include <utility>
 
 __SYCL_INLINE_NAMESPACE(cl) {
@@ -33,6 +37,7 @@ namespace detail {
 
 using ContextImplPtr = std::shared_ptr<detail::context_impl>;
 using DeviceImplPtr = shared_ptr_class<detail::device_impl>;
+class command_graph_impl;
 
 /// Sets max number of queues supported by FPGA RT.
 static constexpr size_t MaxNumQueues = 256;
@@ -57,14 +62,8 @@ public:
   /// \param PropList is a list of properties to use for queue construction.
   queue_impl(const DeviceImplPtr &Device, const async_handler &AsyncHandler,
              const property_list &PropList)
-      : queue_impl(Device,
-                   detail::getSyclObjImpl(
-                       context(createSyclObjFromImpl<device>(Device), {},
-                               (DefaultContextType == CUDAContextT::primary)
-                                   ? property_list{property::context::cuda::
-                                                       use_primary_context()}
-                                   : property_list{})),
-                   AsyncHandler, PropList){};
+      : queue_impl(Device, getDefaultContext(Device), AsyncHandler,
+                   PropList){};
 
   /// Constructs a SYCL queue with an async_handler and property_list provided
   /// form a device and a context.
@@ -84,12 +83,33 @@ public:
           "Queue cannot be constructed with the given context and device "
           "as the context does not contain the given device.",
           PI_INVALID_DEVICE);
+    const QueueOrder QOrder =
+        MPropList.has_property<property::queue::in_order>()
+            ? QueueOrder::Ordered
+            : QueueOrder::OOO;
+    namespace queue_props = ext::oneapi::property::queue;
+    if (MPropList.has_property<queue_props::priority_normal>() +
+            MPropList.has_property<queue_props::priority_low>() +
+            MPropList.has_property<queue_props::priority_high>() >
+        1)
+      throw cl::sycl::invalid_parameter_error(
+          "Queue cannot be constructed with different priorities.",
+          PI_INVALID_QUEUE_PROPERTIES);
     if (!MHostQueue) {
-      const QueueOrder QOrder =
-          MPropList.has_property<property::queue::in_order>()
-              ? QueueOrder::Ordered
-              : QueueOrder::OOO;
       MQueues.push_back(createQueue(QOrder));
+      MIsInorder = QOrder == QueueOrder::Ordered;
+    }
+    if (MPropList
+            .has_property<ext::oneapi::property::queue::discard_events>()) {
+      if (QOrder != QueueOrder::Ordered)
+        throw cl::sycl::invalid_parameter_error(
+            "The discard_events property requires the in_order property.",
+            PI_INVALID_QUEUE_PROPERTIES);
+      // The Level Zero plugin needs an output event for each command.
+      MDiscardEvents =
+          !MHostQueue && getPlugin().getBackend() != backend::level_zero;
+      if (MDiscardEvents)
+        MDiscardedEvent = makeEventImpl();
     }
   }
 
@@ -120,6 +140,7 @@ public:
   ~queue_impl() {
     throw_asynchronous();
     if (!MHostQueue) {
+      freeReductionUSMScratch();
       getPlugin().call<PiApiKind::piQueueRelease>(MQueues[0]);
     }
   }
@@ -147,9 +168,20 @@ public:
   /// \return an associated SYCL device.
   device get_device() const { return createSyclObjFromImpl<device>(MDevice); }
 
+  /// \return an implementation of the device associated with this queue.
+  const DeviceImplPtr &getDeviceImplPtr() const { return MDevice; }
+
   /// \return true if this queue is a SYCL host queue.
   bool is_host() const { return MHostQueue; }
 
+  /// \return true if the kernels enqueued without the graph need no native
+  /// event, see ext::oneapi::property::queue::discard_events.
+  bool discardsEvents() const { return MDiscardEvents; }
+
+  /// \return the event returned for the submissions whose events are
+  /// discarded.
+  const EventImplPtr &getDiscardedEvent() const { return MDiscardedEvent; }
+
   /// Queries SYCL queue for information.
   ///
   /// The return type depends on information being queried.
@@ -245,9 +277,23 @@ public:
     if (Order == QueueOrder::OOO) {
       CreationFlags = PI_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE;
     }
-    if (MPropList.has_property<property::queue::enable_profiling>()) {
+    // The device execution times reported to the XPTI subscribers and
+    // recorded in the kernel statistics need profiling too
+    if (MPropList.has_property<property::queue::enable_profiling>() ||
+        DeviceTimestampPoller::isEnabled() ||
+        KernelStatsRecorder::isEnabled()) {
       CreationFlags |= PI_QUEUE_PROFILING_ENABLE;
     }
+    if (MPropList.has_property<ext::oneapi::property::queue::priority_low>())
+      CreationFlags |= PI_EXT_ONEAPI_QUEUE_PRIORITY_LOW;
+    else if (MPropList
+                 .has_property<ext::oneapi::property::queue::priority_high>())
+      CreationFlags |= PI_EXT_ONEAPI_QUEUE_PRIORITY_HIGH;
+    if (MPropList
+            .has_property<ext::oneapi::property::queue::sub_device_scaling>())
+      CreationFlags |= PI_EXT_ONEAPI_QUEUE_SUB_DEVICE_SCALING;
+    if (MPropList.has_property<ext::oneapi::property::queue::spin_wait>())
+      CreationFlags |= PI_EXT_ONEAPI_QUEUE_SPIN_WAIT;
     RT::PiQueue Queue{};
     RT::PiContext Context = MContext->getHandleRef();
     RT::PiDevice Device = MDevice->getHandleRef();
@@ -350,6 +396,67 @@ public:
   /// \param Advice is a device-defined advice for the specified allocation.
   event mem_advise(const shared_ptr_class<queue_impl> &Self, const void *Ptr,
                    size_t Length, pi_mem_advice Advice);
+  /// Executes a command graph recorded from a queue of the same context.
+  ///
+  /// \param Impl is a shared_ptr to this queue.
+  /// \param Graph is the executable graph built by the plugin.
+  /// \param DepEvents are the events the execution waits for.
+  /// \return an event representing the execution of the graph.
+  event enqueueCommandGraph(const shared_ptr_class<queue_impl> &Self,
+                            RT::PiExtCommandGraph Graph,
+                            const vector_class<event> &DepEvents);
+
+  /// Tracks a native command enqueued to the queue without a command group.
+  ///
+  /// \param Self is a shared_ptr to this queue.
+  /// \param NativeEvent is the event of the command, which the returned event
+  /// takes the ownership of.
+  /// \return an event representing the command.
+  event addNativeEvent(const shared_ptr_class<queue_impl> &Self,
+                       RT::PiEvent NativeEvent);
+
+  /// Sets the command graph which records the command groups submitted to the
+  /// queue instead of executing them, see command_graph_impl::record.
+  ///
+  /// \param Graph is the recording graph, or nullptr to end the recording.
+  void setRecordingGraph(command_graph_impl *Graph) {
+    MRecordingGraph.store(Graph);
+  }
+
+  /// \return the command graph recording the queue, or nullptr.
+  command_graph_impl *getRecordingGraph() const {
+    return MRecordingGraph.load();
+  }
+
+  /// Starts collecting the command groups submitted to the queue instead of
+  /// submitting them, see ONEAPI::fusion_wrapper.
+  void startFusion();
+
+  /// \return true if the command groups submitted to the queue are collected.
+  bool isInFusionMode() const { return MInFusionMode.load(); }
+
+  /// Collects a command group submitted in fusion mode.
+  ///
+  /// \return an event standing for the command group, which may only be used
+  /// as a dependency of the other command groups of the fusion.
+  EventImplPtr addToFusion(std::unique_ptr<CG> CommandGroup);
+
+  /// Submits the collected command groups and leaves the fusion mode.
+  ///
+  /// \param Self is a shared_ptr to this queue.
+  /// \return an event representing the execution of the command groups.
+  event completeFusion(const shared_ptr_class<queue_impl> &Self);
+
+  /// Submits command groups collected by the fusion mode or by a
+  /// ONEAPI::submission_batch, in order.
+  ///
+  /// \param Self is a shared_ptr to this queue.
+  /// \param CommandGroups are the command groups, each with the placeholder
+  /// event returned for it when it was collected.
+  /// \return the events of the command groups.
+  vector_class<event> submitCollected(
+      const shared_ptr_class<queue_impl> &Self,
+      vector_class<std::pair<EventImplPtr, std::unique_ptr<CG>>> CommandGroups);
 
   /// Puts exception to the list of asynchronous ecxeptions.
   ///
@@ -371,7 +478,57 @@ public:
   /// \return a native handle.
   pi_native_handle getNative() const;
 
+  /// Buffer of bytes used by reductions for their temporary data.
+  using ReductionScratchT = buffer<unsigned char, 1>;
+
+  /// Takes a scratch buffer from the reduction scratch arena of the queue,
+  /// or creates a new one if there is no free buffer of the required size.
+  ///
+  /// \param Size is the size of the buffer in bytes.
+  /// \param ZeroInit is true if the buffer must be filled with zeros. It is
+  /// the responsibility of the user of such buffer to restore the zeros
+  /// before the buffer is returned.
+  /// \return a scratch buffer.
+  std::unique_ptr<ReductionScratchT> takeReductionScratch(size_t Size,
+                                                          bool ZeroInit);
+
+  /// Returns a scratch buffer taken by takeReductionScratch() to the arena.
+  ///
+  /// \param Size is the size of the buffer in bytes.
+  /// \param ZeroInit is true if the buffer is filled with zeros.
+  /// \param Buf is the buffer to be returned.
+  void returnReductionScratch(size_t Size, bool ZeroInit,
+                              std::unique_ptr<ReductionScratchT> Buf);
+
+  /// Takes a USM device allocation from the reduction scratch arena of the
+  /// queue, or allocates a new one if there is no free allocation of the
+  /// required size.
+  ///
+  /// The allocation may be returned to the arena as soon as the command group
+  /// using it is enqueued, because the in-order queue runs the commands of
+  /// its next user after that command group.
+  ///
+  /// \param Size is the size of the allocation in bytes.
+  /// \param ZeroInit is true if the allocation must be filled with zeros. It
+  /// is the responsibility of the user of such allocation to restore the zeros
+  /// before the allocation is returned.
+  /// \return the allocation, or nullptr if the queue is not in-order, is
+  /// recorded into a command graph or the allocation fails.
+  void *takeReductionUSMScratch(size_t Size, bool ZeroInit);
+
+  /// Returns an allocation taken by takeReductionUSMScratch() to the arena.
+  ///
+  /// \param Size is the size of the allocation in bytes.
+  /// \param ZeroInit is true if the allocation is filled with zeros.
+  /// \param Ptr is the allocation to be returned.
+  void returnReductionUSMScratch(size_t Size, bool ZeroInit, void *Ptr);
+
 private:
+  /// \return the context of the queues constructed from Device only. It is
+  /// shared by all these queues, so that constructing them is cheap, unless
+  /// SYCL_DISABLE_DEFAULT_CONTEXT is set.
+  static ContextImplPtr getDefaultContext(const DeviceImplPtr &Device);
+
   /// Performs command group submission to the queue.
   ///
   /// \param CGF is a function object containing command group.
@@ -384,7 +541,7 @@ private:
     handler Handler(Self, MHostQueue);
     Handler.saveCodeLoc(Loc);
     CGF(Handler);
-    event Event = Handler.finalize();
+    event Event = MIsInorder ? finalizeInOrder(Handler) : Handler.finalize();
     addEvent(Event);
     return Event;
   }
@@ -400,6 +557,20 @@ private:
 
   void initHostTaskAndEventCallbackThreadPool();
 
+  /// Waits for the native queue and frees the free USM scratch allocations
+  /// of reductions.
+  void freeReductionUSMScratch();
+
+  /// Finalizes a command group submitted to an in-order queue.
+  ///
+  /// The native queue orders the device commands enqueued to it, so the
+  /// command group only depends on the previous one if it is a host task or
+  /// if the previous one is not on the native queue yet.
+  ///
+  /// \param Handler is the handler of the command group.
+  /// \return a SYCL event representing the command group.
+  event finalizeInOrder(handler &Handler);
+
   /// queue_impl.addEvent tracks events with weak pointers
   /// but some events have no other owners. addSharedEvent()
   /// follows events with a shared pointer.
@@ -412,6 +583,14 @@ private:
   /// \param Event is the event to be stored
   void addEvent(const event &Event);
 
+  /// Drops the events of MEventsWeak which no longer exist. Must be called
+  /// with MMutex held.
+  void pruneWeakEvents();
+
+  /// Drops the events of MEventsShared which are complete. Must be called
+  /// with MMutex held.
+  void pruneSharedEvents();
+
   /// Protects all the fields that can be changed by class' methods.
   mutex_class MMutex;
 
@@ -425,6 +604,14 @@ private:
   /// additionally, USM operations are not added to the scheduler command graph,
   /// queue is the only owner on the runtime side.
   vector_class<event> MEventsShared;
+
+  /// The sizes of MEventsWeak and MEventsShared at which they are pruned.
+  /// Queues which are never waited on would otherwise track all the events
+  /// they have ever had; as the limits double the remaining sizes, the
+  /// pruning takes constant amortized time per event.
+  size_t MEventsWeakPruneSize = MinEventsToPrune;
+  size_t MEventsSharedPruneSize = MinEventsToPrune;
+  static constexpr size_t MinEventsToPrune = 128;
   exception_list MExceptions;
   const async_handler MAsyncHandler;
   const property_list MPropList;
@@ -435,12 +622,37 @@ private:
   size_t MNextQueueIdx = 0;
 
   const bool MHostQueue = false;
+  /// True if the native queue is in-order.
+  bool MIsInorder = false;
+  /// Serializes the submissions to an in-order queue.
+  mutex_class MLastEventMutex;
+  /// The event of the last command group submitted to an in-order queue.
+  EventImplPtr MLastEvent;
+  std::atomic<command_graph_impl *> MRecordingGraph{nullptr};
+  /// Protects MFusionList.
+  mutex_class MFusionMutex;
+  std::atomic<bool> MInFusionMode{false};
+  /// The command groups collected in fusion mode, with the events standing
+  /// for them.
+  vector_class<std::pair<EventImplPtr, std::unique_ptr<CG>>> MFusionList;
+  bool MDiscardEvents = false;
+  /// A complete event shared by the submissions whose events are discarded.
+  EventImplPtr MDiscardedEvent;
   // Assume OOO support by default.
   bool MSupportOOO = true;
 
   // Thread pool for host task and event callbacks execution.
   // The thread pool is instantiated upon the very first call to getThreadPool()
   std::unique_ptr<ThreadPool> MHostTaskThreadPool;
+
+  /// Free scratch buffers of reductions, keyed by the zero-initialization flag
+  /// and the size in bytes.
+  std::multimap<std::pair<bool, size_t>, std::unique_ptr<ReductionScratchT>>
+      MReductionScratch;
+  /// Free USM scratch allocations of reductions, keyed the same way.
+  std::multimap<std::pair<bool, size_t>, void *> MReductionUSMScratch;
+  /// Protects MReductionScratch and MReductionUSMScratch.
+  mutex_class MReductionScratchMutex;
 };
 
 } // namespace detail
@@ -7,6 +7,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <CL/sycl/ONEAPI/reduction.hpp>
+#include <CL/sycl/detail/usm_impl.hpp>
 #include <detail/queue_impl.hpp>
 
 __SYCL_INLINE_NAMESPACE(cl) {
@@ -94,6 +95,41 @@ reduGetMaxWGSize(shared_ptr_class<sycl::detail::queue_impl> Queue,
   return WGSize;
 }
 
+__SYCL_EXPORT shared_ptr_class<buffer<unsigned char, 1>>
+reduGetScratchBuffer(shared_ptr_class<sycl::detail::queue_impl> Queue,
+                     size_t Size, bool ZeroInit) {
+  using ScratchT = sycl::detail::queue_impl::ReductionScratchT;
+  std::unique_ptr<ScratchT> Buf = Queue->takeReductionScratch(Size, ZeroInit);
+  // The buffer goes back to the arena when the last command group using it
+  // releases it. The queue is not kept alive by the buffer.
+  std::weak_ptr<sycl::detail::queue_impl> WeakQueue = Queue;
+  return shared_ptr_class<ScratchT>(
+      Buf.release(), [WeakQueue, Size, ZeroInit](ScratchT *Ptr) {
+        std::unique_ptr<ScratchT> Buf(Ptr);
+        if (shared_ptr_class<sycl::detail::queue_impl> Queue = WeakQueue.lock())
+          Queue->returnReductionScratch(Size, ZeroInit, std::move(Buf));
+      });
+}
+
+__SYCL_EXPORT shared_ptr_class<void>
+reduGetUSMScratch(shared_ptr_class<sycl::detail::queue_impl> Queue,
+                  size_t Size, bool ZeroInit) {
+  void *Ptr = Queue->takeReductionUSMScratch(Size, ZeroInit);
+  if (!Ptr)
+    return nullptr;
+  // The allocation goes back to the arena when the last command group using
+  // it releases it, or is freed if the queue is gone.
+  std::weak_ptr<sycl::detail::queue_impl> WeakQueue = Queue;
+  context Context = Queue->get_context();
+  return shared_ptr_class<void>(
+      Ptr, [WeakQueue, Context, Size, ZeroInit](void *Ptr) {
+        if (shared_ptr_class<sycl::detail::queue_impl> Queue = WeakQueue.lock())
+          Queue->returnReductionUSMScratch(Size, ZeroInit, Ptr);
+        else
+          sycl::detail::usm::free(Ptr, Context);
+      });
+}
+
 } // namespace detail
 } // namespace ONEAPI
 } // namespace sycl
@@ -16,10 +16,14 @@
 #include <CL/sycl/detail/memory_manager.hpp>
 #include <CL/sycl/program.hpp>
 #include <CL/sycl/sampler.hpp>
+#include <detail/config.hpp>
 #include <detail/context_impl.hpp>
+#include <detail/device_timestamps.hpp>
 #include <detail/event_impl.hpp>
+#include <detail/global_handler.hpp>
 #include <detail/kernel_impl.hpp>
 #include <detail/kernel_info.hpp>
+#include <detail/kernel_stats.hpp>
 #include <detail/program_impl.hpp>
 #include <detail/program_manager/program_manager.hpp>
 #include <detail/queue_impl.hpp>
@@ -27,8 +31,13 @@
 #include <detail/scheduler/commands.hpp>
 #include <detail/scheduler/scheduler.hpp>
 #include <detail/stream_impl.hpp>
+#include <detail/submit_latency.hpp>
+#include <detail/work_group_size.hpp>
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -228,23 +237,20 @@ public:
 
     // Completing command's event along with unblocking enqueue readiness of
     // empty command may lead to quick deallocation of MThisCmd by some cleanup
-    // process. Thus we'll copy deps prior to completing of event and unblocking
-    // of empty command.
-    // Also, it's possible to have record deallocated prior to enqueue process.
-    // Thus we employ read-lock of graph.
+    // process. The read-lock of graph keeps the commands alive while the
+    // dependent commands are enqueued.
     {
       Scheduler &Sched = Scheduler::getInstance();
       std::shared_lock<std::shared_timed_mutex> Lock(Sched.MGraphLock);
 
-      std::vector<DepDesc> Deps = MThisCmd->MDeps;
-
       // update self-event status
       MThisCmd->MEvent->setComplete();
 
       EmptyCmd->MEnqueueStatus = EnqueueResultT::SyclEnqueueReady;
 
-      for (const DepDesc &Dep : Deps)
-        Scheduler::enqueueLeavesOfReqUnlocked(Dep.MDepRequirement);
+      // Continue straight into the commands waiting for the host task rather
+      // than into the leaves of all its memory objects.
+      Scheduler::enqueueUsersUnlocked(MThisCmd);
     }
   }
 };
@@ -304,9 +310,13 @@ void Command::waitForEvents(QueueImplPtr Queue,
   }
 }
 
+SlabPool &getCommandPool() {
+  return GlobalHandler::instance().getCommandPool();
+}
+
 Command::Command(CommandType Type, QueueImplPtr Queue)
     : MQueue(std::move(Queue)), MType(Type) {
-  MEvent.reset(new detail::event_impl(MQueue));
+  MEvent = detail::makeEventImpl(MQueue);
   MEvent->setCommand(this);
   MEvent->setContextImpl(detail::getSyclObjImpl(MQueue->get_context()));
   MEnqueueStatus = EnqueueResultT::SyclEnqueueReady;
@@ -341,7 +351,8 @@ void Command::emitEdgeEventForCommandDependence(Command *Cmd, void *ObjAddr,
 #ifdef XPTI_ENABLE_INSTRUMENTATION
   // Bail early if either the source or the target node for the given dependency
   // is undefined or NULL
-  if (!(xptiTraceEnabled() && MTraceEvent && Cmd && Cmd->MTraceEvent))
+  if (!(MTraceEvent && Cmd && Cmd->MTraceEvent &&
+        xptiCheckTraceEnabled(MStreamID, xpti::trace_edge_create)))
     return;
   // If all the information we need for creating an edge event is available,
   // then go ahead with creating it; if not, bail early!
@@ -439,7 +450,9 @@ void Command::emitEdgeEventForEventDependence(Command *Cmd,
 uint64_t Command::makeTraceEventProlog(void *MAddress) {
   uint64_t CommandInstanceNo = 0;
 #ifdef XPTI_ENABLE_INSTRUMENTATION
-  if (!xptiTraceEnabled())
+  // A command that is not sampled gets no trace event, so none of its
+  // notifications are sent
+  if (!xptiTraceEnabled() || !xptiSampleTrace(MStreamID))
     return CommandInstanceNo;
 
   MTraceEventPrologComplete = true;
@@ -534,7 +547,8 @@ void Command::addDep(EventImplPtr Event) {
 
 void Command::emitEnqueuedEventSignal(RT::PiEvent &PiEventAddr) {
 #ifdef XPTI_ENABLE_INSTRUMENTATION
-  if (!(xptiTraceEnabled() && MTraceEvent && PiEventAddr))
+  if (!(MTraceEvent && PiEventAddr &&
+        xptiCheckTraceEnabled(MStreamID, xpti::trace_signal)))
     return;
   // Asynchronous call, so send a signal with the event information as
   // user_data
@@ -546,7 +560,7 @@ void Command::emitEnqueuedEventSignal(RT::PiEvent &PiEventAddr) {
 
 void Command::emitInstrumentation(uint16_t Type, const char *Txt) {
 #ifdef XPTI_ENABLE_INSTRUMENTATION
-  if (!(xptiTraceEnabled() && MTraceEvent))
+  if (!(MTraceEvent && xptiCheckTraceEnabled(MStreamID, Type)))
     return;
   // Trace event notifier that emits a Type event
   xptiNotifySubscribers(MStreamID, Type, detail::GSYCLGraphEvent,
@@ -611,6 +625,9 @@ bool Command::enqueue(EnqueueResultT &EnqueueResult, BlockingT Blocking) {
   // This will avoid execution of the same failed command twice.
   MEnqueueStatus = EnqueueResultT::SyclEnqueueFailed;
   MShouldCompleteEventIfPossible = true;
+#ifdef XPTI_ENABLE_INSTRUMENTATION
+  uint64_t HostQueuedTime = MTraceEvent ? DeviceTimestampPoller::hostTime() : 0;
+#endif
   cl_int Res = enqueueImp();
 
   if (CL_SUCCESS != Res)
@@ -628,6 +645,14 @@ bool Command::enqueue(EnqueueResultT &EnqueueResult, BlockingT Blocking) {
 
   // Emit this correlation signal before the task end
   emitEnqueuedEventSignal(MEvent->getHandleRef());
+#ifdef XPTI_ENABLE_INSTRUMENTATION
+  if (MTraceEvent && MEnqueueStatus == EnqueueResultT::SyclEnqueueSuccess &&
+      !MQueue->is_host() && MEvent->getHandleRef() &&
+      xptiCheckTraceEnabled(MStreamID, xpti::trace_metadata))
+    GlobalHandler::instance().getDeviceTimestampPoller().add(
+        MQueue->getPlugin(), MEvent->getHandleRef(), MTraceEvent, MInstanceID,
+        MStreamID, HostQueuedTime);
+#endif
 #ifdef XPTI_ENABLE_INSTRUMENTATION
   emitInstrumentation(xpti::trace_task_end, nullptr);
 #endif
@@ -924,7 +949,7 @@ cl_int ReleaseCommand::enqueueImp() {
                                     ? MAllocaCmd->MLinkedAllocaCmd->getQueue()
                                     : MAllocaCmd->getQueue();
 
-    EventImplPtr UnmapEventImpl(new event_impl(Queue));
+    EventImplPtr UnmapEventImpl = makeEventImpl(Queue);
     UnmapEventImpl->setContextImpl(
         detail::getSyclObjImpl(Queue->get_context()));
     RT::PiEvent &UnmapEvent = UnmapEventImpl->getHandleRef();
@@ -1128,7 +1153,9 @@ void MemCpyCommand::emitInstrumentationData() {
 }
 
 ContextImplPtr MemCpyCommand::getContext() const {
-  const QueueImplPtr &Queue = MQueue->is_host() ? MSrcQueue : MQueue;
+  // Copies between devices of different contexts are enqueued to the source
+  // queue.
+  const QueueImplPtr &Queue = MSrcQueue->is_host() ? MQueue : MSrcQueue;
   return detail::getSyclObjImpl(Queue->get_context());
 }
 
@@ -1431,6 +1458,12 @@ static std::string cgTypeToString(detail::CG::CGTYPE Type) {
   case detail::CG::FILL_USM:
     return "fill usm";
     break;
+  case detail::CG::COPY_USM_RECT:
+    return "copy usm rect";
+    break;
+  case detail::CG::FILL_USM_RECT:
+    return "fill usm rect";
+    break;
   case detail::CG::PREFETCH_USM:
     return "prefetch usm";
     break;
@@ -1621,10 +1654,229 @@ static void ReverseRangeDimensionsForKernel(NDRDescT &NDR) {
   }
 }
 
-pi_result ExecCGCommand::SetKernelParamsAndLaunch(
-    CGExecKernel *ExecKernel, RT::PiKernel Kernel, NDRDescT &NDRDesc,
-    std::vector<RT::PiEvent> &RawEvents, RT::PiEvent &Event,
-    ProgramManager::KernelArgMask EliminatedArgMask) {
+/// Sets the kernel arguments with a single call if the plugin supports
+/// piextKernelSetArgs, or one by one otherwise.
+static void setKernelArgs(const detail::plugin &Plugin, RT::PiKernel Kernel,
+                          const vector_class<RT::PiKernelArg> &Args) {
+  if (Args.empty())
+    return;
+  if (Plugin.getPiPlugin().PiFunctionTable.piextKernelSetArgs) {
+    Plugin.call<PiApiKind::piextKernelSetArgs>(Kernel, Args.size(),
+                                               Args.data());
+    return;
+  }
+  for (const RT::PiKernelArg &Arg : Args) {
+    switch (Arg.kind) {
+    case PI_KERNEL_ARG_VALUE:
+      Plugin.call<PiApiKind::piKernelSetArg>(Kernel, Arg.index, Arg.size,
+                                             Arg.value);
+      break;
+    case PI_KERNEL_ARG_MEM_OBJ:
+      Plugin.call<PiApiKind::piextKernelSetArgMemObj>(
+          Kernel, Arg.index, static_cast<const RT::PiMem *>(Arg.value));
+      break;
+    case PI_KERNEL_ARG_SAMPLER:
+      Plugin.call<PiApiKind::piextKernelSetArgSampler>(
+          Kernel, Arg.index, static_cast<const RT::PiSampler *>(Arg.value));
+      break;
+    case PI_KERNEL_ARG_POINTER:
+      Plugin.call<PiApiKind::piextKernelSetArgPointer>(Kernel, Arg.index,
+                                                       Arg.size, Arg.value);
+      break;
+    }
+  }
+}
+
+/// Prefetches the shared USM allocations which the arguments of a kernel point
+/// into to the device of \p Queue. Pointers captured by a kernel lambda are
+/// passed as plain values, so every argument of the size of a pointer is
+/// looked up.
+///
+/// \return the events of the enqueued prefetches.
+static std::vector<RT::PiEvent>
+prefetchSharedUSMArgs(const QueueImplPtr &Queue,
+                      const vector_class<RT::PiKernelArg> &Args) {
+  std::vector<RT::PiEvent> Events;
+  const detail::plugin &Plugin = Queue->getPlugin();
+  if (!Plugin.getPiPlugin().PiFunctionTable.piextUSMGetMemAllocInfo)
+    return Events;
+
+  const RT::PiContext Context = Queue->getContextImplPtr()->getHandleRef();
+  auto GetAllocInfo = [&](void *Ptr, pi_mem_info ParamName, size_t Size,
+                          void *Value) {
+    return Plugin.call_nocheck<PiApiKind::piextUSMGetMemAllocInfo>(
+               Context, Ptr, ParamName, Size, Value, nullptr) == PI_SUCCESS;
+  };
+
+  std::vector<void *> Prefetched;
+  for (const RT::PiKernelArg &Arg : Args) {
+    if ((Arg.kind != PI_KERNEL_ARG_VALUE &&
+         Arg.kind != PI_KERNEL_ARG_POINTER) ||
+        Arg.size != sizeof(void *))
+      continue;
+    void *Ptr = nullptr;
+    std::memcpy(&Ptr, Arg.value, sizeof(Ptr));
+    if (!Ptr)
+      continue;
+
+    pi_usm_type Type = PI_MEM_TYPE_UNKNOWN;
+    void *Base = nullptr;
+    size_t Size = 0;
+    if (!GetAllocInfo(Ptr, PI_MEM_ALLOC_TYPE, sizeof(Type), &Type) ||
+        Type != PI_MEM_TYPE_SHARED ||
+        !GetAllocInfo(Ptr, PI_MEM_ALLOC_BASE_PTR, sizeof(Base), &Base) ||
+        !GetAllocInfo(Ptr, PI_MEM_ALLOC_SIZE, sizeof(Size), &Size))
+      continue;
+    if (std::find(Prefetched.begin(), Prefetched.end(), Base) !=
+        Prefetched.end())
+      continue;
+    Prefetched.push_back(Base);
+
+    // The prefetch is only a hint, the launch goes ahead if it fails.
+    RT::PiEvent Event = nullptr;
+    if (Plugin.call_nocheck<PiApiKind::piextUSMEnqueuePrefetch>(
+            Queue->getHandleRef(), Base, Size, PI_USM_MIGRATION_TBD0, 0,
+            nullptr, &Event) == PI_SUCCESS &&
+        Event)
+      Events.push_back(Event);
+  }
+  return Events;
+}
+
+namespace {
+/// The kernel of a command group and the layout of its arguments.
+struct ResolvedKernel {
+  RT::PiKernel Kernel = nullptr;
+  /// Protects the arguments of a kernel of the program cache.
+  std::mutex *KernelMutex = nullptr;
+  RT::PiProgram Program = nullptr;
+  const program_impl *Prg = nullptr;
+  ProgramManager::KernelArgMask EliminatedArgMask;
+  ProgramManager::KernelArgFields ArgFields;
+  ProgramManager::SpecConstBufferInfo SpecConstBuf;
+};
+
+/// The arguments of a kernel as passed to the plugin. The memory objects,
+/// samplers and spec constants are stored aside, PiArgs refer to them.
+struct KernelArgsStorage {
+  void clear() {
+    PiArgs.clear();
+    MemArgs.clear();
+    SamplerArgs.clear();
+    SpecConstData.clear();
+  }
+
+  vector_class<RT::PiKernelArg> PiArgs;
+  vector_class<RT::PiMem> MemArgs;
+  vector_class<RT::PiSampler> SamplerArgs;
+  std::vector<unsigned char> SpecConstData;
+};
+} // namespace
+
+static ResolvedKernel resolveKernel(const QueueImplPtr &Queue,
+                                    CGExecKernel &ExecKernel) {
+  ResolvedKernel Resolved;
+  sycl::context Context = Queue->get_context();
+  bool KnownProgram = true;
+
+  if (nullptr != ExecKernel.MSyclKernel) {
+    assert(ExecKernel.MSyclKernel->get_info<info::kernel::context>() ==
+           Context);
+    Resolved.Kernel = ExecKernel.MSyclKernel->getHandleRef();
+
+    auto SyclProg = detail::getSyclObjImpl(
+        ExecKernel.MSyclKernel->get_info<info::kernel::program>());
+    Resolved.Program = SyclProg->getHandleRef();
+    Resolved.Prg = SyclProg.get();
+    if (SyclProg->is_cacheable()) {
+      RT::PiKernel FoundKernel = nullptr;
+      std::tie(FoundKernel, Resolved.KernelMutex) =
+          detail::ProgramManager::getInstance().getOrCreateKernel(
+              ExecKernel.MOSModuleHandle,
+              ExecKernel.MSyclKernel->get_info<info::kernel::context>(),
+              Queue->get_device(), ExecKernel.MKernelName, SyclProg.get());
+      assert(FoundKernel == Resolved.Kernel);
+      (void)FoundKernel;
+    } else
+      KnownProgram = false;
+  } else {
+    std::tie(Resolved.Kernel, Resolved.KernelMutex) =
+        detail::ProgramManager::getInstance().getOrCreateKernel(
+            ExecKernel.MOSModuleHandle, Context, Queue->get_device(),
+            ExecKernel.MKernelName, nullptr, ExecKernel.MKernelID);
+    Queue->getPlugin().call<PiApiKind::piKernelGetInfo>(
+        Resolved.Kernel, PI_KERNEL_INFO_PROGRAM, sizeof(RT::PiProgram),
+        &Resolved.Program, nullptr);
+  }
+
+  if (nullptr == ExecKernel.MSyclKernel ||
+      !ExecKernel.MSyclKernel->isCreatedFromSource()) {
+    Resolved.EliminatedArgMask =
+        detail::ProgramManager::getInstance().getEliminatedKernelArgMask(
+            ExecKernel.MOSModuleHandle, Context, Queue->get_device(),
+            Resolved.Program, ExecKernel.MKernelName, KnownProgram,
+            &Resolved.ArgFields, &Resolved.SpecConstBuf);
+  }
+  return Resolved;
+}
+
+/// The local size the runtime selected for a launch without one.
+struct LocalSizeSelection {
+  /// The local sizes of the kernel, null if the runtime has not selected one.
+  KernelWorkGroupSizesPtr Sizes;
+  /// Whether the local size of the launch has been set by the runtime rather
+  /// than left to the driver.
+  bool IsSet = false;
+  KernelWorkGroupSizes::Trial Trial;
+};
+
+/// Selects the local size of a launch of a kernel of the program cache that
+/// has none, see SYCL_WORK_GROUP_SIZE_POLICY. \p NDRDesc is in the order of
+/// the plugin interface.
+///
+/// \param AllowTrial if true, the launch may be timed to tune the local size.
+/// \return true if the local size of \p NDRDesc has been set.
+static bool selectLaunchLocalSize(const QueueImplPtr &Queue,
+                                  const ResolvedKernel &Resolved,
+                                  NDRDescT &NDRDesc,
+                                  LocalSizeSelection &Selection,
+                                  bool AllowTrial) {
+  if (Resolved.KernelMutex == nullptr)
+    return false;
+  const WorkGroupSizePolicy Policy =
+      SYCLConfig<SYCL_WORK_GROUP_SIZE_POLICY>::get();
+  if (Policy == WorkGroupSizePolicy::driver)
+    return false;
+
+  KernelWorkGroupSizesPtr Sizes =
+      Queue->getContextImplPtr()->getKernelProgramCache()
+          .getKernelWorkGroupSizes(
+              Resolved.Kernel, *detail::getSyclObjImpl(Queue->get_device()));
+  const WorkSizeT GlobalSize{NDRDesc.GlobalSize[0], NDRDesc.GlobalSize[1],
+                             NDRDesc.GlobalSize[2]};
+  WorkSizeT LocalSize;
+  Selection.IsSet =
+      Sizes->getLocalSize(Policy, NDRDesc.Dims, GlobalSize, LocalSize,
+                          AllowTrial ? &Selection.Trial : nullptr);
+  if (Selection.IsSet)
+    for (int I = 0; I < 3; ++I)
+      NDRDesc.LocalSize[I] = LocalSize[I];
+  Selection.Sizes = std::move(Sizes);
+  return Selection.IsSet;
+}
+
+/// Sets the arguments of the command group on \p Kernel and prepares NDRDesc
+/// for the launch. The runtime selects the local size of the launches
+/// without one in \p Selection.
+///
+/// \param AllowTrial if true, the launch may be timed to tune the local size.
+/// \return true if the launch has a local size.
+static bool SetKernelParams(
+    const QueueImplPtr &Queue, CGExecKernel *ExecKernel, RT::PiKernel Kernel,
+    NDRDescT &NDRDesc, const ResolvedKernel &Resolved,
+    const std::function<void *(Requirement *Req)> &getMemAllocationFunc,
+    KernelArgsStorage &Storage, LocalSizeSelection &Selection,
+    bool AllowTrial) {
   vector_class<ArgDesc> &Args = ExecKernel->MArgs;
   // TODO this is not necessary as long as we can guarantee that the arguments
   // are already sorted (e. g. handle the sorting in handler if necessary due
@@ -1634,67 +1886,331 @@ pi_result ExecCGCommand::SetKernelParamsAndLaunch(
   });
   int LastIndex = -1;
   int NextTrueIndex = 0;
-  const detail::plugin &Plugin = MQueue->getPlugin();
+  const detail::plugin &Plugin = Queue->getPlugin();
+  const ProgramManager::KernelArgMask &EliminatedArgMask =
+      Resolved.EliminatedArgMask;
+  const ProgramManager::KernelArgFields &ArgFields = Resolved.ArgFields;
+  vector_class<RT::PiKernelArg> &PiArgs = Storage.PiArgs;
+  vector_class<RT::PiMem> &MemArgs = Storage.MemArgs;
+  vector_class<RT::PiSampler> &SamplerArgs = Storage.SamplerArgs;
+  Storage.clear();
+  // PiArgs refer to the memory objects and samplers, which must not be
+  // reallocated. Most kernels have neither, so their storage is only reserved
+  // when needed.
+  size_t NumMemArgs = 0;
+  size_t NumSamplerArgs = 0;
+  for (const ArgDesc &Arg : Args) {
+    NumMemArgs += Arg.MType == kernel_param_kind_t::kind_accessor;
+    NumSamplerArgs += Arg.MType == kernel_param_kind_t::kind_sampler;
+  }
+  PiArgs.reserve(Args.size());
+  if (NumMemArgs)
+    MemArgs.reserve(NumMemArgs);
+  if (NumSamplerArgs)
+    SamplerArgs.reserve(NumSamplerArgs);
+  // An aggregate argument of which only parts are used is passed as one
+  // kernel argument per kept byte range.
+  auto getNumKernelArgs = [&ArgFields](int Idx) -> int {
+    auto It = ArgFields.find(Idx);
+    return It == ArgFields.end() ? 1 : static_cast<int>(It->second.size());
+  };
   for (ArgDesc &Arg : ExecKernel->MArgs) {
     // Handle potential gaps in set arguments (e. g. if some of them are set
     // on the user side).
     for (int Idx = LastIndex + 1; Idx < Arg.MIndex; ++Idx)
       if (EliminatedArgMask.empty() || !EliminatedArgMask[Idx])
-        ++NextTrueIndex;
+        NextTrueIndex += getNumKernelArgs(Idx);
     LastIndex = Arg.MIndex;
 
     if (!EliminatedArgMask.empty() && EliminatedArgMask[Arg.MIndex])
       continue;
+    const pi_uint32 Index = static_cast<pi_uint32>(NextTrueIndex);
     switch (Arg.MType) {
     case kernel_param_kind_t::kind_accessor: {
       Requirement *Req = (Requirement *)(Arg.MPtr);
-      AllocaCommandBase *AllocaCmd = getAllocaForReq(Req);
-      RT::PiMem MemArg = (RT::PiMem)AllocaCmd->getMemAllocation();
+      MemArgs.push_back((RT::PiMem)getMemAllocationFunc(Req));
       if (Plugin.getBackend() == backend::opencl) {
-        Plugin.call<PiApiKind::piKernelSetArg>(Kernel, NextTrueIndex,
-                                               sizeof(RT::PiMem), &MemArg);
+        PiArgs.push_back({PI_KERNEL_ARG_VALUE, Index, sizeof(RT::PiMem),
+                          &MemArgs.back()});
       } else {
-        Plugin.call<PiApiKind::piextKernelSetArgMemObj>(Kernel, NextTrueIndex,
-                                                        &MemArg);
+        PiArgs.push_back({PI_KERNEL_ARG_MEM_OBJ, Index, sizeof(RT::PiMem),
+                          &MemArgs.back()});
       }
       break;
     }
     case kernel_param_kind_t::kind_std_layout: {
-      Plugin.call<PiApiKind::piKernelSetArg>(Kernel, NextTrueIndex, Arg.MSize,
-                                             Arg.MPtr);
+      auto FieldsIt = ArgFields.find(Arg.MIndex);
+      if (FieldsIt == ArgFields.end()) {
+        PiArgs.push_back({PI_KERNEL_ARG_VALUE, Index, Arg.MSize, Arg.MPtr});
+        break;
+      }
+      pi_uint32 RangeIndex = Index;
+      for (const auto &Range : FieldsIt->second) {
+        assert(Range.first + Range.second <= static_cast<size_t>(Arg.MSize) &&
+               "Kernel argument range is out of bounds");
+        PiArgs.push_back({PI_KERNEL_ARG_VALUE, RangeIndex++, Range.second,
+                          static_cast<char *>(Arg.MPtr) + Range.first});
+      }
+      NextTrueIndex += static_cast<int>(FieldsIt->second.size()) - 1;
       break;
     }
     case kernel_param_kind_t::kind_sampler: {
       sampler *SamplerPtr = (sampler *)Arg.MPtr;
-      RT::PiSampler Sampler = detail::getSyclObjImpl(*SamplerPtr)
-                                  ->getOrCreateSampler(MQueue->get_context());
-      Plugin.call<PiApiKind::piextKernelSetArgSampler>(Kernel, NextTrueIndex,
-                                                       &Sampler);
+      SamplerArgs.push_back(detail::getSyclObjImpl(*SamplerPtr)
+                                ->getOrCreateSampler(Queue->get_context()));
+      PiArgs.push_back({PI_KERNEL_ARG_SAMPLER, Index, sizeof(RT::PiSampler),
+                        &SamplerArgs.back()});
       break;
     }
     case kernel_param_kind_t::kind_pointer: {
-      Plugin.call<PiApiKind::piextKernelSetArgPointer>(Kernel, NextTrueIndex,
-                                                       Arg.MSize, Arg.MPtr);
+      PiArgs.push_back({PI_KERNEL_ARG_POINTER, Index, Arg.MSize, Arg.MPtr});
       break;
     }
     }
     ++NextTrueIndex;
   }
+  // Kernels built ahead of time with emulated spec constants take their values
+  // in an implicit trailing argument.
+  const ProgramManager::SpecConstBufferInfo &SpecConstBuf =
+      Resolved.SpecConstBuf;
+  if (SpecConstBuf.Size != 0) {
+    ProgramManager::fillSpecConstBuffer(SpecConstBuf, Resolved.Prg,
+                                        Storage.SpecConstData);
+    PiArgs.push_back({PI_KERNEL_ARG_VALUE, SpecConstBuf.ArgIndex,
+                      Storage.SpecConstData.size(),
+                      Storage.SpecConstData.data()});
+  }
+  setKernelArgs(Plugin, Kernel, PiArgs);
 
   adjustNDRangePerKernel(NDRDesc, Kernel,
-                         *(detail::getSyclObjImpl(MQueue->get_device())));
+                         *(detail::getSyclObjImpl(Queue->get_device())));
 
   // Remember this information before the range dimensions are reversed
   const bool HasLocalSize = (NDRDesc.LocalSize[0] != 0);
 
   ReverseRangeDimensionsForKernel(NDRDesc);
-  pi_result Error = Plugin.call_nocheck<PiApiKind::piEnqueueKernelLaunch>(
-      MQueue->getHandleRef(), Kernel, NDRDesc.Dims, &NDRDesc.GlobalOffset[0],
-      &NDRDesc.GlobalSize[0], HasLocalSize ? &NDRDesc.LocalSize[0] : nullptr,
-      RawEvents.size(), RawEvents.empty() ? nullptr : &RawEvents[0], &Event);
+  if (HasLocalSize)
+    return true;
+  return selectLaunchLocalSize(Queue, Resolved, NDRDesc, Selection,
+                               AllowTrial);
+}
+
+/// \return the nanoseconds elapsed since Start.
+static uint64_t
+getElapsedNs(const std::chrono::steady_clock::time_point &Start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - Start)
+      .count();
+}
+
+static pi_result SetKernelParamsAndLaunch(
+    const QueueImplPtr &Queue, CGExecKernel *ExecKernel, RT::PiKernel Kernel,
+    NDRDescT &NDRDesc, std::vector<RT::PiEvent> &RawEvents,
+    RT::PiEvent *OutEvent, const ResolvedKernel &Resolved,
+    const std::function<void *(Requirement *Req)> &getMemAllocationFunc,
+    KernelStatsEntry *Stats) {
+  const detail::plugin &Plugin = Queue->getPlugin();
+  // The storage is reused by the launches of the thread, which then do not
+  // allocate memory for the arguments.
+  static thread_local KernelArgsStorage Storage;
+  LocalSizeSelection Selection;
+  std::chrono::steady_clock::time_point SetArgsStart;
+  if (Stats)
+    SetArgsStart = std::chrono::steady_clock::now();
+  const bool HasLocalSize = SetKernelParams(
+      Queue, ExecKernel, Kernel, NDRDesc, Resolved, getMemAllocationFunc,
+      Storage, Selection, /*AllowTrial=*/OutEvent != nullptr);
+  if (Stats)
+    Stats->ArgSetupNs.fetch_add(getElapsedNs(SetArgsStart),
+                                std::memory_order_relaxed);
+  const vector_class<RT::PiKernelArg> &PiArgs = Storage.PiArgs;
+
+  // The migration of the memory the kernel uses starts right away, while the
+  // kernel may still wait for its dependencies.
+  std::vector<RT::PiEvent> PrefetchEvents;
+  if (Queue->has_property<ext::oneapi::property::queue::prefetch_shared_usm>())
+    PrefetchEvents = prefetchSharedUSMArgs(Queue, PiArgs);
+  std::vector<RT::PiEvent> WaitEvents;
+  if (!PrefetchEvents.empty()) {
+    WaitEvents.reserve(RawEvents.size() + PrefetchEvents.size());
+    WaitEvents.insert(WaitEvents.end(), RawEvents.begin(), RawEvents.end());
+    WaitEvents.insert(WaitEvents.end(), PrefetchEvents.begin(),
+                      PrefetchEvents.end());
+  }
+  const std::vector<RT::PiEvent> &LaunchEvents =
+      PrefetchEvents.empty() ? RawEvents : WaitEvents;
+
+  // A timed launch starts once its dependencies are done and is waited for,
+  // so that only the kernel is timed.
+  const bool IsTimed = Selection.Trial.IsTimed;
+  if (IsTimed && !LaunchEvents.empty())
+    Plugin.call<PiApiKind::piEventsWait>(LaunchEvents.size(),
+                                         &LaunchEvents[0]);
+  const auto Start = std::chrono::steady_clock::now();
+
+  pi_result Error;
+  {
+    SubmitLatencyScope LatencyScope(SubmitStage::kernel_launch);
+    Error = Plugin.call_nocheck<PiApiKind::piEnqueueKernelLaunch>(
+        Queue->getHandleRef(), Kernel, NDRDesc.Dims, &NDRDesc.GlobalOffset[0],
+        &NDRDesc.GlobalSize[0], HasLocalSize ? &NDRDesc.LocalSize[0] : nullptr,
+        LaunchEvents.size(), LaunchEvents.empty() ? nullptr : &LaunchEvents[0],
+        OutEvent);
+    // The local size selected by the runtime must not make a launch fail
+    // which the driver could have made with its own.
+    if (Error == PI_INVALID_WORK_GROUP_SIZE && Selection.IsSet)
+      Error = Plugin.call_nocheck<PiApiKind::piEnqueueKernelLaunch>(
+          Queue->getHandleRef(), Kernel, NDRDesc.Dims,
+          &NDRDesc.GlobalOffset[0], &NDRDesc.GlobalSize[0], nullptr,
+          LaunchEvents.size(),
+          LaunchEvents.empty() ? nullptr : &LaunchEvents[0], OutEvent);
+  }
+  if (IsTimed && Error == PI_SUCCESS) {
+    Plugin.call<PiApiKind::piEventsWait>(1, OutEvent);
+    const auto Time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - Start);
+    Selection.Sizes->recordTrial(Selection.Trial, Time.count());
+  }
+  for (RT::PiEvent PrefetchEvent : PrefetchEvents)
+    Plugin.call<PiApiKind::piEventRelease>(PrefetchEvent);
   return Error;
 }
 
+cl_int enqueueImpKernel(
+    const QueueImplPtr &Queue, CGExecKernel &ExecKernel,
+    std::vector<RT::PiEvent> &RawEvents, RT::PiEvent *OutEvent,
+    const std::function<void *(Requirement *Req)> &getMemAllocationFunc) {
+  NDRDescT &NDRDesc = ExecKernel.MNDRDesc;
+
+  // The statistics of the kernel on the device, if they are collected
+  KernelStatsEntry *Stats = nullptr;
+  std::chrono::steady_clock::time_point ResolveStart;
+  if (KernelStatsRecorder::isEnabled()) {
+    Stats = &GlobalHandler::instance().getKernelStatsRecorder().getEntry(
+        ExecKernel.MKernelName, Queue->getDeviceImplPtr().get(), [&Queue] {
+          return Queue->get_device().get_info<info::device::name>();
+        });
+    ResolveStart = std::chrono::steady_clock::now();
+  }
+
+  // Run OpenCL kernel
+  const ResolvedKernel Resolved = resolveKernel(Queue, ExecKernel);
+  RT::PiKernel Kernel = Resolved.Kernel;
+  if (Stats)
+    Stats->BuildNs.fetch_add(getElapsedNs(ResolveStart),
+                             std::memory_order_relaxed);
+
+  pi_result Error = PI_SUCCESS;
+  if (Resolved.KernelMutex != nullptr) {
+    // For cacheable kernels, we use per-kernel mutex
+    std::unique_lock<std::mutex> Lock(*Resolved.KernelMutex, std::try_to_lock);
+    if (!Lock.owns_lock() && nullptr == ExecKernel.MSyclKernel) {
+      // Another thread is setting the arguments of the kernel. Launch a clone
+      // with its own arguments instead of waiting for it.
+      const ContextImplPtr &ContextImpl = Queue->getContextImplPtr();
+      RT::PiKernel Clone = ProgramManager::getInstance().getKernelClone(
+          ContextImpl, Resolved.Program, Kernel, ExecKernel.MKernelName);
+      try {
+        Error = SetKernelParamsAndLaunch(Queue, &ExecKernel, Clone, NDRDesc,
+                                         RawEvents, OutEvent, Resolved,
+                                         getMemAllocationFunc, Stats);
+      } catch (...) {
+        ContextImpl->getKernelProgramCache().returnKernelClone(Kernel, Clone);
+        throw;
+      }
+      ContextImpl->getKernelProgramCache().returnKernelClone(Kernel, Clone);
+    } else {
+      if (!Lock.owns_lock())
+        Lock.lock();
+      Error = SetKernelParamsAndLaunch(Queue, &ExecKernel, Kernel, NDRDesc,
+                                       RawEvents, OutEvent, Resolved,
+                                       getMemAllocationFunc, Stats);
+    }
+  } else {
+    Error = SetKernelParamsAndLaunch(Queue, &ExecKernel, Kernel, NDRDesc,
+                                     RawEvents, OutEvent, Resolved,
+                                     getMemAllocationFunc, Stats);
+  }
+
+  if (PI_SUCCESS != Error) {
+    // If we have got non-success error code, let's analyze it to emit nice
+    // exception explaining what was wrong
+    const device_impl &DeviceImpl =
+        *(detail::getSyclObjImpl(Queue->get_device()));
+    return detail::enqueue_kernel_launch::handleError(Error, DeviceImpl,
+                                                      Kernel, NDRDesc);
+  }
+
+  // The device time of the sampled launches is read once they complete, by
+  // the thread polling the device execution times
+  if (Stats &&
+      GlobalHandler::instance().getKernelStatsRecorder().countLaunch(*Stats) &&
+      OutEvent && *OutEvent)
+    GlobalHandler::instance().getDeviceTimestampPoller().add(
+        Queue->getPlugin(), *OutEvent, *Stats);
+
+  return PI_SUCCESS;
+}
+
+void prepareRecordedKernel(const QueueImplPtr &Queue, CGExecKernel &ExecKernel,
+                           RecordedKernel &Recorded) {
+  const ContextImplPtr &ContextImpl = Queue->getContextImplPtr();
+  const ResolvedKernel Resolved = resolveKernel(Queue, ExecKernel);
+  if (Recorded.MKernel && Recorded.MCacheKernel != Resolved.Kernel)
+    releaseRecordedKernel(ContextImpl, Recorded);
+  if (!Recorded.MKernel) {
+    Recorded.MKernel = ProgramManager::getInstance().getKernelClone(
+        ContextImpl, Resolved.Program, Resolved.Kernel,
+        ExecKernel.MKernelName);
+    Recorded.MCacheKernel = Resolved.Kernel;
+  }
+
+  auto getMemAllocationFunc = [](Requirement *) -> void * {
+    throw runtime_error("Accessor is used in a recorded command group.",
+                        PI_INVALID_OPERATION);
+  };
+  Recorded.MNDRDesc = ExecKernel.MNDRDesc;
+  KernelArgsStorage Storage;
+  LocalSizeSelection Selection;
+  Recorded.MHasLocalSize = SetKernelParams(
+      Queue, &ExecKernel, Recorded.MKernel, Recorded.MNDRDesc, Resolved,
+      getMemAllocationFunc, Storage, Selection, /*AllowTrial=*/false);
+}
+
+void releaseRecordedKernel(const ContextImplPtr &Context,
+                           RecordedKernel &Recorded) {
+  if (!Recorded.MKernel)
+    return;
+  Context->getKernelProgramCache().returnKernelClone(Recorded.MCacheKernel,
+                                                     Recorded.MKernel);
+  Recorded.MKernel = nullptr;
+  Recorded.MCacheKernel = nullptr;
+}
+
+cl_int launchRecordedKernel(const QueueImplPtr &Queue,
+                            const RecordedKernel &Recorded,
+                            const std::vector<RT::PiEvent> &RawEvents,
+                            RT::PiEvent *OutEvent) {
+  NDRDescT NDRDesc = Recorded.MNDRDesc;
+  pi_result Error;
+  {
+    SubmitLatencyScope LatencyScope(SubmitStage::kernel_launch);
+    Error = Queue->getPlugin().call_nocheck<PiApiKind::piEnqueueKernelLaunch>(
+        Queue->getHandleRef(), Recorded.MKernel, NDRDesc.Dims,
+        &NDRDesc.GlobalOffset[0], &NDRDesc.GlobalSize[0],
+        Recorded.MHasLocalSize ? &NDRDesc.LocalSize[0] : nullptr,
+        RawEvents.size(), RawEvents.empty() ? nullptr : &RawEvents[0],
+        OutEvent);
+  }
+  if (PI_SUCCESS != Error) {
+    const device_impl &DeviceImpl =
+        *(detail::getSyclObjImpl(Queue->get_device()));
+    return detail::enqueue_kernel_launch::handleError(
+        Error, DeviceImpl, Recorded.MKernel, NDRDesc);
+  }
+  return PI_SUCCESS;
+}
+
 // The function initialize accessors and calls lambda.
 // The function is used as argument to piEnqueueNativeKernel which requires
 // that the passed function takes one void* argument.
@@ -1885,70 +2401,13 @@ cl_int ExecCGCommand::enqueueImp() {
       return CL_SUCCESS;
     }
 
-    // Run OpenCL kernel
-    sycl::context Context = MQueue->get_context();
-    RT::PiKernel Kernel = nullptr;
-    std::mutex *KernelMutex = nullptr;
-    RT::PiProgram Program = nullptr;
-    bool KnownProgram = true;
-
-    if (nullptr != ExecKernel->MSyclKernel) {
-      assert(ExecKernel->MSyclKernel->get_info<info::kernel::context>() ==
-             Context);
-      Kernel = ExecKernel->MSyclKernel->getHandleRef();
-
-      auto SyclProg = detail::getSyclObjImpl(
-          ExecKernel->MSyclKernel->get_info<info::kernel::program>());
-      Program = SyclProg->getHandleRef();
-      if (SyclProg->is_cacheable()) {
-        RT::PiKernel FoundKernel = nullptr;
-        std::tie(FoundKernel, KernelMutex) =
-            detail::ProgramManager::getInstance().getOrCreateKernel(
-                ExecKernel->MOSModuleHandle,
-                ExecKernel->MSyclKernel->get_info<info::kernel::context>(),
-                MQueue->get_device(), ExecKernel->MKernelName, SyclProg.get());
-        assert(FoundKernel == Kernel);
-      } else
-        KnownProgram = false;
-    } else {
-      std::tie(Kernel, KernelMutex) =
-          detail::ProgramManager::getInstance().getOrCreateKernel(
-              ExecKernel->MOSModuleHandle, Context, MQueue->get_device(),
-              ExecKernel->MKernelName, nullptr);
-      MQueue->getPlugin().call<PiApiKind::piKernelGetInfo>(
-          Kernel, PI_KERNEL_INFO_PROGRAM, sizeof(RT::PiProgram), &Program,
-          nullptr);
-    }
-
-    pi_result Error = PI_SUCCESS;
-    ProgramManager::KernelArgMask EliminatedArgMask;
-    if (nullptr == ExecKernel->MSyclKernel ||
-        !ExecKernel->MSyclKernel->isCreatedFromSource()) {
-      EliminatedArgMask =
-          detail::ProgramManager::getInstance().getEliminatedKernelArgMask(
-              ExecKernel->MOSModuleHandle, Context, MQueue->get_device(),
-              Program, ExecKernel->MKernelName, KnownProgram);
-    }
-    if (KernelMutex != nullptr) {
-      // For cacheable kernels, we use per-kernel mutex
-      std::lock_guard<std::mutex> Lock(*KernelMutex);
-      Error = SetKernelParamsAndLaunch(ExecKernel, Kernel, NDRDesc, RawEvents,
-                                       Event, EliminatedArgMask);
-    } else {
-      Error = SetKernelParamsAndLaunch(ExecKernel, Kernel, NDRDesc, RawEvents,
-                                       Event, EliminatedArgMask);
-    }
-
-    if (PI_SUCCESS != Error) {
-      // If we have got non-success error code, let's analyze it to emit nice
-      // exception explaining what was wrong
-      const device_impl &DeviceImpl =
-          *(detail::getSyclObjImpl(MQueue->get_device()));
-      return detail::enqueue_kernel_launch::handleError(Error, DeviceImpl,
-                                                        Kernel, NDRDesc);
-    }
+    auto getMemAllocationFunc = [this](Requirement *Req) {
+      AllocaCommandBase *AllocaCmd = getAllocaForReq(Req);
+      return AllocaCmd->getMemAllocation();
+    };
 
-    return PI_SUCCESS;
+    return enqueueImpKernel(MQueue, *ExecKernel, RawEvents, &Event,
+                            getMemAllocationFunc);
   }
   case CG::CGTYPE::COPY_USM: {
     CGCopyUSM *Copy = (CGCopyUSM *)MCommandGroup.get();
@@ -1964,6 +2423,21 @@ cl_int ExecCGCommand::enqueueImp() {
 
     return CL_SUCCESS;
   }
+  case CG::CGTYPE::COPY_USM_RECT: {
+    CGCopyUSMRect *Copy = (CGCopyUSMRect *)MCommandGroup.get();
+    MemoryManager::copy_usm_rect(Copy->getSrc(), MQueue, Copy->getRect(),
+                                 Copy->getDst(), std::move(RawEvents), Event);
+
+    return CL_SUCCESS;
+  }
+  case CG::CGTYPE::FILL_USM_RECT: {
+    CGFillUSMRect *Fill = (CGFillUSMRect *)MCommandGroup.get();
+    MemoryManager::fill_usm_rect(Fill->getDst(), MQueue, Fill->getRect(),
+                                 Fill->getPattern(), std::move(RawEvents),
+                                 Event);
+
+    return CL_SUCCESS;
+  }
   case CG::CGTYPE::PREFETCH_USM: {
     CGPrefetchUSM *Prefetch = (CGPrefetchUSM *)MCommandGroup.get();
     MemoryManager::prefetch_usm(Prefetch->getDst(), MQueue,
@@ -11,6 +11,8 @@
 #include <atomic>
 #include <cstdint>
 #include <deque>
+#include <functional>
+#include <limits>
 #include <memory>
 #include <set>
 #include <unordered_set>
@@ -20,6 +22,7 @@
 #include <CL/sycl/detail/accessor_impl.hpp>
 #include <CL/sycl/detail/cg.hpp>
 #include <detail/program_manager/program_manager.hpp>
+#include <detail/slab_pool.hpp>
 
 __SYCL_INLINE_NAMESPACE(cl) {
 namespace sycl {
@@ -83,6 +86,17 @@ struct DepDesc {
   AllocaCommandBase *MAllocaCmd = nullptr;
 };
 
+/// \return the pool which holds the scheduler commands and their edge lists.
+///
+/// Commands are created and retired at the rate of submissions, so their
+/// memory is recycled instead of being returned to the system allocator.
+SlabPool &getCommandPool();
+
+template <typename T>
+using CommandAllocator = SlabPoolAllocator<T, getCommandPool>;
+
+using DepDescList = std::vector<DepDesc, CommandAllocator<DepDesc>>;
+
 /// The Command class represents some action that needs to be performed on one
 /// or more memory objects. The Command has a vector of DepDesc objects that
 /// represent dependencies of the command. It has a vector of pointers to
@@ -107,6 +121,13 @@ public:
 
   Command(CommandType Type, QueueImplPtr Queue);
 
+  static void *operator new(size_t Size) {
+    return getCommandPool().allocate(Size);
+  }
+  static void operator delete(void *Ptr, size_t Size) noexcept {
+    getCommandPool().deallocate(Ptr, Size);
+  }
+
   void addDep(DepDesc NewDep);
 
   void addDep(EventImplPtr Event);
@@ -222,9 +243,11 @@ public:
   }
 
   /// Contains list of dependencies(edges)
-  std::vector<DepDesc> MDeps;
+  DepDescList MDeps;
   /// Contains list of commands that depend on the command.
-  std::unordered_set<Command *> MUsers;
+  std::unordered_set<Command *, std::hash<Command *>,
+                     std::equal_to<Command *>, CommandAllocator<Command *>>
+      MUsers;
   /// Indicates whether the command can be blocked from enqueueing.
   bool MIsBlockable = false;
   /// Counts the number of memory objects this command is a leaf for.
@@ -352,6 +375,12 @@ public:
   /// alloca command.
   bool MIsLeaderAlloca = true;
 
+  /// Bounds in bytes of the memory which was modified in the other contexts
+  /// since the allocation was last up to date. Only the parent allocations
+  /// track them, a new allocation is out of date as a whole.
+  size_t MStaleBegin = 0;
+  size_t MStaleEnd = std::numeric_limits<size_t>::max();
+
 protected:
   Requirement MRequirement;
   ReleaseCommand MReleaseCmd;
@@ -477,6 +506,49 @@ private:
   void **MDstPtr = nullptr;
 };
 
+/// Enqueues the device kernel described by \p ExecKernel to \p Queue.
+///
+/// \param OutEvent receives the event of the launch. It is nullptr when the
+/// queue discards the event, see queue_impl::discardsEvents.
+/// \param getMemAllocationFunc returns the memory allocation which backs an
+/// accessor argument of the kernel.
+/// \return CL_SUCCESS or an error code produced by the launch.
+cl_int enqueueImpKernel(
+    const QueueImplPtr &Queue, CGExecKernel &ExecKernel,
+    std::vector<RT::PiEvent> &RawEvents, RT::PiEvent *OutEvent,
+    const std::function<void *(Requirement *Req)> &getMemAllocationFunc);
+
+/// A kernel of a command group whose arguments are set once, for the command
+/// groups which are launched repeatedly without the scheduler, see
+/// ONEAPI::command_graph.
+struct RecordedKernel {
+  /// The kernel of the kernel program cache MKernel is a clone of.
+  RT::PiKernel MCacheKernel = nullptr;
+  /// A clone of the kernel, whose arguments are only set by the recording.
+  RT::PiKernel MKernel = nullptr;
+  /// The ranges of the launch, adjusted to the kernel.
+  NDRDescT MNDRDesc;
+  bool MHasLocalSize = false;
+};
+
+/// Sets the arguments of \p ExecKernel, which must not have accessor
+/// arguments, on a clone of its kernel. The clone already held by
+/// \p Recorded is reused if it is a clone of the same kernel.
+void prepareRecordedKernel(const QueueImplPtr &Queue, CGExecKernel &ExecKernel,
+                           RecordedKernel &Recorded);
+
+/// Returns the clone held by \p Recorded to the kernel program cache.
+void releaseRecordedKernel(const ContextImplPtr &Context,
+                           RecordedKernel &Recorded);
+
+/// Launches a kernel prepared by prepareRecordedKernel on \p Queue.
+///
+/// \return CL_SUCCESS or an error code produced by the launch.
+cl_int launchRecordedKernel(const QueueImplPtr &Queue,
+                            const RecordedKernel &Recorded,
+                            const std::vector<RT::PiEvent> &RawEvents,
+                            RT::PiEvent *OutEvent);
+
 /// The exec CG command enqueues execution of kernel or explicit memory
 /// operation.
 class ExecCGCommand : public Command {
@@ -510,11 +582,6 @@ private:
 
   AllocaCommandBase *getAllocaForReq(Requirement *Req);
 
-  pi_result SetKernelParamsAndLaunch(
-      CGExecKernel *ExecKernel, RT::PiKernel Kernel, NDRDescT &NDRDesc,
-      std::vector<RT::PiEvent> &RawEvents, RT::PiEvent &Event,
-      ProgramManager::KernelArgMask EliminatedArgMask);
-
   std::unique_ptr<detail::CG> MCommandGroup;
 
   friend class Command;
@@ -15,8 +15,10 @@
 #include <detail/queue_impl.hpp>
 #include <detail/scheduler/scheduler.hpp>
 
+#include <algorithm>
 #include <cstdlib>
 #include <fstream>
+#include <limits>
 #include <map>
 #include <memory>
 #include <queue>
@@ -46,7 +48,52 @@ static bool sameCtx(const ContextImplPtr &LHS, const ContextImplPtr &RHS) {
   return LHS == RHS || (LHS->is_host() && RHS->is_host());
 }
 
+/// Checks if the memory of a buffer can be moved from a device of \p SrcCtx to
+/// a device of \p DstCtx without going through the host.
+static bool canCopyPeer(const ContextImplPtr &SrcCtx,
+                        const ContextImplPtr &DstCtx, const Requirement *Req) {
+  if (SYCLConfig<SYCL_DISABLE_PEER_MIGRATION>::get() ||
+      Req->MSYCLMemObj->getType() != SYCLMemObjI::MemObjType::BUFFER)
+    return false;
+  const plugin &Plugin = SrcCtx->getPlugin();
+  return Plugin.getBackend() == DstCtx->getPlugin().getBackend() &&
+         Plugin.getPiPlugin().PiFunctionTable.piextEnqueueMemBufferCopyPeer;
+}
+
 /// Checks if current requirement is requirement for sub buffer.
+/// The key of a context in the allocation lookup tables of MemObjRecord. The
+/// host contexts are the same to sameCtx, so they share the null key.
+static const context_impl *getAllocaContextKey(const ContextImplPtr &Ctx) {
+  return Ctx->is_host() ? nullptr : Ctx.get();
+}
+
+void MemObjRecord::addAllocaCommand(AllocaCommandBase *AllocaCmd) {
+  MAllocaCommands.push_back(AllocaCmd);
+  const context_impl *Key =
+      getAllocaContextKey(AllocaCmd->getQueue()->getContextImplPtr());
+  // emplace keeps the first allocation, which the linear search found
+  if (AllocaCmd->getType() == Command::CommandType::ALLOCA_SUB_BUF)
+    MSubBufAllocaByContext[Key].emplace(
+        AllocaCmd->getRequirement()->MOffsetInBytes, AllocaCmd);
+  else
+    MAllocaByContext.emplace(Key, AllocaCmd);
+}
+
+AllocaCommandBase *MemObjRecord::findAlloca(const ContextImplPtr &Ctx) const {
+  const auto It = MAllocaByContext.find(getAllocaContextKey(Ctx));
+  return It != MAllocaByContext.end() ? It->second : nullptr;
+}
+
+AllocaCommandBase *
+MemObjRecord::findSubBufAlloca(const ContextImplPtr &Ctx,
+                               size_t OffsetInBytes) const {
+  const auto CtxIt = MSubBufAllocaByContext.find(getAllocaContextKey(Ctx));
+  if (CtxIt == MSubBufAllocaByContext.end())
+    return nullptr;
+  const auto It = CtxIt->second.find(OffsetInBytes);
+  return It != CtxIt->second.end() ? It->second : nullptr;
+}
+
 static bool IsSuitableSubReq(const Requirement *Req) {
   return Req->MIsSubBuffer;
 }
@@ -191,6 +238,21 @@ Scheduler::GraphBuilder::getOrInsertMemObjRecord(const QueueImplPtr &Queue,
         Dependency->addUser(Dependant);
         --(Dependency->MLeafCounter);
       };
+  LeavesCollection::AddToGroupF AddToReadGroup =
+      [this](Command *Group, Command *Leaf, MemObjRecord *Record) {
+        // The group runs on the queue of its first reader and has a copy of
+        // the requirement of each of its readers
+        EmptyCommand *GroupCmd = static_cast<EmptyCommand *>(Group);
+        if (!GroupCmd) {
+          GroupCmd = new EmptyCommand(Leaf->getQueue());
+          ++(GroupCmd->MLeafCounter);
+        }
+        DepDesc Dep = findDepForRecord(Leaf, Record);
+        GroupCmd->addRequirement(Leaf, Dep.MAllocaCmd, Dep.MDepRequirement);
+        Leaf->addUser(GroupCmd);
+        --(Leaf->MLeafCounter);
+        return static_cast<Command *>(GroupCmd);
+      };
 
   const ContextImplPtr &InteropCtxPtr = Req->MSYCLMemObj->getInteropContext();
   if (InteropCtxPtr) {
@@ -210,11 +272,13 @@ Scheduler::GraphBuilder::getOrInsertMemObjRecord(const QueueImplPtr &Queue,
         Dev, InteropCtxPtr, /*AsyncHandler=*/{}, /*PropertyList=*/{}}};
 
     MemObject->MRecord.reset(
-        new MemObjRecord{InteropCtxPtr, LeafLimit, AllocateDependency});
+        new MemObjRecord{InteropCtxPtr, LeafLimit, AllocateDependency,
+                         AddToReadGroup});
     getOrCreateAllocaForReq(MemObject->MRecord.get(), Req, InteropQueuePtr);
   } else
     MemObject->MRecord.reset(new MemObjRecord{Queue->getContextImplPtr(),
-                                              LeafLimit, AllocateDependency});
+                                              LeafLimit, AllocateDependency,
+                                              AddToReadGroup});
 
   MMemObjs.push_back(MemObject);
   return MemObject->MRecord.get();
@@ -295,6 +359,32 @@ static Command *insertMapUnmapForLinkedCmds(AllocaCommandBase *AllocaCmdSrc,
   return MapCmd;
 }
 
+// Checks if the copy to the destination allocation can be limited to its
+// stale bytes. The byte offsets are valid only for the parent allocations of
+// buffers.
+static bool isPartiallyStale(const AllocaCommandBase *AllocaCmdSrc,
+                             const AllocaCommandBase *AllocaCmdDst) {
+  const Requirement *Req = AllocaCmdDst->getRequirement();
+  return Req->MSYCLMemObj->getType() == SYCLMemObjI::MemObjType::BUFFER &&
+         AllocaCmdSrc->getType() == Command::CommandType::ALLOCA &&
+         AllocaCmdDst->getType() == Command::CommandType::ALLOCA &&
+         !AllocaCmdDst->MLinkedAllocaCmd &&
+         AllocaCmdDst->MStaleBegin < AllocaCmdDst->MStaleEnd &&
+         (AllocaCmdDst->MStaleBegin != 0 ||
+          AllocaCmdDst->MStaleEnd < Req->MSYCLMemObj->getSize());
+}
+
+// Checks if the allocation has the latest content of the memory object, so
+// that it can become the current one without a memory move. Linked
+// allocations are still remapped to switch the active one.
+static bool isUpToDate(AllocaCommandBase *AllocaCmd) {
+  if (AllocaCmd->getType() == Command::CommandType::ALLOCA_SUB_BUF)
+    AllocaCmd =
+        static_cast<AllocaSubBufCommand *>(AllocaCmd)->getParentAlloca();
+  return !AllocaCmd->MLinkedAllocaCmd &&
+         AllocaCmd->MStaleBegin >= AllocaCmd->MStaleEnd;
+}
+
 Command *Scheduler::GraphBuilder::insertMemoryMove(MemObjRecord *Record,
                                                    Requirement *Req,
                                                    const QueueImplPtr &Queue) {
@@ -319,17 +409,7 @@ Command *Scheduler::GraphBuilder::insertMemoryMove(MemObjRecord *Record,
     // Since no alloca command for the sub buffer requirement was found in the
     // current context, need to find a parent alloca command for it (it must be
     // there)
-    auto IsSuitableAlloca = [Record](AllocaCommandBase *AllocaCmd) {
-      bool Res = sameCtx(AllocaCmd->getQueue()->getContextImplPtr(),
-                         Record->MCurContext) &&
-                 // Looking for a parent buffer alloca command
-                 AllocaCmd->getType() == Command::CommandType::ALLOCA;
-      return Res;
-    };
-    const auto It =
-        std::find_if(Record->MAllocaCommands.begin(),
-                     Record->MAllocaCommands.end(), IsSuitableAlloca);
-    AllocaCmdSrc = (Record->MAllocaCommands.end() != It) ? *It : nullptr;
+    AllocaCmdSrc = Record->findAlloca(Record->MCurContext);
   }
   if (!AllocaCmdSrc)
     throw runtime_error("Cannot find buffer allocation", PI_INVALID_VALUE);
@@ -356,6 +436,19 @@ Command *Scheduler::GraphBuilder::insertMemoryMove(MemObjRecord *Record,
     if ((Req->MAccessMode == access::mode::discard_write) ||
         (Req->MAccessMode == access::mode::discard_read_write)) {
       return nullptr;
+    } else if (isPartiallyStale(AllocaCmdSrc, AllocaCmdDst)) {
+      // Only the bytes modified since the destination was up to date are
+      // copied, the rest of it has the latest content already.
+      const size_t Size = Req->MSYCLMemObj->getSize();
+      const size_t Begin = AllocaCmdDst->MStaleBegin;
+      const size_t End = AllocaCmdDst->MStaleEnd;
+      Requirement StaleReq(/*Offset*/ {Begin, 0, 0}, {End - Begin, 1, 1},
+                           /*MemoryRange*/ {Size, 1, 1},
+                           access::mode::read_write, Req->MSYCLMemObj,
+                           /*Dims*/ 1, /*Working with bytes*/ sizeof(char));
+      NewCmd = new MemCpyCommand(StaleReq, AllocaCmdSrc, StaleReq,
+                                 AllocaCmdDst, AllocaCmdSrc->getQueue(),
+                                 AllocaCmdDst->getQueue());
     } else {
       // Full copy of buffer is needed to avoid loss of data that may be caused
       // by copying specific range from host to device and backwards.
@@ -365,6 +458,8 @@ Command *Scheduler::GraphBuilder::insertMemoryMove(MemObjRecord *Record,
                             AllocaCmdSrc->getQueue(), AllocaCmdDst->getQueue());
     }
   }
+  AllocaCmdDst->MStaleBegin = std::numeric_limits<size_t>::max();
+  AllocaCmdDst->MStaleEnd = 0;
 
   for (Command *Dep : Deps) {
     NewCmd->addDep(DepDesc{Dep, NewCmd->getRequirement(), AllocaCmdDst});
@@ -415,7 +510,8 @@ Command *Scheduler::GraphBuilder::remapMemoryObject(
 
 // The function adds copy operation of the up to date'st memory to the memory
 // pointed by Req.
-Command *Scheduler::GraphBuilder::addCopyBack(Requirement *Req) {
+Command *Scheduler::GraphBuilder::addCopyBack(Requirement *Req,
+                                              bool DirtyOnly) {
 
   QueueImplPtr HostQueue = Scheduler::getInstance().getDefaultHostQueue();
   SYCLMemObjI *MemObj = Req->MSYCLMemObj;
@@ -431,10 +527,29 @@ Command *Scheduler::GraphBuilder::addCopyBack(Requirement *Req) {
       findDepsForReq(Record, Req, HostQueue->getContextImplPtr());
   AllocaCommandBase *SrcAllocaCmd =
       findAllocaForReq(Record, Req, Record->MCurContext);
+  Requirement SrcReq = *SrcAllocaCmd->getRequirement();
+
+  // The allocation and the memory pointed by Req have the same content except
+  // for the dirty bytes, copy only them if they are a part of the buffer.
+  const size_t Size = MemObj->getSize();
+  if (DirtyOnly && MemObj->getType() == SYCLMemObjI::MemObjType::BUFFER &&
+      SrcAllocaCmd->getType() == Command::CommandType::ALLOCA &&
+      Req->MDims == 1 && Req->MElemSize == 1 &&
+      Record->MDirtyBegin < Record->MDirtyEnd &&
+      (Record->MDirtyBegin != 0 || Record->MDirtyEnd < Size)) {
+    range<3> MemoryRange{Size, 1, 1};
+    id<3> Offset{Record->MDirtyBegin, 0, 0};
+    range<3> AccessRange{Record->MDirtyEnd - Record->MDirtyBegin, 1, 1};
+    SrcReq = Requirement(Offset, AccessRange, MemoryRange,
+                         access::mode::read_write, MemObj, /*Dims*/ 1,
+                         /*Working with bytes*/ sizeof(char));
+    Req->MOffset = Offset;
+    Req->MAccessRange = AccessRange;
+  }
 
-  std::unique_ptr<MemCpyCommandHost> MemCpyCmdUniquePtr(new MemCpyCommandHost(
-      *SrcAllocaCmd->getRequirement(), SrcAllocaCmd, *Req, &Req->MData,
-      SrcAllocaCmd->getQueue(), std::move(HostQueue)));
+  std::unique_ptr<MemCpyCommandHost> MemCpyCmdUniquePtr(
+      new MemCpyCommandHost(SrcReq, SrcAllocaCmd, *Req, &Req->MData,
+                            SrcAllocaCmd->getQueue(), std::move(HostQueue)));
 
   if (!MemCpyCmdUniquePtr)
     throw runtime_error("Out of host memory", PI_OUT_OF_HOST_MEMORY);
@@ -461,7 +576,7 @@ Command *Scheduler::GraphBuilder::addHostAccessor(Requirement *Req) {
   MemObjRecord *Record = getOrInsertMemObjRecord(HostQueue, Req);
   if (MPrintOptionsArray[BeforeAddHostAcc])
     printGraphAsDot("before_addHostAccessor");
-  markModifiedIfWrite(Record, Req);
+  markModifiedIfWrite(Record, Req, HostQueue->getContextImplPtr());
 
   AllocaCommandBase *HostAllocaCmd =
       getOrCreateAllocaForReq(Record, Req, HostQueue);
@@ -470,7 +585,9 @@ Command *Scheduler::GraphBuilder::addHostAccessor(Requirement *Req) {
               Record->MCurContext)) {
     if (!isAccessModeAllowed(Req->MAccessMode, Record->MHostAccess))
       remapMemoryObject(Record, Req, HostAllocaCmd);
-  } else
+  } else if (isUpToDate(HostAllocaCmd))
+    Record->MCurContext = HostQueue->getContextImplPtr();
+  else
     insertMemoryMove(Record, Req, HostQueue);
 
   Command *UpdateHostAccCmd = insertUpdateHostReqCmd(Record, Req, HostQueue);
@@ -575,32 +692,19 @@ DepDesc Scheduler::GraphBuilder::findDepForRecord(Command *Cmd,
 }
 
 // The function searches for the alloca command matching context and
-// requirement.
+// requirement: the sub-buffer allocation at the offset of a sub-buffer
+// requirement, the allocation of the whole memory object otherwise.
 AllocaCommandBase *
 Scheduler::GraphBuilder::findAllocaForReq(MemObjRecord *Record,
                                           const Requirement *Req,
                                           const ContextImplPtr &Context) {
-  auto IsSuitableAlloca = [&Context, Req](AllocaCommandBase *AllocaCmd) {
-    bool Res = sameCtx(AllocaCmd->getQueue()->getContextImplPtr(), Context);
-    if (IsSuitableSubReq(Req)) {
-      const Requirement *TmpReq = AllocaCmd->getRequirement();
-      Res &= AllocaCmd->getType() == Command::CommandType::ALLOCA_SUB_BUF;
-      Res &= TmpReq->MOffsetInBytes == Req->MOffsetInBytes;
-      Res &= TmpReq->MSYCLMemObj->getSize() == Req->MSYCLMemObj->getSize();
-    }
-    return Res;
-  };
-  const auto It = std::find_if(Record->MAllocaCommands.begin(),
-                               Record->MAllocaCommands.end(), IsSuitableAlloca);
-  return (Record->MAllocaCommands.end() != It) ? *It : nullptr;
+  if (IsSuitableSubReq(Req))
+    return Record->findSubBufAlloca(Context, Req->MOffsetInBytes);
+  return Record->findAlloca(Context);
 }
 
 static bool checkHostUnifiedMemory(const ContextImplPtr &Ctx) {
-  for (const device &Device : Ctx->getDevices()) {
-    if (!Device.get_info<info::device::host_unified_memory>())
-      return false;
-  }
-  return true;
+  return Ctx->hasHostUnifiedMemory();
 }
 
 // The function searches for the alloca command matching context and
@@ -677,6 +781,13 @@ AllocaCommandBase *Scheduler::GraphBuilder::getOrCreateAllocaForReq(
       AllocaCmd =
           new AllocaCommand(Queue, FullReq, InitFromUserData, LinkedAllocaCmd);
 
+      // The first allocation and the ones sharing the memory of the current
+      // allocation are up to date.
+      if (Record->MAllocaCommands.empty() || LinkedAllocaCmd) {
+        AllocaCmd->MStaleBegin = std::numeric_limits<size_t>::max();
+        AllocaCmd->MStaleEnd = 0;
+      }
+
       // Update linked command
       if (LinkedAllocaCmd) {
         AllocaCmd->addDep(DepDesc{LinkedAllocaCmd, AllocaCmd->getRequirement(),
@@ -711,26 +822,68 @@ AllocaCommandBase *Scheduler::GraphBuilder::getOrCreateAllocaForReq(
       }
     }
 
-    Record->MAllocaCommands.push_back(AllocaCmd);
+    Record->addAllocaCommand(AllocaCmd);
     Record->MWriteLeaves.push_back(AllocaCmd);
     ++(AllocaCmd->MLeafCounter);
   }
   return AllocaCmd;
 }
 
+// Computes the bytes of the memory object accessed by the requirement. The
+// access range of a multidimensional requirement is approximated with the
+// bytes from its first to its last element.
+static void getAccessedBytes(const Requirement *Req, size_t &Begin,
+                             size_t &End) {
+  const size_t Size = Req->MSYCLMemObj->getSize();
+  const range<3> &MemoryRange = Req->MMemoryRange;
+  const range<3> &AccessRange = Req->MAccessRange;
+  const id<3> &Offset = Req->MOffset;
+
+  Begin = 0;
+  End = Size;
+  if (Req->MSYCLMemObj->getType() == SYCLMemObjI::MemObjType::BUFFER &&
+      MemoryRange.size() != 0 && AccessRange.size() != 0) {
+    auto Linearize = [&MemoryRange](size_t I0, size_t I1, size_t I2) {
+      return (I0 * MemoryRange[1] + I1) * MemoryRange[2] + I2;
+    };
+    size_t First = Linearize(Offset[0], Offset[1], Offset[2]);
+    size_t Last = Linearize(Offset[0] + AccessRange[0] - 1,
+                            Offset[1] + AccessRange[1] - 1,
+                            Offset[2] + AccessRange[2] - 1);
+    Begin = std::min(Size, Req->MOffsetInBytes + First * Req->MElemSize);
+    End = std::min(Size, Req->MOffsetInBytes + (Last + 1) * Req->MElemSize);
+  }
+}
+
 // The function sets MemModified flag in record if requirement has write access.
-void Scheduler::GraphBuilder::markModifiedIfWrite(MemObjRecord *Record,
-                                                  Requirement *Req) {
+// The bytes written become dirty for the copy back and stale in the parent
+// allocations of the other contexts.
+void Scheduler::GraphBuilder::markModifiedIfWrite(
+    MemObjRecord *Record, Requirement *Req, const ContextImplPtr &Context) {
   switch (Req->MAccessMode) {
   case access::mode::write:
   case access::mode::read_write:
   case access::mode::discard_write:
   case access::mode::discard_read_write:
   case access::mode::atomic:
-    Record->MMemModified = true;
-  case access::mode::read:
     break;
+  case access::mode::read:
+    return;
   }
+  Record->MMemModified = true;
+
+  size_t Begin = 0;
+  size_t End = 0;
+  getAccessedBytes(Req, Begin, End);
+  Record->MDirtyBegin = std::min(Record->MDirtyBegin, Begin);
+  Record->MDirtyEnd = std::max(Record->MDirtyEnd, End);
+
+  for (AllocaCommandBase *AllocaCmd : Record->MAllocaCommands)
+    if (AllocaCmd->getType() == Command::CommandType::ALLOCA &&
+        !sameCtx(AllocaCmd->getQueue()->getContextImplPtr(), Context)) {
+      AllocaCmd->MStaleBegin = std::min(AllocaCmd->MStaleBegin, Begin);
+      AllocaCmd->MStaleEnd = std::max(AllocaCmd->MStaleEnd, End);
+    }
 }
 
 template <typename T>
@@ -758,7 +911,7 @@ Scheduler::GraphBuilder::addEmptyCmd(Command *Cmd, const std::vector<T *> &Reqs,
 
   Cmd->addUser(EmptyCmd);
 
-  const std::vector<DepDesc> &Deps = Cmd->MDeps;
+  const DepDescList &Deps = Cmd->MDeps;
   for (const DepDesc &Dep : Deps) {
     const Requirement *Req = Dep.MDepRequirement;
     MemObjRecord *Record = getMemObjRecord(Req->MSYCLMemObj);
@@ -832,7 +985,7 @@ Scheduler::GraphBuilder::addCG(std::unique_ptr<detail::CG> CommandGroup,
               : Queue;
 
       Record = getOrInsertMemObjRecord(QueueForAlloca, Req);
-      markModifiedIfWrite(Record, Req);
+      markModifiedIfWrite(Record, Req, QueueForAlloca->getContextImplPtr());
 
       AllocaCmd = getOrCreateAllocaForReq(Record, Req, QueueForAlloca);
 
@@ -848,9 +1001,12 @@ Scheduler::GraphBuilder::addCG(std::unique_ptr<detail::CG> CommandGroup,
       if (Record->MCurContext->is_host() &&
           !isAccessModeAllowed(Req->MAccessMode, Record->MHostAccess))
         remapMemoryObject(Record, Req, AllocaCmd);
+    } else if (isUpToDate(AllocaCmd)) {
+      // Nothing was modified since the memory was last in this context.
+      Record->MCurContext = AllocaCmd->getQueue()->getContextImplPtr();
     } else {
-      // Cannot directly copy memory from OpenCL device to OpenCL device -
-      // create two copies: device->host and host->device.
+      // Unless the plugin can copy memory between devices of different
+      // contexts, create two copies: device->host and host->device.
       bool NeedMemMoveToHost = false;
       auto MemMoveTargetQueue = Queue;
 
@@ -863,7 +1019,8 @@ Scheduler::GraphBuilder::addCG(std::unique_ptr<detail::CG> CommandGroup,
           MemMoveTargetQueue = HT.MQueue;
         }
       } else if (!Queue->is_host() && !Record->MCurContext->is_host())
-        NeedMemMoveToHost = true;
+        NeedMemMoveToHost =
+            !canCopyPeer(Record->MCurContext, Queue->getContextImplPtr(), Req);
 
       if (NeedMemMoveToHost)
         insertMemoryMove(Record, Req,
@@ -881,7 +1038,7 @@ Scheduler::GraphBuilder::addCG(std::unique_ptr<detail::CG> CommandGroup,
   // Node dependencies can be modified further when adding the node to leaves,
   // iterate over their copy.
   // FIXME employ a reference here to eliminate copying of a vector
-  std::vector<DepDesc> Deps = NewCmd->MDeps;
+  DepDescList Deps = NewCmd->MDeps;
   for (DepDesc &Dep : Deps) {
     Dep.MDepCommand->addUser(NewCmd.get());
     const Requirement *Req = Dep.MDepRequirement;
@@ -905,6 +1062,33 @@ Scheduler::GraphBuilder::addCG(std::unique_ptr<detail::CG> CommandGroup,
   return NewCmd.release();
 }
 
+bool Scheduler::GraphBuilder::isGraphIndependent(
+    const detail::CG &CommandGroup, const QueueImplPtr &Queue) const {
+  if (!CommandGroup.MRequirements.empty())
+    return false;
+
+  // Update host and host task command groups get auxiliary commands linked to
+  // the graph.
+  const CG::CGTYPE CGType = CommandGroup.getType();
+  if (CGType == CG::UPDATE_HOST || CGType == CG::CODEPLAY_HOST_TASK)
+    return false;
+
+  // Printing traverses the whole graph.
+  if (MPrintOptionsArray[BeforeAddCG] || MPrintOptionsArray[AfterAddCG])
+    return false;
+
+  // Events from other contexts are connected through a host task, see
+  // Command::processDepEvent.
+  const ContextImplPtr &Context = Queue->getContextImplPtr();
+  if (Context->is_host())
+    return true;
+  return std::all_of(CommandGroup.MEvents.begin(), CommandGroup.MEvents.end(),
+                     [&Context](const EventImplPtr &Event) {
+                       return Event->is_host() ||
+                              Event->getContextImpl() == Context;
+                     });
+}
+
 void Scheduler::GraphBuilder::decrementLeafCountersForRecord(
     MemObjRecord *Record) {
   for (Command *Cmd : Record->MReadLeaves) {
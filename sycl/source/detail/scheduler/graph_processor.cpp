@@ -52,6 +52,25 @@ void Scheduler::GraphProcessor::waitForEvent(EventImplPtr Event) {
   Cmd->getEvent()->waitInternal();
 }
 
+void Scheduler::GraphProcessor::waitForEvents(
+    const std::vector<EventImplPtr> &Events) {
+  for (const EventImplPtr &Event : Events) {
+    // Command can be nullptr if user creates cl::sycl::event explicitly or the
+    // event has been waited on by another thread
+    Command *Cmd = getCommand(Event);
+    if (!Cmd)
+      continue;
+
+    EnqueueResultT Res;
+    bool Enqueued = enqueueCommand(Cmd, Res, BLOCKING);
+    if (!Enqueued && EnqueueResultT::SyclEnqueueFailed == Res.MResult)
+      // TODO: Reschedule commands.
+      throw runtime_error("Enqueue process failed.", PI_INVALID_OPERATION);
+  }
+
+  event_impl::waitAllInternal(Events);
+}
+
 bool Scheduler::GraphProcessor::enqueueCommand(Command *Cmd,
                                                EnqueueResultT &EnqueueResult,
                                                BlockingT Blocking) {
@@ -6,6 +6,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <detail/queue_impl.hpp>
 #include <detail/scheduler/leaves_collection.hpp>
 #include <detail/scheduler/scheduler.hpp>
 
@@ -36,6 +37,9 @@ static inline bool isHostAccessorCmd(Command *Cmd) {
 }
 
 size_t LeavesCollection::remove(value_type Cmd) {
+  if (Cmd == MGroupCmd)
+    MGroupCmd = nullptr;
+
   if (!isHostAccessorCmd(Cmd)) {
     auto NewEnd =
         std::remove(MGenericCommands.begin(), MGenericCommands.end(), Cmd);
@@ -117,7 +121,8 @@ bool LeavesCollection::addGenericCommand(Command *Cmd) {
     if (OldLeaf == Cmd)
       return false;
 
-    MAllocateDependency(Cmd, OldLeaf, MRecord);
+    if (!MAddToGroup || !evictToGroup())
+      MAllocateDependency(Cmd, MGenericCommands.front(), MRecord);
   }
 
   MGenericCommands.push_back(Cmd);
@@ -125,6 +130,50 @@ bool LeavesCollection::addGenericCommand(Command *Cmd) {
   return true;
 }
 
+// Only the commands of the same device context are grouped, the dependencies
+// between contexts would need the host to connect them.
+static bool canJoinGroup(Command *GroupCmd, Command *Cmd) {
+  const QueueImplPtr &Queue = Cmd->getQueue();
+  return !Queue->is_host() && Cmd->getType() != Command::ALLOCA &&
+         Cmd->getType() != Command::ALLOCA_SUB_BUF &&
+         (!GroupCmd ||
+          GroupCmd->getQueue()->getContextImplPtr() ==
+              Queue->getContextImplPtr());
+}
+
+bool LeavesCollection::evictToGroup() {
+  if (MGenericCommands.capacity() < 2)
+    return false;
+
+  // The group is moved to the back instead of joining itself
+  if (MGenericCommands.front() == MGroupCmd) {
+    MGenericCommands.pop_front();
+    MGenericCommands.push_back(MGroupCmd);
+  }
+  Command *OldLeaf = MGenericCommands.front();
+
+  if (MGroupCmd && !MGroupCmd->isSuccessfullyEnqueued() &&
+      canJoinGroup(MGroupCmd, OldLeaf)) {
+    MAddToGroup(MGroupCmd, OldLeaf, MRecord);
+    MGenericCommands.pop_front();
+    return true;
+  }
+  if (!canJoinGroup(nullptr, OldLeaf))
+    return false;
+
+  // The new group takes the place of the leaf, the next oldest leaf joins it
+  // to make room for the new one.
+  MGroupCmd = MAddToGroup(nullptr, OldLeaf, MRecord);
+  MGenericCommands.pop_front();
+  MGenericCommands.push_back(MGroupCmd);
+  OldLeaf = MGenericCommands.front();
+  if (!canJoinGroup(MGroupCmd, OldLeaf))
+    return false;
+  MAddToGroup(MGroupCmd, OldLeaf, MRecord);
+  MGenericCommands.pop_front();
+  return true;
+}
+
 void LeavesCollection::insertHostAccessorCommand(EmptyCommand *Cmd) {
   MHostAccessorCommandsXRef[Cmd] =
       MHostAccessorCommands.insert(MHostAccessorCommands.end(), Cmd);
@@ -35,6 +35,12 @@ struct MemObjRecord;
 /// guaranteed to work with std::remove as host accessors' commands are stored
 /// in a map. Hence, the LeavesCollection class provides a viable solution
 /// with its own remove method.
+///
+/// The read leaves of a memory object are evicted into a read group instead
+/// of becoming dependencies of the new leaf: the group is an empty command
+/// depending on the evicted readers, so that the readers keep running in
+/// parallel and the later writers depend on the group. A group accepts
+/// readers until it is enqueued.
 class LeavesCollection {
 public:
   using GenericCommandsT = CircularBuffer<Command *>;
@@ -44,6 +50,11 @@ public:
   using AllocateDependencyF =
       std::function<void(Command *, Command *, MemObjRecord *)>;
 
+  // Make the group command depend on the leaf, a new group is created if the
+  // group is null. Returns the group.
+  using AddToGroupF =
+      std::function<Command *(Command *, Command *, MemObjRecord *)>;
+
   template <bool IsConst> class IteratorT;
 
   using value_type = Command *;
@@ -56,9 +67,11 @@ public:
   using const_iterator = IteratorT<true>;
 
   LeavesCollection(MemObjRecord *Record, std::size_t GenericCommandsCapacity,
-                   AllocateDependencyF AllocateDependency)
+                   AllocateDependencyF AllocateDependency,
+                   AddToGroupF AddToGroup = nullptr)
       : MRecord{Record}, MGenericCommands{GenericCommandsCapacity},
-        MAllocateDependency{std::move(AllocateDependency)} {}
+        MAllocateDependency{std::move(AllocateDependency)},
+        MAddToGroup{std::move(AddToGroup)} {}
 
   iterator begin() {
     if (MGenericCommands.empty())
@@ -125,7 +138,14 @@ private:
 
   AllocateDependencyF MAllocateDependency;
 
+  AddToGroupF MAddToGroup;
+  // The read group which accepts the evicted leaves, if any.
+  Command *MGroupCmd = nullptr;
+
   bool addGenericCommand(value_type Cmd);
+  // Evicts the oldest generic command into a read group. Returns false if
+  // it can't be grouped.
+  bool evictToGroup();
   bool addHostAccessorCommand(EmptyCommand *Cmd);
 
   // inserts a command to the end of list for its mem object
@@ -7,19 +7,26 @@
 //===----------------------------------------------------------------------===//
 
 #include "CL/sycl/detail/sycl_mem_obj_i.hpp"
+#include <CL/sycl/detail/memory_manager.hpp>
 #include <CL/sycl/device_selector.hpp>
+#include <detail/event_impl.hpp>
 #include <detail/global_handler.hpp>
 #include <detail/queue_impl.hpp>
 #include <detail/scheduler/scheduler.hpp>
 #include <detail/scheduler/scheduler_helpers.hpp>
 #include <detail/stream_impl.hpp>
+#include <detail/submit_latency.hpp>
+#include <detail/thread_pool.hpp>
 
+#include <algorithm>
 #include <chrono>
 #include <cstdio>
 #include <memory>
 #include <mutex>
 #include <set>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 __SYCL_INLINE_NAMESPACE(cl) {
@@ -31,6 +38,7 @@ void Scheduler::waitForRecordToFinish(MemObjRecord *Record) {
   // Will contain the list of dependencies for the Release Command
   std::set<Command *> DepCommands;
 #endif
+  std::vector<EventImplPtr> LeafEvents;
   for (Command *Cmd : Record->MReadLeaves) {
     EnqueueResultT Res;
     bool Enqueued = GraphProcessor::enqueueCommand(Cmd, Res);
@@ -40,7 +48,7 @@ void Scheduler::waitForRecordToFinish(MemObjRecord *Record) {
     // Capture the dependencies
     DepCommands.insert(Cmd);
 #endif
-    GraphProcessor::waitForEvent(Cmd->getEvent());
+    LeafEvents.push_back(Cmd->getEvent());
   }
   for (Command *Cmd : Record->MWriteLeaves) {
     EnqueueResultT Res;
@@ -50,8 +58,11 @@ void Scheduler::waitForRecordToFinish(MemObjRecord *Record) {
 #ifdef XPTI_ENABLE_INSTRUMENTATION
     DepCommands.insert(Cmd);
 #endif
-    GraphProcessor::waitForEvent(Cmd->getEvent());
+    LeafEvents.push_back(Cmd->getEvent());
   }
+  GraphProcessor::waitForEvents(LeafEvents);
+
+  std::vector<EventImplPtr> ReleaseEvents;
   for (AllocaCommandBase *AllocaCmd : Record->MAllocaCommands) {
     Command *ReleaseCmd = AllocaCmd->getReleaseCmd();
     EnqueueResultT Res;
@@ -63,12 +74,142 @@ void Scheduler::waitForRecordToFinish(MemObjRecord *Record) {
     // reported as edges
     ReleaseCmd->resolveReleaseDependencies(DepCommands);
 #endif
-    GraphProcessor::waitForEvent(ReleaseCmd->getEvent());
+    ReleaseEvents.push_back(ReleaseCmd->getEvent());
+  }
+  GraphProcessor::waitForEvents(ReleaseEvents);
+}
+
+bool Scheduler::canBypassGraph(const detail::CG &CommandGroup,
+                               const QueueImplPtr &Queue) {
+  if (Queue->is_host() || !CommandGroup.MRequirements.empty())
+    return false;
+
+#ifdef XPTI_ENABLE_INSTRUMENTATION
+  // Graph nodes and edges are reported by the commands.
+  if (xptiTraceEnabled())
+    return false;
+#endif
+
+  switch (CommandGroup.getType()) {
+  case CG::KERNEL: {
+    const auto &ExecKernel = static_cast<const CGExecKernel &>(CommandGroup);
+    // Streams are flushed by a host task connected to the kernel command.
+    if (!ExecKernel.MStreams.empty())
+      return false;
+    break;
   }
+  case CG::COPY_USM:
+  case CG::FILL_USM:
+  case CG::COPY_USM_RECT:
+  case CG::FILL_USM_RECT:
+  case CG::PREFETCH_USM:
+    break;
+  default:
+    return false;
+  }
+
+  // Only dependencies which are already represented by a native event of the
+  // same context can be passed to the device as is.
+  const ContextImplPtr &Context = Queue->getContextImplPtr();
+  return std::all_of(CommandGroup.MEvents.begin(), CommandGroup.MEvents.end(),
+                     [&Context](const EventImplPtr &Event) {
+                       return !Event->is_host() &&
+                              Event->getHandleRef() != nullptr &&
+                              Event->getContextImpl() == Context;
+                     });
+}
+
+EventImplPtr
+Scheduler::enqueueWithoutGraph(std::unique_ptr<detail::CG> CommandGroup,
+                               const QueueImplPtr &Queue) {
+  std::vector<RT::PiEvent> RawEvents;
+  RawEvents.reserve(CommandGroup->MEvents.size());
+  for (const EventImplPtr &Event : CommandGroup->MEvents)
+    RawEvents.push_back(Event->getHandleRef());
+
+  // There are no accessor arguments, see canBypassGraph.
+  auto getMemAllocationFunc = [](Requirement *) -> void * {
+    throw runtime_error("Accessor is used in a command group enqueued "
+                        "without the graph.",
+                        PI_INVALID_OPERATION);
+  };
+
+  // The in-order native queue orders the kernels whose events are discarded
+  // with the commands submitted after them.
+  if (Queue->discardsEvents() && CommandGroup->getType() == CG::KERNEL) {
+    cl_int Result = enqueueImpKernel(
+        Queue, *static_cast<CGExecKernel *>(CommandGroup.get()), RawEvents,
+        /*OutEvent=*/nullptr, getMemAllocationFunc);
+    if (CL_SUCCESS != Result)
+      throw runtime_error("Enqueue process failed.", PI_INVALID_OPERATION);
+    return Queue->getDiscardedEvent();
+  }
+
+  EventImplPtr NewEvent = detail::makeEventImpl(Queue);
+  NewEvent->setContextImpl(Queue->getContextImplPtr());
+
+  RT::PiEvent &Event = NewEvent->getHandleRef();
+  cl_int Result = CL_SUCCESS;
+  switch (CommandGroup->getType()) {
+  case CG::KERNEL: {
+    Result = enqueueImpKernel(
+        Queue, *static_cast<CGExecKernel *>(CommandGroup.get()), RawEvents,
+        &Event, getMemAllocationFunc);
+    break;
+  }
+  case CG::COPY_USM: {
+    CGCopyUSM *Copy = static_cast<CGCopyUSM *>(CommandGroup.get());
+    MemoryManager::copy_usm(Copy->getSrc(), Queue, Copy->getLength(),
+                            Copy->getDst(), std::move(RawEvents), Event);
+    break;
+  }
+  case CG::FILL_USM: {
+    CGFillUSM *Fill = static_cast<CGFillUSM *>(CommandGroup.get());
+    MemoryManager::fill_usm(Fill->getDst(), Queue, Fill->getLength(),
+                            Fill->getFill(), std::move(RawEvents), Event);
+    break;
+  }
+  case CG::COPY_USM_RECT: {
+    CGCopyUSMRect *Copy = static_cast<CGCopyUSMRect *>(CommandGroup.get());
+    MemoryManager::copy_usm_rect(Copy->getSrc(), Queue, Copy->getRect(),
+                                 Copy->getDst(), std::move(RawEvents), Event);
+    break;
+  }
+  case CG::FILL_USM_RECT: {
+    CGFillUSMRect *Fill = static_cast<CGFillUSMRect *>(CommandGroup.get());
+    MemoryManager::fill_usm_rect(Fill->getDst(), Queue, Fill->getRect(),
+                                 Fill->getPattern(), std::move(RawEvents),
+                                 Event);
+    break;
+  }
+  case CG::PREFETCH_USM: {
+    CGPrefetchUSM *Prefetch = static_cast<CGPrefetchUSM *>(CommandGroup.get());
+    MemoryManager::prefetch_usm(Prefetch->getDst(), Queue,
+                                Prefetch->getLength(), std::move(RawEvents),
+                                Event);
+    break;
+  }
+  default:
+    throw runtime_error("Command group can't be enqueued without the graph.",
+                        PI_INVALID_OPERATION);
+  }
+
+  if (CL_SUCCESS != Result)
+    throw runtime_error("Enqueue process failed.", PI_INVALID_OPERATION);
+
+  return NewEvent;
 }
 
 EventImplPtr Scheduler::addCG(std::unique_ptr<detail::CG> CommandGroup,
                               QueueImplPtr Queue) {
+  SubmitLatencyScope LatencyScope(SubmitStage::add_command_group);
+  // Command groups which neither access memory objects nor depend on the
+  // commands in the graph are enqueued right away.
+  if (canBypassGraph(*CommandGroup, Queue)) {
+    SubmitLatencyScope EnqueueLatencyScope(SubmitStage::enqueue_command);
+    return enqueueWithoutGraph(std::move(CommandGroup), Queue);
+  }
+
   EventImplPtr NewEvent = nullptr;
   const bool IsKernel = CommandGroup->getType() == CG::KERNEL;
   const bool IsHostKernel = CommandGroup->getType() == CG::RUN_ON_HOST_INTEL;
@@ -87,47 +228,24 @@ EventImplPtr Scheduler::addCG(std::unique_ptr<detail::CG> CommandGroup,
   }
 
   {
+    SubmitLatencyScope GraphLatencyScope(SubmitStage::graph_builder);
+    // Command groups which are independent of the rest of the graph only
+    // modify the new command, so they do not need the exclusive lock and do
+    // not serialize with each other.
     std::unique_lock<std::shared_timed_mutex> Lock(MGraphLock, std::defer_lock);
-    lockSharedTimedMutex(Lock);
-
-    Command *NewCmd = nullptr;
-    switch (CommandGroup->getType()) {
-    case CG::UPDATE_HOST:
-      NewCmd = MGraphBuilder.addCGUpdateHost(std::move(CommandGroup),
-                                             DefaultHostQueue);
-      break;
-    case CG::CODEPLAY_HOST_TASK:
-      NewCmd = MGraphBuilder.addCG(std::move(CommandGroup), DefaultHostQueue);
-      break;
-    default:
-      NewCmd = MGraphBuilder.addCG(std::move(CommandGroup), std::move(Queue));
-    }
-    NewEvent = NewCmd->getEvent();
+    std::shared_lock<std::shared_timed_mutex> SharedLock(MGraphLock,
+                                                         std::defer_lock);
+    if (MGraphBuilder.isGraphIndependent(*CommandGroup, Queue))
+      SharedLock.lock();
+    else
+      lockSharedTimedMutex(Lock);
+
+    NewEvent = addCGToGraph(std::move(CommandGroup), std::move(Queue));
   }
 
   {
     std::shared_lock<std::shared_timed_mutex> Lock(MGraphLock);
-
-    Command *NewCmd = static_cast<Command *>(NewEvent->getCommand());
-    if (NewCmd) {
-      // TODO: Check if lazy mode.
-      EnqueueResultT Res;
-      bool Enqueued = GraphProcessor::enqueueCommand(NewCmd, Res);
-      if (!Enqueued && EnqueueResultT::SyclEnqueueFailed == Res.MResult)
-        throw runtime_error("Enqueue process failed.", PI_INVALID_OPERATION);
-
-      // If there are no memory dependencies decouple and free the command.
-      // Though, dismiss ownership of native kernel command group as it's
-      // resources may be in use by backend and synchronization point here is
-      // at native kernel execution finish.
-      if (NewCmd->MDeps.size() == 0 && NewCmd->MUsers.size() == 0) {
-        if (IsHostKernel)
-          static_cast<ExecCGCommand *>(NewCmd)->releaseCG();
-
-        NewEvent->setCommand(nullptr);
-        delete NewCmd;
-      }
-    }
+    enqueueNewCommand(NewEvent, IsHostKernel);
   }
 
   for (auto StreamImplPtr : Streams) {
@@ -137,10 +255,135 @@ EventImplPtr Scheduler::addCG(std::unique_ptr<detail::CG> CommandGroup,
   return NewEvent;
 }
 
-EventImplPtr Scheduler::addCopyBack(Requirement *Req) {
+EventImplPtr Scheduler::addCGToGraph(std::unique_ptr<detail::CG> CommandGroup,
+                                     QueueImplPtr Queue) {
+  Command *NewCmd = nullptr;
+  switch (CommandGroup->getType()) {
+  case CG::UPDATE_HOST:
+    NewCmd = MGraphBuilder.addCGUpdateHost(std::move(CommandGroup),
+                                           DefaultHostQueue);
+    break;
+  case CG::CODEPLAY_HOST_TASK:
+    NewCmd = MGraphBuilder.addCG(std::move(CommandGroup), DefaultHostQueue);
+    break;
+  default:
+    NewCmd = MGraphBuilder.addCG(std::move(CommandGroup), std::move(Queue));
+  }
+  return NewCmd->getEvent();
+}
+
+void Scheduler::enqueueNewCommand(const EventImplPtr &NewEvent,
+                                  bool IsHostKernel) {
+  Command *NewCmd = static_cast<Command *>(NewEvent->getCommand());
+  if (!NewCmd)
+    return;
+
+  // TODO: Check if lazy mode.
+  EnqueueResultT Res;
+  bool Enqueued;
+  {
+    SubmitLatencyScope EnqueueLatencyScope(SubmitStage::enqueue_command);
+    Enqueued = GraphProcessor::enqueueCommand(NewCmd, Res);
+  }
+  if (!Enqueued && EnqueueResultT::SyclEnqueueFailed == Res.MResult)
+    throw runtime_error("Enqueue process failed.", PI_INVALID_OPERATION);
+
+  // If there are no memory dependencies decouple and free the command.
+  // Though, dismiss ownership of native kernel command group as it's
+  // resources may be in use by backend and synchronization point here is
+  // at native kernel execution finish.
+  if (NewCmd->MDeps.size() == 0 && NewCmd->MUsers.size() == 0) {
+    if (IsHostKernel)
+      static_cast<ExecCGCommand *>(NewCmd)->releaseCG();
+
+    NewEvent->setCommand(nullptr);
+    delete NewCmd;
+  }
+}
+
+/// \return true if the command group has to be added on its own with
+/// Scheduler::addCG: the streams of a kernel are initialized and flushed by
+/// other command groups.
+static bool hasStreams(const CG &CommandGroup) {
+  return CommandGroup.getType() == CG::KERNEL &&
+         !static_cast<const CGExecKernel &>(CommandGroup).MStreams.empty();
+}
+
+std::vector<EventImplPtr>
+Scheduler::addCGs(std::vector<std::pair<EventImplPtr, std::unique_ptr<CG>>>
+                      CommandGroups,
+                  const QueueImplPtr &Queue) {
+  std::vector<EventImplPtr> Events;
+  Events.reserve(CommandGroups.size());
+  // The dependencies on the placeholder events of the earlier command groups
+  // become dependencies on their events
+  std::unordered_map<const event_impl *, EventImplPtr> SubmittedEvents;
+  auto ResolveDeps = [&SubmittedEvents](CG &CommandGroup) {
+    for (EventImplPtr &DepEvent : CommandGroup.MEvents) {
+      auto It = SubmittedEvents.find(DepEvent.get());
+      if (It != SubmittedEvents.end())
+        DepEvent = It->second;
+    }
+  };
+  auto Submitted = [&](size_t I, EventImplPtr Event) {
+    if (CommandGroups[I].first)
+      SubmittedEvents[CommandGroups[I].first.get()] = Event;
+    Events.push_back(std::move(Event));
+  };
+
+  const size_t NumCGs = CommandGroups.size();
+  size_t I = 0;
+  while (I < NumCGs) {
+    CG &First = *CommandGroups[I].second;
+    ResolveDeps(First);
+    if (canBypassGraph(First, Queue)) {
+      SubmitLatencyScope EnqueueLatencyScope(SubmitStage::enqueue_command);
+      Submitted(I, enqueueWithoutGraph(std::move(CommandGroups[I].second),
+                                       Queue));
+      ++I;
+      continue;
+    }
+    if (hasStreams(First)) {
+      Submitted(I, addCG(std::move(CommandGroups[I].second), Queue));
+      ++I;
+      continue;
+    }
+
+    // The consecutive command groups going through the graph are added under
+    // a single acquisition of the exclusive lock, then enqueued in order
+    // under a single acquisition of the shared lock. A command group which
+    // bypasses the graph ends the run, so that it is enqueued after them.
+    const size_t RunBegin = I;
+    std::vector<bool> IsHostKernel;
+    {
+      SubmitLatencyScope GraphLatencyScope(SubmitStage::graph_builder);
+      std::unique_lock<std::shared_timed_mutex> Lock(MGraphLock,
+                                                     std::defer_lock);
+      lockSharedTimedMutex(Lock);
+      for (; I < NumCGs; ++I) {
+        CG &CommandGroup = *CommandGroups[I].second;
+        if (I != RunBegin) {
+          ResolveDeps(CommandGroup);
+          if (canBypassGraph(CommandGroup, Queue) || hasStreams(CommandGroup))
+            break;
+        }
+        IsHostKernel.push_back(CommandGroup.getType() ==
+                               CG::RUN_ON_HOST_INTEL);
+        Submitted(I, addCGToGraph(std::move(CommandGroups[I].second), Queue));
+      }
+    }
+
+    std::shared_lock<std::shared_timed_mutex> Lock(MGraphLock);
+    for (size_t J = RunBegin; J < I; ++J)
+      enqueueNewCommand(Events[J], IsHostKernel[J - RunBegin]);
+  }
+  return Events;
+}
+
+EventImplPtr Scheduler::addCopyBack(Requirement *Req, bool DirtyOnly) {
   std::unique_lock<std::shared_timed_mutex> Lock(MGraphLock, std::defer_lock);
   lockSharedTimedMutex(Lock);
-  Command *NewCmd = MGraphBuilder.addCopyBack(Req);
+  Command *NewCmd = MGraphBuilder.addCopyBack(Req, DirtyOnly);
   // Command was not creted because there were no operations with
   // buffer.
   if (!NewCmd)
@@ -171,6 +414,11 @@ void Scheduler::waitForEvent(EventImplPtr Event) {
   GraphProcessor::waitForEvent(std::move(Event));
 }
 
+void Scheduler::waitForEvents(const std::vector<EventImplPtr> &Events) {
+  std::shared_lock<std::shared_timed_mutex> Lock(MGraphLock);
+  GraphProcessor::waitForEvents(Events);
+}
+
 static void deallocateStreams(
     std::vector<std::shared_ptr<stream_impl>> &StreamsToDeallocate) {
   // Deallocate buffers for stream objects of the finished commands. Iterate in
@@ -204,6 +452,61 @@ void Scheduler::cleanupFinishedCommands(EventImplPtr FinishedEvent) {
   deallocateStreams(StreamsToDeallocate);
 }
 
+void Scheduler::deferCleanupFinishedCommands(EventImplPtr FinishedEvent) {
+  bool HasStreams = false;
+  {
+    std::lock_guard<std::recursive_mutex> Lock(StreamBuffersPoolMutex);
+    HasStreams = !StreamBuffersPool.empty();
+  }
+  if (HasStreams) {
+    cleanupFinishedCommands(std::move(FinishedEvent));
+    return;
+  }
+
+  std::lock_guard<std::mutex> Lock(MDeferredCleanupMutex);
+  MDeferredCleanupEvents.push_back(std::move(FinishedEvent));
+  if (MDeferredCleanupScheduled)
+    return;
+  MDeferredCleanupScheduled = true;
+  if (!MCleanupThreadPool) {
+    MCleanupThreadPool = std::make_unique<ThreadPool>();
+    MCleanupThreadPool->start();
+  }
+  MCleanupThreadPool->submit([this]() { cleanupDeferredCommands(); });
+}
+
+void Scheduler::cleanupDeferredCommands() {
+  std::vector<EventImplPtr> FinishedEvents;
+  {
+    std::lock_guard<std::mutex> Lock(MDeferredCleanupMutex);
+    FinishedEvents.swap(MDeferredCleanupEvents);
+    MDeferredCleanupScheduled = false;
+  }
+
+  std::vector<std::shared_ptr<stream_impl>> StreamsToDeallocate;
+  {
+    // Waiting for the lock could deadlock with the threads enqueueing blocked
+    // commands, as in cleanupFinishedCommands
+    std::unique_lock<std::shared_timed_mutex> Lock(MGraphLock,
+                                                   std::try_to_lock);
+    if (!Lock.owns_lock()) {
+      std::lock_guard<std::mutex> CleanupLock(MDeferredCleanupMutex);
+      MDeferredCleanupEvents.insert(MDeferredCleanupEvents.end(),
+                                    FinishedEvents.begin(),
+                                    FinishedEvents.end());
+      return;
+    }
+    for (const EventImplPtr &FinishedEvent : FinishedEvents) {
+      // The batch may have several events of the same commands, which are
+      // cleaned up once
+      auto FinishedCmd = static_cast<Command *>(FinishedEvent->getCommand());
+      if (FinishedCmd)
+        MGraphBuilder.cleanupFinishedCommands(FinishedCmd, StreamsToDeallocate);
+    }
+  }
+  deallocateStreams(StreamsToDeallocate);
+}
+
 void Scheduler::removeMemoryObject(detail::SYCLMemObjI *MemObj) {
   // We are going to traverse a graph of finished commands. Gather stream
   // objects from these commands if any and deallocate buffers for these stream
@@ -242,6 +545,29 @@ void Scheduler::removeMemoryObject(detail::SYCLMemObjI *MemObj) {
   deallocateStreams(StreamsToDeallocate);
 }
 
+void Scheduler::waitForAllRecords() {
+  {
+    std::shared_lock<std::shared_timed_mutex> Lock(MGraphLock);
+    std::vector<EventImplPtr> LeafEvents;
+    for (SYCLMemObjI *MemObj : MGraphBuilder.MMemObjs) {
+      MemObjRecord *Record = MGraphBuilder.getMemObjRecord(MemObj);
+      for (LeavesCollection *Leaves :
+           {&Record->MReadLeaves, &Record->MWriteLeaves})
+        for (Command *Cmd : *Leaves) {
+          EnqueueResultT Res;
+          bool Enqueued = GraphProcessor::enqueueCommand(Cmd, Res);
+          if (!Enqueued && EnqueueResultT::SyclEnqueueFailed == Res.MResult)
+            throw runtime_error("Enqueue process failed.",
+                                PI_INVALID_OPERATION);
+          LeafEvents.push_back(Cmd->getEvent());
+        }
+    }
+    GraphProcessor::waitForEvents(LeafEvents);
+  }
+  // The worker finishes the cleanup it runs, if any, before it is stopped.
+  MCleanupThreadPool.reset();
+}
+
 EventImplPtr Scheduler::addHostAccessor(Requirement *Req) {
   std::unique_lock<std::shared_timed_mutex> Lock(MGraphLock, std::defer_lock);
   lockSharedTimedMutex(Lock);
@@ -284,18 +610,76 @@ void Scheduler::enqueueLeavesOfReqUnlocked(const Requirement *const Req) {
   EnqueueLeaves(Record->MWriteLeaves);
 }
 
+// static
+void Scheduler::enqueueUsersUnlocked(Command *CompletedCmd) {
+  std::vector<Command *> ToEnqueue(CompletedCmd->MUsers.begin(),
+                                   CompletedCmd->MUsers.end());
+  std::unordered_set<Command *> Visited(ToEnqueue.begin(), ToEnqueue.end());
+  while (!ToEnqueue.empty()) {
+    Command *Cmd = ToEnqueue.back();
+    ToEnqueue.pop_back();
+    EnqueueResultT Res;
+    bool Enqueued = GraphProcessor::enqueueCommand(Cmd, Res);
+    if (!Enqueued) {
+      if (EnqueueResultT::SyclEnqueueFailed == Res.MResult)
+        throw runtime_error("Enqueue process failed.", PI_INVALID_OPERATION);
+      // The users of a blocked command are blocked as well
+      continue;
+    }
+    for (Command *User : Cmd->MUsers)
+      if (Visited.insert(User).second)
+        ToEnqueue.push_back(User);
+  }
+}
+
 void Scheduler::allocateStreamBuffers(stream_impl *Impl,
                                       size_t StreamBufferSize,
                                       size_t FlushBufferSize) {
   std::lock_guard<std::recursive_mutex> lock(StreamBuffersPoolMutex);
+  // The flush task of the previous user of a cached stream buffer has reset
+  // its offsets, so it can be used as is.
+  auto It = std::find_if(CachedStreamBuffers.begin(),
+                         CachedStreamBuffers.end(),
+                         [StreamBufferSize](StreamBuffers *Bufs) {
+                           return Bufs->Data.size() == StreamBufferSize;
+                         });
+  if (It != CachedStreamBuffers.end()) {
+    StreamBuffers *Bufs = *It;
+    CachedStreamBuffers.erase(It);
+    Bufs->resetFlushBuf(FlushBufferSize);
+    StreamBuffersPool.insert({Impl, Bufs});
+    return;
+  }
   StreamBuffersPool.insert(
       {Impl, new StreamBuffers(StreamBufferSize, FlushBufferSize)});
 }
 
 void Scheduler::deallocateStreamBuffers(stream_impl *Impl) {
+  StreamBuffers *Bufs = nullptr;
+  {
+    std::lock_guard<std::recursive_mutex> lock(StreamBuffersPoolMutex);
+    auto It = StreamBuffersPool.find(Impl);
+    if (It == StreamBuffersPool.end())
+      return;
+    Bufs = It->second;
+    StreamBuffersPool.erase(It);
+  }
+
+  // Destroying the stream buffer waits for the flush task, which guarantees
+  // that the streamed data is printed at the synchronization point. Keep the
+  // guarantee for a stream buffer which is kept for reuse.
+  if (Bufs->FlushEvent)
+    Bufs->FlushEvent->wait(Bufs->FlushEvent);
+
   std::lock_guard<std::recursive_mutex> lock(StreamBuffersPoolMutex);
-  delete StreamBuffersPool[Impl];
-  StreamBuffersPool.erase(Impl);
+  if (CachedStreamBuffers.size() < MaxCachedStreamBuffers) {
+    Bufs->FlushEvent = nullptr;
+    // Release the per work item flush buffer, it is not reused.
+    Bufs->resetFlushBuf(1);
+    CachedStreamBuffers.push_back(Bufs);
+    return;
+  }
+  delete Bufs;
 }
 
 Scheduler::Scheduler() {
@@ -345,6 +729,15 @@ void Scheduler::lockSharedTimedMutex(
 #endif // _WIN32
 }
 
+int Scheduler::getMemObjNumaNode(SYCLMemObjI *MemObj) {
+  if (!MemObj->MRecord)
+    return -1;
+  for (const AllocaCommandBase *AllocaCmd : MemObj->MRecord->MAllocaCommands)
+    if (!AllocaCmd->getQueue()->is_host())
+      return AllocaCmd->getQueue()->getDeviceImplPtr()->getNumaNode();
+  return -1;
+}
+
 MemObjRecord *Scheduler::getMemObjRecord(const Requirement *const Req) {
   return Req->MSYCLMemObj->MRecord.get();
 }
@@ -14,7 +14,9 @@
 #include <detail/scheduler/leaves_collection.hpp>
 
 #include <cstddef>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <queue>
 #include <set>
 #include <shared_mutex>
@@ -179,6 +181,7 @@ class queue_impl;
 class event_impl;
 class context_impl;
 class DispatchHostTask;
+class ThreadPool;
 
 using QueueImplPtr = std::shared_ptr<detail::queue_impl>;
 using EventImplPtr = std::shared_ptr<detail::event_impl>;
@@ -192,13 +195,38 @@ using ContextImplPtr = std::shared_ptr<detail::context_impl>;
 /// \ingroup sycl_graph
 struct MemObjRecord {
   MemObjRecord(ContextImplPtr Ctx, std::size_t LeafLimit,
-               LeavesCollection::AllocateDependencyF AllocateDependency)
-      : MReadLeaves{this, LeafLimit, AllocateDependency},
+               LeavesCollection::AllocateDependencyF AllocateDependency,
+               LeavesCollection::AddToGroupF AddToReadGroup = nullptr)
+      : MReadLeaves{this, LeafLimit, AllocateDependency,
+                    std::move(AddToReadGroup)},
         MWriteLeaves{this, LeafLimit, AllocateDependency}, MCurContext{Ctx} {}
 
-  // Contains all allocation commands for the memory object.
+  // Contains all allocation commands for the memory object. They are added
+  // with addAllocaCommand, which keeps the lookup tables below up to date.
   std::vector<AllocaCommandBase *> MAllocaCommands;
 
+  // The first allocation of the whole memory object in each context, and the
+  // first sub-buffer allocation for each context and offset in bytes, so that
+  // finding the allocation of a requirement doesn't scan MAllocaCommands. All
+  // the host contexts share the null key.
+  std::unordered_map<const context_impl *, AllocaCommandBase *>
+      MAllocaByContext;
+  std::unordered_map<const context_impl *,
+                     std::unordered_map<size_t, AllocaCommandBase *>>
+      MSubBufAllocaByContext;
+
+  // Adds an allocation command of the memory object.
+  void addAllocaCommand(AllocaCommandBase *AllocaCmd);
+
+  // Returns the allocation of the whole memory object in the context, or
+  // nullptr.
+  AllocaCommandBase *findAlloca(const ContextImplPtr &Ctx) const;
+
+  // Returns the allocation of the sub-buffer at the offset in the context, or
+  // nullptr.
+  AllocaCommandBase *findSubBufAlloca(const ContextImplPtr &Ctx,
+                                      size_t OffsetInBytes) const;
+
   // Contains latest read only commands working with memory object.
   LeavesCollection MReadLeaves;
 
@@ -215,6 +243,11 @@ struct MemObjRecord {
   // The flag indicates that the content of the memory object was/will be
   // modified. Used while deciding if copy back needed.
   bool MMemModified = false;
+
+  // Bounds in bytes of the memory which was/will be modified. Used to limit
+  // the copy back to the memory which is out of date.
+  size_t MDirtyBegin = std::numeric_limits<size_t>::max();
+  size_t MDirtyEnd = 0;
 };
 
 /// DPC++ graph scheduler class.
@@ -366,13 +399,30 @@ public:
   EventImplPtr addCG(std::unique_ptr<detail::CG> CommandGroup,
                      QueueImplPtr Queue);
 
+  /// Registers the command groups of a batch in order, as addCG would one
+  /// after the other. The consecutive command groups which go through the
+  /// graph are added to it under a single lock acquisition.
+  ///
+  /// \param CommandGroups are the command groups, each with the placeholder
+  /// event returned for it when it was collected, or nullptr. The
+  /// dependencies of a command group on the placeholder events of the earlier
+  /// ones are replaced with their events.
+  /// \param Queue is the queue the command groups are submitted to.
+  /// \return the events of the command groups, in order.
+  std::vector<EventImplPtr>
+  addCGs(std::vector<std::pair<EventImplPtr, std::unique_ptr<detail::CG>>>
+             CommandGroups,
+         const QueueImplPtr &Queue);
+
   /// Registers a command group, that copies most recent memory to the memory
   /// pointed by the requirement.
   ///
   /// \param Req is a requirement that points to the memory where data is
   /// needed.
+  /// \param DirtyOnly tells that the memory pointed by the requirement is up
+  /// to date except for the modified data, so only the latter is copied.
   /// \return an event object to wait on for copy finish.
-  EventImplPtr addCopyBack(Requirement *Req);
+  EventImplPtr addCopyBack(Requirement *Req, bool DirtyOnly = false);
 
   /// Waits for the event.
   ///
@@ -382,6 +432,14 @@ public:
   /// \param Event is a pointer to event to wait on.
   void waitForEvent(EventImplPtr Event);
 
+  /// Waits for all the events.
+  ///
+  /// Commands of all the events are enqueued first, so that the devices
+  /// process them while the host waits for the native events.
+  ///
+  /// \param Events is a list of events to wait on.
+  void waitForEvents(const std::vector<EventImplPtr> &Events);
+
   /// Removes buffer from the graph.
   ///
   /// The lifetime of memory object descriptor begins when the first command
@@ -399,6 +457,12 @@ public:
   /// \param MemObj is a memory object that points to the buffer being removed.
   void removeMemoryObject(detail::SYCLMemObjI *MemObj);
 
+  /// Waits for the commands of all the memory objects still in the graph, the
+  /// copy-backs among them included, and stops the deferred cleanup. Nothing
+  /// is released: this is for the fast shutdown, which leaves the scheduler
+  /// alive. \sa GlobalHandler::drainForFastShutdown
+  void waitForAllRecords();
+
   /// Removes finished non-leaf non-alloca commands from the subgraph (assuming
   /// that all its commands have been waited for).
   /// \sa GraphBuilder::cleanupFinishedCommands
@@ -406,6 +470,14 @@ public:
   /// \param FinishedEvent is a cleanup candidate event.
   void cleanupFinishedCommands(EventImplPtr FinishedEvent);
 
+  /// Defers the cleanup of the finished commands to a worker thread, which
+  /// cleans them up in batches, so that the waiting threads don't take the
+  /// graph lock for it. While there are streams, the cleanup is done right
+  /// away: it prints the streamed data of the finished commands.
+  ///
+  /// \param FinishedEvent is a cleanup candidate event.
+  void deferCleanupFinishedCommands(EventImplPtr FinishedEvent);
+
   /// Adds nodes to the graph, that update the requirement with the pointer
   /// to the host memory.
   ///
@@ -439,6 +511,9 @@ public:
 
   /// Deallocate all stream buffers in the pool
   ///
+  /// The stream buffer is kept for reuse by a later stream of the same size
+  /// if fewer than MaxCachedStreamBuffers buffers are already kept.
+  ///
   /// \param Pointer to the stream object
   void deallocateStreamBuffers(stream_impl *);
 
@@ -446,6 +521,11 @@ public:
 
   static MemObjRecord *getMemObjRecord(const Requirement *const Req);
 
+  /// \return the NUMA node of the device the memory object was allocated on
+  /// first, or -1 if there is none or its node is unknown. The host memory of
+  /// the object is mostly copied to and from that device.
+  static int getMemObjNumaNode(SYCLMemObjI *MemObj);
+
   Scheduler();
   ~Scheduler();
 
@@ -459,6 +539,46 @@ protected:
 
   static void enqueueLeavesOfReqUnlocked(const Requirement *const Req);
 
+  /// Enqueues the commands which depend on the completed command, and
+  /// transitively their users, stopping at the commands which are still
+  /// blocked. The graph must be read-locked.
+  ///
+  /// This is the continuation of a host task: its dependent device commands
+  /// are enqueued by the host task worker as soon as it completes, without
+  /// walking the leaves of all its memory objects.
+  static void enqueueUsersUnlocked(Command *CompletedCmd);
+
+  /// Checks if the command group can be enqueued to the device directly,
+  /// without creating a command in the graph and taking the graph lock.
+  ///
+  /// This is the case for device kernels and USM operations which don't
+  /// access memory objects, don't use streams and only depend on events
+  /// which have already been submitted to a device of the same context.
+  ///
+  /// \param CommandGroup is the command group to check.
+  /// \param Queue is the queue the command group is submitted to.
+  static bool canBypassGraph(const detail::CG &CommandGroup,
+                             const QueueImplPtr &Queue);
+
+  /// Enqueues the command group to the device without adding it to the graph.
+  ///
+  /// \sa canBypassGraph
+  /// \return an event object to wait on for command group completion.
+  static EventImplPtr
+  enqueueWithoutGraph(std::unique_ptr<detail::CG> CommandGroup,
+                      const QueueImplPtr &Queue);
+
+  /// Adds the command group to the graph. Must be called with MGraphLock
+  /// held, exclusively unless the command group is independent of the graph.
+  ///
+  /// \return the event of the new command.
+  EventImplPtr addCGToGraph(std::unique_ptr<detail::CG> CommandGroup,
+                            QueueImplPtr Queue);
+
+  /// Enqueues the command of the event returned by addCGToGraph, and frees it
+  /// if no other command refers to it. Must be called with MGraphLock held.
+  void enqueueNewCommand(const EventImplPtr &NewEvent, bool IsHostKernel);
+
   /// Graph builder class.
   ///
   /// The graph builder provides means to change an existing graph (e.g. add
@@ -477,6 +597,14 @@ protected:
     Command *addCG(std::unique_ptr<detail::CG> CommandGroup,
                    QueueImplPtr Queue);
 
+    /// Checks if adding the command group to the graph only modifies the new
+    /// command: the command group has no requirements and none of its event
+    /// dependencies needs a connection command. In this case the command
+    /// group can be added while other threads read the graph or add other
+    /// such command groups.
+    bool isGraphIndependent(const detail::CG &CommandGroup,
+                            const QueueImplPtr &Queue) const;
+
     /// Registers a \ref CG "command group" that updates host memory to the
     /// latest state.
     ///
@@ -487,7 +615,8 @@ protected:
     /// Enqueues a command to update memory to the latest state.
     ///
     /// \param Req is a requirement, that describes memory object.
-    Command *addCopyBack(Requirement *Req);
+    /// \param DirtyOnly limits the copy to the modified memory.
+    Command *addCopyBack(Requirement *Req, bool DirtyOnly = false);
 
     /// Enqueues a command to create a host accessor.
     ///
@@ -609,7 +738,10 @@ protected:
                                                const Requirement *Req,
                                                QueueImplPtr Queue);
 
-    void markModifiedIfWrite(MemObjRecord *Record, Requirement *Req);
+    /// Marks the memory object as modified if the requirement has write access.
+    /// The bytes written become stale in the allocations of the other contexts.
+    void markModifiedIfWrite(MemObjRecord *Record, Requirement *Req,
+                             const ContextImplPtr &Context);
 
     /// Used to track commands that need to be visited during graph traversal.
     std::queue<Command *> MCmdsToVisit;
@@ -713,6 +845,9 @@ protected:
     /// Waits for the command, associated with Event passed, is completed.
     static void waitForEvent(EventImplPtr Event);
 
+    /// Waits for the commands, associated with Events passed, are completed.
+    static void waitForEvents(const std::vector<EventImplPtr> &Events);
+
     /// Enqueues the command and all its dependencies.
     ///
     /// \param EnqueueResult is set to specific status if enqueue failed.
@@ -723,6 +858,10 @@ protected:
 
   void waitForRecordToFinish(MemObjRecord *Record);
 
+  /// Cleans up the commands of the deferred events if the graph lock is
+  /// free. Otherwise the events are kept for the next cleanup.
+  void cleanupDeferredCommands();
+
   GraphBuilder MGraphBuilder;
   // TODO: after switching to C++17, change std::shared_timed_mutex to
   // std::shared_mutex
@@ -761,8 +900,24 @@ protected:
 
     // Global flush buffer
     buffer<char, 1> FlushBuf;
+
+    // Event of the task printing the stream buffer, the stream buffer can only
+    // be reused or destroyed once it is complete.
+    EventImplPtr FlushEvent;
+
+    // Replace the flush buffer with a new one of FlushBufferSize bytes. The
+    // flush buffer is resized to the number of work items of the kernel it is
+    // used in, so unlike the stream buffer it cannot be reused.
+    void resetFlushBuf(size_t FlushBufferSize) {
+      FlushBuf = buffer<char, 1>(range<1>(FlushBufferSize));
+      FlushBuf.set_write_back(false);
+    }
   };
 
+  // Two stream buffers are enough for a stream buffer to be drained on the
+  // host while the next kernel streams into the other one.
+  static constexpr size_t MaxCachedStreamBuffers = 2;
+
   friend class stream_impl;
   friend void initStream(StreamImplPtr, QueueImplPtr);
 
@@ -778,6 +933,19 @@ protected:
   // scheduler. If program is not correct and doesn't have necessary sync point
   // then warning will be issued.
   std::unordered_map<stream_impl *, StreamBuffers *> StreamBuffersPool;
+
+  // Stream buffers released by finished kernels, kept to avoid allocating and
+  // initializing a new stream buffer for every kernel using a stream. They
+  // are not destroyed with the scheduler for the same reason as the pool.
+  std::vector<StreamBuffers *> CachedStreamBuffers;
+
+  // Protects the deferred cleanup state
+  std::mutex MDeferredCleanupMutex;
+  std::vector<EventImplPtr> MDeferredCleanupEvents;
+  bool MDeferredCleanupScheduled = false;
+  // Runs the deferred cleanup. Declared last, so that its worker is stopped
+  // before the graph is destroyed.
+  std::unique_ptr<ThreadPool> MCleanupThreadPool;
 };
 
 } // namespace detail
@@ -0,0 +1,148 @@
+//===-- slab_pool.hpp - Pool of small fixed size blocks ---------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl/detail/defines.hpp>
+#include <CL/sycl/detail/spinlock.hpp>
+
+#include <array>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+
+/// Allocator of small blocks which are carved out of large slabs.
+///
+/// Requested sizes are rounded up to a multiple of Granularity. Freed blocks
+/// are kept in a free list of their size class and are handed out again by
+/// the next allocation of the same class, so steady streams of short-lived
+/// objects stop hitting the system allocator. Slabs are only released when
+/// the pool is destroyed. Requests larger than MaxBlockSize are forwarded to
+/// the global operator new.
+class SlabPool {
+public:
+  /// Alignment and size step of the blocks.
+  static constexpr size_t Granularity = alignof(std::max_align_t);
+  /// Largest block which is served from the slabs.
+  static constexpr size_t MaxBlockSize = 1024;
+  /// Size of the memory chunk requested from the system at once.
+  static constexpr size_t SlabSize = 64 * 1024;
+
+  SlabPool() = default;
+  SlabPool(const SlabPool &) = delete;
+  SlabPool &operator=(const SlabPool &) = delete;
+
+  ~SlabPool() {
+    for (void *Slab : MSlabs)
+      ::operator delete(Slab);
+  }
+
+  void *allocate(size_t Size) {
+    if (Size > MaxBlockSize)
+      return ::operator new(Size);
+
+    const size_t Class = getSizeClass(Size);
+    std::lock_guard<SpinLock> Lock(MLock);
+    if (!MFreeLists[Class])
+      refill(Class);
+
+    FreeBlock *Block = MFreeLists[Class];
+    MFreeLists[Class] = Block->MNext;
+    return Block;
+  }
+
+  /// \param Size must be the size passed to allocate for \p Ptr.
+  void deallocate(void *Ptr, size_t Size) noexcept {
+    if (!Ptr)
+      return;
+    if (Size > MaxBlockSize) {
+      ::operator delete(Ptr);
+      return;
+    }
+
+    const size_t Class = getSizeClass(Size);
+    FreeBlock *Block = static_cast<FreeBlock *>(Ptr);
+    std::lock_guard<SpinLock> Lock(MLock);
+    Block->MNext = MFreeLists[Class];
+    MFreeLists[Class] = Block;
+  }
+
+private:
+  struct FreeBlock {
+    FreeBlock *MNext;
+  };
+
+  static constexpr size_t NumSizeClasses = MaxBlockSize / Granularity;
+
+  static size_t getSizeClass(size_t Size) {
+    return Size == 0 ? 0 : (Size - 1) / Granularity;
+  }
+
+  /// Splits a new slab into blocks of the size class. Must be called with
+  /// MLock held.
+  void refill(size_t Class) {
+    const size_t BlockSize = (Class + 1) * Granularity;
+    MSlabs.reserve(MSlabs.size() + 1);
+    char *Slab = static_cast<char *>(::operator new(SlabSize));
+    MSlabs.push_back(Slab);
+
+    FreeBlock *Head = MFreeLists[Class];
+    for (size_t Offset = SlabSize - SlabSize % BlockSize; Offset != 0;) {
+      Offset -= BlockSize;
+      FreeBlock *Block = reinterpret_cast<FreeBlock *>(Slab + Offset);
+      Block->MNext = Head;
+      Head = Block;
+    }
+    MFreeLists[Class] = Head;
+  }
+
+  SpinLock MLock;
+  std::array<FreeBlock *, NumSizeClasses> MFreeLists{};
+  std::vector<void *> MSlabs;
+};
+
+/// Standard allocator which takes memory from the pool returned by
+/// GetPool, e.g. for containers of the scheduler graph nodes.
+template <typename T, SlabPool &(*GetPool)()> class SlabPoolAllocator {
+public:
+  using value_type = T;
+
+  template <typename U> struct rebind {
+    using other = SlabPoolAllocator<U, GetPool>;
+  };
+
+  SlabPoolAllocator() noexcept = default;
+  template <typename U>
+  SlabPoolAllocator(const SlabPoolAllocator<U, GetPool> &) noexcept {}
+
+  T *allocate(size_t N) {
+    return static_cast<T *>(GetPool().allocate(N * sizeof(T)));
+  }
+
+  void deallocate(T *Ptr, size_t N) noexcept {
+    GetPool().deallocate(Ptr, N * sizeof(T));
+  }
+
+  template <typename U>
+  bool operator==(const SlabPoolAllocator<U, GetPool> &) const noexcept {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const SlabPoolAllocator<U, GetPool> &) const noexcept {
+    return false;
+  }
+};
+
+} // namespace detail
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -10,7 +10,9 @@
 #include <detail/scheduler/scheduler.hpp>
 #include <detail/stream_impl.hpp>
 
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
 
 __SYCL_INLINE_NAMESPACE(cl) {
 namespace sycl {
@@ -67,28 +69,44 @@ void stream_impl::flush() {
   // finishes execution.
   auto Q = detail::createSyclObjFromImpl<queue>(
       cl::sycl::detail::Scheduler::getInstance().getDefaultHostQueue());
-  Q.submit([&](handler &cgh) {
+  Scheduler::StreamBuffers *Bufs = nullptr;
+  {
+    std::lock_guard<std::recursive_mutex> Lock(
+        Scheduler::getInstance().StreamBuffersPoolMutex);
+    Bufs = Scheduler::getInstance().StreamBuffersPool.find(this)->second;
+  }
+  event FlushEvent = Q.submit([&](handler &cgh) {
+    // Access the stream buffer together with the offsets in its beginning, so
+    // that only the streamed data is printed and the offsets can be reset.
     auto BufHostAcc =
-        detail::Scheduler::getInstance()
-            .StreamBuffersPool.find(this)
-            ->second->Buf
+        Bufs->Buf
             .get_access<access::mode::read_write, access::target::host_buffer>(
-                cgh, range<1>(BufferSize_), id<1>(OffsetSize));
+                cgh, range<1>(OffsetSize + BufferSize_ + 1), id<1>(0));
     // Create accessor to the flush buffer even if not using it yet. Otherwise
     // kernel will be a leaf for the flush buffer and scheduler will not be able
-    // to cleanup the kernel. TODO: get rid of finalize method by using host
-    // accessor to the flush buffer.
+    // to cleanup the kernel. A single element is enough for that, copying back
+    // the whole flush buffer, whose size is proportional to the number of work
+    // items, would dominate the cost of the flush.
+    // TODO: get rid of finalize method by using host accessor to the flush
+    // buffer.
     auto FlushBufHostAcc =
-        detail::Scheduler::getInstance()
-            .StreamBuffersPool.find(this)
-            ->second->FlushBuf
+        Bufs->FlushBuf
             .get_access<access::mode::read_write, access::target::host_buffer>(
-                cgh);
+                cgh, range<1>(1), id<1>(0));
+    const size_t Size = BufferSize_;
     cgh.codeplay_host_task([=] {
-      printf("%s", BufHostAcc.get_pointer());
+      char *BufPtr = BufHostAcc.get_pointer();
+      unsigned Offsets[2];
+      std::memcpy(Offsets, BufPtr, OffsetSize);
+      fwrite(BufPtr + OffsetSize, 1, std::min<size_t>(Offsets[0], Size),
+             stdout);
       fflush(stdout);
+      // Reset the offsets for the stream buffer to be reused by another
+      // stream, see Scheduler::deallocateStreamBuffers.
+      std::memset(BufPtr, 0, OffsetSize);
     });
   });
+  Bufs->FlushEvent = detail::getSyclObjImpl(FlushEvent);
 }
 } // namespace detail
 } // namespace sycl
@@ -0,0 +1,78 @@
+//==----- submission_batch_impl.hpp --- SYCL batched command groups --------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl/detail/cg.hpp>
+#include <CL/sycl/detail/common.hpp>
+#include <CL/sycl/event.hpp>
+#include <CL/sycl/stl.hpp>
+
+#include <memory>
+#include <mutex>
+#include <utility>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+class handler;
+
+namespace detail {
+
+class queue_impl;
+class event_impl;
+using QueueImplPtr = std::shared_ptr<queue_impl>;
+using EventImplPtr = std::shared_ptr<event_impl>;
+
+/// The command groups collected by a ONEAPI::submission_batch, each with the
+/// placeholder event returned for it.
+class submission_batch_impl {
+public:
+  using CollectedCGs =
+      vector_class<std::pair<EventImplPtr, std::unique_ptr<CG>>>;
+
+  submission_batch_impl(QueueImplPtr Queue) : MQueue(std::move(Queue)) {}
+
+  /// Commits the command groups which are still collected.
+  ~submission_batch_impl();
+
+  const QueueImplPtr &getQueue() const { return MQueue; }
+
+  size_t size() const {
+    std::lock_guard<mutex_class> Lock(MMutex);
+    return MCGs.size();
+  }
+
+  /// Runs a command group function and collects the command group.
+  event submit(const function_class<void(handler &)> &CGF,
+               const code_location &Loc);
+
+  /// Submits the collected command groups to the queue.
+  vector_class<event> commit();
+
+  /// \return the batch collecting the command groups finalized by the calling
+  /// thread, or nullptr if they are submitted.
+  static submission_batch_impl *getCurrent() { return MCurrent; }
+
+  /// Collects a command group finalized while the batch is current.
+  ///
+  /// \return an event standing for the command group, which may only be used
+  /// as a dependency of the command groups collected after it.
+  EventImplPtr add(std::unique_ptr<CG> CommandGroup);
+
+private:
+  const QueueImplPtr MQueue;
+  /// Protects MCGs.
+  mutable mutex_class MMutex;
+  CollectedCGs MCGs;
+
+  static thread_local submission_batch_impl *MCurrent;
+};
+
+} // namespace detail
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -0,0 +1,229 @@
+//==-------- submit_latency.cpp --- SYCL submission latency statistics -----==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/config.hpp>
+#include <detail/global_handler.hpp>
+#include <detail/submit_latency.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+
+constexpr unsigned LatencyHistogram::SubBucketBits;
+constexpr unsigned LatencyHistogram::SubBuckets;
+constexpr unsigned LatencyHistogram::NumBuckets;
+
+unsigned LatencyHistogram::getBucket(uint64_t Value) {
+  if (Value < SubBuckets)
+    return static_cast<unsigned>(Value);
+#ifdef _MSC_VER
+  unsigned long Exponent;
+  _BitScanReverse64(&Exponent, Value);
+#else
+  unsigned Exponent = 63 - __builtin_clzll(Value);
+#endif
+  unsigned Shift = Exponent - SubBucketBits;
+  return (Shift + 1) * SubBuckets +
+         static_cast<unsigned>((Value >> Shift) & (SubBuckets - 1));
+}
+
+uint64_t LatencyHistogram::getBucketLowest(unsigned Bucket) {
+  unsigned Group = Bucket / SubBuckets;
+  uint64_t SubBucket = Bucket % SubBuckets;
+  if (Group == 0)
+    return SubBucket;
+  return (SubBuckets + SubBucket) << (Group - 1);
+}
+
+uint64_t LatencyHistogram::getBucketHighest(unsigned Bucket) {
+  unsigned Group = Bucket / SubBuckets;
+  if (Group == 0)
+    return Bucket;
+  return getBucketLowest(Bucket) + ((uint64_t(1) << (Group - 1)) - 1);
+}
+
+void LatencyHistogram::record(uint64_t Value) {
+  increment(MCount, 1);
+  increment(MTotal, Value);
+  if (Value < MMin.load(std::memory_order_relaxed))
+    MMin.store(Value, std::memory_order_relaxed);
+  if (Value > MMax.load(std::memory_order_relaxed))
+    MMax.store(Value, std::memory_order_relaxed);
+  increment(MBuckets[getBucket(Value)], 1);
+}
+
+void LatencyHistogram::merge(std::vector<uint64_t> &Counts,
+                             ONEAPI::submit_latency &Stats) const {
+  uint64_t Count = MCount.load(std::memory_order_relaxed);
+  if (Count == 0)
+    return;
+  uint64_t Min = MMin.load(std::memory_order_relaxed);
+  Stats.min_ns = Stats.count ? std::min(Stats.min_ns, Min) : Min;
+  Stats.max_ns = std::max(Stats.max_ns, MMax.load(std::memory_order_relaxed));
+  Stats.count += Count;
+  Stats.total_ns += MTotal.load(std::memory_order_relaxed);
+  for (unsigned I = 0; I < NumBuckets; ++I)
+    Counts[I] += MBuckets[I].load(std::memory_order_relaxed);
+}
+
+void LatencyHistogram::setPercentiles(const std::vector<uint64_t> &Counts,
+                                      ONEAPI::submit_latency &Stats) {
+  if (Stats.count == 0)
+    return;
+
+  // The counts of the buckets are read after the count of the histogram, so
+  // they may add up to more than the count
+  uint64_t *Percentiles[] = {&Stats.p50_ns, &Stats.p90_ns, &Stats.p99_ns};
+  const unsigned Ranks[] = {50, 90, 99};
+  uint64_t Cumulated = 0;
+  unsigned Percentile = 0;
+  for (unsigned I = 0; I < NumBuckets && Percentile < 3; ++I) {
+    Cumulated += Counts[I];
+    while (Percentile < 3 &&
+           Cumulated * 100 >= Stats.count * Ranks[Percentile]) {
+      uint64_t Value = std::min(getBucketHighest(I), Stats.max_ns);
+      *Percentiles[Percentile++] = std::max(Value, Stats.min_ns);
+    }
+  }
+  for (; Percentile < 3; ++Percentile)
+    *Percentiles[Percentile] = Stats.max_ns;
+}
+
+void LatencyHistogram::reset() {
+  MCount.store(0, std::memory_order_relaxed);
+  MTotal.store(0, std::memory_order_relaxed);
+  MMin.store(UINT64_MAX, std::memory_order_relaxed);
+  MMax.store(0, std::memory_order_relaxed);
+  for (std::atomic<uint64_t> &Bucket : MBuckets)
+    Bucket.store(0, std::memory_order_relaxed);
+}
+
+SubmitLatencyRecorder::SubmitLatencyRecorder()
+    : MID([] {
+        static std::atomic<uint64_t> LastID{0};
+        return ++LastID;
+      }()) {}
+
+SubmitLatencyRecorder::~SubmitLatencyRecorder() {
+  if (!isEnabled())
+    return;
+  const char *Output = SYCLConfig<SYCL_SUBMIT_LATENCY>::get();
+  if (std::strcmp(Output, "1") == 0) {
+    print(std::cerr);
+    return;
+  }
+  std::ofstream File(Output);
+  if (File)
+    print(File);
+  else
+    std::cerr << "SYCL_SUBMIT_LATENCY: cannot write to " << Output << "\n";
+}
+
+bool SubmitLatencyRecorder::isEnabled() {
+  static const bool Enabled = [] {
+    const char *Value = SYCLConfig<SYCL_SUBMIT_LATENCY>::get();
+    return Value && *Value && std::strcmp(Value, "0") != 0;
+  }();
+  return Enabled;
+}
+
+SubmitLatencyRecorder::ThreadHistograms &
+SubmitLatencyRecorder::getThreadHistograms() {
+  // The histograms of a recorder destroyed since are never used again: IDs
+  // are not reused, unlike addresses
+  thread_local uint64_t OwnerID = 0;
+  thread_local ThreadHistograms *Histograms = nullptr;
+  if (OwnerID != MID) {
+    std::lock_guard<std::mutex> Lock(MMutex);
+    MThreads.push_back(std::make_unique<ThreadHistograms>());
+    Histograms = MThreads.back().get();
+    OwnerID = MID;
+  }
+  return *Histograms;
+}
+
+void SubmitLatencyRecorder::record(SubmitStage Stage, uint64_t Nanoseconds) {
+  getThreadHistograms().Stages[static_cast<unsigned>(Stage)].record(
+      Nanoseconds);
+}
+
+ONEAPI::submit_latency SubmitLatencyRecorder::get(SubmitStage Stage) {
+  ONEAPI::submit_latency Stats{};
+  std::vector<uint64_t> Counts(LatencyHistogram::NumBuckets, 0);
+  {
+    std::lock_guard<std::mutex> Lock(MMutex);
+    for (const std::unique_ptr<ThreadHistograms> &Thread : MThreads)
+      Thread->Stages[static_cast<unsigned>(Stage)].merge(Counts, Stats);
+  }
+  LatencyHistogram::setPercentiles(Counts, Stats);
+  return Stats;
+}
+
+void SubmitLatencyRecorder::reset() {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  for (const std::unique_ptr<ThreadHistograms> &Thread : MThreads)
+    for (LatencyHistogram &Histogram : Thread->Stages)
+      Histogram.reset();
+}
+
+void SubmitLatencyRecorder::print(std::ostream &Out) {
+  Out << "SYCL submission latency (ns)\n";
+  Out << std::left << std::setw(24) << "stage" << std::right;
+  for (const char *Column :
+       {"count", "mean", "min", "p50", "p90", "p99", "max"})
+    Out << std::setw(12) << Column;
+  Out << "\n";
+  for (unsigned I = 0; I < NumStages; ++I) {
+    SubmitStage Stage = static_cast<SubmitStage>(I);
+    ONEAPI::submit_latency Stats = get(Stage);
+    Out << std::left << std::setw(24) << getStageName(Stage) << std::right
+        << std::setw(12) << Stats.count << std::setw(12)
+        << (Stats.count ? Stats.total_ns / Stats.count : 0) << std::setw(12)
+        << Stats.min_ns << std::setw(12) << Stats.p50_ns << std::setw(12)
+        << Stats.p90_ns << std::setw(12) << Stats.p99_ns << std::setw(12)
+        << Stats.max_ns << "\n";
+  }
+}
+
+const char *SubmitLatencyRecorder::getStageName(SubmitStage Stage) {
+  switch (Stage) {
+  case SubmitStage::finalize:
+    return "handler::finalize";
+  case SubmitStage::add_command_group:
+    return "Scheduler::addCG";
+  case SubmitStage::graph_builder:
+    return "GraphBuilder";
+  case SubmitStage::enqueue_command:
+    return "enqueueCommand";
+  case SubmitStage::kernel_launch:
+    return "piEnqueueKernelLaunch";
+  }
+  return "unknown";
+}
+
+SubmitLatencyScope::~SubmitLatencyScope() {
+  if (!MEnabled)
+    return;
+  auto Latency = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - MStart);
+  GlobalHandler::instance().getSubmitLatencyRecorder().record(
+      MStage, static_cast<uint64_t>(Latency.count()));
+}
+} // namespace detail
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -0,0 +1,124 @@
+//==-------- submit_latency.hpp --- SYCL submission latency statistics -----==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl/ONEAPI/submit_latency.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+
+using SubmitStage = ONEAPI::submit_stage;
+
+/// A latency histogram with log-linear buckets: each power of two range of
+/// latencies is split into 8 buckets, so a bucket covers at most 12.5% of its
+/// lowest latency.
+///
+/// The histogram has a single writer, the thread it belongs to, which does
+/// not use read-modify-write operations; other threads only read it.
+class LatencyHistogram {
+public:
+  static constexpr unsigned SubBucketBits = 3;
+  static constexpr unsigned SubBuckets = 1u << SubBucketBits;
+  static constexpr unsigned NumBuckets = (64 - SubBucketBits + 1) * SubBuckets;
+
+  static unsigned getBucket(uint64_t Value);
+  /// \return the lowest value of the bucket.
+  static uint64_t getBucketLowest(unsigned Bucket);
+  /// \return the highest value of the bucket.
+  static uint64_t getBucketHighest(unsigned Bucket);
+
+  void record(uint64_t Value);
+  /// Adds the counts of the histogram to Counts and to Stats.
+  void merge(std::vector<uint64_t> &Counts,
+             ONEAPI::submit_latency &Stats) const;
+  /// Sets the percentiles of Stats from the merged Counts.
+  static void setPercentiles(const std::vector<uint64_t> &Counts,
+                             ONEAPI::submit_latency &Stats);
+  void reset();
+
+private:
+  static void increment(std::atomic<uint64_t> &Counter, uint64_t Value) {
+    Counter.store(Counter.load(std::memory_order_relaxed) + Value,
+                  std::memory_order_relaxed);
+  }
+
+  std::atomic<uint64_t> MCount{0};
+  std::atomic<uint64_t> MTotal{0};
+  std::atomic<uint64_t> MMin{UINT64_MAX};
+  std::atomic<uint64_t> MMax{0};
+  std::atomic<uint64_t> MBuckets[NumBuckets] = {};
+};
+
+/// Collects the latencies of the submission stages of all threads, see
+/// SYCL_SUBMIT_LATENCY.
+class SubmitLatencyRecorder {
+public:
+  static constexpr unsigned NumStages =
+      static_cast<unsigned>(SubmitStage::kernel_launch) + 1;
+
+  SubmitLatencyRecorder();
+  /// Prints the statistics if SYCL_SUBMIT_LATENCY asks for it.
+  ~SubmitLatencyRecorder();
+
+  /// \return true if SYCL_SUBMIT_LATENCY enables the measurements.
+  static bool isEnabled();
+
+  void record(SubmitStage Stage, uint64_t Nanoseconds);
+  ONEAPI::submit_latency get(SubmitStage Stage);
+  void reset();
+  void print(std::ostream &Out);
+
+  static const char *getStageName(SubmitStage Stage);
+
+private:
+  struct ThreadHistograms {
+    LatencyHistogram Stages[NumStages];
+  };
+
+  ThreadHistograms &getThreadHistograms();
+
+  // Identifies the recorder in the thread local caches of the histograms.
+  const uint64_t MID;
+  std::mutex MMutex;
+  // The histograms of the threads which have exited are kept, their
+  // latencies still count.
+  std::vector<std::unique_ptr<ThreadHistograms>> MThreads;
+};
+
+/// Measures the latency of a submission stage from its construction to its
+/// destruction, if the measurements are enabled.
+class SubmitLatencyScope {
+public:
+  explicit SubmitLatencyScope(SubmitStage Stage)
+      : MStage(Stage), MEnabled(SubmitLatencyRecorder::isEnabled()) {
+    if (MEnabled)
+      MStart = std::chrono::steady_clock::now();
+  }
+  ~SubmitLatencyScope();
+
+  SubmitLatencyScope(const SubmitLatencyScope &) = delete;
+  SubmitLatencyScope &operator=(const SubmitLatencyScope &) = delete;
+
+private:
+  SubmitStage MStage;
+  bool MEnabled;
+  std::chrono::steady_clock::time_point MStart;
+};
+} // namespace detail
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -47,7 +47,9 @@ SYCLMemObjT::SYCLMemObjT(cl_mem MemObject, const context &SyclContext,
 
 void SYCLMemObjT::releaseMem(ContextImplPtr Context, void *MemAllocation) {
   void *Ptr = getUserPtr();
-  return MemoryManager::releaseMemObj(Context, this, MemAllocation, Ptr);
+  MemoryManager::releaseMemObj(Context, this, MemAllocation, Ptr);
+  if (!Context->is_host())
+    Context->releaseHostMemoryImport(this);
 }
 
 void SYCLMemObjT::updateHostMemory(void *const Ptr) {
@@ -63,7 +65,10 @@ void SYCLMemObjT::updateHostMemory(void *const Ptr) {
                   Dims, ElemSize);
   Req.MData = Ptr;
 
-  EventImplPtr Event = Scheduler::getInstance().addCopyBack(&Req);
+  // The user memory the buffer was created with is only out of date where the
+  // buffer was modified.
+  EventImplPtr Event =
+      Scheduler::getInstance().addCopyBack(&Req, /*DirtyOnly*/ Ptr == MUserPtr);
   if (Event)
     Event->wait(Event);
 }
@@ -1,4 +1,4 @@
-//===-- thread_pool.hpp - Simple thread pool --------------------*- C++ -*-===//
+//===-- thread_pool.hpp - Work-stealing thread pool -------------*- C++ -*-===//
 //
 // Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
 // See https://llvm.org/LICENSE.txt for license information.
@@ -10,49 +10,290 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cerrno>
 #include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
 #include <mutex>
-#include <queue>
+#include <new>
 #include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 #include <CL/sycl/detail/defines.hpp>
 
 __SYCL_INLINE_NAMESPACE(cl) {
 namespace sycl {
 namespace detail {
 
+/// Move-only type-erased job of the thread pool. Small callables are stored
+/// inline to avoid a heap allocation per job.
+class ThreadPoolTask {
+  struct Ops {
+    void (*Invoke)(void *Storage);
+    void (*Move)(void *DstStorage, void *SrcStorage);
+    void (*Destroy)(void *Storage);
+  };
+
+  using StorageT = std::aligned_storage<6 * sizeof(void *),
+                                        alignof(std::max_align_t)>::type;
+
+  template <typename FuncT> static constexpr bool isStoredInline() {
+    return sizeof(FuncT) <= sizeof(StorageT) &&
+           alignof(FuncT) <= alignof(StorageT) &&
+           std::is_nothrow_move_constructible<FuncT>::value;
+  }
+
+  template <typename FuncT> struct InlineOps {
+    static void invoke(void *Storage) { (*static_cast<FuncT *>(Storage))(); }
+    static void move(void *DstStorage, void *SrcStorage) {
+      FuncT *Src = static_cast<FuncT *>(SrcStorage);
+      new (DstStorage) FuncT(std::move(*Src));
+      Src->~FuncT();
+    }
+    static void destroy(void *Storage) {
+      static_cast<FuncT *>(Storage)->~FuncT();
+    }
+    static const Ops Table;
+  };
+
+  template <typename FuncT> struct HeapOps {
+    static void invoke(void *Storage) { (**static_cast<FuncT **>(Storage))(); }
+    static void move(void *DstStorage, void *SrcStorage) {
+      *static_cast<FuncT **>(DstStorage) = *static_cast<FuncT **>(SrcStorage);
+    }
+    static void destroy(void *Storage) {
+      delete *static_cast<FuncT **>(Storage);
+    }
+    static const Ops Table;
+  };
+
+  template <typename FuncT, typename T>
+  void init(T &&Func, std::true_type /*StoredInline*/) {
+    new (&MStorage) FuncT(std::forward<T>(Func));
+    MOps = &InlineOps<FuncT>::Table;
+  }
+
+  template <typename FuncT, typename T>
+  void init(T &&Func, std::false_type /*StoredInline*/) {
+    *reinterpret_cast<FuncT **>(&MStorage) = new FuncT(std::forward<T>(Func));
+    MOps = &HeapOps<FuncT>::Table;
+  }
+
+  void reset() {
+    if (MOps)
+      MOps->Destroy(&MStorage);
+    MOps = nullptr;
+  }
+
+  StorageT MStorage;
+  const Ops *MOps = nullptr;
+
+public:
+  ThreadPoolTask() = default;
+
+  template <typename T, typename FuncT = typename std::decay<T>::type,
+            typename = typename std::enable_if<
+                !std::is_same<FuncT, ThreadPoolTask>::value>::type>
+  ThreadPoolTask(T &&Func) {
+    init<FuncT>(std::forward<T>(Func),
+                std::integral_constant<bool, isStoredInline<FuncT>()>{});
+  }
+
+  ThreadPoolTask(ThreadPoolTask &&Other) noexcept : MOps(Other.MOps) {
+    if (MOps)
+      MOps->Move(&MStorage, &Other.MStorage);
+    Other.MOps = nullptr;
+  }
+
+  ThreadPoolTask &operator=(ThreadPoolTask &&Other) noexcept {
+    if (this != &Other) {
+      reset();
+      MOps = Other.MOps;
+      if (MOps)
+        MOps->Move(&MStorage, &Other.MStorage);
+      Other.MOps = nullptr;
+    }
+    return *this;
+  }
+
+  ThreadPoolTask(const ThreadPoolTask &) = delete;
+  ThreadPoolTask &operator=(const ThreadPoolTask &) = delete;
+
+  ~ThreadPoolTask() { reset(); }
+
+  explicit operator bool() const { return MOps != nullptr; }
+
+  void operator()() { MOps->Invoke(&MStorage); }
+};
+
+template <typename FuncT>
+const ThreadPoolTask::Ops ThreadPoolTask::InlineOps<FuncT>::Table = {
+    &InlineOps<FuncT>::invoke, &InlineOps<FuncT>::move,
+    &InlineOps<FuncT>::destroy};
+
+template <typename FuncT>
+const ThreadPoolTask::Ops ThreadPoolTask::HeapOps<FuncT>::Table = {
+    &HeapOps<FuncT>::invoke, &HeapOps<FuncT>::move, &HeapOps<FuncT>::destroy};
+
+/// Thread pool with a job deque per worker. Jobs submitted from a worker go
+/// to its own deque, other jobs are spread over the deques round-robin. A
+/// worker takes the jobs from the back of its own deque and steals from the
+/// front of the deques of other workers when its own one is empty, so the
+/// submitting threads and the workers rarely contend for the same lock.
 class ThreadPool {
+  struct Worker {
+    std::mutex MMutex;
+    std::deque<ThreadPoolTask> MJobs;
+  };
+
   std::vector<std::thread> MLaunchedThreads;
+  std::vector<std::unique_ptr<Worker>> MWorkers;
 
   size_t MThreadCount;
-  std::queue<std::function<void()>> MJobQueue;
-  std::mutex MJobQueueMutex;
+  bool MPinThreads;
+  std::vector<size_t> MCores;
+  int MNiceIncrement;
+  std::atomic<size_t> MNextWorker{0};
+  // The number of jobs in the deques. Workers sleep while it is zero.
+  std::atomic<size_t> MPendingJobs{0};
+  std::atomic<size_t> MSleepingWorkers{0};
+  std::mutex MSleepMutex;
   std::condition_variable MDoSmthOrStop;
   std::atomic_bool MStop;
 
-  void worker() {
-    std::unique_lock<std::mutex> Lock(MJobQueueMutex);
+  /// \return the pool and the index of the worker running on this thread.
+  static std::pair<ThreadPool *, size_t> &currentWorker() {
+    static thread_local std::pair<ThreadPool *, size_t> Current{nullptr, 0};
+    return Current;
+  }
+
+  static void pinToCores(std::thread &Thread, const size_t *Cores,
+                         size_t NumCores) {
+#ifdef __linux__
+    cpu_set_t CPUSet;
+    CPU_ZERO(&CPUSet);
+    for (size_t I = 0; I < NumCores; ++I)
+      if (Cores[I] < CPU_SETSIZE)
+        CPU_SET(Cores[I], &CPUSet);
+    // Pinning is a performance hint only, a failure is not an error.
+    pthread_setaffinity_np(Thread.native_handle(), sizeof(cpu_set_t), &CPUSet);
+#else
+    (void)Thread;
+    (void)Cores;
+    (void)NumCores;
+#endif
+  }
 
-    while (true) {
-      MDoSmthOrStop.wait(
-          Lock, [this]() { return !MJobQueue.empty() || MStop.load(); });
+  static void renice(int Increment) {
+#ifdef __linux__
+    // The nice value is per thread on Linux. Only the privileged threads can
+    // be made less nice, a failure is not an error: it's a hint too.
+    const id_t ThreadID = static_cast<id_t>(syscall(SYS_gettid));
+    errno = 0;
+    const int Nice = getpriority(PRIO_PROCESS, ThreadID);
+    if (errno == 0)
+      setpriority(PRIO_PROCESS, ThreadID, Nice + Increment);
+#else
+    (void)Increment;
+#endif
+  }
 
-      if (MStop.load())
-        break;
+  bool popJob(size_t Idx, ThreadPoolTask &Job) {
+    Worker &W = *MWorkers[Idx];
+    std::lock_guard<std::mutex> Lock(W.MMutex);
+    if (W.MJobs.empty())
+      return false;
+    Job = std::move(W.MJobs.back());
+    W.MJobs.pop_back();
+    return true;
+  }
+
+  bool stealJob(size_t Idx, ThreadPoolTask &Job) {
+    for (size_t Offset = 1; Offset < MWorkers.size(); ++Offset) {
+      Worker &Victim = *MWorkers[(Idx + Offset) % MWorkers.size()];
+      std::unique_lock<std::mutex> Lock(Victim.MMutex, std::try_to_lock);
+      if (!Lock.owns_lock() || Victim.MJobs.empty())
+        continue;
+      Job = std::move(Victim.MJobs.front());
+      Victim.MJobs.pop_front();
+      return true;
+    }
+    return false;
+  }
 
-      std::function<void()> Job = std::move(MJobQueue.front());
-      MJobQueue.pop();
-      Lock.unlock();
+  void worker(size_t Idx) {
+    currentWorker() = std::make_pair(this, Idx);
+    if (MNiceIncrement)
+      renice(MNiceIncrement);
+
+    while (!MStop.load()) {
+      ThreadPoolTask Job;
+      if (popJob(Idx, Job) || stealJob(Idx, Job)) {
+        MPendingJobs.fetch_sub(1);
+        Job();
+        continue;
+      }
+
+      std::unique_lock<std::mutex> Lock(MSleepMutex);
+      // Pairs with the check in enqueue: either the submitting thread sees
+      // this worker sleeping or the worker sees the new job.
+      MSleepingWorkers.fetch_add(1);
+      MDoSmthOrStop.wait(
+          Lock, [this]() { return MPendingJobs.load() > 0 || MStop.load(); });
+      MSleepingWorkers.fetch_sub(1);
+    }
+  }
 
-      Job();
+  void enqueue(ThreadPoolTask &&Job) {
+    const std::pair<ThreadPool *, size_t> &Current = currentWorker();
+    size_t Idx = Current.first == this
+                     ? Current.second
+                     : MNextWorker.fetch_add(1, std::memory_order_relaxed) %
+                           MWorkers.size();
+    {
+      Worker &W = *MWorkers[Idx];
+      std::lock_guard<std::mutex> Lock(W.MMutex);
+      W.MJobs.push_back(std::move(Job));
+    }
 
-      Lock.lock();
+    MPendingJobs.fetch_add(1);
+    if (MSleepingWorkers.load() > 0) {
+      // The lock makes sure the sleeping worker is already waiting.
+      { std::lock_guard<std::mutex> Lock(MSleepMutex); }
+      MDoSmthOrStop.notify_one();
     }
   }
 
 public:
-  ThreadPool(unsigned int ThreadCount = 1) : MThreadCount(ThreadCount) {}
+  /// \param ThreadCount is the number of worker threads.
+  /// \param PinThreads makes the workers pinned to the host cores, one
+  /// worker per core. Pinning is only supported on Linux.
+  /// \param NiceIncrement is added to the nice value of the workers, so that
+  /// the host scheduler prefers the other threads if it is positive. It is
+  /// only supported on Linux.
+  /// \param Cores are the host cores the workers are kept on, e.g. the ones of
+  /// the NUMA node of a device, all of them if empty. Workers pinned with
+  /// PinThreads are pinned to these cores. It is only supported on Linux.
+  ThreadPool(unsigned int ThreadCount = 1, bool PinThreads = false,
+             int NiceIncrement = 0, std::vector<size_t> Cores = {})
+      : MThreadCount(ThreadCount), MPinThreads(PinThreads),
+        MCores(std::move(Cores)), MNiceIncrement(NiceIncrement) {
+    MWorkers.reserve(std::max<size_t>(MThreadCount, 1));
+    for (size_t Idx = 0; Idx < std::max<size_t>(MThreadCount, 1); ++Idx)
+      MWorkers.emplace_back(new Worker());
+  }
 
   ~ThreadPool() { finishAndWait(); }
 
@@ -61,36 +302,90 @@ public:
 
     MStop.store(false);
 
-    for (size_t Idx = 0; Idx < MThreadCount; ++Idx)
-      MLaunchedThreads.emplace_back([this] { worker(); });
+    const size_t CoreCount = std::max(std::thread::hardware_concurrency(), 1u);
+    for (size_t Idx = 0; Idx < MThreadCount; ++Idx) {
+      MLaunchedThreads.emplace_back([this, Idx] { worker(Idx); });
+      if (MPinThreads && !MCores.empty()) {
+        pinToCores(MLaunchedThreads.back(), &MCores[Idx % MCores.size()], 1);
+      } else if (MPinThreads) {
+        const size_t Core = Idx % CoreCount;
+        pinToCores(MLaunchedThreads.back(), &Core, 1);
+      } else if (!MCores.empty()) {
+        pinToCores(MLaunchedThreads.back(), MCores.data(), MCores.size());
+      }
+    }
   }
 
   void finishAndWait() {
     MStop.store(true);
 
-    MDoSmthOrStop.notify_all();
+    {
+      std::lock_guard<std::mutex> Lock(MSleepMutex);
+      MDoSmthOrStop.notify_all();
+    }
 
     for (std::thread &Thread : MLaunchedThreads)
       if (Thread.joinable())
         Thread.join();
   }
 
-  template <typename T> void submit(T &&Func) {
-    {
-      std::lock_guard<std::mutex> Lock(MJobQueueMutex);
-      MJobQueue.emplace([F = std::move(Func)]() { F(); });
-    }
+  /// \return the number of worker threads.
+  size_t getThreadCount() const { return MThreadCount; }
 
-    MDoSmthOrStop.notify_one();
+  template <typename T> void submit(T &&Func) {
+    enqueue(ThreadPoolTask(std::forward<T>(Func)));
   }
 
-  void submit(std::function<void()> &&Func) {
-    {
-      std::lock_guard<std::mutex> Lock(MJobQueueMutex);
-      MJobQueue.emplace(Func);
+  /// Runs Task(Idx) for every Idx in [0, Count) and waits for all of them to
+  /// finish. The calling thread executes tasks too, so the call never waits
+  /// for a free worker and can be nested in a job of the same pool. The first
+  /// exception thrown by a task is rethrown once all tasks are finished.
+  template <typename T> void parallelFor(size_t Count, T &&Task) {
+    if (Count <= 1) {
+      if (Count)
+        Task(0);
+      return;
     }
 
-    MDoSmthOrStop.notify_one();
+    // Jobs may be picked up by the workers after the call has returned, so
+    // the state they share with the caller is reference counted. Such late
+    // jobs find no task to run and never touch Task.
+    struct SharedState {
+      std::atomic<size_t> MNextIdx{0};
+      size_t MDoneCount = 0;
+      std::exception_ptr MError;
+      std::mutex MMutex;
+      std::condition_variable MFinished;
+    };
+    std::shared_ptr<SharedState> State = std::make_shared<SharedState>();
+
+    auto RunTasks = [Count, TaskPtr = &Task](SharedState &S) {
+      size_t Idx;
+      while ((Idx = S.MNextIdx.fetch_add(1)) < Count) {
+        std::exception_ptr Error;
+        try {
+          (*TaskPtr)(Idx);
+        } catch (...) {
+          Error = std::current_exception();
+        }
+        std::lock_guard<std::mutex> Lock(S.MMutex);
+        if (Error && !S.MError)
+          S.MError = Error;
+        if (++S.MDoneCount == Count)
+          S.MFinished.notify_all();
+      }
+    };
+
+    for (size_t Idx = 1; Idx < std::min(Count, MThreadCount + 1); ++Idx)
+      submit([State, RunTasks]() { RunTasks(*State); });
+
+    RunTasks(*State);
+
+    std::unique_lock<std::mutex> Lock(State->MMutex);
+    State->MFinished.wait(
+        Lock, [&State, Count]() { return State->MDoneCount == Count; });
+    if (State->MError)
+      std::rethrow_exception(State->MError);
   }
 };
 
@@ -0,0 +1,125 @@
+//==------------ usm_host_pool.cpp - Pool of USM host blocks ---*- C++ -*---==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/config.hpp>
+#include <detail/plugin.hpp>
+#include <detail/usm/usm_host_pool.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+
+static size_t getCapacityConfig() {
+  const char *ValStr = SYCLConfig<SYCL_USM_HOST_POOL_SIZE>::get();
+  if (!ValStr)
+    return 0;
+  return static_cast<size_t>(std::strtoull(ValStr, nullptr, 10));
+}
+
+USMHostPool::USMHostPool() : MCapacity(getCapacityConfig()) {}
+
+size_t USMHostPool::getSizeClass(size_t Size) {
+  size_t Class = 0;
+  while (getBlockSize(Class) < Size)
+    ++Class;
+  return Class;
+}
+
+bool USMHostPool::isPoolable(size_t Size, size_t Alignment) const {
+  if (!isEnabled() || Size == 0 || Size > MaxBlockSize)
+    return false;
+  // Alignment of a block grows with its size, so a larger alignment is
+  // satisfied by picking a larger block as long as it isn't too wasteful.
+  if (Alignment > MaxBlockAlignment || (Alignment & (Alignment - 1)) != 0)
+    return false;
+  // Blocks which can never be cached are not worth rounding up.
+  return getBlockSize(getSizeClass(std::max(Size, Alignment))) <= MCapacity;
+}
+
+void *USMHostPool::allocate(const plugin &Plugin, RT::PiContext Context,
+                            size_t Size, size_t Alignment) {
+  const size_t Class = getSizeClass(std::max(Size, Alignment));
+  {
+    std::lock_guard<std::mutex> Lock(MMutex);
+    std::vector<void *> &FreeList = MFreeLists[Class];
+    if (!FreeList.empty()) {
+      void *Ptr = FreeList.back();
+      FreeList.pop_back();
+      MCachedSize -= getBlockSize(Class);
+      return Ptr;
+    }
+  }
+
+  // Allocate outside of the lock: the driver call is the slow part and other
+  // threads may be served from the cache meanwhile.
+  const size_t BlockSize = getBlockSize(Class);
+  void *Ptr = nullptr;
+  RT::PiResult Error = Plugin.call_nocheck<PiApiKind::piextUSMHostAlloc>(
+      &Ptr, Context, nullptr, BlockSize,
+      std::min(BlockSize, MaxBlockAlignment));
+  if (Error != PI_SUCCESS)
+    return nullptr;
+
+  std::lock_guard<std::mutex> Lock(MMutex);
+  MBlocks.emplace(Ptr, Class);
+  return Ptr;
+}
+
+bool USMHostPool::deallocate(const plugin &Plugin, RT::PiContext Context,
+                             void *Ptr) {
+  if (!isEnabled())
+    return false;
+  {
+    std::lock_guard<std::mutex> Lock(MMutex);
+    auto It = MBlocks.find(Ptr);
+    if (It == MBlocks.end())
+      return false;
+
+    const size_t Class = It->second;
+    const size_t BlockSize = getBlockSize(Class);
+    if (MCachedSize + BlockSize <= MCapacity) {
+      MFreeLists[Class].push_back(Ptr);
+      MCachedSize += BlockSize;
+      return true;
+    }
+    MBlocks.erase(It);
+  }
+
+  Plugin.call<PiApiKind::piextUSMFree>(Context, Ptr);
+  return true;
+}
+
+void USMHostPool::trim(const plugin &Plugin, RT::PiContext Context) {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  for (std::vector<void *> &FreeList : MFreeLists) {
+    for (void *Ptr : FreeList) {
+      Plugin.call<PiApiKind::piextUSMFree>(Context, Ptr);
+      MBlocks.erase(Ptr);
+    }
+    FreeList.clear();
+  }
+  MCachedSize = 0;
+}
+
+void USMHostPool::release(const plugin &Plugin, RT::PiContext Context) {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  for (std::vector<void *> &FreeList : MFreeLists) {
+    for (void *Ptr : FreeList)
+      Plugin.call<PiApiKind::piextUSMFree>(Context, Ptr);
+    FreeList.clear();
+  }
+  MBlocks.clear();
+  MCachedSize = 0;
+}
+
+} // namespace detail
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -0,0 +1,107 @@
+//==------------ usm_host_pool.hpp - Pool of USM host blocks ---*- C++ -*---==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl/detail/defines.hpp>
+#include <CL/sycl/detail/pi.hpp>
+
+#include <array>
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+
+class plugin;
+
+/// Cache of USM host allocations of a context.
+///
+/// Pinned host memory is expensive to allocate and to free, so applications
+/// which repeatedly call sycl::malloc_host and sycl::free for staging buffers
+/// spend a lot of time in the driver. The pool rounds the requested sizes up to
+/// a power of two and keeps the blocks freed by sycl::free in a free list of
+/// their size class, so that the next request of the same class is served
+/// without calling the plugin.
+///
+/// Only pointers returned by allocate are ever cached: any other pointer passed
+/// to deallocate is left to the caller. The total size of the cached blocks is
+/// bounded by the capacity of the pool, the blocks which don't fit are freed
+/// immediately. A pool with zero capacity is disabled.
+class USMHostPool {
+public:
+  /// Smallest block which is handed out by the pool.
+  static constexpr size_t MinBlockSize = 64;
+  /// Largest block which is handed out by the pool.
+  static constexpr size_t MaxBlockSize = 64 * 1024 * 1024;
+  /// Blocks are aligned to their size but no more than this.
+  static constexpr size_t MaxBlockAlignment = 4096;
+
+  /// Constructs the pool with the capacity set by SYCL_USM_HOST_POOL_SIZE.
+  USMHostPool();
+  explicit USMHostPool(size_t Capacity) : MCapacity(Capacity) {}
+  USMHostPool(const USMHostPool &) = delete;
+  USMHostPool &operator=(const USMHostPool &) = delete;
+
+  bool isEnabled() const { return MCapacity != 0; }
+
+  /// Returns true if a request with the given size and alignment is served
+  /// from the pool.
+  bool isPoolable(size_t Size, size_t Alignment) const;
+
+  /// Returns a block of at least \p Size bytes aligned to \p Alignment either
+  /// from the cache or from piextUSMHostAlloc. Returns nullptr if the plugin
+  /// fails to allocate the block.
+  ///
+  /// \param Size and \p Alignment must satisfy isPoolable.
+  void *allocate(const plugin &Plugin, RT::PiContext Context, size_t Size,
+                 size_t Alignment);
+
+  /// Puts \p Ptr back to the cache if it has been returned by allocate.
+  ///
+  /// \return false if \p Ptr doesn't belong to the pool and must be freed by
+  /// the caller.
+  bool deallocate(const plugin &Plugin, RT::PiContext Context, void *Ptr);
+
+  /// Frees the cached blocks, keeping track of the blocks which are in use.
+  void trim(const plugin &Plugin, RT::PiContext Context);
+
+  /// Frees all cached blocks. Blocks which are still in use are forgotten, they
+  /// are released together with the context.
+  void release(const plugin &Plugin, RT::PiContext Context);
+
+  /// Returns the total size of the blocks kept in the cache.
+  size_t getCachedSize() const {
+    std::lock_guard<std::mutex> Lock(MMutex);
+    return MCachedSize;
+  }
+
+private:
+  /// Power of two sizes from MinBlockSize to MaxBlockSize.
+  static constexpr size_t NumSizeClasses = 21;
+  static_assert((MinBlockSize << (NumSizeClasses - 1)) == MaxBlockSize,
+                "Size classes must cover all poolable sizes");
+
+  static size_t getSizeClass(size_t Size);
+  static size_t getBlockSize(size_t Class) { return MinBlockSize << Class; }
+
+  const size_t MCapacity;
+  mutable std::mutex MMutex;
+  /// Free blocks of every size class.
+  std::array<std::vector<void *>, NumSizeClasses> MFreeLists;
+  /// Size class of every block allocated by the pool, both free and in use.
+  std::unordered_map<void *, size_t> MBlocks;
+  size_t MCachedSize = 0;
+};
+
+} // namespace detail
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -6,6 +6,7 @@
 //
 // ===--------------------------------------------------------------------=== //
 
+#include <CL/sycl/ONEAPI/distributed_usm.hpp>
 #include <CL/sycl/context.hpp>
 #include <CL/sycl/detail/aligned_allocator.hpp>
 #include <CL/sycl/detail/os_util.hpp>
@@ -47,9 +48,17 @@ void *alignedAllocHost(size_t Alignment, size_t Size, const context &Ctxt,
     pi_context C = CtxImpl->getHandleRef();
     const detail::plugin &Plugin = CtxImpl->getPlugin();
     pi_result Error;
+    if (!CtxImpl->reserveMemory(Size))
+      return nullptr;
 
     switch (Kind) {
     case alloc::host: {
+      USMHostPool &Pool = CtxImpl->getUSMHostPool();
+      if (Pool.isPoolable(Size, Alignment)) {
+        RetVal = Pool.allocate(Plugin, C, Size, Alignment);
+        Error = RetVal ? PI_SUCCESS : PI_OUT_OF_HOST_MEMORY;
+        break;
+      }
       Error = Plugin.call_nocheck<PiApiKind::piextUSMHostAlloc>(
           &RetVal, C, nullptr, Size, Alignment);
       break;
@@ -67,6 +76,8 @@ void *alignedAllocHost(size_t Alignment, size_t Size, const context &Ctxt,
     // The spec wants a nullptr returned, not an exception.
     if (Error != PI_SUCCESS)
       return nullptr;
+    CtxImpl->getMemoryUsage().recordAllocation(
+        RetVal, MemoryUsageTracker::Category::USMHost, Size);
   }
   return RetVal;
 }
@@ -99,6 +110,8 @@ void *alignedAlloc(size_t Alignment, size_t Size, const context &Ctxt,
     const detail::plugin &Plugin = CtxImpl->getPlugin();
     pi_result Error;
     pi_device Id;
+    if (!CtxImpl->reserveMemory(Size))
+      return nullptr;
 
     switch (Kind) {
     case alloc::device: {
@@ -125,6 +138,11 @@ void *alignedAlloc(size_t Alignment, size_t Size, const context &Ctxt,
     // The spec wants a nullptr returned, not an exception.
     if (Error != PI_SUCCESS)
       return nullptr;
+    CtxImpl->getMemoryUsage().recordAllocation(
+        RetVal,
+        Kind == alloc::device ? MemoryUsageTracker::Category::USMDevice
+                              : MemoryUsageTracker::Category::USMShared,
+        Size);
   }
   return RetVal;
 }
@@ -139,6 +157,10 @@ void free(void *Ptr, const context &Ctxt) {
     std::shared_ptr<context_impl> CtxImpl = detail::getSyclObjImpl(Ctxt);
     pi_context C = CtxImpl->getHandleRef();
     const detail::plugin &Plugin = CtxImpl->getPlugin();
+    CtxImpl->getMemoryUsage().recordRelease(Ptr);
+    // Host blocks taken from the pool go back to it instead of the plugin.
+    if (CtxImpl->getUSMHostPool().deallocate(Plugin, C, Ptr))
+      return;
     Plugin.call<PiApiKind::piextUSMFree>(C, Ptr);
   }
 }
@@ -335,5 +357,41 @@ device get_pointer_device(const void *Ptr, const context &Ctxt) {
                       PI_INVALID_OPERATION);
 }
 
+namespace ONEAPI {
+void *malloc_shared_distributed(size_t Size, const context &Ctxt,
+                                size_t StripeSize) {
+  std::shared_ptr<sycl::detail::context_impl> CtxImpl =
+      sycl::detail::getSyclObjImpl(Ctxt);
+  const vector_class<device> &Devs = CtxImpl->getDevices();
+  if (Devs.empty())
+    return nullptr;
+  const sycl::detail::plugin &Plugin = CtxImpl->getPlugin();
+  // Only the Level Zero plugin places the stripes
+  if (Ctxt.is_host() || Devs.size() == 1 || StripeSize == 0 ||
+      Plugin.getBackend() != backend::level_zero)
+    return malloc_shared(Size, Devs[0], Ctxt);
+  if (Size == 0)
+    return nullptr;
+
+  pi_usm_mem_properties Properties[] = {
+      PI_EXT_ONEAPI_MEM_ALLOC_STRIPE_SIZE,
+      static_cast<pi_usm_mem_properties>(StripeSize),
+      static_cast<pi_usm_mem_properties>(0)};
+  if (!CtxImpl->reserveMemory(Size))
+    return nullptr;
+  void *RetVal = nullptr;
+  pi_device Id = sycl::detail::getSyclObjImpl(Devs[0])->getHandleRef();
+  pi_result Error =
+      Plugin.call_nocheck<sycl::detail::PiApiKind::piextUSMSharedAlloc>(
+          &RetVal, CtxImpl->getHandleRef(), Id, Properties, Size, 0);
+  // The spec wants a nullptr returned, not an exception.
+  if (Error != PI_SUCCESS)
+    return nullptr;
+  CtxImpl->getMemoryUsage().recordAllocation(
+      RetVal, sycl::detail::MemoryUsageTracker::Category::USMShared, Size);
+  return RetVal;
+}
+} // namespace ONEAPI
+
 } // namespace sycl
 } // __SYCL_INLINE_NAMESPACE(cl)
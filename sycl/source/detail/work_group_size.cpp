@@ -0,0 +1,232 @@
+//==-- work_group_size.cpp - Local size selection of range kernels ---------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/device_impl.hpp>
+#include <detail/plugin.hpp>
+#include <detail/work_group_size.hpp>
+
+#include <algorithm>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+
+/// The most local sizes the autotuner tries for a launch, the choice of the
+/// driver included.
+static constexpr size_t MaxLocalSizeCandidates = 8;
+
+KernelWorkGroupLimits getKernelWorkGroupLimits(RT::PiKernel Kernel,
+                                               const device_impl &Device) {
+  const plugin &Plugin = Device.getPlugin();
+  RT::PiDevice Dev = Device.getHandleRef();
+  KernelWorkGroupLimits Limits;
+
+  size_t RequiredSize[3] = {0, 0, 0};
+  if (Plugin.call_nocheck<PiApiKind::piKernelGetGroupInfo>(
+          Kernel, Dev, PI_KERNEL_GROUP_INFO_COMPILE_WORK_GROUP_SIZE,
+          sizeof(RequiredSize), RequiredSize, nullptr) == PI_SUCCESS &&
+      RequiredSize[0] != 0) {
+    Limits.HasRequiredSize = true;
+    return Limits;
+  }
+
+  size_t KernelMaxSize = 0;
+  Plugin.call_nocheck<PiApiKind::piKernelGetGroupInfo>(
+      Kernel, Dev, PI_KERNEL_GROUP_INFO_WORK_GROUP_SIZE, sizeof(KernelMaxSize),
+      &KernelMaxSize, nullptr);
+  const size_t DeviceMaxSize =
+      Device.get_info<info::device::max_work_group_size>();
+  Limits.MaxSize = KernelMaxSize == 0
+                       ? DeviceMaxSize
+                       : std::min(KernelMaxSize, DeviceMaxSize);
+
+  size_t PreferredMultiple = 0;
+  Plugin.call_nocheck<PiApiKind::piKernelGetGroupInfo>(
+      Kernel, Dev, PI_KERNEL_GROUP_INFO_PREFERRED_WORK_GROUP_SIZE_MULTIPLE,
+      sizeof(PreferredMultiple), &PreferredMultiple, nullptr);
+  if (PreferredMultiple == 0) {
+    size_t Input[3] = {Limits.MaxSize, 1, 1};
+    uint32_t MaxSubGroupSize = 0;
+    Plugin.call_nocheck<PiApiKind::piKernelGetSubGroupInfo>(
+        Kernel, Dev, PI_KERNEL_MAX_SUB_GROUP_SIZE, sizeof(Input), Input,
+        sizeof(MaxSubGroupSize), &MaxSubGroupSize, nullptr);
+    PreferredMultiple = MaxSubGroupSize;
+  }
+  if (PreferredMultiple != 0 && PreferredMultiple <= Limits.MaxSize)
+    Limits.PreferredMultiple = PreferredMultiple;
+
+  // The device info is in the order of the SYCL dimensions.
+  const id<3> MaxItemSizes =
+      Device.get_info<info::device::max_work_item_sizes>();
+  Limits.MaxItemSizes = {MaxItemSizes[2], MaxItemSizes[1], MaxItemSizes[0]};
+  Limits.ComputeUnits = std::max<size_t>(
+      1, Device.get_info<info::device::max_compute_units>());
+  return Limits;
+}
+
+/// Selects the local size with the largest product not above \p Budget, see
+/// selectLocalSize().
+///
+/// \return the product of the local size, zero if there is none.
+static size_t selectLocalSizeWithin(const KernelWorkGroupLimits &Limits,
+                                    int Dims, const WorkSizeT &GlobalSize,
+                                    size_t Budget, WorkSizeT &LocalSize) {
+  // The divisors of the global sizes, the largest first, so that the first
+  // one of the local sizes with the same product has the largest innermost
+  // dimension.
+  std::array<std::vector<size_t>, 3> Divisors;
+  for (int D = 0; D < 3; ++D) {
+    if (D >= Dims) {
+      Divisors[D].push_back(1);
+      continue;
+    }
+    size_t Max = std::min(Budget, GlobalSize[D]);
+    if (Limits.MaxItemSizes[D] != 0)
+      Max = std::min(Max, Limits.MaxItemSizes[D]);
+    for (size_t L = Max; L >= 1; --L)
+      if (GlobalSize[D] % L == 0)
+        Divisors[D].push_back(L);
+    if (Divisors[D].empty())
+      return 0;
+  }
+
+  const size_t Multiple = Limits.PreferredMultiple;
+  size_t BestProduct = 0;
+  bool BestIsMultiple = false;
+  for (size_t L0 : Divisors[0])
+    for (size_t L1 : Divisors[1]) {
+      if (L0 * L1 > Budget)
+        continue;
+      for (size_t L2 : Divisors[2]) {
+        const size_t Product = L0 * L1 * L2;
+        if (Product > Budget)
+          continue;
+        const bool IsMultiple = Product % Multiple == 0;
+        if (IsMultiple < BestIsMultiple ||
+            (IsMultiple == BestIsMultiple && Product <= BestProduct))
+          continue;
+        BestProduct = Product;
+        BestIsMultiple = IsMultiple;
+        LocalSize = {L0, L1, L2};
+      }
+    }
+  return BestProduct;
+}
+
+bool selectLocalSize(const KernelWorkGroupLimits &Limits, int Dims,
+                     const WorkSizeT &GlobalSize, WorkSizeT &LocalSize) {
+  if (Limits.HasRequiredSize || Limits.MaxSize == 0)
+    return false;
+  size_t Total = 1;
+  for (int D = 0; D < Dims; ++D)
+    Total *= GlobalSize[D];
+  if (Total == 0)
+    return false;
+
+  // Smaller work-groups leave fewer compute units idle when the range is too
+  // small to give all of them a work-group of the largest size.
+  const size_t Multiple = Limits.PreferredMultiple;
+  size_t Budget = Limits.MaxSize;
+  while (Budget / 2 >= Multiple && Budget * Limits.ComputeUnits > Total)
+    Budget /= 2;
+
+  const size_t Product =
+      selectLocalSizeWithin(Limits, Dims, GlobalSize, Budget, LocalSize);
+  // The driver may do better with the global sizes with few divisors, e.g.
+  // by launching non-uniform work-groups.
+  return Product != 0 && (Product >= Multiple || Product == Total);
+}
+
+std::vector<WorkSizeT>
+getLocalSizeCandidates(const KernelWorkGroupLimits &Limits, int Dims,
+                       const WorkSizeT &GlobalSize) {
+  std::vector<WorkSizeT> Candidates;
+  WorkSizeT LocalSize;
+  if (selectLocalSize(Limits, Dims, GlobalSize, LocalSize))
+    Candidates.push_back(LocalSize);
+  if (!Limits.HasRequiredSize)
+    for (size_t Budget = Limits.MaxSize;
+         Budget >= Limits.PreferredMultiple &&
+         Candidates.size() + 1 < MaxLocalSizeCandidates;
+         Budget /= 2) {
+      if (selectLocalSizeWithin(Limits, Dims, GlobalSize, Budget, LocalSize) <
+          Limits.PreferredMultiple)
+        break;
+      if (std::find(Candidates.begin(), Candidates.end(), LocalSize) ==
+          Candidates.end())
+        Candidates.push_back(LocalSize);
+    }
+  Candidates.push_back(WorkSizeT{});
+  return Candidates;
+}
+
+bool KernelWorkGroupSizes::getLocalSize(WorkGroupSizePolicy Policy, int Dims,
+                                        const WorkSizeT &GlobalSize,
+                                        WorkSizeT &LocalSize,
+                                        Trial *LaunchTrial) {
+  if (Policy == WorkGroupSizePolicy::driver)
+    return false;
+
+  std::lock_guard<std::mutex> Lock(MMutex);
+  auto It = MSelections.find(GlobalSize);
+  if (It == MSelections.end()) {
+    if (MSelections.size() >= MaxSelections)
+      MSelections.clear();
+    Selection NewSelection;
+    if (Policy == WorkGroupSizePolicy::autotune) {
+      NewSelection.Candidates =
+          getLocalSizeCandidates(MLimits, Dims, GlobalSize);
+    } else {
+      WorkSizeT Selected{};
+      if (!selectLocalSize(MLimits, Dims, GlobalSize, Selected))
+        Selected = WorkSizeT{};
+      NewSelection.Candidates.push_back(Selected);
+    }
+    NewSelection.Times.assign(NewSelection.Candidates.size(), 0);
+    It = MSelections.emplace(GlobalSize, std::move(NewSelection)).first;
+  }
+
+  Selection &S = It->second;
+  size_t Candidate = S.Best;
+  if (LaunchTrial && S.Candidates.size() > 1 &&
+      S.Launches <= S.Candidates.size()) {
+    // The first launch warms up the caches and the memory of the kernel and
+    // is not timed.
+    if (S.Launches == 0) {
+      Candidate = 0;
+    } else {
+      Candidate = S.Launches - 1;
+      LaunchTrial->GlobalSize = GlobalSize;
+      LaunchTrial->Candidate = Candidate;
+      LaunchTrial->IsTimed = true;
+    }
+    ++S.Launches;
+  }
+  LocalSize = S.Candidates[Candidate];
+  return LocalSize[0] != 0;
+}
+
+void KernelWorkGroupSizes::recordTrial(const Trial &LaunchTrial,
+                                       uint64_t Nanoseconds) {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  auto It = MSelections.find(LaunchTrial.GlobalSize);
+  if (It == MSelections.end())
+    return;
+  Selection &S = It->second;
+  if (S.Times[LaunchTrial.Candidate] != 0)
+    return;
+  // A zero time would read as not recorded.
+  S.Times[LaunchTrial.Candidate] = std::max<uint64_t>(Nanoseconds, 1);
+  if (++S.NumTimed != S.Candidates.size())
+    return;
+  S.Best = std::min_element(S.Times.begin(), S.Times.end()) - S.Times.begin();
+}
+
+} // namespace detail
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -0,0 +1,144 @@
+//==-- work_group_size.hpp - Local size selection of range kernels ---------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/sycl/detail/defines.hpp>
+#include <CL/sycl/detail/pi.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+class device_impl;
+
+/// How the local size of the kernels launched without one is chosen, set by
+/// SYCL_WORK_GROUP_SIZE_POLICY.
+enum class WorkGroupSizePolicy {
+  /// The driver chooses the local size.
+  driver,
+  /// The runtime chooses the local size from the properties of the kernel and
+  /// of the device, see selectLocalSize().
+  occupancy,
+  /// The runtime times the candidate local sizes on the first launches of
+  /// each kernel with each global size and keeps the fastest one.
+  autotune
+};
+
+/// The sizes of the three dimensions of a range, in the order of the
+/// dimensions of the plugin interface, i.e. the innermost one first.
+using WorkSizeT = std::array<size_t, 3>;
+
+/// The properties of a kernel on a device which bound its local size.
+struct KernelWorkGroupLimits {
+  /// The largest work-group size the kernel can be launched with, the lesser
+  /// of the size the kernel reports, which accounts for its register and
+  /// local memory usage, and of the device maximum. Zero if unknown.
+  size_t MaxSize = 0;
+  /// The multiple the work-group sizes should be, the preferred multiple of
+  /// the kernel or its sub-group size.
+  size_t PreferredMultiple = 1;
+  /// The maximum sizes of the dimensions of a work-group, zero if unknown.
+  WorkSizeT MaxItemSizes{};
+  /// The number of compute units of the device.
+  size_t ComputeUnits = 1;
+  /// Whether the kernel has a required work-group size, which the runtime
+  /// must leave to the driver.
+  bool HasRequiredSize = false;
+};
+
+/// Queries the limits of \p Kernel on \p Device. The queries the plugin fails
+/// leave their limits unknown.
+KernelWorkGroupLimits getKernelWorkGroupLimits(RT::PiKernel Kernel,
+                                               const device_impl &Device);
+
+/// Selects the local size of a launch of \p Dims dimensions with the global
+/// size \p GlobalSize, both in the order of the plugin interface.
+///
+/// The work-group size starts at the largest one the kernel allows and is
+/// halved, down to the preferred multiple, until every compute unit gets a
+/// work-group. The local size is then the one with the largest product not
+/// above it whose dimensions divide the global ones, preferring products that
+/// are multiples of the preferred multiple, then larger innermost dimensions.
+///
+/// \return false if the driver should choose the local size, e.g. because the
+/// global size has no divisor that makes an efficient work-group.
+bool selectLocalSize(const KernelWorkGroupLimits &Limits, int Dims,
+                     const WorkSizeT &GlobalSize, WorkSizeT &LocalSize);
+
+/// \return the local sizes the autotuner tries for a launch, the one of
+/// selectLocalSize() first and the choice of the driver, as zeros, last.
+std::vector<WorkSizeT>
+getLocalSizeCandidates(const KernelWorkGroupLimits &Limits, int Dims,
+                       const WorkSizeT &GlobalSize);
+
+/// The local sizes selected for the launches of a kernel on a device, by
+/// global size. The selections are computed on the first launch with each
+/// global size and then looked up.
+class KernelWorkGroupSizes {
+public:
+  /// A launch timed by the autotuner.
+  struct Trial {
+    WorkSizeT GlobalSize{};
+    size_t Candidate = 0;
+    bool IsTimed = false;
+  };
+
+  /// The number of global sizes the selections are kept for. The selections
+  /// of a kernel launched with more global sizes are computed again.
+  static constexpr size_t MaxSelections = 64;
+
+  explicit KernelWorkGroupSizes(const KernelWorkGroupLimits &Limits)
+      : MLimits(Limits) {}
+
+  const KernelWorkGroupLimits &getLimits() const { return MLimits; }
+
+  /// Gets the local size of the next launch with \p GlobalSize.
+  ///
+  /// With the autotune policy, the first launch runs the first candidate to
+  /// warm up, the next ones run every candidate once and the fastest one is
+  /// kept for the following launches. \p LaunchTrial is marked as timed if the
+  /// launch is to be timed and reported to recordTrial(); no launch is timed
+  /// if it is null.
+  ///
+  /// \return false if the driver should choose the local size.
+  bool getLocalSize(WorkGroupSizePolicy Policy, int Dims,
+                    const WorkSizeT &GlobalSize, WorkSizeT &LocalSize,
+                    Trial *LaunchTrial);
+
+  /// Records the time a launch reported by getLocalSize() took.
+  void recordTrial(const Trial &LaunchTrial, uint64_t Nanoseconds);
+
+private:
+  struct Selection {
+    std::vector<WorkSizeT> Candidates;
+    /// The times of the candidates, zero until they are recorded.
+    std::vector<uint64_t> Times;
+    /// The number of launches made, the warm-up included.
+    size_t Launches = 0;
+    size_t NumTimed = 0;
+    size_t Best = 0;
+  };
+
+  const KernelWorkGroupLimits MLimits;
+  std::mutex MMutex;
+  std::map<WorkSizeT, Selection> MSelections;
+};
+
+using KernelWorkGroupSizesPtr = std::shared_ptr<KernelWorkGroupSizes>;
+
+} // namespace detail
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
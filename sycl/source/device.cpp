@@ -12,7 +12,9 @@
 #include <CL/sycl/info/info_desc.hpp>
 #include <detail/config.hpp>
 #include <detail/device_impl.hpp>
+#include <detail/device_selection_cache.hpp>
 #include <detail/force_device.hpp>
+#include <detail/global_handler.hpp>
 
 __SYCL_INLINE_NAMESPACE(cl) {
 namespace sycl {
@@ -42,7 +44,7 @@ device::device(const device_selector &deviceSelector) {
   *this = deviceSelector.select_device();
 }
 
-vector_class<device> device::get_devices(info::device_type deviceType) {
+static vector_class<device> enumerateDevices(info::device_type deviceType) {
   vector_class<device> devices;
   // Host device availability should not depend on the forced type
   const bool includeHost =
@@ -77,6 +79,15 @@ vector_class<device> device::get_devices(info::device_type deviceType) {
   return devices;
 }
 
+vector_class<device> device::get_devices(info::device_type deviceType) {
+  // The devices of the platforms don't change, nor does the configuration
+  // filtering them, so they are only enumerated once per device type.
+  return detail::GlobalHandler::instance()
+      .getDeviceSelectionCache()
+      .getDevices(deviceType,
+                  [deviceType] { return enumerateDevices(deviceType); });
+}
+
 cl_device_id device::get() const { return impl->get(); }
 
 bool device::is_host() const { return impl->is_host(); }
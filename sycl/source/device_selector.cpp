@@ -15,6 +15,7 @@
 #include <CL/sycl/stl.hpp>
 #include <detail/config.hpp>
 #include <detail/device_impl.hpp>
+#include <detail/device_selection_cache.hpp>
 #include <detail/filter_selector_impl.hpp>
 #include <detail/force_device.hpp>
 #include <detail/global_handler.hpp>
@@ -23,6 +24,7 @@
 #include <algorithm>
 #include <cctype>
 #include <regex>
+#include <typeinfo>
 
 __SYCL_INLINE_NAMESPACE(cl) {
 namespace sycl {
@@ -62,67 +64,98 @@ static bool isForcedDevice(const device &Dev, int Index = -1) {
   return false;
 }
 
-device device_selector::select_device() const {
-  vector_class<device> devices = device::get_devices();
-  int score = REJECT_DEVICE_SCORE;
-  const device *res = nullptr;
-
-  for (const auto &dev : devices) {
-    int dev_score = (*this)(dev);
-
-    if (detail::pi::trace(detail::pi::TraceLevel::PI_TRACE_ALL)) {
-      string_class PlatformName = dev.get_info<info::device::platform>()
-                                      .get_info<info::platform::name>();
-      string_class DeviceName = dev.get_info<info::device::name>();
-      std::cout << "SYCL_PI_TRACE[all]: "
-                << "select_device(): -> score = " << dev_score
-                << ((dev_score < 0) ? " (REJECTED)" : "") << std::endl
-                << "SYCL_PI_TRACE[all]: "
-                << "  platform: " << PlatformName << std::endl
-                << "SYCL_PI_TRACE[all]: "
-                << "  device: " << DeviceName << std::endl;
-    }
+/// \return true if the devices chosen by selectors may be cached, which they
+/// are not when the traces show how the devices are scored each time.
+static bool isSelectionCacheEnabled() {
+  return !detail::pi::trace(detail::pi::TraceLevel::PI_TRACE_BASIC) &&
+         !detail::pi::trace(detail::pi::TraceLevel::PI_TRACE_ALL);
+}
 
-    // A negative score means that a device must not be selected.
-    if (dev_score < 0)
-      continue;
+/// \return the key of the device chosen by Selector in the selection cache,
+/// or an empty string if its choice is not cached.
+static string_class getSelectionCacheKey(const device_selector &Selector) {
+  if (!isSelectionCacheEnabled())
+    return {};
+  // The built-in selectors choose among the same devices for the same
+  // configuration every time. Their subclasses may not.
+  const std::type_info &Type = typeid(Selector);
+  if (Type == typeid(default_selector) || Type == typeid(gpu_selector) ||
+      Type == typeid(cpu_selector) || Type == typeid(accelerator_selector) ||
+      Type == typeid(host_selector))
+    return Type.name();
+  return {};
+}
 
-    // If SYCL_DEVICE_FILTER is set, give a bonus point for the device
-    // whose index matches with desired device number.
-    int index = &dev - &devices[0];
-    if (isForcedDevice(dev, index)) {
-      dev_score += 1000;
+device device_selector::select_device() const {
+  auto Select = [this]() -> device {
+    vector_class<device> devices = device::get_devices();
+    int score = REJECT_DEVICE_SCORE;
+    const device *res = nullptr;
+
+    for (const auto &dev : devices) {
+      int dev_score = (*this)(dev);
+
+      if (detail::pi::trace(detail::pi::TraceLevel::PI_TRACE_ALL)) {
+        string_class PlatformName = dev.get_info<info::device::platform>()
+                                        .get_info<info::platform::name>();
+        string_class DeviceName = dev.get_info<info::device::name>();
+        std::cout << "SYCL_PI_TRACE[all]: "
+                  << "select_device(): -> score = " << dev_score
+                  << ((dev_score < 0) ? " (REJECTED)" : "") << std::endl
+                  << "SYCL_PI_TRACE[all]: "
+                  << "  platform: " << PlatformName << std::endl
+                  << "SYCL_PI_TRACE[all]: "
+                  << "  device: " << DeviceName << std::endl;
+      }
+
+      // A negative score means that a device must not be selected.
+      if (dev_score < 0)
+        continue;
+
+      // If SYCL_DEVICE_FILTER is set, give a bonus point for the device
+      // whose index matches with desired device number.
+      int index = &dev - &devices[0];
+      if (isForcedDevice(dev, index)) {
+        dev_score += 1000;
+      }
+
+      // SYCL spec says: "If more than one device receives the high score then
+      // one of those tied devices will be returned, but which of the devices
+      // from the tied set is to be returned is not defined". Here we give a
+      // preference to the device of the preferred BE.
+      //
+      if ((score < dev_score) ||
+          (score == dev_score && isDeviceOfPreferredSyclBe(dev))) {
+        res = &dev;
+        score = dev_score;
+      }
     }
 
-    // SYCL spec says: "If more than one device receives the high score then
-    // one of those tied devices will be returned, but which of the devices
-    // from the tied set is to be returned is not defined". Here we give a
-    // preference to the device of the preferred BE.
-    //
-    if ((score < dev_score) ||
-        (score == dev_score && isDeviceOfPreferredSyclBe(dev))) {
-      res = &dev;
-      score = dev_score;
+    if (res != nullptr) {
+      if (detail::pi::trace(detail::pi::TraceLevel::PI_TRACE_BASIC)) {
+        string_class PlatformName = res->get_info<info::device::platform>()
+                                        .get_info<info::platform::name>();
+        string_class DeviceName = res->get_info<info::device::name>();
+        std::cout << "SYCL_PI_TRACE[all]: "
+                  << "Selected device ->" << std::endl
+                  << "SYCL_PI_TRACE[all]: "
+                  << "  platform: " << PlatformName << std::endl
+                  << "SYCL_PI_TRACE[all]: "
+                  << "  device: " << DeviceName << std::endl;
+      }
+      return *res;
     }
-  }
 
-  if (res != nullptr) {
-    if (detail::pi::trace(detail::pi::TraceLevel::PI_TRACE_BASIC)) {
-      string_class PlatformName = res->get_info<info::device::platform>()
-                                      .get_info<info::platform::name>();
-      string_class DeviceName = res->get_info<info::device::name>();
-      std::cout << "SYCL_PI_TRACE[all]: "
-                << "Selected device ->" << std::endl
-                << "SYCL_PI_TRACE[all]: "
-                << "  platform: " << PlatformName << std::endl
-                << "SYCL_PI_TRACE[all]: "
-                << "  device: " << DeviceName << std::endl;
-    }
-    return *res;
-  }
+    throw cl::sycl::runtime_error("No device of requested type available.",
+                                  PI_DEVICE_NOT_FOUND);
+  };
 
-  throw cl::sycl::runtime_error("No device of requested type available.",
-                                PI_DEVICE_NOT_FOUND);
+  string_class CacheKey = getSelectionCacheKey(*this);
+  if (CacheKey.empty())
+    return Select();
+  return detail::GlobalHandler::instance()
+      .getDeviceSelectionCache()
+      .getSelectedDevice(CacheKey, Select);
 }
 
 /// Devices of different kinds are prioritized in the following order:
@@ -254,11 +287,21 @@ device filter_selector::select_device() const {
   std::lock_guard<std::mutex> Guard(
       sycl::detail::GlobalHandler::instance().getFilterMutex());
 
-  device Result = device_selector::select_device();
+  auto Select = [this] {
+    device Result = device_selector::select_device();
+
+    reset();
 
-  reset();
+    return Result;
+  };
 
-  return Result;
+  // The choice only depends on the filter string, as the ranker is the
+  // default selector.
+  if (!isSelectionCacheEnabled())
+    return Select();
+  return sycl::detail::GlobalHandler::instance()
+      .getDeviceSelectionCache()
+      .getSelectedDevice("filter_selector:" + impl->getFilter(), Select);
 }
 
 } // namespace ONEAPI
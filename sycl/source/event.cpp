@@ -21,11 +21,11 @@
 __SYCL_INLINE_NAMESPACE(cl) {
 namespace sycl {
 
-event::event() : impl(std::make_shared<detail::event_impl>()) {}
+event::event() : impl(detail::makeEventImpl()) {}
 
 event::event(cl_event ClEvent, const context &SyclContext)
-    : impl(std::make_shared<detail::event_impl>(
-          detail::pi::cast<RT::PiEvent>(ClEvent), SyclContext)) {}
+    : impl(detail::makeEventImpl(detail::pi::cast<RT::PiEvent>(ClEvent),
+                                 SyclContext)) {}
 
 bool event::operator==(const event &rhs) const { return rhs.impl == impl; }
 
@@ -38,9 +38,11 @@ bool event::is_host() const { return impl->is_host(); }
 void event::wait() { impl->wait(impl); }
 
 void event::wait(const vector_class<event> &EventList) {
-  for (auto E : EventList) {
-    E.wait();
-  }
+  vector_class<detail::EventImplPtr> EventImpls;
+  EventImpls.reserve(EventList.size());
+  for (const event &E : EventList)
+    EventImpls.push_back(detail::getSyclObjImpl(E));
+  detail::event_impl::waitAll(EventImpls);
 }
 
 void event::wait_and_throw() { impl->wait_and_throw(impl); }
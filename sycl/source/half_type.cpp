@@ -6,109 +6,24 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <CL/sycl/ONEAPI/half_conversions.hpp>
 #include <CL/sycl/half_type.hpp>
-// This is included to enable __builtin_expect()
 #include <detail/platform_util.hpp>
 
-#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
 
 __SYCL_INLINE_NAMESPACE(cl) {
 namespace sycl {
 namespace detail {
 
-static uint16_t float2Half(const float &Val) {
-  const uint32_t Bits = *reinterpret_cast<const uint32_t *>(&Val);
-
-  // Extract the sign from the float value
-  const uint16_t Sign = (Bits & 0x80000000) >> 16;
-  // Extract the fraction from the float value
-  const uint32_t Frac32 = Bits & 0x7fffff;
-  // Extract the exponent from the float value
-  const uint8_t Exp32 = (Bits & 0x7f800000) >> 23;
-  const int16_t Exp32Diff = Exp32 - 127;
-
-  // intialize to 0, covers the case for 0 and small numbers
-  uint16_t Exp16 = 0, Frac16 = 0;
-
-  if (__builtin_expect(Exp32Diff > 15, 0)) {
-    // Infinity and big numbers convert to infinity
-    Exp16 = 0x1f;
-  } else if (__builtin_expect(Exp32Diff > -14, 0)) {
-    // normal range for half type
-    Exp16 = Exp32Diff + 15;
-    // convert 23-bit mantissa to 10-bit mantissa.
-    Frac16 = Frac32 >> 13;
-    // Round the mantissa as given in OpenCL spec section : 6.1.1.1 The half
-    // data type.
-    if (Frac32 >> 12 & 0x01)
-      Frac16 += 1;
-  } else if (__builtin_expect(Exp32Diff > -24, 0)) {
-    // subnormals
-    Frac16 = (Frac32 | (uint32_t(1) << 23)) >> (-Exp32Diff - 1);
-  }
-
-  if (__builtin_expect(Exp32 == 0xff && Frac32 != 0, 0)) {
-    // corner case: FP32 is NaN
-    Exp16 = 0x1F;
-    Frac16 = 0x200;
-  }
-
-  // Compose the final FP16 binary
-  uint16_t Ret = 0;
-  Ret |= Sign;
-  Ret |= Exp16 << 10;
-  Ret += Frac16; // Add the carry bit from operation Frac16 += 1;
-
-  return Ret;
-}
-
-static float half2Float(const uint16_t &Val) {
-  // Extract the sign from the bits
-  const uint32_t Sign = static_cast<uint32_t>(Val & 0x8000) << 16;
-  // Extract the exponent from the bits
-  const uint8_t Exp16 = (Val & 0x7c00) >> 10;
-  // Extract the fraction from the bits
-  uint16_t Frac16 = Val & 0x3ff;
-
-  uint32_t Exp32 = 0;
-  if (__builtin_expect(Exp16 == 0x1f, 0)) {
-    Exp32 = 0xff;
-  } else if (__builtin_expect(Exp16 == 0, 0)) {
-    Exp32 = 0;
-  } else {
-    Exp32 = static_cast<uint32_t>(Exp16) + 112;
-  }
-
-  // corner case: subnormal -> normal
-  // The denormal number of FP16 can be represented by FP32, therefore we need
-  // to recover the exponent and recalculate the fration.
-  if (__builtin_expect(Exp16 == 0 && Frac16 != 0, 0)) {
-    uint8_t OffSet = 0;
-    do {
-      ++OffSet;
-      Frac16 <<= 1;
-    } while ((Frac16 & 0x400) != 0x400);
-    // mask the 9th bit
-    Frac16 &= 0x3ff;
-    Exp32 = 113 - OffSet;
-  }
-
-  uint32_t Frac32 = Frac16 << 13;
-
-  // Compose the final FP32 binary
-  uint32_t Bits = 0;
-
-  Bits |= Sign;
-  Bits |= (Exp32 << 23);
-  Bits |= Frac32;
-
-  float Result;
-  std::memcpy(&Result, &Bits, sizeof(Result));
-  return Result;
-}
-
 namespace host_half_impl {
 
+// The definitions of the members inlined into the applications, exported for
+// the ones built when they weren't.
 half::half(const float &RHS) : Buf(float2Half(RHS)) {}
 
 half &half::operator+=(const half &RHS) {
@@ -173,6 +88,89 @@ bool operator==(const half &LHS, const half &RHS) {
 bool operator!=(const half &LHS, const half &RHS) { return !(LHS == RHS); }
 } // namespace host_half_impl
 
+// The representation of the half type on the host.
+static_assert(sizeof(half_impl::half) == sizeof(uint16_t),
+              "Unexpected size of half");
+
+#if defined(__x86_64__) || defined(__i386__)
+#if defined(__GNUC__) || defined(__clang__)
+#define __SYCL_TARGET_F16C __attribute__((target("f16c")))
+#else
+#define __SYCL_TARGET_F16C
+#endif
+
+// Converts 8 values at a time with the F16C instructions, and the rest one at
+// a time.
+__SYCL_TARGET_F16C static void convertToHalfF16C(const float *Src,
+                                                 uint16_t *Dst, size_t Count) {
+  size_t I = 0;
+  for (; I + 8 <= Count; I += 8)
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i *>(Dst + I),
+        _mm256_cvtps_ph(_mm256_loadu_ps(Src + I), _MM_FROUND_TO_NEAREST_INT));
+  for (; I < Count; ++I)
+    Dst[I] = _cvtss_sh(Src[I], _MM_FROUND_TO_NEAREST_INT);
+}
+
+__SYCL_TARGET_F16C static void convertFromHalfF16C(const uint16_t *Src,
+                                                   float *Dst, size_t Count) {
+  size_t I = 0;
+  for (; I + 8 <= Count; I += 8)
+    _mm256_storeu_ps(Dst + I, _mm256_cvtph_ps(_mm_loadu_si128(
+                                  reinterpret_cast<const __m128i *>(Src + I))));
+  for (; I < Count; ++I)
+    Dst[I] = _cvtsh_ss(Src[I]);
+}
+
+#undef __SYCL_TARGET_F16C
+#endif
+
+static void convertToHalf(const float *Src, uint16_t *Dst, size_t Count) {
+#if defined(__x86_64__) || defined(__i386__)
+  static const bool HasF16C = PlatformUtil::hasHalfConversions();
+  if (HasF16C)
+    return convertToHalfF16C(Src, Dst, Count);
+#elif defined(__aarch64__)
+  size_t I = 0;
+  for (; I + 4 <= Count; I += 4)
+    vst1_u16(Dst + I, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(Src + I))));
+  Src += I;
+  Dst += I;
+  Count -= I;
+#endif
+  for (size_t I = 0; I < Count; ++I)
+    Dst[I] = host_half_impl::float2Half(Src[I]);
+}
+
+static void convertFromHalf(const uint16_t *Src, float *Dst, size_t Count) {
+#if defined(__x86_64__) || defined(__i386__)
+  static const bool HasF16C = PlatformUtil::hasHalfConversions();
+  if (HasF16C)
+    return convertFromHalfF16C(Src, Dst, Count);
+#elif defined(__aarch64__)
+  size_t I = 0;
+  for (; I + 4 <= Count; I += 4)
+    vst1q_f32(Dst + I, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(Src + I))));
+  Src += I;
+  Dst += I;
+  Count -= I;
+#endif
+  for (size_t I = 0; I < Count; ++I)
+    Dst[I] = host_half_impl::half2Float(Src[I]);
+}
+
 } // namespace detail
+
+namespace ONEAPI {
+
+void convert_to_half(const float *Src, half *Dst, size_t Count) {
+  detail::convertToHalf(Src, reinterpret_cast<uint16_t *>(Dst), Count);
+}
+
+void convert_from_half(const half *Src, float *Dst, size_t Count) {
+  detail::convertFromHalf(reinterpret_cast<const uint16_t *>(Src), Dst, Count);
+}
+
+} // namespace ONEAPI
 } // namespace sycl
 } // __SYCL_INLINE_NAMESPACE(cl)
@@ -7,6 +7,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <algorithm>
+#include <cstring>
 
 #include <CL/sycl/detail/common.hpp>
 #include <CL/sycl/detail/helpers.hpp>
@@ -14,19 +15,39 @@
 #include <CL/sycl/event.hpp>
 #include <CL/sycl/handler.hpp>
 #include <CL/sycl/info/info_desc.hpp>
+#include <detail/command_graph_impl.hpp>
 #include <detail/kernel_impl.hpp>
 #include <detail/queue_impl.hpp>
 #include <detail/scheduler/scheduler.hpp>
+#include <detail/submission_batch_impl.hpp>
+#include <detail/submit_latency.hpp>
 
 __SYCL_INLINE_NAMESPACE(cl) {
 namespace sycl {
 
+// The handler keeps the rectangle of a USM copy or fill in its argument
+// storage until finalize() moves it to the command group.
+static void storeUSMRect(vector_class<vector_class<char>> &ArgsStorage,
+                         const detail::USMRect &Rect) {
+  const char *Bytes = reinterpret_cast<const char *>(&Rect);
+  ArgsStorage.emplace_back(Bytes, Bytes + sizeof(Rect));
+}
+
+static detail::USMRect
+takeUSMRect(vector_class<vector_class<char>> &ArgsStorage) {
+  detail::USMRect Rect;
+  std::memcpy(&Rect, ArgsStorage.back().data(), sizeof(Rect));
+  ArgsStorage.pop_back();
+  return Rect;
+}
+
 event handler::finalize() {
   // This block of code is needed only for reduction implementation.
   // It is harmless (does nothing) for everything else.
   if (MIsFinalized)
     return MLastEvent;
   MIsFinalized = true;
+  detail::SubmitLatencyScope LatencyScope(detail::SubmitStage::finalize);
 
   unique_ptr_class<detail::CG> CommandGroup;
   switch (MCGType) {
@@ -38,7 +59,7 @@ event handler::finalize() {
         std::move(MSharedPtrStorage), std::move(MRequirements),
         std::move(MEvents), std::move(MArgs), std::move(MKernelName),
         std::move(MOSModuleHandle), std::move(MStreamStorage), MCGType,
-        MCodeLoc));
+        MCodeLoc, MKernelID));
     break;
   }
   case detail::CG::CODEPLAY_INTEROP_TASK:
@@ -79,6 +100,22 @@ event handler::finalize() {
         std::move(MAccStorage), std::move(MSharedPtrStorage),
         std::move(MRequirements), std::move(MEvents), MCodeLoc));
     break;
+  case detail::CG::COPY_USM_RECT: {
+    const detail::USMRect Rect = takeUSMRect(MArgsStorage);
+    CommandGroup.reset(new detail::CGCopyUSMRect(
+        MSrcPtr, MDstPtr, Rect, std::move(MArgsStorage),
+        std::move(MAccStorage), std::move(MSharedPtrStorage),
+        std::move(MRequirements), std::move(MEvents), MCodeLoc));
+    break;
+  }
+  case detail::CG::FILL_USM_RECT: {
+    const detail::USMRect Rect = takeUSMRect(MArgsStorage);
+    CommandGroup.reset(new detail::CGFillUSMRect(
+        std::move(MPattern), MDstPtr, Rect, std::move(MArgsStorage),
+        std::move(MAccStorage), std::move(MSharedPtrStorage),
+        std::move(MRequirements), std::move(MEvents), MCodeLoc));
+    break;
+  }
   case detail::CG::PREFETCH_USM:
     CommandGroup.reset(new detail::CGPrefetchUSM(
         MDstPtr, MLength, std::move(MArgsStorage), std::move(MAccStorage),
@@ -108,6 +145,26 @@ event handler::finalize() {
                         PI_INVALID_OPERATION);
   }
 
+  // The command groups submitted to a recorded queue are not executed
+  if (detail::command_graph_impl *Graph = MQueue->getRecordingGraph()) {
+    MLastEvent = detail::createSyclObjFromImpl<event>(
+        Graph->record(std::move(CommandGroup)));
+    return MLastEvent;
+  }
+  if (MQueue->isInFusionMode()) {
+    MLastEvent = detail::createSyclObjFromImpl<event>(
+        MQueue->addToFusion(std::move(CommandGroup)));
+    return MLastEvent;
+  }
+  // The command groups submitted through a batch are submitted by its commit
+  detail::submission_batch_impl *Batch =
+      detail::submission_batch_impl::getCurrent();
+  if (Batch && Batch->getQueue() == MQueue) {
+    MLastEvent = detail::createSyclObjFromImpl<event>(
+        Batch->add(std::move(CommandGroup)));
+    return MLastEvent;
+  }
+
   detail::EventImplPtr Event = detail::Scheduler::getInstance().addCG(
       std::move(CommandGroup), std::move(MQueue));
 
@@ -130,6 +187,28 @@ void handler::associateWithHandler(detail::AccessorBaseHost *AccBase,
                                    /*index*/ 0);
 }
 
+/// \return the number of arguments processArg adds for the arguments of a
+/// kernel lambda, so that MArgs is only allocated once.
+static size_t getNumArgDescs(size_t KernelArgsNum,
+                             const detail::kernel_param_desc_t *KernelArgs,
+                             bool IsESIMD) {
+  size_t NumArgDescs = KernelArgsNum;
+  for (size_t I = 0; I < KernelArgsNum; ++I) {
+    if (KernelArgs[I].kind != detail::kernel_param_kind_t::kind_accessor)
+      continue;
+    const access::target AccTarget =
+        static_cast<access::target>(KernelArgs[I].info & 0x7ff);
+    // The ranges and the offset of the accessor are passed as well
+    if (AccTarget == access::target::local)
+      NumArgDescs += 3;
+    else if (!IsESIMD && (AccTarget == access::target::global_buffer ||
+                          AccTarget == access::target::constant_buffer))
+      NumArgDescs +=
+          KernelArgs[I].info & detail::kernel_param_accessor_no_offset ? 2 : 3;
+  }
+  return NumArgDescs;
+}
+
 // TODO remove this one once ABI breaking changes are allowed.
 void handler::processArg(void *Ptr, const detail::kernel_param_kind_t &Kind,
                          const int Size, const size_t Index, size_t &IndexShift,
@@ -183,10 +262,14 @@ void handler::processArg(void *Ptr, const detail::kernel_param_kind_t &Kind,
         MArgs.emplace_back(kernel_param_kind_t::kind_std_layout,
                            &AccImpl->MMemoryRange[0], SizeAccField,
                            Index + IndexShift);
-        ++IndexShift;
-        MArgs.emplace_back(kernel_param_kind_t::kind_std_layout,
-                           &AccImpl->MOffset[0], SizeAccField,
-                           Index + IndexShift);
+        // The offset of accessors with the no_offset property is known to be
+        // zero, so the device compiler doesn't make it a kernel argument.
+        if (!(Size & detail::kernel_param_accessor_no_offset)) {
+          ++IndexShift;
+          MArgs.emplace_back(kernel_param_kind_t::kind_std_layout,
+                             &AccImpl->MOffset[0], SizeAccField,
+                             Index + IndexShift);
+        }
       }
       break;
     }
@@ -254,6 +337,8 @@ void handler::extractArgsAndReqs() {
       });
 
   const bool IsKernelCreatedFromSource = MKernel->isCreatedFromSource();
+  // The accessors take at most 4 arguments
+  MArgs.reserve(UnPreparedArgs.size() * (IsKernelCreatedFromSource ? 1 : 4));
 
   size_t IndexShift = 0;
   for (size_t I = 0; I < UnPreparedArgs.size(); ++I) {
@@ -277,6 +362,8 @@ void handler::extractArgsAndReqsFromLambda(
     char *LambdaPtr, size_t KernelArgsNum,
     const detail::kernel_param_desc_t *KernelArgs, bool IsESIMD) {
   const bool IsKernelCreatedFromSource = false;
+  MArgs.reserve(MArgs.size() +
+                getNumArgDescs(KernelArgsNum, KernelArgs, IsESIMD));
   size_t IndexShift = 0;
   for (size_t I = 0; I < KernelArgsNum; ++I) {
     void *Ptr = LambdaPtr + KernelArgs[I].offset;
@@ -337,6 +424,54 @@ void handler::memset(void *Dest, int Value, size_t Count) {
   MCGType = detail::CG::FILL_USM;
 }
 
+void handler::memcpy2d(void *Dest, size_t DestPitch, const void *Src,
+                       size_t SrcPitch, size_t Width, size_t Height) {
+  memcpy3d(Dest, DestPitch, DestPitch * Height, Src, SrcPitch,
+           SrcPitch * Height, Width, Height, 1);
+}
+
+void handler::memcpy3d(void *Dest, size_t DestPitch, size_t DestSlicePitch,
+                       const void *Src, size_t SrcPitch, size_t SrcSlicePitch,
+                       size_t Width, size_t Height, size_t Depth) {
+  throwIfActionIsCreated();
+  if (DestPitch < Width || SrcPitch < Width ||
+      DestSlicePitch < DestPitch * Height || SrcSlicePitch < SrcPitch * Height)
+    throw invalid_parameter_error(
+        "The pitches of a rectangular copy must not be smaller than the "
+        "rectangle.",
+        PI_INVALID_VALUE);
+  MSrcPtr = const_cast<void *>(Src);
+  MDstPtr = Dest;
+  detail::USMRect Rect;
+  Rect.Width = Width;
+  Rect.Height = Height;
+  Rect.Depth = Depth;
+  Rect.SrcRowPitch = SrcPitch;
+  Rect.SrcSlicePitch = SrcSlicePitch;
+  Rect.DstRowPitch = DestPitch;
+  Rect.DstSlicePitch = DestSlicePitch;
+  storeUSMRect(MArgsStorage, Rect);
+  MCGType = detail::CG::COPY_USM_RECT;
+}
+
+void handler::fill2dImpl(void *Dest, size_t DestPitch, const void *Pattern,
+                         size_t PatternSize, size_t Width, size_t Height) {
+  if (DestPitch < Width)
+    throw invalid_parameter_error(
+        "The pitch of a rectangular fill must not be smaller than its rows.",
+        PI_INVALID_VALUE);
+  MDstPtr = Dest;
+  const char *Bytes = static_cast<const char *>(Pattern);
+  MPattern.assign(Bytes, Bytes + PatternSize);
+  detail::USMRect Rect;
+  Rect.Width = Width;
+  Rect.Height = Height;
+  Rect.DstRowPitch = DestPitch;
+  Rect.DstSlicePitch = DestPitch * Height;
+  storeUSMRect(MArgsStorage, Rect);
+  MCGType = detail::CG::FILL_USM_RECT;
+}
+
 void handler::prefetch(const void *Ptr, size_t Count) {
   throwIfActionIsCreated();
   MDstPtr = const_cast<void *>(Ptr);
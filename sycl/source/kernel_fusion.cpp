@@ -0,0 +1,40 @@
+//==------- kernel_fusion.cpp --- SYCL kernel fusion of command groups -----==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <CL/sycl/ONEAPI/kernel_fusion.hpp>
+#include <detail/queue_impl.hpp>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace ONEAPI {
+
+fusion_wrapper::fusion_wrapper(queue &Queue) : MQueue(Queue) {}
+
+queue fusion_wrapper::get_queue() const { return MQueue; }
+
+bool fusion_wrapper::is_in_fusion_mode() const {
+  return sycl::detail::getSyclObjImpl(MQueue)->isInFusionMode();
+}
+
+void fusion_wrapper::start_fusion() {
+  sycl::detail::getSyclObjImpl(MQueue)->startFusion();
+}
+
+void fusion_wrapper::cancel_fusion() {
+  const auto &QueueImpl = sycl::detail::getSyclObjImpl(MQueue);
+  QueueImpl->completeFusion(QueueImpl);
+}
+
+event fusion_wrapper::complete_fusion() {
+  const auto &QueueImpl = sycl::detail::getSyclObjImpl(MQueue);
+  return QueueImpl->completeFusion(QueueImpl);
+}
+
+} // namespace ONEAPI
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -0,0 +1,34 @@
+//==---------- kernel_stats.cpp --- SYCL per-kernel execution statistics ---==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <CL/sycl/ONEAPI/kernel_stats.hpp>
+#include <detail/global_handler.hpp>
+#include <detail/kernel_stats.hpp>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace ONEAPI {
+
+bool is_kernel_stats_enabled() {
+  return detail::KernelStatsRecorder::isEnabled();
+}
+
+vector_class<kernel_stats> get_kernel_stats() {
+  if (!detail::KernelStatsRecorder::isEnabled())
+    return {};
+  return detail::GlobalHandler::instance().getKernelStatsRecorder().get();
+}
+
+void reset_kernel_stats() {
+  if (detail::KernelStatsRecorder::isEnabled())
+    detail::GlobalHandler::instance().getKernelStatsRecorder().reset();
+}
+
+} // namespace ONEAPI
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -0,0 +1,46 @@
+//==----------- prebuild.cpp --- SYCL ahead-of-first-use builds ------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <CL/sycl/ONEAPI/prebuild.hpp>
+#include <detail/context_impl.hpp>
+#include <detail/global_handler.hpp>
+#include <detail/program_manager/program_manager.hpp>
+#include <detail/thread_pool.hpp>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace ONEAPI {
+
+void prebuild_all(const context &Context, const vector_class<device> &Devices) {
+  if (Context.is_host())
+    return;
+
+  detail::getSyclObjImpl(Context)->beginPrebuild();
+  // The job keeps the context alive until the builds are finished.
+  detail::GlobalHandler::instance().getProgramBuildThreadPool().submit(
+      [Context, Devices]() {
+        try {
+          detail::ProgramManager::getInstance().prebuildAll(Context, Devices);
+        } catch (...) {
+          // The kernels which have not been built are built on submission.
+        }
+        detail::getSyclObjImpl(Context)->endPrebuild();
+      });
+}
+
+void wait_for_prebuild(const context &Context) {
+  detail::getSyclObjImpl(Context)->waitForPrebuild();
+}
+
+bool is_prebuild_complete(const context &Context) {
+  return detail::getSyclObjImpl(Context)->isPrebuildComplete();
+}
+
+} // namespace ONEAPI
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -133,6 +133,34 @@ template __SYCL_EXPORT bool
 queue::has_property<property::queue::enable_profiling>() const;
 template __SYCL_EXPORT property::queue::enable_profiling
 queue::get_property<property::queue::enable_profiling>() const;
+template __SYCL_EXPORT bool
+queue::has_property<ext::oneapi::property::queue::prefetch_shared_usm>() const;
+template __SYCL_EXPORT ext::oneapi::property::queue::prefetch_shared_usm
+queue::get_property<ext::oneapi::property::queue::prefetch_shared_usm>() const;
+template __SYCL_EXPORT bool
+queue::has_property<ext::oneapi::property::queue::discard_events>() const;
+template __SYCL_EXPORT ext::oneapi::property::queue::discard_events
+queue::get_property<ext::oneapi::property::queue::discard_events>() const;
+template __SYCL_EXPORT bool
+queue::has_property<ext::oneapi::property::queue::priority_normal>() const;
+template __SYCL_EXPORT ext::oneapi::property::queue::priority_normal
+queue::get_property<ext::oneapi::property::queue::priority_normal>() const;
+template __SYCL_EXPORT bool
+queue::has_property<ext::oneapi::property::queue::priority_low>() const;
+template __SYCL_EXPORT ext::oneapi::property::queue::priority_low
+queue::get_property<ext::oneapi::property::queue::priority_low>() const;
+template __SYCL_EXPORT bool
+queue::has_property<ext::oneapi::property::queue::priority_high>() const;
+template __SYCL_EXPORT ext::oneapi::property::queue::priority_high
+queue::get_property<ext::oneapi::property::queue::priority_high>() const;
+template __SYCL_EXPORT bool
+queue::has_property<ext::oneapi::property::queue::sub_device_scaling>() const;
+template __SYCL_EXPORT ext::oneapi::property::queue::sub_device_scaling
+queue::get_property<ext::oneapi::property::queue::sub_device_scaling>() const;
+template __SYCL_EXPORT bool
+queue::has_property<ext::oneapi::property::queue::spin_wait>() const;
+template __SYCL_EXPORT ext::oneapi::property::queue::spin_wait
+queue::get_property<ext::oneapi::property::queue::spin_wait>() const;
 
 bool queue::is_in_order() const {
   return impl->has_property<property::queue::in_order>();
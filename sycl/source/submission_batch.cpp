@@ -0,0 +1,83 @@
+//==------ submission_batch.cpp --- SYCL batched command group submission --==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <CL/sycl/ONEAPI/submission_batch.hpp>
+#include <detail/event_impl.hpp>
+#include <detail/queue_impl.hpp>
+#include <detail/submission_batch_impl.hpp>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace detail {
+
+thread_local submission_batch_impl *submission_batch_impl::MCurrent = nullptr;
+
+submission_batch_impl::~submission_batch_impl() {
+  try {
+    commit();
+  } catch (...) {
+    MQueue->reportAsyncException(std::current_exception());
+  }
+}
+
+event submission_batch_impl::submit(const function_class<void(handler &)> &CGF,
+                                    const code_location &Loc) {
+  // The command groups submitted by the command group function itself, e.g.
+  // for reductions, are collected as well
+  submission_batch_impl *Previous = MCurrent;
+  MCurrent = this;
+  try {
+    event Event = MQueue->submit(CGF, MQueue, Loc);
+    MCurrent = Previous;
+    return Event;
+  } catch (...) {
+    MCurrent = Previous;
+    throw;
+  }
+}
+
+EventImplPtr submission_batch_impl::add(std::unique_ptr<CG> CommandGroup) {
+  EventImplPtr Event = makeEventImpl();
+  std::lock_guard<mutex_class> Lock(MMutex);
+  MCGs.emplace_back(Event, std::move(CommandGroup));
+  return Event;
+}
+
+vector_class<event> submission_batch_impl::commit() {
+  CollectedCGs CGs;
+  {
+    std::lock_guard<mutex_class> Lock(MMutex);
+    CGs.swap(MCGs);
+  }
+  return MQueue->submitCollected(MQueue, std::move(CGs));
+}
+
+} // namespace detail
+
+namespace ONEAPI {
+
+submission_batch::submission_batch(queue &Queue)
+    : impl(std::make_shared<detail::submission_batch_impl>(
+          detail::getSyclObjImpl(Queue))) {}
+
+queue submission_batch::get_queue() const {
+  return detail::createSyclObjFromImpl<queue>(impl->getQueue());
+}
+
+size_t submission_batch::size() const { return impl->size(); }
+
+event submission_batch::submit_impl(function_class<void(handler &)> CGH,
+                                    const detail::code_location &CodeLoc) {
+  return impl->submit(CGH, CodeLoc);
+}
+
+vector_class<event> submission_batch::commit() { return impl->commit(); }
+
+} // namespace ONEAPI
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -0,0 +1,35 @@
+//==-------- submit_latency.cpp --- SYCL submission latency statistics -----==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <CL/sycl/ONEAPI/submit_latency.hpp>
+#include <detail/global_handler.hpp>
+#include <detail/submit_latency.hpp>
+
+__SYCL_INLINE_NAMESPACE(cl) {
+namespace sycl {
+namespace ONEAPI {
+
+bool is_submit_latency_enabled() {
+  return detail::SubmitLatencyRecorder::isEnabled();
+}
+
+submit_latency get_submit_latency(submit_stage Stage) {
+  if (!detail::SubmitLatencyRecorder::isEnabled())
+    return submit_latency{};
+  return detail::GlobalHandler::instance().getSubmitLatencyRecorder().get(
+      Stage);
+}
+
+void reset_submit_latency() {
+  if (detail::SubmitLatencyRecorder::isEnabled())
+    detail::GlobalHandler::instance().getSubmitLatencyRecorder().reset();
+}
+
+} // namespace ONEAPI
+} // namespace sycl
+} // __SYCL_INLINE_NAMESPACE(cl)
@@ -178,6 +178,7 @@ void foo() {
 // CHECK-NEXT: 520 |     unsigned long MLineNo
 // CHECK-NEXT: 528 |     unsigned long MColumnNo
 // CHECK-NEXT: 536 |   _Bool MIsFinalized
+// CHECK-NEXT: 540 |   unsigned int MKernelID
 // CHECK-NEXT: 544 |   class sycl::event MLastEvent
 // CHECK-NEXT: 544 |     class std::shared_ptr<class sycl::detail::event_impl> impl
 // CHECK-NEXT: 544 |       class std::__shared_ptr<class sycl::detail::event_impl, __gnu_cxx::_S_atomic> (base)
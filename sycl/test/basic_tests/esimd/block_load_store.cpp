@@ -12,6 +12,8 @@ using namespace cl::sycl;
 void kernel(accessor<int, 1, access::mode::read_write, access::target::global_buffer> &buf) __attribute__((sycl_device)) {
   simd<int, 32> v1(0, 1);
 
+  block_prefetch<int, 32, CacheHint::Streaming, CacheHint::WriteBack>(
+      buf.get_pointer());
   auto v0 = block_load<int, 32>(buf.get_pointer());
 
   v0 = v0 + v1;
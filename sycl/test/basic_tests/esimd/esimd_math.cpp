@@ -60,3 +60,13 @@ bool test_esimd_dp4() __attribute__((sycl_device)) {
   return (ret[0] == ret[1] && ret[1] == ret[2] && ret[2] == ret[3]) &&
          (ret[0] == 14.0f && ret[4] == 126.0f);
 }
+
+bool test_esimd_dpas() __attribute__((sycl_device)) {
+  simd<int, 8> acc(0);
+  simd<uint32_t, 64> b(0x01010101);
+  simd<uint32_t, 8> a(0x01010101);
+  simd<int, 8> ret =
+      esimd_dpas<EsimdPrecisionType::U8, EsimdPrecisionType::U8, 8, 1, int>(
+          acc, b, a);
+  return ret[0] == 32;
+}
@@ -0,0 +1,54 @@
+// RUN: %clangxx -fsycl %s -o %t.out
+// RUN: rm -rf %t.dir && mkdir -p %t.dir
+// RUN: env SYCL_ONLINE_COMPILER_CACHE_DIR=%t.dir %t.out
+// The second run reads the binaries from the directory
+// RUN: env SYCL_ONLINE_COMPILER_CACHE_DIR=%t.dir %t.out
+// RUN: %t.out
+
+//==------ online_compiler_cache.cpp - online compiler result cache test ---==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#include <CL/sycl.hpp>
+#include <CL/sycl/INTEL/online_compiler.hpp>
+
+#include <cassert>
+#include <future>
+#include <string>
+#include <vector>
+
+using namespace cl::sycl::INTEL;
+
+int main() {
+  const std::string Source = "__kernel void k(__global int *p) { *p = 1; }";
+  const std::vector<std::string> Options{"-cl-fast-relaxed-math"};
+
+  online_compiler<source_language::opencl_c> Compiler;
+  std::vector<byte> Binary = Compiler.compile(Source, Options);
+  // Repeated compilations are lookups
+  assert(Compiler.compile(Source, Options) == Binary);
+
+  std::future<std::vector<byte>> Async;
+  {
+    // The compiler can be destroyed while the compilation runs
+    online_compiler<source_language::opencl_c> AsyncCompiler;
+    Async = AsyncCompiler.compile_async(Source, Options);
+  }
+  assert(Async.get() == Binary);
+
+  online_compiler<source_language::opencl_c> GPUCompiler(
+      cl::sycl::info::device_type::gpu, device_arch::gpu_gen9);
+  std::vector<std::future<std::vector<byte>>> Compilations;
+  for (int I = 0; I < 4; ++I)
+    Compilations.push_back(GPUCompiler.compile_async(Source));
+  std::vector<byte> GPUBinary = GPUCompiler.compile(Source);
+  for (std::future<std::vector<byte>> &Compilation : Compilations)
+    assert(Compilation.get() == GPUBinary);
+
+  online_compiler<source_language::cm> CMCompiler;
+  assert(CMCompiler.compile(Source) == CMCompiler.compile(Source));
+  return 0;
+}
@@ -0,0 +1,38 @@
+// RUN: %clangxx -fsycl-device-only -O2 -emit-llvm %s -S -o %t.ll -I %sycl_include -Wno-sycl-strict -Xclang -verify-ignore-unexpected=note,warning
+// RUN: FileCheck %s --input-file %t.ll
+
+// Check that a device function called with a pointer to a global buffer and
+// with a pointer to local memory is cloned for each address space, and that
+// the clones access the memory without generic pointers.
+
+#include <CL/sycl.hpp>
+
+using namespace cl::sycl;
+
+__attribute__((noinline)) void add(int *Ptr, int Value) { *Ptr += Value; }
+
+// CHECK: define {{.*}}spir_kernel void @{{.*}}InferAS
+// CHECK-DAG: call spir_func void @_Z3addPii.as1(i32 addrspace(1)*
+// CHECK-DAG: call spir_func void @_Z3addPii.as3(i32 addrspace(3)*
+// CHECK: define internal spir_func void @_Z3addPii.as{{[13]}}(i32 addrspace({{[13]}})*
+// CHECK-NOT: addrspacecast
+// CHECK: ret void
+// CHECK: define internal spir_func void @_Z3addPii.as{{[13]}}(i32 addrspace({{[13]}})*
+// CHECK-NOT: addrspacecast
+// CHECK: ret void
+
+int main() {
+  queue Q;
+  buffer<int, 1> Buf(range<1>(1));
+  Q.submit([&](handler &CGH) {
+    auto Acc = Buf.get_access<access::mode::read_write>(CGH);
+    accessor<int, 1, access::mode::read_write, access::target::local> Local(
+        range<1>(1), CGH);
+    CGH.single_task<class InferAS>([=]() {
+      Local[0] = 0;
+      add(Local.get_pointer(), 1);
+      add(Acc.get_pointer(), Local[0]);
+    });
+  });
+  return 0;
+}
@@ -0,0 +1,50 @@
+// RUN: %clangxx -fsycl-device-only -Xclang -fsycl-is-device -emit-llvm %s -S -o %t.ll -I %sycl_include -Wno-sycl-strict -Xclang -verify-ignore-unexpected=note,warning -Xclang -disable-llvm-passes
+// RUN: FileCheck %s --input-file %t.ll
+//
+// Checks that joint_matrix operations are lowered to SPV_INTEL_joint_matrix
+// built-ins on the SPIR-V path.
+
+#include <CL/sycl.hpp>
+#include <CL/sycl/ONEAPI/experimental/matrix.hpp>
+
+using namespace cl::sycl;
+using namespace cl::sycl::ONEAPI::experimental::matrix;
+
+constexpr size_t TM = 8;
+constexpr size_t TN = 8;
+constexpr size_t TK = 32;
+
+// CHECK: call spir_func %{{.*}}__spirv_JointMatrixINTEL{{.*}} @_Z{{.*}}__spirv_JointMatrixLoadINTEL{{.*}}(i8 addrspace(4)*
+// CHECK: call spir_func %{{.*}}__spirv_JointMatrixINTEL{{.*}} @_Z{{.*}}__spirv_JointMatrixLoadINTEL{{.*}}(i8 addrspace(4)*
+// CHECK: call spir_func %{{.*}}__spirv_JointMatrixINTEL{{.*}} @_Z{{.*}}__spirv_JointMatrixLoadINTEL{{.*}}(i32 addrspace(4)*
+// CHECK: call spir_func %{{.*}}__spirv_JointMatrixINTEL{{.*}} @_Z{{.*}}__spirv_JointMatrixMadINTEL
+// CHECK: call spir_func void @_Z{{.*}}__spirv_JointMatrixStoreINTEL{{.*}}(i32 addrspace(4)*
+
+int main() {
+  queue Q;
+  buffer<int8_t, 1> BufA(range<1>(TM * TK));
+  buffer<int8_t, 1> BufB(range<1>(TK * TN));
+  buffer<int32_t, 1> BufC(range<1>(TM * TN));
+  Q.submit([&](handler &CGH) {
+    auto A = BufA.get_access<access::mode::read_write>(CGH);
+    auto B = BufB.get_access<access::mode::read_write>(CGH);
+    auto C = BufC.get_access<access::mode::read_write>(CGH);
+    CGH.parallel_for<class JointMatrixKernel>(
+        nd_range<1>(range<1>(TN), range<1>(TN)), [=](nd_item<1> It) {
+          ONEAPI::sub_group SG = It.get_sub_group();
+          joint_matrix<int8_t, TM, TK> SubA(SG);
+          joint_matrix<int8_t, TK, TN, matrix_layout::packed_b> SubB(SG);
+          joint_matrix<int32_t, TM, TN> SubC(SG);
+          joint_matrix_load(SG, SubA, A.get_pointer(), TK,
+                            matrix_layout::row_major);
+          joint_matrix_load(SG, SubB, B.get_pointer(), TN * 4,
+                            matrix_layout::packed_b);
+          joint_matrix_load(SG, SubC, C.get_pointer(), TN,
+                            matrix_layout::row_major);
+          SubC = joint_matrix_mad(SG, SubA, SubB, SubC);
+          joint_matrix_store(SG, SubC, C.get_pointer(), TN,
+                             matrix_layout::row_major);
+        });
+  });
+  return 0;
+}
@@ -0,0 +1,28 @@
+// RUN: %clangxx -fsycl-device-only -Xclang -fenable-sycl-dae -O2 -emit-llvm %s -S -o %t.ll -I %sycl_include -Wno-sycl-strict -Xclang -verify-ignore-unexpected=note,warning
+// RUN: FileCheck %s --input-file %t.ll
+
+// Check that a captured struct of which the kernel reads only two fields is
+// passed as the two byte ranges holding them.
+
+#include <CL/sycl.hpp>
+
+using namespace cl::sycl;
+
+struct Params {
+  int A;
+  float Unused[16];
+  long B;
+  int AlsoUnused[8];
+};
+
+// CHECK: define {{.*}}spir_kernel void @{{.*}}FieldElim({ [4 x i8] }* byval({ [4 x i8] }) align 8 %_arg_P.range0, { [8 x i8] }* byval({ [8 x i8] }) align 8 %_arg_P.range1, {{.*}}!sycl_kernel_arg_fields ![[FIELDS:[0-9]+]]
+// CHECK: ![[FIELDS]] = !{![[PARAM:[0-9]+]]}
+// CHECK: ![[PARAM]] = !{i32 0, i32 0, i32 4, i32 72, i32 8}
+
+int main() {
+  queue Q;
+  Params P{};
+  long *Out = malloc_shared<long>(1, Q);
+  Q.single_task<class FieldElim>([=]() { *Out = P.A + P.B; });
+  return 0;
+}
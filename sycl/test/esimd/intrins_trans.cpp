@@ -68,6 +68,11 @@ SYCL_ESIMD_FUNCTION SYCL_EXTERNAL simd<float, 16> foo() {
   __esimd_flat_write<uint32_t, VL>(v_addr.data(), v01.data(), 0, pred.data());
   // CHECK: call void @llvm.genx.svm.scatter.v32i1.v32i64.v32i32(<32 x i1> %{{[0-9a-zA-Z_.]+}}, i32 0, <32 x i64> %{{[0-9a-zA-Z_.]+}}, <32 x i32> %{{[0-9a-zA-Z_.]+}})
 
+  // Prefetches have no GenX counterpart and are dropped.
+  __esimd_flat_block_prefetch<uint32_t, VL, CacheHint::Streaming>(addr);
+  __esimd_flat_prefetch<uint32_t, VL>(v_addr.data(), 0, pred.data());
+  // CHECK-NOT: prefetch
+
   simd<short, 16> mina(0, 1);
   simd<short, 16> minc(5);
   minc = __esimd_smin<short, 16>(mina.data(), minc.data());
@@ -78,6 +83,14 @@ SYCL_ESIMD_FUNCTION SYCL_EXTERNAL simd<float, 16> foo() {
   diva = __esimd_div_ieee<1>(diva.data(), divb.data());
   // CHECK:  %{{[0-9a-zA-Z_.]+}} = call <1 x float> @llvm.genx.ieee.div.v1f32(<1 x float>  %{{[0-9a-zA-Z_.]+}}, <1 x float>  %{{[0-9a-zA-Z_.]+}})
 
+  simd<int, 8> dpas_acc(0);
+  simd<uint32_t, 64> dpas_src1(1);
+  simd<uint32_t, 8> dpas_src2(1);
+  simd<int, 8> dpas_res =
+      esimd_dpas<EsimdPrecisionType::U8, EsimdPrecisionType::S8, 8, 1, int>(
+          dpas_acc, dpas_src1, dpas_src2);
+  // CHECK: %{{[0-9a-zA-Z_.]+}} = call <8 x i32> @llvm.genx.dpas2.v8i32.v8i32.v64i32.v8i32(<8 x i32> %{{[0-9a-zA-Z_.]+}}, <64 x i32> %{{[0-9a-zA-Z_.]+}}, <8 x i32> %{{[0-9a-zA-Z_.]+}}, i32 6, i32 7, i32 8, i32 1, i32 1, i32 1)
+
   simd<float, 16> a(0.1f);
   simd<float, 8> b = __esimd_rdregion<float, 16, 8, 0, 8, 1>(a.data(), 0);
   // CHECK: %{{[0-9a-zA-Z_.]+}} = call <8 x float> @llvm.genx.rdregionf.v8f32.v16f32.i16(<16 x float> %{{[0-9a-zA-Z_.]+}}, i32 0, i32 8, i32 1, i16 0, i32 0)
@@ -108,6 +121,10 @@ SYCL_ESIMD_FUNCTION SYCL_EXTERNAL simd<float, 16> foo() {
   // CHECK: %[[SI2:[0-9a-zA-Z_.]+]] = ptrtoint %opencl.image2d_wo_t addrspace(1)* %{{[0-9a-zA-Z_.]+}} to i32
   // CHECK: call void @llvm.genx.media.st.v32i32(i32 0, i32 %[[SI2]], i32 0, i32 32, i32 %{{[0-9a-zA-Z_.]+}}, i32 %{{[0-9a-zA-Z_.]+}}, <32 x i32> %{{[0-9a-zA-Z_.]+}})
 
+  // A block taller than one dataport transaction is read in bands of rows.
+  simd<int, 128> vt = media_block_load<int, 16, 8>(pA, x, y);
+  // CHECK-COUNT-2: call <64 x i32> @llvm.genx.media.ld.v64i32(i32 0, i32 %{{[0-9a-zA-Z_.]+}}, i32 0, i32 32,
+
   auto ee = __esimd_vload<int, 16>((vector_type_t<int, 16> *)(&vg));
   // CHECK: %{{[0-9a-zA-Z_.]+}} = call <16 x i32> @llvm.genx.vload.v16i32.p4v16i32(<16 x i32> addrspace(4)* {{.*}})
   __esimd_vstore<int, 32>(&vc, va.data());
@@ -26,8 +26,10 @@ int main() {
 
     default_selector Selector;
 
-    queue FirstQueue(Selector);
-    queue SecondQueue(Selector);
+    device Device = Selector.select_device();
+    // The queues made from a device share its default context.
+    queue FirstQueue(context(Device), Device);
+    queue SecondQueue(context(Device), Device);
 
     assert(FirstQueue.get_context() != SecondQueue.get_context());
     FirstQueue.submit([&](handler &Cgh) {
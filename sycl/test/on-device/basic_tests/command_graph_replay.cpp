@@ -0,0 +1,72 @@
+// RUN: %clangxx -fsycl -fsycl-targets=%sycl_triple %s -o %t.out
+// RUN: %CPU_RUN_PLACEHOLDER %t.out
+// RUN: %GPU_RUN_PLACEHOLDER %t.out
+// RUN: %ACC_RUN_PLACEHOLDER %t.out
+
+// Records USM command groups with dependencies into a command graph, replays
+// them and records them again with other arguments.
+
+#include <CL/sycl.hpp>
+
+#include <iostream>
+
+constexpr size_t N = 1024;
+
+void record(sycl::ONEAPI::command_graph &Graph, sycl::queue &Q, int *Data,
+            int *Result, int Value) {
+  Graph.begin_recording(Q);
+  sycl::event Fill = Q.fill(Data, Value, N);
+  sycl::event Add = Q.submit([&](sycl::handler &CGH) {
+    CGH.depends_on(Fill);
+    CGH.parallel_for<class Add>(sycl::range<1>{N},
+                                [=](sycl::id<1> I) { Data[I] += 1; });
+  });
+  Q.submit([&](sycl::handler &CGH) {
+    CGH.depends_on(Add);
+    CGH.single_task<class Sum>([=]() {
+      int Sum = 0;
+      for (size_t I = 0; I < N; ++I)
+        Sum += Data[I];
+      *Result += Sum;
+    });
+  });
+  Graph.end_recording();
+}
+
+int main() {
+  sycl::queue Q;
+  if (Q.is_host())
+    return 0;
+  int *Data = sycl::malloc_device<int>(N, Q);
+  int *Result = sycl::malloc_shared<int>(1, Q);
+  *Result = 0;
+
+  sycl::ONEAPI::command_graph Graph;
+  record(Graph, Q, Data, Result, 1);
+  if (!Graph.is_recorded()) {
+    std::cerr << "The graph is not recorded" << std::endl;
+    return 1;
+  }
+  // Nothing is executed during the recording
+  if (*Result != 0) {
+    std::cerr << "The recorded commands were executed" << std::endl;
+    return 1;
+  }
+
+  sycl::event Replay = Graph.replay(Q);
+  Graph.replay(Q, {Replay}).wait();
+  int Expected = 2 * N * 2;
+  // Recording again updates the arguments
+  record(Graph, Q, Data, Result, 2);
+  Graph.replay(Q).wait();
+  Expected += N * 3;
+
+  int Got = *Result;
+  sycl::free(Data, Q);
+  sycl::free(Result, Q);
+  if (Got != Expected) {
+    std::cerr << "Expected " << Expected << ", got " << Got << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -254,6 +254,17 @@ int main() {
   assert(bitwise_comparison_fp16(half(-55504) * 3, 64512));
   // underflow
   assert(bitwise_comparison_fp16(half(8.1035e-05) / half(3), 453));
+  // the ties round to the nearest even
+  uint32_t tie = 0x3f801000; // 1 + 2^-11
+  assert(bitwise_comparison_fp16(reinterpret_cast<float &>(tie), 0x3c00));
+  tie = 0x3f803000; // 1 + 3 * 2^-11
+  assert(bitwise_comparison_fp16(reinterpret_cast<float &>(tie), 0x3c02));
+  tie = 0x33c00000; // 3 * 2^-25, subnormal
+  assert(bitwise_comparison_fp16(reinterpret_cast<float &>(tie), 0x0002));
+  // the largest value converted to the maximum half
+  uint32_t below_inf = 0x477fefff;
+  assert(
+      bitwise_comparison_fp16(reinterpret_cast<float &>(below_inf), 0x7bff));
 
   // Basic tests: fp16->fp32
   // The following references are from `_cvtsh_ss`.
@@ -281,6 +292,30 @@ int main() {
   assert(bitwise_comparison_fp32(reinterpret_cast<const half &>(subnormal),
                                  882900992));
 
+  // signaling nan
+  const uint16_t snan16 = 0x7c01;
+  assert(bitwise_comparison_fp32(reinterpret_cast<const half &>(snan16),
+                                 0x7fc02000));
+
+  // Bulk conversions, of full vectors of the conversion instructions and of
+  // remaining elements
+  for (size_t count : {1, 8, 19}) {
+    std::vector<float> floats(count);
+    for (size_t i = 0; i < count; ++i)
+      floats[i] = i * 0.37f - 3.0f;
+    floats[0] = 65520.0f;
+    std::vector<half> halfs(count);
+    ONEAPI::convert_to_half(floats.data(), halfs.data(), count);
+    std::vector<float> back(count);
+    ONEAPI::convert_from_half(halfs.data(), back.data(), count);
+    for (size_t i = 0; i < count; ++i) {
+      const half expected = floats[i];
+      assert(bitwise_comparison_fp16(
+          halfs[i], reinterpret_cast<const uint16_t &>(expected)));
+      assert(back[i] == static_cast<float>(expected));
+    }
+  }
+
   // std::hash<cl::sycl::half>
   std::unordered_set<half> sets;
   sets.insert(1.2);
@@ -0,0 +1,55 @@
+// RUN: %clangxx -fsycl %s -o %t.out
+// RUN: %RUN_ON_HOST %t.out
+// RUN: env SYCL_HOST_KERNEL_THREADS=1 %RUN_ON_HOST %t.out
+// RUN: env SYCL_HOST_KERNEL_THREADS=4 %RUN_ON_HOST %t.out
+
+// The kernels of the host device run on several threads, each work-item still
+// runs exactly once and sees its own ids.
+
+#include <CL/sycl.hpp>
+
+#include <iostream>
+#include <vector>
+
+using namespace cl::sycl;
+
+int main() {
+  queue Q{host_selector{}};
+  constexpr size_t Rows = 37, Cols = 64;
+  std::vector<int> Data(Rows * Cols, 0);
+  int Failures = 0;
+
+  {
+    buffer<int, 2> Buf{Data.data(), range<2>{Rows, Cols}};
+    Q.submit([&](handler &CGH) {
+      auto Acc = Buf.get_access<access::mode::read_write>(CGH);
+      CGH.parallel_for<class RangeKernel>(range<2>{Rows, Cols},
+                                          [=](item<2> It) { Acc[It] += 1; });
+    });
+    Q.submit([&](handler &CGH) {
+      auto Acc = Buf.get_access<access::mode::read_write>(CGH);
+      CGH.parallel_for<class NDRangeKernel>(
+          nd_range<2>{range<2>{Rows, Cols}, range<2>{1, 16}},
+          [=](nd_item<2> It) {
+            if (this_nd_item<2>().get_global_id() == It.get_global_id())
+              Acc[It.get_global_id()] += 1;
+          });
+    });
+    Q.submit([&](handler &CGH) {
+      auto Acc = Buf.get_access<access::mode::read_write>(CGH);
+      CGH.parallel_for_work_group<class GroupKernel>(
+          range<2>{Rows, Cols / 16}, range<2>{1, 16}, [=](group<2> G) {
+            G.parallel_for_work_item(
+                [&](h_item<2> It) { Acc[It.get_global_id()] += 1; });
+          });
+    });
+  }
+
+  for (size_t I = 0; I < Data.size(); ++I)
+    if (Data[I] != 3) {
+      std::cerr << "Element " << I << " is " << Data[I] << ", expected 3"
+                << std::endl;
+      ++Failures;
+    }
+  return Failures ? 1 : 0;
+}
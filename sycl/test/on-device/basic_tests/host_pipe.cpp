@@ -0,0 +1,58 @@
+// RUN: %clangxx -fsycl -fsycl-targets=%sycl_triple %s -o %t.out
+// RUN: %CPU_RUN_PLACEHOLDER %t.out
+// RUN: %GPU_RUN_PLACEHOLDER %t.out
+// RUN: %ACC_RUN_PLACEHOLDER %t.out
+
+// A single kernel launch processes the data the host streams to it through a
+// host pipe, and streams the results back through another one. The pipes are
+// smaller than the data, so both sides wait for each other. The host device
+// is not tested, as its kernels run in the thread submitting them.
+
+#include <CL/sycl.hpp>
+#include <CL/sycl/INTEL/fpga_extensions.hpp>
+
+#include <iostream>
+
+using sycl::INTEL::host_pipe;
+
+int main() {
+  sycl::queue Q;
+  if (!Q.get_device().has(sycl::aspect::usm_host_allocations)) {
+    std::cout << "Skipping: no USM host allocations" << std::endl;
+    return 0;
+  }
+
+  constexpr int N = 1000;
+  host_pipe<int> In(Q, 16);
+  host_pipe<int> Out(Q, 7);
+
+  auto InEnd = In.get_kernel_end();
+  auto OutEnd = Out.get_kernel_end();
+  sycl::event Stream = Q.single_task<class Square>([=]() {
+    for (int I = 0; I < N; ++I) {
+      int Value = InEnd.read();
+      OutEnd.write(Value * Value);
+    }
+  });
+
+  int Failures = 0;
+  int Written = 0, Read = 0;
+  while (Read < N) {
+    if (Written < N && In.try_write(Written))
+      ++Written;
+    int Value;
+    if (Out.try_read(Value)) {
+      if (Value != Read * Read && Failures++ == 0)
+        std::cerr << "Expected " << Read * Read << " at " << Read << ", got "
+                  << Value << std::endl;
+      ++Read;
+    }
+  }
+  Stream.wait();
+
+  if (In.try_read(Read) || Out.try_read(Read)) {
+    std::cerr << "The pipes should be empty" << std::endl;
+    ++Failures;
+  }
+  return Failures;
+}
@@ -0,0 +1,47 @@
+// RUN: %clangxx -fsycl -fsycl-targets=%sycl_triple %s -o %t.out
+// RUN: %CPU_RUN_PLACEHOLDER %t.out
+// RUN: %GPU_RUN_PLACEHOLDER %t.out
+// RUN: %ACC_RUN_PLACEHOLDER %t.out
+
+// The host tasks of an in-order queue are ordered with the kernels submitted
+// before and after them, without explicit dependencies.
+
+#include <CL/sycl.hpp>
+
+#include <iostream>
+
+template <typename PropertiesT> int test(PropertiesT Properties) {
+  sycl::queue Q{Properties};
+  int *Data = sycl::malloc_shared<int>(1, Q);
+  *Data = 0;
+
+  constexpr int Iterations = 16;
+  for (int I = 0; I < Iterations; ++I) {
+    Q.submit([&](sycl::handler &CGH) {
+      CGH.single_task<class Increment>([=]() { *Data += 1; });
+    });
+    Q.submit([&](sycl::handler &CGH) {
+      CGH.codeplay_host_task([=]() { *Data *= 2; });
+    });
+  }
+  Q.wait();
+
+  int Expected = 0;
+  for (int I = 0; I < Iterations; ++I)
+    Expected = (Expected + 1) * 2;
+  int Result = *Data;
+  sycl::free(Data, Q);
+  if (Result != Expected) {
+    std::cerr << "Expected " << Expected << ", got " << Result << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+int main() {
+  int Failures = test(sycl::property_list{sycl::property::queue::in_order()});
+  Failures += test(sycl::property_list{
+      sycl::property::queue::in_order(),
+      sycl::ext::oneapi::property::queue::discard_events()});
+  return Failures;
+}
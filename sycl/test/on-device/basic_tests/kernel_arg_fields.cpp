@@ -0,0 +1,51 @@
+// RUN: %clangxx -fsycl -fsycl-dead-args-optimization -fsycl-targets=%sycl_triple %s -o %t.out
+// RUN: %CPU_RUN_PLACEHOLDER %t.out
+// RUN: %GPU_RUN_PLACEHOLDER %t.out
+// RUN: %ACC_RUN_PLACEHOLDER %t.out
+
+// Check that only the used parts of captured structs are passed correctly,
+// together with arguments eliminated as a whole and accessors.
+
+#include <CL/sycl.hpp>
+
+#include <iostream>
+
+using namespace cl::sycl;
+
+struct Params {
+  int A;
+  float Unused[16];
+  long B;
+  int AlsoUnused[8];
+  char C;
+};
+
+int main() {
+  queue Q;
+  Params P{};
+  P.A = 1;
+  P.B = 1L << 40;
+  P.C = 3;
+  for (int I = 0; I < 16; ++I)
+    P.Unused[I] = I;
+  const int NotUsed = 42;
+
+  long Result = 0;
+  {
+    buffer<long, 1> Buf(&Result, range<1>(1));
+    Q.submit([&](handler &CGH) {
+      auto Acc = Buf.get_access<access::mode::write>(CGH);
+      CGH.single_task<class FieldElim>([=]() {
+        (void)NotUsed;
+        Acc[0] = P.A + P.B + P.C;
+      });
+    });
+  }
+
+  const long Expected = 1 + (1L << 40) + 3;
+  if (Result != Expected) {
+    std::cout << "Result " << Result << " != " << Expected << std::endl;
+    return 1;
+  }
+  return 0;
+}
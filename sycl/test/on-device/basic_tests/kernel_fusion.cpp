@@ -0,0 +1,79 @@
+// RUN: %clangxx -fsycl -fsycl-targets=%sycl_triple %s -o %t.out
+// RUN: %CPU_RUN_PLACEHOLDER %t.out
+// RUN: %GPU_RUN_PLACEHOLDER %t.out
+// RUN: %ACC_RUN_PLACEHOLDER %t.out
+
+// The command groups submitted in fusion mode are executed in order by
+// complete_fusion and cancel_fusion.
+
+#include <CL/sycl.hpp>
+
+#include <iostream>
+
+constexpr size_t N = 512;
+
+template <typename NameT> class Add;
+
+template <typename NameT>
+void chain(sycl::queue &Q, sycl::buffer<int, 1> &In, sycl::buffer<int, 1> &Tmp,
+           sycl::buffer<int, 1> &Out) {
+  Q.submit([&](sycl::handler &CGH) {
+    auto AccIn = In.get_access<sycl::access::mode::read>(CGH);
+    auto AccTmp = Tmp.get_access<sycl::access::mode::discard_write>(CGH);
+    CGH.parallel_for<NameT>(sycl::range<1>{N}, [=](sycl::id<1> I) {
+      AccTmp[I] = AccIn[I] * 2;
+    });
+  });
+  Q.submit([&](sycl::handler &CGH) {
+    auto AccTmp = Tmp.get_access<sycl::access::mode::read>(CGH);
+    auto AccOut = Out.get_access<sycl::access::mode::discard_write>(CGH);
+    CGH.parallel_for<Add<NameT>>(sycl::range<1>{N}, [=](sycl::id<1> I) {
+      AccOut[I] = AccTmp[I] + 1;
+    });
+  });
+}
+
+int check(sycl::buffer<int, 1> &Out) {
+  auto Acc = Out.get_access<sycl::access::mode::read>();
+  for (size_t I = 0; I < N; ++I) {
+    if (Acc[I] != static_cast<int>(I) * 2 + 1) {
+      std::cerr << "Wrong result at " << I << ": " << Acc[I] << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int main() {
+  sycl::queue Q;
+  if (Q.is_host())
+    return 0;
+
+  std::vector<int> Data(N);
+  for (size_t I = 0; I < N; ++I)
+    Data[I] = static_cast<int>(I);
+  sycl::buffer<int, 1> In{Data.data(), sycl::range<1>{N}};
+  sycl::buffer<int, 1> Tmp{sycl::range<1>{N}};
+  sycl::buffer<int, 1> Out{sycl::range<1>{N}};
+
+  sycl::ONEAPI::fusion_wrapper Fusion{Q};
+  Fusion.start_fusion();
+  if (!Fusion.is_in_fusion_mode()) {
+    std::cerr << "The queue is not in fusion mode" << std::endl;
+    return 1;
+  }
+  chain<class Double>(Q, In, Tmp, Out);
+  Fusion.complete_fusion().wait();
+  if (Fusion.is_in_fusion_mode()) {
+    std::cerr << "The queue is still in fusion mode" << std::endl;
+    return 1;
+  }
+  int Failures = check(Out);
+
+  Fusion.start_fusion();
+  chain<class DoubleCancel>(Q, In, Tmp, Out);
+  Fusion.cancel_fusion();
+  Q.wait();
+  Failures += check(Out);
+  return Failures;
+}
@@ -0,0 +1,44 @@
+// RUN: %clangxx -fsycl -fsycl-targets=%sycl_triple %s -o %t.out
+// RUN: %RUN_ON_HOST %t.out
+// RUN: %CPU_RUN_PLACEHOLDER %t.out
+// RUN: %GPU_RUN_PLACEHOLDER %t.out
+// RUN: %ACC_RUN_PLACEHOLDER %t.out
+
+//==------- prebuild_all.cpp - ONEAPI::prebuild_all extension test ---------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <CL/sycl.hpp>
+
+#include <cassert>
+
+using namespace cl::sycl;
+
+class Increment;
+
+int main() {
+  queue Queue;
+  context Context = Queue.get_context();
+
+  ONEAPI::prebuild_all(Context);
+  // Starting the builds twice is allowed, they share the program cache.
+  ONEAPI::prebuild_all(Context, {Queue.get_device()});
+  ONEAPI::wait_for_prebuild(Context);
+  assert(ONEAPI::is_prebuild_complete(Context));
+
+  int Data = 41;
+  {
+    buffer<int, 1> Buf(&Data, range<1>(1));
+    Queue.submit([&](handler &CGH) {
+      auto Acc = Buf.get_access<access::mode::read_write>(CGH);
+      CGH.single_task<Increment>([=]() { Acc[0] += 1; });
+    });
+  }
+  assert(Data == 42);
+
+  return 0;
+}
@@ -0,0 +1,56 @@
+// RUN: %clangxx -fsycl -fsycl-targets=%sycl_triple %s -o %t.out
+// RUN: %CPU_RUN_PLACEHOLDER %t.out
+// RUN: %GPU_RUN_PLACEHOLDER %t.out
+// RUN: %ACC_RUN_PLACEHOLDER %t.out
+
+#include <CL/sycl.hpp>
+
+#include <iostream>
+
+int main() {
+  // The events can only be discarded by in-order queues.
+  try {
+    sycl::queue Q{sycl::property_list{
+        sycl::ext::oneapi::property::queue::discard_events()}};
+    std::cerr << "An out-of-order discard_events queue was created"
+              << std::endl;
+    return 1;
+  } catch (const sycl::invalid_parameter_error &) {
+  }
+
+  sycl::queue Q{sycl::property_list{
+      sycl::property::queue::in_order(),
+      sycl::ext::oneapi::property::queue::discard_events()}};
+  if (!Q.has_property<sycl::ext::oneapi::property::queue::discard_events>()) {
+    std::cerr << "Queue should have the discard_events property" << std::endl;
+    return 1;
+  }
+
+  constexpr size_t N = 16;
+  constexpr int Steps = 10;
+  int *Data = sycl::malloc_shared<int>(N, Q);
+  for (size_t I = 0; I < N; ++I)
+    Data[I] = 0;
+
+  // The kernels only see the updates of the previous ones if they run in
+  // order, their events are not waited on.
+  for (int Step = 0; Step < Steps; ++Step)
+    Q.parallel_for<class step>(sycl::range<1>{N}, [=](sycl::id<1> I) {
+      Data[I] = Data[I] * 2 + 1;
+    });
+  Q.wait();
+
+  int Errors = 0;
+  for (size_t I = 0; I < N; ++I)
+    Errors += Data[I] != (1 << Steps) - 1;
+
+  // A barrier returns a real event.
+  Q.parallel_for<class reset>(sycl::range<1>{N},
+                              [=](sycl::id<1> I) { Data[I] = 0; });
+  Q.submit_barrier().wait();
+  for (size_t I = 0; I < N; ++I)
+    Errors += Data[I] != 0;
+
+  sycl::free(Data, Q);
+  return Errors;
+}
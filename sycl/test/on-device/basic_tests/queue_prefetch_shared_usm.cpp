@@ -0,0 +1,36 @@
+// RUN: %clangxx -fsycl -fsycl-targets=%sycl_triple %s -o %t.out
+// RUN: env SYCL_PI_TRACE=2 %CPU_RUN_PLACEHOLDER %t.out 2>&1 %CPU_CHECK_PLACEHOLDER
+
+#include <CL/sycl.hpp>
+
+#include <iostream>
+
+int main() {
+  sycl::queue Q{sycl::property_list{
+      sycl::ext::oneapi::property::queue::prefetch_shared_usm()}};
+  if (!Q.has_property<
+          sycl::ext::oneapi::property::queue::prefetch_shared_usm>()) {
+    std::cerr << "Queue should have the prefetch_shared_usm property"
+              << std::endl;
+    return 1;
+  }
+
+  constexpr size_t N = 16;
+  int *Data = sycl::malloc_shared<int>(N, Q);
+  for (size_t I = 0; I < N; ++I)
+    Data[I] = I;
+
+  Q.parallel_for<class add_one>(sycl::range<1>{N}, [=](sycl::id<1> I) {
+     Data[I] += 1;
+   }).wait();
+
+  int Errors = 0;
+  for (size_t I = 0; I < N; ++I)
+    Errors += Data[I] != static_cast<int>(I) + 1;
+  sycl::free(Data, Q);
+  return Errors;
+}
+
+// The allocation the kernel uses is prefetched before the kernel is launched.
+// CHECK: ---> piextUSMEnqueuePrefetch
+// CHECK: ---> piEnqueueKernelLaunch
@@ -0,0 +1,62 @@
+// RUN: %clangxx -fsycl -fsycl-targets=%sycl_triple %s -o %t.out
+// RUN: %RUN_ON_HOST %t.out
+// RUN: %CPU_RUN_PLACEHOLDER %t.out
+// RUN: %GPU_RUN_PLACEHOLDER %t.out
+// RUN: %ACC_RUN_PLACEHOLDER %t.out
+
+// The priorities don't change the results of the queues.
+
+#include <CL/sycl.hpp>
+
+#include <iostream>
+
+namespace queue_props = sycl::ext::oneapi::property::queue;
+
+template <typename PriorityT> class Fill;
+
+template <typename PriorityT> int test(const char *Name) {
+  sycl::queue Q{sycl::property_list{PriorityT()}};
+  if (!Q.has_property<PriorityT>()) {
+    std::cerr << "Queue should have the " << Name << " property" << std::endl;
+    return 1;
+  }
+
+  constexpr size_t N = 16;
+  int *Data = sycl::malloc_shared<int>(N, Q);
+  Q.parallel_for<Fill<PriorityT>>(sycl::range<1>{N}, [=](sycl::id<1> I) {
+     Data[I] = static_cast<int>(I[0]);
+   }).wait();
+  Q.submit([&](sycl::handler &CGH) {
+     CGH.codeplay_host_task([=]() {
+       for (size_t I = 0; I < N; ++I)
+         Data[I] *= 2;
+     });
+   }).wait();
+
+  int Failures = 0;
+  for (size_t I = 0; I < N; ++I) {
+    if (Data[I] != static_cast<int>(I) * 2) {
+      std::cerr << Name << ": expected " << I * 2 << " at " << I << ", got "
+                << Data[I] << std::endl;
+      ++Failures;
+    }
+  }
+  sycl::free(Data, Q);
+  return Failures;
+}
+
+int main() {
+  // A queue has a single priority.
+  try {
+    sycl::queue Q{sycl::property_list{queue_props::priority_low(),
+                                      queue_props::priority_high()}};
+    std::cerr << "A queue with two priorities was created" << std::endl;
+    return 1;
+  } catch (const sycl::invalid_parameter_error &) {
+  }
+
+  int Failures = test<queue_props::priority_normal>("priority_normal");
+  Failures += test<queue_props::priority_low>("priority_low");
+  Failures += test<queue_props::priority_high>("priority_high");
+  return Failures;
+}
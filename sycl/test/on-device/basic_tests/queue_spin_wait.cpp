@@ -0,0 +1,41 @@
+// RUN: %clangxx -fsycl -fsycl-targets=%sycl_triple %s -o %t.out
+// RUN: %RUN_ON_HOST %t.out
+// RUN: %CPU_RUN_PLACEHOLDER %t.out
+// RUN: %GPU_RUN_PLACEHOLDER %t.out
+// RUN: %ACC_RUN_PLACEHOLDER %t.out
+
+// The waits of a queue polling its events before blocking see the results of
+// both the short kernels, which complete while polling, and the long ones.
+
+#include <CL/sycl.hpp>
+
+#include <iostream>
+
+using sycl::ext::oneapi::property::queue::spin_wait;
+
+int main() {
+  sycl::queue Q{sycl::property_list{spin_wait()}};
+  if (!Q.has_property<spin_wait>()) {
+    std::cerr << "Queue should have the spin_wait property" << std::endl;
+    return 1;
+  }
+
+  constexpr size_t N = 1 << 20;
+  int *Data = sycl::malloc_shared<int>(N, Q);
+
+  int Failures = 0;
+  for (size_t Size : {size_t(1), N}) {
+    for (int Iter = 0; Iter < 10; ++Iter) {
+      Q.parallel_for<class Fill>(sycl::range<1>{Size}, [=](sycl::id<1> I) {
+         Data[I] = Iter;
+       }).wait();
+      if (Data[0] != Iter || Data[Size - 1] != Iter) {
+        std::cerr << "Expected " << Iter << " for size " << Size << ", got "
+                  << Data[0] << " and " << Data[Size - 1] << std::endl;
+        ++Failures;
+      }
+    }
+  }
+  sycl::free(Data, Q);
+  return Failures;
+}
@@ -0,0 +1,58 @@
+// RUN: %clangxx -fsycl -fsycl-targets=%sycl_triple %s -o %t.out
+// RUN: %RUN_ON_HOST %t.out
+// RUN: %CPU_RUN_PLACEHOLDER %t.out
+// RUN: %GPU_RUN_PLACEHOLDER %t.out
+// RUN: %ACC_RUN_PLACEHOLDER %t.out
+
+// The kernels of a queue spreading them across the sub-devices see the same
+// memory and are ordered by their dependencies like on any other queue.
+
+#include <CL/sycl.hpp>
+
+#include <iostream>
+#include <vector>
+
+using sycl::ext::oneapi::property::queue::sub_device_scaling;
+
+int main() {
+  sycl::queue Q{sycl::property_list{sub_device_scaling()}};
+  if (!Q.has_property<sub_device_scaling>()) {
+    std::cerr << "Queue should have the sub_device_scaling property"
+              << std::endl;
+    return 1;
+  }
+
+  constexpr size_t N = 1024;
+  constexpr size_t Chunks = 8;
+  int *Data = sycl::malloc_shared<int>(N * Chunks, Q);
+
+  // Independent kernels, which may run on different sub-devices
+  std::vector<sycl::event> Fills;
+  for (size_t C = 0; C < Chunks; ++C) {
+    int *Chunk = Data + C * N;
+    Fills.push_back(Q.parallel_for<class Fill>(
+        sycl::nd_range<1>{N, 64},
+        [=](sycl::nd_item<1> It) {
+          Chunk[It.get_global_id(0)] = static_cast<int>(C);
+        }));
+  }
+  // A kernel depending on all of them
+  Q.submit([&](sycl::handler &CGH) {
+     CGH.depends_on(Fills);
+     CGH.parallel_for<class Add>(sycl::range<1>{N * Chunks},
+                                 [=](sycl::id<1> I) { Data[I] += 1; });
+   }).wait();
+
+  int Failures = 0;
+  for (size_t I = 0; I < N * Chunks; ++I) {
+    const int Expected = static_cast<int>(I / N) + 1;
+    if (Data[I] != Expected) {
+      std::cerr << "Expected " << Expected << " at " << I << ", got "
+                << Data[I] << std::endl;
+      ++Failures;
+      break;
+    }
+  }
+  sycl::free(Data, Q);
+  return Failures;
+}
@@ -0,0 +1,52 @@
+// RUN: %clangxx -fsycl -fsycl-targets=%sycl_triple %s -o %t.out
+// RUN: %CPU_RUN_PLACEHOLDER %t.out %CPU_CHECK_PLACEHOLDER
+// RUN: %GPU_RUN_ON_LINUX_PLACEHOLDER %t.out %GPU_CHECK_ON_LINUX_PLACEHOLDER
+// RUN: %ACC_RUN_PLACEHOLDER %t.out %ACC_CHECK_PLACEHOLDER
+
+// Check that stream buffers reused by consecutive kernels only print what the
+// current kernel has streamed, both for kernels of different sizes and when
+// the previous kernel streamed more data.
+
+#include <CL/sycl.hpp>
+
+#include <iostream>
+
+using namespace cl::sycl;
+
+int main() {
+  queue Queue;
+
+  for (size_t NumWI : {4, 1, 2}) {
+    Queue.submit([&](handler &CGH) {
+      stream Out(1024, 80, CGH);
+      CGH.parallel_for<class reuse_sizes>(
+          range<1>(NumWI), [=](id<1>) { Out << "Work item" << endl; });
+    });
+    Queue.wait();
+    std::cout << "--" << std::endl;
+  }
+  // CHECK: Work item
+  // CHECK-NEXT: Work item
+  // CHECK-NEXT: Work item
+  // CHECK-NEXT: Work item
+  // CHECK-NEXT: --
+  // CHECK-NEXT: Work item
+  // CHECK-NEXT: --
+  // CHECK-NEXT: Work item
+  // CHECK-NEXT: Work item
+  // CHECK-NEXT: --
+
+  // Submit without waiting, so that the next kernel runs while the output of
+  // the previous one may still be printed.
+  for (int I = 0; I < 3; ++I)
+    Queue.submit([&](handler &CGH) {
+      stream Out(1024, 80, CGH);
+      CGH.single_task<class reuse_async>([=]() { Out << "Kernel" << endl; });
+    });
+  Queue.wait();
+  // CHECK-NEXT: Kernel
+  // CHECK-NEXT: Kernel
+  // CHECK-NEXT: Kernel
+
+  return 0;
+}
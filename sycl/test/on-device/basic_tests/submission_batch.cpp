@@ -0,0 +1,85 @@
+// RUN: %clangxx -fsycl -fsycl-targets=%sycl_triple %s -o %t.out
+// RUN: %RUN_ON_HOST %t.out
+// RUN: %CPU_RUN_PLACEHOLDER %t.out
+// RUN: %GPU_RUN_PLACEHOLDER %t.out
+// RUN: %ACC_RUN_PLACEHOLDER %t.out
+
+// The command groups of a batch are only executed by its commit, in order and
+// with their dependencies on each other, whether they use USM or buffers.
+
+#include <CL/sycl.hpp>
+
+#include <iostream>
+
+constexpr size_t N = 256;
+constexpr size_t NumCGs = 64;
+
+int main() {
+  sycl::queue Q;
+  int *Data = sycl::malloc_shared<int>(N * NumCGs, Q);
+  sycl::buffer<int, 1> Buf{sycl::range<1>{N}};
+
+  sycl::ONEAPI::submission_batch Batch{Q};
+  // Independent USM kernels
+  for (size_t C = 0; C < NumCGs; ++C) {
+    int *Chunk = Data + C * N;
+    Batch.submit([&](sycl::handler &CGH) {
+      CGH.parallel_for<class Fill>(sycl::range<1>{N}, [=](sycl::id<1> I) {
+        Chunk[I] = static_cast<int>(C);
+      });
+    });
+  }
+  // A chain of kernels on a buffer, and a kernel depending on an event of
+  // the batch
+  sycl::event Init = Batch.submit([&](sycl::handler &CGH) {
+    auto Acc = Buf.get_access<sycl::access::mode::discard_write>(CGH);
+    CGH.parallel_for<class Init>(sycl::range<1>{N},
+                                 [=](sycl::id<1> I) { Acc[I] = 1; });
+  });
+  Batch.submit([&](sycl::handler &CGH) {
+    auto Acc = Buf.get_access<sycl::access::mode::read_write>(CGH);
+    CGH.parallel_for<class Double>(sycl::range<1>{N},
+                                   [=](sycl::id<1> I) { Acc[I] *= 2; });
+  });
+  Batch.submit([&](sycl::handler &CGH) {
+    CGH.depends_on(Init);
+    CGH.parallel_for<class Add>(sycl::range<1>{N},
+                                [=](sycl::id<1> I) { Data[I] += 1; });
+  });
+
+  if (Batch.size() != NumCGs + 3) {
+    std::cerr << "Expected " << NumCGs + 3 << " command groups in the batch, "
+              << "got " << Batch.size() << std::endl;
+    return 1;
+  }
+  std::vector<sycl::event> Events = Batch.commit();
+  if (Events.size() != NumCGs + 3 || Batch.size() != 0) {
+    std::cerr << "The commit returned " << Events.size() << " events"
+              << std::endl;
+    return 1;
+  }
+  for (sycl::event &Event : Events)
+    Event.wait();
+
+  int Failures = 0;
+  for (size_t I = 0; I < N * NumCGs; ++I) {
+    const int Expected = static_cast<int>(I / N) + (I < N ? 1 : 0);
+    if (Data[I] != Expected) {
+      std::cerr << "Expected " << Expected << " at " << I << ", got "
+                << Data[I] << std::endl;
+      ++Failures;
+      break;
+    }
+  }
+  auto Acc = Buf.get_access<sycl::access::mode::read>();
+  for (size_t I = 0; I < N; ++I) {
+    if (Acc[I] != 2) {
+      std::cerr << "Expected 2 in the buffer at " << I << ", got " << Acc[I]
+                << std::endl;
+      ++Failures;
+      break;
+    }
+  }
+  sycl::free(Data, Q);
+  return Failures;
+}
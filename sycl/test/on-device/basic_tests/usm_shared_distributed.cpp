@@ -0,0 +1,59 @@
+// RUN: %clangxx -fsycl -fsycl-targets=%sycl_triple %s -o %t.out
+// RUN: %RUN_ON_HOST %t.out
+// RUN: %CPU_RUN_PLACEHOLDER %t.out
+// RUN: %GPU_RUN_PLACEHOLDER %t.out
+// RUN: %ACC_RUN_PLACEHOLDER %t.out
+
+// A distributed shared allocation is a single allocation for the host and
+// for all the devices of the context, whichever device its stripes are on.
+
+#include <CL/sycl.hpp>
+
+#include <iostream>
+#include <vector>
+
+int main() {
+  sycl::queue Q;
+  sycl::context Context = Q.get_context();
+  std::vector<sycl::device> Devices = Context.get_devices();
+
+  // Small stripes, so that each device has several stripes
+  constexpr size_t StripeSize = 64 * 1024;
+  constexpr size_t StripeElems = StripeSize / sizeof(int);
+  const size_t NumStripes = 4 * Devices.size() + 1;
+  const size_t N = NumStripes * StripeElems - 3;
+  int *Data =
+      sycl::ONEAPI::malloc_shared_distributed<int>(N, Context, StripeSize);
+  if (!Data) {
+    std::cerr << "The distributed allocation failed" << std::endl;
+    return 1;
+  }
+  for (size_t I = 0; I < N; ++I)
+    Data[I] = static_cast<int>(I);
+
+  // Each device updates the stripes which are local to it
+  std::vector<sycl::event> Events;
+  for (size_t D = 0; D < Devices.size(); ++D) {
+    sycl::queue DeviceQueue{Context, Devices[D]};
+    const size_t NumDevices = Devices.size();
+    Events.push_back(DeviceQueue.parallel_for<class Stripes>(
+        sycl::range<1>{N}, [=](sycl::id<1> I) {
+          if ((I[0] / StripeElems) % NumDevices == D)
+            Data[I] += 1;
+        }));
+  }
+  for (sycl::event &Event : Events)
+    Event.wait();
+
+  int Failures = 0;
+  for (size_t I = 0; I < N; ++I) {
+    if (Data[I] != static_cast<int>(I) + 1) {
+      std::cerr << "Expected " << I + 1 << " at " << I << ", got " << Data[I]
+                << std::endl;
+      ++Failures;
+      break;
+    }
+  }
+  sycl::free(Data, Context);
+  return Failures;
+}
@@ -0,0 +1,113 @@
+// RUN: %clangxx -fsycl -fsycl-targets=%sycl_triple %s -o %t.out
+// RUN: %CPU_RUN_PLACEHOLDER %t.out
+// RUN: %GPU_RUN_PLACEHOLDER %t.out
+// RUN: %ACC_RUN_PLACEHOLDER %t.out
+
+// Group algorithms are not supported on host device.
+// RUNx: %RUN_ON_HOST %t.out
+
+// This test checks the device-wide scans, radix sort and histogram over USM
+// on sizes spanning many work-groups and not multiple of the tile sizes.
+
+#include <CL/sycl.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+using namespace cl::sycl;
+
+int checkScans(queue &Q, size_t N) {
+  int *In = malloc_shared<int>(N, Q);
+  int *Incl = malloc_shared<int>(N, Q);
+  int *Excl = malloc_shared<int>(N, Q);
+  for (size_t I = 0; I < N; ++I)
+    In[I] = static_cast<int>(I % 13) - 6;
+
+  ONEAPI::inclusive_scan(Q, In, In + N, Incl, ONEAPI::plus<int>()).wait();
+  ONEAPI::exclusive_scan(Q, In, In + N, Excl, 5, ONEAPI::plus<int>()).wait();
+
+  int Errors = 0;
+  int Sum = 0;
+  for (size_t I = 0; I < N; ++I) {
+    Errors += Excl[I] != Sum + 5;
+    Sum += In[I];
+    Errors += Incl[I] != Sum;
+  }
+  if (Errors)
+    std::cout << "Scans of " << N << " elements failed\n";
+  free(In, Q);
+  free(Incl, Q);
+  free(Excl, Q);
+  return Errors;
+}
+
+template <typename KeyT> int checkSort(queue &Q, size_t N) {
+  KeyT *Keys = malloc_shared<KeyT>(N, Q);
+  size_t *Values = malloc_shared<size_t>(N, Q);
+  std::vector<std::pair<KeyT, size_t>> Expected(N);
+  for (size_t I = 0; I < N; ++I) {
+    Keys[I] = static_cast<KeyT>((I * 7919) % 1009) - static_cast<KeyT>(500);
+    Values[I] = I;
+    Expected[I] = {Keys[I], I};
+  }
+  // The sort is stable, so the pairs are ordered as by std::stable_sort.
+  std::stable_sort(Expected.begin(), Expected.end(),
+                   [](const std::pair<KeyT, size_t> &A,
+                      const std::pair<KeyT, size_t> &B) {
+                     return A.first < B.first;
+                   });
+
+  ONEAPI::radix_sort_by_key(Q, Keys, Values, N).wait();
+
+  int Errors = 0;
+  for (size_t I = 0; I < N; ++I)
+    Errors +=
+        Keys[I] != Expected[I].first || Values[I] != Expected[I].second;
+  if (Errors)
+    std::cout << "Sort of " << N << " elements failed\n";
+  free(Keys, Q);
+  free(Values, Q);
+  return Errors;
+}
+
+int checkHistogram(queue &Q, size_t N) {
+  constexpr size_t NumBins = 10;
+  float *In = malloc_shared<float>(N, Q);
+  uint32_t *Bins = malloc_shared<uint32_t>(NumBins, Q);
+  std::vector<uint32_t> Expected(NumBins, 0);
+  for (size_t I = 0; I < N; ++I) {
+    // Some values are out of the range of the bins.
+    In[I] = static_cast<float>(I % 12) - 1.0f;
+    if (In[I] >= 0.0f && In[I] < 10.0f)
+      ++Expected[static_cast<size_t>(In[I])];
+  }
+  std::fill(Bins, Bins + NumBins, 0);
+
+  ONEAPI::histogram(Q, In, In + N, Bins, NumBins, 0.0f, 10.0f).wait();
+
+  int Errors = 0;
+  for (size_t B = 0; B < NumBins; ++B)
+    Errors += Bins[B] != Expected[B];
+  if (Errors)
+    std::cout << "Histogram of " << N << " elements failed\n";
+  free(In, Q);
+  free(Bins, Q);
+  return Errors;
+}
+
+int main() {
+  queue Q;
+  int Errors = 0;
+  for (size_t N : {1, 1000, 100003}) {
+    Errors += checkScans(Q, N);
+    Errors += checkSort<int>(Q, N);
+    Errors += checkSort<unsigned short>(Q, N);
+    Errors += checkHistogram(Q, N);
+  }
+  if (Errors)
+    return 1;
+  std::cout << "Test passed\n";
+  return 0;
+}
@@ -0,0 +1,101 @@
+// REQUIRES: cuda
+// RUN: %clangxx -fsycl -fsycl-targets=%sycl_triple -Xsycl-target-backend --cuda-gpu-arch=sm_70 %s -o %t.out
+// RUN: %GPU_RUN_PLACEHOLDER %t.out
+
+// Multiplies half matrices with joint_matrix, checks the result against a host
+// reference and reports the achieved throughput.
+
+#include <CL/sycl.hpp>
+#include <CL/sycl/ONEAPI/experimental/matrix.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using namespace cl::sycl;
+using namespace cl::sycl::ONEAPI::experimental::matrix;
+
+constexpr size_t TM = 16;
+constexpr size_t TN = 16;
+constexpr size_t TK = 16;
+constexpr size_t SGSize = 32;
+
+constexpr size_t M = 1024;
+constexpr size_t N = 1024;
+constexpr size_t K = 1024;
+
+int main() {
+  // Small integers keep every product and sum exact in float.
+  std::vector<half> HostA(M * K), HostB(K * N);
+  std::vector<float> HostC(M * N, 0.0f), Ref(M * N, 0.0f);
+  for (size_t I = 0; I < M * K; ++I)
+    HostA[I] = static_cast<float>(static_cast<int>(I % 5) - 2);
+  for (size_t I = 0; I < K * N; ++I)
+    HostB[I] = static_cast<float>(static_cast<int>(I % 3) - 1);
+
+  queue Q;
+  double Seconds = 0;
+  {
+    buffer<half, 1> BufA(HostA.data(), range<1>(M * K));
+    buffer<half, 1> BufB(HostB.data(), range<1>(K * N));
+    buffer<float, 1> BufC(HostC.data(), range<1>(M * N));
+
+    auto Start = std::chrono::steady_clock::now();
+    Q.submit([&](handler &CGH) {
+      auto A = BufA.get_access<access::mode::read_write>(CGH);
+      auto B = BufB.get_access<access::mode::read_write>(CGH);
+      auto C = BufC.get_access<access::mode::read_write>(CGH);
+      // Each sub-group computes one TM x TN tile of C.
+      CGH.parallel_for<class HalfMatmul>(
+          nd_range<2>(range<2>(M / TM, N / TN * SGSize), range<2>(1, SGSize)),
+          [=](nd_item<2> It) {
+            ONEAPI::sub_group SG = It.get_sub_group();
+            const size_t TileRow = It.get_global_id(0);
+            const size_t TileCol = It.get_group(1);
+
+            joint_matrix<half, TM, TK> SubA(SG);
+            joint_matrix<half, TK, TN, matrix_layout::packed_b> SubB(SG);
+            joint_matrix<float, TM, TN> SubC(SG);
+            joint_matrix_load(SG, SubC,
+                              C.get_pointer() + TileRow * TM * N + TileCol * TN,
+                              N, matrix_layout::row_major);
+            for (size_t KK = 0; KK < K; KK += TK) {
+              joint_matrix_load(SG, SubA,
+                                A.get_pointer() + TileRow * TM * K + KK, K,
+                                matrix_layout::row_major);
+              joint_matrix_load(SG, SubB,
+                                B.get_pointer() + KK * N + TileCol * TN, N,
+                                matrix_layout::row_major);
+              SubC = joint_matrix_mad(SG, SubA, SubB, SubC);
+            }
+            joint_matrix_store(SG, SubC,
+                               C.get_pointer() + TileRow * TM * N +
+                                   TileCol * TN,
+                               N, matrix_layout::row_major);
+          });
+    });
+    Q.wait_and_throw();
+    Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                            Start)
+                  .count();
+  }
+
+  for (size_t I = 0; I < M; ++I)
+    for (size_t KK = 0; KK < K; ++KK) {
+      const float AVal = HostA[I * K + KK];
+      for (size_t J = 0; J < N; ++J)
+        Ref[I * N + J] += AVal * static_cast<float>(HostB[KK * N + J]);
+    }
+
+  for (size_t I = 0; I < M * N; ++I) {
+    if (HostC[I] != Ref[I]) {
+      std::cout << "Mismatch at " << I << ": " << HostC[I]
+                << " != " << Ref[I] << std::endl;
+      return 1;
+    }
+  }
+
+  std::cout << "GFLOPS: " << 2.0 * M * N * K / Seconds / 1e9 << std::endl;
+  std::cout << "Test passed" << std::endl;
+  return 0;
+}
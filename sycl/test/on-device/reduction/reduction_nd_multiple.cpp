@@ -0,0 +1,82 @@
+// RUN: %clangxx -fsycl -fsycl-targets=%sycl_triple %s -o %t.out
+// RUN: env SYCL_PI_TRACE=2 %CPU_RUN_PLACEHOLDER %t.out 2>&1 %CPU_CHECK_PLACEHOLDER
+// RUN: %GPU_RUN_PLACEHOLDER %t.out
+// RUN: %ACC_RUN_PLACEHOLDER %t.out
+
+// RUNx: %RUN_ON_HOST %t.out
+// TODO: Enable the test for HOST when it supports barrier()
+
+// This test checks that parallel_for(nd_range, reduction..., func) performs
+// several reductions of different types, operations and access modes in
+// a single kernel.
+
+#include <CL/sycl.hpp>
+
+#include <iostream>
+
+using namespace cl::sycl;
+
+struct XorOp {
+  int operator()(int A, int B) const { return A ^ B; }
+};
+
+template <typename RangeT> class MultipleReductions;
+
+template <typename RangeT> int test(queue &Q, RangeT Range) {
+  size_t N = Range.get_global_range().size();
+  float Sum = 1.0f;
+  int Xor = 0;
+  int *Max = malloc_shared<int>(1, Q);
+  *Max = -1;
+  {
+    buffer<float, 1> SumBuf(&Sum, range<1>(1));
+    buffer<int, 1> XorBuf(&Xor, range<1>(1));
+    Q.submit([&](handler &CGH) {
+      auto SumAcc = SumBuf.get_access<access::mode::read_write>(CGH);
+      auto XorAcc = XorBuf.get_access<access::mode::discard_write>(CGH);
+      CGH.parallel_for<MultipleReductions<RangeT>>(
+          Range, ONEAPI::reduction(SumAcc, ONEAPI::plus<float>()),
+          ONEAPI::reduction(XorAcc, 0, XorOp()),
+          ONEAPI::reduction(Max, ONEAPI::maximum<int>()),
+          [=](auto NDIt, auto &SumRed, auto &XorRed, auto &MaxRed) {
+            int I = static_cast<int>(NDIt.get_global_linear_id());
+            SumRed.combine(1.0f);
+            XorRed.combine(I);
+            MaxRed.combine(I);
+          });
+    });
+  }
+
+  int ExpectedXor = 0;
+  for (size_t I = 0; I < N; ++I)
+    ExpectedXor ^= static_cast<int>(I);
+
+  int Error = 0;
+  if (Sum != 1.0f + N || Xor != ExpectedXor ||
+      *Max != static_cast<int>(N - 1)) {
+    std::cout << "Error: Sum = " << Sum << ", Xor = " << Xor
+              << ", Max = " << *Max << "\n";
+    Error = 1;
+  }
+  free(Max, Q);
+  return Error;
+}
+
+int main() {
+  queue Q;
+  int Error = test(Q, nd_range<1>{range<1>{64 * 16}, range<1>{16}});
+  std::cout << "end of pow2 test" << std::endl;
+  // The work-group size is not a power of two.
+  Error += test(Q, nd_range<2>{range<2>{21, 10}, range<2>{7, 5}});
+  if (Error)
+    return 1;
+  std::cout << "Test passed\n";
+  return 0;
+}
+
+// CHECK: ---> piEnqueueKernelLaunch
+// CHECK-NOT: ---> piEnqueueKernelLaunch
+// CHECK: end of pow2 test
+// CHECK: ---> piEnqueueKernelLaunch
+// CHECK-NOT: ---> piEnqueueKernelLaunch
+// CHECK: Test passed
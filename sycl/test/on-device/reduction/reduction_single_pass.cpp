@@ -0,0 +1,70 @@
+// RUN: %clangxx -fsycl -fsycl-targets=%sycl_triple %s -o %t.out
+// RUN: env SYCL_PI_TRACE=2 %CPU_RUN_PLACEHOLDER %t.out 2>&1 %CPU_CHECK_PLACEHOLDER
+
+// RUNx: %RUN_ON_HOST %t.out
+// TODO: Enable the test for HOST when it supports ONEAPI::reduce() and
+// barrier()
+
+// This test checks that parallel_for(nd_range, reduction, func) with many
+// work-groups and an operation without fast atomics is done by a single
+// kernel, both for a type with fast reduce and for a custom operation.
+
+#include <CL/sycl.hpp>
+
+#include <iostream>
+
+using namespace cl::sycl;
+
+struct XorOp {
+  int operator()(int A, int B) const { return A ^ B; }
+};
+
+int main() {
+  queue Q;
+  constexpr size_t NWorkGroups = 64;
+  constexpr size_t WGSize = 16;
+  nd_range<1> Range{range<1>{NWorkGroups * WGSize}, range<1>{WGSize}};
+
+  float Sum = 1.0f;
+  {
+    buffer<float, 1> SumBuf(&Sum, range<1>(1));
+    Q.submit([&](handler &CGH) {
+      auto SumAcc = SumBuf.get_access<access::mode::read_write>(CGH);
+      CGH.parallel_for<class SinglePassPlus>(
+          Range, ONEAPI::reduction(SumAcc, ONEAPI::plus<float>()),
+          [=](nd_item<1> NDIt, auto &Red) { Red.combine(1.0f); });
+    });
+  }
+  std::cout << "end of plus" << std::endl;
+
+  int Xor = 0;
+  {
+    buffer<int, 1> XorBuf(&Xor, range<1>(1));
+    Q.submit([&](handler &CGH) {
+      auto XorAcc = XorBuf.get_access<access::mode::discard_write>(CGH);
+      CGH.parallel_for<class SinglePassXor>(
+          Range, ONEAPI::reduction(XorAcc, 0, XorOp()),
+          [=](nd_item<1> NDIt, auto &Red) {
+            Red.combine(static_cast<int>(NDIt.get_global_linear_id()));
+          });
+    });
+  }
+
+  int ExpectedXor = 0;
+  for (size_t I = 0; I < NWorkGroups * WGSize; ++I)
+    ExpectedXor ^= static_cast<int>(I);
+
+  if (Sum != 1.0f + NWorkGroups * WGSize || Xor != ExpectedXor) {
+    std::cout << "Error: Sum = " << Sum << ", Xor = " << Xor << "\n";
+    return 1;
+  }
+  std::cout << "Test passed\n";
+  return 0;
+}
+
+// CHECK: ---> piEnqueueKernelLaunch
+// CHECK-NOT: ---> piEnqueueKernelLaunch
+// CHECK: end of plus
+// CHECK: ---> piEnqueueKernelLaunch
+// CHECK-NOT: ---> piEnqueueKernelLaunch
+// CHECK: Test passed
@@ -0,0 +1,65 @@
+// UNSUPPORTED: cuda
+//
+// RUN: %clangxx -fsycl -fsycl-targets=%sycl_triple %s -o %t.out
+// RUN: %RUN_ON_HOST %t.out
+// RUN: %CPU_RUN_PLACEHOLDER %t.out
+// RUN: %GPU_RUN_PLACEHOLDER %t.out
+//
+//==----------- specialized_kernel.cpp -------------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+// The test checks that the kernels specialized by the launch constants of
+// each launch compute with the values of that launch, also when the same
+// values are used again.
+
+#include <CL/sycl.hpp>
+
+#include <iostream>
+
+using namespace sycl;
+using ONEAPI::experimental::specialized_kernel;
+
+class Size;
+class Stride;
+class Scale;
+
+int main() {
+  queue Q;
+  constexpr int MaxSize = 64;
+  int *Data = malloc_shared<int>(MaxSize, Q);
+
+  int Failures = 0;
+  const int Shapes[][2] = {{8, 1}, {16, 2}, {8, 1}, {32, 2}, {16, 2}};
+  for (const auto &Shape : Shapes) {
+    for (int I = 0; I < MaxSize; ++I)
+      Data[I] = I;
+
+    specialized_kernel<Scale> Specialized(Q.get_context());
+    auto N = Specialized.specialize<Size>(Shape[0]);
+    auto S = Specialized.specialize<Stride>(Shape[1]);
+    Q.submit([&](handler &CGH) {
+       CGH.single_task<Scale>(Specialized.get_kernel(), [=]() {
+         for (int I = 0; I < N.get(); I += S.get())
+           Data[I] *= 2;
+       });
+     }).wait();
+
+    for (int I = 0; I < MaxSize; ++I) {
+      const bool Scaled = I < Shape[0] && I % Shape[1] == 0;
+      const int Expected = Scaled ? I * 2 : I;
+      if (Data[I] != Expected) {
+        std::cerr << "size " << Shape[0] << ", stride " << Shape[1]
+                  << ": expected " << Expected << " at " << I << ", got "
+                  << Data[I] << std::endl;
+        ++Failures;
+      }
+    }
+  }
+
+  free(Data, Q);
+  return Failures;
+}
@@ -0,0 +1,93 @@
+// UNSUPPORTED: cpu
+// #2252 Disable until all variants of built-ins are available in OpenCL CPU
+// runtime for every supported ISA
+//
+// RUN: %clangxx -fsycl -fsycl-targets=%sycl_triple %s -o %t.out
+// RUN: %GPU_RUN_PLACEHOLDER %t.out
+// RUN: %ACC_RUN_PLACEHOLDER %t.out
+//==-- reduce_scan_range.cpp - SYCL reduce and scan over ranges test ------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// The test checks reduce() and scans over ranges whose lengths are not
+// multiples of the tiles processed by work-items, and the sub-group reduce()
+// over unaligned global memory.
+
+#include "helper.hpp"
+
+#include <numeric>
+
+template <typename T> class range_algorithms;
+
+template <typename T> void check(queue &Queue) {
+  constexpr size_t N = 1001;
+  constexpr size_t G = 64;
+  std::vector<T> Input(N);
+  for (size_t I = 0; I < N; ++I)
+    Input[I] = static_cast<T>(I % 7);
+  std::vector<T> Exclusive(N), Inclusive(N);
+  T GroupSum = 0, SubGroupSum = 0;
+  {
+    buffer<T> InBuf(Input.data(), range<1>(N));
+    buffer<T> ExBuf(Exclusive.data(), range<1>(N));
+    buffer<T> InclBuf(Inclusive.data(), range<1>(N));
+    buffer<T> GroupSumBuf(&GroupSum, range<1>(1));
+    buffer<T> SubGroupSumBuf(&SubGroupSum, range<1>(1));
+    Queue.submit([&](handler &CGH) {
+      auto In = InBuf.template get_access<access::mode::read>(CGH);
+      auto Ex = ExBuf.template get_access<access::mode::discard_write>(CGH);
+      auto Incl = InclBuf.template get_access<access::mode::discard_write>(CGH);
+      auto GSum =
+          GroupSumBuf.template get_access<access::mode::discard_write>(CGH);
+      auto SGSum =
+          SubGroupSumBuf.template get_access<access::mode::discard_write>(CGH);
+      CGH.parallel_for<range_algorithms<T>>(
+          nd_range<1>(G, G), [=](nd_item<1> NDIt) {
+            group<1> G = NDIt.get_group();
+            auto First = In.get_pointer();
+            auto Last = First + N;
+            ONEAPI::exclusive_scan(G, First, Last, Ex.get_pointer(),
+                                   ONEAPI::plus<>());
+            ONEAPI::inclusive_scan(G, First, Last, Incl.get_pointer(),
+                                   ONEAPI::plus<>());
+            T Sum = ONEAPI::reduce(G, First, Last, ONEAPI::plus<>());
+            // Start from an unaligned address to check the elements before
+            // the first block read.
+            ONEAPI::sub_group SG = NDIt.get_sub_group();
+            T SGReduced = ONEAPI::reduce(SG, First + 1, Last, ONEAPI::plus<>());
+            if (NDIt.get_local_id(0) == 0) {
+              GSum[0] = Sum;
+              SGSum[0] = SGReduced;
+            }
+          });
+    });
+  }
+
+  std::vector<T> Expected(N);
+  std::partial_sum(Input.begin(), Input.end(), Expected.begin());
+  T Total = Expected[N - 1];
+  exit_if_not_equal(GroupSum, Total, "reduce");
+  exit_if_not_equal(SubGroupSum, Total - Input[0], "sub-group reduce");
+  for (size_t I = 0; I < N; ++I) {
+    exit_if_not_equal(Inclusive[I], Expected[I], "inclusive_scan");
+    exit_if_not_equal(Exclusive[I], I ? Expected[I - 1] : T(0),
+                      "exclusive_scan");
+  }
+}
+
+int main() {
+  queue Queue;
+  if (!core_sg_supported(Queue.get_device())) {
+    std::cout << "Skipping test\n";
+    return 0;
+  }
+  check<int>(Queue);
+  check<unsigned int>(Queue);
+  check<float>(Queue);
+  std::cout << "Test passed." << std::endl;
+  return 0;
+}
@@ -0,0 +1,64 @@
+// REQUIRES: gpu, level_zero
+
+// RUN: %clangxx -fsycl -fsycl-targets=%sycl_triple %s -o %t.out
+// RUN: env SYCL_PI_LEVEL_ZERO_USE_COPY_ENGINE=1 %GPU_RUN_PLACEHOLDER %t.out
+// RUN: env SYCL_PI_LEVEL_ZERO_USE_COPY_ENGINE=0 %GPU_RUN_PLACEHOLDER %t.out
+
+// level_zero_copy_engine.cpp
+//
+// This tests the offload of memory copies and fills to the copy engine of
+// the device. Transfers to and from the device are interleaved with kernels
+// which depend on them, so that the result is only correct if the commands
+// on the copy and compute engines are ordered by their events.
+
+#include <CL/sycl.hpp>
+
+#include <iostream>
+#include <vector>
+
+using namespace cl::sycl;
+
+int main() {
+  queue Q;
+  constexpr size_t N = 1024;
+  constexpr int Iterations = 8;
+
+  std::vector<int> Host(N);
+  int *Dev = malloc_device<int>(N, Q);
+
+  for (int I = 0; I < Iterations; ++I) {
+    event Fill = Q.fill(Dev, I, N);
+    event Kernel = Q.submit([&](handler &CGH) {
+      CGH.depends_on(Fill);
+      CGH.parallel_for<class Increment>(
+          range<1>(N), [=](id<1> Idx) { Dev[Idx] += Idx[0]; });
+    });
+    Q.submit([&](handler &CGH) {
+       CGH.depends_on(Kernel);
+       CGH.memcpy(Host.data(), Dev, N * sizeof(int));
+     }).wait();
+
+    for (size_t J = 0; J < N; ++J)
+      if (Host[J] != I + static_cast<int>(J)) {
+        std::cout << "Error at " << J << ": " << Host[J] << std::endl;
+        return 1;
+      }
+  }
+
+  {
+    buffer<int, 1> Buf(Host.data(), range<1>(N));
+    Q.submit([&](handler &CGH) {
+      auto Acc = Buf.get_access<access::mode::discard_write>(CGH);
+      CGH.fill(Acc, 42);
+    });
+  }
+  for (size_t J = 0; J < N; ++J)
+    if (Host[J] != 42) {
+      std::cout << "Error at " << J << ": " << Host[J] << std::endl;
+      return 1;
+    }
+
+  free(Dev, Q);
+  std::cout << "Test Passed" << std::endl;
+  return 0;
+}
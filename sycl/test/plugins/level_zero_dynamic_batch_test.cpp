@@ -5,6 +5,9 @@
 // Check that dynamic batching increases batch size
 // RUN: env SYCL_PI_TRACE=2 ZE_DEBUG=1 %GPU_RUN_PLACEHOLDER %t.out 2>&1 | FileCheck --check-prefixes=CKALL,CKDYNUP %s
 
+// Check that batches are also closed by the latency target
+// RUN: env SYCL_PI_LEVEL_ZERO_BATCH_LATENCY_US=1 ZE_DEBUG=1 %GPU_RUN_PLACEHOLDER %t.out 2>&1 | FileCheck --check-prefixes=CKALL,CKLAT %s
+
 // level_zero_dynamic_batch_test.cpp
 //
 // This tests the level zero plugin's kernel dyanmic batch size adjustment
@@ -33,6 +36,7 @@
 // CKALL: Test Pass
 // CKALL: Test Pass
 // CKALL: Test Pass
+// CKLAT: piQueueRelease NumBatchesExecuted {{[0-9]+}}, NumBatchedCommands {{[0-9]+}}, NumTimesClosedByLatency {{[1-9][0-9]*}}
 
 #include "CL/sycl.hpp"
 #include <chrono>
@@ -0,0 +1,44 @@
+// REQUIRES: gpu, level_zero
+
+// RUN: %clangxx -fsycl -fsycl-targets=%sycl_triple %s -o %t.out
+// RUN: env SYCL_PI_LEVEL_ZERO_USE_IMMEDIATE_COMMANDLISTS=1 SYCL_PI_TRACE=2 ZE_DEBUG=1 %GPU_RUN_PLACEHOLDER %t.out 2>&1 | FileCheck %s
+
+// level_zero_immediate_command_lists.cpp
+//
+// This tests the immediate command lists mode of the level zero plugin.
+// Kernels are appended to the immediate command list of the queue, so no
+// regular command lists are closed or executed and no fences are created.
+
+#include <CL/sycl.hpp>
+
+#include <iostream>
+
+using namespace cl::sycl;
+
+// CHECK-NOT: zeCommandListClose
+// CHECK-NOT: zeCommandQueueExecuteCommandLists
+// CHECK-NOT: zeFenceCreate
+// CHECK: Test Passed
+
+int main() {
+  queue Q;
+  constexpr size_t N = 16;
+  int *Data = malloc_shared<int>(N, Q);
+
+  for (size_t I = 0; I < N; ++I)
+    Data[I] = 0;
+  for (int I = 0; I < 8; ++I)
+    Q.parallel_for<class Increment>(range<1>(N),
+                                    [=](id<1> Idx) { Data[Idx] += 1; });
+  Q.wait();
+
+  for (size_t I = 0; I < N; ++I)
+    if (Data[I] != 8) {
+      std::cout << "Error at " << I << ": " << Data[I] << std::endl;
+      return 1;
+    }
+
+  free(Data, Q);
+  std::cout << "Test Passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,53 @@
+// REQUIRES: gpu, level_zero
+
+// RUN: %clangxx -fsycl -fsycl-targets=%sycl_triple %s -o %t.out
+// RUN: env SYCL_PI_LEVEL_ZERO_USE_MULTIPLE_COMPUTE_QUEUES=1 %GPU_RUN_PLACEHOLDER %t.out
+// RUN: env SYCL_PI_LEVEL_ZERO_USE_MULTIPLE_COMPUTE_QUEUES=1 SYCL_PI_LEVEL_ZERO_BATCH_SIZE=1 %GPU_RUN_PLACEHOLDER %t.out
+
+// level_zero_multiple_compute_queues.cpp
+//
+// This tests spreading the command lists of a queue across all the command
+// queues of the compute group. Independent kernels may run on any of them,
+// while chains of dependent kernels must still be ordered by their events.
+
+#include <CL/sycl.hpp>
+
+#include <iostream>
+
+using namespace cl::sycl;
+
+int main() {
+  queue Q;
+  constexpr size_t N = 64;
+  constexpr size_t Chunks = 16;
+  constexpr int ChainLength = 4;
+  int *Data = malloc_shared<int>(N * Chunks, Q);
+
+  for (size_t I = 0; I < N * Chunks; ++I)
+    Data[I] = 0;
+
+  for (size_t C = 0; C < Chunks; ++C) {
+    event Prev;
+    for (int L = 0; L < ChainLength; ++L) {
+      Prev = Q.submit([&](handler &CGH) {
+        CGH.depends_on(Prev);
+        int *Chunk = Data + C * N;
+        CGH.parallel_for<class Step>(
+            range<1>(N), [=](id<1> Idx) { Chunk[Idx] = Chunk[Idx] * 2 + 1; });
+      });
+    }
+  }
+  Q.wait();
+
+  // Every element went through ChainLength steps of x = 2x + 1 in order.
+  const int Expected = (1 << ChainLength) - 1;
+  for (size_t I = 0; I < N * Chunks; ++I)
+    if (Data[I] != Expected) {
+      std::cout << "Error at " << I << ": " << Data[I] << std::endl;
+      return 1;
+    }
+
+  free(Data, Q);
+  std::cout << "Test Passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,55 @@
+// REQUIRES: gpu, level_zero
+
+// RUN: %clangxx -fsycl -fsycl-targets=%sycl_triple %s -o %t.out
+// RUN: env SYCL_PI_LEVEL_ZERO_USM_ALLOCATOR="256M;device:64M,4;host:64M,4;shared:64M,4" SYCL_PI_LEVEL_ZERO_USM_ALLOCATOR_TRACE=1 %GPU_RUN_PLACEHOLDER %t.out 2>&1 | FileCheck %s
+// RUN: env SYCL_PI_LEVEL_ZERO_DISABLE_USM_ALLOCATOR=1 %GPU_RUN_PLACEHOLDER %t.out
+
+// level_zero_usm_allocator.cpp
+//
+// This tests the configuration of the USM pools. Large allocations are
+// pooled when their size is within the configured MaxPoolableSize, so the
+// repeated allocations of the same size are served by the slabs kept in the
+// pools.
+
+#include <CL/sycl.hpp>
+
+#include <iostream>
+
+using namespace cl::sycl;
+
+// CHECK: Test Passed
+// CHECK-DAG: host pool statistics:
+// CHECK-DAG: shared pool statistics:
+// CHECK-DAG: device pool statistics:
+// CHECK-DAG: bucket 33554432: allocs 8, allocs from pool 7, frees 8
+
+int main() {
+  queue Q;
+  constexpr size_t Size = 32 * 1024 * 1024;
+  constexpr int Iterations = 8;
+
+  for (int I = 0; I < Iterations; ++I) {
+    char *Dev = malloc_device<char>(Size, Q);
+    char *Host = malloc_host<char>(Size, Q);
+    char *Shared = malloc_shared<char>(Size, Q);
+    if (!Dev || !Host || !Shared) {
+      std::cout << "Allocation failed" << std::endl;
+      return 1;
+    }
+
+    Q.memset(Dev, I, Size).wait();
+    Q.memcpy(Host, Dev, Size).wait();
+    Q.memcpy(Shared, Host, Size).wait();
+    if (Shared[0] != I || Shared[Size - 1] != I) {
+      std::cout << "Error at iteration " << I << std::endl;
+      return 1;
+    }
+
+    free(Dev, Q);
+    free(Host, Q);
+    free(Shared, Q);
+  }
+
+  std::cout << "Test Passed" << std::endl;
+  return 0;
+}
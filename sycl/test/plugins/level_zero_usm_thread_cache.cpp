@@ -0,0 +1,52 @@
+// REQUIRES: gpu, level_zero
+
+// RUN: %clangxx -fsycl -fsycl-targets=%sycl_triple %s -o %t.out -lpthread
+// RUN: %GPU_RUN_PLACEHOLDER %t.out
+// RUN: env SYCL_PI_LEVEL_ZERO_USM_ALLOCATOR_THREAD_CACHE=1 %GPU_RUN_PLACEHOLDER %t.out
+// RUN: env SYCL_PI_LEVEL_ZERO_USM_ALLOCATOR_THREAD_CACHE=0 %GPU_RUN_PLACEHOLDER %t.out
+
+// level_zero_usm_thread_cache.cpp
+//
+// This tests the thread caches of the USM pools. Many threads allocate and
+// free small device allocations, which are mostly served by the free chunks
+// kept by each thread, and check that a kernel sees its own allocation only.
+
+#include <CL/sycl.hpp>
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace cl::sycl;
+
+int main() {
+  queue Q;
+  constexpr int NumThreads = 32;
+  constexpr int Iterations = 64;
+  std::atomic<int> Errors{0};
+
+  std::vector<std::thread> Threads;
+  for (int T = 0; T < NumThreads; ++T)
+    Threads.emplace_back([&, T] {
+      for (int I = 0; I < Iterations; ++I) {
+        const size_t N = 1 + (T * Iterations + I) % 256;
+        int *Dev = malloc_device<int>(N, Q);
+        Q.fill(Dev, T, N).wait();
+        int Last = -1;
+        Q.memcpy(&Last, Dev + N - 1, sizeof(int)).wait();
+        if (Last != T)
+          ++Errors;
+        free(Dev, Q);
+      }
+    });
+  for (auto &Thread : Threads)
+    Thread.join();
+
+  if (Errors) {
+    std::cout << "Errors: " << Errors << std::endl;
+    return 1;
+  }
+  std::cout << "Test Passed" << std::endl;
+  return 0;
+}
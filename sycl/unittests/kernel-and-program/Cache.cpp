@@ -17,6 +17,7 @@
 
 #include <atomic>
 #include <iostream>
+#include <limits>
 
 using namespace sycl;
 
@@ -394,3 +395,213 @@ TEST_F(KernelAndProgramCacheTest, KernelNegativeSource) {
       CtxImpl->getKernelProgramCache().acquireKernelsPerProgramCache().get();
   EXPECT_EQ(Cache.size(), 0) << "Expect empty cache for kernels";
 }
+
+static int ProgramReleaseCount = 0;
+
+static pi_result redefinedProgramRelease(pi_program program) {
+  ++ProgramReleaseCount;
+  return PI_SUCCESS;
+}
+
+// Check that the least recently used specialized builds beyond the limit are
+// evicted unless they are pinned.
+TEST_F(KernelAndProgramCacheTest, SpecializedBuildsLRU) {
+  if (Plt.is_host() || Plt.get_backend() != backend::opencl) {
+    return;
+  }
+
+  Mock->redefine<detail::PiApiKind::piProgramRelease>(redefinedProgramRelease);
+  ProgramReleaseCount = 0;
+
+  context Ctx{Plt};
+  auto CtxImpl = detail::getSyclObjImpl(Ctx);
+  detail::KernelProgramCache &Cache = CtxImpl->getKernelProgramCache();
+  detail::RT::PiDevice Device =
+      detail::getSyclObjImpl(Ctx.get_devices()[0])->getHandleRef();
+
+  using ProgramCacheKeyT = detail::KernelProgramCache::ProgramCacheKeyT;
+  using PiProgramT = detail::KernelProgramCache::PiProgramT;
+  std::vector<ProgramCacheKeyT> Keys;
+  {
+    auto LockedCache = Cache.acquireCachedPrograms();
+    for (uintptr_t I = 1; I <= 3; ++I) {
+      ProgramCacheKeyT Key{{{static_cast<unsigned char>(I)}, 1}, Device};
+      LockedCache.get().emplace(
+          std::piecewise_construct, std::forward_as_tuple(Key),
+          std::forward_as_tuple(reinterpret_cast<PiProgramT *>(I),
+                                detail::BS_Done));
+      Keys.push_back(Key);
+    }
+  }
+
+  const detail::KernelProgramCache::SpecializedBuildLimits Limits{
+      2, std::numeric_limits<size_t>::max(),
+      std::numeric_limits<size_t>::max()};
+  EXPECT_NE(Cache.useSpecializedBuild(Keys[0], /*Pin=*/true, Limits), nullptr);
+  EXPECT_NE(Cache.useSpecializedBuild(Keys[1], /*Pin=*/false, Limits),
+            nullptr);
+  EXPECT_NE(Cache.useSpecializedBuild(Keys[2], /*Pin=*/false, Limits),
+            nullptr);
+  // The first build is pinned, so the second one is evicted.
+  EXPECT_EQ(ProgramReleaseCount, 1);
+  EXPECT_EQ(Cache.useSpecializedBuild(Keys[1], /*Pin=*/false, Limits),
+            nullptr);
+
+  Cache.unpinSpecializedBuild(reinterpret_cast<PiProgramT *>(1));
+  const detail::KernelProgramCache::SpecializedBuildLimits OneBuild{
+      1, std::numeric_limits<size_t>::max(),
+      std::numeric_limits<size_t>::max()};
+  EXPECT_NE(Cache.useSpecializedBuild(Keys[2], /*Pin=*/false, OneBuild),
+            nullptr);
+  EXPECT_EQ(ProgramReleaseCount, 2);
+
+  detail::KernelProgramCache::SpecializedBuildStats Stats =
+      Cache.getSpecializedBuildStats();
+  EXPECT_EQ(Stats.Hits, 1u);
+  EXPECT_EQ(Stats.Misses, 3u);
+  EXPECT_EQ(Stats.Evictions, 2u);
+  EXPECT_EQ(Stats.Builds, 1u);
+}
+
+// Check that the specialized builds of all the kernel sets are evicted least
+// recently used first once the cache holds too many of them or too many bytes.
+TEST_F(KernelAndProgramCacheTest, SpecializedBuildsCapacity) {
+  if (Plt.is_host() || Plt.get_backend() != backend::opencl) {
+    return;
+  }
+
+  Mock->redefine<detail::PiApiKind::piProgramRelease>(redefinedProgramRelease);
+  ProgramReleaseCount = 0;
+
+  context Ctx{Plt};
+  auto CtxImpl = detail::getSyclObjImpl(Ctx);
+  detail::KernelProgramCache &Cache = CtxImpl->getKernelProgramCache();
+  detail::RT::PiDevice Device =
+      detail::getSyclObjImpl(Ctx.get_devices()[0])->getHandleRef();
+
+  using ProgramCacheKeyT = detail::KernelProgramCache::ProgramCacheKeyT;
+  using PiProgramT = detail::KernelProgramCache::PiProgramT;
+  std::vector<ProgramCacheKeyT> Keys;
+  {
+    auto LockedCache = Cache.acquireCachedPrograms();
+    // Each build is of a different kernel set.
+    for (uintptr_t I = 1; I <= 4; ++I) {
+      ProgramCacheKeyT Key{{{static_cast<unsigned char>(I)}, I}, Device};
+      LockedCache.get().emplace(
+          std::piecewise_construct, std::forward_as_tuple(Key),
+          std::forward_as_tuple(reinterpret_cast<PiProgramT *>(I),
+                                detail::BS_Done));
+      Keys.push_back(Key);
+    }
+  }
+
+  const detail::KernelProgramCache::SpecializedBuildLimits Limits{2, 3, 250};
+  EXPECT_NE(Cache.useSpecializedBuild(Keys[0], /*Pin=*/false, Limits, 100),
+            nullptr);
+  EXPECT_NE(Cache.useSpecializedBuild(Keys[1], /*Pin=*/false, Limits, 100),
+            nullptr);
+  EXPECT_NE(Cache.useSpecializedBuild(Keys[0], /*Pin=*/false, Limits),
+            nullptr);
+  // The sizes go beyond the limit, so the least recently used build goes.
+  EXPECT_NE(Cache.useSpecializedBuild(Keys[2], /*Pin=*/false, Limits, 100),
+            nullptr);
+  EXPECT_EQ(ProgramReleaseCount, 1);
+  EXPECT_EQ(Cache.useSpecializedBuild(Keys[1], /*Pin=*/false, Limits),
+            nullptr);
+
+  // The count goes beyond the limit.
+  const detail::KernelProgramCache::SpecializedBuildLimits TwoBuilds{
+      2, 2, std::numeric_limits<size_t>::max()};
+  EXPECT_NE(Cache.useSpecializedBuild(Keys[3], /*Pin=*/false, TwoBuilds, 10),
+            nullptr);
+  EXPECT_EQ(ProgramReleaseCount, 2);
+  EXPECT_EQ(Cache.useSpecializedBuild(Keys[0], /*Pin=*/false, TwoBuilds),
+            nullptr);
+
+  detail::KernelProgramCache::SpecializedBuildStats Stats =
+      Cache.getSpecializedBuildStats();
+  EXPECT_EQ(Stats.Hits, 1u);
+  EXPECT_EQ(Stats.Misses, 4u);
+  EXPECT_EQ(Stats.Evictions, 2u);
+  EXPECT_EQ(Stats.Builds, 2u);
+  EXPECT_EQ(Stats.Size, 110u);
+}
+
+// Check that the kernel fast cache returns only the kernels saved for the
+// exact OS module, kernel name and device.
+TEST(KernelFastCacheTest, LookupByModuleNameAndDevice) {
+  detail::KernelProgramCache Cache;
+  auto Kernel = reinterpret_cast<detail::RT::PiKernel>(0x1);
+  auto Device = reinterpret_cast<detail::RT::PiDevice>(0x2);
+  auto OtherDevice = reinterpret_cast<detail::RT::PiDevice>(0x3);
+  std::mutex KernelMutex;
+  const detail::OSModuleHandle M = detail::OSUtil::ExeModuleHandle;
+
+  EXPECT_EQ(Cache.tryToGetKernelFast(M, "Kernel", Device).first, nullptr)
+      << "Expect empty fast cache";
+
+  Cache.saveKernelFast(M, "Kernel", Device,
+                       std::make_pair(Kernel, &KernelMutex));
+
+  auto Ret = Cache.tryToGetKernelFast(M, "Kernel", Device);
+  EXPECT_EQ(Ret.first, Kernel);
+  EXPECT_EQ(Ret.second, &KernelMutex);
+
+  EXPECT_EQ(Cache.tryToGetKernelFast(M, "Kernel", OtherDevice).first, nullptr);
+  EXPECT_EQ(Cache.tryToGetKernelFast(M, "Kernel2", Device).first, nullptr);
+  EXPECT_EQ(Cache.tryToGetKernelFast(detail::OSUtil::DummyModuleHandle,
+                                     "Kernel", Device)
+                .first,
+            nullptr);
+}
+
+TEST(KernelFastCacheTest, LookupByKernelID) {
+  detail::KernelProgramCache Cache;
+  auto Kernel = reinterpret_cast<detail::RT::PiKernel>(0x1);
+  auto OtherKernel = reinterpret_cast<detail::RT::PiKernel>(0x4);
+  auto Device = reinterpret_cast<detail::RT::PiDevice>(0x2);
+  auto OtherDevice = reinterpret_cast<detail::RT::PiDevice>(0x3);
+  std::mutex KernelMutex;
+
+  EXPECT_EQ(Cache.tryToGetKernelByID(1, Device).first, nullptr)
+      << "Expect empty kernel ID table";
+
+  Cache.saveKernelByID(1, Device, std::make_pair(Kernel, &KernelMutex));
+  auto Ret = Cache.tryToGetKernelByID(1, Device);
+  EXPECT_EQ(Ret.first, Kernel);
+  EXPECT_EQ(Ret.second, &KernelMutex);
+
+  // The slot keeps the first device saved.
+  Cache.saveKernelByID(1, OtherDevice,
+                       std::make_pair(OtherKernel, &KernelMutex));
+  EXPECT_EQ(Cache.tryToGetKernelByID(1, OtherDevice).first, nullptr);
+  EXPECT_EQ(Cache.tryToGetKernelByID(1, Device).first, Kernel);
+
+  // IDs from different chunks of the table are independent.
+  Cache.saveKernelByID(1000, Device, std::make_pair(OtherKernel, &KernelMutex));
+  EXPECT_EQ(Cache.tryToGetKernelByID(1000, Device).first, OtherKernel);
+  EXPECT_EQ(Cache.tryToGetKernelByID(2, Device).first, nullptr);
+
+  // IDs beyond the table are not cached.
+  Cache.saveKernelByID(1u << 30, Device, std::make_pair(Kernel, &KernelMutex));
+  EXPECT_EQ(Cache.tryToGetKernelByID(1u << 30, Device).first, nullptr);
+}
+
+// Check that the free clones are kept apart for every cached kernel.
+TEST(KernelFastCacheTest, KernelClones) {
+  detail::KernelProgramCache Cache;
+  auto Kernel = reinterpret_cast<detail::RT::PiKernel>(0x1);
+  auto OtherKernel = reinterpret_cast<detail::RT::PiKernel>(0x2);
+  auto Clone = reinterpret_cast<detail::RT::PiKernel>(0x3);
+  auto OtherClone = reinterpret_cast<detail::RT::PiKernel>(0x4);
+
+  EXPECT_EQ(Cache.tryToGetKernelClone(Kernel), nullptr)
+      << "Expect no free clones";
+
+  Cache.returnKernelClone(Kernel, Clone);
+  Cache.returnKernelClone(OtherKernel, OtherClone);
+  EXPECT_EQ(Cache.tryToGetKernelClone(Kernel), Clone);
+  EXPECT_EQ(Cache.tryToGetKernelClone(Kernel), nullptr);
+  EXPECT_EQ(Cache.tryToGetKernelClone(OtherKernel), OtherClone);
+  EXPECT_EQ(Cache.tryToGetKernelClone(OtherKernel), nullptr);
+}
@@ -0,0 +1,94 @@
+//==---- BuiltProgramBundle.cpp --------------------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <CL/sycl.hpp>
+#include <detail/built_program_bundle.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+
+using namespace cl::sycl;
+using detail::BuiltProgramBundle;
+
+static BuiltProgramBundle::Entry makeEntry(const std::string &DeviceID,
+                                           const std::string &SpecConsts,
+                                           std::vector<char> Binary) {
+  BuiltProgramBundle::Entry E;
+  E.DeviceID = DeviceID;
+  E.ImageID = "1234/56";
+  E.BuildOptions = "-O2";
+  E.SpecConsts = SpecConsts;
+  E.Binary = std::move(Binary);
+  return E;
+}
+
+TEST(BuiltProgramBundle, FileRoundTrip) {
+  const std::string FileName = "BuiltProgramBundle.RoundTrip.bin";
+  std::vector<BuiltProgramBundle::Entry> Entries;
+  Entries.push_back(makeEntry("GPU/1.0", "", {'a', 'b', 'c'}));
+  // Spec constant values are binary data.
+  Entries.push_back(makeEntry("CPU/2.0", std::string("\0\1\2", 3), {'d'}));
+  BuiltProgramBundle::writeToFile(FileName, Entries);
+
+  std::vector<BuiltProgramBundle::Entry> Read =
+      BuiltProgramBundle::readFromFile(FileName);
+  std::remove(FileName.c_str());
+  ASSERT_EQ(Read.size(), 2u);
+  for (size_t I = 0; I < Read.size(); ++I) {
+    EXPECT_EQ(Read[I].DeviceID, Entries[I].DeviceID);
+    EXPECT_EQ(Read[I].ImageID, Entries[I].ImageID);
+    EXPECT_EQ(Read[I].BuildOptions, Entries[I].BuildOptions);
+    EXPECT_EQ(Read[I].SpecConsts, Entries[I].SpecConsts);
+    EXPECT_EQ(Read[I].Binary, Entries[I].Binary);
+  }
+}
+
+TEST(BuiltProgramBundle, RejectsOtherFiles) {
+  EXPECT_THROW(BuiltProgramBundle::readFromFile("BuiltProgramBundle.None"),
+               runtime_error);
+
+  const std::string FileName = "BuiltProgramBundle.Other.bin";
+  {
+    std::ofstream FileStream{FileName, std::ios::binary};
+    FileStream << "not a bundle";
+  }
+  EXPECT_THROW(BuiltProgramBundle::readFromFile(FileName), runtime_error);
+
+  // A truncated bundle
+  BuiltProgramBundle::writeToFile(FileName,
+                                  {makeEntry("GPU/1.0", "", {'a', 'b'})});
+  std::ifstream In{FileName, std::ios::binary};
+  std::string Contents{std::istreambuf_iterator<char>(In),
+                       std::istreambuf_iterator<char>()};
+  In.close();
+  {
+    std::ofstream FileStream{FileName, std::ios::binary};
+    FileStream.write(Contents.data(), Contents.size() - 1);
+  }
+  EXPECT_THROW(BuiltProgramBundle::readFromFile(FileName), runtime_error);
+  std::remove(FileName.c_str());
+}
+
+TEST(BuiltProgramBundle, FindsByAllComponents) {
+  BuiltProgramBundle Bundle;
+  EXPECT_TRUE(Bundle.empty());
+  Bundle.add(makeEntry("GPU/1.0", "", {'a'}));
+  EXPECT_FALSE(Bundle.empty());
+
+  EXPECT_EQ(Bundle.find(makeEntry("GPU/1.0", "", {})),
+            std::vector<char>{'a'});
+  // Another driver version or other spec constant values.
+  EXPECT_TRUE(Bundle.find(makeEntry("GPU/1.1", "", {})).empty());
+  EXPECT_TRUE(Bundle.find(makeEntry("GPU/1.0", "x", {})).empty());
+
+  BuiltProgramBundle::Entry OtherOptions = makeEntry("GPU/1.0", "", {});
+  OtherOptions.BuildOptions = "-O0";
+  EXPECT_TRUE(Bundle.find(OtherOptions).empty());
+}
@@ -0,0 +1,63 @@
+//==---- DeviceBinaryImage.cpp ---------------------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <CL/sycl/detail/device_binary_image.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <vector>
+
+using namespace cl::sycl::detail;
+
+static constexpr size_t ImageSize = 64 * 1024;
+
+alignas(4096) static const unsigned char ReadOnlyData[ImageSize] = {1, 2, 3};
+alignas(4096) static unsigned char WritableData[ImageSize];
+
+static pi_device_binary_struct makeBinary(const unsigned char *Data) {
+  pi_device_binary_struct Bin{};
+  Bin.Version = PI_DEVICE_BINARY_VERSION;
+  Bin.Kind = PI_DEVICE_BINARY_OFFLOAD_KIND_SYCL;
+  Bin.Format = PI_DEVICE_BINARY_TYPE_SPIRV;
+  Bin.DeviceTargetSpec = __SYCL_PI_DEVICE_BINARY_TARGET_SPIRV64;
+  Bin.CompileOptions = "";
+  Bin.LinkOptions = "";
+  Bin.BinaryStart = Data;
+  Bin.BinaryEnd = Data + ImageSize;
+  return Bin;
+}
+
+TEST(DeviceBinaryImage, ReleasedDataStaysReadable) {
+  pi_device_binary_struct Bin = makeBinary(ReadOnlyData);
+  RTDeviceBinaryImage Img(&Bin, OSUtil::ExeModuleHandle);
+  Img.prepare();
+  Img.releaseData();
+  EXPECT_EQ(ReadOnlyData[0], 1);
+  EXPECT_EQ(ReadOnlyData[2], 3);
+  EXPECT_EQ(ReadOnlyData[ImageSize - 1], 0);
+}
+
+TEST(DeviceBinaryImage, WritableDataIsNotReleased) {
+  // The pages of the heap and of the writable segments would be zeroed.
+  std::vector<unsigned char> HeapData(ImageSize + 4096, 0x5a);
+  for (size_t I = 0; I < ImageSize; ++I)
+    WritableData[I] = static_cast<unsigned char>(I);
+
+  for (const unsigned char *Data : {HeapData.data(), &WritableData[0]}) {
+    pi_device_binary_struct Bin = makeBinary(Data);
+    RTDeviceBinaryImage Img(&Bin, OSUtil::ExeModuleHandle);
+    Img.prepare();
+    Img.releaseData();
+  }
+
+  for (size_t I = 0; I < ImageSize; ++I) {
+    ASSERT_EQ(HeapData[I], 0x5a);
+    ASSERT_EQ(WritableData[I], static_cast<unsigned char>(I));
+  }
+}
@@ -0,0 +1,77 @@
+//==---- DeviceInfoCache.cpp -----------------------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <gtest/gtest.h>
+
+#include <detail/device_info_cache.hpp>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using cl::sycl::detail::DeviceInfoCache;
+using cl::sycl::detail::DeviceInfoSlot;
+using cl::sycl::detail::getDeviceInfoSlot;
+namespace info = cl::sycl::info;
+
+TEST(DeviceInfoCacheTest, ComputesOnce) {
+  DeviceInfoCache Cache;
+  int Computes = 0;
+  auto Compute = [&]() {
+    ++Computes;
+    return std::string("cl_khr_fp64");
+  };
+  const std::string &First =
+      Cache.get<std::string>(DeviceInfoSlot::extensions_string, Compute);
+  const std::string &Second =
+      Cache.get<std::string>(DeviceInfoSlot::extensions_string, Compute);
+  EXPECT_EQ(Computes, 1);
+  EXPECT_EQ(&First, &Second);
+  EXPECT_EQ(First, "cl_khr_fp64");
+}
+
+TEST(DeviceInfoCacheTest, SlotsAreIndependent) {
+  DeviceInfoCache Cache;
+  EXPECT_EQ(Cache.get<size_t>(DeviceInfoSlot::max_work_group_size,
+                              []() { return size_t{256}; }),
+            256u);
+  EXPECT_EQ(Cache.get<unsigned>(DeviceInfoSlot::max_compute_units,
+                                []() { return 8u; }),
+            8u);
+}
+
+TEST(DeviceInfoCacheTest, OnlyImmutableInfoIsCached) {
+  static_assert(getDeviceInfoSlot(info::device::name) == DeviceInfoSlot::name,
+                "The device name is cached");
+  EXPECT_EQ(getDeviceInfoSlot(info::device::max_work_group_size),
+            DeviceInfoSlot::max_work_group_size);
+  EXPECT_EQ(getDeviceInfoSlot(info::device::reference_count),
+            DeviceInfoSlot::num_slots);
+}
+
+TEST(DeviceInfoCacheTest, ConcurrentQueriesAgree) {
+  DeviceInfoCache Cache;
+  std::atomic<int> Computes{0};
+  constexpr size_t NumThreads = 8;
+  std::vector<const std::string *> Results(NumThreads);
+  std::vector<std::thread> Threads;
+  for (size_t I = 0; I < NumThreads; ++I)
+    Threads.emplace_back([&, I]() {
+      Results[I] = &Cache.get<std::string>(DeviceInfoSlot::vendor, [&]() {
+        ++Computes;
+        return std::string("vendor");
+      });
+    });
+  for (std::thread &Thread : Threads)
+    Thread.join();
+
+  EXPECT_GE(Computes.load(), 1);
+  for (const std::string *Result : Results)
+    EXPECT_EQ(Result, Results[0]);
+}
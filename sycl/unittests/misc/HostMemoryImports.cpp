@@ -0,0 +1,103 @@
+//==---- HostMemoryImports.cpp ---------------------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/host_memory_imports.hpp>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using cl::sycl::detail::HostMemoryImports;
+
+namespace {
+struct Recorder {
+  std::vector<const void *> Imported;
+  std::vector<const void *> Released;
+  bool Accept = true;
+
+  HostMemoryImports::ImportFn import() {
+    return [this](const void *Ptr, size_t) {
+      if (Accept)
+        Imported.push_back(Ptr);
+      return Accept;
+    };
+  }
+  HostMemoryImports::ReleaseFn release() {
+    return [this](const void *Ptr) { Released.push_back(Ptr); };
+  }
+};
+} // namespace
+
+static constexpr size_t Size = HostMemoryImports::MinSize;
+
+TEST(HostMemoryImports, RegistersOncePerOwner) {
+  std::vector<char> Memory(Size);
+  HostMemoryImports Imports;
+  Recorder R;
+  int Owner;
+
+  EXPECT_FALSE(Imports.contains(Memory.data(), Size));
+  ASSERT_TRUE(Imports.acquire(&Owner, Memory.data(), Size, R.import()));
+  ASSERT_TRUE(Imports.acquire(&Owner, Memory.data(), Size, R.import()));
+  EXPECT_EQ(R.Imported.size(), 1u);
+  EXPECT_TRUE(Imports.contains(Memory.data(), Size));
+  EXPECT_TRUE(Imports.contains(Memory.data() + 16, 32));
+  EXPECT_FALSE(Imports.contains(Memory.data() + 16, Size));
+
+  Imports.release(&Owner, R.release());
+  ASSERT_EQ(R.Released.size(), 1u);
+  EXPECT_EQ(R.Released[0], Memory.data());
+  EXPECT_FALSE(Imports.contains(Memory.data(), Size));
+
+  // Owners without a registration are ignored.
+  Imports.release(&Owner, R.release());
+  EXPECT_EQ(R.Released.size(), 1u);
+}
+
+TEST(HostMemoryImports, SharesHoldingRegistration) {
+  std::vector<char> Memory(2 * Size);
+  HostMemoryImports Imports;
+  Recorder R;
+  int Whole, Half;
+
+  ASSERT_TRUE(Imports.acquire(&Whole, Memory.data(), 2 * Size, R.import()));
+  ASSERT_TRUE(Imports.acquire(&Half, Memory.data() + Size, Size, R.import()));
+  EXPECT_EQ(R.Imported.size(), 1u);
+
+  // The registration is released with its last owner.
+  Imports.release(&Whole, R.release());
+  EXPECT_TRUE(R.Released.empty());
+  EXPECT_TRUE(Imports.contains(Memory.data(), 2 * Size));
+  Imports.release(&Half, R.release());
+  EXPECT_EQ(R.Released.size(), 1u);
+}
+
+TEST(HostMemoryImports, RefusesOverlapsAndSmallRanges) {
+  std::vector<char> Memory(3 * Size);
+  HostMemoryImports Imports;
+  Recorder R;
+  int First, Overlapping, Next, Small;
+
+  ASSERT_TRUE(Imports.acquire(&First, Memory.data(), 2 * Size, R.import()));
+  EXPECT_FALSE(Imports.acquire(&Overlapping, Memory.data() + Size, 2 * Size,
+                               R.import()));
+  ASSERT_TRUE(
+      Imports.acquire(&Next, Memory.data() + 2 * Size, Size, R.import()));
+  EXPECT_FALSE(Imports.acquire(&Small, Memory.data(), Size - 1, R.import()));
+  EXPECT_EQ(R.Imported.size(), 2u);
+
+  // A range refused by the plugin isn't registered.
+  std::vector<char> Other(Size);
+  R.Accept = false;
+  EXPECT_FALSE(Imports.acquire(&Small, Other.data(), Size, R.import()));
+  EXPECT_FALSE(Imports.contains(Other.data(), Size));
+
+  Imports.releaseAll(R.release());
+  EXPECT_EQ(R.Released.size(), 2u);
+  EXPECT_FALSE(Imports.contains(Memory.data(), Size));
+}
@@ -0,0 +1,176 @@
+//==---- HostStagingRing.cpp -----------------------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <CL/sycl.hpp>
+#include <detail/context_impl.hpp>
+#include <detail/host_staging_ring.hpp>
+#include <helpers/PiMock.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+using namespace cl::sycl;
+using detail::HostStagingRing;
+
+// Memory of the mock buffer, all transfers are performed immediately.
+static std::vector<char> Device;
+static int NumHostAllocs = 0;
+static int NumTransfers = 0;
+static std::uintptr_t NextEvent = 1;
+
+static pi_result redefinedUSMHostAlloc(void **ResultPtr, pi_context,
+                                       pi_usm_mem_properties *, size_t Size,
+                                       pi_uint32) {
+  ++NumHostAllocs;
+  *ResultPtr = std::malloc(Size);
+  return PI_SUCCESS;
+}
+
+static pi_result redefinedUSMFree(pi_context, void *Ptr) {
+  std::free(Ptr);
+  return PI_SUCCESS;
+}
+
+static pi_result redefinedUSMGetMemAllocInfo(pi_context, const void *,
+                                             pi_mem_info, size_t,
+                                             void *ParamValue, size_t *) {
+  *reinterpret_cast<pi_usm_type *>(ParamValue) = PI_MEM_TYPE_UNKNOWN;
+  return PI_SUCCESS;
+}
+
+static pi_result redefinedEnqueueMemBufferWrite(pi_queue, pi_mem, pi_bool,
+                                                size_t Offset, size_t Size,
+                                                const void *Ptr, pi_uint32,
+                                                const pi_event *,
+                                                pi_event *Event) {
+  ++NumTransfers;
+  std::memcpy(Device.data() + Offset, Ptr, Size);
+  *Event = reinterpret_cast<pi_event>(NextEvent++);
+  return PI_SUCCESS;
+}
+
+static pi_result redefinedEnqueueMemBufferRead(pi_queue, pi_mem, pi_bool,
+                                               size_t Offset, size_t Size,
+                                               void *Ptr, pi_uint32,
+                                               const pi_event *,
+                                               pi_event *Event) {
+  ++NumTransfers;
+  std::memcpy(Ptr, Device.data() + Offset, Size);
+  *Event = reinterpret_cast<pi_event>(NextEvent++);
+  return PI_SUCCESS;
+}
+
+static pi_result redefinedEnqueueEventsWait(pi_queue, pi_uint32,
+                                            const pi_event *, pi_event *Event) {
+  *Event = reinterpret_cast<pi_event>(NextEvent++);
+  return PI_SUCCESS;
+}
+
+static pi_result redefinedEventsWait(pi_uint32, const pi_event *) {
+  return PI_SUCCESS;
+}
+
+static pi_result redefinedEventRelease(pi_event) { return PI_SUCCESS; }
+
+class HostStagingRingTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    platform Plt{default_selector()};
+    if (Plt.is_host()) {
+      std::cout << "Not run due to host-only environment\n";
+      return;
+    }
+
+    Mock.reset(new unittest::PiMock{Plt});
+    Mock->redefine<detail::PiApiKind::piextUSMHostAlloc>(
+        redefinedUSMHostAlloc);
+    Mock->redefine<detail::PiApiKind::piextUSMFree>(redefinedUSMFree);
+    Mock->redefine<detail::PiApiKind::piextUSMGetMemAllocInfo>(
+        redefinedUSMGetMemAllocInfo);
+    Mock->redefine<detail::PiApiKind::piEnqueueMemBufferWrite>(
+        redefinedEnqueueMemBufferWrite);
+    Mock->redefine<detail::PiApiKind::piEnqueueMemBufferRead>(
+        redefinedEnqueueMemBufferRead);
+    Mock->redefine<detail::PiApiKind::piEnqueueEventsWait>(
+        redefinedEnqueueEventsWait);
+    Mock->redefine<detail::PiApiKind::piEventsWait>(redefinedEventsWait);
+    Mock->redefine<detail::PiApiKind::piEventRelease>(redefinedEventRelease);
+    Ctx.reset(new context{Plt});
+    NumHostAllocs = NumTransfers = 0;
+  }
+
+  const detail::plugin &getPlugin() {
+    return detail::getSyclObjImpl(*Ctx)->getPlugin();
+  }
+  RT::PiContext getHandle() {
+    return detail::getSyclObjImpl(*Ctx)->getHandleRef();
+  }
+
+  std::unique_ptr<unittest::PiMock> Mock;
+  std::unique_ptr<context> Ctx;
+};
+
+TEST_F(HostStagingRingTest, DisabledWithZeroCapacity) {
+  if (!Ctx)
+    return;
+  HostStagingRing Ring(0);
+  EXPECT_FALSE(Ring.isEnabled());
+
+  std::vector<char> Data(1024);
+  RT::PiEvent Event = nullptr;
+  EXPECT_FALSE(Ring.write(getPlugin(), getHandle(), nullptr, nullptr, 0,
+                          Data.data(), Data.size(), {}, Event));
+  EXPECT_EQ(NumHostAllocs, 0);
+}
+
+TEST_F(HostStagingRingTest, SmallCopiesAreNotStaged) {
+  if (!Ctx)
+    return;
+  HostStagingRing Ring(4096);
+
+  std::vector<char> Data(Ring.getSlotSize());
+  RT::PiEvent Event = nullptr;
+  EXPECT_FALSE(Ring.write(getPlugin(), getHandle(), nullptr, nullptr, 0,
+                          Data.data(), Data.size(), {}, Event));
+  EXPECT_EQ(NumHostAllocs, 0);
+}
+
+TEST_F(HostStagingRingTest, CopiesInChunks) {
+  if (!Ctx)
+    return;
+  HostStagingRing Ring(4096);
+  const size_t Size = Ring.getSlotSize() * 6 + 100;
+  Device.assign(Size + 8, 0);
+
+  std::vector<char> Src(Size);
+  std::iota(Src.begin(), Src.end(), 0);
+  RT::PiEvent Event = nullptr;
+  ASSERT_TRUE(Ring.write(getPlugin(), getHandle(), nullptr, nullptr, 8,
+                         Src.data(), Size, {}, Event));
+  EXPECT_NE(Event, nullptr);
+  EXPECT_EQ(NumHostAllocs, int(HostStagingRing::NumSlots));
+  EXPECT_EQ(NumTransfers, 7);
+  EXPECT_EQ(std::memcmp(Device.data() + 8, Src.data(), Size), 0);
+
+  std::vector<char> Dst(Size);
+  NumTransfers = 0;
+  ASSERT_TRUE(Ring.read(getPlugin(), getHandle(), nullptr, nullptr, 8,
+                        Dst.data(), Size, {}, Event));
+  EXPECT_NE(Event, nullptr);
+  EXPECT_EQ(NumTransfers, 7);
+  EXPECT_EQ(Dst, Src);
+
+  // The slots are allocated once.
+  EXPECT_EQ(NumHostAllocs, int(HostStagingRing::NumSlots));
+  Ring.release(getPlugin(), getHandle());
+}
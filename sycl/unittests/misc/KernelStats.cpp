@@ -0,0 +1,97 @@
+//==---- KernelStats.cpp ---------------------------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <gtest/gtest.h>
+
+#include <detail/kernel_stats.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using cl::sycl::ONEAPI::kernel_stats;
+using cl::sycl::detail::KernelStatsEntry;
+using cl::sycl::detail::KernelStatsRecorder;
+
+static const int Device0 = 0;
+static const int Device1 = 1;
+
+TEST(KernelStatsTest, EntriesByKernelAndDevice) {
+  KernelStatsRecorder Recorder(1);
+  int NameQueries = 0;
+  auto GetName = [&NameQueries] {
+    ++NameQueries;
+    return std::string("device");
+  };
+  KernelStatsEntry &A0 = Recorder.getEntry("A", &Device0, GetName);
+  KernelStatsEntry &B0 = Recorder.getEntry("B", &Device0, GetName);
+  KernelStatsEntry &A1 = Recorder.getEntry("A", &Device1, GetName);
+  EXPECT_NE(&A0, &B0);
+  EXPECT_NE(&A0, &A1);
+  // The device name is only queried for new entries
+  EXPECT_EQ(&A0, &Recorder.getEntry("A", &Device0, GetName));
+  EXPECT_EQ(NameQueries, 3);
+  EXPECT_EQ(A0.KernelName, "A");
+  EXPECT_EQ(A0.DeviceName, "device");
+}
+
+TEST(KernelStatsTest, Sampling) {
+  KernelStatsRecorder Recorder(4);
+  KernelStatsEntry &Entry =
+      Recorder.getEntry("K", &Device0, [] { return std::string("device"); });
+  int Sampled = 0;
+  for (int I = 0; I < 16; ++I)
+    Sampled += Recorder.countLaunch(Entry);
+  EXPECT_EQ(Sampled, 4);
+  EXPECT_EQ(Entry.Launches.load(), 16u);
+
+  // A sampling of 0 measures every launch
+  KernelStatsRecorder All(0);
+  KernelStatsEntry &AllEntry =
+      All.getEntry("K", &Device0, [] { return std::string("device"); });
+  EXPECT_TRUE(All.countLaunch(AllEntry));
+  EXPECT_TRUE(All.countLaunch(AllEntry));
+}
+
+TEST(KernelStatsTest, Aggregates) {
+  KernelStatsRecorder Recorder(1);
+  auto GetName = [] { return std::string("device"); };
+  KernelStatsEntry &Short = Recorder.getEntry("Short", &Device0, GetName);
+  KernelStatsEntry &Long = Recorder.getEntry("Long", &Device0, GetName);
+  for (uint64_t Value = 1; Value <= 100; ++Value) {
+    Recorder.countLaunch(Short);
+    Short.DeviceTime.record(Value);
+  }
+  Recorder.countLaunch(Long);
+  Long.DeviceTime.record(1000000);
+  Long.ArgSetupNs += 10;
+  Long.BuildNs += 20;
+  // Not launched, so not reported
+  Recorder.getEntry("Unused", &Device0, GetName);
+
+  std::vector<kernel_stats> Stats = Recorder.get();
+  ASSERT_EQ(Stats.size(), 2u);
+  // By decreasing total device time
+  EXPECT_EQ(Stats[0].kernel_name, "Long");
+  EXPECT_EQ(Stats[0].device_name, "device");
+  EXPECT_EQ(Stats[0].launch_count, 1u);
+  EXPECT_EQ(Stats[0].device_time.count, 1u);
+  EXPECT_EQ(Stats[0].device_time.p50_ns, 1000000u);
+  EXPECT_EQ(Stats[0].arg_setup_ns, 10u);
+  EXPECT_EQ(Stats[0].build_ns, 20u);
+  EXPECT_EQ(Stats[1].kernel_name, "Short");
+  EXPECT_EQ(Stats[1].launch_count, 100u);
+  EXPECT_EQ(Stats[1].device_time.total_ns, 5050u);
+  EXPECT_EQ(Stats[1].device_time.min_ns, 1u);
+  EXPECT_EQ(Stats[1].device_time.max_ns, 100u);
+  EXPECT_GE(Stats[1].device_time.p90_ns, 90u);
+  EXPECT_LE(Stats[1].device_time.p90_ns, 90u + 90u / 8);
+
+  Recorder.reset();
+  EXPECT_TRUE(Recorder.get().empty());
+}
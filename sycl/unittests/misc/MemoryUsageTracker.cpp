@@ -0,0 +1,75 @@
+//==---- MemoryUsageTracker.cpp --------------------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/memory_usage_tracker.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+using namespace cl::sycl;
+using detail::MemoryUsageTracker;
+using Category = MemoryUsageTracker::Category;
+
+TEST(MemoryUsageTracker, CountsByCategory) {
+  MemoryUsageTracker Tracker(0);
+  int A, B, C;
+  Tracker.recordAllocation(&A, Category::Buffer, 100);
+  Tracker.recordAllocation(&B, Category::USMDevice, 200);
+  Tracker.recordAllocation(&C, Category::USMHost, 300);
+
+  ONEAPI::memory_usage Usage = Tracker.getUsage(64);
+  EXPECT_EQ(Usage.buffers, 100u);
+  EXPECT_EQ(Usage.images, 0u);
+  EXPECT_EQ(Usage.usm_device, 200u);
+  EXPECT_EQ(Usage.usm_host, 300u);
+  EXPECT_EQ(Usage.usm_shared, 0u);
+  EXPECT_EQ(Usage.cached, 64u);
+  EXPECT_EQ(Usage.total, 664u);
+  EXPECT_EQ(Usage.peak, 600u);
+  EXPECT_EQ(Usage.limit, 0u);
+}
+
+TEST(MemoryUsageTracker, KeepsPeak) {
+  MemoryUsageTracker Tracker(0);
+  int A, B;
+  Tracker.recordAllocation(&A, Category::USMShared, 1000);
+  EXPECT_TRUE(Tracker.recordRelease(&A));
+  Tracker.recordAllocation(&B, Category::Image, 10);
+
+  ONEAPI::memory_usage Usage = Tracker.getUsage(0);
+  EXPECT_EQ(Usage.usm_shared, 0u);
+  EXPECT_EQ(Usage.images, 10u);
+  EXPECT_EQ(Usage.total, 10u);
+  EXPECT_EQ(Usage.peak, 1000u);
+}
+
+TEST(MemoryUsageTracker, IgnoresUnknownPointers) {
+  MemoryUsageTracker Tracker(0);
+  int A, Foreign;
+  Tracker.recordAllocation(&A, Category::Buffer, 100);
+  EXPECT_FALSE(Tracker.recordRelease(&Foreign));
+  EXPECT_TRUE(Tracker.recordRelease(&A));
+  EXPECT_FALSE(Tracker.recordRelease(&A));
+  EXPECT_EQ(Tracker.getUsage(0).total, 0u);
+}
+
+TEST(MemoryUsageTracker, ChecksLimit) {
+  MemoryUsageTracker Unlimited(0);
+  EXPECT_TRUE(Unlimited.fits(SIZE_MAX, SIZE_MAX));
+
+  MemoryUsageTracker Tracker(1000);
+  int A;
+  Tracker.recordAllocation(&A, Category::USMDevice, 600);
+  EXPECT_TRUE(Tracker.fits(400, 0));
+  EXPECT_FALSE(Tracker.fits(401, 0));
+  // The cached blocks count against the limit.
+  EXPECT_FALSE(Tracker.fits(400, 1));
+  EXPECT_FALSE(Tracker.fits(0, 500));
+  EXPECT_EQ(Tracker.getUsage(0).limit, 1000u);
+}
@@ -0,0 +1,50 @@
+//==---- Numa.cpp ----------------------------------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/numa.hpp>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace cl::sycl::detail;
+
+TEST(Numa, NormalizesPciAddresses) {
+  // CUDA reports the sysfs format in upper case.
+  EXPECT_EQ(normalizePciAddress("0000:3B:00.0"), "0000:3b:00.0");
+  EXPECT_EQ(normalizePciAddress("0000:3b:00.1"), "0000:3b:00.1");
+  // Level Zero reports decimal numbers.
+  EXPECT_EQ(normalizePciAddress("0:59:0.0"), "0000:3b:00.0");
+  EXPECT_EQ(normalizePciAddress("1:154:2.3"), "0001:9a:02.3");
+
+  EXPECT_EQ(normalizePciAddress(""), "");
+  EXPECT_EQ(normalizePciAddress("0:3b:0.0"), "");
+  EXPECT_EQ(normalizePciAddress("0:256:0.0"), "");
+  EXPECT_EQ(normalizePciAddress("0:59:0"), "");
+}
+
+TEST(Numa, ParsesCpuLists) {
+  EXPECT_EQ(parseCpuList("0-3,8,10-11"),
+            (std::vector<size_t>{0, 1, 2, 3, 8, 10, 11}));
+  EXPECT_EQ(parseCpuList("5"), std::vector<size_t>{5});
+
+  EXPECT_TRUE(parseCpuList("").empty());
+  EXPECT_TRUE(parseCpuList("3-1").empty());
+  EXPECT_TRUE(parseCpuList("0,,2").empty());
+  EXPECT_TRUE(parseCpuList("0-a").empty());
+}
+
+TEST(Numa, IgnoresUnknownNodes) {
+  EXPECT_EQ(getPciDeviceNumaNode("not an address"), -1);
+  EXPECT_TRUE(getNumaNodeCores(-1).empty());
+
+  // Placement is a hint, nothing happens for unknown nodes.
+  std::vector<char> Memory(NumaMinPlacementSize);
+  preferNumaNode(Memory.data(), Memory.size(), -1);
+  { ScopedNumaNodePreference Preference(-1); }
+}
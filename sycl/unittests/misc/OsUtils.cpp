@@ -10,6 +10,9 @@
 #include <gtest/gtest.h>
 
 #ifdef _WIN32
+#include <direct.h>
+#define rmdir _rmdir
+
 /// Compare for string equality, but ignore difference between forward slash (/)
 /// and backward slash (\).
 ///
@@ -34,6 +37,7 @@ bool isSameDir(const char* LHS, const char* RHS) {
 #else
 #include <sys/stat.h>
 #include <stdlib.h>
+#include <unistd.h>
 /// Check with respect to symbolic links
 bool isSameDir(const char* LHS, const char* RHS) {
   struct stat StatBuf;
@@ -59,3 +63,23 @@ TEST_F(OsUtilsTest, getCurrentDSODir) {
   ASSERT_TRUE(isSameDir(DSODir.c_str(), SYCL_LIB_DIR)) <<
       "expected: " << SYCL_LIB_DIR << ", got: " << DSODir;
 }
+
+TEST_F(OsUtilsTest, makeDir) {
+  using cl::sycl::detail::OSUtil;
+  std::string Root = std::string(SYCL_LIB_DIR) + OSUtil::DirSep +
+                     "os_utils_make_dir_test";
+  std::string Dir = Root + OSUtil::DirSep + "a" + OSUtil::DirSep + "b";
+  ASSERT_FALSE(OSUtil::isPathPresent(Dir));
+
+  // All missing parent directories are created.
+  ASSERT_EQ(OSUtil::makeDir(Dir.c_str()), 0);
+  ASSERT_TRUE(OSUtil::isPathPresent(Dir));
+
+  // An existing directory is not an error.
+  ASSERT_EQ(OSUtil::makeDir(Dir.c_str()), 0);
+
+  rmdir(Dir.c_str());
+  rmdir((Root + OSUtil::DirSep + "a").c_str());
+  rmdir(Root.c_str());
+  ASSERT_FALSE(OSUtil::isPathPresent(Root));
+}
@@ -0,0 +1,80 @@
+//==---- SlabPool.cpp ------------------------------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <gtest/gtest.h>
+
+#include <detail/slab_pool.hpp>
+
+#include <cstdint>
+#include <set>
+#include <thread>
+#include <vector>
+
+using cl::sycl::detail::SlabPool;
+using cl::sycl::detail::SlabPoolAllocator;
+
+TEST(SlabPoolTest, RecyclesFreedBlocks) {
+  SlabPool Pool;
+  void *First = Pool.allocate(100);
+  Pool.deallocate(First, 100);
+
+  // Sizes of the same class share the free list.
+  void *Second = Pool.allocate(SlabPool::Granularity * 7);
+  EXPECT_EQ(First, Second);
+  Pool.deallocate(Second, SlabPool::Granularity * 7);
+}
+
+TEST(SlabPoolTest, BlocksAreDistinctAndAligned) {
+  SlabPool Pool;
+  const size_t Size = 24;
+  // Enough blocks to take more than one slab.
+  const size_t Count = 2 * SlabPool::SlabSize / SlabPool::Granularity;
+
+  std::vector<void *> Blocks;
+  for (size_t I = 0; I < Count; ++I) {
+    void *Block = Pool.allocate(Size);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(Block) % SlabPool::Granularity,
+              0u);
+    Blocks.push_back(Block);
+  }
+  EXPECT_EQ(std::set<void *>(Blocks.begin(), Blocks.end()).size(), Count);
+
+  for (void *Block : Blocks)
+    Pool.deallocate(Block, Size);
+}
+
+TEST(SlabPoolTest, LargeBlocks) {
+  SlabPool Pool;
+  const size_t Size = SlabPool::MaxBlockSize + 1;
+  void *Block = Pool.allocate(Size);
+  ASSERT_NE(Block, nullptr);
+  Pool.deallocate(Block, Size);
+  Pool.deallocate(nullptr, 16);
+}
+
+static SlabPool &getTestPool() {
+  static SlabPool Pool;
+  return Pool;
+}
+
+TEST(SlabPoolTest, ConcurrentContainers) {
+  std::vector<std::thread> Threads;
+  for (int T = 0; T < 4; ++T)
+    Threads.emplace_back([] {
+      for (int I = 0; I < 1000; ++I) {
+        std::vector<int, SlabPoolAllocator<int, getTestPool>> Vec;
+        for (int J = 0; J < 64; ++J)
+          Vec.push_back(J);
+        std::set<int, std::less<int>, SlabPoolAllocator<int, getTestPool>> Set(
+            Vec.begin(), Vec.end());
+        ASSERT_EQ(Set.size(), Vec.size());
+      }
+    });
+  for (std::thread &Thread : Threads)
+    Thread.join();
+}
@@ -0,0 +1,83 @@
+//==---- SubmitLatency.cpp -------------------------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <gtest/gtest.h>
+
+#include <detail/submit_latency.hpp>
+
+#include <cstdint>
+#include <thread>
+
+using cl::sycl::detail::LatencyHistogram;
+using cl::sycl::detail::SubmitLatencyRecorder;
+using cl::sycl::detail::SubmitStage;
+
+TEST(SubmitLatencyTest, BucketsCoverValues) {
+  const uint64_t Values[] = {0,    1,     7,       8,         9,
+                             15,   16,    100,     1000,      123456,
+                             4096, 65535, 1 << 30, UINT64_MAX};
+  for (uint64_t Value : Values) {
+    unsigned Bucket = LatencyHistogram::getBucket(Value);
+    ASSERT_LT(Bucket, LatencyHistogram::NumBuckets);
+    EXPECT_LE(LatencyHistogram::getBucketLowest(Bucket), Value);
+    EXPECT_GE(LatencyHistogram::getBucketHighest(Bucket), Value);
+    // A bucket does not cover more than 12.5% of its lowest value
+    uint64_t Lowest = LatencyHistogram::getBucketLowest(Bucket);
+    uint64_t Width = LatencyHistogram::getBucketHighest(Bucket) - Lowest;
+    EXPECT_LE(Width, Lowest / LatencyHistogram::SubBuckets);
+  }
+}
+
+TEST(SubmitLatencyTest, BucketsAreContiguous) {
+  for (unsigned Bucket = 1; Bucket < LatencyHistogram::NumBuckets; ++Bucket)
+    EXPECT_EQ(LatencyHistogram::getBucketHighest(Bucket - 1) + 1,
+              LatencyHistogram::getBucketLowest(Bucket));
+}
+
+TEST(SubmitLatencyTest, Percentiles) {
+  SubmitLatencyRecorder Recorder;
+  for (uint64_t Value = 1; Value <= 1000; ++Value)
+    Recorder.record(SubmitStage::finalize, Value);
+
+  cl::sycl::ONEAPI::submit_latency Stats =
+      Recorder.get(SubmitStage::finalize);
+  EXPECT_EQ(Stats.count, 1000u);
+  EXPECT_EQ(Stats.total_ns, 500500u);
+  EXPECT_EQ(Stats.min_ns, 1u);
+  EXPECT_EQ(Stats.max_ns, 1000u);
+  EXPECT_GE(Stats.p50_ns, 500u);
+  EXPECT_LE(Stats.p50_ns, 500u + 500u / 8);
+  EXPECT_GE(Stats.p90_ns, 900u);
+  EXPECT_LE(Stats.p90_ns, 900u + 900u / 8);
+  EXPECT_GE(Stats.p99_ns, 990u);
+  EXPECT_LE(Stats.p99_ns, 1000u);
+
+  EXPECT_EQ(Recorder.get(SubmitStage::kernel_launch).count, 0u);
+}
+
+TEST(SubmitLatencyTest, MergesThreads) {
+  SubmitLatencyRecorder Recorder;
+  std::thread Thread([&] {
+    for (int I = 0; I < 100; ++I)
+      Recorder.record(SubmitStage::graph_builder, 2000);
+  });
+  Thread.join();
+  for (int I = 0; I < 100; ++I)
+    Recorder.record(SubmitStage::graph_builder, 10);
+
+  cl::sycl::ONEAPI::submit_latency Stats =
+      Recorder.get(SubmitStage::graph_builder);
+  EXPECT_EQ(Stats.count, 200u);
+  EXPECT_EQ(Stats.min_ns, 10u);
+  EXPECT_EQ(Stats.max_ns, 2000u);
+  EXPECT_EQ(Stats.p50_ns, 10u);
+  EXPECT_EQ(Stats.p99_ns, 2000u);
+
+  Recorder.reset();
+  EXPECT_EQ(Recorder.get(SubmitStage::graph_builder).count, 0u);
+}
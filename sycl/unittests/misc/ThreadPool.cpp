@@ -0,0 +1,109 @@
+//==---- ThreadPool.cpp ----------------------------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <gtest/gtest.h>
+
+#include <detail/thread_pool.hpp>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using cl::sycl::detail::ThreadPool;
+
+TEST(ThreadPoolTest, ParallelForRunsEachTaskOnce) {
+  ThreadPool Pool(3);
+  Pool.start();
+
+  const size_t Count = 100;
+  std::vector<std::atomic<int>> Runs(Count);
+  Pool.parallelFor(Count, [&](size_t Idx) { ++Runs[Idx]; });
+
+  for (size_t Idx = 0; Idx < Count; ++Idx)
+    EXPECT_EQ(Runs[Idx].load(), 1) << "Task " << Idx;
+}
+
+TEST(ThreadPoolTest, ParallelForNested) {
+  // The inner calls must not wait for the workers busy with the outer ones.
+  ThreadPool Pool(1);
+  Pool.start();
+
+  std::atomic<int> Runs{0};
+  Pool.parallelFor(4, [&](size_t) {
+    Pool.parallelFor(4, [&](size_t) { ++Runs; });
+  });
+  EXPECT_EQ(Runs.load(), 16);
+}
+
+TEST(ThreadPoolTest, ParallelForRethrows) {
+  ThreadPool Pool(2);
+  Pool.start();
+
+  std::atomic<int> Runs{0};
+  EXPECT_THROW(Pool.parallelFor(8,
+                                [&](size_t Idx) {
+                                  ++Runs;
+                                  if (Idx == 3)
+                                    throw std::runtime_error("Task failed");
+                                }),
+               std::runtime_error);
+  // The remaining tasks are still run.
+  EXPECT_EQ(Runs.load(), 8);
+}
+
+TEST(ThreadPoolTest, SubmitMoveOnlyAndLargeJobs) {
+  ThreadPool Pool(2);
+  Pool.start();
+
+  std::atomic<int> Sum{0};
+  std::unique_ptr<int> Value(new int(1));
+  // Move-only job stored inline.
+  Pool.submit([&Sum, V = std::move(Value)]() { Sum += *V; });
+  // Job too large to be stored inline.
+  std::array<int, 64> Large;
+  Large.fill(1);
+  Pool.submit([&Sum, Large]() {
+    for (int V : Large)
+      Sum += V;
+  });
+
+  while (Sum.load() != 65)
+    std::this_thread::yield();
+}
+
+TEST(ThreadPoolTest, IdleWorkersStealJobs) {
+  // The jobs are submitted by a worker to its own deque and must be executed
+  // by the other workers while it is blocked.
+  ThreadPool Pool(4);
+  Pool.start();
+
+  std::atomic<int> Done{0};
+  std::atomic<bool> Submitted{false};
+  Pool.submit([&]() {
+    for (int I = 0; I < 3; ++I)
+      Pool.submit([&Done]() { ++Done; });
+    Submitted = true;
+    while (Done.load() != 3)
+      std::this_thread::yield();
+  });
+
+  while (!Submitted.load() || Done.load() != 3)
+    std::this_thread::yield();
+}
+
+TEST(ThreadPoolTest, PinnedWorkers) {
+  ThreadPool Pool(2, /*PinThreads=*/true);
+  Pool.start();
+
+  std::atomic<int> Runs{0};
+  Pool.parallelFor(16, [&](size_t) { ++Runs; });
+  EXPECT_EQ(Runs.load(), 16);
+}
@@ -0,0 +1,154 @@
+//==---- USMHostPool.cpp ---------------------------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <CL/sycl.hpp>
+#include <detail/context_impl.hpp>
+#include <detail/usm/usm_host_pool.hpp>
+#include <helpers/PiMock.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+using namespace cl::sycl;
+using detail::USMHostPool;
+
+static int NumHostAllocs = 0;
+static int NumFrees = 0;
+
+static pi_result redefinedUSMHostAlloc(void **ResultPtr, pi_context,
+                                       pi_usm_mem_properties *, size_t Size,
+                                       pi_uint32 Alignment) {
+  ++NumHostAllocs;
+  *ResultPtr = detail::OSUtil::alignedAlloc(Alignment ? Alignment : 1, Size);
+  return PI_SUCCESS;
+}
+
+static pi_result redefinedUSMFree(pi_context, void *Ptr) {
+  ++NumFrees;
+  detail::OSUtil::alignedFree(Ptr);
+  return PI_SUCCESS;
+}
+
+class USMHostPoolTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    platform Plt{default_selector()};
+    if (Plt.is_host()) {
+      std::cout << "Not run due to host-only environment\n";
+      return;
+    }
+
+    Mock.reset(new unittest::PiMock{Plt});
+    Mock->redefine<detail::PiApiKind::piextUSMHostAlloc>(
+        redefinedUSMHostAlloc);
+    Mock->redefine<detail::PiApiKind::piextUSMFree>(redefinedUSMFree);
+    Ctx.reset(new context{Plt});
+    NumHostAllocs = NumFrees = 0;
+  }
+
+  const detail::plugin &getPlugin() {
+    return detail::getSyclObjImpl(*Ctx)->getPlugin();
+  }
+  RT::PiContext getHandle() {
+    return detail::getSyclObjImpl(*Ctx)->getHandleRef();
+  }
+
+  std::unique_ptr<unittest::PiMock> Mock;
+  std::unique_ptr<context> Ctx;
+};
+
+TEST_F(USMHostPoolTest, DisabledWithZeroCapacity) {
+  if (!Ctx)
+    return;
+  USMHostPool Pool(0);
+  EXPECT_FALSE(Pool.isEnabled());
+  EXPECT_FALSE(Pool.isPoolable(256, 0));
+
+  int Foreign;
+  EXPECT_FALSE(Pool.deallocate(getPlugin(), getHandle(), &Foreign));
+}
+
+TEST_F(USMHostPoolTest, RecyclesFreedBlocks) {
+  if (!Ctx)
+    return;
+  USMHostPool Pool(1024 * 1024);
+  ASSERT_TRUE(Pool.isPoolable(100, 0));
+
+  void *First = Pool.allocate(getPlugin(), getHandle(), 100, 0);
+  ASSERT_NE(First, nullptr);
+  EXPECT_TRUE(Pool.deallocate(getPlugin(), getHandle(), First));
+  EXPECT_EQ(Pool.getCachedSize(), 128u);
+
+  // Sizes of the same class share the free list.
+  void *Second = Pool.allocate(getPlugin(), getHandle(), 120, 0);
+  EXPECT_EQ(First, Second);
+  EXPECT_EQ(NumHostAllocs, 1);
+  EXPECT_EQ(Pool.getCachedSize(), 0u);
+
+  EXPECT_TRUE(Pool.deallocate(getPlugin(), getHandle(), Second));
+  Pool.release(getPlugin(), getHandle());
+  EXPECT_EQ(NumFrees, 1);
+}
+
+TEST_F(USMHostPoolTest, HonorsAlignment) {
+  if (!Ctx)
+    return;
+  USMHostPool Pool(1024 * 1024);
+  EXPECT_FALSE(Pool.isPoolable(64, USMHostPool::MaxBlockAlignment * 2));
+  EXPECT_FALSE(Pool.isPoolable(64, 48));
+
+  ASSERT_TRUE(Pool.isPoolable(64, 1024));
+  void *Ptr = Pool.allocate(getPlugin(), getHandle(), 64, 1024);
+  ASSERT_NE(Ptr, nullptr);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(Ptr) % 1024, 0u);
+  EXPECT_TRUE(Pool.deallocate(getPlugin(), getHandle(), Ptr));
+  Pool.release(getPlugin(), getHandle());
+}
+
+TEST_F(USMHostPoolTest, FreesBlocksOverCapacity) {
+  if (!Ctx)
+    return;
+  USMHostPool Pool(4096);
+  EXPECT_FALSE(Pool.isPoolable(8192, 0));
+
+  void *First = Pool.allocate(getPlugin(), getHandle(), 4096, 0);
+  void *Second = Pool.allocate(getPlugin(), getHandle(), 4096, 0);
+  EXPECT_EQ(NumHostAllocs, 2);
+
+  EXPECT_TRUE(Pool.deallocate(getPlugin(), getHandle(), First));
+  EXPECT_EQ(NumFrees, 0);
+  // The cache is full, the block goes back to the plugin.
+  EXPECT_TRUE(Pool.deallocate(getPlugin(), getHandle(), Second));
+  EXPECT_EQ(NumFrees, 1);
+
+  Pool.release(getPlugin(), getHandle());
+  EXPECT_EQ(NumFrees, 2);
+  EXPECT_EQ(Pool.getCachedSize(), 0u);
+}
+
+TEST_F(USMHostPoolTest, TrimKeepsBlocksInUse) {
+  if (!Ctx)
+    return;
+  USMHostPool Pool(1024 * 1024);
+  void *Cached = Pool.allocate(getPlugin(), getHandle(), 256, 0);
+  void *InUse = Pool.allocate(getPlugin(), getHandle(), 256, 0);
+  EXPECT_TRUE(Pool.deallocate(getPlugin(), getHandle(), Cached));
+
+  Pool.trim(getPlugin(), getHandle());
+  EXPECT_EQ(NumFrees, 1);
+  EXPECT_EQ(Pool.getCachedSize(), 0u);
+
+  // The block in use still belongs to the pool.
+  EXPECT_TRUE(Pool.deallocate(getPlugin(), getHandle(), InUse));
+  EXPECT_EQ(Pool.getCachedSize(), 256u);
+  Pool.release(getPlugin(), getHandle());
+  EXPECT_EQ(NumFrees, 2);
+}
@@ -0,0 +1,148 @@
+//==---- WorkGroupSize.cpp --- Local size selection unit tests -------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <gtest/gtest.h>
+
+#include <detail/work_group_size.hpp>
+
+#include <vector>
+
+using cl::sycl::detail::getLocalSizeCandidates;
+using cl::sycl::detail::KernelWorkGroupLimits;
+using cl::sycl::detail::KernelWorkGroupSizes;
+using cl::sycl::detail::selectLocalSize;
+using cl::sycl::detail::WorkGroupSizePolicy;
+using cl::sycl::detail::WorkSizeT;
+
+static KernelWorkGroupLimits makeGPULimits() {
+  KernelWorkGroupLimits Limits;
+  Limits.MaxSize = 256;
+  Limits.PreferredMultiple = 32;
+  Limits.MaxItemSizes = {256, 256, 64};
+  Limits.ComputeUnits = 4;
+  return Limits;
+}
+
+TEST(WorkGroupSizeTest, LargestMultipleOfPreferred) {
+  WorkSizeT LocalSize;
+  ASSERT_TRUE(selectLocalSize(makeGPULimits(), 1, {1 << 20, 1, 1}, LocalSize));
+  EXPECT_EQ(LocalSize, (WorkSizeT{256, 1, 1}));
+
+  // 160 divides 4320 and is a multiple of 32, the larger sizes are not both.
+  ASSERT_TRUE(selectLocalSize(makeGPULimits(), 1, {4320, 1, 1}, LocalSize));
+  EXPECT_EQ(LocalSize, (WorkSizeT{160, 1, 1}));
+}
+
+TEST(WorkGroupSizeTest, InnermostDimensionFirst) {
+  WorkSizeT LocalSize;
+  ASSERT_TRUE(selectLocalSize(makeGPULimits(), 2, {1024, 1024, 1}, LocalSize));
+  EXPECT_EQ(LocalSize, (WorkSizeT{256, 1, 1}));
+
+  // The innermost dimension only has 64 items, the next one makes up the rest.
+  ASSERT_TRUE(selectLocalSize(makeGPULimits(), 2, {64, 1024, 1}, LocalSize));
+  EXPECT_EQ(LocalSize, (WorkSizeT{64, 4, 1}));
+
+  // The outermost dimension is bounded by its maximum size.
+  ASSERT_TRUE(selectLocalSize(makeGPULimits(), 3, {1, 1, 1024}, LocalSize));
+  EXPECT_EQ(LocalSize, (WorkSizeT{1, 1, 64}));
+}
+
+TEST(WorkGroupSizeTest, EveryComputeUnitGetsAGroup) {
+  WorkSizeT LocalSize;
+  // 512 items make 2 groups of 256 for 4 compute units.
+  ASSERT_TRUE(selectLocalSize(makeGPULimits(), 1, {512, 1, 1}, LocalSize));
+  EXPECT_EQ(LocalSize, (WorkSizeT{128, 1, 1}));
+
+  // The groups are not made smaller than the preferred multiple.
+  ASSERT_TRUE(selectLocalSize(makeGPULimits(), 1, {64, 1, 1}, LocalSize));
+  EXPECT_EQ(LocalSize, (WorkSizeT{32, 1, 1}));
+}
+
+TEST(WorkGroupSizeTest, LeavesToDriver) {
+  WorkSizeT LocalSize;
+  // A prime number of items only makes groups of 1.
+  EXPECT_FALSE(selectLocalSize(makeGPULimits(), 1, {1000003, 1, 1}, LocalSize));
+
+  // But a range smaller than a group is launched as a single one.
+  ASSERT_TRUE(selectLocalSize(makeGPULimits(), 1, {7, 1, 1}, LocalSize));
+  EXPECT_EQ(LocalSize, (WorkSizeT{7, 1, 1}));
+
+  KernelWorkGroupLimits Required = makeGPULimits();
+  Required.HasRequiredSize = true;
+  EXPECT_FALSE(selectLocalSize(Required, 1, {1 << 20, 1, 1}, LocalSize));
+
+  EXPECT_FALSE(selectLocalSize(KernelWorkGroupLimits{}, 1, {1 << 20, 1, 1},
+                               LocalSize));
+}
+
+TEST(WorkGroupSizeTest, Candidates) {
+  std::vector<WorkSizeT> Candidates =
+      getLocalSizeCandidates(makeGPULimits(), 1, {1 << 20, 1, 1});
+  std::vector<WorkSizeT> Expected = {
+      {256, 1, 1}, {128, 1, 1}, {64, 1, 1}, {32, 1, 1}, {0, 0, 0}};
+  EXPECT_EQ(Candidates, Expected);
+
+  Candidates = getLocalSizeCandidates(makeGPULimits(), 1, {1000003, 1, 1});
+  EXPECT_EQ(Candidates, std::vector<WorkSizeT>{WorkSizeT{}});
+}
+
+TEST(WorkGroupSizeTest, OccupancyPolicy) {
+  KernelWorkGroupSizes Sizes(makeGPULimits());
+  WorkSizeT LocalSize;
+  KernelWorkGroupSizes::Trial Trial;
+  for (int I = 0; I < 3; ++I) {
+    ASSERT_TRUE(Sizes.getLocalSize(WorkGroupSizePolicy::occupancy, 1,
+                                   {1 << 20, 1, 1}, LocalSize, &Trial));
+    EXPECT_EQ(LocalSize, (WorkSizeT{256, 1, 1}));
+    EXPECT_FALSE(Trial.IsTimed);
+  }
+  EXPECT_FALSE(Sizes.getLocalSize(WorkGroupSizePolicy::driver, 1,
+                                  {1 << 20, 1, 1}, LocalSize, &Trial));
+}
+
+TEST(WorkGroupSizeTest, AutotuneKeepsFastest) {
+  KernelWorkGroupSizes Sizes(makeGPULimits());
+  const WorkSizeT GlobalSize{1 << 20, 1, 1};
+  const std::vector<WorkSizeT> Candidates =
+      getLocalSizeCandidates(makeGPULimits(), 1, GlobalSize);
+  WorkSizeT LocalSize;
+
+  // The warm-up launch is not timed.
+  KernelWorkGroupSizes::Trial WarmUp;
+  ASSERT_TRUE(Sizes.getLocalSize(WorkGroupSizePolicy::autotune, 1, GlobalSize,
+                                 LocalSize, &WarmUp));
+  EXPECT_FALSE(WarmUp.IsTimed);
+
+  for (size_t I = 0; I < Candidates.size(); ++I) {
+    KernelWorkGroupSizes::Trial Trial;
+    const bool HasLocalSize = Sizes.getLocalSize(
+        WorkGroupSizePolicy::autotune, 1, GlobalSize, LocalSize, &Trial);
+    ASSERT_TRUE(Trial.IsTimed);
+    EXPECT_EQ(Trial.Candidate, I);
+    EXPECT_EQ(HasLocalSize, Candidates[I][0] != 0);
+    if (HasLocalSize)
+      EXPECT_EQ(LocalSize, Candidates[I]);
+    // The candidate of 64 items is the fastest.
+    Sizes.recordTrial(Trial, Candidates[I][0] == 64 ? 10 : 100);
+  }
+
+  for (int I = 0; I < 3; ++I) {
+    KernelWorkGroupSizes::Trial Trial;
+    ASSERT_TRUE(Sizes.getLocalSize(WorkGroupSizePolicy::autotune, 1,
+                                   GlobalSize, LocalSize, &Trial));
+    EXPECT_FALSE(Trial.IsTimed);
+    EXPECT_EQ(LocalSize, (WorkSizeT{64, 1, 1}));
+  }
+
+  // The launches which can't be timed use the first candidate until the
+  // tuning is done.
+  KernelWorkGroupSizes Untimed(makeGPULimits());
+  ASSERT_TRUE(Untimed.getLocalSize(WorkGroupSizePolicy::autotune, 1,
+                                   GlobalSize, LocalSize, nullptr));
+  EXPECT_EQ(LocalSize, Candidates[0]);
+}
@@ -134,3 +134,56 @@ TEST_F(CudaCommandsTest, PIEnqueueReadBufferNonBlocking) {
     std::cout << std::endl;
   }
 }
+
+TEST_F(CudaCommandsTest, PIEnqueueCommandGraph) {
+  constexpr const size_t bytes = 64u;
+  unsigned char output[bytes] = {};
+
+  void *ptr = nullptr;
+  ASSERT_EQ((plugin.call_nocheck<detail::PiApiKind::piextUSMDeviceAlloc>(
+                &ptr, context_, device_, nullptr, bytes, 0)),
+            PI_SUCCESS);
+
+  // Record the fill with one value, then record it again with another one,
+  // which updates the graph in place.
+  pi_ext_command_graph graph = nullptr;
+  for (int value : {1, 2}) {
+    ASSERT_EQ(
+        (plugin.call_nocheck<detail::PiApiKind::piextQueueBeginGraphCapture>(
+            queue_)),
+        PI_SUCCESS);
+    ASSERT_EQ((plugin.call_nocheck<detail::PiApiKind::piextUSMEnqueueMemset>(
+                  queue_, ptr, value, bytes, 0, nullptr, nullptr)),
+              PI_SUCCESS);
+    ASSERT_EQ(
+        (plugin.call_nocheck<detail::PiApiKind::piextQueueEndGraphCapture>(
+            queue_, &graph)),
+        PI_SUCCESS);
+    ASSERT_NE(graph, nullptr);
+  }
+
+  // Nothing has been executed while recording.
+  ASSERT_EQ((plugin.call_nocheck<detail::PiApiKind::piextUSMEnqueueMemcpy>(
+                queue_, true, output, ptr, bytes, 0, nullptr, nullptr)),
+            PI_SUCCESS);
+  EXPECT_EQ(output[0], 0u);
+
+  pi_event event;
+  ASSERT_EQ((plugin.call_nocheck<detail::PiApiKind::piextEnqueueCommandGraph>(
+                queue_, graph, 0, nullptr, &event)),
+            PI_SUCCESS);
+  ASSERT_EQ((plugin.call_nocheck<detail::PiApiKind::piextUSMEnqueueMemcpy>(
+                queue_, true, output, ptr, bytes, 1, &event, nullptr)),
+            PI_SUCCESS);
+  EXPECT_TRUE(std::all_of(std::begin(output), std::end(output),
+                          [](unsigned char elem) { return elem == 2; }));
+
+  ASSERT_EQ((plugin.call_nocheck<detail::PiApiKind::piEventRelease>(event)),
+            PI_SUCCESS);
+  ASSERT_EQ((plugin.call_nocheck<detail::PiApiKind::piextCommandGraphRelease>(
+                graph)),
+            PI_SUCCESS);
+  ASSERT_EQ(
+      (plugin.call_nocheck<detail::PiApiKind::piextUSMFree>(context_, ptr)),
+      PI_SUCCESS);
+}
@@ -253,6 +253,46 @@ TEST_F(CudaKernelsTest, PIKernelSetMemObj) {
   ASSERT_EQ(storedValue, memObj);
 }
 
+TEST_F(CudaKernelsTest, PIKernelSetArgs) {
+
+  pi_program prog;
+  pi_int32 binary_status = PI_SUCCESS;
+  ASSERT_EQ((plugin.call_nocheck<detail::PiApiKind::piProgramCreateWithBinary>(
+                context_, 1, &device_, nullptr,
+                (const unsigned char **)&ptxSource, &binary_status, &prog)),
+            PI_SUCCESS);
+  ASSERT_EQ(binary_status, PI_SUCCESS);
+
+  ASSERT_EQ((plugin.call_nocheck<detail::PiApiKind::piProgramBuild>(
+                prog, 1, &device_, "", nullptr, nullptr)),
+            PI_SUCCESS);
+
+  pi_kernel kern;
+  ASSERT_EQ((plugin.call_nocheck<detail::PiApiKind::piKernelCreate>(
+                prog, "_Z8myKernelPi", &kern)),
+            PI_SUCCESS);
+
+  size_t memSize = 1024u;
+  pi_mem memObj;
+  ASSERT_EQ((plugin.call_nocheck<detail::PiApiKind::piMemBufferCreate>(
+                context_, PI_MEM_FLAGS_ACCESS_RW, memSize, nullptr, &memObj,
+                nullptr)),
+            PI_SUCCESS);
+
+  // The arguments are set in order, the last one for an index wins.
+  int number = 10;
+  const pi_kernel_arg args[] = {
+      {PI_KERNEL_ARG_VALUE, 0, sizeof(int), &number},
+      {PI_KERNEL_ARG_MEM_OBJ, 0, sizeof(pi_mem), &memObj}};
+  ASSERT_EQ((plugin.call_nocheck<detail::PiApiKind::piextKernelSetArgs>(
+                kern, 2, args)),
+            PI_SUCCESS);
+  const auto &kernArgs = kern->get_arg_indices();
+  ASSERT_EQ(kernArgs.size(), (size_t)1 + NUM_IMPLICIT_ARGS);
+  CUdeviceptr storedValue = *(static_cast<CUdeviceptr *>(kernArgs[0]));
+  ASSERT_EQ(storedValue, memObj->mem_.buffer_mem_.get());
+}
+
 TEST_F(CudaKernelsTest, PIkerneldispatch) {
 
   pi_program prog;
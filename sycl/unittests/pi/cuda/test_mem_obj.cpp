@@ -86,6 +86,46 @@ TEST_F(CudaTestMemObj, piMemBufferAllocHost) {
             PI_SUCCESS);
 }
 
+TEST_F(CudaTestMemObj, piextUSMDeviceAllocPooled) {
+  ASSERT_NE(context_->deviceMemPool_, nullptr);
+
+  const size_t memSize = 1024u;
+  void *first = nullptr;
+  void *second = nullptr;
+  ASSERT_EQ((plugin.call_nocheck<detail::PiApiKind::piextUSMDeviceAlloc>(
+                &first, context_, device_, nullptr, memSize, 0)),
+            PI_SUCCESS);
+  ASSERT_EQ((plugin.call_nocheck<detail::PiApiKind::piextUSMDeviceAlloc>(
+                &second, context_, device_, nullptr, memSize, 0)),
+            PI_SUCCESS);
+  ASSERT_NE(first, nullptr);
+  ASSERT_NE(second, nullptr);
+  EXPECT_NE(first, second);
+
+  // Pooled allocations are regular device memory.
+  unsigned int type = 0;
+  ASSERT_EQ(cuPointerGetAttribute(&type, CU_POINTER_ATTRIBUTE_MEMORY_TYPE,
+                                  reinterpret_cast<CUdeviceptr>(second)),
+            CUDA_SUCCESS);
+  EXPECT_EQ(type, CU_MEMORYTYPE_DEVICE);
+
+  // A freed block is handed out again without calling the driver.
+  ASSERT_EQ((plugin.call_nocheck<detail::PiApiKind::piextUSMFree>(context_,
+                                                                   second)),
+            PI_SUCCESS);
+  void *third = nullptr;
+  ASSERT_EQ((plugin.call_nocheck<detail::PiApiKind::piextUSMDeviceAlloc>(
+                &third, context_, device_, nullptr, memSize, 0)),
+            PI_SUCCESS);
+  EXPECT_EQ(third, second);
+
+  for (void *ptr : {first, third}) {
+    ASSERT_EQ(
+        (plugin.call_nocheck<detail::PiApiKind::piextUSMFree>(context_, ptr)),
+        PI_SUCCESS);
+  }
+}
+
 TEST_F(CudaTestMemObj, piMemBufferCreateNoActiveContext) {
   const size_t memSize = 1024u;
   // Context has been destroyed
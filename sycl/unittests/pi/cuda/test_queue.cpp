@@ -149,3 +149,49 @@ TEST_F(CudaTestQueue, PICreateQueueInterop) {
   ASSERT_EQ((plugin.call_nocheck<detail::PiApiKind::piQueueRelease>(queue)),
             PI_SUCCESS);
 }
+
+TEST_F(CudaTestQueue, PICreateQueueOutOfOrderStreams) {
+  // The stream counts are read once, when the first out-of-order queue is
+  // created, so this must be the only test creating such queues.
+  setenv("SYCL_PI_CUDA_NUM_COMPUTE_STREAMS", "2", 1);
+  setenv("SYCL_PI_CUDA_NUM_TRANSFER_STREAMS", "1", 1);
+
+  pi_queue queue;
+  ASSERT_EQ((plugin.call_nocheck<detail::PiApiKind::piQueueCreate>(
+                context_, device_, PI_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE,
+                &queue)),
+            PI_SUCCESS);
+  ASSERT_NE(queue, nullptr);
+
+  ASSERT_EQ(queue->computeStreams_.size(), 2u);
+  ASSERT_EQ(queue->transferStreams_.size(), 1u);
+  EXPECT_EQ(queue->get(), queue->computeStreams_[0]);
+
+  // Kernels alternate between the compute streams, memory operations stay on
+  // the transfer stream.
+  CUstream first = queue->get_next_compute_stream();
+  CUstream second = queue->get_next_compute_stream();
+  EXPECT_NE(first, second);
+  EXPECT_EQ(queue->get_next_compute_stream(), first);
+  EXPECT_EQ(queue->get_next_transfer_stream(), queue->transferStreams_[0]);
+  EXPECT_EQ(queue->get_next_transfer_stream(), queue->transferStreams_[0]);
+
+  // A marker without a wait list covers the work of all streams.
+  pi_event event;
+  ASSERT_EQ((plugin.call_nocheck<detail::PiApiKind::piEnqueueEventsWait>(
+                queue, 0, nullptr, &event)),
+            PI_SUCCESS);
+  ASSERT_EQ((plugin.call_nocheck<detail::PiApiKind::piEventsWait>(1, &event)),
+            PI_SUCCESS);
+  ASSERT_EQ((plugin.call_nocheck<detail::PiApiKind::piEventRelease>(event)),
+            PI_SUCCESS);
+
+  ASSERT_EQ((plugin.call_nocheck<detail::PiApiKind::piQueueFinish>(queue)),
+            PI_SUCCESS);
+  for (CUstream stream : queue->computeStreams_)
+    EXPECT_EQ(cuStreamQuery(stream), CUDA_SUCCESS);
+  EXPECT_EQ(cuStreamQuery(queue->transferStreams_[0]), CUDA_SUCCESS);
+
+  ASSERT_EQ((plugin.call_nocheck<detail::PiApiKind::piQueueRelease>(queue)),
+            PI_SUCCESS);
+}
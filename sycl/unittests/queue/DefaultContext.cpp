@@ -0,0 +1,53 @@
+//==------- DefaultContext.cpp --- default context and selection cache -----==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <CL/sycl.hpp>
+#include <gtest/gtest.h>
+
+using namespace cl::sycl;
+
+TEST(DefaultContext, SharedByQueuesOfDevice) {
+  queue Q1;
+  queue Q2{Q1.get_device()};
+  queue Q3{default_selector()};
+  EXPECT_EQ(Q1.get_context(), Q2.get_context());
+  EXPECT_EQ(Q1.get_context(), Q3.get_context());
+
+  // The contexts constructed by users are not shared.
+  context Ctx{Q1.get_device()};
+  queue Q4{Ctx, Q1.get_device()};
+  EXPECT_NE(Q4.get_context(), Q1.get_context());
+}
+
+TEST(DefaultContext, OwnContextPerHostDevice) {
+  queue HostQueue{host_selector()};
+  queue DefaultQueue;
+  if (DefaultQueue.is_host())
+    return;
+  EXPECT_NE(HostQueue.get_context(), DefaultQueue.get_context());
+}
+
+TEST(DeviceSelectionCache, SelectionsAreStable) {
+  vector_class<device> Devices = device::get_devices();
+  EXPECT_EQ(Devices, device::get_devices());
+  EXPECT_EQ(platform::get_platforms(), platform::get_platforms());
+
+  device Default = default_selector().select_device();
+  EXPECT_EQ(Default, default_selector().select_device());
+  EXPECT_EQ(host_selector().select_device(), host_selector().select_device());
+  EXPECT_TRUE(host_selector().select_device().is_host());
+
+  // A subclass of a built-in selector makes its own choice.
+  struct HostPreferringSelector : public default_selector {
+    int operator()(const device &Dev) const override {
+      return Dev.is_host() ? 10000 : default_selector::operator()(Dev);
+    }
+  };
+  EXPECT_TRUE(HostPreferringSelector().select_device().is_host());
+  EXPECT_EQ(default_selector().select_device(), Default);
+}
@@ -0,0 +1,74 @@
+//==------- ReductionScratch.cpp --- reduction scratch arena unit test -----==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <CL/sycl.hpp>
+#include <detail/queue_impl.hpp>
+#include <gtest/gtest.h>
+
+using namespace cl::sycl;
+
+TEST(ReductionScratch, BuffersAreReused) {
+  queue Q;
+  shared_ptr_class<detail::queue_impl> QueueImpl = detail::getSyclObjImpl(Q);
+
+  auto Buf = ONEAPI::detail::reduGetScratchBuffer(QueueImpl, 64, false);
+  auto BufImpl = detail::getSyclObjImpl(*Buf);
+  Buf.reset();
+
+  // A buffer of another size or initialization is not the returned one.
+  auto OtherSize = ONEAPI::detail::reduGetScratchBuffer(QueueImpl, 32, false);
+  EXPECT_NE(detail::getSyclObjImpl(*OtherSize), BufImpl);
+  auto ZeroInit = ONEAPI::detail::reduGetScratchBuffer(QueueImpl, 64, true);
+  EXPECT_NE(detail::getSyclObjImpl(*ZeroInit), BufImpl);
+
+  auto SameBuf = ONEAPI::detail::reduGetScratchBuffer(QueueImpl, 64, false);
+  EXPECT_EQ(detail::getSyclObjImpl(*SameBuf), BufImpl);
+
+  // The buffer is not shared while it is in use.
+  auto NewBuf = ONEAPI::detail::reduGetScratchBuffer(QueueImpl, 64, false);
+  EXPECT_NE(detail::getSyclObjImpl(*NewBuf), BufImpl);
+}
+
+TEST(ReductionScratch, BufferOutlivesQueue) {
+  shared_ptr_class<buffer<unsigned char, 1>> Buf;
+  {
+    queue Q;
+    Buf = ONEAPI::detail::reduGetScratchBuffer(detail::getSyclObjImpl(Q), 16,
+                                               true);
+  }
+  EXPECT_EQ(Buf->get_count(), 16u);
+  Buf.reset();
+}
+
+TEST(ReductionScratch, USMScratchNeedsInOrderQueue) {
+  queue Q;
+  EXPECT_EQ(
+      ONEAPI::detail::reduGetUSMScratch(detail::getSyclObjImpl(Q), 64, false),
+      nullptr);
+}
+
+TEST(ReductionScratch, USMScratchIsReused) {
+  queue Q{property::queue::in_order()};
+  if (Q.is_host())
+    return;
+  shared_ptr_class<detail::queue_impl> QueueImpl = detail::getSyclObjImpl(Q);
+
+  auto Scratch = ONEAPI::detail::reduGetUSMScratch(QueueImpl, 64, false);
+  void *Ptr = Scratch.get();
+  ASSERT_NE(Ptr, nullptr);
+  Scratch.reset();
+
+  auto ZeroInit = ONEAPI::detail::reduGetUSMScratch(QueueImpl, 64, true);
+  EXPECT_NE(ZeroInit.get(), Ptr);
+  auto Same = ONEAPI::detail::reduGetUSMScratch(QueueImpl, 64, false);
+  EXPECT_EQ(Same.get(), Ptr);
+
+  // The memory is not shared while it is in use.
+  auto New = ONEAPI::detail::reduGetUSMScratch(QueueImpl, 64, false);
+  EXPECT_NE(New.get(), Ptr);
+}
@@ -0,0 +1,159 @@
+//==------------- USMRect.cpp --- rectangular USM copy unit tests ----------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <CL/sycl.hpp>
+#include <detail/context_impl.hpp>
+#include <gtest/gtest.h>
+#include <helpers/PiMock.hpp>
+
+#include <vector>
+
+using namespace cl::sycl;
+
+static context *TestContext = nullptr;
+static int NumRectCopies = 0;
+static int NumRectFills = 0;
+static pi_buff_rect_region_struct LastRegion;
+static size_t LastDstRowPitch = 0;
+static size_t LastSrcRowPitch = 0;
+static std::vector<const void *> RowCopySources;
+static int NumEventsJoined = 0;
+
+static pi_result redefinedUSMEnqueueMemcpyRect(
+    pi_queue, pi_bool, void *, size_t DstRowPitch, size_t, const void *,
+    size_t SrcRowPitch, size_t, pi_buff_rect_region Region, pi_uint32,
+    const pi_event *, pi_event *Event) {
+  ++NumRectCopies;
+  LastRegion = *Region;
+  LastDstRowPitch = DstRowPitch;
+  LastSrcRowPitch = SrcRowPitch;
+  *Event = reinterpret_cast<pi_event>(1);
+  return PI_SUCCESS;
+}
+
+static pi_result redefinedUSMEnqueueFillRect(pi_queue, void *, size_t,
+                                             const void *, size_t PatternSize,
+                                             size_t Width, size_t Height,
+                                             pi_uint32, const pi_event *,
+                                             pi_event *Event) {
+  ++NumRectFills;
+  LastRegion = {Width, Height, PatternSize};
+  *Event = reinterpret_cast<pi_event>(1);
+  return PI_SUCCESS;
+}
+
+static pi_result redefinedUSMEnqueueMemcpy(pi_queue, pi_bool, void *,
+                                           const void *Src, size_t, pi_uint32,
+                                           const pi_event *, pi_event *Event) {
+  RowCopySources.push_back(Src);
+  *Event = reinterpret_cast<pi_event>(1);
+  return PI_SUCCESS;
+}
+
+static pi_result redefinedEnqueueEventsWait(pi_queue, pi_uint32 NumEvents,
+                                            const pi_event *,
+                                            pi_event *Event) {
+  NumEventsJoined += NumEvents;
+  *Event = reinterpret_cast<pi_event>(1);
+  return PI_SUCCESS;
+}
+
+static pi_result redefinedEventGetInfo(pi_event, pi_event_info ParamName,
+                                       size_t, void *ParamValue, size_t *) {
+  if (ParamName == PI_EVENT_INFO_COMMAND_EXECUTION_STATUS) {
+    *reinterpret_cast<pi_int32 *>(ParamValue) = PI_EVENT_COMPLETE;
+    return PI_SUCCESS;
+  }
+  *reinterpret_cast<RT::PiContext *>(ParamValue) =
+      detail::getSyclObjImpl(*TestContext)->getHandleRef();
+  return PI_SUCCESS;
+}
+
+static pi_result redefinedEventsWait(pi_uint32, const pi_event *) {
+  return PI_SUCCESS;
+}
+
+static pi_result redefinedEventRetainRelease(pi_event) { return PI_SUCCESS; }
+
+static void setUpMock(unittest::PiMock &Mock) {
+  Mock.redefine<detail::PiApiKind::piextUSMEnqueueMemcpyRect>(
+      redefinedUSMEnqueueMemcpyRect);
+  Mock.redefine<detail::PiApiKind::piextUSMEnqueueFillRect>(
+      redefinedUSMEnqueueFillRect);
+  Mock.redefine<detail::PiApiKind::piextUSMEnqueueMemcpy>(
+      redefinedUSMEnqueueMemcpy);
+  Mock.redefine<detail::PiApiKind::piEnqueueEventsWait>(
+      redefinedEnqueueEventsWait);
+  Mock.redefine<detail::PiApiKind::piEventGetInfo>(redefinedEventGetInfo);
+  Mock.redefine<detail::PiApiKind::piEventsWait>(redefinedEventsWait);
+  Mock.redefine<detail::PiApiKind::piEventRetain>(
+      redefinedEventRetainRelease);
+  Mock.redefine<detail::PiApiKind::piEventRelease>(
+      redefinedEventRetainRelease);
+  NumRectCopies = 0;
+  NumRectFills = 0;
+  NumEventsJoined = 0;
+  RowCopySources.clear();
+}
+
+TEST(USMRectTest, CopiesOneRectangle) {
+  platform Plt{default_selector()};
+  if (Plt.is_host()) {
+    std::cout << "Not run on host - no PI calls made in that case" << std::endl;
+    return;
+  }
+  unittest::PiMock Mock{Plt};
+  setUpMock(Mock);
+  context Ctx{Plt};
+  TestContext = &Ctx;
+  queue Q{Ctx, default_selector()};
+
+  std::vector<char> Src(64 * 16), Dst(128 * 16);
+  Q.memcpy2d(Dst.data(), 128, Src.data(), 64, 48, 16).wait();
+  ASSERT_EQ(NumRectCopies, 1);
+  EXPECT_EQ(LastRegion.width_bytes, 48u);
+  EXPECT_EQ(LastRegion.height_scalar, 16u);
+  EXPECT_EQ(LastRegion.depth_scalar, 1u);
+  EXPECT_EQ(LastDstRowPitch, 128u);
+  EXPECT_EQ(LastSrcRowPitch, 64u);
+
+  Q.fill2d(Dst.data(), 128, 7, 12, 16).wait();
+  ASSERT_EQ(NumRectFills, 1);
+  EXPECT_EQ(LastRegion.width_bytes, 12 * sizeof(int));
+  EXPECT_EQ(LastRegion.height_scalar, 16u);
+  EXPECT_EQ(LastRegion.depth_scalar, sizeof(int));
+
+  // The pitches can't be smaller than the rows.
+  EXPECT_THROW(Q.memcpy2d(Dst.data(), 32, Src.data(), 64, 48, 16),
+               invalid_parameter_error);
+  TestContext = nullptr;
+}
+
+TEST(USMRectTest, CopiesRowsWithoutRectCopies) {
+  platform Plt{default_selector()};
+  if (Plt.is_host()) {
+    std::cout << "Not run on host - no PI calls made in that case" << std::endl;
+    return;
+  }
+  unittest::PiMock Mock{Plt};
+  setUpMock(Mock);
+  Mock.redefine<detail::PiApiKind::piextUSMEnqueueMemcpyRect>(
+      static_cast<decltype(&piextUSMEnqueueMemcpyRect)>(nullptr));
+  context Ctx{Plt};
+  TestContext = &Ctx;
+  queue Q{Ctx, default_selector()};
+
+  std::vector<char> Src(64 * 4 * 2), Dst(64 * 4 * 2);
+  Q.memcpy3d(Dst.data(), 64, 256, Src.data(), 64, 256, 32, 4, 2).wait();
+  EXPECT_EQ(NumRectCopies, 0);
+  ASSERT_EQ(RowCopySources.size(), 8u);
+  EXPECT_EQ(RowCopySources[1], Src.data() + 64);
+  EXPECT_EQ(RowCopySources[4], Src.data() + 256);
+  EXPECT_EQ(NumEventsJoined, 8);
+  TestContext = nullptr;
+}
@@ -19,6 +19,7 @@ struct TestCtx {
   context &Ctx;
   int NEventsWaitedFor = 0;
   int EventReferenceCount = 0;
+  int NEventsReleased = 0;
 };
 
 std::unique_ptr<TestCtx> TestContext;
@@ -43,6 +44,10 @@ pi_result redefinedEventsWait(pi_uint32 num_events,
 pi_result redefinedEventGetInfo(pi_event event, pi_event_info param_name,
                                 size_t param_value_size, void *param_value,
                                 size_t *param_value_size_ret) {
+  if (param_name == PI_EVENT_INFO_COMMAND_EXECUTION_STATUS) {
+    *reinterpret_cast<pi_int32 *>(param_value) = PI_EVENT_COMPLETE;
+    return PI_SUCCESS;
+  }
   EXPECT_EQ(param_name, PI_EVENT_INFO_CONTEXT)
       << "Unexpected event info requested";
   auto *Result = reinterpret_cast<RT::PiContext *>(param_value);
@@ -59,6 +64,7 @@ pi_result redefinedEventRetain(pi_event event) {
 
 pi_result redefinedEventRelease(pi_event event) {
   --TestContext->EventReferenceCount;
+  ++TestContext->NEventsReleased;
   return PI_SUCCESS;
 }
 
@@ -99,3 +105,43 @@ TEST(QueueWaitTest, USMEventClear) {
   Q.wait();
   ASSERT_EQ(TestContext->NEventsWaitedFor, 1);
 }
+
+// Check that the complete USM events are dropped by a queue which is never
+// waited on, instead of being tracked until the next call to wait().
+TEST(QueueWaitTest, USMEventPrune) {
+  platform Plt{default_selector()};
+  if (Plt.is_host()) {
+    std::cout << "Not run on host - no PI events created in that case"
+              << std::endl;
+    return;
+  }
+
+  // TODO: Skip test for CUDA temporarily
+  if (detail::getSyclObjImpl(Plt)->getPlugin().getBackend() == backend::cuda) {
+    std::cout << "Not run on CUDA - usm is not supported for CUDA backend yet"
+              << std::endl;
+    return;
+  }
+
+  unittest::PiMock Mock{Plt};
+  Mock.redefine<detail::PiApiKind::piextUSMEnqueueMemset>(
+      redefinedUSMEnqueueMemset);
+  Mock.redefine<detail::PiApiKind::piEventsWait>(redefinedEventsWait);
+  Mock.redefine<detail::PiApiKind::piEventGetInfo>(redefinedEventGetInfo);
+  Mock.redefine<detail::PiApiKind::piEventRetain>(redefinedEventRetain);
+  Mock.redefine<detail::PiApiKind::piEventRelease>(redefinedEventRelease);
+
+  context Ctx{Plt};
+  TestContext.reset(new TestCtx(Ctx));
+  queue Q{Ctx, default_selector()};
+
+  unsigned char *HostAlloc = (unsigned char *)malloc_host(1, Ctx);
+  const int NumEvents = 1000;
+  for (int I = 0; I < NumEvents; ++I)
+    Q.memset(HostAlloc, 42, 1);
+  // At most the events added since the last pruning are still tracked
+  EXPECT_GT(TestContext->NEventsReleased, NumEvents / 2);
+  Q.wait();
+  EXPECT_EQ(TestContext->NEventsReleased, NumEvents);
+  free(HostAlloc, Ctx);
+}
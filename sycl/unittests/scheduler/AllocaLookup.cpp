@@ -0,0 +1,73 @@
+//==---------------- AllocaLookup.cpp --- Scheduler unit tests -------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "SchedulerTest.hpp"
+#include "SchedulerTestUtils.hpp"
+
+using namespace cl::sycl;
+
+// The allocations of a memory object are found by context, and the ones of
+// its sub-buffers by context and offset, whatever the number of allocations.
+TEST_F(SchedulerTest, AllocaLookup) {
+  queue HostQueue{host_selector()};
+  queue OtherHostQueue{host_selector()};
+  detail::QueueImplPtr HostQueueImpl = detail::getSyclObjImpl(HostQueue);
+  detail::QueueImplPtr OtherHostQueueImpl =
+      detail::getSyclObjImpl(OtherHostQueue);
+
+  MockScheduler MS;
+  constexpr size_t NumSubBuffers = 8;
+  constexpr size_t SubBufferSize = 4;
+  buffer<int, 1> Buf(range<1>(NumSubBuffers * SubBufferSize));
+  detail::SYCLMemObjI *MemObj = detail::getSyclObjImpl(Buf).get();
+  const range<3> MemoryRange{NumSubBuffers * SubBufferSize, 1, 1};
+  detail::Requirement Req(/*Offset*/ {0, 0, 0}, MemoryRange, MemoryRange,
+                          access::mode::read_write, MemObj, /*Dims*/ 1,
+                          /*ElemSize*/ sizeof(int));
+  std::vector<detail::Requirement> SubReqs;
+  for (size_t I = 0; I < NumSubBuffers; ++I)
+    SubReqs.emplace_back(
+        /*Offset*/ id<3>{I * SubBufferSize, 0, 0},
+        /*AccessRange*/ range<3>{SubBufferSize, 1, 1}, MemoryRange,
+        access::mode::read_write, MemObj, /*Dims*/ 1,
+        /*ElemSize*/ sizeof(int),
+        /*OffsetInBytes*/ I * SubBufferSize * sizeof(int),
+        /*IsSubBuffer*/ true);
+
+  detail::MemObjRecord *Record =
+      MS.getOrInsertMemObjRecord(HostQueueImpl, &Req);
+  detail::AllocaCommandBase *Alloca =
+      MS.getOrCreateAllocaForReq(Record, &Req, HostQueueImpl);
+  std::vector<detail::AllocaCommandBase *> SubAllocas;
+  for (detail::Requirement &SubReq : SubReqs)
+    SubAllocas.push_back(
+        MS.getOrCreateAllocaForReq(Record, &SubReq, HostQueueImpl));
+
+  ASSERT_EQ(Record->MAllocaCommands.size(), NumSubBuffers + 1);
+  EXPECT_EQ(Alloca->getType(), detail::Command::ALLOCA);
+  for (size_t I = 0; I < NumSubBuffers; ++I) {
+    EXPECT_EQ(SubAllocas[I]->getType(), detail::Command::ALLOCA_SUB_BUF);
+    EXPECT_EQ(static_cast<detail::AllocaSubBufCommand *>(SubAllocas[I])
+                  ->getParentAlloca(),
+              Alloca);
+  }
+
+  // The same allocations are found again, also from another host context,
+  // and no new ones are made.
+  EXPECT_EQ(MS.getOrCreateAllocaForReq(Record, &Req, OtherHostQueueImpl),
+            Alloca);
+  for (size_t I = 0; I < NumSubBuffers; ++I)
+    EXPECT_EQ(
+        MS.getOrCreateAllocaForReq(Record, &SubReqs[I], OtherHostQueueImpl),
+        SubAllocas[I]);
+  EXPECT_EQ(Record->MAllocaCommands.size(), NumSubBuffers + 1);
+  EXPECT_EQ(Record->findAlloca(HostQueueImpl->getContextImplPtr()), Alloca);
+  EXPECT_EQ(Record->findSubBufAlloca(HostQueueImpl->getContextImplPtr(),
+                                     /*OffsetInBytes*/ 1),
+            nullptr);
+}
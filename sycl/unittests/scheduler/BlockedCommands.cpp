@@ -169,3 +169,47 @@ TEST_F(SchedulerTest, EnqueueHostDependency) {
   ASSERT_EQ(detail::EnqueueResultT::SyclEnqueueSuccess, Res.MResult)
       << "Enqueue operation should return successfully.\n";
 }
+
+TEST_F(SchedulerTest, EnqueueUsersOfCompletedCommand) {
+  MockCommand A(detail::getSyclObjImpl(MQueue));
+  A.MEnqueueStatus = detail::EnqueueResultT::SyclEnqueueSuccess;
+
+  MockCommand B(detail::getSyclObjImpl(MQueue));
+  B.MEnqueueStatus = detail::EnqueueResultT::SyclEnqueueReady;
+  B.MRetVal = CL_SUCCESS;
+
+  MockCommand C(detail::getSyclObjImpl(MQueue));
+  C.MEnqueueStatus = detail::EnqueueResultT::SyclEnqueueReady;
+  C.MRetVal = CL_SUCCESS;
+
+  MockCommand D(detail::getSyclObjImpl(MQueue));
+  D.MEnqueueStatus = detail::EnqueueResultT::SyclEnqueueBlocked;
+  D.MIsBlockable = true;
+
+  MockCommand E(detail::getSyclObjImpl(MQueue));
+  E.MEnqueueStatus = detail::EnqueueResultT::SyclEnqueueReady;
+  E.MRetVal = CL_SUCCESS;
+
+  addEdge(&B, &A, nullptr);
+  addEdge(&C, &B, nullptr);
+  addEdge(&D, &A, nullptr);
+  addEdge(&E, &D, nullptr);
+
+  // We have such a graph:
+  //
+  //   C -> B -> A
+  //   E -> D -> A
+  //
+  // Once A is complete, B and C are enqueued straight away, D is still
+  // blocked and so is E.
+
+  EXPECT_CALL(B, enqueue(_, _)).Times(AtLeast(1));
+  EXPECT_CALL(C, enqueue(_, _)).Times(AtLeast(1));
+  EXPECT_CALL(D, enqueue(_, _)).Times(0);
+  EXPECT_CALL(E, enqueue(_, _)).Times(0);
+
+  MockScheduler::enqueueUsersUnlocked(&A);
+  EXPECT_TRUE(B.isSuccessfullyEnqueued());
+  EXPECT_TRUE(C.isSuccessfullyEnqueued());
+  EXPECT_FALSE(E.isSuccessfullyEnqueued());
+}
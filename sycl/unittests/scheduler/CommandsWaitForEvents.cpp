@@ -10,6 +10,9 @@
 #include "SchedulerTestUtils.hpp"
 #include <helpers/PiMock.hpp>
 
+#include <algorithm>
+#include <vector>
+
 using namespace cl::sycl;
 
 struct TestCtx {
@@ -110,3 +113,48 @@ TEST_F(SchedulerTest, CommandsWaitForEvents) {
               TestContext->EventCtx2WasWaited)
       << "Not all events were waited for";
 }
+
+static std::vector<pi_uint32> BatchSizes;
+
+pi_result batchedWaitFunc(pi_uint32 N, const pi_event *List) {
+  BatchSizes.push_back(N);
+  return PI_SUCCESS;
+}
+
+TEST_F(SchedulerTest, EventsWaitBatchedPerContext) {
+  default_selector Selector{};
+  if (Selector.select_device().is_host()) {
+    std::cerr << "Not run due to host-only environment\n";
+    return;
+  }
+
+  platform Plt{Selector};
+  unittest::PiMock Mock{Plt};
+
+  Mock.redefine<detail::PiApiKind::piEventsWait>(batchedWaitFunc);
+  Mock.redefine<detail::PiApiKind::piEventRetain>(retainReleaseFunc);
+  Mock.redefine<detail::PiApiKind::piEventRelease>(retainReleaseFunc);
+  Mock.redefine<detail::PiApiKind::piEventGetInfo>(getEventInfoFunc);
+
+  context Ctx1{Plt};
+  queue Q1{Ctx1, Selector};
+  context Ctx2{Plt};
+  queue Q2{Ctx2, Selector};
+
+  TestContext.reset(new TestCtx(Q1, Q2));
+
+  std::vector<std::shared_ptr<detail::event_impl>> Events;
+  Events.emplace_back(
+      new detail::event_impl(TestContext->EventCtx1, Q1.get_context()));
+  Events.emplace_back(
+      new detail::event_impl(TestContext->EventCtx2, Q2.get_context()));
+  Events.emplace_back(
+      new detail::event_impl(TestContext->EventCtx1, Q1.get_context()));
+
+  BatchSizes.clear();
+  detail::event_impl::waitAll(Events);
+
+  std::sort(BatchSizes.begin(), BatchSizes.end());
+  ASSERT_EQ(BatchSizes, (std::vector<pi_uint32>{1, 2}))
+      << "Events should be waited for by one call per context";
+}
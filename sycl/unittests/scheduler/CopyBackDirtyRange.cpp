@@ -0,0 +1,55 @@
+//==------- CopyBackDirtyRange.cpp --- Scheduler unit tests ----------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "SchedulerTest.hpp"
+#include "SchedulerTestUtils.hpp"
+
+using namespace cl::sycl;
+
+static detail::Requirement getCopyBackRequirement(detail::SYCLMemObjI *MemObj,
+                                                  void *Ptr) {
+  const size_t Size = MemObj->getSize();
+  detail::Requirement Req(/*Offset*/ {0, 0, 0}, /*AccessRange*/ {Size, 1, 1},
+                          /*MemoryRange*/ {Size, 1, 1}, access::mode::read,
+                          MemObj, /*Dims*/ 1, /*ElemSize*/ 1);
+  Req.MData = Ptr;
+  return Req;
+}
+
+TEST_F(SchedulerTest, CopyBackDirtyRange) {
+  queue HostQueue{host_selector()};
+  detail::QueueImplPtr QImpl = detail::getSyclObjImpl(HostQueue);
+
+  MockScheduler MS;
+  int Data[4][8] = {};
+  buffer<int, 2> Buf(&Data[0][0], range<2>(4, 8));
+  detail::SYCLMemObjI *MemObj = detail::getSyclObjImpl(Buf).get();
+
+  // Elements [1][2] to [2][5] are written, the copy back is limited to the
+  // bytes from the first to the last of them.
+  detail::Requirement WriteReq(
+      /*Offset*/ {1, 2, 0}, /*AccessRange*/ {2, 4, 1},
+      /*MemoryRange*/ {4, 8, 1}, access::mode::write, MemObj, /*Dims*/ 2,
+      /*ElemSize*/ sizeof(int));
+  detail::MemObjRecord *Record = MS.getOrInsertMemObjRecord(QImpl, &WriteReq);
+  MS.getOrCreateAllocaForReq(Record, &WriteReq, QImpl);
+  MS.markModifiedIfWrite(Record, &WriteReq, QImpl->getContextImplPtr());
+
+  detail::Requirement DirtyReq = getCopyBackRequirement(MemObj, &Data[0][0]);
+  ASSERT_NE(MS.addCopyBack(&DirtyReq, /*DirtyOnly*/ true), nullptr);
+  EXPECT_EQ(DirtyReq.MOffset[0], (1 * 8 + 2) * sizeof(int));
+  EXPECT_EQ(DirtyReq.MAccessRange[0], 12 * sizeof(int));
+
+  // The copy to the other memory is complete.
+  int FinalData[4][8] = {};
+  detail::Requirement FullReq =
+      getCopyBackRequirement(MemObj, &FinalData[0][0]);
+  ASSERT_NE(MS.addCopyBack(&FullReq, /*DirtyOnly*/ false), nullptr);
+  EXPECT_EQ(FullReq.MOffset[0], 0u);
+  EXPECT_EQ(FullReq.MAccessRange[0], sizeof(FinalData));
+}
@@ -0,0 +1,73 @@
+//==------------ GraphIndependentCG.cpp ---- Scheduler unit tests ----------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "SchedulerTest.hpp"
+#include "SchedulerTestUtils.hpp"
+
+#include <iostream>
+
+using namespace cl::sycl;
+
+static std::unique_ptr<detail::CG>
+createCG(detail::CG::CGTYPE Type,
+         std::vector<detail::Requirement *> Requirements = {}) {
+  return std::unique_ptr<detail::CG>(new detail::CGBarrier(
+      /*EventsWaitWithBarrier=*/{}, /*ArgsStorage=*/{}, /*AccStorage=*/{},
+      /*SharedPtrStorage=*/{}, std::move(Requirements), /*Events=*/{}, Type));
+}
+
+TEST_F(SchedulerTest, GraphIndependentCG) {
+  queue HQueue(host_selector{});
+  detail::QueueImplPtr HQueueImpl = detail::getSyclObjImpl(HQueue);
+  MockScheduler MS;
+
+  EXPECT_TRUE(MS.isGraphIndependent(*createCG(detail::CG::BARRIER), HQueueImpl))
+      << "Command group without requirements is independent";
+
+  buffer<int, 1> Buf(range<1>(1));
+  detail::Requirement Req = getMockRequirement(Buf);
+  EXPECT_FALSE(
+      MS.isGraphIndependent(*createCG(detail::CG::BARRIER, {&Req}), HQueueImpl))
+      << "Command group with requirements depends on the graph";
+
+  EXPECT_FALSE(MS.isGraphIndependent(*createCG(detail::CG::CODEPLAY_HOST_TASK),
+                                     HQueueImpl))
+      << "Host task gets an empty command linked to it";
+  EXPECT_FALSE(
+      MS.isGraphIndependent(*createCG(detail::CG::UPDATE_HOST), HQueueImpl))
+      << "Update host command group depends on the graph";
+}
+
+TEST_F(SchedulerTest, BypassGraph) {
+  queue HQueue(host_selector{});
+  detail::QueueImplPtr HQueueImpl = detail::getSyclObjImpl(HQueue);
+  EXPECT_FALSE(MockScheduler::canBypassGraph(*createCG(detail::CG::COPY_USM),
+                                             HQueueImpl))
+      << "Host queue command groups are executed by the graph";
+
+  platform Plt{default_selector()};
+  if (Plt.is_host()) {
+    std::cout << "Not run due to host-only environment\n";
+    return;
+  }
+
+  queue Q;
+  detail::QueueImplPtr QueueImpl = detail::getSyclObjImpl(Q);
+  EXPECT_TRUE(MockScheduler::canBypassGraph(*createCG(detail::CG::COPY_USM),
+                                            QueueImpl))
+      << "USM command group without dependencies bypasses the graph";
+  EXPECT_FALSE(
+      MockScheduler::canBypassGraph(*createCG(detail::CG::BARRIER), QueueImpl))
+      << "Barrier is enqueued by the graph";
+
+  buffer<int, 1> Buf(range<1>(1));
+  detail::Requirement Req = getMockRequirement(Buf);
+  EXPECT_FALSE(MockScheduler::canBypassGraph(
+      *createCG(detail::CG::FILL_USM, {&Req}), QueueImpl))
+      << "Command group with requirements depends on the graph";
+}
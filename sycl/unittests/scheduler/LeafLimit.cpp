@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <iostream>
 #include <memory>
 #include <vector>
 
@@ -67,3 +68,59 @@ TEST_F(SchedulerTest, LeafLimit) {
       NewestLeaf->MDeps.begin(), NewestLeaf->MDeps.end(),
       [&](const detail::DepDesc &DD) { return DD.MDepCommand == OldestLeaf; }));
 }
+
+// Checks that the read leaves evicted when the leaf limit is overflowed join
+// a read group instead of becoming dependencies of the newest leaf.
+TEST_F(SchedulerTest, ReadLeafLimit) {
+  queue Q;
+  if (Q.is_host()) {
+    std::cout << "Not run due to host-only environment\n";
+    return;
+  }
+  detail::QueueImplPtr QImpl = detail::getSyclObjImpl(Q);
+
+  MockScheduler MS;
+  std::vector<std::unique_ptr<MockCommand>> LeavesToAdd;
+
+  buffer<int, 1> Buf(range<1>(1));
+  detail::Requirement MockReq = getMockRequirement(Buf);
+  MockReq.MAccessMode = access::mode::read;
+
+  std::unique_ptr<MockCommand> MockDepCmd =
+      std::make_unique<MockCommand>(QImpl, MockReq);
+  detail::MemObjRecord *Rec = MS.getOrInsertMemObjRecord(QImpl, &MockReq);
+
+  for (std::size_t i = 0; i < Rec->MReadLeaves.genericCommandsCapacity() + 1;
+       ++i)
+    LeavesToAdd.push_back(std::make_unique<MockCommand>(QImpl, MockReq));
+  for (auto &Leaf : LeavesToAdd) {
+    MockDepCmd->addUser(Leaf.get());
+    Leaf->addDep(
+        detail::DepDesc{MockDepCmd.get(), Leaf->getRequirement(), nullptr});
+  }
+  for (auto &LeafPtr : LeavesToAdd)
+    MS.addNodeToLeaves(Rec, LeafPtr.get(), access::mode::read);
+
+  const detail::CircularBuffer<detail::Command *> &Leaves =
+      Rec->MReadLeaves.getGenericCommands();
+  auto GroupIt = std::find_if(Leaves.begin(), Leaves.end(),
+                              [](const detail::Command *Cmd) {
+                                return Cmd->getType() ==
+                                       detail::Command::EMPTY_TASK;
+                              });
+  ASSERT_NE(GroupIt, Leaves.end());
+  std::unique_ptr<detail::Command> Group{*GroupIt};
+
+  // The two oldest leaves are in the group, the newest one only depends on
+  // its own dependency.
+  for (std::size_t i = 0; i < 2; ++i) {
+    MockCommand *Evicted = LeavesToAdd[i].get();
+    EXPECT_TRUE(std::find(Leaves.begin(), Leaves.end(), Evicted) ==
+                Leaves.end());
+    EXPECT_EQ(Evicted->MUsers.count(Group.get()), 1U);
+    EXPECT_EQ(Evicted->MLeafCounter, 0U);
+  }
+  EXPECT_EQ(Group->MDeps.size(), 2U);
+  EXPECT_EQ(LeavesToAdd.back()->MDeps.size(), 1U);
+  Rec->MReadLeaves.remove(Group.get());
+}
@@ -78,7 +78,7 @@ TEST_F(SchedulerTest, LinkedAllocaDependencies) {
   Req.MSYCLMemObj = &MemObj;
 
   cl::sycl::detail::AllocaCommand AllocaCmd1(DefaultHostQueue, Req, false);
-  Record->MAllocaCommands.push_back(&AllocaCmd1);
+  Record->addAllocaCommand(&AllocaCmd1);
 
   MockCommand DepCmd(DefaultHostQueue, Req);
   MockCommand DepDepCmd(DefaultHostQueue, Req);
@@ -25,7 +25,7 @@ TEST_F(SchedulerTest, MemObjCommandCleanup) {
       new detail::AllocaCommand(detail::getSyclObjImpl(MQueue), MockReqA);
   std::unique_ptr<detail::AllocaCommand> MockAllocaB{
       new detail::AllocaCommand(detail::getSyclObjImpl(MQueue), MockReqB)};
-  RecA->MAllocaCommands.push_back(MockAllocaA);
+  RecA->addAllocaCommand(MockAllocaA);
 
   // Create a direct user of both allocas
   std::unique_ptr<MockCommand> MockDirectUser{
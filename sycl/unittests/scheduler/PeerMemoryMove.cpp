@@ -0,0 +1,123 @@
+//==------------ PeerMemoryMove.cpp --- Scheduler unit tests ---------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "SchedulerTest.hpp"
+#include "SchedulerTestUtils.hpp"
+
+#include <helpers/PiMock.hpp>
+
+#include <iostream>
+#include <memory>
+
+using namespace cl::sycl;
+
+static int NumPeerCopies = 0;
+static size_t PeerCopySize = 0;
+static int NumHostTransfers = 0;
+
+static pi_result redefinedMemBufferCreate(pi_context, pi_mem_flags, size_t,
+                                          void *, pi_mem *RetMem,
+                                          const pi_mem_properties *) {
+  *RetMem = nullptr;
+  return PI_SUCCESS;
+}
+
+static pi_result redefinedMemRelease(pi_mem) { return PI_SUCCESS; }
+
+static pi_result redefinedEnqueueMemBufferCopyPeer(
+    pi_queue, pi_mem, size_t, pi_queue, pi_mem, size_t, size_t Size, pi_uint32,
+    const pi_event *, pi_event *Event) {
+  ++NumPeerCopies;
+  PeerCopySize = Size;
+  *Event = nullptr;
+  return PI_SUCCESS;
+}
+
+static pi_result redefinedEnqueueMemBufferRead(pi_queue, pi_mem, pi_bool,
+                                               size_t, size_t, void *,
+                                               pi_uint32, const pi_event *,
+                                               pi_event *Event) {
+  ++NumHostTransfers;
+  *Event = nullptr;
+  return PI_SUCCESS;
+}
+
+static pi_result redefinedEnqueueMemBufferWrite(pi_queue, pi_mem, pi_bool,
+                                                size_t, size_t, const void *,
+                                                pi_uint32, const pi_event *,
+                                                pi_event *Event) {
+  ++NumHostTransfers;
+  *Event = nullptr;
+  return PI_SUCCESS;
+}
+
+TEST_F(SchedulerTest, PeerMemoryMove) {
+  platform Plt{default_selector()};
+  if (Plt.is_host()) {
+    std::cout << "Not run due to host-only environment\n";
+    return;
+  }
+
+  queue Q;
+  unittest::PiMock Mock{Q};
+  Mock.redefine<detail::PiApiKind::piMemBufferCreate>(redefinedMemBufferCreate);
+  Mock.redefine<detail::PiApiKind::piMemRelease>(redefinedMemRelease);
+  Mock.redefine<detail::PiApiKind::piextEnqueueMemBufferCopyPeer>(
+      redefinedEnqueueMemBufferCopyPeer);
+  Mock.redefine<detail::PiApiKind::piEnqueueMemBufferRead>(
+      redefinedEnqueueMemBufferRead);
+  Mock.redefine<detail::PiApiKind::piEnqueueMemBufferWrite>(
+      redefinedEnqueueMemBufferWrite);
+
+  device Dev = Q.get_device();
+  context SrcCtx{Dev};
+  context DstCtx{Dev};
+  queue SrcQueue{SrcCtx, Dev};
+  queue DstQueue{DstCtx, Dev};
+  detail::QueueImplPtr SrcQueueImpl = detail::getSyclObjImpl(SrcQueue);
+  detail::QueueImplPtr DstQueueImpl = detail::getSyclObjImpl(DstQueue);
+
+  MockScheduler MS;
+  buffer<int, 1> Buf(range<1>(4));
+  detail::Requirement Req(/*Offset*/ {0, 0, 0}, /*AccessRange*/ {4, 1, 1},
+                          /*MemoryRange*/ {4, 1, 1}, access::mode::read_write,
+                          detail::getSyclObjImpl(Buf).get(), /*Dims*/ 1,
+                          /*ElemSize*/ sizeof(int));
+
+  detail::MemObjRecord *Record =
+      MS.getOrInsertMemObjRecord(SrcQueueImpl, &Req);
+  MS.getOrCreateAllocaForReq(Record, &Req, SrcQueueImpl);
+
+  // The memory is moved to the other context with a single copy.
+  std::unique_ptr<detail::CG> CG{new detail::CGBarrier(
+      /*EventsWaitWithBarrier=*/{}, /*ArgsStorage=*/{}, /*AccStorage=*/{},
+      /*SharedPtrStorage=*/{}, /*Requirements=*/{&Req}, /*Events=*/{},
+      detail::CG::BARRIER)};
+  detail::Command *BarrierCmd = MS.addCG(std::move(CG), DstQueueImpl);
+  ASSERT_NE(BarrierCmd, nullptr);
+
+  for (detail::AllocaCommandBase *AllocaCmd : Record->MAllocaCommands)
+    EXPECT_FALSE(AllocaCmd->getQueue()->is_host())
+        << "The memory is not moved through the host";
+
+  detail::Command *MemoryMove = nullptr;
+  for (const detail::DepDesc &Dep : BarrierCmd->MDeps)
+    if (Dep.MDepCommand &&
+        Dep.MDepCommand->getType() == detail::Command::COPY_MEMORY)
+      MemoryMove = Dep.MDepCommand;
+  ASSERT_NE(MemoryMove, nullptr);
+  EXPECT_EQ(MemoryMove->getContext(), SrcQueueImpl->getContextImplPtr());
+
+  NumPeerCopies = 0;
+  NumHostTransfers = 0;
+  detail::EnqueueResultT Res;
+  MockScheduler::enqueueCommand(MemoryMove, Res, detail::BLOCKING);
+  EXPECT_EQ(NumPeerCopies, 1);
+  EXPECT_EQ(PeerCopySize, 4 * sizeof(int));
+  EXPECT_EQ(NumHostTransfers, 0);
+}
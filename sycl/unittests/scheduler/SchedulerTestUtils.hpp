@@ -117,6 +117,10 @@ public:
     return GraphProcessor::enqueueCommand(Cmd, EnqueueResult, Blocking);
   }
 
+  static void enqueueUsersUnlocked(cl::sycl::detail::Command *CompletedCmd) {
+    Scheduler::enqueueUsersUnlocked(CompletedCmd);
+  }
+
   cl::sycl::detail::AllocaCommandBase *
   getOrCreateAllocaForReq(cl::sycl::detail::MemObjRecord *Record,
                           const cl::sycl::detail::Requirement *Req,
@@ -131,11 +135,32 @@ public:
     return MGraphBuilder.insertMemoryMove(Record, Req, Queue);
   }
 
+  void markModifiedIfWrite(cl::sycl::detail::MemObjRecord *Record,
+                           cl::sycl::detail::Requirement *Req,
+                           const cl::sycl::detail::ContextImplPtr &Context) {
+    MGraphBuilder.markModifiedIfWrite(Record, Req, Context);
+  }
+
+  cl::sycl::detail::Command *addCopyBack(cl::sycl::detail::Requirement *Req,
+                                         bool DirtyOnly) {
+    return MGraphBuilder.addCopyBack(Req, DirtyOnly);
+  }
+
   cl::sycl::detail::Command *
   addCG(std::unique_ptr<cl::sycl::detail::CG> CommandGroup,
         cl::sycl::detail::QueueImplPtr Queue) {
     return MGraphBuilder.addCG(std::move(CommandGroup), Queue);
   }
+
+  bool isGraphIndependent(const cl::sycl::detail::CG &CommandGroup,
+                          const cl::sycl::detail::QueueImplPtr &Queue) {
+    return MGraphBuilder.isGraphIndependent(CommandGroup, Queue);
+  }
+
+  static bool canBypassGraph(const cl::sycl::detail::CG &CommandGroup,
+                             const cl::sycl::detail::QueueImplPtr &Queue) {
+    return cl::sycl::detail::Scheduler::canBypassGraph(CommandGroup, Queue);
+  }
 };
 
 void addEdge(cl::sycl::detail::Command *User, cl::sycl::detail::Command *Dep,
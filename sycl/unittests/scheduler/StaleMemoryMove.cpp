@@ -0,0 +1,112 @@
+//==------------ StaleMemoryMove.cpp --- Scheduler unit tests --------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "SchedulerTest.hpp"
+#include "SchedulerTestUtils.hpp"
+
+#include <helpers/PiMock.hpp>
+
+#include <iostream>
+#include <memory>
+
+using namespace cl::sycl;
+
+static size_t PeerCopyOffset = 0;
+static size_t PeerCopySize = 0;
+
+static pi_result redefinedMemBufferCreate(pi_context, pi_mem_flags, size_t,
+                                          void *, pi_mem *RetMem,
+                                          const pi_mem_properties *) {
+  *RetMem = nullptr;
+  return PI_SUCCESS;
+}
+
+static pi_result redefinedMemRelease(pi_mem) { return PI_SUCCESS; }
+
+static pi_result redefinedEnqueueMemBufferCopyPeer(
+    pi_queue, pi_mem, size_t SrcOffset, pi_queue, pi_mem, size_t, size_t Size,
+    pi_uint32, const pi_event *, pi_event *Event) {
+  PeerCopyOffset = SrcOffset;
+  PeerCopySize = Size;
+  *Event = nullptr;
+  return PI_SUCCESS;
+}
+
+static detail::Command *findMemoryMove(detail::Command *Cmd) {
+  for (const detail::DepDesc &Dep : Cmd->MDeps)
+    if (Dep.MDepCommand &&
+        Dep.MDepCommand->getType() == detail::Command::COPY_MEMORY)
+      return Dep.MDepCommand;
+  return nullptr;
+}
+
+static detail::Command *addBarrier(MockScheduler &MS, detail::Requirement *Req,
+                                   const detail::QueueImplPtr &Queue) {
+  std::unique_ptr<detail::CG> CG{new detail::CGBarrier(
+      /*EventsWaitWithBarrier=*/{}, /*ArgsStorage=*/{}, /*AccStorage=*/{},
+      /*SharedPtrStorage=*/{}, /*Requirements=*/{Req}, /*Events=*/{},
+      detail::CG::BARRIER)};
+  return MS.addCG(std::move(CG), Queue);
+}
+
+TEST_F(SchedulerTest, StaleMemoryMove) {
+  platform Plt{default_selector()};
+  if (Plt.is_host()) {
+    std::cout << "Not run due to host-only environment\n";
+    return;
+  }
+
+  queue Q;
+  unittest::PiMock Mock{Q};
+  Mock.redefine<detail::PiApiKind::piMemBufferCreate>(redefinedMemBufferCreate);
+  Mock.redefine<detail::PiApiKind::piMemRelease>(redefinedMemRelease);
+  Mock.redefine<detail::PiApiKind::piextEnqueueMemBufferCopyPeer>(
+      redefinedEnqueueMemBufferCopyPeer);
+
+  device Dev = Q.get_device();
+  context SrcCtx{Dev};
+  context DstCtx{Dev};
+  queue SrcQueue{SrcCtx, Dev};
+  queue DstQueue{DstCtx, Dev};
+  detail::QueueImplPtr SrcQueueImpl = detail::getSyclObjImpl(SrcQueue);
+  detail::QueueImplPtr DstQueueImpl = detail::getSyclObjImpl(DstQueue);
+
+  MockScheduler MS;
+  buffer<int, 1> Buf(range<1>(4));
+  detail::SYCLMemObjI *MemObj = detail::getSyclObjImpl(Buf).get();
+  detail::Requirement ReadReq(/*Offset*/ {0, 0, 0}, /*AccessRange*/ {4, 1, 1},
+                              /*MemoryRange*/ {4, 1, 1}, access::mode::read,
+                              MemObj, /*Dims*/ 1, /*ElemSize*/ sizeof(int));
+  detail::Requirement WriteReq(/*Offset*/ {2, 0, 0}, /*AccessRange*/ {1, 1, 1},
+                               /*MemoryRange*/ {4, 1, 1}, access::mode::write,
+                               MemObj, /*Dims*/ 1, /*ElemSize*/ sizeof(int));
+
+  detail::MemObjRecord *Record =
+      MS.getOrInsertMemObjRecord(SrcQueueImpl, &ReadReq);
+  MS.getOrCreateAllocaForReq(Record, &ReadReq, SrcQueueImpl);
+
+  // The new allocation of the other context is copied to as a whole.
+  detail::Command *MemoryMove =
+      findMemoryMove(addBarrier(MS, &ReadReq, DstQueueImpl));
+  ASSERT_NE(MemoryMove, nullptr);
+  detail::EnqueueResultT Res;
+  MockScheduler::enqueueCommand(MemoryMove, Res, detail::BLOCKING);
+  EXPECT_EQ(PeerCopySize, 4 * sizeof(int));
+
+  // Nothing was modified since the memory was moved, it is not moved back.
+  EXPECT_EQ(findMemoryMove(addBarrier(MS, &ReadReq, SrcQueueImpl)), nullptr);
+  EXPECT_EQ(Record->MCurContext, SrcQueueImpl->getContextImplPtr());
+
+  // Only the element written is copied.
+  addBarrier(MS, &WriteReq, SrcQueueImpl);
+  MemoryMove = findMemoryMove(addBarrier(MS, &ReadReq, DstQueueImpl));
+  ASSERT_NE(MemoryMove, nullptr);
+  MockScheduler::enqueueCommand(MemoryMove, Res, detail::BLOCKING);
+  EXPECT_EQ(PeerCopyOffset, 2 * sizeof(int));
+  EXPECT_EQ(PeerCopySize, sizeof(int));
+}
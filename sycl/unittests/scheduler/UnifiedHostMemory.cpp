@@ -0,0 +1,113 @@
+//==------------ UnifiedHostMemory.cpp --- Scheduler unit tests ------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "SchedulerTest.hpp"
+#include "SchedulerTestUtils.hpp"
+
+#include <helpers/PiMock.hpp>
+
+#include <iostream>
+#include <memory>
+
+using namespace cl::sycl;
+
+static pi_result redefinedDeviceGetInfo(pi_device Device,
+                                        pi_device_info ParamName,
+                                        size_t ParamValueSize, void *ParamValue,
+                                        size_t *ParamValueSizeRet) {
+  if (ParamName == PI_DEVICE_INFO_HOST_UNIFIED_MEMORY) {
+    auto *Result = reinterpret_cast<pi_bool *>(ParamValue);
+    *Result = true;
+  } else if (ParamName == PI_DEVICE_INFO_TYPE) {
+    auto *Result = reinterpret_cast<_pi_device_type *>(ParamValue);
+    *Result = PI_DEVICE_TYPE_GPU;
+  }
+  return PI_SUCCESS;
+}
+
+static RT::PiMemFlags ExpectedMemObjFlags;
+static int NumMemBufferCreateCalls = 0;
+
+static pi_result
+redefinedMemBufferCreate(pi_context context, pi_mem_flags flags, size_t size,
+                         void *host_ptr, pi_mem *ret_mem,
+                         const pi_mem_properties *properties = nullptr) {
+  ++NumMemBufferCreateCalls;
+  EXPECT_EQ(flags, ExpectedMemObjFlags);
+  *ret_mem = nullptr;
+  return PI_SUCCESS;
+}
+
+static pi_result redefinedMemRelease(pi_mem mem) { return PI_SUCCESS; }
+
+TEST_F(SchedulerTest, UnifiedHostMemory) {
+  platform Plt{default_selector()};
+  if (Plt.is_host()) {
+    std::cout << "Not run due to host-only environment\n";
+    return;
+  }
+
+  queue Q;
+  unittest::PiMock Mock{Q};
+  Mock.redefine<detail::PiApiKind::piDeviceGetInfo>(redefinedDeviceGetInfo);
+  Mock.redefine<detail::PiApiKind::piMemBufferCreate>(redefinedMemBufferCreate);
+  Mock.redefine<detail::PiApiKind::piMemRelease>(redefinedMemRelease);
+  cl::sycl::detail::QueueImplPtr QImpl = detail::getSyclObjImpl(Q);
+
+  device HostDevice;
+  std::shared_ptr<detail::queue_impl> DefaultHostQueue{
+      new detail::queue_impl(detail::getSyclObjImpl(HostDevice), {}, {})};
+
+  MockScheduler MS;
+  // Check non-host -> host alloca with the user pointer
+  {
+    int val;
+    buffer<int, 1> Buf(&val, range<1>(1));
+    detail::Requirement Req = getMockRequirement(Buf);
+
+    // The host pointer is used as the storage of the non-host allocation.
+    ExpectedMemObjFlags = PI_MEM_FLAGS_ACCESS_RW | PI_MEM_FLAGS_HOST_PTR_USE;
+
+    detail::MemObjRecord *Record = MS.getOrInsertMemObjRecord(QImpl, &Req);
+    detail::AllocaCommandBase *NonHostAllocaCmd =
+        MS.getOrCreateAllocaForReq(Record, &Req, QImpl);
+
+    detail::AllocaCommandBase *HostAllocaCmd =
+        MS.getOrCreateAllocaForReq(Record, &Req, DefaultHostQueue);
+    EXPECT_EQ(HostAllocaCmd->MLinkedAllocaCmd, NonHostAllocaCmd);
+    EXPECT_EQ(NonHostAllocaCmd->MLinkedAllocaCmd, HostAllocaCmd);
+
+    NumMemBufferCreateCalls = 0;
+    detail::EnqueueResultT Res;
+    MockScheduler::enqueueCommand(NonHostAllocaCmd, Res, detail::BLOCKING);
+    EXPECT_EQ(NumMemBufferCreateCalls, 1);
+
+    // The host accessor maps the non-host allocation instead of copying it.
+    detail::Command *MemoryMove =
+        MS.insertMemoryMove(Record, &Req, DefaultHostQueue);
+    EXPECT_EQ(MemoryMove->getType(), detail::Command::MAP_MEM_OBJ);
+  }
+  // Check non-host alloca without the user pointer
+  {
+    buffer<int, 1> Buf(range<1>(1));
+    detail::Requirement Req = getMockRequirement(Buf);
+
+    // The buffer is allocated in host accessible memory, so that it can be
+    // mapped to the host without copies.
+    ExpectedMemObjFlags = PI_MEM_FLAGS_ACCESS_RW | PI_MEM_FLAGS_HOST_PTR_ALLOC;
+
+    detail::MemObjRecord *Record = MS.getOrInsertMemObjRecord(QImpl, &Req);
+    detail::AllocaCommandBase *NonHostAllocaCmd =
+        MS.getOrCreateAllocaForReq(Record, &Req, QImpl);
+
+    NumMemBufferCreateCalls = 0;
+    detail::EnqueueResultT Res;
+    MockScheduler::enqueueCommand(NonHostAllocaCmd, Res, detail::BLOCKING);
+    EXPECT_EQ(NumMemBufferCreateCalls, 1);
+  }
+}
@@ -9,6 +9,9 @@
 #include "SchedulerTest.hpp"
 #include "SchedulerTestUtils.hpp"
 
+#include <chrono>
+#include <thread>
+
 using namespace cl::sycl;
 
 TEST_F(SchedulerTest, WaitAfterCleanup) {
@@ -26,3 +29,18 @@ TEST_F(SchedulerTest, WaitAfterCleanup) {
 
   detail::Scheduler::getInstance().waitForEvent(Event);
 }
+
+TEST_F(SchedulerTest, DeferredCleanup) {
+  MockScheduler MS;
+  auto Cmd = new MockCommand(detail::getSyclObjImpl(MQueue));
+  auto Event = Cmd->getEvent();
+  MS.waitForEvent(Event);
+
+  // The command is cleaned up by the worker of the scheduler
+  MS.deferCleanupFinishedCommands(Event);
+  auto Deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (Event->getCommand() && std::chrono::steady_clock::now() < Deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  ASSERT_EQ(Event->getCommand(), nullptr)
+      << "Command should have been cleaned up\n";
+}
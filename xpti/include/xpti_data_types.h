@@ -339,6 +339,17 @@ enum class trace_activity_type_t {
   sleep_activity = 1 << 3
 };
 
+/// Selects which of the operations instrumented on a stream are traced; see
+/// xptiSetSampling()
+enum class sampling_mode_t : uint8_t {
+  /// Every operation is traced
+  all = 0,
+  /// One operation out of every N is traced
+  every_nth = 1,
+  /// At most one operation is traced per time interval, given in nanoseconds
+  time_interval = 2
+};
+
 struct reserved_data_t {
   /// Has a reference to the associated payload field for an event
   payload_t *payload;
@@ -392,6 +403,19 @@ enum class result_t : int32_t {
   XPTI_RESULT_INVALIDARG = int32_t(0x80004006)
 };
 
+/// The execution times of a command offloaded to a device, in nanoseconds on
+/// the host clock that xptiQueryNotificationTime() uses. Runtimes that measure
+/// them send them as the user data of a metadata notification for the event
+/// of the command, once the command has completed.
+struct device_timestamps_t {
+  /// When the command was queued
+  uint64_t queued;
+  /// When the device started executing the command
+  uint64_t start;
+  /// When the device completed the command
+  uint64_t end;
+};
+
 // These defines are present to enable plugin developers
 // who want to subscribe to the streams from the framework
 //
@@ -451,6 +475,8 @@ constexpr uint16_t trace_edge_create =
     static_cast<uint16_t>(xpti::trace_point_type_t::edge_create);
 constexpr uint16_t trace_signal =
     static_cast<uint16_t>(xpti::trace_point_type_t::signal);
+constexpr uint16_t trace_metadata =
+    static_cast<uint16_t>(xpti::trace_point_type_t::metadata);
 
 constexpr uint16_t trace_graph_event =
     static_cast<uint16_t>(xpti::trace_event_type_t::graph);
@@ -382,6 +382,51 @@ xptiQueryMetadata(xpti::trace_event_data_t *e);
 /// @return bool that indicates whether it is enabled or not
 XPTI_EXPORT_API bool xptiTraceEnabled();
 
+/// @brief Returns whether a trace type has subscribers in a stream
+/// @details Returns true if tracing is enabled and a callback has been
+/// registered for trace_type in the stream; notifications of other trace types
+/// are not delivered to anyone. The check is a single load, so instrumentation
+/// can call it before building the payload and the event of a notification.
+/// The begin and end trace points of a pair, such as task_begin and task_end,
+/// are enabled together, and all user defined trace points are enabled as soon
+/// as one of them has a callback.
+///
+/// @param stream_id The stream the notification would be sent to
+/// @param trace_type The trace point type of the notification
+/// @return bool that indicates whether the notification would be delivered
+XPTI_EXPORT_API bool xptiCheckTraceEnabled(uint8_t stream_id,
+                                           uint16_t trace_type);
+
+/// @brief Sets the sampling policy of a stream
+/// @details With sampling, only some of the operations instrumented on a
+/// stream are traced, which keeps the cost of always-on tracing low. The
+/// instrumentation asks xptiSampleTrace() whether to trace an operation before
+/// it creates any event for it, and then sends all or none of the
+/// notifications of the operation. The policy of all streams can also be set
+/// with the XPTI_SAMPLE_EVERY=<N> or XPTI_SAMPLE_INTERVAL=<microseconds>
+/// environment variables.
+///
+/// @param stream_id The stream whose policy is being set
+/// @param mode Selects the operations that are traced
+/// @param value N for sampling_mode_t::every_nth, the interval in nanoseconds
+/// for sampling_mode_t::time_interval, ignored for sampling_mode_t::all
+/// @return The result code which can be one of:
+///            1. XPTI_RESULT_SUCCESS when the policy is set
+///            2. XPTI_RESULT_INVALIDARG when the value is zero or the mode is
+///               unknown
+XPTI_EXPORT_API xpti::result_t xptiSetSampling(uint8_t stream_id,
+                                               xpti::sampling_mode_t mode,
+                                               uint64_t value);
+
+/// @brief Decides whether an instrumented operation is traced
+/// @details Each call counts as one operation of the stream, which is traced
+/// if this function returns true, according to the policy set with
+/// xptiSetSampling(). Without a sampling policy, this always returns true.
+///
+/// @param stream_id The stream the notifications of the operation go to
+/// @return bool that indicates whether the operation should be traced
+XPTI_EXPORT_API bool xptiSampleTrace(uint8_t stream_id);
+
 /// @brief Resets internal state
 /// @details This method is currently ONLY used by the tests and is NOT
 /// recommended for use in the instrumentation of applications or runtimes.
@@ -394,6 +439,15 @@ XPTI_EXPORT_API void xptiReset();
 /// The proxy/stub library does not implement this function.
 XPTI_EXPORT_API void xptiForceSetTraceEnabled(bool yesOrNo);
 
+/// @brief Returns the time a notification was sent at
+/// @details When the framework delivers the notifications from a collector
+/// thread (XPTI_ASYNC_NOTIFICATIONS=1), callbacks run some time after the
+/// notification was sent. Within a callback, this function returns the time at
+/// which the notification being handled was sent; otherwise, it returns the
+/// current time. The proxy/stub library does not implement this function.
+/// @return The time in nanoseconds on a monotonic clock
+XPTI_EXPORT_API uint64_t xptiQueryNotificationTime();
+
 typedef xpti::result_t (*xpti_initialize_t)(const char *, uint32_t, uint32_t,
                                             const char *);
 typedef void (*xpti_finalize_t)(const char *);
@@ -421,4 +475,8 @@ typedef xpti::result_t (*xpti_add_metadata_t)(xpti::trace_event_data_t *,
                                               const char *, const char *);
 typedef xpti::metadata_t *(*xpti_query_metadata_t)(xpti::trace_event_data_t *);
 typedef bool (*xpti_trace_enabled_t)();
+typedef bool (*xpti_check_trace_enabled_t)(uint8_t, uint16_t);
+typedef xpti::result_t (*xpti_set_sampling_t)(uint8_t, xpti::sampling_mode_t,
+                                              uint64_t);
+typedef bool (*xpti_sample_trace_t)(uint8_t);
 }
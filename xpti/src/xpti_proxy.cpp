@@ -31,6 +31,9 @@ enum functions_t {
   XPTI_ADD_METADATA,
   XPTI_QUERY_METADATA,
   XPTI_TRACE_ENABLED,
+  XPTI_CHECK_TRACE_ENABLED,
+  XPTI_SET_SAMPLING,
+  XPTI_SAMPLE_TRACE,
 
   // All additional functions need to appear before
   // the XPTI_FW_API_COUNT enum
@@ -57,7 +60,10 @@ class ProxyLoader {
       {XPTI_NOTIFY_SUBSCRIBERS, "xptiNotifySubscribers"},
       {XPTI_ADD_METADATA, "xptiAddMetadata"},
       {XPTI_QUERY_METADATA, "xptiQueryMetadata"},
-      {XPTI_TRACE_ENABLED, "xptiTraceEnabled"}};
+      {XPTI_TRACE_ENABLED, "xptiTraceEnabled"},
+      {XPTI_CHECK_TRACE_ENABLED, "xptiCheckTraceEnabled"},
+      {XPTI_SET_SAMPLING, "xptiSetSampling"},
+      {XPTI_SAMPLE_TRACE, "xptiSampleTrace"}};
 
 public:
   typedef std::vector<xpti_plugin_function_t> dispatch_table_t;
@@ -305,6 +311,39 @@ XPTI_EXPORT_API bool xptiTraceEnabled() {
   return false;
 }
 
+XPTI_EXPORT_API bool xptiCheckTraceEnabled(uint8_t stream_id,
+                                           uint16_t trace_type) {
+  if (xpti::g_loader.noErrors()) {
+    auto f = xpti::g_loader.functionByIndex(XPTI_CHECK_TRACE_ENABLED);
+    if (f) {
+      return (*(xpti_check_trace_enabled_t)f)(stream_id, trace_type);
+    }
+  }
+  return false;
+}
+
+XPTI_EXPORT_API xpti::result_t xptiSetSampling(uint8_t stream_id,
+                                               xpti::sampling_mode_t mode,
+                                               uint64_t value) {
+  if (xpti::g_loader.noErrors()) {
+    auto f = xpti::g_loader.functionByIndex(XPTI_SET_SAMPLING);
+    if (f) {
+      return (*(xpti_set_sampling_t)f)(stream_id, mode, value);
+    }
+  }
+  return xpti::result_t::XPTI_RESULT_FAIL;
+}
+
+XPTI_EXPORT_API bool xptiSampleTrace(uint8_t stream_id) {
+  if (xpti::g_loader.noErrors()) {
+    auto f = xpti::g_loader.functionByIndex(XPTI_SAMPLE_TRACE);
+    if (f) {
+      return (*(xpti_sample_trace_t)f)(stream_id);
+    }
+  }
+  return false;
+}
+
 XPTI_EXPORT_API xpti::result_t xptiAddMetadata(xpti::trace_event_data_t *e,
                                                const char *key,
                                                const char *value) {
@@ -0,0 +1,157 @@
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace xpti {
+/// \brief An insert-only hash map of 64-bit keys to 64-bit values
+/// \details Lookups are lock-free: the map is a linearly probed open-addressing
+/// table whose slots are published by an atomic store of the key after the
+/// value, so a reader never sees a key without its value. Insertions are
+/// serialized with a mutex; the tables the framework keeps are written once
+/// per new string or payload and read on every notification, so contention
+/// is on the read side.
+///
+/// When the table gets half full, the entries are copied into a table twice as
+/// large, which is then published for the readers. The previous tables are
+/// kept alive until the map is cleared or destroyed, as readers may still be
+/// probing them; such a reader may miss a key inserted concurrently, just like
+/// a reader that looked the key up right before its insertion.
+class ConcurrentTable64 {
+public:
+  ConcurrentTable64(size_t Capacity = 1024) : MInitialCapacity(Capacity) {
+    reset();
+  }
+
+  ConcurrentTable64(const ConcurrentTable64 &) = delete;
+  ConcurrentTable64 &operator=(const ConcurrentTable64 &) = delete;
+
+  /// Looks the key up, returns true and its value through Value if present.
+  bool find(uint64_t Key, uint64_t &Value) const {
+    if (Key == EmptyKey) {
+      if (!MHasEmptyKey.load(std::memory_order_acquire))
+        return false;
+      Value = MEmptyKeyValue;
+      return true;
+    }
+    const table_t *Table = MTable.load(std::memory_order_acquire);
+    for (size_t I = hash(Key) & Table->Mask;; I = (I + 1) & Table->Mask) {
+      uint64_t SlotKey = Table->Slots[I].Key.load(std::memory_order_acquire);
+      if (SlotKey == Key) {
+        Value = Table->Slots[I].Value.load(std::memory_order_relaxed);
+        return true;
+      }
+      if (SlotKey == EmptyKey)
+        return false;
+    }
+  }
+
+  /// Inserts the key with the value if the key is not present yet. Returns
+  /// false, leaving the table unchanged, if the key is already present.
+  bool insert(uint64_t Key, uint64_t Value) {
+    std::lock_guard<std::mutex> Lock(MMutex);
+    uint64_t Existing;
+    if (find(Key, Existing))
+      return false;
+    if (Key == EmptyKey) {
+      MEmptyKeyValue = Value;
+      MHasEmptyKey.store(true, std::memory_order_release);
+    } else {
+      table_t *Table = MTable.load(std::memory_order_relaxed);
+      if (2 * (MSize + 1) > Table->Mask + 1)
+        Table = grow(*Table);
+      store(*Table, Key, Value);
+    }
+    ++MSize;
+    return true;
+  }
+
+  size_t size() const {
+    std::lock_guard<std::mutex> Lock(MMutex);
+    return MSize;
+  }
+
+  /// Removes all the entries. Must not be called concurrently with any other
+  /// operation on the table.
+  void clear() {
+    std::lock_guard<std::mutex> Lock(MMutex);
+    reset();
+  }
+
+private:
+  static constexpr uint64_t EmptyKey = 0;
+
+  struct slot_t {
+    std::atomic<uint64_t> Key;
+    std::atomic<uint64_t> Value;
+  };
+
+  struct table_t {
+    table_t(size_t Capacity)
+        : Mask(Capacity - 1), Slots(new slot_t[Capacity]()) {}
+    const size_t Mask;
+    std::unique_ptr<slot_t[]> Slots;
+  };
+
+  /// Mixes the key bits, as keys such as IDs are often sequential.
+  static size_t hash(uint64_t Key) {
+    Key ^= Key >> 33;
+    Key *= 0xff51afd7ed558ccdULL;
+    Key ^= Key >> 33;
+    Key *= 0xc4ceb9fe1a85ec53ULL;
+    Key ^= Key >> 33;
+    return static_cast<size_t>(Key);
+  }
+
+  static void store(table_t &Table, uint64_t Key, uint64_t Value) {
+    size_t I = hash(Key) & Table.Mask;
+    while (Table.Slots[I].Key.load(std::memory_order_relaxed) != EmptyKey)
+      I = (I + 1) & Table.Mask;
+    Table.Slots[I].Value.store(Value, std::memory_order_relaxed);
+    Table.Slots[I].Key.store(Key, std::memory_order_release);
+  }
+
+  table_t *grow(const table_t &Old) {
+    std::unique_ptr<table_t> New(new table_t(2 * (Old.Mask + 1)));
+    for (size_t I = 0; I <= Old.Mask; ++I) {
+      uint64_t Key = Old.Slots[I].Key.load(std::memory_order_relaxed);
+      if (Key != EmptyKey)
+        store(*New, Key, Old.Slots[I].Value.load(std::memory_order_relaxed));
+    }
+    MTables.push_back(std::move(New));
+    MTable.store(MTables.back().get(), std::memory_order_release);
+    return MTables.back().get();
+  }
+
+  void reset() {
+    size_t Capacity = 16;
+    while (Capacity < 2 * MInitialCapacity)
+      Capacity <<= 1;
+    MTables.clear();
+    MTables.emplace_back(new table_t(Capacity));
+    MTable.store(MTables.back().get(), std::memory_order_release);
+    MHasEmptyKey.store(false, std::memory_order_relaxed);
+    MSize = 0;
+  }
+
+  const size_t MInitialCapacity;
+  /// The table readers probe
+  std::atomic<table_t *> MTable;
+  /// The current table and the ones it replaced
+  std::vector<std::unique_ptr<table_t>> MTables;
+  /// The empty key marks free slots, so its value is kept aside
+  std::atomic<bool> MHasEmptyKey{false};
+  uint64_t MEmptyKeyValue = 0;
+  size_t MSize = 0;
+  mutable std::mutex MMutex;
+};
+} // namespace xpti
@@ -0,0 +1,87 @@
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace xpti {
+/// \brief A bounded lock-free single-producer single-consumer queue
+/// \details One thread pushes the elements and another one pops them; neither
+/// operation blocks or allocates memory. The capacity is rounded up to a power
+/// of two. The producer and consumer positions are kept on separate cache
+/// lines, along with the copy each side caches of the other side's position,
+/// so that the two threads touch each other's cache line only when the cached
+/// copy says the queue is full or empty.
+template <typename T> class SPSCRingBuffer {
+public:
+  SPSCRingBuffer(size_t Capacity = 1024)
+      : MMask(roundUpToPowerOf2(Capacity) - 1), MSlots(new T[MMask + 1]) {}
+
+  SPSCRingBuffer(const SPSCRingBuffer &) = delete;
+  SPSCRingBuffer &operator=(const SPSCRingBuffer &) = delete;
+
+  size_t capacity() const { return MMask + 1; }
+
+  /// Appends a copy of the value to the queue, returns false if the queue is
+  /// full. Must only be called by the producer thread.
+  bool push(const T &Value) {
+    size_t Tail = MTail.load(std::memory_order_relaxed);
+    if (Tail - MCachedHead > MMask) {
+      MCachedHead = MHead.load(std::memory_order_acquire);
+      if (Tail - MCachedHead > MMask)
+        return false;
+    }
+    MSlots[Tail & MMask] = Value;
+    MTail.store(Tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Moves the oldest value of the queue to Value, returns false if the queue
+  /// is empty. Must only be called by the consumer thread.
+  bool pop(T &Value) {
+    size_t Head = MHead.load(std::memory_order_relaxed);
+    if (Head == MCachedTail) {
+      MCachedTail = MTail.load(std::memory_order_acquire);
+      if (Head == MCachedTail)
+        return false;
+    }
+    Value = MSlots[Head & MMask];
+    MHead.store(Head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Returns the number of values pushed since the queue was created.
+  size_t pushed() const { return MTail.load(std::memory_order_acquire); }
+  /// Returns the number of values popped since the queue was created.
+  size_t popped() const { return MHead.load(std::memory_order_acquire); }
+
+  bool empty() const { return pushed() == popped(); }
+
+private:
+  static constexpr size_t CacheLineSize = 64;
+
+  static size_t roundUpToPowerOf2(size_t Value) {
+    size_t Result = 1;
+    while (Result < Value)
+      Result <<= 1;
+    return Result;
+  }
+
+  const size_t MMask;
+  std::unique_ptr<T[]> MSlots;
+  char MPad0[CacheLineSize];
+  /// Consumer position and the consumer's copy of the producer position
+  std::atomic<size_t> MHead{0};
+  size_t MCachedTail = 0;
+  char MPad1[CacheLineSize - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+  /// Producer position and the producer's copy of the consumer position
+  std::atomic<size_t> MTail{0};
+  size_t MCachedHead = 0;
+  char MPad2[CacheLineSize - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+};
+} // namespace xpti
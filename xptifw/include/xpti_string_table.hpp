@@ -4,51 +4,54 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 //
 #pragma once
+#include "xpti_concurrent_table.hpp"
 #include "xpti_data_types.h"
 
 #include <atomic>
+#include <cstring>
+#include <memory>
 #include <mutex>
-#include <unordered_map>
+#include <string>
+#include <utility>
+#include <vector>
 
 #ifdef XPTI_STATISTICS
 #include <cstdio>
 #endif
 
-#ifdef XPTI_USE_TBB
-
-#include <tbb/concurrent_hash_map.h>
-#include <tbb/spin_mutex.h>
-
-#pragma message("Using TBB concurrent containers...")
 namespace xpti {
 /// \brief A string table class to support the payload handling
 /// \details With each payload, a kernel/function name and the source file name
 /// may be passed and we need to ensure that the incoming strings are copied and
 /// represented in a string table as the incoming strings are guaranteed to be
 /// valid only for the duration of the call that handles the payload. This
-/// implementation used Threading Building Blocks concurrent containers.
+/// implementation uses insert-only open-addressing tables, so looking up a
+/// string that is already in the table, in either direction, takes no lock
+/// and allocates no memory; only the insertion of new strings is serialized.
 class StringTable {
 public:
-  using st_forward_t = tbb::concurrent_hash_map<std::string, int32_t>;
-  using st_reverse_t = tbb::concurrent_hash_map<int32_t, const char *>;
+  /// A snapshot of the string table contents as string ID and string pairs.
+  using st_reverse_t = std::vector<std::pair<int32_t, const char *>>;
 
-  StringTable(int size = 4096)
-      : MStringToID(size), MIDToString(size), MTableSize(size) {
+  StringTable(int size = 4096) : MStringToID(size), MIDToString(size) {
     MIds = 1;
+    MStrings = 0;
 #ifdef XPTI_STATISTICS
     MInsertions = 0;
     MRetrievals = 0;
 #endif
   }
 
-  //  Clear all the contents of this string table and get it ready for re-use
+  //  Clear all the contents of this string table and get it ready for re-use.
+  //  Must not be called concurrently with any other operation on the table.
   void clear() {
+    std::lock_guard<std::mutex> Lock(MMutex);
     MIds = {1};
-    MIDToString.clear();
+    MStrings = {0};
     MStringToID.clear();
+    MIDToString.clear();
+    MEntries.clear();
 
-    MIDToString.rehash(MTableSize);
-    MStringToID.rehash(MTableSize);
 #ifdef XPTI_STATISTICS
     MInsertions = 0;
     MRetrievals = 0;
@@ -65,100 +68,36 @@ public:
   xpti::string_id_t add(const char *str, const char **ref_str = nullptr) {
     if (!str)
       return xpti::invalid_id;
-
-    std::string LocalStr = str;
-    return add(LocalStr, ref_str);
+    return add(str, std::strlen(str), ref_str);
   }
 
-  xpti::string_id_t add(std::string str, const char **ref_str = nullptr) {
-    if (str.empty())
-      return xpti::invalid_id;
-
-    // Try to see if the string is already present in the string table
-    st_forward_t::const_accessor e;
-    if (MStringToID.find(e, str)) {
-#ifdef XPTI_STATISTICS
-      MRetrievals++;
-#endif
-      if (ref_str)
-        *ref_str = e->first.c_str();
-
-      // We found it, so we return the string ID
-      return e->second;
-    } else {
-      // Multiple threads could fall through here Release the reader lock held
-      e.release();
-      string_id_t id;
-      {
-        // Employ a double-check pattern here
-        tbb::spin_mutex::scoped_lock dc(MMutex);
-        st_forward_t::accessor f;
-        if (MStringToID.insert(f, str)) {
-          // If the string does not exist, then insert() returns true. Here we
-          // create an ID for it
-          id = MIds++;
-          f->second = id;
-#ifdef XPTI_STATISTICS
-          MInsertions++;
-#endif
-          //  When we insert a new entry into the table, we also need to build
-          //  the reverse lookup;
-          {
-            st_reverse_t::accessor r;
-            if (MIDToString.insert(r, id)) {
-              //  An entry does not exist, so we will add it to the reverse
-              //  lookup.
-              r->second = f->first.c_str();
-              // Cache the saved string address and send it to the caller
-              if (ref_str)
-                *ref_str = r->second;
-              f.release();
-              r.release();
-              MStrings++;
-              return id;
-            } else {
-              // We cannot have a case where a string is not present in the
-              // forward lookup and present in the reverse lookup
-              MStringToID.erase(f);
-              if (ref_str)
-                *ref_str = nullptr;
-
-              return xpti::invalid_id;
-            }
-          }
-
-        } else {
-          // The string has already been added, so we return the stored ID
-          id = f->second;
-#ifdef XPTI_STATISTICS
-          MRetrievals++;
-#endif
-          if (ref_str)
-            *ref_str = f->first.c_str();
-          return id;
-        }
-        // Both the accessor and MMutex will be released here!
-      }
-    }
-    return xpti::invalid_id;
+  xpti::string_id_t add(const std::string &str,
+                        const char **ref_str = nullptr) {
+    return add(str.data(), str.size(), ref_str);
   }
 
   //  The reverse query allows one to get the string from the string_id_t that
   //  may have been cached somewhere.
   const char *query(xpti::string_id_t id) {
-    st_reverse_t::const_accessor e;
-    if (MIDToString.find(e, id)) {
+    uint64_t Entry;
+    if (!MIDToString.find(static_cast<uint64_t>(id), Entry))
+      return nullptr;
 #ifdef XPTI_STATISTICS
-      MRetrievals++;
+    MRetrievals++;
 #endif
-      return e->second;
-    } else
-      return nullptr;
+    return reinterpret_cast<const entry_t *>(Entry)->Str.c_str();
   }
 
   int32_t count() { return (int32_t)MStrings; }
 
-  const st_reverse_t &table() { return MIDToString; }
+  st_reverse_t table() {
+    std::lock_guard<std::mutex> Lock(MMutex);
+    st_reverse_t Table;
+    Table.reserve(MEntries.size());
+    for (const auto &Entry : MEntries)
+      Table.emplace_back(Entry->ID, Entry->Str.c_str());
+    return Table;
+  }
 
   void printStatistics() {
 #ifdef XPTI_STATISTICS
@@ -168,176 +107,96 @@ public:
   }
 
 private:
-  safe_int32_t MIds;        ///< Thread-safe ID generator
-  st_forward_t MStringToID; ///< Forward lookup hash map
-  st_reverse_t MIDToString; ///< Reverse lookup hash map
-  int32_t MTableSize;       ///< Initial table size of the hash-map
-  tbb::spin_mutex MMutex;   ///< Mutex required for double-check pattern
-  safe_int32_t MStrings;    ///< The count of strings in the table
-#ifdef XPTI_STATISTICS
-  safe_uint64_t MInsertions, ///< Thread-safe tracking of insertions
-      MRetrievals;           ///< Thread-safe tracking of lookups
-#endif
-};
-} // namespace xpti
-#else // Non-TBB implementation follows
-
-namespace xpti {
-/// \brief A string table class to support the payload handling
-/// \details With each payload, a kernel/function name and the source file name
-/// may be passed and we need to ensure that the incoming strings are copied and
-/// represented in a string table as the incoming strings are guaranteed to be
-/// valid only for the duration of the call that handles the payload. This
-/// implementation used STL containers protected with std::mutex.
-class StringTable {
-public:
-  using st_forward_t = std::unordered_map<std::string, int32_t>;
-  using st_reverse_t = std::unordered_map<int32_t, const char *>;
-
-  StringTable(int size = 4096)
-      : MStringToID(size), MIDToString(size), MTableSize(size) {
-    MIds = 1;
-#ifdef XPTI_STATISTICS
-    MInsertions = 0;
-    MRetrievals = 0;
-#endif
-  }
-
-  //  Clear all the contents of this string table and get it ready for re-use
-  void clear() {
-    MIds = {1};
-    MIDToString.clear();
-    MStringToID.clear();
-
-#ifdef XPTI_STATISTICS
-    MInsertions = 0;
-    MRetrievals = 0;
-#endif
+  struct entry_t {
+    entry_t(const char *Str, size_t Length, xpti::string_id_t ID)
+        : Str(Str, Length), ID(ID) {}
+    const std::string Str;
+    const xpti::string_id_t ID;
+    /// The next string with the same hash value
+    std::atomic<entry_t *> Next{nullptr};
+  };
+
+  /// FNV-1a hash of the string
+  static uint64_t hash(const char *Str, size_t Length) {
+    uint64_t Hash = 0xcbf29ce484222325ULL;
+    for (size_t I = 0; I < Length; ++I) {
+      Hash ^= static_cast<unsigned char>(Str[I]);
+      Hash *= 0x100000001b3ULL;
+    }
+    return Hash;
   }
 
-  // If the string being added to the string table is empty or invalid, then
-  // the returned string id = invalid_id;
-  //
-  // On success, the string will be inserted into two tables - one that maps
-  // string to string ID and another that maps from string ID to string. If a
-  // reference string pointer is made available, then the address of the string
-  // in the string table is returned through the default argument
-  xpti::string_id_t add(const char *str, const char **ref_str = nullptr) {
-    if (!str)
-      return xpti::invalid_id;
-
-    std::string LocalStr = str;
-    return add(LocalStr, ref_str);
+  /// Looks the string up among the ones with the given hash value. Returns the
+  /// string entry, or null and the last entry with the hash value, if any,
+  /// through Last.
+  const entry_t *find(uint64_t Hash, const char *Str, size_t Length,
+                      entry_t **Last = nullptr) {
+    uint64_t Head;
+    if (!MStringToID.find(Hash, Head))
+      return nullptr;
+    for (entry_t *Entry = reinterpret_cast<entry_t *>(Head); Entry;
+         Entry = Entry->Next.load(std::memory_order_acquire)) {
+      if (Entry->Str.size() == Length &&
+          std::memcmp(Entry->Str.data(), Str, Length) == 0)
+        return Entry;
+      if (Last)
+        *Last = Entry;
+    }
+    return nullptr;
   }
 
-  xpti::string_id_t add(std::string str, const char **ref_str = nullptr) {
-    if (str.empty())
+  xpti::string_id_t add(const char *Str, size_t Length, const char **RefStr) {
+    if (!Length)
       return xpti::invalid_id;
 
     // Try to see if the string is already present in the string table
-    auto Loc = MStringToID.find(str);
-    if (Loc != MStringToID.end()) {
-#ifdef XPTI_STATISTICS
-      MRetrievals++;
-#endif
-      if (ref_str)
-        *ref_str = Loc->first.c_str();
-
-      // We found it, so we return the string ID
-      return Loc->second;
-    } else {
-      // String not in the table
-      // Multiple threads could fall through here
-      string_id_t StrID;
-      {
-        // Employ a double-check pattern here
-        std::lock_guard<std::mutex> lock(MMutex);
-        auto Loc = MStringToID.find(str);
-        // String not present in the table
-        if (Loc == MStringToID.end()) {
-          // Add it
-          StrID = MIds++;
-          auto Entry = MStringToID.insert(st_forward_t::value_type(str, StrID));
-          if (ref_str)
-            *ref_str = Entry.first->first.c_str();
-#ifdef XPTI_STATISTICS
-          MInsertions++;
-#endif
-          //  When we insert a new entry into the table, we also need to build
-          //  the reverse lookup;
-          {
-            auto IDLoc = MIDToString.find(StrID);
-            if (IDLoc == MIDToString.end()) {
-              //  An entry does not exist, so we will add it to the reverse
-              //  lookup.
-              MIDToString[StrID] = Entry.first->first.c_str();
-              // Cache the saved string address and send it to the caller
-              MStrings++;
-              return StrID;
-            } else {
-              // We cannot have a case where a string is not present in the
-              // forward lookup and present in the reverse lookup
-              MStringToID.erase(Loc);
-              if (ref_str)
-                *ref_str = nullptr;
-
-              return xpti::invalid_id;
-            }
-          }
-
-        } else {
-          // The string has already been added, so we return the stored ID
-          StrID = Loc->second;
-#ifdef XPTI_STATISTICS
-          MRetrievals++;
-#endif
-          if (ref_str)
-            *ref_str = Loc->first.c_str();
-          return StrID;
-        }
-        // The MMutex will be released here!
+    uint64_t Hash = hash(Str, Length);
+    const entry_t *Entry = find(Hash, Str, Length);
+    if (!Entry) {
+      // String not in the table; multiple threads could fall through here, so
+      // employ a double-check pattern
+      std::lock_guard<std::mutex> Lock(MMutex);
+      entry_t *Last = nullptr;
+      Entry = find(Hash, Str, Length, &Last);
+      if (!Entry) {
+        MEntries.emplace_back(new entry_t(Str, Length, MIds++));
+        entry_t *NewEntry = MEntries.back().get();
+        // The reverse lookup is built first, so that the ID of a string found
+        // in the forward lookup can always be queried
+        MIDToString.insert(static_cast<uint64_t>(NewEntry->ID),
+                           reinterpret_cast<uint64_t>(NewEntry));
+        if (Last)
+          Last->Next.store(NewEntry, std::memory_order_release);
+        else
+          MStringToID.insert(Hash, reinterpret_cast<uint64_t>(NewEntry));
+        MStrings++;
+#ifdef XPTI_STATISTICS
+        MInsertions++;
+#endif
+        if (RefStr)
+          *RefStr = NewEntry->Str.c_str();
+        return NewEntry->ID;
       }
     }
-    return xpti::invalid_id;
-  }
-
-  //  The reverse query allows one to get the string from the string_id_t that
-  //  may have been cached somewhere.
-  const char *query(xpti::string_id_t id) {
-    std::lock_guard<std::mutex> lock(MMutex);
-    auto Loc = MIDToString.find(id);
-    if (Loc != MIDToString.end()) {
 #ifdef XPTI_STATISTICS
-      MRetrievals++;
+    MRetrievals++;
 #endif
-      return Loc->second;
-    } else
-      return nullptr;
+    if (RefStr)
+      *RefStr = Entry->Str.c_str();
+    // We found it, so we return the string ID
+    return Entry->ID;
   }
 
-  int32_t count() { return (int32_t)MStrings; }
-
-  const st_reverse_t &table() { return MIDToString; }
-
-  void printStatistics() {
-#ifdef XPTI_STATISTICS
-    printf("String table inserts: [%llu]\n", MInsertions.load());
-    printf("String table lookups: [%llu]\n", MRetrievals.load());
-#endif
-  }
-
-private:
-  safe_int32_t MIds;         ///< Thread-safe ID generator
-  st_forward_t MStringToID;  ///< Forward lookup hash map
-  st_reverse_t MIDToString;  ///< Reverse lookup hash map
-  int32_t MTableSize;        ///< Initial table size of the hash-map
-  std::mutex MMutex;         ///< Mutex required for double-check pattern
-                             ///< Replace with reader-writer lock in C++14
-  safe_int32_t MStrings;     ///< The count of strings in the table
+  /// Owns the strings, which the lookups below point to
+  std::vector<std::unique_ptr<entry_t>> MEntries;
+  safe_int32_t MIds;             ///< Thread-safe ID generator
+  ConcurrentTable64 MStringToID; ///< Forward lookup by string hash
+  ConcurrentTable64 MIDToString; ///< Reverse lookup by string ID
+  std::mutex MMutex;             ///< Serializes the insertions
+  safe_int32_t MStrings;         ///< The count of strings in the table
 #ifdef XPTI_STATISTICS
   safe_uint64_t MInsertions, ///< Thread-safe tracking of insertions
       MRetrievals;           ///< Thread-safe tracking of lookups
 #endif
 };
 } // namespace xpti
-#endif
@@ -0,0 +1,347 @@
+//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//
+// A collector that writes the trace events of all streams to a compact binary
+// trace file, which the xpti_trace_convert tool turns into a Chrome trace.
+//
+// Each thread encodes its events into a chunk in memory, without contention
+// with the other threads; a full chunk is copied into the memory-mapped trace
+// file at an offset reserved with an atomic add. The names of the events are
+// written to the file once.
+//
+#include "binary_trace_format.hpp"
+#include "xpti_trace_framework.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace bt = xpti::binary_trace;
+
+namespace {
+constexpr const char *env_trace_file = "XPTI_BINARY_TRACE_FILE";
+constexpr const char *env_trace_size = "XPTI_BINARY_TRACE_SIZE";
+constexpr size_t ChunkSize = 64 * 1024;
+/// The largest event record
+constexpr size_t MaxEventSize = 1 + 5 * bt::max_varint_size;
+
+/// A trace file of fixed capacity, mapped in memory
+class TraceFile {
+public:
+  bool open(const char *Path, size_t Capacity) {
+    MFD = ::open(Path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (MFD < 0)
+      return false;
+    // The file is sparse until the chunks are written
+    void *Data = MAP_FAILED;
+    if (ftruncate(MFD, Capacity) == 0)
+      Data =
+          mmap(nullptr, Capacity, PROT_READ | PROT_WRITE, MAP_SHARED, MFD, 0);
+    if (Data == MAP_FAILED) {
+      ::close(MFD);
+      MFD = -1;
+      return false;
+    }
+    MData = static_cast<uint8_t *>(Data);
+    MCapacity = Capacity;
+    bt::file_header_t Header{};
+    std::memcpy(Header.Magic, bt::file_magic, sizeof(Header.Magic));
+    Header.Version = bt::file_version;
+    std::memcpy(MData, &Header, sizeof(Header));
+    MOffset = sizeof(Header);
+    return true;
+  }
+
+  /// Appends the data to the file, returns false if it does not fit.
+  bool write(const void *Data, size_t Size) {
+    size_t Offset = MOffset.load(std::memory_order_relaxed);
+    do {
+      if (Offset + Size > MCapacity)
+        return false;
+    } while (!MOffset.compare_exchange_weak(Offset, Offset + Size,
+                                            std::memory_order_relaxed));
+    std::memcpy(MData + Offset, Data, Size);
+    return true;
+  }
+
+  /// Unmaps the file and cuts it to the size of the data written. Must not be
+  /// called concurrently with write().
+  void close() {
+    if (MFD < 0)
+      return;
+    munmap(MData, MCapacity);
+    if (ftruncate(MFD, MOffset) != 0)
+      perror("binary collector: ftruncate");
+    ::close(MFD);
+    MFD = -1;
+    MData = nullptr;
+  }
+
+  size_t size() const { return MOffset; }
+
+private:
+  int MFD = -1;
+  uint8_t *MData = nullptr;
+  size_t MCapacity = 0;
+  std::atomic<size_t> MOffset{0};
+};
+
+/// The chunk being filled by a thread, and the names the thread has already
+/// looked up
+struct ThreadBuffer {
+  std::mutex Lock;
+  uint32_t ThreadID = 0;
+  /// Set once the trace file is closed
+  bool Closed = false;
+  uint32_t Events = 0;
+  uint64_t BaseTime = 0;
+  uint64_t LastTime = 0;
+  size_t Used = sizeof(bt::chunk_header_t);
+  uint8_t Data[ChunkSize];
+  std::unordered_map<int64_t, uint64_t> EventNames;
+  std::unordered_map<const void *, uint64_t> FunctionNames;
+};
+
+class BinaryCollector {
+public:
+  bool open() {
+    const char *Path = std::getenv(env_trace_file);
+    const char *Size = std::getenv(env_trace_size);
+    MPath = Path ? Path : "xpti_trace.bin";
+    // The capacity is given in MiB
+    size_t Capacity = Size ? std::strtoull(Size, nullptr, 10) : 0;
+    Capacity = (Capacity ? Capacity : 1024) << 20;
+    if (!MFile.open(MPath.c_str(), Capacity)) {
+      perror(("binary collector: cannot map " + MPath).c_str());
+      return false;
+    }
+    return true;
+  }
+
+  ThreadBuffer &threadBuffer() {
+    static thread_local ThreadBuffer *TLBuffer = nullptr;
+    if (!TLBuffer) {
+      std::lock_guard<std::mutex> Lock(MBuffersLock);
+      MBuffers.emplace_back(new ThreadBuffer);
+      TLBuffer = MBuffers.back().get();
+      TLBuffer->ThreadID = static_cast<uint32_t>(MBuffers.size() - 1);
+      TLBuffer->Closed = MClosed;
+    }
+    return *TLBuffer;
+  }
+
+  /// Records an event; the caller holds the lock of the buffer.
+  void addEvent(ThreadBuffer &Buffer, uint16_t TraceType,
+                xpti::trace_event_data_t *Event, uint64_t Instance,
+                const void *UserData, uint64_t Time) {
+    if (Buffer.Closed) {
+      MDropped++;
+      return;
+    }
+    uint64_t NameID = nameID(Buffer, TraceType, Event, UserData);
+    if (Buffer.Used + MaxEventSize > ChunkSize)
+      flush(Buffer);
+    if (!Buffer.Events)
+      Buffer.BaseTime = Buffer.LastTime = Time;
+    uint8_t *Out = Buffer.Data + Buffer.Used;
+    *Out++ = static_cast<uint8_t>(bt::record_tag_t::event);
+    Out = bt::encodeVarint(Out, TraceType);
+    Out = bt::encodeVarint(Out, bt::zigzagEncode(static_cast<int64_t>(
+                                    Time - Buffer.LastTime)));
+    Out = bt::encodeVarint(Out, Event ? Event->unique_id : 0);
+    Out = bt::encodeVarint(Out, Instance);
+    Out = bt::encodeVarint(Out, NameID);
+    Buffer.Used = Out - Buffer.Data;
+    Buffer.LastTime = Time;
+    Buffer.Events++;
+  }
+
+  /// Writes out the chunks of all the threads and closes the trace file; the
+  /// events recorded afterwards are dropped.
+  void close() {
+    std::lock_guard<std::mutex> Lock(MBuffersLock);
+    if (MClosed)
+      return;
+    for (auto &Buffer : MBuffers) {
+      std::lock_guard<std::mutex> BufferLock(Buffer->Lock);
+      flush(*Buffer);
+      Buffer->Closed = true;
+    }
+    MClosed = true;
+    MFile.close();
+    fprintf(stderr,
+            "binary collector: %llu events written to %s (%llu bytes), %llu "
+            "dropped\n",
+            (unsigned long long)MEvents, MPath.c_str(),
+            (unsigned long long)MFile.size(), (unsigned long long)MDropped);
+  }
+
+private:
+  /// Copies the chunk to the trace file and starts a new one.
+  void flush(ThreadBuffer &Buffer) {
+    if (Buffer.Used > sizeof(bt::chunk_header_t)) {
+      bt::chunk_header_t Header;
+      Header.Magic = bt::chunk_magic;
+      Header.Size =
+          static_cast<uint32_t>(Buffer.Used - sizeof(bt::chunk_header_t));
+      Header.ThreadID = Buffer.ThreadID;
+      Header.Events = Buffer.Events;
+      Header.BaseTime = Buffer.BaseTime;
+      std::memcpy(Buffer.Data, &Header, sizeof(Header));
+      if (MFile.write(Buffer.Data, Buffer.Used))
+        MEvents += Buffer.Events;
+      else
+        MDropped += Buffer.Events;
+    }
+    Buffer.Used = sizeof(bt::chunk_header_t);
+    Buffer.Events = 0;
+  }
+
+  /// Returns the ID of the name of the event, defining the name in the
+  /// buffer if no thread has used it yet. The PI calls have no event and pass
+  /// their name as user data; other events without a payload have no name.
+  uint64_t nameID(ThreadBuffer &Buffer, uint16_t TraceType,
+                  xpti::trace_event_data_t *Event, const void *UserData) {
+    bool IsFunction =
+        TraceType == (uint16_t)xpti::trace_point_type_t::function_begin ||
+        TraceType == (uint16_t)xpti::trace_point_type_t::function_end;
+    if (IsFunction && UserData) {
+      auto It = Buffer.FunctionNames.find(UserData);
+      if (It != Buffer.FunctionNames.end())
+        return It->second;
+      uint64_t ID = stringID(Buffer, static_cast<const char *>(UserData));
+      Buffer.FunctionNames.emplace(UserData, ID);
+      return ID;
+    }
+    if (!Event)
+      return 0;
+    auto It = Buffer.EventNames.find(Event->unique_id);
+    if (It != Buffer.EventNames.end())
+      return It->second;
+    const xpti::payload_t *Payload = xptiQueryPayload(Event);
+    const char *Name = Payload && Payload->name_sid != xpti::invalid_id
+                           ? Payload->name
+                           : "<unknown>";
+    uint64_t ID = stringID(Buffer, Name);
+    Buffer.EventNames.emplace(Event->unique_id, ID);
+    return ID;
+  }
+
+  uint64_t stringID(ThreadBuffer &Buffer, const char *Str) {
+    std::string Name(Str);
+    // Keep a string definition within a chunk
+    size_t MaxLength = ChunkSize / 2;
+    if (Name.size() > MaxLength)
+      Name.resize(MaxLength);
+    std::lock_guard<std::mutex> Lock(MStringsLock);
+    auto It = MStringIDs.find(Name);
+    if (It != MStringIDs.end())
+      return It->second;
+    uint64_t ID = MStringIDs.size() + 1;
+    MStringIDs.emplace(Name, ID);
+    if (Buffer.Used + 1 + 2 * bt::max_varint_size + Name.size() > ChunkSize)
+      flush(Buffer);
+    uint8_t *Out = Buffer.Data + Buffer.Used;
+    *Out++ = static_cast<uint8_t>(bt::record_tag_t::string);
+    Out = bt::encodeVarint(Out, ID);
+    Out = bt::encodeVarint(Out, Name.size());
+    std::memcpy(Out, Name.data(), Name.size());
+    Buffer.Used = Out + Name.size() - Buffer.Data;
+    return ID;
+  }
+
+  std::string MPath;
+  TraceFile MFile;
+  std::mutex MBuffersLock;
+  std::vector<std::unique_ptr<ThreadBuffer>> MBuffers;
+  bool MClosed = false;
+  std::mutex MStringsLock;
+  std::unordered_map<std::string, uint64_t> MStringIDs;
+  std::atomic<uint64_t> MEvents{0};
+  std::atomic<uint64_t> MDropped{0};
+};
+
+// Never destroyed, as notifications may still be delivered while the process
+// exits; the file is closed by the library destructor
+BinaryCollector *GCollector = nullptr;
+std::mutex GInitLock;
+} // namespace
+
+XPTI_CALLBACK_API void tpCallback(uint16_t TraceType,
+                                  xpti::trace_event_data_t *Parent,
+                                  xpti::trace_event_data_t *Event,
+                                  uint64_t Instance, const void *UserData) {
+  // With asynchronous notifications, this is the time the event was sent at
+  uint64_t Time = xptiQueryNotificationTime();
+  ThreadBuffer &Buffer = GCollector->threadBuffer();
+  std::lock_guard<std::mutex> Lock(Buffer.Lock);
+  GCollector->addEvent(Buffer, TraceType, Event, Instance, UserData, Time);
+}
+
+// Based on the documentation, every subscriber MUST implement the
+// xptiTraceInit() and xptiTraceFinish() APIs for their subscriber collector to
+// be loaded successfully.
+XPTI_CALLBACK_API void xptiTraceInit(unsigned int major_version,
+                                     unsigned int minor_version,
+                                     const char *version_str,
+                                     const char *stream_name) {
+  if (!stream_name)
+    return;
+  {
+    std::lock_guard<std::mutex> Lock(GInitLock);
+    if (!GCollector) {
+      std::unique_ptr<BinaryCollector> Collector(new BinaryCollector);
+      if (!Collector->open())
+        return;
+      GCollector = Collector.release();
+    }
+  }
+  // Record all the predefined trace point types of every stream
+  const xpti::trace_point_type_t TraceTypes[] = {
+      xpti::trace_point_type_t::graph_create,
+      xpti::trace_point_type_t::node_create,
+      xpti::trace_point_type_t::edge_create,
+      xpti::trace_point_type_t::region_begin,
+      xpti::trace_point_type_t::region_end,
+      xpti::trace_point_type_t::task_begin,
+      xpti::trace_point_type_t::task_end,
+      xpti::trace_point_type_t::barrier_begin,
+      xpti::trace_point_type_t::barrier_end,
+      xpti::trace_point_type_t::lock_begin,
+      xpti::trace_point_type_t::lock_end,
+      xpti::trace_point_type_t::signal,
+      xpti::trace_point_type_t::transfer_begin,
+      xpti::trace_point_type_t::transfer_end,
+      xpti::trace_point_type_t::thread_begin,
+      xpti::trace_point_type_t::thread_end,
+      xpti::trace_point_type_t::wait_begin,
+      xpti::trace_point_type_t::wait_end,
+      xpti::trace_point_type_t::function_begin,
+      xpti::trace_point_type_t::function_end};
+  uint8_t StreamID = xptiRegisterStream(stream_name);
+  for (auto TraceType : TraceTypes)
+    xptiRegisterCallback(StreamID, (uint16_t)TraceType, tpCallback);
+}
+
+XPTI_CALLBACK_API void xptiTraceFinish(const char *stream_name) {
+  // The chunks of all the streams go to the same file, which is closed when
+  // the library is unloaded
+}
+
+__attribute__((destructor)) static void framework_fini() {
+  if (GCollector)
+    GCollector->close();
+}
@@ -0,0 +1,88 @@
+//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//
+// Layout of the binary traces written by the binary collector and read by the
+// xpti_trace_convert tool.
+//
+// A trace file starts with a file_header_t, followed by chunks. Each chunk is
+// a chunk_header_t and the records written by one thread of the application,
+// one after the other. A record is a tag byte followed by unsigned LEB128
+// (varint) fields:
+//
+//   record_tag_t::string: <string ID> <length> <bytes>
+//     Defines a string. Each string is defined once in the whole file, maybe
+//     in a later chunk than the first event that uses it.
+//   record_tag_t::event: <trace type> <time> <event ID> <instance> <name ID>
+//     The time is the zigzag encoded difference with the time of the previous
+//     event of the chunk, or with the chunk base time for the first event.
+//
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace xpti {
+namespace binary_trace {
+constexpr char file_magic[8] = {'X', 'P', 'T', 'I', 'B', 'I', 'N', '\0'};
+constexpr uint32_t file_version = 1;
+constexpr uint32_t chunk_magic = 0x43545058; // "XPTC"
+
+struct file_header_t {
+  char Magic[8];
+  uint32_t Version;
+  uint32_t Reserved;
+};
+
+struct chunk_header_t {
+  uint32_t Magic;
+  /// Size of the records that follow the header in bytes
+  uint32_t Size;
+  /// Enumerated ID of the thread that wrote the chunk
+  uint32_t ThreadID;
+  /// Number of event records in the chunk
+  uint32_t Events;
+  /// Time in nanoseconds the event times of the chunk are relative to
+  uint64_t BaseTime;
+};
+
+enum class record_tag_t : uint8_t { string = 1, event = 2 };
+
+/// The largest encoding of a 64-bit varint
+constexpr size_t max_varint_size = 10;
+
+inline uint8_t *encodeVarint(uint8_t *Out, uint64_t Value) {
+  while (Value >= 0x80) {
+    *Out++ = static_cast<uint8_t>(Value) | 0x80;
+    Value >>= 7;
+  }
+  *Out++ = static_cast<uint8_t>(Value);
+  return Out;
+}
+
+/// Decodes a varint from [In, End); returns nullptr if it is truncated.
+inline const uint8_t *decodeVarint(const uint8_t *In, const uint8_t *End,
+                                   uint64_t &Value) {
+  Value = 0;
+  for (unsigned Shift = 0; In != End && Shift < 64; Shift += 7) {
+    uint8_t Byte = *In++;
+    Value |= static_cast<uint64_t>(Byte & 0x7f) << Shift;
+    if (!(Byte & 0x80))
+      return In;
+  }
+  return nullptr;
+}
+
+inline uint64_t zigzagEncode(int64_t Value) {
+  return (static_cast<uint64_t>(Value) << 1) ^
+         static_cast<uint64_t>(Value >> 63);
+}
+
+inline int64_t zigzagDecode(uint64_t Value) {
+  return static_cast<int64_t>(Value >> 1) ^ -static_cast<int64_t>(Value & 1);
+}
+} // namespace binary_trace
+} // namespace xpti
@@ -0,0 +1,224 @@
+//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//
+// Converts a trace written by the binary collector to the Chrome trace event
+// JSON format, which chrome://tracing and the Perfetto UI open.
+//
+//   xpti_trace_convert <trace.bin> <trace.json>
+//
+#include "binary_trace_format.hpp"
+#include "xpti_data_types.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace bt = xpti::binary_trace;
+
+namespace {
+using string_table_t = std::unordered_map<uint64_t, std::string>;
+
+/// Decodes the records of a chunk; calls OnString(ID, Str) for the string
+/// definitions and OnEvent(TraceType, Time, EventID, Instance, NameID) for the
+/// events. Returns false if the chunk is malformed.
+template <typename StringFn, typename EventFn>
+bool decodeChunk(const bt::chunk_header_t &Header, const uint8_t *In,
+                 StringFn OnString, EventFn OnEvent) {
+  const uint8_t *End = In + Header.Size;
+  uint64_t Time = Header.BaseTime;
+  while (In != End) {
+    auto Tag = static_cast<bt::record_tag_t>(*In++);
+    if (Tag == bt::record_tag_t::string) {
+      uint64_t ID, Length;
+      if (!(In = bt::decodeVarint(In, End, ID)) ||
+          !(In = bt::decodeVarint(In, End, Length)) ||
+          Length > static_cast<uint64_t>(End - In))
+        return false;
+      OnString(ID, std::string(reinterpret_cast<const char *>(In), Length));
+      In += Length;
+    } else if (Tag == bt::record_tag_t::event) {
+      uint64_t Fields[5];
+      for (uint64_t &Field : Fields)
+        if (!(In = bt::decodeVarint(In, End, Field)))
+          return false;
+      Time += bt::zigzagDecode(Fields[1]);
+      OnEvent(static_cast<uint16_t>(Fields[0]), Time, Fields[2], Fields[3],
+              Fields[4]);
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Calls Fn(Header, Records) for each chunk of the trace; returns false if the
+/// trace is malformed.
+template <typename ChunkFn>
+bool forEachChunk(const std::vector<uint8_t> &Trace, ChunkFn Fn) {
+  size_t Offset = sizeof(bt::file_header_t);
+  while (Offset < Trace.size()) {
+    bt::chunk_header_t Header;
+    if (Trace.size() - Offset < sizeof(Header))
+      return false;
+    std::memcpy(&Header, Trace.data() + Offset, sizeof(Header));
+    Offset += sizeof(Header);
+    if (Header.Magic != bt::chunk_magic || Trace.size() - Offset < Header.Size)
+      return false;
+    if (!Fn(Header, Trace.data() + Offset))
+      return false;
+    Offset += Header.Size;
+  }
+  return true;
+}
+
+const char *traceTypeName(uint16_t TraceType) {
+  using tp = xpti::trace_point_type_t;
+  switch (static_cast<tp>(TraceType)) {
+  case tp::graph_create:
+    return "graph_create";
+  case tp::node_create:
+    return "node_create";
+  case tp::edge_create:
+    return "edge_create";
+  case tp::region_begin:
+  case tp::region_end:
+    return "region";
+  case tp::task_begin:
+  case tp::task_end:
+    return "task";
+  case tp::barrier_begin:
+  case tp::barrier_end:
+    return "barrier";
+  case tp::lock_begin:
+  case tp::lock_end:
+    return "lock";
+  case tp::signal:
+    return "signal";
+  case tp::transfer_begin:
+  case tp::transfer_end:
+    return "transfer";
+  case tp::thread_begin:
+  case tp::thread_end:
+    return "thread";
+  case tp::wait_begin:
+  case tp::wait_end:
+    return "wait";
+  case tp::function_begin:
+  case tp::function_end:
+    return "function";
+  default:
+    return "user_defined";
+  }
+}
+
+/// Returns the Chrome trace phase of the trace type: the begin and end of the
+/// predefined scopes, or an instant event.
+char tracePhase(uint16_t TraceType) {
+  using tp = xpti::trace_point_type_t;
+  if (TraceType & (uint16_t)tp::user_defined)
+    return 'i';
+  switch (static_cast<tp>(TraceType)) {
+  case tp::graph_create:
+  case tp::node_create:
+  case tp::edge_create:
+  case tp::signal:
+  case tp::metadata:
+    return 'i';
+  default:
+    return TraceType & 1 ? 'E' : 'B';
+  }
+}
+
+void writeJSONString(FILE *Out, const std::string &Str) {
+  fputc('"', Out);
+  for (unsigned char C : Str) {
+    if (C == '"' || C == '\\')
+      fprintf(Out, "\\%c", C);
+    else if (C < 0x20)
+      fprintf(Out, "\\u%04x", C);
+    else
+      fputc(C, Out);
+  }
+  fputc('"', Out);
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s <trace.bin> <trace.json>\n", argv[0]);
+    return 1;
+  }
+  std::ifstream In(argv[1], std::ios::binary);
+  std::vector<uint8_t> Trace((std::istreambuf_iterator<char>(In)),
+                             std::istreambuf_iterator<char>());
+  bt::file_header_t Header{};
+  if (Trace.size() >= sizeof(Header))
+    std::memcpy(&Header, Trace.data(), sizeof(Header));
+  if (std::memcmp(Header.Magic, bt::file_magic, sizeof(Header.Magic)) ||
+      Header.Version != bt::file_version) {
+    fprintf(stderr, "%s: not a binary XPTI trace\n", argv[1]);
+    return 1;
+  }
+
+  // A string may be defined after its first use, so all the strings are read
+  // before the events are written
+  string_table_t Strings;
+  bool Valid = forEachChunk(Trace, [&](const bt::chunk_header_t &Chunk,
+                                       const uint8_t *Records) {
+    return decodeChunk(
+        Chunk, Records,
+        [&](uint64_t ID, std::string Str) { Strings[ID] = std::move(Str); },
+        [](uint16_t, uint64_t, uint64_t, uint64_t, uint64_t) {});
+  });
+  if (!Valid) {
+    fprintf(stderr, "%s: malformed trace\n", argv[1]);
+    return 1;
+  }
+
+  FILE *Out = fopen(argv[2], "w");
+  if (!Out) {
+    perror(argv[2]);
+    return 1;
+  }
+  fprintf(Out, "{\"traceEvents\":[");
+  const char *Separator = "\n";
+  uint64_t Events = 0;
+  forEachChunk(Trace, [&](const bt::chunk_header_t &Chunk,
+                          const uint8_t *Records) {
+    return decodeChunk(
+        Chunk, Records, [](uint64_t, std::string) {},
+        [&](uint16_t TraceType, uint64_t Time, uint64_t EventID,
+            uint64_t Instance, uint64_t NameID) {
+          auto It = Strings.find(NameID);
+          char Phase = tracePhase(TraceType);
+          fprintf(Out, "%s{\"name\":", Separator);
+          writeJSONString(Out, It != Strings.end() ? It->second
+                                                   : traceTypeName(TraceType));
+          fprintf(Out,
+                  ",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":0,"
+                  "\"tid\":%" PRIu32,
+                  traceTypeName(TraceType), Phase, Time / 1000.0,
+                  Chunk.ThreadID);
+          if (Phase == 'i')
+            fprintf(Out, ",\"s\":\"t\"");
+          fprintf(Out,
+                  ",\"args\":{\"event_id\":%" PRIu64 ",\"instance\":%" PRIu64
+                  "}}",
+                  EventID, Instance);
+          Separator = ",\n";
+          Events++;
+        });
+  });
+  fprintf(Out, "\n]}\n");
+  fclose(Out);
+  printf("%" PRIu64 " events converted\n", Events);
+  return 0;
+}
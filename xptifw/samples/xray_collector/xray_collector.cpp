@@ -0,0 +1,162 @@
+//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//
+// A bridge that sends the function entries and exits traced by XRay to the
+// "xray" stream of XPTI, so that the host functions of an application appear
+// in the same trace as the events of the SYCL runtime.
+//
+// The bridge is loaded as a subscriber, installs its handler in the XRay
+// runtime linked into the application and patches the instrumented functions
+// when the first stream is initialized. The handler notifies function_begin
+// and function_end trace points on the thread that runs the function, so the
+// other collectors record them with the same clock and thread IDs as the
+// events of the SYCL runtime.
+//
+#include "xpti_trace_framework.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+
+// The XRay runtime is only present in the applications built with
+// -fxray-instrument, so its interface is declared here as weak rather than
+// taken from <xray/xray_interface.h>.
+enum XRayEntryType {
+  ENTRY = 0,
+  EXIT = 1,
+  TAIL = 2,
+  LOG_ARGS_ENTRY = 3,
+  CUSTOM_EVENT = 4,
+  TYPED_EVENT = 5,
+};
+
+extern "C" {
+__attribute__((weak)) int __xray_set_handler(void (*)(int32_t, XRayEntryType));
+__attribute__((weak)) int __xray_remove_handler();
+__attribute__((weak)) int __xray_patch();
+__attribute__((weak)) int __xray_unpatch();
+__attribute__((weak)) uintptr_t __xray_function_address(int32_t);
+__attribute__((weak)) size_t __xray_max_function_id();
+}
+
+namespace {
+constexpr const char *xray_stream_name = "xray";
+/// XRayPatchingStatus::SUCCESS
+constexpr int xray_patching_success = 1;
+
+uint8_t GStreamID = 0;
+bool GActive = false;
+/// The names of the functions by XRay function ID, which starts at 1; the
+/// handler passes them as the user data of the trace points.
+std::vector<std::string> GFunctionNames;
+/// Whether the current thread is in the handler, e.g. if a collector calls an
+/// instrumented function.
+thread_local bool GInHandler = false;
+std::mutex GInitLock;
+
+std::string functionName(int32_t FuncID) {
+  const void *Address =
+      reinterpret_cast<const void *>(__xray_function_address(FuncID));
+  Dl_info Info;
+  if (Address && dladdr(Address, &Info) && Info.dli_sname) {
+    int Status = 0;
+    char *Demangled =
+        abi::__cxa_demangle(Info.dli_sname, nullptr, nullptr, &Status);
+    std::string Name = Status == 0 ? Demangled : Info.dli_sname;
+    free(Demangled);
+    return Name;
+  }
+  return "xray_function_" + std::to_string(FuncID);
+}
+
+void xrayHandler(int32_t FuncID, XRayEntryType Type) {
+  if (GInHandler || FuncID <= 0 ||
+      static_cast<size_t>(FuncID) >= GFunctionNames.size())
+    return;
+  uint16_t TraceType;
+  switch (Type) {
+  case ENTRY:
+  case LOG_ARGS_ENTRY:
+    TraceType = (uint16_t)xpti::trace_point_type_t::function_begin;
+    break;
+  case EXIT:
+  case TAIL:
+    TraceType = (uint16_t)xpti::trace_point_type_t::function_end;
+    break;
+  default:
+    return;
+  }
+  if (!xptiCheckTraceEnabled(GStreamID, TraceType))
+    return;
+  GInHandler = true;
+  // The function events have no event object; the instance is the XRay
+  // function ID
+  xptiNotifySubscribers(GStreamID, TraceType, nullptr, nullptr, FuncID,
+                        GFunctionNames[FuncID].c_str());
+  GInHandler = false;
+}
+
+/// Installs the handler and patches the instrumented functions, once.
+void startXRay() {
+  if (GActive)
+    return;
+  if (!__xray_set_handler || !__xray_max_function_id) {
+    fprintf(stderr, "xray_collector: the application is not instrumented "
+                    "with XRay (-fxray-instrument)\n");
+    return;
+  }
+  // The names are resolved ahead, since dladdr() and the demangler are too
+  // costly for the handler
+  size_t MaxID = __xray_max_function_id();
+  GFunctionNames.resize(MaxID + 1);
+  for (size_t ID = 1; ID <= MaxID; ++ID)
+    GFunctionNames[ID] = functionName(static_cast<int32_t>(ID));
+
+  GStreamID = xptiRegisterStream(xray_stream_name);
+  GActive = true;
+  // Let the other subscribers register their callbacks for the stream
+  xptiInitialize(xray_stream_name, 1, 0, "1.0");
+  if (!__xray_set_handler(xrayHandler) ||
+      __xray_patch() != xray_patching_success)
+    fprintf(stderr, "xray_collector: patching the XRay sleds failed\n");
+}
+
+void stopXRay() {
+  if (!GActive)
+    return;
+  GActive = false;
+  __xray_unpatch();
+  __xray_remove_handler();
+}
+} // namespace
+
+// Based on the documentation, every subscriber MUST implement the
+// xptiTraceInit() and xptiTraceFinish() APIs for their subscriber collector to
+// be loaded successfully.
+XPTI_CALLBACK_API void xptiTraceInit(unsigned int major_version,
+                                     unsigned int minor_version,
+                                     const char *version_str,
+                                     const char *stream_name) {
+  // The bridge only sends notifications, it doesn't subscribe to any stream
+  if (!stream_name || std::string(xray_stream_name) == stream_name)
+    return;
+  std::lock_guard<std::mutex> Lock(GInitLock);
+  startXRay();
+}
+
+XPTI_CALLBACK_API void xptiTraceFinish(const char *stream_name) {
+  // The functions stop being traced as soon as the streams are finalized,
+  // before the collectors close their traces
+  std::lock_guard<std::mutex> Lock(GInitLock);
+  stopXRay();
+}
@@ -5,14 +5,21 @@
 //
 #include "xpti_trace_framework.hpp"
 #include "xpti_int64_hash_table.hpp"
+#include "xpti_ring_buffer.hpp"
 #include "xpti_string_table.hpp"
 
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
+#include <cstdlib>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -37,7 +44,21 @@
 
 namespace xpti {
 constexpr const char *env_subscribers = "XPTI_SUBSCRIBERS";
+constexpr const char *env_async_notifications = "XPTI_ASYNC_NOTIFICATIONS";
+constexpr const char *env_async_buffer_size = "XPTI_ASYNC_BUFFER_SIZE";
+constexpr const char *env_sample_every = "XPTI_SAMPLE_EVERY";
+constexpr const char *env_sample_interval = "XPTI_SAMPLE_INTERVAL";
 xpti::utils::PlatformHelper g_helper;
+
+/// Returns the current time in nanoseconds on the steady clock.
+static uint64_t timestampNow() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+/// Time at which the notification being delivered by the collector thread was
+/// sent, 0 outside of the asynchronous delivery.
+static thread_local uint64_t GNotificationTime = 0;
 // This class is a helper class to load all the listed subscribers provided by
 // the user in XPTI_SUBSCRIBERS environment variable.
 class Subscribers {
@@ -706,9 +727,19 @@ public:
     // If we come here, then we did not find the callback being registered
     // already in the framework. So, we insert it.
     Acc->second.push_back(std::make_pair(true, cbFunc));
+    MTraceTypes[StreamID].fetch_or(traceTypeBit(TraceType),
+                                   std::memory_order_relaxed);
     return xpti::result_t::XPTI_RESULT_SUCCESS;
   }
 
+  /// Returns true if a callback has ever been registered for the trace type,
+  /// or for the other trace point of its begin/end pair, in the stream. The
+  /// bits are not cleared when the callbacks are unregistered.
+  bool hasCallbacks(uint8_t StreamID, uint16_t TraceType) const {
+    return MTraceTypes[StreamID].load(std::memory_order_relaxed) &
+           traceTypeBit(TraceType);
+  }
+
   xpti::result_t unregisterCallback(uint8_t StreamID, uint16_t TraceType,
                                     xpti::tracepoint_callback_api_t cbFunc) {
     if (!cbFunc)
@@ -820,6 +851,15 @@ public:
   }
 
 private:
+  /// Maps a trace type to its bit in the stream masks: the predefined trace
+  /// points of a begin/end pair share a bit and all user defined trace points
+  /// share the last one.
+  static uint64_t traceTypeBit(uint16_t TraceType) {
+    if (TraceType & (uint16_t)trace_point_type_t::user_defined)
+      return 1ULL << 63;
+    return 1ULL << ((TraceType & 0x7f) >> 1);
+  }
+
 #ifdef XPTI_STATISTICS
   std::string stringify_trace_type(xpti_trace_point_type_t TraceType) {
     switch (TraceType) {
@@ -876,6 +916,8 @@ private:
   }
 #endif
   stream_cb_t MCallbacksByStream;
+  /// The trace types with callbacks, by stream ID
+  std::atomic<uint64_t> MTraceTypes[256] = {};
 #ifdef XPTI_USE_TBB
   tbb::spin_mutex MStatsLock;
 #else
@@ -885,6 +927,185 @@ private:
   statistics_t MStats;
 };
 
+/// \brief Helper class to deliver notifications from a dedicated thread
+/// \details When enabled with XPTI_ASYNC_NOTIFICATIONS=1, a notification only
+/// costs the instrumented thread a push into a ring buffer it owns; a
+/// collector thread drains the buffers of all threads in batches and invokes
+/// the callbacks through \ref Notifications. The notifications of each thread
+/// are delivered in order, but the notifications of different threads may
+/// interleave differently than they were sent. Subscribers can get the time a
+/// notification was sent at with xptiQueryNotificationTime().
+///
+/// The user data is delivered as the pointer that was passed; it is not
+/// copied, so this mode is only suitable for subscribers which do not
+/// dereference user data that is valid only during the notification call.
+///
+/// The size of each thread's buffer, in notifications, can be set with
+/// XPTI_ASYNC_BUFFER_SIZE. A thread blocks when its buffer is full, until the
+/// collector thread makes room.
+class AsyncNotifications {
+public:
+  AsyncNotifications(Notifications &Notifier, size_t BufferSize)
+      : MNotifier(Notifier), MBufferSize(BufferSize) {
+    MCollector = std::thread([this] { collect(); });
+  }
+
+  ~AsyncNotifications() { stop(); }
+
+  xpti::result_t notifySubscribers(uint8_t StreamID, uint16_t TraceType,
+                                   xpti::trace_event_data_t *Parent,
+                                   xpti::trace_event_data_t *Object,
+                                   uint64_t InstanceNo, const void *UserData) {
+    // The callbacks run on the collector thread may send notifications too,
+    // they cannot be queued as the thread would wait for itself.
+    if (GIsCollectorThread || !MRunning.load(std::memory_order_acquire))
+      return MNotifier.notifySubscribers(StreamID, TraceType, Parent, Object,
+                                         InstanceNo, UserData);
+
+    record_t Record = {timestampNow(), Parent,    Object,  InstanceNo,
+                       UserData,       TraceType, StreamID};
+    SPSCRingBuffer<record_t> &Records = threadBuffer().Records;
+    while (!Records.push(Record))
+      std::this_thread::yield();
+    return xpti::result_t::XPTI_RESULT_SUCCESS;
+  }
+
+  /// Waits until all the notifications sent before the call are delivered.
+  void flush() {
+    if (GIsCollectorThread)
+      return;
+    std::vector<std::pair<std::shared_ptr<thread_buffer_t>, size_t>> Targets;
+    {
+      std::lock_guard<std::mutex> Lock(MBuffersLock);
+      for (const auto &Buffer : MBuffers)
+        Targets.emplace_back(Buffer, Buffer->Records.pushed());
+    }
+    for (const auto &Target : Targets)
+      while (Target.first->Delivered.load(std::memory_order_acquire) <
+             Target.second)
+        std::this_thread::yield();
+  }
+
+  /// Delivers the pending notifications and stops the collector thread, the
+  /// later notifications are delivered synchronously.
+  void stop() {
+    if (!MCollector.joinable())
+      return;
+    MRunning.store(false, std::memory_order_release);
+    MCollector.join();
+  }
+
+private:
+  struct record_t {
+    uint64_t Timestamp;
+    xpti::trace_event_data_t *Parent;
+    xpti::trace_event_data_t *Object;
+    uint64_t InstanceNo;
+    const void *UserData;
+    uint16_t TraceType;
+    uint8_t StreamID;
+  };
+
+  struct thread_buffer_t {
+    thread_buffer_t(size_t Size) : Records(Size) {}
+    SPSCRingBuffer<record_t> Records;
+    /// Number of notifications of the buffer delivered so far
+    std::atomic<size_t> Delivered{0};
+    /// Set when the thread owning the buffer exits, the buffer can then be
+    /// given to a new thread once it is drained.
+    std::atomic<bool> Orphaned{false};
+  };
+
+  /// Returns the buffer of the calling thread, assigning it one first if it
+  /// does not have one yet.
+  thread_buffer_t &threadBuffer() {
+    struct buffer_handle_t {
+      std::shared_ptr<thread_buffer_t> Buffer;
+      ~buffer_handle_t() {
+        if (Buffer)
+          Buffer->Orphaned.store(true, std::memory_order_release);
+      }
+    };
+    static thread_local buffer_handle_t Handle;
+    if (Handle.Buffer)
+      return *Handle.Buffer;
+
+    std::lock_guard<std::mutex> Lock(MBuffersLock);
+    for (const auto &Buffer : MBuffers) {
+      if (Buffer->Orphaned.load(std::memory_order_acquire) &&
+          Buffer->Records.empty()) {
+        Buffer->Orphaned.store(false, std::memory_order_relaxed);
+        Handle.Buffer = Buffer;
+        return *Buffer;
+      }
+    }
+    MBuffers.push_back(std::make_shared<thread_buffer_t>(MBufferSize));
+    MNumBuffers.store(MBuffers.size(), std::memory_order_release);
+    Handle.Buffer = MBuffers.back();
+    return *Handle.Buffer;
+  }
+
+  /// Delivers up to MaxRecords notifications of the buffer, returns the
+  /// number of delivered notifications.
+  size_t drain(thread_buffer_t &Buffer, size_t MaxRecords) {
+    record_t Record;
+    size_t Count = 0;
+    while (Count < MaxRecords && Buffer.Records.pop(Record)) {
+      GNotificationTime = Record.Timestamp;
+      MNotifier.notifySubscribers(Record.StreamID, Record.TraceType,
+                                  Record.Parent, Record.Object,
+                                  Record.InstanceNo, Record.UserData);
+      ++Count;
+      Buffer.Delivered.store(Buffer.Records.popped(),
+                             std::memory_order_release);
+    }
+    GNotificationTime = 0;
+    return Count;
+  }
+
+  void collect() {
+    GIsCollectorThread = true;
+    // The buffers are only ever added, so the local copy is refreshed when
+    // their number changes.
+    std::vector<std::shared_ptr<thread_buffer_t>> Buffers;
+    while (true) {
+      // Once stopping, exit only after a pass that found nothing to deliver
+      bool Stopping = !MRunning.load(std::memory_order_acquire);
+      if (MNumBuffers.load(std::memory_order_acquire) != Buffers.size()) {
+        std::lock_guard<std::mutex> Lock(MBuffersLock);
+        Buffers = MBuffers;
+      }
+      size_t Delivered = 0;
+      for (const auto &Buffer : Buffers)
+        Delivered += drain(*Buffer, MBatchSize);
+      if (Delivered)
+        continue;
+      if (Stopping)
+        break;
+      std::this_thread::sleep_for(MIdleInterval);
+    }
+  }
+
+  static thread_local bool GIsCollectorThread;
+  /// Maximum number of notifications delivered from a buffer before moving on
+  /// to the next one
+  static constexpr size_t MBatchSize = 256;
+  /// Time the collector thread sleeps for when there is nothing to deliver
+  static constexpr std::chrono::microseconds MIdleInterval{50};
+
+  Notifications &MNotifier;
+  size_t MBufferSize;
+  std::atomic<bool> MRunning{true};
+  std::vector<std::shared_ptr<thread_buffer_t>> MBuffers;
+  std::atomic<size_t> MNumBuffers{0};
+  std::mutex MBuffersLock;
+  std::thread MCollector;
+};
+
+thread_local bool AsyncNotifications::GIsCollectorThread = false;
+constexpr size_t AsyncNotifications::MBatchSize;
+constexpr std::chrono::microseconds AsyncNotifications::MIdleInterval;
+
 class Framework {
 public:
   Framework()
@@ -893,6 +1114,29 @@ public:
     MSubscribers.loadFromEnvironmentVariable();
     MTraceEnabled =
         (g_helper.checkTraceEnv() && MSubscribers.hasValidSubscribers());
+    if (MTraceEnabled) {
+      std::string Async =
+          g_helper.getEnvironmentVariable(env_async_notifications);
+      if (Async == "1" || Async == "true") {
+        std::string Size =
+            g_helper.getEnvironmentVariable(env_async_buffer_size);
+        size_t BufferSize =
+            Size.empty() ? 0 : std::strtoull(Size.c_str(), nullptr, 10);
+        MAsyncNotifier.reset(new AsyncNotifications(
+            MNotifier, BufferSize ? BufferSize : 1024));
+      }
+    }
+    std::string Every = g_helper.getEnvironmentVariable(env_sample_every);
+    std::string Interval =
+        g_helper.getEnvironmentVariable(env_sample_interval);
+    for (int StreamID = 0; StreamID < 256; ++StreamID) {
+      if (!Every.empty())
+        setSampling(StreamID, sampling_mode_t::every_nth,
+                    std::strtoull(Every.c_str(), nullptr, 10));
+      else if (!Interval.empty())
+        setSampling(StreamID, sampling_mode_t::time_interval,
+                    std::strtoull(Interval.c_str(), nullptr, 10) * 1000);
+    }
   }
 
   void clear() {
@@ -905,6 +1149,56 @@ public:
 
   inline bool traceEnabled() { return MTraceEnabled; }
 
+  inline bool checkTraceEnabled(uint8_t StreamID, uint16_t TraceType) {
+    return MTraceEnabled && MNotifier.hasCallbacks(StreamID, TraceType);
+  }
+
+  xpti::result_t setSampling(uint8_t StreamID, sampling_mode_t Mode,
+                             uint64_t Value) {
+    sampling_t &Sampling = MSampling[StreamID];
+    switch (Mode) {
+    case sampling_mode_t::all:
+      break;
+    case sampling_mode_t::every_nth:
+    case sampling_mode_t::time_interval:
+      if (!Value)
+        return xpti::result_t::XPTI_RESULT_INVALIDARG;
+      // The value is published along with the mode, so a thread that sees the
+      // mode never sees a zero value
+      Sampling.Value.store(Value, std::memory_order_relaxed);
+      Sampling.Count.store(0, std::memory_order_relaxed);
+      break;
+    default:
+      return xpti::result_t::XPTI_RESULT_INVALIDARG;
+    }
+    Sampling.Mode.store(Mode, std::memory_order_release);
+    return xpti::result_t::XPTI_RESULT_SUCCESS;
+  }
+
+  bool sampleTrace(uint8_t StreamID) {
+    if (!MTraceEnabled)
+      return false;
+    sampling_t &Sampling = MSampling[StreamID];
+    switch (Sampling.Mode.load(std::memory_order_acquire)) {
+    case sampling_mode_t::every_nth:
+      return Sampling.Count.fetch_add(1, std::memory_order_relaxed) %
+                 Sampling.Value.load(std::memory_order_relaxed) ==
+             0;
+    case sampling_mode_t::time_interval: {
+      // Count holds the time at which the next operation may be traced; only
+      // one of the threads getting there at the same time moves it forward
+      uint64_t Now = timestampNow();
+      uint64_t Next = Sampling.Count.load(std::memory_order_relaxed);
+      return Now >= Next &&
+             Sampling.Count.compare_exchange_strong(
+                 Next, Now + Sampling.Value.load(std::memory_order_relaxed),
+                 std::memory_order_relaxed);
+    }
+    default:
+      return true;
+    }
+  }
+
   inline uint64_t makeUniqueID() { return MTracepoints.makeUniqueID(); }
 
   xpti::result_t addMetadata(xpti::trace_event_data_t *Event, const char *Key,
@@ -1019,9 +1313,16 @@ public:
         return xpti::result_t::XPTI_RESULT_INVALIDARG;
       }
     }
+    // Nobody listens to this trace type, so there is no need to look up the
+    // callbacks or queue the notification
+    if (!MNotifier.hasCallbacks(StreamID, TraceType))
+      return xpti::result_t::XPTI_RESULT_SUCCESS;
     //
     //  Notify all subscribers for the stream 'StreamID'
     //
+    if (MAsyncNotifier)
+      return MAsyncNotifier->notifySubscribers(StreamID, TraceType, Parent,
+                                               Object, InstanceNo, UserData);
     return MNotifier.notifySubscribers(StreamID, TraceType, Parent, Object,
                                        InstanceNo, UserData);
   }
@@ -1031,6 +1332,9 @@ public:
   xpti::result_t finalizeStream(const char *Stream) {
     if (!Stream)
       return xpti::result_t::XPTI_RESULT_INVALIDARG;
+    // Subscribers get the notifications sent before they are finalized
+    if (MAsyncNotifier)
+      MAsyncNotifier->flush();
     MSubscribers.finalizeForStream(Stream);
     return MNotifier.unregisterStream(MStreamStringTable.add(Stream));
   }
@@ -1046,12 +1350,24 @@ public:
   }
 
 private:
+  /// The sampling policy of a stream
+  struct sampling_t {
+    std::atomic<sampling_mode_t> Mode{sampling_mode_t::all};
+    /// N or the interval in nanoseconds
+    std::atomic<uint64_t> Value{0};
+    /// The operations seen or the time the next one may be traced at
+    std::atomic<uint64_t> Count{0};
+  };
+
   /// Thread-safe counter used for generating universal IDs
   xpti::safe_uint64_t MUniversalIDs;
   /// Manages loading the subscribers and calling their init() functions
   xpti::Subscribers MSubscribers;
   /// Used to send event notification to subscribers
   xpti::Notifications MNotifier;
+  /// Delivers the notifications from a collector thread if enabled; declared
+  /// after MNotifier and MSubscribers as it uses them until it is destroyed
+  std::unique_ptr<xpti::AsyncNotifications> MAsyncNotifier;
   /// Thread-safe string table
   xpti::StringTable MStringTableRef;
   /// Thread-safe string table, used for stream IDs
@@ -1062,6 +1378,8 @@ private:
   xpti::Tracepoints MTracepoints;
   /// Flag indicates whether tracing should be enabled
   bool MTraceEnabled;
+  /// The sampling policies, by stream ID
+  sampling_t MSampling[256];
 };
 
 static Framework GXPTIFramework;
@@ -1157,6 +1475,21 @@ XPTI_EXPORT_API bool xptiTraceEnabled() {
   return xpti::GXPTIFramework.traceEnabled();
 }
 
+XPTI_EXPORT_API bool xptiCheckTraceEnabled(uint8_t StreamID,
+                                           uint16_t TraceType) {
+  return xpti::GXPTIFramework.checkTraceEnabled(StreamID, TraceType);
+}
+
+XPTI_EXPORT_API xpti::result_t xptiSetSampling(uint8_t StreamID,
+                                               xpti::sampling_mode_t Mode,
+                                               uint64_t Value) {
+  return xpti::GXPTIFramework.setSampling(StreamID, Mode, Value);
+}
+
+XPTI_EXPORT_API bool xptiSampleTrace(uint8_t StreamID) {
+  return xpti::GXPTIFramework.sampleTrace(StreamID);
+}
+
 XPTI_EXPORT_API xpti::result_t xptiAddMetadata(xpti::trace_event_data_t *Event,
                                                const char *Key,
                                                const char *Value) {
@@ -1171,6 +1504,11 @@ xptiQueryMetadata(xpti::trace_event_data_t *Event) {
 XPTI_EXPORT_API void xptiForceSetTraceEnabled(bool YesOrNo) {
   xpti::GXPTIFramework.setTraceEnabled(YesOrNo);
 }
+
+XPTI_EXPORT_API uint64_t xptiQueryNotificationTime() {
+  return xpti::GNotificationTime ? xpti::GNotificationTime
+                                 : xpti::timestampNow();
+}
 } // extern "C"
 
 #if (defined(_WIN32) || defined(_WIN64))
@@ -348,3 +348,52 @@ TEST(xptiApiTest, xptiQueryMetadata) {
   auto str = xptiLookupString(ID);
   EXPECT_STREQ(str, "bar1");
 }
+
+TEST(xptiApiTest, xptiCheckTraceEnabled) {
+  uint8_t StreamID = xptiRegisterStream("check_trace_enabled");
+  xptiForceSetTraceEnabled(true);
+  EXPECT_FALSE(xptiCheckTraceEnabled(StreamID, xpti::trace_task_begin));
+
+  auto Result = xptiRegisterCallback(StreamID, xpti::trace_task_begin,
+                                     trace_point_callback);
+  EXPECT_EQ(Result, xpti::result_t::XPTI_RESULT_SUCCESS);
+  EXPECT_TRUE(xptiCheckTraceEnabled(StreamID, xpti::trace_task_begin));
+  // The end of the pair is enabled along with its begin
+  EXPECT_TRUE(xptiCheckTraceEnabled(StreamID, xpti::trace_task_end));
+  EXPECT_FALSE(xptiCheckTraceEnabled(StreamID, xpti::trace_wait_begin));
+  EXPECT_FALSE(xptiCheckTraceEnabled(StreamID, xpti::trace_signal));
+
+  xptiForceSetTraceEnabled(false);
+  EXPECT_FALSE(xptiCheckTraceEnabled(StreamID, xpti::trace_task_begin));
+  xptiForceSetTraceEnabled(true);
+}
+
+TEST(xptiApiTest, xptiSampleTrace) {
+  uint8_t StreamID = xptiRegisterStream("sample_trace");
+  xptiForceSetTraceEnabled(true);
+  EXPECT_TRUE(xptiSampleTrace(StreamID));
+
+  auto Result = xptiSetSampling(StreamID, xpti::sampling_mode_t::every_nth, 0);
+  EXPECT_EQ(Result, xpti::result_t::XPTI_RESULT_INVALIDARG);
+  Result = xptiSetSampling(StreamID, xpti::sampling_mode_t::every_nth, 4);
+  EXPECT_EQ(Result, xpti::result_t::XPTI_RESULT_SUCCESS);
+  int Sampled = 0;
+  for (int I = 0; I < 16; ++I)
+    Sampled += xptiSampleTrace(StreamID);
+  EXPECT_EQ(Sampled, 4);
+
+  // An hour long interval only lets the first operation through
+  Result = xptiSetSampling(StreamID, xpti::sampling_mode_t::time_interval,
+                           3600ULL * 1000000000ULL);
+  EXPECT_EQ(Result, xpti::result_t::XPTI_RESULT_SUCCESS);
+  EXPECT_TRUE(xptiSampleTrace(StreamID));
+  EXPECT_FALSE(xptiSampleTrace(StreamID));
+
+  Result = xptiSetSampling(StreamID, xpti::sampling_mode_t::all, 0);
+  EXPECT_EQ(Result, xpti::result_t::XPTI_RESULT_SUCCESS);
+  EXPECT_TRUE(xptiSampleTrace(StreamID));
+
+  xptiForceSetTraceEnabled(false);
+  EXPECT_FALSE(xptiSampleTrace(StreamID));
+  xptiForceSetTraceEnabled(true);
+}
@@ -0,0 +1,78 @@
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include "xpti_concurrent_table.hpp"
+#include "xpti_int64_hash_table.hpp"
+#include "xpti_string_table.hpp"
+
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(xptiConcurrentTableTest, InsertFindGrow) {
+  xpti::ConcurrentTable64 Table(4);
+  uint64_t Value = 0;
+  EXPECT_FALSE(Table.find(0, Value));
+
+  // Grows several times; 0 is a valid key too
+  for (uint64_t Key = 0; Key < 1000; ++Key)
+    EXPECT_TRUE(Table.insert(Key, Key * 2));
+  EXPECT_FALSE(Table.insert(10, 0));
+  EXPECT_EQ(Table.size(), 1000u);
+  for (uint64_t Key = 0; Key < 1000; ++Key) {
+    EXPECT_TRUE(Table.find(Key, Value));
+    EXPECT_EQ(Value, Key * 2);
+  }
+  EXPECT_FALSE(Table.find(1000, Value));
+
+  Table.clear();
+  EXPECT_EQ(Table.size(), 0u);
+  EXPECT_FALSE(Table.find(0, Value));
+  EXPECT_FALSE(Table.find(10, Value));
+}
+
+TEST(xptiConcurrentTableTest, Hash64x64Table) {
+  xpti::Hash64x64Table Table(4);
+  Table.add(-5, 7);
+  EXPECT_EQ(Table.find(-5), 7);
+  EXPECT_EQ(Table.reverseFind(7), -5);
+  // Neither an existing key nor an existing value is remapped
+  Table.add(-5, 8);
+  Table.add(6, 7);
+  EXPECT_EQ(Table.find(-5), 7);
+  EXPECT_EQ(Table.find(6), xpti::invalid_id);
+  EXPECT_EQ(Table.reverseFind(8), xpti::invalid_id);
+}
+
+TEST(xptiConcurrentTableTest, ConcurrentStringTable) {
+  constexpr int NumThreads = 8;
+  constexpr int NumStrings = 2000;
+  xpti::StringTable Table(16);
+  std::vector<std::vector<xpti::string_id_t>> IDs(NumThreads);
+
+  std::vector<std::thread> Threads;
+  for (int T = 0; T < NumThreads; ++T)
+    Threads.emplace_back([&Table, &IDs, T] {
+      for (int I = 0; I < NumStrings; ++I) {
+        // Threads add the same strings in different orders
+        int S = (I + T * 97) % NumStrings;
+        const char *Ref = nullptr;
+        std::string Str = "string" + std::to_string(S);
+        IDs[T].push_back(Table.add(Str.c_str(), &Ref));
+        EXPECT_STREQ(Ref, Str.c_str());
+        EXPECT_EQ(Table.query(IDs[T].back()), Ref);
+      }
+    });
+  for (auto &Thread : Threads)
+    Thread.join();
+
+  EXPECT_EQ(Table.count(), NumStrings);
+  EXPECT_EQ(Table.table().size(), static_cast<size_t>(NumStrings));
+  for (int T = 1; T < NumThreads; ++T)
+    for (int I = 0; I < NumStrings; ++I)
+      EXPECT_EQ(IDs[T][I], IDs[0][(I + T * 97) % NumStrings]);
+  EXPECT_EQ(Table.add(""), xpti::invalid_id);
+}
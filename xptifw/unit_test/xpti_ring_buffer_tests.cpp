@@ -0,0 +1,57 @@
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include "xpti_ring_buffer.hpp"
+
+#include <gtest/gtest.h>
+#include <thread>
+
+TEST(xptiRingBufferTest, PushPop) {
+  xpti::SPSCRingBuffer<int> Buffer(3);
+  EXPECT_EQ(Buffer.capacity(), 4u);
+  EXPECT_TRUE(Buffer.empty());
+
+  int Value = 0;
+  EXPECT_FALSE(Buffer.pop(Value));
+  for (int I = 0; I < 4; ++I)
+    EXPECT_TRUE(Buffer.push(I));
+  EXPECT_FALSE(Buffer.push(4));
+  EXPECT_EQ(Buffer.pushed(), 4u);
+
+  // Elements come out in order and free their slots
+  EXPECT_TRUE(Buffer.pop(Value));
+  EXPECT_EQ(Value, 0);
+  EXPECT_TRUE(Buffer.push(4));
+  for (int I = 1; I < 5; ++I) {
+    EXPECT_TRUE(Buffer.pop(Value));
+    EXPECT_EQ(Value, I);
+  }
+  EXPECT_FALSE(Buffer.pop(Value));
+  EXPECT_TRUE(Buffer.empty());
+  EXPECT_EQ(Buffer.popped(), 5u);
+}
+
+TEST(xptiRingBufferTest, ConcurrentPushPop) {
+  constexpr int Count = 100000;
+  xpti::SPSCRingBuffer<int> Buffer(16);
+
+  std::thread Producer([&Buffer] {
+    for (int I = 0; I < Count; ++I)
+      while (!Buffer.push(I))
+        std::this_thread::yield();
+  });
+  int Expected = 0;
+  while (Expected < Count) {
+    int Value;
+    if (!Buffer.pop(Value)) {
+      std::this_thread::yield();
+      continue;
+    }
+    EXPECT_EQ(Value, Expected);
+    ++Expected;
+  }
+  Producer.join();
+  EXPECT_TRUE(Buffer.empty());
+}